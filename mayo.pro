@@ -13,7 +13,7 @@ CONFIG(debug, debug|release) {
     message(Mayo version $$MAYO_VERSION release)
 }
 
-QT += core gui widgets
+QT += core gui widgets network
 message(Qt version $$QT_VERSION)
 
 CONFIG += c++17
@@ -52,6 +52,7 @@ macx {
 
 *win* {
     LIBS += -lUser32
+    LIBS += -lPsapi # For GetProcessMemoryInfo()
 }
 
 INCLUDEPATH += \
@@ -215,3 +216,41 @@ isEmpty(GMIO_ROOT) {
         $$GMIO_ROOT/src/gmio_support/stream_qt.cpp
     DEFINES += HAVE_GMIO
 }
+
+# Profiling zones(see src/base/profiler.h), compiled out by default
+# -- "qmake CONFIG+=mayo_profiler" records zones written as Chrome trace file at exit, file path
+#    specified with environment variable MAYO_PROFILER_OUTPUT
+# -- "qmake TRACY_ROOT=<path>" forwards zones to Tracy client
+mayo_profiler {
+    message(Profiler ON)
+    DEFINES += MAYO_WITH_PROFILER
+}
+!isEmpty(TRACY_ROOT) {
+    message(Tracy ON)
+    INCLUDEPATH += $$TRACY_ROOT/public
+    SOURCES += $$TRACY_ROOT/public/TracyClient.cpp
+    DEFINES += MAYO_WITH_TRACY TRACY_ENABLE
+    unix:LIBS += -lpthread -ldl
+}
+
+# Decompression of input files(see src/base/io_compressed_stream.h), disabled by default
+# -- "qmake CONFIG+=mayo_zlib" enables gzip, ZLIB_ROOT=<path> can be specified for non-system zlib
+# -- "qmake CONFIG+=mayo_zstd" enables zstd, ZSTD_ROOT=<path> can be specified for non-system zstd
+mayo_zlib|!isEmpty(ZLIB_ROOT) {
+    message(zlib ON)
+    !isEmpty(ZLIB_ROOT) {
+        INCLUDEPATH += $$ZLIB_ROOT/include
+        LIBS += -L$$ZLIB_ROOT/lib
+    }
+    LIBS += -lz
+    DEFINES += HAVE_ZLIB
+}
+mayo_zstd|!isEmpty(ZSTD_ROOT) {
+    message(zstd ON)
+    !isEmpty(ZSTD_ROOT) {
+        INCLUDEPATH += $$ZSTD_ROOT/include
+        LIBS += -L$$ZSTD_ROOT/lib
+    }
+    LIBS += -lzstd
+    DEFINES += HAVE_ZSTD
+}
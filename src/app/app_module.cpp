@@ -7,20 +7,47 @@
 #include "app_module.h"
 
 #include "../base/application.h"
+#include "../base/bnd_box_cache.h"
 #include "../base/bnd_utils.h"
 #include "../base/brep_utils.h"
+#include "../base/document.h"
 #include "../base/io_reader.h"
 #include "../base/io_writer.h"
 #include "../base/io_system.h"
+#include "../base/mesh_reorder.h"
+#include "../base/mesh_repair.h"
+#include "../base/mesh_utils.h"
 #include "../base/occt_enums.h"
 #include "../base/settings.h"
+#include "../base/shape_healing.h"
+#include "../base/string_conv.h"
+#include "../base/task_manager.h"
+#include "../base/task_progress.h"
+#include "../graphics/graphics_async_hlr.h"
 #include "../graphics/graphics_object_driver.h"
 #include "../gui/gui_application.h"
 #include "../gui/gui_document.h"
+#include "../gui/gui_image_renderer.h"
+#include "theme.h"
 
-#include <BRepBndLib.hxx>
+#include <BRep_Builder.hxx>
+#include <BRep_Tool.hxx>
+#include <BRepBuilderAPI_Copy.hxx>
+#include <BRepTools.hxx>
+#include <TDataXtd_Triangulation.hxx>
+#include <TopExp.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+#include <TopoDS.hxx>
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDataStream>
 #include <QtCore/QDir>
+#include <QtCore/QStandardPaths>
 #include <QtGui/QGuiApplication>
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cmath>
 #include <iterator>
 
 namespace Mayo {
@@ -43,7 +70,11 @@ AppModule::AppModule(Application* app)
       sectionId_graphicsClipPlanes(
           app->settings()->addSection(this->groupId_graphics, textId("clipPlanes"))),
       sectionId_graphicsMeshDefaults(
-          app->settings()->addSection(this->groupId_graphics, textId("meshDefaults")))
+          app->settings()->addSection(this->groupId_graphics, textId("meshDefaults"))),
+      sectionId_graphicsCulling(
+          app->settings()->addSection(this->groupId_graphics, textId("culling"))),
+      sectionId_graphicsTransparency(
+          app->settings()->addSection(this->groupId_graphics, textId("transparency")))
 {
     static bool metaTypesRegistered = false;
     if (!metaTypesRegistered) {
@@ -52,6 +83,22 @@ AppModule::AppModule(Application* app)
     }
 
     auto settings = app->settings();
+    const QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (!cacheDir.isEmpty())
+        m_thumbnailCacheDirPath = filepathFrom(cacheDir + "/thumbnails");
+
+    this->updateCacheDirPaths();
+
+    QObject::connect(
+                &m_thumbnailTaskMgr, &TaskManager::ended,
+                this, &AppModule::onRecentFileThumbnailTaskEnded);
+
+    // Bounds the frequency of message() signals, whatever the count of emitted messages
+    m_timerMessageDelivery.setSingleShot(true);
+    m_timerMessageDelivery.setInterval(200);
+    QObject::connect(
+                &m_timerMessageDelivery, &QTimer::timeout,
+                this, &AppModule::deliverQueuedMessages);
 
     // System
     // -- Units
@@ -71,7 +118,35 @@ AppModule::AppModule(Application* app)
     settings->addSetting(&this->recentFiles, this->groupId_application);
     settings->addSetting(&this->lastOpenDir, this->groupId_application);
     settings->addSetting(&this->lastSelectedFormatFilter, this->groupId_application);
+    this->importMemoryBudget.setDescription(
+                tr("Memory in megabytes that files read concurrently are expected to use at most. "
+                   "Big files are then read one after the other, small ones concurrently. "
+                   "Zero means half of the physical memory"));
+    this->importMemoryBudget.setRange(0, INT_MAX);
+    this->importMemoryBudget.setSingleStep(512);
+    this->importMemoryBudget.setConstraintsEnabled(true);
+    this->importDeduplicateGeometry.setDescription(
+                tr("Merge identical parts(same topology and geometry, eg standard screws) found in "
+                   "the imported files into shared instances. Reduces meshing time, memory usage and "
+                   "size of exported files"));
     settings->addSetting(&this->linkWithDocumentSelector, this->groupId_application);
+    settings->addSetting(&this->importMemoryBudget, this->groupId_application);
+    settings->addSetting(&this->importDeduplicateGeometry, this->groupId_application);
+    this->importConcurrentModelTreeBuild.setDescription(
+                tr("Explore concurrently the assembly structures of the imported parts when adding "
+                   "them to the model tree. Speeds up import of documents having thousands of "
+                   "top-level parts"));
+    settings->addSetting(&this->importConcurrentModelTreeBuild, this->groupId_application);
+    this->importUseModelCache.setDescription(
+                tr("Store imported models(translated and meshed) in the cache folder and reuse them "
+                   "when the same file contents are opened again with the same import and meshing "
+                   "options, whatever the location of the file"));
+    this->cacheFolder.setDescription(
+                tr("Folder where meshes and imported models are cached. Can be a network folder "
+                   "shared by several users, only the first one opening a model then pays the cost "
+                   "of translation and meshing. Empty means the cache directory of the user"));
+    settings->addSetting(&this->importUseModelCache, this->groupId_application);
+    settings->addSetting(&this->cacheFolder, this->groupId_application);
     this->recentFiles.setUserVisible(false);
     this->lastOpenDir.setUserVisible(false);
     this->lastSelectedFormatFilter.setUserVisible(false);
@@ -91,10 +166,54 @@ AppModule::AppModule(Application* app)
                    "If activated, deflection used for the polygonalisation of each edge will be "
                    "`ChordalDeflection` &#215; `SizeOfEdge`. The deflection used for the faces will be "
                    "the maximum deflection of their edges."));
+    this->meshingInParallel.setDescription(
+                tr("Mesh faces of a shape concurrently, using all available processor cores"));
+    this->meshingUseCache.setDescription(
+                tr("Store computed meshes on disk and reuse them when the same shapes are opened "
+                   "again with the same meshing parameters"));
+    this->meshingLazy.setDescription(
+                tr("Don't mesh BRep shapes at import, but only when they have to be displayed. "
+                   "Meshing is then done in background and shapes appear once ready, which reduces "
+                   "the time to open huge assemblies"));
+    this->meshingProgressive.setDescription(
+                tr("With lazy meshing, shapes are first displayed with a very coarse mesh which "
+                   "is then refined in background to the configured quality"));
+    this->meshingProgressive.setEnabled(false);
+    this->meshingRepairOnImport.setDescription(
+                tr("Repair meshes imported from STL, OBJ, ... files: merge duplicated vertices, "
+                   "remove degenerate triangles and make orientation of triangles consistent. "
+                   "This reduces memory usage and gives correct volumes"));
+    this->meshingAdaptive.setDescription(
+                tr("Chordal deflection of each part is computed from its own size instead of the "
+                   "size of the whole model, within limits. Small parts like fasteners get fewer "
+                   "triangles while big parts keep the quality of the model"));
+    this->meshingTriangleBudget.setDescription(
+                tr("Maximum count of triangles expected for a model, meshing gets coarser when it "
+                   "would be exceeded. Zero means no limit"));
+    this->meshingTriangleBudget.setRange(0, INT_MAX);
+    this->meshingTriangleBudget.setSingleStep(100000);
+    this->meshingTriangleBudget.setConstraintsEnabled(true);
+    this->meshingSinglePrecision.setDescription(
+                tr("Store the nodes of meshes with single precision floats instead of double, "
+                   "which halves their memory. Precision is enough for display and most mesh "
+                   "exports. Requires OpenCascade 7.6 or later"));
+    this->meshingReorder.setDescription(
+                tr("Reorder the triangles of meshes so neighbor triangles are close in memory and "
+                   "share vertices already processed by the graphics card. Speeds up display of "
+                   "big meshes at the expense of meshing time"));
     settings->addSetting(&this->meshingQuality, this->groupId_meshing);
     settings->addSetting(&this->meshingChordalDeflection, this->groupId_meshing);
     settings->addSetting(&this->meshingAngularDeflection, this->groupId_meshing);
     settings->addSetting(&this->meshingRelative, this->groupId_meshing);
+    settings->addSetting(&this->meshingInParallel, this->groupId_meshing);
+    settings->addSetting(&this->meshingUseCache, this->groupId_meshing);
+    settings->addSetting(&this->meshingLazy, this->groupId_meshing);
+    settings->addSetting(&this->meshingProgressive, this->groupId_meshing);
+    settings->addSetting(&this->meshingRepairOnImport, this->groupId_meshing);
+    settings->addSetting(&this->meshingAdaptive, this->groupId_meshing);
+    settings->addSetting(&this->meshingTriangleBudget, this->groupId_meshing);
+    settings->addSetting(&this->meshingSinglePrecision, this->groupId_meshing);
+    settings->addSetting(&this->meshingReorder, this->groupId_meshing);
 
     // Graphics
     this->defaultShowOriginTrihedron.setDescription(
@@ -102,6 +221,35 @@ AppModule::AppModule(Application* app)
                    "This doesn't affect 3D view of currently opened documents"));
     settings->addSetting(&this->defaultShowOriginTrihedron, this->groupId_graphics);
     settings->addSetting(&this->instantZoomFactor, this->groupId_graphics);
+    this->asyncHiddenLineRemovalOn.setDescription(
+                tr("Compute hidden lines in background, the 3D view shows the previous result "
+                   "until the computation for the new camera orientation is done. Results are "
+                   "cached so going back to an already visited view is instant"));
+    settings->addSetting(&this->asyncHiddenLineRemovalOn, this->groupId_graphics);
+    this->staticBatchingOn.setDescription(
+                tr("Merge small parts sharing the same color into a few big graphics objects, so "
+                   "assemblies made of many parts are drawn faster. A part is displayed apart again "
+                   "once selected, hidden or exploded. Only applies to shaded display mode"));
+    settings->addSetting(&this->staticBatchingOn, this->groupId_graphics);
+    this->depthBufferPickingOn.setDescription(
+                tr("Read back the depth buffer of the 3D view when idle, so hovering empty areas "
+                   "costs nothing and only the part under the mouse cursor gets its selection data "
+                   "computed. Recommended for very big models"));
+    settings->addSetting(&this->depthBufferPickingOn, this->groupId_graphics);
+    this->presentationMemoryBudget.setDescription(
+                tr("Graphics memory in megabytes that the 3D presentations of all opened documents "
+                   "are expected to use at most. Beyond, parts hidden or outside of the 3D view are "
+                   "displayed as boxes and their presentation released, until they come back into "
+                   "view. Zero means unlimited"));
+    this->presentationMemoryBudget.setRange(0, INT_MAX);
+    this->presentationMemoryBudget.setSingleStep(256);
+    this->presentationMemoryBudget.setConstraintsEnabled(true);
+    settings->addSetting(&this->presentationMemoryBudget, this->groupId_graphics);
+    this->shapePagingOn.setDescription(
+                tr("Write the shapes of the models hidden for a while into temporary files, so they "
+                   "don't use memory. Shapes are read back once the models are shown again or "
+                   "exported. Recommended when many big models are opened at the same time"));
+    settings->addSetting(&this->shapePagingOn, this->groupId_graphics);
     // -- Clip planes
     this->clipPlanesCappingOn.setDescription(
                 tr("Enable capping of currently clipped graphics"));
@@ -115,6 +263,50 @@ AppModule::AppModule(Application* app)
     settings->addSetting(&this->meshDefaultsMaterial, this->sectionId_graphicsMeshDefaults);
     settings->addSetting(&this->meshDefaultsShowEdges, this->sectionId_graphicsMeshDefaults);
     settings->addSetting(&this->meshDefaultsShowNodes, this->sectionId_graphicsMeshDefaults);
+    this->meshDefaultsEdgeFeatureAngle.setDescription(
+                tr("Edges of meshes are shown only where the angle between adjacent triangles exceeds "
+                   "this value, along with free edges. All edges are shown if zero"));
+    settings->addSetting(&this->meshDefaultsEdgeFeatureAngle, this->sectionId_graphicsMeshDefaults);
+    // -- Culling
+    this->cullingFrustumOn.setDescription(
+                tr("Skip drawing of the graphics located outside of the 3D view"));
+    this->cullingSizeThreshold.setDescription(
+                tr("Skip drawing of the graphics whose size on screen is less than this count of "
+                   "pixels. Disabled if 0"));
+    this->cullingDynamicSizeThreshold.setDescription(
+                tr("Same as size culling but applied only while the 3D view is rotated or panned, "
+                   "so navigation stays fluid on big models. Disabled if 0"));
+    this->cullingAdaptiveRenderingOn.setDescription(
+                tr("Lower rendering quality while the 3D view is rotated or panned: no antialiasing, "
+                   "no hidden line removal and no capping of clip planes. Full quality is restored "
+                   "once the view stops moving"));
+    this->cullingOcclusionOn.setDescription(
+                tr("Skip drawing of the graphics entirely hidden behind others, eg interior parts of "
+                   "dense assemblies. Hidden graphics uncovered while the 3D view is rotated or "
+                   "panned might show up with a short delay"));
+    for (PropertyInt* prop : { &this->cullingSizeThreshold, &this->cullingDynamicSizeThreshold }) {
+        prop->setRange(0, 100);
+        prop->setSingleStep(1);
+        prop->setConstraintsEnabled(true);
+    }
+
+    settings->addSetting(&this->cullingFrustumOn, this->sectionId_graphicsCulling);
+    settings->addSetting(&this->cullingSizeThreshold, this->sectionId_graphicsCulling);
+    settings->addSetting(&this->cullingDynamicSizeThreshold, this->sectionId_graphicsCulling);
+    settings->addSetting(&this->cullingAdaptiveRenderingOn, this->sectionId_graphicsCulling);
+    settings->addSetting(&this->cullingOcclusionOn, this->sectionId_graphicsCulling);
+    // -- Transparency
+    this->transparencyMode.setDescription(
+                tr("Rendering of transparent objects\n"
+                   "'Unordered': transparent objects are blended in drawing order, artifacts are "
+                   "likely where they overlap\n"
+                   "'Performance': weighted blended order-independent transparency, interactive "
+                   "even with thousands of transparent parts\n"
+                   "'Quality': depth peeling order-independent transparency(requires OpenCascade "
+                   ">= v7.5), accurate but slower. Replaced by 'Performance' while the 3D view is "
+                   "rotated or panned if adaptive rendering is on"));
+    this->transparencyMode.mutableEnumeration().changeTrContext(AppModule::textIdContext());
+    settings->addSetting(&this->transparencyMode, this->sectionId_graphicsTransparency);
     // Import
     auto groupId_Import = settings->addGroup(textId("import"));
     for (IO::Format format : app->ioSystem()->readerFormats()) {
@@ -132,6 +324,14 @@ AppModule::AppModule(Application* app)
         }
     }
 
+    // Snapshot of the reader parameters of a format is outdated as soon as an import setting changes
+    QObject::connect(settings, &Settings::changed, this, [=](Property* setting) {
+        for (const auto& [format, group] : m_mapFormatReaderParameters) {
+            if (setting->group() == group)
+                this->invalidateReaderParametersSnapshot(format);
+        }
+    });
+
     // Export
     auto groupId_Export = settings->addGroup(textId("export"));
     for (IO::Format format : app->ioSystem()->writerFormats()) {
@@ -160,16 +360,35 @@ AppModule::AppModule(Application* app)
         this->lastOpenDir.setValue({});
         this->lastSelectedFormatFilter.setValue({});
         this->linkWithDocumentSelector.setValue(true);
+        this->importMemoryBudget.setValue(0);
+        this->importDeduplicateGeometry.setValue(false);
+        this->importConcurrentModelTreeBuild.setValue(false);
+        this->importUseModelCache.setValue(false);
+        this->cacheFolder.setValue({});
     });
     settings->addResetFunction(this->groupId_graphics, [=]{
         this->defaultShowOriginTrihedron.setValue(true);
         this->instantZoomFactor.setValue(5.);
+        this->asyncHiddenLineRemovalOn.setValue(true);
+        this->staticBatchingOn.setValue(false);
+        this->depthBufferPickingOn.setValue(false);
+        this->presentationMemoryBudget.setValue(0);
+        this->shapePagingOn.setValue(false);
     });
     settings->addResetFunction(this->groupId_meshing, [&]{
         this->meshingQuality.setValue(BRepMeshQuality::Normal);
         this->meshingChordalDeflection.setQuantity(1 * Quantity_Millimeter);
         this->meshingAngularDeflection.setQuantity(20 * Quantity_Degree);
         this->meshingRelative.setValue(false);
+        this->meshingInParallel.setValue(true);
+        this->meshingUseCache.setValue(true);
+        this->meshingLazy.setValue(false);
+        this->meshingProgressive.setValue(true);
+        this->meshingRepairOnImport.setValue(false);
+        this->meshingAdaptive.setValue(false);
+        this->meshingTriangleBudget.setValue(0);
+        this->meshingSinglePrecision.setValue(false);
+        this->meshingReorder.setValue(false);
     });
     settings->addResetFunction(this->sectionId_graphicsClipPlanes, [=]{
         this->clipPlanesCappingOn.setValue(true);
@@ -182,6 +401,17 @@ AppModule::AppModule(Application* app)
         this->meshDefaultsMaterial.setValue(meshDefaults.material);
         this->meshDefaultsShowEdges.setValue(meshDefaults.showEdges);
         this->meshDefaultsShowNodes.setValue(meshDefaults.showNodes);
+        this->meshDefaultsEdgeFeatureAngle.setQuantity(meshDefaults.edgeFeatureAngle * Quantity_Radian);
+    });
+    settings->addResetFunction(this->sectionId_graphicsCulling, [=]{
+        this->cullingFrustumOn.setValue(true);
+        this->cullingSizeThreshold.setValue(0);
+        this->cullingDynamicSizeThreshold.setValue(0);
+        this->cullingAdaptiveRenderingOn.setValue(true);
+        this->cullingOcclusionOn.setValue(false);
+    });
+    settings->addResetFunction(this->sectionId_graphicsTransparency, [=]{
+        this->transparencyMode.setValue(TransparencyMode::Performance);
     });
 }
 
@@ -212,6 +442,14 @@ bool AppModule::excludeSettingPredicate(const Property& prop)
     return !prop.isUserVisible();
 }
 
+bool AppModule::isGuiSetting(const Property& prop) const
+{
+    if (&prop == &this->linkWithDocumentSelector || !prop.isUserVisible())
+        return true;
+
+    return m_app->settings()->findProperty(&prop).group() == this->groupId_graphics;
+}
+
 const PropertyGroup* AppModule::findReaderParameters(IO::Format format) const
 {
     auto it = m_mapFormatReaderParameters.find(format);
@@ -263,7 +501,29 @@ void AppModule::emitMessage(Messenger::MessageType msgType, const QString& text)
         m_messageLog.push_back({ msgType, text });
     }
 
-    emit this->message(msgType, text);
+    // Emitting thread might not run an event loop, so the timer is started from the main thread
+    if (m_messageQueue.push(msgType, text))
+        QMetaObject::invokeMethod(&m_timerMessageDelivery, "start", Qt::QueuedConnection);
+}
+
+void AppModule::deliverQueuedMessages()
+{
+    const MessageBatchQueue::Batch batch = m_messageQueue.takeBatch();
+    for (const MessageBatchQueue::Item& item : batch.items) {
+        if (item.repeatCount > 1) {
+            const QString text = item.message.text + "\n" + tr("(repeated %n times)", nullptr, item.repeatCount);
+            emit this->message(item.message.type, text);
+        }
+        else {
+            emit this->message(item.message.type, item.message.text);
+        }
+    }
+
+    for (int i = 0; i < int(std::size(batch.discardedCount)); ++i) {
+        const int count = batch.discardedCount[i];
+        if (count > 0)
+            emit this->message(MessageType(i), tr("%n other message(s) not shown", nullptr, count));
+    }
 }
 
 void AppModule::clearMessageLog()
@@ -312,58 +572,147 @@ const RecentFile* AppModule::findRecentFile(const FilePath& fp) const
 
 void AppModule::recordRecentFileThumbnail(GuiDocument* guiDoc)
 {
-    if (!guiDoc)
+    const TaskId taskId = this->startRecentFileThumbnailTask(guiDoc);
+    if (taskId != 0)
+        m_thumbnailTaskMgr.run(taskId);
+}
+
+void AppModule::recordRecentFileThumbnails(GuiApplication* guiApp)
+{
+    if (!guiApp)
         return;
 
-    const RecentFile* recentFile = this->findRecentFile(guiDoc->document()->filePath());
+    std::vector<TaskId> vecTaskId;
+    for (GuiDocument* guiDoc : guiApp->guiDocuments()) {
+        const TaskId taskId = this->startRecentFileThumbnailTask(guiDoc);
+        if (taskId != 0) {
+            vecTaskId.push_back(taskId);
+            m_thumbnailTaskMgr.run(taskId);
+        }
+    }
+
+    // Typically called once event loop is over, so TaskManager::ended() signals won't be delivered
+    m_thumbnailTaskMgr.waitForAll(vecTaskId);
+    for (TaskId taskId : vecTaskId)
+        this->onRecentFileThumbnailTaskEnded(taskId);
+}
+
+ModelCache AppModule::modelCache() const
+{
+    return this->importUseModelCache ? m_modelCache : ModelCache();
+}
+
+QByteArray AppModule::importParametersFingerprint() const
+{
+    QByteArray bytes;
+    QDataStream stream(&bytes, QIODevice::WriteOnly);
+    auto fnAddProperty = [&](const Property* prop) {
+        stream << prop->name().key << this->toVariant(*prop);
+    };
+    // Formats are iterated in a stable order, unlike m_mapFormatReaderParameters
+    for (IO::Format format : m_app->ioSystem()->readerFormats()) {
+        const PropertyGroup* group = this->findReaderParameters(format);
+        if (group) {
+            for (const Property* prop : group->properties())
+                fnAddProperty(prop);
+        }
+    }
+
+    fnAddProperty(&this->importDeduplicateGeometry);
+    const Settings* settings = m_app->settings();
+    for (int iSection = 0; iSection < settings->sectionCount(this->groupId_meshing); ++iSection) {
+        const Settings_SectionIndex sectionId(this->groupId_meshing, iSection);
+        for (int iSetting = 0; iSetting < settings->settingCount(sectionId); ++iSetting) {
+            const Property* prop = settings->property(Settings_SettingIndex(sectionId, iSetting));
+            // Options not affecting the resulting triangulations
+            if (prop != &this->meshingInParallel && prop != &this->meshingUseCache)
+                fnAddProperty(prop);
+        }
+    }
+
+    return bytes;
+}
+
+FilePath AppModule::recentFileThumbnailFilepath(const FilePath& fp) const
+{
+    if (m_thumbnailCacheDirPath.empty())
+        return {};
+
+    const QByteArray pathUtf8 = filepathTo<QFileInfo>(fp).absoluteFilePath().toUtf8();
+    const QByteArray hash = QCryptographicHash::hash(pathUtf8, QCryptographicHash::Md5).toHex();
+    return m_thumbnailCacheDirPath / (hash.toStdString() + ".png");
+}
+
+TaskId AppModule::startRecentFileThumbnailTask(GuiDocument* guiDoc)
+{
+    if (!guiDoc)
+        return 0;
+
+    const FilePath docFilepath = guiDoc->document()->filePath();
+    const RecentFile* recentFile = this->findRecentFile(docFilepath);
     if (!recentFile)
-        return;
+        return 0;
 
-    if (!recentFile->isThumbnailOutOfSync())
-        return;
+    const FilePath thumbnailFilepath = this->recentFileThumbnailFilepath(recentFile->filepath);
+    if (thumbnailFilepath.empty())
+        return 0;
 
-    RecentFile newRecentFile = *recentFile;
-    const bool okRecord = newRecentFile.recordThumbnail(guiDoc, this->recentFileThumbnailSize());
-    if (!okRecord)
-        return;
+    // Thumbnail file could have been deleted along with cache directory
+    if (!recentFile->isThumbnailOutOfSync() && filepathExists(thumbnailFilepath))
+        return 0;
 
-    const RecentFiles& listRecentFile = this->recentFiles.value();
-    RecentFiles newListRecentFile = listRecentFile;
-    const auto indexRecentFile = std::distance(&listRecentFile.front(), recentFile);
-    newListRecentFile.at(indexRecentFile) = newRecentFile;
-    this->recentFiles.setValue(newListRecentFile);
+    const bool isPending = std::any_of(
+                m_mapThumbnailTask.cbegin(), m_mapThumbnailTask.cend(), [&](const auto& mapPair) {
+        return filepathEquivalent(mapPair.second.filepath, recentFile->filepath);
+    });
+    if (isPending)
+        return 0;
+
+    // Rendering requires the GUI thread, only PNG encoding and file writing are done in background
+    GuiImageRenderer::Parameters params;
+    params.size = this->recentFileThumbnailSize();
+    params.backgroundColor = mayoTheme()->color(Theme::Color::Palette_Window);
+    const GuiImageRenderer renderer(params);
+    const QImage img = renderer.render(guiDoc, guiDoc->graphicsScene()->v3dViewer()->DefaultViewProj());
+    if (img.isNull())
+        return 0;
+
+    auto okWrite = std::make_shared<bool>(false);
+    const TaskId taskId = m_thumbnailTaskMgr.newTask([=](TaskProgress*) {
+        std::error_code ec;
+        std::filesystem::create_directories(thumbnailFilepath.parent_path(), ec);
+        *okWrite = img.save(filepathTo<QString>(thumbnailFilepath), "PNG");
+    });
+    const int64_t timestamp = RecentFile::lastModifiedTimestamp(recentFile->filepath);
+    m_mapThumbnailTask.insert({ taskId, ThumbnailTask{ recentFile->filepath, timestamp, okWrite } });
+    return taskId;
 }
 
-void AppModule::recordRecentFileThumbnails(GuiApplication* guiApp)
+void AppModule::onRecentFileThumbnailTaskEnded(TaskId taskId)
 {
-    if (!guiApp)
+    auto itTask = m_mapThumbnailTask.find(taskId);
+    if (itTask == m_mapThumbnailTask.end())
         return;
 
+    const ThumbnailTask task = itTask->second;
+    m_mapThumbnailTask.erase(itTask);
+    const RecentFile* recentFile = this->findRecentFile(task.filepath);
+    if (!recentFile || !*task.okWrite)
+        return; // Recent file was removed from the list in the meantime, or write failed
+
     const RecentFiles& listRecentFile = this->recentFiles.value();
     RecentFiles newListRecentFile = listRecentFile;
-    for (GuiDocument* guiDoc : guiApp->guiDocuments()) {
-        const RecentFile* recentFile = this->findRecentFile(guiDoc->document()->filePath());
-        if (!recentFile || !recentFile->isThumbnailOutOfSync())
-            continue; // Skip
-
-        RecentFile newRecentFile = *recentFile;
-        if (newRecentFile.recordThumbnail(guiDoc, this->recentFileThumbnailSize())) {
-            auto indexRecentFile = std::distance(&listRecentFile.front(), recentFile);
-            newListRecentFile.at(indexRecentFile) = newRecentFile;
-        }
-    }
-
+    const auto indexRecentFile = std::distance(&listRecentFile.front(), recentFile);
+    newListRecentFile.at(indexRecentFile).thumbnailTimestamp = task.timestamp;
     this->recentFiles.setValue(newListRecentFile);
 }
 
-static QuantityLength shapeChordalDeflection(const TopoDS_Shape& shape)
+static QuantityLength shapeChordalDeflection(const Bnd_Box& shapeBndBox)
 {
     // Excerpted from Prs3d::GetDeflection(...)
     constexpr QuantityLength baseDeviation = 1 * Quantity_Millimeter;
 
-    Bnd_Box bndBox;
-    constexpr bool useTriangulation = true;
-    BRepBndLib::Add(shape, bndBox, !useTriangulation);
+    Bnd_Box bndBox = shapeBndBox;
     if (bndBox.IsVoid())
         return baseDeviation;
 
@@ -380,10 +729,37 @@ static QuantityLength shapeChordalDeflection(const TopoDS_Shape& shape)
     return 4 * diagMaxComp * baseDeviation;
 }
 
+// Count of triangles in the triangulations of the faces of 'shape'
+static int64_t shapeTriangleCount(const TopoDS_Shape& shape)
+{
+    int64_t count = 0;
+    BRepUtils::forEachSubFace(shape, [&](const TopoDS_Face& face) {
+        TopLoc_Location loc;
+        const Handle_Poly_Triangulation& triangulation = BRep_Tool::Triangulation(face, loc);
+        if (!triangulation.IsNull())
+            count += triangulation->NbTriangles();
+    });
+    return count;
+}
+
 OccBRepMeshParameters AppModule::brepMeshParameters(const TopoDS_Shape& shape) const
+{
+    return this->brepMeshParameters(BndBoxCache::shapeBox(shape));
+}
+
+OccBRepMeshParameters AppModule::brepMeshParameters(const TDF_Label& labelShape) const
+{
+    const DocumentPtr doc = Document::findFrom(labelShape);
+    if (doc.IsNull())
+        return this->brepMeshParameters(XCaf::shape(labelShape));
+
+    return this->brepMeshParameters(doc->bndBoxCache().labelBox(labelShape));
+}
+
+OccBRepMeshParameters AppModule::brepMeshParameters(const Bnd_Box& shapeBndBox) const
 {
     OccBRepMeshParameters params;
-    params.InParallel = true;
+    params.InParallel = this->meshingInParallel;
 #if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 5, 0)
     params.AllowQualityDecrease = true;
 #endif
@@ -409,7 +785,7 @@ OccBRepMeshParameters AppModule::brepMeshParameters(const TopoDS_Shape& shape) c
             return { 1, 1 };
         };
         const Coefficients coeffs = fnCoefficients(this->meshingQuality);
-        params.Deflection = UnitSystem::meters(coeffs.chordalDeflection * shapeChordalDeflection(shape));
+        params.Deflection = UnitSystem::meters(coeffs.chordalDeflection * shapeChordalDeflection(shapeBndBox));
         params.Angle = UnitSystem::radians(coeffs.angularDeflection * (20 * Quantity_Degree));
     }
 
@@ -423,8 +799,295 @@ void AppModule::computeBRepMesh(const TopoDS_Shape& shape, TaskProgress* progres
 
 void AppModule::computeBRepMesh(const TDF_Label& labelEntity, TaskProgress* progress)
 {
-    if (XCaf::isShape(labelEntity))
-        this->computeBRepMesh(XCaf::shape(labelEntity), progress);
+    if (!XCaf::isShape(labelEntity))
+        return;
+
+    // Mesh each part prototype once, instead of exploring all the component instances
+    // Mesh parameters are computed from the whole entity so quality is uniform across prototypes,
+    // unless adaptive meshing is on
+    int referenceCount = 0;
+    const TDF_LabelSequence seqPrototype = XCaf::shapePrototypes(labelEntity, &referenceCount);
+    OccBRepMeshParameters entityParams = this->brepMeshParameters(labelEntity);
+    // Prototypes are independent so they're meshed concurrently, then BRepMesh concurrency is only
+    // needed for single-prototype entities
+    if (seqPrototype.Size() > 1)
+        entityParams.InParallel = false;
+
+    const int64_t triangleBudget = this->meshingTriangleBudget.value();
+    std::atomic<int64_t> triangleCount = 0;
+    std::atomic<int> processedPrototypeCount = 0;
+    std::atomic<int> cachedPrototypeCount = 0;
+    std::atomic<int> meshedPrototypeCount = 0;
+    // Multiplies deflections when triangle budget would be exceeded, count of triangles being
+    // projected from the prototypes processed so far
+    auto fnBudgetFactor = [&]{
+        const int processedCount = processedPrototypeCount.load();
+        if (triangleBudget <= 0 || processedCount == 0)
+            return 1.;
+
+        // Count of triangles is roughly inversely proportional to the chordal deflection
+        const double projectedCount = triangleCount.load() * (double(seqPrototype.Size()) / processedCount);
+        return std::clamp(projectedCount / triangleBudget, 1., 8.);
+    };
+    TaskManager::runConcurrently(seqPrototype.Size(), progress, [&](int iPrototype, TaskProgress* subProgress) {
+        const TDF_Label& labelPrototype = seqPrototype.Value(iPrototype + 1);
+        const TopoDS_Shape shapePrototype = XCaf::shape(labelPrototype);
+        OccBRepMeshParameters params = entityParams;
+        if (this->meshingAdaptive && !params.Relative) {
+            // Tiny parts don't go below a tenth of the entity deflection, big parts don't go
+            // above the entity deflection
+            const double deflection = this->brepMeshParameters(labelPrototype).Deflection;
+            params.Deflection = std::clamp(deflection, entityParams.Deflection / 10., entityParams.Deflection);
+        }
+
+        params.Deflection *= fnBudgetFactor();
+        auto fnPrototypeProcessed = [&]{
+            if (triangleBudget > 0)
+                triangleCount += shapeTriangleCount(shapePrototype);
+
+            ++processedPrototypeCount;
+        };
+
+        // Triangulation might already be there(eg restored from a binary Mayo document)
+        if (BRepTools::Triangulation(shapePrototype, params.Deflection)) {
+            ++meshedPrototypeCount;
+            fnPrototypeProcessed();
+            return;
+        }
+
+        QByteArray cacheKey;
+        if (this->meshingUseCache) {
+            cacheKey = MeshCache::key(shapePrototype, params);
+            if (m_meshCache.load(cacheKey, shapePrototype)) {
+                ++cachedPrototypeCount;
+                fnPrototypeProcessed();
+                return;
+            }
+        }
+
+        BRepUtils::computeMesh(shapePrototype, params, subProgress);
+        if (TaskProgress::isAbortRequested(subProgress))
+            return;
+
+        // Reordered before being cached, so meshes loaded from cache don't need it
+        if (this->meshingReorder)
+            MeshReorder::reorderShape(shapePrototype, MeshReorder::Options());
+
+        if (!cacheKey.isEmpty())
+            m_meshCache.save(cacheKey, shapePrototype);
+
+        fnPrototypeProcessed();
+    });
+    if (TaskProgress::isAbortRequested(progress))
+        return;
+
+    const double budgetFactor = fnBudgetFactor();
+    this->compactTriangulations(labelEntity);
+    // Triangulation presence flags of the indexed sub-shapes are outdated
+    const DocumentPtr doc = Document::findFrom(labelEntity);
+    if (!doc.IsNull())
+        doc->subShapeCache().forget(labelEntity);
+    if (budgetFactor > 1.)
+        this->emitTrace(tr("Meshing coarsened by %1 to fit triangle budget").arg(budgetFactor, 0, 'f', 2));
+
+    if (cachedPrototypeCount > 0)
+        this->emitTrace(tr("%1 prototype mesh(es) loaded from cache").arg(cachedPrototypeCount.load()));
+
+    if (meshedPrototypeCount > 0)
+        this->emitTrace(tr("%1 prototype(s) already meshed").arg(meshedPrototypeCount.load()));
+
+    const int skippedInstanceCount = std::max(0, referenceCount - seqPrototype.Size());
+    if (skippedInstanceCount > 0) {
+        this->emitTrace(tr("%1 prototype(s) meshed, %2 component instance(s) skipped")
+                        .arg(seqPrototype.Size()).arg(skippedInstanceCount));
+    }
+}
+
+void AppModule::computeBRepMeshLod(const TDF_Label& labelEntity, int lodLevel, TaskProgress* progress)
+{
+    if (!XCaf::isShape(labelEntity))
+        return;
+
+    OccBRepMeshParameters params = this->brepMeshParameters(labelEntity);
+    const double factor = std::pow(2., lodLevel);
+    params.Deflection *= factor;
+    params.Angle = std::min(params.Angle * factor, UnitSystem::radians(80 * Quantity_Degree));
+    // Concurrency is handled at prototype level
+    params.InParallel = false;
+    const TDF_LabelSequence seqPrototype = XCaf::shapePrototypes(labelEntity);
+    TaskManager::runConcurrently(seqPrototype.Size(), progress, [&](int iPrototype, TaskProgress* taskProgress) {
+        const TopoDS_Shape shapePrototype = XCaf::shape(seqPrototype.Value(iPrototype + 1));
+        BRepTools::Clean(shapePrototype); // Otherwise existing finer triangulations are kept
+        BRepUtils::computeMesh(shapePrototype, params, taskProgress);
+        if (this->meshingReorder)
+            MeshReorder::reorderShape(shapePrototype, MeshReorder::Options());
+    });
+    this->compactTriangulations(labelEntity);
+    // Triangulation presence flags of the indexed sub-shapes are outdated
+    const DocumentPtr doc = Document::findFrom(labelEntity);
+    if (!doc.IsNull())
+        doc->subShapeCache().forget(labelEntity);
+}
+
+void AppModule::repairImportedMesh(const TDF_Label& labelEntity, TaskProgress* progress)
+{
+    if (!this->meshingRepairOnImport)
+        return;
+
+    const MeshRepair::Report report = MeshRepair::repairLabel(labelEntity, MeshRepair::Options(), progress);
+    if (report.isModified()) {
+        this->emitInfo(tr("Mesh repair of '%1': %2 nodes and %3 triangles removed, %4 triangles flipped, %5 saved")
+                       .arg(to_QString(CafUtils::labelAttrStdName(labelEntity)))
+                       .arg(report.removedNodeCount)
+                       .arg(report.removedTriangleCount)
+                       .arg(report.flippedTriangleCount)
+                       .arg(QStringUtils::bytesText(std::max<int64_t>(0, report.savedBytes()))));
+    }
+}
+
+void AppModule::compactTriangulations(const TDF_Label& labelEntity)
+{
+    if (!this->meshingSinglePrecision)
+        return;
+
+    uint64_t savedBytes = 0;
+    auto attrTriangulation = CafUtils::findAttribute<TDataXtd_Triangulation>(labelEntity);
+    if (attrTriangulation) {
+        savedBytes += MeshUtils::compactTriangulation(attrTriangulation->Get());
+    }
+    else if (XCaf::isShape(labelEntity)) {
+        // Triangulations shared by faces are compacted once, as they're then already single precision
+        for (const TDF_Label& labelPrototype : XCaf::shapePrototypes(labelEntity)) {
+            for (TopExp_Explorer expl(XCaf::shape(labelPrototype), TopAbs_FACE); expl.More(); expl.Next()) {
+                TopLoc_Location loc;
+                savedBytes += MeshUtils::compactTriangulation(BRep_Tool::Triangulation(TopoDS::Face(expl.Current()), loc));
+            }
+        }
+    }
+
+    if (savedBytes > 0)
+        this->emitTrace(tr("Meshes stored in single precision, %1 saved").arg(QStringUtils::bytesText(savedBytes)));
+}
+
+void AppModule::reorderTriangulations(const TDF_Label& labelEntity, TaskProgress* progress)
+{
+    if (!this->meshingReorder)
+        return;
+
+    MeshReorder::reorderLabel(labelEntity, MeshReorder::Options(), progress);
+}
+
+std::function<void()> AppModule::computeBRepMeshRefinement(const TDF_Label& labelShape, TaskProgress* progress)
+{
+    if (!XCaf::isShape(labelShape))
+        return {};
+
+    struct FaceMesh {
+        TopoDS_Face face;
+        TopLoc_Location loc;
+        Handle_Poly_Triangulation triangulation;
+        std::vector<std::pair<TopoDS_Edge, Handle_Poly_PolygonOnTriangulation>> vecEdgePolygon;
+    };
+    auto vecPrototypeShape = std::make_shared<std::vector<TopoDS_Shape>>();
+    auto vecFaceMesh = std::make_shared<std::vector<FaceMesh>>();
+    const TDF_LabelSequence seqPrototype = XCaf::shapePrototypes(labelShape);
+    const double subPortionSize = 100. / std::max(1, seqPrototype.Size());
+    for (const TDF_Label& labelPrototype : seqPrototype) {
+        TaskProgress subProgress(progress, subPortionSize);
+        const TopoDS_Shape shape = XCaf::shape(labelPrototype);
+        // Geometry is shared, only topology is copied so BRepMesh stores triangulations in the copy
+        const TopoDS_Shape shapeCopy = BRepBuilderAPI_Copy(shape, false, false).Shape();
+        const OccBRepMeshParameters params = this->brepMeshParameters(labelPrototype);
+        QByteArray cacheKey;
+        if (this->meshingUseCache)
+            cacheKey = MeshCache::key(shape, params);
+
+        if (cacheKey.isEmpty() || !m_meshCache.load(cacheKey, shapeCopy)) {
+            BRepUtils::computeMesh(shapeCopy, params, &subProgress);
+            if (TaskProgress::isAbortRequested(progress))
+                return {};
+
+            if (this->meshingReorder)
+                MeshReorder::reorderShape(shapeCopy, MeshReorder::Options());
+
+            if (!cacheKey.isEmpty())
+                m_meshCache.save(cacheKey, shapeCopy);
+        }
+
+        // Copy has the same topology, faces and edges are then explored in the same order
+        TopTools_IndexedMapOfShape mapFace;
+        TopTools_IndexedMapOfShape mapFaceCopy;
+        TopExp::MapShapes(shape, TopAbs_FACE, mapFace);
+        TopExp::MapShapes(shapeCopy, TopAbs_FACE, mapFaceCopy);
+        if (mapFace.Extent() != mapFaceCopy.Extent())
+            continue;
+
+        vecPrototypeShape->push_back(shape);
+        for (int i = 1; i <= mapFaceCopy.Extent(); ++i) {
+            const TopoDS_Face& faceCopy = TopoDS::Face(mapFaceCopy.FindKey(i));
+            FaceMesh faceMesh;
+            faceMesh.face = TopoDS::Face(mapFace.FindKey(i));
+            faceMesh.triangulation = BRep_Tool::Triangulation(faceCopy, faceMesh.loc);
+            if (!faceMesh.triangulation)
+                continue;
+
+            if (this->meshingSinglePrecision)
+                MeshUtils::compactTriangulation(faceMesh.triangulation);
+
+            // Polygons of the edges, used by the display of face boundaries
+            TopExp_Explorer expEdge(faceMesh.face, TopAbs_EDGE);
+            TopExp_Explorer expEdgeCopy(faceCopy, TopAbs_EDGE);
+            for (; expEdge.More() && expEdgeCopy.More(); expEdge.Next(), expEdgeCopy.Next()) {
+                const TopoDS_Edge& edgeCopy = TopoDS::Edge(expEdgeCopy.Current());
+                auto polygon = BRep_Tool::PolygonOnTriangulation(edgeCopy, faceMesh.triangulation, faceMesh.loc);
+                if (polygon)
+                    faceMesh.vecEdgePolygon.push_back({ TopoDS::Edge(expEdge.Current()), polygon });
+            }
+
+            vecFaceMesh->push_back(std::move(faceMesh));
+        }
+    }
+
+    return [=]{
+        for (const TopoDS_Shape& shape : *vecPrototypeShape)
+            BRepTools::Clean(shape); // Removes coarse triangulations along with their edge polygons
+
+        BRep_Builder builder;
+        for (const FaceMesh& faceMesh : *vecFaceMesh) {
+            builder.UpdateFace(faceMesh.face, faceMesh.triangulation);
+            for (const auto& [edge, polygon] : faceMesh.vecEdgePolygon)
+                builder.UpdateEdge(edge, polygon, faceMesh.triangulation, faceMesh.loc);
+        }
+    };
+}
+
+bool AppModule::shapeHealingRequired(IO::Format format) const
+{
+    const PropertyGroup* params = this->findReaderParameters(format);
+    if (!params)
+        return false;
+
+    for (const Property* prop : params->properties()) {
+        if (prop->name().key == "healShapes" && isType<PropertyBool>(prop))
+            return constRef<PropertyBool>(*prop).value();
+    }
+
+    return false;
+}
+
+void AppModule::healImportedShapes(const TDF_Label& labelEntity, IO::Format format, TaskProgress* progress)
+{
+    if (!this->shapeHealingRequired(format))
+        return;
+
+    const ShapeHealing::Report report = ShapeHealing::healLabel(labelEntity, ShapeHealing::Options(), progress);
+    if (report.isModified()) {
+        this->emitInfo(tr("Shape healing of '%1': %2 part(s) fixed, %3 solid(s) and %4 face(s) modified")
+                       .arg(to_QString(CafUtils::labelAttrStdName(labelEntity)))
+                       .arg(report.healedShapeCount)
+                       .arg(report.modifiedSolidCount)
+                       .arg(report.modifiedFaceCount));
+    }
 }
 
 AppModule* AppModule::get(const ApplicationPtr& app)
@@ -435,13 +1098,26 @@ AppModule* AppModule::get(const ApplicationPtr& app)
     return nullptr;
 }
 
+void AppModule::updateCacheDirPaths()
+{
+    // Thumbnails relate to the recent files of the user, so they always stay in the user cache
+    // directory, unlike meshes and models which can be shared
+    QString cacheDir = QString::fromStdString(this->cacheFolder.value());
+    if (cacheDir.isEmpty())
+        cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+
+    m_meshCache.setDirPath(!cacheDir.isEmpty() ? filepathFrom(cacheDir + "/meshes") : FilePath());
+    m_modelCache.setDirPath(!cacheDir.isEmpty() ? filepathFrom(cacheDir + "/models") : FilePath());
+}
+
 void AppModule::onPropertyChanged(Property* prop)
 {
     if (prop == &this->meshDefaultsColor
             || prop == &this->meshDefaultsEdgeColor
             || prop == &this->meshDefaultsMaterial
             || prop == &this->meshDefaultsShowEdges
-            || prop == &this->meshDefaultsShowNodes)
+            || prop == &this->meshDefaultsShowNodes
+            || prop == &this->meshDefaultsEdgeFeatureAngle)
     {
         auto values = GraphicsMeshObjectDriver::defaultValues();
         values.color = this->meshDefaultsColor.value();
@@ -449,8 +1125,40 @@ void AppModule::onPropertyChanged(Property* prop)
         values.material = static_cast<Graphic3d_NameOfMaterial>(this->meshDefaultsMaterial.value());
         values.showEdges = this->meshDefaultsShowEdges.value();
         values.showNodes = this->meshDefaultsShowNodes.value();
+        values.edgeFeatureAngle = UnitSystem::radians(this->meshDefaultsEdgeFeatureAngle.quantity());
         GraphicsMeshObjectDriver::setDefaultValues(values);
     }
+    else if (prop == &this->meshingLazy || prop == &this->meshingProgressive) {
+        GraphicsShapeObjectDriver::MeshFunction fnMesh;
+        GraphicsShapeObjectDriver::RefineMeshFunction fnRefine;
+        if (this->meshingLazy && this->meshingProgressive) {
+            // Coarse tessellation first(deflection multiplied by 8), refined afterwards
+            fnMesh = [=](const TDF_Label& label, TaskProgress* progress) {
+                this->computeBRepMeshLod(label, 3, progress);
+            };
+            fnRefine = [=](const TDF_Label& label, TaskProgress* progress) {
+                return this->computeBRepMeshRefinement(label, progress);
+            };
+        }
+        else if (this->meshingLazy) {
+            fnMesh = [=](const TDF_Label& label, TaskProgress* progress) {
+                this->computeBRepMesh(label, progress);
+            };
+        }
+
+        GraphicsShapeObjectDriver::setLazyMeshFunction(std::move(fnMesh));
+        GraphicsShapeObjectDriver::setRefineMeshFunction(std::move(fnRefine));
+        this->meshingProgressive.setEnabled(this->meshingLazy);
+    }
+    else if (prop == &this->cacheFolder) {
+        this->updateCacheDirPaths();
+    }
+    else if (prop == &this->importMemoryBudget) {
+        m_app->ioSystem()->setImportMemoryBudget(uint64_t(this->importMemoryBudget.value()) * 1024 * 1024);
+    }
+    else if (prop == &this->asyncHiddenLineRemovalOn) {
+        GraphicsAsyncHlr::globalInstance()->setEnabled(this->asyncHiddenLineRemovalOn);
+    }
     else if (prop == &this->meshingQuality) {
         const bool isUserDefined = this->meshingQuality.value() == BRepMeshQuality::UserDefined;
         this->meshingChordalDeflection.setEnabled(isUserDefined);
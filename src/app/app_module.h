@@ -10,7 +10,9 @@
 
 #include "../base/application_ptr.h"
 #include "../base/io_parameters_provider.h"
+#include "../base/mesh_cache.h"
 #include "../base/messenger.h"
+#include "../base/model_cache.h"
 #include "../base/occ_brep_mesh_parameters.h"
 #include "../base/occt_enums.h"
 #include "../base/property.h"
@@ -19,10 +21,15 @@
 #include "../base/property_value_conversion.h"
 #include "../base/qtcore_hfuncs.h"
 #include "../base/settings_index.h"
+#include "../base/task_manager.h"
 #include "../base/unit_system.h"
 #include "qstring_utils.h"
 
+#include <Bnd_Box.hxx>
 #include <QtCore/QObject>
+#include <QtCore/QTimer>
+#include <TDF_Label.hxx>
+#include <functional>
 #include <mutex>
 #include <unordered_map>
 #include <vector>
@@ -55,16 +62,64 @@ public:
     static QByteArray languageCode(const ApplicationPtr& app);
 
     static bool excludeSettingPredicate(const Property& prop);
+    // Whether 'prop' is a setting used only by the GUI(graphics, recent files, ...), such settings
+    // aren't loaded by the command-line modes not requiring GUI
+    bool isGuiSetting(const Property& prop) const;
 
     void prependRecentFile(const FilePath& fp);
     const RecentFile* findRecentFile(const FilePath& fp) const;
+    // Thumbnail images are rendered in the GUI thread, then saved to files in background
     void recordRecentFileThumbnail(GuiDocument* guiDoc);
+    // Same as recordRecentFileThumbnail() for all documents, but blocks until files are written
     void recordRecentFileThumbnails(GuiApplication* guiApp);
     QSize recentFileThumbnailSize() const { return { 190, 150 }; }
+    // Path of the thumbnail image file in cache directory, that file may not exist
+    FilePath recentFileThumbnailFilepath(const FilePath& fp) const;
+
+    // Cache of the models imported with option 'importUseModelCache', null cache if option is off
+    ModelCache modelCache() const;
+    // Fingerprint of the settings affecting the contents of an imported document(reader parameters,
+    // geometry deduplication and meshing), see ModelCache::key()
+    QByteArray importParametersFingerprint() const;
 
     OccBRepMeshParameters brepMeshParameters(const TopoDS_Shape& shape) const;
+    // Bounding box of the shape is taken from Document::bndBoxCache()
+    OccBRepMeshParameters brepMeshParameters(const TDF_Label& labelShape) const;
+    // Chordal deflection is relative to the size of 'shapeBndBox'
+    OccBRepMeshParameters brepMeshParameters(const Bnd_Box& shapeBndBox) const;
     void computeBRepMesh(const TopoDS_Shape& shape, TaskProgress* progress = nullptr);
+    // Prototypes of the entity are meshed once. With option 'meshingAdaptive' deflection of each
+    // prototype is relative to its own size, capped by the deflection of the whole entity
+    // Deflections are increased along the way when option 'meshingTriangleBudget' would be exceeded
     void computeBRepMesh(const TDF_Label& labelEntity, TaskProgress* progress = nullptr);
+    // Replaces the triangulations of entity prototypes by coarser ones, deflections being multiplied
+    // by 2^lodLevel. Prototypes are meshed concurrently
+    void computeBRepMeshLod(const TDF_Label& labelEntity, int lodLevel, TaskProgress* progress = nullptr);
+
+    // Repairs the triangulations of an entity imported from a mesh format(see MeshRepair), memory
+    // saved is reported as an info message. Does nothing if option 'meshingRepairOnImport' is off
+    void repairImportedMesh(const TDF_Label& labelEntity, TaskProgress* progress = nullptr);
+
+    // Stores the triangulations of an entity in single precision(see
+    // MeshUtils::compactTriangulation()), memory saved is reported as a trace message
+    // Does nothing if option 'meshingSinglePrecision' is off
+    void compactTriangulations(const TDF_Label& labelEntity);
+
+    // Reorders the triangulations of an entity for memory locality and GPU vertex cache reuse(see
+    // MeshReorder). Does nothing if option 'meshingReorder' is off
+    void reorderTriangulations(const TDF_Label& labelEntity, TaskProgress* progress = nullptr);
+
+    // Computes the final triangulations of the prototypes of 'labelShape' on copies of their
+    // topology, so shapes currently displayed with a coarse tessellation aren't modified
+    // Returns the function replacing the triangulations of the prototypes, to be called in the
+    // main thread(see GraphicsShapeObjectDriver::RefineMeshFunction). Returns null function on abort
+    std::function<void()> computeBRepMeshRefinement(const TDF_Label& labelShape, TaskProgress* progress = nullptr);
+
+    // Whether reader parameters of 'format' enable shape healing, ie have boolean property "healShapes" on
+    bool shapeHealingRequired(IO::Format format) const;
+    // Heals the prototypes of an entity imported from 'format'(see ShapeHealing), changes are
+    // reported as an info message. Does nothing if shapeHealingRequired() is false
+    void healImportedShapes(const TDF_Label& labelEntity, IO::Format format, TaskProgress* progress = nullptr);
 
     // from IO::ParametersProvider
     const PropertyGroup* findReaderParameters(IO::Format format) const override;
@@ -75,6 +130,8 @@ public:
     bool fromVariant(Property* prop, const QVariant& variant) const override;
 
     // from Messenger
+    // Can be called from any thread. Messages are logged at once, but signal message() is emitted
+    // by batches from the main thread at a bounded frequency, repeated messages being merged
     void emitMessage(MessageType msgType, const QString& text) override;
     void clearMessageLog();
     Span<const Messenger::Message> messageLog() const { return m_messageLog; }
@@ -93,6 +150,11 @@ public:
     PropertyFilePath lastOpenDir{ this, textId("lastOpenFolder") };
     PropertyString lastSelectedFormatFilter{ this, textId("lastSelectedFormatFilter") };
     PropertyBool linkWithDocumentSelector{ this, textId("linkWithDocumentSelector") };
+    PropertyInt importMemoryBudget{ this, textId("importMemoryBudget") }; // MB, 0 if automatic
+    PropertyBool importDeduplicateGeometry{ this, textId("importDeduplicateGeometry") };
+    PropertyBool importConcurrentModelTreeBuild{ this, textId("importConcurrentModelTreeBuild") };
+    PropertyBool importUseModelCache{ this, textId("importUseModelCache") };
+    PropertyString cacheFolder{ this, textId("cacheFolder") }; // Empty if user cache directory
     // Meshing
     const Settings_GroupIndex groupId_meshing;
     enum class BRepMeshQuality { VeryCoarse, Coarse, Normal, Precise, VeryPrecise, UserDefined };
@@ -100,10 +162,24 @@ public:
     PropertyLength meshingChordalDeflection{ this, textId("meshingChordalDeflection") };
     PropertyAngle meshingAngularDeflection{ this, textId("meshingAngularDeflection") };
     PropertyBool meshingRelative{ this, textId("meshingRelative") };
+    PropertyBool meshingInParallel{ this, textId("meshingInParallel") };
+    PropertyBool meshingUseCache{ this, textId("meshingUseCache") };
+    PropertyBool meshingLazy{ this, textId("meshingLazy") };
+    PropertyBool meshingProgressive{ this, textId("meshingProgressive") };
+    PropertyBool meshingRepairOnImport{ this, textId("meshingRepairOnImport") };
+    PropertyBool meshingAdaptive{ this, textId("meshingAdaptive") };
+    PropertyInt meshingTriangleBudget{ this, textId("meshingTriangleBudget") }; // 0 if unlimited
+    PropertyBool meshingSinglePrecision{ this, textId("meshingSinglePrecision") };
+    PropertyBool meshingReorder{ this, textId("meshingReorder") };
     // Graphics
     const Settings_GroupIndex groupId_graphics;
     PropertyBool defaultShowOriginTrihedron{ this, textId("defaultShowOriginTrihedron") };
     PropertyDouble instantZoomFactor{ this, textId("instantZoomFactor") };
+    PropertyBool asyncHiddenLineRemovalOn{ this, textId("asyncHiddenLineRemovalOn") };
+    PropertyBool staticBatchingOn{ this, textId("staticBatchingOn") };
+    PropertyBool depthBufferPickingOn{ this, textId("depthBufferPickingOn") };
+    PropertyInt presentationMemoryBudget{ this, textId("presentationMemoryBudget") }; // MB, 0 if unlimited
+    PropertyBool shapePagingOn{ this, textId("shapePagingOn") };
     // -- ClipPlanes
     const Settings_SectionIndex sectionId_graphicsClipPlanes;
     PropertyBool clipPlanesCappingOn{ this, textId("cappingOn") };
@@ -115,18 +191,47 @@ public:
     PropertyEnumeration meshDefaultsMaterial{ this, textId("material"), OcctEnums::Graphic3d_NameOfMaterial() };
     PropertyBool meshDefaultsShowEdges{ this, textId("showEgesOn") };
     PropertyBool meshDefaultsShowNodes{ this, textId("showNodesOn") };
+    PropertyAngle meshDefaultsEdgeFeatureAngle{ this, textId("edgeFeatureAngle") };
+    // -- Culling
+    const Settings_SectionIndex sectionId_graphicsCulling;
+    PropertyBool cullingFrustumOn{ this, textId("frustumCullingOn") };
+    PropertyInt cullingSizeThreshold{ this, textId("sizeCullingThreshold") };
+    PropertyInt cullingDynamicSizeThreshold{ this, textId("dynamicSizeCullingThreshold") };
+    PropertyBool cullingAdaptiveRenderingOn{ this, textId("adaptiveRenderingOn") };
+    PropertyBool cullingOcclusionOn{ this, textId("occlusionCullingOn") };
+    // -- Transparency
+    const Settings_SectionIndex sectionId_graphicsTransparency;
+    enum class TransparencyMode { Unordered, Performance, Quality };
+    PropertyEnum<TransparencyMode> transparencyMode{ this, textId("transparencyMode") };
 
 protected:
     // from PropertyGroup
     void onPropertyChanged(Property* prop) override;
 
 private:
+    TaskId startRecentFileThumbnailTask(GuiDocument* guiDoc);
+    void onRecentFileThumbnailTaskEnded(TaskId taskId);
+    void deliverQueuedMessages();
+    void updateCacheDirPaths();
+
     Application* m_app = nullptr;
     std::vector<std::unique_ptr<PropertyGroup>> m_vecPtrPropertyGroup;
     std::unordered_map<IO::Format, PropertyGroup*> m_mapFormatReaderParameters;
     std::unordered_map<IO::Format, PropertyGroup*> m_mapFormatWriterParameters;
     std::vector<Messenger::Message> m_messageLog;
     std::mutex m_mutexMessageLog;
+    MessageBatchQueue m_messageQueue;
+    QTimer m_timerMessageDelivery;
+    MeshCache m_meshCache;
+    ModelCache m_modelCache;
+    FilePath m_thumbnailCacheDirPath;
+    struct ThumbnailTask {
+        FilePath filepath;
+        int64_t timestamp;
+        std::shared_ptr<bool> okWrite;
+    };
+    TaskManager m_thumbnailTaskMgr;
+    std::unordered_map<TaskId, ThumbnailTask> m_mapThumbnailTask;
 };
 
 } // namespace Mayo
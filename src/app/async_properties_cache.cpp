@@ -0,0 +1,82 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "async_properties_cache.h"
+
+namespace Mayo {
+
+AsyncPropertiesCache::AsyncPropertiesCache(QObject* parent)
+    : QObject(parent)
+{
+    QObject::connect(&m_taskMgr, &TaskManager::ended, this, &AsyncPropertiesCache::onTaskEnded);
+}
+
+const AsyncPropertiesCache::Values* AsyncPropertiesCache::find(
+        const TDF_Label& label, const Handle_Standard_Transient& geometry, ComputeFunction fnCompute)
+{
+    Entry& entry = m_mapEntry[label];
+    if (entry.geometry != geometry) {
+        // Geometry was replaced, values cached are obsolete. Task possibly running for the previous
+        // geometry is left to complete, its result will be dropped
+        entry.geometry = geometry;
+        entry.values.reset();
+        entry.taskId = 0;
+    }
+
+    if (entry.values)
+        return entry.values.get();
+
+    if (entry.taskId == 0 && fnCompute) {
+        auto result = std::make_shared<Values>();
+        entry.taskId = m_taskMgr.newTask([=](TaskProgress* progress) {
+            *result = fnCompute(progress);
+        });
+        m_mapTask.insert({ entry.taskId, TaskData{ label, geometry, result } });
+        m_taskMgr.run(entry.taskId);
+    }
+
+    return nullptr;
+}
+
+void AsyncPropertiesCache::clear()
+{
+    // Tasks still running are left to complete, their results go nowhere
+    m_mapEntry.clear();
+    m_mapTask.clear();
+}
+
+void AsyncPropertiesCache::onTaskEnded(TaskId taskId)
+{
+    auto itTask = m_mapTask.find(taskId);
+    if (itTask == m_mapTask.end())
+        return; // Cache was cleared in the meantime
+
+    const TaskData task = std::move(itTask->second);
+    m_mapTask.erase(itTask);
+    auto itEntry = m_mapEntry.find(task.label);
+    if (itEntry != m_mapEntry.end() && itEntry->second.taskId == taskId) {
+        itEntry->second.values = task.result;
+        itEntry->second.taskId = 0;
+        this->purge();
+        emit computed(task.label);
+    }
+}
+
+void AsyncPropertiesCache::purge()
+{
+    // An entry is the last owner of its geometry when the document was closed or the geometry of
+    // the label replaced
+    for (auto it = m_mapEntry.begin(); it != m_mapEntry.end(); ) {
+        const Entry& entry = it->second;
+        const bool isGeometryReleased = entry.geometry.IsNull() || entry.geometry->GetRefCount() == 1;
+        if (entry.taskId == 0 && isGeometryReleased)
+            it = m_mapEntry.erase(it);
+        else
+            ++it;
+    }
+}
+
+} // namespace Mayo
@@ -0,0 +1,76 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "../base/caf_utils.h"
+#include "../base/quantity.h"
+#include "../base/task_manager.h"
+
+#include <QtCore/QObject>
+#include <Standard_Transient.hxx>
+#include <TDF_Label.hxx>
+#include <gp_Pnt.hxx>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+
+namespace Mayo {
+
+// Caches property values which are expensive to compute(ex: mass properties of big meshes)
+// Computations are run by worker threads, so the caller(GUI thread) is never blocked
+// Entries are keyed by label and keep the geometry object(Poly_Triangulation, TopoDS_TShape, ...)
+// values were computed from: values are recomputed only when the geometry of a label is replaced
+// Entries whose geometry isn't referenced anymore outside of the cache are purged
+class AsyncPropertiesCache : public QObject {
+    Q_OBJECT
+public:
+    struct Values {
+        bool hasCentroid = false;
+        bool hasArea = false;
+        bool hasVolume = false;
+        gp_Pnt centroid;
+        QuantityArea area;
+        QuantityVolume volume;
+    };
+
+    // Called from a worker thread
+    using ComputeFunction = std::function<Values(TaskProgress*)>;
+
+    AsyncPropertiesCache(QObject* parent = nullptr);
+
+    // Returns the values of 'label' if they're available for 'geometry', otherwise requests their
+    // computation with 'fnCompute'(unless it's already running) and returns nullptr
+    // Signal computed() is emitted once the requested values are available
+    const Values* find(const TDF_Label& label, const Handle_Standard_Transient& geometry, ComputeFunction fnCompute);
+
+    void clear();
+
+signals:
+    void computed(const TDF_Label& label);
+
+private:
+    struct Entry {
+        Handle_Standard_Transient geometry;
+        std::shared_ptr<const Values> values; // Null until computed for 'geometry'
+        TaskId taskId = 0;
+    };
+
+    struct TaskData {
+        TDF_Label label;
+        Handle_Standard_Transient geometry;
+        std::shared_ptr<Values> result;
+    };
+
+    void onTaskEnded(TaskId taskId);
+    void purge();
+
+    TaskManager m_taskMgr;
+    std::unordered_map<TDF_Label, Entry> m_mapEntry;
+    std::unordered_map<TaskId, TaskData> m_mapTask;
+};
+
+} // namespace Mayo
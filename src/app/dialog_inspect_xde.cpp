@@ -9,10 +9,13 @@
 #include "../base/application.h"
 #include "../base/brep_utils.h"
 #include "../base/caf_utils.h"
+#include "../base/global.h"
 #include "../base/meta_enum.h"
 #include "../base/qmeta_tdf_label.h"
 #include "../base/settings.h"
 #include "../base/string_conv.h"
+#include "../base/task_manager.h"
+#include "../base/task_progress.h"
 #include "../base/tkernel_utils.h"
 #include "../gui/qtgui_utils.h"
 #include "app_module.h"
@@ -54,6 +57,8 @@
 #  include <XCAFDoc_VisMaterialTool.hxx>
 #endif
 
+#include <atomic>
+#include <memory>
 #include <sstream>
 
 namespace Mayo {
@@ -61,7 +66,8 @@ namespace Mayo {
 namespace Internal {
 
 enum TreeWidgetItemRole {
-    TreeWidgetItem_TdfLabelRole = Qt::UserRole + 1
+    TreeWidgetItem_TdfLabelRole = Qt::UserRole + 1,
+    TreeWidgetItem_ChildrenLoadedRole
 };
 
 static void loadLabelAttributes(const TDF_Label& label, QTreeWidgetItem* treeItem)
@@ -596,16 +602,28 @@ static void loadLabel(const TDF_Label& label, QTreeWidgetItem* treeItem)
     const QString stdName = to_QString(CafUtils::labelAttrStdName(label));
     if (!stdName.isEmpty())
         treeItem->setText(0, treeItem->text(0) + " " + stdName);
+
+    // Children items are created on expansion, see loadChildrenLabels()
+    if (label.HasChild())
+        treeItem->setChildIndicatorPolicy(QTreeWidgetItem::ShowIndicator);
 }
 
-static void deepLoadChildrenLabels(const TDF_Label& label, QTreeWidgetItem* treeItem)
+// Creates the items of the direct children of 'label', only once per tree item
+static void loadChildrenLabels(const TDF_Label& label, QTreeWidgetItem* treeItem)
 {
+    if (treeItem->data(0, TreeWidgetItem_ChildrenLoadedRole).toBool())
+        return;
+
+    treeItem->setData(0, TreeWidgetItem_ChildrenLoadedRole, true);
+    QList<QTreeWidgetItem*> listChildTreeItem;
     for (TDF_ChildIterator it(label, Standard_False); it.More(); it.Next()) {
-        const TDF_Label childLabel = it.Value();
-        auto childTreeItem = new QTreeWidgetItem(treeItem);
-        loadLabel(childLabel, childTreeItem);
-        deepLoadChildrenLabels(childLabel, childTreeItem);
+        auto childTreeItem = new QTreeWidgetItem;
+        loadLabel(it.Value(), childTreeItem);
+        listChildTreeItem.push_back(childTreeItem);
     }
+
+    treeItem->addChildren(listChildTreeItem);
+    treeItem->setChildIndicatorPolicy(QTreeWidgetItem::DontShowIndicatorWhenChildless);
 }
 
 } // namespace Internal
@@ -617,13 +635,20 @@ DialogInspectXde::DialogInspectXde(QWidget *parent)
     m_ui->setupUi(this);
     m_ui->splitter->setStretchFactor(0, 1);
     m_ui->splitter->setStretchFactor(1, 4);
+    m_ui->treeWidget_Document->setUniformRowHeights(true);
     QObject::connect(
                 m_ui->treeWidget_Document, &QTreeWidget::itemClicked,
                 this, &DialogInspectXde::onLabelTreeWidgetItemClicked);
+    QObject::connect(
+                m_ui->treeWidget_Document, &QTreeWidget::itemExpanded,
+                this, &DialogInspectXde::onLabelTreeWidgetItemExpanded);
 }
 
 DialogInspectXde::~DialogInspectXde()
 {
+    if (m_taskIdLabelCount != 0)
+        TaskManager::globalInstance()->requestAbort(m_taskIdLabelCount);
+
     delete m_ui;
 }
 
@@ -640,12 +665,47 @@ void DialogInspectXde::load(const Handle_TDocStd_Document& doc)
         const TDF_Label label = doc->Main();
         auto treeItem = new QTreeWidgetItem;
         Internal::loadLabel(label, treeItem);
-        Internal::deepLoadChildrenLabels(label, treeItem);
         m_ui->treeWidget_Document->addTopLevelItem(treeItem);
         treeItem->setExpanded(true);
+        this->startLabelCount(label);
     }
 }
 
+void DialogInspectXde::onLabelTreeWidgetItemExpanded(QTreeWidgetItem* item)
+{
+    const QVariant varLabel = item->data(0, Internal::TreeWidgetItem_TdfLabelRole);
+    if (varLabel.isValid())
+        Internal::loadChildrenLabels(varLabel.value<TDF_Label>(), item);
+}
+
+void DialogInspectXde::startLabelCount(const TDF_Label& labelRoot)
+{
+    // Whole tree of labels is only walked in a background task, to show its size
+    auto labelCount = std::make_shared<std::atomic<int>>(0);
+    auto taskMgr = TaskManager::globalInstance();
+    const Handle_TDocStd_Document doc = m_doc;
+    m_taskIdLabelCount = taskMgr->newTask([=](TaskProgress* progress) {
+        MAYO_UNUSED(doc); // Keeps the document alive until end of the task
+        int count = 1;
+        for (TDF_ChildIterator it(labelRoot, Standard_True); it.More(); it.Next()) {
+            if ((++count & 0xFFF) == 0 && progress->isAbortRequested())
+                return;
+        }
+
+        *labelCount = count;
+    });
+    QObject::connect(taskMgr, &TaskManager::ended, this, [=](TaskId taskId) {
+        if (taskId != m_taskIdLabelCount)
+            return;
+
+        m_taskIdLabelCount = 0;
+        if (*labelCount > 0)
+            this->setWindowTitle(tr("XDE - %n label(s)", nullptr, labelCount->load()));
+    });
+    taskMgr->setTitle(m_taskIdLabelCount, tr("Count XDE labels"));
+    taskMgr->run(m_taskIdLabelCount);
+}
+
 void DialogInspectXde::onLabelTreeWidgetItemClicked(QTreeWidgetItem *item, int /*column*/)
 {
     const QVariant varLabel = item->data(0, Internal::TreeWidgetItem_TdfLabelRole);
@@ -6,7 +6,10 @@
 
 #pragma once
 
+#include "../base/task_common.h"
+
 #include <QtWidgets/QDialog>
+#include <TDF_Label.hxx>
 #include <TDocStd_Document.hxx>
 class QTreeWidgetItem;
 
@@ -22,9 +25,12 @@ public:
 
 private:
     void onLabelTreeWidgetItemClicked(QTreeWidgetItem* item, int column);
+    void onLabelTreeWidgetItemExpanded(QTreeWidgetItem* item);
+    void startLabelCount(const TDF_Label& labelRoot);
 
     class Ui_DialogInspectXde* m_ui = nullptr;
     Handle_TDocStd_Document m_doc;
+    TaskId m_taskIdLabelCount = 0;
 };
 
 } // namespace Mayo
@@ -9,6 +9,7 @@
 #include "../base/application.h"
 #include "../base/settings.h"
 #include "../base/task_manager.h"
+#include "../base/task_stats.h"
 #include "ui_dialog_task_manager.h"
 #include "qstring_utils.h"
 #include "theme.h"
@@ -32,6 +33,8 @@ public:
     QLabel* m_label = nullptr;
     QProgressBar* m_progress = nullptr;
     QToolButton* m_interruptBtn = nullptr;
+    QLabel* m_statsLabel = nullptr;
+    TaskStatsHistory m_statsHistory;
 
     void createUnboundedProgressTimer();
     void stopUnboundedProgressTimer();
@@ -52,7 +55,8 @@ DialogTaskManager::TaskWidget::TaskWidget(QWidget* parent)
     : QWidget(parent),
       m_label(new QLabel(this)),
       m_progress(new QProgressBar(this)),
-      m_interruptBtn(new QToolButton(this))
+      m_interruptBtn(new QToolButton(this)),
+      m_statsLabel(new QLabel(this))
 {
     QFont labelFont = m_label->font();
     labelFont.setBold(true);
@@ -69,6 +73,7 @@ DialogTaskManager::TaskWidget::TaskWidget(QWidget* parent)
     auto mainLayout = new QVBoxLayout;
     mainLayout->addWidget(m_label);
     mainLayout->addLayout(progressLayout);
+    mainLayout->addWidget(m_statsLabel);
     mainLayout->setSpacing(0);
     this->setLayout(mainLayout);
 }
@@ -118,6 +123,11 @@ DialogTaskManager::DialogTaskManager(TaskManager* taskMgr, QWidget* parent)
     QObject::connect(taskMgr, &TaskManager::ended, this, &DialogTaskManager::onTaskEnded);
     QObject::connect(taskMgr, &TaskManager::progressChanged, this, &DialogTaskManager::onTaskProgress);
     QObject::connect(taskMgr, &TaskManager::progressStep, this, &DialogTaskManager::onTaskProgressStep);
+
+    // Statistics are sampled periodically, progress signals can't be relied on as they might be
+    // sparse(eg OpenCascade phases without progress report)
+    m_statsTimer = new QTimer(this);
+    QObject::connect(m_statsTimer, &QTimer::timeout, this, &DialogTaskManager::updateTaskStats);
 }
 
 DialogTaskManager::~DialogTaskManager()
@@ -139,6 +149,9 @@ void DialogTaskManager::onTaskStarted(TaskId taskId)
     m_taskIdToWidget.insert({ taskId, widget });
     ++m_taskCount;
     this->onTaskProgressStep(taskId, QString());
+    this->updateWindowTitle();
+    if (!m_statsTimer->isActive())
+        m_statsTimer->start(1000);
 }
 
 void DialogTaskManager::onTaskEnded(TaskId taskId)
@@ -153,8 +166,10 @@ void DialogTaskManager::onTaskEnded(TaskId taskId)
         m_taskIdToWidget.erase(taskId);
     }
 
+    this->updateWindowTitle();
     --m_taskCount;
     if (m_taskCount == 0) {
+        m_statsTimer->stop();
         m_isRunning = false;
         this->accept();
     }
@@ -201,6 +216,33 @@ void DialogTaskManager::interruptTask()
     }
 }
 
+void DialogTaskManager::updateWindowTitle()
+{
+    // Show count of tasks waiting for an available worker
+    const int pendingCount = m_taskMgr->pendingTaskCount();
+    if (pendingCount > 0)
+        this->setWindowTitle(tr("Tasks (%1 queued)").arg(pendingCount));
+    else
+        this->setWindowTitle(tr("Tasks"));
+}
+
+void DialogTaskManager::updateTaskStats()
+{
+    const QLocale locale = Application::instance()->settings()->locale();
+    for (const auto& [taskId, widget] : m_taskIdToWidget) {
+        const TaskStats stats = m_taskMgr->stats(taskId);
+        widget->m_statsHistory.addSample(stats);
+        QString text = tr("Elapsed %1, step %2").arg(
+                    QStringUtils::durationText(stats.elapsedMs, locale),
+                    QStringUtils::durationText(stats.stepElapsedMs, locale));
+        const QString textRates = QStringUtils::text(widget->m_statsHistory, locale);
+        if (!textRates.isEmpty())
+            text += tr(", ") + textRates;
+
+        widget->m_statsLabel->setText(text);
+    }
+}
+
 DialogTaskManager::TaskWidget* DialogTaskManager::taskWidget(TaskId taskId)
 {
     auto it = m_taskIdToWidget.find(taskId);
@@ -30,9 +30,12 @@ private:
     void onTaskProgress(TaskId taskId, int percent);
     void onTaskProgressStep(TaskId taskId, const QString& name);
     void interruptTask();
+    void updateWindowTitle();
+    void updateTaskStats();
 
     class Ui_DialogTaskManager* m_ui = nullptr;
     TaskManager* m_taskMgr = nullptr;
+    class QTimer* m_statsTimer = nullptr;
     std::unordered_map<TaskId, TaskWidget*> m_taskIdToWidget;
     bool m_isRunning = false;
     unsigned m_taskCount = 0;
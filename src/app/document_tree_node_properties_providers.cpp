@@ -6,30 +6,53 @@
 
 #include "document_tree_node_properties_providers.h"
 
+#include "../base/brep_mass_properties.h"
 #include "../base/caf_utils.h"
 #include "../base/document.h"
 #include "../base/document_tree_node.h"
 #include "../base/mesh_utils.h"
 #include "../base/meta_enum.h"
+#include "../base/point_cloud.h"
 #include "../base/string_conv.h"
 #include "../base/xcaf.h"
+#include "async_properties_cache.h"
 
 #include <TDataStd_Name.hxx>
 #include <TDataXtd_Triangulation.hxx>
+#include <algorithm>
+#include <climits>
 
 namespace Mayo {
 
+namespace {
+
+AsyncPropertiesCache* meshPropertiesCache()
+{
+    static AsyncPropertiesCache cache;
+    return &cache;
+}
+
+AsyncPropertiesCache* brepPropertiesCache()
+{
+    static AsyncPropertiesCache cache;
+    return &cache;
+}
+
+} // namespace
+
 class XCaf_DocumentTreeNodePropertiesProvider::Properties : public PropertyGroupSignals {
     MAYO_DECLARE_TEXT_ID_FUNCTIONS(Mayo::XCaf_DocumentTreeNodeProperties)
 public:
     Properties(const DocumentTreeNode& treeNode)
-        : m_label(treeNode.label())
+        : m_document(treeNode.document()),
+          m_label(treeNode.label())
     {
         const TDF_Label& label = m_label;
-        const XCaf& xcaf = treeNode.document()->xcaf();
+        LabelAttributesCache& attrsCache = m_document->labelAttributesCache();
+        const auto attrs = attrsCache.attributes(label);
 
         // Name
-        m_propertyName.setValue(to_stdString(CafUtils::labelAttrStdName(label)));
+        m_propertyName.setValue(to_stdString(attrs->name));
 
         // Shape type
         const TopAbs_ShapeEnum shapeType = XCAFDoc_ShapeTool::GetShape(label).ShapeType();
@@ -61,34 +84,32 @@ public:
 
         // XDE layers
         {
-            TDF_LabelSequence seqLayerLabel = xcaf.layers(label);
-            if (XCaf::isShapeReference(label)) {
-                TDF_LabelSequence seqLayerLabelProduct = xcaf.layers(XCaf::shapeReferred(label));
-                seqLayerLabel.Append(seqLayerLabelProduct);
-            }
-
             QStringList listLayerName;
-            for (const TDF_Label& layerLabel : seqLayerLabel)
-                listLayerName.push_back(to_QString(xcaf.layerName(layerLabel)));
+            for (const TCollection_ExtendedString& layerName : attrs->vecLayerName)
+                listLayerName.push_back(to_QString(layerName));
 
-            if (!seqLayerLabel.IsEmpty())
+            if (attrs->isReference) {
+                for (const TCollection_ExtendedString& layerName : attrsCache.attributes(attrs->labelReferred)->vecLayerName)
+                    listLayerName.push_back(to_QString(layerName));
+            }
+
+            if (!listLayerName.isEmpty())
                 m_propertyXdeLayer.setValue(to_stdString(listLayerName.join(", ")));
             else
                 this->removeProperty(&m_propertyXdeLayer);
         }
 
         // Reference location
-        if (XCaf::isShapeReference(label)) {
-            const TopLoc_Location loc = XCaf::shapeReferenceLocation(label);
-            m_propertyReferenceLocation.setValue(loc.Transformation());
+        if (attrs->isReference) {
+            m_propertyReferenceLocation.setValue(attrs->referenceLocation.Transformation());
         }
         else {
             this->removeProperty(&m_propertyReferenceLocation);
         }
 
         // Color
-        if (xcaf.hasShapeColor(label))
-            m_propertyColor.setValue(xcaf.shapeColor(label));
+        if (attrs->hasColor)
+            m_propertyColor.setValue(attrs->color);
         else
             this->removeProperty(&m_propertyColor);
 
@@ -108,10 +129,57 @@ public:
                 this->removeProperty(&m_propertyValidationVolume);
         }
 
+        // Mass properties computed from BRep, in background
+        // Not for assemblies: their shape is a compound rebuilt on each query, so it can't be used
+        // as the key of cached values
+        // Deferred scaling of the entity is applied on the computed values, this avoids to scale
+        // the shapes of the document just for measurement
+        const TopoDS_Shape shape = XCaf::shape(label);
+        if (!XCaf::isShapeAssembly(label) && !shape.IsNull()) {
+            const Tree<TDF_Label>& modelTree = m_document->modelTree();
+            const double scaling =
+                    m_document->deferredScaling(modelTree.nodeData(modelTree.nodeRoot(treeNode.id())));
+            auto fnCompute = [=](TaskProgress* progress) {
+                const auto massProps = BRepMassProperties::compute(shape, BRepMassProperties::Mode::Exact, progress);
+                AsyncPropertiesCache::Values values;
+                values.hasArea = massProps.area > 0;
+                values.hasVolume = massProps.volume > 0;
+                values.hasCentroid = values.hasArea;
+                values.area = massProps.area * scaling * scaling * Quantity_SquaredMillimeter;
+                values.volume = massProps.volume * scaling * scaling * scaling * Quantity_CubicMillimeter;
+                values.centroid = gp_Pnt(massProps.centroid.XYZ() * scaling);
+                return values;
+            };
+            AsyncPropertiesCache* cache = brepPropertiesCache();
+            const AsyncPropertiesCache::Values* values = cache->find(label, shape.TShape(), fnCompute);
+            if (values) {
+                this->setComputedMassProperties(*values);
+            }
+            else {
+                m_propertyComputedCentroid.setEnabled(false);
+                m_propertyComputedArea.setEnabled(false);
+                m_propertyComputedVolume.setEnabled(false);
+                QObject::connect(cache, &AsyncPropertiesCache::computed, this, [=](const TDF_Label& labelComputed) {
+                    if (labelComputed != label)
+                        return;
+
+                    const AsyncPropertiesCache::Values* values = cache->find(label, shape.TShape(), fnCompute);
+                    if (values)
+                        this->setComputedMassProperties(*values);
+                });
+            }
+        }
+        else {
+            this->removeProperty(&m_propertyComputedCentroid);
+            this->removeProperty(&m_propertyComputedArea);
+            this->removeProperty(&m_propertyComputedVolume);
+        }
+
         // Referred entity's properties
-        if (XCaf::isShapeReference(label)) {
-            m_labelReferred = XCaf::shapeReferred(label);
-            m_propertyReferredName.setValue(to_stdString(CafUtils::labelAttrStdName(m_labelReferred)));
+        if (attrs->isReference) {
+            m_labelReferred = attrs->labelReferred;
+            const auto attrsReferred = attrsCache.attributes(m_labelReferred);
+            m_propertyReferredName.setValue(to_stdString(attrsReferred->name));
             auto validProps = XCaf::validationProperties(m_labelReferred);
             m_propertyReferredValidationCentroid.setValue(validProps.centroid);
             if (!validProps.hasCentroid)
@@ -125,8 +193,8 @@ public:
             if (!validProps.hasVolume)
                 this->removeProperty(&m_propertyReferredValidationVolume);
 
-            if (xcaf.hasShapeColor(m_labelReferred))
-                m_propertyReferredColor.setValue(xcaf.shapeColor(m_labelReferred));
+            if (attrsReferred->hasColor)
+                m_propertyReferredColor.setValue(attrsReferred->color);
             else
                 this->removeProperty(&m_propertyReferredColor);
         }
@@ -145,12 +213,28 @@ public:
         m_propertyReferredName.setUserReadOnly(false);
     }
 
+    void setComputedMassProperties(const AsyncPropertiesCache::Values& values)
+    {
+        m_propertyComputedCentroid.setEnabled(true);
+        m_propertyComputedArea.setEnabled(true);
+        m_propertyComputedVolume.setEnabled(true);
+        m_propertyComputedCentroid.setValue(values.centroid);
+        m_propertyComputedArea.setQuantity(values.area);
+        m_propertyComputedVolume.setQuantity(values.volume);
+    }
+
     void onPropertyChanged(Property* prop) override
     {
-        if (prop == &m_propertyName)
+        if (prop == &m_propertyName) {
             TDataStd_Name::Set(m_label, to_OccExtString(m_propertyName.value()));
-        else if (prop == &m_propertyReferredName)
+            m_document->labelAttributesCache().forget(m_label);
+            m_document->searchIndex().invalidateLabel(m_label);
+        }
+        else if (prop == &m_propertyReferredName) {
             TDataStd_Name::Set(m_labelReferred, to_OccExtString(m_propertyReferredName.value()));
+            m_document->labelAttributesCache().forget(m_labelReferred);
+            m_document->searchIndex().invalidateLabel(m_labelReferred);
+        }
 
         PropertyGroupSignals::onPropertyChanged(prop);
     }
@@ -164,6 +248,9 @@ public:
     PropertyOccPnt m_propertyValidationCentroid{ this, textId("Centroid") };
     PropertyArea m_propertyValidationArea{ this, textId("Area") };
     PropertyVolume m_propertyValidationVolume{ this, textId("Volume") };
+    PropertyOccPnt m_propertyComputedCentroid{ this, textId("ComputedCentroid") };
+    PropertyArea m_propertyComputedArea{ this, textId("ComputedArea") };
+    PropertyVolume m_propertyComputedVolume{ this, textId("ComputedVolume") };
 
     PropertyString m_propertyReferredName{ this, textId("ProductName") };
     PropertyOccColor m_propertyReferredColor{ this, textId("ProductColor") };
@@ -171,6 +258,7 @@ public:
     PropertyArea m_propertyReferredValidationArea{ this, textId("ProductArea") };
     PropertyVolume m_propertyReferredValidationVolume{ this, textId("ProductVolume") };
 
+    DocumentPtr m_document;
     TDF_Label m_label;
     TDF_Label m_labelReferred;
 };
@@ -194,23 +282,65 @@ class Mesh_DocumentTreeNodePropertiesProvider::Properties : public PropertyGroup
 public:
     Properties(const DocumentTreeNode& treeNode)
     {
-        auto attrTriangulation = CafUtils::findAttribute<TDataXtd_Triangulation>(treeNode.label());
+        const TDF_Label label = treeNode.label();
+        auto attrTriangulation = CafUtils::findAttribute<TDataXtd_Triangulation>(label);
         Handle_Poly_Triangulation polyTri;
         if (!attrTriangulation.IsNull())
             polyTri = attrTriangulation->Get();
 
         m_propertyNodeCount.setValue(!polyTri.IsNull() ? polyTri->NbNodes() : 0);
         m_propertyTriangleCount.setValue(!polyTri.IsNull() ? polyTri->NbTriangles() : 0);
-        m_propertyArea.setQuantity(MeshUtils::triangulationArea(polyTri) * Quantity_SquaredMillimeter);
-        m_propertyVolume.setQuantity(MeshUtils::triangulationVolume(polyTri) * Quantity_CubicMillimeter);
         for (Property* property : this->properties())
             property->setUserReadOnly(true);
+
+        if (polyTri.IsNull())
+            return;
+
+        // Mass properties are computed in background, then cached until triangulation is replaced
+        auto fnCompute = [=](TaskProgress*) {
+            const MeshUtils::MassProperties massProps = MeshUtils::triangulationMassProperties(polyTri);
+            AsyncPropertiesCache::Values values;
+            values.hasArea = values.hasVolume = values.hasCentroid = true;
+            values.area = massProps.area * Quantity_SquaredMillimeter;
+            values.volume = massProps.volume * Quantity_CubicMillimeter;
+            values.centroid = massProps.centroid;
+            return values;
+        };
+        AsyncPropertiesCache* cache = meshPropertiesCache();
+        const AsyncPropertiesCache::Values* values = cache->find(label, polyTri, fnCompute);
+        if (values) {
+            this->setMassProperties(*values);
+        }
+        else {
+            m_propertyArea.setEnabled(false);
+            m_propertyVolume.setEnabled(false);
+            m_propertyCentroid.setEnabled(false);
+            QObject::connect(cache, &AsyncPropertiesCache::computed, this, [=](const TDF_Label& labelComputed) {
+                if (labelComputed != label)
+                    return;
+
+                const AsyncPropertiesCache::Values* values = cache->find(label, polyTri, fnCompute);
+                if (values)
+                    this->setMassProperties(*values);
+            });
+        }
+    }
+
+    void setMassProperties(const AsyncPropertiesCache::Values& values)
+    {
+        m_propertyArea.setEnabled(true);
+        m_propertyVolume.setEnabled(true);
+        m_propertyCentroid.setEnabled(true);
+        m_propertyArea.setQuantity(values.area);
+        m_propertyVolume.setQuantity(values.volume);
+        m_propertyCentroid.setValue(values.centroid);
     }
 
     PropertyInt m_propertyNodeCount{ this, textId("NodeCount") };
     PropertyInt m_propertyTriangleCount{ this, textId("TriangleCount") };
     PropertyArea m_propertyArea{ this, textId("Area") };
     PropertyVolume m_propertyVolume{ this, textId("Volume") };
+    PropertyOccPnt m_propertyCentroid{ this, textId("Centroid") };
 };
 
 bool Mesh_DocumentTreeNodePropertiesProvider::supports(const DocumentTreeNode& treeNode) const
@@ -227,4 +357,41 @@ Mesh_DocumentTreeNodePropertiesProvider::properties(const DocumentTreeNode& tree
     return std::make_unique<Properties>(treeNode);
 }
 
+class PointCloud_DocumentTreeNodePropertiesProvider::Properties : public PropertyGroupSignals {
+    MAYO_DECLARE_TEXT_ID_FUNCTIONS(Mayo::PointCloud_DocumentTreeNodeProperties)
+public:
+    Properties(const DocumentTreeNode& treeNode)
+    {
+        auto attrPointCloud = CafUtils::findAttribute<PointCloudAttribute>(treeNode.label());
+        PointCloudPtr pointCloud;
+        if (!attrPointCloud.IsNull())
+            pointCloud = attrPointCloud->get();
+
+        auto fnToInt = [](uint64_t count) { return int(std::min<uint64_t>(count, INT_MAX)); };
+        m_propertyPointCount.setValue(!pointCloud.IsNull() ? fnToInt(pointCloud->pointCount()) : 0);
+        m_propertyOctreeNodeCount.setValue(!pointCloud.IsNull() ? fnToInt(pointCloud->nodes().size()) : 0);
+        m_propertyOutOfCore.setValue(!pointCloud.IsNull() && pointCloud->isOutOfCoreStorage());
+        for (Property* property : this->properties())
+            property->setUserReadOnly(true);
+    }
+
+    PropertyInt m_propertyPointCount{ this, textId("PointCount") };
+    PropertyInt m_propertyOctreeNodeCount{ this, textId("OctreeNodeCount") };
+    PropertyBool m_propertyOutOfCore{ this, textId("OutOfCoreStorage") };
+};
+
+bool PointCloud_DocumentTreeNodePropertiesProvider::supports(const DocumentTreeNode& treeNode) const
+{
+    return CafUtils::hasAttribute<PointCloudAttribute>(treeNode.label());
+}
+
+std::unique_ptr<PropertyGroupSignals>
+PointCloud_DocumentTreeNodePropertiesProvider::properties(const DocumentTreeNode& treeNode) const
+{
+    if (!treeNode.isValid())
+        return {};
+
+    return std::make_unique<Properties>(treeNode);
+}
+
 } // namespace Mayo
@@ -5,20 +5,33 @@
 ****************************************************************************/
 
 #include "../base/application.h"
+#include "../base/brep_mass_properties.h"
+#include "../base/caf_utils.h"
+#include "../base/cpu_topology.h"
 #include "../base/document_tree_node_properties_provider.h"
 #include "../base/io_system.h"
+#include "../base/memory_usage.h"
+#include "../base/mesh_decimation.h"
 #include "../base/messenger.h"
+#include "../base/profiler.h"
 #include "../base/settings.h"
+#include "../base/string_conv.h"
 #include "../base/task_manager.h"
+#include "../base/text_id.h"
+#include "../base/xcaf.h"
 #include "../io_dxf/io_dxf.h"
 #include "../io_gmio/io_gmio.h"
 #include "../io_occ/io_occ.h"
 #include "../graphics/graphics_object_driver.h"
 #include "../gui/gui_application.h"
+#include "../gui/gui_document.h"
+#include "../gui/gui_image_renderer.h"
+#include "../gui/gui_render_benchmark.h"
 #include "app_module.h"
 #include "console.h"
 #include "document_tree_node_properties_providers.h"
 #include "mainwindow.h"
+#include "qstring_utils.h"
 #include "theme.h"
 #include "version.h"
 #include "widget_model_tree.h"
@@ -28,35 +41,81 @@
 #include <QtCore/QtDebug>
 #include <QtCore/QCommandLineParser>
 #include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileSystemWatcher>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QSet>
 #include <QtCore/QSettings>
 #include <QtCore/QTimer>
 #include <QtCore/QTranslator>
 #include <QtWidgets/QApplication>
 
 #include <Message.hxx>
+#include <gsl/util>
 
+#include <algorithm>
+#include <chrono>
 #include <cstdlib>
 #include <iostream>
 #include <iomanip>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
 #include <unordered_map>
 
 #ifdef Q_OS_WIN
 #  include <windows.h> // For AttachConsole(), etc.
 #endif
+#ifdef Q_OS_UNIX
+#  include <sys/resource.h> // For getrusage()
+#endif
 
 namespace Mayo {
 
 class Main { Q_DECLARE_TR_FUNCTIONS(Mayo::Main) };
 
 struct CommandLineArguments {
+    struct RenderView {
+        QString name;
+        V3d_TypeOfOrientation projection;
+    };
+
     QString themeName;
     FilePath filepathSettings;
     std::vector<FilePath> listFilepathToExport;
     std::vector<FilePath> listFilepathToOpen;
+    int exportLodCount = 1;
+    bool decimateMeshes = false;
+    MeshDecimation::Options meshDecimation; // Options of decimation if 'decimateMeshes' is on
+    FilePath renderDirPath;
+    std::vector<RenderView> listRenderView;
+    QSize renderSize = { 512, 512 };
+    bool renderBenchmark = false;
+    QString reportFormat; // Format of the report printed at the end of CLI export, "json" only
+    QString batchManifest; // "-" for standard input
+    bool exportEach = false;
+    bool watchInputs = false;
+    int jobCount = 0; // Maximum count of concurrent jobs, default if <= 0
+    TaskManager::WorkerPlacement workerPlacement = TaskManager::WorkerPlacement::None;
     bool cliProgressReport = true;
 };
 
+// Views accepted by command-line option --render-views
+static const CommandLineArguments::RenderView cliRenderViews[] = {
+    { "iso", V3d_XposYnegZpos },
+    { "back", V3d_Ypos },
+    { "front", V3d_Yneg },
+    { "left", V3d_Xneg },
+    { "right", V3d_Xpos },
+    { "top", V3d_Zpos },
+    { "bottom", V3d_Zneg }
+};
+
 static CommandLineArguments processCommandLine()
 {
     CommandLineArguments args;
@@ -87,6 +146,98 @@ static CommandLineArguments processCommandLine()
                 Main::tr("filepath"));
     cmdParser.addOption(cmdFileToExport);
 
+    const QCommandLineOption cmdExportLodCount(
+                QStringList{ "export-lod" },
+                Main::tr("Count of levels of detail(LOD) to export for mesh formats. Each extra level "
+                         "is twice coarser than the previous one and written in a separate file "
+                         "suffixed with _lodN(eg. -e file.obj --export-lod 3 writes file.obj, "
+                         "file_lod1.obj and file_lod2.obj)"),
+                Main::tr("count"));
+    cmdParser.addOption(cmdExportLodCount);
+
+    const QCommandLineOption cmdDecimate(
+                QStringList{ "decimate" },
+                Main::tr("Decimate the meshes of opened files before export. Target is either a ratio "
+                         "of the input triangle count if lower than 1(eg. --decimate 0.25) or a count "
+                         "of triangles per mesh(eg. --decimate 100000)"),
+                Main::tr("target"));
+    cmdParser.addOption(cmdDecimate);
+
+    const QCommandLineOption cmdRenderDir(
+                QStringList{ "render-dir" },
+                Main::tr("Render opened files into PNG images written in a folder, without GUI. One "
+                         "image <file>_<view>.png is written per file and view"),
+                Main::tr("folder"));
+    cmdParser.addOption(cmdRenderDir);
+
+    const QCommandLineOption cmdRenderViews(
+                QStringList{ "render-views" },
+                Main::tr("Comma-separated list of the views to render(iso|back|front|left|right|top|bottom), "
+                         "defaults to iso"),
+                Main::tr("views"));
+    cmdParser.addOption(cmdRenderViews);
+
+    const QCommandLineOption cmdRenderSize(
+                QStringList{ "render-size" },
+                Main::tr("Size in pixels of the rendered images(eg. 256x256), defaults to 512x512"),
+                Main::tr("size"));
+    cmdParser.addOption(cmdRenderSize);
+
+    const QCommandLineOption cmdRenderBenchmark(
+                QStringList{ "render-bench" },
+                Main::tr("Measure rendering performance of opened files, without GUI. Prints a JSON "
+                         "object per file with presentation time, first frame time, average frame "
+                         "time during a camera orbit and picking latency. View size is controlled "
+                         "with --render-size"));
+    cmdParser.addOption(cmdRenderBenchmark);
+
+    const QCommandLineOption cmdReport(
+                QStringList{ "report" },
+                Main::tr("Print a report once export is finished(CLI-mode only), with the timing of "
+                         "each import/export phase per file, peak memory, entity counts and mass "
+                         "properties of BRep entities. Only "
+                         "'json' format is supported, combine with --no-progress to get clean output"),
+                Main::tr("format"));
+    cmdParser.addOption(cmdReport);
+
+    const QCommandLineOption cmdBatch(
+                QStringList{ "batch" },
+                Main::tr("Run conversion jobs read from a manifest file, or standard input if '-', "
+                         "without GUI. Each line is a JSON job {\"id\": ..., \"inputs\": [files...], "
+                         "\"outputs\": [files...]}, jobs are executed concurrently and each result is "
+                         "written as a JSON line on standard output"),
+                Main::tr("manifest"));
+    cmdParser.addOption(cmdBatch);
+
+    const QCommandLineOption cmdExportEach(
+                QStringList{ "each" },
+                Main::tr("Export each input file separately into its own document. Export file paths "
+                         "are then patterns where {stem}, {filename} and {dir} are replaced by the "
+                         "corresponding part of the input file path(eg. --each -e {stem}.glb)"));
+    cmdParser.addOption(cmdExportEach);
+
+    const QCommandLineOption cmdWatch(
+                QStringList{ "watch" },
+                Main::tr("Watch input files and folders(recursively), without GUI. Each input file is "
+                         "exported again when it changes, export file paths are patterns as with "
+                         "--each. At start only the input files more recent than their export files "
+                         "are exported. Keeps running until interrupted"));
+    cmdParser.addOption(cmdWatch);
+
+    const QCommandLineOption cmdJobCount(
+                QStringList{ "jobs" },
+                Main::tr("Maximum count of jobs executed concurrently with --each or --batch, "
+                         "defaults to the number of hardware threads"),
+                Main::tr("count"));
+    cmdParser.addOption(cmdJobCount);
+
+    const QCommandLineOption cmdWorkerPlacement(
+                QStringList{ "worker-placement" },
+                Main::tr("Binding of the CLI worker threads to CPUs(none|cpu|numa). With 'numa' "
+                         "workers are spread across NUMA nodes and a job stays on one node"),
+                Main::tr("placement"));
+    cmdParser.addOption(cmdWorkerPlacement);
+
     const QCommandLineOption cmdCliNoProgress(
                 QStringList{ "no-progress" },
                 Main::tr("Disable progress reporting in console output(CLI-mode only)"));
@@ -112,6 +263,69 @@ static CommandLineArguments processCommandLine()
             args.listFilepathToExport.push_back(filepathFrom(strFilepath));
     }
 
+    if (cmdParser.isSet(cmdExportLodCount))
+        args.exportLodCount = std::max(1, cmdParser.value(cmdExportLodCount).toInt());
+
+    if (cmdParser.isSet(cmdDecimate)) {
+        const double target = cmdParser.value(cmdDecimate).toDouble();
+        args.decimateMeshes = target > 0;
+        if (target > 0 && target < 1)
+            args.meshDecimation.targetRatio = target;
+        else if (target >= 1)
+            args.meshDecimation.targetTriangleCount = int(target);
+        else
+            qWarning() << Main::tr("Invalid decimation target '%1'").arg(cmdParser.value(cmdDecimate));
+    }
+
+    if (cmdParser.isSet(cmdRenderDir))
+        args.renderDirPath = filepathFrom(cmdParser.value(cmdRenderDir));
+
+    const QStringList listRenderViewName =
+            cmdParser.isSet(cmdRenderViews) ?
+                cmdParser.value(cmdRenderViews).split(',', QString::SkipEmptyParts) :
+                QStringList{ "iso" };
+    for (const QString& viewName : listRenderViewName) {
+        auto itView = std::find_if(
+                    std::cbegin(cliRenderViews), std::cend(cliRenderViews), [&](const auto& view) {
+            return view.name == viewName.trimmed();
+        });
+        if (itView != std::cend(cliRenderViews))
+            args.listRenderView.push_back(*itView);
+        else
+            qWarning() << Main::tr("Unknown render view '%1'").arg(viewName);
+    }
+
+    if (cmdParser.isSet(cmdRenderSize)) {
+        const QStringList listSizeValue = cmdParser.value(cmdRenderSize).split('x');
+        if (listSizeValue.size() == 2)
+            args.renderSize = QSize(listSizeValue.at(0).toInt(), listSizeValue.at(1).toInt());
+    }
+
+    args.renderBenchmark = cmdParser.isSet(cmdRenderBenchmark);
+    if (cmdParser.isSet(cmdReport)) {
+        args.reportFormat = cmdParser.value(cmdReport);
+        if (args.reportFormat != "json")
+            qWarning() << Main::tr("Unknown report format '%1'").arg(args.reportFormat);
+    }
+
+    if (cmdParser.isSet(cmdBatch))
+        args.batchManifest = cmdParser.value(cmdBatch);
+
+    args.exportEach = cmdParser.isSet(cmdExportEach);
+    args.watchInputs = cmdParser.isSet(cmdWatch);
+    if (cmdParser.isSet(cmdJobCount))
+        args.jobCount = cmdParser.value(cmdJobCount).toInt();
+
+    if (cmdParser.isSet(cmdWorkerPlacement)) {
+        const QString strPlacement = cmdParser.value(cmdWorkerPlacement);
+        if (strPlacement == "cpu")
+            args.workerPlacement = TaskManager::WorkerPlacement::Cpu;
+        else if (strPlacement == "numa")
+            args.workerPlacement = TaskManager::WorkerPlacement::NumaNode;
+        else if (strPlacement != "none")
+            qWarning() << Main::tr("Unknown worker placement '%1'").arg(strPlacement);
+    }
+
     for (const QString& posArg : cmdParser.positionalArguments())
         args.listFilepathToOpen.push_back(filepathFrom(posArg));
 
@@ -146,6 +360,61 @@ static void qtMessageHandler(QtMsgType type, const QMessageLogContext& /*context
     }
 }
 
+// Durations of application startup phases, reported on stderr once main window is displayed if
+// environment variable MAYO_STARTUP_REPORT is defined
+struct StartupPhaseTime {
+    const char* name;
+    int64_t durationUsec;
+};
+
+static std::vector<StartupPhaseTime> startupPhaseTimes;
+
+static bool isStartupReportOn()
+{
+    static const bool on = !qEnvironmentVariableIsEmpty("MAYO_STARTUP_REPORT");
+    return on;
+}
+
+// Measures the enclosing scope as a startup phase, also recorded as a profiling zone
+class StartupPhase {
+public:
+    StartupPhase(const char* name)
+        : m_name(name), m_start(std::chrono::steady_clock::now()), m_profilerZone(name)
+    {}
+
+    ~StartupPhase() {
+        if (isStartupReportOn()) {
+            const auto duration = std::chrono::steady_clock::now() - m_start;
+            const auto durationUsec = std::chrono::duration_cast<std::chrono::microseconds>(duration);
+            startupPhaseTimes.push_back({ m_name, durationUsec.count() });
+        }
+    }
+
+private:
+    const char* m_name;
+    std::chrono::steady_clock::time_point m_start;
+    ProfilerZone m_profilerZone;
+};
+
+static void printStartupReport(std::chrono::steady_clock::time_point startTime)
+{
+    if (!isStartupReportOn())
+        return;
+
+    const auto duration = std::chrono::steady_clock::now() - startTime;
+    std::cerr << "Startup phases(ms):" << std::endl;
+    for (const StartupPhaseTime& phase : startupPhaseTimes) {
+        std::cerr << "    " << std::left << std::setw(24) << phase.name
+                  << std::right << std::setw(10) << std::fixed << std::setprecision(1)
+                  << phase.durationUsec / 1000. << std::endl;
+    }
+
+    std::cerr << "    " << std::left << std::setw(24) << "Total(until first paint)"
+              << std::right << std::setw(10) << std::fixed << std::setprecision(1)
+              << std::chrono::duration_cast<std::chrono::microseconds>(duration).count() / 1000.
+              << std::endl;
+}
+
 static std::unique_ptr<Theme> globalTheme;
 
 // Declared in theme.h
@@ -157,23 +426,35 @@ Theme* mayoTheme()
 // Initializes "Base" objects
 static void initBase(QCoreApplication* qtApp)
 {
-    Application::setOpenCascadeEnvironment("opencascade.conf");
+    {
+        const StartupPhase phase("OpenCascade environment");
+        Application::setOpenCascadeEnvironment("opencascade.conf");
+    }
+
     auto app = Application::instance();
 
     // Load translation files
     {
+        const StartupPhase phase("Translations");
         const QString qmFilePath = AppModule::qmFilePath(AppModule::languageCode(app));
         auto translator = new QTranslator(app.get());
-        if (translator->load(qmFilePath))
+        if (translator->load(qmFilePath)) {
             qtApp->installTranslator(translator);
+            // Some texts might have been translated before, with no translator
+            TextId::invalidateTrCache();
+        }
         else
             qWarning() << Main::tr("Failed to load translation for '%1'").arg(qmFilePath);
     }
 
     // Register I/O objects
+    // Note: factories are stateless, actual readers/writers are created on first use of a format
+    const StartupPhase phase("I/O and providers");
     app->ioSystem()->addFactoryReader(std::make_unique<IO::OccFactoryReader>());
     app->ioSystem()->addFactoryReader(std::make_unique<IO::DxfFactoryReader>());
+    app->ioSystem()->addFactoryReader(IO::GmioFactoryReader::create());
     app->ioSystem()->addFactoryWriter(std::make_unique<IO::OccFactoryWriter>());
+    app->ioSystem()->addFactoryWriter(std::make_unique<IO::DxfFactoryWriter>());
     app->ioSystem()->addFactoryWriter(IO::GmioFactoryWriter::create());
     IO::addPredefinedFormatProbes(app->ioSystem());
 
@@ -182,6 +463,8 @@ static void initBase(QCoreApplication* qtApp)
                 std::make_unique<XCaf_DocumentTreeNodePropertiesProvider>());
     app->documentTreeNodePropertiesProviderTable()->addProvider(
                 std::make_unique<Mesh_DocumentTreeNodePropertiesProvider>());
+    app->documentTreeNodePropertiesProviderTable()->addProvider(
+                std::make_unique<PointCloud_DocumentTreeNodePropertiesProvider>());
 }
 
 // Initializes "GUI" objects
@@ -197,8 +480,61 @@ static void initGui(GuiApplication* guiApp)
     // Register Graphics entity drivers
     guiApp->graphicsObjectDriverTable()->addDriver(std::make_unique<GraphicsShapeObjectDriver>());
     guiApp->graphicsObjectDriverTable()->addDriver(std::make_unique<GraphicsMeshObjectDriver>());
+    guiApp->graphicsObjectDriverTable()->addDriver(std::make_unique<GraphicsPointCloudObjectDriver>());
+}
+
+// Returns peak resident memory of the current process in bytes, or -1 if not available
+static int64_t cli_peakMemoryUsage()
+{
+#if defined(Q_OS_UNIX)
+    struct rusage usage = {};
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return -1;
+
+#  if defined(Q_OS_MACOS)
+    return int64_t(usage.ru_maxrss); // Bytes
+#  else
+    return int64_t(usage.ru_maxrss) * 1024; // Kilobytes
+#  endif
+#else
+    return -1;
+#endif
+}
+
+static const char* cli_phaseName(IO::System::Phase phase)
+{
+    switch (phase) {
+    case IO::System::Phase::Probe: return "probe";
+    case IO::System::Phase::Read: return "read";
+    case IO::System::Phase::Transfer: return "transfer";
+    case IO::System::Phase::PostProcess: return "post-process";
+    case IO::System::Phase::ExportTransfer: return "export-transfer";
+    case IO::System::Phase::ExportWrite: return "export-write";
+    }
+
+    return "";
 }
 
+// Collects emitted error messages into a single string object
+// Messages might be emitted concurrently by reader threads, a repeated message is collected once
+struct ErrorMessageCollect : public Messenger {
+    QString message;
+    void emitMessage(MessageType msgType, const QString& text) override {
+        if (msgType != MessageType::Error)
+            return;
+
+        std::lock_guard<std::mutex> lock(this->mutex);
+        if (!this->setText.contains(text)) {
+            this->setText.insert(text);
+            this->message += text + " ";
+        }
+    }
+
+private:
+    std::mutex mutex;
+    QSet<QString> setText;
+};
+
 // Asynchronously exports input file(s) listed in 'args'
 // Calls 'fnContinuation' at the end of execution
 static void cli_asyncExportDocuments(
@@ -220,23 +556,113 @@ static void cli_asyncExportDocuments(
         std::unordered_map<TaskId, int> mapTaskLineWidth;
         // Count of progress lines in console after last call to fnPrintProgress()
         int lastPrintProgressLineCount = 0;
-    };
-
-    // Collects emitted error messages into a single string object
-    struct ErrorMessageCollect : public Messenger {
-        QString message;
-        void emitMessage(MessageType msgType, const QString& text) override {
-            if (msgType == MessageType::Error)
-                message += text + " ";
-        }
+        // Task exporting levels of detail
+        TaskId exportLodsTaskId = 0;
+        // Data of the report printed at exit(option --report)
+        std::mutex mutexPhaseReport;
+        std::vector<IO::System::PhaseReport> vecPhaseReport;
+        std::vector<std::pair<QString, TaskStats>> vecTaskReport; // Title and final stats of tasks
+        // Throughput/ETA of the tasks printed along with progress
+        std::unordered_map<TaskId, TaskStatsHistory> mapTaskStatsHistory;
+        std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+        int entityCount = 0;
+        int treeNodeCount = 0;
+        std::vector<std::pair<QString, MemoryUsage>> vecEntityMemoryUsage;
+        MemoryUsage docMemoryUsage;
+        std::vector<std::pair<QString, BRepMassProperties>> vecEntityMassProperties;
     };
 
     auto helper = new Helper; // Allocated on heap because current function is asynchronous
     auto taskMgr = &helper->taskMgr;
+    taskMgr->setWorkerPlacement(args.workerPlacement);
     auto appModule = AppModule::get(app);
 
+    // Helper function to collect the timing of import/export phases
+    auto fnPhaseFinished = [=](const IO::System::PhaseReport& report) {
+        std::lock_guard<std::mutex> lock(helper->mutexPhaseReport);
+        helper->vecPhaseReport.push_back(report);
+    };
+    // Helper function to print the report requested with option --report
+    auto fnPrintReport = [=](int retCode) {
+        if (args.reportFormat != "json")
+            return;
+
+        QJsonArray jsonPhases;
+        {
+            std::lock_guard<std::mutex> lock(helper->mutexPhaseReport);
+            for (const IO::System::PhaseReport& report : helper->vecPhaseReport) {
+                QJsonObject jsonPhase;
+                jsonPhase.insert("file", filepathTo<QString>(report.filepath));
+                jsonPhase.insert("format", QString::fromUtf8(IO::formatIdentifier(report.format).data()));
+                jsonPhase.insert("phase", cli_phaseName(report.phase));
+                jsonPhase.insert("elapsedMs", report.elapsedUsec / 1000.);
+                jsonPhases.append(jsonPhase);
+            }
+        }
+
+        QJsonArray jsonTasks;
+        {
+            std::lock_guard<std::mutex> lock(helper->mutexPhaseReport);
+            for (const auto& [taskTitle, stats] : helper->vecTaskReport) {
+                QJsonObject jsonTask;
+                jsonTask.insert("title", taskTitle);
+                jsonTask.insert("elapsedMs", double(stats.elapsedMs));
+                jsonTask.insert("processedBytes", double(stats.processedBytes));
+                jsonTask.insert("processedEntities", double(stats.processedEntities));
+                const double elapsedSecs = stats.elapsedMs / 1000.;
+                if (elapsedSecs > 0) {
+                    jsonTask.insert("bytesPerSecond", stats.processedBytes / elapsedSecs);
+                    jsonTask.insert("entitiesPerSecond", stats.processedEntities / elapsedSecs);
+                }
+
+                jsonTasks.append(jsonTask);
+            }
+        }
+
+        const auto elapsed = std::chrono::steady_clock::now() - helper->startTime;
+        QJsonObject jsonReport;
+        jsonReport.insert("success", retCode == EXIT_SUCCESS);
+        jsonReport.insert("elapsedMs", double(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count()));
+        jsonReport.insert("peakMemoryBytes", double(cli_peakMemoryUsage()));
+        jsonReport.insert("entityCount", helper->entityCount);
+        jsonReport.insert("treeNodeCount", helper->treeNodeCount);
+        auto fnJsonMemoryUsage = [](const MemoryUsage& usage) {
+            QJsonObject jsonUsage;
+            jsonUsage.insert("brepBytes", double(usage.brepBytes));
+            jsonUsage.insert("triangulationBytes", double(usage.triangulationBytes));
+            jsonUsage.insert("estimatedPresentationBytes", double(usage.estimatedPresentationBytes()));
+            return jsonUsage;
+        };
+        QJsonObject jsonMemory = fnJsonMemoryUsage(helper->docMemoryUsage);
+        QJsonArray jsonEntitiesMemory;
+        for (const auto& [entityName, usage] : helper->vecEntityMemoryUsage) {
+            QJsonObject jsonEntity = fnJsonMemoryUsage(usage);
+            jsonEntity.insert("name", entityName);
+            jsonEntitiesMemory.append(jsonEntity);
+        }
+
+        jsonMemory.insert("entities", jsonEntitiesMemory);
+        jsonReport.insert("memory", jsonMemory);
+        QJsonArray jsonMassProperties;
+        for (const auto& [entityName, massProps] : helper->vecEntityMassProperties) {
+            QJsonObject jsonEntity;
+            jsonEntity.insert("name", entityName);
+            jsonEntity.insert("faceCount", massProps.faceCount);
+            jsonEntity.insert("area", massProps.area);
+            jsonEntity.insert("volume", massProps.volume);
+            const gp_Pnt& centroid = massProps.centroid;
+            jsonEntity.insert("centroid", QJsonArray{ centroid.X(), centroid.Y(), centroid.Z() });
+            jsonMassProperties.append(jsonEntity);
+        }
+
+        jsonReport.insert("massProperties", jsonMassProperties);
+        jsonReport.insert("phases", jsonPhases);
+        jsonReport.insert("tasks", jsonTasks);
+        std::cout << QJsonDocument(jsonReport).toJson(QJsonDocument::Indented).toStdString() << std::flush;
+    };
     // Helper function to exit current function
     auto fnExit = [=](int retCode) {
+        fnPrintReport(retCode);
         helper->deleteLater();
         fnContinuation(retCode);
     };
@@ -265,6 +691,17 @@ static void cli_asyncExportDocuments(
                 lineWidth += 5;
                 if (progress >= 100)
                     consoleSetTextColor(ConsoleColor::Default);
+
+                if (!taskFinished) {
+                    TaskStatsHistory& statsHistory = helper->mapTaskStatsHistory[taskId];
+                    statsHistory.addSample(taskMgr->stats(taskId));
+                    const QString textStats = QStringUtils::text(statsHistory);
+                    if (!textStats.isEmpty()) {
+                        const std::string strStats = " (" + consoleToPrintable(textStats) + ")";
+                        std::cout << strStats;
+                        lineWidth += int(strStats.size());
+                    }
+                }
             }
 
             const int printWidth = consoleWidth();
@@ -302,8 +739,24 @@ static void cli_asyncExportDocuments(
         if (args.cliProgressReport)
             fnPrintProgress();
     });
+    // Final stats of tasks for the report, collected in the thread of the task as it's about to end
+    QObject::connect(taskMgr, &TaskManager::ended, [=](TaskId taskId) {
+        const TaskStats stats = taskMgr->stats(taskId);
+        std::lock_guard<std::mutex> lock(helper->mutexPhaseReport);
+        helper->vecTaskReport.push_back({ taskMgr->title(taskId), stats });
+    });
 
-    helper->exportTaskCount = int(args.listFilepathToExport.size());
+    // If export operation targets some mesh format then force meshing of imported BRep shapes
+    bool brepMeshRequired = false;
+    for (const FilePath& filepath : args.listFilepathToExport) {
+        const IO::Format format = app->ioSystem()->probeFormat(filepath);
+        brepMeshRequired = IO::formatProvidesMesh(format);
+        if (brepMeshRequired)
+            break; // Interrupt
+    }
+
+    const bool hasExportLods = args.exportLodCount > 1 && brepMeshRequired;
+    helper->exportTaskCount = int(args.listFilepathToExport.size()) + (hasExportLods ? 1 : 0);
     QObject::connect(taskMgr, &TaskManager::ended, app, [=]{
         if (helper->exportTaskCount == 0) {
             bool okExport = true;
@@ -316,15 +769,6 @@ static void cli_asyncExportDocuments(
         }
     });
 
-    // If export operation targets some mesh format then force meshing of imported BRep shapes
-    bool brepMeshRequired = false;
-    for (const FilePath& filepath : args.listFilepathToExport) {
-        const IO::Format format = app->ioSystem()->probeFormat(filepath);
-        brepMeshRequired = IO::formatProvidesMesh(format);
-        if (brepMeshRequired)
-            break; // Interrupt
-    }
-
     // Suppress output from OpenCascade
     Message::DefaultMessenger()->RemovePrinters(Message_Printer::get_type_descriptor());
 
@@ -337,14 +781,50 @@ static void cli_asyncExportDocuments(
                 .targetDocument(doc)
                 .withFilepaths(args.listFilepathToOpen)
                 .withParametersProvider(appModule)
-                .withEntityPostProcess([=](TDF_Label labelEntity, TaskProgress* progress) {
+                .withGeometryDeduplicated(appModule->importDeduplicateGeometry)
+                .withModelTreeBuiltConcurrently(appModule->importConcurrentModelTreeBuild)
+                .withEntityPostProcess([=](TDF_Label labelEntity, IO::Format format, TaskProgress* progress) {
+                    appModule->healImportedShapes(labelEntity, format, progress);
                     appModule->computeBRepMesh(labelEntity, progress);
+                    appModule->repairImportedMesh(labelEntity, progress);
+                    if (args.decimateMeshes)
+                        MeshDecimation::decimateLabel(labelEntity, args.meshDecimation, progress);
+
+                    // BRep meshes are already reordered by computeBRepMesh()
+                    if (args.decimateMeshes || IO::formatProvidesMesh(format))
+                        appModule->reorderTriangulations(labelEntity, progress);
+
+                    appModule->compactTriangulations(labelEntity);
+                })
+                .withEntityPostProcessRequiredIf([=](IO::Format format) {
+                    const bool meshPostProcess =
+                            appModule->meshingRepairOnImport || appModule->meshingSinglePrecision
+                            || appModule->meshingReorder || args.decimateMeshes;
+                    return brepMeshRequired
+                            || (meshPostProcess && IO::formatProvidesMesh(format))
+                            || appModule->shapeHealingRequired(format);
                 })
-                .withEntityPostProcessRequiredIf([=](IO::Format){ return brepMeshRequired; })
                 .withEntityPostProcessInfoProgress(20, Main::tr("Mesh BRep shapes"))
                 .withMessenger(&errorCollect)
                 .withTaskProgress(progress)
+                .withPhaseFinished(fnPhaseFinished)
                 .execute();
+            helper->entityCount = doc->entityCount();
+            traverseTree_unorder(doc->modelTree(), [=](TreeNodeId) { ++(helper->treeNodeCount); });
+            if (args.reportFormat == "json") {
+                for (int i = 0; i < doc->entityCount(); ++i) {
+                    const TDF_Label labelEntity = doc->entityLabel(i);
+                    const QString entityName = to_QString(CafUtils::labelAttrStdName(labelEntity));
+                    helper->vecEntityMemoryUsage.push_back({ entityName, MemoryUsage::ofLabel(labelEntity) });
+                    if (XCaf::isShape(labelEntity)) {
+                        const auto massProps = BRepMassProperties::compute(XCaf::shape(labelEntity));
+                        helper->vecEntityMassProperties.push_back({ entityName, massProps });
+                    }
+                }
+
+                helper->docMemoryUsage = MemoryUsage::ofDocument(doc);
+            }
+
             taskMgr->setTitle(progress->taskId(), okImport ? Main::tr("Imported") : errorCollect.message);
             helper->mapTaskStatus.at(progress->taskId())->success = okImport;
             helper->mapTaskStatus.at(progress->taskId())->finished = true;
@@ -369,6 +849,7 @@ static void cli_asyncExportDocuments(
                             .withParameters(appModule->findWriterParameters(format))
                             .withMessenger(&errorCollect)
                             .withTaskProgress(progress)
+                            .withPhaseFinished(fnPhaseFinished)
                             .execute();
                 const QString msg = okExport ? Main::tr("Exported %1").arg(strFilename) : errorCollect.message;
                 taskMgr->setTitle(progress->taskId(), msg);
@@ -380,12 +861,731 @@ static void cli_asyncExportDocuments(
         taskMgr->setTitle(taskId, Main::tr("Exporting %1...").arg(strFilename));
     }
 
+    // Levels of detail are exported by a task depending on all the other export tasks, as it replaces
+    // the triangulations of the document shapes
+    std::vector<TaskId> vecExportTaskId;
+    taskMgr->foreachTask([&](TaskId taskId) {
+        if (taskId != importTaskId)
+            vecExportTaskId.push_back(taskId);
+    });
+    if (hasExportLods) {
+        helper->exportLodsTaskId = taskMgr->newTaskAfter(vecExportTaskId, [=](TaskProgress* progress) {
+            ErrorMessageCollect errorCollect;
+            bool okExport = true;
+            const int lodCount = args.exportLodCount;
+            for (int lodLevel = 1; lodLevel < lodCount && okExport; ++lodLevel) {
+                TaskProgress lodProgress(progress, 100. / (lodCount - 1));
+                {
+                    TaskProgress meshProgress(&lodProgress, 50);
+                    for (int i = 0; i < doc->entityCount(); ++i) {
+                        TaskProgress entityProgress(&meshProgress, 100. / doc->entityCount());
+                        appModule->computeBRepMeshLod(doc->entityLabel(i), lodLevel, &entityProgress);
+                    }
+                }
+
+                TaskProgress exportProgress(&lodProgress, 50);
+                for (const FilePath& filepath : args.listFilepathToExport) {
+                    const IO::Format format = app->ioSystem()->probeFormat(filepath);
+                    if (!IO::formatProvidesMesh(format))
+                        continue;
+
+                    const std::string lodSuffix = "_lod" + std::to_string(lodLevel);
+                    FilePath lodFilepath = filepath;
+                    lodFilepath.replace_filename(filepath.stem().u8string() + lodSuffix);
+                    lodFilepath.replace_extension(filepath.extension());
+                    const ApplicationItem appItems[] = { doc };
+                    TaskProgress fileProgress(&exportProgress, 100. / args.listFilepathToExport.size());
+                    okExport = okExport && app->ioSystem()->exportApplicationItems()
+                            .targetFile(lodFilepath)
+                            .targetFormat(format)
+                            .withItems(appItems)
+                            .withParameters(appModule->findWriterParameters(format))
+                            .withMessenger(&errorCollect)
+                            .withTaskProgress(&fileProgress)
+                            .withPhaseFinished(fnPhaseFinished)
+                            .execute();
+                }
+            }
+
+            const QString msg = okExport ? Main::tr("Exported %1 levels of detail").arg(lodCount) : errorCollect.message;
+            taskMgr->setTitle(progress->taskId(), msg);
+            helper->mapTaskStatus.at(progress->taskId())->success = okExport;
+            helper->mapTaskStatus.at(progress->taskId())->finished = true;
+            --(helper->exportTaskCount);
+        });
+        helper->mapTaskStatus.insert({ helper->exportLodsTaskId, std::make_unique<TaskStatus>() });
+        taskMgr->setTitle(helper->exportLodsTaskId, Main::tr("Exporting levels of detail..."));
+    }
+
     taskMgr->foreachTask([=](TaskId taskId) {
         if (taskId != importTaskId)
             taskMgr->run(taskId, TaskAutoDestroy::Off);
     });
 }
 
+// Imports files 'spanFilepathIn' into 'doc' then exports the document into each file of 'spanFilepathOut'
+// BRep shapes are meshed if any of the output formats requires a mesh. When the writers can mesh
+// on the fly, BRep meshing is deferred to export so meshes don't all live in memory at once
+// Meshes are decimated before export if 'meshDecimation' isn't null
+// Blocking function, error messages are collected into 'ptrErrorMessage'
+static bool cli_convertFiles(
+        Application* app,
+        const DocumentPtr& doc,
+        Span<const FilePath> spanFilepathIn,
+        Span<const FilePath> spanFilepathOut,
+        const MeshDecimation::Options* meshDecimation,
+        TaskProgress* progress,
+        QString* ptrErrorMessage)
+{
+    auto appModule = AppModule::get(app);
+    const bool brepMeshRequired = std::any_of(spanFilepathOut.begin(), spanFilepathOut.end(), [=](const FilePath& fp) {
+        return IO::formatProvidesMesh(app->ioSystem()->probeFormat(fp));
+    });
+    // Decimation acts on the imported meshes, so BRep meshes can't be deferred in that case
+    const bool brepMeshOnExport = brepMeshRequired && !meshDecimation
+            && std::all_of(spanFilepathOut.begin(), spanFilepathOut.end(), [=](const FilePath& fp) {
+        const IO::Format format = app->ioSystem()->probeFormat(fp);
+        if (!IO::formatProvidesMesh(format))
+            return true;
+
+        auto writer = app->ioSystem()->createWriter(format);
+        return writer && writer->supportsShapeMesher();
+    });
+    // Meshes computed by a writer can be released only if no other export needs them
+    const bool releaseMeshes = brepMeshOnExport && spanFilepathOut.size() == 1;
+
+    ErrorMessageCollect errorCollect;
+    auto _ = gsl::finally([&]{
+        if (ptrErrorMessage)
+            *ptrErrorMessage = errorCollect.message.trimmed();
+    });
+
+    const double exportPortionSize = !spanFilepathOut.empty() ? 50. / spanFilepathOut.size() : 0.;
+    {
+        TaskProgress importProgress(progress, 100 - exportPortionSize * spanFilepathOut.size());
+        const bool okImport = app->ioSystem()->importInDocument()
+                .targetDocument(doc)
+                .withFilepaths(spanFilepathIn)
+                .withParametersProvider(appModule)
+                .withGeometryDeduplicated(appModule->importDeduplicateGeometry)
+                .withModelTreeBuiltConcurrently(appModule->importConcurrentModelTreeBuild)
+                .withEntityPostProcess([=](TDF_Label labelEntity, IO::Format format, TaskProgress* progress) {
+                    appModule->healImportedShapes(labelEntity, format, progress);
+                    if (!brepMeshOnExport)
+                        appModule->computeBRepMesh(labelEntity, progress);
+
+                    appModule->repairImportedMesh(labelEntity, progress);
+                    if (meshDecimation)
+                        MeshDecimation::decimateLabel(labelEntity, *meshDecimation, progress);
+
+                    // BRep meshes are already reordered by computeBRepMesh()
+                    if (meshDecimation || IO::formatProvidesMesh(format))
+                        appModule->reorderTriangulations(labelEntity, progress);
+
+                    appModule->compactTriangulations(labelEntity);
+                })
+                .withEntityPostProcessRequiredIf([=](IO::Format format) {
+                    const bool meshPostProcess =
+                            appModule->meshingRepairOnImport || appModule->meshingSinglePrecision
+                            || appModule->meshingReorder || meshDecimation;
+                    return (brepMeshRequired && !brepMeshOnExport)
+                            || (meshPostProcess && IO::formatProvidesMesh(format))
+                            || appModule->shapeHealingRequired(format);
+                })
+                .withEntityPostProcessInfoProgress(20, Main::tr("Mesh BRep shapes"))
+                .withMessenger(&errorCollect)
+                .withTaskProgress(&importProgress)
+                .execute();
+        if (!okImport)
+            return false;
+    }
+
+    bool okExport = true;
+    for (const FilePath& filepath : spanFilepathOut) {
+        TaskProgress exportProgress(progress, exportPortionSize);
+        const IO::Format format = app->ioSystem()->probeFormat(filepath);
+        const ApplicationItem appItems[] = { doc };
+        okExport = app->ioSystem()->exportApplicationItems()
+                .targetFile(filepath)
+                .targetFormat(format)
+                .withItems(appItems)
+                .withParameters(appModule->findWriterParameters(format))
+                .withShapeMesher(
+                    brepMeshOnExport && IO::formatProvidesMesh(format) ?
+                        IO::ShapeMesher([=](const TopoDS_Shape& shape, TaskProgress* progress) {
+                            appModule->computeBRepMesh(shape, progress);
+                        })
+                        : IO::ShapeMesher{},
+                    releaseMeshes)
+                .withMessenger(&errorCollect)
+                .withTaskProgress(&exportProgress)
+                .execute()
+                && okExport;
+    }
+
+    return okExport;
+}
+
+// Returns the export file path built from 'pattern' for input file 'filepathIn'
+// Placeholders {stem}, {filename} and {dir} are replaced by the corresponding parts of 'filepathIn'
+static FilePath cli_exportFilepath(const FilePath& pattern, const FilePath& filepathIn)
+{
+    QString strFilepath = filepathTo<QString>(pattern);
+    strFilepath.replace("{stem}", filepathTo<QString>(filepathIn.stem()));
+    strFilepath.replace("{filename}", filepathTo<QString>(filepathIn.filename()));
+    strFilepath.replace("{dir}", filepathTo<QString>(filepathIn.parent_path()));
+    return filepathFrom(strFilepath);
+}
+
+// Asynchronously runs independent conversion jobs, each one having its own document
+// Jobs are either read from manifest 'args.batchManifest'(JSON lines) or built from input files
+// with option --each(one job per input file). Application objects are shared by all jobs, which are
+// executed concurrently as soon as available(at most 'args.jobCount' at a time). Document of a job
+// is closed once it is finished, and the result is reported(JSON line on standard output for
+// batch mode)
+// Calls 'fnContinuation' when all jobs are finished
+static void cli_asyncBatchJobs(
+        Application* app, const CommandLineArguments& args, std::function<void(int)> fnContinuation)
+{
+    struct Job {
+        QJsonValue id;
+        DocumentPtr doc;
+        std::vector<FilePath> listFilepathIn;
+        std::vector<FilePath> listFilepathOut;
+        bool success = false;
+        QString errorMessage;
+    };
+
+    struct Helper : public QObject {
+        // Task manager object dedicated to the scope of current function
+        TaskManager taskMgr;
+        // Mapping between a task id and the job it executes
+        std::unordered_map<TaskId, std::unique_ptr<Job>> mapJob;
+        // Lines read from standard input by a separate thread, pulled periodically by 'timerPull'
+        std::mutex mutexLine;
+        std::vector<std::string> vecLine;
+        bool isInputFinished = false;
+        QTimer timerPull;
+        bool success = true;
+        int startedJobCount = 0;
+    };
+
+    auto helper = new Helper; // Allocated on heap because current function is asynchronous
+    auto taskMgr = &helper->taskMgr;
+    if (args.jobCount > 0)
+        taskMgr->setMaxConcurrency(args.jobCount);
+
+    taskMgr->setWorkerPlacement(args.workerPlacement);
+
+    const bool isBatchMode = !args.batchManifest.isEmpty();
+    auto fnWriteResult = [=](const QJsonValue& id, bool ok, const QString& msg) {
+        if (!isBatchMode) {
+            if (ok)
+                qInfo().noquote() << Main::tr("Converted %1").arg(id.toString());
+            else
+                qCritical().noquote() << Main::tr("Failed to convert %1: %2").arg(id.toString(), msg);
+
+            return;
+        }
+
+        QJsonObject jsonResult;
+        jsonResult.insert("id", id);
+        jsonResult.insert("success", ok);
+        if (!msg.isEmpty())
+            jsonResult.insert("message", msg);
+
+        std::cout << QJsonDocument(jsonResult).toJson(QJsonDocument::Compact).toStdString() << std::endl;
+    };
+
+    auto fnExitIfDone = [=]{
+        if (helper->isInputFinished && helper->mapJob.empty()) {
+            const int retCode = helper->success ? EXIT_SUCCESS : EXIT_FAILURE;
+            helper->deleteLater();
+            fnContinuation(retCode);
+        }
+    };
+
+    auto fnStartJob = [=](std::unique_ptr<Job> job) {
+        job->doc = app->newDocument();
+        Job* ptrJob = job.get();
+        const TaskId taskId = taskMgr->newTask([=](TaskProgress* progress) {
+            ptrJob->success = cli_convertFiles(
+                        app, ptrJob->doc,
+                        ptrJob->listFilepathIn, ptrJob->listFilepathOut,
+                        args.decimateMeshes ? &args.meshDecimation : nullptr,
+                        progress, &ptrJob->errorMessage);
+        });
+        // Jobs are dealt round-robin to NUMA nodes, whatever the worker picking them
+        if (args.workerPlacement == TaskManager::WorkerPlacement::NumaNode)
+            taskMgr->setNumaNode(taskId, helper->startedJobCount % CpuTopology::numaNodeCount());
+
+        ++helper->startedJobCount;
+        helper->mapJob.insert({ taskId, std::move(job) });
+        taskMgr->run(taskId);
+    };
+
+    auto fnSubmitJob = [=](const QByteArray& line) {
+        if (line.trimmed().isEmpty())
+            return;
+
+        QJsonParseError jsonError;
+        const QJsonDocument jsonDoc = QJsonDocument::fromJson(line, &jsonError);
+        const QJsonObject jsonJob = jsonDoc.object();
+        auto job = std::make_unique<Job>();
+        job->id = jsonJob.value("id");
+        for (const QJsonValue& value : jsonJob.value("inputs").toArray())
+            job->listFilepathIn.push_back(filepathFrom(value.toString()));
+
+        for (const QJsonValue& value : jsonJob.value("outputs").toArray())
+            job->listFilepathOut.push_back(filepathFrom(value.toString()));
+
+        QString strError;
+        if (!jsonDoc.isObject())
+            strError = Main::tr("Invalid job: %1").arg(jsonError.errorString());
+        else if (job->listFilepathIn.empty())
+            strError = Main::tr("No input files");
+        else if (job->listFilepathOut.empty())
+            strError = Main::tr("No output files");
+
+        if (!strError.isEmpty()) {
+            fnWriteResult(job->id, false, strError);
+            helper->success = false;
+            return;
+        }
+
+        fnStartJob(std::move(job));
+    };
+
+    QObject::connect(taskMgr, &TaskManager::ended, helper, [=](TaskId taskId) {
+        auto itJob = helper->mapJob.find(taskId);
+        if (itJob == helper->mapJob.end())
+            return;
+
+        const Job& job = *itJob->second;
+        fnWriteResult(job.id, job.success, job.errorMessage);
+        helper->success = helper->success && job.success;
+        app->closeDocument(job.doc); // Release memory as soon as possible
+        helper->mapJob.erase(itJob);
+        fnExitIfDone();
+    });
+
+    // Suppress output from OpenCascade
+    Message::DefaultMessenger()->RemovePrinters(Message_Printer::get_type_descriptor());
+
+    if (!isBatchMode) {
+        for (const FilePath& filepathIn : args.listFilepathToOpen) {
+            auto job = std::make_unique<Job>();
+            job->id = filepathTo<QString>(filepathIn);
+            job->listFilepathIn.push_back(filepathIn);
+            for (const FilePath& pattern : args.listFilepathToExport)
+                job->listFilepathOut.push_back(cli_exportFilepath(pattern, filepathIn));
+
+            fnStartJob(std::move(job));
+        }
+
+        helper->isInputFinished = true;
+        return fnExitIfDone();
+    }
+
+    if (args.batchManifest != "-") {
+        QFile fileManifest(args.batchManifest);
+        if (!fileManifest.open(QIODevice::ReadOnly)) {
+            qCritical().noquote() << Main::tr("Failed to open manifest '%1'").arg(args.batchManifest);
+            helper->deleteLater();
+            return fnContinuation(EXIT_FAILURE);
+        }
+
+        while (!fileManifest.atEnd())
+            fnSubmitJob(fileManifest.readLine());
+
+        helper->isInputFinished = true;
+        return fnExitIfDone();
+    }
+
+    // Standard input is read by a separate thread so jobs are started as soon as they're received
+    std::thread([=]{
+        std::string line;
+        while (std::getline(std::cin, line)) {
+            std::lock_guard<std::mutex> lock(helper->mutexLine);
+            helper->vecLine.push_back(std::move(line));
+        }
+
+        std::lock_guard<std::mutex> lock(helper->mutexLine);
+        helper->isInputFinished = true;
+    }).detach();
+
+    helper->timerPull.setInterval(50);
+    QObject::connect(&helper->timerPull, &QTimer::timeout, helper, [=]{
+        std::vector<std::string> vecLine;
+        bool isInputFinished = false;
+        {
+            std::lock_guard<std::mutex> lock(helper->mutexLine);
+            vecLine.swap(helper->vecLine);
+            isInputFinished = helper->isInputFinished;
+        }
+
+        for (const std::string& line : vecLine)
+            fnSubmitJob(QByteArray::fromStdString(line));
+
+        if (isInputFinished) {
+            helper->timerPull.stop();
+            fnExitIfDone();
+        }
+    });
+    helper->timerPull.start();
+}
+
+// Watches the input files and folders(recursively) listed in 'args', each input file is exported
+// again into its own document once it changed. Export file paths are patterns as with --each
+// At start, an input file is exported if any of its export files is missing or older. Then it's
+// exported each time its last modification timestamp differs from the one recorded at its previous
+// export(same logic as RecentFile::isThumbnailOutOfSync()). File system notifications are gathered
+// for a short delay, so a file still being written is exported once
+// Application objects are shared by all exports, so snapshots of reader parameters and cached
+// triangulations(if mesh cache is enabled in settings) are reused
+// Calls 'fnContinuation' only if there is nothing to watch, otherwise runs until interrupted
+static void cli_asyncWatchFolders(
+        Application* app, const CommandLineArguments& args, std::function<void(int)> fnContinuation)
+{
+    struct WatchedFile {
+        std::vector<FilePath> listFilepathOut;
+        int64_t exportTimestamp = -1; // Timestamp of the input file at its last export, -1 if none
+        TaskId exportTaskId = 0; // Export task running, 0 if none
+        bool isExportPending = false; // Changed while being exported
+    };
+
+    struct Export {
+        FilePath filepathIn;
+        DocumentPtr doc;
+        int64_t timestamp = 0;
+        bool success = false;
+        QString errorMessage;
+    };
+
+    struct Helper : public QObject {
+        // Task manager object dedicated to the scope of current function
+        TaskManager taskMgr;
+        QFileSystemWatcher watcher;
+        QTimer timerChanges; // Collects notifications of 'watcher' until timeout
+        QSet<QString> setChangedPath;
+        std::map<FilePath, WatchedFile> mapFile;
+        std::set<FilePath> setFilepathOut; // Export files of all the watched files, not to be watched
+        std::unordered_map<TaskId, std::unique_ptr<Export>> mapExport;
+    };
+
+    auto helper = new Helper; // Allocated on heap because current function is asynchronous
+    auto taskMgr = &helper->taskMgr;
+    if (args.jobCount > 0)
+        taskMgr->setMaxConcurrency(args.jobCount);
+
+    taskMgr->setWorkerPlacement(args.workerPlacement);
+
+    auto fnStartExport = [=](const FilePath& filepathIn) {
+        WatchedFile& watchedFile = helper->mapFile.at(filepathIn);
+        if (watchedFile.exportTaskId != 0) {
+            watchedFile.isExportPending = true;
+            return;
+        }
+
+        auto exportData = std::make_unique<Export>();
+        exportData->filepathIn = filepathIn;
+        exportData->doc = app->newDocument();
+        exportData->timestamp = RecentFile::lastModifiedTimestamp(filepathIn);
+        Export* ptrExport = exportData.get();
+        const std::vector<FilePath> listFilepathOut = watchedFile.listFilepathOut;
+        const TaskId taskId = taskMgr->newTask([=](TaskProgress* progress) {
+            ptrExport->success = cli_convertFiles(
+                        app, ptrExport->doc,
+                        Span<const FilePath>(&ptrExport->filepathIn, 1), listFilepathOut,
+                        args.decimateMeshes ? &args.meshDecimation : nullptr,
+                        progress, &ptrExport->errorMessage);
+        });
+        watchedFile.exportTaskId = taskId;
+        helper->mapExport.insert({ taskId, std::move(exportData) });
+        taskMgr->run(taskId);
+    };
+
+    // Registers input file 'filepath' if not watched yet, and exports it if out of sync
+    auto fnCheckFile = [=](const FilePath& filepath) {
+        const FilePath filepathIn = filepath.lexically_normal();
+        if (helper->setFilepathOut.find(filepathIn) != helper->setFilepathOut.cend())
+            return;
+
+        auto itFile = helper->mapFile.find(filepathIn);
+        const int64_t timestamp = RecentFile::lastModifiedTimestamp(filepathIn);
+        if (itFile != helper->mapFile.end()) {
+            // Files replaced by a rename(eg atomic save) are no longer watched
+            const QString strFilepathIn = filepathTo<QString>(filepathIn);
+            if (!helper->watcher.files().contains(strFilepathIn))
+                helper->watcher.addPath(strFilepathIn);
+
+            if (filepathExists(filepathIn) && timestamp != itFile->second.exportTimestamp)
+                fnStartExport(filepathIn);
+
+            return;
+        }
+
+        if (app->ioSystem()->probeFormat(filepathIn) == IO::Format_Unknown)
+            return;
+
+        WatchedFile watchedFile;
+        bool isOutOfSync = false;
+        for (const FilePath& pattern : args.listFilepathToExport) {
+            const FilePath filepathOut = cli_exportFilepath(pattern, filepathIn).lexically_normal();
+            watchedFile.listFilepathOut.push_back(filepathOut);
+            helper->setFilepathOut.insert(filepathOut);
+            isOutOfSync = isOutOfSync
+                    || !filepathExists(filepathOut)
+                    || RecentFile::lastModifiedTimestamp(filepathOut) < timestamp;
+        }
+
+        watchedFile.exportTimestamp = timestamp;
+        helper->mapFile.insert({ filepathIn, std::move(watchedFile) });
+        helper->watcher.addPath(filepathTo<QString>(filepathIn));
+        if (isOutOfSync)
+            fnStartExport(filepathIn);
+    };
+
+    // Watches 'folder' and its sub-folders, new files are checked
+    auto fnCheckFolder = [=](const FilePath& folder) {
+        namespace fs = std::filesystem;
+        QStringList listFolder = { filepathTo<QString>(folder) };
+        std::error_code ec;
+        constexpr auto options = fs::directory_options::skip_permission_denied;
+        for (fs::recursive_directory_iterator it(folder, options, ec), itEnd; !ec && it != itEnd; it.increment(ec)) {
+            std::error_code ecEntry;
+            if (it->is_directory(ecEntry))
+                listFolder.push_back(filepathTo<QString>(it->path()));
+        }
+
+        for (const QString& strFolder : listFolder) {
+            if (!helper->watcher.directories().contains(strFolder))
+                helper->watcher.addPath(strFolder);
+        }
+
+        for (const FilePath& filepath : IO::System::folderFiles(folder))
+            fnCheckFile(filepath);
+    };
+
+    QObject::connect(taskMgr, &TaskManager::ended, helper, [=](TaskId taskId) {
+        auto itExport = helper->mapExport.find(taskId);
+        if (itExport == helper->mapExport.end())
+            return;
+
+        const Export& exportData = *itExport->second;
+        const QString strFilepathIn = filepathTo<QString>(exportData.filepathIn);
+        if (exportData.success)
+            qInfo().noquote() << Main::tr("Converted %1").arg(strFilepathIn);
+        else
+            qCritical().noquote() << Main::tr("Failed to convert %1: %2").arg(strFilepathIn, exportData.errorMessage);
+
+        WatchedFile& watchedFile = helper->mapFile.at(exportData.filepathIn);
+        watchedFile.exportTaskId = 0;
+        watchedFile.exportTimestamp = exportData.timestamp;
+        const bool isExportPending = watchedFile.isExportPending;
+        watchedFile.isExportPending = false;
+        const FilePath filepathIn = exportData.filepathIn;
+        app->closeDocument(exportData.doc); // Release memory as soon as possible
+        helper->mapExport.erase(itExport);
+        if (isExportPending)
+            fnCheckFile(filepathIn);
+    });
+
+    auto fnPathChanged = [=](const QString& path) {
+        helper->setChangedPath.insert(path);
+        helper->timerChanges.start();
+    };
+    QObject::connect(&helper->watcher, &QFileSystemWatcher::fileChanged, helper, fnPathChanged);
+    QObject::connect(&helper->watcher, &QFileSystemWatcher::directoryChanged, helper, fnPathChanged);
+    helper->timerChanges.setSingleShot(true);
+    helper->timerChanges.setInterval(500);
+    QObject::connect(&helper->timerChanges, &QTimer::timeout, helper, [=]{
+        const QSet<QString> setChangedPath = std::move(helper->setChangedPath);
+        helper->setChangedPath.clear();
+        for (const QString& path : setChangedPath) {
+            const FilePath filepath = filepathFrom(path);
+            if (filepathIsDirectory(filepath))
+                fnCheckFolder(filepath);
+            else
+                fnCheckFile(filepath);
+        }
+    });
+
+    // Suppress output from OpenCascade
+    Message::DefaultMessenger()->RemovePrinters(Message_Printer::get_type_descriptor());
+
+    for (const FilePath& filepath : args.listFilepathToOpen) {
+        if (filepathIsDirectory(filepath))
+            fnCheckFolder(filepath);
+        else if (filepathIsRegularFile(filepath))
+            fnCheckFile(filepath);
+        else
+            qWarning().noquote() << Main::tr("Ignore '%1', not a file nor a folder").arg(filepathTo<QString>(filepath));
+    }
+
+    if (helper->watcher.files().isEmpty() && helper->watcher.directories().isEmpty()) {
+        qCritical().noquote() << Main::tr("No input files nor folders -> nothing to watch");
+        helper->deleteLater();
+        return fnContinuation(EXIT_FAILURE);
+    }
+
+    qInfo().noquote() << Main::tr("Watching %1 file(s)").arg(int(helper->mapFile.size()));
+}
+
+// Asynchronously renders input file(s) listed in 'args' into images, one per view listed in 'args'
+// In case of rendering benchmark(option --render-bench), performance of rendering is measured
+// instead for each document
+// Files are imported concurrently, each document is then rendered in the GUI thread once imported
+// while the writing of images to files runs concurrently
+// Calls 'fnContinuation' at the end of execution
+static void cli_asyncRenderDocuments(
+        GuiApplication* guiApp, const CommandLineArguments& args, std::function<void(int)> fnContinuation)
+{
+    struct ImportTask {
+        DocumentPtr doc;
+        FilePath filepath;
+        std::atomic<bool> success = {};
+    };
+
+    struct Helper : public QObject {
+        // Task manager object dedicated to the scope of current function
+        TaskManager taskMgr;
+        // Mapping between a task id and the import task data
+        std::unordered_map<TaskId, std::unique_ptr<ImportTask>> mapImportTask;
+        // Count of import/write tasks not finished yet, when 0 is reached then quit
+        int pendingTaskCount = 0;
+        std::atomic<bool> success = { true };
+    };
+
+    auto helper = new Helper; // Allocated on heap because current function is asynchronous
+    auto taskMgr = &helper->taskMgr;
+    auto app = guiApp->application().get();
+    auto appModule = AppModule::get(app);
+    GuiImageRenderer::Parameters renderParams;
+    renderParams.size = args.renderSize;
+    const GuiImageRenderer renderer(renderParams);
+    GuiRenderBenchmark::Parameters benchParams;
+    benchParams.size = args.renderSize;
+    const GuiRenderBenchmark benchmark(benchParams);
+
+    // Renders the views of the document of 'importTask', images are written by concurrent tasks
+    auto fnRenderDocument = [=](const ImportTask& importTask) {
+        GuiDocument* guiDoc = guiApp->findGuiDocument(importTask.doc);
+        if (!guiDoc)
+            return;
+
+        for (const CommandLineArguments::RenderView& view : args.listRenderView) {
+            const QImage img = renderer.render(guiDoc, view.projection);
+            const std::string strFilename =
+                    importTask.filepath.stem().u8string() + "_" + view.name.toStdString() + ".png";
+            const FilePath filepathImage = args.renderDirPath / strFilename;
+            const QString strFilepathImage = filepathTo<QString>(filepathImage);
+            if (img.isNull()) {
+                qCritical() << Main::tr("Failed to render %1").arg(strFilepathImage);
+                helper->success = false;
+                continue;
+            }
+
+            const TaskId taskId = taskMgr->newTask([=](TaskProgress*) {
+                if (img.save(strFilepathImage)) {
+                    qInfo() << Main::tr("Written %1").arg(strFilepathImage);
+                }
+                else {
+                    qCritical() << Main::tr("Failed to write %1").arg(strFilepathImage);
+                    helper->success = false;
+                }
+            });
+            ++(helper->pendingTaskCount);
+            taskMgr->run(taskId);
+        }
+    };
+
+    // Measures rendering performance of the document of 'importTask', prints result as JSON
+    auto fnBenchmarkDocument = [=](const ImportTask& importTask) {
+        GuiDocument* guiDoc = guiApp->findGuiDocument(importTask.doc);
+        if (!guiDoc)
+            return;
+
+        const GuiRenderBenchmark::Result result = benchmark.run(guiDoc);
+        QJsonObject jsonResult;
+        jsonResult.insert("file", filepathTo<QString>(importTask.filepath));
+        jsonResult.insert("presentationMs", result.presentationMsecs);
+        jsonResult.insert("firstFrameMs", result.firstFrameMsecs);
+        jsonResult.insert("averageFrameMs", result.averageFrameMsecs);
+        jsonResult.insert("averagePickMs", result.averagePickMsecs);
+        jsonResult.insert("frameCount", result.frameCount);
+        jsonResult.insert("pickCount", result.pickCount);
+        jsonResult.insert("shapeObjectCount", result.shapeObjectCount);
+        jsonResult.insert("meshObjectCount", result.meshObjectCount);
+        jsonResult.insert("otherObjectCount", result.otherObjectCount);
+        std::cout << QJsonDocument(jsonResult).toJson(QJsonDocument::Compact).toStdString()
+                  << std::endl;
+    };
+
+    QObject::connect(taskMgr, &TaskManager::ended, helper, [=](TaskId taskId) {
+        auto itImportTask = helper->mapImportTask.find(taskId);
+        if (itImportTask != helper->mapImportTask.end()) {
+            const ImportTask& importTask = *itImportTask->second;
+            if (importTask.success && args.renderBenchmark)
+                fnBenchmarkDocument(importTask);
+            else if (importTask.success)
+                fnRenderDocument(importTask);
+
+            guiApp->application()->closeDocument(importTask.doc);
+            helper->mapImportTask.erase(itImportTask);
+        }
+
+        if (--(helper->pendingTaskCount) == 0) {
+            const int retCode = helper->success ? EXIT_SUCCESS : EXIT_FAILURE;
+            helper->deleteLater();
+            fnContinuation(retCode);
+        }
+    });
+
+    // Suppress output from OpenCascade
+    Message::DefaultMessenger()->RemovePrinters(Message_Printer::get_type_descriptor());
+
+    // Run import operations, BRep shapes are meshed within the import tasks so this doesn't
+    // happen later in the GUI thread at rendering time
+    for (const FilePath& filepath : args.listFilepathToOpen) {
+        auto importTask = std::make_unique<ImportTask>();
+        importTask->doc = app->newDocument();
+        importTask->filepath = filepath;
+        ImportTask* ptrImportTask = importTask.get();
+        const TaskId taskId = taskMgr->newTask([=](TaskProgress* progress) {
+            ErrorMessageCollect errorCollect;
+            const bool okImport = app->ioSystem()->importInDocument()
+                    .targetDocument(ptrImportTask->doc)
+                    .withFilepath(ptrImportTask->filepath)
+                    .withParametersProvider(appModule)
+                    .withEntityPostProcess([=](TDF_Label labelEntity, IO::Format format, TaskProgress* progress) {
+                        appModule->healImportedShapes(labelEntity, format, progress);
+                        appModule->computeBRepMesh(labelEntity, progress);
+                        appModule->repairImportedMesh(labelEntity, progress);
+                        if (IO::formatProvidesMesh(format))
+                            appModule->reorderTriangulations(labelEntity, progress);
+
+                        appModule->compactTriangulations(labelEntity);
+                    })
+                    .withEntityPostProcessRequiredIf([](IO::Format){ return true; })
+                    .withEntityPostProcessInfoProgress(20, Main::tr("Mesh BRep shapes"))
+                    .withMessenger(&errorCollect)
+                    .withTaskProgress(progress)
+                    .execute();
+            ptrImportTask->success = okImport;
+            if (!okImport) {
+                qCritical().noquote() << errorCollect.message;
+                helper->success = false;
+            }
+        });
+        helper->mapImportTask.insert({ taskId, std::move(importTask) });
+        ++(helper->pendingTaskCount);
+    }
+
+    for (const auto& mapPair : helper->mapImportTask)
+        taskMgr->run(mapPair.first);
+}
+
 // Initializes and runs Mayo application
 static int runApp(QCoreApplication* qtApp)
 {
@@ -399,9 +1599,12 @@ static int runApp(QCoreApplication* qtApp)
 
     // Helper function: load application settings from INI file(if provided) otherwise use the
     // application regular storage(eg registry on Windows)
-    auto fnLoadAppSettings = [&](Settings* appSettings) {
+    // In headless modes the settings used only by the GUI are skipped
+    auto fnLoadAppSettings = [&](Settings* appSettings, bool headless) {
+        const AppModule* appModule = AppModule::get(Application::instance());
+        auto fnExcludeGui = [=](const Property& prop) { return headless && appModule->isGuiSetting(prop); };
         if (args.filepathSettings.empty()) {
-            appSettings->load();
+            appSettings->load(fnExcludeGui);
         }
         else {
             const QString strFilepathSettings = filepathTo<QString>(args.filepathSettings);
@@ -409,17 +1612,50 @@ static int runApp(QCoreApplication* qtApp)
                 fnCriticalExit(Main::tr("Failed to load settings file '%1'").arg(strFilepathSettings));
 
             QSettings fileSettings(strFilepathSettings, QSettings::IniFormat);
-            appSettings->loadFrom(fileSettings, &AppModule::excludeSettingPredicate);
+            appSettings->loadFrom(fileSettings, [=](const Property& prop) {
+                return AppModule::excludeSettingPredicate(prop) || fnExcludeGui(prop);
+            });
         }
     };
 
     // Initialize Base application
+    const auto startTime = std::chrono::steady_clock::now();
     initBase(qtApp);
     auto app = Application::instance().get();
 
     // Register AppModule
-    auto appModule = new AppModule(app);
-    app->settings()->setPropertyValueConversion(*appModule);
+    AppModule* appModule = nullptr;
+    {
+        const StartupPhase phase("AppModule");
+        appModule = new AppModule(app);
+        app->settings()->setPropertyValueConversion(*appModule);
+    }
+
+    // Process CLI watch mode
+    if (args.watchInputs) {
+        if (args.listFilepathToOpen.empty() || args.listFilepathToExport.empty())
+            fnCriticalExit(Main::tr("No input files or no export files -> nothing to watch"));
+
+        app->settings()->resetAll();
+        fnLoadAppSettings(app->settings(), true);
+        QTimer::singleShot(0, qtApp, [=]{
+            cli_asyncWatchFolders(app, args, [=](int retcode) { qtApp->exit(retcode); });
+        });
+        return qtApp->exec();
+    }
+
+    // Process CLI batch mode, or export of each input file separately
+    if (!args.batchManifest.isEmpty() || (args.exportEach && !args.listFilepathToExport.empty())) {
+        if (args.exportEach && args.listFilepathToOpen.empty())
+            fnCriticalExit(Main::tr("No input files -> nothing to export"));
+
+        app->settings()->resetAll();
+        fnLoadAppSettings(app->settings(), true);
+        QTimer::singleShot(0, qtApp, [=]{
+            cli_asyncBatchJobs(app, args, [=](int retcode) { qtApp->exit(retcode); });
+        });
+        return qtApp->exec();
+    }
 
     // Process CLI
     if (!args.listFilepathToExport.empty()) {
@@ -427,7 +1663,7 @@ static int runApp(QCoreApplication* qtApp)
             fnCriticalExit(Main::tr("No input files -> nothing to export"));
 
         app->settings()->resetAll();
-        fnLoadAppSettings(app->settings());
+        fnLoadAppSettings(app->settings(), true);
         QTimer::singleShot(0, qtApp, [=]{
             cli_asyncExportDocuments(app, args, [=](int retcode) { qtApp->exit(retcode); });
         });
@@ -435,8 +1671,43 @@ static int runApp(QCoreApplication* qtApp)
     }
 
     // Initialize Gui application
-    auto guiApp = new GuiApplication(app);
-    initGui(guiApp);
+    GuiApplication* guiApp = nullptr;
+    {
+        const StartupPhase phase("GUI drivers");
+        guiApp = new GuiApplication(app);
+        initGui(guiApp);
+    }
+
+    // Create theme
+    globalTheme.reset(createTheme(args.themeName));
+    if (!globalTheme)
+        fnCriticalExit(Main::tr("Failed to load theme '%1'").arg(args.themeName));
+
+    // Process CLI rendering(or rendering benchmark)
+    if (!args.renderDirPath.empty() || args.renderBenchmark) {
+        if (args.listFilepathToOpen.empty())
+            fnCriticalExit(Main::tr("No input files -> nothing to render"));
+
+        if (!args.renderBenchmark && args.listRenderView.empty())
+            fnCriticalExit(Main::tr("No valid views -> nothing to render"));
+
+        if (!args.renderBenchmark) {
+            std::error_code errorCode;
+            std::filesystem::create_directories(args.renderDirPath, errorCode);
+            if (!filepathIsDirectory(args.renderDirPath)) {
+                const QString strRenderDirPath = filepathTo<QString>(args.renderDirPath);
+                fnCriticalExit(Main::tr("Failed to create render folder '%1'").arg(strRenderDirPath));
+            }
+        }
+
+        app->settings()->resetAll();
+        fnLoadAppSettings(app->settings(), false);
+        QTimer::singleShot(0, qtApp, [=]{
+            cli_asyncRenderDocuments(guiApp, args, [=](int retcode) { qtApp->exit(retcode); });
+        });
+        return qtApp->exec();
+    }
+
     QObject::connect(
                 guiApp, &GuiApplication::guiDocumentErased,
                 appModule, &AppModule::recordRecentFileThumbnail);
@@ -445,24 +1716,33 @@ static int runApp(QCoreApplication* qtApp)
     WidgetModelTree::addPrototypeBuilder(std::make_unique<WidgetModelTreeBuilder_Mesh>());
     WidgetModelTree::addPrototypeBuilder(std::make_unique<WidgetModelTreeBuilder_Xde>());
 
-    // Create theme
-    globalTheme.reset(createTheme(args.themeName));
-    if (!globalTheme)
-        fnCriticalExit(Main::tr("Failed to load theme '%1'").arg(args.themeName));
-
-    mayoTheme()->setup();
+    {
+        const StartupPhase phase("Theme");
+        mayoTheme()->setup();
+    }
 
     // Create MainWindow
-    app->settings()->loadProperty(app->settings()->findProperty(&appModule->recentFiles));
-    MainWindow mainWindow(guiApp);
-    mainWindow.setWindowTitle(QCoreApplication::applicationName());
-    mainWindow.show();
+    std::unique_ptr<MainWindow> mainWindow;
+    {
+        const StartupPhase phase("MainWindow");
+        app->settings()->loadProperty(app->settings()->findProperty(&appModule->recentFiles));
+        mainWindow = std::make_unique<MainWindow>(guiApp);
+        mainWindow->setWindowTitle(QCoreApplication::applicationName());
+        mainWindow->show();
+    }
+
     if (!args.listFilepathToOpen.empty()) {
-        QTimer::singleShot(0, [&]{ mainWindow.openDocumentsFromList(args.listFilepathToOpen); });
+        QTimer::singleShot(0, [&]{ mainWindow->openDocumentsFromList(args.listFilepathToOpen); });
+    }
+
+    {
+        const StartupPhase phase("Settings");
+        app->settings()->resetAll();
+        fnLoadAppSettings(app->settings(), false);
     }
 
-    app->settings()->resetAll();
-    fnLoadAppSettings(app->settings());
+    // First event loop iteration is done once main window got painted
+    QTimer::singleShot(0, [=]{ printStartupReport(startTime); });
     const int code = qtApp->exec();
     appModule->recordRecentFileThumbnails(guiApp);
     app->settings()->save();
@@ -486,19 +1766,31 @@ int main(int argc, char* argv[])
     qAddPostRoutine(&Mayo::onQtAppExit);
 
     auto fnArgEqual = [](const char* arg, const char* option) { return std::strcmp(arg, option) == 0; };
+    bool isAppCliRenderMode = false;
     for (int i = 1; i < argc; ++i) {
         const char* arg = argv[i];
-        if (fnArgEqual(arg, "-e") || fnArgEqual(arg, "--export")
+        if (fnArgEqual(arg, "-e") || fnArgEqual(arg, "--export") || fnArgEqual(arg, "--batch")
+                || fnArgEqual(arg, "--watch")
                 || fnArgEqual(arg, "-h") || fnArgEqual(arg, "--help")
                 || fnArgEqual(arg, "-v") || fnArgEqual(arg, "--version"))
         {
             Mayo::isAppCliMode = true;
-            break;
+        }
+        else if (fnArgEqual(arg, "--render-dir") || fnArgEqual(arg, "--render-bench")) {
+            Mayo::isAppCliMode = true;
+            isAppCliRenderMode = true;
         }
     }
 
+    // Rendering requires GUI objects(eg palette of the theme) but no window is ever shown, so the
+    // Qt "offscreen" platform is enough unless another one is explicitly requested
+    if (isAppCliRenderMode && qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
     std::unique_ptr<QCoreApplication> ptrApp(
-            Mayo::isAppCliMode ? new QCoreApplication(argc, argv) : new QApplication(argc, argv));
+            Mayo::isAppCliMode && !isAppCliRenderMode ?
+                new QCoreApplication(argc, argv) :
+                new QApplication(argc, argv));
 
 #if defined(Q_OS_WIN) && defined(NDEBUG)
     if (Mayo::isAppCliMode) {
@@ -522,5 +1814,13 @@ int main(int argc, char* argv[])
     QCoreApplication::setOrganizationDomain("www.fougue.pro");
     QCoreApplication::setApplicationName("Mayo");
     QCoreApplication::setApplicationVersion(QString::fromUtf8(Mayo::strVersion));
-    return Mayo::runApp(ptrApp.get());
+    const int retCode = Mayo::runApp(ptrApp.get());
+    // Dump profiling zones if instrumentation is enabled(see src/base/profiler.h)
+    const QString strTraceFilepath = QString::fromLocal8Bit(qgetenv("MAYO_PROFILER_OUTPUT"));
+    if (Mayo::Profiler::isEnabled() && !strTraceFilepath.isEmpty()) {
+        if (!Mayo::Profiler::writeChromeTrace(Mayo::filepathFrom(strTraceFilepath)))
+            qCritical() << Mayo::Main::tr("Failed to write profiling trace '%1'").arg(strTraceFilepath);
+    }
+
+    return retCode;
 }
@@ -9,12 +9,18 @@
 
 #include "../base/application.h"
 #include "../base/application_item_selection_model.h"
+#include "../base/caf_utils.h"
 #include "../base/cpp_utils.h"
 #include "../base/document.h"
+#include "../base/document_snapshot.h"
+#include "../base/document_diff.h"
 #include "../base/global.h"
 #include "../base/io_format.h"
 #include "../base/io_system.h"
+#include "../base/memory_usage.h"
+#include "../base/mesh_decimation.h"
 #include "../base/messenger.h"
+#include "../base/model_cache.h"
 #include "../base/settings.h"
 #include "../base/string_conv.h"
 #include "../base/task_manager.h"
@@ -31,6 +37,7 @@
 #include "dialog_task_manager.h"
 #include "document_tree_node_properties_providers.h"
 #include "item_view_buttons.h"
+#include "qstring_utils.h"
 #include "theme.h"
 #include "widget_file_system.h"
 #include "widget_gui_document.h"
@@ -54,8 +61,13 @@
 #include <QtWidgets/QActionGroup>
 #include <QtWidgets/QApplication>
 #include <QtWidgets/QFileDialog>
+#include <QtWidgets/QInputDialog>
 #include <QtDebug>
 
+#include <TDataStd_Name.hxx>
+#include <TDataXtd_Triangulation.hxx>
+#include <algorithm>
+#include <mutex>
 #include <unordered_set>
 
 namespace Mayo {
@@ -100,6 +112,27 @@ static IO::Format formatFromFilter(const QString& filter)
     return IO::Format_Unknown;
 }
 
+// Read-only properties of the estimated memory used by a document tree node
+class MemoryUsageProperties : public PropertyGroupSignals {
+    MAYO_DECLARE_TEXT_ID_FUNCTIONS(Mayo::MemoryUsageProperties)
+public:
+    MemoryUsageProperties(const DocumentTreeNode& treeNode, int treeItemCount)
+    {
+        const MemoryUsage usage = MemoryUsage::ofLabel(treeNode.label());
+        m_propertyBRep.setValue(to_stdString(QStringUtils::bytesText(usage.brepBytes)));
+        m_propertyTriangulation.setValue(to_stdString(QStringUtils::bytesText(usage.triangulationBytes)));
+        m_propertyPresentation.setValue(to_stdString(QStringUtils::bytesText(usage.estimatedPresentationBytes())));
+        m_propertyTreeItemCount.setValue(treeItemCount);
+        for (Property* prop : this->properties())
+            prop->setUserReadOnly(true);
+    }
+
+    PropertyString m_propertyBRep{ this, textId("BRep") };
+    PropertyString m_propertyTriangulation{ this, textId("Triangulations") };
+    PropertyString m_propertyPresentation{ this, textId("Presentations") };
+    PropertyInt m_propertyTreeItemCount{ this, textId("DocumentTreeItems") };
+};
+
 // TODO: move in Options
 struct ImportExportSettings {
     FilePath openDir;
@@ -199,6 +232,16 @@ static void handleMessage(Messenger::MessageType msgType, const QString& text, Q
     }
 }
 
+// Is 'appItem' a mesh entity(STL, PLY, ... file contents), which can be decimated ?
+static bool isMeshEntity(const ApplicationItem& appItem)
+{
+    if (!appItem.isDocumentTreeNode())
+        return false;
+
+    const DocumentTreeNode& docTreeNode = appItem.documentTreeNode();
+    return docTreeNode.isEntity() && CafUtils::hasAttribute<TDataXtd_Triangulation>(docTreeNode.label());
+}
+
 } // namespace Internal
 
 MainWindow::MainWindow(GuiApplication* guiApp, QWidget *parent)
@@ -227,6 +270,7 @@ MainWindow::MainWindow(GuiApplication* guiApp, QWidget *parent)
 
     m_ui->actionAboutMayo->setText(tr("About %1").arg(QApplication::applicationName()));
     m_ui->actionImport->setIcon(mayoTheme()->icon(Theme::Icon::Import));
+    m_ui->actionImportFolder->setIcon(mayoTheme()->icon(Theme::Icon::Import));
     m_ui->actionExportSelectedItems->setIcon(mayoTheme()->icon(Theme::Icon::Export));
     m_ui->actionZoomIn->setIcon(mayoTheme()->icon(Theme::Icon::ZoomIn));
     m_ui->actionZoomOut->setIcon(mayoTheme()->icon(Theme::Icon::ZoomOut));
@@ -266,6 +310,12 @@ MainWindow::MainWindow(GuiApplication* guiApp, QWidget *parent)
     QObject::connect(
                 m_ui->actionImport, &QAction::triggered,
                 this, &MainWindow::importInCurrentDoc);
+    QObject::connect(
+                m_ui->actionImportFolder, &QAction::triggered,
+                this, &MainWindow::importFolderInCurrentDoc);
+    QObject::connect(
+                m_ui->actionReloadDoc, &QAction::triggered,
+                this, &MainWindow::reloadCurrentDocFromDisk);
     QObject::connect(
                 m_ui->actionExportSelectedItems, &QAction::triggered,
                 this, &MainWindow::exportSelectedItems);
@@ -323,6 +373,15 @@ MainWindow::MainWindow(GuiApplication* guiApp, QWidget *parent)
     QObject::connect(
                 m_ui->actionInspectXDE, &QAction::triggered,
                 this, &MainWindow::inspectXde);
+    QObject::connect(
+                m_ui->actionDecimateMesh, &QAction::triggered,
+                this, &MainWindow::decimateSelectedMeshes);
+    QObject::connect(
+                m_ui->actionCompareDocuments, &QAction::triggered,
+                this, &MainWindow::compareDocuments);
+    QObject::connect(
+                m_ui->actionClearComparison, &QAction::triggered,
+                this, &MainWindow::clearDocumentsComparison);
     QObject::connect(
                 m_ui->actionOptions, &QAction::triggered,
                 this, &MainWindow::editOptions);
@@ -403,6 +462,22 @@ MainWindow::MainWindow(GuiApplication* guiApp, QWidget *parent)
 
     new DialogTaskManager(TaskManager::globalInstance(), this);
 
+    // Presentation memory budget and shape paging are shared by all the documents
+    {
+        AppModule* appModule = AppModule::get(guiApp->application());
+        auto fnApplyPresentationMemoryBudget = [=]{
+            guiApp->setPresentationMemoryBudget(uint64_t(appModule->presentationMemoryBudget.value()) * 1024 * 1024);
+        };
+        fnApplyPresentationMemoryBudget();
+        guiApp->setShapePagingOn(appModule->shapePagingOn);
+        QObject::connect(guiApp->application()->settings(), &Settings::changed, this, [=](Property* setting) {
+            if (setting == &appModule->presentationMemoryBudget)
+                fnApplyPresentationMemoryBudget();
+            else if (setting == &appModule->shapePagingOn)
+                guiApp->setShapePagingOn(appModule->shapePagingOn);
+        });
+    }
+
     // BEWARE MainWindow::onGuiDocumentAdded() must be called before
     // MainWindow::onCurrentDocumentIndexChanged()
     auto guiDocModel = new GuiDocumentListModel(guiApp, this);
@@ -510,21 +585,99 @@ void MainWindow::importInCurrentDoc()
     if (resFileNames.listFilepath.empty())
         return;
 
+    const QString taskTitle =
+            resFileNames.listFilepath.size() > 1 ?
+                tr("Import") :
+                filepathTo<QString>(resFileNames.listFilepath.front().stem());
+    const std::vector<FilePath> listFilepath = resFileNames.listFilepath;
+    this->runImportInDocument(
+                widgetGuiDoc->guiDocument()->document(), taskTitle, [=]{ return listFilepath; }, ImportMode::Files);
+    for (const FilePath& fp : resFileNames.listFilepath)
+        Internal::prependRecentFile(fp);
+}
+
+void MainWindow::importFolderInCurrentDoc()
+{
+    auto widgetGuiDoc = this->currentWidgetGuiDocument();
+    if (!widgetGuiDoc)
+        return;
+
+    auto lastIoSettings = Internal::ImportExportSettings::load();
+    const QString strFolder = QFileDialog::getExistingDirectory(
+                this, tr("Select Folder"), filepathTo<QString>(lastIoSettings.openDir));
+    if (strFolder.isEmpty())
+        return;
+
+    const FilePath folder = filepathFrom(strFolder);
+    lastIoSettings.openDir = folder;
+    Internal::ImportExportSettings::save(lastIoSettings);
+    // Files are enumerated within the import task, folder might be big or on a slow drive
+    this->runImportInDocument(
+                widgetGuiDoc->guiDocument()->document(),
+                filepathTo<QString>(folder.filename()),
+                [=]{ return IO::System::folderFiles(folder); },
+                ImportMode::Folder);
+}
+
+void MainWindow::reloadCurrentDocFromDisk()
+{
+    auto widgetGuiDoc = this->currentWidgetGuiDocument();
+    if (!widgetGuiDoc)
+        return;
+
+    const DocumentPtr doc = widgetGuiDoc->guiDocument()->document();
+    const FilePath filepath = doc->filePath();
+    if (filepath.empty() || !filepathExists(filepath)) {
+        WidgetsUtils::asyncMsgBoxWarning(
+                    this, tr("Warning"), tr("Document '%1' has no file on disk").arg(doc->name()));
+        return;
+    }
+
+    this->runImportInDocument(doc, doc->name(), [=]{ return std::vector<FilePath>{ filepath }; }, ImportMode::Reload);
+}
+
+void MainWindow::runImportInDocument(
+        const DocumentPtr& doc, const QString& taskTitle, ImportFilepaths fnFilepaths, ImportMode mode)
+{
+    const bool isFolder = mode == ImportMode::Folder;
     auto app = m_guiApp->application();
     auto taskMgr = TaskManager::globalInstance();
     const TaskId taskId = taskMgr->newTask([=](TaskProgress* progress) {
         QTime chrono;
         chrono.start();
 
+        // Entities are added to the document(and so to the model tree) as soon as each file is
+        // imported, not at the end of the whole import
+        const std::vector<FilePath> listFilepath = fnFilepaths();
         auto appModule = AppModule::get(app);
+        if (isFolder && listFilepath.empty()) {
+            appModule->emitWarning(tr("No file found in folder"));
+            return;
+        }
+
         const bool okImport = app->ioSystem()->importInDocument()
-                .targetDocument(widgetGuiDoc->guiDocument()->document())
-                .withFilepaths(resFileNames.listFilepath)
+                .targetDocument(doc)
+                .withFilepaths(listFilepath)
+                .withUnsupportedFilesSkipped(isFolder)
+                .withEntitiesReloaded(mode == ImportMode::Reload)
                 .withParametersProvider(appModule)
-                .withEntityPostProcess([=](TDF_Label labelEntity, TaskProgress* progress) {
+                .withGeometryDeduplicated(appModule->importDeduplicateGeometry)
+                .withModelTreeBuiltConcurrently(appModule->importConcurrentModelTreeBuild)
+                .withEntityPostProcess([=](TDF_Label labelEntity, IO::Format format, TaskProgress* progress) {
+                        AppModule::get(app)->healImportedShapes(labelEntity, format, progress);
                         AppModule::get(app)->computeBRepMesh(labelEntity, progress);
+                        AppModule::get(app)->repairImportedMesh(labelEntity, progress);
+                        if (IO::formatProvidesMesh(format))
+                            AppModule::get(app)->reorderTriangulations(labelEntity, progress);
+
+                        AppModule::get(app)->compactTriangulations(labelEntity);
+                })
+                .withEntityPostProcessRequiredIf([=](IO::Format format) {
+                        return (!appModule->meshingLazy && IO::formatProvidesBRep(format))
+                                || ((appModule->meshingRepairOnImport || appModule->meshingSinglePrecision || appModule->meshingReorder)
+                                    && IO::formatProvidesMesh(format))
+                                || appModule->shapeHealingRequired(format);
                 })
-                .withEntityPostProcessRequiredIf(&IO::formatProvidesBRep)
                 .withEntityPostProcessInfoProgress(20, tr("Mesh BRep shapes"))
                 .withMessenger(appModule)
                 .withTaskProgress(progress)
@@ -532,14 +685,8 @@ void MainWindow::importInCurrentDoc()
         if (okImport)
             appModule->emitInfo(tr("Import time: %1ms").arg(chrono.elapsed()));
     });
-    const QString taskTitle =
-            resFileNames.listFilepath.size() > 1 ?
-                tr("Import") :
-                filepathTo<QString>(resFileNames.listFilepath.front().stem());
     taskMgr->setTitle(taskId, taskTitle);
     taskMgr->run(taskId);
-    for (const FilePath& fp : resFileNames.listFilepath)
-        Internal::prependRecentFile(fp);
 }
 
 void MainWindow::exportSelectedItems()
@@ -564,6 +711,8 @@ void MainWindow::exportSelectedItems()
     lastSettings.openDir = filepathFrom(strFilepath);
     auto taskMgr = TaskManager::globalInstance();
     const IO::Format format = Internal::formatFromFilter(lastSettings.selectedFilter);
+    // Export task works on a snapshot, documents can then be modified while it's running
+    const DocumentSnapshotPtr snapshot = DocumentSnapshot::create(m_guiApp->selectionModel()->selectedItems());
     const TaskId taskId = taskMgr->newTask([=](TaskProgress* progress) {
         QTime chrono;
         chrono.start();
@@ -572,7 +721,7 @@ void MainWindow::exportSelectedItems()
                 app->ioSystem()->exportApplicationItems()
                 .targetFile(filepathFrom(strFilepath))
                 .targetFormat(format)
-                .withItems(m_guiApp->selectionModel()->selectedItems())
+                .withItems(snapshot->applicationItems())
                 .withParameters(appModule->findWriterParameters(format))
                 .withMessenger(appModule)
                 .withTaskProgress(progress)
@@ -650,6 +799,182 @@ void MainWindow::inspectXde()
     }
 }
 
+void MainWindow::decimateSelectedMeshes()
+{
+    std::vector<DocumentTreeNode> vecMeshNode;
+    for (const ApplicationItem& appItem : m_guiApp->selectionModel()->selectedItems()) {
+        if (Internal::isMeshEntity(appItem))
+            vecMeshNode.push_back(appItem.documentTreeNode());
+    }
+
+    if (vecMeshNode.empty())
+        return;
+
+    auto dlg = new QInputDialog(this);
+    dlg->setWindowTitle(tr("Decimate Mesh"));
+    dlg->setLabelText(tr("Target count of triangles(percentage of the current count)"));
+    dlg->setInputMode(QInputDialog::IntInput);
+    dlg->setIntRange(1, 99);
+    dlg->setIntValue(25);
+    QObject::connect(dlg, &QInputDialog::intValueSelected, this, [=](int percent) {
+        // Decimated meshes are added as new entities, original ones are kept
+        auto app = m_guiApp->application();
+        auto taskMgr = TaskManager::globalInstance();
+        const TaskId taskId = taskMgr->newTask([=](TaskProgress* progress) {
+            MeshDecimation::Options options;
+            options.targetRatio = percent / 100.;
+            for (const DocumentTreeNode& meshNode : vecMeshNode) {
+                TaskProgress meshProgress(progress, 100. / vecMeshNode.size());
+                const TDF_Label labelMesh = meshNode.label();
+                auto attrTriangulation = CafUtils::findAttribute<TDataXtd_Triangulation>(labelMesh);
+                MeshDecimation::Report report;
+                const Handle_Poly_Triangulation mesh =
+                        MeshDecimation::decimate(attrTriangulation->Get(), options, &report, &meshProgress);
+                if (mesh.IsNull())
+                    return; // Aborted
+
+                const DocumentPtr doc = meshNode.document();
+                const TDF_Label labelDecimated = doc->newEntityLabel();
+                TCollection_ExtendedString name = CafUtils::labelAttrStdName(labelMesh);
+                name += " (decimated)";
+                TDataXtd_Triangulation::Set(labelDecimated, mesh);
+                TDataStd_Name::Set(labelDecimated, name);
+                doc->addEntityTreeNode(labelDecimated);
+                AppModule::get(app)->emitInfo(
+                            tr("Mesh '%1' decimated: %2 triangles down to %3")
+                            .arg(to_QString(CafUtils::labelAttrStdName(labelMesh)))
+                            .arg(report.inputTriangleCount)
+                            .arg(report.outputTriangleCount));
+            }
+        });
+        taskMgr->setTitle(taskId, tr("Decimate meshes"));
+        taskMgr->run(taskId);
+    });
+    WidgetsUtils::asyncDialogExec(dlg);
+}
+
+void MainWindow::compareDocuments()
+{
+    const WidgetGuiDocument* widgetDoc = this->currentWidgetGuiDocument();
+    GuiDocument* guiDocCompared = widgetDoc ? widgetDoc->guiDocument() : nullptr;
+    if (!guiDocCompared)
+        return;
+
+    std::vector<DocumentPtr> vecDocCandidate;
+    QStringList listDocName;
+    for (GuiDocument* guiDoc : m_guiApp->guiDocuments()) {
+        if (guiDoc != guiDocCompared) {
+            vecDocCandidate.push_back(guiDoc->document());
+            listDocName.push_back(guiDoc->document()->name());
+        }
+    }
+
+    if (vecDocCandidate.empty())
+        return;
+
+    auto dlg = new QInputDialog(this);
+    dlg->setWindowTitle(tr("Compare Documents"));
+    dlg->setLabelText(tr("Reference document compared to '%1'").arg(guiDocCompared->document()->name()));
+    dlg->setComboBoxItems(listDocName);
+    dlg->setComboBoxEditable(false);
+    const DocumentPtr docCompared = guiDocCompared->document();
+    QObject::connect(dlg, &QInputDialog::textValueSelected, this, [=](const QString& docName) {
+        const int docIndex = listDocName.indexOf(docName);
+        if (docIndex < 0)
+            return;
+
+        const DocumentPtr docReference = vecDocCandidate.at(docIndex);
+        for (const DocumentPtr& doc : { docReference, docCompared }) {
+            GuiDocument* guiDoc = m_guiApp->findGuiDocument(doc);
+            if (guiDoc)
+                guiDoc->clearNodesColorOverride();
+        }
+
+        // Items are compared in a worker thread and queued, they are colored in the main thread
+        // by a timer started on each batch
+        struct ComparisonQueue {
+            std::mutex mutex;
+            std::vector<DocumentDiff::Item> vecItem;
+        };
+        auto queue = std::make_shared<ComparisonQueue>();
+        auto timerApply = new QTimer(this);
+        timerApply->setSingleShot(true);
+        timerApply->setInterval(0);
+        auto fnApplyQueuedItems = [=]{
+            std::vector<DocumentDiff::Item> vecItem;
+            {
+                std::lock_guard<std::mutex> lock(queue->mutex);
+                vecItem.swap(queue->vecItem);
+            }
+
+            using Status = DocumentDiff::Status;
+            auto fnColorNodes = [&](const DocumentPtr& doc, Status status, const Quantity_Color& color) {
+                GuiDocument* guiDoc = m_guiApp->findGuiDocument(doc);
+                if (!guiDoc)
+                    return;
+
+                std::vector<TreeNodeId> vecNodeId;
+                for (const DocumentDiff::Item& item : vecItem) {
+                    const TreeNodeId nodeId = doc == docReference ? item.nodeIdReference : item.nodeIdCompared;
+                    if (item.status == status && nodeId != 0)
+                        vecNodeId.push_back(nodeId);
+                }
+
+                if (!vecNodeId.empty())
+                    guiDoc->setNodesColorOverride(vecNodeId, color);
+            };
+            fnColorNodes(docReference, Status::Unchanged, Quantity_NOC_GRAY70);
+            fnColorNodes(docReference, Status::Moved, Quantity_NOC_GRAY70);
+            fnColorNodes(docReference, Status::Modified, Quantity_NOC_GRAY70);
+            fnColorNodes(docReference, Status::Removed, Quantity_NOC_BLUE1);
+            fnColorNodes(docCompared, Status::Unchanged, Quantity_NOC_GRAY70);
+            fnColorNodes(docCompared, Status::Moved, Quantity_NOC_ORANGE);
+            fnColorNodes(docCompared, Status::Modified, Quantity_NOC_RED);
+            fnColorNodes(docCompared, Status::Added, Quantity_NOC_GREEN);
+        };
+        QObject::connect(timerApply, &QTimer::timeout, this, fnApplyQueuedItems);
+
+        auto app = m_guiApp->application();
+        auto taskMgr = TaskManager::globalInstance();
+        const TaskId taskId = taskMgr->newTask([=](TaskProgress* progress) {
+            auto fnItemsCompared = [=](Span<const DocumentDiff::Item> spanItem) {
+                {
+                    std::lock_guard<std::mutex> lock(queue->mutex);
+                    queue->vecItem.insert(queue->vecItem.end(), spanItem.begin(), spanItem.end());
+                }
+
+                // Emitting thread doesn't run an event loop, so the timer is started from the main thread
+                QMetaObject::invokeMethod(timerApply, "start", Qt::QueuedConnection);
+            };
+            const DocumentDiff::Report report =
+                    DocumentDiff::compare(docReference, docCompared, fnItemsCompared, {}, progress);
+            AppModule::get(app)->emitInfo(
+                        tr("Comparison of '%1' with reference '%2': %3 unchanged, %4 moved, %5 modified, %6 added, %7 removed")
+                        .arg(docCompared->name(), docReference->name())
+                        .arg(report.unchangedCount)
+                        .arg(report.movedCount)
+                        .arg(report.modifiedCount)
+                        .arg(report.addedCount)
+                        .arg(report.removedCount));
+        });
+        QObject::connect(taskMgr, &TaskManager::ended, timerApply, [=](TaskId id) {
+            if (id == taskId) {
+                fnApplyQueuedItems();
+                timerApply->deleteLater();
+            }
+        });
+        taskMgr->setTitle(taskId, tr("Compare documents"));
+        taskMgr->run(taskId);
+    });
+    WidgetsUtils::asyncDialogExec(dlg);
+}
+
+void MainWindow::clearDocumentsComparison()
+{
+    for (GuiDocument* guiDoc : m_guiApp->guiDocuments())
+        guiDoc->clearNodesColorOverride();
+}
+
 void MainWindow::toggleFullscreen()
 {
     if (this->isFullScreen()) {
@@ -718,6 +1043,10 @@ void MainWindow::onApplicationItemSelectionChanged()
                     });
                 }
             }
+
+            m_ptrCurrentNodeMemoryProperties = std::make_unique<Internal::MemoryUsageProperties>(
+                        docTreeNode, uiModelTree->itemCount(item.document()));
+            uiProps->editProperties(m_ptrCurrentNodeMemoryProperties.get(), uiProps->addGroup(tr("Memory")));
         }
 
         auto app = m_guiApp->application();
@@ -749,6 +1078,28 @@ void MainWindow::onGuiDocumentAdded(GuiDocument* guiDoc)
     auto appModule = AppModule::get(app);
     auto widget = new WidgetGuiDocument(guiDoc);
     widget->controller()->setInstantZoomFactor(appModule->instantZoomFactor);
+    guiDoc->setFrustumCullingOn(appModule->cullingFrustumOn);
+    guiDoc->setSizeCullingThreshold(appModule->cullingSizeThreshold);
+    guiDoc->setDynamicSizeCullingThreshold(appModule->cullingDynamicSizeThreshold);
+    guiDoc->setAdaptiveRenderingOn(appModule->cullingAdaptiveRenderingOn);
+    guiDoc->setOcclusionCullingOn(appModule->cullingOcclusionOn);
+    guiDoc->setStaticBatchingOn(appModule->staticBatchingOn);
+    guiDoc->graphicsScene()->setPickingBufferOn(appModule->depthBufferPickingOn);
+    auto fnApplyTransparencyMode = [=](AppModule::TransparencyMode mode) {
+        switch (mode) {
+        case AppModule::TransparencyMode::Unordered:
+            return guiDoc->setTransparencyMethod(Graphic3d_RTM_BLEND_UNORDERED);
+        case AppModule::TransparencyMode::Performance:
+            return guiDoc->setTransparencyMethod(Graphic3d_RTM_BLEND_OIT);
+        case AppModule::TransparencyMode::Quality:
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 5, 0)
+            return guiDoc->setTransparencyMethod(Graphic3d_RTM_DEPTH_PEELING_OIT);
+#else
+            return guiDoc->setTransparencyMethod(Graphic3d_RTM_BLEND_OIT);
+#endif
+        }
+    };
+    fnApplyTransparencyMode(appModule->transparencyMode.value());
     if (appModule->defaultShowOriginTrihedron.value()) {
         guiDoc->toggleOriginTrihedronVisibility();
         guiDoc->graphicsScene()->redraw();
@@ -757,6 +1108,22 @@ void MainWindow::onGuiDocumentAdded(GuiDocument* guiDoc)
     QObject::connect(app->settings(), &Settings::changed, this, [=](Property* setting) {
         if (setting == &appModule->instantZoomFactor)
             widget->controller()->setInstantZoomFactor(appModule->instantZoomFactor);
+        else if (setting == &appModule->cullingFrustumOn)
+            guiDoc->setFrustumCullingOn(appModule->cullingFrustumOn);
+        else if (setting == &appModule->cullingSizeThreshold)
+            guiDoc->setSizeCullingThreshold(appModule->cullingSizeThreshold);
+        else if (setting == &appModule->cullingDynamicSizeThreshold)
+            guiDoc->setDynamicSizeCullingThreshold(appModule->cullingDynamicSizeThreshold);
+        else if (setting == &appModule->cullingAdaptiveRenderingOn)
+            guiDoc->setAdaptiveRenderingOn(appModule->cullingAdaptiveRenderingOn);
+        else if (setting == &appModule->cullingOcclusionOn)
+            guiDoc->setOcclusionCullingOn(appModule->cullingOcclusionOn);
+        else if (setting == &appModule->staticBatchingOn)
+            guiDoc->setStaticBatchingOn(appModule->staticBatchingOn);
+        else if (setting == &appModule->depthBufferPickingOn)
+            guiDoc->graphicsScene()->setPickingBufferOn(appModule->depthBufferPickingOn);
+        else if (setting == &appModule->transparencyMode)
+            fnApplyTransparencyMode(appModule->transparencyMode.value());
     });
 
     V3dViewController* ctrl = widget->controller();
@@ -878,10 +1245,24 @@ void MainWindow::closeCurrentDocument()
 void MainWindow::closeDocument(WidgetGuiDocument* widget)
 {
     if (widget) {
-        const DocumentPtr& doc = widget->guiDocument()->document();
+        // Document is detached from the GUI right now, its contents are released in background so
+        // the user doesn't have to wait before opening other documents
+        const DocumentPtr doc = widget->guiDocument()->document();
         m_ui->stack_GuiDocuments->removeWidget(widget);
         widget->deleteLater();
-        m_guiApp->application()->closeDocument(doc);
+        auto appModule = AppModule::get(m_guiApp->application());
+        m_guiApp->application()->closeDocumentAsync(doc, [=]{
+            // Allocators keep freed memory around, so give it back explicitly after release of
+            // a(potentially big) document
+            const int64_t residentBytesBefore = ProcessMemory::residentBytes();
+            ProcessMemory::trim();
+            const int64_t residentBytesAfter = ProcessMemory::residentBytes();
+            if (residentBytesBefore >= 0 && residentBytesAfter >= 0) {
+                appModule->emitInfo(tr("Memory trimmed after close, resident size %1 -> %2")
+                                    .arg(QStringUtils::bytesText(residentBytesBefore))
+                                    .arg(QStringUtils::bytesText(residentBytesAfter)));
+            }
+        });
         this->updateControlsActivation();
     }
 }
@@ -927,7 +1308,29 @@ void MainWindow::openDocumentsFromList(Span<const FilePath> listFilePath)
             const TaskId taskId = taskMgr->newTask([=](TaskProgress* progress) {
                 QTime chrono;
                 chrono.start();
+                auto appModule = AppModule::get(app);
+                // Model might have been imported already with the same options, possibly by another
+                // user sharing the cache folder
+                const ModelCache modelCache = appModule->modelCache();
+                QByteArray modelCacheKey;
+                if (!modelCache.isNull()) {
+                    TaskProgress cacheProgress(progress, 0, tr("Check model cache"));
+                    modelCacheKey = ModelCache::key(fp, appModule->importParametersFingerprint(), &cacheProgress);
+                }
+
                 DocumentPtr doc;
+                if (modelCache.contains(modelCacheKey)) {
+                    std::lock_guard<std::mutex> lock(mutexApp); MAYO_UNUSED(lock);
+                    doc = modelCache.open(app, modelCacheKey, progress);
+                }
+
+                if (doc) {
+                    doc->setName(filepathTo<QString>(fp.stem()));
+                    doc->setFilePath(fp);
+                    appModule->emitInfo(tr("Model loaded from cache in %1ms").arg(chrono.elapsed()));
+                    return;
+                }
+
                 {
                     std::lock_guard<std::mutex> lock(mutexApp); MAYO_UNUSED(lock);
                     doc = app->newDocument();
@@ -936,22 +1339,38 @@ void MainWindow::openDocumentsFromList(Span<const FilePath> listFilePath)
                 doc->setName(filepathTo<QString>(fp.stem()));
                 doc->setFilePath(fp);
 
-                auto appModule = AppModule::get(app);
                 const bool okImport =
                         app->ioSystem()->importInDocument()
                         .targetDocument(doc)
                         .withFilepath(fp)
                         .withParametersProvider(appModule)
-                        .withEntityPostProcess([=](TDF_Label labelEntity, TaskProgress* progress) {
+                        .withGeometryDeduplicated(appModule->importDeduplicateGeometry)
+                        .withModelTreeBuiltConcurrently(appModule->importConcurrentModelTreeBuild)
+                        .withEntityPostProcess([=](TDF_Label labelEntity, IO::Format format, TaskProgress* progress) {
+                                appModule->healImportedShapes(labelEntity, format, progress);
                                 appModule->computeBRepMesh(labelEntity, progress);
+                                appModule->repairImportedMesh(labelEntity, progress);
+                                if (IO::formatProvidesMesh(format))
+                                    appModule->reorderTriangulations(labelEntity, progress);
+
+                                appModule->compactTriangulations(labelEntity);
+                        })
+                        .withEntityPostProcessRequiredIf([=](IO::Format format) {
+                                return (!appModule->meshingLazy && IO::formatProvidesBRep(format))
+                                        || ((appModule->meshingRepairOnImport || appModule->meshingSinglePrecision || appModule->meshingReorder)
+                                            && IO::formatProvidesMesh(format))
+                                        || appModule->shapeHealingRequired(format);
                         })
-                        .withEntityPostProcessRequiredIf(&IO::formatProvidesBRep)
                         .withEntityPostProcessInfoProgress(20, tr("Mesh BRep shapes"))
                         .withMessenger(appModule)
                         .withTaskProgress(progress)
                         .execute();
-                if (okImport)
+                if (okImport) {
                     appModule->emitInfo(tr("Import time: %1ms").arg(chrono.elapsed()));
+                    // Deferred shapes and scalings aren't persistent, such documents can't be cached
+                    if (!modelCacheKey.isEmpty() && !doc->hasDeferredShapes() && !doc->hasDeferredScalings())
+                        modelCache.save(app, doc, modelCacheKey);
+                }
             });
             taskMgr->setTitle(taskId, filepathTo<QString>(fp.stem()));
             taskMgr->run(taskId);
@@ -974,6 +1393,8 @@ void MainWindow::updateControlsActivation()
         m_ui->stack_Main->setCurrentWidget(newMainPage);
 
     m_ui->actionImport->setEnabled(!appDocumentsEmpty);
+    m_ui->actionImportFolder->setEnabled(!appDocumentsEmpty);
+    m_ui->actionReloadDoc->setEnabled(!appDocumentsEmpty);
     m_ui->menu_Projection->setEnabled(!appDocumentsEmpty);
     m_ui->actionProjectionOrthographic->setEnabled(!appDocumentsEmpty);
     m_ui->actionProjectionPerspective->setEnabled(!appDocumentsEmpty);
@@ -1000,6 +1421,10 @@ void MainWindow::updateControlsActivation()
                 spanSelectedAppItem.size() == 1
                 && firstAppItem.isValid()
                 && firstAppItem.document()->isXCafDocument());
+    m_ui->actionDecimateMesh->setEnabled(
+                std::any_of(spanSelectedAppItem.begin(), spanSelectedAppItem.end(), &Internal::isMeshEntity));
+    m_ui->actionCompareDocuments->setEnabled(appDocumentsCount >= 2);
+    m_ui->actionClearComparison->setEnabled(!appDocumentsEmpty);
 }
 
 int MainWindow::currentDocumentIndex() const
@@ -6,11 +6,14 @@
 
 #pragma once
 
+#include "../base/document_ptr.h"
 #include "../base/filepath.h"
 #include "../base/property.h"
 #include "../graphics/graphics_object_base_property_group.h"
 #include <QtWidgets/QMainWindow>
+#include <functional>
 #include <memory>
+#include <vector>
 class QFileInfo;
 
 namespace Mayo {
@@ -44,6 +47,8 @@ private:
     void newDocument();
     void openDocuments();
     void importInCurrentDoc();
+    void importFolderInCurrentDoc();
+    void reloadCurrentDocFromDisk();
     void exportSelectedItems();
     void closeCurrentDocument();
     void closeAllDocumentsExceptCurrent();
@@ -58,6 +63,9 @@ private:
     void editOptions();
     void saveImageView();
     void inspectXde();
+    void decimateSelectedMeshes();
+    void compareDocuments();
+    void clearDocumentsComparison();
     // -- Window menu
     void toggleFullscreen();
     void toggleLeftSidebar();
@@ -73,6 +81,13 @@ private:
     void onLeftContentsPageChanged(int pageId);
     void onCurrentDocumentIndexChanged(int idx);
 
+    // Runs a task importing files in 'doc', 'fnFilepaths' is called from the task to get the files
+    // In "Reload" mode only the entities of 'doc' whose geometry changed are replaced
+    enum class ImportMode { Files, Folder, Reload };
+    using ImportFilepaths = std::function<std::vector<FilePath>()>;
+    void runImportInDocument(
+            const DocumentPtr& doc, const QString& taskTitle, ImportFilepaths fnFilepaths, ImportMode mode);
+
     void closeDocument(WidgetGuiDocument* widget);
     void closeDocument(int docIndex);
 
@@ -94,6 +109,7 @@ private:
     Qt::WindowStates m_previousWindowState = Qt::WindowNoState;
     std::unique_ptr<PropertyGroupSignals> m_ptrCurrentNodeDataProperties;
     std::unique_ptr<GraphicsObjectBasePropertyGroup> m_ptrCurrentNodeGraphicsProperties;
+    std::unique_ptr<PropertyGroupSignals> m_ptrCurrentNodeMemoryProperties;
 };
 
 } // namespace Mayo
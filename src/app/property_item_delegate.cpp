@@ -229,6 +229,10 @@ QString PropertyItemDelegate::displayText(const QVariant& value, const QLocale&)
     }
     else if (value.canConvert<Property*>()) {
         const Property* prop = qvariant_cast<Property*>(value);
+        // Read-only properties are disabled while their value isn't available yet
+        if (prop && prop->isUserReadOnly() && !prop->isEnabled())
+            return tr("Computing...");
+
         //return propertyValueText(prop);
         const char* propTypeName = prop ? prop->dynTypeName() : "";
         if (propTypeName == PropertyBool::TypeName)
@@ -9,6 +9,7 @@
 #include <gp_Trsf.hxx>
 #include <Precision.hxx>
 #include <Quantity_Color.hxx>
+#include <algorithm>
 #include <cctype>
 
 namespace Mayo {
@@ -106,6 +107,44 @@ QString QStringUtils::bytesText(uint64_t sizeBytes, const QLocale& locale)
         return tr("%1%2").arg(locale.toString(qSizeBytes / oneMB), tr("MB"));
 }
 
+QString QStringUtils::durationText(int64_t msecs, const QLocale& locale)
+{
+    const qint64 secs = std::max<qint64>(0, msecs / 1000);
+    auto fnTwoDigits = [&](qint64 value) {
+        return locale.toString(value).rightJustified(2, locale.zeroDigit());
+    };
+    if (secs < 60)
+        return tr("%1s").arg(locale.toString(secs));
+    else if (secs < 3600)
+        return tr("%1m%2s").arg(locale.toString(secs / 60), fnTwoDigits(secs % 60));
+    else
+        return tr("%1h%2m").arg(locale.toString(secs / 3600), fnTwoDigits((secs % 3600) / 60));
+}
+
+QString QStringUtils::text(const TaskStatsHistory& history, const QLocale& locale)
+{
+    QString text;
+    auto fnAppendItem = [&](const QString& item) {
+        if (!text.isEmpty())
+            text += tr(", ");
+
+        text += item;
+    };
+    const double bytesPerSec = history.bytesPerSecond();
+    if (bytesPerSec > 0)
+        fnAppendItem(tr("%1/s").arg(QStringUtils::bytesText(uint64_t(bytesPerSec), locale)));
+
+    const double entitiesPerSec = history.entitiesPerSecond();
+    if (entitiesPerSec > 0)
+        fnAppendItem(tr("%1 entities/s").arg(locale.toString(entitiesPerSec, 'f', 1)));
+
+    const int64_t remainingMs = history.remainingMs();
+    if (remainingMs > 0)
+        fnAppendItem(tr("ETA %1").arg(QStringUtils::durationText(remainingMs, locale)));
+
+    return text;
+}
+
 QString QStringUtils::yesNoText(bool on)
 {
     return on ? tr("Yes") : tr("No");
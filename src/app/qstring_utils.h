@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include "../base/task_stats.h"
 #include "../base/unit_system.h"
 #include <QtCore/QCoreApplication>
 #include <QtCore/QLocale>
@@ -35,6 +36,11 @@ public:
     static QString text(const Quantity_Color& color, const QString& format = "RGB(%1, %2 %3)");
 
     static QString bytesText(uint64_t sizeBytes, const QLocale& locale = QLocale());
+    // Duration formatted like "2h05m", "3m20s" or "12s"
+    static QString durationText(int64_t msecs, const QLocale& locale = QLocale());
+    // Throughput and estimated remaining time, eg "12.5MB/s, 340 entities/s, ETA 1m05s"
+    // Items not available in 'history' are omitted
+    static QString text(const TaskStatsHistory& history, const QLocale& locale = QLocale());
 
     static QString yesNoText(bool on);
     static QString yesNoText(Qt::CheckState state);
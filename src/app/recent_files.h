@@ -9,20 +9,18 @@
 #include "../base/filepath.h"
 #include "../base/property_builtins.h"
 
-#include <QtGui/QPixmap>
 #include <vector>
 class QDataStream;
 
 namespace Mayo {
 
-class GuiDocument;
-
+// Thumbnail images aren't part of RecentFile, they are stored as image files in a cache directory
+// and loaded on demand(see AppModule::recentFileThumbnailFilepath())
 struct RecentFile {
     FilePath filepath;
-    QPixmap thumbnail;
-    int64_t thumbnailTimestamp = 0;
-    bool recordThumbnail(GuiDocument* guiDoc, QSize size);
+    int64_t thumbnailTimestamp = 0; // Last modification time of 'filepath' when thumbnail was recorded
     bool isThumbnailOutOfSync() const;
+    static int64_t lastModifiedTimestamp(const FilePath& fp);
 };
 
 using RecentFiles = std::vector<RecentFile>;
@@ -8,15 +8,25 @@
 
 #include "../base/application.h"
 #include "../base/bnd_utils.h"
+#include "../base/document.h"
+#include "../base/filepath.h"
 #include "../base/math_utils.h"
+#include "../base/mesh_section.h"
 #include "../base/settings.h"
+#include "../base/string_conv.h"
+#include "../base/task_progress.h"
 #include "../base/tkernel_utils.h"
+#include "../graphics/graphics_scene.h"
 #include "../graphics/graphics_utils.h"
+#include "../gui/gui_document.h"
+#include "../io_dxf/io_dxf.h"
 #include "app_module.h"
 #include "ui_widget_clip_planes.h"
+#include "widgets_utils.h"
 
 #include <algorithm>
 #include <QtCore/QFile>
+#include <QtWidgets/QFileDialog>
 #include <Bnd_Box.hxx>
 #include <Graphic3d_ClipPlane.hxx>
 #include <Graphic3d_Texture2Dmanual.hxx>
@@ -24,10 +34,26 @@
 
 namespace Mayo {
 
-WidgetClipPlanes::WidgetClipPlanes(const Handle_V3d_View& view3d, QWidget* parent)
+namespace {
+
+// Color of the capping and section of clip plane at index 'iPlane'
+Quantity_NameOfColor clipPlaneColor(int iPlane)
+{
+    switch (iPlane) {
+    case 0: return Quantity_NOC_RED1;
+    case 1: return Quantity_NOC_GREEN1;
+    case 2: return Quantity_NOC_BLUE1;
+    default: return Quantity_NOC_GRAY;
+    }
+}
+
+} // namespace
+
+WidgetClipPlanes::WidgetClipPlanes(GuiDocument* guiDoc, QWidget* parent)
     : QWidget(parent),
       m_ui(new Ui_WidgetClipPlanes),
-      m_view(view3d)
+      m_guiDoc(guiDoc),
+      m_view(guiDoc->v3dView())
 {
     m_ui->setupUi(this);
     this->createPlaneCappingTexture();
@@ -52,17 +78,9 @@ WidgetClipPlanes::WidgetClipPlanes(const Handle_V3d_View& view3d, QWidget* paren
     };
 
     auto fnGetCappingColor = [=](const ClipPlaneData& data) {
-        if (&data == &m_vecClipPlaneData.at(0))
-            return Quantity_NOC_RED1;
-        else if (&data == &m_vecClipPlaneData.at(1))
-            return Quantity_NOC_GREEN1;
-        else if (&data == &m_vecClipPlaneData.at(2))
-            return Quantity_NOC_BLUE1;
-        else
-            return Quantity_NOC_GRAY;
+        return clipPlaneColor(int(&data - m_vecClipPlaneData.data()));
     };
 
-
     const auto appModule = AppModule::get(Application::instance());
     for (ClipPlaneData& data : m_vecClipPlaneData) {
         data.ui.widget_Control->setEnabled(data.ui.check_On->isChecked());
@@ -99,6 +117,15 @@ WidgetClipPlanes::WidgetClipPlanes(const Handle_V3d_View& view3d, QWidget* paren
         }
     });
     m_ui->widget_CustomDir->setVisible(false);
+
+    QObject::connect(&m_sectionTaskMgr, &TaskManager::ended, this, &WidgetClipPlanes::onSectionTaskEnded);
+    QObject::connect(m_ui->check_Section, &QAbstractButton::toggled, this, [=]{
+        for (ClipPlaneData& data : m_vecClipPlaneData)
+            this->updateSection(&data);
+
+        m_view->Redraw();
+    });
+    QObject::connect(m_ui->btn_ExportSection, &QAbstractButton::clicked, this, &WidgetClipPlanes::exportSections);
 }
 
 WidgetClipPlanes::~WidgetClipPlanes()
@@ -124,8 +151,10 @@ void WidgetClipPlanes::setRanges(const Bnd_Box& bndBox)
 
 void WidgetClipPlanes::setClippingOn(bool on)
 {
-    for (ClipPlaneData& data : m_vecClipPlaneData)
+    for (ClipPlaneData& data : m_vecClipPlaneData) {
         data.graphics->SetOn(on ? data.ui.check_On->isChecked() : false);
+        this->updateSection(&data);
+    }
 
     m_view->Redraw();
 }
@@ -141,6 +170,7 @@ void WidgetClipPlanes::connectUi(ClipPlaneData* data)
     QObject::connect(ui.check_On, &QCheckBox::clicked, this, [=](bool on) {
         ui.widget_Control->setEnabled(on);
         this->setPlaneOn(gfx, on);
+        this->updateSection(data);
         m_view->Redraw();
     });
 
@@ -165,6 +195,7 @@ void WidgetClipPlanes::connectUi(ClipPlaneData* data)
         const double dPct = ui.spinValueToSliderValue(pos);
         posSlider->setValue(qRound(dPct));
         GraphicsUtils::Gpx3dClipPlane_setPosition(gfx, pos);
+        this->updateSection(data);
         m_view->Redraw();
     });
 
@@ -173,6 +204,7 @@ void WidgetClipPlanes::connectUi(ClipPlaneData* data)
         QSignalBlocker sigBlock(posSpin); Q_UNUSED(sigBlock);
         posSpin->setValue(pos);
         GraphicsUtils::Gpx3dClipPlane_setPosition(gfx, pos);
+        this->updateSection(data);
         m_view->Redraw();
     });
 
@@ -180,6 +212,7 @@ void WidgetClipPlanes::connectUi(ClipPlaneData* data)
         const gp_Dir invNormal = gfx->ToPlane().Axis().Direction().Reversed();
         GraphicsUtils::Gpx3dClipPlane_setNormal(gfx, invNormal);
         GraphicsUtils::Gpx3dClipPlane_setPosition(gfx, data->ui.posSpin()->value());
+        this->updateSection(data);
         m_view->Redraw();
     });
 
@@ -198,6 +231,7 @@ void WidgetClipPlanes::connectUi(ClipPlaneData* data)
                 const auto bbc = BndBoxCoords::get(m_bndBox);
                 this->setPlaneRange(data, MathUtils::planeRange(bbc, normal));
                 GraphicsUtils::Gpx3dClipPlane_setNormal(gfx, normal);
+                this->updateSection(data);
                 m_view->Redraw();
             }
         });
@@ -246,6 +280,9 @@ void WidgetClipPlanes::setPlaneRange(ClipPlaneData* data, const Range& range)
         posSpin->setValue(newPlanePos);
         posSlider->setValue(data->ui.spinValueToSliderValue(newPlanePos));
     }
+
+    // Document contents may have changed, section has to be computed again anyway
+    this->updateSection(data);
 }
 
 void WidgetClipPlanes::createPlaneCappingTexture()
@@ -271,6 +308,125 @@ void WidgetClipPlanes::createPlaneCappingTexture()
 #endif
 }
 
+bool WidgetClipPlanes::isSectionVisible(const ClipPlaneData& data) const
+{
+    return m_ui->check_Section->isChecked() && data.graphics->IsOn();
+}
+
+void WidgetClipPlanes::updateSection(ClipPlaneData* data)
+{
+    SectionData& section = data->section;
+    if (!this->isSectionVisible(*data)) {
+        if (!section.gfx.IsNull()) {
+            m_guiDoc->graphicsScene()->eraseObject(section.gfx);
+            section.gfx.Nullify();
+        }
+
+        section.isTaskOutdated = false;
+        return;
+    }
+
+    // Section is computed for the latest plane requested only, intermediate positions reached
+    // while the task is running(ex: slider dragged) are skipped
+    if (section.taskId != 0)
+        section.isTaskOutdated = true;
+    else
+        this->startSectionTask(data);
+}
+
+void WidgetClipPlanes::startSectionTask(ClipPlaneData* data)
+{
+    const DocumentPtr doc = m_guiDoc->document();
+    const gp_Pln plane = data->graphics->ToPlane();
+    auto result = std::make_shared<TopoDS_Shape>();
+    SectionData& section = data->section;
+    section.taskId = m_sectionTaskMgr.newTask([=](TaskProgress* progress) {
+        // Sections are computed from the actual triangulations
+        doc->applyDeferredScalings();
+        *result = MeshSection::toShape(MeshSection::compute(doc->bvh(), plane, progress));
+    });
+    section.taskResult = result;
+    section.isTaskOutdated = false;
+    m_sectionTaskMgr.run(section.taskId);
+}
+
+void WidgetClipPlanes::onSectionTaskEnded(TaskId taskId)
+{
+    auto itData = std::find_if(
+                m_vecClipPlaneData.begin(), m_vecClipPlaneData.end(), [=](const ClipPlaneData& data) {
+        return data.section.taskId == taskId;
+    });
+    if (itData == m_vecClipPlaneData.end())
+        return;
+
+    SectionData& section = itData->section;
+    const TopoDS_Shape shape = *section.taskResult;
+    section.taskId = 0;
+    section.taskResult.reset();
+    if (!this->isSectionVisible(*itData))
+        return;
+
+    // Plane moved again while computing, then chain with the latest plane
+    if (section.isTaskOutdated)
+        this->startSectionTask(&(*itData));
+
+    GraphicsScene* scene = m_guiDoc->graphicsScene();
+    if (section.gfx.IsNull()) {
+        section.gfx = new AIS_Shape(shape);
+        section.gfx->SetColor(clipPlaneColor(int(itData - m_vecClipPlaneData.begin())));
+        section.gfx->SetWidth(2.);
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 4, 0)
+        // Section lies on the clip plane, it mustn't be clipped
+        Handle_Graphic3d_SequenceOfHClipPlane seqClipPlane = new Graphic3d_SequenceOfHClipPlane;
+        seqClipPlane->SetOverrideGlobal(true);
+        section.gfx->SetClipPlanes(seqClipPlane);
+#endif
+        scene->addObject(section.gfx, GraphicsScene::AddObjectDisableSelectionMode);
+    }
+    else {
+        section.gfx->SetShape(shape);
+        scene->recomputeObjectPresentation(section.gfx);
+    }
+
+    scene->redraw();
+}
+
+void WidgetClipPlanes::exportSections()
+{
+    std::vector<const ClipPlaneData*> vecActiveData;
+    for (const ClipPlaneData& data : m_vecClipPlaneData) {
+        if (data.graphics->IsOn())
+            vecActiveData.push_back(&data);
+    }
+
+    if (vecActiveData.empty()) {
+        WidgetsUtils::asyncMsgBoxInfo(this, tr("Export sections"), tr("No clip plane is active"));
+        return;
+    }
+
+    const QString fileName = QFileDialog::getSaveFileName(
+                this, tr("Select DXF file"), QString(), tr("DXF files(*.dxf)"));
+    if (fileName.isEmpty())
+        return;
+
+    // Sections are written in 3D document coordinates, one layer per plane
+    IO::DxfWriter writer;
+    writer.parameters().projection = IO::DxfWriter::Projection::None;
+    const DocumentPtr doc = m_guiDoc->document();
+    doc->applyDeferredScalings();
+    for (const ClipPlaneData* data : vecActiveData) {
+        const auto vecPolyline = MeshSection::compute(doc->bvh(), data->graphics->ToPlane());
+        const QString layerName = QString("Section %1").arg(data->ui.check_On->text());
+        writer.addShape(to_stdString(layerName), MeshSection::toShape(vecPolyline));
+    }
+
+    TaskProgress progress;
+    if (!writer.writeFile(filepathFrom(fileName), &progress)) {
+        WidgetsUtils::asyncMsgBoxCritical(
+                    this, tr("Error"), tr("Failed to export sections to '%1'").arg(fileName));
+    }
+}
+
 WidgetClipPlanes::UiClipPlane::UiClipPlane(QCheckBox* checkOn, QWidget* widgetControl)
     : check_On(checkOn), widget_Control(widgetControl)
 { }
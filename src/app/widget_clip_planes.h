@@ -6,11 +6,15 @@
 
 #pragma once
 
+#include "../base/task_manager.h"
+
 #include <QtWidgets/QWidget>
+#include <AIS_Shape.hxx>
 #include <Bnd_Box.hxx>
 #include <Graphic3d_ClipPlane.hxx>
 #include <Graphic3d_TextureMap.hxx>
 #include <V3d_View.hxx>
+#include <memory>
 #include <vector>
 class QCheckBox;
 class QDoubleSpinBox;
@@ -19,10 +23,12 @@ class QAbstractButton;
 
 namespace Mayo {
 
+class GuiDocument;
+
 class WidgetClipPlanes : public QWidget {
     Q_OBJECT
 public:
-    WidgetClipPlanes(const Handle_V3d_View& view3d, QWidget* parent = nullptr);
+    WidgetClipPlanes(GuiDocument* guiDoc, QWidget* parent = nullptr);
     ~WidgetClipPlanes();
 
     void setRanges(const Bnd_Box& box);
@@ -44,9 +50,18 @@ private:
         double sliderValueToSpinValue(double val) const;
     };
 
+    // Cross-section of the document meshes, computed asynchronously
+    struct SectionData {
+        Handle_AIS_Shape gfx; // Null until first section was computed
+        TaskId taskId = 0;
+        std::shared_ptr<TopoDS_Shape> taskResult;
+        bool isTaskOutdated = false; // Plane changed while task was running
+    };
+
     struct ClipPlaneData {
         Handle_Graphic3d_ClipPlane graphics;
         UiClipPlane ui;
+        SectionData section;
     };
 
     using Range = std::pair<double, double>;
@@ -58,11 +73,20 @@ private:
 
     void createPlaneCappingTexture();
 
+    // -- Sections
+    bool isSectionVisible(const ClipPlaneData& data) const;
+    void updateSection(ClipPlaneData* data);
+    void startSectionTask(ClipPlaneData* data);
+    void onSectionTaskEnded(TaskId taskId);
+    void exportSections();
+
     class Ui_WidgetClipPlanes* m_ui;
+    GuiDocument* m_guiDoc;
     Handle_V3d_View m_view;
     std::vector<ClipPlaneData> m_vecClipPlaneData;
     Bnd_Box m_bndBox;
     Handle_Graphic3d_TextureMap m_textureCapping;
+    TaskManager m_sectionTaskMgr;
 };
 
 } // namespace Mayo
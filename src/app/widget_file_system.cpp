@@ -5,6 +5,10 @@
 ****************************************************************************/
 
 #include "widget_file_system.h"
+
+#include "../base/application.h"
+#include "../base/io_system.h"
+#include "../base/task_manager.h"
 #include "qstring_utils.h"
 
 #include <QtCore/QDateTime>
@@ -12,6 +16,7 @@
 #include <QtCore/QFileInfo>
 #include <QtWidgets/QBoxLayout>
 #include <QtWidgets/QTreeWidget>
+#include <vector>
 
 namespace Mayo {
 
@@ -24,6 +29,17 @@ static QString absolutePath(const QFileInfo& fi)
 
 } // namespace Internal
 
+// Written by the background tasks, read in the GUI thread only once they are ended
+struct WidgetFileSystem::DirListing {
+    struct Entry {
+        QFileInfo fileInfo;
+        IO::FileMetadata metadata;
+    };
+
+    QString dirPath;
+    std::vector<Entry> vecEntry;
+};
+
 WidgetFileSystem::WidgetFileSystem(QWidget* parent)
     : QWidget(parent),
       m_treeWidget(new QTreeWidget(this))
@@ -40,6 +56,14 @@ WidgetFileSystem::WidgetFileSystem(QWidget* parent)
     QObject::connect(
                 m_treeWidget, &QTreeWidget::itemActivated,
                 this, &WidgetFileSystem::onTreeItemActivated);
+    QObject::connect(
+                TaskManager::globalInstance(), &TaskManager::ended,
+                this, &WidgetFileSystem::onTaskEnded);
+}
+
+WidgetFileSystem::~WidgetFileSystem()
+{
+    this->abortTasks();
 }
 
 QFileInfo WidgetFileSystem::currentLocation() const
@@ -51,49 +75,15 @@ void WidgetFileSystem::setLocation(const QFileInfo& fiLoc)
 {
     const QString pathCurrLocation = Internal::absolutePath(m_location);
     const QString pathLoc = Internal::absolutePath(fiLoc);
+    m_location = fiLoc;
     if (pathCurrLocation == pathLoc) {
-        for (int i = 0; i < m_treeWidget->topLevelItemCount(); ++i) {
-            QTreeWidgetItem* item = m_treeWidget->topLevelItem(i);
-            if (item->text(0) == fiLoc.fileName()) {
-                m_treeWidget->clearSelection();
-                item->setSelected(true);
-                break;
-            }
-        }
+        this->selectLocationItem();
     }
     else {
         m_treeWidget->clear();
-        QTreeWidgetItem* itemToBeSelected = nullptr;
-        QList<QTreeWidgetItem*> listItem;
-        if (fiLoc.exists()) {
-            const QDir dir(pathLoc);
-            const QFileInfoList listEntryFileInfo =
-                    dir.entryInfoList(
-                        QDir::Files | QDir::AllDirs | QDir::NoDot,
-                        QDir::DirsFirst);
-            for (const QFileInfo& fi : listEntryFileInfo) {
-                auto item = new QTreeWidgetItem;
-                if (fi.fileName() != QLatin1String(".")) {
-                    item->setText(0, fi.fileName());
-                    item->setIcon(0, m_fileIconProvider.icon(fi));
-                    const QString itemTooltip =
-                            tr("%1\nSize: %2\nLast modified: %3")
-                            .arg(QDir::toNativeSeparators(fi.absoluteFilePath()))
-                            .arg(QStringUtils::bytesText(fi.size()))
-                            .arg(fi.lastModified().toString(Qt::SystemLocaleShortDate));
-                    item->setToolTip(0, itemTooltip);
-                    if (fi.fileName() == fiLoc.fileName())
-                        itemToBeSelected = item;
-                }
-                listItem.push_back(item);
-            }
-        }
-        m_treeWidget->addTopLevelItems(listItem);
         m_treeWidget->headerItem()->setText(0, fiLoc.dir().dirName());
-        if (itemToBeSelected != nullptr)
-            itemToBeSelected->setSelected(true);
+        this->startListing(pathLoc);
     }
-    m_location = fiLoc;
 }
 
 void WidgetFileSystem::onTreeItemActivated(QTreeWidgetItem* item, int column)
@@ -113,4 +103,123 @@ void WidgetFileSystem::onTreeItemActivated(QTreeWidgetItem* item, int column)
     }
 }
 
+void WidgetFileSystem::onTaskEnded(TaskId taskId)
+{
+    if (taskId == 0)
+        return;
+
+    if (taskId == m_taskIdListing) {
+        m_taskIdListing = 0;
+        QList<QTreeWidgetItem*> listItem;
+        // Generic icons: icons specific to each file would require to access the drive again
+        const QIcon iconDir = m_fileIconProvider.icon(QFileIconProvider::Folder);
+        const QIcon iconFile = m_fileIconProvider.icon(QFileIconProvider::File);
+        for (const DirListing::Entry& entry : m_listing->vecEntry) {
+            const QFileInfo& fi = entry.fileInfo;
+            auto item = new QTreeWidgetItem;
+            item->setText(0, fi.fileName());
+            item->setIcon(0, fi.isDir() ? iconDir : iconFile);
+            const QString itemTooltip =
+                    tr("%1\nSize: %2\nLast modified: %3")
+                    .arg(QDir::toNativeSeparators(fi.absoluteFilePath()))
+                    .arg(QStringUtils::bytesText(fi.size()))
+                    .arg(fi.lastModified().toString(Qt::SystemLocaleShortDate));
+            item->setToolTip(0, itemTooltip);
+            listItem.push_back(item);
+        }
+
+        m_treeWidget->addTopLevelItems(listItem);
+        this->selectLocationItem();
+        this->startProbing();
+    }
+    else if (taskId == m_taskIdProbing) {
+        m_taskIdProbing = 0;
+        // Items were created in the same order as the listing entries
+        for (int i = 0; i < m_treeWidget->topLevelItemCount() && i < int(m_listing->vecEntry.size()); ++i) {
+            const IO::FileMetadata& metadata = m_listing->vecEntry.at(i).metadata;
+            if (metadata.format == IO::Format_Unknown)
+                continue;
+
+            QTreeWidgetItem* item = m_treeWidget->topLevelItem(i);
+            QString itemTooltip = item->toolTip(0);
+            itemTooltip += tr("\nFormat: %1").arg(QString::fromUtf8(IO::formatName(metadata.format).data()));
+            if (!metadata.schema.empty())
+                itemTooltip += tr("\nSchema: %1").arg(QString::fromStdString(metadata.schema));
+
+            if (metadata.entityCount >= 0)
+                itemTooltip += tr("\nEntities: ~%1").arg(metadata.entityCount);
+
+            item->setToolTip(0, itemTooltip);
+        }
+    }
+}
+
+void WidgetFileSystem::startListing(const QString& dirPath)
+{
+    this->abortTasks();
+    auto listing = std::make_shared<DirListing>();
+    listing->dirPath = dirPath;
+    m_listing = listing;
+    auto taskMgr = TaskManager::globalInstance();
+    m_taskIdListing = taskMgr->newTask([=](TaskProgress*) {
+        const QDir dir(listing->dirPath);
+        if (!dir.exists())
+            return;
+
+        const QFileInfoList listEntryFileInfo =
+                dir.entryInfoList(QDir::Files | QDir::AllDirs | QDir::NoDot, QDir::DirsFirst);
+        for (const QFileInfo& fi : listEntryFileInfo) {
+            DirListing::Entry entry;
+            entry.fileInfo = fi;
+            // Stats are cached by QFileInfo, so GUI thread won't access the drive again
+            entry.fileInfo.size();
+            entry.fileInfo.lastModified();
+            listing->vecEntry.push_back(std::move(entry));
+        }
+    }, TaskPriority_Interactive);
+    taskMgr->setTitle(m_taskIdListing, tr("List %1").arg(QDir::toNativeSeparators(dirPath)));
+    taskMgr->run(m_taskIdListing);
+}
+
+void WidgetFileSystem::startProbing()
+{
+    auto listing = m_listing;
+    auto ioSystem = Application::instance()->ioSystem();
+    auto taskMgr = TaskManager::globalInstance();
+    m_taskIdProbing = taskMgr->newTask([=](TaskProgress* progress) {
+        for (DirListing::Entry& entry : listing->vecEntry) {
+            if (progress->isAbortRequested())
+                return;
+
+            if (entry.fileInfo.isFile())
+                entry.metadata = ioSystem->fileMetadata(filepathFrom(entry.fileInfo));
+        }
+    }, TaskPriority_Background);
+    taskMgr->setTitle(m_taskIdProbing, tr("Probe files of %1").arg(QDir::toNativeSeparators(listing->dirPath)));
+    taskMgr->run(m_taskIdProbing);
+}
+
+void WidgetFileSystem::abortTasks()
+{
+    auto taskMgr = TaskManager::globalInstance();
+    for (TaskId* ptrTaskId : { &m_taskIdListing, &m_taskIdProbing }) {
+        if (*ptrTaskId != 0)
+            taskMgr->requestAbort(*ptrTaskId);
+
+        *ptrTaskId = 0;
+    }
+}
+
+void WidgetFileSystem::selectLocationItem()
+{
+    m_treeWidget->clearSelection();
+    for (int i = 0; i < m_treeWidget->topLevelItemCount(); ++i) {
+        QTreeWidgetItem* item = m_treeWidget->topLevelItem(i);
+        if (item->text(0) == m_location.fileName()) {
+            item->setSelected(true);
+            break;
+        }
+    }
+}
+
 } // namespace Mayo
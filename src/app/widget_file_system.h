@@ -6,18 +6,24 @@
 
 #pragma once
 
+#include "../base/task_common.h"
+
 #include <QtCore/QFileInfo>
 #include <QtWidgets/QWidget>
 #include <QtWidgets/QFileIconProvider>
+#include <memory>
 class QTreeWidget;
 class QTreeWidgetItem;
 
 namespace Mayo {
 
+// Lists the contents of a directory. Listing and probing of the files(see IO::System::fileMetadata())
+// are done in background tasks, so browsing isn't blocked by slow drives(ex: network drives)
 class WidgetFileSystem : public QWidget {
     Q_OBJECT
 public:
     WidgetFileSystem(QWidget* parent = nullptr);
+    ~WidgetFileSystem();
 
     QFileInfo currentLocation() const;
     void setLocation(const QFileInfo& fiLoc);
@@ -26,11 +32,21 @@ signals:
     void locationActivated(const QFileInfo& loc);
 
 private:
+    struct DirListing;
+
     void onTreeItemActivated(QTreeWidgetItem* item, int column);
+    void onTaskEnded(TaskId taskId);
+    void startListing(const QString& dirPath);
+    void startProbing();
+    void abortTasks();
+    void selectLocationItem();
 
     QTreeWidget* m_treeWidget = nullptr;
     QFileInfo m_location;
     QFileIconProvider m_fileIconProvider;
+    std::shared_ptr<DirListing> m_listing;
+    TaskId m_taskIdListing = 0;
+    TaskId m_taskIdProbing = 0;
 };
 
 } // namespace Mayo
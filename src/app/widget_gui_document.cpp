@@ -23,6 +23,7 @@
 #include <QtWidgets/QBoxLayout>
 #include <QtWidgets/QMenu>
 #include <QtWidgets/QProxyStyle>
+#include <QtWidgets/QSplitter>
 #include <QtWidgets/QWidgetAction>
 
 namespace Mayo {
@@ -80,12 +81,15 @@ WidgetGuiDocument::WidgetGuiDocument(GuiDocument* guiDoc, QWidget* parent)
     : QWidget(parent),
       m_guiDoc(guiDoc),
       m_qtOccView(new WidgetOccView(guiDoc->v3dView(), this)),
-      m_controller(new WidgetOccViewController(m_qtOccView))
+      m_controller(new WidgetOccViewController(m_qtOccView)),
+      m_splitterViews(new QSplitter(Qt::Horizontal, this))
 {
     {
+        m_splitterViews->addWidget(m_qtOccView);
+        m_splitterViews->setChildrenCollapsible(false);
         auto layout = new QVBoxLayout;
         layout->setContentsMargins(0, 0, 0, 0);
-        layout->addWidget(m_qtOccView);
+        layout->addWidget(m_splitterViews);
         this->setLayout(layout);
     }
 
@@ -94,6 +98,8 @@ WidgetGuiDocument::WidgetGuiDocument(GuiDocument* guiDoc, QWidget* parent)
     m_btnEditClipping->setCheckable(true);
     m_btnExplode = Internal::createViewBtn(this, Theme::Icon::Multiple, tr("Explode assemblies"));
     m_btnExplode->setCheckable(true);
+    m_btnSplitView = Internal::createViewBtn(this, Theme::Icon::LeftSidebar, tr("Split view"));
+    m_btnSplitView->setCheckable(true);
 
     QObject::connect(m_btnFitAll, &ButtonFlat::clicked, this, [=]{
         m_guiDoc->runViewCameraAnimation(&GraphicsUtils::V3dView_fitAll);
@@ -104,12 +110,39 @@ WidgetGuiDocument::WidgetGuiDocument(GuiDocument* guiDoc, QWidget* parent)
     QObject::connect(
                 m_btnExplode, &ButtonFlat::checked,
                 this, &WidgetGuiDocument::toggleWidgetExplode);
+    QObject::connect(
+                m_btnSplitView, &ButtonFlat::checked,
+                this, &WidgetGuiDocument::toggleSecondaryView);
     QObject::connect(
                 m_controller, &V3dViewController::dynamicActionStarted,
                 m_guiDoc, &GuiDocument::stopViewCameraAnimation);
     QObject::connect(
                 m_controller, &V3dViewController::viewScaled,
                 m_guiDoc, &GuiDocument::stopViewCameraAnimation);
+    QObject::connect(
+                m_controller, &V3dViewController::dynamicActionStarted,
+                m_guiDoc, &GuiDocument::startViewDynamicAction);
+    QObject::connect(
+                m_controller, &V3dViewController::dynamicActionEnded,
+                m_guiDoc, &GuiDocument::stopViewDynamicAction);
+    QObject::connect(
+                m_controller, &V3dViewController::dynamicActionEnded,
+                m_guiDoc, &GuiDocument::updateViewLevelOfDetail);
+    QObject::connect(
+                m_controller, &V3dViewController::viewScaled,
+                m_guiDoc, &GuiDocument::updateViewLevelOfDetail);
+
+    // Redraws of the views are coalesced and paced to the refresh rate of the display
+    m_guiDoc->graphicsScene()->setRedrawRequestHandler([=]{
+        m_qtOccView->requestRedraw();
+        if (m_qtOccSecondaryView)
+            m_qtOccSecondaryView->requestRedraw();
+    });
+    m_guiDoc->viewCameraAnimation()->setViewRedrawRequest([=]{ m_qtOccView->requestRedraw(); });
+    QObject::connect(m_qtOccView, &WidgetOccView::aboutToRedraw, this, [=]{
+        m_guiDoc->viewCameraAnimation()->updateViewCamera();
+    });
+
     QObject::connect(
                 m_controller, &V3dViewController::mouseClicked, this, [=](Qt::MouseButton btn) {
         if (btn == Qt::MouseButton::LeftButton) {
@@ -128,6 +161,13 @@ WidgetGuiDocument::WidgetGuiDocument(GuiDocument* guiDoc, QWidget* parent)
     this->recreateViewControls();
 }
 
+WidgetGuiDocument::~WidgetGuiDocument()
+{
+    // GuiDocument may outlive this widget
+    m_guiDoc->graphicsScene()->setRedrawRequestHandler({});
+    m_guiDoc->viewCameraAnimation()->setViewRedrawRequest({});
+}
+
 void WidgetGuiDocument::paintPanel(QWidget* widget)
 {
     QPainter painter(widget);
@@ -150,7 +190,7 @@ void WidgetGuiDocument::toggleWidgetClipPlanes(bool on)
     if (!m_widgetClipPlanes) {
         if (on) {
             auto panel = new Internal::PanelView3d(this);
-            auto widget = new WidgetClipPlanes(m_guiDoc->v3dView(), panel);
+            auto widget = new WidgetClipPlanes(m_guiDoc, panel);
             WidgetsUtils::addContentsWidget(panel, widget);
             panel->show();
             panel->adjustSize();
@@ -194,6 +234,40 @@ void WidgetGuiDocument::toggleWidgetExplode(bool on)
         m_btnEditClipping->setChecked(false);
 }
 
+void WidgetGuiDocument::toggleSecondaryView(bool on)
+{
+    if (on && !m_qtOccSecondaryView) {
+        // View shares the presentations of the main view, only camera and clip planes are its own
+        m_qtOccSecondaryView = new WidgetOccView(m_guiDoc->createSecondaryView(), m_splitterViews);
+        auto controller = new WidgetOccViewController(m_qtOccSecondaryView);
+        controller->setInstantZoomFactor(m_controller->instantZoomFactor());
+        const Handle_V3d_View view = m_qtOccSecondaryView->v3dView();
+        QObject::connect(controller, &V3dViewController::mouseMoved, this, [=](const QPoint& pos) {
+            m_guiDoc->graphicsScene()->highlightAt(pos, view);
+        });
+        QObject::connect(controller, &V3dViewController::mouseClicked, this, [=](Qt::MouseButton btn) {
+            if (btn == Qt::MouseButton::LeftButton) {
+                if (!m_guiDoc->processAction(m_guiDoc->graphicsScene()->currentHighlightedOwner()))
+                    m_guiDoc->graphicsScene()->select();
+            }
+        });
+        QObject::connect(controller, &WidgetOccViewController::multiSelectionToggled, this, [=](bool on) {
+            m_guiDoc->graphicsScene()->setSelectionMode(
+                        on ? GraphicsScene::SelectionMode::Multi : GraphicsScene::SelectionMode::Single);
+        });
+        m_splitterViews->addWidget(m_qtOccSecondaryView);
+        const int viewWidth = m_splitterViews->width() / 2;
+        m_splitterViews->setSizes({ viewWidth, viewWidth });
+    }
+    else if (!on && m_qtOccSecondaryView) {
+        const Handle_V3d_View view = m_qtOccSecondaryView->v3dView();
+        delete m_qtOccSecondaryView; // Deletes also the owned view controller
+        m_qtOccSecondaryView = nullptr;
+        m_guiDoc->destroySecondaryView(view);
+        m_guiDoc->graphicsScene()->redraw();
+    }
+}
+
 void WidgetGuiDocument::layoutWidgetPanel(QWidget* panel)
 {
     auto fnPanelPos = [=](QWidget* panel) -> QPoint {
@@ -295,7 +369,7 @@ void WidgetGuiDocument::recreateViewControls()
 QRect WidgetGuiDocument::viewControlsRect() const
 {
     const QRect rectFirstBtn = m_btnFitAll->frameGeometry();
-    const QRect rectLastBtn = m_btnExplode->frameGeometry();
+    const QRect rectLastBtn = m_btnSplitView->frameGeometry();
     QRect rect;
     rect.setCoords(
                 rectFirstBtn.left(), rectFirstBtn.top(),
@@ -310,7 +384,7 @@ void WidgetGuiDocument::layoutViewControls()
         if (m_guiDoc->viewTrihedronMode() == GuiDocument::ViewTrihedronMode::AisViewCube) {
             const int btnSize = m_btnFitAll->width();
             const int viewCubeBndSize = m_guiDoc->aisViewCubeBoundingSize();
-            const int ctrlCount = 2 + m_vecWidgetForViewProj.size();
+            const int ctrlCount = 3 + m_vecWidgetForViewProj.size();
             const int ctrlWidth = ctrlCount * btnSize + (ctrlCount - 1) * margin;
             const int ctrlHeight = btnSize;
             const int ctrlXOffset = (viewCubeBndSize - ctrlWidth) / 2;
@@ -339,6 +413,7 @@ void WidgetGuiDocument::layoutViewControls()
 
     WidgetsUtils::moveWidgetRightTo(m_btnEditClipping, widgetLast, margin);
     WidgetsUtils::moveWidgetRightTo(m_btnExplode, m_btnEditClipping, margin);
+    WidgetsUtils::moveWidgetRightTo(m_btnSplitView, m_btnExplode, margin);
 }
 
 } // namespace Mayo
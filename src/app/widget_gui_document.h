@@ -10,6 +10,7 @@
 #include <QtWidgets/QWidget>
 #include <V3d_TypeOfOrientation.hxx>
 #include <vector>
+class QSplitter;
 
 namespace Mayo {
 
@@ -23,6 +24,7 @@ class WidgetGuiDocument : public QWidget {
     Q_OBJECT
 public:
     WidgetGuiDocument(GuiDocument* guiDoc, QWidget* parent = nullptr);
+    ~WidgetGuiDocument();
 
     GuiDocument* guiDocument() const { return m_guiDoc; }
     V3dViewController* controller() const { return m_controller; }
@@ -35,6 +37,7 @@ protected:
 private:
     void toggleWidgetClipPlanes(bool on);
     void toggleWidgetExplode(bool on);
+    void toggleSecondaryView(bool on);
 
     void recreateViewControls();
     QRect viewControlsRect() const;
@@ -44,6 +47,8 @@ private:
     GuiDocument* m_guiDoc = nullptr;
     WidgetOccView* m_qtOccView = nullptr;
     WidgetOccViewController* m_controller = nullptr;
+    QSplitter* m_splitterViews = nullptr;
+    WidgetOccView* m_qtOccSecondaryView = nullptr;
     WidgetClipPlanes* m_widgetClipPlanes = nullptr;
     WidgetExplodeAssembly* m_widgetExplodeAsm = nullptr;
     QRect m_rectControls;
@@ -51,6 +56,7 @@ private:
     ButtonFlat* m_btnFitAll = nullptr;
     ButtonFlat* m_btnEditClipping = nullptr;
     ButtonFlat* m_btnExplode = nullptr;
+    ButtonFlat* m_btnSplitView = nullptr;
     std::vector<QWidget*> m_vecWidgetForViewProj;
 };
 
@@ -7,7 +7,9 @@
 #include "widget_home_files.h"
 
 #include "../base/application.h"
+#include "../base/io_system.h"
 #include "../base/settings.h"
+#include "../base/task_manager.h"
 #include "../gui/gui_application.h"
 #include "../gui/gui_document.h"
 #include "app_module.h"
@@ -18,10 +20,13 @@
 #include <QtCore/QDateTime>
 #include <QtCore/QDir>
 #include <QtCore/QFileInfo>
+#include <QtCore/QTimer>
 #include <QtGui/QPixmapCache>
 #include <QtWidgets/QFileIconProvider>
 #include <QtWidgets/QVBoxLayout>
 #include <algorithm>
+#include <memory>
+#include <vector>
 
 namespace Mayo {
 
@@ -82,8 +87,12 @@ public:
         }
         else {
             auto appModule = AppModule::get(Application::instance());
-            const RecentFile* recentFile = appModule ? appModule->findRecentFile(filepathFrom(url)) : nullptr;
-            pixmap = recentFile ? recentFile->thumbnail : QPixmap();
+            // Thumbnail is read from cache directory only once the item has to be painted
+            const FilePath thumbnailFilepath =
+                    appModule ? appModule->recentFileThumbnailFilepath(filepathFrom(url)) : FilePath();
+            if (!thumbnailFilepath.empty() && filepathIsRegularFile(thumbnailFilepath))
+                pixmap.load(filepathTo<QString>(thumbnailFilepath), "PNG");
+
             if (pixmap.isNull()) {
                 const QIcon icon = m_fileIconProvider.icon(QFileInfo(url));
                 pixmap = fnPixmap(icon, 64, 64);
@@ -101,6 +110,12 @@ public:
     }
 
 private:
+    struct FileStats {
+        FilePath filepath;
+        QFileInfo fileInfo;
+        IO::FileMetadata metadata;
+    };
+
     void reloadRecentFiles() {
         auto app = Application::instance();
         auto appModule = AppModule::get(app);
@@ -109,6 +124,70 @@ private:
             return;
 
         m_storage->m_items.erase(m_storage->m_items.begin() + 2, m_storage->m_items.end());
+        for (const RecentFile& recentFile : listRecentFile) {
+            // Thumbnail may have been recorded again since pixmap was cached
+            QPixmapCache::remove(filepathTo<QString>(recentFile.filepath));
+            HomeFileItem item;
+            // Only the path is known for now, file is accessed by startFileStatsTask()
+            const auto fi = filepathTo<QFileInfo>(recentFile.filepath);
+            item.name = fi.fileName();
+            item.type = HomeFileItem::Type::RecentFile;
+            item.description = QDir::toNativeSeparators(fi.absolutePath());
+            item.textWrapMode = QTextOption::WrapAtWordBoundaryOrAnywhere;
+            item.imageUrl = filepathTo<QString>(recentFile.filepath);
+            item.filepath = recentFile.filepath;
+            m_storage->m_items.push_back(std::move(item));
+        }
+
+        m_cacheRecentFiles = listRecentFile;
+        this->startFileStatsTask();
+    }
+
+    // File stats(and format) are read in a background task, recent files might be on slow drives
+    void startFileStatsTask() {
+        auto vecFileStats = std::make_shared<std::vector<FileStats>>();
+        for (const RecentFile& recentFile : m_cacheRecentFiles)
+            vecFileStats->push_back({ recentFile.filepath, {}, {} });
+
+        auto taskMgr = TaskManager::globalInstance();
+        if (m_taskIdFileStats != 0)
+            taskMgr->requestAbort(m_taskIdFileStats);
+
+        auto ioSystem = Application::instance()->ioSystem();
+        m_taskIdFileStats = taskMgr->newTask([=](TaskProgress* progress) {
+            for (FileStats& stats : *vecFileStats) {
+                if (progress->isAbortRequested())
+                    return;
+
+                // Stats are cached by QFileInfo, so GUI thread won't access the drive again
+                stats.fileInfo = filepathTo<QFileInfo>(stats.filepath);
+                stats.fileInfo.size();
+                stats.fileInfo.birthTime();
+                stats.fileInfo.lastModified();
+                stats.fileInfo.lastRead();
+                if (stats.fileInfo.isFile())
+                    stats.metadata = ioSystem->fileMetadata(stats.filepath);
+            }
+        }, TaskPriority_Background);
+        const TaskId taskId = m_taskIdFileStats;
+        auto conn = std::make_shared<QMetaObject::Connection>();
+        *conn = QObject::connect(taskMgr, &TaskManager::ended, this, [=](TaskId endedTaskId) {
+            if (endedTaskId != taskId)
+                return;
+
+            QObject::disconnect(*conn);
+            if (taskId != m_taskIdFileStats)
+                return;
+
+            m_taskIdFileStats = 0;
+            this->updateFileStats(*vecFileStats);
+        });
+        taskMgr->setTitle(m_taskIdFileStats, WidgetHomeFiles::tr("Read stats of recent files"));
+        taskMgr->run(m_taskIdFileStats);
+    }
+
+    void updateFileStats(const std::vector<FileStats>& vecFileStats) {
+        auto app = Application::instance();
         auto fnToString = [=](const QDateTime& dateTime) {
             const QString strTime = dateTime.time().toString("HH:mm");
             const QDate date = dateTime.date();
@@ -132,11 +211,18 @@ private:
                 return WidgetHomeFiles::tr("%1 %2").arg(strDate, strTime);
             }
         };
-        for (const RecentFile& recentFile : listRecentFile) {
-            HomeFileItem item;
-            const auto fi = filepathTo<QFileInfo>(recentFile.filepath);
-            item.name = fi.fileName();
-            item.type = HomeFileItem::Type::RecentFile;
+        int rowFirst = -1;
+        int rowLast = -1;
+        for (const FileStats& stats : vecFileStats) {
+            auto itItem = std::find_if(
+                        m_storage->m_items.begin(), m_storage->m_items.end(), [&](const HomeFileItem& item) {
+                return item.type == HomeFileItem::Type::RecentFile && item.filepath == stats.filepath;
+            });
+            if (itItem == m_storage->m_items.end())
+                continue;
+
+            const QFileInfo& fi = stats.fileInfo;
+            HomeFileItem& item = *itItem;
             item.description =
                     WidgetHomeFiles::tr(
                         "%1\n\n"
@@ -150,13 +236,22 @@ private:
                     .arg(fnToString(fi.lastModified()))
                     .arg(fnToString(fi.lastRead()))
                     ;
-            item.textWrapMode = QTextOption::WrapAtWordBoundaryOrAnywhere;
-            item.imageUrl = filepathTo<QString>(recentFile.filepath);
-            item.filepath = recentFile.filepath;
-            m_storage->m_items.push_back(std::move(item));
+            if (stats.metadata.format != IO::Format_Unknown) {
+                item.description += WidgetHomeFiles::tr("Format: %1")
+                        .arg(QString::fromUtf8(IO::formatName(stats.metadata.format).data()));
+                if (stats.metadata.entityCount >= 0)
+                    item.description += WidgetHomeFiles::tr(", ~%1 entities").arg(stats.metadata.entityCount);
+
+                item.description += "\n";
+            }
+
+            const int row = int(itItem - m_storage->m_items.begin());
+            rowFirst = rowFirst < 0 ? row : std::min(rowFirst, row);
+            rowLast = std::max(rowLast, row);
         }
 
-        m_cacheRecentFiles = listRecentFile;
+        if (rowFirst >= 0)
+            emit this->dataChanged(this->index(rowFirst), this->index(rowLast));
     }
 
     static constexpr const char ImageId_NewDocument[] = "NewDocument_beae5f60-78a5-4b4e-8875-2dcebdbb4c58";
@@ -165,6 +260,7 @@ private:
     QFileIconProvider m_fileIconProvider;
     RecentFiles m_cacheRecentFiles;
     ListHelper::DefaultModelStorage<HomeFileItem>* m_storage = nullptr;
+    TaskId m_taskIdFileStats = 0;
 };
 
 class HomeFilesDelegate : public ListHelper::ItemDelegate {
@@ -217,7 +313,7 @@ WidgetHomeFiles::WidgetHomeFiles(QWidget* parent)
 
     QObject::connect(app->settings(), &Settings::changed, this, [=](const Property* setting) {
         if (setting == &appModule->recentFiles)
-            model->reload();
+            this->scheduleReload();
     });
 }
 
@@ -235,4 +331,21 @@ void WidgetHomeFiles::showEvent(QShowEvent* event)
     homeFilesModel->reload();
 }
 
+void WidgetHomeFiles::scheduleReload()
+{
+    // Recent files are changed many times at startup(loading, reset, loading again), reload is
+    // done once on next event loop iteration. Hidden widget is reloaded when shown
+    if (m_isReloadScheduled)
+        return;
+
+    m_isReloadScheduled = true;
+    QTimer::singleShot(0, this, [=]{
+        m_isReloadScheduled = false;
+        if (this->isVisible()) {
+            auto homeFilesModel = static_cast<HomeFilesModel*>(m_gridModel.sourceModel());
+            homeFilesModel->reload();
+        }
+    });
+}
+
 } // namespace Mayo
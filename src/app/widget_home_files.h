@@ -27,9 +27,12 @@ protected:
     void showEvent(QShowEvent* event) override;
 
 private:
+    void scheduleReload();
+
     GridHelper::View* m_gridView;
     GridHelper::ProxyModel m_gridModel;
     ListHelper::ItemDelegate* m_gridDelegate;
+    bool m_isReloadScheduled = false;
 };
 
 } // namespace Mayo
@@ -10,24 +10,23 @@
 #include "../base/application_item_selection_model.h"
 #include "../base/document.h"
 #include "../base/settings.h"
+#include "../base/task_manager.h"
 #include "../gui/gui_application.h"
 #include "item_view_buttons.h"
 #include "theme.h"
 #include "widget_model_tree_builder.h"
+#include "widget_model_tree_item_model.h"
+#include "ui_widget_model_tree.h"
 
 #include <QtCore/QtDebug>
-#include <QtCore/QMetaType>
-#include <QtWidgets/QTreeWidget>
-#include <QtWidgets/QTreeWidgetItemIterator>
+#include <QtCore/QTimer>
+#include <QtWidgets/QTreeView>
 
 #include <gsl/util>
 #include <cassert>
 #include <memory>
 #include <unordered_map>
 
-Q_DECLARE_METATYPE(Mayo::DocumentPtr)
-Q_DECLARE_METATYPE(Mayo::DocumentTreeNode)
-
 namespace Mayo {
 namespace Internal {
 
@@ -40,104 +39,23 @@ static std::vector<WidgetModelTree::BuilderPtr>& arrayPrototypeBuilder()
     return vecPtrBuilder;
 }
 
-class TreeWidget : public QTreeWidget {
-public:
-    TreeWidget(QWidget* parent = nullptr)
-        : QTreeWidget(parent)
-    { }
-
-    QModelIndex indexFromItem(QTreeWidgetItem* item, int column = 0) const {
-        return QTreeWidget::indexFromItem(item, column);
-    }
-
-    QTreeWidgetItem* itemFromIndex(const QModelIndex& index) const {
-        return QTreeWidget::itemFromIndex(index);
-    }
-};
-
-} // namespace Internal
-} // namespace Mayo
-#include "ui_widget_model_tree.h"
-
-namespace Mayo {
-
-namespace Internal {
-
-enum TreeItemRole {
-    TreeItemTypeRole = Qt::UserRole + 1,
-    TreeItemDocumentRole,
-    TreeItemDocumentTreeNodeRole
-};
-
-enum TreeItemType {
-    TreeItemType_Unknown = 0,
-    TreeItemType_Document = 0x01,
-    TreeItemType_DocumentTreeNode = 0x02,
-    TreeItemType_DocumentEntity = 0x10 | TreeItemType_DocumentTreeNode
-};
-
-static TreeItemType treeItemType(const QTreeWidgetItem* treeItem)
-{
-    const QVariant varType = treeItem->data(0, TreeItemTypeRole);
-    return varType.isValid() ?
-                static_cast<Internal::TreeItemType>(varType.toInt()) :
-                Internal::TreeItemType_Unknown;
-}
-
-static DocumentPtr treeItemDocument(const QTreeWidgetItem* treeItem)
-{
-    //Expects(treeItemType(treeItem) == TreeItemType_Document);
-    const QVariant var = treeItem->data(0, TreeItemDocumentRole);
-    return var.isValid() ? var.value<DocumentPtr>() : DocumentPtr();
-}
-
-static DocumentTreeNode treeItemDocumentTreeNode(const QTreeWidgetItem* treeItem)
-{
-    //Expects(treeItemType(treeItem) & TreeItemType_DocumentTreeNode);
-    const QVariant var = treeItem->data(0, TreeItemDocumentTreeNodeRole);
-    return var.isValid() ? var.value<DocumentTreeNode>() : DocumentTreeNode::null();
-}
-
-static void setTreeItemDocument(QTreeWidgetItem* treeItem, const DocumentPtr& doc)
-{
-    treeItem->setData(0, TreeItemTypeRole, Internal::TreeItemType_Document);
-    treeItem->setData(0, TreeItemDocumentRole, QVariant::fromValue(doc));
-}
-
-static void setTreeItemDocumentTreeNode(QTreeWidgetItem* treeItem, const DocumentTreeNode& node)
-{
-    const TreeItemType treeItemType =
-            node.isEntity() ? TreeItemType_DocumentEntity : TreeItemType_DocumentTreeNode;
-    treeItem->setData(0, TreeItemTypeRole, treeItemType);
-    treeItem->setData(0, TreeItemDocumentTreeNodeRole, QVariant::fromValue(node));
-}
-
-static ApplicationItem toApplicationItem(const QTreeWidgetItem* treeItem)
-{
-    const TreeItemType type = Internal::treeItemType(treeItem);
-    if (type == TreeItemType_Document)
-        return ApplicationItem(Internal::treeItemDocument(treeItem));
-    else if (type & TreeItemType_DocumentTreeNode)
-        return ApplicationItem(Internal::treeItemDocumentTreeNode(treeItem));
-
-    return ApplicationItem();
-}
-
 } // namespace Internal
 
 WidgetModelTree::WidgetModelTree(QWidget* widget)
     : QWidget(widget),
-      m_ui(new Ui_WidgetModelTree)
+      m_ui(new Ui_WidgetModelTree),
+      m_itemModel(new WidgetModelTreeItemModel(this))
 {
     m_ui->setupUi(this);
-    m_ui->treeWidget_Model->setUniformRowHeights(true);
+    m_ui->treeView_Model->setModel(m_itemModel);
+    m_itemModel->setSelectionModel(m_ui->treeView_Model->selectionModel());
     for (const BuilderPtr& ptrBuilder : Internal::arrayPrototypeBuilder()) {
         m_vecBuilder.push_back(ptrBuilder->clone());
-        m_vecBuilder.back()->setTreeWidget(m_ui->treeWidget_Model);
+        m_vecBuilder.back()->setModelTreeWidget(this);
     }
 
     // Add action "Remove item from document"
-    auto modelTreeBtns = new ItemViewButtons(m_ui->treeWidget_Model, this);
+    auto modelTreeBtns = new ItemViewButtons(m_ui->treeView_Model, this);
     constexpr int idBtnRemove = 1;
     modelTreeBtns->addButton(
                 idBtnRemove,
@@ -145,8 +63,8 @@ WidgetModelTree::WidgetModelTree(QWidget* widget)
                 tr("Remove from document"));
     modelTreeBtns->setButtonDetection(
                 idBtnRemove,
-                Internal::TreeItemTypeRole,
-                QVariant(Internal::TreeItemType_DocumentEntity));
+                WidgetModelTreeItemModel::ItemTypeRole,
+                QVariant(WidgetModelTreeItemModel::ItemType_DocumentEntity));
     modelTreeBtns->setButtonDisplayColumn(idBtnRemove, 0);
     modelTreeBtns->setButtonDisplayModes(idBtnRemove, ItemViewButtons::DisplayOnDetection);
     modelTreeBtns->setButtonItemSide(idBtnRemove, ItemViewButtons::ItemRightSide);
@@ -157,13 +75,17 @@ WidgetModelTree::WidgetModelTree(QWidget* widget)
                 modelTreeBtns, &ItemViewButtons::buttonClicked,
                 this, [=](int btnId, const QModelIndex& index) {
         if (btnId == idBtnRemove && index.isValid()) {
-            const QTreeWidgetItem* treeItem = m_ui->treeWidget_Model->itemFromIndex(index);
-            const DocumentTreeNode entityNode = Internal::treeItemDocumentTreeNode(treeItem);
+            const DocumentTreeNode entityNode = m_itemModel->documentTreeNode(index);
             entityNode.document()->destroyEntity(entityNode.id());
         }
     });
 
-    this->connectTreeModelDataChanged(true);
+    QObject::connect(
+                m_ui->treeView_Model, &QTreeView::expanded,
+                this, &WidgetModelTree::onTreeViewItemExpanded);
+    QObject::connect(
+                m_ui->lineEdit_Search, &QLineEdit::textChanged,
+                this, &WidgetModelTree::onSearchTextChanged);
 }
 
 WidgetModelTree::~WidgetModelTree()
@@ -174,25 +96,37 @@ WidgetModelTree::~WidgetModelTree()
 void WidgetModelTree::refreshItemText(const ApplicationItem& appItem)
 {
     if (appItem.isDocument()) {
-        const DocumentPtr doc = appItem.document();
-        QTreeWidgetItem* treeItem = this->findTreeItem(doc);
-        if (treeItem)
-            this->findSupportBuilder(doc)->refreshTextTreeItem(doc, treeItem);
+        m_itemModel->invalidateText(m_itemModel->indexOf(appItem.document()));
     }
     else if (appItem.isDocumentTreeNode()) {
+        // Text of other nodes may depend on this one(eg instances of the same product), so all
+        // rows of the document are invalidated. Only the displayed ones will be computed again
         const DocumentTreeNode& node = appItem.documentTreeNode();
-        QTreeWidgetItem* treeItemDocItem = this->findTreeItem(node);
-        if (treeItemDocItem)
-            this->findSupportBuilder(node)->refreshTextTreeItem(node, treeItemDocItem);
+        this->findSupportBuilder(node)->invalidateText(node);
+        m_itemModel->invalidateText(node.document());
+    }
+}
+
+void WidgetModelTree::refreshAllItemsText()
+{
+    for (int row = 0; row < m_itemModel->rowCount(); ++row) {
+        const ApplicationItem appItem = m_itemModel->applicationItem(m_itemModel->index(row, 0));
+        m_itemModel->invalidateText(appItem.document());
     }
 }
 
+int WidgetModelTree::itemCount(const DocumentPtr& doc) const
+{
+    return m_itemModel->itemCount(doc);
+}
+
 void WidgetModelTree::registerGuiApplication(GuiApplication* guiApp)
 {
     if (m_guiApp == guiApp)
         return;
 
     m_guiApp = guiApp;
+    m_itemModel->setGuiApplication(guiApp);
     for (const BuilderPtr& builder : m_vecBuilder)
         builder->registerGuiApplication(guiApp);
 
@@ -225,7 +159,7 @@ void WidgetModelTree::registerGuiApplication(GuiApplication* guiApp)
                 m_guiApp->selectionModel(), &ApplicationItemSelectionModel::changed,
                 this, &WidgetModelTree::onApplicationItemSelectionModelChanged);
 
-    this->connectTreeWidgetDocumentSelectionChanged(true);
+    this->connectTreeViewDocumentSelectionChanged(true);
 }
 
 WidgetModelTree_UserActions WidgetModelTree::createUserActions(QObject* parent)
@@ -253,81 +187,21 @@ void WidgetModelTree::addPrototypeBuilder(BuilderPtr builder)
     Internal::arrayPrototypeBuilder().push_back(std::move(builder));
 }
 
-DocumentTreeNode WidgetModelTree::documentTreeNode(const QTreeWidgetItem* treeItem)
-{
-    return Internal::treeItemDocumentTreeNode(treeItem);
-}
-
-void WidgetModelTree::setDocumentTreeNode(QTreeWidgetItem* treeItem, const DocumentTreeNode& node)
-{
-    Internal::setTreeItemDocumentTreeNode(treeItem, node);
-}
-
-void WidgetModelTree::setDocument(QTreeWidgetItem* treeItem, const DocumentPtr& doc)
-{
-    Internal::setTreeItemDocument(treeItem, doc);
-}
-
-bool WidgetModelTree::holdsDocument(const QTreeWidgetItem* treeItem)
-{
-    return Internal::treeItemType(treeItem) == Internal::TreeItemType_Document;
-}
-
-bool WidgetModelTree::holdsDocumentTreeNode(const QTreeWidgetItem* treeItem)
-{
-    return Internal::treeItemType(treeItem) & Internal::TreeItemType_DocumentTreeNode;
-}
-
 void WidgetModelTree::onDocumentAdded(const DocumentPtr& doc)
 {
-    auto treeItem = this->findSupportBuilder(doc)->createTreeItem(doc);
-    Internal::setTreeItemDocument(treeItem, doc);
-    Q_ASSERT(Internal::treeItemDocument(treeItem) == doc);
-    m_ui->treeWidget_Model->addTopLevelItem(treeItem);
+    m_itemModel->appendDocument(doc, this->findSupportBuilder(doc));
 }
 
 void WidgetModelTree::onDocumentAboutToClose(const DocumentPtr& doc)
 {
-    delete this->findTreeItem(doc);
+    m_itemModel->removeDocument(doc);
+    for (const BuilderPtr& builder : m_vecBuilder)
+        builder->invalidateText(doc);
 }
 
 void WidgetModelTree::onDocumentNameChanged(const DocumentPtr& doc, const QString& /*name*/)
 {
-    QTreeWidgetItem* treeItem = this->findTreeItem(doc);
-    if (treeItem)
-        this->findSupportBuilder(doc)->refreshTextTreeItem(doc, treeItem);
-}
-
-QTreeWidgetItem* WidgetModelTree::loadDocumentEntity(const DocumentTreeNode& node)
-{
-    Expects(node.isEntity());
-    auto treeItem = this->findSupportBuilder(node)->createTreeItem(node);
-    Internal::setTreeItemDocumentTreeNode(treeItem, node);
-    return treeItem;
-}
-
-QTreeWidgetItem* WidgetModelTree::findTreeItem(const DocumentPtr& doc) const
-{
-    for (int i = 0; i < m_ui->treeWidget_Model->topLevelItemCount(); ++i) {
-        QTreeWidgetItem* treeItem = m_ui->treeWidget_Model->topLevelItem(i);
-        if (Internal::treeItemDocument(treeItem) == doc)
-            return treeItem;
-    }
-
-    return nullptr;
-}
-
-QTreeWidgetItem* WidgetModelTree::findTreeItem(const DocumentTreeNode& node) const
-{
-    QTreeWidgetItem* treeItemDoc = this->findTreeItem(node.document());
-    if (treeItemDoc) {
-        for (QTreeWidgetItemIterator it(treeItemDoc); *it; ++it) {
-            if (Internal::treeItemDocumentTreeNode(*it) == node)
-                return *it;
-        }
-    }
-
-    return nullptr;
+    m_itemModel->invalidateText(m_itemModel->indexOf(doc));
 }
 
 WidgetModelTreeBuilder* WidgetModelTree::findSupportBuilder(const DocumentPtr& doc) const
@@ -351,29 +225,18 @@ WidgetModelTreeBuilder* WidgetModelTree::findSupportBuilder(const DocumentTreeNo
 
 void WidgetModelTree::onDocumentEntityAdded(const DocumentPtr& doc, TreeNodeId entityId)
 {
-    QTreeWidgetItem* treeDocEntity = this->loadDocumentEntity({ doc, entityId });
-    QTreeWidgetItem* treeDoc = this->findTreeItem(doc);
-    if (treeDoc) {
-        treeDoc->addChild(treeDocEntity);
-        treeDoc->setExpanded(true);
-    }
+    const DocumentTreeNode entityNode(doc, entityId);
+    m_itemModel->appendEntity(entityNode, this->findSupportBuilder(entityNode));
+    m_ui->treeView_Model->expand(m_itemModel->indexOf(doc));
+    this->scheduleSearchIndexUpdate(doc);
 }
 
 void WidgetModelTree::onDocumentEntityAboutToBeDestroyed(const DocumentPtr& doc, TreeNodeId entityId)
 {
-    QTreeWidgetItem* treeItem = this->findTreeItem({ doc, entityId });
-    delete treeItem;
+    m_itemModel->removeEntity({ doc, entityId });
 }
 
-//void WidgetModelTree::onDocumentItemPropertyChanged(
-//        DocumentItem* docItem, Property* prop)
-//{
-//    QTreeWidgetItem* treeItem = this->findTreeItem(docItem);
-//    if (treeItem && prop == &docItem->propertyLabel)
-//        this->findSupportBuilder(docItem)->refreshTextTreeItem(docItem, treeItem);
-//}
-
-void WidgetModelTree::onTreeWidgetDocumentSelectionChanged(
+void WidgetModelTree::onTreeViewDocumentSelectionChanged(
         const QItemSelection& selected, const QItemSelection& deselected)
 {
     const QModelIndexList listSelectedIndex = selected.indexes();
@@ -382,116 +245,133 @@ void WidgetModelTree::onTreeWidgetDocumentSelectionChanged(
     std::vector<ApplicationItem> vecDeselected;
     vecSelected.reserve(listSelectedIndex.size());
     vecDeselected.reserve(listDeselectedIndex.size());
-    for (const QModelIndex& index : listSelectedIndex) {
-        const QTreeWidgetItem* treeItem = m_ui->treeWidget_Model->itemFromIndex(index);
-        vecSelected.push_back(Internal::toApplicationItem(treeItem));
-    }
+    for (const QModelIndex& index : listSelectedIndex)
+        vecSelected.push_back(m_itemModel->applicationItem(index));
 
-    for (const QModelIndex& index : listDeselectedIndex) {
-        const QTreeWidgetItem* treeItem = m_ui->treeWidget_Model->itemFromIndex(index);
-        vecDeselected.push_back(Internal::toApplicationItem(treeItem));
-    }
+    for (const QModelIndex& index : listDeselectedIndex)
+        vecDeselected.push_back(m_itemModel->applicationItem(index));
 
     m_guiApp->selectionModel()->add(vecSelected);
     m_guiApp->selectionModel()->remove(vecDeselected);
 }
 
-void WidgetModelTree::onApplicationItemSelectionModelChanged(
-        Span<const ApplicationItem> selected, Span<const ApplicationItem> deselected)
+void WidgetModelTree::onTreeViewItemExpanded(const QModelIndex& index)
 {
-    this->connectTreeWidgetDocumentSelectionChanged(false);
-    auto _ = gsl::finally([=] { this->connectTreeWidgetDocumentSelectionChanged(true); });
-
-    auto fnSetSelected = [=](Span<const ApplicationItem> spanAppItem, bool on) {
-        for (const ApplicationItem& appItem : spanAppItem) {
-            if (!appItem.isDocumentTreeNode())
-                continue;
-
-            QTreeWidgetItem* treeItem = this->findTreeItem(appItem.documentTreeNode());
-            if (!treeItem)
-                continue;
+    const DocumentTreeNode node = m_itemModel->documentTreeNode(index);
+    if (!node.isValid())
+        return;
 
-            treeItem->setSelected(on);
-            if (on)
-                m_ui->treeWidget_Model->scrollToItem(treeItem);
-        }
-    };
+    const DocumentPtr doc = node.document();
+    if (!doc->hasDeferredShapes())
+        return;
 
-    fnSetSelected(selected, true);
-    fnSetSelected(deselected, false);
+    // Load the shapes of the direct child parts, sub-assemblies are loaded when expanded
+    const Tree<TDF_Label>& modelTree = doc->modelTree();
+    for (TreeNodeId childId = modelTree.nodeChildFirst(node.id());
+         childId != 0;
+         childId = modelTree.nodeSiblingNext(childId))
+    {
+        const TDF_Label childLabel = modelTree.nodeData(childId);
+        const TDF_Label childProduct =
+                XCaf::isShapeReference(childLabel) ? XCaf::shapeReferred(childLabel) : childLabel;
+        if (!XCaf::isShapeAssembly(childProduct))
+            doc->loadDeferredShapes(childId);
+    }
 }
 
-void WidgetModelTree::connectTreeModelDataChanged(bool on)
+void WidgetModelTree::onApplicationItemSelectionModelChanged(
+        Span<const ApplicationItem> selected, Span<const ApplicationItem> deselected)
 {
-    if (on) {
-        m_connTreeModelDataChanged = QObject::connect(
-                    m_ui->treeWidget_Model->model(), &QAbstractItemModel::dataChanged,
-                    this, &WidgetModelTree::onTreeModelDataChanged, Qt::UniqueConnection);
+    this->connectTreeViewDocumentSelectionChanged(false);
+    auto _ = gsl::finally([=] { this->connectTreeViewDocumentSelectionChanged(true); });
+
+    // Rows are (de)selected in one go, so selecting thousands of nodes(eg search results)
+    // doesn't emit as many QItemSelectionModel signals
+    QItemSelection itemsDeselected;
+    for (const ApplicationItem& appItem : deselected) {
+        if (appItem.isDocumentTreeNode()) {
+            const QModelIndex index = m_itemModel->indexOf(appItem.documentTreeNode());
+            if (index.isValid())
+                itemsDeselected.select(index, index);
+        }
     }
-    else {
-        QObject::disconnect(m_connTreeModelDataChanged);
+
+    // Rows of selected nodes might not exist yet, they are created along with their ancestors
+    QItemSelection itemsSelected;
+    for (const ApplicationItem& appItem : selected) {
+        if (appItem.isDocumentTreeNode()) {
+            const QModelIndex index = m_itemModel->indexOf(appItem.documentTreeNode(), true);
+            if (index.isValid())
+                itemsSelected.select(index, index);
+        }
+    }
+
+    QItemSelectionModel* selectionModel = m_ui->treeView_Model->selectionModel();
+    if (!itemsDeselected.isEmpty())
+        selectionModel->select(itemsDeselected, QItemSelectionModel::Deselect);
+
+    if (!itemsSelected.isEmpty()) {
+        selectionModel->select(itemsSelected, QItemSelectionModel::Select);
+        m_ui->treeView_Model->scrollTo(itemsSelected.first().topLeft());
     }
 }
 
-void WidgetModelTree::connectTreeWidgetDocumentSelectionChanged(bool on)
+void WidgetModelTree::connectTreeViewDocumentSelectionChanged(bool on)
 {
     if (on) {
-        m_connTreeWidgetDocumentSelectionChanged = QObject::connect(
-                    m_ui->treeWidget_Model->selectionModel(), &QItemSelectionModel::selectionChanged,
-                    this, &WidgetModelTree::onTreeWidgetDocumentSelectionChanged,
+        m_connTreeViewDocumentSelectionChanged = QObject::connect(
+                    m_ui->treeView_Model->selectionModel(), &QItemSelectionModel::selectionChanged,
+                    this, &WidgetModelTree::onTreeViewDocumentSelectionChanged,
                     Qt::UniqueConnection);
     }
     else {
-        QObject::disconnect(m_connTreeWidgetDocumentSelectionChanged);
+        QObject::disconnect(m_connTreeViewDocumentSelectionChanged);
     }
 }
 
-void WidgetModelTree::onTreeModelDataChanged(
-        const QModelIndex& topLeft, const QModelIndex& bottomRight, const QVector<int>& roles)
+void WidgetModelTree::onNodesVisibilityChanged(
+        const GuiDocument* guiDoc, const std::unordered_map<TreeNodeId, Qt::CheckState>& mapNodeId)
 {
-    if (roles.contains(Qt::CheckStateRole) && topLeft == bottomRight) {
-        const QModelIndex& indexItem = topLeft;
-        const auto itemCheckState = Qt::CheckState(indexItem.data(Qt::CheckStateRole).toInt());
-        if (itemCheckState == Qt::PartiallyChecked)
-            return;
-
-        const QVariant var = indexItem.data(Internal::TreeItemDocumentTreeNodeRole);
-        auto treeNode = var.isValid() ? var.value<DocumentTreeNode>() : DocumentTreeNode::null();
-        if (!treeNode.isValid())
-            return;
-
-        GuiDocument* guiDoc = m_guiApp->findGuiDocument(treeNode.document());
-        if (!guiDoc)
-            return;
-
-        guiDoc->setNodeVisible(treeNode.id(), itemCheckState == Qt::Checked ? true : false);
-        guiDoc->graphicsScene()->redraw();
+    // Check states are provided by GuiDocument, only rows already created need an update
+    std::vector<TreeNodeId> vecNodeId;
+    vecNodeId.reserve(mapNodeId.size());
+    for (const auto& [nodeId, state] : mapNodeId)
+        vecNodeId.push_back(nodeId);
+
+    m_itemModel->notifyCheckStateChanged(guiDoc->document(), vecNodeId);
+}
+
+void WidgetModelTree::onSearchTextChanged(const QString& text)
+{
+    std::vector<ApplicationItem> vecItem;
+    auto app = m_guiApp->application();
+    for (int i = 0; i < app->documentCount(); ++i) {
+        const DocumentPtr doc = app->findDocumentByIndex(i);
+        for (TreeNodeId nodeId : doc->searchIndex().find(text))
+            vecItem.push_back(DocumentTreeNode(doc, nodeId));
     }
+
+    // Search results replace the current selection, through the batched path of the selection model
+    ApplicationItemSelectionModel* selectionModel = m_guiApp->selectionModel();
+    selectionModel->clear();
+    if (!vecItem.empty())
+        selectionModel->add(vecItem);
 }
 
-void WidgetModelTree::onNodesVisibilityChanged(
-        const GuiDocument* guiDoc, const std::unordered_map<TreeNodeId, Qt::CheckState>& mapNodeId)
+void WidgetModelTree::scheduleSearchIndexUpdate(const DocumentPtr& doc)
 {
-    QTreeWidgetItem* treeItemDoc = this->findTreeItem(guiDoc->document());
-    if (!treeItemDoc)
+    if (!m_setDocumentIndexPending.insert(doc->identifier()).second)
         return;
 
-    this->connectTreeModelDataChanged(false);
-    auto _ = gsl::finally([=]{ this->connectTreeModelDataChanged(true); });
-
-    auto localMapNodeId = mapNodeId;
-    for (QTreeWidgetItemIterator it(treeItemDoc); *it; ++it) {
-        QTreeWidgetItem* treeItem = *it;
-        const DocumentTreeNode docTreeNode = Internal::treeItemDocumentTreeNode(treeItem);
-        auto itNodeVisibleState = localMapNodeId.find(docTreeNode.id());
-        if (itNodeVisibleState != localMapNodeId.cend()) {
-            treeItem->setCheckState(0, itNodeVisibleState->second);
-            localMapNodeId.erase(itNodeVisibleState);
-        }
-
-        if (localMapNodeId.empty())
-            return;
-    }
+    QTimer::singleShot(500, this, [=]{
+        m_setDocumentIndexPending.erase(doc->identifier());
+        auto taskMgr = TaskManager::globalInstance();
+        const TaskId taskId = taskMgr->newTask([=](TaskProgress* progress) {
+            doc->searchIndex().update(progress);
+        });
+        taskMgr->setTitle(taskId, tr("Index names of '%1'").arg(doc->name()));
+        taskMgr->run(taskId);
+    });
 }
 
 } // namespace Mayo
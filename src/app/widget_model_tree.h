@@ -13,15 +13,15 @@
 #include <QtWidgets/QWidget>
 #include <functional>
 class QItemSelection;
-class QTreeWidget;
-class QTreeWidgetItem;
 
 #include <memory>
+#include <unordered_set>
 
 namespace Mayo {
 
 class GuiApplication;
 class WidgetModelTreeBuilder;
+class WidgetModelTreeItemModel;
 
 struct WidgetModelTree_UserActions {
     using FunctionSyncItems = std::function<void()>;
@@ -39,6 +39,10 @@ public:
     ~WidgetModelTree();
 
     void refreshItemText(const ApplicationItem& appItem);
+    void refreshAllItemsText();
+
+    // Count of tree items created for document 'doc'
+    int itemCount(const DocumentPtr& doc) const;
 
     void registerGuiApplication(GuiApplication* guiApp);
 
@@ -47,13 +51,6 @@ public:
     // For builders
     static void addPrototypeBuilder(BuilderPtr builder);
 
-    static DocumentTreeNode documentTreeNode(const QTreeWidgetItem* treeItem);
-    static void setDocumentTreeNode(QTreeWidgetItem* treeItem, const DocumentTreeNode& node);
-    static void setDocument(QTreeWidgetItem* treeItem, const DocumentPtr& doc);
-
-    static bool holdsDocument(const QTreeWidgetItem* treeItem);
-    static bool holdsDocumentTreeNode(const QTreeWidgetItem* treeItem);
-
 private:
     void onDocumentAdded(const DocumentPtr& doc);
     void onDocumentAboutToClose(const DocumentPtr& doc);
@@ -61,33 +58,32 @@ private:
     void onDocumentEntityAdded(const DocumentPtr& doc, TreeNodeId entityId);
     void onDocumentEntityAboutToBeDestroyed(const DocumentPtr& doc, TreeNodeId entityId);
 
-    void onTreeWidgetDocumentSelectionChanged(
+    void onTreeViewDocumentSelectionChanged(
             const QItemSelection& selected, const QItemSelection& deselected);
+    void onTreeViewItemExpanded(const QModelIndex& index);
     void onApplicationItemSelectionModelChanged(
             Span<const ApplicationItem> selected, Span<const ApplicationItem> deselected);
 
-    void connectTreeModelDataChanged(bool on);
-    void connectTreeWidgetDocumentSelectionChanged(bool on);
+    void connectTreeViewDocumentSelectionChanged(bool on);
 
-    void onTreeModelDataChanged(
-            const QModelIndex& topLeft, const QModelIndex& bottomRight, const QVector<int>& roles);
     void onNodesVisibilityChanged(
             const GuiDocument* guiDoc, const std::unordered_map<TreeNodeId, Qt::CheckState>& mapNodeId);
 
-    QTreeWidgetItem* loadDocumentEntity(const DocumentTreeNode& entityNode);
-
-    QTreeWidgetItem* findTreeItem(const DocumentPtr& doc) const;
-    QTreeWidgetItem* findTreeItem(const DocumentTreeNode& node) const;
+    // Selects the nodes of all documents matching 'text', see DocumentSearchIndex::find()
+    void onSearchTextChanged(const QString& text);
+    // Runs a background task updating the search index of 'doc', once a burst of added entities
+    // is over(eg import of many files)
+    void scheduleSearchIndexUpdate(const DocumentPtr& doc);
 
     WidgetModelTreeBuilder* findSupportBuilder(const DocumentPtr& doc) const;
     WidgetModelTreeBuilder* findSupportBuilder(const DocumentTreeNode& entityNode) const;
 
     class Ui_WidgetModelTree* m_ui = nullptr;
     GuiApplication* m_guiApp = nullptr;
+    WidgetModelTreeItemModel* m_itemModel = nullptr;
     std::vector<BuilderPtr> m_vecBuilder;
-    QString m_refItemTextTemplate;
-    QMetaObject::Connection m_connTreeModelDataChanged;
-    QMetaObject::Connection m_connTreeWidgetDocumentSelectionChanged;
+    QMetaObject::Connection m_connTreeViewDocumentSelectionChanged;
+    std::unordered_set<Document::Identifier> m_setDocumentIndexPending;
 };
 
 } // namespace Mayo
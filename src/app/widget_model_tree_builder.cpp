@@ -13,41 +13,50 @@
 #include "widget_model_tree.h"
 #include "theme.h"
 
-#include <QtWidgets/QTreeWidget>
-#include <QtWidgets/QTreeWidgetItem>
-
 namespace Mayo {
 
 WidgetModelTreeBuilder::~WidgetModelTreeBuilder()
 {
 }
 
-void WidgetModelTreeBuilder::refreshTextTreeItem(const DocumentPtr& doc, QTreeWidgetItem* treeItem)
+QString WidgetModelTreeBuilder::text(const DocumentPtr& doc) const
+{
+    return WidgetModelTreeBuilder::labelText(doc->name());
+}
+
+QIcon WidgetModelTreeBuilder::icon(const DocumentPtr& /*doc*/) const
+{
+    return mayoTheme()->icon(Theme::Icon::File);
+}
+
+QString WidgetModelTreeBuilder::toolTip(const DocumentPtr& doc) const
+{
+    return filepathTo<QString>(doc->filePath());
+}
+
+QString WidgetModelTreeBuilder::text(const DocumentTreeNode& node) const
+{
+    return WidgetModelTreeBuilder::labelText(node.document()->labelNameCache().labelName(node.label()));
+}
+
+QIcon WidgetModelTreeBuilder::icon(const DocumentTreeNode& /*node*/) const
 {
-    treeItem->setText(0, WidgetModelTreeBuilder::labelText(doc->name()));
+    return QIcon();
 }
 
-void WidgetModelTreeBuilder::refreshTextTreeItem(const DocumentTreeNode& node, QTreeWidgetItem* treeItem)
+bool WidgetModelTreeBuilder::isCheckable(const DocumentTreeNode& /*node*/) const
 {
-    treeItem->setText(0, WidgetModelTreeBuilder::labelText(node.label()));
+    return true;
 }
 
-QTreeWidgetItem* WidgetModelTreeBuilder::createTreeItem(const DocumentPtr& doc)
+bool WidgetModelTreeBuilder::hasChildNodes(const DocumentTreeNode& /*node*/) const
 {
-    auto treeItem = new QTreeWidgetItem;
-    treeItem->setText(0, WidgetModelTreeBuilder::labelText(doc->name()));
-    treeItem->setIcon(0, mayoTheme()->icon(Theme::Icon::File));
-    treeItem->setToolTip(0, filepathTo<QString>(doc->filePath()));
-    return treeItem;
+    return false;
 }
 
-QTreeWidgetItem* WidgetModelTreeBuilder::createTreeItem(const DocumentTreeNode& node)
+void WidgetModelTreeBuilder::visitChildNodes(
+        const DocumentTreeNode& /*node*/, const std::function<void(TreeNodeId)>& /*fnVisit*/) const
 {
-    auto treeItem = new QTreeWidgetItem;
-    treeItem->setText(0, WidgetModelTreeBuilder::labelText(node.label()));
-    treeItem->setFlags(treeItem->flags() | Qt::ItemIsUserCheckable);
-    treeItem->setCheckState(0, Qt::Checked);
-    return treeItem;
 }
 
 std::unique_ptr<WidgetModelTreeBuilder> WidgetModelTreeBuilder::clone() const
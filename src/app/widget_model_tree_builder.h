@@ -10,16 +10,18 @@
 #include "../base/document_tree_node.h"
 #include "../base/property_builtins.h"
 #include "widget_model_tree.h"
+#include <functional>
 #include <vector>
 #include <QtCore/QString>
+#include <QtGui/QIcon>
 class QAction;
 class QObject;
-class QTreeWidget;
-class QTreeWidgetItem;
 
 namespace Mayo {
 
 // TODO Rename Builder -> Extension ?
+// Provides the data of the WidgetModelTree items, queried on demand by the underlying item model
+// only for the rows actually displayed
 class WidgetModelTreeBuilder {
 public:
     virtual ~WidgetModelTreeBuilder();
@@ -27,14 +29,26 @@ public:
     virtual bool supportsDocument(const DocumentPtr&) const { return true; }
     virtual bool supportsDocumentTreeNode(const DocumentTreeNode&) const { return true; }
 
-    virtual void refreshTextTreeItem(const DocumentPtr& doc, QTreeWidgetItem* treeItem);
-    virtual void refreshTextTreeItem(const DocumentTreeNode& node, QTreeWidgetItem* treeItem);
+    virtual QString text(const DocumentPtr& doc) const;
+    virtual QIcon icon(const DocumentPtr& doc) const;
+    virtual QString toolTip(const DocumentPtr& doc) const;
 
-    virtual QTreeWidgetItem* createTreeItem(const DocumentPtr& doc);
-    virtual QTreeWidgetItem* createTreeItem(const DocumentTreeNode& node);
+    virtual QString text(const DocumentTreeNode& node) const;
+    virtual QIcon icon(const DocumentTreeNode& node) const;
+    virtual bool isCheckable(const DocumentTreeNode& node) const;
 
-    QTreeWidget* treeWidget() const { return m_treeWidget; }
-    void setTreeWidget(QTreeWidget* tree) { m_treeWidget = tree; }
+    // Texts possibly cached by the builder are obsolete, eg after name attribute of 'node' changed
+    virtual void invalidateText(const DocumentTreeNode& /*node*/) {}
+    virtual void invalidateText(const DocumentPtr& /*doc*/) {}
+
+    // Child nodes of 'node' to be displayed in the tree, their rows are created only when 'node' is
+    // expanded. Default implementation shows no child nodes
+    virtual bool hasChildNodes(const DocumentTreeNode& node) const;
+    virtual void visitChildNodes(
+            const DocumentTreeNode& node, const std::function<void(TreeNodeId)>& fnVisit) const;
+
+    WidgetModelTree* modelTreeWidget() const { return m_modelTreeWidget; }
+    void setModelTreeWidget(WidgetModelTree* widget) { m_modelTreeWidget = widget; }
 
     virtual void registerGuiApplication(GuiApplication* /*guiApp*/) {}
 
@@ -48,7 +62,7 @@ protected:
     static QString labelText(const TDF_Label& label);
 
 private:
-    QTreeWidget* m_treeWidget = nullptr;
+    WidgetModelTree* m_modelTreeWidget = nullptr;
 };
 
 } // namespace Mayo
@@ -6,26 +6,23 @@
 
 #include "widget_model_tree_builder_mesh.h"
 #include "../base/caf_utils.h"
+#include "../base/point_cloud.h"
 #include "theme.h"
 #include "widget_model_tree.h"
 
-#include <QtWidgets/QTreeWidgetItem>
 #include <TDataXtd_Triangulation.hxx>
 
 namespace Mayo {
 
 bool WidgetModelTreeBuilder_Mesh::supportsDocumentTreeNode(const DocumentTreeNode& node) const
 {
-    return CafUtils::hasAttribute<TDataXtd_Triangulation>(node.label());
+    return CafUtils::hasAttribute<TDataXtd_Triangulation>(node.label())
+            || CafUtils::hasAttribute<PointCloudAttribute>(node.label());
 }
 
-QTreeWidgetItem* WidgetModelTreeBuilder_Mesh::createTreeItem(const DocumentTreeNode& node)
+QIcon WidgetModelTreeBuilder_Mesh::icon(const DocumentTreeNode& /*node*/) const
 {
-    Expects(this->supportsDocumentTreeNode(node));
-
-    auto treeItem = WidgetModelTreeBuilder::createTreeItem(node);
-    treeItem->setIcon(0, mayoTheme()->icon(Theme::Icon::ItemMesh));
-    return treeItem;
+    return mayoTheme()->icon(Theme::Icon::ItemMesh);
 }
 
 std::unique_ptr<WidgetModelTreeBuilder> WidgetModelTreeBuilder_Mesh::clone() const
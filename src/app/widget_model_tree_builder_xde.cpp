@@ -14,11 +14,6 @@
 #include "widget_model_tree.h"
 
 #include <QtWidgets/QActionGroup>
-#include <QtWidgets/QTreeWidget>
-#include <QtWidgets/QTreeWidgetItemIterator>
-
-#include <unordered_map>
-#include <unordered_set>
 
 namespace Mayo {
 
@@ -81,34 +76,35 @@ bool WidgetModelTreeBuilder_Xde::supportsDocumentTreeNode(const DocumentTreeNode
     return XCaf::isShape(node.label());
 }
 
-void WidgetModelTreeBuilder_Xde::refreshTextTreeItem(
-        const DocumentTreeNode& node, QTreeWidgetItem* treeItem)
+QString WidgetModelTreeBuilder_Xde::text(const DocumentTreeNode& node) const
 {
-    const TDF_Label labelNode = node.label();
-    TDF_LabelSequence seqLabelRefresh;
-    if (XCaf::isShapeReference(labelNode)
-            && m_module->instanceNameTemplate().contains("%product"))
-    {
-        XCAFDoc_ShapeTool::GetUsers(
-                    XCaf::shapeReferred(labelNode),
-                    seqLabelRefresh,
-                    false /* don't get sub children */);
-    }
-    else {
-        seqLabelRefresh.Append(labelNode);
-    }
+    const TDF_Label label = node.label();
+    const auto attrs = node.document()->labelAttributesCache().attributes(label);
+    if (attrs->isReference)
+        return this->referenceItemText(node.document(), label, attrs->labelReferred);
+    else
+        return node.document()->labelNameCache().labelName(label);
+}
 
-    for (const TDF_Label& labelRefresh : seqLabelRefresh) {
-        QTreeWidgetItem* treeItemLabel = this->findTreeItem(treeItem, labelRefresh);
-        if (treeItemLabel)
-            this->refreshXdeAssemblyNodeItemText(treeItemLabel);
-    }
+QIcon WidgetModelTreeBuilder_Xde::icon(const DocumentTreeNode& node) const
+{
+    return Module::shapeIcon(node.document()->modelTree().nodeData(this->contentNodeId(node)));
+}
+
+bool WidgetModelTreeBuilder_Xde::isCheckable(const DocumentTreeNode& /*node*/) const
+{
+    return m_isMergeXdeReferredShapeOn;
 }
 
-QTreeWidgetItem* WidgetModelTreeBuilder_Xde::createTreeItem(const DocumentTreeNode& node)
+bool WidgetModelTreeBuilder_Xde::hasChildNodes(const DocumentTreeNode& node) const
 {
-    Expects(this->supportsDocumentTreeNode(node));
-    return this->buildXdeTree(nullptr, node);
+    return !node.document()->modelTree().nodeIsLeaf(this->contentNodeId(node));
+}
+
+void WidgetModelTreeBuilder_Xde::visitChildNodes(
+        const DocumentTreeNode& node, const std::function<void(TreeNodeId)>& fnVisit) const
+{
+    visitDirectChildren(this->contentNodeId(node), node.document()->modelTree(), fnVisit);
 }
 
 // BEWARE Not thread-safe, should be called from main(GUI) thread
@@ -147,72 +143,6 @@ WidgetModelTree_UserActions WidgetModelTreeBuilder_Xde::createUserActions(QObjec
     return userActions;
 }
 
-QTreeWidgetItem* WidgetModelTreeBuilder_Xde::guiCreateXdeTreeNode(
-        QTreeWidgetItem* guiParentNode, const DocumentTreeNode& node)
-{
-    auto guiNode = new QTreeWidgetItem(guiParentNode);
-    const QString stdName = to_QString(CafUtils::labelAttrStdName(node.label()));
-    guiNode->setText(0, stdName);
-    WidgetModelTree::setDocumentTreeNode(guiNode, node);
-    const QIcon icon = Module::shapeIcon(node.label());
-    if (!icon.isNull())
-        guiNode->setIcon(0, icon);
-
-    return guiNode;
-}
-
-QTreeWidgetItem* WidgetModelTreeBuilder_Xde::buildXdeTree(
-        QTreeWidgetItem* treeItem, const DocumentTreeNode& node)
-{
-    Expects(node.isEntity());
-
-    std::unordered_map<TreeNodeId, QTreeWidgetItem*> mapNodeIdToTreeItem;
-    std::unordered_set<TreeNodeId> setReferenceNodeId;
-    const DocumentPtr doc = node.document();
-    const Tree<TDF_Label>& modelTree = doc->modelTree();
-    traverseTree(node.id(), modelTree, [&](TreeNodeId itNodeId) {
-        const TreeNodeId nodeParentId = modelTree.nodeParent(itNodeId);
-        auto itParentFound = mapNodeIdToTreeItem.find(nodeParentId);
-        QTreeWidgetItem* guiParentNode =
-                itParentFound != mapNodeIdToTreeItem.end() ? itParentFound->second : treeItem;
-        if (m_isMergeXdeReferredShapeOn) {
-            const TDF_Label& nodeLabel = modelTree.nodeData(itNodeId);
-            if (XCaf::isShapeReference(nodeLabel)) {
-                mapNodeIdToTreeItem[itNodeId] = guiParentNode;
-                setReferenceNodeId.insert(itNodeId);
-            }
-            else {
-                auto guiNode = new QTreeWidgetItem(guiParentNode);
-                QString guiNodeText = to_QString(CafUtils::labelAttrStdName(nodeLabel));
-                TreeNodeId guiNodeId = itNodeId;
-                if (setReferenceNodeId.find(nodeParentId) != setReferenceNodeId.cend()) {
-                    const TDF_Label& refLabel = modelTree.nodeData(nodeParentId);
-                    guiNodeText = this->referenceItemText(refLabel, nodeLabel);
-                    guiNodeId = nodeParentId;
-                    if (!guiParentNode)
-                        mapNodeIdToTreeItem[nodeParentId] = guiNode;
-                }
-
-                guiNode->setText(0, guiNodeText);
-                WidgetModelTree::setDocumentTreeNode(guiNode, DocumentTreeNode(doc, guiNodeId));
-                const QIcon icon = Module::shapeIcon(nodeLabel);
-                if (!icon.isNull())
-                    guiNode->setIcon(0, icon);
-
-                guiNode->setFlags(guiNode->flags() | Qt::ItemIsUserCheckable);
-                guiNode->setCheckState(0, Qt::Checked);
-                mapNodeIdToTreeItem[itNodeId] = guiNode;
-            }
-        }
-        else {
-            auto guiNode = ThisType::guiCreateXdeTreeNode(guiParentNode, { doc, itNodeId });
-            mapNodeIdToTreeItem[itNodeId] = guiNode;
-        }
-    });
-
-    return mapNodeIdToTreeItem.find(node.id())->second;
-}
-
 QByteArray WidgetModelTreeBuilder_Xde::instanceNameFormat() const
 {
     return m_module->instanceNameFormat.name();
@@ -224,10 +154,8 @@ void WidgetModelTreeBuilder_Xde::setInstanceNameFormat(const QByteArray& format)
         return;
 
     m_module->instanceNameFormat.setValueByName(format);
-    for (QTreeWidgetItemIterator it(this->treeWidget()); *it; ++it) {
-        if (WidgetModelTree::holdsDocumentTreeNode(*it))
-            this->refreshXdeAssemblyNodeItemText(*it);
-    }
+    if (this->modelTreeWidget())
+        this->modelTreeWidget()->refreshAllItemsText();
 }
 
 std::unique_ptr<WidgetModelTreeBuilder> WidgetModelTreeBuilder_Xde::clone() const
@@ -238,26 +166,24 @@ std::unique_ptr<WidgetModelTreeBuilder> WidgetModelTreeBuilder_Xde::clone() cons
     return builder;
 }
 
-void WidgetModelTreeBuilder_Xde::refreshXdeAssemblyNodeItemText(QTreeWidgetItem* item)
+TreeNodeId WidgetModelTreeBuilder_Xde::contentNodeId(const DocumentTreeNode& node) const
 {
-    const DocumentTreeNode docTreeNode = WidgetModelTree::documentTreeNode(item);
-    const TDF_Label label = docTreeNode.label();
-    if (XCaf::isShapeReference(label)) {
-        const TDF_Label& instanceLabel = label;
-        const TDF_Label productLabel = XCaf::shapeReferred(instanceLabel);
-        const QString itemText = this->referenceItemText(instanceLabel, productLabel);
-        item->setText(0, itemText);
-    }
-    else {
-        item->setText(0, to_QString(CafUtils::labelAttrStdName(label)));
+    // In model tree, a reference node has the referred product as single child node
+    if (m_isMergeXdeReferredShapeOn && node.document()->labelAttributesCache().attributes(node.label())->isReference) {
+        const TreeNodeId productNodeId = node.document()->modelTree().nodeChildFirst(node.id());
+        if (productNodeId != 0)
+            return productNodeId;
     }
+
+    return node.id();
 }
 
 QString WidgetModelTreeBuilder_Xde::referenceItemText(
-        const TDF_Label& instanceLabel, const TDF_Label& productLabel) const
+        const DocumentPtr& doc, const TDF_Label& instanceLabel, const TDF_Label& productLabel) const
 {
-    const QString instanceName = to_QString(CafUtils::labelAttrStdName(instanceLabel)).trimmed();
-    const QString productName = to_QString(CafUtils::labelAttrStdName(productLabel)).trimmed();
+    LabelNameCache& nameCache = doc->labelNameCache();
+    const QString instanceName = nameCache.labelName(instanceLabel).trimmed();
+    const QString productName = nameCache.labelName(productLabel).trimmed();
     const QByteArray strTemplate = Module::toInstanceNameTemplate(m_module->instanceNameFormat);
     QString itemText = QString::fromUtf8(strTemplate);
     itemText.replace("%instance", instanceName)
@@ -265,19 +191,4 @@ QString WidgetModelTreeBuilder_Xde::referenceItemText(
     return itemText;
 }
 
-QTreeWidgetItem* WidgetModelTreeBuilder_Xde::findTreeItem(
-        QTreeWidgetItem* parentTreeItem, const TDF_Label& label) const
-{
-    if (!parentTreeItem)
-        return nullptr;
-
-    for (QTreeWidgetItemIterator it(parentTreeItem); *it; ++it) {
-        const DocumentTreeNode node = WidgetModelTree::documentTreeNode(*it);
-        if (node.label() == label)
-            return *it;
-    }
-
-    return nullptr;
-}
-
 } // namespace Mayo
@@ -7,7 +7,7 @@
 #pragma once
 
 #include "widget_model_tree_builder.h"
-class TDF_Label;
+#include "../base/caf_utils.h"
 
 namespace Mayo {
 
@@ -15,8 +15,13 @@ class WidgetModelTreeBuilder_Xde : public WidgetModelTreeBuilder {
     MAYO_DECLARE_TEXT_ID_FUNCTIONS(Mayo::WidgetModelTreeBuilder_Xde)
 public:
     bool supportsDocumentTreeNode(const DocumentTreeNode& node) const override;
-    void refreshTextTreeItem(const DocumentTreeNode& node, QTreeWidgetItem* treeItem) override;
-    QTreeWidgetItem* createTreeItem(const DocumentTreeNode& node) override;
+
+    QString text(const DocumentTreeNode& node) const override;
+    QIcon icon(const DocumentTreeNode& node) const override;
+    bool isCheckable(const DocumentTreeNode& node) const override;
+    bool hasChildNodes(const DocumentTreeNode& node) const override;
+    void visitChildNodes(
+            const DocumentTreeNode& node, const std::function<void(TreeNodeId)>& fnVisit) const override;
 
     void registerGuiApplication(GuiApplication* guiApp) override;
     WidgetModelTree_UserActions createUserActions(QObject* parent) override;
@@ -26,15 +31,10 @@ public:
 private:
     class Module;
 
-    using ThisType = WidgetModelTreeBuilder_Xde;
-
-    static QTreeWidgetItem* guiCreateXdeTreeNode(
-            QTreeWidgetItem* guiParentNode, const DocumentTreeNode& node);
-
-    QTreeWidgetItem* buildXdeTree(QTreeWidgetItem* treeItem, const DocumentTreeNode& node);
-    void refreshXdeAssemblyNodeItemText(QTreeWidgetItem* item);
-    QString referenceItemText(const TDF_Label& instanceLabel, const TDF_Label& productLabel) const;
-    QTreeWidgetItem* findTreeItem(QTreeWidgetItem* parentTreeItem, const TDF_Label& label) const;
+    // Node whose children are displayed below 'node', ie the referred product when merging is on
+    TreeNodeId contentNodeId(const DocumentTreeNode& node) const;
+    QString referenceItemText(
+            const DocumentPtr& doc, const TDF_Label& instanceLabel, const TDF_Label& productLabel) const;
 
     QByteArray instanceNameFormat() const;
     void setInstanceNameFormat(const QByteArray& format);
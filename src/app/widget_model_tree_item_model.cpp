@@ -0,0 +1,531 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "widget_model_tree_item_model.h"
+
+#include "../base/document.h"
+#include "../gui/gui_application.h"
+#include "../gui/gui_document.h"
+#include "widget_model_tree_builder.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace Mayo {
+
+namespace {
+
+// Time spent at most inserting rows within an event loop iteration
+constexpr qint64 ItemModel_fetchTimeBudgetNs = 4 * 1000 * 1000;
+
+} // namespace
+
+WidgetModelTreeItemModel::WidgetModelTreeItemModel(QObject* parent)
+    : QAbstractItemModel(parent)
+{
+    m_root.isFetched = true;
+    m_timerTextRefresh.setSingleShot(true);
+    m_timerTextRefresh.setInterval(50);
+    QObject::connect(
+                &m_timerTextRefresh, &QTimer::timeout,
+                this, &WidgetModelTreeItemModel::onTextRefreshTimeout);
+    m_timerFetch.setSingleShot(true);
+    m_timerFetch.setInterval(0);
+    QObject::connect(
+                &m_timerFetch, &QTimer::timeout,
+                this, &WidgetModelTreeItemModel::onFetchTimeout);
+}
+
+WidgetModelTreeItemModel::~WidgetModelTreeItemModel()
+{
+}
+
+QModelIndex WidgetModelTreeItemModel::appendDocument(const DocumentPtr& doc, WidgetModelTreeBuilder* builder)
+{
+    const int row = int(m_root.children.size());
+    this->beginInsertRows(QModelIndex(), row, row);
+    auto item = std::make_unique<Item>();
+    item->parent = &m_root;
+    item->row = row;
+    item->document = doc;
+    item->builder = builder;
+    item->isFetched = true; // Entity rows are appended explicitly
+    m_root.children.push_back(std::move(item));
+    this->endInsertRows();
+    return this->index(row, 0);
+}
+
+void WidgetModelTreeItemModel::removeDocument(const DocumentPtr& doc)
+{
+    Item* docItem = this->findDocumentItem(doc);
+    if (docItem)
+        this->removeItem(docItem);
+}
+
+int WidgetModelTreeItemModel::itemCount(const DocumentPtr& doc) const
+{
+    const Item* docItem = this->findDocumentItem(doc);
+    return docItem ? 1 + int(docItem->mapNodeItem.size()) : 0;
+}
+
+void WidgetModelTreeItemModel::appendEntity(
+        const DocumentTreeNode& entityNode, WidgetModelTreeBuilder* builder)
+{
+    Item* docItem = this->findDocumentItem(entityNode.document());
+    if (!docItem)
+        return;
+
+    docItem->vecPendingRow.push_back({ entityNode.id(), builder, true });
+    this->scheduleFetch(docItem);
+}
+
+void WidgetModelTreeItemModel::removeEntity(const DocumentTreeNode& entityNode)
+{
+    Item* docItem = this->findDocumentItem(entityNode.document());
+    if (!docItem)
+        return;
+
+    auto itItem = docItem->mapNodeItem.find(entityNode.id());
+    if (itItem != docItem->mapNodeItem.end()) {
+        this->removeItem(itItem->second);
+    }
+    else {
+        auto& vecPendingRow = docItem->vecPendingRow;
+        auto itRow = std::find_if(
+                    vecPendingRow.begin() + docItem->pendingRowPos, vecPendingRow.end(),
+                    [&](const PendingRow& row) { return row.nodeId == entityNode.id(); });
+        if (itRow != vecPendingRow.end())
+            vecPendingRow.erase(itRow);
+    }
+}
+
+ApplicationItem WidgetModelTreeItemModel::applicationItem(const QModelIndex& index) const
+{
+    const Item* item = index.isValid() ? this->toItem(index) : nullptr;
+    if (!item)
+        return ApplicationItem();
+
+    if (item->nodeId == 0)
+        return ApplicationItem(item->document);
+    else
+        return ApplicationItem(WidgetModelTreeItemModel::toDocumentTreeNode(item));
+}
+
+DocumentTreeNode WidgetModelTreeItemModel::documentTreeNode(const QModelIndex& index) const
+{
+    const Item* item = index.isValid() ? this->toItem(index) : nullptr;
+    return item ? WidgetModelTreeItemModel::toDocumentTreeNode(item) : DocumentTreeNode::null();
+}
+
+QModelIndex WidgetModelTreeItemModel::indexOf(const DocumentPtr& doc) const
+{
+    const Item* docItem = this->findDocumentItem(doc);
+    return docItem ? this->toIndex(docItem) : QModelIndex();
+}
+
+QModelIndex WidgetModelTreeItemModel::indexOf(const DocumentTreeNode& node, bool fetch)
+{
+    Item* docItem = this->findDocumentItem(node.document());
+    if (!docItem)
+        return {};
+
+    auto itItem = docItem->mapNodeItem.find(node.id());
+    if (itItem != docItem->mapNodeItem.end())
+        return this->toIndex(itItem->second);
+
+    if (!fetch)
+        return {};
+
+    // Row of the owner entity might be pending
+    this->fetchChildren(docItem);
+
+    // Path from the owner entity down to 'node', ids without row(merged ones) are just skipped
+    Document* doc = node.document().get();
+    const Tree<TDF_Label>& modelTree = doc->modelTree();
+    std::vector<TreeNodeId> vecPathNodeId;
+    for (TreeNodeId id = node.id(); id != 0; id = modelTree.nodeParent(id)) {
+        vecPathNodeId.push_back(id);
+        if (doc->isEntity(id))
+            break;
+    }
+
+    Item* item = nullptr;
+    for (auto itNodeId = vecPathNodeId.crbegin(); itNodeId != vecPathNodeId.crend(); ++itNodeId) {
+        if (item)
+            this->fetchChildren(item);
+
+        itItem = docItem->mapNodeItem.find(*itNodeId);
+        if (itItem != docItem->mapNodeItem.end())
+            item = itItem->second;
+        else if (!item)
+            return {}; // Entity row not found
+    }
+
+    return item && item->nodeId == node.id() ? this->toIndex(item) : QModelIndex();
+}
+
+void WidgetModelTreeItemModel::invalidateText(const QModelIndex& index)
+{
+    const Item* item = index.isValid() ? this->toItem(index) : nullptr;
+    if (!item)
+        return;
+
+    item->isTextDirty = true;
+    m_vecTextRefreshIndex.push_back(index);
+    m_timerTextRefresh.start();
+}
+
+void WidgetModelTreeItemModel::invalidateText(const DocumentPtr& doc)
+{
+    const Item* docItem = this->findDocumentItem(doc);
+    if (!docItem)
+        return;
+
+    docItem->isTextDirty = true;
+    for (const auto& [nodeId, item] : docItem->mapNodeItem)
+        item->isTextDirty = true;
+
+    m_vecTextRefreshTreeIndex.push_back(this->toIndex(docItem));
+    m_timerTextRefresh.start();
+}
+
+void WidgetModelTreeItemModel::notifyCheckStateChanged(
+        const DocumentPtr& doc, Span<const TreeNodeId> spanNodeId)
+{
+    const Item* docItem = this->findDocumentItem(doc);
+    if (!docItem)
+        return;
+
+    for (TreeNodeId nodeId : spanNodeId) {
+        auto itItem = docItem->mapNodeItem.find(nodeId);
+        if (itItem != docItem->mapNodeItem.cend()) {
+            const QModelIndex index = this->toIndex(itItem->second);
+            emit this->dataChanged(index, index, { Qt::CheckStateRole });
+        }
+    }
+}
+
+QModelIndex WidgetModelTreeItemModel::index(int row, int column, const QModelIndex& parent) const
+{
+    const Item* parentItem = this->toItem(parent);
+    if (column != 0 || row < 0 || row >= int(parentItem->children.size()))
+        return {};
+
+    return this->createIndex(row, column, parentItem->children.at(row).get());
+}
+
+QModelIndex WidgetModelTreeItemModel::parent(const QModelIndex& index) const
+{
+    const Item* item = index.isValid() ? this->toItem(index) : nullptr;
+    if (!item || item->parent == &m_root)
+        return {};
+
+    return this->toIndex(item->parent);
+}
+
+int WidgetModelTreeItemModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.column() <= 0 ? int(this->toItem(parent)->children.size()) : 0;
+}
+
+int WidgetModelTreeItemModel::columnCount(const QModelIndex& /*parent*/) const
+{
+    return 1;
+}
+
+bool WidgetModelTreeItemModel::hasChildren(const QModelIndex& parent) const
+{
+    const Item* item = this->toItem(parent);
+    if (item->isFetched)
+        return !item->children.empty() || WidgetModelTreeItemModel::hasPendingRows(item);
+
+    return item->builder->hasChildNodes(WidgetModelTreeItemModel::toDocumentTreeNode(item));
+}
+
+bool WidgetModelTreeItemModel::canFetchMore(const QModelIndex& parent) const
+{
+    const Item* item = this->toItem(parent);
+    return !item->isFetched || WidgetModelTreeItemModel::hasPendingRows(item);
+}
+
+void WidgetModelTreeItemModel::fetchMore(const QModelIndex& parent)
+{
+    QElapsedTimer chronoBudget;
+    chronoBudget.start();
+    Item* item = this->toItem(parent);
+    if (!this->fetchChildren(item, &chronoBudget))
+        this->scheduleFetch(item);
+}
+
+QVariant WidgetModelTreeItemModel::data(const QModelIndex& index, int role) const
+{
+    const Item* item = index.isValid() ? this->toItem(index) : nullptr;
+    if (!item)
+        return {};
+
+    if (role == Qt::DisplayRole) {
+        if (item->isTextDirty) {
+            item->text =
+                    item->nodeId == 0 ?
+                        item->builder->text(item->document) :
+                        item->builder->text(WidgetModelTreeItemModel::toDocumentTreeNode(item));
+            item->isTextDirty = false;
+        }
+
+        return item->text;
+    }
+
+    if (item->nodeId == 0) {
+        switch (role) {
+        case Qt::DecorationRole: return item->builder->icon(item->document);
+        case Qt::ToolTipRole: return item->builder->toolTip(item->document);
+        case ItemTypeRole: return ItemType_Document;
+        default: return {};
+        }
+    }
+
+    const DocumentTreeNode node = WidgetModelTreeItemModel::toDocumentTreeNode(item);
+    switch (role) {
+    case Qt::DecorationRole: return item->builder->icon(node);
+    case Qt::CheckStateRole: {
+        if (!item->builder->isCheckable(node))
+            return {};
+
+        const GuiDocument* guiDoc = m_guiApp ? m_guiApp->findGuiDocument(item->document) : nullptr;
+        return guiDoc ? guiDoc->nodeVisibleState(item->nodeId) : Qt::Checked;
+    }
+    case ItemTypeRole: return item->isEntity ? ItemType_DocumentEntity : ItemType_DocumentTreeNode;
+    default: return {};
+    }
+}
+
+bool WidgetModelTreeItemModel::setData(const QModelIndex& index, const QVariant& value, int role)
+{
+    const Item* item = index.isValid() ? this->toItem(index) : nullptr;
+    if (!item || item->nodeId == 0 || role != Qt::CheckStateRole)
+        return false;
+
+    const auto checkState = Qt::CheckState(value.toInt());
+    GuiDocument* guiDoc = m_guiApp ? m_guiApp->findGuiDocument(item->document) : nullptr;
+    if (!guiDoc || checkState == Qt::PartiallyChecked)
+        return false;
+
+    std::vector<TreeNodeId> vecNodeId = { item->nodeId };
+    if (m_selectionModel && m_selectionModel->isSelected(index)) {
+        for (const QModelIndex& selIndex : m_selectionModel->selectedIndexes()) {
+            const Item* selItem = selIndex != index ? this->toItem(selIndex) : nullptr;
+            if (selItem && selItem->nodeId != 0 && selItem->document == item->document
+                    && (this->flags(selIndex) & Qt::ItemIsUserCheckable))
+            {
+                vecNodeId.push_back(selItem->nodeId);
+            }
+        }
+    }
+
+    // Check states are then updated with signal GuiDocument::nodesVisibilityChanged()
+    guiDoc->setNodesVisible(vecNodeId, checkState == Qt::Checked);
+    guiDoc->graphicsScene()->redraw();
+    return true;
+}
+
+Qt::ItemFlags WidgetModelTreeItemModel::flags(const QModelIndex& index) const
+{
+    const Item* item = index.isValid() ? this->toItem(index) : nullptr;
+    if (!item)
+        return Qt::NoItemFlags;
+
+    Qt::ItemFlags itemFlags = Qt::ItemIsSelectable | Qt::ItemIsEnabled;
+    if (item->nodeId != 0 && item->builder->isCheckable(WidgetModelTreeItemModel::toDocumentTreeNode(item)))
+        itemFlags |= Qt::ItemIsUserCheckable;
+
+    return itemFlags;
+}
+
+WidgetModelTreeItemModel::Item* WidgetModelTreeItemModel::toItem(const QModelIndex& index) const
+{
+    if (!index.isValid())
+        return const_cast<Item*>(&m_root);
+
+    return static_cast<Item*>(index.internalPointer());
+}
+
+QModelIndex WidgetModelTreeItemModel::toIndex(const Item* item) const
+{
+    if (!item || item == &m_root)
+        return {};
+
+    return this->createIndex(item->row, 0, const_cast<Item*>(item));
+}
+
+WidgetModelTreeItemModel::Item* WidgetModelTreeItemModel::findDocumentItem(const DocumentPtr& doc) const
+{
+    auto itItem = std::find_if(
+                m_root.children.cbegin(), m_root.children.cend(), [&](const std::unique_ptr<Item>& item) {
+        return item->document == doc;
+    });
+    return itItem != m_root.children.cend() ? itItem->get() : nullptr;
+}
+
+DocumentTreeNode WidgetModelTreeItemModel::toDocumentTreeNode(const Item* item)
+{
+    return item->nodeId != 0 ? DocumentTreeNode(item->document, item->nodeId) : DocumentTreeNode::null();
+}
+
+bool WidgetModelTreeItemModel::hasPendingRows(const Item* item)
+{
+    return item->pendingRowPos < item->vecPendingRow.size();
+}
+
+bool WidgetModelTreeItemModel::fetchChildren(Item* item, const QElapsedTimer* chronoBudget)
+{
+    if (!item->isFetched) {
+        item->isFetched = true;
+        const DocumentTreeNode node = WidgetModelTreeItemModel::toDocumentTreeNode(item);
+        item->builder->visitChildNodes(node, [&](TreeNodeId id) {
+            item->vecPendingRow.push_back({ id, item->builder, false });
+        });
+    }
+
+    while (WidgetModelTreeItemModel::hasPendingRows(item)) {
+        const size_t pendingCount = item->vecPendingRow.size() - item->pendingRowPos;
+        if (!chronoBudget) {
+            this->insertPendingRows(item, pendingCount);
+            break;
+        }
+
+        const qint64 remainingBudgetNs = ItemModel_fetchTimeBudgetNs - chronoBudget->nsecsElapsed();
+        if (remainingBudgetNs <= 0)
+            return false;
+
+        // Size of next chunk is adapted so its insertion(views included) takes the budget left
+        QElapsedTimer chronoChunk;
+        chronoChunk.start();
+        const size_t chunkSize = std::min(pendingCount, m_fetchChunkSize);
+        this->insertPendingRows(item, chunkSize);
+        const qint64 chunkTimeNs = std::max<qint64>(1, chronoChunk.nsecsElapsed());
+        const double rowTimeNs = double(chunkTimeNs) / chunkSize;
+        m_fetchChunkSize = size_t(std::clamp(ItemModel_fetchTimeBudgetNs / rowTimeNs, 16., 100000.));
+    }
+
+    item->vecPendingRow.clear();
+    item->vecPendingRow.shrink_to_fit();
+    item->pendingRowPos = 0;
+    return true;
+}
+
+void WidgetModelTreeItemModel::insertPendingRows(Item* item, size_t count)
+{
+    if (count == 0)
+        return;
+
+    Item* docItem = item->nodeId != 0 ? this->findDocumentItem(item->document) : item;
+    const int rowFirst = int(item->children.size());
+    this->beginInsertRows(this->toIndex(item), rowFirst, rowFirst + int(count) - 1);
+    item->children.reserve(item->children.size() + count);
+    for (size_t i = 0; i < count; ++i) {
+        const PendingRow& pendingRow = item->vecPendingRow.at(item->pendingRowPos + i);
+        auto childItem = std::make_unique<Item>();
+        childItem->parent = item;
+        childItem->row = int(item->children.size());
+        childItem->document = item->document;
+        childItem->nodeId = pendingRow.nodeId;
+        childItem->isEntity = pendingRow.isEntity;
+        childItem->builder = pendingRow.builder;
+        docItem->mapNodeItem.insert({ pendingRow.nodeId, childItem.get() });
+        item->children.push_back(std::move(childItem));
+    }
+
+    item->pendingRowPos += count;
+    this->endInsertRows();
+}
+
+void WidgetModelTreeItemModel::scheduleFetch(Item* item)
+{
+    if (!item->isFetchScheduled) {
+        item->isFetchScheduled = true;
+        m_vecFetchIndex.push_back(this->toIndex(item));
+    }
+
+    m_timerFetch.start();
+}
+
+void WidgetModelTreeItemModel::onFetchTimeout()
+{
+    QElapsedTimer chronoBudget;
+    chronoBudget.start();
+    auto itIndex = m_vecFetchIndex.begin();
+    while (itIndex != m_vecFetchIndex.end()) {
+        // Index is invalid if item was removed meanwhile
+        if (itIndex->isValid()) {
+            Item* item = this->toItem(*itIndex);
+            if (!this->fetchChildren(item, &chronoBudget))
+                break;
+
+            item->isFetchScheduled = false;
+        }
+
+        ++itIndex;
+    }
+
+    m_vecFetchIndex.erase(m_vecFetchIndex.begin(), itIndex);
+    if (!m_vecFetchIndex.empty())
+        m_timerFetch.start();
+}
+
+void WidgetModelTreeItemModel::removeItem(Item* item)
+{
+    Item* parentItem = item->parent;
+    if (item->nodeId != 0) {
+        Item* docItem = this->findDocumentItem(item->document);
+        std::function<void(const Item*)> fnUnmap = [&](const Item* itemUnmap) {
+            docItem->mapNodeItem.erase(itemUnmap->nodeId);
+            for (const std::unique_ptr<Item>& child : itemUnmap->children)
+                fnUnmap(child.get());
+        };
+        fnUnmap(item);
+    }
+
+    const int row = item->row;
+    this->beginRemoveRows(this->toIndex(parentItem), row, row);
+    parentItem->children.erase(parentItem->children.begin() + row);
+    for (int i = row; i < int(parentItem->children.size()); ++i)
+        parentItem->children.at(i)->row = i;
+
+    this->endRemoveRows();
+}
+
+void WidgetModelTreeItemModel::notifyChildrenTextChanged(const Item* item)
+{
+    if (item->children.empty())
+        return;
+
+    const QModelIndex indexFirst = this->toIndex(item->children.front().get());
+    const QModelIndex indexLast = this->toIndex(item->children.back().get());
+    emit this->dataChanged(indexFirst, indexLast, { Qt::DisplayRole });
+    for (const std::unique_ptr<Item>& child : item->children)
+        this->notifyChildrenTextChanged(child.get());
+}
+
+void WidgetModelTreeItemModel::onTextRefreshTimeout()
+{
+    // Views query data() for displayed rows only, dirty texts of hidden rows are left as is
+    for (const QPersistentModelIndex& index : m_vecTextRefreshIndex) {
+        if (index.isValid())
+            emit this->dataChanged(index, index, { Qt::DisplayRole });
+    }
+
+    for (const QPersistentModelIndex& index : m_vecTextRefreshTreeIndex) {
+        if (index.isValid()) {
+            emit this->dataChanged(index, index, { Qt::DisplayRole });
+            this->notifyChildrenTextChanged(this->toItem(index));
+        }
+    }
+
+    m_vecTextRefreshIndex.clear();
+    m_vecTextRefreshTreeIndex.clear();
+}
+
+} // namespace Mayo
@@ -0,0 +1,145 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "../base/application_item.h"
+#include "../base/document_tree_node.h"
+#include "../base/span.h"
+
+#include <QtCore/QAbstractItemModel>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QItemSelectionModel>
+#include <QtCore/QTimer>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace Mayo {
+
+class GuiApplication;
+class WidgetModelTreeBuilder;
+
+// Item model of WidgetModelTree, backed directly by Document::modelTree()
+// Document and entity rows are inserted when added to the application, but rows of the nodes below
+// an entity are created only once their parent row is expanded(see fetchMore()). Item data(text,
+// icon, ...) is provided on demand by the builder supporting the entity, only text is cached per row
+// Rows are inserted by chunks within a time budget per event loop iteration, remaining ones being
+// inserted in next iterations. So adding thousands of entities or expanding a node having thousands
+// of children never blocks the GUI for more than a few milliseconds
+class WidgetModelTreeItemModel : public QAbstractItemModel {
+public:
+    enum ItemRole {
+        ItemTypeRole = Qt::UserRole + 1
+    };
+
+    enum ItemType {
+        ItemType_Unknown = 0,
+        ItemType_Document = 0x01,
+        ItemType_DocumentTreeNode = 0x02,
+        ItemType_DocumentEntity = 0x10 | ItemType_DocumentTreeNode
+    };
+
+    WidgetModelTreeItemModel(QObject* parent = nullptr);
+    ~WidgetModelTreeItemModel();
+
+    void setGuiApplication(GuiApplication* guiApp) { m_guiApp = guiApp; }
+
+    // When the check state of a selected row is changed, the change applies to all the selected
+    // rows of the same document with a single GuiDocument::setNodesVisible() call
+    void setSelectionModel(QItemSelectionModel* selectionModel) { m_selectionModel = selectionModel; }
+
+    QModelIndex appendDocument(const DocumentPtr& doc, WidgetModelTreeBuilder* builder);
+    void removeDocument(const DocumentPtr& doc);
+    // Row of the entity is inserted on a next event loop iteration, along with other pending rows
+    void appendEntity(const DocumentTreeNode& entityNode, WidgetModelTreeBuilder* builder);
+    void removeEntity(const DocumentTreeNode& entityNode);
+
+    ApplicationItem applicationItem(const QModelIndex& index) const;
+    DocumentTreeNode documentTreeNode(const QModelIndex& index) const;
+
+    QModelIndex indexOf(const DocumentPtr& doc) const;
+    // Index of the row displaying 'node', rows of its ancestors(and pending entity rows) are created
+    // at once if 'fetch' is true
+    // Returns an invalid index if 'node' isn't displayed(eg product merged into its reference row)
+    QModelIndex indexOf(const DocumentTreeNode& node, bool fetch = false);
+
+    // Marks the text of rows as dirty, it's then computed again only when a row gets displayed
+    // View notification is debounced, so bursts of invalidations cause a single refresh
+    void invalidateText(const QModelIndex& index);
+    void invalidateText(const DocumentPtr& doc);
+
+    // Count of rows created for the document 'doc'(document row included), rows are created lazily
+    // so this is usually far less than the count of nodes in the model tree
+    int itemCount(const DocumentPtr& doc) const;
+
+    // Signals check state of nodes have changed, only already created rows are concerned
+    void notifyCheckStateChanged(const DocumentPtr& doc, Span<const TreeNodeId> spanNodeId);
+
+    // from QAbstractItemModel
+    QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex& index) const override;
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    bool hasChildren(const QModelIndex& parent = QModelIndex()) const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    bool setData(const QModelIndex& index, const QVariant& value, int role = Qt::EditRole) override;
+    Qt::ItemFlags flags(const QModelIndex& index) const override;
+
+private:
+    struct PendingRow {
+        TreeNodeId nodeId = 0;
+        WidgetModelTreeBuilder* builder = nullptr;
+        bool isEntity = false;
+    };
+
+    struct Item {
+        Item* parent = nullptr;
+        int row = 0;
+        DocumentPtr document;
+        TreeNodeId nodeId = 0; // Null for document items
+        bool isEntity = false;
+        WidgetModelTreeBuilder* builder = nullptr;
+        std::vector<std::unique_ptr<Item>> children;
+        bool isFetched = false; // Child nodes were collected, their rows might still be pending
+        bool isFetchScheduled = false;
+        std::vector<PendingRow> vecPendingRow; // Child rows to be inserted
+        size_t pendingRowPos = 0; // First row in 'vecPendingRow' not inserted yet
+        mutable bool isTextDirty = true;
+        mutable QString text;
+        // Only for document items, created items of document tree nodes
+        std::unordered_map<TreeNodeId, Item*> mapNodeItem;
+    };
+
+    Item* toItem(const QModelIndex& index) const;
+    QModelIndex toIndex(const Item* item) const;
+    Item* findDocumentItem(const DocumentPtr& doc) const;
+    static DocumentTreeNode toDocumentTreeNode(const Item* item);
+    static bool hasPendingRows(const Item* item);
+    // Inserts the pending child rows of 'item', all of them if 'chronoBudget' is null
+    // Otherwise rows are inserted by chunks until time budget is over, returns false if rows remain
+    bool fetchChildren(Item* item, const QElapsedTimer* chronoBudget = nullptr);
+    void insertPendingRows(Item* item, size_t count);
+    void scheduleFetch(Item* item);
+    void onFetchTimeout();
+    void removeItem(Item* item);
+    void notifyChildrenTextChanged(const Item* item);
+    void onTextRefreshTimeout();
+
+    Item m_root;
+    GuiApplication* m_guiApp = nullptr;
+    QItemSelectionModel* m_selectionModel = nullptr;
+    QTimer m_timerTextRefresh;
+    QTimer m_timerFetch;
+    std::vector<QPersistentModelIndex> m_vecFetchIndex; // Items having pending rows
+    size_t m_fetchChunkSize = 256; // Adapted to the time rows insertion takes
+    std::vector<QPersistentModelIndex> m_vecTextRefreshIndex; // Item only
+    std::vector<QPersistentModelIndex> m_vecTextRefreshTreeIndex; // Item and all its children
+};
+
+} // namespace Mayo
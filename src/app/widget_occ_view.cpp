@@ -7,15 +7,25 @@
 #include "widget_occ_view.h"
 #include "occt_window.h"
 
+#include <QtCore/QTimer>
+#include <QtGui/QGuiApplication>
 #include <QtGui/QResizeEvent>
+#include <QtGui/QScreen>
+#include <QtGui/QWindow>
+#include <algorithm>
+#include <cmath>
 
 namespace Mayo {
 
 WidgetOccView::WidgetOccView(const Handle_V3d_View& view, QWidget* parent)
     : QWidget(parent),
-      m_view(view)
+      m_view(view),
+      m_timerRedraw(new QTimer(this))
 {
     this->setMouseTracking(true);
+    m_timerRedraw->setSingleShot(true);
+    m_timerRedraw->setTimerType(Qt::PreciseTimer);
+    QObject::connect(m_timerRedraw, &QTimer::timeout, this, &WidgetOccView::redrawNow);
 
     // Avoid Qt background clears to improve resizing speed
     this->setAutoFillBackground(false);
@@ -29,6 +39,17 @@ const Handle_V3d_View &WidgetOccView::v3dView() const
     return m_view;
 }
 
+void WidgetOccView::requestRedraw()
+{
+    if (m_timerRedraw->isActive())
+        return; // Already scheduled for next frame
+
+    // Redraw right away if the last frame is older than a frame interval, so latency is kept low
+    const int interval = this->frameInterval();
+    const qint64 elapsed = m_timeSinceRedraw.isValid() ? m_timeSinceRedraw.elapsed() : interval;
+    m_timerRedraw->start(int(std::max<qint64>(0, interval - elapsed)));
+}
+
 QPaintEngine* WidgetOccView::paintEngine() const
 {
     return nullptr;
@@ -47,7 +68,7 @@ void WidgetOccView::showEvent(QShowEvent*)
 
 void WidgetOccView::paintEvent(QPaintEvent*)
 {
-    m_view->Redraw();
+    this->redrawNow();
 }
 
 void WidgetOccView::resizeEvent(QResizeEvent* event)
@@ -56,4 +77,20 @@ void WidgetOccView::resizeEvent(QResizeEvent* event)
         m_view->MustBeResized();
 }
 
+void WidgetOccView::redrawNow()
+{
+    m_timerRedraw->stop(); // Pending request is fulfilled by this redraw
+    emit this->aboutToRedraw();
+    m_view->Redraw();
+    m_timeSinceRedraw.start();
+}
+
+int WidgetOccView::frameInterval() const
+{
+    const QWindow* window = this->window()->windowHandle();
+    const QScreen* screen = window ? window->screen() : QGuiApplication::primaryScreen();
+    const double refreshRate = screen && screen->refreshRate() > 1. ? screen->refreshRate() : 60.;
+    return std::max(1, int(std::lround(1000. / refreshRate)));
+}
+
 } // namespace Mayo
@@ -6,9 +6,12 @@
 
 #pragma once
 
+#include <QtCore/QElapsedTimer>
 #include <QtWidgets/QWidget>
 #include <V3d_View.hxx>
 
+class QTimer;
+
 namespace Mayo {
 
 //! Qt wrapper around the V3d_View class
@@ -20,15 +23,30 @@ public:
 
     const Handle_V3d_View& v3dView() const;
 
+    // Redraw requests are coalesced into a single redraw per displayed frame, paced by the refresh
+    // rate of the screen: on high-rate input devices the view is redrawn once per frame with the
+    // latest camera, intermediate states are dropped
+    void requestRedraw();
+
     QPaintEngine* paintEngine() const override;
 
+signals:
+    // Emitted right before the view is redrawn, eg to apply the camera of an animation for the time
+    // of the frame
+    void aboutToRedraw();
+
 protected:
     void showEvent(QShowEvent* event) override;
     void paintEvent(QPaintEvent* event) override;
     void resizeEvent(QResizeEvent* event) override;
 
 private:
+    void redrawNow();
+    int frameInterval() const; // Milliseconds
+
     Handle_V3d_View m_view;
+    QTimer* m_timerRedraw = nullptr;
+    QElapsedTimer m_timeSinceRedraw;
 };
 
 } // namespace Mayo
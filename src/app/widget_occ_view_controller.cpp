@@ -106,8 +106,7 @@ bool WidgetOccViewController::eventFilter(QObject* watched, QEvent* event)
                 && this->currentDynamicAction() == DynamicAction::InstantZoom)
         {
             this->stopDynamicAction();
-            this->restoreCamera();
-            view->Update();
+            this->changeView([=]{ this->restoreCamera(); });
         }
 
         if (keyEvent->key() == Qt::Key_Shift
@@ -137,7 +136,7 @@ bool WidgetOccViewController::eventFilter(QObject* watched, QEvent* event)
                 view->StartRotation(prevPos.x(), prevPos.y());
             }
 
-            view->Rotation(currPos.x(), currPos.y());
+            this->changeView([&]{ view->Rotation(currPos.x(), currPos.y()); });
         }
         else if (mouseEvent->buttons() == Qt::RightButton) {
             if (!this->isPanningStarted()) {
@@ -145,7 +144,7 @@ bool WidgetOccViewController::eventFilter(QObject* watched, QEvent* event)
                 this->startDynamicAction(DynamicAction::Panning);
             }
 
-            view->Pan(currPos.x() - prevPos.x(), prevPos.y() - currPos.y());
+            this->changeView([&]{ view->Pan(currPos.x() - prevPos.x(), prevPos.y() - currPos.y()); });
         }
         else if (mouseEvent->buttons() == Qt::MiddleButton) {
             if (!this->isWindowZoomingStarted()) {
@@ -200,6 +199,13 @@ void WidgetOccViewController::setViewCursor(const QCursor &cursor)
         m_widgetView->setCursor(cursor);
 }
 
+void WidgetOccViewController::redrawView()
+{
+    // Coalesced with the other requests, a single redraw per displayed frame
+    if (m_widgetView)
+        m_widgetView->requestRedraw();
+}
+
 struct WidgetOccViewController::RubberBand : public V3dViewController::AbstractRubberBand {
     RubberBand(QWidget* parent)
         : m_rubberBand(QRubberBand::Rectangle, parent)
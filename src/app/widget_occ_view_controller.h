@@ -27,6 +27,7 @@ signals:
 
 private:
     void setViewCursor(const QCursor& cursor);
+    void redrawView() override;
 
     AbstractRubberBand* createRubberBand() override;
     struct RubberBand;
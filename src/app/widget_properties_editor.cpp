@@ -76,6 +76,18 @@ void WidgetPropertiesEditor::editProperties(PropertyGroup* propGroup, Group* grp
 
         d->ui->treeWidget_Browser->resizeColumnToContents(0);
         d->ui->treeWidget_Browser->resizeColumnToContents(1);
+
+        // Property values might be changed afterwards without user interaction(ex: values computed
+        // in background)
+        auto propGroupSignals = dynamic_cast<PropertyGroupSignals*>(propGroup);
+        if (propGroupSignals) {
+            QObject::connect(propGroupSignals, &PropertyGroupSignals::propertyChanged, this, [=]{
+                d->ui->treeWidget_Browser->viewport()->update();
+            });
+            QObject::connect(propGroupSignals, &PropertyGroupSignals::propertyEnabled, this, [=](Property* prop, bool on) {
+                this->setPropertyEnabled(prop, on);
+            });
+        }
     }
 }
 
@@ -160,7 +172,10 @@ void WidgetPropertiesEditor::Private::createQtProperty(
     const QString labelSpacer = parentItem ? "       " : "";
     itemProp->setText(0, labelSpacer + property->label());
     itemProp->setData(1, Qt::DisplayRole, QVariant::fromValue<Property*>(property));
-    itemProp->setFlags(Qt::ItemIsSelectable | Qt::ItemIsEnabled | Qt::ItemIsEditable);
+    itemProp->setFlags(Qt::ItemIsSelectable | Qt::ItemIsEditable);
+    if (property->isEnabled())
+        itemProp->setFlags(itemProp->flags() | Qt::ItemIsEnabled);
+
     if (parentItem)
         parentItem->addChild(itemProp);
     else
@@ -6,9 +6,12 @@
 
 #include "application.h"
 #include "document_tree_node_properties_provider.h"
+#include "global.h"
 #include "io_system.h"
+#include "occ_progress_indicator.h"
 #include "property_builtins.h"
 #include "settings.h"
+#include "task_manager.h"
 #include "tkernel_utils.h"
 
 #include <BinXCAFDrivers_DocumentRetrievalDriver.hxx>
@@ -19,6 +22,9 @@
 #if OCC_VERSION_HEX < OCC_VERSION_CHECK(7, 5, 0)
 #  include <CDF_Session.hxx>
 #endif
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+#  include <Message.hxx>
+#endif
 
 #include <QtCore/QCoreApplication>
 #include <QtCore/QDir>
@@ -60,10 +66,15 @@ const ApplicationPtr& Application::instance()
     if (appPtr.IsNull()) {
         appPtr = new Application;
         const char strFougueCopyright[] = "Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>";
+        Handle_BinXCAFDrivers_DocumentStorageDriver binStorageDriver = new BinXCAFDrivers_DocumentStorageDriver;
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+        // Triangulations of shapes are stored too, so reopened documents don't need to be meshed again
+        binStorageDriver->SetWithTriangles(Message::DefaultMessenger(), true);
+#endif
         appPtr->DefineFormat(
                     Document::NameFormatBinary, qUtf8Printable(tr("Binary Mayo Document Format")), "myb",
                     new Document::FormatBinaryRetrievalDriver,
-                    new BinXCAFDrivers_DocumentStorageDriver);
+                    binStorageDriver);
         appPtr->DefineFormat(
                     Document::NameFormatXml, qUtf8Printable(tr("XML Mayo Document Format")), "myx",
                     new Document::FormatXmlRetrievalDriver,
@@ -91,18 +102,44 @@ DocumentPtr Application::newDocument(Document::Format docFormat)
     return DocumentPtr::DownCast(stdDoc);
 }
 
-DocumentPtr Application::openDocument(const FilePath& filepath, PCDM_ReaderStatus* ptrReadStatus)
+DocumentPtr Application::openDocument(
+        const FilePath& filepath, PCDM_ReaderStatus* ptrReadStatus, TaskProgress* progress)
 {
     Handle_TDocStd_Document stdDoc;
-    const PCDM_ReaderStatus readStatus = this->Open(filepathTo<TCollection_ExtendedString>(filepath), stdDoc);
+    const auto strFilepath = filepathTo<TCollection_ExtendedString>(filepath);
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 5, 0)
+    Handle_Message_ProgressIndicator indicator = new OccProgressIndicator(progress);
+    const PCDM_ReaderStatus readStatus = this->Open(strFilepath, stdDoc, TKernelUtils::start(indicator));
+#else
+    MAYO_UNUSED(progress);
+    const PCDM_ReaderStatus readStatus = this->Open(strFilepath, stdDoc);
+#endif
     if (ptrReadStatus)
         *ptrReadStatus = readStatus;
 
     DocumentPtr doc = DocumentPtr::DownCast(stdDoc);
     this->addDocument(doc);
+    if (doc)
+        doc->rebuildModelTree();
+
     return doc;
 }
 
+PCDM_StoreStatus Application::saveDocumentAs(const DocumentPtr& doc, const FilePath& filepath, TaskProgress* progress)
+{
+    if (doc.IsNull())
+        return PCDM_SS_Failure;
+
+    const auto strFilepath = filepathTo<TCollection_ExtendedString>(filepath);
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 5, 0)
+    Handle_Message_ProgressIndicator indicator = new OccProgressIndicator(progress);
+    return this->SaveAs(doc, strFilepath, TKernelUtils::start(indicator));
+#else
+    MAYO_UNUSED(progress);
+    return this->SaveAs(doc, strFilepath);
+#endif
+}
+
 DocumentPtr Application::findDocumentByIndex(int docIndex) const
 {
     Handle_TDocStd_Document doc;
@@ -142,6 +179,29 @@ void Application::closeDocument(const DocumentPtr& doc)
     TDocStd_Application::Close(doc);
 }
 
+TaskId Application::closeDocumentAsync(const DocumentPtr& doc, std::function<void()> fnReleased)
+{
+    if (doc.IsNull())
+        return 0;
+
+    TDocStd_Application::Close(doc);
+    // 'doc' is detached from the application. Once its last reference is dropped(eg widgets deleted
+    // with deleteLater(), lazy meshing tasks), the release task is run: OCAF contents are released
+    // there, but the QObject is deleted in its own thread as events might still be posted to it(eg
+    // queued signals)
+    auto taskMgr = TaskManager::globalInstance();
+    Document* ptrDoc = doc.get();
+    const TaskId taskId = taskMgr->newTask([=](TaskProgress*) {
+        ptrDoc->releaseContents();
+        ptrDoc->deleteLater();
+        if (fnReleased)
+            fnReleased();
+    }, TaskPriority_Background);
+    taskMgr->setTitle(taskId, tr("Release %1").arg(doc->name()));
+    doc->m_fnLastReferenceDropped = [=]{ taskMgr->run(taskId); };
+    return taskId;
+}
+
 Settings* Application::settings() const
 {
     return &(d->m_settings);
@@ -175,6 +235,10 @@ void Application::setOpenCascadeEnvironment(const FilePath& settingsFilepath)
         "MMGT_OPT",
         "MMGT_CLEAR",
         "MMGT_REENTRANT",
+        "MMGT_MMAP",
+        "MMGT_CELLSIZE",
+        "MMGT_NBPAGES",
+        "MMGT_THRESHOLD",
         "CSF_LANGUAGE",
         "CSF_EXCEPTION_PROMPT"
     };
@@ -202,6 +266,13 @@ void Application::setOpenCascadeEnvironment(const FilePath& settingsFilepath)
             continue;
 
         const QString strValue = occSettings.value(qVarName).toString();
+        if (qVarName == QLatin1String("MMGT_OPT")
+                && strValue != "0" && strValue != "1" && strValue != "2")
+        {
+            qWarning().noquote() << tr("Invalid value '%1' of MMGT_OPT, memory manager unchanged").arg(strValue);
+            continue;
+        }
+
         qputenv(varName, strValue.toUtf8());
         qDebug().noquote() << QString("%1 = %2").arg(qVarName).arg(strValue);
     }
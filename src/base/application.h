@@ -8,7 +8,9 @@
 
 #include "application_ptr.h"
 #include "document.h"
+#include "task_common.h"
 #include <CDF_DirectoryIterator.hxx>
+#include <functional>
 
 namespace Mayo {
 
@@ -37,18 +39,36 @@ public:
 
     int documentCount() const;
     DocumentPtr newDocument(Document::Format docFormat = Document::Format::Binary);
-    DocumentPtr openDocument(const FilePath& filepath, PCDM_ReaderStatus* ptrReadStatus = nullptr);
+    // Opens and saves documents in Mayo native formats(see Document::Format)
+    // Progress is reported into 'progress' with OpenCascade >= v7.5.0
+    DocumentPtr openDocument(
+            const FilePath& filepath,
+            PCDM_ReaderStatus* ptrReadStatus = nullptr,
+            TaskProgress* progress = nullptr);
+    PCDM_StoreStatus saveDocumentAs(const DocumentPtr& doc, const FilePath& filepath, TaskProgress* progress = nullptr);
     DocumentPtr findDocumentByIndex(int docIndex) const;
     DocumentPtr findDocumentByIdentifier(Document::Identifier docIdent) const;
     DocumentPtr findDocumentByLocation(const FilePath& location) const;
     int findIndexOfDocument(const DocumentPtr& doc) const;
 
     void closeDocument(const DocumentPtr& doc);
+    // Same as closeDocument() but contents of 'doc'(OCAF labels and attributes, caches, ...) are
+    // released from a TaskManager thread, once the last reference to 'doc' is dropped. The QObject
+    // itself is then deleted with deleteLater(). Signal documentAboutToClose() is emitted before return
+    // Optional 'fnReleased' is called from the release task once contents are released
+    // Returns the identifier of the release task(within TaskManager::globalInstance())
+    TaskId closeDocumentAsync(const DocumentPtr& doc, std::function<void()> fnReleased = {});
 
     Settings* settings() const;
     IO::System* ioSystem() const;
     DocumentTreeNodePropertiesProviderTable* documentTreeNodePropertiesProviderTable() const;
 
+    // Sets the environment variables of OpenCascade(MMGT_*, CSF_*) from INI file 'settingsFilepath'
+    // MMGT_OPT selects the memory manager: 0 = C runtime malloc(), 1 = OpenCascade optimized
+    // allocator(tuned by MMGT_CLEAR, MMGT_MMAP, MMGT_CELLSIZE, MMGT_NBPAGES, MMGT_THRESHOLD) and
+    // 2 = TBB scalable allocator. OpenCascade creates its memory manager on first allocation, so
+    // MMGT_* variables are effective only if this function is called early(or if set in the
+    // environment of the process)
     static void setOpenCascadeEnvironment(const FilePath& settingsFilepath);
 
 public: //  from TDocStd_Application
@@ -0,0 +1,40 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "tkernel_utils.h"
+
+#include <NCollection_IncAllocator.hxx>
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 8, 0)
+#  include <NCollection_OccAllocator.hxx>
+#else
+#  include <NCollection_StdAllocator.hxx>
+#endif
+#include <vector>
+
+namespace Mayo {
+
+// STL allocator taking memory from an OpenCascade allocator, typically an arena created with
+// newArena(). Each container holds a handle to the arena, so memory of the arena is released at
+// once when the last container using it is destroyed
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 8, 0)
+template<typename T> using ArenaAllocator = NCollection_OccAllocator<T>;
+#else
+template<typename T> using ArenaAllocator = NCollection_StdAllocator<T>;
+#endif
+
+template<typename T> using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+// Monotonic allocator, memory is taken by blocks of 'blockSize' bytes and deallocation is a no-op
+// Meant for the transient data of a single operation(eg file import) freed all together
+// BEWARE Not thread-safe, allocations must be done by one thread at a time
+inline Handle_NCollection_BaseAllocator newArena(size_t blockSize = 512 * 1024)
+{
+    return new NCollection_IncAllocator(blockSize);
+}
+
+} // namespace Mayo
@@ -0,0 +1,124 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "bnd_box_cache.h"
+
+#include "bnd_utils.h"
+#include "profiler.h"
+#include "task_manager.h"
+#include "task_progress.h"
+#include "xcaf.h"
+
+#include <BRepBndLib.hxx>
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace Mayo {
+
+Bnd_Box BndBoxCache::labelBox(const TDF_Label& label)
+{
+    if (XCaf::isShapeReference(label)) {
+        const Bnd_Box box = this->labelBox(XCaf::shapeReferred(label));
+        return box.Transformed(XCaf::shapeReferenceLocation(label).Transformation());
+    }
+
+    if (XCaf::isShapeAssembly(label)) {
+        Bnd_Box box;
+        for (const TDF_Label& labelComponent : XCaf::shapeComponents(label))
+            BndUtils::add(&box, this->labelBox(labelComponent));
+
+        return box;
+    }
+
+    return this->prototypeBox(label);
+}
+
+void BndBoxCache::computePrototypeBoxes(const TDF_LabelSequence& seqLabel, TaskProgress* progress)
+{
+    MAYO_PROFILE_ZONE("BndBoxCache::computePrototypeBoxes");
+    // Shapes are retrieved sequentially, only BRep data is then accessed concurrently
+    std::vector<std::pair<TDF_Label, TopoDS_Shape>> vecPrototype;
+    for (const TDF_Label& label : seqLabel) {
+        for (const TDF_Label& labelPrototype : XCaf::shapePrototypes(label)) {
+            const TopoDS_Shape shape = XCaf::shape(labelPrototype);
+            Bnd_Box box;
+            if (!this->findPrototypeBox(labelPrototype, shape, &box))
+                vecPrototype.push_back({ labelPrototype, shape });
+        }
+    }
+
+    if (vecPrototype.empty())
+        return;
+
+    const int prototypeCount = int(vecPrototype.size());
+    const int taskCount = std::min(prototypeCount, std::max(1, int(std::thread::hardware_concurrency())));
+    TaskManager::runConcurrently(taskCount, progress, [&](int iTask, TaskProgress* taskProgress) {
+        const int first = (iTask * prototypeCount) / taskCount;
+        const int last = ((iTask + 1) * prototypeCount) / taskCount;
+        for (int i = first; i < last; ++i) {
+            if (TaskProgress::isAbortRequested(taskProgress))
+                return;
+
+            const auto& [label, shape] = vecPrototype.at(i);
+            this->insertPrototypeBox(label, shape, BndBoxCache::shapeBox(shape));
+            taskProgress->setValue(((i + 1 - first) * 100) / (last - first));
+        }
+    });
+}
+
+void BndBoxCache::forget(const TDF_Label& label)
+{
+    const TDF_LabelSequence seqPrototype = XCaf::shapePrototypes(label);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const TDF_Label& labelPrototype : seqPrototype)
+        m_mapEntry.erase(labelPrototype);
+}
+
+void BndBoxCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_mapEntry.clear();
+}
+
+Bnd_Box BndBoxCache::shapeBox(const TopoDS_Shape& shape)
+{
+    Bnd_Box box;
+    constexpr bool useTriangulation = true;
+    BRepBndLib::Add(shape, box, !useTriangulation);
+    return box;
+}
+
+Bnd_Box BndBoxCache::prototypeBox(const TDF_Label& label)
+{
+    const TopoDS_Shape shape = XCaf::shape(label);
+    Bnd_Box box;
+    if (!this->findPrototypeBox(label, shape, &box)) {
+        box = BndBoxCache::shapeBox(shape);
+        this->insertPrototypeBox(label, shape, box);
+    }
+
+    return box;
+}
+
+bool BndBoxCache::findPrototypeBox(const TDF_Label& label, const TopoDS_Shape& shape, Bnd_Box* box) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_mapEntry.find(label);
+    if (it == m_mapEntry.end() || !it->second.shape.IsSame(shape))
+        return false;
+
+    *box = it->second.box;
+    return true;
+}
+
+void BndBoxCache::insertPrototypeBox(const TDF_Label& label, const TopoDS_Shape& shape, const Bnd_Box& box)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_mapEntry[label] = Entry{ shape, box };
+}
+
+} // namespace Mayo
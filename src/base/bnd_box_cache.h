@@ -0,0 +1,60 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "caf_utils.h"
+
+#include <Bnd_Box.hxx>
+#include <TDF_Label.hxx>
+#include <TDF_LabelSequence.hxx>
+#include <TopoDS_Shape.hxx>
+#include <mutex>
+#include <unordered_map>
+
+namespace Mayo {
+
+class TaskProgress;
+
+// Bounding boxes of the XCAF shapes of a document
+// Boxes are computed once per prototype(non-assembly shape, see XCaf::shapePrototypes()), the box
+// of an instance is the box of its prototype transformed by the instance location
+// Cached boxes are tied to the shape they were computed from, so a box is computed again when the
+// shape of a label is replaced(eg deferred shape loaded)
+// All functions are thread-safe
+class BndBoxCache {
+public:
+    // Returns the box of the shape at 'label', which can be a prototype, an assembly or a
+    // reference(box is then located)
+    Bnd_Box labelBox(const TDF_Label& label);
+
+    // Computes concurrently the boxes of all the prototypes instantiated by 'seqLabel', so later
+    // calls to labelBox() are just lookups
+    void computePrototypeBoxes(const TDF_LabelSequence& seqLabel, TaskProgress* progress = nullptr);
+
+    // Drops the boxes of the prototypes instantiated by 'label', to be called before the label is
+    // destroyed
+    void forget(const TDF_Label& label);
+    void clear();
+
+    // Bounding box of 'shape' computed from BRep geometry, triangulation isn't used
+    static Bnd_Box shapeBox(const TopoDS_Shape& shape);
+
+private:
+    Bnd_Box prototypeBox(const TDF_Label& label);
+    bool findPrototypeBox(const TDF_Label& label, const TopoDS_Shape& shape, Bnd_Box* box) const;
+    void insertPrototypeBox(const TDF_Label& label, const TopoDS_Shape& shape, const Bnd_Box& box);
+
+    struct Entry {
+        TopoDS_Shape shape;
+        Bnd_Box box;
+    };
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<TDF_Label, Entry> m_mapEntry;
+};
+
+} // namespace Mayo
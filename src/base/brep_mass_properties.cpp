@@ -0,0 +1,168 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "brep_mass_properties.h"
+
+#include "mesh_utils.h"
+#include "profiler.h"
+#include "task_manager.h"
+#include "task_progress.h"
+
+#include <BRepGProp.hxx>
+#include <BRep_Tool.hxx>
+#include <GProp_GProps.hxx>
+#include <Poly_Triangulation.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopoDS.hxx>
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+namespace Mayo {
+
+namespace {
+
+struct FaceItem {
+    TopoDS_Face face;
+    bool isSolidBoundary = false; // Contributes to volume
+};
+
+// Integrals of a face, moments are the integrals of position vectors so contributions of faces
+// can simply be summed
+struct FaceIntegrals {
+    double area = 0;
+    gp_XYZ areaMoment;
+    double volume = 0;
+    gp_XYZ volumeMoment;
+};
+
+FaceIntegrals exactIntegrals(const FaceItem& item)
+{
+    FaceIntegrals integrals;
+    GProp_GProps surfaceProps;
+    BRepGProp::SurfaceProperties(item.face, surfaceProps);
+    integrals.area = surfaceProps.Mass();
+    integrals.areaMoment = surfaceProps.CentreOfMass().XYZ() * integrals.area;
+    if (item.isSolidBoundary) {
+        // Contribution of the face to the volume of its solid(divergence theorem), relative to
+        // the origin as all faces must share the same reference point
+        GProp_GProps volumeProps;
+        BRepGProp::VolumeProperties(item.face, volumeProps);
+        integrals.volume = volumeProps.Mass();
+        integrals.volumeMoment = volumeProps.CentreOfMass().XYZ() * integrals.volume;
+    }
+
+    return integrals;
+}
+
+bool triangulationIntegrals(const FaceItem& item, FaceIntegrals* integrals)
+{
+    TopLoc_Location loc;
+    const Handle_Poly_Triangulation& triangulation = BRep_Tool::Triangulation(item.face, loc);
+    if (triangulation.IsNull() || triangulation->NbTriangles() <= 0)
+        return false;
+
+    const gp_Trsf& trsf = loc.Transformation();
+    const bool isReversed = item.face.Orientation() == TopAbs_REVERSED;
+    for (int i = 1; i <= triangulation->NbTriangles(); ++i) {
+        int n1, n2, n3;
+        triangulation->Triangle(i).Get(n1, n2, n3);
+        if (isReversed)
+            std::swap(n2, n3);
+
+        const gp_XYZ p1 = triangulation->Node(n1).Transformed(trsf).XYZ();
+        const gp_XYZ p2 = triangulation->Node(n2).Transformed(trsf).XYZ();
+        const gp_XYZ p3 = triangulation->Node(n3).Transformed(trsf).XYZ();
+        const gp_XYZ sum = p1 + p2 + p3;
+        const double area = MeshUtils::triangleArea(p1, p2, p3);
+        integrals->area += area;
+        integrals->areaMoment += sum * (area / 3.);
+        if (item.isSolidBoundary) {
+            // Signed volume of the tetrahedron formed with origin, centroid is at 1/4 of sum
+            const double volume = MeshUtils::triangleSignedVolume(p1, p2, p3);
+            integrals->volume += volume;
+            integrals->volumeMoment += sum * (volume / 4.);
+        }
+    }
+
+    return true;
+}
+
+} // namespace
+
+BRepMassProperties BRepMassProperties::compute(const TopoDS_Shape& shape, Mode mode, TaskProgress* progress)
+{
+    MAYO_PROFILE_ZONE("BRepMassProperties::compute");
+    BRepMassProperties props;
+    if (shape.IsNull())
+        return props;
+
+    // Faces of solids first, then faces not part of any solid
+    std::vector<FaceItem> vecFace;
+    for (TopExp_Explorer expSolid(shape, TopAbs_SOLID); expSolid.More(); expSolid.Next()) {
+        for (TopExp_Explorer expFace(expSolid.Current(), TopAbs_FACE); expFace.More(); expFace.Next())
+            vecFace.push_back({ TopoDS::Face(expFace.Current()), true });
+    }
+
+    for (TopExp_Explorer expFace(shape, TopAbs_FACE, TopAbs_SOLID); expFace.More(); expFace.Next())
+        vecFace.push_back({ TopoDS::Face(expFace.Current()), false });
+
+    props.faceCount = int(vecFace.size());
+    if (vecFace.empty())
+        return props;
+
+    // Faces are processed by contiguous chunks, more chunks than threads to balance the load as
+    // faces can be of very different complexity
+    const int faceCount = int(vecFace.size());
+    const int threadCount = std::max(1, int(std::thread::hardware_concurrency()));
+    const int chunkCount = std::min(faceCount, 4 * threadCount);
+    std::vector<FaceIntegrals> vecFaceIntegrals(vecFace.size());
+    auto fnChunk = [&](int iChunk, TaskProgress* chunkProgress) {
+        const int first = (iChunk * faceCount) / chunkCount;
+        const int last = ((iChunk + 1) * faceCount) / chunkCount;
+        for (int i = first; i < last; ++i) {
+            if (TaskProgress::isAbortRequested(chunkProgress))
+                return;
+
+            const FaceItem& item = vecFace.at(i);
+            FaceIntegrals& integrals = vecFaceIntegrals.at(i);
+            if (mode != Mode::Triangulation || !triangulationIntegrals(item, &integrals))
+                integrals = exactIntegrals(item);
+
+            if (chunkProgress)
+                chunkProgress->setValue(((i + 1 - first) * 100) / (last - first));
+        }
+    };
+    if (chunkCount > 1) {
+        if (!TaskManager::runConcurrently(chunkCount, progress, fnChunk))
+            return props;
+    }
+    else {
+        fnChunk(0, progress);
+    }
+
+    // Reduction in face order, independent of the way faces were dispatched to threads
+    FaceIntegrals total;
+    for (const FaceIntegrals& integrals : vecFaceIntegrals) {
+        total.area += integrals.area;
+        total.areaMoment += integrals.areaMoment;
+        total.volume += integrals.volume;
+        total.volumeMoment += integrals.volumeMoment;
+    }
+
+    // Solids with faces oriented inwards give negative volume
+    props.area = total.area;
+    props.volume = std::abs(total.volume);
+    if (props.volume > 0)
+        props.centroid.SetXYZ(total.volumeMoment / total.volume);
+    else if (props.area > 0)
+        props.centroid.SetXYZ(total.areaMoment / total.area);
+
+    return props;
+}
+
+} // namespace Mayo
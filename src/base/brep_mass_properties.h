@@ -0,0 +1,37 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include <TopoDS_Shape.hxx>
+#include <gp_Pnt.hxx>
+
+namespace Mayo {
+
+class TaskProgress;
+
+// Mass properties of a BRep shape, for unit density
+// Computation is split per face: the surface integrals of each face are evaluated concurrently,
+// then summed in the order faces are explored so the result doesn't depend on thread scheduling
+struct BRepMassProperties {
+    enum class Mode {
+        // Integrals are evaluated on the geometric surfaces of the faces(BRepGProp)
+        Exact,
+        // Integrals are evaluated on the triangulation of the faces, which is much faster but
+        // approximate. Faces without triangulation are evaluated the exact way
+        Triangulation
+    };
+
+    double area = 0; // Area of all faces
+    double volume = 0; // Volume of the solids, faces not part of a solid aren't considered
+    gp_Pnt centroid; // Center of volume, or center of area if volume is null
+    int faceCount = 0;
+
+    static BRepMassProperties compute(
+            const TopoDS_Shape& shape, Mode mode = Mode::Exact, TaskProgress* progress = nullptr);
+};
+
+} // namespace Mayo
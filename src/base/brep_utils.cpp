@@ -8,18 +8,88 @@
 
 #include "global.h"
 #include "tkernel_utils.h"
+#include "task_progress.h"
 #if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 5, 0)
 #  include "occ_progress_indicator.h"
 #endif
 
+#include <QtCore/QByteArray>
+#include <QtCore/QCryptographicHash>
+#include <BinTools.hxx>
+#include <BRepBuilderAPI_Copy.hxx>
 #include <BRepMesh_IncrementalMesh.hxx>
 #include <BRep_Builder.hxx>
 #include <BRepTools.hxx>
+#include <TopoDS_Compound.hxx>
 #include <climits>
+#include <istream>
+#include <ostream>
 #include <sstream>
+#include <streambuf>
 
 namespace Mayo {
 
+namespace {
+
+// Read-only stream buffer over existing memory, avoids the copy made by std::istringstream
+class MemoryStreamBuffer : public std::streambuf {
+public:
+    MemoryStreamBuffer(std::string_view data) {
+        char* begin = const_cast<char*>(data.data());
+        this->setg(begin, begin, begin + data.size());
+    }
+
+protected:
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode) override {
+        char* pos = nullptr;
+        if (dir == std::ios_base::beg)
+            pos = this->eback() + off;
+        else if (dir == std::ios_base::cur)
+            pos = this->gptr() + off;
+        else
+            pos = this->egptr() + off;
+
+        if (pos < this->eback() || pos > this->egptr())
+            return pos_type(off_type(-1));
+
+        this->setg(this->eback(), pos, this->egptr());
+        return pos_type(pos - this->eback());
+    }
+
+    pos_type seekpos(pos_type pos, std::ios_base::openmode mode) override {
+        return this->seekoff(off_type(pos), std::ios_base::beg, mode);
+    }
+};
+
+// BinTools_ShapeSet header, start of any uncompressed binary data
+constexpr std::string_view binaryShapeToken = "Open CASCADE Topology V";
+
+// Output stream buffer feeding a hash function instead of storing characters
+class HashStreamBuf : public std::streambuf {
+public:
+    HashStreamBuf(QCryptographicHash* hash) : m_hash(hash) {}
+
+protected:
+    int_type overflow(int_type c) override {
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            const char chr = traits_type::to_char_type(c);
+            m_hash->addData(&chr, 1);
+        }
+
+        return traits_type::not_eof(c);
+    }
+
+    std::streamsize xsputn(const char* s, std::streamsize n) override {
+        m_hash->addData(s, int(n));
+        return n;
+    }
+
+private:
+    QCryptographicHash* m_hash = nullptr;
+};
+
+} // namespace
+
 bool BRepUtils::moreComplex(TopAbs_ShapeEnum lhs, TopAbs_ShapeEnum rhs)
 {
     return lhs < rhs;
@@ -37,26 +107,115 @@ std::string BRepUtils::shapeToString(const TopoDS_Shape& shape)
     return oss.str();
 }
 
-TopoDS_Shape BRepUtils::shapeFromString(const std::string& str)
+TopoDS_Shape BRepUtils::shapeFromString(std::string_view str)
 {
     TopoDS_Shape shape;
     BRep_Builder brepBuilder;
-    std::istringstream iss(str, std::ios_base::in);
-    BRepTools::Read(shape, iss, brepBuilder);
+    MemoryStreamBuffer buffer(str);
+    std::istream istr(&buffer);
+    BRepTools::Read(shape, istr, brepBuilder);
+    return shape;
+}
+
+std::string BRepUtils::shapeToBinary(const TopoDS_Shape& shape, bool compress)
+{
+    std::ostringstream oss(std::ios_base::out | std::ios_base::binary);
+    BinTools::Write(shape, oss);
+    std::string data = oss.str();
+    if (!compress)
+        return data;
+
+    // qCompress() output starts with uncompressed size(4 bytes big-endian), so it can't be
+    // confused with BinTools header
+    const QByteArray zdata = qCompress(reinterpret_cast<const uchar*>(data.data()), int(data.size()));
+    return std::string(zdata.constData(), zdata.size());
+}
+
+TopoDS_Shape BRepUtils::shapeFromBinary(std::string_view data)
+{
+    TopoDS_Shape shape;
+    auto fnRead = [&](std::string_view bytes) {
+        MemoryStreamBuffer buffer(bytes);
+        std::istream istr(&buffer);
+        BinTools::Read(shape, istr);
+    };
+    if (data.substr(0, binaryShapeToken.size()) == binaryShapeToken) {
+        fnRead(data);
+    }
+    else {
+        const QByteArray bytes = qUncompress(reinterpret_cast<const uchar*>(data.data()), int(data.size()));
+        if (!bytes.isEmpty())
+            fnRead(std::string_view(bytes.constData(), bytes.size()));
+    }
+
     return shape;
 }
 
+void BRepUtils::addShapeToHash(const TopoDS_Shape& shape, QCryptographicHash* hash, bool withTriangulations)
+{
+    HashStreamBuf hashBuf(hash);
+    std::ostream ostr(&hashBuf);
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+    BRepTools::Write(shape, ostr, withTriangulations, false/*withNormals*/, TopTools_FormatVersion_CURRENT);
+#else
+    if (withTriangulations) {
+        BRepTools::Write(shape, ostr);
+    }
+    else {
+        // BRepTools::Write() always includes triangulations, write a copy without meshes
+        const BRepBuilderAPI_Copy copy(shape, true/*copyGeom*/, false/*copyMesh*/);
+        BRepTools::Write(copy.Shape(), ostr);
+    }
+#endif
+}
+
 void BRepUtils::computeMesh(
         const TopoDS_Shape& shape, const OccBRepMeshParameters& params, TaskProgress* progress)
 {
 #if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 5, 0)
     Handle_Message_ProgressIndicator indicator = new OccProgressIndicator(progress);
     BRepMesh_IncrementalMesh mesher(shape, params, TKernelUtils::start(indicator));
+    MAYO_UNUSED(mesher);
 #else
-    BRepMesh_IncrementalMesh mesher(shape, params);
-    MAYO_UNUSED(progress);
+    // No progress indicator in BRepMesh, faces are meshed by batches so abort requests are checked
+    // in between. Batches are compounds, parallel meshing of their faces still applies
+    constexpr int batchFaceCount = 64;
+    int faceCount = 0;
+    if (progress)
+        BRepUtils::forEachSubShape(shape, TopAbs_FACE, [&](const TopoDS_Shape&) { ++faceCount; });
+
+    if (faceCount <= batchFaceCount) {
+        BRepMesh_IncrementalMesh mesher(shape, params);
+        MAYO_UNUSED(mesher);
+        return;
+    }
+
+    int meshedFaceCount = 0;
+    BRep_Builder builder;
+    TopoDS_Compound batch;
+    int batchSize = 0;
+    auto fnMeshBatch = [&]{
+        BRepMesh_IncrementalMesh mesher(batch, params);
+        MAYO_UNUSED(mesher);
+        meshedFaceCount += batchSize;
+        progress->setValue((100 * meshedFaceCount) / faceCount);
+        batchSize = 0;
+    };
+    for (TopExp_Explorer expl(shape, TopAbs_FACE); expl.More(); expl.Next()) {
+        if (batchSize == 0)
+            builder.MakeCompound(batch);
+
+        builder.Add(batch, expl.Current());
+        if (++batchSize == batchFaceCount) {
+            fnMeshBatch();
+            if (progress->isAbortRequested())
+                return;
+        }
+    }
+
+    if (batchSize > 0)
+        fnMeshBatch();
 #endif
-    MAYO_UNUSED(mesher);
 }
 
 } // namespace Mayo
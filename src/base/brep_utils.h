@@ -12,6 +12,9 @@
 #include <TopExp_Explorer.hxx>
 #include <TopoDS.hxx>
 #include <string>
+#include <string_view>
+
+class QCryptographicHash;
 
 namespace Mayo {
 
@@ -44,7 +47,21 @@ struct BRepUtils {
     static std::string shapeToString(const TopoDS_Shape& shape);
 
     // Deserializes string 'str' obtained from 'shapeToToString()' into a shape object
-    static TopoDS_Shape shapeFromString(const std::string& str);
+    // 'str' is read in place, no copy is made
+    static TopoDS_Shape shapeFromString(std::string_view str);
+
+    // Serializes 'shape' into a compact binary representation(OpenCascade BinTools format),
+    // triangulations are included. If 'compress' is true then data is further compressed with zlib
+    static std::string shapeToBinary(const TopoDS_Shape& shape, bool compress = false);
+
+    // Deserializes 'data' obtained from 'shapeToBinary()' into a shape object, compression is
+    // detected. Uncompressed 'data' is read in place, no copy is made
+    static TopoDS_Shape shapeFromBinary(std::string_view data);
+
+    // Feeds 'hash' with the serialized contents of 'shape'(OpenCascade BRep format), nothing is
+    // stored in memory. Triangulations are excluded if 'withTriangulations' is false, so shapes
+    // having same geometry produce same hash whatever their meshes
+    static void addShapeToHash(const TopoDS_Shape& shape, QCryptographicHash* hash, bool withTriangulations = true);
 
     // Computes a mesh representation of 'shape' using OpenCascade meshing algorithm
     static void computeMesh(
@@ -0,0 +1,237 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "bvh.h"
+#include "task_manager.h"
+
+#include <cmath>
+#include <numeric>
+#include <thread>
+
+namespace Mayo {
+
+void Bvh::Box::add(const gp_Pnt& pnt)
+{
+    const double coords[] = { pnt.X(), pnt.Y(), pnt.Z() };
+    for (int i = 0; i < 3; ++i) {
+        this->minCorner[i] = std::min(this->minCorner[i], coords[i]);
+        this->maxCorner[i] = std::max(this->maxCorner[i], coords[i]);
+    }
+}
+
+void Bvh::Box::add(const Box& other)
+{
+    for (int i = 0; i < 3; ++i) {
+        this->minCorner[i] = std::min(this->minCorner[i], other.minCorner[i]);
+        this->maxCorner[i] = std::max(this->maxCorner[i], other.maxCorner[i]);
+    }
+}
+
+double Bvh::Box::squareDistance(const gp_Pnt& pnt) const
+{
+    const double coords[] = { pnt.X(), pnt.Y(), pnt.Z() };
+    double sqDist = 0.;
+    for (int i = 0; i < 3; ++i) {
+        const double delta = std::max({ 0., this->minCorner[i] - coords[i], coords[i] - this->maxCorner[i] });
+        sqDist += delta * delta;
+    }
+
+    return sqDist;
+}
+
+bool Bvh::Box::lineRange(const gp_Pnt& pnt, const gp_Dir& dir, double* tMin, double* tMax) const
+{
+    // Slab method
+    const double origin[] = { pnt.X(), pnt.Y(), pnt.Z() };
+    const double direction[] = { dir.X(), dir.Y(), dir.Z() };
+    double t0 = -Infinite;
+    double t1 = Infinite;
+    for (int i = 0; i < 3; ++i) {
+        if (std::abs(direction[i]) > 0.) {
+            const double invDir = 1. / direction[i];
+            double tNear = (this->minCorner[i] - origin[i]) * invDir;
+            double tFar = (this->maxCorner[i] - origin[i]) * invDir;
+            if (tNear > tFar)
+                std::swap(tNear, tFar);
+
+            t0 = std::max(t0, tNear);
+            t1 = std::min(t1, tFar);
+        }
+        else if (origin[i] < this->minCorner[i] || origin[i] > this->maxCorner[i]) {
+            return false;
+        }
+    }
+
+    *tMin = t0;
+    *tMax = t1;
+    return t0 <= t1;
+}
+
+void Bvh::Box::planeRange(const gp_Dir& n, double d, double* distMin, double* distMax) const
+{
+    // Center and half-extent of the box projected on normal 'n'
+    const double normal[] = { n.X(), n.Y(), n.Z() };
+    double center = 0.;
+    double radius = 0.;
+    for (int i = 0; i < 3; ++i) {
+        center += normal[i] * 0.5 * (this->minCorner[i] + this->maxCorner[i]);
+        radius += std::abs(normal[i]) * 0.5 * (this->maxCorner[i] - this->minCorner[i]);
+    }
+
+    *distMin = center - d - radius;
+    *distMax = center - d + radius;
+}
+
+namespace {
+
+// Below that count of items, subtrees aren't built concurrently
+constexpr int MinConcurrentBuildSize = 1 << 16;
+
+struct BuildContext {
+    Span<const Bvh::Box> itemBoxes;
+    std::vector<int>* vecItem;
+    std::vector<Bvh::Node>* vecNode;
+    int maxLeafSize;
+};
+
+// Subtree whose items are [first, last[, to be built separately and then linked to node 'iNode'
+struct PendingSubtree {
+    int iNode;
+    int first;
+    int last;
+};
+
+// Builds node 'iNode' of the items [first, last[
+// If 'vecPending' isn't null, recursion stops at 'maxDepth' and subtrees still to be built are
+// added to 'vecPending'
+void buildNode(
+        const BuildContext& ctx,
+        int iNode,
+        int first,
+        int last,
+        int depth,
+        int maxDepth,
+        std::vector<PendingSubtree>* vecPending)
+{
+    if (vecPending && depth == maxDepth) {
+        vecPending->push_back({ iNode, first, last });
+        return;
+    }
+
+    std::vector<int>& vecItem = *ctx.vecItem;
+    Bvh::Box box;
+    Bvh::Box centerBox; // Bounding box of item centers, scaled by 2
+    for (int i = first; i < last; ++i) {
+        const Bvh::Box& itemBox = ctx.itemBoxes[vecItem[i]];
+        box.add(itemBox);
+        centerBox.add(gp_Pnt(
+                          itemBox.minCorner[0] + itemBox.maxCorner[0],
+                          itemBox.minCorner[1] + itemBox.maxCorner[1],
+                          itemBox.minCorner[2] + itemBox.maxCorner[2]));
+    }
+
+    int axis = 0;
+    for (int i = 1; i < 3; ++i) {
+        const double extent = centerBox.maxCorner[i] - centerBox.minCorner[i];
+        if (extent > centerBox.maxCorner[axis] - centerBox.minCorner[axis])
+            axis = i;
+    }
+
+    // Note: vecNode might be reallocated by recursive calls, nodes are accessed by index
+    std::vector<Bvh::Node>& vecNode = *ctx.vecNode;
+    vecNode[iNode].box = box;
+    const bool isFlat = !(centerBox.maxCorner[axis] > centerBox.minCorner[axis]);
+    if (last - first <= ctx.maxLeafSize || isFlat) {
+        vecNode[iNode].first = first;
+        vecNode[iNode].count = last - first;
+        return;
+    }
+
+    const int middle = first + (last - first) / 2;
+    auto fnCenter = [&](int iItem) {
+        const Bvh::Box& itemBox = ctx.itemBoxes[iItem];
+        return itemBox.minCorner[axis] + itemBox.maxCorner[axis];
+    };
+    std::nth_element(
+                vecItem.begin() + first, vecItem.begin() + middle, vecItem.begin() + last,
+                [&](int lhs, int rhs) { return fnCenter(lhs) < fnCenter(rhs); });
+
+    const int iChild = int(vecNode.size());
+    vecNode.resize(vecNode.size() + 2);
+    vecNode[iNode].first = iChild;
+    vecNode[iNode].count = 0;
+    buildNode(ctx, iChild, first, middle, depth + 1, maxDepth, vecPending);
+    buildNode(ctx, iChild + 1, middle, last, depth + 1, maxDepth, vecPending);
+}
+
+} // namespace
+
+Bvh Bvh::build(Span<const Box> itemBoxes, int maxLeafSize)
+{
+    Bvh bvh;
+    const int itemCount = int(itemBoxes.size());
+    if (itemCount == 0)
+        return bvh;
+
+    bvh.m_vecItem.resize(itemCount);
+    std::iota(bvh.m_vecItem.begin(), bvh.m_vecItem.end(), 0);
+    bvh.m_vecNode.reserve(2 * (itemCount / std::max(1, maxLeafSize)) + 1);
+    bvh.m_vecNode.resize(1);
+    const BuildContext ctx = { itemBoxes, &bvh.m_vecItem, &bvh.m_vecNode, std::max(1, maxLeafSize) };
+
+    const int threadCount = std::max(1, int(std::thread::hardware_concurrency()));
+    if (itemCount < MinConcurrentBuildSize || threadCount == 1) {
+        buildNode(ctx, 0, 0, itemCount, 0, -1, nullptr);
+        return bvh;
+    }
+
+    // Top of the hierarchy is built sequentially until there's a subtree for each thread, subtrees
+    // are then built concurrently in separate node arrays(ranges of items are disjoint)
+    int topDepth = 0;
+    while ((1 << topDepth) < threadCount)
+        ++topDepth;
+
+    std::vector<PendingSubtree> vecPending;
+    buildNode(ctx, 0, 0, itemCount, 0, topDepth, &vecPending);
+    std::vector<std::vector<Node>> vecSubtreeNodes(vecPending.size());
+    TaskManager::runConcurrently(int(vecPending.size()), nullptr, [&](int iSubtree, TaskProgress*) {
+        const PendingSubtree& subtree = vecPending.at(iSubtree);
+        std::vector<Node>& vecNode = vecSubtreeNodes.at(iSubtree);
+        vecNode.resize(1);
+        const BuildContext subCtx = { itemBoxes, &bvh.m_vecItem, &vecNode, ctx.maxLeafSize };
+        buildNode(subCtx, 0, subtree.first, subtree.last, 0, -1, nullptr);
+    });
+
+    // Root of a subtree replaces its pending node, other nodes are appended
+    for (size_t i = 0; i < vecPending.size(); ++i) {
+        const std::vector<Node>& vecNode = vecSubtreeNodes.at(i);
+        const int offset = int(bvh.m_vecNode.size()) - 1;
+        auto fnLinked = [=](Node node) {
+            if (!node.isLeaf())
+                node.first += offset;
+
+            return node;
+        };
+        bvh.m_vecNode[vecPending.at(i).iNode] = fnLinked(vecNode.front());
+        for (auto it = vecNode.cbegin() + 1; it != vecNode.cend(); ++it)
+            bvh.m_vecNode.push_back(fnLinked(*it));
+    }
+
+    return bvh;
+}
+
+const Bvh::Box& Bvh::box() const
+{
+    static const Box nullBox;
+    return !m_vecNode.empty() ? m_vecNode.front().box : nullBox;
+}
+
+size_t Bvh::memoryUsage() const
+{
+    return m_vecNode.capacity() * sizeof(Node) + m_vecItem.capacity() * sizeof(int);
+}
+
+} // namespace Mayo
@@ -0,0 +1,161 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "span.h"
+
+#include <gp_Dir.hxx>
+#include <gp_Pnt.hxx>
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace Mayo {
+
+// Bounding volume hierarchy over items given by their axis-aligned bounding boxes
+// Tree is built top-down, nodes are split at the median of item centers along the longest axis,
+// so depth is logarithmic whatever the distribution of the items. Subtrees of big hierarchies are
+// built concurrently
+// Bvh doesn't keep the item boxes, items are identified by their index in the input array
+class Bvh {
+public:
+    struct Box {
+        double minCorner[3] = { Infinite, Infinite, Infinite };
+        double maxCorner[3] = { -Infinite, -Infinite, -Infinite };
+
+        bool isVoid() const { return this->minCorner[0] > this->maxCorner[0]; }
+        void add(const gp_Pnt& pnt);
+        void add(const Box& other);
+        // Squared distance from 'pnt' to the box, zero if 'pnt' is inside
+        double squareDistance(const gp_Pnt& pnt) const;
+        // Range of parameters [tMin, tMax] of the points on the line 'pnt + t * dir' inside the box
+        // Returns false if the line misses the box
+        bool lineRange(const gp_Pnt& pnt, const gp_Dir& dir, double* tMin, double* tMax) const;
+        // Range of the signed distances of the box corners to the plane 'dot(n, p) = d', with 'n'
+        // unit normal. The box crosses the plane if returned range contains zero
+        void planeRange(const gp_Dir& n, double d, double* distMin, double* distMax) const;
+
+        static constexpr double Infinite = std::numeric_limits<double>::max();
+    };
+
+    struct Node {
+        Box box;
+        // Leaf node: items at [first, first + count[ in array items()
+        // Inner node(count == 0): children are nodes at indexes 'first' and 'first + 1'
+        int first = 0;
+        int count = 0;
+
+        bool isLeaf() const { return this->count > 0; }
+    };
+
+    // Maximum count of items in a leaf node
+    static constexpr int DefaultMaxLeafSize = 4;
+
+    Bvh() = default;
+    static Bvh build(Span<const Box> itemBoxes, int maxLeafSize = DefaultMaxLeafSize);
+
+    bool empty() const { return m_vecNode.empty(); }
+    int itemCount() const { return int(m_vecItem.size()); }
+    const Box& box() const;
+
+    const std::vector<Node>& nodes() const { return m_vecNode; }
+    const std::vector<int>& items() const { return m_vecItem; }
+
+    // Visits depth-first the nodes for which fnAcceptBox(const Box&) returns true, and calls
+    // fnItem(int iItem) for each item of the visited leaves
+    template<typename FN_ACCEPT, typename FN_ITEM>
+    void traverse(FN_ACCEPT fnAcceptBox, FN_ITEM fnItem) const;
+
+    // Visits nodes nearest-first, handy for closest point and ray queries
+    // fnBoxBound(const Box&) returns a lower bound of the values of the items inside the box, and
+    // fnItem(int iItem) returns the best value found so far. Nodes whose bound isn't less than the
+    // best value are skipped
+    template<typename FN_BOUND, typename FN_ITEM>
+    void traverseNearest(FN_BOUND fnBoxBound, FN_ITEM fnItem) const;
+
+    size_t memoryUsage() const;
+
+private:
+    // Median split gives a depth not exceeding log2(INT_MAX)
+    static constexpr int MaxDepth = 64;
+
+    std::vector<Node> m_vecNode;
+    std::vector<int> m_vecItem;
+};
+
+
+
+// --
+// -- Implementation
+// --
+
+template<typename FN_ACCEPT, typename FN_ITEM>
+void Bvh::traverse(FN_ACCEPT fnAcceptBox, FN_ITEM fnItem) const
+{
+    if (m_vecNode.empty())
+        return;
+
+    int stack[MaxDepth];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+    while (stackSize > 0) {
+        const Node& node = m_vecNode[stack[--stackSize]];
+        if (!fnAcceptBox(node.box))
+            continue;
+
+        if (node.isLeaf()) {
+            for (int i = node.first; i < node.first + node.count; ++i)
+                fnItem(m_vecItem[i]);
+        }
+        else {
+            stack[stackSize++] = node.first + 1;
+            stack[stackSize++] = node.first;
+        }
+    }
+}
+
+template<typename FN_BOUND, typename FN_ITEM>
+void Bvh::traverseNearest(FN_BOUND fnBoxBound, FN_ITEM fnItem) const
+{
+    if (m_vecNode.empty())
+        return;
+
+    struct StackItem {
+        int iNode;
+        double bound;
+    };
+    StackItem stack[MaxDepth];
+    int stackSize = 0;
+    double bestValue = std::numeric_limits<double>::max();
+    stack[stackSize++] = { 0, fnBoxBound(m_vecNode.front().box) };
+    while (stackSize > 0) {
+        const StackItem item = stack[--stackSize];
+        if (item.bound >= bestValue)
+            continue;
+
+        const Node& node = m_vecNode[item.iNode];
+        if (node.isLeaf()) {
+            for (int i = node.first; i < node.first + node.count; ++i)
+                bestValue = std::min(bestValue, fnItem(m_vecItem[i]));
+        }
+        else {
+            StackItem childA = { node.first, fnBoxBound(m_vecNode[node.first].box) };
+            StackItem childB = { node.first + 1, fnBoxBound(m_vecNode[node.first + 1].box) };
+            if (childA.bound < childB.bound)
+                std::swap(childA, childB);
+
+            // Nearest child is pushed last so it's visited first
+            if (childA.bound < bestValue)
+                stack[stackSize++] = childA;
+
+            if (childB.bound < bestValue)
+                stack[stackSize++] = childB;
+        }
+    }
+}
+
+} // namespace Mayo
@@ -0,0 +1,221 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "cpu_topology.h"
+
+#include <QtCore/QtGlobal>
+#include <vector>
+
+#if defined(Q_OS_WIN)
+#  include <windows.h>
+#elif defined(Q_OS_LINUX)
+#  include <pthread.h>
+#  include <sched.h>
+#  include <cstdio>
+#  include <cstdlib>
+#  include <string>
+#endif
+
+namespace Mayo {
+
+namespace {
+
+#if defined(Q_OS_WIN)
+
+// Processor group and mask of the CPUs of each NUMA node
+const std::vector<GROUP_AFFINITY>& numaNodeAffinities()
+{
+    static const std::vector<GROUP_AFFINITY> vecAffinity = []{
+        std::vector<GROUP_AFFINITY> vec;
+        ULONG highestNode = 0;
+        if (!GetNumaHighestNodeNumber(&highestNode))
+            return vec;
+
+        for (ULONG node = 0; node <= highestNode; ++node) {
+            GROUP_AFFINITY affinity = {};
+            if (GetNumaNodeProcessorMaskEx(USHORT(node), &affinity) && affinity.Mask != 0)
+                vec.push_back(affinity);
+        }
+
+        return vec;
+    }();
+    return vecAffinity;
+}
+
+#elif defined(Q_OS_LINUX)
+
+// Parses list of CPUs formatted like "0-7,16-23"
+std::vector<int> parseCpuList(const std::string& str)
+{
+    std::vector<int> vecCpu;
+    const char* it = str.c_str();
+    while (*it != '\0') {
+        char* itEnd = nullptr;
+        const long first = std::strtol(it, &itEnd, 10);
+        if (itEnd == it)
+            break;
+
+        long last = first;
+        it = itEnd;
+        if (*it == '-') {
+            last = std::strtol(it + 1, &itEnd, 10);
+            it = itEnd;
+        }
+
+        for (long cpu = first; cpu <= last; ++cpu)
+            vecCpu.push_back(int(cpu));
+
+        if (*it == ',')
+            ++it;
+        else
+            break;
+    }
+
+    return vecCpu;
+}
+
+// CPUs of each NUMA node, as exposed by sysfs
+const std::vector<std::vector<int>>& numaNodeCpus()
+{
+    static const std::vector<std::vector<int>> vecNodeCpus = []{
+        std::vector<std::vector<int>> vec;
+        for (int node = 0; ; ++node) {
+            const std::string path = "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist";
+            std::FILE* file = std::fopen(path.c_str(), "r");
+            if (!file)
+                break;
+
+            char buffer[1024] = {};
+            const bool ok = std::fgets(buffer, sizeof(buffer), file) != nullptr;
+            std::fclose(file);
+            std::vector<int> vecCpu = ok ? parseCpuList(buffer) : std::vector<int>{};
+            if (!vecCpu.empty())
+                vec.push_back(std::move(vecCpu));
+        }
+
+        return vec;
+    }();
+    return vecNodeCpus;
+}
+
+bool bindCurrentThread(const std::vector<int>& vecCpu)
+{
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    for (int cpu : vecCpu) {
+        if (cpu >= 0 && cpu < CPU_SETSIZE)
+            CPU_SET(cpu, &cpuSet);
+    }
+
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) == 0;
+}
+
+#endif
+
+} // namespace
+
+int CpuTopology::numaNodeCount()
+{
+#if defined(Q_OS_WIN)
+    const int nodeCount = int(numaNodeAffinities().size());
+#elif defined(Q_OS_LINUX)
+    const int nodeCount = int(numaNodeCpus().size());
+#else
+    const int nodeCount = 1;
+#endif
+    return nodeCount > 0 ? nodeCount : 1;
+}
+
+bool CpuTopology::bindCurrentThreadToNumaNode(int node)
+{
+#if defined(Q_OS_WIN)
+    const std::vector<GROUP_AFFINITY>& vecAffinity = numaNodeAffinities();
+    if (node < 0 || node >= int(vecAffinity.size()))
+        return false;
+
+    return SetThreadGroupAffinity(GetCurrentThread(), &vecAffinity.at(node), nullptr) != 0;
+#elif defined(Q_OS_LINUX)
+    const std::vector<std::vector<int>>& vecNodeCpus = numaNodeCpus();
+    if (node < 0 || node >= int(vecNodeCpus.size()))
+        return false;
+
+    return bindCurrentThread(vecNodeCpus.at(node));
+#else
+    Q_UNUSED(node);
+    return false;
+#endif
+}
+
+bool CpuTopology::bindCurrentThreadToCpu(int cpu)
+{
+#if defined(Q_OS_WIN)
+    // Logical CPUs are numbered across processor groups
+    const WORD groupCount = GetActiveProcessorGroupCount();
+    int cpuFirstInGroup = 0;
+    for (WORD group = 0; group < groupCount; ++group) {
+        const int groupCpuCount = int(GetActiveProcessorCount(group));
+        if (cpu >= cpuFirstInGroup && cpu < cpuFirstInGroup + groupCpuCount) {
+            GROUP_AFFINITY affinity = {};
+            affinity.Group = group;
+            affinity.Mask = KAFFINITY(1) << (cpu - cpuFirstInGroup);
+            return SetThreadGroupAffinity(GetCurrentThread(), &affinity, nullptr) != 0;
+        }
+
+        cpuFirstInGroup += groupCpuCount;
+    }
+
+    return false;
+#elif defined(Q_OS_LINUX)
+    return cpu >= 0 && bindCurrentThread({ cpu });
+#else
+    Q_UNUSED(cpu);
+    return false;
+#endif
+}
+
+int CpuTopology::currentThreadNumaNode()
+{
+#if defined(Q_OS_WIN)
+    GROUP_AFFINITY threadAffinity = {};
+    if (!GetThreadGroupAffinity(GetCurrentThread(), &threadAffinity))
+        return -1;
+
+    const std::vector<GROUP_AFFINITY>& vecAffinity = numaNodeAffinities();
+    for (const GROUP_AFFINITY& nodeAffinity : vecAffinity) {
+        if (nodeAffinity.Group == threadAffinity.Group
+                && (threadAffinity.Mask & ~nodeAffinity.Mask) == 0)
+        {
+            return int(&nodeAffinity - vecAffinity.data());
+        }
+    }
+
+    return -1;
+#elif defined(Q_OS_LINUX)
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    if (pthread_getaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) != 0)
+        return -1;
+
+    const std::vector<std::vector<int>>& vecNodeCpus = numaNodeCpus();
+    for (const std::vector<int>& vecCpu : vecNodeCpus) {
+        int nodeCpuSetCount = 0;
+        for (int cpu : vecCpu) {
+            if (cpu >= 0 && cpu < CPU_SETSIZE && CPU_ISSET(cpu, &cpuSet))
+                ++nodeCpuSetCount;
+        }
+
+        // Thread is bound to this node if all the CPUs it can run on belong to the node
+        if (nodeCpuSetCount > 0 && nodeCpuSetCount == CPU_COUNT(&cpuSet))
+            return int(&vecCpu - vecNodeCpus.data());
+    }
+
+    return -1;
+#else
+    return -1;
+#endif
+}
+
+} // namespace Mayo
@@ -0,0 +1,29 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+namespace Mayo {
+
+// CPU topology of the machine and binding of threads to CPUs
+// Used to keep the memory allocated by a thread(first-touch policy) local to a NUMA node on
+// multi-socket machines
+// Bindings are not supported on macOS, functions then return false or default values
+struct CpuTopology {
+    // Count of NUMA nodes, 1 if the machine isn't NUMA or topology isn't available
+    static int numaNodeCount();
+
+    // Binds the calling thread to the CPUs of NUMA node 'node' in [0, numaNodeCount()[
+    static bool bindCurrentThreadToNumaNode(int node);
+
+    // Binds the calling thread to logical CPU 'cpu' in [0, std::thread::hardware_concurrency()[
+    static bool bindCurrentThreadToCpu(int cpu);
+
+    // NUMA node the calling thread is bound to, -1 if it can run on CPUs of several nodes
+    static int currentThreadNumaNode();
+};
+
+} // namespace Mayo
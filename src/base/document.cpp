@@ -7,13 +7,52 @@
 #include "application.h"
 #include "caf_utils.h"
 #include "document.h"
+#include "profiler.h"
+#include "task_manager.h"
+#include "task_progress.h"
+#include "tkernel_utils.h"
+#include <BRepBuilderAPI_Transform.hxx>
+#include <BRep_Builder.hxx>
 #include <TDF_ChildIterator.hxx>
 #include <TDF_TagSource.hxx>
+#include <TNaming_Builder.hxx>
+#include <TopoDS_Compound.hxx>
+#include <TopoDS_Iterator.hxx>
 #include <XCAFDoc_DocumentTool.hxx>
+#include <XCAFDoc_Location.hxx>
+#include <XCAFDoc_ShapeMapTool.hxx>
+#include <gp.hxx>
+#include <algorithm>
+#include <functional>
 #include <set>
+#include <thread>
+#include <unordered_set>
 
 namespace Mayo {
 
+namespace {
+
+// Assembly trees of 'vecLabel' collected by concurrent tasks, each one exploring a range of labels
+std::vector<std::vector<XCaf::AssemblyTreeItem>> collectAssemblyTrees_concurrent(const std::vector<TDF_Label>& vecLabel)
+{
+    MAYO_PROFILE_ZONE("Document::collectAssemblyTrees");
+    std::vector<std::vector<XCaf::AssemblyTreeItem>> vecTree(vecLabel.size());
+    const int labelCount = int(vecLabel.size());
+    const int taskCount = std::min(labelCount, std::max(1, int(std::thread::hardware_concurrency())));
+    if (taskCount <= 0)
+        return vecTree;
+
+    TaskManager::runConcurrently(taskCount, nullptr, [&](int iTask, TaskProgress*) {
+        const int first = (iTask * labelCount) / taskCount;
+        const int last = ((iTask + 1) * labelCount) / taskCount;
+        for (int i = first; i < last; ++i)
+            vecTree.at(i) = XCaf::collectAssemblyTree(vecLabel.at(i));
+    });
+    return vecTree;
+}
+
+} // namespace
+
 Document::Document()
     : QObject(nullptr),
       TDocStd_Document(NameFormatBinary)
@@ -97,13 +136,22 @@ DocumentTreeNode Document::entityTreeNode(int index) const
     return { DocumentPtr(this), this->entityTreeNodeId(index) };
 }
 
-void Document::rebuildModelTree()
+TreeNodeId Document::findEntityTreeNodeId(const TDF_Label& label) const
 {
-    m_modelTree.clear();
+    auto it = m_mapEntityLabelTreeNode.find(label);
+    return it != m_mapEntityLabelTreeNode.cend() ? it->second : 0;
+}
+
+void Document::rebuildModelTree(bool concurrentBuild)
+{
+    MAYO_PROFILE_ZONE("Document::rebuildModelTree");
+    // Collect the top-level labels expected as entities
+    std::vector<TDF_Label> vecXCafLabel;
+    std::vector<TDF_Label> vecOtherLabel;
     const bool xcafIsNull = m_xcaf.isNull();
     if (!xcafIsNull) {
         for (const TDF_Label& label : m_xcaf.topLevelFreeShapes())
-            m_xcaf.deepBuildAssemblyTree(0, label);
+            vecXCafLabel.push_back(label);
     }
 
     constexpr bool allLevels = true;
@@ -112,9 +160,50 @@ void Document::rebuildModelTree()
         if (!CafUtils::isNullOrEmpty(childLabel)
                 && (xcafIsNull || childLabel != this->Main())) // Not XCAF Main label
         {
-            m_modelTree.appendChild(0, childLabel);
+            vecOtherLabel.push_back(childLabel);
         }
     }
+
+    // Remove entities whose label is no longer a top-level label
+    std::unordered_set<TDF_Label> setExpectedLabel;
+    setExpectedLabel.insert(vecXCafLabel.cbegin(), vecXCafLabel.cend());
+    setExpectedLabel.insert(vecOtherLabel.cbegin(), vecOtherLabel.cend());
+    std::vector<TreeNodeId> vecObsoleteEntityId;
+    for (TreeNodeId entityId : m_modelTree.roots()) {
+        if (setExpectedLabel.find(m_modelTree.nodeData(entityId)) == setExpectedLabel.cend())
+            vecObsoleteEntityId.push_back(entityId);
+    }
+
+    for (TreeNodeId entityId : vecObsoleteEntityId) {
+        emit this->entityAboutToBeDestroyed(entityId);
+        this->forgetEntityCaches(m_modelTree.nodeData(entityId), entityId);
+        m_mapEntityLabelTreeNode.erase(m_modelTree.nodeData(entityId));
+        m_modelTree.removeRoot(entityId);
+    }
+
+    // Add entities for the new top-level labels
+    auto fnAddEntity = [&](const TDF_Label& label, const std::function<TreeNodeId()>& fnBuild) {
+        if (m_mapEntityLabelTreeNode.find(label) == m_mapEntityLabelTreeNode.cend())
+            this->addEntity(label, fnBuild());
+    };
+    if (concurrentBuild) {
+        std::vector<TDF_Label> vecNewLabel;
+        for (const TDF_Label& label : vecXCafLabel) {
+            if (m_mapEntityLabelTreeNode.find(label) == m_mapEntityLabelTreeNode.cend())
+                vecNewLabel.push_back(label);
+        }
+
+        const auto vecTree = collectAssemblyTrees_concurrent(vecNewLabel);
+        for (size_t i = 0; i < vecNewLabel.size(); ++i)
+            fnAddEntity(vecNewLabel.at(i), [&]{ return m_xcaf.appendAssemblyTree(0, vecTree.at(i)); });
+    }
+    else {
+        for (const TDF_Label& label : vecXCafLabel)
+            fnAddEntity(label, [&]{ return m_xcaf.deepBuildAssemblyTree(0, label); });
+    }
+
+    for (const TDF_Label& label : vecOtherLabel)
+        fnAddEntity(label, [&]{ return m_modelTree.appendChild(0, label); });
 }
 
 DocumentPtr Document::findFrom(const TDF_Label& label)
@@ -134,19 +223,17 @@ TDF_Label Document::newEntityLabel()
 
 void Document::addEntityTreeNode(const TDF_Label& label)
 {
+    MAYO_PROFILE_ZONE("Document::addEntityTreeNode");
     // Check if 'label' belongs to current document
     if (Document::findFrom(label).get() != this)
         return;
 
     // Check if 'label' is not already there inside model tree
-    for (int i = 0; i < this->entityCount(); ++i) {
-        if (this->entityLabel(i) == label)
-            return;
-    }
+    if (this->findEntityTreeNodeId(label) != 0)
+        return;
 
     // TODO Allow custom population of the model tree for the new entity
-    const TreeNodeId nodeId = m_xcaf.deepBuildAssemblyTree(0, label);
-    emit this->entityAdded(nodeId);
+    this->addEntity(label, m_xcaf.deepBuildAssemblyTree(0, label));
 
 #if 0
     // Remove 'label'
@@ -155,6 +242,42 @@ void Document::addEntityTreeNode(const TDF_Label& label)
 #endif
 }
 
+void Document::addEntityTreeNodes(const TDF_LabelSequence& seqLabel, bool concurrentBuild)
+{
+    MAYO_PROFILE_ZONE("Document::addEntityTreeNodes");
+    if (!concurrentBuild) {
+        for (const TDF_Label& label : seqLabel)
+            this->addEntityTreeNode(label);
+
+        return;
+    }
+
+    // Same checks as addEntityTreeNode()
+    std::vector<TDF_Label> vecNewLabel;
+    std::unordered_set<TDF_Label> setNewLabel;
+    for (const TDF_Label& label : seqLabel) {
+        if (Document::findFrom(label).get() == this
+                && this->findEntityTreeNodeId(label) == 0
+                && setNewLabel.insert(label).second)
+        {
+            vecNewLabel.push_back(label);
+        }
+    }
+
+    // Model tree is modified sequentially, in the order of 'seqLabel'
+    const auto vecTree = collectAssemblyTrees_concurrent(vecNewLabel);
+    for (size_t i = 0; i < vecNewLabel.size(); ++i)
+        this->addEntity(vecNewLabel.at(i), m_xcaf.appendAssemblyTree(0, vecTree.at(i)));
+}
+
+void Document::addEntity(const TDF_Label& label, TreeNodeId nodeId)
+{
+    m_mapEntityLabelTreeNode.insert({ label, nodeId });
+    m_bvh.addEntity(label);
+    m_searchIndex.addEntity(m_modelTree, nodeId);
+    emit this->entityAdded(nodeId);
+}
+
 void Document::destroyEntity(TreeNodeId entityTreeNodeId)
 {
     Expects(this->modelTree().nodeIsRoot(entityTreeNodeId));
@@ -164,17 +287,336 @@ void Document::destroyEntity(TreeNodeId entityTreeNodeId)
         return;
 
     emit this->entityAboutToBeDestroyed(entityTreeNodeId);
+    this->forgetEntityCaches(entityLabel, entityTreeNodeId);
+    m_mapEntityLabelTreeNode.erase(entityLabel);
     entityLabel.ForgetAllAttributes();
     entityLabel.Nullify();
     m_modelTree.removeRoot(entityTreeNodeId);
 }
 
+void Document::forgetEntityCaches(const TDF_Label& entityLabel, TreeNodeId entityTreeNodeId)
+{
+    m_xcaf.invalidateShapeAbsoluteLocations(entityTreeNodeId);
+    m_bndBoxCache.forget(entityLabel);
+    m_subShapeCache.forget(entityLabel);
+    m_bvh.forget(entityLabel);
+    m_labelNameCache.forget(entityLabel);
+    m_styleCache.forget(entityLabel);
+    m_labelAttributesCache.forget(entityLabel);
+    m_searchIndex.forget(entityTreeNodeId);
+}
+
+void Document::setDeferredShape(const TDF_Label& label, ShapeLoader fnLoad)
+{
+    std::lock_guard<std::mutex> lock(m_mutexDeferredShape);
+    if (fnLoad)
+        m_mapDeferredShape.insert_or_assign(label, std::move(fnLoad));
+    else
+        m_mapDeferredShape.erase(label);
+}
+
+bool Document::hasDeferredShapes() const
+{
+    std::lock_guard<std::mutex> lock(m_mutexDeferredShape);
+    return !m_mapDeferredShape.empty();
+}
+
+bool Document::isShapeDeferred(const TDF_Label& label) const
+{
+    std::lock_guard<std::mutex> lock(m_mutexDeferredShape);
+    return m_mapDeferredShape.find(label) != m_mapDeferredShape.cend();
+}
+
+void Document::loadDeferredShapes(TreeNodeId nodeId, TaskProgress* progress)
+{
+    // Take the loaders out of the map, so a shared prototype is loaded only once
+    std::vector<std::pair<TDF_Label, ShapeLoader>> vecLoader;
+    {
+        std::lock_guard<std::mutex> lock(m_mutexDeferredShape);
+        if (m_mapDeferredShape.empty())
+            return;
+
+        traverseTree(nodeId, m_modelTree, [&](TreeNodeId id) {
+            auto it = m_mapDeferredShape.find(m_modelTree.nodeData(id));
+            if (it != m_mapDeferredShape.end()) {
+                vecLoader.emplace_back(it->first, std::move(it->second));
+                m_mapDeferredShape.erase(it);
+            }
+        });
+    }
+
+    if (vecLoader.empty())
+        return;
+
+    // Shapes are loaded first, then assigned to the labels with the lock held so concurrent calls
+    // don't modify the XCAF labels at the same time
+    std::vector<TopoDS_Shape> vecShape;
+    vecShape.reserve(vecLoader.size());
+    const double itemProgressSize = 100. / double(vecLoader.size());
+    for (const auto& [label, fnLoad] : vecLoader) {
+        TaskProgress loadProgress(progress, itemProgressSize);
+        vecShape.push_back(fnLoad(&loadProgress));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutexDeferredShape);
+        const Handle_XCAFDoc_ShapeTool shapeTool = m_xcaf.shapeTool();
+        for (size_t i = 0; i < vecLoader.size(); ++i) {
+            if (!vecShape.at(i).IsNull())
+                shapeTool->SetShape(vecLoader.at(i).first, vecShape.at(i));
+        }
+
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 4, 0)
+        // Compounds of the parent assemblies still refer to the placeholder shapes
+        shapeTool->UpdateAssemblies();
+#endif
+        // Snapshots of the labels hold the placeholder shapes
+        for (const auto& [label, fnLoad] : vecLoader)
+            m_labelAttributesCache.forget(label);
+
+        traverseTree(m_modelTree.nodeRoot(nodeId), m_modelTree, [&](TreeNodeId id) {
+            m_labelAttributesCache.forget(m_modelTree.nodeData(id));
+        });
+        m_bvh.addEntity(m_modelTree.nodeData(m_modelTree.nodeRoot(nodeId)));
+    }
+
+    emit this->deferredShapesLoaded(nodeId);
+}
+
+void Document::loadAllDeferredShapes(TaskProgress* progress)
+{
+    const int count = this->entityCount();
+    for (int i = 0; i < count && this->hasDeferredShapes(); ++i) {
+        TaskProgress entityProgress(progress, 100. / count);
+        this->loadDeferredShapes(this->entityTreeNodeId(i), &entityProgress);
+    }
+}
+
+int Document::unloadShapes(TreeNodeId entityTreeNodeId, const ShapeStore& fnStore)
+{
+    MAYO_PROFILE_ZONE("Document::unloadShapes");
+    Expects(m_modelTree.nodeIsRoot(entityTreeNodeId));
+
+    const TDF_Label entityLabel = m_modelTree.nodeData(entityTreeNodeId);
+    if (!XCaf::isShape(entityLabel))
+        return 0;
+
+    // Prototypes shared with other entities must stay resident
+    std::unordered_set<TDF_Label> setSharedProto;
+    for (const auto& [otherEntityLabel, otherTreeNodeId] : m_mapEntityLabelTreeNode) {
+        if (otherTreeNodeId != entityTreeNodeId && XCaf::isShape(otherEntityLabel)) {
+            for (const TDF_Label& protoLabel : XCaf::shapePrototypes(otherEntityLabel))
+                setSharedProto.insert(protoLabel);
+        }
+    }
+
+    auto fnPlaceholder = []{
+        TopoDS_Compound comp;
+        BRep_Builder().MakeCompound(comp);
+        return comp;
+    };
+
+    int unloadedCount = 0;
+    for (const TDF_Label& protoLabel : XCaf::shapePrototypes(entityLabel)) {
+        if (setSharedProto.find(protoLabel) != setSharedProto.cend() || this->isShapeDeferred(protoLabel))
+            continue;
+
+        const TopoDS_Shape shape = XCaf::shape(protoLabel);
+        if (shape.IsNull() || !TopoDS_Iterator(shape).More())
+            continue; // Nothing to release
+
+        ShapeLoader fnLoad = fnStore(protoLabel);
+        if (!fnLoad)
+            continue;
+
+        m_subShapeCache.forget(protoLabel);
+        m_bndBoxCache.forget(protoLabel);
+        m_styleCache.forget(protoLabel);
+        // XCAFDoc_ShapeTool::SetShape() is not used as it forgets the sub-shape labels which are not
+        // sub-shapes of the new shape
+        for (const TDF_Label& subLabel : XCaf::shapeSubs(protoLabel))
+            TNaming_Builder(subLabel).Generated(fnPlaceholder());
+
+        const TopoDS_Compound placeholder = fnPlaceholder();
+        TNaming_Builder(protoLabel).Generated(placeholder);
+        XCAFDoc_ShapeMapTool::Set(protoLabel)->SetShape(placeholder);
+        m_labelAttributesCache.forget(protoLabel); // Sub-shape labels included
+        this->setDeferredShape(protoLabel, std::move(fnLoad));
+        ++unloadedCount;
+    }
+
+    if (unloadedCount == 0)
+        return 0;
+
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 4, 0)
+    // Compounds of the assemblies and shapes of the components still refer to the released shapes
+    m_xcaf.shapeTool()->UpdateAssemblies();
+#endif
+    traverseTree(entityTreeNodeId, m_modelTree, [&](TreeNodeId id) {
+        m_labelAttributesCache.forget(m_modelTree.nodeData(id));
+    });
+    m_bvh.forget(entityLabel);
+    m_bvh.addEntity(entityLabel);
+    emit this->shapesUnloaded(entityTreeNodeId);
+    return unloadedCount;
+}
+
+void Document::setDeferredScaling(const TDF_Label& entityLabel, double factor)
+{
+    std::lock_guard<std::mutex> lock(m_mutexDeferredScaling);
+    if (factor > 0 && factor != 1.)
+        m_mapDeferredScaling.insert_or_assign(entityLabel, factor);
+    else
+        m_mapDeferredScaling.erase(entityLabel);
+}
+
+double Document::deferredScaling(const TDF_Label& entityLabel) const
+{
+    std::lock_guard<std::mutex> lock(m_mutexDeferredScaling);
+    auto it = m_mapDeferredScaling.find(entityLabel);
+    return it != m_mapDeferredScaling.cend() ? it->second : 1.;
+}
+
+bool Document::hasDeferredScalings() const
+{
+    std::lock_guard<std::mutex> lock(m_mutexDeferredScaling);
+    return !m_mapDeferredScaling.empty();
+}
+
+void Document::applyDeferredScalings(TaskProgress* progress)
+{
+    MAYO_PROFILE_ZONE("Document::applyDeferredScalings");
+    std::vector<std::pair<TDF_Label, double>> vecScaling;
+    {
+        std::lock_guard<std::mutex> lock(m_mutexDeferredScaling);
+        vecScaling.assign(m_mapDeferredScaling.cbegin(), m_mapDeferredScaling.cend());
+        m_mapDeferredScaling.clear();
+    }
+
+    if (vecScaling.empty())
+        return;
+
+    const Handle_XCAFDoc_ShapeTool shapeTool = m_xcaf.shapeTool();
+    std::unordered_set<TDF_Label> setLabelScaled;
+    // Scale is about the origin, so the rotation part of a location is kept and its translation
+    // part is just multiplied by the scale factor
+    std::function<void(const TDF_Label&, double)> fnScaleLabel;
+    fnScaleLabel = [&](const TDF_Label& label, double factor) {
+        if (!setLabelScaled.insert(label).second)
+            return;
+
+        if (XCaf::isShapeAssembly(label)) {
+            // Compound of the assembly is rebuilt from the components once they are scaled
+            BRep_Builder builder;
+            TopoDS_Compound comp;
+            builder.MakeCompound(comp);
+            for (const TDF_Label& compLabel : XCaf::shapeComponents(label)) {
+                const TDF_Label referredLabel = XCaf::shapeReferred(compLabel);
+                fnScaleLabel(referredLabel, factor);
+                gp_Trsf trsf = XCaf::shapeReferenceLocation(compLabel).Transformation();
+                trsf.SetTranslationPart(trsf.TranslationPart() * factor);
+                const TopLoc_Location loc(trsf);
+                const TopoDS_Shape compShape = XCaf::shape(referredLabel).Located(loc);
+                XCAFDoc_Location::Set(compLabel, loc);
+                TNaming_Builder(compLabel).Generated(compShape);
+                builder.Add(comp, compShape);
+                m_labelAttributesCache.forget(compLabel);
+            }
+
+            TNaming_Builder(label).Generated(comp);
+            XCAFDoc_ShapeMapTool::Set(label)->SetShape(comp);
+        }
+        else if (XCaf::isShapeSimple(label)) {
+            gp_Trsf trsfScale;
+            trsfScale.SetScale(gp::Origin(), factor);
+            const TopoDS_Shape shape = XCaf::shape(label);
+            m_subShapeCache.forget(shape);
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+            BRepBuilderAPI_Transform transform(shape, trsfScale, true/*copyGeom*/, true/*copyMesh*/);
+#else
+            BRepBuilderAPI_Transform transform(shape, trsfScale, true/*copyGeom*/);
+#endif
+            if (!transform.IsDone())
+                return;
+
+            // Sub-shape labels(ex: colored faces) have to refer to the scaled sub-shapes before
+            // SetShape() is called, otherwise they would be forgotten
+            for (const TDF_Label& subLabel : XCaf::shapeSubs(label)) {
+                TNaming_Builder(subLabel).Generated(transform.ModifiedShape(XCaf::shape(subLabel)));
+                m_labelAttributesCache.forget(subLabel);
+            }
+
+            shapeTool->SetShape(label, transform.Shape());
+        }
+
+        m_bndBoxCache.forget(label);
+        m_labelAttributesCache.forget(label);
+    };
+
+    for (const auto& [entityLabel, factor] : vecScaling) {
+        // Actual shapes have to be scaled, not placeholders
+        const TreeNodeId entityTreeNodeId = this->findEntityTreeNodeId(entityLabel);
+        if (entityTreeNodeId == 0)
+            continue;
+
+        this->loadDeferredShapes(entityTreeNodeId);
+        if (XCaf::isShape(entityLabel))
+            fnScaleLabel(entityLabel, factor);
+    }
+
+    for (const auto& [entityLabel, factor] : vecScaling) {
+        m_bvh.forget(entityLabel);
+        m_bvh.addEntity(entityLabel);
+    }
+
+    if (progress)
+        progress->setValue(100);
+
+    emit this->deferredScalingsApplied();
+}
+
 void Document::BeforeClose()
 {
     TDocStd_Document::BeforeClose();
+    m_labelNameCache.clear();
+    m_labelAttributesCache.clear();
+    m_searchIndex.clear();
     Application::instance()->notifyDocumentAboutToClose(m_identifier);
 }
 
+void Document::Delete() const
+{
+    if (m_fnLastReferenceDropped)
+        m_fnLastReferenceDropped();
+    else
+        TDocStd_Document::Delete();
+}
+
+void Document::releaseContents()
+{
+    m_bvh.clear();
+    m_searchIndex.clear();
+    m_styleCache.clear();
+    m_subShapeCache.clear();
+    m_bndBoxCache.clear();
+    m_labelAttributesCache.clear();
+    m_labelNameCache.clear();
+    m_modelTree.clear();
+    m_mapEntityLabelTreeNode.clear();
+    {
+        std::lock_guard<std::mutex> lock(m_mutexDeferredShape);
+        m_mapDeferredShape.clear();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutexDeferredScaling);
+        m_mapDeferredScaling.clear();
+    }
+
+    // Attributes hold the actual data(shapes, triangulations, names, ...), labels are just tags
+    this->GetData()->Root().ForgetAllAttributes(true/*clearChildren*/);
+}
+
 void Document::ChangeStorageFormat(const TCollection_ExtendedString& newStorageFormat)
 {
     // TODO: check format
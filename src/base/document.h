@@ -6,17 +6,29 @@
 
 #pragma once
 
+#include "bnd_box_cache.h"
+#include "document_bvh.h"
 #include "document_ptr.h"
+#include "document_search_index.h"
 #include "document_tree_node.h"
 #include "filepath.h"
+#include "label_attributes_cache.h"
+#include "label_name_cache.h"
 #include "libtree.h"
+#include "shape_style_cache.h"
+#include "sub_shape_cache.h"
 #include "xcaf.h"
 #include <QtCore/QObject>
+#include <TopoDS_Shape.hxx>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
 
 namespace Mayo {
 
 class Application;
 class DocumentTreeNode;
+class TaskProgress;
 
 class Document : public QObject, public TDocStd_Document {
     Q_OBJECT
@@ -47,36 +59,124 @@ public:
     XCaf& xcaf() { return m_xcaf; }
     const XCaf& xcaf() const { return m_xcaf; }
 
+    // Bounding boxes of the shapes, computed once per prototype
+    BndBoxCache& bndBoxCache() const { return m_bndBoxCache; }
+
+    // Indexed faces/edges/vertices of the shapes, computed once per prototype
+    SubShapeCache& subShapeCache() const { return m_subShapeCache; }
+
+    // Spatial index over the triangulations of the entities, for distance/picking/section queries
+    // Kept in sync with the entities of the document, indexing is done on first query
+    DocumentBvh& bvh() const { return m_bvh; }
+
+    // Names of the labels converted to QString, conversion is done once per name
+    LabelNameCache& labelNameCache() const { return m_labelNameCache; }
+
+    // Snapshots of the label attributes(name, color, layers, shape, reference), see
+    // LabelAttributesCache::forget() once attributes of a label are modified
+    LabelAttributesCache& labelAttributesCache() const { return m_labelAttributesCache; }
+
+    // Styles(colors) of the prototypes and of their faces, shared by the mesh exporters
+    ShapeStyleCache& styleCache() const { return m_styleCache; }
+
+    // Inverted index of the names and layers of the model tree nodes, for as-you-type search
+    // Kept in sync with the entities of the document, indexing is done on first query
+    DocumentSearchIndex& searchIndex() const { return m_searchIndex; }
+
     TDF_Label rootLabel() const;
     bool isEntity(TreeNodeId nodeId);
     int entityCount() const;
     TDF_Label entityLabel(int index) const;
     TreeNodeId entityTreeNodeId(int index) const;
     DocumentTreeNode entityTreeNode(int index) const;
+    // Returns the tree node of the entity having 'label', or null if 'label' isn't an entity
+    TreeNodeId findEntityTreeNodeId(const TDF_Label& label) const;
 
     const Tree<TDF_Label>& modelTree() const { return m_modelTree; }
-    void rebuildModelTree();
+    // Synchronizes the model tree with the top-level labels of the document
+    // Only changed top-level labels are concerned: entities whose label vanished are destroyed and
+    // new labels are added as entities, tree nodes of the other entities are kept as is
+    // With 'concurrentBuild' the assembly trees of the new entities are explored concurrently, see
+    // addEntityTreeNodes()
+    void rebuildModelTree(bool concurrentBuild = false);
 
     static DocumentPtr findFrom(const TDF_Label& label);
 
     TDF_Label newEntityLabel();
     void addEntityTreeNode(const TDF_Label& label);
+    // Same as calling addEntityTreeNode() for each label of 'seqLabel'
+    // With 'concurrentBuild' the assembly trees(read-only XCAF exploration) of the labels are
+    // collected by concurrent tasks, then appended into the model tree. Worth it for documents
+    // having thousands of entities
+    void addEntityTreeNodes(const TDF_LabelSequence& seqLabel, bool concurrentBuild = false);
     void destroyEntity(TreeNodeId entityTreeNodeId);
 
+    // -- Deferred shapes
+    // Placeholder shape labels(typically produced by a "structure only" read) whose actual shape is
+    // materialized on demand by calling 'fnLoad'
+    using ShapeLoader = std::function<TopoDS_Shape(TaskProgress*)>;
+    void setDeferredShape(const TDF_Label& label, ShapeLoader fnLoad);
+    bool hasDeferredShapes() const;
+    bool isShapeDeferred(const TDF_Label& label) const;
+
+    // Materializes the deferred shapes found in the model tree starting at 'nodeId'(deep traversal)
+    // Signal deferredShapesLoaded() is emitted(from the calling thread) if any shape was loaded
+    // Loaders are executed in the calling thread, then the XCAF labels are modified(SetShape(),
+    // UpdateAssemblies()) with a lock held, so concurrent calls are safe. But the other accesses to
+    // the document are not synchronized: must be called from the main thread, unless no other
+    // thread accesses the document meanwhile(eg export task)
+    void loadDeferredShapes(TreeNodeId nodeId, TaskProgress* progress = nullptr);
+    void loadAllDeferredShapes(TaskProgress* progress = nullptr);
+
+    // -- Unloaded shapes
+    // Function saving the shape of prototype 'protoLabel' and of its sub-shape labels somewhere(eg
+    // a file) then returning the loader restoring them. The loader has to assign the restored
+    // sub-shapes to the sub-shape labels before returning the prototype shape
+    // Returns an empty loader if the shapes can't be saved
+    using ShapeStore = std::function<ShapeLoader(const TDF_Label& protoLabel)>;
+
+    // Releases the prototype shapes of entity 'entityTreeNodeId'(geometry and triangulations): each
+    // prototype is saved with 'fnStore', then replaced by an empty placeholder registered as a
+    // deferred shape(see loadDeferredShapes()). Shapes of the sub-shape labels are replaced as well
+    // Prototypes also instantiated by another entity are kept, as well as prototypes already deferred
+    // Signal shapesUnloaded() is emitted if any prototype was released. Returns the count of them
+    int unloadShapes(TreeNodeId entityTreeNodeId, const ShapeStore& fnStore);
+
+    // -- Deferred scalings
+    // Uniform scale factor(typically a length unit conversion) of an entity not applied yet to its
+    // geometry: graphics display the entity scaled, while shapes are kept in the source units until
+    // applyDeferredScalings() is called(ex: before writing a file or measuring)
+    void setDeferredScaling(const TDF_Label& entityLabel, double factor);
+    double deferredScaling(const TDF_Label& entityLabel) const; // 1 if none
+    bool hasDeferredScalings() const;
+
+    // Scales the prototype shapes and the component locations of the entities having a deferred
+    // scaling. All entities are processed at once, as prototypes might be shared by several entities
+    // Can be called from any thread, signal deferredScalingsApplied() is emitted if any entity was scaled
+    void applyDeferredScalings(TaskProgress* progress = nullptr);
+
 signals:
     void nameChanged(const QString& name);
     void entityAdded(Mayo::TreeNodeId entityTreeNodeId);
     void entityAboutToBeDestroyed(Mayo::TreeNodeId entityTreeNodeId);
+    void deferredShapesLoaded(Mayo::TreeNodeId nodeId);
+    void shapesUnloaded(Mayo::TreeNodeId entityTreeNodeId);
+    void deferredScalingsApplied();
     //void itemPropertyChanged(DocumentItem* docItem, Property* prop);
 
 public: // -- from TDocStd_Document
     void BeforeClose() override;
     void ChangeStorageFormat(const TCollection_ExtendedString& newStorageFormat) override;
 
+    // -- from Standard_Transient
+    // Called once the last reference(handle) to the document is dropped
+    void Delete() const override;
+
     DEFINE_STANDARD_RTTI_INLINE(Document, TDocStd_Document)
 
 private:
     friend class Application;
+    friend class DocumentSnapshot;
     class FormatBinaryRetrievalDriver;
     class FormatXmlRetrievalDriver;
 
@@ -85,13 +185,35 @@ private:
 
     Document();
     void initXCaf();
+    // Registers 'nodeId' as the tree node of new entity 'label'
+    void addEntity(const TDF_Label& label, TreeNodeId nodeId);
+    // Drops the cached data of entity 'entityLabel' about to be removed from the model tree
+    void forgetEntityCaches(const TDF_Label& entityLabel, TreeNodeId entityTreeNodeId);
     void setIdentifier(Identifier ident) { m_identifier = ident; }
+    // Releases the OCAF labels and attributes, and the caches. Document must not be used afterwards
+    // apart from its destruction
+    void releaseContents();
 
     Identifier m_identifier = -1;
     QString m_name;
     FilePath m_filePath;
     XCaf m_xcaf;
+    mutable BndBoxCache m_bndBoxCache;
+    mutable SubShapeCache m_subShapeCache;
+    mutable DocumentBvh m_bvh{ &m_subShapeCache };
+    mutable LabelNameCache m_labelNameCache;
+    mutable LabelAttributesCache m_labelAttributesCache;
+    mutable ShapeStyleCache m_styleCache{ &m_subShapeCache, &m_labelAttributesCache };
+    mutable DocumentSearchIndex m_searchIndex{ &m_labelAttributesCache };
     Tree<TDF_Label> m_modelTree;
+    std::unordered_map<TDF_Label, TreeNodeId> m_mapEntityLabelTreeNode;
+    std::unordered_map<TDF_Label, ShapeLoader> m_mapDeferredShape;
+    mutable std::mutex m_mutexDeferredShape;
+    std::unordered_map<TDF_Label, double> m_mapDeferredScaling;
+    mutable std::mutex m_mutexDeferredScaling;
+    // If set, called by Delete() instead of destroying the document which is then owned by the
+    // function, see Application::closeDocumentAsync()
+    std::function<void()> m_fnLastReferenceDropped;
 };
 
 } // namespace Mayo
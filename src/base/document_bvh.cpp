@@ -0,0 +1,543 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "document_bvh.h"
+
+#include "brep_utils.h"
+#include "profiler.h"
+#include "sub_shape_cache.h"
+#include "task_manager.h"
+#include "task_progress.h"
+#include "xcaf.h"
+
+#include <BRep_Tool.hxx>
+#include <TDataXtd_Triangulation.hxx>
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace Mayo {
+
+namespace {
+
+// Minimum count of triangles processed by a task when computing triangle boxes
+constexpr int MinChunkSize = 1 << 16;
+
+int concurrentTaskCount(int itemCount, int minChunkSize)
+{
+    const int threadCount = std::max(1, int(std::thread::hardware_concurrency()));
+    return std::max(1, std::min(itemCount / minChunkSize, threadCount));
+}
+
+// Calls fnTask(iTask) for 'taskCount' tasks, concurrently if there are more than one
+template<typename FN>
+void runTasks(int taskCount, TaskProgress* progress, FN fnTask)
+{
+    if (taskCount > 1)
+        TaskManager::runConcurrently(taskCount, progress, [&](int iTask, TaskProgress*) { fnTask(iTask); });
+    else if (taskCount == 1)
+        fnTask(0);
+}
+
+std::shared_ptr<DocumentBvh::Mesh> buildMesh(const Handle_Poly_Triangulation& triangulation)
+{
+    const int triangleCount = triangulation->NbTriangles();
+    std::vector<Bvh::Box> vecTriangleBox(triangleCount);
+    const int taskCount = concurrentTaskCount(triangleCount, MinChunkSize);
+    runTasks(taskCount, nullptr, [&](int iTask) {
+        const auto first = int((int64_t(iTask) * triangleCount) / taskCount);
+        const auto last = int((int64_t(iTask + 1) * triangleCount) / taskCount);
+        for (int i = first; i < last; ++i) {
+            int n1, n2, n3;
+            triangulation->Triangle(i + 1).Get(n1, n2, n3);
+            Bvh::Box& box = vecTriangleBox[i];
+            box.add(triangulation->Node(n1));
+            box.add(triangulation->Node(n2));
+            box.add(triangulation->Node(n3));
+        }
+    });
+
+    auto mesh = std::make_shared<DocumentBvh::Mesh>();
+    mesh->triangulation = triangulation;
+    mesh->bvh = Bvh::build(vecTriangleBox);
+    return mesh;
+}
+
+Bvh::Box transformedBox(const Bvh::Box& box, const gp_Trsf& trsf)
+{
+    if (box.isVoid() || trsf.Form() == gp_Identity)
+        return box;
+
+    Bvh::Box trsfBox;
+    for (int i = 0; i < 8; ++i) {
+        const gp_Pnt corner(
+                    (i & 1) ? box.maxCorner[0] : box.minCorner[0],
+                    (i & 2) ? box.maxCorner[1] : box.minCorner[1],
+                    (i & 4) ? box.maxCorner[2] : box.minCorner[2]);
+        trsfBox.add(corner.Transformed(trsf));
+    }
+
+    return trsfBox;
+}
+
+bool boxesIntersect(const Bvh::Box& lhs, const Bvh::Box& rhs)
+{
+    for (int i = 0; i < 3; ++i) {
+        if (lhs.maxCorner[i] < rhs.minCorner[i] || rhs.maxCorner[i] < lhs.minCorner[i])
+            return false;
+    }
+
+    return true;
+}
+
+// Point of triangle(a, b, c) closest to 'p'
+// See "Real-Time Collision Detection" by Christer Ericson, section 5.1.5
+gp_XYZ closestPointOnTriangle(const gp_XYZ& p, const gp_XYZ& a, const gp_XYZ& b, const gp_XYZ& c)
+{
+    const gp_XYZ ab = b - a;
+    const gp_XYZ ac = c - a;
+    const gp_XYZ ap = p - a;
+    const double d1 = ab.Dot(ap);
+    const double d2 = ac.Dot(ap);
+    if (d1 <= 0. && d2 <= 0.)
+        return a;
+
+    const gp_XYZ bp = p - b;
+    const double d3 = ab.Dot(bp);
+    const double d4 = ac.Dot(bp);
+    if (d3 >= 0. && d4 <= d3)
+        return b;
+
+    const double vc = d1 * d4 - d3 * d2;
+    if (vc <= 0. && d1 >= 0. && d3 <= 0.)
+        return a + ab * (d1 / (d1 - d3));
+
+    const gp_XYZ cp = p - c;
+    const double d5 = ab.Dot(cp);
+    const double d6 = ac.Dot(cp);
+    if (d6 >= 0. && d5 <= d6)
+        return c;
+
+    const double vb = d5 * d2 - d1 * d6;
+    if (vb <= 0. && d2 >= 0. && d6 <= 0.)
+        return a + ac * (d2 / (d2 - d6));
+
+    const double va = d3 * d6 - d5 * d4;
+    if (va <= 0. && (d4 - d3) >= 0. && (d5 - d6) >= 0.)
+        return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+    const double denom = va + vb + vc;
+    if (!(std::abs(denom) > 0.)) // Degenerate triangle
+        return a;
+
+    return a + ab * (vb / denom) + ac * (vc / denom);
+}
+
+// Parameter of the intersection of line 'origin + t * dir' with triangle(a, b, c), both sides of
+// the triangle are considered. Returns false if there's no intersection
+// See Möller-Trumbore algorithm
+bool lineTriangleIntersection(
+        const gp_XYZ& origin, const gp_XYZ& dir, const gp_XYZ& a, const gp_XYZ& b, const gp_XYZ& c, double* t)
+{
+    const gp_XYZ edge1 = b - a;
+    const gp_XYZ edge2 = c - a;
+    const gp_XYZ pvec = dir.Crossed(edge2);
+    const double det = edge1.Dot(pvec);
+    if (std::abs(det) < 1e-300)
+        return false;
+
+    const double invDet = 1. / det;
+    const gp_XYZ tvec = origin - a;
+    const double u = tvec.Dot(pvec) * invDet;
+    if (u < 0. || u > 1.)
+        return false;
+
+    const gp_XYZ qvec = tvec.Crossed(edge1);
+    const double v = dir.Dot(qvec) * invDet;
+    if (v < 0. || u + v > 1.)
+        return false;
+
+    *t = edge2.Dot(qvec) * invDet;
+    return true;
+}
+
+} // namespace
+
+DocumentBvh::DocumentBvh(SubShapeCache* subShapeCache)
+    : m_subShapeCache(subShapeCache)
+{
+}
+
+void DocumentBvh::addEntity(const TDF_Label& entityLabel)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_vecPendingLabel.push_back(entityLabel);
+}
+
+void DocumentBvh::forget(const TDF_Label& entityLabel)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto itPending = std::remove(m_vecPendingLabel.begin(), m_vecPendingLabel.end(), entityLabel);
+    m_vecPendingLabel.erase(itPending, m_vecPendingLabel.end());
+    if (m_mapEntity.erase(entityLabel) > 0)
+        m_isTopLevelValid = false;
+}
+
+void DocumentBvh::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_mapEntity.clear();
+    m_vecPendingLabel.clear();
+    m_mapMesh.clear();
+    m_vecInstance.clear();
+    m_topBvh = {};
+    m_isTopLevelValid = true;
+}
+
+void DocumentBvh::update(TaskProgress* progress)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    this->updateImpl(progress);
+}
+
+Bvh::Box DocumentBvh::box()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    this->updateImpl(nullptr);
+    return m_topBvh.box();
+}
+
+DocumentBvh::Hit DocumentBvh::nearestPoint(const gp_Pnt& pnt, double maxDistance)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    this->updateImpl(nullptr);
+    Hit hit;
+    const double maxSqDistance = maxDistance < std::sqrt(Bvh::Box::Infinite) ? maxDistance * maxDistance : Bvh::Box::Infinite;
+    double bestSqDistance = maxSqDistance;
+    auto fnInstanceBound = [&](const Bvh::Box& box) {
+        const double sqDist = box.squareDistance(pnt);
+        return sqDist <= maxSqDistance ? sqDist : Bvh::Box::Infinite;
+    };
+    m_topBvh.traverseNearest(fnInstanceBound, [&](int iInstance) {
+        const InstancePtr& instance = m_vecInstance.at(iInstance);
+        const Poly_Triangulation* triangulation = instance->mesh->triangulation.get();
+        // Distances in mesh coordinates are scaled by the transformation
+        const double sqScale = instance->trsf.ScaleFactor() * instance->trsf.ScaleFactor();
+        const gp_Pnt localPnt = pnt.Transformed(instance->trsf.Inverted());
+        double bestLocalSqDistance = bestSqDistance / sqScale;
+        instance->mesh->bvh.traverseNearest(
+                    [&](const Bvh::Box& box) { return box.squareDistance(localPnt); },
+                    [&](int iTriangle) {
+            int n1, n2, n3;
+            triangulation->Triangle(iTriangle + 1).Get(n1, n2, n3);
+            const gp_XYZ closest = closestPointOnTriangle(
+                        localPnt.XYZ(),
+                        triangulation->Node(n1).XYZ(),
+                        triangulation->Node(n2).XYZ(),
+                        triangulation->Node(n3).XYZ());
+            const double sqDist = (closest - localPnt.XYZ()).SquareModulus();
+            if (sqDist < bestLocalSqDistance) {
+                bestLocalSqDistance = sqDist;
+                hit.instance = instance;
+                hit.triangleIndex = iTriangle + 1;
+                hit.point = gp_Pnt(closest).Transformed(instance->trsf);
+            }
+
+            return bestLocalSqDistance;
+        });
+
+        bestSqDistance = std::min(bestSqDistance, bestLocalSqDistance * sqScale);
+        return bestSqDistance;
+    });
+
+    if (hit.isValid())
+        hit.distance = std::sqrt(bestSqDistance);
+
+    return hit;
+}
+
+DocumentBvh::Hit DocumentBvh::raycast(const gp_Lin& ray, double maxDistance)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    this->updateImpl(nullptr);
+    Hit hit;
+    double bestDistance = maxDistance;
+    auto fnBoxBound = [](const Bvh::Box& box, const gp_Pnt& origin, const gp_Dir& dir, double maxT) {
+        double tMin, tMax;
+        if (!box.lineRange(origin, dir, &tMin, &tMax) || tMax < 0. || tMin > maxT)
+            return Bvh::Box::Infinite;
+
+        return std::max(0., tMin);
+    };
+    auto fnInstanceBound = [&](const Bvh::Box& box) {
+        return fnBoxBound(box, ray.Location(), ray.Direction(), maxDistance);
+    };
+    m_topBvh.traverseNearest(fnInstanceBound, [&](int iInstance) {
+        const InstancePtr& instance = m_vecInstance.at(iInstance);
+        const Poly_Triangulation* triangulation = instance->mesh->triangulation.get();
+        // Parameters along the ray in mesh coordinates are scaled by the transformation
+        const double scale = std::abs(instance->trsf.ScaleFactor());
+        const gp_Lin localRay = ray.Transformed(instance->trsf.Inverted());
+        const gp_XYZ& localOrigin = localRay.Location().XYZ();
+        const gp_XYZ& localDir = localRay.Direction().XYZ();
+        double bestLocalT = bestDistance / scale;
+        instance->mesh->bvh.traverseNearest(
+                    [&](const Bvh::Box& box) {
+                        return fnBoxBound(box, localRay.Location(), localRay.Direction(), bestLocalT);
+                    },
+                    [&](int iTriangle) {
+            int n1, n2, n3;
+            triangulation->Triangle(iTriangle + 1).Get(n1, n2, n3);
+            double t;
+            const bool intersects = lineTriangleIntersection(
+                        localOrigin, localDir,
+                        triangulation->Node(n1).XYZ(),
+                        triangulation->Node(n2).XYZ(),
+                        triangulation->Node(n3).XYZ(),
+                        &t);
+            if (intersects && t >= 0. && t < bestLocalT) {
+                bestLocalT = t;
+                hit.instance = instance;
+                hit.triangleIndex = iTriangle + 1;
+                hit.point = gp_Pnt(localOrigin + localDir * t).Transformed(instance->trsf);
+            }
+
+            return bestLocalT;
+        });
+
+        bestDistance = std::min(bestDistance, bestLocalT * scale);
+        return bestDistance;
+    });
+
+    if (hit.isValid())
+        hit.distance = bestDistance;
+
+    return hit;
+}
+
+std::vector<DocumentBvh::InstancePtr> DocumentBvh::instancesCrossing(const gp_Pln& plane)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    this->updateImpl(nullptr);
+    const gp_Dir& n = plane.Axis().Direction();
+    const double d = n.XYZ().Dot(plane.Location().XYZ());
+    std::vector<InstancePtr> vecInstance;
+    auto fnCrossesBox = [&](const Bvh::Box& box) {
+        double distMin, distMax;
+        box.planeRange(n, d, &distMin, &distMax);
+        return distMin <= 0. && distMax >= 0.;
+    };
+    m_topBvh.traverse(fnCrossesBox, [&](int iInstance) {
+        if (fnCrossesBox(m_vecInstance.at(iInstance)->box))
+            vecInstance.push_back(m_vecInstance.at(iInstance));
+    });
+    return vecInstance;
+}
+
+std::vector<DocumentBvh::InstancePtr> DocumentBvh::instancesIntersecting(const Bvh::Box& box)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    this->updateImpl(nullptr);
+    std::vector<InstancePtr> vecInstance;
+    auto fnIntersectsBox = [&](const Bvh::Box& nodeBox) { return boxesIntersect(nodeBox, box); };
+    m_topBvh.traverse(fnIntersectsBox, [&](int iInstance) {
+        if (fnIntersectsBox(m_vecInstance.at(iInstance)->box))
+            vecInstance.push_back(m_vecInstance.at(iInstance));
+    });
+    return vecInstance;
+}
+
+size_t DocumentBvh::memoryUsage()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t size = m_topBvh.memoryUsage();
+    size += m_vecInstance.capacity() * sizeof(InstancePtr) + m_vecInstance.size() * sizeof(Instance);
+    for (const auto& [triangulation, mesh] : m_mapMesh)
+        size += mesh->bvh.memoryUsage();
+
+    return size;
+}
+
+void DocumentBvh::updateImpl(TaskProgress* progress)
+{
+    // Entities to be indexed
+    std::vector<TDF_Label> vecLabel;
+    for (const TDF_Label& label : m_vecPendingLabel) {
+        if (std::find(vecLabel.cbegin(), vecLabel.cend(), label) == vecLabel.cend())
+            vecLabel.push_back(label);
+    }
+
+    m_vecPendingLabel.clear();
+    for (const auto& [label, entity] : m_mapEntity) {
+        if (std::find(vecLabel.cbegin(), vecLabel.cend(), label) == vecLabel.cend()
+                && this->needsUpdate(label, entity))
+        {
+            vecLabel.push_back(label);
+        }
+    }
+
+    if (vecLabel.empty()) {
+        if (!m_isTopLevelValid)
+            this->rebuildTopLevel();
+
+        return;
+    }
+
+    MAYO_PROFILE_ZONE("DocumentBvh::update");
+    // Instances are gathered sequentially(OCAF data and BRep shapes), then the triangles of the new
+    // triangulations are indexed concurrently
+    std::vector<std::pair<TDF_Label, Entity>> vecEntity;
+    std::vector<Handle_Poly_Triangulation> vecNewTriangulation;
+    for (const TDF_Label& label : vecLabel) {
+        Entity entity = this->createEntity(label);
+        for (const InstancePtr& instance : entity.vecInstance) {
+            const Handle_Poly_Triangulation& triangulation = instance->mesh->triangulation;
+            if (m_mapMesh.find(triangulation.get()) == m_mapMesh.cend()) {
+                m_mapMesh.insert({ triangulation.get(), nullptr });
+                vecNewTriangulation.push_back(triangulation);
+            }
+        }
+
+        vecEntity.emplace_back(label, std::move(entity));
+    }
+
+    // Triangulations are split between tasks, big ones are also indexed concurrently by Bvh::build()
+    const int meshCount = int(vecNewTriangulation.size());
+    std::vector<std::shared_ptr<const Mesh>> vecNewMesh(meshCount);
+    const int taskCount = std::min(meshCount, std::max(1, int(std::thread::hardware_concurrency())));
+    runTasks(taskCount, progress, [&](int iTask) {
+        for (int i = (iTask * meshCount) / taskCount; i < ((iTask + 1) * meshCount) / taskCount; ++i)
+            vecNewMesh.at(i) = buildMesh(vecNewTriangulation.at(i));
+    });
+
+    for (int i = 0; i < meshCount; ++i)
+        m_mapMesh[vecNewTriangulation.at(i).get()] = vecNewMesh.at(i);
+
+    // Instances created by createEntity() refer to a placeholder Mesh, now replaced by the indexed one
+    for (auto& [label, entity] : vecEntity) {
+        for (InstancePtr& ptrInstance : entity.vecInstance) {
+            auto instance = std::make_shared<Instance>(*ptrInstance);
+            instance->mesh = m_mapMesh.at(instance->mesh->triangulation.get());
+            instance->box = transformedBox(instance->mesh->bvh.box(), instance->trsf);
+            ptrInstance = std::move(instance);
+        }
+
+        m_mapEntity.insert_or_assign(label, std::move(entity));
+    }
+
+    this->rebuildTopLevel();
+}
+
+bool DocumentBvh::needsUpdate(const TDF_Label& entityLabel, const Entity& entity) const
+{
+    if (entity.isShape) {
+        const TopoDS_Shape shape = XCaf::shape(entityLabel);
+        if (!shape.IsSame(entity.shape))
+            return true;
+
+        if (entity.isComplete)
+            return false;
+
+        // Some faces were meshed since entity was indexed?
+        size_t meshedFaceCount = 0;
+        this->forEachEntityFace(entityLabel, [&](const TopoDS_Face& face) {
+            TopLoc_Location loc;
+            const Handle_Poly_Triangulation& triangulation = BRep_Tool::Triangulation(face, loc);
+            if (!triangulation.IsNull() && triangulation->NbTriangles() > 0)
+                ++meshedFaceCount;
+        });
+        return meshedFaceCount != entity.vecInstance.size();
+    }
+
+    auto attrTriangulation = CafUtils::findAttribute<TDataXtd_Triangulation>(entityLabel);
+    return attrTriangulation.IsNull() || attrTriangulation->Get() != entity.triangulation;
+}
+
+DocumentBvh::Entity DocumentBvh::createEntity(const TDF_Label& entityLabel) const
+{
+    Entity entity;
+    entity.isComplete = true;
+    auto fnAddInstance = [&](const Handle_Poly_Triangulation& triangulation, const TopoDS_Face& face, const gp_Trsf& trsf) {
+        // Mesh is a placeholder just holding the triangulation, see updateImpl()
+        auto it = m_mapMesh.find(triangulation.get());
+        auto instance = std::make_shared<Instance>();
+        instance->entityLabel = entityLabel;
+        instance->face = face;
+        instance->trsf = trsf;
+        if (it != m_mapMesh.cend() && it->second) {
+            instance->mesh = it->second;
+        }
+        else {
+            auto mesh = std::make_shared<Mesh>();
+            mesh->triangulation = triangulation;
+            instance->mesh = mesh;
+        }
+
+        entity.vecInstance.push_back(instance);
+    };
+
+    entity.isShape = XCaf::isShape(entityLabel);
+    if (entity.isShape) {
+        entity.shape = XCaf::shape(entityLabel);
+        this->forEachEntityFace(entityLabel, [&](const TopoDS_Face& face) {
+            TopLoc_Location loc;
+            const Handle_Poly_Triangulation& triangulation = BRep_Tool::Triangulation(face, loc);
+            if (!triangulation.IsNull() && triangulation->NbTriangles() > 0)
+                fnAddInstance(triangulation, face, loc.Transformation());
+            else
+                entity.isComplete = false;
+        });
+    }
+    else {
+        auto attrTriangulation = CafUtils::findAttribute<TDataXtd_Triangulation>(entityLabel);
+        if (!attrTriangulation.IsNull()) {
+            entity.triangulation = attrTriangulation->Get();
+            if (!entity.triangulation.IsNull() && entity.triangulation->NbTriangles() > 0)
+                fnAddInstance(entity.triangulation, TopoDS_Face(), gp_Trsf());
+        }
+    }
+
+    return entity;
+}
+
+void DocumentBvh::forEachEntityFace(
+        const TDF_Label& entityLabel, const std::function<void(const TopoDS_Face&)>& fn) const
+{
+    if (m_subShapeCache) {
+        // Triangulation presence flags are ignored, faces might have been meshed since indexing
+        m_subShapeCache->forEachLabelFace(entityLabel, TopLoc_Location(), [&](const TopoDS_Face& face, bool) {
+            fn(face);
+        });
+    }
+    else {
+        BRepUtils::forEachSubFace(XCaf::shape(entityLabel), fn);
+    }
+}
+
+void DocumentBvh::rebuildTopLevel()
+{
+    m_vecInstance.clear();
+    for (const auto& [label, entity] : m_mapEntity)
+        m_vecInstance.insert(m_vecInstance.end(), entity.vecInstance.cbegin(), entity.vecInstance.cend());
+
+    std::vector<Bvh::Box> vecInstanceBox;
+    vecInstanceBox.reserve(m_vecInstance.size());
+    for (const InstancePtr& instance : m_vecInstance)
+        vecInstanceBox.push_back(instance->box);
+
+    m_topBvh = Bvh::build(vecInstanceBox);
+    m_isTopLevelValid = true;
+
+    // Drop the meshes not used anymore by any instance
+    for (auto it = m_mapMesh.begin(); it != m_mapMesh.end();) {
+        if (it->second.use_count() <= 1)
+            it = m_mapMesh.erase(it);
+        else
+            ++it;
+    }
+}
+
+} // namespace Mayo
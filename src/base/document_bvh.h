@@ -0,0 +1,158 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "bvh.h"
+#include "caf_utils.h"
+
+#include <Poly_Triangulation.hxx>
+#include <TDF_Label.hxx>
+#include <TopoDS_Face.hxx>
+#include <TopoDS_Shape.hxx>
+#include <gp_Lin.hxx>
+#include <gp_Pln.hxx>
+#include <gp_Trsf.hxx>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace Mayo {
+
+class SubShapeCache;
+class TaskProgress;
+
+// Spatial index over the triangulations of the entities of a document, for measurement, picking
+// and section queries
+// Two levels of hierarchy: a Bvh over the triangles of each triangulation(built once per
+// Poly_Triangulation object, so shared by all the instances of a shape), and a top-level Bvh over
+// the located instances of the triangulations
+// Triangulations are the ones of the faces of XCAF shapes(faces not meshed are ignored) and the
+// TDataXtd_Triangulation attributes of mesh entities
+// Entities are indexed lazily: addEntity() and forget() only record changes, the index is updated
+// by the next call to update() or to a query function. Triangles of new triangulations are
+// indexed concurrently
+// All functions are thread-safe
+class DocumentBvh {
+public:
+    // Faces of XCAF shapes are queried from 'subShapeCache' if not null, so the faces of a prototype
+    // instantiated many times are explored once
+    DocumentBvh(SubShapeCache* subShapeCache = nullptr);
+
+    // Index of the triangles of a triangulation, in its own coordinate system
+    struct Mesh {
+        Handle_Poly_Triangulation triangulation;
+        Bvh bvh; // Items are triangle indexes minus one
+    };
+
+    // Instance of a Mesh in the document, items of the top-level Bvh
+    struct Instance {
+        TDF_Label entityLabel;
+        TopoDS_Face face; // Null for mesh entities
+        gp_Trsf trsf; // Transformation from Mesh coordinates to document coordinates
+        std::shared_ptr<const Mesh> mesh;
+        Bvh::Box box; // Bounding box in document coordinates
+    };
+
+    using InstancePtr = std::shared_ptr<const Instance>;
+
+    struct Hit {
+        InstancePtr instance; // Null if no triangle was found
+        int triangleIndex = 0; // Index in Instance::mesh::triangulation, 1-based
+        gp_Pnt point; // Document coordinates
+        double distance = std::numeric_limits<double>::max();
+
+        bool isValid() const { return this->instance != nullptr; }
+    };
+
+    // Records that 'entityLabel' has to be indexed, or indexed again if it was already
+    void addEntity(const TDF_Label& entityLabel);
+    // Removes 'entityLabel' from index, to be called before the entity is destroyed
+    void forget(const TDF_Label& entityLabel);
+    void clear();
+
+    // Indexes the entities added or changed since last update, the ones whose shape was replaced
+    // or having faces not meshed when last indexed are checked again
+    void update(TaskProgress* progress = nullptr);
+
+    // Bounding box of all the indexed triangles
+    Bvh::Box box();
+
+    // Point of the triangulations closest to 'pnt', within 'maxDistance'
+    Hit nearestPoint(const gp_Pnt& pnt, double maxDistance = std::numeric_limits<double>::max());
+    // First triangle crossed by 'ray'(only points after the ray origin are considered)
+    Hit raycast(const gp_Lin& ray, double maxDistance = std::numeric_limits<double>::max());
+    // Instances whose bounding box crosses 'plane'
+    std::vector<InstancePtr> instancesCrossing(const gp_Pln& plane);
+    // Instances whose bounding box intersects 'box'
+    std::vector<InstancePtr> instancesIntersecting(const Bvh::Box& box);
+
+    // Calls fn(int iTriangle) for the triangles of 'mesh' crossing 'localPlane', which is expressed
+    // in mesh coordinates. 'iTriangle' is 1-based
+    template<typename FN>
+    static void forEachTriangleCrossing(const Mesh& mesh, const gp_Pln& localPlane, FN fn);
+
+    // Estimated memory used by the index
+    size_t memoryUsage();
+
+private:
+    struct Entity {
+        bool isShape = false; // XCAF shape, otherwise mesh entity
+        TopoDS_Shape shape; // Shape of the entity when it was indexed
+        Handle_Poly_Triangulation triangulation; // Mesh entities only
+        bool isComplete = false; // False if some faces weren't meshed
+        std::vector<InstancePtr> vecInstance;
+    };
+
+    void updateImpl(TaskProgress* progress);
+    bool needsUpdate(const TDF_Label& entityLabel, const Entity& entity) const;
+    Entity createEntity(const TDF_Label& entityLabel) const;
+    void rebuildTopLevel();
+    void forEachEntityFace(const TDF_Label& entityLabel, const std::function<void(const TopoDS_Face&)>& fn) const;
+
+    SubShapeCache* m_subShapeCache = nullptr;
+
+    std::mutex m_mutex;
+    std::unordered_map<TDF_Label, Entity> m_mapEntity;
+    std::vector<TDF_Label> m_vecPendingLabel;
+    std::unordered_map<const Poly_Triangulation*, std::shared_ptr<const Mesh>> m_mapMesh;
+    std::vector<InstancePtr> m_vecInstance; // Items of m_topBvh
+    Bvh m_topBvh;
+    bool m_isTopLevelValid = true;
+};
+
+
+
+// --
+// -- Implementation
+// --
+
+template<typename FN>
+void DocumentBvh::forEachTriangleCrossing(const Mesh& mesh, const gp_Pln& localPlane, FN fn)
+{
+    const gp_Dir& n = localPlane.Axis().Direction();
+    const double d = n.XYZ().Dot(localPlane.Location().XYZ());
+    auto fnCrossesBox = [&](const Bvh::Box& box) {
+        double distMin, distMax;
+        box.planeRange(n, d, &distMin, &distMax);
+        return distMin <= 0. && distMax >= 0.;
+    };
+    const Poly_Triangulation* triangulation = mesh.triangulation.get();
+    mesh.bvh.traverse(fnCrossesBox, [&](int iItem) {
+        int n1, n2, n3;
+        triangulation->Triangle(iItem + 1).Get(n1, n2, n3);
+        const double d1 = n.XYZ().Dot(triangulation->Node(n1).XYZ()) - d;
+        const double d2 = n.XYZ().Dot(triangulation->Node(n2).XYZ()) - d;
+        const double d3 = n.XYZ().Dot(triangulation->Node(n3).XYZ()) - d;
+        if (std::min({ d1, d2, d3 }) <= 0. && std::max({ d1, d2, d3 }) >= 0.)
+            fn(iItem + 1);
+    });
+}
+
+} // namespace Mayo
@@ -0,0 +1,265 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "document_diff.h"
+
+#include "bnd_box_cache.h"
+#include "brep_mass_properties.h"
+#include "caf_utils.h"
+#include "document.h"
+#include "mesh_utils.h"
+#include "profiler.h"
+#include "qtcore_hfuncs.h"
+#include "shape_deduplication.h"
+#include "string_conv.h"
+#include "task_manager.h"
+#include "task_progress.h"
+
+#include <QtCore/QStringList>
+#include <BRep_Builder.hxx>
+#include <Bnd_Box.hxx>
+#include <TDataXtd_Triangulation.hxx>
+#include <TopoDS_Face.hxx>
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+
+namespace Mayo {
+
+namespace {
+
+struct Part {
+    QString path;
+    TreeNodeId nodeId = 0; // Instance node
+    TDF_Label labelPrototype; // Leaf label
+    TopLoc_Location location; // Absolute
+};
+
+// Geometry properties of a leaf label, independent of the instance location
+struct PrototypeProperties {
+    QByteArray hash;
+    double volume = 0;
+    Bnd_Box bndBox;
+};
+
+// Parts of the document, duplicate paths(eg unnamed components) are numbered in order of occurrence
+std::vector<Part> documentParts(const DocumentPtr& doc)
+{
+    const Tree<TDF_Label>& modelTree = doc->modelTree();
+    std::vector<Part> vecPart;
+    std::unordered_map<QString, int> mapPathCount;
+    traverseTree(modelTree, [&](TreeNodeId id) {
+        if (!modelTree.nodeIsLeaf(id))
+            return;
+
+        QStringList listName;
+        for (TreeNodeId itId = id; itId != 0; itId = modelTree.nodeParent(itId)) {
+            const auto attrs = doc->labelAttributesCache().attributes(modelTree.nodeData(itId));
+            listName.prepend(to_QString(attrs->name));
+            if (modelTree.nodeIsRoot(itId))
+                break;
+        }
+
+        Part part;
+        part.path = listName.join('/');
+        const int pathCount = ++mapPathCount[part.path];
+        if (pathCount > 1)
+            part.path += QString("#%1").arg(pathCount);
+
+        const TreeNodeId parentId = !modelTree.nodeIsRoot(id) ? modelTree.nodeParent(id) : 0;
+        const bool isComponent = parentId != 0 && XCaf::isShapeReference(modelTree.nodeData(parentId));
+        part.nodeId = isComponent ? parentId : id;
+        part.labelPrototype = modelTree.nodeData(id);
+        part.location = doc->xcaf().shapeAbsoluteLocation(id);
+        vecPart.push_back(std::move(part));
+    });
+
+    return vecPart;
+}
+
+PrototypeProperties prototypeProperties(const TDF_Label& label, double precision)
+{
+    PrototypeProperties props;
+    if (XCaf::isShape(label)) {
+        const TopoDS_Shape shape = XCaf::shape(label);
+        props.hash = ShapeDeduplication::geometryHash(shape, precision);
+        props.volume = BRepMassProperties::compute(shape, BRepMassProperties::Mode::Triangulation).volume;
+        props.bndBox = BndBoxCache::shapeBox(shape);
+    }
+    else if (auto attrTriangulation = CafUtils::findAttribute<TDataXtd_Triangulation>(label)) {
+        // Mesh entity, triangulation is hashed as the one of a face without surface
+        const Handle_Poly_Triangulation& triangulation = attrTriangulation->Get();
+        TopoDS_Face face;
+        BRep_Builder().MakeFace(face, triangulation);
+        props.hash = ShapeDeduplication::geometryHash(face, precision);
+        props.volume = MeshUtils::triangulationVolume(triangulation);
+        for (int i = 1; i <= triangulation->NbNodes(); ++i)
+            props.bndBox.Add(triangulation->Node(i));
+    }
+
+    return props;
+}
+
+bool isSameLocation(const TopLoc_Location& lhs, const TopLoc_Location& rhs, double precision)
+{
+    const gp_Trsf trsfLhs = lhs.Transformation();
+    const gp_Trsf trsfRhs = rhs.Transformation();
+    if (trsfLhs.TranslationPart().Distance(trsfRhs.TranslationPart()) > precision)
+        return false;
+
+    for (int row = 1; row <= 3; ++row) {
+        for (int col = 1; col <= 3; ++col) {
+            if (std::abs(trsfLhs.Value(row, col) - trsfRhs.Value(row, col)) > Precision::Angular())
+                return false;
+        }
+    }
+
+    return true;
+}
+
+double bndBoxDelta(const Bnd_Box& lhs, const Bnd_Box& rhs)
+{
+    if (lhs.IsVoid() || rhs.IsVoid())
+        return 0;
+
+    return std::max(lhs.CornerMin().Distance(rhs.CornerMin()), lhs.CornerMax().Distance(rhs.CornerMax()));
+}
+
+} // namespace
+
+bool DocumentDiff::Report::hasDifferences() const
+{
+    return this->movedCount != 0 || this->modifiedCount != 0 || this->addedCount != 0 || this->removedCount != 0;
+}
+
+DocumentDiff::Report DocumentDiff::compare(
+        const DocumentPtr& docReference,
+        const DocumentPtr& docCompared,
+        const ItemsCompared& fnItemsCompared,
+        const Options& options,
+        TaskProgress* progress)
+{
+    MAYO_PROFILE_ZONE("DocumentDiff::compare");
+    Report report;
+    {
+        TaskProgress loadProgress(progress, 10);
+        docReference->loadAllDeferredShapes(&loadProgress);
+        docCompared->loadAllDeferredShapes(&loadProgress);
+    }
+
+    std::vector<Item> vecItem;
+    auto fnReportItems = [&]{
+        for (const Item& item : vecItem) {
+            switch (item.status) {
+            case Status::Unchanged: ++report.unchangedCount; break;
+            case Status::Moved: ++report.movedCount; break;
+            case Status::Modified: ++report.modifiedCount; break;
+            case Status::Added: ++report.addedCount; break;
+            case Status::Removed: ++report.removedCount; break;
+            }
+        }
+
+        if (fnItemsCompared && !vecItem.empty())
+            fnItemsCompared(vecItem);
+
+        vecItem.clear();
+    };
+
+    // Match parts by path, unmatched parts are reported right away
+    const std::vector<Part> vecPartReference = documentParts(docReference);
+    const std::vector<Part> vecPartCompared = documentParts(docCompared);
+    std::unordered_map<QString, const Part*> mapPathPartCompared;
+    for (const Part& part : vecPartCompared)
+        mapPathPartCompared.insert({ part.path, &part });
+
+    std::vector<std::pair<const Part*, const Part*>> vecMatch;
+    for (const Part& part : vecPartReference) {
+        auto itMatch = mapPathPartCompared.find(part.path);
+        if (itMatch != mapPathPartCompared.end()) {
+            vecMatch.push_back({ &part, itMatch->second });
+            mapPathPartCompared.erase(itMatch);
+        }
+        else {
+            Item item;
+            item.status = Status::Removed;
+            item.path = part.path;
+            item.nodeIdReference = part.nodeId;
+            vecItem.push_back(std::move(item));
+        }
+    }
+
+    fnReportItems();
+
+    for (const Part& part : vecPartCompared) {
+        if (mapPathPartCompared.find(part.path) != mapPathPartCompared.end()) {
+            Item item;
+            item.status = Status::Added;
+            item.path = part.path;
+            item.nodeIdCompared = part.nodeId;
+            vecItem.push_back(std::move(item));
+        }
+    }
+
+    fnReportItems();
+
+    // Compare matched parts batch after batch, properties of the prototypes not met yet are
+    // computed concurrently. Prototypes instantiated many times are processed once
+    std::unordered_map<TDF_Label, PrototypeProperties> mapPrototypeProps;
+    const int batchSize = std::max(1, options.batchSize);
+    const double batchPortionSize = !vecMatch.empty() ? 90. * batchSize / vecMatch.size() : 0.;
+    for (size_t iBatchStart = 0; iBatchStart < vecMatch.size(); iBatchStart += batchSize) {
+        const size_t iBatchEnd = std::min(vecMatch.size(), iBatchStart + batchSize);
+        std::vector<TDF_Label> vecPrototype;
+        for (size_t i = iBatchStart; i < iBatchEnd; ++i) {
+            for (const Part* part : { vecMatch.at(i).first, vecMatch.at(i).second }) {
+                if (mapPrototypeProps.insert({ part->labelPrototype, {} }).second)
+                    vecPrototype.push_back(part->labelPrototype);
+            }
+        }
+
+        std::vector<PrototypeProperties> vecProps(vecPrototype.size());
+        TaskProgress batchProgress(progress, std::min(batchPortionSize, 90.));
+        const bool okBatch = TaskManager::runConcurrently(
+                    int(vecPrototype.size()), &batchProgress, [&](int i, TaskProgress*) {
+            vecProps.at(i) = prototypeProperties(vecPrototype.at(i), options.precision);
+        });
+        if (!okBatch)
+            return report;
+
+        for (size_t i = 0; i < vecPrototype.size(); ++i)
+            mapPrototypeProps.at(vecPrototype.at(i)) = std::move(vecProps.at(i));
+
+        for (size_t i = iBatchStart; i < iBatchEnd; ++i) {
+            const Part* partReference = vecMatch.at(i).first;
+            const Part* partCompared = vecMatch.at(i).second;
+            const PrototypeProperties& propsReference = mapPrototypeProps.at(partReference->labelPrototype);
+            const PrototypeProperties& propsCompared = mapPrototypeProps.at(partCompared->labelPrototype);
+            Item item;
+            item.path = partReference->path;
+            item.nodeIdReference = partReference->nodeId;
+            item.nodeIdCompared = partCompared->nodeId;
+            item.volumeDelta = propsCompared.volume - propsReference.volume;
+            item.bndBoxDelta = bndBoxDelta(
+                        propsReference.bndBox.Transformed(partReference->location.Transformation()),
+                        propsCompared.bndBox.Transformed(partCompared->location.Transformation()));
+            if (propsReference.hash != propsCompared.hash)
+                item.status = Status::Modified;
+            else if (!isSameLocation(partReference->location, partCompared->location, options.precision))
+                item.status = Status::Moved;
+            else
+                item.status = Status::Unchanged;
+
+            vecItem.push_back(std::move(item));
+        }
+
+        fnReportItems();
+    }
+
+    return report;
+}
+
+} // namespace Mayo
@@ -0,0 +1,75 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "document_ptr.h"
+#include "libtree.h"
+#include "span.h"
+
+#include <QtCore/QString>
+#include <Precision.hxx>
+#include <functional>
+
+namespace Mayo {
+
+class TaskProgress;
+
+// Geometric comparison of two documents, typically two revisions of the same assembly
+// Parts(leaf nodes of the model trees) are matched by path, ie the names of the nodes from the
+// entity root. Geometry of matched parts is compared with ShapeDeduplication::geometryHash(), then
+// volumes and bounding boxes provide the magnitude of the changes
+struct DocumentDiff {
+    enum class Status {
+        Unchanged,
+        Moved, // Same geometry, distinct location
+        Modified, // Distinct geometry
+        Added, // Part found in the compared document only
+        Removed // Part found in the reference document only
+    };
+
+    struct Item {
+        Status status = Status::Unchanged;
+        QString path; // Names of the nodes from the entity root separated with '/'
+        // Instance nodes of the part, ie the component(reference) node or the leaf node itself
+        // Null if the part is missing in the document
+        TreeNodeId nodeIdReference = 0;
+        TreeNodeId nodeIdCompared = 0;
+        double volumeDelta = 0; // Volume in compared document minus volume in reference document
+        double bndBoxDelta = 0; // Greatest distance between the corners of the located boxes
+    };
+
+    struct Options {
+        double precision = Precision::Confusion(); // Tolerance on geometry and locations
+        // Count of matched parts compared concurrently per batch, items are reported once their
+        // batch is finished so first results come quickly for big assemblies
+        int batchSize = 256;
+    };
+
+    struct Report {
+        int unchangedCount = 0;
+        int movedCount = 0;
+        int modifiedCount = 0;
+        int addedCount = 0;
+        int removedCount = 0;
+
+        bool hasDifferences() const;
+    };
+
+    // Called from the thread executing compare(), incrementally: removed and added parts are
+    // reported first, then matched parts batch after batch
+    using ItemsCompared = std::function<void(Span<const Item>)>;
+
+    // Deferred shapes of the documents are loaded first. Returns early if abort is requested
+    static Report compare(
+            const DocumentPtr& docReference,
+            const DocumentPtr& docCompared,
+            const ItemsCompared& fnItemsCompared,
+            const Options& options = {},
+            TaskProgress* progress = nullptr);
+};
+
+} // namespace Mayo
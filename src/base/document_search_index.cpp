@@ -0,0 +1,246 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "document_search_index.h"
+
+#include "label_attributes_cache.h"
+#include "profiler.h"
+#include "string_conv.h"
+#include "task_manager.h"
+#include "task_progress.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace Mayo {
+
+namespace {
+
+// Count of nodes whose words are computed by a concurrent task
+constexpr int NodeChunkSize = 4096;
+
+void appendWords(const QString& text, std::vector<QString>* ptrVecWord)
+{
+    int wordStart = -1;
+    for (int i = 0; i <= text.size(); ++i) {
+        const bool isWordChar = i < text.size() && text.at(i).isLetterOrNumber();
+        if (isWordChar && wordStart < 0) {
+            wordStart = i;
+        }
+        else if (!isWordChar && wordStart >= 0) {
+            ptrVecWord->push_back(text.mid(wordStart, i - wordStart).toLower());
+            wordStart = -1;
+        }
+    }
+}
+
+void sortUnique(std::vector<TreeNodeId>* ptrVecId)
+{
+    std::sort(ptrVecId->begin(), ptrVecId->end());
+    ptrVecId->erase(std::unique(ptrVecId->begin(), ptrVecId->end()), ptrVecId->end());
+}
+
+} // namespace
+
+DocumentSearchIndex::DocumentSearchIndex(LabelAttributesCache* attributesCache)
+    : m_attributesCache(attributesCache)
+{
+}
+
+void DocumentSearchIndex::addEntity(const Tree<TDF_Label>& modelTree, TreeNodeId entityId)
+{
+    PendingChange change;
+    change.type = PendingChange::Type::Add;
+    change.entityId = entityId;
+    traverseTree(entityId, modelTree, [&](TreeNodeId id) {
+        const TreeNodeId parentId = id != entityId ? modelTree.nodeParent(id) : 0;
+        const TDF_Label parentLabel = parentId != 0 ? modelTree.nodeData(parentId) : TDF_Label();
+        change.vecNode.push_back({ id, parentId, modelTree.nodeData(id), parentLabel });
+    });
+
+    std::lock_guard<std::mutex> lock(m_mutexPendingChange);
+    m_vecPendingChange.push_back(std::move(change));
+}
+
+void DocumentSearchIndex::forget(TreeNodeId entityId)
+{
+    PendingChange change;
+    change.type = PendingChange::Type::Forget;
+    change.entityId = entityId;
+    std::lock_guard<std::mutex> lock(m_mutexPendingChange);
+    m_vecPendingChange.push_back(std::move(change));
+}
+
+void DocumentSearchIndex::invalidateLabel(const TDF_Label& label)
+{
+    PendingChange change;
+    change.type = PendingChange::Type::InvalidateLabel;
+    change.entityId = 0;
+    change.label = label;
+    std::lock_guard<std::mutex> lock(m_mutexPendingChange);
+    m_vecPendingChange.push_back(std::move(change));
+}
+
+void DocumentSearchIndex::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    {
+        std::lock_guard<std::mutex> lockPending(m_mutexPendingChange);
+        m_vecPendingChange.clear();
+    }
+
+    m_mapEntity.clear();
+}
+
+void DocumentSearchIndex::update(TaskProgress* progress)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    this->updateImpl(progress);
+}
+
+std::vector<TreeNodeId> DocumentSearchIndex::find(const QString& query)
+{
+    const std::vector<QString> vecQueryWord = DocumentSearchIndex::words(query);
+    if (vecQueryWord.empty())
+        return {};
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    this->updateImpl(nullptr);
+    std::vector<TreeNodeId> vecResultId;
+    for (const auto& [entityId, entity] : m_mapEntity) {
+        // Nodes matching all the query words, each query word being a prefix of a node word
+        std::vector<TreeNodeId> vecEntityResultId;
+        for (size_t iWord = 0; iWord < vecQueryWord.size(); ++iWord) {
+            const QString& queryWord = vecQueryWord.at(iWord);
+            std::vector<TreeNodeId> vecWordId;
+            for (auto it = entity.mapWordNodes.lower_bound(queryWord);
+                 it != entity.mapWordNodes.cend() && it->first.startsWith(queryWord);
+                 ++it)
+            {
+                vecWordId.insert(vecWordId.end(), it->second.cbegin(), it->second.cend());
+            }
+
+            sortUnique(&vecWordId);
+            if (iWord == 0) {
+                vecEntityResultId = std::move(vecWordId);
+            }
+            else {
+                std::vector<TreeNodeId> vecIntersectionId;
+                std::set_intersection(
+                            vecEntityResultId.cbegin(), vecEntityResultId.cend(),
+                            vecWordId.cbegin(), vecWordId.cend(),
+                            std::back_inserter(vecIntersectionId));
+                vecEntityResultId = std::move(vecIntersectionId);
+            }
+
+            if (vecEntityResultId.empty())
+                break;
+        }
+
+        vecResultId.insert(vecResultId.end(), vecEntityResultId.cbegin(), vecEntityResultId.cend());
+    }
+
+    return vecResultId;
+}
+
+std::vector<QString> DocumentSearchIndex::words(const QString& text)
+{
+    std::vector<QString> vecWord;
+    appendWords(text, &vecWord);
+    return vecWord;
+}
+
+void DocumentSearchIndex::updateImpl(TaskProgress* progress)
+{
+    std::vector<PendingChange> vecChange;
+    {
+        std::lock_guard<std::mutex> lock(m_mutexPendingChange);
+        vecChange.swap(m_vecPendingChange);
+    }
+
+    // Changes are applied in order, ids of destroyed entities might be reused by new ones
+    for (PendingChange& change : vecChange) {
+        switch (change.type) {
+        case PendingChange::Type::Add: {
+            Entity& entity = m_mapEntity[change.entityId];
+            entity.vecNode = std::move(change.vecNode);
+            entity.mapWordNodes.clear();
+            entity.isIndexed = false;
+            break;
+        }
+        case PendingChange::Type::Forget:
+            m_mapEntity.erase(change.entityId);
+            break;
+        case PendingChange::Type::InvalidateLabel:
+            for (auto& [entityId, entity] : m_mapEntity) {
+                auto itNode = std::find_if(entity.vecNode.cbegin(), entity.vecNode.cend(), [&](const Node& node) {
+                    return node.label == change.label;
+                });
+                if (itNode != entity.vecNode.cend())
+                    entity.isIndexed = false;
+            }
+            break;
+        }
+    }
+
+    std::vector<Entity*> vecEntityToIndex;
+    size_t nodeToIndexCount = 0;
+    for (auto& [entityId, entity] : m_mapEntity) {
+        if (!entity.isIndexed) {
+            vecEntityToIndex.push_back(&entity);
+            nodeToIndexCount += entity.vecNode.size();
+        }
+    }
+
+    if (vecEntityToIndex.empty())
+        return;
+
+    MAYO_PROFILE_ZONE("DocumentSearchIndex::update");
+    for (Entity* entity : vecEntityToIndex) {
+        TaskProgress entityProgress(progress, 100. * entity->vecNode.size() / std::max<size_t>(1, nodeToIndexCount));
+        this->indexEntity(entity, &entityProgress);
+    }
+}
+
+void DocumentSearchIndex::indexEntity(Entity* entity, TaskProgress* progress) const
+{
+    // Words of the nodes are computed concurrently, then gathered in the sorted map
+    const int nodeCount = int(entity->vecNode.size());
+    const int chunkCount = (nodeCount + NodeChunkSize - 1) / NodeChunkSize;
+    std::vector<std::vector<std::pair<QString, TreeNodeId>>> vecChunkWords(chunkCount);
+    TaskManager::runConcurrently(chunkCount, progress, [&](int iChunk, TaskProgress*) {
+        auto& vecWordNode = vecChunkWords.at(iChunk);
+        std::vector<QString> vecWord;
+        const int iNodeEnd = std::min(nodeCount, (iChunk + 1) * NodeChunkSize);
+        for (int iNode = iChunk * NodeChunkSize; iNode < iNodeEnd; ++iNode) {
+            const Node& node = entity->vecNode.at(iNode);
+            const bool parentIsReference =
+                    !node.parentLabel.IsNull() && m_attributesCache->attributes(node.parentLabel)->isReference;
+            const TreeNodeId instanceId = parentIsReference ? node.parentId : node.id;
+            const auto attrs = m_attributesCache->attributes(node.label);
+            vecWord.clear();
+            appendWords(to_QString(attrs->name), &vecWord);
+            for (const TCollection_ExtendedString& layerName : attrs->vecLayerName)
+                appendWords(to_QString(layerName), &vecWord);
+
+            for (QString& word : vecWord)
+                vecWordNode.push_back({ std::move(word), instanceId });
+        }
+    });
+
+    entity->mapWordNodes.clear();
+    for (const auto& vecWordNode : vecChunkWords) {
+        for (const auto& [word, nodeId] : vecWordNode) {
+            std::vector<TreeNodeId>& vecNodeId = entity->mapWordNodes[word];
+            if (vecNodeId.empty() || vecNodeId.back() != nodeId)
+                vecNodeId.push_back(nodeId);
+        }
+    }
+
+    entity->isIndexed = !TaskProgress::isAbortRequested(progress);
+}
+
+} // namespace Mayo
@@ -0,0 +1,88 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "libtree.h"
+
+#include <QtCore/QString>
+#include <TDF_Label.hxx>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace Mayo {
+
+class LabelAttributesCache;
+class TaskProgress;
+
+// Inverted index over the model tree of a document, mapping the words of label names and layer
+// names to tree nodes, for as-you-type search
+// Nodes are indexed as "instance" nodes: a node whose parent is a component(reference) is indexed
+// along with its parent, so the product name(typically the part number) of a component matches
+// the component node, which is the one carrying the graphics
+// Entities are indexed lazily: addEntity(), forget() and invalidateLabel() only record changes, the
+// index is updated by the next call to update() or find(). Model tree of an entity is copied by
+// addEntity(), so update() can run in a background thread while the model tree is modified
+// All functions are thread-safe
+class DocumentSearchIndex {
+public:
+    DocumentSearchIndex(LabelAttributesCache* attributesCache);
+
+    // Records that entity 'entityId' has to be indexed, or indexed again if it was already
+    void addEntity(const Tree<TDF_Label>& modelTree, TreeNodeId entityId);
+    // Removes entity 'entityId' from index, to be called before the entity is destroyed
+    void forget(TreeNodeId entityId);
+    // Records that the attributes(name, layers) of 'label' changed, entities containing 'label'
+    // are indexed again
+    void invalidateLabel(const TDF_Label& label);
+    void clear();
+
+    // Indexes the entities added or changed since last update, nodes are processed concurrently
+    void update(TaskProgress* progress = nullptr);
+
+    // Instance nodes having a word starting with each of the words of 'query'(case insensitive)
+    // Returned nodes are sorted by entity then by id
+    std::vector<TreeNodeId> find(const QString& query);
+
+    // Lower-case words of 'text', ie sequences of letters and digits
+    static std::vector<QString> words(const QString& text);
+
+private:
+    struct Node {
+        TreeNodeId id;
+        TreeNodeId parentId; // Null for the entity node
+        TDF_Label label;
+        TDF_Label parentLabel;
+    };
+
+    struct Entity {
+        std::vector<Node> vecNode; // Copy of the model tree of the entity, in pre-order
+        std::map<QString, std::vector<TreeNodeId>> mapWordNodes; // Sorted, for prefix lookup
+        bool isIndexed = false;
+    };
+
+    struct PendingChange {
+        enum class Type { Add, Forget, InvalidateLabel };
+        Type type;
+        TreeNodeId entityId;
+        std::vector<Node> vecNode; // Type::Add only
+        TDF_Label label; // Type::InvalidateLabel only
+    };
+
+    void updateImpl(TaskProgress* progress);
+    void indexEntity(Entity* entity, TaskProgress* progress) const;
+
+    LabelAttributesCache* m_attributesCache = nullptr;
+    std::mutex m_mutex;
+    std::map<TreeNodeId, Entity> m_mapEntity;
+    // Changes are recorded apart, so the thread modifying the model tree isn't blocked by update()
+    std::mutex m_mutexPendingChange;
+    std::vector<PendingChange> m_vecPendingChange;
+};
+
+} // namespace Mayo
@@ -0,0 +1,153 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "document_snapshot.h"
+
+#include "document.h"
+#include "profiler.h"
+#include "tkernel_utils.h"
+#include "xcaf.h"
+
+#include <TDF_CopyLabel.hxx>
+#include <XCAFDoc_DocumentTool.hxx>
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+#  include <XCAFDoc_Editor.hxx>
+#endif
+#include <map>
+#include <unordered_map>
+#include <utility>
+
+namespace Mayo {
+
+namespace {
+
+// Index of 'nodeId' among the children of its parent
+int childIndex(const Tree<TDF_Label>& tree, TreeNodeId nodeId)
+{
+    int index = 0;
+    for (TreeNodeId id = tree.nodeSiblingPrevious(nodeId); id != 0; id = tree.nodeSiblingPrevious(id))
+        ++index;
+
+    return index;
+}
+
+TreeNodeId childAt(const Tree<TDF_Label>& tree, TreeNodeId parentId, int index)
+{
+    TreeNodeId id = tree.nodeChildFirst(parentId);
+    for (int i = 0; i < index && id != 0; ++i)
+        id = tree.nodeSiblingNext(id);
+
+    return id;
+}
+
+} // namespace
+
+DocumentSnapshotPtr DocumentSnapshot::create(Span<const ApplicationItem> spanItem)
+{
+    MAYO_PROFILE_ZONE("DocumentSnapshot::create");
+    std::shared_ptr<DocumentSnapshot> snapshot(new DocumentSnapshot);
+    std::unordered_map<const Document*, DocumentPtr> mapSnapshotDoc;
+    std::map<std::pair<const Document*, TreeNodeId>, TreeNodeId> mapEntityClone;
+
+    auto fnSnapshotDoc = [&](const DocumentPtr& doc) {
+        auto it = mapSnapshotDoc.find(doc.get());
+        if (it != mapSnapshotDoc.end())
+            return it->second;
+
+        DocumentPtr docSnapshot = new Document;
+        XCAFDoc_DocumentTool::Set(docSnapshot->Main(), false);
+        docSnapshot->initXCaf();
+        docSnapshot->setName(doc->name());
+        docSnapshot->setFilePath(doc->filePath());
+        snapshot->m_vecDocument.push_back(docSnapshot);
+        mapSnapshotDoc.insert({ doc.get(), docSnapshot });
+        return docSnapshot;
+    };
+
+    // Returns the tree node of the clone of entity 'entityId', null if it can't be cloned
+    auto fnCloneEntity = [&](const DocumentPtr& doc, TreeNodeId entityId) -> TreeNodeId {
+        auto it = mapEntityClone.find({ doc.get(), entityId });
+        if (it != mapEntityClone.end())
+            return it->second;
+
+        const DocumentPtr docSnapshot = fnSnapshotDoc(doc);
+        const TDF_Label label = doc->modelTree().nodeData(entityId);
+        TDF_Label labelClone;
+        if (XCaf::isShape(label)) {
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+            // Shapes are bound to the cloned labels, not copied
+            const TDF_LabelSequence seqMark = docSnapshot->xcaf().topLevelFreeShapes();
+            TDF_LabelSequence seqLabel;
+            seqLabel.Append(label);
+            XCAFDoc_Editor::Extract(seqLabel, docSnapshot->xcaf().shapeTool()->Label());
+            const TDF_LabelSequence seqNewLabel = docSnapshot->xcaf().diffTopLevelFreeShapes(seqMark);
+            if (!seqNewLabel.IsEmpty())
+                labelClone = seqNewLabel.First();
+#endif
+        }
+        else {
+            // Mesh and point cloud attributes share their data when pasted
+            labelClone = docSnapshot->newEntityLabel();
+            TDF_CopyLabel copy(label, labelClone);
+            copy.Perform();
+        }
+
+        TreeNodeId cloneId = 0;
+        if (!labelClone.IsNull()) {
+            docSnapshot->addEntityTreeNode(labelClone);
+            cloneId = docSnapshot->findEntityTreeNodeId(labelClone);
+        }
+
+        mapEntityClone.insert({ { doc.get(), entityId }, cloneId });
+        return cloneId;
+    };
+
+    for (const ApplicationItem& item : spanItem) {
+        if (item.isDocument()) {
+            const DocumentPtr doc = item.document();
+            bool isDocCloned = true;
+            for (int i = 0; i < doc->entityCount(); ++i)
+                isDocCloned = fnCloneEntity(doc, doc->entityTreeNodeId(i)) != 0 && isDocCloned;
+
+            if (isDocCloned) {
+                snapshot->m_vecItem.push_back(fnSnapshotDoc(doc));
+            }
+            else {
+                snapshot->m_vecItem.push_back(item);
+                snapshot->m_isIsolated = false;
+            }
+        }
+        else if (item.isDocumentTreeNode()) {
+            // Clone of the tree node is found by the path from the entity, model trees of an
+            // entity and of its clone having the same structure
+            const DocumentPtr doc = item.document();
+            const Tree<TDF_Label>& tree = doc->modelTree();
+            const TreeNodeId entityId = tree.nodeRoot(item.documentTreeNode().id());
+            std::vector<int> vecChildIndex;
+            for (TreeNodeId id = item.documentTreeNode().id(); id != entityId; id = tree.nodeParent(id))
+                vecChildIndex.push_back(childIndex(tree, id));
+
+            TreeNodeId cloneId = fnCloneEntity(doc, entityId);
+            if (cloneId != 0) {
+                const DocumentPtr docSnapshot = fnSnapshotDoc(doc);
+                for (auto it = vecChildIndex.rbegin(); it != vecChildIndex.rend() && cloneId != 0; ++it)
+                    cloneId = childAt(docSnapshot->modelTree(), cloneId, *it);
+            }
+
+            if (cloneId != 0) {
+                snapshot->m_vecItem.push_back(DocumentTreeNode(fnSnapshotDoc(doc), cloneId));
+            }
+            else {
+                snapshot->m_vecItem.push_back(item);
+                snapshot->m_isIsolated = false;
+            }
+        }
+    }
+
+    return snapshot;
+}
+
+} // namespace Mayo
@@ -0,0 +1,46 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "application_item.h"
+#include "document_ptr.h"
+#include "span.h"
+
+#include <memory>
+#include <vector>
+
+namespace Mayo {
+
+class DocumentSnapshot;
+using DocumentSnapshotPtr = std::shared_ptr<const DocumentSnapshot>;
+
+// Read-only copy of application items, so a background task(eg export) works on a consistent state
+// while source documents keep being modified(nodes hidden, entities deleted or imported, ...)
+// Entities involved are cloned into private documents not registered in Application: labels are
+// copied with their attributes(names, colors, layers, ...) but shapes and meshes are shared, as
+// TopoDS_Shape and Poly_Triangulation objects are reference-counted
+// Note: cloning XCAF entities requires OpenCascade >= 7.6, otherwise source items are kept as is
+class DocumentSnapshot {
+public:
+    // Must be called in the thread modifying the documents of 'spanItem', typically main thread
+    static DocumentSnapshotPtr create(Span<const ApplicationItem> spanItem);
+
+    // Items mapped into the snapshot documents, in the same order as the source items
+    Span<const ApplicationItem> applicationItems() const { return m_vecItem; }
+
+    // Whether all source items could be cloned
+    bool isIsolated() const { return m_isIsolated; }
+
+private:
+    DocumentSnapshot() = default;
+
+    std::vector<DocumentPtr> m_vecDocument;
+    std::vector<ApplicationItem> m_vecItem;
+    bool m_isIsolated = true;
+};
+
+} // namespace Mayo
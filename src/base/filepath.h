@@ -79,4 +79,13 @@ inline bool filepathIsRegularFile(const FilePath& fp) {
     }
 }
 
+// Exception-safe version of std::filesystem::is_directory()
+inline bool filepathIsDirectory(const FilePath& fp) {
+    try {
+        return std::filesystem::is_directory(fp);
+    } catch (...) {
+        return false;
+    }
+}
+
 } // namespace Mayo
@@ -0,0 +1,376 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "io_compressed_stream.h"
+#include "global.h"
+
+#include <QtCore/QFile>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+#ifdef HAVE_ZLIB
+#  include <zlib.h>
+#endif
+#ifdef HAVE_ZSTD
+#  include <zstd.h>
+#endif
+
+namespace Mayo {
+namespace IO {
+
+namespace {
+
+constexpr size_t Decompress_inputChunkSize = 256 * 1024;
+constexpr size_t Decompress_blockSize = 1024 * 1024;
+constexpr size_t Decompress_maxQueuedBlockCount = 4;
+
+// Streaming decoder, input and output ranges are advanced by decode()
+class Decoder {
+public:
+    virtual ~Decoder() = default;
+    // Returns false if contents are corrupted
+    virtual bool decode(const char** inData, size_t* inSize, char** outData, size_t* outSize) = 0;
+
+    static std::unique_ptr<Decoder> create(Compression compression);
+};
+
+#ifdef HAVE_ZLIB
+class GzipDecoder : public Decoder {
+public:
+    GzipDecoder() {
+        // Window bits 15 + 32 : zlib and gzip headers are detected
+        m_isValid = inflateInit2(&m_stream, 15 + 32) == Z_OK;
+    }
+
+    ~GzipDecoder() {
+        if (m_isValid)
+            inflateEnd(&m_stream);
+    }
+
+    bool decode(const char** inData, size_t* inSize, char** outData, size_t* outSize) override {
+        if (!m_isValid)
+            return false;
+
+        // Loops while progress is made, input may be empty to flush pending output
+        while (*outSize > 0) {
+            m_stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(*inData));
+            m_stream.avail_in = uInt(std::min<size_t>(*inSize, UINT32_MAX));
+            m_stream.next_out = reinterpret_cast<Bytef*>(*outData);
+            m_stream.avail_out = uInt(std::min<size_t>(*outSize, UINT32_MAX));
+            const uInt availIn = m_stream.avail_in;
+            const uInt availOut = m_stream.avail_out;
+            const int ret = inflate(&m_stream, Z_NO_FLUSH);
+            const size_t consumedSize = availIn - m_stream.avail_in;
+            const size_t producedSize = availOut - m_stream.avail_out;
+            *inData += consumedSize;
+            *inSize -= consumedSize;
+            *outData += producedSize;
+            *outSize -= producedSize;
+            if (ret == Z_STREAM_END) {
+                // Files may contain several gzip members, concatenated
+                if (*inSize == 0)
+                    break;
+
+                if (inflateReset(&m_stream) != Z_OK)
+                    return false;
+            }
+            else if (ret != Z_OK && ret != Z_BUF_ERROR) {
+                return false;
+            }
+            else if (consumedSize == 0 && producedSize == 0) {
+                break;
+            }
+        }
+
+        return true;
+    }
+
+private:
+    z_stream m_stream = {};
+    bool m_isValid = false;
+};
+#endif
+
+#ifdef HAVE_ZSTD
+class ZstdDecoder : public Decoder {
+public:
+    ZstdDecoder() : m_stream(ZSTD_createDStream()) {
+        if (m_stream)
+            ZSTD_initDStream(m_stream);
+    }
+
+    ~ZstdDecoder() {
+        ZSTD_freeDStream(m_stream);
+    }
+
+    bool decode(const char** inData, size_t* inSize, char** outData, size_t* outSize) override {
+        if (!m_stream)
+            return false;
+
+        // Frames following each other are decoded as a single stream
+        ZSTD_inBuffer input = { *inData, *inSize, 0 };
+        ZSTD_outBuffer output = { *outData, *outSize, 0 };
+        // Loops while progress is made, input may be empty to flush pending output
+        while (output.pos < output.size) {
+            const size_t inPos = input.pos;
+            const size_t outPos = output.pos;
+            const size_t ret = ZSTD_decompressStream(m_stream, &output, &input);
+            if (ZSTD_isError(ret))
+                return false;
+
+            if (input.pos == inPos && output.pos == outPos)
+                break;
+        }
+
+        *inData += input.pos;
+        *inSize -= input.pos;
+        *outData += output.pos;
+        *outSize -= output.pos;
+        return true;
+    }
+
+private:
+    ZSTD_DStream* m_stream = nullptr;
+};
+#endif
+
+std::unique_ptr<Decoder> Decoder::create(Compression compression)
+{
+    switch (compression) {
+#ifdef HAVE_ZLIB
+    case Compression::Gzip: return std::make_unique<GzipDecoder>();
+#endif
+#ifdef HAVE_ZSTD
+    case Compression::Zstd: return std::make_unique<ZstdDecoder>();
+#endif
+    default: return {};
+    }
+}
+
+} // namespace
+
+Compression probeCompression(std::string_view data)
+{
+    auto fnStartsWith = [=](std::initializer_list<unsigned char> magic) {
+        return data.size() >= magic.size()
+                && std::equal(magic.begin(), magic.end(), data.cbegin(), [](unsigned char lhs, char rhs) {
+            return lhs == static_cast<unsigned char>(rhs);
+        });
+    };
+
+    if (fnStartsWith({ 0x1F, 0x8B }))
+        return Compression::Gzip;
+
+    if (fnStartsWith({ 0x28, 0xB5, 0x2F, 0xFD }))
+        return Compression::Zstd;
+
+    return Compression::None;
+}
+
+bool isCompressionSupported(Compression compression)
+{
+    switch (compression) {
+    case Compression::None: return true;
+#ifdef HAVE_ZLIB
+    case Compression::Gzip: return true;
+#endif
+#ifdef HAVE_ZSTD
+    case Compression::Zstd: return true;
+#endif
+    default: return false;
+    }
+}
+
+std::string_view compressionFileSuffix(Compression compression)
+{
+    switch (compression) {
+    case Compression::None: return {};
+    case Compression::Gzip: return "gz";
+    case Compression::Zstd: return "zst";
+    }
+
+    return {};
+}
+
+QByteArray decompressBegin(std::string_view compressedBegin, Compression compression, int len)
+{
+    std::unique_ptr<Decoder> decoder = Decoder::create(compression);
+    if (!decoder || len <= 0)
+        return {};
+
+    QByteArray contents(len, Qt::Uninitialized);
+    const char* inData = compressedBegin.data();
+    size_t inSize = compressedBegin.size();
+    char* outData = contents.data();
+    size_t outSize = contents.size();
+    decoder->decode(&inData, &inSize, &outData, &outSize);
+    contents.truncate(len - int(outSize));
+    return contents;
+}
+
+uint64_t decompressedSizeHint(std::string_view compressedBegin, std::string_view compressedEnd, Compression compression)
+{
+    if (compression == Compression::Gzip && compressedEnd.size() >= 4) {
+        // Trailer ISIZE field of the last member, little-endian size modulo 2^32
+        const auto* bytes = reinterpret_cast<const uint8_t*>(compressedEnd.data() + compressedEnd.size() - 4);
+        return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (uint64_t(bytes[3]) << 24);
+    }
+
+#ifdef HAVE_ZSTD
+    if (compression == Compression::Zstd) {
+        const unsigned long long size = ZSTD_getFrameContentSize(compressedBegin.data(), compressedBegin.size());
+        if (size != ZSTD_CONTENTSIZE_UNKNOWN && size != ZSTD_CONTENTSIZE_ERROR)
+            return size;
+    }
+#else
+    MAYO_UNUSED(compressedBegin);
+#endif
+
+    return 0;
+}
+
+DecompressStreamBuffer::DecompressStreamBuffer(const FilePath& filepath, Compression compression)
+{
+    this->setg(nullptr, nullptr, nullptr);
+    m_thread = std::thread([=]{ this->runDecompression(filepath, compression); });
+}
+
+DecompressStreamBuffer::~DecompressStreamBuffer()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isStopRequested = true;
+    }
+
+    m_condQueueNotFull.notify_all();
+    m_thread.join();
+}
+
+bool DecompressStreamBuffer::hasError() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_hasError;
+}
+
+DecompressStreamBuffer::int_type DecompressStreamBuffer::underflow()
+{
+    if (this->gptr() < this->egptr())
+        return traits_type::to_int_type(*this->gptr());
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_condBlockAvailable.wait(lock, [=]{ return !m_queueBlock.empty() || m_isDecompressionDone; });
+        if (m_queueBlock.empty())
+            return traits_type::eof();
+
+        m_currentBlock = std::move(m_queueBlock.front());
+        m_queueBlock.pop_front();
+    }
+
+    m_condQueueNotFull.notify_one();
+    m_consumedSize += m_currentBlock.size();
+    char* blockData = m_currentBlock.data();
+    this->setg(blockData, blockData, blockData + m_currentBlock.size());
+    return traits_type::to_int_type(*this->gptr());
+}
+
+void DecompressStreamBuffer::runDecompression(const FilePath& filepath, Compression compression)
+{
+    auto fnFinish = [=](bool hasError) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_isDecompressionDone = true;
+            m_hasError = hasError;
+        }
+
+        m_condBlockAvailable.notify_all();
+    };
+
+    std::unique_ptr<Decoder> decoder = Decoder::create(compression);
+    QFile file(filepathTo<QString>(filepath));
+    if (!decoder || !file.open(QIODevice::ReadOnly))
+        return fnFinish(true);
+
+    std::vector<char> inputChunk(Decompress_inputChunkSize);
+    std::vector<char> block(Decompress_blockSize);
+    char* outData = block.data();
+    size_t outSize = block.size();
+    auto fnPushBlock = [&]{
+        block.resize(block.size() - outSize);
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_condQueueNotFull.wait(lock, [=]{
+            return m_queueBlock.size() < Decompress_maxQueuedBlockCount || m_isStopRequested;
+        });
+        if (m_isStopRequested)
+            return false;
+
+        m_queueBlock.push_back(std::move(block));
+        lock.unlock();
+        m_condBlockAvailable.notify_one();
+        block = std::vector<char>(Decompress_blockSize);
+        outData = block.data();
+        outSize = block.size();
+        return true;
+    };
+
+    while (!file.atEnd()) {
+        const qint64 readSize = file.read(inputChunk.data(), inputChunk.size());
+        if (readSize < 0)
+            return fnFinish(true);
+
+        const char* inData = inputChunk.data();
+        size_t inSize = size_t(readSize);
+        while (inSize > 0) {
+            if (!decoder->decode(&inData, &inSize, &outData, &outSize))
+                return fnFinish(true);
+
+            if (outSize == 0 && !fnPushBlock())
+                return fnFinish(false);
+        }
+    }
+
+    // Flush output still pending in the decoder
+    while (true) {
+        const char* inData = nullptr;
+        size_t inSize = 0;
+        const size_t outSizeBefore = outSize;
+        if (!decoder->decode(&inData, &inSize, &outData, &outSize))
+            return fnFinish(true);
+
+        if (outSize == outSizeBefore)
+            break;
+
+        if (outSize == 0 && !fnPushBlock())
+            return fnFinish(false);
+    }
+
+    if (outSize < block.size() && !fnPushBlock())
+        return fnFinish(false);
+
+    fnFinish(false);
+}
+
+bool decompressFile(const FilePath& filepath, Compression compression, std::vector<uint8_t>* contents)
+{
+    DecompressStreamBuffer streamBuffer(filepath, compression);
+    contents->clear();
+    constexpr size_t chunkSize = Decompress_blockSize;
+    size_t size = 0;
+    while (true) {
+        contents->resize(size + chunkSize);
+        const std::streamsize readSize = streamBuffer.sgetn(reinterpret_cast<char*>(contents->data() + size), chunkSize);
+        size += size_t(readSize);
+        if (size_t(readSize) < chunkSize)
+            break;
+    }
+
+    contents->resize(size);
+    return !streamBuffer.hasError();
+}
+
+} // namespace IO
+} // namespace Mayo
@@ -0,0 +1,84 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "filepath.h"
+
+#include <QtCore/QByteArray>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <streambuf>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace Mayo {
+namespace IO {
+
+// Compression of input files, decoders are available if Mayo was built with zlib(HAVE_ZLIB) and
+// zstd(HAVE_ZSTD)
+enum class Compression { None, Gzip, Zstd };
+
+// Compression identified from the magic bytes starting 'data'
+Compression probeCompression(std::string_view data);
+bool isCompressionSupported(Compression compression);
+// File name suffixes of 'compression', eg "gz" for Gzip. Empty if None
+std::string_view compressionFileSuffix(Compression compression);
+
+// Decompresses the beginning of the contents, up to 'len' bytes
+// 'compressedBegin' is an excerpt of the compressed contents(from start)
+QByteArray decompressBegin(std::string_view compressedBegin, Compression compression, int len);
+
+// Size of the decompressed contents as recorded in the compressed data, zero if unknown
+// 'compressedBegin' and 'compressedEnd' are excerpts of the start and end of the compressed contents
+uint64_t decompressedSizeHint(std::string_view compressedBegin, std::string_view compressedEnd, Compression compression);
+
+// Input stream buffer decompressing a file on the fly
+// Decompression runs in a separate thread filling a bounded queue of blocks which are consumed by
+// the reading thread, so decompression is pipelined with parsing and memory usage is bounded
+class DecompressStreamBuffer : public std::streambuf {
+public:
+    DecompressStreamBuffer(const FilePath& filepath, Compression compression);
+    ~DecompressStreamBuffer();
+
+    // Whether the file could not be read or contents are corrupted. To be checked once end of
+    // stream is reached
+    bool hasError() const;
+
+    // Count of decompressed bytes consumed so far
+    uint64_t consumedSize() const { return m_consumedSize; }
+
+    // Disable copy
+    DecompressStreamBuffer(const DecompressStreamBuffer&) = delete;
+    DecompressStreamBuffer& operator=(const DecompressStreamBuffer&) = delete;
+
+protected:
+    int_type underflow() override;
+
+private:
+    void runDecompression(const FilePath& filepath, Compression compression);
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_condBlockAvailable;
+    std::condition_variable m_condQueueNotFull;
+    std::deque<std::vector<char>> m_queueBlock;
+    bool m_isDecompressionDone = false;
+    bool m_isStopRequested = false;
+    bool m_hasError = false;
+    std::vector<char> m_currentBlock; // Block being consumed
+    uint64_t m_consumedSize = 0;
+    std::thread m_thread;
+};
+
+// Decompresses the whole file into memory, for readers requiring contiguous contents
+// Returns false in case of error
+bool decompressFile(const FilePath& filepath, Compression compression, std::vector<uint8_t>* contents);
+
+} // namespace IO
+} // namespace Mayo
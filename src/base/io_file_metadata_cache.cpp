@@ -0,0 +1,77 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "io_file_metadata_cache.h"
+
+#include <QtCore/QDateTime>
+#include <QtCore/QFileInfo>
+
+namespace Mayo {
+namespace IO {
+
+namespace {
+
+// Bounds memory usage when browsing huge directory trees, cache is then emptied
+constexpr size_t FileMetadataCache_maxEntryCount = 100000;
+
+} // namespace
+
+FileStamp FileStamp::get(const FilePath& fp)
+{
+    const auto fi = filepathTo<QFileInfo>(fp);
+    if (!fi.isFile())
+        return {};
+
+    FileStamp stamp;
+    stamp.size = uint64_t(fi.size());
+    stamp.lastModified = fi.lastModified().toMSecsSinceEpoch();
+    return stamp;
+}
+
+bool FileMetadataCache::find(const FilePath& fp, const FileStamp& stamp, FileMetadata* metadata) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_mapEntry.find(FileMetadataCache::entryKey(fp));
+    if (it == m_mapEntry.cend() || !(it->second.stamp == stamp))
+        return false;
+
+    if (metadata)
+        *metadata = it->second.metadata;
+
+    return true;
+}
+
+void FileMetadataCache::insert(const FilePath& fp, const FileStamp& stamp, const FileMetadata& metadata)
+{
+    if (stamp.isNull())
+        return;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_mapEntry.size() >= FileMetadataCache_maxEntryCount)
+        m_mapEntry.clear();
+
+    m_mapEntry.insert_or_assign(FileMetadataCache::entryKey(fp), Entry{ stamp, metadata });
+}
+
+size_t FileMetadataCache::size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_mapEntry.size();
+}
+
+void FileMetadataCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_mapEntry.clear();
+}
+
+std::string FileMetadataCache::entryKey(const FilePath& fp)
+{
+    return filepathTo<QFileInfo>(fp).absoluteFilePath().toStdString();
+}
+
+} // namespace IO
+} // namespace Mayo
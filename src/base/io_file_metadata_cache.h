@@ -0,0 +1,71 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "filepath.h"
+#include "io_format.h"
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace Mayo {
+namespace IO {
+
+// Information about a file found by probing(see System::fileMetadata())
+struct FileMetadata {
+    Format format = Format_Unknown;
+    // Whether the fields below were scanned, probing for the format alone leaves them unknown
+    bool isScanned = false;
+    int64_t entityCount = -1; // Estimation, -1 if unknown(ex: count of STEP data entities)
+    int64_t triangleCount = -1; // Estimation for mesh formats, -1 if unknown(ex: STL facets)
+    uint64_t contentsSize = 0; // Decompressed size of the contents, zero if unknown
+    std::string schema; // Application schema(ex: STEP "AUTOMOTIVE_DESIGN"), empty if unknown
+};
+
+// Identifies a version of a file on disk
+struct FileStamp {
+    uint64_t size = 0;
+    int64_t lastModified = 0; // Milliseconds since epoch
+
+    // Returns null stamp(zero size and time) if 'fp' isn't a regular file
+    static FileStamp get(const FilePath& fp);
+    bool isNull() const { return size == 0 && lastModified == 0; }
+    bool operator==(const FileStamp& other) const {
+        return size == other.size && lastModified == other.lastModified;
+    }
+};
+
+// Cache of FileMetadata objects, an entry being valid as long as the stamp of its file is unchanged
+// Avoids probing the same files again and again when they are listed in file browsing widgets and
+// then imported, which matters on network drives
+// All functions can be called concurrently
+class FileMetadataCache {
+public:
+    // Returns true and assigns 'metadata' if there is an entry for 'fp' matching 'stamp'
+    bool find(const FilePath& fp, const FileStamp& stamp, FileMetadata* metadata) const;
+    // Entry of 'fp' is replaced if any. Does nothing if 'stamp' is null
+    void insert(const FilePath& fp, const FileStamp& stamp, const FileMetadata& metadata);
+
+    size_t size() const;
+    void clear();
+
+private:
+    struct Entry {
+        FileStamp stamp;
+        FileMetadata metadata;
+    };
+
+    static std::string entryKey(const FilePath& fp);
+
+    std::unordered_map<std::string, Entry> m_mapEntry;
+    mutable std::mutex m_mutex;
+};
+
+} // namespace IO
+} // namespace Mayo
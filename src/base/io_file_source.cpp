@@ -0,0 +1,108 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "io_file_source.h"
+#include "io_remote_file.h"
+
+#include <algorithm>
+
+namespace Mayo {
+namespace IO {
+
+namespace {
+constexpr int FileSource_bufferBeginSize = 2048;
+constexpr int FileSource_compressedBeginSize = 64 * 1024;
+constexpr int FileSource_remoteBeginSize = 1024;
+} // namespace
+
+FileSource::FileSource(const FilePath& filepath)
+    : m_filepath(filepath),
+      m_file(filepathTo<QString>(filepath))
+{
+    if (RemoteFile::isUrl(filepath)) {
+        this->openRemote();
+        return;
+    }
+
+    if (!m_file.open(QIODevice::ReadOnly))
+        return;
+
+    m_size = m_file.size();
+    m_contentsSize = m_size;
+    const QByteArray magic = m_file.peek(4);
+    m_compression = probeCompression(std::string_view(magic.constData(), magic.size()));
+    if (m_compression != Compression::None) {
+        const QByteArray compressedBegin = m_file.read(FileSource_compressedBeginSize);
+        m_file.seek(std::max<qint64>(0, m_size - 4));
+        const QByteArray compressedEnd = m_file.read(4);
+        m_bufferBegin = decompressBegin(
+                    std::string_view(compressedBegin.constData(), compressedBegin.size()),
+                    m_compression,
+                    FileSource_bufferBeginSize);
+        m_contentsSize = decompressedSizeHint(
+                    std::string_view(compressedBegin.constData(), compressedBegin.size()),
+                    std::string_view(compressedEnd.constData(), compressedEnd.size()),
+                    m_compression);
+        return;
+    }
+
+    if (m_size > 0)
+        m_mappedData = m_file.map(0, m_size);
+
+    if (!m_mappedData)
+        m_bufferBegin = m_file.read(FileSource_bufferBeginSize);
+}
+
+FilePath FileSource::nameHint() const
+{
+    return this->isRemote() ? RemoteFile::nameHint(m_url) : m_filepath;
+}
+
+std::string_view FileSource::contents() const
+{
+    if (!m_mappedData)
+        return {};
+
+    return std::string_view(reinterpret_cast<const char*>(m_mappedData), m_size);
+}
+
+QByteArray FileSource::contentsBegin(int len) const
+{
+    if (m_mappedData) {
+        const int lenView = int(std::min<uint64_t>(len, m_size));
+        return QByteArray::fromRawData(reinterpret_cast<const char*>(m_mappedData), lenView);
+    }
+
+    return m_bufferBegin.left(len);
+}
+
+void FileSource::openRemote()
+{
+    // Probing only needs the beginning of the contents, the file isn't downloaded here
+    m_url = RemoteFile::toUrl(m_filepath);
+    const RemoteFile::RangeResult range = RemoteFile::fetchRange(m_url, 0, FileSource_remoteBeginSize);
+    if (!range.errorText.isEmpty())
+        return;
+
+    m_isRemoteOpen = true;
+    m_size = range.fileSize;
+    m_contentsSize = m_size;
+    m_compression = probeCompression(std::string_view(range.data.constData(), range.data.size()));
+    if (m_compression != Compression::None) {
+        // End of the file isn't fetched, so decompressed size is unknown
+        m_bufferBegin = decompressBegin(
+                    std::string_view(range.data.constData(), range.data.size()),
+                    m_compression,
+                    FileSource_bufferBeginSize);
+        m_contentsSize = 0;
+        return;
+    }
+
+    m_bufferBegin = range.data;
+}
+
+} // namespace IO
+} // namespace Mayo
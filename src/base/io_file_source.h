@@ -0,0 +1,80 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "filepath.h"
+#include "io_compressed_stream.h"
+
+#include <QtCore/QByteArray>
+#include <QtCore/QFile>
+#include <QtCore/QUrl>
+#include <cstdint>
+#include <string_view>
+
+namespace Mayo {
+namespace IO {
+
+// Provides read-only access to the contents of a file, opened once and shared between format
+// probing and readers
+// File contents are memory-mapped when possible(pages are then loaded lazily by the OS), otherwise
+// only the beginning of the file is read into an internal buffer
+// Compressed files(see probeCompression()) are not mapped, contentsBegin() then provides the
+// beginning of the decompressed contents and readers have to decompress the file themselves(see
+// DecompressStreamBuffer)
+// Remote files(HTTP(S) URL, see RemoteFile::isUrl()) are not mapped either: only their first KB is
+// fetched at construction, readers then download the contents through RemoteStreamBuffer
+class FileSource {
+public:
+    FileSource(const FilePath& filepath);
+
+    const FilePath& filepath() const { return m_filepath; }
+    bool isOpen() const { return m_file.isOpen() || m_isRemoteOpen; }
+    bool isMapped() const { return m_mappedData != nullptr; }
+
+    bool isRemote() const { return !m_url.isEmpty(); }
+    // URL of the remote file, empty if file is local
+    const QUrl& url() const { return m_url; }
+    // Path to be used for file suffix and entity names, the path part of the URL if file is remote
+    FilePath nameHint() const;
+
+    // Size in bytes of the file
+    uint64_t size() const { return m_size; }
+
+    Compression compression() const { return m_compression; }
+    bool isCompressed() const { return m_compression != Compression::None; }
+    // Size in bytes of the decompressed contents if compressed, zero if unknown. Same as size() otherwise
+    uint64_t contentsSize() const { return m_contentsSize; }
+
+    // Returns zero-copy view over the whole file contents, empty if file could not be mapped
+    std::string_view contents() const;
+
+    // Returns zero-copy view over the first 'len' bytes of the file(less if file is smaller)
+    // Bytes are the decompressed ones in case the file is compressed
+    QByteArray contentsBegin(int len = 2048) const;
+
+    // Disable copy
+    FileSource(const FileSource&) = delete;
+    FileSource(FileSource&&) = delete;
+    FileSource& operator=(const FileSource&) = delete;
+    FileSource& operator=(FileSource&&) = delete;
+
+private:
+    void openRemote();
+
+    FilePath m_filepath;
+    QFile m_file;
+    QUrl m_url;
+    bool m_isRemoteOpen = false;
+    uint64_t m_size = 0;
+    uint64_t m_contentsSize = 0;
+    Compression m_compression = Compression::None;
+    const uchar* m_mappedData = nullptr;
+    QByteArray m_bufferBegin; // Fallback when memory-mapping isn't available
+};
+
+} // namespace IO
+} // namespace Mayo
@@ -24,6 +24,8 @@ std::string_view formatIdentifier(Format format)
     case Format_VRML: return "VRML";
     case Format_AMF:  return "AMF";
     case Format_DXF:  return "DXF";
+    case Format_PLY:  return "PLY";
+    case Format_3MF:  return "3MF";
     }
 
     return "";
@@ -42,6 +44,8 @@ std::string_view formatName(Format format)
     case Format_VRML: return "VRML(ISO/CEI 14772-2)";
     case Format_AMF:  return "Additive manufacturing file format(ISO/ASTM 52915:2016)";
     case Format_DXF:  return "Drawing Exchange Format";
+    case Format_PLY:  return "PLY(Polygon File Format)";
+    case Format_3MF:  return "3MF(3D Manufacturing Format)";
     }
 
     return "";
@@ -58,6 +62,8 @@ Span<std::string_view> formatFileSuffixes(Format format)
     static std::string_view vrml_suffix[] = { "wrl", "wrz", "vrml" };
     static std::string_view amf_suffix[] =  { "amf" };
     static std::string_view dxf_suffix[] =  { "dxf" };
+    static std::string_view ply_suffix[] =  { "ply" };
+    static std::string_view _3mf_suffix[] = { "3mf" };
 
     switch (format) {
     case Format_Unknown: return {};
@@ -70,6 +76,8 @@ Span<std::string_view> formatFileSuffixes(Format format)
     case Format_VRML: return vrml_suffix;
     case Format_AMF:  return amf_suffix;
     case Format_DXF:  return dxf_suffix;
+    case Format_PLY:  return ply_suffix;
+    case Format_3MF:  return _3mf_suffix;
     }
 
     return {};
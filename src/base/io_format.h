@@ -23,7 +23,9 @@ enum Format {
     Format_GLTF,
     Format_VRML,
     Format_AMF,
-    Format_DXF
+    Format_DXF,
+    Format_PLY,
+    Format_3MF
 };
 
 // Returns identifier(unique short name) corresponding to 'format'
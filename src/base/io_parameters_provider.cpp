@@ -0,0 +1,42 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "io_parameters_provider.h"
+
+namespace Mayo {
+namespace IO {
+
+void ParametersProvider::applyReaderParameters(Format format, Reader* reader) const
+{
+    ReaderParametersSnapshotPtr snapshot;
+    {
+        std::lock_guard<std::mutex> lock(m_mutexSnapshot);
+        auto it = m_mapFormatSnapshot.find(format);
+        if (it != m_mapFormatSnapshot.cend())
+            snapshot = it->second;
+    }
+
+    if (snapshot) {
+        reader->applyParametersSnapshot(*snapshot);
+        return;
+    }
+
+    reader->applyProperties(this->findReaderParameters(format));
+    snapshot = reader->createParametersSnapshot();
+    if (snapshot) {
+        std::lock_guard<std::mutex> lock(m_mutexSnapshot);
+        m_mapFormatSnapshot.insert({ format, snapshot });
+    }
+}
+
+void ParametersProvider::invalidateReaderParametersSnapshot(Format format)
+{
+    std::lock_guard<std::mutex> lock(m_mutexSnapshot);
+    m_mapFormatSnapshot.erase(format);
+}
+
+} // namespace IO
+} // namespace Mayo
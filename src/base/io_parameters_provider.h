@@ -7,6 +7,9 @@
 #pragma once
 
 #include "io_format.h"
+#include "io_reader.h"
+#include <mutex>
+#include <unordered_map>
 
 namespace Mayo { class PropertyGroup; }
 
@@ -16,8 +19,25 @@ namespace IO {
 // Abstract mechanism to provide reader/writer parameters for a format
 class ParametersProvider {
 public:
+    virtual ~ParametersProvider() = default;
+
     virtual const PropertyGroup* findReaderParameters(Format format) const = 0;
     virtual const PropertyGroup* findWriterParameters(Format format) const = 0;
+
+    // Configures 'reader' with the parameters of 'format'
+    // The property group is converted once: first call creates a snapshot of the parameters applied
+    // to 'reader', next calls apply that snapshot directly(see Reader::applyParametersSnapshot())
+    // Readers not supporting snapshots are configured with Reader::applyProperties()
+    // Thread-safe
+    void applyReaderParameters(Format format, Reader* reader) const;
+
+protected:
+    // To be called when parameters of 'format' changed, so the snapshot is created again
+    void invalidateReaderParametersSnapshot(Format format);
+
+private:
+    mutable std::mutex m_mutexSnapshot;
+    mutable std::unordered_map<Format, ReaderParametersSnapshotPtr> m_mapFormatSnapshot;
 };
 
 } // namespace IO
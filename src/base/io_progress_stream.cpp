@@ -0,0 +1,112 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "io_progress_stream.h"
+#include "task_progress.h"
+
+#include <algorithm>
+
+namespace Mayo {
+namespace IO {
+
+namespace {
+
+// Abort requests are checked each time a chunk is consumed/produced
+constexpr size_t ProgressStream_chunkSize = 256 * 1024;
+
+} // namespace
+
+ProgressInputStreamBuffer::ProgressInputStreamBuffer(
+        std::streambuf* source, uint64_t totalSize, TaskProgress* progress)
+    : m_source(source),
+      m_totalSize(totalSize),
+      m_progress(progress),
+      m_buffer(ProgressStream_chunkSize)
+{
+    this->setg(nullptr, nullptr, nullptr);
+}
+
+ProgressInputStreamBuffer::int_type ProgressInputStreamBuffer::underflow()
+{
+    if (this->gptr() < this->egptr())
+        return traits_type::to_int_type(*this->gptr());
+
+    if (m_isAborted || !m_source)
+        return traits_type::eof();
+
+    if (TaskProgress::isAbortRequested(m_progress)) {
+        m_isAborted = true;
+        return traits_type::eof();
+    }
+
+    const std::streamsize readSize = m_source->sgetn(m_buffer.data(), m_buffer.size());
+    if (readSize <= 0)
+        return traits_type::eof();
+
+    m_consumedSize += uint64_t(readSize);
+    if (m_progress) {
+        m_progress->addProcessedBytes(uint64_t(readSize));
+        if (m_totalSize > 0)
+            m_progress->setValue(int(std::min<uint64_t>(100, (100 * m_consumedSize) / m_totalSize)));
+    }
+
+    char* bufferData = m_buffer.data();
+    this->setg(bufferData, bufferData, bufferData + readSize);
+    return traits_type::to_int_type(*this->gptr());
+}
+
+AbortableOutputStreamBuffer::AbortableOutputStreamBuffer(std::streambuf* sink, TaskProgress* progress)
+    : m_sink(sink),
+      m_progress(progress),
+      m_buffer(ProgressStream_chunkSize)
+{
+    this->setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+}
+
+AbortableOutputStreamBuffer::~AbortableOutputStreamBuffer()
+{
+    this->flushBuffer();
+}
+
+AbortableOutputStreamBuffer::int_type AbortableOutputStreamBuffer::overflow(int_type ch)
+{
+    if (!this->flushBuffer())
+        return traits_type::eof();
+
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+        *this->pptr() = traits_type::to_char_type(ch);
+        this->pbump(1);
+    }
+
+    return traits_type::not_eof(ch);
+}
+
+int AbortableOutputStreamBuffer::sync()
+{
+    return this->flushBuffer() && m_sink && m_sink->pubsync() == 0 ? 0 : -1;
+}
+
+bool AbortableOutputStreamBuffer::flushBuffer()
+{
+    if (m_isAborted || !m_sink)
+        return false;
+
+    if (TaskProgress::isAbortRequested(m_progress)) {
+        m_isAborted = true;
+        return false;
+    }
+
+    const std::streamsize size = this->pptr() - this->pbase();
+    const bool ok = size == 0 || m_sink->sputn(this->pbase(), size) == size;
+    if (ok && size > 0 && m_progress)
+        m_progress->addProcessedBytes(uint64_t(size));
+
+    this->setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+    return ok;
+}
+
+} // namespace IO
+} // namespace Mayo
@@ -0,0 +1,72 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <streambuf>
+#include <vector>
+
+namespace Mayo {
+
+class TaskProgress;
+
+namespace IO {
+
+// Input stream buffer forwarding the contents of another stream buffer, used to feed OpenCascade
+// parsers that don't report progress(eg STEP parsing)
+// Progress is reported by count of bytes consumed if total size is known(non zero). On abort
+// request end of stream is reported, so the parser stops early and fails
+class ProgressInputStreamBuffer : public std::streambuf {
+public:
+    ProgressInputStreamBuffer(std::streambuf* source, uint64_t totalSize, TaskProgress* progress);
+
+    bool isAborted() const { return m_isAborted; }
+
+    // Disable copy
+    ProgressInputStreamBuffer(const ProgressInputStreamBuffer&) = delete;
+    ProgressInputStreamBuffer& operator=(const ProgressInputStreamBuffer&) = delete;
+
+protected:
+    int_type underflow() override;
+
+private:
+    std::streambuf* m_source = nullptr;
+    uint64_t m_totalSize = 0;
+    uint64_t m_consumedSize = 0;
+    TaskProgress* m_progress = nullptr;
+    bool m_isAborted = false;
+    std::vector<char> m_buffer;
+};
+
+// Output stream buffer forwarding to another stream buffer until abort is requested, writes then
+// fail so the stream enters the bad state. Used for OpenCascade writers not checking for abort
+class AbortableOutputStreamBuffer : public std::streambuf {
+public:
+    AbortableOutputStreamBuffer(std::streambuf* sink, TaskProgress* progress);
+    ~AbortableOutputStreamBuffer();
+
+    bool isAborted() const { return m_isAborted; }
+
+    // Disable copy
+    AbortableOutputStreamBuffer(const AbortableOutputStreamBuffer&) = delete;
+    AbortableOutputStreamBuffer& operator=(const AbortableOutputStreamBuffer&) = delete;
+
+protected:
+    int_type overflow(int_type ch) override;
+    int sync() override;
+
+private:
+    bool flushBuffer();
+
+    std::streambuf* m_sink = nullptr;
+    TaskProgress* m_progress = nullptr;
+    bool m_isAborted = false;
+    std::vector<char> m_buffer;
+};
+
+} // namespace IO
+} // namespace Mayo
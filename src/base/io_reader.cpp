@@ -5,8 +5,15 @@
 ****************************************************************************/
 
 #include "io_reader.h"
+#include "io_file_source.h"
+#include "io_remote_file.h"
 #include "messenger.h"
 
+#include <QtCore/QDir>
+#include <QtCore/QTemporaryFile>
+#include <istream>
+#include <iterator>
+
 namespace Mayo {
 namespace IO {
 
@@ -15,6 +22,56 @@ Reader::Reader()
 {
 }
 
+Reader::~Reader()
+{
+}
+
+bool Reader::readFileSource(const FileSource& source, TaskProgress* progress)
+{
+    // Readers supporting compressed files override this function
+    if (source.isCompressed())
+        return false;
+
+    if (source.isRemote()) {
+        // Contents are consumed while they are downloaded
+        RemoteStreamBuffer streamBuffer(source.url());
+        std::istream istr(&streamBuffer);
+        return this->readStream(istr, source.nameHint(), progress) && !streamBuffer.hasError();
+    }
+
+    return this->readFile(source.filepath(), progress);
+}
+
+bool Reader::readBuffer(Span<const uint8_t> data, const FilePath& nameHint, TaskProgress* progress)
+{
+    // Keep file suffix as some readers rely on it(eg to select binary or text variant)
+    QString fileTemplate = QDir::temp().filePath("mayo_XXXXXX");
+    const std::string suffix = nameHint.extension().u8string();
+    if (!suffix.empty())
+        fileTemplate += QString::fromStdString(suffix);
+
+    m_tempFile = std::make_unique<QTemporaryFile>(fileTemplate);
+    if (!m_tempFile->open())
+        return false;
+
+    const auto dataSize = static_cast<qint64>(data.size());
+    const bool okWrite = m_tempFile->write(reinterpret_cast<const char*>(data.data()), dataSize) == dataSize;
+    m_tempFile->close();
+    if (!okWrite)
+        return false;
+
+    return this->readFile(filepathFrom(m_tempFile->fileName()), progress);
+}
+
+bool Reader::readStream(std::istream& istr, const FilePath& nameHint, TaskProgress* progress)
+{
+    m_streamContents.assign(std::istreambuf_iterator<char>(istr), std::istreambuf_iterator<char>());
+    if (istr.bad())
+        return false;
+
+    return this->readBuffer(m_streamContents, nameHint, progress);
+}
+
 void Reader::setMessenger(Messenger* messenger)
 {
     if (messenger)
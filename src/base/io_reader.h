@@ -11,7 +11,11 @@
 #include "io_format.h"
 #include "span.h"
 #include <TDF_LabelSequence.hxx>
+#include <iosfwd>
 #include <memory>
+#include <vector>
+
+class QTemporaryFile;
 
 namespace Mayo {
 
@@ -21,20 +25,75 @@ class TaskProgress;
 
 namespace IO {
 
+class FileSource;
+
+// Reader parameters in compiled form, ie plain values converted once from a property group
+// Immutable once created, so a snapshot can be shared by readers running in different threads
+class ReaderParametersSnapshot {
+public:
+    virtual ~ReaderParametersSnapshot() = default;
+};
+
+using ReaderParametersSnapshotPtr = std::shared_ptr<const ReaderParametersSnapshot>;
+
+// Snapshot holding a copy of the 'Parameters' struct of a reader
+template<typename PARAMETERS>
+class ReaderParametersSnapshotOf : public ReaderParametersSnapshot {
+public:
+    ReaderParametersSnapshotOf(const PARAMETERS& params) : m_params(params) {}
+    const PARAMETERS& params() const { return m_params; }
+
+    static ReaderParametersSnapshotPtr create(const PARAMETERS& params) {
+        return std::make_shared<ReaderParametersSnapshotOf<PARAMETERS>>(params);
+    }
+
+    // Assigns '*params' if 'snapshot' holds a PARAMETERS object
+    static bool apply(const ReaderParametersSnapshot& snapshot, PARAMETERS* params) {
+        auto ptr = dynamic_cast<const ReaderParametersSnapshotOf<PARAMETERS>*>(&snapshot);
+        if (ptr)
+            *params = ptr->params();
+
+        return ptr != nullptr;
+    }
+
+private:
+    const PARAMETERS m_params;
+};
+
 class Reader {
 public:
     Reader();
-    virtual ~Reader() = default;
+    virtual ~Reader();
 
     virtual bool readFile(const FilePath& fp, TaskProgress* progress) = 0;
+    // Same as readFile() but reuses file already opened(eg for format probing)
+    // Default implementation calls readFile() with source file path, and fails if source is compressed
+    // Remote source is downloaded through a stream passed to readStream()
+    virtual bool readFileSource(const FileSource& source, TaskProgress* progress);
+    // Reads contents held in memory, 'nameHint' is the path the contents would have on disk(used
+    // for naming of entities, file suffix and companion files)
+    // Default implementation writes 'data' into a temporary file which is then passed to readFile(),
+    // that file exists until the reader is destroyed
+    virtual bool readBuffer(Span<const uint8_t> data, const FilePath& nameHint, TaskProgress* progress);
+    // Reads contents of stream 'istr' until end, see readBuffer() for 'nameHint'
+    // Default implementation collects the stream into a buffer owned by the reader then passes it
+    // to readBuffer()
+    virtual bool readStream(std::istream& istr, const FilePath& nameHint, TaskProgress* progress);
     virtual TDF_LabelSequence transfer(DocumentPtr doc, TaskProgress* progress) = 0;
     virtual void applyProperties(const PropertyGroup* /*params*/) {}
 
+    // Snapshot of the current parameters, null if not supported by the reader
+    virtual ReaderParametersSnapshotPtr createParametersSnapshot() const { return {}; }
+    // Applies snapshot created by a reader of the same type, avoids the conversion of property values
+    virtual void applyParametersSnapshot(const ReaderParametersSnapshot& /*snapshot*/) {}
+
     Messenger* messenger() const { return m_messenger; }
     void setMessenger(Messenger* messenger);
 
 private:
     Messenger* m_messenger = nullptr;
+    std::unique_ptr<QTemporaryFile> m_tempFile; // Fallback of readBuffer()
+    std::vector<uint8_t> m_streamContents; // Fallback of readStream()
 };
 
 class FactoryReader {
@@ -0,0 +1,245 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "io_remote_file.h"
+
+#include <QtCore/QEventLoop>
+#include <QtCore/QTimer>
+#include <QtNetwork/QNetworkAccessManager>
+#include <QtNetwork/QNetworkReply>
+#include <QtNetwork/QNetworkRequest>
+#include <algorithm>
+#include <memory>
+
+namespace Mayo {
+namespace IO {
+
+namespace {
+
+constexpr qint64 Remote_blockSize = 256 * 1024;
+constexpr size_t Remote_maxQueuedBlockCount = 16;
+constexpr int Remote_stopCheckInterval = 100; // ms
+
+QNetworkRequest createRequest(const QUrl& url)
+{
+    QNetworkRequest request(url);
+    request.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
+    return request;
+}
+
+int httpStatusCode(const QNetworkReply* reply)
+{
+    return reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+}
+
+// Total size found in a header like "Content-Range: bytes 0-1023/146515", zero if unknown("*")
+uint64_t contentRangeTotalSize(const QByteArray& header)
+{
+    const int pos = header.lastIndexOf('/');
+    if (pos < 0)
+        return 0;
+
+    bool ok = false;
+    const qulonglong size = header.mid(pos + 1).trimmed().toULongLong(&ok);
+    return ok ? size : 0;
+}
+
+} // namespace
+
+bool RemoteFile::isUrl(std::string_view str)
+{
+    const QString qstr = QString::fromUtf8(str.data(), int(std::min<size_t>(str.size(), 8)));
+    return qstr.startsWith("http://", Qt::CaseInsensitive) || qstr.startsWith("https://", Qt::CaseInsensitive);
+}
+
+bool RemoteFile::isUrl(const FilePath& fp)
+{
+    return RemoteFile::isUrl(fp.u8string());
+}
+
+QUrl RemoteFile::toUrl(const FilePath& fp)
+{
+    return QUrl(QString::fromStdString(fp.u8string()));
+}
+
+FilePath RemoteFile::nameHint(const QUrl& url)
+{
+    return filepathFrom(url.path(QUrl::FullyDecoded));
+}
+
+RemoteFile::RangeResult RemoteFile::fetchRange(const QUrl& url, uint64_t offset, int len)
+{
+    RangeResult result;
+    QNetworkAccessManager manager;
+    QNetworkRequest request = createRequest(url);
+    request.setRawHeader(
+                "Range",
+                "bytes=" + QByteArray::number(qulonglong(offset))
+                + "-" + QByteArray::number(qulonglong(offset + std::max(len, 1) - 1)));
+    std::unique_ptr<QNetworkReply> reply(manager.get(request));
+    QEventLoop loop;
+    bool isTruncated = false;
+    QObject::connect(reply.get(), &QNetworkReply::readyRead, &loop, [&]{
+        result.data += reply->read(len - result.data.size());
+        if (result.data.size() >= len && !reply->isFinished()) {
+            isTruncated = true;
+            reply->abort();
+        }
+    });
+    QObject::connect(reply.get(), &QNetworkReply::finished, &loop, &QEventLoop::quit);
+    if (!reply->isFinished())
+        loop.exec();
+
+    result.data += reply->read(len - result.data.size());
+    const int statusCode = httpStatusCode(reply.get());
+    if (statusCode == 206) {
+        result.fileSize = contentRangeTotalSize(reply->rawHeader("Content-Range"));
+    }
+    else if (statusCode == 416) {
+        // Range not satisfiable: 'offset' is past the end, typically empty file
+        result.data.clear();
+        result.fileSize = contentRangeTotalSize(reply->rawHeader("Content-Range"));
+        return result;
+    }
+    else if (statusCode == 200) {
+        // Range ignored by the server, whole contents were sent from start
+        if (offset > 0) {
+            result.data.clear();
+            result.errorText = QNetworkReply::tr("Server doesn't support range requests");
+            return result;
+        }
+
+        result.fileSize = reply->header(QNetworkRequest::ContentLengthHeader).toULongLong();
+    }
+
+    if (reply->error() != QNetworkReply::NoError && !isTruncated)
+        result.errorText = reply->errorString();
+
+    return result;
+}
+
+RemoteStreamBuffer::RemoteStreamBuffer(const QUrl& url)
+{
+    this->setg(nullptr, nullptr, nullptr);
+    m_thread = std::thread([=]{ this->runDownload(url); });
+}
+
+RemoteStreamBuffer::~RemoteStreamBuffer()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isStopRequested = true;
+    }
+
+    m_condQueueNotFull.notify_all();
+    m_thread.join();
+}
+
+bool RemoteStreamBuffer::hasError() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return !m_errorText.isEmpty();
+}
+
+QString RemoteStreamBuffer::errorText() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_errorText;
+}
+
+RemoteStreamBuffer::int_type RemoteStreamBuffer::underflow()
+{
+    if (this->gptr() < this->egptr())
+        return traits_type::to_int_type(*this->gptr());
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_condBlockAvailable.wait(lock, [=]{ return !m_queueBlock.empty() || m_isDownloadDone; });
+        if (m_queueBlock.empty())
+            return traits_type::eof();
+
+        m_currentBlock = std::move(m_queueBlock.front());
+        m_queueBlock.pop_front();
+    }
+
+    m_condQueueNotFull.notify_one();
+    m_consumedSize += m_currentBlock.size();
+    char* blockData = m_currentBlock.data();
+    this->setg(blockData, blockData, blockData + m_currentBlock.size());
+    return traits_type::to_int_type(*this->gptr());
+}
+
+void RemoteStreamBuffer::runDownload(const QUrl& url)
+{
+    // Network objects live in the download thread, which runs its own event loop
+    QNetworkAccessManager manager;
+    std::unique_ptr<QNetworkReply> reply(manager.get(createRequest(url)));
+    // Bounds the data buffered by Qt while the reading thread is behind
+    reply->setReadBufferSize(Remote_blockSize * 4);
+    bool isStopped = false;
+    auto fnPushAvailableBlocks = [&]{
+        while (!isStopped && reply->bytesAvailable() > 0) {
+            std::vector<char> block(size_t(std::min(reply->bytesAvailable(), Remote_blockSize)));
+            const qint64 readSize = reply->read(block.data(), qint64(block.size()));
+            if (readSize <= 0)
+                return;
+
+            block.resize(size_t(readSize));
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condQueueNotFull.wait(lock, [=]{
+                return m_queueBlock.size() < Remote_maxQueuedBlockCount || m_isStopRequested;
+            });
+            if (m_isStopRequested) {
+                isStopped = true;
+                lock.unlock();
+                reply->abort();
+                return;
+            }
+
+            m_queueBlock.push_back(std::move(block));
+            lock.unlock();
+            m_condBlockAvailable.notify_one();
+        }
+    };
+
+    QEventLoop loop;
+    QTimer timerStopCheck;
+    QObject::connect(reply.get(), &QNetworkReply::readyRead, &loop, fnPushAvailableBlocks);
+    QObject::connect(reply.get(), &QNetworkReply::finished, &loop, &QEventLoop::quit);
+    QObject::connect(&timerStopCheck, &QTimer::timeout, &loop, [&]{
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            isStopped = m_isStopRequested;
+        }
+
+        if (isStopped)
+            reply->abort();
+    });
+    timerStopCheck.start(Remote_stopCheckInterval);
+    if (!reply->isFinished())
+        loop.exec();
+
+    fnPushAvailableBlocks();
+    QString errorText;
+    if (!isStopped) {
+        const int statusCode = httpStatusCode(reply.get());
+        if (reply->error() != QNetworkReply::NoError)
+            errorText = reply->errorString();
+        else if (statusCode != 0 && statusCode != 200 && statusCode != 206)
+            errorText = QString("HTTP status %1").arg(statusCode);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_isDownloadDone = true;
+        m_errorText = errorText;
+    }
+
+    m_condBlockAvailable.notify_all();
+}
+
+} // namespace IO
+} // namespace Mayo
@@ -0,0 +1,95 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "filepath.h"
+
+#include <QtCore/QByteArray>
+#include <QtCore/QString>
+#include <QtCore/QUrl>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <streambuf>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace Mayo {
+namespace IO {
+
+// Read-only access to files served over HTTP(S), typically objects of a storage bucket reached
+// with presigned URLs(ex: Amazon S3)
+// Server is expected to support "Range" requests, so the beginning of a file can be fetched
+// without downloading it entirely. Size of a file is taken from the "Content-Range" header of a
+// range request: HEAD requests are not used as a presigned URL is valid for a single HTTP method
+namespace RemoteFile {
+
+// Whether 'str' is a URL with "http" or "https" scheme
+bool isUrl(std::string_view str);
+bool isUrl(const FilePath& fp);
+
+// Returns the URL held by 'fp', see isUrl()
+QUrl toUrl(const FilePath& fp);
+
+// Returns the path part of 'url'(ex: "/bucket/part.stl"), query items like the signature of a
+// presigned URL are dropped. To be used as name hint by readers(file suffix, entity names)
+FilePath nameHint(const QUrl& url);
+
+struct RangeResult {
+    QByteArray data;
+    uint64_t fileSize = 0; // Zero if unknown
+    QString errorText; // Empty on success
+};
+
+// Fetches at most 'len' bytes of the file, starting at 'offset'. Blocks until completion
+// If the server doesn't support range requests then transfer is aborted once 'len' bytes are received
+RangeResult fetchRange(const QUrl& url, uint64_t offset, int len);
+
+} // namespace RemoteFile
+
+// Input stream buffer over the contents of a remote file, bytes are available to the reading
+// thread as soon as they arrive
+// Download runs in a separate thread filling a bounded queue of blocks which are consumed by the
+// reading thread, so network transfer is pipelined with parsing and memory usage is bounded
+class RemoteStreamBuffer : public std::streambuf {
+public:
+    RemoteStreamBuffer(const QUrl& url);
+    ~RemoteStreamBuffer();
+
+    // Whether the download failed. To be checked once end of stream is reached
+    bool hasError() const;
+    QString errorText() const;
+
+    // Count of bytes consumed so far
+    uint64_t consumedSize() const { return m_consumedSize; }
+
+    // Disable copy
+    RemoteStreamBuffer(const RemoteStreamBuffer&) = delete;
+    RemoteStreamBuffer& operator=(const RemoteStreamBuffer&) = delete;
+
+protected:
+    int_type underflow() override;
+
+private:
+    void runDownload(const QUrl& url);
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_condBlockAvailable;
+    std::condition_variable m_condQueueNotFull;
+    std::deque<std::vector<char>> m_queueBlock;
+    bool m_isDownloadDone = false;
+    bool m_isStopRequested = false;
+    QString m_errorText;
+    std::vector<char> m_currentBlock; // Block being consumed
+    uint64_t m_consumedSize = 0;
+    std::thread m_thread;
+};
+
+} // namespace IO
+} // namespace Mayo
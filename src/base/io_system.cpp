@@ -6,21 +6,36 @@
 
 #include "io_system.h"
 
+#include "brep_utils.h"
+#include "caf_utils.h"
 #include "document.h"
+#include "io_file_source.h"
+#include "memory_usage.h"
 #include "io_parameters_provider.h"
 #include "io_reader.h"
 #include "io_writer.h"
 #include "messenger.h"
+#include "profiler.h"
+#include "shape_deduplication.h"
 #include "task_manager.h"
 #include "task_progress.h"
 
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QtEndian>
+#include <BRep_Builder.hxx>
+#include <Standard_Failure.hxx>
+#include <TDataXtd_Triangulation.hxx>
+#include <TopoDS_Face.hxx>
+
 #include <algorithm>
-#include <array>
-#include <fstream>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <future>
-#include <locale>
 #include <mutex>
-#include <regex>
+#include <shared_mutex>
+#include <unordered_map>
 #include <vector>
 
 namespace Mayo {
@@ -39,67 +54,406 @@ Messenger* nullMessenger()
     return NullMessenger::instance();
 }
 
+// Returns the description of the exception being handled, must be called within a catch block
+QString currentExceptionText()
+{
+    try {
+        throw;
+    } catch (const Standard_Failure& err) {
+        return QString::fromUtf8(err.GetMessageString());
+    } catch (const std::exception& err) {
+        return QString::fromUtf8(err.what());
+    } catch (...) {
+        return System::tr("Unknown exception");
+    }
+}
+
+// Hash of the geometry of entity 'label', used to detect changed entities when reloading a document
+// Triangulations of BRep shapes are excluded, they depend on meshing parameters
+QByteArray entityGeometryHash(const TDF_Label& label, bool isMeshFormat)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    if (XCaf::isShape(label)) {
+        BRepUtils::addShapeToHash(XCaf::shape(label), &hash, isMeshFormat);
+    }
+    else if (auto attrPolyTri = CafUtils::findAttribute<TDataXtd_Triangulation>(label)) {
+        // Mesh entity, triangulation is serialized as the one of a face without surface
+        TopoDS_Face face;
+        BRep_Builder().MakeFace(face, attrPolyTri->Get());
+        BRepUtils::addShapeToHash(face, &hash, true);
+    }
+
+    return hash.result();
+}
+
+// Whether writers of 'format' depend on process-global state, so can't be run concurrently with
+// each other. STEP/IGES writers rely on Interface_Static variables and the global mutex of
+// OpenCascade CAF
+bool writerUsesGlobalState(Format format)
+{
+    return format == Format_STEP || format == Format_IGES;
+}
+
+// Writers expect actual shapes in actual coordinates, so deferred shapes(if any) of the items are
+// loaded first and deferred scalings are applied
+void applyDeferredData(Span<const ApplicationItem> spanAppItem)
+{
+    for (const ApplicationItem& appItem : spanAppItem) {
+        if (appItem.isDocument())
+            appItem.document()->loadAllDeferredShapes();
+        else if (appItem.isDocumentTreeNode())
+            appItem.document()->loadDeferredShapes(appItem.documentTreeNode().id());
+
+        // Scaling of an entity can't be applied alone, prototypes might be shared with other entities
+        if (appItem.document())
+            appItem.document()->applyDeferredScalings();
+    }
+}
+
+// Calls 'fnMesher' concurrently on the top-level shapes of the items
+void meshShapes(Span<const ApplicationItem> spanAppItem, const ShapeMesher& fnMesher, TaskProgress* progress)
+{
+    std::vector<TopoDS_Shape> vecShape;
+    for (const ApplicationItem& appItem : spanAppItem) {
+        if (appItem.isDocument()) {
+            for (const TDF_Label& label : appItem.document()->xcaf().topLevelFreeShapes())
+                vecShape.push_back(XCaf::shape(label));
+        }
+        else if (appItem.isDocumentTreeNode() && XCaf::isShape(appItem.documentTreeNode().label())) {
+            vecShape.push_back(XCaf::shape(appItem.documentTreeNode().label()));
+        }
+    }
+
+    TaskManager::runConcurrently(int(vecShape.size()), progress, [&](int i, TaskProgress* progressShape) {
+        fnMesher(vecShape.at(i), progressShape);
+    });
+}
+
 bool containsFormat(Span<const Format> spanFormat, Format format)
 {
     auto itFormat = std::find(spanFormat.begin(), spanFormat.end(), format);
     return itFormat != spanFormat.end();
 }
 
+bool isAsciiSpace(char c)
+{
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+void toAsciiLower(std::string* str)
+{
+    for (char& c : *str) {
+        if (c >= 'A' && c <= 'Z')
+            c += 'a' - 'A';
+    }
+}
+
+void addSuffixFormat(std::unordered_map<std::string, Format>* mapSuffixFormat, Format format)
+{
+    for (std::string_view suffix : formatFileSuffixes(format)) {
+        std::string key(suffix);
+        toAsciiLower(&key);
+        mapSuffixFormat->emplace(std::move(key), format);
+    }
+}
+
+// Measures the elapsed time of an operation phase, reported on destruction
+class PhaseTimer {
+public:
+    PhaseTimer(const System::PhaseFinished& fn, const FilePath& fp, Format format, System::Phase phase)
+        : m_fn(fn), m_report{ fp, format, phase, 0 }, m_start(std::chrono::steady_clock::now())
+    {}
+
+    ~PhaseTimer() {
+        if (m_fn) {
+            const auto elapsed = std::chrono::steady_clock::now() - m_start;
+            m_report.elapsedUsec = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+            m_fn(m_report);
+        }
+    }
+
+    void setFormat(Format format) { m_report.format = format; }
+
+private:
+    const System::PhaseFinished& m_fn;
+    System::PhaseReport m_report;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+// Fills the stats of a STEP file from its header and from the end of its data section, so scan is
+// quick whatever the file size
+void scanFileStats_STEP(const FileSource& source, FileMetadata* metadata)
+{
+    // Header contains for example: FILE_SCHEMA(('AUTOMOTIVE_DESIGN { 1 0 10303 214 1 1 1 1 }'));
+    const QByteArray header = source.contentsBegin(8192);
+    const int posSchema = header.indexOf("FILE_SCHEMA");
+    const int posQuoteBegin = posSchema >= 0 ? header.indexOf('\'', posSchema) : -1;
+    const int posQuoteEnd = posQuoteBegin >= 0 ? header.indexOf('\'', posQuoteBegin + 1) : -1;
+    if (posQuoteEnd > posQuoteBegin) {
+        QByteArray schema = header.mid(posQuoteBegin + 1, posQuoteEnd - posQuoteBegin - 1);
+        const int posBrace = schema.indexOf('{');
+        if (posBrace >= 0)
+            schema.truncate(posBrace);
+
+        metadata->schema = schema.trimmed().toStdString();
+    }
+
+    // Compressed files can't be read from their end
+    if (source.isCompressed() || source.isRemote())
+        return;
+
+    // Entities of the data section are usually numbered in sequence(#1, #2, ...), so the greatest
+    // instance name defined in the last bytes of the file estimates the count of entities
+    constexpr qint64 tailSize = 64 * 1024;
+    QByteArray tail;
+    const std::string_view contents = source.contents();
+    if (!contents.empty()) {
+        const size_t pos = contents.size() > size_t(tailSize) ? contents.size() - size_t(tailSize) : 0;
+        tail = QByteArray::fromRawData(contents.data() + pos, int(contents.size() - pos));
+    }
+    else {
+        QFile file(filepathTo<QString>(source.filepath()));
+        if (!file.open(QIODevice::ReadOnly) || !file.seek(std::max<qint64>(0, file.size() - tailSize)))
+            return;
+
+        tail = file.readAll();
+    }
+
+    int64_t maxInstanceId = -1;
+    for (int pos = tail.indexOf('#'); pos >= 0; pos = tail.indexOf('#', pos + 1)) {
+        // Instance definition "#123=" starts a line, other occurrences are references
+        if (pos > 0 && tail.at(pos - 1) != '\n' && tail.at(pos - 1) != '\r')
+            continue;
+
+        int64_t instanceId = 0;
+        int posChar = pos + 1;
+        while (posChar < tail.size() && tail.at(posChar) >= '0' && tail.at(posChar) <= '9')
+            instanceId = instanceId * 10 + (tail.at(posChar++) - '0');
+
+        const bool hasDigits = posChar > pos + 1;
+        while (posChar < tail.size() && isAsciiSpace(tail.at(posChar)))
+            ++posChar;
+
+        if (hasDigits && posChar < tail.size() && tail.at(posChar) == '=')
+            maxInstanceId = std::max(maxInstanceId, instanceId);
+    }
+
+    metadata->entityCount = maxInstanceId;
+}
+
+// Fills the stats of a STL file. Binary STL is 80 bytes of header, the count of triangles then 50
+// bytes per triangle, so count is exact when contents size matches(binary file may start with
+// "solid" as well). Count of ASCII facets is extrapolated from the beginning of the file
+void scanFileStats_STL(const FileSource& source, FileMetadata* metadata)
+{
+    constexpr int sampleSize = 64 * 1024;
+    const QByteArray sample = source.contentsBegin(sampleSize);
+    const uint64_t contentsSize = source.contentsSize();
+    if (sample.size() >= 84) {
+        const auto triangleCount = qFromLittleEndian<quint32>(sample.constData() + 80);
+        if (contentsSize == 84 + 50 * uint64_t(triangleCount)) {
+            metadata->triangleCount = triangleCount;
+            return;
+        }
+    }
+
+    if (!sample.trimmed().startsWith("solid"))
+        return;
+
+    int64_t facetCount = 0;
+    for (int pos = sample.indexOf("endfacet"); pos >= 0; pos = sample.indexOf("endfacet", pos + 8))
+        ++facetCount;
+
+    if (sample.size() < sampleSize)
+        metadata->triangleCount = facetCount;
+    else if (contentsSize > 0 && facetCount > 0)
+        metadata->triangleCount = int64_t(double(facetCount) * contentsSize / sample.size());
+}
+
+// Returns the contents of DXF section 'name'(ex: "ENTITIES"), empty if not found
+std::string_view findSection_DXF(std::string_view contents, std::string_view name, bool isBinary)
+{
+    // Section name is a whole line in ASCII files, a null-terminated string in binary files
+    auto fnFindToken = [=](std::string_view token, size_t pos) {
+        for (pos = contents.find(token, pos); pos != std::string_view::npos; pos = contents.find(token, pos + 1)) {
+            const size_t posEnd = pos + token.size();
+            const bool isTokenBegin = pos > 0 && (isBinary || contents.at(pos - 1) == '\n' || isAsciiSpace(contents.at(pos - 1)));
+            const char cEnd = posEnd < contents.size() ? contents.at(posEnd) : '\0';
+            const bool isTokenEnd = isBinary ? cEnd == '\0' : (cEnd == '\0' || cEnd == '\r' || cEnd == '\n');
+            if (isTokenBegin && isTokenEnd)
+                return pos;
+        }
+
+        return std::string_view::npos;
+    };
+
+    const size_t posName = fnFindToken(name, 0);
+    if (posName == std::string_view::npos)
+        return {};
+
+    const size_t posBegin = posName + name.size();
+    const size_t posEnd = fnFindToken("ENDSEC", posBegin);
+    return contents.substr(posBegin, posEnd != std::string_view::npos ? posEnd - posBegin : std::string_view::npos);
+}
+
+// Fills the stats of a DXF file from the sizes of its BLOCKS and ENTITIES sections. Entities are
+// counted in the beginning of the sections then count is extrapolated to the section sizes
+// Sections are located in the whole contents, so scan is skipped if file can't be mapped
+void scanFileStats_DXF(const FileSource& source, FileMetadata* metadata)
+{
+    const std::string_view contents = source.contents();
+    if (contents.empty())
+        return;
+
+    constexpr std::string_view binarySentinel = "AutoCAD Binary DXF";
+    const bool isBinary = contents.substr(0, binarySentinel.size()) == binarySentinel;
+    int64_t entityCount = -1;
+    for (std::string_view sectionName : { "BLOCKS", "ENTITIES" }) {
+        const std::string_view section = findSection_DXF(contents, sectionName, isBinary);
+        if (section.empty())
+            continue;
+
+        if (isBinary) {
+            // Group codes and values are packed, no cheap way to split them
+            constexpr size_t averageEntitySize = 64;
+            entityCount = std::max<int64_t>(entityCount, 0) + int64_t(section.size() / averageEntitySize);
+            continue;
+        }
+
+        // ASCII file is a sequence of (group code, value) line pairs, group code 0 starts an entity
+        constexpr size_t sampleSize = 64 * 1024;
+        const std::string_view sample = section.substr(0, sampleSize);
+        int64_t sampleEntityCount = 0;
+        size_t posLine = sample.find('\n');
+        while (posLine != std::string_view::npos) {
+            const size_t posCodeEnd = sample.find('\n', posLine + 1);
+            if (posCodeEnd == std::string_view::npos)
+                break;
+
+            std::string_view code = sample.substr(posLine + 1, posCodeEnd - posLine - 1);
+            while (!code.empty() && isAsciiSpace(code.front()))
+                code.remove_prefix(1);
+
+            while (!code.empty() && isAsciiSpace(code.back()))
+                code.remove_suffix(1);
+
+            if (code == "0")
+                ++sampleEntityCount;
+
+            posLine = sample.find('\n', posCodeEnd + 1); // Skip value line
+        }
+
+        // Last group of the sample is "0 ENDSEC" when the whole section was parsed
+        const int64_t sectionEntityCount =
+                section.size() <= sampleSize ?
+                    std::max<int64_t>(sampleEntityCount - 1, 0)
+                    : int64_t(double(sampleEntityCount) * section.size() / sample.size());
+        entityCount = std::max<int64_t>(entityCount, 0) + sectionEntityCount;
+    }
+
+    metadata->entityCount = entityCount;
+}
+
 } // namespace
 
-void System::addFormatProbe(const FormatProbe& probe)
+void System::addFormatProbe(const FormatProbe& probe, std::string_view leadingChars)
 {
-    m_vecFormatProbe.push_back(probe);
+    FormatProbeEntry entry;
+    entry.fnProbe = probe;
+    for (char c : leadingChars)
+        entry.leadingChars.set(static_cast<unsigned char>(c));
+
+    m_vecFormatProbe.push_back(std::move(entry));
 }
 
 Format System::probeFormat(const FilePath& filepath) const
 {
-    std::ifstream file;
-    file.open(filepath);
-    if (file.is_open()) {
-        std::array<char, 2048> buff;
-        buff.fill(0);
-        file.read(buff.data(), buff.size());
-        FormatProbeInput probeInput = {};
-        probeInput.filepath = filepath;
-        probeInput.contentsBegin = QByteArray::fromRawData(buff.data(), buff.size());
-        probeInput.hintFullSize = std::filesystem::file_size(filepath);
-        for (const FormatProbe& fnProbe : m_vecFormatProbe) {
-            const Format format = fnProbe(probeInput);
-            if (format != Format_Unknown)
-                return format;
+    const FileSource source(filepath);
+    return this->probeFormat(source);
+}
+
+Format System::probeFormat(const FileSource& source) const
+{
+    // Local file might have been probed already, typically when listed by a file browsing widget
+    FileStamp stamp;
+    if (!source.isRemote()) {
+        stamp = FileStamp::get(source.filepath());
+        FileMetadata metadata;
+        if (m_fileMetadataCache.find(source.filepath(), stamp, &metadata))
+            return metadata.format;
+    }
+
+    FileMetadata metadata;
+    metadata.format = this->probeFormatUncached(source);
+    m_fileMetadataCache.insert(source.filepath(), stamp, metadata);
+    return metadata.format;
+}
+
+FileMetadata System::fileMetadata(const FilePath& filepath) const
+{
+    const FileStamp stamp = FileStamp::get(filepath);
+    FileMetadata metadata;
+    if (m_fileMetadataCache.find(filepath, stamp, &metadata) && metadata.isScanned)
+        return metadata;
+
+    const FileSource source(filepath);
+    metadata.format = this->probeFormat(source);
+    metadata.isScanned = true;
+    metadata.contentsSize = source.contentsSize();
+    if (source.isOpen()) {
+        switch (metadata.format) {
+        case Format_STEP: scanFileStats_STEP(source, &metadata); break;
+        case Format_STL: scanFileStats_STL(source, &metadata); break;
+        case Format_DXF: scanFileStats_DXF(source, &metadata); break;
+        default: break;
         }
     }
 
-    // Try to guess from file suffix
-    std::string fileSuffix = filepath.extension().u8string();
-    if (!fileSuffix.empty() && fileSuffix.front() == '.')
-        fileSuffix.erase(fileSuffix.begin());
+    m_fileMetadataCache.insert(filepath, stamp, metadata);
+    return metadata;
+}
 
-    auto fnCharIEqual = [](char lhs, char rhs) {
-        const auto& clocale = std::locale::classic();
-        return std::tolower(lhs, clocale) == std::tolower(rhs, clocale);
-    };
-    auto fnMatchFileSuffix = [=](Format format) {
-        for (std::string_view candidate : formatFileSuffixes(format)) {
-            if (candidate.size() == fileSuffix.size()
-                    && std::equal(candidate.cbegin(), candidate.cend(), fileSuffix.cbegin(), fnCharIEqual))
-            {
-                return true;
+Format System::probeFormatUncached(const FileSource& source) const
+{
+    const FilePath filepath = source.nameHint();
+    if (source.isOpen()) {
+        FormatProbeInput probeInput = {};
+        probeInput.filepath = filepath;
+        probeInput.contentsBegin = source.contentsBegin(2048);
+        probeInput.hintFullSize = source.contentsSize();
+        probeInput.source = &source;
+        const QByteArray& sample = probeInput.contentsBegin;
+        auto itFirstNonSpace = std::find_if_not(sample.cbegin(), sample.cend(), isAsciiSpace);
+        const unsigned char firstChar = itFirstNonSpace != sample.cend() ? *itFirstNonSpace : 0;
+        for (const FormatProbeEntry& entry : m_vecFormatProbe) {
+            if (entry.leadingChars.none() || entry.leadingChars.test(firstChar)) {
+                const Format format = entry.fnProbe(probeInput);
+                if (format != Format_Unknown)
+                    return format;
             }
         }
+    }
 
-        return false;
+    // Try to guess from file suffix, compression suffix is skipped(eg "stp" for "file.stp.gz")
+    auto fnFileSuffix = [](const FilePath& fp) {
+        std::string suffix = fp.extension().u8string();
+        if (!suffix.empty() && suffix.front() == '.')
+            suffix.erase(suffix.begin());
+
+        toAsciiLower(&suffix);
+        return suffix;
     };
-    for (Format format : m_vecReaderFormat) {
-        if (fnMatchFileSuffix(format))
-            return format;
-    }
+    std::string fileSuffix = fnFileSuffix(filepath);
+    if (source.isCompressed() && fileSuffix == compressionFileSuffix(source.compression()))
+        fileSuffix = fnFileSuffix(filepath.stem());
 
-    for (Format format : m_vecWriterFormat) {
-        if (fnMatchFileSuffix(format))
-            return format;
-    }
+    auto itReader = m_mapReaderSuffixFormat.find(fileSuffix);
+    if (itReader != m_mapReaderSuffixFormat.cend())
+        return itReader->second;
+
+    auto itWriter = m_mapWriterSuffixFormat.find(fileSuffix);
+    if (itWriter != m_mapWriterSuffixFormat.cend())
+        return itWriter->second;
 
     return Format_Unknown;
 }
@@ -115,8 +469,10 @@ void System::addFactoryReader(std::unique_ptr<FactoryReader> ptr)
 
     for (Format format : ptr->formats()) {
         auto itFormat = std::find(m_vecReaderFormat.cbegin(), m_vecReaderFormat.cend(), format);
-        if (itFormat == m_vecReaderFormat.cend())
+        if (itFormat == m_vecReaderFormat.cend()) {
             m_vecReaderFormat.push_back(format);
+            addSuffixFormat(&m_mapReaderSuffixFormat, format);
+        }
     }
 
     m_vecFactoryReader.push_back(std::move(ptr));
@@ -133,8 +489,10 @@ void System::addFactoryWriter(std::unique_ptr<FactoryWriter> ptr)
 
     for (IO::Format format : ptr->formats()) {
         auto itFormat = std::find(m_vecWriterFormat.cbegin(), m_vecWriterFormat.cend(), format);
-        if (itFormat == m_vecWriterFormat.cend())
+        if (itFormat == m_vecWriterFormat.cend()) {
             m_vecWriterFormat.push_back(format);
+            addSuffixFormat(&m_mapWriterSuffixFormat, format);
+        }
     }
 
     m_vecFactoryWriter.push_back(std::move(ptr));
@@ -195,14 +553,34 @@ bool System::importInDocument(const Args_ImportInDocument& args)
     struct TaskData {
         ReaderPtr reader;
         FilePath filepath;
+        std::unique_ptr<FileSource> fileSource; // Shared by format probing and reader
         Format fileFormat = Format_Unknown;
         TaskProgress* progress = nullptr;
         TaskId taskId = 0;
         TDF_LabelSequence seqTransferredEntity;
+        uint64_t readMemory = 0; // See estimatedReadMemory()
+        bool isReadStarted = false;
         bool readSuccess = false;
         bool transferred = false;
     };
 
+    // Entities of the target document to be matched with the transferred ones, in case of reload
+    struct ReloadEntity {
+        TDF_Label label;
+        TCollection_ExtendedString name;
+        bool isMatched = false;
+    };
+    std::vector<ReloadEntity> vecReloadEntity;
+    std::unordered_map<TDF_Label, TDF_Label> mapReplacedEntity; // Transferred -> replaced entity
+    int reloadKeptCount = 0;
+    int reloadAddedCount = 0;
+    if (args.reloadEntities) {
+        for (int i = 0; i < doc->entityCount(); ++i) {
+            const TDF_Label labelEntity = doc->entityLabel(i);
+            vecReloadEntity.push_back({ labelEntity, CafUtils::labelAttrStdName(labelEntity) });
+        }
+    }
+
     auto fnEntityPostProcessRequired = [&](Format format) {
         if (args.entityPostProcess && args.entityPostProcessRequiredIf)
             return args.entityPostProcessRequiredIf(format);
@@ -218,10 +596,27 @@ bool System::importInDocument(const Args_ImportInDocument& args)
         fnAddError(fp, errorMsg);
         return false;
     };
+    auto fnProbeFile = [&](TaskData& taskData) {
+        MAYO_PROFILE_ZONE("IO::System probe");
+        PhaseTimer timer(args.phaseFinished, taskData.filepath, Format_Unknown, Phase::Probe);
+        taskData.fileSource = std::make_unique<FileSource>(taskData.filepath);
+        taskData.fileFormat = args.format;
+        if (taskData.fileFormat == Format_Unknown)
+            taskData.fileFormat = this->probeFormat(*taskData.fileSource);
+        timer.setFormat(taskData.fileFormat);
+    };
     auto fnReadFile = [&](TaskData& taskData) {
-        taskData.fileFormat = this->probeFormat(taskData.filepath);
+        if (!taskData.fileSource) // Might be already probed for admission control
+            fnProbeFile(taskData);
+
         if (taskData.fileFormat == Format_Unknown)
-            return fnReadFileError(taskData.filepath, tr("Unknown format"));
+            return args.skipUnsupportedFiles ? false : fnReadFileError(taskData.filepath, tr("Unknown format"));
+
+        if (!isCompressionSupported(taskData.fileSource->compression()))
+            return fnReadFileError(taskData.filepath, tr("Compression not supported"));
+
+        if (taskData.fileSource->isRemote() && taskData.fileSource->isCompressed())
+            return fnReadFileError(taskData.filepath, tr("Compressed remote files not supported"));
 
         int portionSize = 40;
         if (fnEntityPostProcessRequired(taskData.fileFormat))
@@ -230,32 +625,94 @@ bool System::importInDocument(const Args_ImportInDocument& args)
         TaskProgress progress(taskData.progress, portionSize, tr("Reading file"));
         taskData.reader = this->createReader(taskData.fileFormat);
         if (!taskData.reader)
-            return fnReadFileError(taskData.filepath, tr("No supporting reader"));
+            return args.skipUnsupportedFiles ? false : fnReadFileError(taskData.filepath, tr("No supporting reader"));
 
         taskData.reader->setMessenger(messenger);
-        if (args.parametersProvider) {
-            taskData.reader->applyProperties(
-                        args.parametersProvider->findReaderParameters(taskData.fileFormat));
-        }
+        if (args.parametersProvider)
+            args.parametersProvider->applyReaderParameters(taskData.fileFormat, taskData.reader.get());
 
-        if (!taskData.reader->readFile(taskData.filepath, &progress))
+        MAYO_PROFILE_ZONE("IO::System read");
+        PhaseTimer timer(args.phaseFinished, taskData.filepath, taskData.fileFormat, Phase::Read);
+        if (!taskData.reader->readFileSource(*taskData.fileSource, &progress))
             return fnReadFileError(taskData.filepath, tr("File read problem"));
 
         return true;
     };
+    // Exceptions escaping readers(eg Standard_Failure) are reported as read errors, so the file is
+    // just skipped by the import
+    auto fnReadFileNoThrow = [&](TaskData& taskData) {
+        try {
+            return fnReadFile(taskData);
+        } catch (...) {
+            return fnReadFileError(taskData.filepath, tr("File read problem\n%1").arg(currentExceptionText()));
+        }
+    };
+    // Discards the transferred entities identical to their matching entity in target document
+    // Entities with same name are matched in order of occurrence
+    auto fnFilterReloadedEntities = [&](TaskData& taskData) {
+        const bool isMeshFormat = !formatProvidesBRep(taskData.fileFormat);
+        TDF_LabelSequence seqChangedEntity;
+        for (const TDF_Label& labelEntity : taskData.seqTransferredEntity) {
+            const TCollection_ExtendedString& name = CafUtils::labelAttrStdName(labelEntity);
+            auto itMatch = std::find_if(vecReloadEntity.begin(), vecReloadEntity.end(), [&](const ReloadEntity& entity) {
+                return !entity.isMatched && entity.name == name;
+            });
+            if (itMatch == vecReloadEntity.end()) {
+                seqChangedEntity.Append(labelEntity);
+                ++reloadAddedCount;
+                continue;
+            }
+
+            itMatch->isMatched = true;
+            const bool isUnchanged =
+                    !doc->isShapeDeferred(itMatch->label)
+                    && !doc->isShapeDeferred(labelEntity)
+                    && entityGeometryHash(itMatch->label, isMeshFormat) == entityGeometryHash(labelEntity, isMeshFormat);
+            if (isUnchanged) {
+                labelEntity.ForgetAllAttributes();
+                ++reloadKeptCount;
+            }
+            else {
+                mapReplacedEntity.insert({ labelEntity, itMatch->label });
+                seqChangedEntity.Append(labelEntity);
+            }
+        }
+
+        taskData.seqTransferredEntity = seqChangedEntity;
+    };
     auto fnTransfer = [&](TaskData& taskData) {
         int portionSize = 60;
         if (fnEntityPostProcessRequired(taskData.fileFormat))
             portionSize *= (100 - args.entityPostProcessProgressSize) / 100.;
 
         TaskProgress progress(taskData.progress, portionSize, tr("Transferring file"));
+        MAYO_PROFILE_ZONE("IO::System transfer");
+        PhaseTimer timer(args.phaseFinished, taskData.filepath, taskData.fileFormat, Phase::Transfer);
         if (taskData.reader && !TaskProgress::isAbortRequested(&progress)) {
-            taskData.seqTransferredEntity = taskData.reader->transfer(doc, &progress);
+            QString errorDetails;
+            try {
+                taskData.seqTransferredEntity = taskData.reader->transfer(doc, &progress);
+            } catch (...) {
+                taskData.seqTransferredEntity.Clear();
+                errorDetails = currentExceptionText();
+            }
+
             if (taskData.seqTransferredEntity.IsEmpty())
-                fnAddError(taskData.filepath, tr("File transfer problem"));
+                fnAddError(taskData.filepath, (tr("File transfer problem") + "\n" + errorDetails).trimmed());
+
+            rootProgress->addProcessedEntities(taskData.seqTransferredEntity.Size());
+
+            if (args.reloadEntities)
+                fnFilterReloadedEntities(taskData);
+
+            // Bounding boxes are needed afterwards by meshing and graphics mapping, compute them
+            // all at once so prototypes are processed concurrently
+            doc->bndBoxCache().computePrototypeBoxes(taskData.seqTransferredEntity);
         }
 
         taskData.transferred = true;
+        taskData.fileSource.reset();
+        taskData.reader.reset(); // Release the memory held by the reader(eg parsed model)
     };
     auto fnPostProcess = [&](TaskData& taskData) {
         if (!fnEntityPostProcessRequired(taskData.fileFormat))
@@ -265,24 +722,46 @@ bool System::importInDocument(const Args_ImportInDocument& args)
                     taskData.progress,
                     args.entityPostProcessProgressSize,
                     args.entityPostProcessProgressStep);
+        MAYO_PROFILE_ZONE("IO::System post-process");
+        PhaseTimer timer(args.phaseFinished, taskData.filepath, taskData.fileFormat, Phase::PostProcess);
         const double subPortionSize = 100. / double(taskData.seqTransferredEntity.Size());
         for (const TDF_Label& labelEntity : taskData.seqTransferredEntity) {
             TaskProgress subProgress(&progress, subPortionSize);
-            args.entityPostProcess(labelEntity, &subProgress);
+            args.entityPostProcess(labelEntity, taskData.fileFormat, &subProgress);
+        }
+    };
+    auto fnDeduplicateGeometry = [&](const TDF_LabelSequence& seqEntity) {
+        TaskProgress progress(rootProgress, 0, tr("Deduplicating geometry"));
+        MAYO_PROFILE_ZONE("IO::System deduplicate");
+        const ShapeDeduplication::Report report = ShapeDeduplication::deduplicate(seqEntity, {}, &progress);
+        if (report.isModified()) {
+            messenger->emitInfo(tr("Deduplication: %1 prototypes merged into shared ones, %2 references redirected")
+                                .arg(report.mergedPrototypeCount)
+                                .arg(report.redirectedReferenceCount));
         }
     };
     auto fnAddModelTreeEntities = [&](TaskData& taskData) {
-        for (const TDF_Label& labelEntity : taskData.seqTransferredEntity)
-            doc->addEntityTreeNode(labelEntity);
+        // Done after post-process so triangulations are there, writers/graphics/selection then
+        // query indexed sub-shapes instead of exploring the shapes again
+        doc->subShapeCache().computePrototypeSubShapes(taskData.seqTransferredEntity);
+        for (const TDF_Label& labelEntity : taskData.seqTransferredEntity) {
+            auto itReplaced = mapReplacedEntity.find(labelEntity);
+            if (itReplaced != mapReplacedEntity.end())
+                doc->destroyEntity(doc->findEntityTreeNodeId(itReplaced->second));
+        }
+
+        doc->addEntityTreeNodes(taskData.seqTransferredEntity, args.concurrentModelTreeBuild);
     };
 
     if (listFilepath.size() == 1) { // Single file case
         TaskData taskData;
         taskData.filepath = listFilepath.front();
         taskData.progress = rootProgress;
-        ok = fnReadFile(taskData);
-        if (ok) {
+        if (fnReadFileNoThrow(taskData)) {
             fnTransfer(taskData);
+            if (args.deduplicateGeometry)
+                fnDeduplicateGeometry(taskData.seqTransferredEntity);
+
             fnPostProcess(taskData);
             fnAddModelTreeEntities(taskData);
         }
@@ -291,45 +770,289 @@ bool System::importInDocument(const Args_ImportInDocument& args)
         std::vector<TaskData> vecTaskData;
         vecTaskData.resize(listFilepath.size());
 
+        // Completion events of read and post-process tasks, pushed from worker threads
+        // NOTE must be declared before task managers so it outlives any running task
+        struct TaskEvent {
+            TaskData* taskData;
+            bool isPostProcess;
+        };
+        std::mutex mutexEvent;
+        std::condition_variable condEvent;
+        std::deque<TaskEvent> queueEvent;
+        auto fnPushEvent = [&](TaskEvent event) {
+            {
+                std::lock_guard<std::mutex> lock(mutexEvent);
+                queueEvent.push_back(event);
+            }
+
+            condEvent.notify_one();
+        };
+
         TaskManager childTaskManager;
         QObject::connect(&childTaskManager, &TaskManager::progressChanged, [&](TaskId, int) {
             rootProgress->setValue(childTaskManager.globalProgress());
         });
+        if (m_maxConcurrency > 0)
+            childTaskManager.setMaxConcurrency(m_maxConcurrency);
+
+        // Post-process(eg BRep meshing) of file N is executed concurrently with read of next files
+        // Post-process reads the label tree of the target document and writes to its caches, it
+        // must not overlap with transfer and model tree updates modifying the document. Post-process
+        // tasks lock the document in shared mode(entities of distinct files are post-processed
+        // concurrently), transfer and model tree updates in exclusive mode
+        // NOTE must be declared before postProcessTaskManager so it outlives any post-process task
+        std::shared_mutex mutexDocument;
+        TaskManager postProcessTaskManager;
 
         // Read files
+        // Count of files being read is bounded, so memory usage doesn't depend on the count of
+        // files(eg when importing a folder with thousands of files)
+        // Reads are also admitted within the memory budget, estimated memory of a file being held
+        // until it's transferred(see importMemoryBudget())
+        const int maxPendingReadCount = 2 * childTaskManager.maxConcurrency();
+        uint64_t memoryBudget = m_importMemoryBudget;
+        if (memoryBudget == 0) {
+            const int64_t physicalMemory = ProcessMemory::physicalBytes();
+            memoryBudget = physicalMemory > 0 ? uint64_t(physicalMemory) / 2 : 0;
+        }
+
+        int pendingReadCount = 0;
+        uint64_t pendingReadMemory = 0;
+        int nextTaskDataIndex = 0; // First file whose read isn't started
+        auto fnRunNextReads = [&]{
+            // Files not fitting in the budget are skipped so the small files following a big one
+            // are read meanwhile. Lookahead is bounded, files are read roughly in order
+            const int lookaheadEnd = std::min<int>(vecTaskData.size(), nextTaskDataIndex + 4 * maxPendingReadCount);
+            for (int i = nextTaskDataIndex; i < lookaheadEnd && pendingReadCount < maxPendingReadCount; ++i) {
+                TaskData& taskData = vecTaskData.at(i);
+                if (taskData.isReadStarted)
+                    continue;
+
+                if (memoryBudget > 0) {
+                    if (!taskData.fileSource) {
+                        fnProbeFile(taskData);
+                        const uint64_t contentsSize = taskData.fileSource->contentsSize();
+                        taskData.readMemory = System::estimatedReadMemory(taskData.fileFormat, contentsSize);
+                    }
+
+                    if (pendingReadMemory > 0 && pendingReadMemory + taskData.readMemory > memoryBudget)
+                        continue;
+                }
+
+                taskData.isReadStarted = true;
+                ++pendingReadCount;
+                pendingReadMemory += taskData.readMemory;
+                childTaskManager.run(taskData.taskId, TaskAutoDestroy::Off);
+            }
+
+            while (nextTaskDataIndex < int(vecTaskData.size()) && vecTaskData.at(nextTaskDataIndex).isReadStarted)
+                ++nextTaskDataIndex;
+        };
         for (TaskData& taskData : vecTaskData) {
             taskData.filepath = listFilepath[&taskData - &vecTaskData.front()];
             taskData.taskId = childTaskManager.newTask([&](TaskProgress* progressChild) {
                 taskData.progress = progressChild;
-                taskData.readSuccess = fnReadFile(taskData);
+                // Must not throw, completion event is expected for every file by the transfer loop
+                taskData.readSuccess = fnReadFileNoThrow(taskData);
             });
+            childTaskManager.whenDone(taskData.taskId, [&]{ fnPushEvent({ &taskData, false }); });
         }
 
-        for (const TaskData& taskData : vecTaskData)
-            childTaskManager.run(taskData.taskId, TaskAutoDestroy::Off);
+        fnRunNextReads();
 
-        // Transfer to document
+        // Transfer to document, as soon as each file is read
+        // This allows to transfer file N while other files are still being read
+        // NOTE transfers to the target document are still serialized(done in the calling thread)
         int taskDataCount = vecTaskData.size();
         while (taskDataCount > 0 && !rootProgress->isAbortRequested()) {
-            auto it = std::find_if(vecTaskData.begin(), vecTaskData.end(), [&](const TaskData& taskData) {
-                return !taskData.transferred && childTaskManager.waitForDone(taskData.taskId, 25);
-            });
+            TaskEvent event = {};
+            {
+                std::unique_lock<std::mutex> lock(mutexEvent);
+                // Timeout is only used to check periodically for abort request
+                condEvent.wait_for(lock, std::chrono::milliseconds(100), [&]{ return !queueEvent.empty(); });
+                if (queueEvent.empty())
+                    continue;
+
+                event = queueEvent.front();
+                queueEvent.pop_front();
+            }
+
+            TaskData* ptrTaskData = event.taskData;
+            if (!event.isPostProcess) {
+                --pendingReadCount;
+                fnRunNextReads();
+                // Bytes read were accounted in the child task, forward them to the importing task
+                if (ptrTaskData->progress)
+                    rootProgress->addProcessedBytes(ptrTaskData->progress->processedBytes());
+
+                if (ptrTaskData->readSuccess) {
+                    std::unique_lock<std::shared_mutex> lock(mutexDocument);
+                    fnTransfer(*ptrTaskData);
+                }
+                else {
+                    ptrTaskData->reader.reset();
+                    ptrTaskData->fileSource.reset();
+                }
 
-            if (it != vecTaskData.end()) {
-                if (it->readSuccess) {
-                    fnTransfer(*it);
-                    fnPostProcess(*it);
-                    fnAddModelTreeEntities(*it);
+                // Reader is released at this point, so is the memory estimated for the file
+                if (ptrTaskData->readMemory > 0) {
+                    pendingReadMemory -= ptrTaskData->readMemory;
+                    fnRunNextReads();
                 }
+            }
 
-                --taskDataCount;
+            // With deduplication, post-process and model tree entities are deferred until all files
+            // are transferred
+            if (!event.isPostProcess && ptrTaskData->readSuccess && !args.deduplicateGeometry) {
+                if (fnEntityPostProcessRequired(ptrTaskData->fileFormat)) {
+                    const TaskId postProcessTaskId = postProcessTaskManager.newTask([&, ptrTaskData](TaskProgress*) {
+                        std::shared_lock<std::shared_mutex> lock(mutexDocument);
+                        fnPostProcess(*ptrTaskData);
+                    });
+                    postProcessTaskManager.whenDone(postProcessTaskId, [&, ptrTaskData]{
+                        fnPushEvent({ ptrTaskData, true });
+                    });
+                    postProcessTaskManager.run(postProcessTaskId);
+                    continue; // Model tree entities will be added once post-process is finished
+                }
+
+                std::unique_lock<std::shared_mutex> lock(mutexDocument);
+                fnAddModelTreeEntities(*ptrTaskData);
+            }
+            else if (event.isPostProcess) {
+                std::unique_lock<std::shared_mutex> lock(mutexDocument);
+                fnAddModelTreeEntities(*ptrTaskData);
             }
+
+            --taskDataCount;
         } // endwhile
+
+        // Deduplicated entities may share prototypes across files, so they are post-processed file
+        // after file(eg concurrent meshing of the same faces isn't safe)
+        if (args.deduplicateGeometry && !rootProgress->isAbortRequested()) {
+            TDF_LabelSequence seqEntity;
+            for (const TaskData& taskData : vecTaskData) {
+                for (const TDF_Label& labelEntity : taskData.seqTransferredEntity)
+                    seqEntity.Append(labelEntity);
+            }
+
+            fnDeduplicateGeometry(seqEntity);
+            for (TaskData& taskData : vecTaskData) {
+                if (taskData.readSuccess) {
+                    fnPostProcess(taskData);
+                    fnAddModelTreeEntities(taskData);
+                }
+            }
+        }
+    }
+
+    if (args.reloadEntities && ok && !rootProgress->isAbortRequested()) {
+        int removedCount = 0;
+        for (const ReloadEntity& entity : vecReloadEntity) {
+            if (!entity.isMatched) {
+                doc->destroyEntity(doc->findEntityTreeNodeId(entity.label));
+                ++removedCount;
+            }
+        }
+
+        messenger->emitInfo(tr("Reload: %1 entities unchanged, %2 replaced, %3 added, %4 removed")
+                            .arg(reloadKeptCount)
+                            .arg(int(mapReplacedEntity.size()))
+                            .arg(reloadAddedCount)
+                            .arg(removedCount));
     }
 
     return ok;
 }
 
+std::vector<FilePath> System::folderFiles(const FilePath& folder, bool recursive)
+{
+    namespace fs = std::filesystem;
+    std::vector<FilePath> vecFilepath;
+    std::error_code ec;
+    auto fnAddEntry = [&](const fs::directory_entry& entry) {
+        std::error_code ecEntry;
+        if (entry.is_regular_file(ecEntry))
+            vecFilepath.push_back(entry.path());
+    };
+    constexpr auto options = fs::directory_options::skip_permission_denied;
+    if (recursive) {
+        for (fs::recursive_directory_iterator it(folder, options, ec), itEnd; !ec && it != itEnd; it.increment(ec))
+            fnAddEntry(*it);
+    }
+    else {
+        for (fs::directory_iterator it(folder, options, ec), itEnd; !ec && it != itEnd; it.increment(ec))
+            fnAddEntry(*it);
+    }
+
+    std::sort(vecFilepath.begin(), vecFilepath.end());
+    return vecFilepath;
+}
+
+uint64_t System::estimatedReadMemory(Format format, uint64_t contentsSize)
+{
+    // Rough ratios of the memory held by readers to the size of the file contents
+    switch (format) {
+    case Format_STEP: return 10 * contentsSize; // Parsed model, each entity is an object
+    case Format_IGES: return 6 * contentsSize;
+    case Format_DXF:
+    case Format_VRML: return 4 * contentsSize;
+    case Format_STL:
+    case Format_OBJ:
+    case Format_PLY:
+    case Format_GLTF:
+    case Format_AMF:
+    case Format_3MF:
+    case Format_OCCBREP: return 2 * contentsSize; // Contents translate almost directly into meshes/shapes
+    default: return 4 * contentsSize;
+    }
+}
+
+System::FileEstimate System::estimate(const FilePath& filepath) const
+{
+    const FileMetadata metadata = this->fileMetadata(filepath);
+    FileEstimate estimate;
+    estimate.format = metadata.format;
+    estimate.contentsSize = metadata.contentsSize > 0 ? metadata.contentsSize : FileStamp::get(filepath).size;
+    estimate.entityCount = metadata.entityCount;
+    estimate.triangleCount = metadata.triangleCount;
+    estimate.providesBRep = formatProvidesBRep(metadata.format);
+    estimate.providesMesh = formatProvidesMesh(metadata.format);
+    estimate.memory = System::estimatedReadMemory(metadata.format, estimate.contentsSize);
+
+    // Cost of one byte of contents, relative to mesh formats
+    auto fnWorkPerByte = [](Format format) -> uint64_t {
+        switch (format) {
+        case Format_STEP: return 8; // Parsing then translation of each entity into a shape
+        case Format_IGES: return 6;
+        case Format_DXF: return 4;
+        case Format_VRML:
+        case Format_OCCBREP: return 3;
+        default: return 1;
+        }
+    };
+    estimate.work = fnWorkPerByte(metadata.format) * estimate.contentsSize;
+
+    // Scanned counts are preferred to contents size, sizes of items vary a lot across files(ex:
+    // STEP entities with long names, DXF with many attributes)
+    // Costs per item are the ones per byte times a typical item size
+    if (metadata.format == Format_STEP && metadata.entityCount >= 0) {
+        estimate.work = uint64_t(metadata.entityCount) * 8 * 80;
+        estimate.memory = uint64_t(metadata.entityCount) * 10 * 80;
+    }
+    else if (metadata.format == Format_DXF && metadata.entityCount >= 0) {
+        estimate.work = uint64_t(metadata.entityCount) * 4 * 100;
+    }
+    else if (metadata.format == Format_STL && metadata.triangleCount >= 0) {
+        // Triangle holds 3 node indices, a normal and half a node(nodes shared by ~6 triangles)
+        // Doubled for the buffers of the reader(ex: map merging coincident nodes)
+        estimate.work = uint64_t(metadata.triangleCount) * 50;
+        estimate.memory = uint64_t(metadata.triangleCount) * (12 + 12 + 12 / 2) * 2;
+    }
+
+    return estimate;
+}
+
 System::Operation_ImportInDocument System::importInDocument() {
     return Operation_ImportInDocument(*this);
 }
@@ -350,15 +1073,36 @@ bool System::exportApplicationItems(const Args_ExportApplicationItems& args)
 
     writer->setMessenger(args.messenger);
     writer->applyProperties(args.parameters);
+    applyDeferredData(args.applicationItems);
+    if (args.shapeMesher && writer->supportsShapeMesher()) {
+        writer->setShapeMesher(args.shapeMesher, args.releaseMeshes);
+    }
+    else if (args.shapeMesher) {
+        // Meshing isn't accounted in progress value but is aborted along with the export
+        TaskProgress meshProgress(progress, 0, tr("Mesh"));
+        MAYO_PROFILE_ZONE("IO::System export meshing");
+        meshShapes(args.applicationItems, args.shapeMesher, &meshProgress);
+    }
+
+    if (TaskProgress::isAbortRequested(progress))
+        return false;
+
     {
         TaskProgress transferProgress(progress, 40, tr("Transfer"));
+        MAYO_PROFILE_ZONE("IO::System export transfer");
+        PhaseTimer timer(args.phaseFinished, args.targetFilepath, args.targetFormat, Phase::ExportTransfer);
         const bool okTransfer = writer->transfer(args.applicationItems, &transferProgress);
         if (!okTransfer)
             return fnError(tr("File transfer problem"));
     }
 
+    if (TaskProgress::isAbortRequested(progress))
+        return false;
+
     {
         TaskProgress writeProgress(progress, 60, tr("Write"));
+        MAYO_PROFILE_ZONE("IO::System export write");
+        PhaseTimer timer(args.phaseFinished, args.targetFilepath, args.targetFormat, Phase::ExportWrite);
         const bool okWriteFile = writer->writeFile(args.targetFilepath, &writeProgress);
         if (!okWriteFile)
             return fnError(tr("File write problem"));
@@ -367,6 +1111,160 @@ bool System::exportApplicationItems(const Args_ExportApplicationItems& args)
     return true;
 }
 
+bool System::exportApplicationItemsToTargets(const Args_ExportApplicationItemsToTargets& args)
+{
+    TaskProgress* rootProgress = args.progress ? args.progress : nullTaskProgress();
+    Messenger* messenger = args.messenger ? args.messenger : nullMessenger();
+
+    struct TargetData {
+        const ExportTarget* target = nullptr;
+        std::unique_ptr<Writer> writer;
+        std::vector<Messenger::Message> vecMessage; // Messages are collected, to be emitted from caller thread
+        std::unique_ptr<Messenger> messenger;
+        TaskId taskId = 0;
+        bool success = false;
+    };
+
+    auto fnErrorMessage = [](const ExportTarget& target, const QString& errorMsg) {
+        return tr("Error during export to '%1'\n%2").arg(filepathTo<QString>(target.filepath), errorMsg);
+    };
+
+    // Create writers upfront, in the calling thread
+    std::vector<TargetData> vecTargetData;
+    vecTargetData.resize(args.targets.size());
+    for (TargetData& targetData : vecTargetData) {
+        targetData.target = &args.targets[&targetData - &vecTargetData.front()];
+        targetData.messenger = std::make_unique<MessengerByCallback>(
+                    [&](Messenger::MessageType msgType, const QString& text) {
+                        targetData.vecMessage.push_back({ msgType, text });
+        });
+        targetData.writer = this->createWriter(targetData.target->format);
+        if (targetData.writer) {
+            targetData.writer->setMessenger(targetData.messenger.get());
+            targetData.writer->applyProperties(targetData.target->parameters);
+        }
+        else {
+            targetData.messenger->emitError(fnErrorMessage(*targetData.target, tr("No supporting writer")));
+        }
+    }
+
+    // Execute writers concurrently, except the ones sharing global state(see writerUsesGlobalState())
+    applyDeferredData(args.applicationItems);
+    if (args.shapeMesher) {
+        // Writers can't mesh on the fly, they would share the shapes being meshed
+        TaskProgress meshProgress(rootProgress, 0, tr("Mesh"));
+        MAYO_PROFILE_ZONE("IO::System export meshing");
+        meshShapes(args.applicationItems, args.shapeMesher, &meshProgress);
+        if (TaskProgress::isAbortRequested(rootProgress))
+            return false;
+    }
+
+    TaskManager childTaskManager;
+    QObject::connect(&childTaskManager, &TaskManager::progressChanged, [&](TaskId, int) {
+        rootProgress->setValue(childTaskManager.globalProgress());
+    });
+    if (m_maxConcurrency > 0)
+        childTaskManager.setMaxConcurrency(m_maxConcurrency);
+
+    auto fnExportTarget = [&](TargetData& targetData, TaskProgress* progress) {
+        Writer* writer = targetData.writer.get();
+        Messenger* targetMessenger = targetData.messenger.get();
+        const ExportTarget& target = *targetData.target;
+        {
+            TaskProgress transferProgress(progress, 40, tr("Transfer"));
+            MAYO_PROFILE_ZONE("IO::System export transfer");
+            PhaseTimer timer(args.phaseFinished, target.filepath, target.format, Phase::ExportTransfer);
+            if (!writer->transfer(args.applicationItems, &transferProgress)) {
+                targetMessenger->emitError(fnErrorMessage(*targetData.target, tr("File transfer problem")));
+                return;
+            }
+        }
+
+        if (TaskProgress::isAbortRequested(progress))
+            return;
+
+        {
+            TaskProgress writeProgress(progress, 60, tr("Write"));
+            MAYO_PROFILE_ZONE("IO::System export write");
+            PhaseTimer timer(args.phaseFinished, target.filepath, target.format, Phase::ExportWrite);
+            if (!writer->writeFile(targetData.target->filepath, &writeProgress)) {
+                targetMessenger->emitError(fnErrorMessage(*targetData.target, tr("File write problem")));
+                return;
+            }
+        }
+
+        targetData.success = !TaskProgress::isAbortRequested(progress);
+    };
+
+    std::vector<TaskId> vecPendingTaskId;
+    std::vector<TargetData*> vecPendingTargetData;
+    TaskId lastGlobalStateTaskId = 0;
+    for (TargetData& targetData : vecTargetData) {
+        if (!targetData.writer)
+            continue;
+
+        targetData.taskId = childTaskManager.newTask([&](TaskProgress* progress) {
+            // Exceptions escaping writers(eg Standard_Failure) are reported as errors of the target
+            try {
+                fnExportTarget(targetData, progress);
+            } catch (...) {
+                targetData.success = false;
+                const QString errorMsg = tr("File export problem\n%1").arg(currentExceptionText());
+                targetData.messenger->emitError(fnErrorMessage(*targetData.target, errorMsg));
+            }
+        });
+        // Writers sharing global state are executed one after the other
+        if (writerUsesGlobalState(targetData.target->format)) {
+            if (lastGlobalStateTaskId != 0)
+                childTaskManager.addDependency(targetData.taskId, lastGlobalStateTaskId);
+
+            lastGlobalStateTaskId = targetData.taskId;
+        }
+
+        vecPendingTaskId.push_back(targetData.taskId);
+        vecPendingTargetData.push_back(&targetData);
+    }
+
+    for (const TaskId taskId : vecPendingTaskId)
+        childTaskManager.run(taskId, TaskAutoDestroy::Off);
+
+    auto fnTargetFinished = [&](const TargetData& targetData) {
+        for (const Messenger::Message& msg : targetData.vecMessage)
+            messenger->emitMessage(msg.type, msg.text);
+
+        if (args.targetFinished)
+            args.targetFinished(*targetData.target, targetData.success);
+    };
+
+    // Writers which couldn't be created
+    for (const TargetData& targetData : vecTargetData) {
+        if (!targetData.writer)
+            fnTargetFinished(targetData);
+    }
+
+    bool isAbortPropagated = false;
+    while (!vecPendingTaskId.empty()) {
+        if (!isAbortPropagated && rootProgress->isAbortRequested()) {
+            for (const TaskId taskId : vecPendingTaskId)
+                childTaskManager.requestAbort(taskId);
+
+            isAbortPropagated = true;
+        }
+
+        // Timeout is only used to check periodically for abort request
+        const int index = childTaskManager.waitForAny(vecPendingTaskId, 100);
+        if (index >= 0) {
+            fnTargetFinished(*vecPendingTargetData.at(index));
+            vecPendingTaskId.erase(vecPendingTaskId.begin() + index);
+            vecPendingTargetData.erase(vecPendingTargetData.begin() + index);
+        }
+    }
+
+    return std::all_of(vecTargetData.cbegin(), vecTargetData.cend(), [](const TargetData& targetData) {
+        return targetData.success;
+    });
+}
+
 System::Operation_ExportApplicationItems&
 System::Operation_ExportApplicationItems::targetFile(const FilePath& filepath) {
     m_args.targetFilepath = filepath;
@@ -403,8 +1301,50 @@ System::Operation_ExportApplicationItems::withTaskProgress(TaskProgress* progres
     return *this;
 }
 
+System::Operation_ExportApplicationItems&
+System::Operation_ExportApplicationItems::withPhaseFinished(PhaseFinished fn) {
+    m_args.phaseFinished = std::move(fn);
+    return *this;
+}
+
+System::Operation_ExportApplicationItems&
+System::Operation_ExportApplicationItems::withShapeMesher(ShapeMesher fn, bool releaseMeshes) {
+    m_args.shapeMesher = std::move(fn);
+    m_args.releaseMeshes = releaseMeshes;
+    return *this;
+}
+
+System::Operation_ExportApplicationItems&
+System::Operation_ExportApplicationItems::addTarget(
+        const FilePath& filepath, Format format, const PropertyGroup* parameters) {
+    m_vecAdditionalTarget.push_back({ filepath, format, parameters });
+    return *this;
+}
+
+System::Operation_ExportApplicationItems&
+System::Operation_ExportApplicationItems::withTargetFinished(std::function<void(const ExportTarget&, bool)> fn) {
+    m_fnTargetFinished = std::move(fn);
+    return *this;
+}
+
 bool System::Operation_ExportApplicationItems::execute() {
-    return m_system.exportApplicationItems(m_args);
+    if (m_vecAdditionalTarget.empty())
+        return m_system.exportApplicationItems(m_args);
+
+    std::vector<ExportTarget> vecTarget;
+    if (!m_args.targetFilepath.empty())
+        vecTarget.push_back({ m_args.targetFilepath, m_args.targetFormat, m_args.parameters });
+
+    vecTarget.insert(vecTarget.end(), m_vecAdditionalTarget.cbegin(), m_vecAdditionalTarget.cend());
+    Args_ExportApplicationItemsToTargets args;
+    args.applicationItems = m_args.applicationItems;
+    args.targets = vecTarget;
+    args.shapeMesher = m_args.shapeMesher;
+    args.messenger = m_args.messenger;
+    args.progress = m_args.progress;
+    args.targetFinished = m_fnTargetFinished;
+    args.phaseFinished = m_args.phaseFinished;
+    return m_system.exportApplicationItemsToTargets(args);
 }
 
 System::Operation_ExportApplicationItems::Operation_ExportApplicationItems(System& system)
@@ -436,6 +1376,36 @@ System::Operation_ImportInDocument::withParametersProvider(const ParametersProvi
 }
 
 System::Operation_ImportInDocument&
+System::Operation_ImportInDocument::withFormat(Format format) {
+    m_args.format = format;
+    return *this;
+}
+
+System::Operation_ImportInDocument::Operation&
+System::Operation_ImportInDocument::withUnsupportedFilesSkipped(bool on) {
+    m_args.skipUnsupportedFiles = on;
+    return *this;
+}
+
+System::Operation_ImportInDocument::Operation&
+System::Operation_ImportInDocument::withEntitiesReloaded(bool on) {
+    m_args.reloadEntities = on;
+    return *this;
+}
+
+System::Operation_ImportInDocument::Operation&
+System::Operation_ImportInDocument::withGeometryDeduplicated(bool on) {
+    m_args.deduplicateGeometry = on;
+    return *this;
+}
+
+System::Operation_ImportInDocument::Operation&
+System::Operation_ImportInDocument::withModelTreeBuiltConcurrently(bool on) {
+    m_args.concurrentModelTreeBuild = on;
+    return *this;
+}
+
+System::Operation_ImportInDocument::Operation&
 System::Operation_ImportInDocument::withMessenger(Messenger* messenger) {
     m_args.messenger = messenger;
     return *this;
@@ -447,6 +1417,12 @@ System::Operation_ImportInDocument::withTaskProgress(TaskProgress* progress) {
     return *this;
 }
 
+System::Operation_ImportInDocument&
+System::Operation_ImportInDocument::withPhaseFinished(PhaseFinished fn) {
+    m_args.phaseFinished = std::move(fn);
+    return *this;
+}
+
 System::Operation_ImportInDocument::Operation&
 System::Operation_ImportInDocument::withFilepath(const FilePath& filepath)
 {
@@ -455,6 +1431,21 @@ System::Operation_ImportInDocument::withFilepath(const FilePath& filepath)
 
 System::Operation_ImportInDocument::Operation&
 System::Operation_ImportInDocument::withEntityPostProcess(std::function<void (TDF_Label, TaskProgress*)> fn)
+{
+    if (fn) {
+        m_args.entityPostProcess = [=](TDF_Label labelEntity, Format, TaskProgress* progress) {
+            fn(labelEntity, progress);
+        };
+    }
+    else {
+        m_args.entityPostProcess = {};
+    }
+
+    return *this;
+}
+
+System::Operation_ImportInDocument::Operation&
+System::Operation_ImportInDocument::withEntityPostProcess(std::function<void(TDF_Label, Format, TaskProgress*)> fn)
 {
     m_args.entityPostProcess = std::move(fn);
     return *this;
@@ -487,7 +1478,7 @@ System::Operation_ImportInDocument::Operation_ImportInDocument(System& system)
 namespace {
 
 bool isSpace(char c) {
-    return std::isspace(c, std::locale::classic());
+    return isAsciiSpace(c);
 }
 
 bool matchToken(QByteArray::const_iterator itBegin, std::string_view token) {
@@ -549,6 +1540,14 @@ Format probeFormat_OCCBREP(const System::FormatProbeInput& input)
     if (matchToken(itContentsBegin, occBRepToken))
         return Format_OCCBREP;
 
+    // Binary BRep(BinTools), regex : ^\s*Open CASCADE Topology V
+    constexpr std::string_view occBinBRepToken = "Open CASCADE Topology V";
+    if (input.contentsBegin.cend() - itContentsBegin >= int(occBinBRepToken.size())
+            && matchToken(itContentsBegin, occBinBRepToken))
+    {
+        return Format_OCCBREP;
+    }
+
     return Format_Unknown;
 }
 
@@ -586,10 +1585,100 @@ Format probeFormat_STL(const System::FormatProbeInput& input)
 
 Format probeFormat_OBJ(const System::FormatProbeInput& input)
 {
+    // regex(per line) : ^\s*(v|vt|vn|vp)\s+[-\+]?[0-9\.]+
+    // Lines before the first vertex are expected to be empty, comments or grouping/material statements
     const QByteArray& sample = input.contentsBegin;
-    const std::regex rx{ R"("^\s*(v|vt|vn|vp|surf)\s+[-\+]?[0-9\.]+\s")" };
-    if (std::regex_search(sample.cbegin(), sample.cend(), rx))
-        return Format_OBJ;
+    std::string_view contents(sample.constData(), sample.size());
+    auto fnTrimLeft = [](std::string_view str) {
+        while (!str.empty() && isSpace(str.front()))
+            str.remove_prefix(1);
+
+        return str;
+    };
+    while (!contents.empty()) {
+        const size_t posLineEnd = std::min(contents.find_first_of("\r\n"), contents.size());
+        const std::string_view line = fnTrimLeft(contents.substr(0, posLineEnd));
+        contents.remove_prefix(std::min(posLineEnd + 1, contents.size()));
+        if (line.empty() || line.front() == '#')
+            continue;
+
+        const size_t posKeywordEnd = std::min(line.find_first_of(" \t"), line.size());
+        const std::string_view keyword = line.substr(0, posKeywordEnd);
+        if (keyword == "v" || keyword == "vt" || keyword == "vn" || keyword == "vp") {
+            const std::string_view args = fnTrimLeft(line.substr(posKeywordEnd));
+            if (posKeywordEnd == line.size() || args.empty())
+                return Format_Unknown;
+
+            const char c = args.front();
+            const bool isNumber = c == '-' || c == '+' || c == '.' || (c >= '0' && c <= '9');
+            return isNumber ? Format_OBJ : Format_Unknown;
+        }
+
+        if (keyword != "mtllib" && keyword != "usemtl" && keyword != "o" && keyword != "g" && keyword != "s")
+            return Format_Unknown;
+    }
+
+    return Format_Unknown;
+}
+
+Format probeFormat_PLY(const System::FormatProbeInput& input)
+{
+    // regex : ^ply[\r\n]
+    const QByteArray& sample = input.contentsBegin;
+    constexpr std::string_view plyToken = "ply";
+    if (sample.size() > int(plyToken.size()) && matchToken(sample.cbegin(), plyToken)) {
+        const char c = sample.at(int(plyToken.size()));
+        if (c == '\n' || c == '\r')
+            return Format_PLY;
+    }
+
+    return Format_Unknown;
+}
+
+Format probeFormat_3MF(const System::FormatProbeInput& input)
+{
+    // 3MF package is a ZIP archive, check the filename of the first local file header
+    // Package parts are typically "[Content_Types].xml", "_rels/.rels" and "3D/*.model"
+    const QByteArray& sample = input.contentsBegin;
+    constexpr std::string_view zipSignature = "PK\x03\x04";
+    constexpr int filenameOffset = 30;
+    if (sample.size() <= filenameOffset || !matchToken(sample.cbegin(), zipSignature))
+        return Format_Unknown;
+
+    const auto filenameLength = qFromLittleEndian<quint16>(sample.constData() + 26);
+    const std::string_view filename(
+                sample.constData() + filenameOffset,
+                std::min<int>(filenameLength, sample.size() - filenameOffset));
+    if (filename == "[Content_Types].xml"
+            || filename.substr(0, 3) == "3D/"
+            || filename.substr(0, 6) == "_rels/")
+    {
+        return Format_3MF;
+    }
+
+    return Format_Unknown;
+}
+
+Format probeFormat_DXF(const System::FormatProbeInput& input)
+{
+    const QByteArray& sample = input.contentsBegin;
+    // Binary DXF starts with sentinel "AutoCAD Binary DXF<CR><LF><SUB><NUL>"
+    constexpr std::string_view binaryDxfSentinel("AutoCAD Binary DXF\r\n\x1a\0", 22);
+    if (sample.size() >= int(binaryDxfSentinel.size()) && matchToken(sample.cbegin(), binaryDxfSentinel))
+        return Format_DXF;
+
+    // ASCII DXF, first group is (0, SECTION)
+    // regex : ^\s*0\s*[\r\n]\s*SECTION
+    auto itChar = findFirstNonSpace(sample);
+    if (itChar != sample.cend() && *itChar == '0') {
+        auto itLineEnd = std::find_if_not(itChar + 1, sample.cend(), [](char c) { return c == ' ' || c == '\t'; });
+        if (itLineEnd != sample.cend() && (*itLineEnd == '\r' || *itLineEnd == '\n')) {
+            constexpr std::string_view sectionToken = "SECTION";
+            itChar = std::find_if_not(itLineEnd, sample.cend(), isSpace);
+            if (sample.cend() - itChar >= int(sectionToken.size()) && matchToken(itChar, sectionToken))
+                return Format_DXF;
+        }
+    }
 
     return Format_Unknown;
 }
@@ -599,11 +1688,15 @@ void addPredefinedFormatProbes(System* system)
     if (!system)
         return;
 
-    system->addFormatProbe(probeFormat_STEP);
+    // Probes of binary formats(or with a fixed-column layout) can't be dispatched on first character
+    system->addFormatProbe(probeFormat_STEP, "I");
     system->addFormatProbe(probeFormat_IGES);
-    system->addFormatProbe(probeFormat_OCCBREP);
+    system->addFormatProbe(probeFormat_OCCBREP, "DO");
     system->addFormatProbe(probeFormat_STL);
-    system->addFormatProbe(probeFormat_OBJ);
+    system->addFormatProbe(probeFormat_OBJ, "#vmogsu");
+    system->addFormatProbe(probeFormat_PLY, "p");
+    system->addFormatProbe(probeFormat_3MF, "P");
+    system->addFormatProbe(probeFormat_DXF, "A0");
 }
 
 } // namespace IO
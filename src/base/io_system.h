@@ -8,6 +8,7 @@
 
 #include "application_item.h"
 #include "filepath.h"
+#include "io_file_metadata_cache.h"
 #include "io_format.h"
 #include "io_reader.h"
 #include "io_writer.h"
@@ -15,8 +16,15 @@
 #include "span.h"
 
 #include <QtCore/QCoreApplication>
+#include <algorithm>
+#include <atomic>
+#include <bitset>
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
 
 namespace Mayo {
 
@@ -25,6 +33,7 @@ class TaskProgress;
 
 namespace IO {
 
+class FileSource;
 class ParametersProvider;
 
 // Main class to centralize access to FactoryReader/FactoryWriter objects
@@ -38,10 +47,41 @@ public:
         FilePath filepath;
         QByteArray contentsBegin; // Excerpt of the file(from start)
         uint64_t hintFullSize; // Full file size in bytes
+        const FileSource* source = nullptr; // Whole file contents, might be null
     };
     using FormatProbe = std::function<Format (const FormatProbeInput&)>;
-    void addFormatProbe(const FormatProbe& probe);
+    // 'leadingChars' restricts 'probe' to the contents whose first non-space character is one of
+    // them, other contents are dispatched to other probes without calling 'probe'
+    // Empty 'leadingChars' means the probe is called for any contents
+    void addFormatProbe(const FormatProbe& probe, std::string_view leadingChars = {});
+    // Formats of local files are cached(see fileMetadataCache()), files are probed again only if
+    // their size or modification time changed
     Format probeFormat(const FilePath& filepath) const;
+    Format probeFormat(const FileSource& source) const;
+
+    // Returns the format and basic stats of local file 'filepath', scanning it only if not done
+    // already or if file was modified since. Scan reads only the beginning and the end of the file
+    // Can be called concurrently from any thread(ex: by file browsing widgets)
+    FileMetadata fileMetadata(const FilePath& filepath) const;
+    const FileMetadataCache& fileMetadataCache() const { return m_fileMetadataCache; }
+
+    // Pre-flight cost of importing a file, to schedule batches of files before reading them
+    struct FileEstimate {
+        Format format = Format_Unknown;
+        uint64_t contentsSize = 0; // Decompressed size, file size if unknown
+        int64_t entityCount = -1; // See FileMetadata
+        int64_t triangleCount = -1; // See FileMetadata
+        bool providesBRep = false;
+        bool providesMesh = false;
+        uint64_t memory = 0; // Peak memory in bytes held by the reader, see estimatedReadMemory()
+        // Relative cost of read and transfer, comparable across formats. Unit is roughly the
+        // time taken by one thread to read one byte of a mesh file
+        uint64_t work = 0;
+    };
+    // Estimates the cost of importing local file 'filepath' from its size and from the stats found
+    // by fileMetadata()(ex: STEP entities, STL triangles, DXF sections), no reader is involved
+    // Can be called concurrently from any thread
+    FileEstimate estimate(const FilePath& filepath) const;
 
     void addFactoryReader(std::unique_ptr<FactoryReader> ptr);
     void addFactoryWriter(std::unique_ptr<FactoryWriter> ptr);
@@ -55,21 +95,66 @@ public:
     Span<const Format> readerFormats() const { return m_vecReaderFormat; }
     Span<const Format> writerFormats() const { return m_vecWriterFormat; }
 
+    // Phases of import/export services, elapsed time of each phase can be reported with a
+    // 'phaseFinished' callback. Callback might be called concurrently from several threads
+    enum class Phase { Probe, Read, Transfer, PostProcess, ExportTransfer, ExportWrite };
+    struct PhaseReport {
+        FilePath filepath;
+        Format format = Format_Unknown;
+        Phase phase = Phase::Probe;
+        int64_t elapsedUsec = 0; // Microseconds
+    };
+    using PhaseFinished = std::function<void(const PhaseReport&)>;
+
     // Import service
 
     struct Args_ImportInDocument {
         DocumentPtr targetDocument;
         Span<const FilePath> filepaths; // The files to be imported in target document
         const ParametersProvider* parametersProvider = nullptr;
-        std::function<void(TDF_Label, TaskProgress*)> entityPostProcess;
+        std::function<void(TDF_Label, Format, TaskProgress*)> entityPostProcess; // Format of the source file
         std::function<bool(Format)> entityPostProcessRequiredIf;
         int entityPostProcessProgressSize = 0;
         QString entityPostProcessProgressStep;
+        Format format = Format_Unknown; // Format of all the files, probed for each file if unknown
+        bool skipUnsupportedFiles = false; // Files of unknown format or without reader aren't errors
+        // Target document is reloaded from the files: transferred entities are matched by name with
+        // the entities of the document. Matched entities having same geometry are kept as is(the
+        // transferred ones being discarded), others are replaced. Unmatched entities are destroyed
+        bool reloadEntities = false;
+        // Identical prototypes of the transferred entities are merged into shared references(see
+        // ShapeDeduplication), before post-processing. Entities of distinct files may then share
+        // geometry, so post-processing is executed file after file once all files are transferred
+        bool deduplicateGeometry = false;
+        // Assembly trees of the transferred entities are explored concurrently before being added
+        // into the model tree of the target document(see Document::addEntityTreeNodes())
+        bool concurrentModelTreeBuild = false;
         Messenger* messenger = nullptr;
         TaskProgress* progress = nullptr;
+        PhaseFinished phaseFinished;
     };
     bool importInDocument(const Args_ImportInDocument& args);
 
+    // Regular files of 'folder' and of its sub-folders(if 'recursive'), sorted by path
+    // Folders that can't be read are ignored
+    static std::vector<FilePath> folderFiles(const FilePath& folder, bool recursive = true);
+
+    // Memory in bytes estimated to be held by the reader of a file in 'format' from read to
+    // transfer(eg the parsed STEP model), 'contentsSize' being the size of the file contents
+    static uint64_t estimatedReadMemory(Format format, uint64_t contentsSize);
+
+    // Admission control of the files read concurrently by importInDocument(): reading of a file
+    // starts only while the sum of estimatedReadMemory() of the files being read fits in the budget
+    // so big files are read one after the other, small ones concurrently. A file exceeding the
+    // budget is read alone. Zero means half of the physical memory(no limit if unknown)
+    uint64_t importMemoryBudget() const { return m_importMemoryBudget; }
+    void setImportMemoryBudget(uint64_t bytes) { m_importMemoryBudget = bytes; }
+
+    // Maximum count of files read by importInDocument() or written by exportApplicationItemsToTargets()
+    // concurrently. Zero means hardware concurrency
+    int maxConcurrency() const { return m_maxConcurrency; }
+    void setMaxConcurrency(int count) { m_maxConcurrency = std::max(0, count); }
+
     // Export service
 
     struct Args_ExportApplicationItems {
@@ -77,11 +162,37 @@ public:
         FilePath targetFilepath;
         Format targetFormat = Format_Unknown;
         const PropertyGroup* parameters = nullptr;
+        // Optional, shapes of the items might not be meshed yet. Writer meshes them on the fly if it
+        // supports it(see Writer::setShapeMesher()), otherwise they are meshed before transfer
+        ShapeMesher shapeMesher;
+        bool releaseMeshes = false; // Only for writers supporting the shape mesher
         Messenger* messenger = nullptr;
         TaskProgress* progress = nullptr;
+        PhaseFinished phaseFinished;
     };
     bool exportApplicationItems(const Args_ExportApplicationItems& args);
 
+    // Export service, many target files
+    // Writers are executed concurrently, abort request on 'progress' is propagated to all of them
+
+    struct ExportTarget {
+        FilePath filepath;
+        Format format = Format_Unknown;
+        const PropertyGroup* parameters = nullptr;
+    };
+
+    struct Args_ExportApplicationItemsToTargets {
+        Span<const ApplicationItem> applicationItems;
+        Span<const ExportTarget> targets;
+        ShapeMesher shapeMesher; // Optional, shapes not meshed yet are meshed before transfer
+        Messenger* messenger = nullptr;
+        TaskProgress* progress = nullptr;
+        // Optional callback executed when export to a target is finished(from the calling thread)
+        std::function<void(const ExportTarget&, bool)> targetFinished;
+        PhaseFinished phaseFinished;
+    };
+    bool exportApplicationItemsToTargets(const Args_ExportApplicationItemsToTargets& args);
+
     // Fluent API: import service
 
     struct Operation_ImportInDocument {
@@ -90,14 +201,26 @@ public:
         Operation& withFilepath(const FilePath& filepath);
         Operation& withFilepaths(Span<const FilePath> filepaths);
         Operation& withParametersProvider(const ParametersProvider* provider);
+        // Format of the files to be imported, probing is skipped
+        Operation& withFormat(Format format);
+        // Files not supported are ignored, typically when importing the contents of a folder
+        Operation& withUnsupportedFilesSkipped(bool on);
+        // Only entities whose geometry changed are replaced in target document(see Args_ImportInDocument)
+        Operation& withEntitiesReloaded(bool on);
+        // Identical prototypes are merged across the imported files(see Args_ImportInDocument)
+        Operation& withGeometryDeduplicated(bool on);
+        // Model tree nodes of the entities are built concurrently(see Args_ImportInDocument)
+        Operation& withModelTreeBuiltConcurrently(bool on);
 
         // Post-processing executed before adding entities into Document
         Operation& withEntityPostProcess(std::function<void(TDF_Label, TaskProgress*)> fn);
+        Operation& withEntityPostProcess(std::function<void(TDF_Label, Format, TaskProgress*)> fn);
         Operation& withEntityPostProcessRequiredIf(std::function<bool(Format)> fn);
         Operation& withEntityPostProcessInfoProgress(int progressSize, const QString& progressStep);
 
         Operation& withMessenger(Messenger* messenger);
         Operation& withTaskProgress(TaskProgress* progress);
+        Operation& withPhaseFinished(PhaseFinished fn);
         bool execute();
 
     private:
@@ -116,8 +239,15 @@ public:
         Operation& targetFormat(Format format);
         Operation& withItems(Span<const ApplicationItem> appItems);
         Operation& withParameters(const PropertyGroup* parameters);
+        Operation& withShapeMesher(ShapeMesher fn, bool releaseMeshes = false);
         Operation& withMessenger(Messenger* messenger);
         Operation& withTaskProgress(TaskProgress* progress);
+        Operation& withPhaseFinished(PhaseFinished fn);
+
+        // Additional target files, exported concurrently with target file
+        Operation& addTarget(const FilePath& filepath, Format format, const PropertyGroup* parameters = nullptr);
+        Operation& withTargetFinished(std::function<void(const ExportTarget&, bool)> fn);
+
         bool execute();
 
     private:
@@ -125,16 +255,31 @@ public:
         Operation_ExportApplicationItems(System& system);
         System& m_system;
         Args_ExportApplicationItems m_args;
+        std::vector<ExportTarget> m_vecAdditionalTarget;
+        std::function<void(const ExportTarget&, bool)> m_fnTargetFinished;
     };
     Operation_ExportApplicationItems exportApplicationItems();
 
     // Implementation
 private:
-    std::vector<FormatProbe> m_vecFormatProbe;
+    Format probeFormatUncached(const FileSource& source) const;
+
+    struct FormatProbeEntry {
+        FormatProbe fnProbe;
+        std::bitset<256> leadingChars; // No bit set: probe accepts any contents
+    };
+
+    std::vector<FormatProbeEntry> m_vecFormatProbe;
+    // Lower case file suffixes, first format registered for a suffix wins
+    std::unordered_map<std::string, Format> m_mapReaderSuffixFormat;
+    std::unordered_map<std::string, Format> m_mapWriterSuffixFormat;
     std::vector<Format> m_vecReaderFormat;
     std::vector<Format> m_vecWriterFormat;
     std::vector<std::unique_ptr<FactoryReader>> m_vecFactoryReader;
     std::vector<std::unique_ptr<FactoryWriter>> m_vecFactoryWriter;
+    std::atomic<uint64_t> m_importMemoryBudget = 0;
+    std::atomic<int> m_maxConcurrency = 0;
+    mutable FileMetadataCache m_fileMetadataCache;
 };
 
 // Predefined
@@ -143,6 +288,9 @@ Format probeFormat_IGES(const System::FormatProbeInput& input);
 Format probeFormat_OCCBREP(const System::FormatProbeInput& input);
 Format probeFormat_STL(const System::FormatProbeInput& input);
 Format probeFormat_OBJ(const System::FormatProbeInput& input);
+Format probeFormat_PLY(const System::FormatProbeInput& input);
+Format probeFormat_3MF(const System::FormatProbeInput& input);
+Format probeFormat_DXF(const System::FormatProbeInput& input);
 void addPredefinedFormatProbes(System* system);
 
 } // namespace IO
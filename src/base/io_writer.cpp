@@ -23,5 +23,11 @@ void Writer::setMessenger(Messenger* messenger)
         m_messenger = NullMessenger::instance();
 }
 
+void Writer::setShapeMesher(ShapeMesher fn, bool releaseMeshes)
+{
+    m_shapeMesher = std::move(fn);
+    m_releaseMeshes = releaseMeshes;
+}
+
 } // namespace IO
 } // namespace Mayo
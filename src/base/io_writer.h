@@ -9,8 +9,11 @@
 #include "filepath.h"
 #include "io_format.h"
 #include "span.h"
+#include <functional>
 #include <memory>
 
+class TopoDS_Shape;
+
 namespace Mayo {
 
 class ApplicationItem;
@@ -20,6 +23,9 @@ class TaskProgress;
 
 namespace IO {
 
+// Computes the triangulations of the faces of a shape, see Writer::setShapeMesher()
+using ShapeMesher = std::function<void(const TopoDS_Shape&, TaskProgress*)>;
+
 class Writer {
 public:
     Writer();
@@ -32,8 +38,23 @@ public:
     Messenger* messenger() const { return m_messenger; }
     void setMessenger(Messenger* messenger);
 
+    // Whether the writer meshes shapes itself with the function given to setShapeMesher()
+    virtual bool supportsShapeMesher() const { return false; }
+
+    // Shapes might not be meshed yet, writers supporting it call 'fn' on the prototypes not meshed
+    // concurrently and just before their triangulations are written
+    // If 'releaseMeshes' is true then triangulations computed this way are removed from shapes
+    // once written, so memory holds only the triangulations being written
+    void setShapeMesher(ShapeMesher fn, bool releaseMeshes);
+
+protected:
+    const ShapeMesher& shapeMesher() const { return m_shapeMesher; }
+    bool releaseMeshes() const { return m_releaseMeshes; }
+
 private:
     Messenger* m_messenger = nullptr;
+    ShapeMesher m_shapeMesher;
+    bool m_releaseMeshes = false;
 };
 
 class FactoryWriter {
@@ -0,0 +1,96 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "label_attributes_cache.h"
+
+#include <TDF_LabelSequence.hxx>
+#include <XCAFDoc_DocumentTool.hxx>
+#include <XCAFDoc_ShapeTool.hxx>
+
+namespace Mayo {
+
+std::shared_ptr<const LabelAttributes> LabelAttributesCache::attributes(const TDF_Label& label)
+{
+    Handle_XCAFDoc_ColorTool colorTool;
+    Handle_XCAFDoc_LayerTool layerTool;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto itAttrs = m_mapLabelAttributes.find(label);
+        if (itAttrs != m_mapLabelAttributes.cend())
+            return itAttrs->second;
+
+        // XCAF tools are the same for all the labels of the document
+        if (m_colorTool.IsNull() && !label.IsNull()) {
+            m_colorTool = XCAFDoc_DocumentTool::ColorTool(label);
+            m_layerTool = XCAFDoc_DocumentTool::LayerTool(label);
+        }
+
+        colorTool = m_colorTool;
+        layerTool = m_layerTool;
+    }
+
+    // Built outside the lock, concurrent misses on the same label keep the first snapshot inserted
+    auto attrs = std::make_shared<const LabelAttributes>(buildAttributes(label, colorTool, layerTool));
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_mapLabelAttributes.insert({ label, std::move(attrs) }).first->second;
+}
+
+void LabelAttributesCache::forget(const TDF_Label& label)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto it = m_mapLabelAttributes.begin(); it != m_mapLabelAttributes.end();) {
+        if (it->first == label || it->first.IsDescendant(label))
+            it = m_mapLabelAttributes.erase(it);
+        else
+            ++it;
+    }
+}
+
+void LabelAttributesCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_mapLabelAttributes.clear();
+    m_colorTool.Nullify();
+    m_layerTool.Nullify();
+}
+
+LabelAttributes LabelAttributesCache::buildAttributes(
+        const TDF_Label& label,
+        const Handle_XCAFDoc_ColorTool& colorTool,
+        const Handle_XCAFDoc_LayerTool& layerTool)
+{
+    LabelAttributes attrs;
+    if (label.IsNull())
+        return attrs;
+
+    attrs.name = CafUtils::labelAttrStdName(label);
+    attrs.shape = XCAFDoc_ShapeTool::GetShape(label);
+    attrs.isAssembly = XCAFDoc_ShapeTool::IsAssembly(label);
+    attrs.isReference = XCAFDoc_ShapeTool::GetReferredShape(label, attrs.labelReferred);
+    if (attrs.isReference)
+        attrs.referenceLocation = XCAFDoc_ShapeTool::GetLocation(label);
+
+    // Same precedence as XCaf::shapeColor()
+    if (colorTool) {
+        attrs.hasColor = colorTool->GetColor(label, XCAFDoc_ColorGen, attrs.color)
+                || colorTool->GetColor(label, XCAFDoc_ColorSurf, attrs.color)
+                || colorTool->GetColor(label, XCAFDoc_ColorCurv, attrs.color);
+    }
+
+    if (layerTool) {
+        TDF_LabelSequence seqLayer;
+        layerTool->GetLayers(label, seqLayer);
+        for (const TDF_Label& layerLabel : seqLayer) {
+            TCollection_ExtendedString layerName;
+            layerTool->GetLayer(layerLabel, layerName);
+            attrs.vecLayerName.push_back(layerName);
+        }
+    }
+
+    return attrs;
+}
+
+} // namespace Mayo
@@ -0,0 +1,64 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "caf_utils.h"
+
+#include <Quantity_Color.hxx>
+#include <TCollection_ExtendedString.hxx>
+#include <TDF_Label.hxx>
+#include <TopLoc_Location.hxx>
+#include <TopoDS_Shape.hxx>
+#include <XCAFDoc_ColorTool.hxx>
+#include <XCAFDoc_LayerTool.hxx>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace Mayo {
+
+// Snapshot of the OCAF/XCAF attributes of a label, as queried by the model tree builders, the
+// property panels and the exporters
+struct LabelAttributes {
+    TCollection_ExtendedString name; // Empty if no name attribute
+    TopoDS_Shape shape; // Null if not a shape label
+    bool isAssembly = false;
+    bool isReference = false;
+    TDF_Label labelReferred; // Null if not a reference
+    TopLoc_Location referenceLocation;
+    bool hasColor = false;
+    Quantity_Color color;
+    std::vector<TCollection_ExtendedString> vecLayerName;
+};
+
+// Attributes of the labels of a document, each label snapshot is built on first query then
+// returned as is, sparing the GUID lookups of TDF_Label::FindAttribute() on each query
+// Snapshots are not updated automatically: forget() has to be called once attributes of a label
+// are modified(or before the label is destroyed)
+// All functions are thread-safe
+class LabelAttributesCache {
+public:
+    std::shared_ptr<const LabelAttributes> attributes(const TDF_Label& label);
+
+    // Drops the snapshots of 'label' and its descendants
+    void forget(const TDF_Label& label);
+    void clear();
+
+private:
+    static LabelAttributes buildAttributes(
+            const TDF_Label& label,
+            const Handle_XCAFDoc_ColorTool& colorTool,
+            const Handle_XCAFDoc_LayerTool& layerTool);
+
+    std::mutex m_mutex;
+    std::unordered_map<TDF_Label, std::shared_ptr<const LabelAttributes>> m_mapLabelAttributes;
+    Handle_XCAFDoc_ColorTool m_colorTool;
+    Handle_XCAFDoc_LayerTool m_layerTool;
+};
+
+} // namespace Mayo
@@ -0,0 +1,41 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "label_name_cache.h"
+
+#include "string_conv.h"
+
+namespace Mayo {
+
+QString LabelNameCache::labelName(const TDF_Label& label)
+{
+    const TCollection_ExtendedString& name = CafUtils::labelAttrStdName(label);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    QString& cachedName = m_mapLabelName[label];
+    if (string_conv<std::u16string_view>(cachedName) != string_conv<std::u16string_view>(name))
+        string_conv(name, &cachedName);
+
+    return cachedName;
+}
+
+void LabelNameCache::forget(const TDF_Label& label)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto it = m_mapLabelName.begin(); it != m_mapLabelName.end();) {
+        if (it->first == label || it->first.IsDescendant(label))
+            it = m_mapLabelName.erase(it);
+        else
+            ++it;
+    }
+}
+
+void LabelNameCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_mapLabelName.clear();
+}
+
+} // namespace Mayo
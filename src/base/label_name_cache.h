@@ -0,0 +1,37 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "caf_utils.h"
+
+#include <QtCore/QString>
+#include <TDF_Label.hxx>
+#include <mutex>
+#include <unordered_map>
+
+namespace Mayo {
+
+// Names of the labels of a document converted to QString, for code asking again and again for
+// the same names(model tree, property panels, ...)
+// The cached string is checked against the name attribute on each call, without conversion: it's
+// converted again only when the name changed, reusing the buffer of the cached string. Returned
+// QString objects are implicitly shared with the cache, so no allocation occurs on cache hit
+// All functions are thread-safe
+class LabelNameCache {
+public:
+    QString labelName(const TDF_Label& label);
+
+    // Drops the names of 'label' and its descendants, to be called before the label is destroyed
+    void forget(const TDF_Label& label);
+    void clear();
+
+private:
+    std::mutex m_mutex;
+    std::unordered_map<TDF_Label, QString> m_mapLabelName;
+};
+
+} // namespace Mayo
@@ -14,6 +14,13 @@ namespace Mayo {
 
 using TreeNodeId = uint32_t;
 
+// Tree stored as arrays indexed by node id(links and data are stored apart, so traversals don't
+// load node data)
+// While nodes are appended in pre-order(ie parent of a new node is the last node or one of its
+// ancestors, which is what recursive deep build does) any subtree occupies a contiguous range of
+// ids, so that pre-order traversal of a subtree is a linear scan
+// Removed subtrees are reclaimed when they lie at the end of the arrays(eg the last imported
+// entity is closed), ids of other nodes are kept stable
 template<typename T> class Tree {
 public:
     Tree();
@@ -41,7 +48,6 @@ private:
         TreeNodeId childFirst;
         TreeNodeId childLast;
         TreeNodeId parent;
-        T data;
         bool isDeleted;
     };
 
@@ -62,9 +68,13 @@ private:
     const TreeNode* ptrNode(TreeNodeId id) const;
     TreeNode* appendChild(TreeNodeId parentId);
     bool isNodeDeleted(TreeNodeId id) const;
+    TreeNodeId nodeDescendantLast(TreeNodeId id) const;
+    void reclaimDeletedNodes();
 
     std::vector<TreeNode> m_vecNode;
+    std::vector<T> m_vecNodeData;
     std::vector<TreeNodeId> m_vecRoot;
+    bool m_isPreOrderLayout = true;
 };
 
 // Fastest tree traversal, but nodes are visited unordered
@@ -135,7 +145,7 @@ template<typename T> TreeNodeId Tree<T>::nodeRoot(TreeNodeId id) const {
 template<typename T> const T& Tree<T>::nodeData(TreeNodeId id) const {
     static const T nullObject = {};
     const TreeNode* node = this->ptrNode(id);
-    return node ? node->data : nullObject;
+    return node ? m_vecNodeData.at(id - 1) : nullObject;
 }
 
 template<typename T> bool Tree<T>::nodeIsRoot(TreeNodeId id) const {
@@ -150,29 +160,41 @@ template<typename T> bool Tree<T>::nodeIsLeaf(TreeNodeId id) const {
 template<typename T> void Tree<T>::clear()
 {
     m_vecNode.clear();
+    m_vecNodeData.clear();
     m_vecRoot.clear();
+    m_isPreOrderLayout = true;
 }
 
 template<typename T>
 TreeNodeId Tree<T>::appendChild(TreeNodeId parentId, const T& data)
 {
-    TreeNode* node = this->appendChild(parentId);
-    node->data = data;
+    this->appendChild(parentId);
+    m_vecNodeData.back() = data;
     return this->lastNodeId();
 }
 
 template<typename T>
 TreeNodeId Tree<T>::appendChild(TreeNodeId parentId, T&& data)
 {
-    TreeNode* node = this->appendChild(parentId);
-    node->data = std::forward<T>(data);
+    this->appendChild(parentId);
+    m_vecNodeData.back() = std::forward<T>(data);
     return this->lastNodeId();
 }
 
 template<typename T>
 typename Tree<T>::TreeNode* Tree<T>::appendChild(TreeNodeId parentId)
 {
+    if (m_isPreOrderLayout && parentId != 0) {
+        // Pre-order layout is kept only if 'parentId' is the last node or one of its ancestors
+        TreeNodeId id = this->lastNodeId();
+        while (id != 0 && id != parentId)
+            id = this->nodeParent(id);
+
+        m_isPreOrderLayout = id == parentId;
+    }
+
     m_vecNode.push_back({});
+    m_vecNodeData.push_back({});
     const TreeNodeId nodeId = this->lastNodeId();
     TreeNode* node = &m_vecNode.back();
     node->parent = parentId;
@@ -204,16 +226,46 @@ template<typename T> void Tree<T>::removeRoot(TreeNodeId id)
 {
     Expects(this->nodeIsRoot(id));
 
-    // TODO Mark all children nodes as 'deleted'
     auto it = std::find(m_vecRoot.begin(), m_vecRoot.end(), id);
     if (it != m_vecRoot.end()) {
-        TreeNode* node = this->ptrNode(id);
-        Expects(node != nullptr);
-        node->isDeleted = true;
+        Expects(this->ptrNode(id) != nullptr);
+        std::vector<TreeNodeId> vecNodeId;
+        traverseTree_preOrder(id, *this, [&](TreeNodeId nodeId) { vecNodeId.push_back(nodeId); });
+        for (TreeNodeId nodeId : vecNodeId) {
+            this->ptrNode(nodeId)->isDeleted = true;
+            m_vecNodeData.at(nodeId - 1) = {}; // Release data now
+        }
+
         m_vecRoot.erase(it);
+        this->reclaimDeletedNodes();
+    }
+}
+
+template<typename T> void Tree<T>::reclaimDeletedNodes()
+{
+    // Only trailing deleted nodes can be released without changing ids of the remaining nodes
+    while (!m_vecNode.empty() && m_vecNode.back().isDeleted) {
+        m_vecNode.pop_back();
+        m_vecNodeData.pop_back();
+    }
+
+    if (m_vecRoot.empty())
+        m_isPreOrderLayout = true;
+
+    if (m_vecNode.size() < m_vecNode.capacity() / 4) {
+        m_vecNode.shrink_to_fit();
+        m_vecNodeData.shrink_to_fit();
     }
 }
 
+template<typename T> TreeNodeId Tree<T>::nodeDescendantLast(TreeNodeId id) const
+{
+    for (TreeNodeId idChild = this->nodeChildLast(id); idChild != 0; idChild = this->nodeChildLast(id))
+        id = idChild;
+
+    return id;
+}
+
 template<typename T> Span<const TreeNodeId> Tree<T>::roots() const {
     return m_vecRoot;
 }
@@ -261,7 +313,16 @@ void traverseTree_preOrder(const Tree<T>& tree, const FN& callback) {
 template<typename T, typename FN>
 void traverseTree_preOrder(TreeNodeId id, const Tree<T>& tree, const FN& callback)
 {
-    if (!tree.isNodeDeleted(id)) {
+    if (tree.isNodeDeleted(id))
+        return;
+
+    if (tree.m_isPreOrderLayout) {
+        // Subtree is the contiguous range [id, last descendant]
+        const TreeNodeId idLast = tree.nodeDescendantLast(id);
+        for (TreeNodeId it = id; it <= idLast; ++it)
+            callback(it);
+    }
+    else {
         callback(id);
         for (auto it = tree.nodeChildFirst(id); it != 0; it = tree.nodeSiblingNext(it))
             traverseTree_preOrder(it, tree, callback);
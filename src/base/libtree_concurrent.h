@@ -0,0 +1,134 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "libtree.h"
+#include "task_manager.h"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+// Concurrent traversal algorithms for Tree<T>, nodes are dispatched in chunks executed with
+// TaskManager::runConcurrently()
+// Callbacks are called from several threads at once, so they must not modify the tree and must be
+// safe for concurrent calls(eg read-only access to node data)
+
+namespace Mayo {
+
+// Calls callback(id) for each node of the subtree rooted at 'id', nodes are visited unordered
+template<typename T, typename FN>
+void traverseTree_concurrent(TreeNodeId id, const Tree<T>& tree, const FN& callback);
+
+// Calls callback(id) for each node of the tree, nodes are visited unordered
+template<typename T, typename FN>
+void traverseTree_concurrent(const Tree<T>& tree, const FN& callback);
+
+// Returns fnReduce(...fnReduce(init, fnMap(id1)), ..., fnMap(idN)) for the nodes of the subtree
+// rooted at 'id'. Partial results are computed concurrently and combined in pre-order of the nodes,
+// so 'fnReduce' must be associative and 'init' must be its neutral element
+template<typename R, typename T, typename FN_MAP, typename FN_REDUCE>
+R reduceTree_concurrent(
+        TreeNodeId id, const Tree<T>& tree, R init, const FN_MAP& fnMap, const FN_REDUCE& fnReduce);
+
+// Same as above, for all the nodes of the tree
+template<typename R, typename T, typename FN_MAP, typename FN_REDUCE>
+R reduceTree_concurrent(const Tree<T>& tree, R init, const FN_MAP& fnMap, const FN_REDUCE& fnReduce);
+
+// --
+// -- Implementation
+// --
+
+namespace Internal {
+
+// Minimum count of nodes processed by a task, below that threshold the overhead of tasks isn't worth
+constexpr int TreeMinChunkSize = 64;
+
+inline int treeChunkCount(size_t nodeCount)
+{
+    const int threadCount = std::max(1, int(std::thread::hardware_concurrency()));
+    return std::max(1, std::min(int(nodeCount / TreeMinChunkSize), threadCount));
+}
+
+template<typename FN>
+void forEachTreeChunk(Span<const TreeNodeId> spanNodeId, int chunkCount, const FN& fnChunk)
+{
+    auto fnRunChunk = [&](int iChunk) {
+        const size_t count = spanNodeId.size();
+        const size_t first = (iChunk * count) / chunkCount;
+        const size_t last = ((iChunk + 1) * count) / chunkCount;
+        fnChunk(iChunk, spanNodeId.subspan(first, last - first));
+    };
+
+    if (chunkCount > 1)
+        TaskManager::runConcurrently(chunkCount, nullptr, [&](int iChunk, TaskProgress*) { fnRunChunk(iChunk); });
+    else if (chunkCount == 1)
+        fnRunChunk(0);
+}
+
+template<typename R, typename FN_MAP, typename FN_REDUCE>
+R reduceTreeNodes(Span<const TreeNodeId> spanNodeId, R init, const FN_MAP& fnMap, const FN_REDUCE& fnReduce)
+{
+    const int chunkCount = treeChunkCount(spanNodeId.size());
+    std::vector<R> vecPartial(chunkCount, init);
+    forEachTreeChunk(spanNodeId, chunkCount, [&](int iChunk, Span<const TreeNodeId> spanChunk) {
+        R& partial = vecPartial.at(iChunk);
+        for (TreeNodeId id : spanChunk)
+            partial = fnReduce(std::move(partial), fnMap(id));
+    });
+
+    R result = std::move(init);
+    for (R& partial : vecPartial)
+        result = fnReduce(std::move(result), std::move(partial));
+
+    return result;
+}
+
+} // namespace Internal
+
+template<typename T, typename FN>
+void traverseTree_concurrent(TreeNodeId id, const Tree<T>& tree, const FN& callback)
+{
+    std::vector<TreeNodeId> vecNodeId;
+    traverseTree_preOrder(id, tree, [&](TreeNodeId nodeId) { vecNodeId.push_back(nodeId); });
+    const int chunkCount = Internal::treeChunkCount(vecNodeId.size());
+    Internal::forEachTreeChunk(vecNodeId, chunkCount, [&](int, Span<const TreeNodeId> spanChunk) {
+        for (TreeNodeId nodeId : spanChunk)
+            callback(nodeId);
+    });
+}
+
+template<typename T, typename FN>
+void traverseTree_concurrent(const Tree<T>& tree, const FN& callback)
+{
+    std::vector<TreeNodeId> vecNodeId;
+    traverseTree_unorder(tree, [&](TreeNodeId nodeId) { vecNodeId.push_back(nodeId); });
+    const int chunkCount = Internal::treeChunkCount(vecNodeId.size());
+    Internal::forEachTreeChunk(vecNodeId, chunkCount, [&](int, Span<const TreeNodeId> spanChunk) {
+        for (TreeNodeId nodeId : spanChunk)
+            callback(nodeId);
+    });
+}
+
+template<typename R, typename T, typename FN_MAP, typename FN_REDUCE>
+R reduceTree_concurrent(
+        TreeNodeId id, const Tree<T>& tree, R init, const FN_MAP& fnMap, const FN_REDUCE& fnReduce)
+{
+    std::vector<TreeNodeId> vecNodeId;
+    traverseTree_preOrder(id, tree, [&](TreeNodeId nodeId) { vecNodeId.push_back(nodeId); });
+    return Internal::reduceTreeNodes(Span<const TreeNodeId>(vecNodeId), std::move(init), fnMap, fnReduce);
+}
+
+template<typename R, typename T, typename FN_MAP, typename FN_REDUCE>
+R reduceTree_concurrent(const Tree<T>& tree, R init, const FN_MAP& fnMap, const FN_REDUCE& fnReduce)
+{
+    std::vector<TreeNodeId> vecNodeId;
+    traverseTree_preOrder(tree, [&](TreeNodeId nodeId) { vecNodeId.push_back(nodeId); });
+    return Internal::reduceTreeNodes(Span<const TreeNodeId>(vecNodeId), std::move(init), fnMap, fnReduce);
+}
+
+} // namespace Mayo
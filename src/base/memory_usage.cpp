@@ -0,0 +1,305 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "memory_usage.h"
+
+#include "caf_utils.h"
+#include "document.h"
+#include "tkernel_utils.h"
+#include "xcaf.h"
+
+#include <QtCore/QtGlobal>
+#include <BRep_Curve3D.hxx>
+#include <BRep_CurveOnSurface.hxx>
+#include <BRep_TEdge.hxx>
+#include <BRep_TFace.hxx>
+#include <BRep_Tool.hxx>
+#include <Geom_BezierSurface.hxx>
+#include <Geom_BSplineCurve.hxx>
+#include <Geom_BSplineSurface.hxx>
+#include <Geom2d_BSplineCurve.hxx>
+#include <Standard.hxx>
+#include <TDataXtd_Triangulation.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Iterator.hxx>
+#include <unordered_set>
+
+#if defined(Q_OS_WIN)
+#  include <windows.h>
+#  include <psapi.h> // For GetProcessMemoryInfo()
+#  include <malloc.h> // For _heapmin()
+#elif defined(Q_OS_MACOS)
+#  include <mach/mach.h>
+#  include <malloc/malloc.h>
+#  include <sys/sysctl.h> // For sysctlbyname()
+#elif defined(Q_OS_UNIX)
+#  include <unistd.h>
+#  include <cstdio>
+#  if defined(__GLIBC__)
+#    include <malloc.h> // For malloc_trim()
+#  endif
+#endif
+
+namespace Mayo {
+
+namespace {
+
+uint64_t objectBytes(const Handle_Standard_Transient& object)
+{
+    return !object.IsNull() ? uint64_t(object->DynamicType()->Size()) : 0;
+}
+
+uint64_t geometryBytes(const Handle_Geom_Curve& curve)
+{
+    uint64_t bytes = objectBytes(curve);
+    auto bspline = Handle_Geom_BSplineCurve::DownCast(curve);
+    if (!bspline.IsNull()) {
+        bytes += bspline->NbPoles() * (sizeof(gp_Pnt) + (bspline->IsRational() ? sizeof(double) : 0));
+        bytes += bspline->NbKnots() * (sizeof(double) + sizeof(int));
+    }
+
+    return bytes;
+}
+
+uint64_t geometryBytes(const Handle_Geom2d_Curve& curve)
+{
+    uint64_t bytes = objectBytes(curve);
+    auto bspline = Handle_Geom2d_BSplineCurve::DownCast(curve);
+    if (!bspline.IsNull()) {
+        bytes += bspline->NbPoles() * (sizeof(gp_Pnt2d) + (bspline->IsRational() ? sizeof(double) : 0));
+        bytes += bspline->NbKnots() * (sizeof(double) + sizeof(int));
+    }
+
+    return bytes;
+}
+
+uint64_t geometryBytes(const Handle_Geom_Surface& surface)
+{
+    uint64_t bytes = objectBytes(surface);
+    auto bspline = Handle_Geom_BSplineSurface::DownCast(surface);
+    if (!bspline.IsNull()) {
+        const bool isRational = bspline->IsURational() || bspline->IsVRational();
+        const uint64_t poleCount = uint64_t(bspline->NbUPoles()) * bspline->NbVPoles();
+        bytes += poleCount * (sizeof(gp_Pnt) + (isRational ? sizeof(double) : 0));
+        bytes += (bspline->NbUKnots() + bspline->NbVKnots()) * (sizeof(double) + sizeof(int));
+    }
+
+    auto bezier = Handle_Geom_BezierSurface::DownCast(surface);
+    if (!bezier.IsNull()) {
+        const bool isRational = bezier->IsURational() || bezier->IsVRational();
+        const uint64_t poleCount = uint64_t(bezier->NbUPoles()) * bezier->NbVPoles();
+        bytes += poleCount * (sizeof(gp_Pnt) + (isRational ? sizeof(double) : 0));
+    }
+
+    return bytes;
+}
+
+// Accumulates memory usage of shapes and triangulations, shared objects are counted once
+class MemoryUsageAccumulator {
+public:
+    const MemoryUsage& result() const { return m_result; }
+
+    void addShape(const TopoDS_Shape& shape)
+    {
+        if (shape.IsNull() || !m_setVisited.insert(shape.TShape().get()).second)
+            return;
+
+        m_result.brepBytes += objectBytes(shape.TShape());
+        if (shape.ShapeType() == TopAbs_EDGE) {
+            auto tedge = Handle_BRep_TEdge::DownCast(shape.TShape());
+            for (const Handle_BRep_CurveRepresentation& curveRep : tedge->Curves()) {
+                m_result.brepBytes += objectBytes(curveRep);
+                auto curve3d = Handle_BRep_Curve3D::DownCast(curveRep);
+                if (!curve3d.IsNull())
+                    this->addGeometry(curve3d->Curve3D());
+
+                auto curveOnSurface = Handle_BRep_CurveOnSurface::DownCast(curveRep);
+                if (!curveOnSurface.IsNull())
+                    this->addGeometry(curveOnSurface->PCurve());
+            }
+        }
+        else if (shape.ShapeType() == TopAbs_FACE) {
+            const TopoDS_Face& face = TopoDS::Face(shape);
+            this->addGeometry(BRep_Tool::Surface(face));
+            TopLoc_Location loc;
+            this->addTriangulation(BRep_Tool::Triangulation(face, loc));
+        }
+
+        for (TopoDS_Iterator it(shape, false, false); it.More(); it.Next())
+            this->addShape(it.Value());
+    }
+
+    void addTriangulation(const Handle_Poly_Triangulation& triangulation)
+    {
+        if (triangulation.IsNull() || !m_setVisited.insert(triangulation.get()).second)
+            return;
+
+        const uint64_t nodeCount = triangulation->NbNodes();
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+        // Nodes might be stored in single precision, see MeshUtils::compactTriangulation()
+        const bool isDoublePrecision = triangulation->IsDoublePrecision();
+#else
+        const bool isDoublePrecision = true;
+#endif
+        m_result.triangulationBytes += objectBytes(triangulation);
+        m_result.triangulationBytes += nodeCount * (isDoublePrecision ? sizeof(gp_Pnt) : 3 * sizeof(float));
+        m_result.triangulationBytes += triangulation->NbTriangles() * sizeof(Poly_Triangle);
+        if (triangulation->HasUVNodes())
+            m_result.triangulationBytes += nodeCount * (isDoublePrecision ? sizeof(gp_Pnt2d) : 2 * sizeof(float));
+
+        if (triangulation->HasNormals())
+            m_result.triangulationBytes += nodeCount * 3 * sizeof(float);
+
+        m_result.triangulationNodeCount += triangulation->NbNodes();
+        m_result.triangulationTriangleCount += triangulation->NbTriangles();
+    }
+
+    void addLabel(const TDF_Label& label)
+    {
+        if (XCaf::isShape(label)) {
+            this->addShape(XCaf::shape(label));
+        }
+        else {
+            auto attrTriangulation = CafUtils::findAttribute<TDataXtd_Triangulation>(label);
+            if (!attrTriangulation.IsNull())
+                this->addTriangulation(attrTriangulation->Get());
+        }
+    }
+
+private:
+    template<typename GEOMETRY>
+    void addGeometry(const GEOMETRY& geom)
+    {
+        if (!geom.IsNull() && m_setVisited.insert(geom.get()).second)
+            m_result.brepBytes += geometryBytes(geom);
+    }
+
+    MemoryUsage m_result;
+    std::unordered_set<const void*> m_setVisited;
+};
+
+} // namespace
+
+uint64_t MemoryUsage::estimatedPresentationBytes() const
+{
+    // Vertex attributes are positions and normals as vectors of 3 floats, triangle indices are
+    // 32bits integers
+    return this->triangulationNodeCount * 2 * 3 * sizeof(float)
+            + this->triangulationTriangleCount * 3 * sizeof(uint32_t);
+}
+
+MemoryUsage& MemoryUsage::operator+=(const MemoryUsage& other)
+{
+    this->brepBytes += other.brepBytes;
+    this->triangulationBytes += other.triangulationBytes;
+    this->triangulationNodeCount += other.triangulationNodeCount;
+    this->triangulationTriangleCount += other.triangulationTriangleCount;
+    return *this;
+}
+
+MemoryUsage MemoryUsage::ofShape(const TopoDS_Shape& shape)
+{
+    MemoryUsageAccumulator accumulator;
+    accumulator.addShape(shape);
+    return accumulator.result();
+}
+
+MemoryUsage MemoryUsage::ofTriangulation(const Handle_Poly_Triangulation& triangulation)
+{
+    MemoryUsageAccumulator accumulator;
+    accumulator.addTriangulation(triangulation);
+    return accumulator.result();
+}
+
+MemoryUsage MemoryUsage::ofLabel(const TDF_Label& label)
+{
+    MemoryUsageAccumulator accumulator;
+    accumulator.addLabel(label);
+    return accumulator.result();
+}
+
+MemoryUsage MemoryUsage::ofDocument(const DocumentPtr& doc)
+{
+    MemoryUsageAccumulator accumulator;
+    if (!doc.IsNull()) {
+        for (int i = 0; i < doc->entityCount(); ++i)
+            accumulator.addLabel(doc->entityLabel(i));
+    }
+
+    return accumulator.result();
+}
+
+int64_t ProcessMemory::residentBytes()
+{
+#if defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters = {};
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return -1;
+
+    return int64_t(counters.WorkingSetSize);
+#elif defined(Q_OS_MACOS)
+    mach_task_basic_info info = {};
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS)
+        return -1;
+
+    return int64_t(info.resident_size);
+#elif defined(Q_OS_UNIX)
+    // Second field of "statm" is the count of resident pages
+    std::FILE* file = std::fopen("/proc/self/statm", "r");
+    if (!file)
+        return -1;
+
+    long pageCount = 0;
+    long residentPageCount = 0;
+    const bool ok = std::fscanf(file, "%ld %ld", &pageCount, &residentPageCount) == 2;
+    std::fclose(file);
+    return ok ? int64_t(residentPageCount) * sysconf(_SC_PAGESIZE) : -1;
+#else
+    return -1;
+#endif
+}
+
+int64_t ProcessMemory::physicalBytes()
+{
+#if defined(Q_OS_WIN)
+    MEMORYSTATUSEX status = {};
+    status.dwLength = sizeof(status);
+    if (!GlobalMemoryStatusEx(&status))
+        return -1;
+
+    return int64_t(status.ullTotalPhys);
+#elif defined(Q_OS_MACOS)
+    uint64_t size = 0;
+    size_t len = sizeof(size);
+    if (sysctlbyname("hw.memsize", &size, &len, nullptr, 0) != 0)
+        return -1;
+
+    return int64_t(size);
+#elif defined(Q_OS_UNIX)
+    const long pageCount = sysconf(_SC_PHYS_PAGES);
+    const long pageSize = sysconf(_SC_PAGESIZE);
+    return pageCount > 0 && pageSize > 0 ? int64_t(pageCount) * pageSize : -1;
+#else
+    return -1;
+#endif
+}
+
+void ProcessMemory::trim()
+{
+    // Releases the free lists of the OpenCascade optimized memory manager(MMGT_OPT=1), no-op for
+    // other memory managers
+    Standard::Purge();
+#if defined(Q_OS_WIN)
+    _heapmin();
+#elif defined(Q_OS_MACOS)
+    malloc_zone_pressure_relief(nullptr, 0);
+#elif defined(__GLIBC__)
+    malloc_trim(0);
+#endif
+}
+
+} // namespace Mayo
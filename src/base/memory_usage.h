@@ -0,0 +1,54 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "document_ptr.h"
+
+#include <Poly_Triangulation.hxx>
+#include <TDF_Label.hxx>
+#include <TopoDS_Shape.hxx>
+#include <cstdint>
+
+namespace Mayo {
+
+// Estimated memory usage of the data of a document
+// Sizes are computed from the count of topological entities, geometry control points and mesh
+// nodes/triangles, allocator overhead isn't taken into account
+// Shared data(eg BRep of a prototype instantiated several times) is counted once
+struct MemoryUsage {
+    uint64_t brepBytes = 0; // Topology and geometry
+    uint64_t triangulationBytes = 0;
+    int64_t triangulationNodeCount = 0;
+    int64_t triangulationTriangleCount = 0;
+
+    // Estimated size of the GPU buffers holding the shaded presentation of the triangulations
+    // (vertex positions and normals, triangle indices)
+    uint64_t estimatedPresentationBytes() const;
+
+    MemoryUsage& operator+=(const MemoryUsage& other);
+
+    static MemoryUsage ofShape(const TopoDS_Shape& shape);
+    static MemoryUsage ofTriangulation(const Handle_Poly_Triangulation& triangulation);
+    // Supports XCAF shapes and mesh labels(TDataXtd_Triangulation attribute)
+    static MemoryUsage ofLabel(const TDF_Label& label);
+    static MemoryUsage ofDocument(const DocumentPtr& doc);
+};
+
+// Memory of the current process, as seen by the operating system
+struct ProcessMemory {
+    // Resident set size in bytes(working set on Windows), or -1 if not available
+    static int64_t residentBytes();
+
+    // Size in bytes of the physical memory installed on the machine, or -1 if not available
+    static int64_t physicalBytes();
+
+    // Gives back to the operating system the memory freed but still held by the allocators, ie the
+    // pools of the OpenCascade memory manager and the free pages of the C runtime heap
+    static void trim();
+};
+
+} // namespace Mayo
@@ -0,0 +1,385 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "mesh_cache.h"
+#include "brep_utils.h"
+
+#include <BRep_Builder.hxx>
+#include <BRep_Tool.hxx>
+#include <Poly_PolygonOnTriangulation.hxx>
+#include <Poly_Triangulation.hxx>
+#include <TColStd_HArray1OfReal.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopoDS.hxx>
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDataStream>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QSaveFile>
+#include <vector>
+
+namespace Mayo {
+
+namespace {
+
+constexpr quint32 MeshCache_fileMagic = 0x4d594d43; // "MYMC"
+constexpr quint32 MeshCache_fileVersion = 1;
+
+struct EdgePolygons {
+    TopoDS_Edge edge;
+    Handle_Poly_PolygonOnTriangulation polygon1;
+    Handle_Poly_PolygonOnTriangulation polygon2; // Only for seam edges
+};
+
+struct FaceMesh {
+    TopoDS_Face face;
+    Handle_Poly_Triangulation triangulation;
+    std::vector<EdgePolygons> vecEdgePolygons;
+};
+
+void writePolygon(QDataStream& stream, const Handle_Poly_PolygonOnTriangulation& polygon)
+{
+    const TColStd_Array1OfInteger& arrayNode = polygon->Nodes();
+    stream << polygon->Deflection() << quint32(arrayNode.Size());
+    for (int i = arrayNode.Lower(); i <= arrayNode.Upper(); ++i)
+        stream << qint32(arrayNode.Value(i));
+
+    const Handle_TColStd_HArray1OfReal& arrayParam = polygon->Parameters();
+    const bool hasParams = polygon->HasParameters() && arrayParam->Size() == arrayNode.Size();
+    stream << quint8(hasParams ? 1 : 0);
+    if (hasParams) {
+        for (int i = arrayParam->Lower(); i <= arrayParam->Upper(); ++i)
+            stream << arrayParam->Value(i);
+    }
+}
+
+Handle_Poly_PolygonOnTriangulation readPolygon(QDataStream& stream, int triangulationNodeCount)
+{
+    double deflection;
+    quint32 nodeCount;
+    stream >> deflection >> nodeCount;
+    if (stream.status() != QDataStream::Ok || nodeCount == 0)
+        return {};
+
+    TColStd_Array1OfInteger arrayNode(1, int(nodeCount));
+    for (int i = 1; i <= arrayNode.Upper(); ++i) {
+        qint32 nodeId;
+        stream >> nodeId;
+        if (nodeId < 1 || nodeId > triangulationNodeCount)
+            return {};
+
+        arrayNode.ChangeValue(i) = nodeId;
+    }
+
+    quint8 hasParams;
+    stream >> hasParams;
+    Handle_Poly_PolygonOnTriangulation polygon;
+    if (hasParams) {
+        TColStd_Array1OfReal arrayParam(1, int(nodeCount));
+        for (int i = 1; i <= arrayParam.Upper(); ++i)
+            stream >> arrayParam.ChangeValue(i);
+
+        polygon = new Poly_PolygonOnTriangulation(arrayNode, arrayParam);
+    }
+    else {
+        polygon = new Poly_PolygonOnTriangulation(arrayNode);
+    }
+
+    polygon->Deflection(deflection);
+    return stream.status() == QDataStream::Ok ? polygon : Handle_Poly_PolygonOnTriangulation();
+}
+
+Handle_Poly_Triangulation readTriangulation(QDataStream& stream)
+{
+    double deflection;
+    quint32 nodeCount;
+    quint32 triangleCount;
+    quint8 hasUvNodes;
+    stream >> deflection >> nodeCount >> triangleCount >> hasUvNodes;
+    if (stream.status() != QDataStream::Ok || nodeCount == 0 || triangleCount == 0)
+        return {};
+
+    TColgp_Array1OfPnt arrayNode(1, int(nodeCount));
+    for (int i = 1; i <= arrayNode.Upper(); ++i) {
+        double x, y, z;
+        stream >> x >> y >> z;
+        arrayNode.ChangeValue(i).SetCoord(x, y, z);
+    }
+
+    TColgp_Array1OfPnt2d arrayUvNode(1, hasUvNodes ? int(nodeCount) : 1);
+    if (hasUvNodes) {
+        for (int i = 1; i <= arrayUvNode.Upper(); ++i) {
+            double u, v;
+            stream >> u >> v;
+            arrayUvNode.ChangeValue(i).SetCoord(u, v);
+        }
+    }
+
+    Poly_Array1OfTriangle arrayTriangle(1, int(triangleCount));
+    for (int i = 1; i <= arrayTriangle.Upper(); ++i) {
+        qint32 n1, n2, n3;
+        stream >> n1 >> n2 >> n3;
+        for (qint32 n : { n1, n2, n3 }) {
+            if (n < 1 || n > qint32(nodeCount))
+                return {};
+        }
+
+        arrayTriangle.ChangeValue(i).Set(n1, n2, n3);
+    }
+
+    if (stream.status() != QDataStream::Ok)
+        return {};
+
+    Handle_Poly_Triangulation triangulation;
+    if (hasUvNodes)
+        triangulation = new Poly_Triangulation(arrayNode, arrayUvNode, arrayTriangle);
+    else
+        triangulation = new Poly_Triangulation(arrayNode, arrayTriangle);
+
+    triangulation->Deflection(deflection);
+    return triangulation;
+}
+
+void writeTriangulation(QDataStream& stream, const Handle_Poly_Triangulation& triangulation)
+{
+    stream << triangulation->Deflection()
+           << quint32(triangulation->NbNodes())
+           << quint32(triangulation->NbTriangles())
+           << quint8(triangulation->HasUVNodes() ? 1 : 0);
+    for (int i = 1; i <= triangulation->NbNodes(); ++i) {
+        const gp_Pnt pnt = triangulation->Node(i);
+        stream << pnt.X() << pnt.Y() << pnt.Z();
+    }
+
+    if (triangulation->HasUVNodes()) {
+        for (int i = 1; i <= triangulation->NbNodes(); ++i) {
+            const gp_Pnt2d uv = triangulation->UVNode(i);
+            stream << uv.X() << uv.Y();
+        }
+    }
+
+    for (int i = 1; i <= triangulation->NbTriangles(); ++i) {
+        int n1, n2, n3;
+        triangulation->Triangle(i).Get(n1, n2, n3);
+        stream << qint32(n1) << qint32(n2) << qint32(n3);
+    }
+}
+
+} // namespace
+
+MeshCache::MeshCache(const FilePath& dirPath)
+    : m_dirPath(dirPath)
+{
+}
+
+QByteArray MeshCache::key(const TopoDS_Shape& shape, const OccBRepMeshParameters& params)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    // Triangulations already attached to the faces(eg coarse mesh, LOD mesh) are excluded
+    BRepUtils::addShapeToHash(shape, &hash, false);
+
+    // Only parameters affecting resulting triangulation are taken into account
+    QByteArray bytesParams;
+    {
+        QDataStream stream(&bytesParams, QIODevice::WriteOnly);
+        stream << quint32(MeshCache_fileVersion)
+               << params.Deflection
+               << params.Angle
+               << bool(params.Relative)
+               << bool(params.InternalVerticesMode)
+               << bool(params.ControlSurfaceDeflection);
+    }
+
+    hash.addData(bytesParams);
+    return hash.result().toHex();
+}
+
+bool MeshCache::load(const QByteArray& key, const TopoDS_Shape& shape) const
+{
+    if (this->isNull() || shape.IsNull())
+        return false;
+
+    QFile file(filepathTo<QString>(this->entryFilePath(key)));
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream stream(&file);
+    quint32 magic;
+    quint32 version;
+    quint32 faceCount;
+    stream >> magic >> version >> faceCount;
+    if (magic != MeshCache_fileMagic || version != MeshCache_fileVersion)
+        return false;
+
+    // Read all the face meshes first, so 'shape' is left untouched in case of error
+    std::vector<FaceMesh> vecFaceMesh;
+    for (TopExp_Explorer expFace(shape, TopAbs_FACE); expFace.More(); expFace.Next()) {
+        if (vecFaceMesh.size() >= faceCount)
+            return false;
+
+        FaceMesh faceMesh;
+        faceMesh.face = TopoDS::Face(expFace.Current());
+        quint8 hasTriangulation;
+        stream >> hasTriangulation;
+        if (hasTriangulation) {
+            faceMesh.triangulation = readTriangulation(stream);
+            if (faceMesh.triangulation.IsNull())
+                return false;
+
+            quint32 edgeCount;
+            stream >> edgeCount;
+            TopExp_Explorer expEdge(faceMesh.face, TopAbs_EDGE);
+            for (quint32 i = 0; i < edgeCount; ++i, expEdge.Next()) {
+                if (!expEdge.More())
+                    return false;
+
+                EdgePolygons edgePolygons;
+                edgePolygons.edge = TopoDS::Edge(expEdge.Current());
+                quint8 polygonCount;
+                stream >> polygonCount;
+                const int nodeCount = faceMesh.triangulation->NbNodes();
+                if (polygonCount >= 1)
+                    edgePolygons.polygon1 = readPolygon(stream, nodeCount);
+
+                if (polygonCount >= 2)
+                    edgePolygons.polygon2 = readPolygon(stream, nodeCount);
+
+                if (polygonCount >= 1 && edgePolygons.polygon1.IsNull())
+                    return false;
+
+                if (polygonCount >= 2 && edgePolygons.polygon2.IsNull())
+                    return false;
+
+                faceMesh.vecEdgePolygons.push_back(std::move(edgePolygons));
+            }
+
+            if (expEdge.More())
+                return false;
+        }
+
+        vecFaceMesh.push_back(std::move(faceMesh));
+    }
+
+    if (vecFaceMesh.size() != faceCount || stream.status() != QDataStream::Ok)
+        return false;
+
+    BRep_Builder builder;
+    for (const FaceMesh& faceMesh : vecFaceMesh) {
+        if (faceMesh.triangulation.IsNull())
+            continue;
+
+        builder.UpdateFace(faceMesh.face, faceMesh.triangulation);
+        TopLoc_Location locFace;
+        BRep_Tool::Triangulation(faceMesh.face, locFace);
+        for (const EdgePolygons& edgePolygons : faceMesh.vecEdgePolygons) {
+            if (!edgePolygons.polygon2.IsNull()) {
+                builder.UpdateEdge(
+                            edgePolygons.edge,
+                            edgePolygons.polygon1,
+                            edgePolygons.polygon2,
+                            faceMesh.triangulation,
+                            locFace);
+            }
+            else if (!edgePolygons.polygon1.IsNull()) {
+                builder.UpdateEdge(
+                            edgePolygons.edge,
+                            edgePolygons.polygon1,
+                            faceMesh.triangulation,
+                            locFace);
+            }
+        }
+    }
+
+    return true;
+}
+
+bool MeshCache::save(const QByteArray& key, const TopoDS_Shape& shape) const
+{
+    if (this->isNull() || shape.IsNull())
+        return false;
+
+    // Cache directory might be shared: entry was written by a concurrent writer, with same contents
+    const QString strEntryFilePath = filepathTo<QString>(this->entryFilePath(key));
+    if (QFile::exists(strEntryFilePath))
+        return true;
+
+    if (!QDir().mkpath(filepathTo<QString>(m_dirPath)))
+        return false;
+
+    quint32 faceCount = 0;
+    for (TopExp_Explorer expFace(shape, TopAbs_FACE); expFace.More(); expFace.Next())
+        ++faceCount;
+
+    // Write into temporary file then commit, so concurrent readers never see partial entries
+    QSaveFile file(strEntryFilePath);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    QDataStream stream(&file);
+    stream << MeshCache_fileMagic << MeshCache_fileVersion << faceCount;
+    for (TopExp_Explorer expFace(shape, TopAbs_FACE); expFace.More(); expFace.Next()) {
+        const TopoDS_Face& face = TopoDS::Face(expFace.Current());
+        TopLoc_Location locFace;
+        const Handle_Poly_Triangulation& triangulation = BRep_Tool::Triangulation(face, locFace);
+        stream << quint8(triangulation.IsNull() ? 0 : 1);
+        if (triangulation.IsNull())
+            continue;
+
+        writeTriangulation(stream, triangulation);
+        quint32 edgeCount = 0;
+        for (TopExp_Explorer expEdge(face, TopAbs_EDGE); expEdge.More(); expEdge.Next())
+            ++edgeCount;
+
+        stream << edgeCount;
+        for (TopExp_Explorer expEdge(face, TopAbs_EDGE); expEdge.More(); expEdge.Next()) {
+            const TopoDS_Edge& edge = TopoDS::Edge(expEdge.Current());
+            Handle_Poly_PolygonOnTriangulation polygon1;
+            Handle_Poly_PolygonOnTriangulation polygon2;
+            if (BRep_Tool::IsClosed(edge, face)) {
+                // Seam edge: one polygon for each orientation
+                polygon1 = BRep_Tool::PolygonOnTriangulation(
+                            TopoDS::Edge(edge.Oriented(TopAbs_FORWARD)), triangulation, locFace);
+                polygon2 = BRep_Tool::PolygonOnTriangulation(
+                            TopoDS::Edge(edge.Oriented(TopAbs_REVERSED)), triangulation, locFace);
+            }
+            else {
+                polygon1 = BRep_Tool::PolygonOnTriangulation(edge, triangulation, locFace);
+            }
+
+            const quint8 polygonCount = polygon1.IsNull() ? 0 : (polygon2.IsNull() ? 1 : 2);
+            stream << polygonCount;
+            if (polygonCount >= 1)
+                writePolygon(stream, polygon1);
+
+            if (polygonCount >= 2)
+                writePolygon(stream, polygon2);
+        }
+    }
+
+    if (stream.status() != QDataStream::Ok) {
+        file.cancelWriting();
+        return false;
+    }
+
+    return file.commit();
+}
+
+void MeshCache::clear()
+{
+    if (this->isNull())
+        return;
+
+    QDir dir(filepathTo<QString>(m_dirPath));
+    for (const QString& fileName : dir.entryList({ "*.mesh" }, QDir::Files))
+        dir.remove(fileName);
+}
+
+FilePath MeshCache::entryFilePath(const QByteArray& key) const
+{
+    return m_dirPath / (key.toStdString() + ".mesh");
+}
+
+} // namespace Mayo
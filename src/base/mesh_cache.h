@@ -0,0 +1,54 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "filepath.h"
+#include "occ_brep_mesh_parameters.h"
+
+#include <QtCore/QByteArray>
+#include <TopoDS_Shape.hxx>
+
+namespace Mayo {
+
+// Persistent on-disk cache of BRep shape triangulations
+// Each entry is a file in cache directory, named after a key which is computed from the contents
+// of the shape(geometry and topology) and the mesh parameters. An entry stores the triangulation
+// of each face along with the polygons of the face edges, in a compact binary format
+// Cache directory can be shared by several processes(ex: network folder), entries being committed
+// atomically and never overwritten
+class MeshCache {
+public:
+    MeshCache() = default;
+    MeshCache(const FilePath& dirPath);
+
+    const FilePath& dirPath() const { return m_dirPath; }
+    void setDirPath(const FilePath& dirPath) { m_dirPath = dirPath; }
+
+    bool isNull() const { return m_dirPath.empty(); }
+
+    // Returns the key identifying the triangulation of 'shape' computed with 'params'
+    // Key doesn't depend on the triangulations already attached to 'shape', so it can be computed
+    // before or after meshing
+    static QByteArray key(const TopoDS_Shape& shape, const OccBRepMeshParameters& params);
+
+    // Loads the triangulations stored in entry 'key' and assigns them to the faces of 'shape'
+    // Returns false if there is no such entry or if entry doesn't match the topology of 'shape'
+    bool load(const QByteArray& key, const TopoDS_Shape& shape) const;
+
+    // Stores the current triangulations of 'shape' faces into entry 'key', existing entry is kept untouched
+    bool save(const QByteArray& key, const TopoDS_Shape& shape) const;
+
+    // Deletes all the entries in cache directory
+    void clear();
+
+private:
+    FilePath entryFilePath(const QByteArray& key) const;
+
+    FilePath m_dirPath;
+};
+
+} // namespace Mayo
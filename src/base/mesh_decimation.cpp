@@ -0,0 +1,676 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "mesh_decimation.h"
+
+#include "caf_utils.h"
+#include "mesh_repair.h"
+#include "profiler.h"
+#include "task_manager.h"
+#include "task_progress.h"
+#include "xcaf.h"
+
+#include <BRep_Builder.hxx>
+#include <BRep_Tool.hxx>
+#include <Bnd_Box.hxx>
+#include <Standard_Version.hxx>
+#include <TDataXtd_Triangulation.hxx>
+#include <TopExp.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+#include <TopoDS.hxx>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <iterator>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace Mayo {
+
+namespace {
+
+void setNode(Poly_Triangulation* mesh, int index, const gp_XYZ& coords)
+{
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+    mesh->SetNode(index, coords);
+#else
+    mesh->ChangeNode(index) = coords;
+#endif
+}
+
+void setTriangle(Poly_Triangulation* mesh, int index, const Poly_Triangle& triangle)
+{
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+    mesh->SetTriangle(index, triangle);
+#else
+    mesh->ChangeTriangle(index) = triangle;
+#endif
+}
+
+// Symmetric 4x4 matrix of the quadric error: sum of squared distances to planes, weighted by area
+struct Quadric {
+    double a2 = 0, ab = 0, ac = 0, ad = 0;
+    double b2 = 0, bc = 0, bd = 0;
+    double c2 = 0, cd = 0;
+    double d2 = 0;
+    double weight = 0; // Sum of the areas, so error can be normalized into a distance
+
+    // Plane a.x + b.y + c.z + d = 0 with (a, b, c) unit normal
+    static Quadric plane(const gp_XYZ& normal, double d, double weight) {
+        const double a = normal.X(), b = normal.Y(), c = normal.Z();
+        Quadric q;
+        q.a2 = weight * a * a; q.ab = weight * a * b; q.ac = weight * a * c; q.ad = weight * a * d;
+        q.b2 = weight * b * b; q.bc = weight * b * c; q.bd = weight * b * d;
+        q.c2 = weight * c * c; q.cd = weight * c * d;
+        q.d2 = weight * d * d;
+        q.weight = weight;
+        return q;
+    }
+
+    Quadric& operator+=(const Quadric& other) {
+        a2 += other.a2; ab += other.ab; ac += other.ac; ad += other.ad;
+        b2 += other.b2; bc += other.bc; bd += other.bd;
+        c2 += other.c2; cd += other.cd;
+        d2 += other.d2;
+        weight += other.weight;
+        return *this;
+    }
+
+    double evaluate(const gp_XYZ& p) const {
+        const double x = p.X(), y = p.Y(), z = p.Z();
+        const double value =
+                a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x
+                + b2 * y * y + 2 * bc * y * z + 2 * bd * y
+                + c2 * z * z + 2 * cd * z
+                + d2;
+        return std::max(0., value);
+    }
+
+    // Position minimizing the error, returns false if the system is ill-conditioned(eg planes all
+    // parallel)
+    bool optimum(gp_XYZ* p) const {
+        const double det =
+                a2 * (b2 * c2 - bc * bc) - ab * (ab * c2 - bc * ac) + ac * (ab * bc - b2 * ac);
+        const double trace = a2 + b2 + c2;
+        if (trace <= 0 || std::abs(det) <= 1e-9 * trace * trace * trace)
+            return false;
+
+        // Cramer's rule on A.p = -(ad, bd, cd)
+        const double rx = -ad, ry = -bd, rz = -cd;
+        const double x = rx * (b2 * c2 - bc * bc) - ab * (ry * c2 - bc * rz) + ac * (ry * bc - b2 * rz);
+        const double y = a2 * (ry * c2 - rz * bc) - rx * (ab * c2 - bc * ac) + ac * (ab * rz - ry * ac);
+        const double z = a2 * (b2 * rz - bc * ry) - ab * (ab * rz - ry * ac) + rx * (ab * bc - b2 * ac);
+        p->SetCoord(x / det, y / det, z / det);
+        return true;
+    }
+};
+
+// Welded triangulation being decimated, removed triangles have their first node set to -1
+struct DecimationData {
+    std::vector<gp_XYZ> vecPosition;
+    std::vector<std::array<int, 3>> vecTriangle;
+    int aliveTriangleCount = 0;
+};
+
+// Decimates the triangles of one cell down to 'targetCount' triangles
+// Only the cell triangles and the positions of vertices interior to the cell(all adjacent
+// triangles in the cell) are written, so cells can be processed concurrently
+// Returns the count of triangles removed
+int decimateCell(
+        DecimationData& data,
+        const std::vector<int>& vecVertexCell,
+        int cellId,
+        const int* cellTriangles,
+        int cellTriangleCount,
+        int targetCount,
+        double maxSquareError,
+        TaskProgress* progress)
+{
+    if (cellTriangleCount <= targetCount)
+        return 0;
+
+    // Local copy of the cell topology, vertices indexed locally
+    std::unordered_map<int, int> mapLocalVertex;
+    std::vector<int> vecGlobalVertex;
+    auto fnLocalVertex = [&](int iGlobal) {
+        const auto [it, isNew] = mapLocalVertex.try_emplace(iGlobal, int(vecGlobalVertex.size()));
+        if (isNew)
+            vecGlobalVertex.push_back(iGlobal);
+
+        return it->second;
+    };
+
+    std::vector<std::array<int, 3>> vecTriangle(cellTriangleCount);
+    std::vector<char> vecTriangleAlive(cellTriangleCount, 1);
+    for (int i = 0; i < cellTriangleCount; ++i) {
+        const std::array<int, 3>& globalTriangle = data.vecTriangle[cellTriangles[i]];
+        for (int j = 0; j < 3; ++j)
+            vecTriangle[i][j] = fnLocalVertex(globalTriangle[j]);
+    }
+
+    const int vertexCount = int(vecGlobalVertex.size());
+    auto fnPosition = [&](int v) -> gp_XYZ& { return data.vecPosition[vecGlobalVertex[v]]; };
+    std::vector<std::vector<int>> vecVertexTriangles(vertexCount);
+    std::vector<Quadric> vecQuadric(vertexCount);
+    std::vector<char> vecIsLocked(vertexCount, 0);
+    for (int v = 0; v < vertexCount; ++v)
+        vecIsLocked[v] = vecVertexCell[vecGlobalVertex[v]] != cellId ? 1 : 0;
+
+    for (int i = 0; i < cellTriangleCount; ++i) {
+        const std::array<int, 3>& tri = vecTriangle[i];
+        const gp_XYZ& p0 = fnPosition(tri[0]);
+        gp_XYZ normal = (fnPosition(tri[1]) - p0).Crossed(fnPosition(tri[2]) - p0);
+        const double doubleArea = normal.Modulus();
+        for (int j = 0; j < 3; ++j)
+            vecVertexTriangles[tri[j]].push_back(i);
+
+        if (doubleArea > 0) {
+            normal /= doubleArea;
+            const Quadric q = Quadric::plane(normal, -normal.Dot(p0), doubleArea / 2.);
+            for (int j = 0; j < 3; ++j)
+                vecQuadric[tri[j]] += q;
+        }
+    }
+
+    // Edges, also used to lock vertices on borders(edge having a single triangle) and on
+    // non-manifold edges. An edge having a single triangle in the cell but two in the whole
+    // triangulation has locked vertices anyway
+    std::vector<std::pair<int, int>> vecEdge;
+    vecEdge.reserve(3 * size_t(cellTriangleCount));
+    for (const std::array<int, 3>& tri : vecTriangle) {
+        for (int j = 0; j < 3; ++j) {
+            const int a = tri[j];
+            const int b = tri[(j + 1) % 3];
+            vecEdge.emplace_back(std::min(a, b), std::max(a, b));
+        }
+    }
+
+    std::sort(vecEdge.begin(), vecEdge.end());
+    std::vector<std::pair<int, int>> vecUniqueEdge;
+    for (size_t i = 0; i < vecEdge.size(); ) {
+        size_t iEnd = i + 1;
+        while (iEnd < vecEdge.size() && vecEdge[iEnd] == vecEdge[i])
+            ++iEnd;
+
+        if (iEnd - i != 2) {
+            vecIsLocked[vecEdge[i].first] = 1;
+            vecIsLocked[vecEdge[i].second] = 1;
+        }
+
+        vecUniqueEdge.push_back(vecEdge[i]);
+        i = iEnd;
+    }
+
+    std::vector<std::pair<int, int>>().swap(vecEdge);
+
+    // Priority queue of collapse candidates, invalidated lazily with vertex version stamps
+    struct Candidate {
+        double cost;
+        int u; // Kept vertex
+        int v; // Removed vertex
+        int versionU;
+        int versionV;
+        gp_XYZ target;
+
+        bool operator>(const Candidate& other) const { return cost > other.cost; }
+    };
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> queueCandidate;
+    std::vector<int> vecVersion(vertexCount, 0);
+    std::vector<char> vecVertexAlive(vertexCount, 1);
+    auto fnPushCandidate = [&](int u, int v) {
+        if (vecIsLocked[u] && vecIsLocked[v])
+            return;
+
+        if (vecIsLocked[v])
+            std::swap(u, v); // Removed vertex must not be locked
+
+        Quadric q = vecQuadric[u];
+        q += vecQuadric[v];
+        gp_XYZ target;
+        if (vecIsLocked[u]) {
+            target = fnPosition(u);
+        }
+        else {
+            // Optimal position, unless it's far away from the edge(near-degenerate quadric)
+            const gp_XYZ pu = fnPosition(u);
+            const gp_XYZ pv = fnPosition(v);
+            const gp_XYZ mid = (pu + pv) / 2.;
+            const double edgeSquareLength = (pv - pu).SquareModulus();
+            if (!q.optimum(&target) || (target - mid).SquareModulus() > 4 * edgeSquareLength) {
+                target = mid;
+                if (q.evaluate(pu) < q.evaluate(target))
+                    target = pu;
+
+                if (q.evaluate(pv) < q.evaluate(target))
+                    target = pv;
+            }
+        }
+
+        const double cost = q.evaluate(target);
+        if (maxSquareError > 0 && q.weight > 0 && cost / q.weight > maxSquareError)
+            return;
+
+        queueCandidate.push({ cost, u, v, vecVersion[u], vecVersion[v], target });
+    };
+    for (const auto& [a, b] : vecUniqueEdge)
+        fnPushCandidate(a, b);
+
+    std::vector<std::pair<int, int>>().swap(vecUniqueEdge);
+
+    auto fnNeighbours = [&](int v, std::vector<int>* ptrVec) {
+        ptrVec->clear();
+        for (int iTri : vecVertexTriangles[v]) {
+            if (!vecTriangleAlive[iTri])
+                continue;
+
+            for (int w : vecTriangle[iTri]) {
+                if (w != v)
+                    ptrVec->push_back(w);
+            }
+        }
+
+        std::sort(ptrVec->begin(), ptrVec->end());
+        ptrVec->erase(std::unique(ptrVec->begin(), ptrVec->end()), ptrVec->end());
+    };
+    auto fnContains = [](const std::array<int, 3>& tri, int v) {
+        return tri[0] == v || tri[1] == v || tri[2] == v;
+    };
+    // Triangles around 'v'(excluding those containing 'other') must not flip when 'v' moves to
+    // 'target'
+    auto fnIsFoldFree = [&](int v, int other, const gp_XYZ& target) {
+        for (int iTri : vecVertexTriangles[v]) {
+            const std::array<int, 3>& tri = vecTriangle[iTri];
+            if (!vecTriangleAlive[iTri] || fnContains(tri, other))
+                continue;
+
+            gp_XYZ p[3] = { fnPosition(tri[0]), fnPosition(tri[1]), fnPosition(tri[2]) };
+            const gp_XYZ normalBefore = (p[1] - p[0]).Crossed(p[2] - p[0]);
+            for (int j = 0; j < 3; ++j) {
+                if (tri[j] == v)
+                    p[j] = target;
+            }
+
+            const gp_XYZ normalAfter = (p[1] - p[0]).Crossed(p[2] - p[0]);
+            if (normalBefore.Dot(normalAfter) <= 0 || normalAfter.SquareModulus() <= 0)
+                return false;
+        }
+
+        return true;
+    };
+
+    std::vector<int> vecNeighboursU;
+    std::vector<int> vecNeighboursV;
+    int aliveCount = cellTriangleCount;
+    int iteration = 0;
+    while (aliveCount > targetCount && !queueCandidate.empty()) {
+        if (++iteration % 4096 == 0) {
+            progress->setValue((100 * (cellTriangleCount - aliveCount)) / (cellTriangleCount - targetCount));
+            if (TaskProgress::isAbortRequested(progress))
+                return 0;
+        }
+
+        const Candidate candidate = queueCandidate.top();
+        queueCandidate.pop();
+        const int u = candidate.u;
+        const int v = candidate.v;
+        if (!vecVertexAlive[u] || !vecVertexAlive[v]
+                || vecVersion[u] != candidate.versionU || vecVersion[v] != candidate.versionV)
+        {
+            continue; // Obsolete candidate
+        }
+
+        // Link condition: vertices adjacent to both 'u' and 'v' must be the opposite vertices of
+        // the triangles sharing edge uv, otherwise the collapse creates non-manifold topology
+        int sharedTriangleCount = 0;
+        for (int iTri : vecVertexTriangles[v]) {
+            if (vecTriangleAlive[iTri] && fnContains(vecTriangle[iTri], u))
+                ++sharedTriangleCount;
+        }
+
+        if (sharedTriangleCount == 0)
+            continue; // Edge doesn't exist anymore
+
+        fnNeighbours(u, &vecNeighboursU);
+        fnNeighbours(v, &vecNeighboursV);
+        int commonNeighbourCount = 0;
+        for (int w : vecNeighboursV) {
+            if (w != u && std::binary_search(vecNeighboursU.cbegin(), vecNeighboursU.cend(), w))
+                ++commonNeighbourCount;
+        }
+
+        if (commonNeighbourCount != sharedTriangleCount)
+            continue;
+
+        if (!fnIsFoldFree(v, u, candidate.target))
+            continue;
+
+        if (!vecIsLocked[u] && !fnIsFoldFree(u, v, candidate.target))
+            continue;
+
+        // Collapse 'v' into 'u'
+        for (int iTri : vecVertexTriangles[v]) {
+            if (!vecTriangleAlive[iTri])
+                continue;
+
+            std::array<int, 3>& tri = vecTriangle[iTri];
+            if (fnContains(tri, u)) {
+                vecTriangleAlive[iTri] = 0;
+                --aliveCount;
+            }
+            else {
+                std::replace(tri.begin(), tri.end(), v, u);
+                vecVertexTriangles[u].push_back(iTri);
+            }
+        }
+
+        std::vector<int>& vecTrianglesU = vecVertexTriangles[u];
+        vecTrianglesU.erase(
+                    std::remove_if(vecTrianglesU.begin(), vecTrianglesU.end(), [&](int iTri) { return !vecTriangleAlive[iTri]; }),
+                    vecTrianglesU.end());
+        std::vector<int>().swap(vecVertexTriangles[v]);
+        if (!vecIsLocked[u])
+            fnPosition(u) = candidate.target;
+
+        vecQuadric[u] += vecQuadric[v];
+        vecVertexAlive[v] = 0;
+        ++vecVersion[u];
+        fnNeighbours(u, &vecNeighboursU);
+        for (int w : vecNeighboursU)
+            fnPushCandidate(u, w);
+    }
+
+    // Write back the cell triangles
+    for (int i = 0; i < cellTriangleCount; ++i) {
+        std::array<int, 3>& globalTriangle = data.vecTriangle[cellTriangles[i]];
+        if (vecTriangleAlive[i]) {
+            for (int j = 0; j < 3; ++j)
+                globalTriangle[j] = vecGlobalVertex[vecTriangle[i][j]];
+        }
+        else {
+            globalTriangle[0] = -1;
+        }
+    }
+
+    return cellTriangleCount - aliveCount;
+}
+
+// One decimation pass over a grid of 'gridSize'^3 cells, shifted by 'gridOffset' cell size
+// Returns the count of triangles removed, or -1 if aborted
+int decimatePass(
+        DecimationData& data,
+        const Bnd_Box& bndBox,
+        int gridSize,
+        double gridOffset,
+        double ratio,
+        double maxSquareError,
+        TaskProgress* progress)
+{
+    const int axisCellCount = gridSize + (gridOffset > 0 ? 1 : 0);
+    const gp_XYZ boxMin = bndBox.CornerMin().XYZ();
+    const gp_XYZ boxSize = bndBox.CornerMax().XYZ() - boxMin;
+    auto fnCellId = [&](const gp_XYZ& pnt) {
+        int cellId = 0;
+        for (int c = 1; c <= 3; ++c) {
+            const double t = boxSize.Coord(c) > 0 ? (pnt.Coord(c) - boxMin.Coord(c)) / boxSize.Coord(c) : 0;
+            const int index = std::clamp(int(std::floor(t * gridSize + gridOffset)), 0, axisCellCount - 1);
+            cellId = cellId * axisCellCount + index;
+        }
+
+        return cellId;
+    };
+
+    // Cell of each triangle(from its centroid), then triangles grouped by cell
+    const int triangleCount = int(data.vecTriangle.size());
+    const int cellCount = axisCellCount * axisCellCount * axisCellCount;
+    std::vector<int> vecTriangleCell(triangleCount, -1);
+    std::vector<int> vecCellOffset(cellCount + 1, 0);
+    for (int i = 0; i < triangleCount; ++i) {
+        const std::array<int, 3>& tri = data.vecTriangle[i];
+        if (tri[0] < 0)
+            continue;
+
+        const gp_XYZ centroid =
+                (data.vecPosition[tri[0]] + data.vecPosition[tri[1]] + data.vecPosition[tri[2]]) / 3.;
+        vecTriangleCell[i] = fnCellId(centroid);
+        ++vecCellOffset[vecTriangleCell[i] + 1];
+    }
+
+    for (int i = 0; i < cellCount; ++i)
+        vecCellOffset[i + 1] += vecCellOffset[i];
+
+    std::vector<int> vecCellTriangles(vecCellOffset.back());
+    {
+        std::vector<int> vecCursor(vecCellOffset.begin(), vecCellOffset.end() - 1);
+        for (int i = 0; i < triangleCount; ++i) {
+            if (vecTriangleCell[i] >= 0)
+                vecCellTriangles[vecCursor[vecTriangleCell[i]]++] = i;
+        }
+    }
+
+    // Vertices used by triangles of different cells are locked(-1)
+    std::vector<int> vecVertexCell(data.vecPosition.size(), -2);
+    for (int i = 0; i < triangleCount; ++i) {
+        const int cellId = vecTriangleCell[i];
+        if (cellId < 0)
+            continue;
+
+        for (int v : data.vecTriangle[i]) {
+            int& vertexCell = vecVertexCell[v];
+            vertexCell = vertexCell == -2 || vertexCell == cellId ? cellId : -1;
+        }
+    }
+
+    std::vector<int>().swap(vecTriangleCell);
+    std::vector<int> vecCellRemovedCount(cellCount, 0);
+    auto fnDecimateCell = [&](int iCell, TaskProgress* cellProgress) {
+        const int cellTriangleCount = vecCellOffset[iCell + 1] - vecCellOffset[iCell];
+        const int targetCount = int(std::ceil(cellTriangleCount * ratio));
+        vecCellRemovedCount[iCell] = decimateCell(
+                    data, vecVertexCell, iCell,
+                    vecCellTriangles.data() + vecCellOffset[iCell], cellTriangleCount,
+                    targetCount, maxSquareError, cellProgress);
+    };
+    if (cellCount > 1) {
+        if (!TaskManager::runConcurrently(cellCount, progress, fnDecimateCell))
+            return -1;
+    }
+    else {
+        fnDecimateCell(0, progress);
+        if (TaskProgress::isAbortRequested(progress))
+            return -1;
+    }
+
+    int removedCount = 0;
+    for (int count : vecCellRemovedCount)
+        removedCount += count;
+
+    data.aliveTriangleCount -= removedCount;
+    return removedCount;
+}
+
+} // namespace
+
+MeshDecimation::Report& MeshDecimation::Report::operator+=(const Report& other)
+{
+    this->inputTriangleCount += other.inputTriangleCount;
+    this->outputTriangleCount += other.outputTriangleCount;
+    return *this;
+}
+
+Handle_Poly_Triangulation MeshDecimation::decimate(
+        const Handle_Poly_Triangulation& mesh, const Options& options, Report* report, TaskProgress* progress)
+{
+    MAYO_PROFILE_ZONE("MeshDecimation::decimate");
+    Report result;
+    result.inputTriangleCount = !mesh.IsNull() ? mesh->NbTriangles() : 0;
+    result.outputTriangleCount = result.inputTriangleCount;
+    auto fnSetReport = [&]{
+        if (report)
+            *report = result;
+    };
+
+    const int targetCount =
+            options.targetTriangleCount > 0 ?
+                options.targetTriangleCount :
+                int(std::ceil(result.inputTriangleCount * std::clamp(options.targetRatio, 0., 1.)));
+    if (mesh.IsNull() || result.inputTriangleCount <= std::max(1, targetCount)) {
+        fnSetReport();
+        return mesh;
+    }
+
+    // Edge collapses need connectivity, which "triangle soups" don't have
+    Handle_Poly_Triangulation meshWelded;
+    {
+        TaskProgress weldProgress(progress, 20);
+        meshWelded = MeshRepair::repair(mesh, MeshRepair::Options(), nullptr, &weldProgress);
+        if (meshWelded.IsNull())
+            return {};
+    }
+
+    DecimationData data;
+    data.vecPosition.resize(meshWelded->NbNodes());
+    Bnd_Box bndBox;
+    for (int i = 0; i < meshWelded->NbNodes(); ++i) {
+        const gp_Pnt pnt = meshWelded->Node(i + 1);
+        data.vecPosition[i] = pnt.XYZ();
+        bndBox.Add(pnt);
+    }
+
+    data.vecTriangle.resize(meshWelded->NbTriangles());
+    for (int i = 0; i < meshWelded->NbTriangles(); ++i) {
+        std::array<int, 3>& tri = data.vecTriangle[i];
+        meshWelded->Triangle(i + 1).Get(tri[0], tri[1], tri[2]);
+        for (int& node : tri)
+            --node; // 0-based
+    }
+
+    data.aliveTriangleCount = int(data.vecTriangle.size());
+    meshWelded.Nullify();
+
+    // Small triangulations are decimated as a single cell
+    const int threadCount = std::max(1, int(std::thread::hardware_concurrency()));
+    const int gridSize =
+            data.aliveTriangleCount < (1 << 17) ?
+                1 :
+                std::clamp(int(std::lround(std::cbrt(4. * threadCount))), 1, 8);
+    const double maxSquareError = options.maxError * options.maxError;
+    const double gridOffsets[] = { 0., 0.5, 0.25 };
+    {
+        TaskProgress decimateProgress(progress, 70);
+        const int passCount = gridSize > 1 ? int(std::size(gridOffsets)) : 1;
+        for (int iPass = 0; iPass < passCount && data.aliveTriangleCount > targetCount; ++iPass) {
+            TaskProgress passProgress(&decimateProgress, 100. / passCount);
+            const double ratio = double(targetCount) / double(data.aliveTriangleCount);
+            const int removedCount = decimatePass(
+                        data, bndBox, gridSize, gridOffsets[iPass], ratio, maxSquareError, &passProgress);
+            if (removedCount < 0)
+                return {};
+
+            if (removedCount == 0)
+                break;
+        }
+    }
+
+    // Compact nodes and triangles
+    std::vector<int> vecNodeIndex(data.vecPosition.size(), 0);
+    for (const std::array<int, 3>& tri : data.vecTriangle) {
+        if (tri[0] >= 0) {
+            for (int v : tri)
+                vecNodeIndex[v] = 1;
+        }
+    }
+
+    int nodeCount = 0;
+    for (int& index : vecNodeIndex)
+        index = index ? ++nodeCount : 0; // 1-based
+
+    Handle_Poly_Triangulation newMesh = new Poly_Triangulation(nodeCount, data.aliveTriangleCount, false);
+    for (size_t i = 0; i < vecNodeIndex.size(); ++i) {
+        if (vecNodeIndex[i] > 0)
+            setNode(newMesh.get(), vecNodeIndex[i], data.vecPosition[i]);
+    }
+
+    int triangleIndex = 0;
+    for (const std::array<int, 3>& tri : data.vecTriangle) {
+        if (tri[0] >= 0) {
+            const Poly_Triangle triangle(vecNodeIndex[tri[0]], vecNodeIndex[tri[1]], vecNodeIndex[tri[2]]);
+            setTriangle(newMesh.get(), ++triangleIndex, triangle);
+        }
+    }
+
+    newMesh->Deflection(mesh->Deflection());
+    result.outputTriangleCount = data.aliveTriangleCount;
+    fnSetReport();
+    if (progress)
+        progress->setValue(100);
+
+    return newMesh;
+}
+
+MeshDecimation::Report MeshDecimation::decimateLabel(const TDF_Label& label, const Options& options, TaskProgress* progress)
+{
+    Report report;
+    auto attrTriangulation = CafUtils::findAttribute<TDataXtd_Triangulation>(label);
+    if (!attrTriangulation.IsNull()) {
+        const Handle_Poly_Triangulation mesh = attrTriangulation->Get();
+        const Handle_Poly_Triangulation newMesh = MeshDecimation::decimate(mesh, options, &report, progress);
+        if (!newMesh.IsNull() && newMesh != mesh)
+            attrTriangulation->Set(newMesh);
+
+        return report;
+    }
+
+    if (!XCaf::isShape(label))
+        return report;
+
+    // Faces holding only a triangulation, each prototype is processed once
+    TopTools_IndexedMapOfShape mapFace;
+    for (const TDF_Label& labelPrototype : XCaf::shapePrototypes(label))
+        TopExp::MapShapes(XCaf::shape(labelPrototype), TopAbs_FACE, mapFace);
+
+    std::vector<TopoDS_Face> vecFace;
+    int totalTriangleCount = 0;
+    for (int i = 1; i <= mapFace.Extent(); ++i) {
+        const TopoDS_Face& face = TopoDS::Face(mapFace.FindKey(i));
+        TopLoc_Location loc;
+        const Handle_Poly_Triangulation& mesh = BRep_Tool::Triangulation(face, loc);
+        if (BRep_Tool::Surface(face, loc).IsNull() && !mesh.IsNull()) {
+            vecFace.push_back(face);
+            totalTriangleCount += mesh->NbTriangles();
+        }
+    }
+
+    // Target count of the whole shape is distributed over faces
+    Options faceOptions = options;
+    if (options.targetTriangleCount > 0) {
+        faceOptions.targetTriangleCount = 0;
+        faceOptions.targetRatio = double(options.targetTriangleCount) / std::max(1, totalTriangleCount);
+    }
+
+    BRep_Builder builder;
+    const double subPortionSize = 100. / std::max<size_t>(1, vecFace.size());
+    for (const TopoDS_Face& face : vecFace) {
+        TaskProgress subProgress(progress, subPortionSize);
+        TopLoc_Location loc;
+        const Handle_Poly_Triangulation mesh = BRep_Tool::Triangulation(face, loc);
+        Report faceReport;
+        const Handle_Poly_Triangulation newMesh = MeshDecimation::decimate(mesh, faceOptions, &faceReport, &subProgress);
+        if (newMesh.IsNull())
+            break; // Aborted
+
+        if (newMesh != mesh)
+            builder.UpdateFace(face, newMesh);
+
+        report += faceReport;
+    }
+
+    return report;
+}
+
+} // namespace Mayo
@@ -0,0 +1,56 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include <Poly_Triangulation.hxx>
+#include <TDF_Label.hxx>
+
+namespace Mayo {
+
+class TaskProgress;
+
+// Simplification of triangulations by edge collapses ordered with quadric error metrics
+// (Garland-Heckbert)
+// The triangulation is split into a grid of spatial cells decimated concurrently, vertices
+// shared by several cells are locked. Passes are then repeated with shifted grids so the cell
+// borders get decimated too
+// Border vertices of open triangulations are kept so holes and outlines don't shrink
+struct MeshDecimation {
+    struct Options {
+        // Count of triangles to reach, 'targetRatio' is used instead if zero
+        int targetTriangleCount = 0;
+        // Count of triangles to reach relative to the input count, in ]0, 1]
+        double targetRatio = 0.5;
+        // Maximum distance allowed between decimated and original surfaces, collapses giving a
+        // bigger error are rejected so target count might not be reached. Zero means no limit
+        double maxError = 0;
+    };
+
+    struct Report {
+        int inputTriangleCount = 0;
+        int outputTriangleCount = 0;
+
+        Report& operator+=(const Report& other);
+    };
+
+    // Returns the decimated triangulation, nodes are welded first(see MeshRepair). UV nodes and
+    // normals are not kept
+    // Returns 'mesh' itself if it's already under the target count, null handle if 'progress' was
+    // aborted
+    static Handle_Poly_Triangulation decimate(
+            const Handle_Poly_Triangulation& mesh,
+            const Options& options,
+            Report* report = nullptr,
+            TaskProgress* progress = nullptr);
+
+    // Decimates in place the triangulation of a mesh label(TDataXtd_Triangulation attribute) or
+    // the triangulations of the faces without geometric surface of a XCAF shape
+    // For XCAF shapes 'targetTriangleCount' applies to the whole shape
+    static Report decimateLabel(const TDF_Label& label, const Options& options, TaskProgress* progress = nullptr);
+};
+
+} // namespace Mayo
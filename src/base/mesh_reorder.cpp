@@ -0,0 +1,482 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "mesh_reorder.h"
+
+#include "caf_utils.h"
+#include "profiler.h"
+#include "task_manager.h"
+#include "task_progress.h"
+#include "tkernel_utils.h"
+#include "xcaf.h"
+
+#include <BRep_Tool.hxx>
+#include <Graphic3d_Vec3.hxx>
+#include <TDataXtd_Triangulation.hxx>
+#include <TShort_HArray1OfShortReal.hxx>
+#include <TopExp.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+#include <TopoDS.hxx>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace Mayo {
+
+namespace {
+
+Poly_Triangle triangleAt(const Handle_Poly_Triangulation& mesh, int index)
+{
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+    return mesh->Triangle(index);
+#else
+    return mesh->Triangles().Value(index);
+#endif
+}
+
+void setTriangle(Poly_Triangulation* mesh, int index, const Poly_Triangle& triangle)
+{
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+    mesh->SetTriangle(index, triangle);
+#else
+    mesh->ChangeTriangle(index) = triangle;
+#endif
+}
+
+void setNode(Poly_Triangulation* mesh, int index, const gp_Pnt& pnt)
+{
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+    mesh->SetNode(index, pnt);
+#else
+    mesh->ChangeNode(index) = pnt;
+#endif
+}
+
+void setUVNode(Poly_Triangulation* mesh, int index, const gp_Pnt2d& uv)
+{
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+    mesh->SetUVNode(index, uv);
+#else
+    mesh->ChangeUVNode(index) = uv;
+#endif
+}
+
+Graphic3d_Vec3 nodeNormal(const Handle_Poly_Triangulation& mesh, int index)
+{
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+    const gp_Dir normal = mesh->Normal(index);
+    return Graphic3d_Vec3(float(normal.X()), float(normal.Y()), float(normal.Z()));
+#else
+    const TShort_Array1OfShortReal& normals = mesh->Normals();
+    return Graphic3d_Vec3(normals(3 * index - 2), normals(3 * index - 1), normals(3 * index));
+#endif
+}
+
+// Spreads the 10 lower bits of 'v' so there are two zero bits between each of them
+uint32_t expandBits10(uint32_t v)
+{
+    v &= 0x3ff;
+    v = (v | (v << 16)) & 0x030000ff;
+    v = (v | (v << 8)) & 0x0300f00f;
+    v = (v | (v << 4)) & 0x030c30c3;
+    v = (v | (v << 2)) & 0x09249249;
+    return v;
+}
+
+// Sorts triangles along the Morton curve of their centroids, quantized on a 1024^3 grid
+// Triangles are 3 consecutive 0-based node indices in 'vecTriangleNode'
+void sortTrianglesMorton(std::vector<int>& vecTriangleNode, const std::vector<gp_Pnt>& vecNode)
+{
+    const int triangleCount = int(vecTriangleNode.size() / 3);
+    std::vector<gp_XYZ> vecCentroid(triangleCount);
+    gp_XYZ minCorner(RealLast(), RealLast(), RealLast());
+    gp_XYZ maxCorner(RealFirst(), RealFirst(), RealFirst());
+    for (int i = 0; i < triangleCount; ++i) {
+        const int* nodes = &vecTriangleNode[3 * size_t(i)];
+        const gp_XYZ centroid =
+                (vecNode[nodes[0]].XYZ() + vecNode[nodes[1]].XYZ() + vecNode[nodes[2]].XYZ()) / 3.;
+        vecCentroid[i] = centroid;
+        for (int c = 1; c <= 3; ++c) {
+            minCorner.SetCoord(c, std::min(minCorner.Coord(c), centroid.Coord(c)));
+            maxCorner.SetCoord(c, std::max(maxCorner.Coord(c), centroid.Coord(c)));
+        }
+    }
+
+    const gp_XYZ extent = maxCorner - minCorner;
+    const double scale = 1023. / std::max({ extent.X(), extent.Y(), extent.Z(), 1e-30 });
+    std::vector<std::pair<uint32_t, int>> vecCodeTriangle(triangleCount);
+    for (int i = 0; i < triangleCount; ++i) {
+        const gp_XYZ pos = (vecCentroid[i] - minCorner) * scale;
+        const uint32_t code = (expandBits10(uint32_t(pos.X())) << 2)
+                | (expandBits10(uint32_t(pos.Y())) << 1)
+                | expandBits10(uint32_t(pos.Z()));
+        vecCodeTriangle[i] = { code, i };
+    }
+
+    // Stable so triangles in the same cell keep their relative order
+    std::stable_sort(vecCodeTriangle.begin(), vecCodeTriangle.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.first < rhs.first;
+    });
+    std::vector<int> vecSorted(vecTriangleNode.size());
+    for (int i = 0; i < triangleCount; ++i) {
+        const int iSource = vecCodeTriangle[i].second;
+        for (int j = 0; j < 3; ++j)
+            vecSorted[3 * size_t(i) + j] = vecTriangleNode[3 * size_t(iSource) + j];
+    }
+
+    vecTriangleNode = std::move(vecSorted);
+}
+
+// Score of a node in Forsyth's algorithm, see https://tomforsyth1000.github.io/papers/fast_vert_cache_opt.html
+float forsythVertexScore(int cachePos, int remainingValence, int cacheSize)
+{
+    if (remainingValence <= 0)
+        return -1.f; // No triangle needs this node anymore
+
+    constexpr float cacheDecayPower = 1.5f;
+    constexpr float lastTriangleScore = 0.75f;
+    constexpr float valenceBoostScale = 2.f;
+    constexpr float valenceBoostPower = 0.5f;
+    float score = 0.f;
+    if (cachePos >= 0) {
+        if (cachePos < 3) {
+            // Nodes of the last triangle added get a fixed score, so the next triangle doesn't
+            // go back and forth
+            score = lastTriangleScore;
+        }
+        else {
+            const float scaler = 1.f / (cacheSize - 3);
+            score = std::pow(1.f - (cachePos - 3) * scaler, cacheDecayPower);
+        }
+    }
+
+    // Nodes with few remaining triangles are boosted, so lone triangles are not left behind
+    score += valenceBoostScale * std::pow(float(remainingValence), -valenceBoostPower);
+    return score;
+}
+
+// Reorders triangles with Forsyth's algorithm, returns the new order of the triangles
+// When no triangle of the cache is left, next triangle not added yet in input order is taken, so
+// the Morton order is followed for the "jumps"
+std::vector<int> optimizeVertexCache(const std::vector<int>& vecTriangleNode, int nodeCount, int cacheSize)
+{
+    const int triangleCount = int(vecTriangleNode.size() / 3);
+    cacheSize = std::max(cacheSize, 4);
+
+    // Triangles adjacent to each node, in compressed rows
+    std::vector<int> vecNodeValence(nodeCount, 0);
+    for (int node : vecTriangleNode)
+        ++vecNodeValence[node];
+
+    std::vector<int> vecNodeOffset(nodeCount + 1, 0);
+    for (int i = 0; i < nodeCount; ++i)
+        vecNodeOffset[i + 1] = vecNodeOffset[i] + vecNodeValence[i];
+
+    std::vector<int> vecNodeTriangle(vecTriangleNode.size());
+    {
+        std::vector<int> vecFill(vecNodeOffset.begin(), vecNodeOffset.end() - 1);
+        for (int i = 0; i < triangleCount; ++i) {
+            for (int j = 0; j < 3; ++j) {
+                const int node = vecTriangleNode[3 * size_t(i) + j];
+                vecNodeTriangle[vecFill[node]++] = i;
+            }
+        }
+    }
+
+    std::vector<int> vecNodeCachePos(nodeCount, -1);
+    std::vector<float> vecNodeScore(nodeCount);
+    for (int i = 0; i < nodeCount; ++i)
+        vecNodeScore[i] = forsythVertexScore(-1, vecNodeValence[i], cacheSize);
+
+    std::vector<float> vecTriangleScore(triangleCount, 0.f);
+    for (int i = 0; i < triangleCount; ++i) {
+        for (int j = 0; j < 3; ++j)
+            vecTriangleScore[i] += vecNodeScore[vecTriangleNode[3 * size_t(i) + j]];
+    }
+
+    std::vector<bool> vecTriangleAdded(triangleCount, false);
+    std::vector<int> vecOrder;
+    vecOrder.reserve(triangleCount);
+    std::vector<int> vecCache;
+    std::vector<int> vecNewCache;
+    vecCache.reserve(cacheSize + 3);
+    vecNewCache.reserve(cacheSize + 3);
+    int nextTriangleCursor = 0;
+    int bestTriangle = -1;
+    for (int iOut = 0; iOut < triangleCount; ++iOut) {
+        if (bestTriangle < 0) {
+            while (vecTriangleAdded[nextTriangleCursor])
+                ++nextTriangleCursor;
+
+            bestTriangle = nextTriangleCursor;
+        }
+
+        vecOrder.push_back(bestTriangle);
+        vecTriangleAdded[bestTriangle] = true;
+        const int* triNodes = &vecTriangleNode[3 * size_t(bestTriangle)];
+
+        // Triangle isn't adjacent to its nodes anymore, it's moved out of the "remaining" part of
+        // each adjacency row
+        for (int j = 0; j < 3; ++j) {
+            const int node = triNodes[j];
+            int* rowBegin = &vecNodeTriangle[vecNodeOffset[node]];
+            int* rowEnd = rowBegin + vecNodeValence[node];
+            int* it = std::find(rowBegin, rowEnd, bestTriangle);
+            if (it != rowEnd) {
+                std::swap(*it, *(rowEnd - 1));
+                --vecNodeValence[node];
+            }
+        }
+
+        // Nodes of the triangle go first in the LRU cache
+        vecNewCache.clear();
+        for (int j = 0; j < 3; ++j) {
+            if (std::find(vecNewCache.cbegin(), vecNewCache.cend(), triNodes[j]) == vecNewCache.cend())
+                vecNewCache.push_back(triNodes[j]);
+        }
+
+        for (int node : vecCache) {
+            if (std::find(triNodes, triNodes + 3, node) == triNodes + 3)
+                vecNewCache.push_back(node);
+        }
+
+        // Scores of the nodes in the cache(or just evicted) and of their triangles are updated
+        for (int i = 0; i < int(vecNewCache.size()); ++i) {
+            const int node = vecNewCache[i];
+            vecNodeCachePos[node] = i < cacheSize ? i : -1;
+            const float score = forsythVertexScore(vecNodeCachePos[node], vecNodeValence[node], cacheSize);
+            const float delta = score - vecNodeScore[node];
+            vecNodeScore[node] = score;
+            for (int k = 0; k < vecNodeValence[node]; ++k)
+                vecTriangleScore[vecNodeTriangle[vecNodeOffset[node] + k]] += delta;
+        }
+
+        if (int(vecNewCache.size()) > cacheSize)
+            vecNewCache.resize(cacheSize);
+
+        std::swap(vecCache, vecNewCache);
+
+        // Best next triangle is searched among the ones using cached nodes
+        bestTriangle = -1;
+        float bestScore = -1.f;
+        for (int node : vecCache) {
+            for (int k = 0; k < vecNodeValence[node]; ++k) {
+                const int iTriangle = vecNodeTriangle[vecNodeOffset[node] + k];
+                if (vecTriangleScore[iTriangle] > bestScore) {
+                    bestScore = vecTriangleScore[iTriangle];
+                    bestTriangle = iTriangle;
+                }
+            }
+        }
+    }
+
+    return vecOrder;
+}
+
+// Faces are dispatched to a few tasks, one task per face would cost more than the reordering of
+// small faces
+int concurrentTaskCount(int itemCount)
+{
+    const int threadCount = std::max(1, int(std::thread::hardware_concurrency()));
+    return std::clamp(itemCount, 1, threadCount);
+}
+
+} // namespace
+
+void MeshReorder::reorder(const Handle_Poly_Triangulation& mesh, const Options& options)
+{
+    if (!mesh || mesh->NbTriangles() < 2)
+        return;
+
+    const int nodeCount = mesh->NbNodes();
+    const int triangleCount = mesh->NbTriangles();
+    std::vector<gp_Pnt> vecNode(nodeCount);
+    for (int i = 0; i < nodeCount; ++i)
+        vecNode[i] = mesh->Node(i + 1);
+
+    std::vector<int> vecTriangleNode(3 * size_t(triangleCount));
+    for (int i = 0; i < triangleCount; ++i) {
+        int n1, n2, n3;
+        triangleAt(mesh, i + 1).Get(n1, n2, n3);
+        vecTriangleNode[3 * size_t(i)] = n1 - 1;
+        vecTriangleNode[3 * size_t(i) + 1] = n2 - 1;
+        vecTriangleNode[3 * size_t(i) + 2] = n3 - 1;
+    }
+
+    if (options.mortonOrder)
+        sortTrianglesMorton(vecTriangleNode, vecNode);
+
+    if (options.vertexCacheOptimization) {
+        const std::vector<int> vecOrder = optimizeVertexCache(vecTriangleNode, nodeCount, options.vertexCacheSize);
+        std::vector<int> vecOrdered(vecTriangleNode.size());
+        for (int i = 0; i < triangleCount; ++i) {
+            for (int j = 0; j < 3; ++j)
+                vecOrdered[3 * size_t(i) + j] = vecTriangleNode[3 * size_t(vecOrder[i]) + j];
+        }
+
+        vecTriangleNode = std::move(vecOrdered);
+    }
+
+    if (options.renumberNodes) {
+        // Nodes in order of first use, unused nodes go last
+        std::vector<int> vecNewIndex(nodeCount, -1);
+        std::vector<int> vecNodeSource;
+        vecNodeSource.reserve(nodeCount);
+        for (int node : vecTriangleNode) {
+            if (vecNewIndex[node] < 0) {
+                vecNewIndex[node] = int(vecNodeSource.size());
+                vecNodeSource.push_back(node);
+            }
+        }
+
+        for (int i = 0; i < nodeCount; ++i) {
+            if (vecNewIndex[i] < 0) {
+                vecNewIndex[i] = int(vecNodeSource.size());
+                vecNodeSource.push_back(i);
+            }
+        }
+
+        for (int& node : vecTriangleNode)
+            node = vecNewIndex[node];
+
+        for (int i = 0; i < nodeCount; ++i)
+            setNode(mesh.get(), i + 1, vecNode[vecNodeSource[i]]);
+
+        if (mesh->HasUVNodes()) {
+            std::vector<gp_Pnt2d> vecUVNode(nodeCount);
+            for (int i = 0; i < nodeCount; ++i)
+                vecUVNode[i] = mesh->UVNode(i + 1);
+
+            for (int i = 0; i < nodeCount; ++i)
+                setUVNode(mesh.get(), i + 1, vecUVNode[vecNodeSource[i]]);
+        }
+
+        if (mesh->HasNormals()) {
+            std::vector<Graphic3d_Vec3> vecNormal(nodeCount);
+            for (int i = 0; i < nodeCount; ++i)
+                vecNormal[i] = nodeNormal(mesh, i + 1);
+
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+            for (int i = 0; i < nodeCount; ++i)
+                mesh->SetNormal(i + 1, vecNormal[vecNodeSource[i]]);
+#else
+            Handle_TShort_HArray1OfShortReal normals = new TShort_HArray1OfShortReal(1, 3 * nodeCount);
+            for (int i = 0; i < nodeCount; ++i) {
+                const Graphic3d_Vec3& normal = vecNormal[vecNodeSource[i]];
+                normals->SetValue(3 * i + 1, normal.x());
+                normals->SetValue(3 * i + 2, normal.y());
+                normals->SetValue(3 * i + 3, normal.z());
+            }
+
+            mesh->SetNormals(normals);
+#endif
+        }
+    }
+
+    for (int i = 0; i < triangleCount; ++i) {
+        const int* nodes = &vecTriangleNode[3 * size_t(i)];
+        setTriangle(mesh.get(), i + 1, Poly_Triangle(nodes[0] + 1, nodes[1] + 1, nodes[2] + 1));
+    }
+}
+
+bool MeshReorder::reorderShape(const TopoDS_Shape& shape, const Options& options, TaskProgress* progress)
+{
+    MAYO_PROFILE_ZONE("MeshReorder::reorderShape");
+    struct FaceMesh {
+        Handle_Poly_Triangulation mesh;
+        bool hasSurface;
+    };
+
+    std::vector<FaceMesh> vecFaceMesh;
+    std::unordered_set<const Poly_Triangulation*> setMesh;
+    TopTools_IndexedMapOfShape mapFace;
+    TopExp::MapShapes(shape, TopAbs_FACE, mapFace);
+    for (int i = 1; i <= mapFace.Extent(); ++i) {
+        const TopoDS_Face& face = TopoDS::Face(mapFace.FindKey(i));
+        TopLoc_Location loc;
+        const Handle_Poly_Triangulation& mesh = BRep_Tool::Triangulation(face, loc);
+        if (mesh && setMesh.insert(mesh.get()).second)
+            vecFaceMesh.push_back({ mesh, !BRep_Tool::Surface(face, loc).IsNull() });
+    }
+
+    if (vecFaceMesh.empty())
+        return true;
+
+    // Biggest triangulations first, for a better balance between tasks
+    std::sort(vecFaceMesh.begin(), vecFaceMesh.end(), [](const FaceMesh& lhs, const FaceMesh& rhs) {
+        return lhs.mesh->NbTriangles() > rhs.mesh->NbTriangles();
+    });
+    const int taskCount = concurrentTaskCount(int(vecFaceMesh.size()));
+    return TaskManager::runConcurrently(taskCount, progress, [&](int iTask, TaskProgress* taskProgress) {
+        for (size_t i = iTask; i < vecFaceMesh.size(); i += taskCount) {
+            if (TaskProgress::isAbortRequested(taskProgress))
+                return;
+
+            Options faceOptions = options;
+            // Polygons of the face edges refer to the node indices
+            faceOptions.renumberNodes = options.renumberNodes && !vecFaceMesh[i].hasSurface;
+            MeshReorder::reorder(vecFaceMesh[i].mesh, faceOptions);
+        }
+    });
+}
+
+bool MeshReorder::reorderLabel(const TDF_Label& label, const Options& options, TaskProgress* progress)
+{
+    auto attrTriangulation = CafUtils::findAttribute<TDataXtd_Triangulation>(label);
+    if (!attrTriangulation.IsNull()) {
+        MeshReorder::reorder(attrTriangulation->Get(), options);
+        return !TaskProgress::isAbortRequested(progress);
+    }
+
+    if (!XCaf::isShape(label))
+        return true;
+
+    const TDF_LabelSequence seqPrototype = XCaf::shapePrototypes(label);
+    const double subPortionSize = 100. / std::max(1, seqPrototype.Size());
+    for (const TDF_Label& labelPrototype : seqPrototype) {
+        TaskProgress subProgress(progress, subPortionSize);
+        if (!MeshReorder::reorderShape(XCaf::shape(labelPrototype), options, &subProgress))
+            return false;
+    }
+
+    return true;
+}
+
+double MeshReorder::averageCacheMissRatio(const Handle_Poly_Triangulation& mesh, int cacheSize)
+{
+    if (!mesh || mesh->NbTriangles() == 0)
+        return 0.;
+
+    cacheSize = std::max(cacheSize, 1);
+    std::vector<int> vecFifo(cacheSize, -1);
+    std::vector<bool> vecNodeCached(mesh->NbNodes() + 1, false);
+    int fifoHead = 0;
+    int64_t missCount = 0;
+    for (int i = 1; i <= mesh->NbTriangles(); ++i) {
+        int nodes[3];
+        triangleAt(mesh, i).Get(nodes[0], nodes[1], nodes[2]);
+        for (int node : nodes) {
+            if (vecNodeCached[node])
+                continue;
+
+            ++missCount;
+            if (vecFifo[fifoHead] >= 0)
+                vecNodeCached[vecFifo[fifoHead]] = false;
+
+            vecFifo[fifoHead] = node;
+            vecNodeCached[node] = true;
+            fifoHead = (fifoHead + 1) % cacheSize;
+        }
+    }
+
+    return double(missCount) / mesh->NbTriangles();
+}
+
+} // namespace Mayo
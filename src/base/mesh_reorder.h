@@ -0,0 +1,52 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include <Poly_Triangulation.hxx>
+#include <TDF_Label.hxx>
+#include <TopoDS_Shape.hxx>
+
+namespace Mayo {
+
+class TaskProgress;
+
+// Reordering of triangulations for memory locality and GPU vertex cache reuse
+// Triangles are first sorted along the Morton(Z-order) curve of their centroids, so triangles close
+// in space are close in memory. Then they are reordered with Forsyth's "linear-speed vertex cache
+// optimisation", so consecutive triangles share nodes still in the post-transform cache of the GPU
+// Finally nodes are renumbered in order of first use by the triangles
+// Triangulations are modified in place, shape stays the same: same nodes and same triangles(with
+// same orientation), just in a different order
+struct MeshReorder {
+    struct Options {
+        bool mortonOrder = true;
+        bool vertexCacheOptimization = true;
+        // Nodes can't be renumbered if some data refers to node indices, like the polygons of the
+        // edges of a face meshed by BRepMesh(Poly_PolygonOnTriangulation)
+        bool renumberNodes = true;
+        // Size of the simulated LRU vertex cache
+        int vertexCacheSize = 32;
+    };
+
+    static void reorder(const Handle_Poly_Triangulation& mesh, const Options& options);
+
+    // Reorders the triangulations of the faces of 'shape', they're processed concurrently
+    // Nodes of faces having a geometric surface are not renumbered, see Options::renumberNodes
+    // Returns false if 'progress' was aborted
+    static bool reorderShape(const TopoDS_Shape& shape, const Options& options, TaskProgress* progress = nullptr);
+
+    // Reorders the triangulation of a mesh label(TDataXtd_Triangulation attribute) or the
+    // triangulations of the prototypes of a XCAF shape
+    // Returns false if 'progress' was aborted
+    static bool reorderLabel(const TDF_Label& label, const Options& options, TaskProgress* progress = nullptr);
+
+    // Average count of vertex cache misses per triangle(ACMR) when drawing 'mesh' with a FIFO
+    // cache of 'cacheSize' entries. Ranges from ~0.5(best) to 3(worst)
+    static double averageCacheMissRatio(const Handle_Poly_Triangulation& mesh, int cacheSize = 32);
+};
+
+} // namespace Mayo
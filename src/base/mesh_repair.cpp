@@ -0,0 +1,592 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "mesh_repair.h"
+
+#include "caf_utils.h"
+#include "memory_usage.h"
+#include "mesh_utils.h"
+#include "profiler.h"
+#include "task_manager.h"
+#include "task_progress.h"
+#include "xcaf.h"
+
+#include <BRep_Builder.hxx>
+#include <BRep_Tool.hxx>
+#include <Graphic3d_Vec3.hxx>
+#include <Standard_Version.hxx>
+#include <TDataXtd_Triangulation.hxx>
+#include <TShort_HArray1OfShortReal.hxx>
+#include <TopExp.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+#include <TopoDS.hxx>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace Mayo {
+
+namespace {
+
+// Key of a node for welding: position(raw or snapped to grid), then bit patterns of UV and
+// normal(zero when absent)
+struct NodeKey {
+    uint64_t bits[8];
+
+    size_t hash() const {
+        // Spatial hash from "Optimized Spatial Hashing for Collision Detection of Deformable Objects"
+        uint64_t h = (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+        // Low bits of doubles are often null(eg integral coordinates), mix high bits down
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        return size_t(h);
+    }
+
+    bool operator==(const NodeKey& other) const {
+        return std::memcmp(bits, other.bits, sizeof(bits)) == 0;
+    }
+};
+
+struct NodeKeyHasher {
+    size_t operator()(const NodeKey& key) const { return key.hash(); }
+};
+
+uint64_t doubleBits(double value)
+{
+    value = value == 0. ? 0. : value; // -0 and +0 must give the same key
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+uint64_t floatBits(float value)
+{
+    value = value == 0.f ? 0.f : value;
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+Graphic3d_Vec3 nodeNormal(const Handle_Poly_Triangulation& mesh, int index)
+{
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+    const gp_Dir normal = mesh->Normal(index);
+    return Graphic3d_Vec3(float(normal.X()), float(normal.Y()), float(normal.Z()));
+#else
+    const TShort_Array1OfShortReal& normals = mesh->Normals();
+    return Graphic3d_Vec3(normals(3 * index - 2), normals(3 * index - 1), normals(3 * index));
+#endif
+}
+
+void setNode(Poly_Triangulation* mesh, int index, const gp_Pnt& pnt)
+{
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+    mesh->SetNode(index, pnt);
+#else
+    mesh->ChangeNode(index) = pnt;
+#endif
+}
+
+void setUVNode(Poly_Triangulation* mesh, int index, const gp_Pnt2d& uv)
+{
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+    mesh->SetUVNode(index, uv);
+#else
+    mesh->ChangeUVNode(index) = uv;
+#endif
+}
+
+void setTriangle(Poly_Triangulation* mesh, int index, const Poly_Triangle& triangle)
+{
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+    mesh->SetTriangle(index, triangle);
+#else
+    mesh->ChangeTriangle(index) = triangle;
+#endif
+}
+
+// Small triangulations are processed by a single task, thread dispatching would cost more
+int concurrentTaskCount(int itemCount)
+{
+    constexpr int minItemCountPerTask = 1 << 16;
+    const int threadCount = std::max(1, int(std::thread::hardware_concurrency()));
+    return std::clamp(itemCount / minItemCountPerTask, 1, threadCount);
+}
+
+bool runTasks(int taskCount, TaskProgress* progress, const std::function<void(int, TaskProgress*)>& fnTask)
+{
+    if (taskCount > 1)
+        return TaskManager::runConcurrently(taskCount, progress, fnTask);
+
+    fnTask(0, progress);
+    return !TaskProgress::isAbortRequested(progress);
+}
+
+// Flags triangles to be flipped so triangles adjacent through a manifold edge(shared by exactly
+// two triangles) traverse it in opposite directions. Then each connected part is oriented as a
+// whole: outwards if it's closed, otherwise as most of its triangles initially are
+// Triangles are 3 consecutive 0-based node indices in 'vecTriangleNode'
+// Returns the count of triangles to be flipped
+int unifyOrientation(
+        const std::vector<int>& vecTriangleNode,
+        const std::function<gp_XYZ(int)>& fnNodePoint,
+        std::vector<char>* ptrVecFlip)
+{
+    const int triangleCount = int(vecTriangleNode.size() / 3);
+    struct HalfEdge {
+        int nodeMin;
+        int nodeMax;
+        int triangle;
+        bool isForward; // Triangle goes from 'nodeMin' to 'nodeMax'
+    };
+    std::vector<HalfEdge> vecHalfEdge;
+    vecHalfEdge.reserve(vecTriangleNode.size());
+    for (int i = 0; i < triangleCount; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            const int a = vecTriangleNode[3 * i + j];
+            const int b = vecTriangleNode[3 * i + (j + 1) % 3];
+            vecHalfEdge.push_back({ std::min(a, b), std::max(a, b), i, a < b });
+        }
+    }
+
+    std::sort(vecHalfEdge.begin(), vecHalfEdge.end(), [](const HalfEdge& lhs, const HalfEdge& rhs) {
+        return lhs.nodeMin != rhs.nodeMin ? lhs.nodeMin < rhs.nodeMin : lhs.nodeMax < rhs.nodeMax;
+    });
+
+    // Adjacency graph in compressed form: links of triangle 'i' are in range
+    // [vecLinkOffset[i], vecLinkOffset[i+1][ of 'vecLink'
+    struct Link {
+        int triangle;
+        bool isConsistent; // Both triangles traverse the shared edge in opposite directions
+    };
+    struct EdgePair {
+        HalfEdge first;
+        HalfEdge second;
+    };
+    std::vector<EdgePair> vecEdgePair;
+    std::vector<char> vecIsOnBoundary(triangleCount, 0); // Free or non-manifold edge
+    for (size_t i = 0; i < vecHalfEdge.size(); ) {
+        size_t iEnd = i + 1;
+        while (iEnd < vecHalfEdge.size()
+               && vecHalfEdge[iEnd].nodeMin == vecHalfEdge[i].nodeMin
+               && vecHalfEdge[iEnd].nodeMax == vecHalfEdge[i].nodeMax)
+        {
+            ++iEnd;
+        }
+
+        if (iEnd - i == 2 && vecHalfEdge[i].triangle != vecHalfEdge[i + 1].triangle) {
+            vecEdgePair.push_back({ vecHalfEdge[i], vecHalfEdge[i + 1] });
+        }
+        else {
+            for (size_t k = i; k < iEnd; ++k)
+                vecIsOnBoundary[vecHalfEdge[k].triangle] = 1;
+        }
+
+        i = iEnd;
+    }
+
+    std::vector<HalfEdge>().swap(vecHalfEdge); // Release memory early
+    std::vector<int> vecLinkOffset(triangleCount + 1, 0);
+    for (const EdgePair& pair : vecEdgePair) {
+        ++vecLinkOffset[pair.first.triangle + 1];
+        ++vecLinkOffset[pair.second.triangle + 1];
+    }
+
+    for (int i = 0; i < triangleCount; ++i)
+        vecLinkOffset[i + 1] += vecLinkOffset[i];
+
+    std::vector<Link> vecLink(vecLinkOffset.back());
+    {
+        std::vector<int> vecLinkCursor(vecLinkOffset.begin(), vecLinkOffset.end() - 1);
+        for (const EdgePair& pair : vecEdgePair) {
+            const bool isConsistent = pair.first.isForward != pair.second.isForward;
+            vecLink[vecLinkCursor[pair.first.triangle]++] = { pair.second.triangle, isConsistent };
+            vecLink[vecLinkCursor[pair.second.triangle]++] = { pair.first.triangle, isConsistent };
+        }
+    }
+
+    std::vector<EdgePair>().swap(vecEdgePair);
+
+    // Propagate orientation across each connected part. Conflicts(non-orientable parts like
+    // Moebius strips) are ignored, orientation of the first visited triangle wins
+    std::vector<char>& vecFlip = *ptrVecFlip;
+    vecFlip.assign(triangleCount, 0);
+    std::vector<char> vecIsVisited(triangleCount, 0);
+    std::vector<int> vecPartTriangle;
+    int flippedCount = 0;
+    for (int seed = 0; seed < triangleCount; ++seed) {
+        if (vecIsVisited[seed])
+            continue;
+
+        vecPartTriangle.clear();
+        vecPartTriangle.push_back(seed);
+        vecIsVisited[seed] = 1;
+        bool isClosed = true;
+        for (size_t head = 0; head < vecPartTriangle.size(); ++head) {
+            const int triangle = vecPartTriangle[head];
+            isClosed = isClosed && !vecIsOnBoundary[triangle];
+            for (int iLink = vecLinkOffset[triangle]; iLink < vecLinkOffset[triangle + 1]; ++iLink) {
+                const Link& link = vecLink[iLink];
+                if (!vecIsVisited[link.triangle]) {
+                    vecIsVisited[link.triangle] = 1;
+                    vecFlip[link.triangle] = vecFlip[triangle] ^ (link.isConsistent ? 0 : 1);
+                    vecPartTriangle.push_back(link.triangle);
+                }
+            }
+        }
+
+        bool flipPart = false;
+        if (isClosed) {
+            double volume = 0;
+            for (int triangle : vecPartTriangle) {
+                const int* nodes = &vecTriangleNode[3 * triangle];
+                const int n2 = vecFlip[triangle] ? nodes[2] : nodes[1];
+                const int n3 = vecFlip[triangle] ? nodes[1] : nodes[2];
+                volume += MeshUtils::triangleSignedVolume(fnNodePoint(nodes[0]), fnNodePoint(n2), fnNodePoint(n3));
+            }
+
+            flipPart = volume < 0;
+        }
+        else {
+            const auto partFlippedCount = std::count_if(
+                        vecPartTriangle.cbegin(), vecPartTriangle.cend(), [&](int triangle) { return vecFlip[triangle] != 0; });
+            flipPart = 2 * size_t(partFlippedCount) > vecPartTriangle.size();
+        }
+
+        for (int triangle : vecPartTriangle) {
+            vecFlip[triangle] ^= flipPart ? 1 : 0;
+            flippedCount += vecFlip[triangle];
+        }
+    }
+
+    return flippedCount;
+}
+
+} // namespace
+
+bool MeshRepair::Report::isModified() const
+{
+    return this->removedNodeCount != 0 || this->removedTriangleCount != 0 || this->flippedTriangleCount != 0;
+}
+
+MeshRepair::Report& MeshRepair::Report::operator+=(const Report& other)
+{
+    this->removedNodeCount += other.removedNodeCount;
+    this->removedTriangleCount += other.removedTriangleCount;
+    this->flippedTriangleCount += other.flippedTriangleCount;
+    this->bytesBefore += other.bytesBefore;
+    this->bytesAfter += other.bytesAfter;
+    return *this;
+}
+
+Handle_Poly_Triangulation MeshRepair::repair(
+        const Handle_Poly_Triangulation& mesh, const Options& options, Report* report, TaskProgress* progress)
+{
+    MAYO_PROFILE_ZONE("MeshRepair::repair");
+    Report result;
+    if (mesh.IsNull() || mesh->NbTriangles() <= 0) {
+        if (report)
+            *report = result;
+
+        return mesh;
+    }
+
+    result.bytesBefore = MemoryUsage::ofTriangulation(mesh).triangulationBytes;
+    result.bytesAfter = result.bytesBefore;
+    const int nodeCount = mesh->NbNodes();
+    const int triangleCount = mesh->NbTriangles();
+    const bool hasUVNodes = mesh->HasUVNodes();
+    const bool hasNormals = mesh->HasNormals();
+
+    // Welding: nodes are partitioned into shards by spatial hash, each task handles one shard so
+    // there is no shared map. Node indices are first local to shards then made global
+    // 'vecNodeRemap' maps input 0-based node index to welded 0-based node index, 'vecNodeSource'
+    // maps welded node index to the input 0-based node index it's copied from
+    std::vector<int> vecNodeRemap(nodeCount);
+    std::vector<int> vecNodeSource;
+    if (options.weldVertices) {
+        auto fnNodeKey = [&](int i) {
+            NodeKey key = {};
+            const gp_Pnt pnt = mesh->Node(i + 1);
+            for (int c = 0; c < 3; ++c) {
+                const double coord = pnt.Coord(c + 1);
+                key.bits[c] = options.weldTolerance > 0 ?
+                            uint64_t(std::llround(coord / options.weldTolerance)) :
+                            doubleBits(coord);
+            }
+
+            if (hasUVNodes) {
+                const gp_Pnt2d uv = mesh->UVNode(i + 1);
+                key.bits[3] = doubleBits(uv.X());
+                key.bits[4] = doubleBits(uv.Y());
+            }
+
+            if (hasNormals) {
+                const Graphic3d_Vec3 normal = nodeNormal(mesh, i + 1);
+                key.bits[5] = floatBits(normal.x());
+                key.bits[6] = floatBits(normal.y());
+                key.bits[7] = floatBits(normal.z());
+            }
+
+            return key;
+        };
+
+        const int shardCount = concurrentTaskCount(nodeCount);
+        std::vector<std::vector<int>> vecShardNodes(shardCount);
+        TaskProgress weldProgress(progress, 40);
+        const bool okWeld = runTasks(shardCount, &weldProgress, [&](int iShard, TaskProgress* taskProgress) {
+            std::unordered_map<NodeKey, int, NodeKeyHasher> mapNode;
+            std::vector<int>& vecNode = vecShardNodes.at(iShard);
+            for (int i = 0; i < nodeCount; ++i) {
+                if (!TaskProgress::checkLoopProgress(taskProgress, i, 0, nodeCount))
+                    return;
+
+                const NodeKey key = fnNodeKey(i);
+                if (shardCount > 1 && int(key.hash() % shardCount) != iShard)
+                    continue;
+
+                const auto [it, isNew] = mapNode.try_emplace(key, int(vecNode.size()));
+                if (isNew)
+                    vecNode.push_back(i);
+
+                vecNodeRemap[i] = it->second;
+            }
+        });
+        if (!okWeld)
+            return {};
+
+        std::vector<int> vecShardOffset(shardCount + 1, 0);
+        for (int iShard = 0; iShard < shardCount; ++iShard)
+            vecShardOffset.at(iShard + 1) = vecShardOffset.at(iShard) + int(vecShardNodes.at(iShard).size());
+
+        vecNodeSource.reserve(vecShardOffset.back());
+        for (const std::vector<int>& vecNode : vecShardNodes)
+            vecNodeSource.insert(vecNodeSource.end(), vecNode.cbegin(), vecNode.cend());
+
+        std::vector<std::vector<int>>().swap(vecShardNodes);
+        if (shardCount > 1) {
+            TaskProgress offsetProgress(progress, 10);
+            const bool okOffset = runTasks(shardCount, &offsetProgress, [&](int iTask, TaskProgress* taskProgress) {
+                const int first = int((int64_t(iTask) * nodeCount) / shardCount);
+                const int last = int((int64_t(iTask + 1) * nodeCount) / shardCount);
+                for (int i = first; i < last; ++i) {
+                    if (!TaskProgress::checkLoopProgress(taskProgress, i, first, last))
+                        return;
+
+                    vecNodeRemap[i] += vecShardOffset.at(fnNodeKey(i).hash() % shardCount);
+                }
+            });
+            if (!okOffset)
+                return {};
+        }
+    }
+    else {
+        vecNodeSource.resize(nodeCount);
+        for (int i = 0; i < nodeCount; ++i) {
+            vecNodeRemap[i] = i;
+            vecNodeSource[i] = i;
+        }
+    }
+
+    auto fnWeldedPoint = [&](int iNode) { return mesh->Node(vecNodeSource[iNode] + 1).XYZ(); };
+
+    // Remap triangle nodes and flag the degenerate triangles, by contiguous ranges of triangles
+    std::vector<int> vecTriangleNode(3 * size_t(triangleCount));
+    std::vector<char> vecIsDegenerate(triangleCount, 0);
+    {
+        const int taskCount = concurrentTaskCount(triangleCount);
+        TaskProgress triangleProgress(progress, 20);
+        const bool okTriangles = runTasks(taskCount, &triangleProgress, [&](int iTask, TaskProgress* taskProgress) {
+            const int first = int((int64_t(iTask) * triangleCount) / taskCount);
+            const int last = int((int64_t(iTask + 1) * triangleCount) / taskCount);
+            for (int i = first; i < last; ++i) {
+                if (!TaskProgress::checkLoopProgress(taskProgress, i, first, last))
+                    return;
+
+                int n1, n2, n3;
+                mesh->Triangle(i + 1).Get(n1, n2, n3);
+                int* nodes = &vecTriangleNode[3 * size_t(i)];
+                nodes[0] = vecNodeRemap[n1 - 1];
+                nodes[1] = vecNodeRemap[n2 - 1];
+                nodes[2] = vecNodeRemap[n3 - 1];
+                if (!options.removeDegenerateTriangles)
+                    continue;
+
+                if (nodes[0] == nodes[1] || nodes[1] == nodes[2] || nodes[0] == nodes[2]) {
+                    vecIsDegenerate[i] = 1;
+                    continue;
+                }
+
+                // Null area with respect to size of the triangle(collinear nodes)
+                const gp_XYZ p1 = fnWeldedPoint(nodes[0]);
+                const gp_XYZ p2 = fnWeldedPoint(nodes[1]);
+                const gp_XYZ p3 = fnWeldedPoint(nodes[2]);
+                const double maxEdgeSquare = std::max({
+                        (p2 - p1).SquareModulus(), (p3 - p2).SquareModulus(), (p1 - p3).SquareModulus() });
+                if ((p2 - p1).Crossed(p3 - p1).Modulus() <= 1e-12 * maxEdgeSquare)
+                    vecIsDegenerate[i] = 1;
+            }
+        });
+        if (!okTriangles)
+            return {};
+    }
+
+    std::vector<int>().swap(vecNodeRemap);
+    int keptTriangleCount = 0;
+    for (int i = 0; i < triangleCount; ++i) {
+        if (vecIsDegenerate[i])
+            continue;
+
+        if (keptTriangleCount != i)
+            std::copy_n(&vecTriangleNode[3 * size_t(i)], 3, &vecTriangleNode[3 * size_t(keptTriangleCount)]);
+
+        ++keptTriangleCount;
+    }
+
+    vecTriangleNode.resize(3 * size_t(keptTriangleCount));
+    result.removedTriangleCount = triangleCount - keptTriangleCount;
+
+    // Drop nodes not used anymore by any triangle
+    if (options.removeDegenerateTriangles) {
+        std::vector<int> vecUsedNodeIndex(vecNodeSource.size(), -1);
+        for (int iNode : vecTriangleNode)
+            vecUsedNodeIndex[iNode] = 0;
+
+        int usedNodeCount = 0;
+        for (size_t i = 0; i < vecUsedNodeIndex.size(); ++i) {
+            if (vecUsedNodeIndex[i] == 0) {
+                vecUsedNodeIndex[i] = usedNodeCount;
+                vecNodeSource[usedNodeCount] = vecNodeSource[i];
+                ++usedNodeCount;
+            }
+        }
+
+        vecNodeSource.resize(usedNodeCount);
+        for (int& iNode : vecTriangleNode)
+            iNode = vecUsedNodeIndex[iNode];
+    }
+
+    result.removedNodeCount = nodeCount - int(vecNodeSource.size());
+    if (TaskProgress::isAbortRequested(progress))
+        return {};
+
+    std::vector<char> vecFlip;
+    if (options.unifyOrientation) {
+        MAYO_PROFILE_ZONE("MeshRepair::unifyOrientation");
+        result.flippedTriangleCount = unifyOrientation(vecTriangleNode, fnWeldedPoint, &vecFlip);
+    }
+
+    if (progress)
+        progress->setValue(90);
+
+    if (!result.isModified() || keptTriangleCount == 0) {
+        // Nothing to repair, or nothing would be left: input triangulation is kept as is
+        if (report)
+            *report = Report{ 0, 0, 0, result.bytesBefore, result.bytesBefore };
+
+        return mesh;
+    }
+
+    const int newNodeCount = int(vecNodeSource.size());
+    Handle_Poly_Triangulation newMesh = new Poly_Triangulation(newNodeCount, keptTriangleCount, hasUVNodes);
+    for (int i = 0; i < newNodeCount; ++i) {
+        setNode(newMesh.get(), i + 1, mesh->Node(vecNodeSource[i] + 1));
+        if (hasUVNodes)
+            setUVNode(newMesh.get(), i + 1, mesh->UVNode(vecNodeSource[i] + 1));
+    }
+
+    if (hasNormals) {
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+        newMesh->AddNormals();
+        for (int i = 0; i < newNodeCount; ++i)
+            newMesh->SetNormal(i + 1, nodeNormal(mesh, vecNodeSource[i] + 1));
+#else
+        Handle_TShort_HArray1OfShortReal normals = new TShort_HArray1OfShortReal(1, 3 * newNodeCount);
+        for (int i = 0; i < newNodeCount; ++i) {
+            const Graphic3d_Vec3 normal = nodeNormal(mesh, vecNodeSource[i] + 1);
+            normals->SetValue(3 * i + 1, normal.x());
+            normals->SetValue(3 * i + 2, normal.y());
+            normals->SetValue(3 * i + 3, normal.z());
+        }
+
+        newMesh->SetNormals(normals);
+#endif
+    }
+
+    for (int i = 0; i < keptTriangleCount; ++i) {
+        const int* nodes = &vecTriangleNode[3 * size_t(i)];
+        const Poly_Triangle triangle = !vecFlip.empty() && vecFlip[i] ?
+                    Poly_Triangle(nodes[0] + 1, nodes[2] + 1, nodes[1] + 1) :
+                    Poly_Triangle(nodes[0] + 1, nodes[1] + 1, nodes[2] + 1);
+        setTriangle(newMesh.get(), i + 1, triangle);
+    }
+
+    newMesh->Deflection(mesh->Deflection());
+    result.bytesAfter = MemoryUsage::ofTriangulation(newMesh).triangulationBytes;
+    if (report)
+        *report = result;
+
+    if (progress)
+        progress->setValue(100);
+
+    return newMesh;
+}
+
+MeshRepair::Report MeshRepair::repairLabel(const TDF_Label& label, const Options& options, TaskProgress* progress)
+{
+    Report report;
+    auto attrTriangulation = CafUtils::findAttribute<TDataXtd_Triangulation>(label);
+    if (!attrTriangulation.IsNull()) {
+        const Handle_Poly_Triangulation mesh = attrTriangulation->Get();
+        const Handle_Poly_Triangulation newMesh = MeshRepair::repair(mesh, options, &report, progress);
+        if (!newMesh.IsNull() && newMesh != mesh)
+            attrTriangulation->Set(newMesh);
+
+        return report;
+    }
+
+    if (!XCaf::isShape(label))
+        return report;
+
+    // Faces holding only a triangulation, each prototype is processed once
+    TopTools_IndexedMapOfShape mapFace;
+    for (const TDF_Label& labelPrototype : XCaf::shapePrototypes(label))
+        TopExp::MapShapes(XCaf::shape(labelPrototype), TopAbs_FACE, mapFace);
+
+    std::vector<TopoDS_Face> vecFace;
+    for (int i = 1; i <= mapFace.Extent(); ++i) {
+        const TopoDS_Face& face = TopoDS::Face(mapFace.FindKey(i));
+        TopLoc_Location loc;
+        if (BRep_Tool::Surface(face, loc).IsNull() && !BRep_Tool::Triangulation(face, loc).IsNull())
+            vecFace.push_back(face);
+    }
+
+    BRep_Builder builder;
+    const double subPortionSize = 100. / std::max<size_t>(1, vecFace.size());
+    for (const TopoDS_Face& face : vecFace) {
+        TaskProgress subProgress(progress, subPortionSize);
+        TopLoc_Location loc;
+        const Handle_Poly_Triangulation mesh = BRep_Tool::Triangulation(face, loc);
+        Report faceReport;
+        const Handle_Poly_Triangulation newMesh = MeshRepair::repair(mesh, options, &faceReport, &subProgress);
+        if (newMesh.IsNull())
+            break; // Aborted
+
+        if (newMesh != mesh)
+            builder.UpdateFace(face, newMesh);
+
+        report += faceReport;
+    }
+
+    return report;
+}
+
+} // namespace Mayo
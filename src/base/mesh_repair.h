@@ -0,0 +1,64 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include <Poly_Triangulation.hxx>
+#include <TDF_Label.hxx>
+#include <cstdint>
+
+namespace Mayo {
+
+class TaskProgress;
+
+// Repair of triangulations coming from "triangle soup" formats(STL, OBJ, ...)
+// Repaired triangulations are smaller and suited to computations assuming consistent topology,
+// like MeshUtils::triangulationVolume()
+struct MeshRepair {
+    struct Options {
+        // Merge nodes having the same position, and also the same UV/normal if any(so texture and
+        // shading seams are kept)
+        bool weldVertices = true;
+        // Positions are snapped to a grid of cells of this size before being compared, zero means
+        // positions must be strictly equal
+        // Note: two close positions falling in neighbour cells are not merged
+        double weldTolerance = 0;
+        // Remove triangles having two identical nodes or null area, and unused nodes
+        bool removeDegenerateTriangles = true;
+        // Flip triangles so adjacent ones are consistently oriented, closed parts are oriented
+        // outwards(positive volume)
+        bool unifyOrientation = true;
+    };
+
+    struct Report {
+        int removedNodeCount = 0;
+        int removedTriangleCount = 0;
+        int flippedTriangleCount = 0;
+        uint64_t bytesBefore = 0; // Estimated memory usage, see MemoryUsage::ofTriangulation()
+        uint64_t bytesAfter = 0;
+
+        int64_t savedBytes() const { return int64_t(this->bytesBefore) - int64_t(this->bytesAfter); }
+        bool isModified() const;
+        Report& operator+=(const Report& other);
+    };
+
+    // Returns the repaired triangulation, which is 'mesh' itself when nothing had to be repaired
+    // Welding and triangle processing are done concurrently for big triangulations
+    // Returns null handle if 'progress' was aborted
+    static Handle_Poly_Triangulation repair(
+            const Handle_Poly_Triangulation& mesh,
+            const Options& options,
+            Report* report = nullptr,
+            TaskProgress* progress = nullptr);
+
+    // Repairs the triangulations of 'label' in place: the triangulation of a mesh label
+    // (TDataXtd_Triangulation attribute) or the triangulations of the faces without geometric
+    // surface of a XCAF shape(eg shapes created by RWMesh_CafReader)
+    // Faces having a surface are left untouched, their triangulation comes from BRepMesh
+    static Report repairLabel(const TDF_Label& label, const Options& options, TaskProgress* progress = nullptr);
+};
+
+} // namespace Mayo
@@ -0,0 +1,234 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "mesh_section.h"
+
+#include "profiler.h"
+#include "task_manager.h"
+
+#include <BRep_Builder.hxx>
+#include <BRepBuilderAPI_MakePolygon.hxx>
+#include <Precision.hxx>
+#include <TopoDS_Compound.hxx>
+#include <algorithm>
+#include <cstdint>
+
+namespace Mayo {
+
+namespace {
+
+// Segment of the section within a triangle, ends are identified by the mesh edges they lie on
+struct SectionSegment {
+    uint64_t edgeKeys[2];
+    gp_Pnt points[2];
+};
+
+struct EdgeSegment {
+    uint64_t edgeKey;
+    int iSegment;
+
+    bool operator<(const EdgeSegment& other) const { return this->edgeKey < other.edgeKey; }
+};
+
+uint64_t edgeKey(int node1, int node2)
+{
+    return (uint64_t(std::min(node1, node2)) << 32) | uint64_t(std::max(node1, node2));
+}
+
+// Appends 'pnt' to 'vecPnt' unless it's coincident with the last point
+void appendPoint(std::vector<gp_Pnt>* vecPnt, const gp_Pnt& pnt)
+{
+    if (vecPnt->empty() || vecPnt->back().SquareDistance(pnt) > Precision::SquareConfusion())
+        vecPnt->push_back(pnt);
+}
+
+} // namespace
+
+std::vector<MeshSection::Polyline> MeshSection::compute(const DocumentBvh::Mesh& mesh, const gp_Pln& localPlane)
+{
+    std::vector<Polyline> vecPolyline;
+    const Poly_Triangulation* triangulation = mesh.triangulation.get();
+    if (!triangulation)
+        return vecPolyline;
+
+    const gp_XYZ& n = localPlane.Axis().Direction().XYZ();
+    const double d = n.Dot(localPlane.Location().XYZ());
+    auto fnSignedDistance = [=](int iNode) { return n.Dot(triangulation->Node(iNode).XYZ()) - d; };
+
+    // Intersection point of edge(node1, node2) with the plane, computed from the lowest node index
+    // so that triangles sharing the edge give the exact same point
+    auto fnEdgePoint = [=](int node1, double dist1, int node2, double dist2) {
+        if (node1 > node2) {
+            std::swap(node1, node2);
+            std::swap(dist1, dist2);
+        }
+
+        const gp_XYZ pnt1 = triangulation->Node(node1).XYZ();
+        const gp_XYZ pnt2 = triangulation->Node(node2).XYZ();
+        const double t = dist1 / (dist1 - dist2);
+        return gp_Pnt(pnt1 + t * (pnt2 - pnt1));
+    };
+
+    std::vector<SectionSegment> vecSegment;
+    DocumentBvh::forEachTriangleCrossing(mesh, localPlane, [&](int iTriangle) {
+        int nodes[3];
+        triangulation->Triangle(iTriangle).Get(nodes[0], nodes[1], nodes[2]);
+        const double dists[3] = {
+            fnSignedDistance(nodes[0]), fnSignedDistance(nodes[1]), fnSignedDistance(nodes[2])
+        };
+        SectionSegment segment;
+        int endCount = 0;
+        for (int i = 0; i < 3; ++i) {
+            const int j = (i + 1) % 3;
+            if ((dists[i] >= 0.) != (dists[j] >= 0.) && endCount < 2) {
+                segment.edgeKeys[endCount] = edgeKey(nodes[i], nodes[j]);
+                segment.points[endCount] = fnEdgePoint(nodes[i], dists[i], nodes[j], dists[j]);
+                ++endCount;
+            }
+        }
+
+        // Sign changes come by pair, zero or two edges cross the plane
+        if (endCount == 2)
+            vecSegment.push_back(segment);
+    });
+
+    // Chain segments through their shared edges
+    std::vector<EdgeSegment> vecEdgeSegment;
+    vecEdgeSegment.reserve(2 * vecSegment.size());
+    for (int i = 0; i < int(vecSegment.size()); ++i) {
+        vecEdgeSegment.push_back({ vecSegment[i].edgeKeys[0], i });
+        vecEdgeSegment.push_back({ vecSegment[i].edgeKeys[1], i });
+    }
+
+    std::sort(vecEdgeSegment.begin(), vecEdgeSegment.end());
+    std::vector<bool> vecSegmentVisited(vecSegment.size(), false);
+    auto fnNextSegment = [&](uint64_t key) {
+        const auto itRange = std::equal_range(
+                    vecEdgeSegment.cbegin(), vecEdgeSegment.cend(), EdgeSegment{ key, -1 });
+        for (auto it = itRange.first; it != itRange.second; ++it) {
+            if (!vecSegmentVisited.at(it->iSegment))
+                return it->iSegment;
+        }
+
+        return -1;
+    };
+
+    // Follows the chain from segment end 'key', appending points to 'vecPnt'
+    // Returns true if the chain came back to 'stopKey'
+    auto fnWalk = [&](uint64_t key, uint64_t stopKey, std::vector<gp_Pnt>* vecPnt) {
+        for (int iSeg = fnNextSegment(key); iSeg >= 0; iSeg = fnNextSegment(key)) {
+            vecSegmentVisited.at(iSeg) = true;
+            const SectionSegment& segment = vecSegment.at(iSeg);
+            const int iEnd = segment.edgeKeys[0] == key ? 1 : 0;
+            appendPoint(vecPnt, segment.points[iEnd]);
+            key = segment.edgeKeys[iEnd];
+            if (key == stopKey)
+                return true;
+        }
+
+        return false;
+    };
+
+    for (int i = 0; i < int(vecSegment.size()); ++i) {
+        if (vecSegmentVisited.at(i))
+            continue;
+
+        vecSegmentVisited.at(i) = true;
+        const SectionSegment& segment = vecSegment.at(i);
+        Polyline polyline;
+        polyline.points.push_back(segment.points[0]);
+        appendPoint(&polyline.points, segment.points[1]);
+        polyline.isClosed = fnWalk(segment.edgeKeys[1], segment.edgeKeys[0], &polyline.points);
+        if (polyline.isClosed) {
+            if (polyline.points.size() > 1
+                    && polyline.points.back().SquareDistance(polyline.points.front()) <= Precision::SquareConfusion())
+            {
+                polyline.points.pop_back();
+            }
+        }
+        else {
+            // Open chain: extend it backward from the first segment
+            std::vector<gp_Pnt> vecPntBackward = { segment.points[0] };
+            fnWalk(segment.edgeKeys[0], segment.edgeKeys[0], &vecPntBackward);
+            if (vecPntBackward.size() > 1) {
+                std::reverse(vecPntBackward.begin(), vecPntBackward.end());
+                vecPntBackward.pop_back(); // Duplicate of polyline front
+                polyline.points.insert(polyline.points.begin(), vecPntBackward.cbegin(), vecPntBackward.cend());
+            }
+        }
+
+        if (polyline.points.size() >= 2)
+            vecPolyline.push_back(std::move(polyline));
+    }
+
+    return vecPolyline;
+}
+
+std::vector<MeshSection::Polyline> MeshSection::compute(DocumentBvh& bvh, const gp_Pln& plane, TaskProgress* progress)
+{
+    MAYO_PROFILE_ZONE("MeshSection::compute");
+    const std::vector<DocumentBvh::InstancePtr> vecInstance = bvh.instancesCrossing(plane);
+    std::vector<std::vector<Polyline>> vecInstancePolylines(vecInstance.size());
+    auto fnComputeInstance = [&](int iInstance) {
+        const DocumentBvh::Instance& instance = *vecInstance.at(iInstance);
+        const gp_Pln localPlane = plane.Transformed(instance.trsf.Inverted());
+        std::vector<Polyline>& vecPolyline = vecInstancePolylines.at(iInstance);
+        vecPolyline = MeshSection::compute(*instance.mesh, localPlane);
+        for (Polyline& polyline : vecPolyline) {
+            for (gp_Pnt& pnt : polyline.points)
+                pnt.Transform(instance.trsf);
+        }
+    };
+
+    const int instanceCount = int(vecInstance.size());
+    if (instanceCount > 1)
+        TaskManager::runConcurrently(instanceCount, progress, [&](int i, TaskProgress*) { fnComputeInstance(i); });
+    else if (instanceCount == 1)
+        fnComputeInstance(0);
+
+    std::vector<Polyline> vecPolyline;
+    for (std::vector<Polyline>& vecInstancePolyline : vecInstancePolylines) {
+        for (Polyline& polyline : vecInstancePolyline)
+            vecPolyline.push_back(std::move(polyline));
+    }
+
+    return vecPolyline;
+}
+
+double MeshSection::length(const Polyline& polyline)
+{
+    const std::vector<gp_Pnt>& vecPnt = polyline.points;
+    double len = 0.;
+    for (size_t i = 1; i < vecPnt.size(); ++i)
+        len += vecPnt[i - 1].Distance(vecPnt[i]);
+
+    if (polyline.isClosed && vecPnt.size() > 2)
+        len += vecPnt.back().Distance(vecPnt.front());
+
+    return len;
+}
+
+TopoDS_Shape MeshSection::toShape(Span<const Polyline> polylines)
+{
+    BRep_Builder builder;
+    TopoDS_Compound cmpd;
+    builder.MakeCompound(cmpd);
+    for (const Polyline& polyline : polylines) {
+        BRepBuilderAPI_MakePolygon makePolygon;
+        for (const gp_Pnt& pnt : polyline.points)
+            makePolygon.Add(pnt);
+
+        if (polyline.isClosed && polyline.points.size() > 2)
+            makePolygon.Close();
+
+        if (makePolygon.IsDone())
+            builder.Add(cmpd, makePolygon.Wire());
+    }
+
+    return cmpd;
+}
+
+} // namespace Mayo
@@ -0,0 +1,45 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "document_bvh.h"
+#include "span.h"
+
+#include <TopoDS_Shape.hxx>
+#include <gp_Pln.hxx>
+#include <gp_Pnt.hxx>
+#include <vector>
+
+namespace Mayo {
+
+class TaskProgress;
+
+// Cross-sections of triangulations by a plane
+// Each triangle crossing the plane gives a segment whose ends lie on triangle edges, segments are
+// then chained through the mesh edges they share. Nodes exactly on the plane are considered on its
+// positive side, so shared vertices don't produce degenerated segments
+struct MeshSection {
+    struct Polyline {
+        std::vector<gp_Pnt> points;
+        bool isClosed = false; // If true then last point is implicitly joined to the first one
+    };
+
+    // Section of the triangulations indexed by 'bvh', points are in document coordinates
+    // Instances crossing the plane are processed concurrently
+    static std::vector<Polyline> compute(DocumentBvh& bvh, const gp_Pln& plane, TaskProgress* progress = nullptr);
+
+    // Section of a single triangulation, 'localPlane' and points are in triangulation coordinates
+    static std::vector<Polyline> compute(const DocumentBvh::Mesh& mesh, const gp_Pln& localPlane);
+
+    // Sum of the lengths of the polyline segments, including the closing segment
+    static double length(const Polyline& polyline);
+
+    // Compound of wires(one per polyline), suitable for display or export
+    static TopoDS_Shape toShape(Span<const Polyline> polylines);
+};
+
+} // namespace Mayo
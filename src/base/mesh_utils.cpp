@@ -5,8 +5,18 @@
 ****************************************************************************/
 
 #include "mesh_utils.h"
+#include "task_manager.h"
+#include "tkernel_utils.h"
+
 #include <QtCore/QtGlobal>
+#include <Bnd_Box.hxx>
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 namespace Mayo {
 
@@ -31,55 +41,602 @@ double MeshUtils::triangleArea(const gp_XYZ& p1, const gp_XYZ& p2, const gp_XYZ&
 
 double MeshUtils::triangulationVolume(const Handle_Poly_Triangulation& triangulation)
 {
+    return MeshUtils::triangulationMassProperties(triangulation).volume;
+}
+
+double MeshUtils::triangulationArea(const Handle_Poly_Triangulation& triangulation)
+{
+    return MeshUtils::triangulationMassProperties(triangulation).area;
+}
+
+namespace {
+
+// Sum with Neumaier compensation of the rounding errors
+class CompensatedSum {
+public:
+    void add(double value) {
+        const double t = m_sum + value;
+        if (std::abs(m_sum) >= std::abs(value))
+            m_compensation += (m_sum - t) + value;
+        else
+            m_compensation += (value - t) + m_sum;
+
+        m_sum = t;
+    }
+
+    void add(const CompensatedSum& other) {
+        this->add(other.m_sum);
+        this->add(other.m_compensation);
+    }
+
+    double value() const { return m_sum + m_compensation; }
+
+private:
+    double m_sum = 0.;
+    double m_compensation = 0.;
+};
+
+// Integrals of polynomials {1, x, y, z, x^2, y^2, z^2, xy, yz, zx} over the volume enclosed by
+// the triangles, plus area and area-weighted sum of triangle centers
+// See "Polyhedral Mass Properties(Revisited)" by David Eberly
+enum MassIntegral {
+    MassIntegral_1, MassIntegral_X, MassIntegral_Y, MassIntegral_Z,
+    MassIntegral_XX, MassIntegral_YY, MassIntegral_ZZ,
+    MassIntegral_XY, MassIntegral_YZ, MassIntegral_ZX,
+    MassIntegral_Area, MassIntegral_AreaX, MassIntegral_AreaY, MassIntegral_AreaZ,
+    MassIntegral_Count
+};
+
+struct MassIntegrals {
+    CompensatedSum value[MassIntegral_Count];
+
+    void add(const MassIntegrals& other) {
+        for (int i = 0; i < MassIntegral_Count; ++i)
+            this->value[i].add(other.value[i]);
+    }
+};
+
+// Triangles are processed by blocks whose vertex coordinates are first gathered into contiguous
+// arrays, so the computation of the terms is a branchless loop the compiler can vectorize
+constexpr int MassTriangleBlockSize = 64;
+
+void accumulateMassIntegrals(
+        const Handle_Poly_Triangulation& triangulation, int triFirst, int triLast, MassIntegrals* integrals)
+{
+    double x0[MassTriangleBlockSize], y0[MassTriangleBlockSize], z0[MassTriangleBlockSize];
+    double x1[MassTriangleBlockSize], y1[MassTriangleBlockSize], z1[MassTriangleBlockSize];
+    double x2[MassTriangleBlockSize], y2[MassTriangleBlockSize], z2[MassTriangleBlockSize];
+    double term[MassIntegral_Count][MassTriangleBlockSize];
+    for (int blockFirst = triFirst; blockFirst <= triLast; blockFirst += MassTriangleBlockSize) {
+        const int blockSize = std::min(MassTriangleBlockSize, triLast - blockFirst + 1);
+        for (int i = 0; i < blockSize; ++i) {
+            int n1, n2, n3;
+            triangulation->Triangle(blockFirst + i).Get(n1, n2, n3);
+            const gp_Pnt p1 = triangulation->Node(n1);
+            const gp_Pnt p2 = triangulation->Node(n2);
+            const gp_Pnt p3 = triangulation->Node(n3);
+            x0[i] = p1.X(); y0[i] = p1.Y(); z0[i] = p1.Z();
+            x1[i] = p2.X(); y1[i] = p2.Y(); z1[i] = p2.Z();
+            x2[i] = p3.X(); y2[i] = p3.Y(); z2[i] = p3.Z();
+        }
+
+        for (int i = 0; i < blockSize; ++i) {
+            // Cross product of the triangle edges
+            const double a1 = x1[i] - x0[i], b1 = y1[i] - y0[i], c1 = z1[i] - z0[i];
+            const double a2 = x2[i] - x0[i], b2 = y2[i] - y0[i], c2 = z2[i] - z0[i];
+            const double d0 = b1 * c2 - b2 * c1;
+            const double d1 = a2 * c1 - a1 * c2;
+            const double d2 = a1 * b2 - a2 * b1;
+
+            auto fnSubExpr = [](double w0, double w1, double w2, double* f, double* g) {
+                const double temp0 = w0 + w1;
+                const double temp1 = w0 * w0;
+                const double temp2 = temp1 + w1 * temp0;
+                f[0] = temp0 + w2;
+                f[1] = temp2 + w2 * f[0];
+                f[2] = w0 * temp1 + w1 * temp2 + w2 * f[1];
+                g[0] = f[1] + w0 * (f[0] + w0);
+                g[1] = f[1] + w1 * (f[0] + w1);
+                g[2] = f[1] + w2 * (f[0] + w2);
+            };
+            double fx[3], gx[3], fy[3], gy[3], fz[3], gz[3];
+            fnSubExpr(x0[i], x1[i], x2[i], fx, gx);
+            fnSubExpr(y0[i], y1[i], y2[i], fy, gy);
+            fnSubExpr(z0[i], z1[i], z2[i], fz, gz);
+
+            const double area = 0.5 * std::sqrt(d0 * d0 + d1 * d1 + d2 * d2);
+            term[MassIntegral_1][i] = d0 * fx[0];
+            term[MassIntegral_X][i] = d0 * fx[1];
+            term[MassIntegral_Y][i] = d1 * fy[1];
+            term[MassIntegral_Z][i] = d2 * fz[1];
+            term[MassIntegral_XX][i] = d0 * fx[2];
+            term[MassIntegral_YY][i] = d1 * fy[2];
+            term[MassIntegral_ZZ][i] = d2 * fz[2];
+            term[MassIntegral_XY][i] = d0 * (y0[i] * gx[0] + y1[i] * gx[1] + y2[i] * gx[2]);
+            term[MassIntegral_YZ][i] = d1 * (z0[i] * gy[0] + z1[i] * gy[1] + z2[i] * gy[2]);
+            term[MassIntegral_ZX][i] = d2 * (x0[i] * gz[0] + x1[i] * gz[1] + x2[i] * gz[2]);
+            term[MassIntegral_Area][i] = area;
+            term[MassIntegral_AreaX][i] = area * fx[0];
+            term[MassIntegral_AreaY][i] = area * fy[0];
+            term[MassIntegral_AreaZ][i] = area * fz[0];
+        }
+
+        for (int j = 0; j < MassIntegral_Count; ++j) {
+            for (int i = 0; i < blockSize; ++i)
+                integrals->value[j].add(term[j][i]);
+        }
+    }
+}
+
+} // namespace
+
+MeshUtils::MassProperties MeshUtils::triangulationMassProperties(const Handle_Poly_Triangulation& triangulation)
+{
+    MassProperties props;
+    if (!triangulation || triangulation->NbTriangles() <= 0)
+        return props;
+
+    // Minimum count of triangles processed by a task, below that threshold the overhead of tasks
+    // isn't worth
+    constexpr int minChunkSize = 65536;
+    const int triCount = triangulation->NbTriangles();
+    const int threadCount = std::max(1, int(std::thread::hardware_concurrency()));
+    const int chunkCount = std::max(1, std::min(triCount / minChunkSize, threadCount));
+    std::vector<MassIntegrals> vecChunkIntegrals(chunkCount);
+    auto fnChunk = [&](int iChunk) {
+        const int triFirst = 1 + int((int64_t(iChunk) * triCount) / chunkCount);
+        const int triLast = int((int64_t(iChunk + 1) * triCount) / chunkCount);
+        accumulateMassIntegrals(triangulation, triFirst, triLast, &vecChunkIntegrals.at(iChunk));
+    };
+    if (chunkCount > 1)
+        TaskManager::runConcurrently(chunkCount, nullptr, [&](int iChunk, TaskProgress*) { fnChunk(iChunk); });
+    else
+        fnChunk(0);
+
+    MassIntegrals integrals;
+    for (const MassIntegrals& chunkIntegrals : vecChunkIntegrals)
+        integrals.add(chunkIntegrals);
+
+    auto fnIntegral = [&](MassIntegral i) { return integrals.value[i].value(); };
+    double mass = fnIntegral(MassIntegral_1) / 6.;
+    // Triangles oriented inwards give negative integrals
+    const double sign = mass < 0 ? -1. : 1.;
+    mass *= sign;
+    props.area = fnIntegral(MassIntegral_Area);
+    props.volume = mass;
+    if (mass > 0) {
+        const double cx = sign * fnIntegral(MassIntegral_X) / (24. * mass);
+        const double cy = sign * fnIntegral(MassIntegral_Y) / (24. * mass);
+        const double cz = sign * fnIntegral(MassIntegral_Z) / (24. * mass);
+        const double xx = sign * fnIntegral(MassIntegral_XX) / 60.;
+        const double yy = sign * fnIntegral(MassIntegral_YY) / 60.;
+        const double zz = sign * fnIntegral(MassIntegral_ZZ) / 60.;
+        const double xy = sign * fnIntegral(MassIntegral_XY) / 120.;
+        const double yz = sign * fnIntegral(MassIntegral_YZ) / 120.;
+        const double zx = sign * fnIntegral(MassIntegral_ZX) / 120.;
+        const double ixx = yy + zz - mass * (cy * cy + cz * cz);
+        const double iyy = zz + xx - mass * (cz * cz + cx * cx);
+        const double izz = xx + yy - mass * (cx * cx + cy * cy);
+        const double ixy = -(xy - mass * cx * cy);
+        const double iyz = -(yz - mass * cy * cz);
+        const double izx = -(zx - mass * cz * cx);
+        props.centroid.SetCoord(cx, cy, cz);
+        props.inertia.SetRows(gp_XYZ(ixx, ixy, izx), gp_XYZ(ixy, iyy, iyz), gp_XYZ(izx, iyz, izz));
+    }
+    else if (props.area > 0) {
+        props.centroid.SetCoord(
+                    fnIntegral(MassIntegral_AreaX) / (3. * props.area),
+                    fnIntegral(MassIntegral_AreaY) / (3. * props.area),
+                    fnIntegral(MassIntegral_AreaZ) / (3. * props.area));
+    }
+
+    return props;
+}
+
+void MeshUtils::NormalArray::resize(int count)
+{
+    this->x.resize(count);
+    this->y.resize(count);
+    this->z.resize(count);
+}
+
+namespace {
+
+// Minimum count of items processed by a concurrent task, below that threading isn't worth it
+constexpr int MinNormalChunkSize = 65536;
+
+// Calls fn(first, last) on consecutive ranges [first, last[ partitioning [0, itemCount[, ranges
+// are processed concurrently for big counts
+int normalChunkCount(int itemCount)
+{
+    const int threadCount = std::max(1, int(std::thread::hardware_concurrency()));
+    return std::max(1, std::min(itemCount / MinNormalChunkSize, threadCount));
+}
+
+// Calls fn(iChunk) for each chunk index in [0, chunkCount[, concurrently if more than one chunk
+template<typename FN>
+void runChunks(int chunkCount, FN fn)
+{
+    if (chunkCount > 1)
+        TaskManager::runConcurrently(chunkCount, nullptr, [&](int iChunk, TaskProgress*) { fn(iChunk); });
+    else
+        fn(0);
+}
+
+// First item of chunk 'iChunk' when partitioning [0, itemCount[ into 'chunkCount' ranges
+int chunkFirstItem(int iChunk, int chunkCount, int itemCount)
+{
+    return int((int64_t(iChunk) * itemCount) / chunkCount);
+}
+
+template<typename FN>
+void runNormalChunks(int itemCount, FN fn)
+{
+    const int chunkCount = normalChunkCount(itemCount);
+    runChunks(chunkCount, [&](int iChunk) {
+        fn(chunkFirstItem(iChunk, chunkCount, itemCount), chunkFirstItem(iChunk + 1, chunkCount, itemCount));
+    });
+}
+
+// Stores into 'normals' the cross products of the edges of triangles [triFirst, triLast[
+// Cross products are computed in double precision, vertex coordinates of a block of triangles are
+// gathered first so the computation is a branchless loop
+void computeTriangleCrossProducts(
+        const Handle_Poly_Triangulation& triangulation,
+        int triFirst,
+        int triLast,
+        MeshUtils::NormalArray* normals)
+{
+    double x0[MassTriangleBlockSize], y0[MassTriangleBlockSize], z0[MassTriangleBlockSize];
+    double x1[MassTriangleBlockSize], y1[MassTriangleBlockSize], z1[MassTriangleBlockSize];
+    double x2[MassTriangleBlockSize], y2[MassTriangleBlockSize], z2[MassTriangleBlockSize];
+    float* nx = normals->x.data();
+    float* ny = normals->y.data();
+    float* nz = normals->z.data();
+    for (int blockFirst = triFirst; blockFirst < triLast; blockFirst += MassTriangleBlockSize) {
+        const int blockSize = std::min(MassTriangleBlockSize, triLast - blockFirst);
+        for (int i = 0; i < blockSize; ++i) {
+            int n1, n2, n3;
+            triangulation->Triangle(blockFirst + i + 1).Get(n1, n2, n3);
+            const gp_Pnt p1 = triangulation->Node(n1);
+            const gp_Pnt p2 = triangulation->Node(n2);
+            const gp_Pnt p3 = triangulation->Node(n3);
+            x0[i] = p1.X(); y0[i] = p1.Y(); z0[i] = p1.Z();
+            x1[i] = p2.X(); y1[i] = p2.Y(); z1[i] = p2.Z();
+            x2[i] = p3.X(); y2[i] = p3.Y(); z2[i] = p3.Z();
+        }
+
+        for (int i = 0; i < blockSize; ++i) {
+            const double a1 = x1[i] - x0[i], b1 = y1[i] - y0[i], c1 = z1[i] - z0[i];
+            const double a2 = x2[i] - x0[i], b2 = y2[i] - y0[i], c2 = z2[i] - z0[i];
+            nx[blockFirst + i] = float(b1 * c2 - b2 * c1);
+            ny[blockFirst + i] = float(a2 * c1 - a1 * c2);
+            nz[blockFirst + i] = float(a1 * b2 - a2 * b1);
+        }
+    }
+}
+
+// Scales vectors [first, last[ of 'normals' to unit length, null vectors are left untouched
+void normalizeVectors(MeshUtils::NormalArray* normals, int first, int last)
+{
+    float* nx = normals->x.data();
+    float* ny = normals->y.data();
+    float* nz = normals->z.data();
+    for (int i = first; i < last; ++i) {
+        // Squared length is computed in double precision so small vectors don't underflow
+        const double sqrLength = double(nx[i]) * nx[i] + double(ny[i]) * ny[i] + double(nz[i]) * nz[i];
+        const double invLength = sqrLength > 0. ? 1. / std::sqrt(sqrLength) : 0.;
+        nx[i] = float(nx[i] * invLength);
+        ny[i] = float(ny[i] * invLength);
+        nz[i] = float(nz[i] * invLength);
+    }
+}
+
+} // namespace
+
+MeshUtils::TriangulationNormals MeshUtils::triangulationNormals(const Handle_Poly_Triangulation& triangulation)
+{
+    TriangulationNormals normals;
     if (!triangulation)
-        return 0;
+        return normals;
+
+    const int nodeCount = triangulation->NbNodes();
+    const int triCount = triangulation->NbTriangles();
+    normals.triangles.resize(triCount);
+    normals.nodes.resize(nodeCount);
+    if (triCount <= 0)
+        return normals;
 
-    double volume = 0;
-    const TColgp_Array1OfPnt& vecNode = triangulation->Nodes();
-    // TODO Parallelize computation
-    for (const Poly_Triangle& tri : triangulation->Triangles()) {
-        int v1, v2, v3;
-        tri.Get(v1, v2, v3);
-        volume += MeshUtils::triangleSignedVolume(
-                    vecNode.Value(v1).Coord(),
-                    vecNode.Value(v2).Coord(),
-                    vecNode.Value(v3).Coord());
+    // Cross products of triangle edges, their length is twice the triangle area
+    runNormalChunks(triCount, [&](int first, int last) {
+        computeTriangleCrossProducts(triangulation, first, last, &normals.triangles);
+    });
+
+    // Node normals get the sum of the cross products of adjacent triangles, which is weighted by area
+    // Accumulation isn't split into chunks as triangles sharing a node may belong to different chunks
+    {
+        const float* tx = normals.triangles.x.data();
+        const float* ty = normals.triangles.y.data();
+        const float* tz = normals.triangles.z.data();
+        float* nx = normals.nodes.x.data();
+        float* ny = normals.nodes.y.data();
+        float* nz = normals.nodes.z.data();
+        for (int i = 0; i < triCount; ++i) {
+            int nodes[3];
+            triangulation->Triangle(i + 1).Get(nodes[0], nodes[1], nodes[2]);
+            for (int n : nodes) {
+                nx[n - 1] += tx[i];
+                ny[n - 1] += ty[i];
+                nz[n - 1] += tz[i];
+            }
+        }
     }
 
-    return std::abs(volume);
+    runNormalChunks(triCount, [&](int first, int last) { normalizeVectors(&normals.triangles, first, last); });
+    runNormalChunks(nodeCount, [&](int first, int last) { normalizeVectors(&normals.nodes, first, last); });
+    return normals;
 }
 
-double MeshUtils::triangulationArea(const Handle_Poly_Triangulation& triangulation)
+std::shared_ptr<const MeshUtils::TriangulationNormals> MeshUtils::cachedTriangulationNormals(
+        const Handle_Poly_Triangulation& triangulation)
 {
     if (!triangulation)
+        return {};
+
+    struct CacheEntry {
+        // Keeps the triangulation alive, so its address can't be reused by another object
+        Handle_Poly_Triangulation triangulation;
+        std::shared_ptr<const TriangulationNormals> normals;
+    };
+
+    static std::mutex mutex;
+    static std::unordered_map<const Poly_Triangulation*, CacheEntry> mapEntry;
+    // Node and triangle arrays might have been edited in place since normals were computed
+    auto fnMatches = [&](const TriangulationNormals& normals) {
+        return normals.nodes.count() == triangulation->NbNodes()
+                && normals.triangles.count() == triangulation->NbTriangles();
+    };
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = mapEntry.find(triangulation.get());
+        if (it != mapEntry.cend() && fnMatches(*it->second.normals))
+            return it->second.normals;
+    }
+
+    // Computation is done outside of the lock, other threads may query the cache meanwhile
+    auto normals = std::make_shared<const TriangulationNormals>(MeshUtils::triangulationNormals(triangulation));
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto it = mapEntry.begin(); it != mapEntry.end();) {
+        if (it->second.triangulation->GetRefCount() <= 1)
+            it = mapEntry.erase(it);
+        else
+            ++it;
+    }
+
+    mapEntry[triangulation.get()] = CacheEntry{ triangulation, normals };
+    return normals;
+}
+
+namespace {
+
+// Edge of a triangle, 'key' holds the indices of the two nodes(lowest one in the high bits) so the
+// edges shared by triangles have the same key whatever their orientation
+struct TriangleEdge {
+    uint64_t key;
+    int triangle; // 0-based
+
+    int node1() const { return int(this->key >> 32); }
+    int node2() const { return int(this->key & 0xFFFFFFFF); }
+    bool operator<(const TriangleEdge& other) const {
+        return this->key < other.key || (this->key == other.key && this->triangle < other.triangle);
+    }
+};
+
+// Calls fn(key) for each non-degenerate edge of triangle 'iTriangle'(0-based)
+template<typename FN>
+void foreachTriangleEdge(const Handle_Poly_Triangulation& triangulation, int iTriangle, FN fn)
+{
+    int n[3];
+    triangulation->Triangle(iTriangle + 1).Get(n[0], n[1], n[2]);
+    for (int i = 0; i < 3; ++i) {
+        const int na = n[i];
+        const int nb = n[(i + 1) % 3];
+        if (na != nb)
+            fn((uint64_t(std::min(na, nb)) << 32) | uint64_t(std::max(na, nb)));
+    }
+}
+
+} // namespace
+
+MeshUtils::TriangulationEdges MeshUtils::triangulationEdges(
+        const Handle_Poly_Triangulation& triangulation, double featureAngle)
+{
+    TriangulationEdges edges;
+    edges.featureAngle = featureAngle;
+    if (!triangulation || triangulation->NbTriangles() <= 0)
+        return edges;
+
+    const int nodeCount = triangulation->NbNodes();
+    const int triCount = triangulation->NbTriangles();
+    // Edges are partitioned into buckets of contiguous ranges of their first node, so buckets can be
+    // sorted and deduplicated concurrently and then simply concatenated
+    const int chunkCount = normalChunkCount(3 * triCount);
+    const int bucketCount = chunkCount;
+    auto fnBucket = [=](uint64_t key) {
+        const auto iBucket = int(((key >> 32) * uint64_t(bucketCount)) / (uint64_t(nodeCount) + 1));
+        return std::min(iBucket, bucketCount - 1);
+    };
+
+    // Count edges of each(triangle chunk, bucket) pair, then scatter the edges at their offsets
+    std::vector<int> vecCount(chunkCount * bucketCount, 0);
+    runChunks(chunkCount, [&](int iChunk) {
+        int* counts = vecCount.data() + iChunk * bucketCount;
+        const int triLast = chunkFirstItem(iChunk + 1, chunkCount, triCount);
+        for (int i = chunkFirstItem(iChunk, chunkCount, triCount); i < triLast; ++i)
+            foreachTriangleEdge(triangulation, i, [&](uint64_t key) { ++counts[fnBucket(key)]; });
+    });
+
+    std::vector<int> vecOffset(chunkCount * bucketCount, 0);
+    std::vector<int> vecBucketFirst(bucketCount + 1, 0);
+    int offset = 0;
+    for (int iBucket = 0; iBucket < bucketCount; ++iBucket) {
+        vecBucketFirst.at(iBucket) = offset;
+        for (int iChunk = 0; iChunk < chunkCount; ++iChunk) {
+            vecOffset.at(iChunk * bucketCount + iBucket) = offset;
+            offset += vecCount.at(iChunk * bucketCount + iBucket);
+        }
+    }
+
+    vecBucketFirst.back() = offset;
+    std::vector<TriangleEdge> vecEdge(offset);
+    runChunks(chunkCount, [&](int iChunk) {
+        int* offsets = vecOffset.data() + iChunk * bucketCount;
+        const int triLast = chunkFirstItem(iChunk + 1, chunkCount, triCount);
+        for (int i = chunkFirstItem(iChunk, chunkCount, triCount); i < triLast; ++i) {
+            foreachTriangleEdge(triangulation, i, [&](uint64_t key) {
+                vecEdge[offsets[fnBucket(key)]++] = { key, i };
+            });
+        }
+    });
+
+    // Triangle normals are needed to evaluate dihedral angles
+    std::shared_ptr<const TriangulationNormals> normals;
+    const bool isFeatureFilter = featureAngle > 0;
+    if (isFeatureFilter)
+        normals = MeshUtils::cachedTriangulationNormals(triangulation);
+
+    const double maxFlatCos = std::cos(featureAngle);
+    auto fnIsFeatureEdge = [&](const TriangleEdge* first, const TriangleEdge* last) {
+        if (last - first != 2)
+            return true; // Free or non-manifold edge
+
+        const MeshUtils::NormalArray& triNormals = normals->triangles;
+        const int t1 = first->triangle;
+        const int t2 = (first + 1)->triangle;
+        const double cosAngle =
+                double(triNormals.x[t1]) * triNormals.x[t2]
+                + double(triNormals.y[t1]) * triNormals.y[t2]
+                + double(triNormals.z[t1]) * triNormals.z[t2];
+        return cosAngle < maxFlatCos;
+    };
+
+    std::vector<std::vector<int>> vecBucketNodes(bucketCount);
+    runChunks(bucketCount, [&](int iBucket) {
+        TriangleEdge* bucketBegin = vecEdge.data() + vecBucketFirst.at(iBucket);
+        TriangleEdge* bucketEnd = vecEdge.data() + vecBucketFirst.at(iBucket + 1);
+        std::sort(bucketBegin, bucketEnd);
+        std::vector<int>& bucketNodes = vecBucketNodes.at(iBucket);
+        for (TriangleEdge* it = bucketBegin; it != bucketEnd; ) {
+            TriangleEdge* itGroupEnd = it + 1;
+            while (itGroupEnd != bucketEnd && itGroupEnd->key == it->key)
+                ++itGroupEnd;
+
+            if (!isFeatureFilter || fnIsFeatureEdge(it, itGroupEnd)) {
+                bucketNodes.push_back(it->node1());
+                bucketNodes.push_back(it->node2());
+            }
+
+            it = itGroupEnd;
+        }
+    });
+
+    size_t edgeNodeCount = 0;
+    for (const std::vector<int>& bucketNodes : vecBucketNodes)
+        edgeNodeCount += bucketNodes.size();
+
+    edges.nodes.reserve(edgeNodeCount);
+    for (const std::vector<int>& bucketNodes : vecBucketNodes)
+        edges.nodes.insert(edges.nodes.end(), bucketNodes.cbegin(), bucketNodes.cend());
+
+    return edges;
+}
+
+std::shared_ptr<const MeshUtils::TriangulationEdges> MeshUtils::cachedTriangulationEdges(
+        const Handle_Poly_Triangulation& triangulation, double featureAngle)
+{
+    if (!triangulation)
+        return {};
+
+    struct CacheEntry {
+        Handle_Poly_Triangulation triangulation;
+        std::shared_ptr<const TriangulationEdges> edges;
+        int nodeCount;
+        int triangleCount;
+    };
+
+    static std::mutex mutex;
+    static std::unordered_map<const Poly_Triangulation*, CacheEntry> mapEntry;
+    auto fnMatches = [&](const CacheEntry& entry) {
+        return entry.nodeCount == triangulation->NbNodes()
+                && entry.triangleCount == triangulation->NbTriangles()
+                && entry.edges->featureAngle == featureAngle;
+    };
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = mapEntry.find(triangulation.get());
+        if (it != mapEntry.cend() && fnMatches(it->second))
+            return it->second.edges;
+    }
+
+    auto edges = std::make_shared<const TriangulationEdges>(MeshUtils::triangulationEdges(triangulation, featureAngle));
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto it = mapEntry.begin(); it != mapEntry.end();) {
+        if (it->second.triangulation->GetRefCount() <= 1)
+            it = mapEntry.erase(it);
+        else
+            ++it;
+    }
+
+    mapEntry[triangulation.get()] = CacheEntry{
+        triangulation, edges, triangulation->NbNodes(), triangulation->NbTriangles() };
+    return edges;
+}
+
+uint64_t MeshUtils::compactTriangulation(const Handle_Poly_Triangulation& triangulation)
+{
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+    if (!triangulation || !triangulation->IsDoublePrecision() || triangulation->NbNodes() == 0)
         return 0;
 
-    double area = 0;
-    const TColgp_Array1OfPnt& vecNode = triangulation->Nodes();
-    // TODO Parallelize computation
-    for (const Poly_Triangle& tri : triangulation->Triangles()) {
-        int v1, v2, v3;
-        tri.Get(v1, v2, v3);
-        area += MeshUtils::triangleArea(
-                    vecNode.Value(v1).Coord(),
-                    vecNode.Value(v2).Coord(),
-                    vecNode.Value(v3).Coord());
+    if (!triangulation->HasCachedMinMax()) {
+        Bnd_Box bndBox;
+        for (int i = 1; i <= triangulation->NbNodes(); ++i)
+            bndBox.Add(triangulation->Node(i));
+
+        triangulation->SetCachedMinMax(bndBox);
     }
 
-    return area;
+    const uint64_t nodeCount = triangulation->NbNodes();
+    uint64_t savedBytes = nodeCount * (sizeof(gp_Pnt) - sizeof(gp_Vec3f));
+    if (triangulation->HasUVNodes())
+        savedBytes += nodeCount * (sizeof(gp_Pnt2d) - sizeof(gp_Vec2f));
+
+    triangulation->SetDoublePrecision(false);
+    return savedBytes;
+#else
+    Q_UNUSED(triangulation);
+    return 0;
+#endif
 }
 
+namespace {
+
 // Adapted from http://cs.smith.edu/~jorourke/Code/polyorient.C
-MeshUtils::Orientation MeshUtils::orientation(const AdaptorPolyline2d& polyline)
+// Function 'fnPointAt(i)' returns the point at index i in [0, pntCount[, it's a template parameter
+// so calls can be inlined when points come from an array
+template<typename FN>
+MeshUtils::Orientation polylineOrientation(int pntCount, FN fnPointAt)
 {
-    const int pntCount = polyline.pointCount();
+    using Orientation = MeshUtils::Orientation;
     if (pntCount < 2)
         return Orientation::Unknown;
 
-    gp_Pnt2d pntExtreme = polyline.pointAt(0);
+    gp_Pnt2d pntExtreme = fnPointAt(0);
     int indexPntExtreme = 0;
     for (int i = 1; i < pntCount; ++i) {
-        const gp_Pnt2d pnt = polyline.pointAt(i);
+        const gp_Pnt2d pnt = fnPointAt(i);
         if (pnt.Y() < pntExtreme.Y()
                 || (qFuzzyCompare(pnt.Y(), pntExtreme.Y()) && (pnt.X() > pntExtreme.X())))
         {
@@ -88,8 +645,8 @@ MeshUtils::Orientation MeshUtils::orientation(const AdaptorPolyline2d& polyline)
         }
     }
 
-    const gp_Pnt2d beforeExtremePnt = polyline.pointAt((indexPntExtreme + (pntCount - 1)) % pntCount);
-    const gp_Pnt2d afterExtremePnt = polyline.pointAt((indexPntExtreme + 1) % pntCount);
+    const gp_Pnt2d beforeExtremePnt = fnPointAt((indexPntExtreme + (pntCount - 1)) % pntCount);
+    const gp_Pnt2d afterExtremePnt = fnPointAt((indexPntExtreme + 1) % pntCount);
     const gp_Pnt2d& a = beforeExtremePnt;
     const gp_Pnt2d& b = pntExtreme;
     const gp_Pnt2d& c = afterExtremePnt;
@@ -112,35 +669,57 @@ MeshUtils::Orientation MeshUtils::orientation(const AdaptorPolyline2d& polyline)
         return orientation;
     }
     else {
-        double polylineArea = 0.;
-        for (int i = 0; i < pntCount; ++i) {
-            const gp_Pnt2d pntBefore = polyline.pointAt((i + (pntCount - 1)) % pntCount);
-            const gp_Pnt2d pntCurrent = polyline.pointAt(i);
-            const gp_Pnt2d pntAfter = polyline.pointAt((i + 1) % pntCount);
-            polylineArea += pntCurrent.X() * (pntAfter.Y() - pntBefore.Y());
-        }
+        // First and last points wrap around, the loop in between has no modulo so it can be
+        // vectorized
+        auto fnTerm = [&](int iBefore, int iCurrent, int iAfter) {
+            return fnPointAt(iCurrent).X() * (fnPointAt(iAfter).Y() - fnPointAt(iBefore).Y());
+        };
+        double polylineArea = fnTerm(pntCount - 1, 0, 1);
+        for (int i = 1; i < pntCount - 1; ++i)
+            polylineArea += fnTerm(i - 1, i, i + 1);
 
+        polylineArea += fnTerm(pntCount - 2, pntCount - 1, 0);
         return fnQualifyArea(polylineArea);
     }
 }
 
-gp_Vec MeshUtils::directionAt(const AdaptorPolyline3d& polyline, int i)
+template<typename FN>
+gp_Vec polylineDirectionAt(int pntCount, int i, FN fnPointAt)
 {
-    const int pntCount = polyline.pointCount();
     if (pntCount > 1) {
-        const gp_Pnt& pnt = polyline.pointAt(i);
         const int indexLastPos = pntCount - 1;
-        if (i < indexLastPos) {
-            const gp_Pnt& nextPnt = polyline.pointAt(i + 1);
-            return gp_Vec(pnt, nextPnt);
-        }
-        else if (i == indexLastPos) {
-            const gp_Pnt& prevPnt = polyline.pointAt(i - 1);
-            return gp_Vec(prevPnt, pnt);
-        }
+        if (i >= 0 && i < indexLastPos)
+            return gp_Vec(fnPointAt(i), fnPointAt(i + 1));
+        else if (i == indexLastPos)
+            return gp_Vec(fnPointAt(i - 1), fnPointAt(i));
     }
 
     return gp_Vec();
 }
 
+} // namespace
+
+MeshUtils::Orientation MeshUtils::orientation(const AdaptorPolyline2d& polyline)
+{
+    return polylineOrientation(polyline.pointCount(), [&](int i) { return polyline.pointAt(i); });
+}
+
+MeshUtils::Orientation MeshUtils::orientation(Span<const gp_Pnt2d> polyline)
+{
+    const gp_Pnt2d* pnts = polyline.data();
+    return polylineOrientation(int(polyline.size()), [=](int i) -> const gp_Pnt2d& { return pnts[i]; });
+}
+
+gp_Vec MeshUtils::directionAt(const AdaptorPolyline3d& polyline, int i)
+{
+    return polylineDirectionAt(
+                polyline.pointCount(), i, [&](int j) -> const gp_Pnt& { return polyline.pointAt(j); });
+}
+
+gp_Vec MeshUtils::directionAt(Span<const gp_Pnt> polyline, int i)
+{
+    const gp_Pnt* pnts = polyline.data();
+    return polylineDirectionAt(int(polyline.size()), i, [=](int j) -> const gp_Pnt& { return pnts[j]; });
+}
+
 } // namespace Mayo
@@ -6,7 +6,15 @@
 
 #pragma once
 
+#include "span.h"
+
 #include <Poly_Triangulation.hxx>
+#include <gp_Mat.hxx>
+#include <gp_Pnt.hxx>
+#include <gp_Pnt2d.hxx>
+#include <cstdint>
+#include <memory>
+#include <vector>
 class gp_XYZ;
 
 namespace Mayo {
@@ -18,6 +26,74 @@ struct MeshUtils {
     static double triangulationVolume(const Handle_Poly_Triangulation& triangulation);
     static double triangulationArea(const Handle_Poly_Triangulation& triangulation);
 
+    struct MassProperties {
+        double area = 0;
+        double volume = 0; // Meaningful only for closed triangulations
+        gp_Pnt centroid; // Center of volume, or center of area if volume is null
+        gp_Mat inertia; // Matrix of inertia at center of volume, for unit density
+    };
+    // Computes all mass properties in a single pass over the triangles
+    // Big triangulations are split into chunks processed concurrently, sums are compensated so the
+    // result doesn't depend much on the count of triangles
+    static MassProperties triangulationMassProperties(const Handle_Poly_Triangulation& triangulation);
+
+    // Array of 3D vectors stored as separate coordinate arrays("structure of arrays"), so loops
+    // over the vectors can be vectorized by the compiler
+    struct NormalArray {
+        std::vector<float> x;
+        std::vector<float> y;
+        std::vector<float> z;
+
+        int count() const { return int(this->x.size()); }
+        void resize(int count);
+    };
+
+    struct TriangulationNormals {
+        // Unit normals of the triangles, index i is triangle i+1. Null for degenerate triangles
+        NormalArray triangles;
+        // Unit normals at the nodes, index i is node i+1. Average of the normals of the adjacent
+        // triangles weighted by their area, null for nodes not used by any triangle
+        NormalArray nodes;
+    };
+    // Computes triangle and node normals from the node coordinates, normals possibly stored in the
+    // triangulation are ignored. Big triangulations are processed by chunks running concurrently
+    static TriangulationNormals triangulationNormals(const Handle_Poly_Triangulation& triangulation);
+
+    // Same as triangulationNormals() but the result is cached per triangulation object, so
+    // graphics and exporters compute the normals of an entity only once
+    // Cache entries are dropped once their triangulation isn't referenced anymore outside of the
+    // cache. Function is thread-safe
+    static std::shared_ptr<const TriangulationNormals> cachedTriangulationNormals(
+            const Handle_Poly_Triangulation& triangulation);
+
+    struct TriangulationEdges {
+        // Node indices(1-based, as in Poly_Triangulation) of the edges, two consecutive indices
+        // per edge
+        std::vector<int> nodes;
+        // Feature angle the edges were computed with, see triangulationEdges()
+        double featureAngle = 0;
+
+        int count() const { return int(this->nodes.size() / 2); }
+    };
+    // Computes the edges of the triangles, an edge shared by several triangles appears once
+    // If 'featureAngle'(radians) is not null, only feature edges are kept: edges where the angle
+    // between the normals of the two adjacent triangles exceeds 'featureAngle', free(boundary) and
+    // non-manifold edges. Big triangulations are processed by chunks running concurrently
+    static TriangulationEdges triangulationEdges(
+            const Handle_Poly_Triangulation& triangulation, double featureAngle = 0);
+
+    // Same as triangulationEdges() but the result is cached per triangulation object, see also
+    // cachedTriangulationNormals(). Function is thread-safe
+    static std::shared_ptr<const TriangulationEdges> cachedTriangulationEdges(
+            const Handle_Poly_Triangulation& triangulation, double featureAngle = 0);
+
+    // Switches the storage of 'triangulation' nodes(and UV nodes) to single precision floats,
+    // halving their memory. Bounding box is computed from the double precision nodes and cached in
+    // the triangulation(see Poly_Triangulation::CachedMinMax()), so bounds stay exact
+    // Node accessors convert back to double on the fly, readers and exporters are not affected
+    // Returns the count of bytes saved. Requires OpenCascade >= v7.6.0, does nothing otherwise
+    static uint64_t compactTriangulation(const Handle_Poly_Triangulation& triangulation);
+
     enum class Orientation {
         Unknown,
         Clockwise,
@@ -40,6 +116,11 @@ struct MeshUtils {
 
     static Orientation orientation(const AdaptorPolyline2d& polyline);
     static gp_Vec directionAt(const AdaptorPolyline3d& polyline, int i);
+
+    // Overloads for polylines stored in contiguous arrays, points are accessed directly instead of
+    // virtual calls to pointAt(). Results are the same as with the adaptor functions
+    static Orientation orientation(Span<const gp_Pnt2d> polyline);
+    static gp_Vec directionAt(Span<const gp_Pnt> polyline, int i);
 };
 
 } // namespace Mayo
@@ -6,6 +6,9 @@
 
 #include "messenger.h"
 
+#include <algorithm>
+#include <iterator>
+
 namespace Mayo {
 
 void Messenger::emitTrace(const QString& text)
@@ -39,6 +42,57 @@ void MessengerByCallback::emitMessage(Messenger::MessageType msgType, const QStr
         m_fnCallback(msgType, text);
 }
 
+bool MessageBatchQueue::Batch::isEmpty() const
+{
+    if (!this->items.empty())
+        return false;
+
+    for (int count : this->discardedCount) {
+        if (count > 0)
+            return false;
+    }
+
+    return true;
+}
+
+MessageBatchQueue::MessageBatchQueue(int maxCountPerType)
+    : m_maxCountPerType(maxCountPerType)
+{
+}
+
+bool MessageBatchQueue::push(Messenger::MessageType msgType, const QString& text)
+{
+    const int iType = int(msgType);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const bool wasEmpty = m_batch.isEmpty();
+    // Batch holds a few messages per type, linear search is fine
+    for (Item& item : m_batch.items) {
+        if (item.message.type == msgType && item.message.text == text) {
+            ++item.repeatCount;
+            return wasEmpty;
+        }
+    }
+
+    if (m_itemCount[iType] < m_maxCountPerType) {
+        m_batch.items.push_back({ { msgType, text }, 1 });
+        ++m_itemCount[iType];
+    }
+    else {
+        ++m_batch.discardedCount[iType];
+    }
+
+    return wasEmpty;
+}
+
+MessageBatchQueue::Batch MessageBatchQueue::takeBatch()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Batch batch = std::move(m_batch);
+    m_batch = {};
+    std::fill(std::begin(m_itemCount), std::end(m_itemCount), 0);
+    return batch;
+}
+
 void NullMessenger::emitMessage(Messenger::MessageType /*msgType*/, const QString& /*text*/)
 {
 }
@@ -8,6 +8,8 @@
 
 #include <QtCore/QString>
 #include <functional>
+#include <mutex>
+#include <vector>
 
 namespace Mayo {
 
@@ -43,6 +45,39 @@ private:
     std::function<void(MessageType, QString)> m_fnCallback;
 };
 
+// Queue of messages emitted from any thread, to be delivered later by batches(eg to the GUI at a
+// bounded frequency)
+// Messages of the same type and text waiting for delivery are merged and counted. Beyond
+// 'maxCountPerType' distinct messages of a type in a batch, further messages are only counted
+// All functions are thread-safe
+class MessageBatchQueue {
+public:
+    struct Item {
+        Messenger::Message message;
+        int repeatCount = 1;
+    };
+
+    struct Batch {
+        std::vector<Item> items; // In emission order
+        int discardedCount[4] = {}; // Indexed by MessageType
+        bool isEmpty() const;
+    };
+
+    MessageBatchQueue(int maxCountPerType = 20);
+
+    // Returns true if the current batch was empty, ie its delivery has to be scheduled
+    bool push(Messenger::MessageType msgType, const QString& text);
+
+    // Returns the current batch and starts a new one
+    Batch takeBatch();
+
+private:
+    std::mutex m_mutex;
+    Batch m_batch;
+    int m_itemCount[4] = {};
+    const int m_maxCountPerType;
+};
+
 class NullMessenger : public Messenger {
 public:
     static Messenger* instance();
@@ -0,0 +1,132 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "model_cache.h"
+#include "application.h"
+#include "task_progress.h"
+
+#include <Standard_Version.hxx>
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QUuid>
+#include <vector>
+
+namespace Mayo {
+
+namespace {
+
+// To be incremented when the contents of an imported document change for the same parameters
+constexpr quint32 ModelCache_version = 1;
+constexpr qint64 ModelCache_readChunkSize = 1024 * 1024;
+
+} // namespace
+
+ModelCache::ModelCache(const FilePath& dirPath)
+    : m_dirPath(dirPath)
+{
+}
+
+QByteArray ModelCache::key(const FilePath& fp, const QByteArray& paramsFingerprint, TaskProgress* progress)
+{
+    QFile file(filepathTo<QString>(fp));
+    if (!file.open(QIODevice::ReadOnly))
+        return {};
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    std::vector<char> chunk(size_t(ModelCache_readChunkSize));
+    const qint64 fileSize = file.size();
+    qint64 readTotalSize = 0;
+    while (!file.atEnd()) {
+        const qint64 readSize = file.read(chunk.data(), ModelCache_readChunkSize);
+        if (readSize < 0)
+            return {};
+
+        hash.addData(chunk.data(), int(readSize));
+        readTotalSize += readSize;
+        if (progress) {
+            progress->setValue(fileSize > 0 ? int(100 * readTotalSize / fileSize) : 100);
+            if (progress->isAbortRequested())
+                return {};
+        }
+    }
+
+    // Documents are stored in OpenCascade binary format, which depends on its version
+    const QByteArray bytesVersion =
+            QByteArray::number(ModelCache_version) + '/' + QByteArray::number(OCC_VERSION_HEX) + '/';
+    hash.addData(bytesVersion);
+    hash.addData(paramsFingerprint);
+    return hash.result().toHex();
+}
+
+bool ModelCache::contains(const QByteArray& key) const
+{
+    return !this->isNull() && !key.isEmpty() && filepathExists(this->entryFilePath(key));
+}
+
+DocumentPtr ModelCache::open(const ApplicationPtr& app, const QByteArray& key, TaskProgress* progress) const
+{
+    if (!this->contains(key))
+        return {};
+
+    PCDM_ReaderStatus readStatus = PCDM_RS_OK;
+    DocumentPtr doc = app->openDocument(this->entryFilePath(key), &readStatus, progress);
+    if (readStatus != PCDM_RS_OK) {
+        if (doc)
+            app->closeDocument(doc);
+
+        return {};
+    }
+
+    return doc;
+}
+
+bool ModelCache::save(const ApplicationPtr& app, const DocumentPtr& doc, const QByteArray& key, TaskProgress* progress) const
+{
+    if (this->isNull() || key.isEmpty() || doc.IsNull())
+        return false;
+
+    const FilePath entryFilePath = this->entryFilePath(key);
+    if (filepathExists(entryFilePath))
+        return true;
+
+    if (!QDir().mkpath(filepathTo<QString>(m_dirPath)))
+        return false;
+
+    // Temporary file is created in the cache directory(same file system), so renaming is atomic
+    // Its name is unique among all the processes sharing the cache directory
+    const QByteArray tempSuffix = "." + QUuid::createUuid().toRfc4122().toHex() + ".tmp";
+    const FilePath tempFilePath = m_dirPath / (key.toStdString() + tempSuffix.toStdString());
+    const QString strTempFilePath = filepathTo<QString>(tempFilePath);
+    if (app->saveDocumentAs(doc, tempFilePath, progress) != PCDM_SS_OK) {
+        QFile::remove(strTempFilePath);
+        return false;
+    }
+
+    // Rename fails if entry was completed meanwhile by a concurrent writer: both are equivalent
+    if (!QFile::rename(strTempFilePath, filepathTo<QString>(entryFilePath)))
+        QFile::remove(strTempFilePath);
+
+    return filepathExists(entryFilePath);
+}
+
+void ModelCache::clear()
+{
+    if (this->isNull())
+        return;
+
+    // Temporary files are left untouched, they might be written by concurrent processes
+    QDir dir(filepathTo<QString>(m_dirPath));
+    for (const QString& fileName : dir.entryList({ "*.myb" }, QDir::Files))
+        dir.remove(fileName);
+}
+
+FilePath ModelCache::entryFilePath(const QByteArray& key) const
+{
+    return m_dirPath / (key.toStdString() + ".myb");
+}
+
+} // namespace Mayo
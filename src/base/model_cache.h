@@ -0,0 +1,59 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "application_ptr.h"
+#include "document_ptr.h"
+#include "filepath.h"
+
+#include <QtCore/QByteArray>
+
+namespace Mayo {
+
+class TaskProgress;
+
+// Persistent on-disk cache of imported models, each entry being a binary Mayo document(.myb)
+// Key of an entry is computed from the contents of the source file and a fingerprint of the
+// parameters affecting import(reader options, meshing, ...), but not from the location of the
+// file. So cache directory can be shared by several users or machines(ex: network folder), the
+// first one opening a model pays the translation and meshing cost
+// Writers are safe to run concurrently, even from different processes: an entry is written into a
+// temporary file which is then renamed, the first completed entry being kept
+class ModelCache {
+public:
+    ModelCache() = default;
+    ModelCache(const FilePath& dirPath);
+
+    const FilePath& dirPath() const { return m_dirPath; }
+    void setDirPath(const FilePath& dirPath) { m_dirPath = dirPath; }
+
+    bool isNull() const { return m_dirPath.empty(); }
+
+    // Returns the key identifying the model imported from file 'fp' with parameters 'paramsFingerprint'
+    // Contents of 'fp' are read entirely. Returns empty key if file can't be read or on abort
+    static QByteArray key(const FilePath& fp, const QByteArray& paramsFingerprint, TaskProgress* progress = nullptr);
+
+    bool contains(const QByteArray& key) const;
+
+    // Opens entry 'key' as a new document of 'app'
+    // Returns null document if there is no such entry or if entry can't be read
+    DocumentPtr open(const ApplicationPtr& app, const QByteArray& key, TaskProgress* progress = nullptr) const;
+
+    // Stores 'doc' into entry 'key', existing entry is kept untouched
+    // Returns true if entry exists on return(written by this call or by a concurrent writer)
+    bool save(const ApplicationPtr& app, const DocumentPtr& doc, const QByteArray& key, TaskProgress* progress = nullptr) const;
+
+    // Deletes all the entries in cache directory
+    void clear();
+
+private:
+    FilePath entryFilePath(const QByteArray& key) const;
+
+    FilePath m_dirPath;
+};
+
+} // namespace Mayo
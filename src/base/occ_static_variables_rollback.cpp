@@ -14,6 +14,23 @@ namespace Mayo {
 namespace IO {
 
 struct OccStaticVariablesRollback::Private {
+    // Is 'record' valid and holding 'value'?
+    template<typename T>
+    static bool hasValue(const StaticVariableRecord& record, T value)
+    {
+        if (!record.isValid())
+            return false;
+
+        if constexpr(std::is_same<std::string_view, T>::value) {
+            auto ptrStr = std::get_if<std::string>(&record.value);
+            return ptrStr && *ptrStr == value;
+        }
+        else {
+            auto ptrValue = std::get_if<T>(&record.value);
+            return ptrValue && *ptrValue == value;
+        }
+    }
+
     template<typename T>
     static StaticVariableRecord createStaticVariableRecord(const char* strKey)
     {
@@ -69,6 +86,9 @@ bool OccStaticVariablesRollback::StaticVariableRecord::isValid() const
 void OccStaticVariablesRollback::change(const char* strKey, int newValue)
 {
     const auto record = Private::createStaticVariableRecord<int>(strKey);
+    if (Private::hasValue(record, newValue))
+        return; // Nothing to change nor to roll back
+
     Private::changeStaticVariable(strKey, newValue);
     if (record.isValid())
         m_vecRecord.push_back(std::move(record));
@@ -77,6 +97,9 @@ void OccStaticVariablesRollback::change(const char* strKey, int newValue)
 void OccStaticVariablesRollback::change(const char* strKey, double newValue)
 {
     const auto record = Private::createStaticVariableRecord<double>(strKey);
+    if (Private::hasValue(record, newValue))
+        return; // Nothing to change nor to roll back
+
     Private::changeStaticVariable(strKey, newValue);
     if (record.isValid())
         m_vecRecord.push_back(std::move(record));
@@ -85,6 +108,9 @@ void OccStaticVariablesRollback::change(const char* strKey, double newValue)
 void OccStaticVariablesRollback::change(const char* strKey, std::string_view newValue)
 {
     const auto record = Private::createStaticVariableRecord<std::string_view>(strKey);
+    if (Private::hasValue(record, newValue))
+        return; // Nothing to change nor to roll back
+
     Private::changeStaticVariable(strKey, newValue);
     if (record.isValid())
         m_vecRecord.push_back(std::move(record));
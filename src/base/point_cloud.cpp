@@ -0,0 +1,206 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "point_cloud.h"
+#include "task_progress.h"
+
+#include <Standard_GUID.hxx>
+#include <QtCore/QDir>
+#include <QtCore/QTemporaryFile>
+#include <algorithm>
+#include <cfloat>
+#include <random>
+
+namespace Mayo {
+
+bool PointCloud::Node::isLeaf() const
+{
+    return std::all_of(std::cbegin(this->children), std::cend(this->children), [](int32_t child) {
+        return child < 0;
+    });
+}
+
+PointCloudPtr PointCloud::build(
+        std::vector<Point>&& vecPoint, const BuildParameters& params, TaskProgress* progress)
+{
+    PointCloudPtr cloud = new PointCloud;
+    cloud->m_pointCount = vecPoint.size();
+
+    // Octree nodes are cubes
+    Point minCorner(FLT_MAX, FLT_MAX, FLT_MAX);
+    Point maxCorner(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+    for (const Point& pnt : vecPoint) {
+        minCorner = minCorner.cwiseMin(pnt);
+        maxCorner = maxCorner.cwiseMax(pnt);
+    }
+
+    if (!vecPoint.empty()) {
+        cloud->m_bndBox.Update(minCorner.x(), minCorner.y(), minCorner.z(),
+                               maxCorner.x(), maxCorner.y(), maxCorner.z());
+    }
+    else {
+        minCorner = maxCorner = Point(0.f, 0.f, 0.f);
+    }
+
+    const Point bndBoxSize = maxCorner - minCorner;
+    const float octreeSize = std::max({ bndBoxSize.x(), bndBoxSize.y(), bndBoxSize.z() });
+    Node rootNode;
+    rootNode.minCorner = minCorner;
+    rootNode.maxCorner = minCorner + Point(octreeSize, octreeSize, octreeSize);
+    rootNode.pointCount = vecPoint.size();
+    cloud->m_vecNode.push_back(rootNode);
+
+    // Subdivide nodes depth-first, points of a node are partitioned in place into its octants
+    // Octant index is (x >= center.x) | (y >= center.y) << 1 | (z >= center.z) << 2
+    std::minstd_rand randomEngine;
+    uint64_t leafPointCount = 0;
+    std::vector<int32_t> vecNodeToProcess = { 0 };
+    while (!vecNodeToProcess.empty()) {
+        const int32_t iNode = vecNodeToProcess.back();
+        vecNodeToProcess.pop_back();
+        const Node node = cloud->m_vecNode.at(iNode); // Copy as vector may be reallocated
+        auto itPointBegin = vecPoint.begin() + node.firstPoint;
+        auto itPointEnd = itPointBegin + node.pointCount;
+        if (node.pointCount <= params.maxLeafPointCount || node.depth >= params.maxDepth) {
+            // Shuffle so picking points with a stride doesn't produce regular patterns(ex: scan lines)
+            std::shuffle(itPointBegin, itPointEnd, randomEngine);
+            leafPointCount += node.pointCount;
+            if (progress)
+                progress->setValue(int(100 * leafPointCount / std::max<uint64_t>(1, vecPoint.size())));
+
+            if (TaskProgress::isAbortRequested(progress))
+                return {};
+
+            continue;
+        }
+
+        const Point center = (node.minCorner + node.maxCorner) * 0.5f;
+        std::vector<Point>::iterator itOctantBounds[9];
+        itOctantBounds[0] = itPointBegin;
+        itOctantBounds[8] = itPointEnd;
+        itOctantBounds[4] = std::partition(itOctantBounds[0], itOctantBounds[8], [=](const Point& pnt) {
+            return pnt.z() < center.z();
+        });
+        for (int i : { 0, 4 }) {
+            itOctantBounds[i + 2] = std::partition(itOctantBounds[i], itOctantBounds[i + 4], [=](const Point& pnt) {
+                return pnt.y() < center.y();
+            });
+        }
+
+        for (int i : { 0, 2, 4, 6 }) {
+            itOctantBounds[i + 1] = std::partition(itOctantBounds[i], itOctantBounds[i + 2], [=](const Point& pnt) {
+                return pnt.x() < center.x();
+            });
+        }
+
+        for (int octant = 0; octant < 8; ++octant) {
+            const auto childPointCount = itOctantBounds[octant + 1] - itOctantBounds[octant];
+            if (childPointCount == 0)
+                continue;
+
+            Node child;
+            child.minCorner = node.minCorner;
+            child.maxCorner = center;
+            for (int axis = 0; axis < 3; ++axis) {
+                if (octant & (1 << axis)) {
+                    child.minCorner[axis] = center[axis];
+                    child.maxCorner[axis] = node.maxCorner[axis];
+                }
+            }
+
+            child.firstPoint = uint64_t(itOctantBounds[octant] - vecPoint.begin());
+            child.pointCount = uint64_t(childPointCount);
+            child.depth = node.depth + 1;
+            const auto iChild = int32_t(cloud->m_vecNode.size());
+            cloud->m_vecNode.at(iNode).children[octant] = iChild;
+            cloud->m_vecNode.push_back(child);
+            vecNodeToProcess.push_back(iChild);
+        }
+    }
+
+    if (params.useOutOfCoreStorage && !vecPoint.empty()) {
+        auto file = std::make_unique<QTemporaryFile>(QDir::temp().filePath("mayo_pointcloud_XXXXXX.bin"));
+        const auto byteCount = qint64(vecPoint.size() * sizeof(Point));
+        if (file->open()
+                && file->write(reinterpret_cast<const char*>(vecPoint.data()), byteCount) == byteCount
+                && file->flush())
+        {
+            const uchar* ptrFileData = file->map(0, byteCount);
+            if (ptrFileData) {
+                cloud->m_ptrPoints = reinterpret_cast<const Point*>(ptrFileData);
+                cloud->m_storageFile = std::move(file);
+                std::vector<Point>().swap(vecPoint);
+            }
+        }
+    }
+
+    if (!cloud->m_storageFile) {
+        cloud->m_vecPoint = std::move(vecPoint);
+        cloud->m_ptrPoints = cloud->m_vecPoint.data();
+    }
+
+    return cloud;
+}
+
+PointCloud::~PointCloud()
+{
+}
+
+Span<const PointCloud::Point> PointCloud::points() const
+{
+    return Span<const Point>(m_ptrPoints, m_pointCount);
+}
+
+Span<const PointCloud::Point> PointCloud::nodePoints(const Node& node) const
+{
+    return Span<const Point>(m_ptrPoints + node.firstPoint, node.pointCount);
+}
+
+const Standard_GUID& PointCloudAttribute::GetID()
+{
+    static const Standard_GUID guid("2b7a7f3e-5c41-4d1a-9e0b-7f4c2d6a9b13");
+    return guid;
+}
+
+Handle_PointCloudAttribute PointCloudAttribute::Set(const TDF_Label& label, const PointCloudPtr& pointCloud)
+{
+    Handle_PointCloudAttribute attr;
+    if (!label.FindAttribute(PointCloudAttribute::GetID(), attr)) {
+        attr = new PointCloudAttribute;
+        label.AddAttribute(attr);
+    }
+
+    attr->set(pointCloud);
+    return attr;
+}
+
+void PointCloudAttribute::set(const PointCloudPtr& pointCloud)
+{
+    this->Backup();
+    m_pointCloud = pointCloud;
+}
+
+const Standard_GUID& PointCloudAttribute::ID() const
+{
+    return PointCloudAttribute::GetID();
+}
+
+void PointCloudAttribute::Restore(const Handle_TDF_Attribute& with)
+{
+    m_pointCloud = Handle_PointCloudAttribute::DownCast(with)->m_pointCloud;
+}
+
+Handle_TDF_Attribute PointCloudAttribute::NewEmpty() const
+{
+    return new PointCloudAttribute;
+}
+
+void PointCloudAttribute::Paste(const Handle_TDF_Attribute& into, const Handle_TDF_RelocationTable&) const
+{
+    Handle_PointCloudAttribute::DownCast(into)->m_pointCloud = m_pointCloud;
+}
+
+} // namespace Mayo
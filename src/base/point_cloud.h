@@ -0,0 +1,113 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "span.h"
+
+#include <Bnd_Box.hxx>
+#include <NCollection_Vec3.hxx>
+#include <Standard_Transient.hxx>
+#include <TDF_Attribute.hxx>
+#include <TDF_Label.hxx>
+#include <TDF_RelocationTable.hxx>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class QFile;
+
+namespace Mayo {
+
+class TaskProgress;
+
+class PointCloud;
+DEFINE_STANDARD_HANDLE(PointCloud, Standard_Transient)
+using PointCloudPtr = opencascade::handle<PointCloud>;
+
+// Point cloud whose points are spatially sorted by an octree
+// Points of an octree node are contiguous in storage, including the points of its descendant nodes.
+// So a coarse level of detail of any node is obtained by picking its points with a stride
+// Once the octree is built, points are moved to a temporary file which is memory-mapped: only the
+// points actually accessed(ex: by the renderer) are paged in memory
+class PointCloud : public Standard_Transient {
+public:
+    using Point = NCollection_Vec3<float>;
+
+    struct Node {
+        Point minCorner;
+        Point maxCorner;
+        uint64_t firstPoint = 0; // Index of first point in PointCloud::points()
+        uint64_t pointCount = 0; // Count of points in the node and its descendants
+        int32_t children[8] = { -1, -1, -1, -1, -1, -1, -1, -1 }; // Indexes in PointCloud::nodes()
+        int depth = 0;
+
+        bool isLeaf() const;
+    };
+
+    struct BuildParameters {
+        unsigned maxLeafPointCount = 32768;
+        int maxDepth = 20;
+        bool useOutOfCoreStorage = true; // Fallback on memory storage if the temporary file fails
+    };
+
+    // Builds the octree of 'vecPoint', which is consumed
+    static PointCloudPtr build(
+            std::vector<Point>&& vecPoint, const BuildParameters& params, TaskProgress* progress = nullptr);
+
+    ~PointCloud();
+
+    uint64_t pointCount() const { return m_pointCount; }
+    Span<const Point> points() const;
+    Span<const Point> nodePoints(const Node& node) const;
+
+    // Root node is at index 0, octree has always a root node(possibly empty)
+    Span<const Node> nodes() const { return m_vecNode; }
+    const Node& rootNode() const { return m_vecNode.front(); }
+
+    // Bounding box of the points, whereas nodes are cubes
+    const Bnd_Box& boundingBox() const { return m_bndBox; }
+
+    bool isOutOfCoreStorage() const { return m_storageFile != nullptr; }
+
+    DEFINE_STANDARD_RTTI_INLINE(PointCloud, Standard_Transient)
+
+private:
+    PointCloud() = default;
+
+    std::vector<Node> m_vecNode;
+    Bnd_Box m_bndBox;
+    uint64_t m_pointCount = 0;
+    const Point* m_ptrPoints = nullptr;
+    std::vector<Point> m_vecPoint; // In-memory storage, empty when out-of-core
+    std::unique_ptr<QFile> m_storageFile;
+};
+
+class PointCloudAttribute;
+DEFINE_STANDARD_HANDLE(PointCloudAttribute, TDF_Attribute)
+
+// OCAF attribute holding point cloud data, point cloud entities are document labels having it
+// Point cloud object is immutable once built, so copies of the attribute share the same object
+class PointCloudAttribute : public TDF_Attribute {
+public:
+    static const Standard_GUID& GetID();
+    static Handle_PointCloudAttribute Set(const TDF_Label& label, const PointCloudPtr& pointCloud);
+
+    const PointCloudPtr& get() const { return m_pointCloud; }
+    void set(const PointCloudPtr& pointCloud);
+
+    const Standard_GUID& ID() const override;
+    void Restore(const Handle_TDF_Attribute& with) override;
+    Handle_TDF_Attribute NewEmpty() const override;
+    void Paste(const Handle_TDF_Attribute& into, const Handle_TDF_RelocationTable& table) const override;
+
+    DEFINE_STANDARD_RTTI_INLINE(PointCloudAttribute, TDF_Attribute)
+
+private:
+    PointCloudPtr m_pointCloud;
+};
+
+} // namespace Mayo
@@ -0,0 +1,148 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "profiler.h"
+
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Mayo {
+
+#if defined(MAYO_WITH_PROFILER)
+
+namespace {
+
+struct ProfilerEvent {
+    const char* name;
+    int64_t startUsec;
+    int64_t durationUsec;
+};
+
+// Events of a single thread, the mutex is contended only when trace is written
+struct ProfilerThreadBuffer {
+    int threadIndex = 0;
+    std::mutex mutex;
+    std::vector<ProfilerEvent> vecEvent;
+};
+
+struct ProfilerRegistry {
+    const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    std::mutex mutex;
+    // Buffers are owned by the registry so events survive the end of their thread
+    std::vector<std::unique_ptr<ProfilerThreadBuffer>> vecThreadBuffer;
+};
+
+ProfilerRegistry& profilerRegistry()
+{
+    static ProfilerRegistry registry;
+    return registry;
+}
+
+ProfilerThreadBuffer* profilerThreadBuffer()
+{
+    thread_local ProfilerThreadBuffer* threadBuffer = nullptr;
+    if (!threadBuffer) {
+        ProfilerRegistry& registry = profilerRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        auto ptrBuffer = std::make_unique<ProfilerThreadBuffer>();
+        ptrBuffer->threadIndex = int(registry.vecThreadBuffer.size()) + 1;
+        threadBuffer = ptrBuffer.get();
+        registry.vecThreadBuffer.push_back(std::move(ptrBuffer));
+    }
+
+    return threadBuffer;
+}
+
+void writeJsonString(std::ostream& outs, const char* str)
+{
+    outs << '"';
+    for (const char* it = str; *it != '\0'; ++it) {
+        if (*it == '"' || *it == '\\')
+            outs << '\\';
+
+        outs << *it;
+    }
+
+    outs << '"';
+}
+
+} // namespace
+
+bool Profiler::isEnabled()
+{
+    return true;
+}
+
+void Profiler::recordZone(const char* name, int64_t startUsec, int64_t durationUsec)
+{
+    ProfilerThreadBuffer* threadBuffer = profilerThreadBuffer();
+    std::lock_guard<std::mutex> lock(threadBuffer->mutex);
+    threadBuffer->vecEvent.push_back({ name, startUsec, durationUsec });
+}
+
+int64_t Profiler::elapsedUsec()
+{
+    const auto elapsed = std::chrono::steady_clock::now() - profilerRegistry().startTime;
+    return std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+}
+
+bool Profiler::writeChromeTrace(const FilePath& filepath)
+{
+    std::ofstream outs(filepath, std::ios::out | std::ios::trunc);
+    if (!outs.is_open())
+        return false;
+
+    ProfilerRegistry& registry = profilerRegistry();
+    std::lock_guard<std::mutex> lockRegistry(registry.mutex);
+    bool isFirstEvent = true;
+    outs << "{\"traceEvents\":[\n";
+    for (const std::unique_ptr<ProfilerThreadBuffer>& threadBuffer : registry.vecThreadBuffer) {
+        std::lock_guard<std::mutex> lockBuffer(threadBuffer->mutex);
+        for (const ProfilerEvent& event : threadBuffer->vecEvent) {
+            if (!isFirstEvent)
+                outs << ",\n";
+
+            outs << "{\"name\":";
+            writeJsonString(outs, event.name);
+            outs << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << threadBuffer->threadIndex
+                 << ",\"ts\":" << event.startUsec
+                 << ",\"dur\":" << event.durationUsec << "}";
+            isFirstEvent = false;
+        }
+    }
+
+    outs << "\n]}\n";
+    outs.close();
+    return outs.good();
+}
+
+#else
+
+bool Profiler::isEnabled()
+{
+    return false;
+}
+
+void Profiler::recordZone(const char*, int64_t, int64_t)
+{
+}
+
+int64_t Profiler::elapsedUsec()
+{
+    return 0;
+}
+
+bool Profiler::writeChromeTrace(const FilePath&)
+{
+    return false;
+}
+
+#endif
+
+} // namespace Mayo
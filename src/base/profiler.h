@@ -0,0 +1,69 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "filepath.h"
+
+#include <cstdint>
+
+// Scoped zones instrumenting hot paths, MAYO_PROFILE_ZONE("name") measures the enclosing scope
+// Zone names must be string literals(only pointers are stored)
+//
+// Instrumentation is compiled out by default, it's enabled with one of the defines:
+//     MAYO_WITH_PROFILER : zones are recorded in memory and can be written as Chrome trace JSON with
+//                          Profiler::writeChromeTrace(), file then viewable with chrome://tracing
+//                          or https://ui.perfetto.dev
+//     MAYO_WITH_TRACY    : zones are forwarded to the Tracy client(TRACY_ENABLE must be defined too)
+
+#define MAYO_PROFILE_CONCAT_IMPL(a, b) a##b
+#define MAYO_PROFILE_CONCAT(a, b) MAYO_PROFILE_CONCAT_IMPL(a, b)
+
+#if defined(MAYO_WITH_TRACY)
+#  include <tracy/Tracy.hpp>
+#  define MAYO_PROFILE_ZONE(name) ZoneScopedN(name)
+#elif defined(MAYO_WITH_PROFILER)
+#  define MAYO_PROFILE_ZONE(name) \
+       const Mayo::ProfilerZone MAYO_PROFILE_CONCAT(mayoProfilerZone_, __LINE__)(name)
+#else
+#  define MAYO_PROFILE_ZONE(name) (void)0
+#endif
+
+namespace Mayo {
+
+class Profiler {
+public:
+    // Whether zones are recorded, always false if instrumentation is compiled out
+    static bool isEnabled();
+
+    // Records a completed zone for the current thread, times are microseconds since Profiler start
+    static void recordZone(const char* name, int64_t startUsec, int64_t durationUsec);
+    static int64_t elapsedUsec();
+
+    // Writes all the zones recorded so far in Chrome trace event format
+    // Returns false if instrumentation is compiled out or file can't be written
+    static bool writeChromeTrace(const FilePath& filepath);
+};
+
+class ProfilerZone {
+public:
+    ProfilerZone(const char* name)
+        : m_name(name), m_startUsec(Profiler::elapsedUsec())
+    {}
+
+    ~ProfilerZone() {
+        Profiler::recordZone(m_name, m_startUsec, Profiler::elapsedUsec() - m_startUsec);
+    }
+
+    ProfilerZone(const ProfilerZone&) = delete;
+    ProfilerZone& operator=(const ProfilerZone&) = delete;
+
+private:
+    const char* m_name = nullptr;
+    int64_t m_startUsec = 0;
+};
+
+} // namespace Mayo
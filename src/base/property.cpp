@@ -161,4 +161,10 @@ void PropertyGroupSignals::onPropertyChanged(Property* prop)
     emit propertyChanged(prop);
 }
 
+void PropertyGroupSignals::onPropertyEnabled(Property* prop, bool on)
+{
+    PropertyGroup::onPropertyEnabled(prop, on);
+    emit propertyEnabled(prop, on);
+}
+
 } // namespace Mayo
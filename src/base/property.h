@@ -129,10 +129,12 @@ public:
 signals:
     void propertyAboutToChange(Mayo::Property* prop);
     void propertyChanged(Mayo::Property* prop);
+    void propertyEnabled(Mayo::Property* prop, bool on);
 
 protected:
     void onPropertyAboutToChange(Property* prop) override;
     void onPropertyChanged(Property* prop) override;
+    void onPropertyEnabled(Property* prop, bool on) override;
 };
 
 
@@ -13,6 +13,7 @@
 #include <QtCore/QSettings>
 #include <gsl/util>
 #include <regex>
+#include <unordered_set>
 
 namespace Mayo {
 
@@ -83,10 +84,16 @@ public:
             const bool ok = m_propValueConverter->fromVariant(property, value);
             if (!ok)
                 qCritical() << QString("Failed to load setting %1").arg(to_QString(propertyKey));
+
+            // Value is now the one of the main storage
+            if (ok && &source == &m_settings)
+                m_setDirtyProperty.erase(property);
         }
     }
 
     QSettings m_settings;
+    // Settings whose value may differ from the one in main storage, to be written by next save()
+    std::unordered_set<const Property*> m_setDirtyProperty;
     QLocale m_locale;
     std::vector<Settings_Group> m_vecGroup;
     std::vector<SectionResetFunction> m_vecSectionResetFn;
@@ -105,9 +112,9 @@ Settings::~Settings()
     delete d;
 }
 
-void Settings::load()
+void Settings::load(const ExcludePropertyPredicate& fnExclude)
 {
-    this->loadFrom(d->m_settings);
+    this->loadFrom(d->m_settings, fnExclude);
 }
 
 void Settings::loadFrom(const QSettings& source, const ExcludePropertyPredicate& fnExclude)
@@ -144,7 +151,12 @@ QVariant Settings::findValueFromKey(const QString& strKey) const
 
 void Settings::save()
 {
-    this->saveAs(&d->m_settings);
+    // Only settings changed since they were last loaded or saved are written, unchanged entries of
+    // the storage are left as is
+    this->saveAs(&d->m_settings, [=](const Property& prop) {
+        return d->m_setDirtyProperty.find(&prop) == d->m_setDirtyProperty.cend();
+    });
+    d->m_setDirtyProperty.clear();
     d->m_settings.sync();
 }
 
@@ -410,6 +422,7 @@ void Settings::onPropertyAboutToChange(Property* prop)
 
 void Settings::onPropertyChanged(Property* prop)
 {
+    d->m_setDirtyProperty.insert(prop);
     PropertyGroup::onPropertyChanged(prop);
     emit this->changed(prop);
 }
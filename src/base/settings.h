@@ -30,9 +30,10 @@ public:
     Settings(QObject* parent = nullptr);
     ~Settings();
 
-    void load();
+    void load(const ExcludePropertyPredicate& fnExclude = nullptr);
     void loadProperty(SettingIndex index);
     QVariant findValueFromKey(const QString& strKey) const;
+    // Writes to the main storage the settings changed since they were last loaded or saved
     void save();
 
     void loadPropertyFrom(const QSettings& source, SettingIndex index);
@@ -0,0 +1,242 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "shape_deduplication.h"
+
+#include "profiler.h"
+#include "qtcore_hfuncs.h"
+#include "task_manager.h"
+#include "task_progress.h"
+#include "xcaf.h"
+
+#include <QtCore/QCryptographicHash>
+#include <BRepAdaptor_Curve.hxx>
+#include <BRepAdaptor_Surface.hxx>
+#include <BRepTools.hxx>
+#include <BRep_Tool.hxx>
+#include <TDataStd_ChildNodeIterator.hxx>
+#include <TDataStd_TreeNode.hxx>
+#include <TNaming_Builder.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Iterator.hxx>
+#include <XCAFDoc.hxx>
+#include <XCAFDoc_DocumentTool.hxx>
+#include <cmath>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace Mayo {
+
+namespace {
+
+// Feeds a hash function with the topology and the rounded geometry of shapes
+class GeometryHasher {
+public:
+    GeometryHasher(QCryptographicHash* hash, double precision)
+        : m_hash(hash), m_precision(precision > 0 ? precision : Precision::Confusion())
+    {}
+
+    void addShape(const TopoDS_Shape& shape) {
+        this->addInt(shape.ShapeType());
+        this->addInt(shape.Orientation());
+        // Shared sub-shapes(same TShape and location) are hashed once, then referred by index
+        const int index = m_mapShape.FindIndex(shape);
+        if (index != 0) {
+            this->addInt(-index);
+            return;
+        }
+
+        m_mapShape.Add(shape);
+        switch (shape.ShapeType()) {
+        case TopAbs_VERTEX:
+            this->addPnt(BRep_Tool::Pnt(TopoDS::Vertex(shape)));
+            break;
+        case TopAbs_EDGE:
+            this->addEdge(TopoDS::Edge(shape));
+            break;
+        case TopAbs_FACE:
+            this->addFace(TopoDS::Face(shape));
+            break;
+        default:
+            break;
+        }
+
+        for (TopoDS_Iterator it(shape); it.More(); it.Next())
+            this->addShape(it.Value());
+    }
+
+private:
+    static constexpr int SampleCount = 5;
+
+    void addEdge(const TopoDS_Edge& edge) {
+        if (BRep_Tool::Degenerated(edge) || !BRep_Tool::IsGeometric(edge)) {
+            this->addInt(-1);
+            return;
+        }
+
+        const BRepAdaptor_Curve curve(edge);
+        this->addInt(curve.GetType());
+        const double uFirst = curve.FirstParameter();
+        const double uLast = curve.LastParameter();
+        for (int i = 0; i < SampleCount; ++i)
+            this->addPnt(curve.Value(uFirst + (uLast - uFirst) * i / (SampleCount - 1)));
+    }
+
+    void addFace(const TopoDS_Face& face) {
+        TopLoc_Location loc;
+        if (BRep_Tool::Surface(face, loc).IsNull()) {
+            // Face carrying a triangulation only(eg imported from a mesh format)
+            const Handle_Poly_Triangulation& triangulation = BRep_Tool::Triangulation(face, loc);
+            this->addInt(triangulation.IsNull() ? -1 : triangulation->NbNodes());
+            if (!triangulation.IsNull()) {
+                for (int i = 1; i <= triangulation->NbNodes(); ++i)
+                    this->addPnt(triangulation->Node(i).Transformed(loc.Transformation()));
+            }
+
+            return;
+        }
+
+        const BRepAdaptor_Surface surface(face);
+        this->addInt(surface.GetType());
+        double uMin, uMax, vMin, vMax;
+        BRepTools::UVBounds(face, uMin, uMax, vMin, vMax);
+        for (int i = 0; i < SampleCount; ++i) {
+            const double u = uMin + (uMax - uMin) * i / (SampleCount - 1);
+            for (int j = 0; j < SampleCount; ++j)
+                this->addPnt(surface.Value(u, vMin + (vMax - vMin) * j / (SampleCount - 1)));
+        }
+    }
+
+    void addInt(int64_t value) {
+        m_hash->addData(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void addReal(double value) {
+        this->addInt(std::llround(value / m_precision));
+    }
+
+    void addPnt(const gp_Pnt& pnt) {
+        this->addReal(pnt.X());
+        this->addReal(pnt.Y());
+        this->addReal(pnt.Z());
+    }
+
+    QCryptographicHash* m_hash = nullptr;
+    double m_precision = Precision::Confusion();
+    TopTools_IndexedMapOfShape m_mapShape;
+};
+
+// Components(reference labels) referring to 'labelPrototype'
+TDF_LabelSequence prototypeReferences(const TDF_Label& labelPrototype)
+{
+    TDF_LabelSequence seqReference;
+    Handle_TDataStd_TreeNode node;
+    if (labelPrototype.FindAttribute(XCAFDoc::ShapeRefGUID(), node)) {
+        for (TDataStd_ChildNodeIterator it(node); it.More(); it.Next())
+            seqReference.Append(it.Value()->Label());
+    }
+
+    return seqReference;
+}
+
+// Makes component 'labelReference' refer to 'labelPrototype', location of the component is kept
+void redirectReference(const TDF_Label& labelReference, const TDF_Label& labelPrototype)
+{
+    const TopLoc_Location loc = XCaf::shapeReferenceLocation(labelReference);
+    TNaming_Builder(labelReference).Generated(XCaf::shape(labelPrototype).Located(loc));
+    Handle_TDataStd_TreeNode nodeReference = TDataStd_TreeNode::Set(labelReference, XCAFDoc::ShapeRefGUID());
+    Handle_TDataStd_TreeNode nodePrototype = TDataStd_TreeNode::Set(labelPrototype, XCAFDoc::ShapeRefGUID());
+    nodeReference->Remove();
+    nodePrototype->Prepend(nodeReference);
+}
+
+} // namespace
+
+QByteArray ShapeDeduplication::geometryHash(const TopoDS_Shape& shape, double precision)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    if (!shape.IsNull()) {
+        GeometryHasher hasher(&hash, precision);
+        hasher.addShape(shape.Located(TopLoc_Location()));
+    }
+
+    return hash.result();
+}
+
+ShapeDeduplication::Report ShapeDeduplication::deduplicate(
+        const TDF_LabelSequence& seqLabel, const Options& options, TaskProgress* progress)
+{
+    MAYO_PROFILE_ZONE("ShapeDeduplication::deduplicate");
+    Report report;
+    if (seqLabel.IsEmpty())
+        return report;
+
+    std::vector<TDF_Label> vecPrototype;
+    std::unordered_set<TDF_Label> setPrototype;
+    for (const TDF_Label& label : seqLabel) {
+        for (const TDF_Label& labelPrototype : XCaf::shapePrototypes(label)) {
+            if (XCaf::isShapeFree(labelPrototype) || !XCaf::shapeSubs(labelPrototype).IsEmpty())
+                continue;
+
+            if (setPrototype.insert(labelPrototype).second)
+                vecPrototype.push_back(labelPrototype);
+        }
+    }
+
+    report.prototypeCount = int(vecPrototype.size());
+    if (vecPrototype.size() < 2)
+        return report;
+
+    // Hashing only reads the document, so prototypes are processed concurrently
+    std::vector<QByteArray> vecHash(vecPrototype.size());
+    TaskManager::runConcurrently(int(vecPrototype.size()), progress, [&](int i, TaskProgress*) {
+        vecHash.at(i) = ShapeDeduplication::geometryHash(XCaf::shape(vecPrototype.at(i)), options.precision);
+    });
+    if (TaskProgress::isAbortRequested(progress))
+        return report;
+
+    // Color of the prototype is part of the key, merging must not change the appearance
+    Handle_XCAFDoc_ShapeTool shapeTool = XCAFDoc_DocumentTool::ShapeTool(seqLabel.First());
+    Handle_XCAFDoc_ColorTool colorTool = XCAFDoc_DocumentTool::ColorTool(seqLabel.First());
+    auto fnColorKey = [&](const TDF_Label& label) {
+        QByteArray key;
+        for (XCAFDoc_ColorType colorType : { XCAFDoc_ColorGen, XCAFDoc_ColorSurf, XCAFDoc_ColorCurv }) {
+            Quantity_Color color;
+            if (colorTool->GetColor(label, colorType, color))
+                key += QByteArray::number(color.Red()) + QByteArray::number(color.Green()) + QByteArray::number(color.Blue());
+
+            key += ';';
+        }
+
+        return key;
+    };
+
+    std::unordered_map<QByteArray, TDF_Label> mapKeyPrototype;
+    for (size_t i = 0; i < vecPrototype.size(); ++i) {
+        const TDF_Label& labelPrototype = vecPrototype.at(i);
+        const QByteArray key = vecHash.at(i) + fnColorKey(labelPrototype);
+        auto [it, isInserted] = mapKeyPrototype.insert({ key, labelPrototype });
+        if (isInserted)
+            continue;
+
+        const TDF_LabelSequence seqReference = prototypeReferences(labelPrototype);
+        for (const TDF_Label& labelReference : seqReference)
+            redirectReference(labelReference, it->second);
+
+        report.redirectedReferenceCount += seqReference.Size();
+        if (shapeTool->RemoveShape(labelPrototype, false/*removeCompletely*/))
+            ++report.mergedPrototypeCount;
+    }
+
+    if (report.redirectedReferenceCount > 0)
+        shapeTool->UpdateAssemblies();
+
+    return report;
+}
+
+} // namespace Mayo
@@ -0,0 +1,49 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include <QtCore/QByteArray>
+#include <Precision.hxx>
+#include <TDF_LabelSequence.hxx>
+#include <TopoDS_Shape.hxx>
+
+namespace Mayo {
+
+class TaskProgress;
+
+// Merging of identical XCAF prototypes, typically standard parts(screws, bearings, ...) appearing
+// in many imported files as independent shapes. Components referring to a duplicate are redirected
+// to a single shared prototype, so meshing, memory and export size no longer grow with duplicates
+struct ShapeDeduplication {
+    struct Options {
+        // Geometry is rounded to this precision before being hashed, so shapes differing by
+        // numerical noise only are considered identical
+        double precision = Precision::Confusion();
+    };
+
+    struct Report {
+        int prototypeCount = 0; // Prototypes examined
+        int mergedPrototypeCount = 0; // Duplicates removed from the document
+        int redirectedReferenceCount = 0; // Components now referring to a shared prototype
+
+        bool isModified() const { return this->mergedPrototypeCount != 0; }
+    };
+
+    // Hash of the topology and of the rounded geometry of 'shape', location of 'shape' itself is
+    // ignored. Geometry is sampled(vertex points, points along edges and over faces), so it doesn't
+    // depend on the parametrization chosen by the exchange format
+    static QByteArray geometryHash(const TopoDS_Shape& shape, double precision = Precision::Confusion());
+
+    // Merges the identical prototypes found in the assembly graphs of 'seqLabel', prototypes are
+    // hashed concurrently. The first prototype met is kept, duplicates are removed once their
+    // components are redirected, then assemblies are updated
+    // Only prototypes referred by components are considered, free shapes are kept as is. Prototypes
+    // having sub-shape labels(eg face colors) or a distinct color are not merged
+    static Report deduplicate(const TDF_LabelSequence& seqLabel, const Options& options, TaskProgress* progress = nullptr);
+};
+
+} // namespace Mayo
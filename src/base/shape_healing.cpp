@@ -0,0 +1,101 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "shape_healing.h"
+
+#include "brep_utils.h"
+#include "profiler.h"
+#include "task_manager.h"
+#include "task_progress.h"
+#include "xcaf.h"
+
+#include <ShapeBuild_ReShape.hxx>
+#include <ShapeExtend_Status.hxx>
+#include <ShapeFix_Shape.hxx>
+#include <ShapeFix_Shell.hxx>
+#include <XCAFDoc_DocumentTool.hxx>
+#include <vector>
+
+namespace Mayo {
+
+ShapeHealing::Report& ShapeHealing::Report::operator+=(const Report& other)
+{
+    this->healedShapeCount += other.healedShapeCount;
+    this->modifiedSolidCount += other.modifiedSolidCount;
+    this->modifiedFaceCount += other.modifiedFaceCount;
+    return *this;
+}
+
+TopoDS_Shape ShapeHealing::heal(const TopoDS_Shape& shape, const Options& options, Report* report)
+{
+    if (report)
+        *report = {};
+
+    if (shape.IsNull())
+        return shape;
+
+    Handle_ShapeFix_Shape fix = new ShapeFix_Shape(shape);
+    fix->SetPrecision(options.precision);
+    fix->SetMaxTolerance(options.maxTolerance);
+    fix->FixSolidMode() = options.fixSolids ? 1 : 0;
+    fix->FixFreeShellMode() = options.fixSolids ? 1 : 0;
+    fix->FixFreeFaceMode() = options.fixFaces ? 1 : 0;
+    fix->FixShellTool()->FixFaceMode() = options.fixFaces ? 1 : 0;
+    fix->Perform();
+    if (!fix->Status(ShapeExtend_DONE))
+        return shape;
+
+    if (report) {
+        // Sub-shapes of the input shape recorded in the context were replaced or removed
+        const Handle_ShapeBuild_ReShape& context = fix->Context();
+        report->healedShapeCount = 1;
+        BRepUtils::forEachSubShape(shape, TopAbs_SOLID, [&](const TopoDS_Shape& solid) {
+            if (context->IsRecorded(solid))
+                ++report->modifiedSolidCount;
+        });
+        BRepUtils::forEachSubFace(shape, [&](const TopoDS_Face& face) {
+            if (context->IsRecorded(face))
+                ++report->modifiedFaceCount;
+        });
+    }
+
+    return fix->Shape();
+}
+
+ShapeHealing::Report ShapeHealing::healLabel(const TDF_Label& label, const Options& options, TaskProgress* progress)
+{
+    MAYO_PROFILE_ZONE("ShapeHealing::healLabel");
+    Report report;
+    if (!XCaf::isShape(label))
+        return report;
+
+    // Prototypes don't share the document, so they can be fixed concurrently. Document is then
+    // updated from the calling thread
+    const TDF_LabelSequence seqPrototype = XCaf::shapePrototypes(label);
+    std::vector<TDF_Label> vecPrototype(seqPrototype.cbegin(), seqPrototype.cend());
+    std::vector<TopoDS_Shape> vecHealedShape(vecPrototype.size());
+    std::vector<Report> vecReport(vecPrototype.size());
+    TaskManager::runConcurrently(int(vecPrototype.size()), progress, [&](int i, TaskProgress*) {
+        vecHealedShape.at(i) = ShapeHealing::heal(XCaf::shape(vecPrototype.at(i)), options, &vecReport.at(i));
+    });
+    if (TaskProgress::isAbortRequested(progress))
+        return report;
+
+    Handle_XCAFDoc_ShapeTool shapeTool = XCAFDoc_DocumentTool::ShapeTool(label);
+    for (size_t i = 0; i < vecPrototype.size(); ++i) {
+        if (vecReport.at(i).isModified()) {
+            shapeTool->SetShape(vecPrototype.at(i), vecHealedShape.at(i));
+            report += vecReport.at(i);
+        }
+    }
+
+    if (report.isModified())
+        shapeTool->UpdateAssemblies();
+
+    return report;
+}
+
+} // namespace Mayo
@@ -0,0 +1,46 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include <Precision.hxx>
+#include <TDF_Label.hxx>
+#include <TopoDS_Shape.hxx>
+
+namespace Mayo {
+
+class TaskProgress;
+
+// Healing of BRep shapes coming from exchange formats(STEP, IGES, ...) with ShapeFix, typically
+// fixes wires of faces(gaps, self-intersections, missing seams) and orientation of shells so that
+// meshing produces closed triangulations
+struct ShapeHealing {
+    struct Options {
+        bool fixSolids = true; // Orientation of shells, free shells turned into solids
+        bool fixFaces = true; // Wires and bounds of faces
+        double precision = Precision::Confusion();
+        double maxTolerance = 1.; // Maximum tolerance allowed to vertices and edges
+    };
+
+    struct Report {
+        int healedShapeCount = 0; // Top-level shapes modified
+        int modifiedSolidCount = 0;
+        int modifiedFaceCount = 0; // Faces either modified or removed
+
+        bool isModified() const { return this->healedShapeCount != 0; }
+        Report& operator+=(const Report& other);
+    };
+
+    // Returns the healed shape, which is 'shape' itself when nothing had to be fixed
+    static TopoDS_Shape heal(const TopoDS_Shape& shape, const Options& options, Report* report = nullptr);
+
+    // Heals the prototypes of XCAF shape 'label' concurrently, then replaces them in the document
+    // and updates the assemblies referring to them
+    // Note: sub-shape labels(eg face colors) of modified prototypes may be lost
+    static Report healLabel(const TDF_Label& label, const Options& options, TaskProgress* progress = nullptr);
+};
+
+} // namespace Mayo
@@ -0,0 +1,122 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "shape_pager.h"
+#include "occ_progress_indicator.h"
+#include "task_progress.h"
+#include "tkernel_utils.h"
+
+#include <BinTools.hxx>
+#include <BRep_Builder.hxx>
+#include <TNaming_Builder.hxx>
+#include <TopoDS_Compound.hxx>
+#include <TopoDS_Iterator.hxx>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <atomic>
+#include <string>
+#include <vector>
+
+namespace Mayo {
+
+namespace {
+
+std::atomic<unsigned> ShapePager_pageCounter{0};
+
+} // namespace
+
+ShapePager::ShapePager(const FilePath& dirPath)
+    : m_dirPath(dirPath)
+{
+}
+
+int ShapePager::pageOut(const DocumentPtr& doc, TreeNodeId entityTreeNodeId) const
+{
+    if (this->isNull() || !doc)
+        return 0;
+
+    QDir().mkpath(filepathTo<QString>(m_dirPath));
+    return doc->unloadShapes(entityTreeNodeId, [=](const TDF_Label& protoLabel) {
+        return this->store(protoLabel);
+    });
+}
+
+void ShapePager::clear()
+{
+    if (this->isNull())
+        return;
+
+    QDir dir(filepathTo<QString>(m_dirPath));
+    for (const QString& fileName : dir.entryList({ "*.brep" }, QDir::Files))
+        dir.remove(fileName);
+}
+
+Document::ShapeLoader ShapePager::store(const TDF_Label& protoLabel) const
+{
+    // Sub-shapes are written along with the prototype in a single compound, so they still share
+    // the TShapes of the prototype once read back
+    std::vector<TDF_Label> vecSubLabel;
+    BRep_Builder builder;
+    TopoDS_Compound comp;
+    builder.MakeCompound(comp);
+    builder.Add(comp, XCaf::shape(protoLabel));
+    for (const TDF_Label& subLabel : XCaf::shapeSubs(protoLabel)) {
+        const TopoDS_Shape subShape = XCaf::shape(subLabel);
+        if (!subShape.IsNull()) {
+            builder.Add(comp, subShape);
+            vecSubLabel.push_back(subLabel);
+        }
+    }
+
+    const unsigned pageId = ++ShapePager_pageCounter;
+    const FilePath filepath =
+            m_dirPath / (std::to_string(QCoreApplication::applicationPid()) + "-" + std::to_string(pageId) + ".brep");
+    const std::string strFilepath = filepath.u8string();
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+    const bool ok = BinTools::Write(
+                comp, strFilepath.c_str(), true/*triangulations*/, true/*normals*/, BinTools_FormatVersion_CURRENT);
+#else
+    const bool ok = BinTools::Write(comp, strFilepath.c_str()); // Triangulations are always written
+#endif
+    if (!ok) {
+        QFile::remove(filepathTo<QString>(filepath));
+        return {};
+    }
+
+    return [=](TaskProgress* progress) {
+        TopoDS_Shape shape;
+        Handle_Message_ProgressIndicator indicator = new OccProgressIndicator(progress);
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 5, 0)
+        const bool okRead = BinTools::Read(shape, strFilepath.c_str(), TKernelUtils::start(indicator));
+#else
+        const bool okRead = BinTools::Read(shape, strFilepath.c_str());
+#endif
+        QFile::remove(filepathTo<QString>(filepath));
+        if (!okRead)
+            return TopoDS_Shape();
+
+        // Sub-shape labels must refer to the sub-shapes of the restored prototype before it's
+        // assigned to its label, see Document::loadDeferredShapes()
+        TopoDS_Iterator itShape(shape);
+        if (!itShape.More())
+            return TopoDS_Shape();
+
+        const TopoDS_Shape protoShape = itShape.Value();
+        itShape.Next();
+        for (const TDF_Label& subLabel : vecSubLabel) {
+            if (!itShape.More())
+                break;
+
+            TNaming_Builder(subLabel).Generated(itShape.Value());
+            itShape.Next();
+        }
+
+        return protoShape;
+    };
+}
+
+} // namespace Mayo
@@ -0,0 +1,44 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "document.h"
+#include "document_ptr.h"
+#include "filepath.h"
+
+namespace Mayo {
+
+// Out-of-core store of the shapes of document entities: prototypes are written into files of a
+// local scratch directory(binary BRep, along with triangulations), then released from memory
+// Shapes are restored on demand through the deferred shapes of the document, ie when a node is
+// shown, expanded or exported(see Document::loadDeferredShapes()). A page file is deleted once
+// read back, each page out writing a new file
+// Scratch directory is expected to be private to the running process
+class ShapePager {
+public:
+    ShapePager() = default;
+    ShapePager(const FilePath& dirPath);
+
+    const FilePath& dirPath() const { return m_dirPath; }
+    void setDirPath(const FilePath& dirPath) { m_dirPath = dirPath; }
+
+    bool isNull() const { return m_dirPath.empty(); }
+
+    // Pages out the prototypes of entity 'entityTreeNodeId', see Document::unloadShapes()
+    // Returns the count of prototypes paged out
+    int pageOut(const DocumentPtr& doc, TreeNodeId entityTreeNodeId) const;
+
+    // Deletes all the page files in scratch directory. Shapes paged out can't be restored afterwards
+    void clear();
+
+private:
+    Document::ShapeLoader store(const TDF_Label& protoLabel) const;
+
+    FilePath m_dirPath;
+};
+
+} // namespace Mayo
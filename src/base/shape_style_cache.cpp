@@ -0,0 +1,173 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "shape_style_cache.h"
+
+#include "brep_utils.h"
+#include "label_attributes_cache.h"
+#include "profiler.h"
+#include "sub_shape_cache.h"
+#include "task_manager.h"
+#include "task_progress.h"
+#include "xcaf.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace Mayo {
+
+const Quantity_Color* PrototypeStyle::faceColor(int iFace) const
+{
+    if (this->vecFaceColorIndex.empty())
+        return nullptr;
+
+    const int colorIndex = this->vecFaceColorIndex.at(iFace - 1);
+    return colorIndex >= 0 ? &this->vecFaceColor.at(colorIndex) : nullptr;
+}
+
+ShapeStyleCache::ShapeStyleCache(SubShapeCache* subShapeCache, LabelAttributesCache* attributesCache)
+    : m_subShapeCache(subShapeCache),
+      m_attributesCache(attributesCache)
+{
+}
+
+std::shared_ptr<const PrototypeStyle> ShapeStyleCache::prototypeStyle(const TDF_Label& labelPrototype)
+{
+    const TopoDS_Shape shape = XCaf::shape(labelPrototype);
+    auto style = this->findStyle(labelPrototype, shape);
+    if (!style) {
+        const StyleSource src = this->styleSource(labelPrototype);
+        style = this->insertStyle(src, this->buildStyle(src));
+    }
+
+    return style;
+}
+
+void ShapeStyleCache::computePrototypeStyles(const TDF_LabelSequence& seqLabel, TaskProgress* progress)
+{
+    MAYO_PROFILE_ZONE("ShapeStyleCache::computePrototypeStyles");
+    // XCAF attributes are read sequentially, only BRep data is then accessed concurrently
+    std::vector<StyleSource> vecSource;
+    for (const TDF_Label& label : seqLabel) {
+        for (const TDF_Label& labelPrototype : XCaf::shapePrototypes(label)) {
+            if (!this->findStyle(labelPrototype, XCaf::shape(labelPrototype)))
+                vecSource.push_back(this->styleSource(labelPrototype));
+        }
+    }
+
+    if (vecSource.empty())
+        return;
+
+    const int prototypeCount = int(vecSource.size());
+    const int taskCount = std::min(prototypeCount, std::max(1, int(std::thread::hardware_concurrency())));
+    TaskManager::runConcurrently(taskCount, progress, [&](int iTask, TaskProgress* taskProgress) {
+        const int first = (iTask * prototypeCount) / taskCount;
+        const int last = ((iTask + 1) * prototypeCount) / taskCount;
+        for (int i = first; i < last; ++i) {
+            if (TaskProgress::isAbortRequested(taskProgress))
+                return;
+
+            const StyleSource& src = vecSource.at(i);
+            this->insertStyle(src, this->buildStyle(src));
+            taskProgress->setValue(((i + 1 - first) * 100) / (last - first));
+        }
+    });
+}
+
+void ShapeStyleCache::forget(const TDF_Label& label)
+{
+    const TDF_LabelSequence seqPrototype = XCaf::shapePrototypes(label);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const TDF_Label& labelPrototype : seqPrototype)
+        m_mapEntry.erase(labelPrototype);
+}
+
+void ShapeStyleCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_mapEntry.clear();
+}
+
+const Quantity_Color* ShapeStyleCache::nodeColor(
+        const LabelAttributes& attrsNode,
+        const LabelAttributes& attrsShape,
+        const Quantity_Color* inheritedColor)
+{
+    if (attrsNode.hasColor)
+        return &attrsNode.color;
+
+    if (attrsShape.hasColor)
+        return &attrsShape.color;
+
+    return inheritedColor;
+}
+
+std::shared_ptr<const PrototypeStyle> ShapeStyleCache::findStyle(const TDF_Label& label, const TopoDS_Shape& shape) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_mapEntry.find(label);
+    if (it == m_mapEntry.cend() || !it->second.shape.IsSame(shape))
+        return {};
+
+    return it->second.style;
+}
+
+std::shared_ptr<const PrototypeStyle> ShapeStyleCache::insertStyle(const StyleSource& src, PrototypeStyle&& style)
+{
+    auto ptr = std::make_shared<const PrototypeStyle>(std::move(style));
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_mapEntry[src.label] = Entry{ src.shape, ptr };
+    return ptr;
+}
+
+ShapeStyleCache::StyleSource ShapeStyleCache::styleSource(const TDF_Label& labelPrototype) const
+{
+    StyleSource src;
+    src.label = labelPrototype;
+    src.shape = XCaf::shape(labelPrototype);
+    src.attrs = m_attributesCache->attributes(labelPrototype);
+    for (const TDF_Label& labelSub : XCaf::shapeSubs(labelPrototype)) {
+        auto attrsSub = m_attributesCache->attributes(labelSub);
+        if (attrsSub->hasColor && !attrsSub->shape.IsNull())
+            src.vecSubAttrs.push_back(std::move(attrsSub));
+    }
+
+    return src;
+}
+
+PrototypeStyle ShapeStyleCache::buildStyle(const StyleSource& src) const
+{
+    PrototypeStyle style;
+    style.hasColor = src.attrs->hasColor;
+    style.color = src.attrs->color;
+    style.subShapes = m_subShapeCache->subShapes(src.shape);
+    if (src.vecSubAttrs.empty())
+        return style;
+
+    // Sub-shapes of XCAF labels are located as the prototype shape, whereas indexed faces are
+    // expressed with identity location
+    const TopTools_IndexedMapOfShape& mapFace = style.subShapes->mapFace;
+    const TopLoc_Location locPrototypeInv = src.shape.Location().Inverted();
+    style.vecFaceColorIndex.resize(mapFace.Extent(), -1);
+    for (const auto& attrsSub : src.vecSubAttrs) {
+        auto itColor = std::find_if(style.vecFaceColor.cbegin(), style.vecFaceColor.cend(), [&](const Quantity_Color& color) {
+            return color.IsEqual(attrsSub->color);
+        });
+        const int colorIndex = int(itColor - style.vecFaceColor.cbegin());
+        if (itColor == style.vecFaceColor.cend())
+            style.vecFaceColor.push_back(attrsSub->color);
+
+        BRepUtils::forEachSubFace(attrsSub->shape, [&](const TopoDS_Face& face) {
+            const int iFace = mapFace.FindIndex(face.Located(locPrototypeInv * face.Location()));
+            if (iFace > 0)
+                style.vecFaceColorIndex.at(iFace - 1) = colorIndex;
+        });
+    }
+
+    return style;
+}
+
+} // namespace Mayo
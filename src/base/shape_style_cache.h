@@ -0,0 +1,99 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "caf_utils.h"
+
+#include <Quantity_Color.hxx>
+#include <TDF_Label.hxx>
+#include <TDF_LabelSequence.hxx>
+#include <TopoDS_Shape.hxx>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace Mayo {
+
+class LabelAttributesCache;
+class SubShapeCache;
+class TaskProgress;
+struct LabelAttributes;
+struct SubShapes;
+
+// Style of a prototype(non-assembly shape) and of its faces, as defined in XCAF: color of the
+// prototype label and colors of its sub-shape labels(eg colored faces)
+struct PrototypeStyle {
+    bool hasColor = false;
+    Quantity_Color color; // Color of the prototype label
+    std::shared_ptr<const SubShapes> subShapes;
+    // Faces having their own color, indexes in 'vecFaceColor' of the faces indexed as
+    // SubShapes::mapFace(minus one). Empty if no face has its own color
+    std::vector<int> vecFaceColorIndex;
+    std::vector<Quantity_Color> vecFaceColor;
+
+    // Own color of face 'iFace'(1-based index in SubShapes::mapFace), null if the face inherits
+    const Quantity_Color* faceColor(int iFace) const;
+};
+
+// Styles of the prototypes of a document, resolved once and shared by all the mesh exporters
+// Color inheritance along the assembly tree is cheap and resolved by callers with nodeColor(),
+// the costly part(matching faces of sub-shape labels with the faces of prototypes) is done here
+// Cached styles are tied to the shape they were computed from, like BndBoxCache
+// All functions are thread-safe
+class ShapeStyleCache {
+public:
+    ShapeStyleCache(SubShapeCache* subShapeCache, LabelAttributesCache* attributesCache);
+
+    // Returns the style of prototype 'labelPrototype', computed on first query
+    std::shared_ptr<const PrototypeStyle> prototypeStyle(const TDF_Label& labelPrototype);
+
+    // Computes concurrently the styles of all the prototypes instantiated by 'seqLabel', so later
+    // calls to prototypeStyle() are just lookups
+    void computePrototypeStyles(const TDF_LabelSequence& seqLabel, TaskProgress* progress = nullptr);
+
+    // Drops the styles of the prototypes instantiated by 'label', to be called before the label is
+    // destroyed
+    void forget(const TDF_Label& label);
+    void clear();
+
+    // Color of a tree node given the color inherited from its parent node(null if none)
+    // Color of a reference takes precedence over the color of the referred shape, and color of an
+    // assembly is inherited by its components unless they define their own
+    // 'attrsShape' are the attributes of the shape referred by the node(ie 'attrsNode' if the node
+    // isn't a reference). Returned pointer refers to one of the arguments
+    static const Quantity_Color* nodeColor(
+            const LabelAttributes& attrsNode,
+            const LabelAttributes& attrsShape,
+            const Quantity_Color* inheritedColor);
+
+private:
+    // Data read from XCAF for building the style of a prototype
+    struct StyleSource {
+        TDF_Label label;
+        TopoDS_Shape shape;
+        std::shared_ptr<const LabelAttributes> attrs;
+        std::vector<std::shared_ptr<const LabelAttributes>> vecSubAttrs; // Colored sub-shapes
+    };
+
+    std::shared_ptr<const PrototypeStyle> findStyle(const TDF_Label& label, const TopoDS_Shape& shape) const;
+    std::shared_ptr<const PrototypeStyle> insertStyle(const StyleSource& src, PrototypeStyle&& style);
+    StyleSource styleSource(const TDF_Label& labelPrototype) const;
+    PrototypeStyle buildStyle(const StyleSource& src) const;
+
+    struct Entry {
+        TopoDS_Shape shape;
+        std::shared_ptr<const PrototypeStyle> style;
+    };
+
+    SubShapeCache* m_subShapeCache = nullptr;
+    LabelAttributesCache* m_attributesCache = nullptr;
+    mutable std::mutex m_mutex;
+    std::unordered_map<TDF_Label, Entry> m_mapEntry;
+};
+
+} // namespace Mayo
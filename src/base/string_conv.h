@@ -13,6 +13,7 @@
 #include <Standard_Version.hxx>
 #include <string>
 #include <string_view>
+#include <type_traits>
 
 namespace Mayo {
 
@@ -31,6 +32,13 @@ OUT_STRING_TYPE string_conv(const IN_STRING_TYPE& str) {
     return StringConv<IN_STRING_TYPE, OUT_STRING_TYPE>::to(str);
 }
 
+// X -> Y, result is assigned to existing string '*buffer'
+// Converters providing function assign() write directly into the buffer so its capacity is reused,
+// which avoids allocations when converting many strings in a loop(eg names on IO paths)
+// Note: 'IN_STRING_TYPE' and 'OUT_STRING_TYPE' should be automatically deduced by the compiler
+template<typename OUT_STRING_TYPE, typename IN_STRING_TYPE>
+void string_conv(const IN_STRING_TYPE& str, OUT_STRING_TYPE* buffer);
+
 // X -> QString
 template<typename STRING_TYPE>
 QString to_QString(const STRING_TYPE& str) {
@@ -155,6 +163,10 @@ template<> struct StringConv<TCollection_AsciiString, std::string> {
     static auto to(const TCollection_AsciiString& str) {
         return std::string(str.ToCString(), str.Length());
     }
+
+    static void assign(const TCollection_AsciiString& str, std::string* buffer) {
+        buffer->assign(str.ToCString(), str.Length());
+    }
 };
 
 // TCollection_AsciiString -> std::string_view
@@ -193,11 +205,15 @@ template<> struct StringConv<TCollection_AsciiString, QString> {
 template<> struct StringConv<TCollection_ExtendedString, std::string> {
     static auto to(const TCollection_ExtendedString& str) {
         std::string u8;
-        u8.resize(str.LengthOfCString());
-        char* u8Data = u8.data();
-        str.ToUTF8CString(u8Data);
+        assign(str, &u8);
         return u8;
     }
+
+    static void assign(const TCollection_ExtendedString& str, std::string* buffer) {
+        buffer->resize(str.LengthOfCString());
+        char* u8Data = buffer->data();
+        str.ToUTF8CString(u8Data);
+    }
 };
 
 // TCollection_ExtendedString -> std::u16string
@@ -205,6 +221,10 @@ template<> struct StringConv<TCollection_ExtendedString, std::u16string> {
     static auto to(const TCollection_ExtendedString& str) {
         return std::u16string(str.ToExtString(), str.Length());
     }
+
+    static void assign(const TCollection_ExtendedString& str, std::u16string* buffer) {
+        buffer->assign(str.ToExtString(), str.Length());
+    }
 };
 
 // TCollection_ExtendedString -> std::u16string_view
@@ -226,6 +246,11 @@ template<> struct StringConv<TCollection_ExtendedString, QString> {
     static auto to(const TCollection_ExtendedString& str) {
         return QString::fromUtf16(str.ToExtString(), str.Length());
     }
+
+    static void assign(const TCollection_ExtendedString& str, QString* buffer) {
+        // Storage of 'buffer' is reused if not shared and big enough
+        buffer->setUnicode(reinterpret_cast<const QChar*>(str.ToExtString()), str.Length());
+    }
 };
 
 // --
@@ -256,4 +281,30 @@ template<> struct StringConv<QString, TCollection_ExtendedString> {
     }
 };
 
+
+// --
+// -- Implementation
+// --
+
+namespace Internal {
+
+template<typename CONV, typename IN_STRING_TYPE, typename OUT_STRING_TYPE, typename = void>
+struct StringConvHasAssign : std::false_type {};
+
+template<typename CONV, typename IN_STRING_TYPE, typename OUT_STRING_TYPE>
+struct StringConvHasAssign<CONV, IN_STRING_TYPE, OUT_STRING_TYPE, std::void_t<decltype(
+        CONV::assign(std::declval<const IN_STRING_TYPE&>(), std::declval<OUT_STRING_TYPE*>()))>>
+    : std::true_type {};
+
+} // namespace Internal
+
+template<typename OUT_STRING_TYPE, typename IN_STRING_TYPE>
+void string_conv(const IN_STRING_TYPE& str, OUT_STRING_TYPE* buffer) {
+    using Conv = StringConv<IN_STRING_TYPE, OUT_STRING_TYPE>;
+    if constexpr (Internal::StringConvHasAssign<Conv, IN_STRING_TYPE, OUT_STRING_TYPE>::value)
+        Conv::assign(str, buffer);
+    else
+        *buffer = Conv::to(str);
+}
+
 } // namespace Mayo
@@ -0,0 +1,175 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "sub_shape_cache.h"
+
+#include "profiler.h"
+#include "task_manager.h"
+#include "task_progress.h"
+#include "xcaf.h"
+
+#include <BRep_Tool.hxx>
+#include <TopExp.hxx>
+#include <TopoDS.hxx>
+#include <algorithm>
+#include <thread>
+#include <unordered_set>
+
+namespace Mayo {
+
+const TopTools_IndexedMapOfShape& SubShapes::map(TopAbs_ShapeEnum shapeType) const
+{
+    switch (shapeType) {
+    case TopAbs_EDGE: return this->mapEdge;
+    case TopAbs_VERTEX: return this->mapVertex;
+    default: return this->mapFace;
+    }
+}
+
+std::shared_ptr<const SubShapes> SubShapeCache::subShapes(const TopoDS_Shape& shape)
+{
+    auto subShapes = this->find(shape);
+    if (!subShapes)
+        subShapes = this->insert(shape, SubShapeCache::build(shape));
+
+    return subShapes;
+}
+
+void SubShapeCache::computePrototypeSubShapes(const TDF_LabelSequence& seqLabel, TaskProgress* progress)
+{
+    MAYO_PROFILE_ZONE("SubShapeCache::computePrototypeSubShapes");
+    // Shapes are retrieved sequentially, only BRep data is then accessed concurrently
+    std::vector<TopoDS_Shape> vecPrototype;
+    std::unordered_set<const TopoDS_TShape*> setTShape;
+    for (const TDF_Label& label : seqLabel) {
+        for (const TDF_Label& labelPrototype : XCaf::shapePrototypes(label)) {
+            const TopoDS_Shape shape = XCaf::shape(labelPrototype);
+            if (!shape.IsNull() && setTShape.insert(shape.TShape().get()).second && !this->find(shape))
+                vecPrototype.push_back(shape);
+        }
+    }
+
+    if (vecPrototype.empty())
+        return;
+
+    const int prototypeCount = int(vecPrototype.size());
+    const int taskCount = std::min(prototypeCount, std::max(1, int(std::thread::hardware_concurrency())));
+    TaskManager::runConcurrently(taskCount, progress, [&](int iTask, TaskProgress* taskProgress) {
+        const int first = (iTask * prototypeCount) / taskCount;
+        const int last = ((iTask + 1) * prototypeCount) / taskCount;
+        for (int i = first; i < last; ++i) {
+            if (TaskProgress::isAbortRequested(taskProgress))
+                return;
+
+            const TopoDS_Shape& shape = vecPrototype.at(i);
+            this->insert(shape, SubShapeCache::build(shape));
+            taskProgress->setValue(((i + 1 - first) * 100) / (last - first));
+        }
+    });
+}
+
+void SubShapeCache::forEachSubFace(const TopoDS_Shape& shape, const std::function<void(const TopoDS_Face&, bool)>& fn)
+{
+    if (shape.IsNull())
+        return;
+
+    const std::shared_ptr<const SubShapes> subShapes = this->subShapes(shape);
+    const TopLoc_Location& loc = shape.Location();
+    for (int i = 1; i <= subShapes->mapFace.Extent(); ++i) {
+        TopoDS_Shape face = subShapes->mapFace.FindKey(i);
+        if (!loc.IsIdentity())
+            face.Move(loc);
+
+        face.Compose(shape.Orientation());
+        fn(TopoDS::Face(face), subShapes->vecFaceTriangulated.at(i - 1));
+    }
+}
+
+void SubShapeCache::forEachLabelFace(
+        const TDF_Label& label,
+        const TopLoc_Location& loc,
+        const std::function<void(const TopoDS_Face&, bool)>& fn)
+{
+    if (XCaf::isShapeReference(label)) {
+        const TopLoc_Location locRef = loc * XCaf::shapeReferenceLocation(label);
+        this->forEachLabelFace(XCaf::shapeReferred(label), locRef, fn);
+    }
+    else if (XCaf::isShapeAssembly(label)) {
+        for (const TDF_Label& labelComponent : XCaf::shapeComponents(label))
+            this->forEachLabelFace(labelComponent, loc, fn);
+    }
+    else if (XCaf::isShape(label)) {
+        this->forEachSubFace(XCaf::shape(label).Moved(loc), fn);
+    }
+}
+
+void SubShapeCache::forget(const TDF_Label& label)
+{
+    for (const TDF_Label& labelPrototype : XCaf::shapePrototypes(label))
+        this->forget(XCaf::shape(labelPrototype));
+}
+
+void SubShapeCache::forget(const TopoDS_Shape& shape)
+{
+    if (shape.IsNull())
+        return;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_mapEntry.erase(shape.TShape().get());
+}
+
+void SubShapeCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_mapEntry.clear();
+}
+
+SubShapes SubShapeCache::build(const TopoDS_Shape& shape)
+{
+    SubShapes subShapes;
+    if (shape.IsNull())
+        return subShapes;
+
+    const TopoDS_Shape shapeRef = shape.Located(TopLoc_Location()).Oriented(TopAbs_FORWARD);
+    TopExp::MapShapes(shapeRef, TopAbs_FACE, subShapes.mapFace);
+    TopExp::MapShapes(shapeRef, TopAbs_EDGE, subShapes.mapEdge);
+    TopExp::MapShapes(shapeRef, TopAbs_VERTEX, subShapes.mapVertex);
+    subShapes.vecFaceTriangulated.resize(subShapes.mapFace.Extent(), false);
+    for (int i = 1; i <= subShapes.mapFace.Extent(); ++i) {
+        TopLoc_Location loc;
+        const Handle_Poly_Triangulation& mesh = BRep_Tool::Triangulation(TopoDS::Face(subShapes.mapFace.FindKey(i)), loc);
+        if (!mesh.IsNull() && mesh->NbTriangles() > 0) {
+            subShapes.vecFaceTriangulated.at(i - 1) = true;
+            ++subShapes.triangulatedFaceCount;
+        }
+    }
+
+    return subShapes;
+}
+
+std::shared_ptr<const SubShapes> SubShapeCache::find(const TopoDS_Shape& shape) const
+{
+    if (shape.IsNull())
+        return {};
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_mapEntry.find(shape.TShape().get());
+    return it != m_mapEntry.cend() ? it->second.subShapes : std::shared_ptr<const SubShapes>();
+}
+
+std::shared_ptr<const SubShapes> SubShapeCache::insert(const TopoDS_Shape& shape, SubShapes&& subShapes)
+{
+    auto ptr = std::make_shared<const SubShapes>(std::move(subShapes));
+    if (shape.IsNull())
+        return ptr;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // Entry might have been inserted meanwhile by another thread, keep it
+    auto it = m_mapEntry.try_emplace(shape.TShape().get(), Entry{ shape, ptr }).first;
+    return it->second.subShapes;
+}
+
+} // namespace Mayo
@@ -0,0 +1,92 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include <TDF_Label.hxx>
+#include <TDF_LabelSequence.hxx>
+#include <TopAbs_ShapeEnum.hxx>
+#include <TopLoc_Location.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+#include <TopoDS_Face.hxx>
+#include <TopoDS_Shape.hxx>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace Mayo {
+
+class TaskProgress;
+
+// Indexed sub-shapes of a shape taken with identity location and forward orientation, see
+// TopExp::MapShapes()
+struct SubShapes {
+    TopTools_IndexedMapOfShape mapFace;
+    TopTools_IndexedMapOfShape mapEdge;
+    TopTools_IndexedMapOfShape mapVertex;
+    // Presence of triangulation for each face(indexed as 'mapFace' minus one), as it was when
+    // sub-shapes were indexed
+    std::vector<bool> vecFaceTriangulated;
+    int triangulatedFaceCount = 0;
+
+    // Map of sub-shapes of type 'shapeType', which must be face, edge or vertex
+    const TopTools_IndexedMapOfShape& map(TopAbs_ShapeEnum shapeType) const;
+};
+
+// Indexed sub-shapes of the XCAF shapes of a document, so writers, graphics and property providers
+// don't explore the same topology again and again
+// Sub-shapes are indexed once per TShape: all the instances of a prototype share the same entry
+// whatever their location and orientation
+// Triangulation presence flags are a snapshot: forget() has to be called once the shapes of a label
+// are meshed again or replaced
+// All functions are thread-safe
+class SubShapeCache {
+public:
+    // Returns the indexed sub-shapes of 'shape', which are computed on first query. Location and
+    // orientation of 'shape' are ignored
+    std::shared_ptr<const SubShapes> subShapes(const TopoDS_Shape& shape);
+
+    // Computes concurrently the sub-shapes of all the prototypes instantiated by 'seqLabel', so
+    // later calls to subShapes() are just lookups
+    void computePrototypeSubShapes(const TDF_LabelSequence& seqLabel, TaskProgress* progress = nullptr);
+
+    // Executes fn(face, isTriangulated) for each indexed face of 'shape', location and orientation
+    // of 'shape' being applied to the faces. Faces are visited in index order
+    void forEachSubFace(const TopoDS_Shape& shape, const std::function<void(const TopoDS_Face&, bool)>& fn);
+
+    // Executes fn(face, isTriangulated) for each face of the shape at 'label', which can be an
+    // assembly or a reference: assemblies are walked down to their prototypes, so the faces of a
+    // prototype instantiated many times are indexed once. 'loc' is applied on top of the faces
+    void forEachLabelFace(
+            const TDF_Label& label,
+            const TopLoc_Location& loc,
+            const std::function<void(const TopoDS_Face&, bool)>& fn);
+
+    // Drops the entries of the prototypes instantiated by 'label', to be called before the shapes
+    // of the label are replaced or meshed again
+    void forget(const TDF_Label& label);
+    void forget(const TopoDS_Shape& shape);
+    void clear();
+
+    // Builds the indexed sub-shapes of 'shape', no caching
+    static SubShapes build(const TopoDS_Shape& shape);
+
+private:
+    struct Entry {
+        TopoDS_Shape shape; // Keeps the TShape alive, so its address isn't reused by another shape
+        std::shared_ptr<const SubShapes> subShapes;
+    };
+
+    std::shared_ptr<const SubShapes> find(const TopoDS_Shape& shape) const;
+    std::shared_ptr<const SubShapes> insert(const TopoDS_Shape& shape, SubShapes&& subShapes);
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<const TopoDS_TShape*, Entry> m_mapEntry;
+};
+
+} // namespace Mayo
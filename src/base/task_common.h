@@ -13,4 +13,13 @@ namespace Mayo {
 using TaskId = uint64_t;
 enum class TaskAutoDestroy { On, Off };
 
+// Predefined priorities of tasks, any other int value can be used
+// Interactive tasks(eg meshing of shapes visible in a view) are started before the other pending
+// tasks and can exceed the maximum concurrency of TaskManager by one thread
+enum TaskPriority {
+    TaskPriority_Background = -100,
+    TaskPriority_Normal = 0,
+    TaskPriority_Interactive = 100
+};
+
 } // namespace Mayo
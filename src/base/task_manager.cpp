@@ -5,14 +5,65 @@
 ****************************************************************************/
 
 #include "task_manager.h"
+#include "cpu_topology.h"
 #include "math_utils.h"
+#include "profiler.h"
 
 #include <QtCore/QtDebug>
 #include <QtCore/QCoreApplication>
+#include <algorithm>
 #include <cassert>
 
 namespace Mayo {
 
+namespace {
+
+// State of a TaskManager::runConcurrently() call, shared with the helper tasks
+struct ConcurrentJob {
+    int taskCount = 0;
+    const std::function<void(int, TaskProgress*)>* fnTask = nullptr;
+    TaskProgress* progress = nullptr;
+    std::atomic<int> nextIndex = 0;
+    std::mutex mutexDone;
+    std::condition_variable condDone;
+    int doneCount = 0; // Guarded by mutexDone
+};
+
+// Executes the tasks of 'job' not claimed yet by other threads, returns once none is left
+// NOTE function and progress of 'job' must not be accessed once all tasks are claimed, as
+//      runConcurrently() might have returned
+void runConcurrentJob(ConcurrentJob* job)
+{
+    for (int i = job->nextIndex++; i < job->taskCount; i = job->nextIndex++) {
+        {
+            // Progress of the task is a portion of the job progress, abort request is inherited
+            TaskProgress taskProgress(job->progress, 100. / job->taskCount);
+            try {
+                (*job->fnTask)(i, &taskProgress);
+            } catch (...) {
+                // Exception can't be reported to the caller, it's swallowed so the job still
+                // completes
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(job->mutexDone);
+            ++(job->doneCount);
+        }
+
+        job->condDone.notify_all();
+    }
+}
+
+// Worker pool executing the helpers of all runConcurrently() calls
+TaskManager& concurrentPool()
+{
+    static TaskManager pool;
+    return pool;
+}
+
+} // namespace
+
 TaskManager::TaskManager(QObject* parent)
     : QObject(parent)
 {
@@ -22,17 +73,30 @@ TaskManager::TaskManager(QObject* parent)
         qRegisterMetaType<TaskId>("TaskId");
         staticTypesRegistered = true;
     }
+
+    m_maxConcurrency = std::max(1, int(std::thread::hardware_concurrency()));
 }
 
 TaskManager::~TaskManager()
 {
-    // Make sure all tasks are really finished
+    // Make sure all tasks are really finished. Tasks still waiting for their dependencies will never
+    // be started
     for (const auto& mapPair : m_mapEntity) {
         const std::unique_ptr<Entity>& ptrEntity = mapPair.second;
-        if (ptrEntity->control.valid())
+        if (ptrEntity->control.valid() && !ptrEntity->isWaitingDependencies)
             ptrEntity->control.wait();
     }
 
+    // Stop worker threads
+    {
+        std::lock_guard<std::mutex> lock(m_mutexPool);
+        m_isPoolStopping = true;
+    }
+
+    m_condPool.notify_all();
+    for (std::thread& worker : m_vecWorker)
+        worker.join();
+
     // Erase the task from its container before destruction, this will allow TaskProgress destructor
     // to behave correctly(it calls TaskProgress::setValue())
     for (auto it = m_mapEntity.begin(); it != m_mapEntity.end(); )
@@ -48,14 +112,16 @@ TaskManager* TaskManager::globalInstance()
     return global;
 }
 
-TaskId TaskManager::newTask(TaskJob fn)
+TaskId TaskManager::newTask(TaskJob fn, int priority)
 {
     const TaskId taskId = m_taskIdSeq.fetch_add(1);
     std::unique_ptr<Entity> ptrEntity(new Entity);
     ptrEntity->task.m_id = taskId;
     ptrEntity->task.m_fn = std::move(fn);
     ptrEntity->task.m_manager = this;
+    ptrEntity->priority = priority;
     ptrEntity->taskProgress.setTask(&ptrEntity->task);
+    std::lock_guard<std::mutex> lock(m_mutexPool);
     m_mapEntity.insert({ taskId, std::move(ptrEntity) });
     return taskId;
 }
@@ -69,7 +135,21 @@ void TaskManager::run(TaskId id, TaskAutoDestroy policy)
 
     entity->isFinished = false;
     entity->autoDestroy = policy;
-    entity->control = std::async([=]{ this->execEntity(entity); });
+    entity->promise = std::promise<void>();
+    entity->control = entity->promise.get_future();
+    {
+        std::lock_guard<std::mutex> lock(m_mutexPool);
+        if (entity->pendingDependencyCount > 0) {
+            // Queued later by notifyFinished() of the last dependency
+            entity->isWaitingDependencies = true;
+            ++m_waitingDependenciesCount;
+            return;
+        }
+
+        this->enqueuePending(entity);
+    }
+
+    m_condPool.notify_one();
 }
 
 void TaskManager::exec(TaskId id, TaskAutoDestroy policy)
@@ -81,9 +161,38 @@ void TaskManager::exec(TaskId id, TaskAutoDestroy policy)
 
     entity->isFinished = false;
     entity->autoDestroy = policy;
+    {
+        std::unique_lock<std::mutex> lock(m_mutexPool);
+        m_condTaskFinished.wait(lock, [=]{ return entity->pendingDependencyCount == 0; });
+    }
+
     this->execEntity(entity);
 }
 
+void TaskManager::addDependency(TaskId id, TaskId dependencyId)
+{
+    Entity* entity = this->findEntity(id);
+    Entity* dependency = this->findEntity(dependencyId);
+    if (!entity || !dependency || entity == dependency)
+        return;
+
+    std::lock_guard<std::mutex> lock(m_mutexPool);
+    if (dependency->isFinished)
+        return;
+
+    dependency->vecDependent.push_back(entity);
+    ++(entity->pendingDependencyCount);
+}
+
+TaskId TaskManager::newTaskAfter(Span<const TaskId> dependencies, TaskJob fn, int priority)
+{
+    const TaskId taskId = this->newTask(std::move(fn), priority);
+    for (const TaskId dependencyId : dependencies)
+        this->addDependency(taskId, dependencyId);
+
+    return taskId;
+}
+
 bool TaskManager::waitForDone(TaskId id, int msecs)
 {
     Entity* entity = this->findEntity(id);
@@ -101,6 +210,85 @@ bool TaskManager::waitForDone(TaskId id, int msecs)
     return entity->control.wait_for(std::chrono::milliseconds(msecs)) == std::future_status::ready;
 }
 
+bool TaskManager::waitForAll(Span<const TaskId> ids, int msecs)
+{
+    std::unique_lock<std::mutex> lock(m_mutexPool);
+    auto fnAllFinished = [=]{
+        return std::all_of(ids.begin(), ids.end(), [=](TaskId id) {
+            const Entity* entity = this->findEntity_locked(id);
+            return !entity || entity->isFinished;
+        });
+    };
+    if (msecs < 0) {
+        m_condTaskFinished.wait(lock, fnAllFinished);
+        return true;
+    }
+
+    return m_condTaskFinished.wait_for(lock, std::chrono::milliseconds(msecs), fnAllFinished);
+}
+
+bool TaskManager::runConcurrently(
+        int taskCount, TaskProgress* progress, const std::function<void(int, TaskProgress*)>& fnTask)
+{
+    auto job = std::make_shared<ConcurrentJob>();
+    job->taskCount = taskCount;
+    job->fnTask = &fnTask;
+    job->progress = progress;
+
+    // Helpers are queued in the pool shared by all calls, so simultaneous or nested calls(eg readers
+    // of files imported concurrently) don't start more threads than there are CPUs
+    // Calling thread executes tasks as well while waiting, completion doesn't depend on available
+    // pool workers and nested calls can't deadlock
+    TaskManager& pool = concurrentPool();
+    const int helperCount = std::min(taskCount - 1, pool.maxConcurrency());
+    for (int i = 0; i < helperCount; ++i)
+        pool.run(pool.newTask([=](TaskProgress*) { runConcurrentJob(job.get()); }));
+
+    runConcurrentJob(job.get());
+    {
+        std::unique_lock<std::mutex> lock(job->mutexDone);
+        job->condDone.wait(lock, [&]{ return job->doneCount == taskCount; });
+    }
+
+    return !TaskProgress::isAbortRequested(progress);
+}
+
+int TaskManager::waitForAny(Span<const TaskId> ids, int msecs)
+{
+    if (ids.empty())
+        return -1;
+
+    std::unique_lock<std::mutex> lock(m_mutexPool);
+    int index = -1;
+    auto fnAnyFinished = [&]{
+        index = this->findFinished(ids);
+        return index != -1;
+    };
+    if (msecs < 0)
+        m_condTaskFinished.wait(lock, fnAnyFinished);
+    else
+        m_condTaskFinished.wait_for(lock, std::chrono::milliseconds(msecs), fnAnyFinished);
+
+    return index;
+}
+
+void TaskManager::whenDone(TaskId id, std::function<void()> fn)
+{
+    Entity* entity = this->findEntity(id);
+    if (!entity || !fn)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutexPool);
+        if (!entity->isFinished) {
+            entity->vecContinuation.push_back(std::move(fn));
+            return;
+        }
+    }
+
+    fn();
+}
+
 void TaskManager::requestAbort(TaskId id)
 {
     Entity* entity = this->findEntity(id);
@@ -110,6 +298,72 @@ void TaskManager::requestAbort(TaskId id)
     }
 }
 
+int TaskManager::maxConcurrency() const
+{
+    std::lock_guard<std::mutex> lock(m_mutexPool);
+    return m_maxConcurrency;
+}
+
+void TaskManager::setMaxConcurrency(int count)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutexPool);
+        m_maxConcurrency = std::max(1, count);
+        // Start additional workers in case pending tasks can now be executed
+        const int workerAvailCount = m_maxConcurrency - int(m_vecWorker.size());
+        const int workerMissingCount = int(m_queuePending.size()) - m_idleWorkerCount;
+        for (int i = 0; i < std::min(workerAvailCount, workerMissingCount); ++i)
+            this->startWorker();
+    }
+
+    m_condPool.notify_all();
+}
+
+TaskManager::WorkerPlacement TaskManager::workerPlacement() const
+{
+    std::lock_guard<std::mutex> lock(m_mutexPool);
+    return m_workerPlacement;
+}
+
+void TaskManager::setWorkerPlacement(WorkerPlacement placement)
+{
+    std::lock_guard<std::mutex> lock(m_mutexPool);
+    m_workerPlacement = placement;
+}
+
+int TaskManager::numaNode(TaskId id) const
+{
+    const Entity* entity = this->findEntity(id);
+    return entity ? entity->numaNode.load() : -1;
+}
+
+void TaskManager::setNumaNode(TaskId id, int node)
+{
+    Entity* entity = this->findEntity(id);
+    if (entity)
+        entity->numaNode = node;
+}
+
+int TaskManager::pendingTaskCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutexPool);
+    return int(m_queuePending.size()) + m_waitingDependenciesCount;
+}
+
+int TaskManager::priority(TaskId id) const
+{
+    const Entity* entity = this->findEntity(id);
+    return entity ? entity->priority.load() : 0;
+}
+
+void TaskManager::setPriority(TaskId id, int priority)
+{
+    // NOTE Has no effect on a task already pending in the worker pool
+    Entity* entity = this->findEntity(id);
+    if (entity)
+        entity->priority = priority;
+}
+
 int TaskManager::progress(TaskId id) const
 {
     const Entity* entity = this->findEntity(id);
@@ -118,19 +372,38 @@ int TaskManager::progress(TaskId id) const
 
 int TaskManager::globalProgress() const
 {
-    int taskAccumPct = 0;
-    for (const auto& mapPair : m_mapEntity) {
-        const std::unique_ptr<Entity>& ptrEntity = mapPair.second;
-        if (ptrEntity->taskProgress.value() > 0)
-            taskAccumPct += ptrEntity->taskProgress.value();
+    int taskCount = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutexPool);
+        taskCount = int(m_mapEntity.size());
     }
 
-    const int taskCount = m_mapEntity.size();
-    const int newGlobalPct = MathUtils::mappedValue(taskAccumPct, 0, taskCount * 100, 0, 100);
-    //qDebug() << "taskCount=" << taskCount << " taskAccumPct=" << taskAccumPct << " newGlobalPct=" << newGlobalPct;
+    const int newGlobalPct = MathUtils::mappedValue(m_progressAccum.load(), 0, taskCount * 100, 0, 100);
     return newGlobalPct;
 }
 
+TaskStats TaskManager::stats(TaskId id) const
+{
+    const Entity* entity = this->findEntity(id);
+    if (!entity)
+        return {};
+
+    const TaskProgress& progress = entity->taskProgress;
+    const int64_t timeStartNs = progress.m_timeStartNs;
+    if (timeStartNs == 0)
+        return {}; // Not started yet
+
+    const auto timeNow = std::chrono::steady_clock::now().time_since_epoch();
+    const int64_t timeNowNs = std::chrono::duration_cast<std::chrono::nanoseconds>(timeNow).count();
+    TaskStats stats;
+    stats.progress = progress.value();
+    stats.elapsedMs = (timeNowNs - timeStartNs) / 1000000;
+    stats.stepElapsedMs = (timeNowNs - progress.m_timeStepStartNs) / 1000000;
+    stats.processedBytes = progress.processedBytes();
+    stats.processedEntities = progress.processedEntities();
+    return stats;
+}
+
 QString TaskManager::title(TaskId id) const
 {
     const Entity* entity = this->findEntity(id);
@@ -144,48 +417,268 @@ void TaskManager::setTitle(TaskId id, const QString& title)
         entity->title = title;
 }
 
+std::vector<TaskId> TaskManager::taskIds() const
+{
+    std::lock_guard<std::mutex> lock(m_mutexPool);
+    std::vector<TaskId> vecId;
+    vecId.reserve(m_mapEntity.size());
+    for (const auto& mapPair : m_mapEntity)
+        vecId.push_back(mapPair.first);
+
+    return vecId;
+}
+
 TaskManager::Entity* TaskManager::findEntity(TaskId id)
 {
-    auto it = m_mapEntity.find(id);
-    return it != m_mapEntity.end() ? it->second.get() : nullptr;
+    std::lock_guard<std::mutex> lock(m_mutexPool);
+    return const_cast<Entity*>(this->findEntity_locked(id));
 }
 
 const TaskManager::Entity* TaskManager::findEntity(TaskId id) const
+{
+    std::lock_guard<std::mutex> lock(m_mutexPool);
+    return this->findEntity_locked(id);
+}
+
+// Must be called with m_mutexPool locked
+const TaskManager::Entity* TaskManager::findEntity_locked(TaskId id) const
 {
     auto it = m_mapEntity.find(id);
     return it != m_mapEntity.cend() ? it->second.get() : nullptr;
 }
 
+void TaskManager::notifyProgress(TaskProgress* progress, int valueOnEntry)
+{
+    const int value = progress->value();
+    m_progressAccum += value - valueOnEntry;
+
+    // Throttle notifications, tight loops in readers can report progress thousands times per second
+    const auto timeNow = std::chrono::steady_clock::now().time_since_epoch();
+    const int64_t timeNowNs = std::chrono::duration_cast<std::chrono::nanoseconds>(timeNow).count();
+    if (value != 0 && value != 100) {
+        const int64_t timeElapsedNs = timeNowNs - progress->m_timeLastNotifyNs;
+        if (timeElapsedNs < int64_t(m_progressNotifyInterval.load()) * 1000000)
+            return;
+    }
+
+    progress->m_timeLastNotifyNs = timeNowNs;
+    emit this->progressChanged(progress->taskId(), value);
+}
+
 void TaskManager::execEntity(Entity* entity)
 {
+    MAYO_PROFILE_ZONE("TaskManager::execEntity");
     if (!entity)
         return;
 
+    entity->taskProgress.resetStats();
     emit this->started(entity->task.id());
     const TaskJob& fn = entity->task.job();
-    fn(&entity->taskProgress);
+    try {
+        fn(&entity->taskProgress);
+    } catch (...) {
+        // Task is finished anyway(exception is then stored in the future of the task), otherwise
+        // waiting functions, continuations and dependent tasks would be blocked forever
+        emit this->ended(entity->task.id());
+        this->notifyFinished(entity);
+        throw;
+    }
+
     if (!entity->taskProgress.isAbortRequested())
         entity->taskProgress.setValue(100);
 
     emit this->ended(entity->task.id());
-    entity->isFinished = true;
+    this->notifyFinished(entity);
 }
 
-void TaskManager::cleanGarbage()
+void TaskManager::notifyFinished(Entity* entity)
 {
-    auto it = m_mapEntity.begin();
-    while (it != m_mapEntity.end()) {
-        Entity* entity = it->second.get();
-        if (entity->isFinished && entity->autoDestroy == TaskAutoDestroy::On) {
-            if (entity->control.valid())
-                entity->control.wait();
+    std::vector<std::function<void()>> vecContinuation;
+    bool hasDependentQueued = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutexPool);
+        entity->isFinished = true;
+        vecContinuation = std::move(entity->vecContinuation);
+        entity->vecContinuation.clear();
+        const bool isAborted = entity->taskProgress.isAbortRequested();
+        for (Entity* dependent : entity->vecDependent) {
+            if (isAborted)
+                dependent->taskProgress.requestAbort();
 
-            it = m_mapEntity.erase(it);
+            --(dependent->pendingDependencyCount);
+            if (dependent->pendingDependencyCount == 0 && dependent->isWaitingDependencies) {
+                dependent->isWaitingDependencies = false;
+                --m_waitingDependenciesCount;
+                this->enqueuePending(dependent);
+                hasDependentQueued = true;
+            }
         }
-        else {
-            ++it;
+
+        entity->vecDependent.clear();
+    }
+
+    m_condTaskFinished.notify_all();
+    if (hasDependentQueued)
+        m_condPool.notify_all();
+
+    for (const std::function<void()>& fn : vecContinuation)
+        fn();
+}
+
+// Must be called with m_mutexPool locked
+int TaskManager::findFinished(Span<const TaskId> ids) const
+{
+    for (auto it = ids.begin(); it != ids.end(); ++it) {
+        const Entity* entity = this->findEntity_locked(*it);
+        if (!entity || entity->isFinished)
+            return int(it - ids.begin());
+    }
+
+    return -1;
+}
+
+void TaskManager::cleanGarbage()
+{
+    // Finished entities are moved out of the map under lock, but destroyed once the lock is released
+    // as waiting for their completion might take a while(eg continuations still being executed)
+    std::vector<std::unique_ptr<Entity>> vecGarbage;
+    {
+        std::lock_guard<std::mutex> lock(m_mutexPool);
+        auto it = m_mapEntity.begin();
+        while (it != m_mapEntity.end()) {
+            Entity* entity = it->second.get();
+            if (entity->isFinished && entity->autoDestroy == TaskAutoDestroy::On) {
+                vecGarbage.push_back(std::move(it->second));
+                it = m_mapEntity.erase(it);
+            }
+            else {
+                ++it;
+            }
         }
     }
+
+    for (const std::unique_ptr<Entity>& entity : vecGarbage) {
+        if (entity->control.valid())
+            entity->control.wait();
+
+        m_progressAccum -= entity->taskProgress.value();
+    }
+}
+
+bool TaskManager::PendingEntity::operator<(const PendingEntity& other) const
+{
+    // std::priority_queue pops the "greatest" item first
+    if (this->priority != other.priority)
+        return this->priority < other.priority;
+    else
+        return this->seq > other.seq;
+}
+
+// Must be called with m_mutexPool locked
+void TaskManager::enqueuePending(Entity* entity)
+{
+    m_queuePending.push({ entity, entity->priority, m_pendingSeq++ });
+    this->startWorkerIfNeeded();
+}
+
+// Must be called with m_mutexPool locked
+bool TaskManager::canStartPending() const
+{
+    if (m_queuePending.empty())
+        return false;
+
+    if (m_runningCount < m_maxConcurrency)
+        return true;
+
+    // Interactive tasks don't wait for the completion of a running task, one extra thread is allowed
+    return m_queuePending.top().priority >= TaskPriority_Interactive
+            && m_runningCount < m_maxConcurrency + 1;
+}
+
+// Must be called with m_mutexPool locked
+void TaskManager::startWorkerIfNeeded()
+{
+    const bool isInteractivePending =
+            !m_queuePending.empty() && m_queuePending.top().priority >= TaskPriority_Interactive;
+    const int maxWorkerCount = m_maxConcurrency + (isInteractivePending ? 1 : 0);
+    const int workerCount = int(m_vecWorker.size());
+    if (m_idleWorkerCount == 0 && workerCount < maxWorkerCount)
+        this->startWorker();
+}
+
+// Must be called with m_mutexPool locked
+void TaskManager::startWorker()
+{
+    const int workerIndex = int(m_vecWorker.size());
+    const bool isNumaMachine = CpuTopology::numaNodeCount() > 1;
+    switch (m_workerPlacement) {
+    case WorkerPlacement::None: {
+        const int node = isNumaMachine ? CpuTopology::currentThreadNumaNode() : -1;
+        m_vecWorker.emplace_back([=]{
+            if (node >= 0)
+                CpuTopology::bindCurrentThreadToNumaNode(node);
+
+            this->workerLoop(node);
+        });
+        break;
+    }
+    case WorkerPlacement::Cpu: {
+        const int cpuCount = std::max(1, int(std::thread::hardware_concurrency()));
+        m_vecWorker.emplace_back([=]{
+            CpuTopology::bindCurrentThreadToCpu(workerIndex % cpuCount);
+            this->workerLoop(isNumaMachine ? CpuTopology::currentThreadNumaNode() : -1);
+        });
+        break;
+    }
+    case WorkerPlacement::NumaNode: {
+        const int node = workerIndex % CpuTopology::numaNodeCount();
+        m_vecWorker.emplace_back([=]{
+            const bool isBound = isNumaMachine && CpuTopology::bindCurrentThreadToNumaNode(node);
+            this->workerLoop(isBound ? node : -1);
+        });
+        break;
+    }
+    }
+}
+
+void TaskManager::workerLoop(int workerNumaNode)
+{
+    std::unique_lock<std::mutex> lock(m_mutexPool);
+    while (true) {
+        ++m_idleWorkerCount;
+        m_condPool.wait(lock, [=]{ return m_isPoolStopping || this->canStartPending(); });
+        --m_idleWorkerCount;
+        if (m_queuePending.empty())
+            return; // Stop requested
+
+        Entity* entity = m_queuePending.top().entity;
+        m_queuePending.pop();
+        ++m_runningCount;
+        const bool isNumaPlacement = m_workerPlacement == WorkerPlacement::NumaNode;
+        lock.unlock();
+
+        // Move to the NUMA node requested by the task, back to the node of the worker afterwards
+        const int taskNumaNode = isNumaPlacement ? entity->numaNode.load() : -1;
+        const bool isNodeChanged =
+                taskNumaNode >= 0
+                && workerNumaNode >= 0
+                && taskNumaNode != workerNumaNode
+                && CpuTopology::bindCurrentThreadToNumaNode(taskNumaNode);
+        try {
+            this->execEntity(entity);
+            entity->promise.set_value();
+        } catch (...) {
+            entity->promise.set_exception(std::current_exception());
+        }
+
+        if (isNodeChanged)
+            CpuTopology::bindCurrentThreadToNumaNode(workerNumaNode);
+
+        lock.lock();
+        --m_runningCount;
+        if (!m_queuePending.empty())
+            m_condPool.notify_one();
+    }
 }
 
 } // namespace Mayo
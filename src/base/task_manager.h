@@ -6,14 +6,21 @@
 
 #pragma once
 
+#include "span.h"
 #include "task.h"
 #include "task_progress.h"
+#include "task_stats.h"
 
 #include <QtCore/QObject>
 #include <atomic>
+#include <condition_variable>
 #include <future>
 #include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 namespace Mayo {
 
@@ -24,23 +31,92 @@ public:
     ~TaskManager();
     static TaskManager* globalInstance();
 
-    TaskId newTask(TaskJob fn);
+    TaskId newTask(TaskJob fn, int priority = TaskPriority_Normal);
+    // Queued in worker pool, once all dependencies of the task are finished
     void run(TaskId id, TaskAutoDestroy policy = TaskAutoDestroy::On);
-    void exec(TaskId id, TaskAutoDestroy policy = TaskAutoDestroy::On); // Synchronous
+    // Synchronous, blocks first until all dependencies of the task are finished
+    void exec(TaskId id, TaskAutoDestroy policy = TaskAutoDestroy::On);
+
+    // Task 'id' won't be started before task 'dependencyId' is finished, to be called before run()
+    // Has no effect if 'dependencyId' is already finished. Abort of the dependency is propagated
+    // to task 'id', which is still executed(eg to release resources) but sees the abort request
+    // NOTE 'dependencyId' has to be run, otherwise task 'id' is never started
+    void addDependency(TaskId id, TaskId dependencyId);
+    // Creates task executing 'fn' once all tasks 'dependencies' are finished(continuation)
+    TaskId newTaskAfter(Span<const TaskId> dependencies, TaskJob fn, int priority = TaskPriority_Normal);
+
+    // Maximum count of tasks executed concurrently by run()
+    // Defaults to the number of hardware threads
+    int maxConcurrency() const;
+    void setMaxConcurrency(int count);
+
+    // Placement of the worker threads of run() on the CPUs of the machine
+    //     None: threads are scheduled by the OS. Workers are bound to the NUMA node of the thread
+    //           creating them if that one is bound to a node(eg worker of another TaskManager)
+    //     Cpu: each worker is bound to a distinct CPU
+    //     NumaNode: workers are spread round-robin across NUMA nodes and bound to the CPUs of
+    //               their node, so memory allocated by tasks(first-touch policy) is node-local
+    // To be set before tasks are run, workers already started are not moved
+    enum class WorkerPlacement { None, Cpu, NumaNode };
+    WorkerPlacement workerPlacement() const;
+    void setWorkerPlacement(WorkerPlacement placement);
+
+    // NUMA node where task 'id' has to be executed, -1(the default) if no preference
+    // The worker executing the task binds itself to 'node' for the duration of the task, so all the
+    // work of eg a single file(and child tasks, see WorkerPlacement::None) stays on the node
+    int numaNode(TaskId id) const;
+    void setNumaNode(TaskId id, int node);
+
+    // Count of tasks submitted with run() but not started yet, including the ones waiting for
+    // their dependencies
+    int pendingTaskCount() const;
+
+    // Among pending tasks, the ones with highest priority are started first
+    int priority(TaskId id) const;
+    void setPriority(TaskId id, int priority);
 
     int progress(TaskId id) const;
     int globalProgress() const;
 
+    // Statistics of task 'id' at the time of the call, can be called from any thread while the task
+    // is running. Typically sampled by a timer and fed into TaskStatsHistory
+    TaskStats stats(TaskId id) const;
+
+    // Minimum time interval between two progressChanged() signals emitted for a task
+    // Intermediate progress values might be skipped, but 0 and 100 are always notified
+    int progressNotifyInterval() const { return m_progressNotifyInterval; }
+    void setProgressNotifyInterval(int msecs) { m_progressNotifyInterval = msecs; }
+
     QString title(TaskId id) const;
     void setTitle(TaskId id, const QString& title);
 
     bool waitForDone(TaskId id, int msecs = -1);
+
+    // Blocks until all tasks are finished or timeout 'msecs' expired(no timeout if msecs < 0)
+    bool waitForAll(Span<const TaskId> ids, int msecs = -1);
+    // Blocks until any of the tasks is finished, returns its index in 'ids' or -1 on timeout
+    // Tasks already finished are also considered, callers should remove them from 'ids'
+    int waitForAny(Span<const TaskId> ids, int msecs = -1);
+    // Registers callback called once task 'id' is finished(called from the thread executing the task)
+    // The callback is called immediately if task is already finished
+    void whenDone(TaskId id, std::function<void()> fn);
+
     void requestAbort(TaskId id);
 
+    // Executes fnTask(index, taskProgress) for each index in [0, taskCount[ concurrently, progress
+    // of each task being a portion of 'progress'
+    // Tasks are executed by the calling thread and by a worker pool shared by all calls, bounded to
+    // hardware concurrency whatever the count of callers(eg tasks of another TaskManager)
+    // Blocks until all tasks are finished, abort request on 'progress' is propagated to the tasks
+    // Returns false if abort was requested
+    static bool runConcurrently(
+            int taskCount, TaskProgress* progress, const std::function<void(int, TaskProgress*)>& fnTask);
+
+    // Calls fn(id) for each task, 'fn' can call any function of TaskManager
     template<typename FUNCTION>
     void foreachTask(FUNCTION fn) {
-        for (const auto& mapPair : m_mapEntity)
-            fn(mapPair.first);
+        for (TaskId id : this->taskIds())
+            fn(id);
     }
 
 signals:
@@ -55,18 +131,66 @@ private:
         Task task;
         TaskProgress taskProgress;
         QString title;
+        std::promise<void> promise;
         std::future<void> control;
         std::atomic<bool> isFinished = false;
         TaskAutoDestroy autoDestroy = TaskAutoDestroy::On;
+        std::atomic<int> priority = 0;
+        std::atomic<int> numaNode = -1;
+        std::vector<std::function<void()>> vecContinuation;
+        // Dependency graph, guarded by m_mutexPool
+        std::vector<Entity*> vecDependent;
+        int pendingDependencyCount = 0;
+        bool isWaitingDependencies = false; // run() called while dependencies are pending
     };
 
+    struct PendingEntity {
+        Entity* entity;
+        int priority;
+        uint64_t seq; // Submission order, FIFO among tasks of same priority
+        bool operator<(const PendingEntity& other) const;
+    };
+
+    friend class TaskProgress;
+    void notifyProgress(TaskProgress* progress, int valueOnEntry);
+
+    std::vector<TaskId> taskIds() const;
+
     Entity* findEntity(TaskId id);
     const Entity* findEntity(TaskId id) const;
+    const Entity* findEntity_locked(TaskId id) const;
     void execEntity(Entity* entity);
     void cleanGarbage();
 
+    void notifyFinished(Entity* entity);
+    int findFinished(Span<const TaskId> ids) const;
+
+    void enqueuePending(Entity* entity);
+    bool canStartPending() const;
+    void startWorkerIfNeeded();
+    void startWorker();
+    void workerLoop(int workerNumaNode);
+
     std::atomic<TaskId> m_taskIdSeq = {};
+    // Guarded by m_mutexPool, so tasks can be created, waited for and destroyed from distinct threads
+    // Entities themselves are stable in memory until destroyed by cleanGarbage()
     std::unordered_map<TaskId, std::unique_ptr<Entity>> m_mapEntity;
+    std::atomic<int> m_progressAccum = 0; // Sum of the progress values of all tasks
+    std::atomic<int> m_progressNotifyInterval = 20;
+
+    // Worker pool
+    mutable std::mutex m_mutexPool;
+    std::condition_variable m_condPool;
+    std::condition_variable m_condTaskFinished;
+    std::priority_queue<PendingEntity> m_queuePending;
+    std::vector<std::thread> m_vecWorker;
+    uint64_t m_pendingSeq = 0;
+    int m_maxConcurrency = 1;
+    int m_runningCount = 0;
+    int m_waitingDependenciesCount = 0;
+    int m_idleWorkerCount = 0;
+    WorkerPlacement m_workerPlacement = WorkerPlacement::None;
+    bool m_isPoolStopping = false;
 };
 
 } // namespace Mayo
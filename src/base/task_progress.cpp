@@ -48,33 +48,88 @@ void TaskProgress::setValue(int pct)
     if (m_isAbortRequested)
         return;
 
-    const int valueOnEntry = m_value;
-    m_value = std::clamp(pct, 0, 100);
-    if (m_value != 0 && m_value == valueOnEntry)
+    const int newValue = std::clamp(pct, 0, 100);
+    const int valueOnEntry = m_value.exchange(newValue);
+    this->notifyValueChanged(valueOnEntry, newValue);
+}
+
+void TaskProgress::addValue(int delta)
+{
+    if (m_isAbortRequested)
+        return;
+
+    int valueOnEntry = m_value.load();
+    int newValue = 0;
+    do {
+        newValue = std::clamp(valueOnEntry + delta, 0, 100);
+    } while (!m_value.compare_exchange_weak(valueOnEntry, newValue));
+
+    this->notifyValueChanged(valueOnEntry, newValue);
+}
+
+void TaskProgress::notifyValueChanged(int valueOnEntry, int newValue)
+{
+    if (newValue != 0 && newValue == valueOnEntry)
         return;
 
     if (m_parent) {
-        const int valueDeltaInParent = std::ceil((m_value - valueOnEntry) * (m_portionSize / 100.));
-        m_parent->setValue(m_parent->value() + valueDeltaInParent);
+        const int valueDeltaInParent = std::ceil((newValue - valueOnEntry) * (m_portionSize / 100.));
+        m_parent->addValue(valueDeltaInParent);
     }
     else {
         if (m_task)
-            emit m_task->manager()->progressChanged(m_task->id(), m_value);
+            m_task->manager()->notifyProgress(this, valueOnEntry);
     }
 }
 
+namespace {
+
+int64_t steadyTimeNs()
+{
+    const auto timeNow = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(timeNow).count();
+}
+
+} // namespace
+
 void TaskProgress::setStep(const QString& title)
 {
     m_step = title;
+    this->root()->m_timeStepStartNs = steadyTimeNs();
     if (m_task)
         emit m_task->manager()->progressStep(m_task->id(), title);
 }
 
+void TaskProgress::addProcessedBytes(uint64_t count)
+{
+    this->root()->m_processedBytes += count;
+}
+
+void TaskProgress::addProcessedEntities(uint64_t count)
+{
+    this->root()->m_processedEntities += count;
+}
+
+uint64_t TaskProgress::processedBytes() const
+{
+    return this->root()->m_processedBytes;
+}
+
+uint64_t TaskProgress::processedEntities() const
+{
+    return this->root()->m_processedEntities;
+}
+
 void TaskProgress::setTask(const Task* task)
 {
     m_task = task;
 }
 
+bool TaskProgress::isAbortRequested() const
+{
+    return m_isAbortRequested || (m_parent && m_parent->isAbortRequested());
+}
+
 bool TaskProgress::isAbortRequested(const TaskProgress* progress)
 {
     return progress ? progress->isAbortRequested() : false;
@@ -85,4 +140,31 @@ void TaskProgress::requestAbort()
     m_isAbortRequested = true;
 }
 
+void TaskProgress::resetStats()
+{
+    const int64_t timeNowNs = steadyTimeNs();
+    m_processedBytes = 0;
+    m_processedEntities = 0;
+    m_timeStartNs = timeNowNs;
+    m_timeStepStartNs = timeNowNs;
+}
+
+TaskProgress* TaskProgress::root()
+{
+    TaskProgress* progress = this;
+    while (progress->m_parent)
+        progress = progress->m_parent;
+
+    return progress;
+}
+
+const TaskProgress* TaskProgress::root() const
+{
+    const TaskProgress* progress = this;
+    while (progress->m_parent)
+        progress = progress->m_parent;
+
+    return progress;
+}
+
 } // namespace Mayo
@@ -8,7 +8,10 @@
 
 #include "task_common.h"
 #include <QtCore/QString>
+#include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <cstdint>
 
 namespace Mayo {
 
@@ -31,13 +34,34 @@ public:
     const QString& step() const { return m_step; }
     void setStep(const QString& title);
 
-    bool isRoot() const { return m_parent != nullptr; }
+    // Amounts of work processed(eg bytes read or written, entities transferred), accumulated into
+    // the root progress so throughput can be sampled from another thread(see TaskManager::stats())
+    void addProcessedBytes(uint64_t count);
+    void addProcessedEntities(uint64_t count);
+    uint64_t processedBytes() const;
+    uint64_t processedEntities() const;
+
+    bool isRoot() const { return m_parent == nullptr; }
     const TaskProgress* parent() const { return m_parent; }
     TaskProgress* parent() { return m_parent; }
 
-    bool isAbortRequested() const { return m_isAbortRequested; }
+    // Abort is requested on the root progress of a task(see TaskManager::requestAbort()), children
+    // progress objects inherit it
+    bool isAbortRequested() const;
     static bool isAbortRequested(const TaskProgress* progress);
 
+    // Helper to report progress of a loop over [first, last[ every 'step' iterations, 'i' being the
+    // current iteration. Returns false on abort request. 'progress' can be null
+    // Inline as it's typically called for each item of big meshes
+    static bool checkLoopProgress(TaskProgress* progress, int64_t i, int64_t first, int64_t last) {
+        constexpr int64_t step = 1 << 16;
+        if (!progress || (i - first) % step != 0)
+            return true;
+
+        progress->setValue(int((100 * (i - first)) / std::max<int64_t>(1, last - first)));
+        return !progress->isAbortRequested();
+    }
+
     // Disable copy
     TaskProgress(const TaskProgress&) = delete;
     TaskProgress(TaskProgress&&) = delete;
@@ -45,8 +69,15 @@ public:
     TaskProgress& operator=(TaskProgress&&) = delete;
 
 private:
+    // Children of a progress can be updated from distinct threads(eg TaskManager::runConcurrently())
+    // so their contributions are added atomically
+    void addValue(int delta);
+    void notifyValueChanged(int valueOnEntry, int newValue);
     void setTask(const Task* task);
     void requestAbort();
+    void resetStats(); // To be called on the root progress when the task is started
+    TaskProgress* root();
+    const TaskProgress* root() const;
 
     friend class TaskManager;
 
@@ -55,7 +86,13 @@ private:
     double m_portionSize = -1;
     std::atomic<int> m_value = 0;
     QString m_step;
-    bool m_isAbortRequested = false;
+    std::atomic<bool> m_isAbortRequested = false;
+    std::atomic<int64_t> m_timeLastNotifyNs = 0; // Used only by root progress, steady_clock duration
+    // Statistics, used only by root progress. Times are steady_clock durations since epoch
+    std::atomic<uint64_t> m_processedBytes = 0;
+    std::atomic<uint64_t> m_processedEntities = 0;
+    std::atomic<int64_t> m_timeStartNs = 0;
+    std::atomic<int64_t> m_timeStepStartNs = 0;
 };
 
 } // namespace Mayo
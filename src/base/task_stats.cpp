@@ -0,0 +1,94 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "task_stats.h"
+
+#include <cmath>
+
+namespace Mayo {
+
+TaskStatsHistory::TaskStatsHistory(int64_t windowMs)
+    : m_windowMs(windowMs)
+{
+}
+
+void TaskStatsHistory::addSample(const TaskStats& stats)
+{
+    // Task was restarted
+    if (!m_deqSample.empty() && stats.elapsedMs < m_deqSample.back().elapsedMs)
+        m_deqSample.clear();
+
+    m_deqSample.push_back(stats);
+    // Keep at least two samples so rates can still be computed with sparse sampling
+    while (m_deqSample.size() > 2 && (stats.elapsedMs - m_deqSample.front().elapsedMs) > m_windowMs)
+        m_deqSample.pop_front();
+}
+
+void TaskStatsHistory::clear()
+{
+    m_deqSample.clear();
+}
+
+TaskStats TaskStatsHistory::lastSample() const
+{
+    return !m_deqSample.empty() ? m_deqSample.back() : TaskStats{};
+}
+
+double TaskStatsHistory::bytesPerSecond() const
+{
+    if (m_deqSample.size() < 2)
+        return 0;
+
+    const TaskStats& first = m_deqSample.front();
+    const TaskStats& last = m_deqSample.back();
+    const int64_t durationMs = last.elapsedMs - first.elapsedMs;
+    if (durationMs <= 0)
+        return 0;
+
+    return (1000. * (last.processedBytes - first.processedBytes)) / durationMs;
+}
+
+double TaskStatsHistory::entitiesPerSecond() const
+{
+    if (m_deqSample.size() < 2)
+        return 0;
+
+    const TaskStats& first = m_deqSample.front();
+    const TaskStats& last = m_deqSample.back();
+    const int64_t durationMs = last.elapsedMs - first.elapsedMs;
+    if (durationMs <= 0)
+        return 0;
+
+    return (1000. * (last.processedEntities - first.processedEntities)) / durationMs;
+}
+
+int64_t TaskStatsHistory::remainingMs() const
+{
+    if (m_deqSample.empty())
+        return -1;
+
+    const TaskStats& last = m_deqSample.back();
+    if (last.progress >= 100)
+        return 0;
+
+    // Progress rate over the window, fallback to the average rate since start of the task if no
+    // progress was made within the window
+    const TaskStats& first = m_deqSample.front();
+    const int progressDelta = last.progress - first.progress;
+    const int64_t durationMs = last.elapsedMs - first.elapsedMs;
+    double msPerPercent = -1;
+    if (progressDelta > 0 && durationMs > 0)
+        msPerPercent = double(durationMs) / progressDelta;
+    else if (last.progress > 0)
+        msPerPercent = double(last.elapsedMs) / last.progress;
+
+    if (msPerPercent < 0)
+        return -1;
+
+    return std::llround(msPerPercent * (100 - last.progress));
+}
+
+} // namespace Mayo
@@ -0,0 +1,48 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+
+namespace Mayo {
+
+// Snapshot of the statistics of a task(see TaskManager::stats()), collected from atomic counters so
+// it's cheap to sample periodically eg from a timer
+struct TaskStats {
+    int progress = 0; // In [0,100]
+    int64_t elapsedMs = 0; // Since the task was started
+    int64_t stepElapsedMs = 0; // Since last call to TaskProgress::setStep()
+    uint64_t processedBytes = 0;
+    uint64_t processedEntities = 0;
+};
+
+// Throughput and remaining time of a task extrapolated from a history of TaskStats samples
+// Samples older than 'windowMs' are discarded, so estimations follow the recent speed of the task
+class TaskStatsHistory {
+public:
+    TaskStatsHistory(int64_t windowMs = 10000);
+
+    void addSample(const TaskStats& stats);
+    void clear();
+    bool isEmpty() const { return m_deqSample.empty(); }
+
+    // Most recent sample, default TaskStats if history is empty
+    TaskStats lastSample() const;
+
+    double bytesPerSecond() const;
+    double entitiesPerSecond() const;
+
+    // Estimated time before the task is finished, -1 if unknown(eg no progress made yet)
+    int64_t remainingMs() const;
+
+private:
+    std::deque<TaskStats> m_deqSample;
+    int64_t m_windowMs = 0;
+};
+
+} // namespace Mayo
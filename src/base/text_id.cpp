@@ -8,12 +8,96 @@
 
 #include <QtCore/QCoreApplication>
 #include <cstring>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
 
 namespace Mayo {
 
+namespace {
+
+// Translations of TextId objects, keyed by the addresses of their bytes. Those are string literals
+// most of the time(see MAYO_TEXT_ID and textId() functions), so keys are stable and cheap to hash
+// Addresses of other strings might be reused once released, hence the contents checked on lookup
+class TrCache {
+public:
+    bool find(const TextId& textId, QString* text) const {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        auto it = m_mapEntry.find(TrCache::entryKey(textId));
+        if (it == m_mapEntry.cend())
+            return false;
+
+        const Entry& entry = it->second;
+        if (entry.key != textId.key || entry.trContext != textId.trContext)
+            return false;
+
+        *text = entry.text;
+        return true;
+    }
+
+    void insert(const TextId& textId, const QString& text) {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        // Bounds memory in case of TextId objects created dynamically
+        if (m_mapEntry.size() >= TrCache_maxEntryCount)
+            m_mapEntry.clear();
+
+        // Deep copies, bytes of 'textId' might be raw data not owned
+        Entry entry;
+        entry.trContext = QByteArray(textId.trContext.constData(), textId.trContext.size());
+        entry.key = QByteArray(textId.key.constData(), textId.key.size());
+        entry.text = text;
+        m_mapEntry.insert_or_assign(TrCache::entryKey(textId), std::move(entry));
+    }
+
+    void clear() {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        m_mapEntry.clear();
+    }
+
+private:
+    static constexpr size_t TrCache_maxEntryCount = 16384;
+
+    using EntryKey = std::pair<const char*, const char*>;
+    struct EntryKeyHash {
+        size_t operator()(const EntryKey& key) const {
+            const size_t h1 = std::hash<const char*>{}(key.first);
+            const size_t h2 = std::hash<const char*>{}(key.second);
+            return h1 ^ (h2 + 0x9e3779b9 + (h1 << 6) + (h1 >> 2));
+        }
+    };
+
+    struct Entry {
+        QByteArray trContext;
+        QByteArray key;
+        QString text;
+    };
+
+    static EntryKey entryKey(const TextId& textId) {
+        return { textId.trContext.constData(), textId.key.constData() };
+    }
+
+    std::unordered_map<EntryKey, Entry, EntryKeyHash> m_mapEntry;
+    mutable std::shared_mutex m_mutex;
+};
+
+TrCache& trCache()
+{
+    static TrCache cache;
+    return cache;
+}
+
+} // namespace
+
 QString TextId::tr() const
 {
-    return QCoreApplication::translate(this->trContext.data(), this->key.data());
+    QString text;
+    if (trCache().find(*this, &text))
+        return text;
+
+    text = QCoreApplication::translate(this->trContext.data(), this->key.data());
+    trCache().insert(*this, text);
+    return text;
 }
 
 bool TextId::isEmpty() const
@@ -21,4 +105,9 @@ bool TextId::isEmpty() const
     return this->key.isEmpty();
 }
 
+void TextId::invalidateTrCache()
+{
+    trCache().clear();
+}
+
 } // namespace Mayo
@@ -30,8 +30,13 @@ struct TextId {
     QByteArray trContext;
     QByteArray key;
 
+    // Translations are cached, so building huge trees or emitting frequent progress steps don't
+    // pay translator lookups repeatedly. Can be called concurrently from any thread
     QString tr() const;
     bool isEmpty() const;
+
+    // To be called when the language changes(ie a translator is installed or removed)
+    static void invalidateTrCache();
 };
 
 } // namespace Mayo
@@ -0,0 +1,57 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "text_number.h"
+
+#include <charconv>
+#include <iomanip>
+#include <iterator>
+#include <locale>
+#include <sstream>
+
+namespace Mayo {
+
+void TextNumber::append(std::string* str, double value, Format format, int precision)
+{
+#if __cpp_lib_to_chars
+    char buff[128];
+    std::to_chars_result res;
+    switch (format) {
+    case Format::Shortest:
+        res = std::to_chars(std::begin(buff), std::end(buff), value);
+        break;
+    case Format::General:
+        res = std::to_chars(std::begin(buff), std::end(buff), value, std::chars_format::general, precision);
+        break;
+    case Format::Fixed:
+        res = std::to_chars(std::begin(buff), std::end(buff), value, std::chars_format::fixed, precision);
+        break;
+    case Format::Scientific:
+        res = std::to_chars(std::begin(buff), std::end(buff), value, std::chars_format::scientific, precision);
+        break;
+    }
+
+    if (res.ec == std::errc()) {
+        str->append(buff, res.ptr - buff);
+        return;
+    }
+#endif
+
+    // Floating-point std::to_chars() not available or buffer too small(eg huge value in fixed format)
+    std::ostringstream sstr;
+    sstr.imbue(std::locale::classic());
+    switch (format) {
+    case Format::Shortest: sstr << std::setprecision(17); break;
+    case Format::General: sstr << std::setprecision(precision); break;
+    case Format::Fixed: sstr << std::fixed << std::setprecision(precision); break;
+    case Format::Scientific: sstr << std::scientific << std::setprecision(precision); break;
+    }
+
+    sstr << value;
+    str->append(sstr.str());
+}
+
+} // namespace Mayo
@@ -0,0 +1,29 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include <string>
+
+namespace Mayo {
+
+// Text representation of floating-point numbers for the writers of text file formats
+// Decimal separator is always '.' whatever the C locale, unlike printf() functions(on Unix the
+// locale of the environment is set by QApplication, eg "1,5" under fr_FR)
+namespace TextNumber {
+
+enum class Format {
+    Shortest, // Shortest representation that reads back to the same double, precision is ignored
+    General, // Like printf() "%.*g", precision is the count of significant digits
+    Fixed, // Like printf() "%.*f", precision is the count of digits after decimal point
+    Scientific // Like printf() "%.*e", precision is the count of digits after decimal point
+};
+
+void append(std::string* str, double value, Format format = Format::Shortest, int precision = 0);
+
+} // namespace TextNumber
+
+} // namespace Mayo
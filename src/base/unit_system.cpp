@@ -8,6 +8,7 @@
 
 #include <fast_float/fast_float.h>
 #include <QtCore/QtGlobal>
+#include <algorithm>
 
 namespace Mayo {
 
@@ -87,7 +88,7 @@ const UnitInfo arrayUnitInfo_ImperialUK[] = {
     { Unit::Length, "yd", 914.4 },
     { Unit::Length, "mi", 1609344 },
     // Others
-    { Unit::Area, "in²", 654.16 },
+    { Unit::Area, "in²", 645.16 },
     { Unit::Volume, "in³", 16387.064 },
     { Unit::Velocity, "in/min", 25.4 / 60. }
 };
@@ -118,7 +119,7 @@ static UnitSystem::TranslateResult translateImperialUK(double value, Unit unit)
     case Unit::Length:
         return { value / 25.4, "in", 25.4 };
     case Unit::Area:
-        return { value / 645.16, "in²", 654.16 };
+        return { value / 645.16, "in²", 645.16 };
     case Unit::Volume:
         return { value / 16387.064, "in³", 16387.064 };
     case Unit::Velocity:
@@ -236,6 +237,36 @@ UnitSystem::TranslateResult UnitSystem::translate(Schema schema, double value, U
     return {};
 }
 
+UnitSystem::Conversion UnitSystem::conversion(Schema schema, Unit unit)
+{
+    const TranslateResult res = UnitSystem::translate(schema, 1., unit);
+    return { res.strUnit, res.factor, 1. / res.factor };
+}
+
+void UnitSystem::translate(const Conversion& conv, Span<double> values)
+{
+    UnitSystem::translate(conv, values, values);
+}
+
+void UnitSystem::translate(const Conversion& conv, Span<const double> values, Span<double> results)
+{
+    Expects(results.size() >= values.size());
+    if (conv.invFactor == 1.) {
+        if (results.data() != values.data())
+            std::copy(values.begin(), values.end(), results.begin());
+
+        return;
+    }
+
+    // Plain loop over raw arrays, so it's auto-vectorized by the compiler
+    const double invFactor = conv.invFactor;
+    const double* in = values.data();
+    double* out = results.data();
+    const size_t count = values.size();
+    for (size_t i = 0; i < count; ++i)
+        out[i] = in[i] * invFactor;
+}
+
 UnitSystem::TranslateResult UnitSystem::parseQuantity(std::string_view strQuantity, Unit* ptrUnit)
 {
     auto fnAssignUnit = [=](Unit unit) {
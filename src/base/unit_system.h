@@ -7,6 +7,7 @@
 #pragma once
 
 #include "quantity.h"
+#include "span.h"
 #include <string_view>
 
 namespace Mayo {
@@ -30,6 +31,24 @@ public:
         return UnitSystem::translate(schema, qty.value(), UNIT);
     }
     static TranslateResult translate(Schema schema, double value, Unit unit);
+
+    // Conversion from internal unit(eg mm for lengths) to the unit of a schema, established once
+    // for bulk conversions(tables of coordinates, areas, volumes, ...)
+    struct Conversion {
+        const char* strUnit; // UTF8
+        double factor; // Internal value = converted value * factor
+        double invFactor;
+        constexpr double apply(double value) const { return value * this->invFactor; }
+    };
+
+    static Conversion conversion(Schema schema, Unit unit);
+    // Converts 'values' in place, schema isn't looked up per value
+    // Note: values are multiplied by the inverse factor, results may differ from translate() on the
+    //       last bit
+    static void translate(const Conversion& conv, Span<double> values);
+    // Converts 'values' into 'results', which must be at least as large as 'values'
+    static void translate(const Conversion& conv, Span<const double> values, Span<double> results);
+
     static TranslateResult parseQuantity(std::string_view strQuantity, Unit* ptrUnit = nullptr);
 
     static TranslateResult radians(QuantityAngle angle);
@@ -5,6 +5,7 @@
 ****************************************************************************/
 
 #include "xcaf.h"
+#include "caf_utils.h"
 
 #include <TDocStd_Document.hxx>
 #include <TDF_AttributeIterator.hxx>
@@ -12,7 +13,9 @@
 #include <XCAFDoc_Centroid.hxx>
 #include <XCAFDoc_DocumentTool.hxx>
 #include <XCAFDoc_Volume.hxx>
+#include <functional>
 #include <set>
+#include <unordered_set>
 
 namespace Mayo {
 
@@ -197,6 +200,34 @@ TDF_Label XCaf::shapeReferred(const TDF_Label& lbl)
     return referred;
 }
 
+TDF_LabelSequence XCaf::shapePrototypes(const TDF_Label& lbl, int* ptrReferenceCount)
+{
+    TDF_LabelSequence seqPrototype;
+    std::unordered_set<TDF_Label> setVisited;
+    int referenceCount = 0;
+    std::function<void(const TDF_Label&)> fnVisit = [&](const TDF_Label& label) {
+        if (XCaf::isShapeReference(label)) {
+            ++referenceCount;
+            fnVisit(XCaf::shapeReferred(label));
+        }
+        else if (setVisited.insert(label).second) {
+            if (XCaf::isShapeAssembly(label)) {
+                for (const TDF_Label& child : XCaf::shapeComponents(label))
+                    fnVisit(child);
+            }
+            else if (XCaf::isShape(label)) {
+                seqPrototype.Append(label);
+            }
+        }
+    };
+    fnVisit(lbl);
+
+    if (ptrReferenceCount)
+        *ptrReferenceCount = referenceCount;
+
+    return seqPrototype;
+}
+
 TDF_LabelSequence XCaf::layers(const TDF_Label& lbl) const
 {
     TDF_LabelSequence seq;
@@ -220,7 +251,47 @@ TCollection_ExtendedString XCaf::layerName(const TDF_Label &lbl) const
 TopLoc_Location XCaf::shapeAbsoluteLocation(TreeNodeId nodeId) const
 {
     Expects(m_modelTree != nullptr);
-    return XCaf::shapeAbsoluteLocation(*m_modelTree, nodeId);
+    const Tree<TDF_Label>& modelTree = *m_modelTree;
+    if (nodeId == 0 || modelTree.nodeData(nodeId).IsNull())
+        return {};
+
+    std::lock_guard<std::mutex> lock(m_mutexNodeAbsoluteLocation);
+    if (nodeId <= m_vecNodeAbsoluteLocation.size()) {
+        const NodeAbsoluteLocation& nodeLoc = m_vecNodeAbsoluteLocation.at(nodeId - 1);
+        if (nodeLoc.isCached)
+            return nodeLoc.location;
+    }
+
+    // Compute locations of the whole entity, parent nodes are visited before their children
+    const TreeNodeId entityId = modelTree.nodeRoot(nodeId);
+    traverseTree_preOrder(entityId, modelTree, [&](TreeNodeId id) {
+        if (id > m_vecNodeAbsoluteLocation.size())
+            m_vecNodeAbsoluteLocation.resize(id);
+
+        const TopLoc_Location refLoc = XCaf::shapeReferenceLocation(modelTree.nodeData(id));
+        const TreeNodeId parentId = modelTree.nodeParent(id);
+        NodeAbsoluteLocation& nodeLoc = m_vecNodeAbsoluteLocation.at(id - 1);
+        nodeLoc.location = parentId != 0 ? m_vecNodeAbsoluteLocation.at(parentId - 1).location * refLoc : refLoc;
+        nodeLoc.isCached = true;
+    });
+
+    return m_vecNodeAbsoluteLocation.at(nodeId - 1).location;
+}
+
+void XCaf::invalidateShapeAbsoluteLocations()
+{
+    std::lock_guard<std::mutex> lock(m_mutexNodeAbsoluteLocation);
+    m_vecNodeAbsoluteLocation.clear();
+}
+
+void XCaf::invalidateShapeAbsoluteLocations(TreeNodeId entityId)
+{
+    Expects(m_modelTree != nullptr);
+    std::lock_guard<std::mutex> lock(m_mutexNodeAbsoluteLocation);
+    traverseTree_preOrder(entityId, *m_modelTree, [&](TreeNodeId id) {
+        if (id <= m_vecNodeAbsoluteLocation.size())
+            m_vecNodeAbsoluteLocation.at(id - 1) = {};
+    });
 }
 
 TopLoc_Location XCaf::shapeAbsoluteLocation(const Tree<TDF_Label>& modelTree, TreeNodeId nodeId)
@@ -310,4 +381,38 @@ TreeNodeId XCaf::deepBuildAssemblyTree(TreeNodeId parentNode, const TDF_Label& l
     return node;
 }
 
+std::vector<XCaf::AssemblyTreeItem> XCaf::collectAssemblyTree(const TDF_Label& label)
+{
+    std::vector<AssemblyTreeItem> vecItem;
+    std::function<void(const TDF_Label&, int)> fnCollect;
+    fnCollect = [&](const TDF_Label& itemLabel, int parentIndex) {
+        const int index = int(vecItem.size());
+        vecItem.push_back({ itemLabel, parentIndex });
+        if (XCaf::isShapeAssembly(itemLabel)) {
+            for (const TDF_Label& child : XCaf::shapeComponents(itemLabel))
+                fnCollect(child, index);
+        }
+        else if (XCaf::isShapeReference(itemLabel)) {
+            fnCollect(XCaf::shapeReferred(itemLabel), index);
+        }
+    };
+    fnCollect(label, -1);
+    return vecItem;
+}
+
+TreeNodeId XCaf::appendAssemblyTree(TreeNodeId parentNode, Span<const AssemblyTreeItem> spanItem)
+{
+    Expects(m_modelTree != nullptr);
+
+    // Items are in pre-order, so the parent of an item is already appended
+    std::vector<TreeNodeId> vecNodeId(spanItem.size());
+    for (size_t i = 0; i < spanItem.size(); ++i) {
+        const AssemblyTreeItem& item = spanItem[i];
+        const TreeNodeId parentId = item.parentIndex >= 0 ? vecNodeId.at(item.parentIndex) : parentNode;
+        vecNodeId.at(i) = m_modelTree->appendChild(parentId, item.label);
+    }
+
+    return !vecNodeId.empty() ? vecNodeId.front() : 0;
+}
+
 } // namespace Mayo
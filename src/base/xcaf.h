@@ -13,6 +13,8 @@
 #include <XCAFDoc_ColorTool.hxx>
 #include <XCAFDoc_ShapeTool.hxx>
 #include <XCAFDoc_LayerTool.hxx>
+#include <mutex>
+#include <vector>
 #if OCC_VERSION_HEX >= 0x070500
 #  include <XCAFDoc_VisMaterialTool.hxx>
 #endif
@@ -31,6 +33,12 @@ public:
         QuantityVolume volume;
     };
 
+    // Node of an assembly tree collected by collectAssemblyTree()
+    struct AssemblyTreeItem {
+        TDF_Label label;
+        int parentIndex; // Index of the parent item, -1 for the root item
+    };
+
     bool isNull() const;
 
     Handle_XCAFDoc_ShapeTool shapeTool() const;
@@ -57,11 +65,18 @@ public:
     bool hasShapeColor(const TDF_Label& lbl) const;
     Quantity_Color shapeColor(const TDF_Label& lbl) const;
 
+    // Absolute locations are cached, they're computed once per entity in a single top-down pass
     TopLoc_Location shapeAbsoluteLocation(TreeNodeId nodeId) const;
+    // Uncached version, location is computed by walking up from the node to the entity root
     static TopLoc_Location shapeAbsoluteLocation(const Tree<TDF_Label>& modelTree, TreeNodeId nodeId);
     static TopLoc_Location shapeReferenceLocation(const TDF_Label& lbl);
     static TDF_Label shapeReferred(const TDF_Label& lbl);
 
+    // Returns the unique non-assembly shapes(ie "prototypes") found in the assembly graph of 'lbl'
+    // Each prototype appears once whatever the count of component instances referring to it
+    // 'ptrReferenceCount' receives the count of references met during graph traversal
+    static TDF_LabelSequence shapePrototypes(const TDF_Label& lbl, int* ptrReferenceCount = nullptr);
+
     TDF_LabelSequence layers(const TDF_Label& lbl) const;
     TCollection_ExtendedString layerName(const TDF_Label& lbl) const;
 
@@ -70,16 +85,33 @@ public:
     // Returns labels of the top-level free shapes that were not found in 'seqOther'
     TDF_LabelSequence diffTopLevelFreeShapes(const TDF_LabelSequence& seqOther) const;
 
+    // Returns in pre-order the nodes of the assembly tree of 'label', as deepBuildAssemblyTree()
+    // would append them in the model tree
+    // Only XCAF attributes are read, so it can be called concurrently for distinct labels
+    static std::vector<AssemblyTreeItem> collectAssemblyTree(const TDF_Label& label);
+
 private:
     XCaf() = default;
 
     TreeNodeId deepBuildAssemblyTree(TreeNodeId parentNode, const TDF_Label& label);
+    // Appends nodes collected by collectAssemblyTree(), returns the id of the root node
+    TreeNodeId appendAssemblyTree(TreeNodeId parentNode, Span<const AssemblyTreeItem> spanItem);
     void setLabelMain(const TDF_Label& labelMain) { m_labelMain = labelMain; }
     void setModelTree(Tree<TDF_Label>& modelTree) { m_modelTree = &modelTree; }
+    // Must be called on structural edits of the model tree
+    void invalidateShapeAbsoluteLocations();
+    void invalidateShapeAbsoluteLocations(TreeNodeId entityId);
 
     friend class Document;
     TDF_Label m_labelMain;
     Tree<TDF_Label>* m_modelTree = nullptr;
+    // Indexed with tree node id, node data is valid only if its 'isCached' flag is set
+    struct NodeAbsoluteLocation {
+        TopLoc_Location location;
+        bool isCached;
+    };
+    mutable std::vector<NodeAbsoluteLocation> m_vecNodeAbsoluteLocation;
+    mutable std::mutex m_mutexNodeAbsoluteLocation;
 };
 
 } // namespace Mayo
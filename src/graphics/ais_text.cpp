@@ -6,8 +6,10 @@
 
 #include "ais_text.h"
 
+#include <Bnd_Box.hxx>
 #include <gp_Pnt.hxx>
 #include <Graphic3d_AspectText3d.hxx>
+#include <Graphic3d_Group.hxx>
 #include <OSD_Environment.hxx>
 #include <Prs3d_Text.hxx>
 #include <Prs3d_TextAspect.hxx>
@@ -23,10 +25,39 @@
 #include <Standard_Transient.hxx>
 #include <TCollection_AsciiString.hxx>
 
+#include <algorithm>
+#include <functional>
+#include <numeric>
 #include <vector>
 
+#if OCC_VERSION_HEX < OCC_VERSION_CHECK(7, 4, 0)
+#  include <Prs3d_Root.hxx>
+#endif
+
 namespace Mayo {
 
+namespace {
+
+bool hasSameStyle(const Handle_Prs3d_TextAspect& lhs, const Handle_Prs3d_TextAspect& rhs)
+{
+    if (lhs == rhs)
+        return true;
+
+    const Handle_Graphic3d_AspectText3d& lhsGfx = lhs->Aspect();
+    const Handle_Graphic3d_AspectText3d& rhsGfx = rhs->Aspect();
+    return lhs->Height() == rhs->Height()
+            && lhs->HorizontalJustification() == rhs->HorizontalJustification()
+            && lhs->VerticalJustification() == rhs->VerticalJustification()
+            && lhs->Orientation() == rhs->Orientation()
+            && lhsGfx->Font() == rhsGfx->Font()
+            && lhsGfx->Color() == rhsGfx->Color()
+            && lhsGfx->ColorSubTitle() == rhsGfx->ColorSubTitle()
+            && lhsGfx->DisplayType() == rhsGfx->DisplayType()
+            && lhsGfx->Style() == rhsGfx->Style();
+}
+
+} // namespace
+
 AIS_Text::AIS_Text(const TCollection_ExtendedString &text, const gp_Pnt& pos)
 {
     TextProperties defaultProps;
@@ -148,15 +179,84 @@ void AIS_Text::Compute(
         const opencascade::handle<Prs3d_Presentation>& pres,
         const int)
 {
+    // Indexes of the texts grouped by style, count of distinct styles is expected to be small
+    std::vector<std::vector<unsigned>> vecBatch;
     for (unsigned i = 0; i < this->textCount(); ++i) {
-        Prs3d_Text::Draw(
-                    pres,
-                    this->presentationTextAspect(i),
-                    this->text(i),
-                    this->position(i));
+        const Handle_Prs3d_TextAspect& aspect = m_textProps.at(i).m_aspect;
+        auto itBatch = std::find_if(vecBatch.begin(), vecBatch.end(), [&](const std::vector<unsigned>& batch) {
+            return hasSameStyle(m_textProps.at(batch.front()).m_aspect, aspect);
+        });
+        if (itBatch != vecBatch.end())
+            itBatch->push_back(i);
+        else
+            vecBatch.push_back({ i });
+    }
+
+    for (const std::vector<unsigned>& batch : vecBatch) {
+        const Handle_Prs3d_TextAspect& aspect = m_textProps.at(batch.front()).m_aspect;
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 4, 0)
+        Handle_Graphic3d_Group group = pres->NewGroup();
+        group->SetGroupPrimitivesAspect(aspect->Aspect());
+        for (unsigned i : batch)
+            Prs3d_Text::Draw(group, aspect, this->text(i), this->position(i));
+#else
+        // Prs3d_Text::Draw() adds texts to the current group of the presentation
+        Prs3d_Root::NewGroup(pres);
+        for (unsigned i : batch)
+            Prs3d_Text::Draw(pres, aspect, this->text(i), this->position(i));
+#endif
     }
 }
 
+std::vector<opencascade::handle<AIS_Text>> AIS_Text::splitByLocality(unsigned maxTextCount) const
+{
+    std::vector<opencascade::handle<AIS_Text>> vecPart;
+    std::vector<unsigned> vecIndex(this->textCount());
+    std::iota(vecIndex.begin(), vecIndex.end(), 0u);
+    maxTextCount = std::max(1u, maxTextCount);
+
+    // Recursive split at the median position along the longest extent of the positions
+    std::function<void(std::vector<unsigned>::iterator, std::vector<unsigned>::iterator)> fnSplit;
+    fnSplit = [&](std::vector<unsigned>::iterator itBegin, std::vector<unsigned>::iterator itEnd) {
+        if (itBegin == itEnd)
+            return;
+
+        const auto count = unsigned(itEnd - itBegin);
+        if (count <= maxTextCount) {
+            opencascade::handle<AIS_Text> part = new AIS_Text;
+            part->m_defaultFont = m_defaultFont;
+            part->m_defaultColor = m_defaultColor;
+            part->m_defaultTextBackgroundColor = m_defaultTextBackgroundColor;
+            part->m_defaultTextDisplayMode = m_defaultTextDisplayMode;
+            part->m_defaultTextStyle = m_defaultTextStyle;
+            part->m_textProps.reserve(count);
+            for (auto it = itBegin; it != itEnd; ++it)
+                part->m_textProps.push_back(m_textProps.at(*it));
+
+            vecPart.push_back(part);
+            return;
+        }
+
+        Bnd_Box bndBox;
+        for (auto it = itBegin; it != itEnd; ++it)
+            bndBox.Add(m_textProps.at(*it).m_position);
+
+        const gp_XYZ extent = bndBox.CornerMax().XYZ() - bndBox.CornerMin().XYZ();
+        int axis = extent.X() >= extent.Y() ? 1 : 2;
+        if (extent.Z() > extent.Coord(axis))
+            axis = 3;
+
+        const auto itMiddle = itBegin + count / 2;
+        std::nth_element(itBegin, itMiddle, itEnd, [&](unsigned lhs, unsigned rhs) {
+            return m_textProps.at(lhs).m_position.Coord(axis) < m_textProps.at(rhs).m_position.Coord(axis);
+        });
+        fnSplit(itBegin, itMiddle);
+        fnSplit(itMiddle, itEnd);
+    };
+    fnSplit(vecIndex.begin(), vecIndex.end());
+    return vecPart;
+}
+
 void AIS_Text::ComputeSelection(
         const opencascade::handle<SelectMgr_Selection>&, const int)
 {
@@ -20,12 +20,16 @@
 #include <Quantity_Color.hxx>
 #include <TCollection_ExtendedString.hxx>
 
+#include <vector>
+
 #if OCC_VERSION_HEX < OCC_VERSION_CHECK(7, 5, 0)
 #  include <Prs3d_Projector.hxx>
 #endif
 
 namespace Mayo {
 
+// Texts sharing the same style are batched in a single graphic group, so the text aspect is
+// applied once for all of them
 class AIS_Text : public AIS_InteractiveObject {
 public:
     AIS_Text() = default;
@@ -54,6 +58,12 @@ public:
     unsigned textCount() const;
     void addText(const TCollection_ExtendedString& text, const gp_Pnt& pos);
 
+    // Splits the texts into objects holding at most 'maxTextCount' texts close to each other
+    // Each object is a separate presentation, so the view can cull them individually by size(see
+    // GuiDocument::setDynamicSizeCullingThreshold()) while a single object would be culled as a whole
+    // Text aspects are shared with this object
+    std::vector<opencascade::handle<AIS_Text>> splitByLocality(unsigned maxTextCount) const;
+
     void ComputeSelection(
             const opencascade::handle<SelectMgr_Selection>& sel,
             const int mode) override;
@@ -0,0 +1,276 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "graphics_async_hlr.h"
+
+#include "../base/tkernel_utils.h"
+#include "graphics_scene.h"
+#include "graphics_utils.h"
+
+#include <Graphic3d_ArrayOfSegments.hxx>
+#include <Graphic3d_CView.hxx>
+#include <Graphic3d_Group.hxx>
+#include <HLRAlgo_EdgeIterator.hxx>
+#include <HLRAlgo_EdgeStatus.hxx>
+#include <HLRAlgo_Projector.hxx>
+#include <HLRBRep_PolyAlgo.hxx>
+#include <Precision.hxx>
+#include <Prs3d_Drawer.hxx>
+#include <Prs3d_LineAspect.hxx>
+#include <TopExp_Explorer.hxx>
+#include <V3d_View.hxx>
+#include <V3d_Viewer.hxx>
+#include <algorithm>
+
+namespace Mayo {
+
+GraphicsAsyncHlr* GraphicsAsyncHlr::globalInstance()
+{
+    static GraphicsAsyncHlr global;
+    return &global;
+}
+
+GraphicsAsyncHlr::GraphicsAsyncHlr()
+{
+    QObject::connect(&m_taskMgr, &TaskManager::ended, this, &GraphicsAsyncHlr::onTaskEnded);
+}
+
+void GraphicsAsyncHlr::setEnabled(bool on)
+{
+    m_isEnabled = on;
+    if (!on) {
+        // Tasks still running are just left to complete, their results go nowhere
+        m_mapObjectEntry.clear();
+        m_mapTaskObject.clear();
+    }
+}
+
+void GraphicsAsyncHlr::setCacheSize(int count)
+{
+    m_cacheSize = std::max(count, 1);
+    for (auto& [object, entry] : m_mapObjectEntry) {
+        while (int(entry.queueCached.size()) > m_cacheSize)
+            entry.queueCached.pop_back();
+    }
+}
+
+bool GraphicsAsyncHlr::computePresentation(
+        AIS_InteractiveObject* object,
+        const TopoDS_Shape& shape,
+        const Handle_Graphic3d_Camera& camera,
+        const Handle_Prs3d_Presentation& prs)
+{
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 5, 0)
+    if (!m_isEnabled || !object || shape.IsNull() || camera.IsNull() || !camera->IsOrthographic())
+        return false;
+
+    // Shapes without faces(ex: wires) have nothing to hide, usual HLR is cheap for them
+    if (!TopExp_Explorer(shape, TopAbs_FACE).More())
+        return false;
+
+    ObjectEntry& entry = m_mapObjectEntry[object];
+    if (!entry.shape.IsEqual(shape)) {
+        // Shape or its location changed, cached edges are obsolete but last ones are shown anyway
+        entry.shape = shape;
+        entry.queueCached.clear();
+    }
+
+    const Orientation orientation{ camera->Direction(), camera->Up() };
+    entry.requestedOrientation = orientation;
+    auto itCached = std::find_if(
+                entry.queueCached.begin(), entry.queueCached.end(), [&](const auto& cached) {
+        return cached.first.isEqual(orientation);
+    });
+    if (itCached != entry.queueCached.end()) {
+        const auto cached = *itCached;
+        entry.queueCached.erase(itCached);
+        entry.queueCached.push_front(cached);
+        entry.lastEdges = cached.second;
+    }
+    else if (entry.taskId == 0) {
+        this->startTask(object, &entry);
+    }
+
+    if (entry.lastEdges)
+        GraphicsAsyncHlr::addEdges(prs, *entry.lastEdges, object->Attributes());
+
+    return true;
+#else
+    Q_UNUSED(object);
+    Q_UNUSED(shape);
+    Q_UNUSED(camera);
+    Q_UNUSED(prs);
+    return false;
+#endif
+}
+
+void GraphicsAsyncHlr::forget(const AIS_InteractiveObject* object)
+{
+    auto itEntry = m_mapObjectEntry.find(object);
+    if (itEntry == m_mapObjectEntry.end())
+        return;
+
+    if (itEntry->second.taskId != 0)
+        m_mapTaskObject.erase(itEntry->second.taskId);
+
+    m_mapObjectEntry.erase(itEntry);
+}
+
+bool GraphicsAsyncHlr::Orientation::isEqual(const Orientation& other) const
+{
+    return this->direction.IsEqual(other.direction, Precision::Angular())
+            && this->up.IsEqual(other.up, Precision::Angular());
+}
+
+GraphicsAsyncHlr::HlrEdges GraphicsAsyncHlr::computeEdges(
+        const TopoDS_Shape& shape, const Orientation& orientation)
+{
+    HlrEdges edges;
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 5, 0)
+    // Same projector as StdPrs_HLRPolyShape for an orthographic camera, camera center is irrelevant
+    const gp_Dir backDir = orientation.direction.Reversed();
+    const gp_Dir xDir = orientation.up.Crossed(backDir);
+    gp_Trsf trsf;
+    trsf.SetTransformation(gp_Ax3(gp::Origin(), backDir, xDir));
+
+    Handle_HLRBRep_PolyAlgo algo = new HLRBRep_PolyAlgo(shape);
+    algo->Projector(HLRAlgo_Projector(trsf, false, 0.));
+    algo->Update();
+
+    HLRAlgo_EdgeStatus status;
+    TopoDS_Shape edgeShape;
+    bool isReg1, isRegN, isOutl, isIntl;
+    for (algo->InitHide(); algo->MoreHide(); algo->NextHide()) {
+        HLRAlgo_BiPoint::PointsT& points = algo->Hide(status, edgeShape, isReg1, isRegN, isOutl, isIntl);
+        // Smooth edges are skipped unless they are part of the silhouette
+        if (isReg1 && !isOutl)
+            continue;
+
+        const gp_XYZ& pnt1 = points.Pnt1;
+        const gp_XYZ vec = points.Pnt2 - points.Pnt1;
+        double start, end;
+        float tolStart, tolEnd;
+        HLRAlgo_EdgeIterator itEdge;
+        for (itEdge.InitVisible(status); itEdge.MoreVisible(); itEdge.NextVisible()) {
+            itEdge.Visible(start, tolStart, end, tolEnd);
+            edges.vecVisiblePnt.emplace_back(pnt1 + vec * start);
+            edges.vecVisiblePnt.emplace_back(pnt1 + vec * end);
+        }
+
+        for (itEdge.InitHidden(status); itEdge.MoreHidden(); itEdge.NextHidden()) {
+            itEdge.Hidden(start, tolStart, end, tolEnd);
+            edges.vecHiddenPnt.emplace_back(pnt1 + vec * start);
+            edges.vecHiddenPnt.emplace_back(pnt1 + vec * end);
+        }
+    }
+#else
+    Q_UNUSED(shape);
+    Q_UNUSED(orientation);
+#endif
+
+    return edges;
+}
+
+void GraphicsAsyncHlr::addEdges(
+        const Handle_Prs3d_Presentation& prs, const HlrEdges& edges, const Handle_Prs3d_Drawer& drawer)
+{
+    auto fnAddSegments = [&](const std::vector<gp_Pnt>& vecPnt, const Handle_Prs3d_LineAspect& aspect) {
+        if (vecPnt.empty())
+            return;
+
+        Handle_Graphic3d_ArrayOfSegments segments = new Graphic3d_ArrayOfSegments(int(vecPnt.size()));
+        for (const gp_Pnt& pnt : vecPnt)
+            segments->AddVertex(pnt);
+
+        Handle_Graphic3d_Group group = prs->NewGroup();
+        group->SetGroupPrimitivesAspect(aspect->Aspect());
+        group->AddPrimitiveArray(segments);
+    };
+
+    fnAddSegments(edges.vecVisiblePnt, drawer->SeenLineAspect());
+    if (drawer->DrawHiddenLine())
+        fnAddSegments(edges.vecHiddenPnt, drawer->HiddenLineAspect());
+}
+
+void GraphicsAsyncHlr::startTask(AIS_InteractiveObject* object, ObjectEntry* entry)
+{
+    auto result = std::make_shared<HlrEdges>();
+    const TopoDS_Shape shape = entry->shape;
+    const Orientation orientation = entry->requestedOrientation;
+    entry->taskId = m_taskMgr.newTask([=](TaskProgress*) {
+        *result = GraphicsAsyncHlr::computeEdges(shape, orientation);
+    });
+    entry->taskShape = shape;
+    entry->taskOrientation = orientation;
+    entry->taskResult = result;
+    m_mapTaskObject.insert({ entry->taskId, object });
+    m_taskMgr.run(entry->taskId);
+}
+
+void GraphicsAsyncHlr::onTaskEnded(TaskId taskId)
+{
+    auto itTask = m_mapTaskObject.find(taskId);
+    if (itTask == m_mapTaskObject.end())
+        return; // Object was forgotten in the meantime
+
+    AIS_InteractiveObject* object = itTask->second;
+    m_mapTaskObject.erase(itTask);
+    auto itEntry = m_mapObjectEntry.find(object);
+    if (itEntry == m_mapObjectEntry.end())
+        return;
+
+    ObjectEntry& entry = itEntry->second;
+    entry.taskId = 0;
+    if (entry.taskShape.IsEqual(entry.shape)) {
+        entry.queueCached.push_front({ entry.taskOrientation, entry.taskResult });
+        while (int(entry.queueCached.size()) > m_cacheSize)
+            entry.queueCached.pop_back();
+    }
+
+    entry.lastEdges = entry.taskResult;
+    entry.taskResult.reset();
+    entry.taskShape.Nullify();
+
+    // Camera moved again while computing, then chain with the latest orientation requested
+    const bool isRequestDone = std::any_of(
+                entry.queueCached.cbegin(), entry.queueCached.cend(), [&](const auto& cached) {
+        return cached.first.isEqual(entry.requestedOrientation);
+    });
+    if (!isRequestDone)
+        this->startTask(object, &entry);
+
+    GraphicsAsyncHlr::recomputeHlrPresentations(object);
+}
+
+void GraphicsAsyncHlr::recomputeHlrPresentations(AIS_InteractiveObject* object)
+{
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 5, 0)
+    const GraphicsObjectPtr gfxObject(object);
+    AIS_InteractiveContext* context = GraphicsUtils::AisObject_contextPtr(gfxObject);
+    if (!context)
+        return;
+
+    // Graphic3d_CView::ReCompute() is no-op for views not in computed mode
+    for (V3d_ListOfViewIterator itView = context->CurrentViewer()->DefinedViewIterator(); itView.More(); itView.Next()) {
+        for (PrsMgr_Presentations::Iterator itPrs(object->Presentations()); itPrs.More(); itPrs.Next())
+            itView.Value()->View()->ReCompute(itPrs.Value());
+    }
+
+    GraphicsScene* scene = GraphicsScene::fromObject(gfxObject);
+    if (scene) {
+        // Coalesces the redraws requested by the tasks ending in the same event loop iteration
+        GraphicsSceneRedrawBlocker blocker(scene);
+        scene->redraw();
+    }
+    else {
+        context->UpdateCurrentViewer();
+    }
+#else
+    Q_UNUSED(object);
+#endif
+}
+
+} // namespace Mayo
@@ -0,0 +1,100 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "../base/task_manager.h"
+
+#include <QtCore/QObject>
+#include <AIS_InteractiveObject.hxx>
+#include <Graphic3d_Camera.hxx>
+#include <Prs3d_Presentation.hxx>
+#include <TopoDS_Shape.hxx>
+#include <gp_Dir.hxx>
+#include <gp_Pnt.hxx>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace Mayo {
+
+// Polygonal hidden line removal(HLR) of shape objects, computed by worker threads
+// While the edges are computed for a new camera orientation, the presentation of an object shows
+// the last result available. Results are cached per object and orientation, so switching between
+// already visited views(ex: front/top/side) is instant
+// Only orthographic cameras are handled: edges of a parallel projection don't depend on the
+// location of the camera
+class GraphicsAsyncHlr : public QObject {
+    Q_OBJECT
+public:
+    static GraphicsAsyncHlr* globalInstance();
+
+    bool isEnabled() const { return m_isEnabled; }
+    void setEnabled(bool on);
+
+    // Maximum count of camera orientations cached per object
+    int cacheSize() const { return m_cacheSize; }
+    void setCacheSize(int count);
+
+    // Fills 'prs' with the HLR edges of 'shape' for 'camera', 'shape' being the located shape
+    // presented by 'object'. Computation is requested in background if needed, then the
+    // presentations of 'object' are recomputed once done
+    // Returns false if asynchronous HLR isn't applicable, HLR has then to be computed the usual way
+    bool computePresentation(
+            AIS_InteractiveObject* object,
+            const TopoDS_Shape& shape,
+            const Handle_Graphic3d_Camera& camera,
+            const Handle_Prs3d_Presentation& prs);
+
+    // Drops cached results of 'object', to be called when it's destroyed
+    void forget(const AIS_InteractiveObject* object);
+
+private:
+    GraphicsAsyncHlr();
+
+    struct Orientation {
+        gp_Dir direction;
+        gp_Dir up;
+        bool isEqual(const Orientation& other) const;
+    };
+
+    // Segments of the edges, as pairs of consecutive points expressed in world coordinates
+    struct HlrEdges {
+        std::vector<gp_Pnt> vecVisiblePnt;
+        std::vector<gp_Pnt> vecHiddenPnt;
+    };
+    using HlrEdgesPtr = std::shared_ptr<const HlrEdges>;
+
+    struct ObjectEntry {
+        TopoDS_Shape shape;
+        std::deque<std::pair<Orientation, HlrEdgesPtr>> queueCached; // Most recently used first
+        HlrEdgesPtr lastEdges;
+        Orientation requestedOrientation;
+        TaskId taskId = 0;
+        TopoDS_Shape taskShape;
+        Orientation taskOrientation;
+        std::shared_ptr<HlrEdges> taskResult;
+    };
+
+    static HlrEdges computeEdges(const TopoDS_Shape& shape, const Orientation& orientation);
+    static void addEdges(
+            const Handle_Prs3d_Presentation& prs,
+            const HlrEdges& edges,
+            const Handle_Prs3d_Drawer& drawer);
+
+    void startTask(AIS_InteractiveObject* object, ObjectEntry* entry);
+    void onTaskEnded(TaskId taskId);
+    static void recomputeHlrPresentations(AIS_InteractiveObject* object);
+
+    TaskManager m_taskMgr;
+    std::unordered_map<const AIS_InteractiveObject*, ObjectEntry> m_mapObjectEntry;
+    std::unordered_map<TaskId, AIS_InteractiveObject*> m_mapTaskObject;
+    bool m_isEnabled = true;
+    int m_cacheSize = 8;
+};
+
+} // namespace Mayo
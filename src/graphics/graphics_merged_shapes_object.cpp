@@ -0,0 +1,280 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "graphics_merged_shapes_object.h"
+
+#include "../base/mesh_utils.h"
+
+#include <AIS_DisplayMode.hxx>
+#include <BRep_Builder.hxx>
+#include <BRep_Tool.hxx>
+#include <Graphic3d_ArrayOfSegments.hxx>
+#include <Graphic3d_ArrayOfTriangles.hxx>
+#include <Graphic3d_AspectFillArea3d.hxx>
+#include <Graphic3d_Group.hxx>
+#include <Prs3d_LineAspect.hxx>
+#include <Prs3d_ShadingAspect.hxx>
+#include <Select3D_SensitiveTriangulation.hxx>
+#include <StdPrs_ShadedShape.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Compound.hxx>
+
+namespace Mayo {
+
+namespace {
+
+// Aspect of a highlight presentation, material of the parts is kept so lighting is the same
+Handle_Graphic3d_AspectFillArea3d highlightAspect(
+        const Handle_Prs3d_ShadingAspect& partAspect, const Handle_Prs3d_Drawer& style)
+{
+    Handle_Prs3d_ShadingAspect aspect = new Prs3d_ShadingAspect;
+    aspect->SetMaterial(partAspect->Material());
+    aspect->SetColor(style ? style->Color() : Quantity_Color(Quantity_NOC_CYAN1));
+    return aspect->Aspect();
+}
+
+} // namespace
+
+GraphicsMergedShapesObject::GraphicsMergedShapesObject()
+{
+    // Own aspect, otherwise the one of the default drawer would be modified
+    myDrawer->SetShadingAspect(new Prs3d_ShadingAspect);
+    this->SetDisplayMode(AIS_Shaded);
+    // Parts are highlighted individually, see HilightOwnerWithColor()
+    this->SetAutoHilight(false);
+}
+
+void GraphicsMergedShapesObject::setShadingAspect(
+        const Quantity_Color& color, const Graphic3d_MaterialAspect& material, double transparency)
+{
+    const Handle_Prs3d_ShadingAspect& aspect = myDrawer->ShadingAspect();
+    aspect->SetMaterial(material);
+    aspect->SetColor(color);
+    aspect->SetTransparency(transparency);
+}
+
+int GraphicsMergedShapesObject::addPart(const TopoDS_Shape& shape)
+{
+    Part part;
+    part.shape = shape;
+    countShapeMesh(shape, &part.nodeCount, &part.triangleCount);
+    m_vecPart.push_back(std::move(part));
+    ++m_includedPartCount;
+    return int(m_vecPart.size()) - 1;
+}
+
+void GraphicsMergedShapesObject::setPartExcluded(int partIndex, bool on)
+{
+    Part& part = m_vecPart.at(partIndex);
+    if (part.isExcluded != on) {
+        part.isExcluded = on;
+        m_includedPartCount += on ? -1 : 1;
+    }
+}
+
+int GraphicsMergedShapesObject::shapeTriangleCount(const TopoDS_Shape& shape)
+{
+    int nodeCount = 0;
+    int triangleCount = 0;
+    countShapeMesh(shape, &nodeCount, &triangleCount);
+    return triangleCount;
+}
+
+bool GraphicsMergedShapesObject::AcceptDisplayMode(const int mode) const
+{
+    return mode == AIS_Shaded;
+}
+
+void GraphicsMergedShapesObject::ComputeSelection(
+        const opencascade::handle<SelectMgr_Selection>& sel, const int mode)
+{
+    if (mode != 0)
+        return;
+
+    for (int i = 0; i < this->partCount(); ++i) {
+        const Part& part = m_vecPart.at(i);
+        if (part.isExcluded)
+            continue;
+
+        Handle_GraphicsMergedShapesOwner owner = new GraphicsMergedShapesOwner(this, i);
+        for (TopExp_Explorer expFace(part.shape, TopAbs_FACE); expFace.More(); expFace.Next()) {
+            TopLoc_Location loc;
+            const Handle_Poly_Triangulation& triangulation = BRep_Tool::Triangulation(TopoDS::Face(expFace.Current()), loc);
+            if (!triangulation.IsNull())
+                sel->Add(new Select3D_SensitiveTriangulation(owner, triangulation, loc, true));
+        }
+    }
+}
+
+void GraphicsMergedShapesObject::HilightOwnerWithColor(
+        const opencascade::handle<PrsMgr_PresentationManager3d>& pm,
+        const opencascade::handle<Prs3d_Drawer>& style,
+        const opencascade::handle<SelectMgr_EntityOwner>& owner)
+{
+    auto partOwner = Handle_GraphicsMergedShapesOwner::DownCast(owner);
+    if (!partOwner || partOwner->partIndex() >= this->partCount())
+        return;
+
+    Handle_Prs3d_Presentation prs = this->GetHilightPresentation(pm);
+    if (!prs)
+        return;
+
+    prs->Clear();
+    const std::vector<const Part*> vecPart = { &m_vecPart.at(partOwner->partIndex()) };
+    addPartsPresentation(prs, highlightAspect(myDrawer->ShadingAspect(), style), vecPart);
+    if (style)
+        prs->SetZLayer(style->ZLayer());
+
+    if (pm->IsImmediateModeOn())
+        pm->AddToImmediateList(prs);
+    else
+        prs->Display();
+}
+
+void GraphicsMergedShapesObject::HilightSelected(
+        const opencascade::handle<PrsMgr_PresentationManager3d>& pm,
+        const SelectMgr_SequenceOfOwner& seqOwner)
+{
+    Handle_Prs3d_Presentation prs = this->GetSelectPresentation(pm);
+    if (!prs)
+        return;
+
+    prs->Clear();
+    std::vector<const Part*> vecPart;
+    for (const Handle_SelectMgr_EntityOwner& owner : seqOwner) {
+        auto partOwner = Handle_GraphicsMergedShapesOwner::DownCast(owner);
+        if (partOwner && partOwner->partIndex() < this->partCount())
+            vecPart.push_back(&m_vecPart.at(partOwner->partIndex()));
+    }
+
+    addPartsPresentation(prs, highlightAspect(myDrawer->ShadingAspect(), this->HilightAttributes()), vecPart);
+    prs->Display();
+}
+
+void GraphicsMergedShapesObject::ClearSelected()
+{
+    Handle_Prs3d_Presentation prs = this->GetSelectPresentation(nullptr);
+    if (prs)
+        prs->Clear();
+}
+
+void GraphicsMergedShapesObject::Compute(
+        const opencascade::handle<PrsMgr_PresentationManager3d>&,
+        const opencascade::handle<Prs3d_Presentation>& pres,
+        const int mode)
+{
+    if (mode != AIS_Shaded)
+        return;
+
+    std::vector<const Part*> vecPart;
+    for (const Part& part : m_vecPart) {
+        if (!part.isExcluded)
+            vecPart.push_back(&part);
+    }
+
+    addPartsPresentation(pres, myDrawer->ShadingAspect()->Aspect(), vecPart);
+    if (myDrawer->FaceBoundaryDraw() && !vecPart.empty()) {
+        // Boundaries of all the parts are put in a single segments array as well
+        TopoDS_Compound compound;
+        BRep_Builder builder;
+        builder.MakeCompound(compound);
+        for (const Part* part : vecPart)
+            builder.Add(compound, part->shape);
+
+        Handle_Graphic3d_ArrayOfSegments segments = StdPrs_ShadedShape::FillFaceBoundaries(compound);
+        if (segments) {
+            Handle_Graphic3d_Group group = pres->NewGroup();
+            group->SetGroupPrimitivesAspect(myDrawer->FaceBoundaryAspect()->Aspect());
+            group->AddPrimitiveArray(segments);
+        }
+    }
+}
+
+void GraphicsMergedShapesObject::countShapeMesh(const TopoDS_Shape& shape, int* ptrNodeCount, int* ptrTriangleCount)
+{
+    for (TopExp_Explorer expFace(shape, TopAbs_FACE); expFace.More(); expFace.Next()) {
+        TopLoc_Location loc;
+        const Handle_Poly_Triangulation& triangulation = BRep_Tool::Triangulation(TopoDS::Face(expFace.Current()), loc);
+        if (!triangulation.IsNull()) {
+            *ptrNodeCount += triangulation->NbNodes();
+            *ptrTriangleCount += triangulation->NbTriangles();
+        }
+    }
+}
+
+void GraphicsMergedShapesObject::fillPartTriangles(const Part& part, Graphic3d_ArrayOfTriangles* triangles)
+{
+    for (TopExp_Explorer expFace(part.shape, TopAbs_FACE); expFace.More(); expFace.Next()) {
+        const TopoDS_Face& face = TopoDS::Face(expFace.Current());
+        TopLoc_Location loc;
+        const Handle_Poly_Triangulation& triangulation = BRep_Tool::Triangulation(face, loc);
+        if (triangulation.IsNull())
+            continue;
+
+        // Vertices are transformed here as the parts have distinct locations, normals are
+        // oriented along with the face
+        const gp_Trsf& trsf = loc.Transformation();
+        const bool isFaceReversed = face.Orientation() == TopAbs_REVERSED;
+        const auto normals = MeshUtils::cachedTriangulationNormals(triangulation);
+        const MeshUtils::NormalArray& nodeNormals = normals->nodes;
+        const int vertexOffset = triangles->VertexNumber();
+        for (int i = 0; i < triangulation->NbNodes(); ++i) {
+            gp_Vec normal(nodeNormals.x[i], nodeNormals.y[i], nodeNormals.z[i]);
+            if (normal.SquareMagnitude() == 0.)
+                normal.SetCoord(0., 0., 1.);
+
+            normal.Transform(trsf);
+            if (isFaceReversed)
+                normal.Reverse();
+
+            triangles->AddVertex(triangulation->Node(i + 1).Transformed(trsf), gp_Dir(normal));
+        }
+
+        for (int i = 1; i <= triangulation->NbTriangles(); ++i) {
+            int n1, n2, n3;
+            triangulation->Triangle(i).Get(n1, n2, n3);
+            if (isFaceReversed)
+                std::swap(n2, n3);
+
+            triangles->AddEdge(vertexOffset + n1);
+            triangles->AddEdge(vertexOffset + n2);
+            triangles->AddEdge(vertexOffset + n3);
+        }
+    }
+}
+
+void GraphicsMergedShapesObject::addPartsPresentation(
+        const Handle_Prs3d_Presentation& prs,
+        const Handle_Graphic3d_AspectFillArea3d& aspect,
+        const std::vector<const Part*>& vecPart)
+{
+    int nodeCount = 0;
+    int triangleCount = 0;
+    for (const Part* part : vecPart) {
+        nodeCount += part->nodeCount;
+        triangleCount += part->triangleCount;
+    }
+
+    if (nodeCount == 0 || triangleCount == 0)
+        return;
+
+    Handle_Graphic3d_ArrayOfTriangles triangles = new Graphic3d_ArrayOfTriangles(nodeCount, 3 * triangleCount, true);
+    for (const Part* part : vecPart)
+        fillPartTriangles(*part, triangles.get());
+
+    Handle_Graphic3d_Group group = prs->NewGroup();
+    group->SetGroupPrimitivesAspect(aspect);
+    group->AddPrimitiveArray(triangles);
+}
+
+GraphicsMergedShapesOwner::GraphicsMergedShapesOwner(const Handle_GraphicsMergedShapesObject& object, int partIndex)
+    : SelectMgr_EntityOwner(object),
+      m_partIndex(partIndex)
+{
+}
+
+} // namespace Mayo
@@ -0,0 +1,122 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "../base/tkernel_utils.h"
+
+#include <AIS_InteractiveObject.hxx>
+#include <Graphic3d_AspectFillArea3d.hxx>
+#include <Prs3d_Presentation.hxx>
+#include <PrsMgr_PresentationManager3d.hxx>
+#include <SelectMgr_EntityOwner.hxx>
+#include <SelectMgr_Selection.hxx>
+#include <TopoDS_Shape.hxx>
+#include <vector>
+
+#if OCC_VERSION_HEX < OCC_VERSION_CHECK(7, 5, 0)
+#  include <Prs3d_Projector.hxx>
+#endif
+
+class Graphic3d_ArrayOfTriangles;
+
+namespace Mayo {
+
+class GraphicsMergedShapesObject;
+class GraphicsMergedShapesOwner;
+DEFINE_STANDARD_HANDLE(GraphicsMergedShapesObject, AIS_InteractiveObject)
+DEFINE_STANDARD_HANDLE(GraphicsMergedShapesOwner, SelectMgr_EntityOwner)
+
+// Graphics object displaying many located shapes(parts) with a single shading aspect, the
+// triangulations of the parts are merged into one vertex buffer so they're drawn with a single
+// draw call instead of one per part
+// Only shaded mode(AIS_Shaded) is supported, face boundaries are drawn if enabled in Attributes()
+// Each part has its own selection owner(GraphicsMergedShapesOwner) and is highlighted alone
+// Parts can be excluded afterwards, presentation has then to be recomputed
+class GraphicsMergedShapesObject : public AIS_InteractiveObject {
+public:
+    GraphicsMergedShapesObject();
+
+    // Shading aspect(color, material, transparency) shared by all the parts
+    void setShadingAspect(const Quantity_Color& color, const Graphic3d_MaterialAspect& material, double transparency);
+
+    // Adds part of located shape 'shape', whose faces are expected to be triangulated
+    // Returns the part index
+    int addPart(const TopoDS_Shape& shape);
+    int partCount() const { return int(m_vecPart.size()); }
+    const TopoDS_Shape& partShape(int partIndex) const { return m_vecPart.at(partIndex).shape; }
+    int partTriangleCount(int partIndex) const { return m_vecPart.at(partIndex).triangleCount; }
+
+    bool isPartExcluded(int partIndex) const { return m_vecPart.at(partIndex).isExcluded; }
+    void setPartExcluded(int partIndex, bool on);
+    int includedPartCount() const { return m_includedPartCount; }
+
+    // Count of triangles of the faces of 'shape'
+    static int shapeTriangleCount(const TopoDS_Shape& shape);
+
+    bool AcceptDisplayMode(const int mode) const override;
+
+    void ComputeSelection(
+            const opencascade::handle<SelectMgr_Selection>& sel,
+            const int mode) override;
+
+    void HilightOwnerWithColor(
+            const opencascade::handle<PrsMgr_PresentationManager3d>& pm,
+            const opencascade::handle<Prs3d_Drawer>& style,
+            const opencascade::handle<SelectMgr_EntityOwner>& owner) override;
+    void HilightSelected(
+            const opencascade::handle<PrsMgr_PresentationManager3d>& pm,
+            const SelectMgr_SequenceOfOwner& seqOwner) override;
+    void ClearSelected() override;
+
+    DEFINE_STANDARD_RTTI_INLINE(GraphicsMergedShapesObject, AIS_InteractiveObject)
+
+protected:
+    void Compute(
+            const opencascade::handle<PrsMgr_PresentationManager3d>& pm,
+            const opencascade::handle<Prs3d_Presentation>& pres,
+            const int mode) override;
+
+#if OCC_VERSION_HEX < OCC_VERSION_CHECK(7, 5, 0)
+    void Compute(
+            const opencascade::handle<Prs3d_Projector>&,
+            const opencascade::handle<Prs3d_Presentation>&) override
+    {}
+#endif
+
+private:
+    struct Part {
+        TopoDS_Shape shape;
+        int nodeCount = 0;
+        int triangleCount = 0;
+        bool isExcluded = false;
+    };
+
+    static void countShapeMesh(const TopoDS_Shape& shape, int* ptrNodeCount, int* ptrTriangleCount);
+    static void fillPartTriangles(const Part& part, Graphic3d_ArrayOfTriangles* triangles);
+    static void addPartsPresentation(
+            const Handle_Prs3d_Presentation& prs,
+            const Handle_Graphic3d_AspectFillArea3d& aspect,
+            const std::vector<const Part*>& vecPart);
+
+    std::vector<Part> m_vecPart;
+    int m_includedPartCount = 0;
+};
+
+// Selection owner of a part of GraphicsMergedShapesObject
+class GraphicsMergedShapesOwner : public SelectMgr_EntityOwner {
+public:
+    GraphicsMergedShapesOwner(const Handle_GraphicsMergedShapesObject& object, int partIndex);
+
+    int partIndex() const { return m_partIndex; }
+
+    DEFINE_STANDARD_RTTI_INLINE(GraphicsMergedShapesOwner, SelectMgr_EntityOwner)
+
+private:
+    int m_partIndex = -1;
+};
+
+} // namespace Mayo
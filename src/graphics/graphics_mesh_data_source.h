@@ -10,15 +10,17 @@
 // -- Basically the same as XSDRAWSTLVRML_DataSource but it allows to be free of TKXSDRAW
 // --
 
+#include "../base/mesh_utils.h"
+
 #include <MeshVS_DataSource.hxx>
 #include <MeshVS_EntityType.hxx>
 #include <Poly_Triangulation.hxx>
 #include <TColStd_PackedMapOfInteger.hxx>
-#include <TColStd_HArray2OfInteger.hxx>
-#include <TColStd_HArray2OfReal.hxx>
 
 namespace Mayo {
 
+// Data source answering MeshVS queries directly from the Poly_Triangulation object, nodes and
+// triangles aren't copied. Element and node normals come from MeshUtils::cachedTriangulationNormals()
 class GraphicsMeshDataSource : public MeshVS_DataSource {
 public:
     GraphicsMeshDataSource(const Handle_Poly_Triangulation& mesh);
@@ -30,14 +32,13 @@ public:
     const TColStd_PackedMapOfInteger& GetAllNodes() const override { return m_nodes; }
     const TColStd_PackedMapOfInteger& GetAllElements() const override { return m_elements; }
     bool GetNormal(const int Id, const int Max, double& nx, double& ny, double& nz) const override;
+    bool GetNodeNormal(const int RankNode, const int ElementId, double& nx, double& ny, double& nz) const override;
 
 private:
-  Handle_Poly_Triangulation m_mesh;
-  TColStd_PackedMapOfInteger m_nodes;
-  TColStd_PackedMapOfInteger m_elements;
-  Handle_TColStd_HArray2OfInteger m_elemNodes;
-  Handle_TColStd_HArray2OfReal m_nodeCoords;
-  Handle_TColStd_HArray2OfReal m_elemNormals;
+    Handle_Poly_Triangulation m_mesh;
+    std::shared_ptr<const MeshUtils::TriangulationNormals> m_normals;
+    TColStd_PackedMapOfInteger m_nodes;
+    TColStd_PackedMapOfInteger m_elements;
 };
 
 } // namespace Mayo
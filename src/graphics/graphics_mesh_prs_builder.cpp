@@ -0,0 +1,225 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "graphics_mesh_prs_builder.h"
+
+#include "../base/mesh_utils.h"
+#include "../base/task_manager.h"
+
+#include <Graphic3d_ArrayOfPoints.hxx>
+#include <Graphic3d_ArrayOfSegments.hxx>
+#include <Graphic3d_ArrayOfTriangles.hxx>
+#include <Graphic3d_AspectFillArea3d.hxx>
+#include <Graphic3d_AspectLine3d.hxx>
+#include <Graphic3d_AspectMarker3d.hxx>
+#include <Graphic3d_BoundBuffer.hxx>
+#include <Graphic3d_Group.hxx>
+#include <Graphic3d_IndexBuffer.hxx>
+#include <MeshVS_DisplayModeFlags.hxx>
+#include <MeshVS_Drawer.hxx>
+#include <MeshVS_DrawerAttribute.hxx>
+#include <MeshVS_Tool.hxx>
+#include <algorithm>
+#include <thread>
+
+namespace Mayo {
+
+namespace {
+
+// Minimum count of items processed by a concurrent task, below that threading isn't worth it
+constexpr int MinChunkSize = 1 << 16;
+
+int chunkCount(int itemCount)
+{
+    const int threadCount = std::max(1, int(std::thread::hardware_concurrency()));
+    return std::max(1, std::min(itemCount / MinChunkSize, threadCount));
+}
+
+} // namespace
+
+GraphicsMeshPrsBuilder::GraphicsMeshPrsBuilder(
+        const Handle_MeshVS_Mesh& parent, const Handle_Poly_Triangulation& mesh)
+    : MeshVS_PrsBuilder(
+          parent, MeshVS_DMF_Shading | MeshVS_DMF_WireFrame, parent->GetDataSource(), -1, MeshVS_BP_User),
+      m_mesh(mesh)
+{
+}
+
+void GraphicsMeshPrsBuilder::Build(
+        const Handle_Prs3d_Presentation& prs,
+        const TColStd_PackedMapOfInteger& IDs,
+        TColStd_PackedMapOfInteger& IDsToExclude,
+        const bool isElement,
+        const int displayMode) const
+{
+    // Highlight presentations and partial builds(ex: hidden elements) are left to MeshVS builders
+    const bool isShading = displayMode == MeshVS_DMF_Shading;
+    const bool isWireframe = displayMode == MeshVS_DMF_WireFrame;
+    if (!(isShading || isWireframe) || m_mesh.IsNull())
+        return;
+
+    const int nodeCount = m_mesh->NbNodes();
+    const int triangleCount = m_mesh->NbTriangles();
+    if (!isElement) {
+        // Nodes are requested by MeshVS_Mesh only if MeshVS_DA_DisplayNodes is on
+        if (nodeCount > 0 && IDs.Extent() == nodeCount) {
+            this->buildNodes(prs);
+            IDsToExclude.Unite(IDs);
+        }
+
+        return;
+    }
+
+    if (nodeCount == 0 || triangleCount == 0 || IDs.Extent() != triangleCount)
+        return;
+
+    const Handle_MeshVS_Drawer drawer = this->GetDrawer();
+    bool showEdges = false;
+    drawer->GetBoolean(MeshVS_DA_ShowEdges, showEdges);
+    if (isWireframe) {
+        const auto edges = this->cachedEdges();
+        if (edges->count() > 0) {
+            Handle_Graphic3d_ArrayOfSegments segments =
+                    new Graphic3d_ArrayOfSegments(nodeCount, 2 * edges->count());
+            segments->Attributes()->NbElements = nodeCount;
+            segments->Indices()->NbElements = 2 * edges->count();
+            this->fillVertices(segments, false);
+            fillEdgeIndices(*edges, segments->Indices());
+            Handle_Graphic3d_Group group = prs->NewGroup();
+            group->SetGroupPrimitivesAspect(MeshVS_Tool::CreateAspectLine3d(drawer));
+            group->AddPrimitiveArray(segments);
+        }
+    }
+    else {
+        Handle_Graphic3d_ArrayOfTriangles triangles =
+                new Graphic3d_ArrayOfTriangles(nodeCount, 3 * triangleCount, true);
+        // Element counts are set upfront so the concurrent SetVertice() calls don't have to update
+        // them
+        triangles->Attributes()->NbElements = nodeCount;
+        triangles->Indices()->NbElements = 3 * triangleCount;
+        this->fillVertices(triangles, true);
+        const int triangleChunkCount = chunkCount(triangleCount);
+        const Handle_Graphic3d_IndexBuffer& indices = triangles->Indices();
+        TaskManager::runConcurrently(triangleChunkCount, nullptr, [&](int iChunk, TaskProgress*) {
+            const auto first = int((iChunk * int64_t(triangleCount)) / triangleChunkCount);
+            const auto last = int(((iChunk + 1) * int64_t(triangleCount)) / triangleChunkCount);
+            for (int i = first; i < last; ++i) {
+                int n1, n2, n3;
+                m_mesh->Triangle(i + 1).Get(n1, n2, n3);
+                indices->SetIndex(3 * i, n1 - 1);
+                indices->SetIndex(3 * i + 1, n2 - 1);
+                indices->SetIndex(3 * i + 2, n3 - 1);
+            }
+        });
+
+        Handle_Graphic3d_AspectFillArea3d aspect = MeshVS_Tool::CreateAspectFillArea3d(drawer);
+        aspect->SetEdgeOff();
+        Handle_Graphic3d_Group group = prs->NewGroup();
+        group->SetGroupPrimitivesAspect(aspect);
+        group->AddPrimitiveArray(triangles);
+
+        // Edges are not drawn with Graphic3d_AspectFillArea3d::SetEdgeOn(), which outlines every
+        // triangle so interior edges are drawn twice
+        if (showEdges) {
+            const auto edges = this->cachedEdges();
+            Handle_Graphic3d_IndexBuffer edgeIndices =
+                    new Graphic3d_IndexBuffer(Graphic3d_Buffer::DefaultAllocator());
+            if (edges->count() > 0 && edgeIndices->Init<int>(2 * edges->count())) {
+                fillEdgeIndices(*edges, edgeIndices);
+                Handle_Graphic3d_Group groupEdges = prs->NewGroup();
+                groupEdges->SetGroupPrimitivesAspect(MeshVS_Tool::CreateAspectLine3d(drawer));
+                groupEdges->AddPrimitiveArray(
+                            Graphic3d_TOPA_SEGMENTS,
+                            edgeIndices,
+                            triangles->Attributes(),
+                            Handle_Graphic3d_BoundBuffer());
+            }
+        }
+    }
+
+    // Prevents MeshVS_MeshPrsBuilder from building the elements once again
+    IDsToExclude.Unite(IDs);
+}
+
+void GraphicsMeshPrsBuilder::buildNodes(const Handle_Prs3d_Presentation& prs) const
+{
+    const Handle_MeshVS_Drawer drawer = this->GetDrawer();
+    int pointBudget = DefaultNodePointBudget;
+    drawer->GetInteger(GraphicsMeshPrsBuilder_DA_NodePointBudget, pointBudget);
+
+    // Nodes picked with a constant stride, node order of scanned/tessellated meshes follows the
+    // surface so the subsampling is rather even
+    const int nodeCount = m_mesh->NbNodes();
+    const int pointCount = pointBudget > 0 ? std::min(nodeCount, pointBudget) : nodeCount;
+    const double stride = double(nodeCount) / double(pointCount);
+    Handle_Graphic3d_ArrayOfPoints points = new Graphic3d_ArrayOfPoints(pointCount);
+    points->Attributes()->NbElements = pointCount;
+    const int pointChunkCount = chunkCount(pointCount);
+    TaskManager::runConcurrently(pointChunkCount, nullptr, [&](int iChunk, TaskProgress*) {
+        const auto first = int((iChunk * int64_t(pointCount)) / pointChunkCount);
+        const auto last = int(((iChunk + 1) * int64_t(pointCount)) / pointChunkCount);
+        for (int i = first; i < last; ++i) {
+            const int nodeIndex = std::min(nodeCount - 1, int(i * stride));
+            points->SetVertice(i + 1, m_mesh->Node(nodeIndex + 1));
+        }
+    });
+
+    // Point sprites, MeshVS_DA_MarkerType is ignored as other marker types are rendered as
+    // textured sprites, much slower for millions of points
+    Quantity_Color color = Quantity_NOC_YELLOW;
+    drawer->GetColor(MeshVS_DA_MarkerColor, color);
+    double scale = 1.;
+    drawer->GetDouble(MeshVS_DA_MarkerScale, scale);
+    Handle_Graphic3d_Group group = prs->NewGroup();
+    group->SetGroupPrimitivesAspect(new Graphic3d_AspectMarker3d(Aspect_TOM_POINT, color, scale));
+    group->AddPrimitiveArray(points);
+}
+
+std::shared_ptr<const MeshUtils::TriangulationEdges> GraphicsMeshPrsBuilder::cachedEdges() const
+{
+    double featureAngle = 0;
+    this->GetDrawer()->GetDouble(GraphicsMeshPrsBuilder_DA_EdgeFeatureAngle, featureAngle);
+    return MeshUtils::cachedTriangulationEdges(m_mesh, featureAngle);
+}
+
+void GraphicsMeshPrsBuilder::fillVertices(const Handle_Graphic3d_ArrayOfPrimitives& array, bool withNormals) const
+{
+    // Vertex normals are the area-weighted average of the normals of the adjacent triangles, shared
+    // with the data source and exporters
+    const int nodeCount = m_mesh->NbNodes();
+    const auto normals = withNormals ? MeshUtils::cachedTriangulationNormals(m_mesh) : nullptr;
+    const int nodeChunkCount = chunkCount(nodeCount);
+    TaskManager::runConcurrently(nodeChunkCount, nullptr, [&](int iChunk, TaskProgress*) {
+        const auto first = int((iChunk * int64_t(nodeCount)) / nodeChunkCount);
+        const auto last = int(((iChunk + 1) * int64_t(nodeCount)) / nodeChunkCount);
+        for (int i = first; i < last; ++i) {
+            array->SetVertice(i + 1, m_mesh->Node(i + 1));
+            if (normals) {
+                const MeshUtils::NormalArray& nodeNormals = normals->nodes;
+                Graphic3d_Vec3 normal(nodeNormals.x[i], nodeNormals.y[i], nodeNormals.z[i]);
+                if (normal.x() == 0.f && normal.y() == 0.f && normal.z() == 0.f)
+                    normal.SetValues(0.f, 0.f, 1.f);
+
+                array->SetVertexNormal(i + 1, normal.x(), normal.y(), normal.z());
+            }
+        }
+    });
+}
+
+void GraphicsMeshPrsBuilder::fillEdgeIndices(
+        const MeshUtils::TriangulationEdges& edges, const Handle_Graphic3d_IndexBuffer& indices)
+{
+    const int indexCount = int(edges.nodes.size());
+    const int indexChunkCount = chunkCount(indexCount);
+    TaskManager::runConcurrently(indexChunkCount, nullptr, [&](int iChunk, TaskProgress*) {
+        const auto first = int((iChunk * int64_t(indexCount)) / indexChunkCount);
+        const auto last = int(((iChunk + 1) * int64_t(indexCount)) / indexChunkCount);
+        for (int i = first; i < last; ++i)
+            indices->SetIndex(i, edges.nodes[i] - 1);
+    });
+}
+
+} // namespace Mayo
@@ -0,0 +1,69 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "../base/mesh_utils.h"
+
+#include <Graphic3d_ArrayOfPrimitives.hxx>
+#include <Graphic3d_IndexBuffer.hxx>
+#include <MeshVS_DrawerAttribute.hxx>
+#include <MeshVS_Mesh.hxx>
+#include <MeshVS_PrsBuilder.hxx>
+#include <Poly_Triangulation.hxx>
+
+namespace Mayo {
+
+class GraphicsMeshPrsBuilder;
+DEFINE_STANDARD_HANDLE(GraphicsMeshPrsBuilder, MeshVS_PrsBuilder)
+
+// Drawer attribute(double, radians) of the feature angle of the edges displayed, see
+// MeshUtils::triangulationEdges(). All edges are displayed if 0 or not set
+constexpr MeshVS_DrawerAttribute GraphicsMeshPrsBuilder_DA_EdgeFeatureAngle = MeshVS_DA_User;
+
+// Drawer attribute(integer) of the maximum count of nodes displayed(MeshVS_DA_DisplayNodes), nodes
+// are evenly decimated beyond. Defaults to GraphicsMeshPrsBuilder::DefaultNodePointBudget if not set
+constexpr auto GraphicsMeshPrsBuilder_DA_NodePointBudget = MeshVS_DrawerAttribute(MeshVS_DA_User + 1);
+
+// MeshVS builder of the shaded and wireframe presentations of a Poly_Triangulation object
+// Unlike MeshVS_MeshPrsBuilder which queries the data source element by element, triangles are
+// put in bulk into a single indexed Graphic3d_ArrayOfTriangles with vertex normals. The array is
+// filled by chunks running concurrently on the threads of TaskManager
+// Edges(wireframe mode, or shaded mode with MeshVS_DA_ShowEdges) are the unique edges of the
+// triangles, cached with the triangulation(see MeshUtils::cachedTriangulationEdges()). They are
+// drawn as a single indexed segments array sharing the vertices of the triangles
+// Nodes(MeshVS_DA_DisplayNodes) are drawn as a single point sprites array, instead of a marker
+// primitive per node
+// MeshVS_DMF_Shading and MeshVS_DMF_WireFrame modes are handled, other modes(shrink) are left to
+// the builders of lower priority
+class GraphicsMeshPrsBuilder : public MeshVS_PrsBuilder {
+public:
+    // Points drawn beyond about one per pixel of a full HD view are wasted, they only cost GPU
+    // memory and frame time
+    static constexpr int DefaultNodePointBudget = 1920 * 1080;
+
+    GraphicsMeshPrsBuilder(const Handle_MeshVS_Mesh& parent, const Handle_Poly_Triangulation& mesh);
+
+    void Build(
+            const Handle_Prs3d_Presentation& prs,
+            const TColStd_PackedMapOfInteger& IDs,
+            TColStd_PackedMapOfInteger& IDsToExclude,
+            const bool isElement,
+            const int displayMode) const override;
+
+    DEFINE_STANDARD_RTTI_INLINE(GraphicsMeshPrsBuilder, MeshVS_PrsBuilder)
+
+private:
+    void buildNodes(const Handle_Prs3d_Presentation& prs) const;
+    std::shared_ptr<const MeshUtils::TriangulationEdges> cachedEdges() const;
+    void fillVertices(const Handle_Graphic3d_ArrayOfPrimitives& array, bool withNormals) const;
+    static void fillEdgeIndices(
+            const MeshUtils::TriangulationEdges& edges, const Handle_Graphic3d_IndexBuffer& indices);
+
+    Handle_Poly_Triangulation m_mesh;
+};
+
+} // namespace Mayo
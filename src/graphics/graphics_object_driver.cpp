@@ -8,16 +8,25 @@
 
 #include "../base/document.h"
 #include "../base/caf_utils.h"
+#include "../base/global.h"
+#include "../base/point_cloud.h"
 #include "../base/property_enumeration.h"
+#include "../base/string_conv.h"
+#include "../base/task_manager.h"
+#include "../base/task_progress.h"
 #include "graphics_object_base_property_group.h"
 #include "graphics_mesh_data_source.h"
+#include "graphics_mesh_prs_builder.h"
+#include "graphics_point_cloud_object.h"
 #include "graphics_scene.h"
+#include "graphics_shape_object.h"
 #include "graphics_utils.h"
 
 #include <AIS_ConnectedInteractive.hxx>
 #include <AIS_DisplayMode.hxx>
 #include <AIS_InteractiveContext.hxx>
 #include <BRep_TFace.hxx>
+#include <BRep_Tool.hxx>
 #include <MeshVS_DisplayModeFlags.hxx>
 #include <MeshVS_DrawerAttribute.hxx>
 #include <MeshVS_Drawer.hxx>
@@ -27,12 +36,31 @@
 #include <V3d_View.hxx>
 #include <V3d_Viewer.hxx>
 #include <TDataXtd_Triangulation.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopoDS.hxx>
 #include <XCAFPrs_AISObject.hxx>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <stdexcept>
 
 namespace Mayo {
 
-namespace { struct GraphicsObjectDriverI18N { MAYO_DECLARE_TEXT_ID_FUNCTIONS(Mayo::GraphicsObjectDriver) }; }
+namespace {
+
+struct GraphicsObjectDriverI18N { MAYO_DECLARE_TEXT_ID_FUNCTIONS(Mayo::GraphicsObjectDriver) };
+
+// Recomputes all presentations of 'object', batched by the scene where 'sceneObject' is displayed
+void requestRedisplay(const GraphicsObjectPtr& object, const GraphicsObjectPtr& sceneObject)
+{
+    GraphicsScene* scene = GraphicsScene::fromObject(sceneObject);
+    if (scene)
+        scene->requestObjectRedisplay(object);
+    else
+        object->Redisplay(true); // All modes
+}
+
+} // namespace
 
 GraphicsObjectDriverPtr GraphicsObjectDriver::get(const GraphicsObjectPtr& object)
 {
@@ -104,7 +132,7 @@ GraphicsObjectPtr GraphicsShapeObjectDriver::createObject(const TDF_Label& label
 {
     if (XCaf::isShape(label)) {
 //        Handle_AIS_Shape object = new AIS_Shape(XCaf::shape(label));
-        Handle_XCAFPrs_AISObject object = new XCAFPrs_AISObject(label);
+        Handle_XCAFPrs_AISObject object = new GraphicsShapeObject(label);
         object->SetDisplayMode(AIS_Shaded);
         object->Attributes()->SetFaceBoundaryDraw(true);
         object->Attributes()->SetFaceBoundaryAspect(
@@ -158,10 +186,10 @@ void GraphicsShapeObjectDriver::applyDisplayMode(GraphicsObjectPtr object, Enume
             auto aisLink = Handle_AIS_ConnectedInteractive::DownCast(object);
             if (aisLink && aisLink->HasConnection()) {
                 aisLink->ConnectedTo()->Attributes()->SetFaceBoundaryDraw(showFaceBounds);
-                aisLink->ConnectedTo()->Redisplay(true);
+                requestRedisplay(aisLink->ConnectedTo(), object);
             }
             else {
-                object->Redisplay(true);
+                requestRedisplay(object, object);
             }
         }
     }
@@ -196,6 +224,119 @@ GraphicsShapeObjectDriver::properties(Span<const GraphicsObjectPtr> spanObject)
     return {};
 }
 
+namespace Internal {
+
+Q_GLOBAL_STATIC(GraphicsShapeObjectDriver::MeshFunction, graphicsShapeLazyMeshFunction)
+
+} // namespace Internal
+
+const GraphicsShapeObjectDriver::MeshFunction& GraphicsShapeObjectDriver::lazyMeshFunction() {
+    return *Internal::graphicsShapeLazyMeshFunction;
+}
+
+void GraphicsShapeObjectDriver::setLazyMeshFunction(MeshFunction fn) {
+    *Internal::graphicsShapeLazyMeshFunction = std::move(fn);
+}
+
+bool GraphicsShapeObjectDriver::isMeshed(const TDF_Label& label)
+{
+    if (!XCaf::isShape(label))
+        return true;
+
+    for (TopExp_Explorer expFace(XCaf::shape(label), TopAbs_FACE); expFace.More(); expFace.Next()) {
+        TopLoc_Location loc;
+        if (BRep_Tool::Triangulation(TopoDS::Face(expFace.Current()), loc).IsNull())
+            return false;
+    }
+
+    return true;
+}
+
+TaskId GraphicsShapeObjectDriver::requestMesh(const TDF_Label& label, int priority)
+{
+    const MeshFunction fnMesh = GraphicsShapeObjectDriver::lazyMeshFunction();
+    if (!fnMesh)
+        return 0;
+
+    // Keep document alive while the task is running
+    const DocumentPtr doc = Document::findFrom(label);
+    TaskManager* taskMgr = TaskManager::globalInstance();
+    const TaskId taskId = taskMgr->newTask([=](TaskProgress* progress) {
+        MAYO_UNUSED(doc);
+        fnMesh(label, progress);
+    }, priority);
+    const QString labelName = to_QString(CafUtils::labelAttrStdName(label));
+    taskMgr->setTitle(taskId, GraphicsObjectDriverI18N::textIdTr("Mesh %1").arg(labelName));
+    taskMgr->run(taskId);
+    return taskId;
+}
+
+namespace Internal {
+
+Q_GLOBAL_STATIC(GraphicsShapeObjectDriver::RefineMeshFunction, graphicsShapeRefineMeshFunction)
+
+// Commit functions of the refinement tasks completed but not yet committed
+struct PendingMeshRefinements {
+    std::mutex mutex;
+    std::unordered_map<TaskId, std::function<void()>> mapTaskCommit;
+};
+Q_GLOBAL_STATIC(PendingMeshRefinements, graphicsShapePendingMeshRefinements)
+
+} // namespace Internal
+
+const GraphicsShapeObjectDriver::RefineMeshFunction& GraphicsShapeObjectDriver::refineMeshFunction() {
+    return *Internal::graphicsShapeRefineMeshFunction;
+}
+
+void GraphicsShapeObjectDriver::setRefineMeshFunction(RefineMeshFunction fn) {
+    *Internal::graphicsShapeRefineMeshFunction = std::move(fn);
+}
+
+TaskId GraphicsShapeObjectDriver::requestMeshRefinement(const TDF_Label& label, int priority)
+{
+    const RefineMeshFunction fnRefine = GraphicsShapeObjectDriver::refineMeshFunction();
+    if (!fnRefine)
+        return 0;
+
+    // Keep document alive while the task is running
+    const DocumentPtr doc = Document::findFrom(label);
+    TaskManager* taskMgr = TaskManager::globalInstance();
+    auto ptrTaskId = std::make_shared<TaskId>(0);
+    const TaskId taskId = taskMgr->newTask([=](TaskProgress* progress) {
+        MAYO_UNUSED(doc);
+        std::function<void()> fnCommit = fnRefine(label, progress);
+        if (!fnCommit || TaskProgress::isAbortRequested(progress))
+            return;
+
+        auto pending = Internal::graphicsShapePendingMeshRefinements();
+        std::lock_guard<std::mutex> lock(pending->mutex);
+        pending->mapTaskCommit.insert_or_assign(*ptrTaskId, std::move(fnCommit));
+    }, priority);
+    *ptrTaskId = taskId;
+    const QString labelName = to_QString(CafUtils::labelAttrStdName(label));
+    taskMgr->setTitle(taskId, GraphicsObjectDriverI18N::textIdTr("Refine mesh %1").arg(labelName));
+    taskMgr->run(taskId);
+    return taskId;
+}
+
+bool GraphicsShapeObjectDriver::commitMeshRefinement(TaskId taskId)
+{
+    std::function<void()> fnCommit;
+    {
+        auto pending = Internal::graphicsShapePendingMeshRefinements();
+        std::lock_guard<std::mutex> lock(pending->mutex);
+        auto it = pending->mapTaskCommit.find(taskId);
+        if (it == pending->mapTaskCommit.end())
+            return false;
+
+        fnCommit = std::move(it->second);
+        pending->mapTaskCommit.erase(it);
+    }
+
+    fnCommit();
+    return true;
+}
+
 GraphicsMeshObjectDriver::GraphicsMeshObjectDriver()
 {
     this->setDisplayModes({
@@ -242,7 +383,9 @@ GraphicsObjectPtr GraphicsMeshObjectDriver::createObject(const TDF_Label& label)
     if (polyTri) {
         Handle_MeshVS_Mesh object = new MeshVS_Mesh;
         object->SetDataSource(new GraphicsMeshDataSource(polyTri));
-        // meshVisu->AddBuilder(..., false); -> No selection
+        // Shaded and wireframe modes are built in bulk by GraphicsMeshPrsBuilder,
+        // MeshVS_MeshPrsBuilder is used for the other modes, nodes and highlighting
+        object->AddBuilder(new GraphicsMeshPrsBuilder(object, polyTri), false);
         object->AddBuilder(new MeshVS_MeshPrsBuilder(object), true);
 
         // -- MeshVS_DrawerAttribute
@@ -253,10 +396,16 @@ GraphicsObjectPtr GraphicsMeshObjectDriver::createObject(const TDF_Label& label)
         object->GetDrawer()->SetMaterial(
                     MeshVS_DA_FrontMaterial, Graphic3d_MaterialAspect(defaultValues().material));
         object->GetDrawer()->SetColor(MeshVS_DA_EdgeColor, defaultValues().edgeColor);
+        object->GetDrawer()->SetDouble(GraphicsMeshPrsBuilder_DA_EdgeFeatureAngle, defaultValues().edgeFeatureAngle);
         object->SetDisplayMode(MeshVS_DMF_Shading);
 
         //object->SetHilightMode(MeshVS_DMF_WireFrame);
-        object->SetMeshSelMethod(MeshVS_MSM_PRECISE);
+        // Precise selection creates a sensitive entity per triangle, too costly for large meshes
+        constexpr int maxPreciseSelectionTriangleCount = 1000000;
+        if (polyTri->NbTriangles() > maxPreciseSelectionTriangleCount)
+            object->SetMeshSelMethod(MeshVS_MSM_BOX);
+        else
+            object->SetMeshSelMethod(MeshVS_MSM_PRECISE);
 
         object->SetOwner(this);
         return object;
@@ -326,7 +475,7 @@ public:
 
     void onPropertyChanged(Property* prop) override {
         auto fnRedisplay = [](const GraphicsObjectPtr& object) {
-            object->Redisplay(true); // All modes
+            requestRedisplay(object, object);
         };
 
         if (prop == &m_propertyShowEdges) {
@@ -389,4 +538,54 @@ void GraphicsMeshObjectDriver::setDefaultValues(const DefaultValues& values) {
     *Internal::graphicsMeshDefaultValues = values;
 }
 
+GraphicsPointCloudObjectDriver::GraphicsPointCloudObjectDriver()
+{
+    this->setDisplayModes({
+        { GraphicsPointCloudObject::DisplayMode_Points, GraphicsObjectDriverI18N::textId("PointCloud_Points") },
+        { GraphicsPointCloudObject::DisplayMode_BoundingBox, GraphicsObjectDriverI18N::textId("PointCloud_BoundingBox") }
+    });
+    this->setDefaultDisplayMode(GraphicsPointCloudObject::DisplayMode_Points);
+}
+
+GraphicsObjectDriver::Support GraphicsPointCloudObjectDriver::supportStatus(const TDF_Label& label) const
+{
+    auto attrPointCloud = CafUtils::findAttribute<PointCloudAttribute>(label);
+    if (attrPointCloud && attrPointCloud->get())
+        return Support::Complete;
+
+    return Support::None;
+}
+
+GraphicsObjectPtr GraphicsPointCloudObjectDriver::createObject(const TDF_Label& label) const
+{
+    auto attrPointCloud = CafUtils::findAttribute<PointCloudAttribute>(label);
+    if (!attrPointCloud || !attrPointCloud->get())
+        return {};
+
+    Handle_GraphicsPointCloudObject object = new GraphicsPointCloudObject(attrPointCloud->get());
+    object->SetColor(GraphicsMeshObjectDriver::defaultValues().color);
+    object->SetOwner(this);
+    return object;
+}
+
+void GraphicsPointCloudObjectDriver::applyDisplayMode(GraphicsObjectPtr object, Enumeration::Value mode) const
+{
+    this->throwIf_differentDriver(object);
+    this->throwIf_invalidDisplayMode(mode);
+    GraphicsUtils::AisObject_contextPtr(object)->SetDisplayMode(object, mode, false);
+}
+
+Enumeration::Value GraphicsPointCloudObjectDriver::currentDisplayMode(const GraphicsObjectPtr& object) const
+{
+    this->throwIf_differentDriver(object);
+    return object->DisplayMode();
+}
+
+std::unique_ptr<GraphicsObjectBasePropertyGroup>
+GraphicsPointCloudObjectDriver::properties(Span<const GraphicsObjectPtr> spanObject) const
+{
+    this->throwIf_differentDriver(spanObject);
+    return {};
+}
+
 } // namespace Mayo
@@ -11,14 +11,17 @@
 #include "../base/enumeration.h"
 #include "../base/property.h"
 #include "../base/span.h"
+#include "../base/task_common.h"
 
 #include <Standard_Transient.hxx>
 #include <TDF_Label.hxx>
+#include <functional>
 #include <memory>
 
 namespace Mayo {
 
 class GraphicsObjectDriver;
+class TaskProgress;
 DEFINE_STANDARD_HANDLE(GraphicsObjectDriver, Standard_Transient)
 using GraphicsObjectDriverPtr = opencascade::handle<GraphicsObjectDriver>;
 
@@ -74,6 +77,38 @@ public:
         DisplayMode_Shaded,
         DisplayMode_ShadedWithFaceBoundary
     };
+
+    // -- Lazy tessellation
+    // When a mesh function is defined, graphics objects whose shape isn't meshed yet are expected
+    // to be displayed only once requestMesh() has completed, so meshing is done just for the shapes
+    // that are actually shown
+    using MeshFunction = std::function<void(const TDF_Label&, TaskProgress*)>;
+    static const MeshFunction& lazyMeshFunction();
+    static void setLazyMeshFunction(MeshFunction fn);
+    static bool isLazyMeshEnabled() { return bool(lazyMeshFunction()); }
+
+    // Returns true if all faces of the shape in 'label' have a triangulation
+    static bool isMeshed(const TDF_Label& label);
+
+    // Runs lazy mesh function on 'label' in a background task of TaskManager::globalInstance()
+    // Returns the identifier of the task, whose end is signaled by TaskManager::ended()
+    static TaskId requestMesh(const TDF_Label& label, int priority = TaskPriority_Normal);
+
+    // -- Progressive display
+    // When a refine function is defined, lazy mesh function is expected to produce a coarse
+    // tessellation so products show up early. Refine function then computes the final
+    // triangulations aside(shapes being displayed can't be modified from a worker thread) and
+    // returns the function replacing the coarse ones, to be called in the main thread
+    using RefineMeshFunction = std::function<std::function<void()>(const TDF_Label&, TaskProgress*)>;
+    static const RefineMeshFunction& refineMeshFunction();
+    static void setRefineMeshFunction(RefineMeshFunction fn);
+    static bool isMeshRefinementEnabled() { return bool(refineMeshFunction()); }
+
+    // Runs refine function on 'label' in a background task of TaskManager::globalInstance()
+    static TaskId requestMeshRefinement(const TDF_Label& label, int priority = TaskPriority_Background);
+    // Applies the triangulations computed by refinement task 'taskId', to be called once the task
+    // has ended. Returns false if the task was aborted(triangulations are then left unchanged)
+    static bool commitMeshRefinement(TaskId taskId);
 };
 
 class GraphicsMeshObjectDriver : public GraphicsObjectDriver {
@@ -92,6 +127,7 @@ public:
         Graphic3d_NameOfMaterial material = Graphic3d_NOM_PLASTIC;
         Quantity_Color color = Quantity_NOC_BISQUE;
         Quantity_Color edgeColor = Quantity_NOC_BLACK;
+        double edgeFeatureAngle = 0; // Radians, see GraphicsMeshPrsBuilder_DA_EdgeFeatureAngle
     };
     static const DefaultValues& defaultValues();
     static void setDefaultValues(const DefaultValues& values);
@@ -100,4 +136,16 @@ private:
     class ObjectProperties;
 };
 
+// Driver for point cloud entities(label having a PointCloudAttribute), see GraphicsPointCloudObject
+class GraphicsPointCloudObjectDriver : public GraphicsObjectDriver {
+public:
+    GraphicsPointCloudObjectDriver();
+
+    Support supportStatus(const TDF_Label& label) const override;
+    GraphicsObjectPtr createObject(const TDF_Label& label) const override;
+    void applyDisplayMode(GraphicsObjectPtr object, Enumeration::Value mode) const override;
+    Enumeration::Value currentDisplayMode(const GraphicsObjectPtr& object) const override;
+    std::unique_ptr<GraphicsObjectBasePropertyGroup> properties(Span<const GraphicsObjectPtr> spanObject) const override;
+};
+
 } // namespace Mayo
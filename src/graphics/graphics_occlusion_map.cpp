@@ -0,0 +1,138 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "graphics_occlusion_map.h"
+#include "../base/bnd_utils.h"
+
+#include <Graphic3d_ZLayerSettings.hxx>
+#include <Image_PixMap.hxx>
+#include <V3d_ImageDumpOptions.hxx>
+#include <V3d_Viewer.hxx>
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace Mayo {
+
+namespace {
+
+// Size in pixels of the tiles the depth buffer is reduced to. Box tests then read a few values
+// whatever the projected size of the boxes
+constexpr int Occlusion_tileSize = 8;
+
+} // namespace
+
+bool GraphicsOcclusionMap::update(const Handle_V3d_View& view)
+{
+    this->clear();
+    if (view.IsNull() || view->Window().IsNull() || !view->Window()->IsMapped())
+        return false;
+
+    int width, height;
+    view->Window()->Size(width, height);
+    if (width <= 0 || height <= 0)
+        return false;
+
+    // Overlay layers must not write depths, Topmost layer for example clears the depth buffer
+    const Handle_V3d_Viewer viewer = view->Viewer();
+    std::vector<std::pair<Graphic3d_ZLayerId, Graphic3d_ZLayerSettings>> vecOverlaySettings;
+    for (Graphic3d_ZLayerId layerId : { Graphic3d_ZLayerId_Top, Graphic3d_ZLayerId_Topmost, Graphic3d_ZLayerId_TopOSD }) {
+        Graphic3d_ZLayerSettings settings = viewer->ZLayerSettings(layerId);
+        vecOverlaySettings.push_back({ layerId, settings });
+        settings.SetClearDepth(false);
+        settings.SetEnableDepthWrite(false);
+        viewer->SetZLayerSettings(layerId, settings);
+    }
+
+    Image_PixMap depthMap;
+    depthMap.SetTopDown(true);
+    V3d_ImageDumpOptions dumpOptions;
+    dumpOptions.BufferType = Graphic3d_BT_Depth;
+    dumpOptions.Width = width;
+    dumpOptions.Height = height;
+    const bool ok = view->ToPixMap(depthMap, dumpOptions);
+    for (const auto& [layerId, settings] : vecOverlaySettings)
+        viewer->SetZLayerSettings(layerId, settings);
+
+    if (!ok || int(depthMap.Width()) != width || int(depthMap.Height()) != height)
+        return false;
+
+    m_camera = new Graphic3d_Camera(view->Camera());
+    m_width = width;
+    m_height = height;
+    m_tileColumnCount = (width + Occlusion_tileSize - 1) / Occlusion_tileSize;
+    m_tileRowCount = (height + Occlusion_tileSize - 1) / Occlusion_tileSize;
+    m_vecTileDepth.resize(size_t(m_tileColumnCount) * m_tileRowCount, 0.f);
+    for (int row = 0; row < height; ++row) {
+        float* tileDepthRow = m_vecTileDepth.data() + size_t(row / Occlusion_tileSize) * m_tileColumnCount;
+        for (int col = 0; col < width; ++col) {
+            float& tileDepth = tileDepthRow[col / Occlusion_tileSize];
+            tileDepth = std::max(tileDepth, depthMap.Value<float>(row, col));
+        }
+    }
+
+    return true;
+}
+
+void GraphicsOcclusionMap::clear()
+{
+    m_camera.Nullify();
+    m_width = 0;
+    m_height = 0;
+    m_tileColumnCount = 0;
+    m_tileRowCount = 0;
+    m_vecTileDepth.clear();
+}
+
+bool GraphicsOcclusionMap::isOccluded(const Bnd_Box& bndBox) const
+{
+    if (this->isNull() || bndBox.IsVoid())
+        return false;
+
+    // Bounding rectangle and nearest depth of the projected corners
+    const Graphic3d_Mat4d& matOrientation = m_camera->OrientationMatrix();
+    const bool isPerspective = !m_camera->IsOrthographic();
+    double xMin = 1., xMax = -1., yMin = 1., yMax = -1., zMin = 1.;
+    for (const gp_Pnt& pnt : BndBoxCoords::get(bndBox).vertices()) {
+        if (isPerspective) {
+            const Graphic3d_Vec4d eyePnt = matOrientation * Graphic3d_Vec4d(pnt.X(), pnt.Y(), pnt.Z(), 1.);
+            if (-eyePnt.z() <= m_camera->ZNear())
+                return false; // Crosses the near plane, projection isn't reliable
+        }
+
+        const gp_Pnt ndcPnt = m_camera->Project(pnt);
+        if (ndcPnt.Z() < -1.)
+            return false;
+
+        xMin = std::min(xMin, ndcPnt.X());
+        xMax = std::max(xMax, ndcPnt.X());
+        yMin = std::min(yMin, ndcPnt.Y());
+        yMax = std::max(yMax, ndcPnt.Y());
+        zMin = std::min(zMin, ndcPnt.Z());
+    }
+
+    if (xMax < -1. || xMin > 1. || yMax < -1. || yMin > 1. || zMin > 1.)
+        return false; // Outside of the view volume, up to frustum culling
+
+    // Normalized device coordinates to pixels(rows from top), then to tiles
+    auto fnClamp = [](int value, int maxValue) { return std::clamp(value, 0, maxValue); };
+    const int colMin = fnClamp(int(std::floor((xMin + 1.) * 0.5 * m_width)), m_width - 1);
+    const int colMax = fnClamp(int(std::ceil((xMax + 1.) * 0.5 * m_width)), m_width - 1);
+    const int rowMin = fnClamp(int(std::floor((1. - yMax) * 0.5 * m_height)), m_height - 1);
+    const int rowMax = fnClamp(int(std::ceil((1. - yMin) * 0.5 * m_height)), m_height - 1);
+    const float boxDepth = float((zMin + 1.) * 0.5);
+    for (int tileRow = rowMin / Occlusion_tileSize; tileRow <= rowMax / Occlusion_tileSize; ++tileRow) {
+        const float* tileDepthRow = m_vecTileDepth.data() + size_t(tileRow) * m_tileColumnCount;
+        for (int tileCol = colMin / Occlusion_tileSize; tileCol <= colMax / Occlusion_tileSize; ++tileCol) {
+            if (tileDepthRow[tileCol] >= boxDepth)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+} // namespace Mayo
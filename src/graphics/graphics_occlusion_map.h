@@ -0,0 +1,41 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include <Bnd_Box.hxx>
+#include <Graphic3d_Camera.hxx>
+#include <V3d_View.hxx>
+#include <vector>
+
+namespace Mayo {
+
+// Conservative occlusion test of bounding boxes against the depth buffer of a view
+// Depth buffer is read back offscreen then reduced to the farthest depth of each tile of pixels,
+// so a box is reported occluded only if it lies behind the drawn objects at every pixel it covers
+// Objects of the overlay Z layers(eg view cube, highlighting) don't contribute to the depths
+class GraphicsOcclusionMap {
+public:
+    // Renders one frame of 'view' offscreen to read its depth buffer, on-screen image is left as is
+    // Returns false if the depth buffer can't be read, the map is then null
+    bool update(const Handle_V3d_View& view);
+    void clear();
+    bool isNull() const { return m_vecTileDepth.empty(); }
+
+    // Whether 'bndBox'(world coordinates) is hidden behind the depths of the map
+    // Boxes crossing the near plane or outside of the view volume are never occluded
+    bool isOccluded(const Bnd_Box& bndBox) const;
+
+private:
+    Handle_Graphic3d_Camera m_camera; // Copy of the view camera at the time depths were read
+    int m_width = 0;
+    int m_height = 0;
+    int m_tileColumnCount = 0;
+    int m_tileRowCount = 0;
+    std::vector<float> m_vecTileDepth; // Farthest depth of each tile, row-major from top
+};
+
+} // namespace Mayo
@@ -0,0 +1,236 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "graphics_point_cloud_object.h"
+#include "graphics_utils.h"
+
+#include <Graphic3d_ArrayOfPoints.hxx>
+#include <Graphic3d_ArrayOfSegments.hxx>
+#include <Graphic3d_Group.hxx>
+#include <Prs3d_LineAspect.hxx>
+#include <Prs3d_PointAspect.hxx>
+#include <Select3D_SensitiveBox.hxx>
+#include <SelectMgr_EntityOwner.hxx>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+
+namespace Mayo {
+
+namespace {
+
+// Count of points displayed for an octree node, whatever its depth. So a node is displayed with
+// a density growing as its screen size decreases
+constexpr uint64_t NodeSampleSize = 32768;
+
+// Nodes are refined when the points picked get more than about one pixel apart on screen
+const double MinRefineScreenSize = std::sqrt(double(NodeSampleSize));
+
+uint64_t nodeSampleCount(const PointCloud::Node& node)
+{
+    return std::min(node.pointCount, NodeSampleSize);
+}
+
+gp_Pnt nodeCorner(const PointCloud::Node& node, int i)
+{
+    return gp_Pnt((i & 1) ? node.maxCorner.x() : node.minCorner.x(),
+                  (i & 2) ? node.maxCorner.y() : node.minCorner.y(),
+                  (i & 4) ? node.maxCorner.z() : node.minCorner.z());
+}
+
+// Returns the size in pixels of the projection of 'node' in 'view', or a negative value if 'node'
+// is outside of the view frustum
+// Like GraphicsUtils::V3dView_isInFrustum(), this is an approximate test on projected corners
+double nodeScreenSize(
+        const Handle_Graphic3d_Camera& camera, int viewHeight, const gp_Trsf& trsf, const PointCloud::Node& node)
+{
+    const gp_Pnt eye = camera->Eye();
+    const gp_Dir dir = camera->Direction();
+    Bnd_Box bndBoxNdc;
+    for (int i = 0; i < 8; ++i) {
+        const gp_Pnt corner = nodeCorner(node, i).Transformed(trsf);
+        if (!camera->IsOrthographic() && gp_Vec(eye, corner).Dot(dir) <= 0.)
+            return std::numeric_limits<double>::max(); // Projection is meaningless, assume visible
+
+        bndBoxNdc.Add(camera->Project(corner));
+    }
+
+    Bnd_Box bndBoxView;
+    bndBoxView.Update(-1, -1, -1, 1, 1, 1);
+    if (bndBoxNdc.IsOut(bndBoxView))
+        return -1.;
+
+    double xMin, yMin, zMin, xMax, yMax, zMax;
+    bndBoxNdc.Get(xMin, yMin, zMin, xMax, yMax, zMax);
+    return std::max(xMax - xMin, yMax - yMin) * 0.5 * viewHeight;
+}
+
+} // namespace
+
+GraphicsPointCloudObject::GraphicsPointCloudObject(const PointCloudPtr& pointCloud)
+    : m_pointCloud(pointCloud)
+{
+    myDrawer->SetPointAspect(new Prs3d_PointAspect(Aspect_TOM_POINT, Quantity_NOC_YELLOW, 1.));
+    myDrawer->SetLineAspect(new Prs3d_LineAspect(Quantity_NOC_YELLOW, Aspect_TOL_SOLID, 1.));
+    this->SetDisplayMode(DisplayMode_Points);
+
+    // Coarse preview until the level of detail is updated for a view
+    if (!m_pointCloud.IsNull()) {
+        const PointCloud::Node& rootNode = m_pointCloud->rootNode();
+        const uint64_t previewCount = std::min(m_pointBudget, 8 * NodeSampleSize);
+        m_vecNodeLod.push_back({ 0, std::min(rootNode.pointCount, previewCount) });
+    }
+}
+
+uint64_t GraphicsPointCloudObject::displayedPointCount() const
+{
+    uint64_t count = 0;
+    for (const NodeLevelOfDetail& nodeLod : m_vecNodeLod)
+        count += nodeLod.pointCount;
+
+    return count;
+}
+
+bool GraphicsPointCloudObject::updateLevelOfDetail(const Handle_V3d_View& view)
+{
+    if (m_pointCloud.IsNull() || view.IsNull())
+        return false;
+
+    const Handle_Graphic3d_Camera& camera = view->Camera();
+    const int viewHeight = std::max(GraphicsUtils::AspectWindow_height(view->Window()), 1);
+    const gp_Trsf trsf = this->Transformation();
+    Span<const PointCloud::Node> nodes = m_pointCloud->nodes();
+
+    // Refine first the nodes having the largest size on screen, until point budget is reached
+    using QueueItem = std::pair<double, int32_t>; // Screen size, node index
+    std::priority_queue<QueueItem> queueNode;
+    std::vector<NodeLevelOfDetail> vecNodeLod;
+    uint64_t pointCount = 0;
+    const double rootScreenSize = nodeScreenSize(camera, viewHeight, trsf, nodes[0]);
+    if (rootScreenSize >= 0 && nodes[0].pointCount > 0) {
+        queueNode.push({ rootScreenSize, 0 });
+        pointCount = nodeSampleCount(nodes[0]);
+    }
+
+    std::vector<QueueItem> vecChild;
+    while (!queueNode.empty()) {
+        const QueueItem item = queueNode.top();
+        queueNode.pop();
+        const PointCloud::Node& node = nodes[item.second];
+        const bool canRefine =
+                node.pointCount > NodeSampleSize
+                && !node.isLeaf()
+                && item.first > MinRefineScreenSize;
+        if (canRefine) {
+            vecChild.clear();
+            uint64_t childrenPointCount = 0;
+            for (int32_t iChild : node.children) {
+                if (iChild < 0)
+                    continue;
+
+                const double childScreenSize = nodeScreenSize(camera, viewHeight, trsf, nodes[iChild]);
+                if (childScreenSize >= 0) {
+                    vecChild.push_back({ childScreenSize, iChild });
+                    childrenPointCount += nodeSampleCount(nodes[iChild]);
+                }
+            }
+
+            const uint64_t refinedPointCount = pointCount - nodeSampleCount(node) + childrenPointCount;
+            if (refinedPointCount <= m_pointBudget) {
+                pointCount = refinedPointCount;
+                for (const QueueItem& child : vecChild)
+                    queueNode.push(child);
+
+                continue;
+            }
+        }
+
+        vecNodeLod.push_back({ item.second, nodeSampleCount(node) });
+    }
+
+    std::sort(vecNodeLod.begin(), vecNodeLod.end(), [](const NodeLevelOfDetail& lhs, const NodeLevelOfDetail& rhs) {
+        return lhs.nodeIndex < rhs.nodeIndex;
+    });
+    if (vecNodeLod == m_vecNodeLod)
+        return false;
+
+    m_vecNodeLod = std::move(vecNodeLod);
+    return true;
+}
+
+void GraphicsPointCloudObject::SetColor(const Quantity_Color& color)
+{
+    AIS_InteractiveObject::SetColor(color);
+    myDrawer->PointAspect()->SetColor(color);
+    myDrawer->LineAspect()->SetColor(color);
+}
+
+bool GraphicsPointCloudObject::AcceptDisplayMode(const int mode) const
+{
+    return mode == DisplayMode_Points || mode == DisplayMode_BoundingBox;
+}
+
+void GraphicsPointCloudObject::ComputeSelection(
+        const opencascade::handle<SelectMgr_Selection>& sel, const int mode)
+{
+    if (mode != 0 || m_pointCloud.IsNull() || m_pointCloud->boundingBox().IsVoid())
+        return;
+
+    Handle_SelectMgr_EntityOwner owner = new SelectMgr_EntityOwner(this);
+    sel->Add(new Select3D_SensitiveBox(owner, m_pointCloud->boundingBox()));
+}
+
+void GraphicsPointCloudObject::Compute(
+        const opencascade::handle<PrsMgr_PresentationManager3d>&,
+        const opencascade::handle<Prs3d_Presentation>& pres,
+        const int mode)
+{
+    if (m_pointCloud.IsNull())
+        return;
+
+    if (mode == DisplayMode_BoundingBox) {
+        const PointCloud::Node& rootNode = m_pointCloud->rootNode();
+        Handle_Graphic3d_ArrayOfSegments segments = new Graphic3d_ArrayOfSegments(8, 24);
+        for (int i = 0; i < 8; ++i)
+            segments->AddVertex(nodeCorner(rootNode, i));
+
+        // Box edges connect corners differing by one coordinate
+        for (int i = 0; i < 8; ++i) {
+            for (int axisBit : { 1, 2, 4 }) {
+                if ((i & axisBit) == 0) {
+                    segments->AddEdge(i + 1);
+                    segments->AddEdge((i | axisBit) + 1);
+                }
+            }
+        }
+
+        Handle_Graphic3d_Group group = pres->NewGroup();
+        group->SetGroupPrimitivesAspect(myDrawer->LineAspect()->Aspect());
+        group->AddPrimitiveArray(segments);
+        return;
+    }
+
+    const uint64_t pointCount = this->displayedPointCount();
+    if (pointCount == 0 || pointCount > uint64_t(std::numeric_limits<int>::max()))
+        return;
+
+    // Points of a node are shuffled, so picking them with a stride gives an even subsampling
+    Handle_Graphic3d_ArrayOfPoints points = new Graphic3d_ArrayOfPoints(int(pointCount));
+    Span<const PointCloud::Node> nodes = m_pointCloud->nodes();
+    for (const NodeLevelOfDetail& nodeLod : m_vecNodeLod) {
+        Span<const PointCloud::Point> nodePoints = m_pointCloud->nodePoints(nodes[nodeLod.nodeIndex]);
+        const double stride = double(nodePoints.size()) / double(nodeLod.pointCount);
+        for (uint64_t i = 0; i < nodeLod.pointCount; ++i)
+            points->AddVertex(nodePoints[uint64_t(i * stride)]);
+    }
+
+    Handle_Graphic3d_Group group = pres->NewGroup();
+    group->SetGroupPrimitivesAspect(myDrawer->PointAspect()->Aspect());
+    group->AddPrimitiveArray(points);
+}
+
+} // namespace Mayo
@@ -0,0 +1,90 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "../base/point_cloud.h"
+#include "../base/tkernel_utils.h"
+
+#include <AIS_InteractiveObject.hxx>
+#include <Prs3d_Presentation.hxx>
+#include <PrsMgr_PresentationManager3d.hxx>
+#include <SelectMgr_Selection.hxx>
+#include <V3d_View.hxx>
+#include <vector>
+
+#if OCC_VERSION_HEX < OCC_VERSION_CHECK(7, 5, 0)
+#  include <Prs3d_Projector.hxx>
+#endif
+
+namespace Mayo {
+
+class GraphicsPointCloudObject;
+DEFINE_STANDARD_HANDLE(GraphicsPointCloudObject, AIS_InteractiveObject)
+
+// Graphics object displaying a subset of the octree nodes of a PointCloud: the nodes visible in a
+// view, each one at a level of detail depending on its size on screen
+// Presentation holds at most pointBudget() points, so GPU memory doesn't grow with the cloud size
+// Level of detail has to be updated explicitly with updateLevelOfDetail() when the camera changes
+class GraphicsPointCloudObject : public AIS_InteractiveObject {
+public:
+    enum DisplayMode {
+        DisplayMode_Points = 0,
+        DisplayMode_BoundingBox = 1
+    };
+
+    GraphicsPointCloudObject(const PointCloudPtr& pointCloud);
+
+    const PointCloudPtr& pointCloud() const { return m_pointCloud; }
+
+    // Maximum count of points in the presentation
+    uint64_t pointBudget() const { return m_pointBudget; }
+    void setPointBudget(uint64_t count) { m_pointBudget = count; }
+
+    // Count of points in the presentation for the current level of detail
+    uint64_t displayedPointCount() const;
+
+    // Selects the octree nodes visible in 'view' and their level of detail
+    // Returns true if selection changed, presentation has then to be recomputed
+    bool updateLevelOfDetail(const Handle_V3d_View& view);
+
+    void SetColor(const Quantity_Color& color) override;
+    bool AcceptDisplayMode(const int mode) const override;
+
+    void ComputeSelection(
+            const opencascade::handle<SelectMgr_Selection>& sel,
+            const int mode) override;
+
+    DEFINE_STANDARD_RTTI_INLINE(GraphicsPointCloudObject, AIS_InteractiveObject)
+
+protected:
+    void Compute(
+            const opencascade::handle<PrsMgr_PresentationManager3d>& pm,
+            const opencascade::handle<Prs3d_Presentation>& pres,
+            const int mode) override;
+
+#if OCC_VERSION_HEX < OCC_VERSION_CHECK(7, 5, 0)
+    void Compute(
+            const opencascade::handle<Prs3d_Projector>&,
+            const opencascade::handle<Prs3d_Presentation>&) override
+    {}
+#endif
+
+private:
+    struct NodeLevelOfDetail {
+        int32_t nodeIndex = -1;
+        uint64_t pointCount = 0; // Count of node points in the presentation
+        bool operator==(const NodeLevelOfDetail& other) const {
+            return this->nodeIndex == other.nodeIndex && this->pointCount == other.pointCount;
+        }
+    };
+
+    PointCloudPtr m_pointCloud;
+    uint64_t m_pointBudget = 10000000;
+    std::vector<NodeLevelOfDetail> m_vecNodeLod;
+};
+
+} // namespace Mayo
@@ -6,22 +6,35 @@
 
 #include "graphics_scene.h"
 
+#include "../base/bvh.h"
 #include "../base/tkernel_utils.h"
 #include "graphics_utils.h"
 
+#include <AIS_Selection.hxx>
 #include <Graphic3d_GraphicDriver.hxx>
+#include <Graphic3d_WorldViewProjState.hxx>
+#include <Image_PixMap.hxx>
+#include <SelectMgr_SelectionManager.hxx>
+#include <TColStd_ListOfInteger.hxx>
+#include <V3d_ImageDumpOptions.hxx>
 #include <V3d_TypeOfOrientation.hxx>
+#include <gp_Lin.hxx>
 #include <QtCore/QPoint>
+#include <QtCore/QTimer>
+#include <algorithm>
+#include <list>
+#include <unordered_map>
+#include <vector>
 
 namespace Mayo {
 namespace Internal {
 
-// Defined in graphics_create_driver.cpp
-Handle_Graphic3d_GraphicDriver createGfxDriver();
+// Defined in gui_create_gfx_driver.cpp
+Handle_Graphic3d_GraphicDriver sharedGfxDriver();
 
 static Handle_V3d_Viewer createOccViewer()
 {
-    Handle_V3d_Viewer viewer = new V3d_Viewer(createGfxDriver());
+    Handle_V3d_Viewer viewer = new V3d_Viewer(sharedGfxDriver());
     viewer->SetDefaultViewSize(1000.);
     viewer->SetDefaultViewProj(V3d_XposYnegZpos);
     viewer->SetComputedMode(true);
@@ -40,11 +53,14 @@ namespace {
 class InteractiveContext : public AIS_InteractiveContext {
     DEFINE_STANDARD_RTTI_INLINE(InteractiveContext, AIS_InteractiveContext)
 public:
-    InteractiveContext(const Handle_V3d_Viewer& viewer)
-        : AIS_InteractiveContext(viewer)
+    InteractiveContext(const Handle_V3d_Viewer& viewer, GraphicsScene* scene)
+        : AIS_InteractiveContext(viewer),
+          m_scene(scene)
     {}
 
     constexpr const GraphicsOwnerPtr& member_myLastPicked() const { return myLastPicked; }
+
+    GraphicsScene* const m_scene;
 };
 
 DEFINE_STANDARD_HANDLE(InteractiveContext, AIS_InteractiveContext)
@@ -57,7 +73,36 @@ public:
     Handle_InteractiveContext m_aisContext;
     std::unordered_set<const AIS_InteractiveObject*> m_setClipPlaneSensitive;
     bool m_isRedrawBlocked = false;
+    std::function<void()> m_fnRedrawRequestHandler;
     SelectionMode m_selectionMode = SelectionMode::Single;
+
+    // Batched changes
+    bool m_isRedrawRequested = false;
+    bool m_isFlushScheduled = false;
+    std::vector<GraphicsObjectPtr> m_vecPendingRedisplay;
+    std::unordered_set<GraphicsObjectPtr> m_setPendingRedisplay;
+    std::unordered_map<GraphicsObjectPtr, bool> m_mapPendingVisible;
+    std::unordered_map<GraphicsObjectPtr, gp_Trsf> m_mapPendingTrsf;
+
+    // Lazy selection, object -> selection modes to be activated
+    std::unordered_map<GraphicsObjectPtr, std::vector<int>> m_mapPendingSelectionModes;
+    std::unordered_set<GraphicsObjectPtr> m_setLazySelectionObject;
+    // Lazy objects having sub-shape selection modes active, most recently hit first
+    std::list<GraphicsObjectPtr> m_listSubShapeSelectionObject;
+    std::unordered_map<GraphicsObjectPtr, std::list<GraphicsObjectPtr>::iterator> m_mapSubShapeSelectionObject;
+    int m_subShapeSelectionCacheCapacity = 64;
+
+    // Depth buffer picking
+    bool m_isPickingBufferOn = false;
+    bool m_isPickingBufferDirty = true;
+    QTimer* m_pickingBufferTimer = nullptr;
+    Handle_V3d_View m_pickingBufferView;
+    Image_PixMap m_pickingDepthMap;
+    Handle_Graphic3d_Camera m_pickingCamera;
+    Graphic3d_WorldViewProjState m_pickingCameraState;
+    Bvh m_pickingBvh;
+    std::vector<GraphicsObjectPtr> m_vecPickingObject;
+    std::vector<Bvh::Box> m_vecPickingObjectBox;
 };
 
 GraphicsScene::GraphicsScene(QObject* parent)
@@ -65,7 +110,12 @@ GraphicsScene::GraphicsScene(QObject* parent)
       d(new Private)
 {
     d->m_v3dViewer = Internal::createOccViewer();
-    d->m_aisContext = new InteractiveContext(d->m_v3dViewer);
+    d->m_aisContext = new InteractiveContext(d->m_v3dViewer, this);
+    // Depth buffer is read back once there was no hover request on a stale buffer for a while
+    d->m_pickingBufferTimer = new QTimer(this);
+    d->m_pickingBufferTimer->setSingleShot(true);
+    d->m_pickingBufferTimer->setInterval(250);
+    QObject::connect(d->m_pickingBufferTimer, &QTimer::timeout, this, &GraphicsScene::updatePickingBuffer);
 }
 
 GraphicsScene::~GraphicsScene()
@@ -73,6 +123,15 @@ GraphicsScene::~GraphicsScene()
     delete d;
 }
 
+GraphicsScene* GraphicsScene::fromObject(const GraphicsObjectPtr& object)
+{
+    if (object.IsNull())
+        return nullptr;
+
+    auto context = Handle_InteractiveContext::DownCast(object->GetContext());
+    return context ? context->m_scene : nullptr;
+}
+
 opencascade::handle<V3d_View> GraphicsScene::createV3dView()
 {
     return d->m_v3dViewer->CreateView();
@@ -98,22 +157,56 @@ bool GraphicsScene::hiddenLineDrawingOn() const
     return d->m_aisContext->DrawHiddenLine();
 }
 
-void GraphicsScene::addObject(const GraphicsObjectPtr& object)
+void GraphicsScene::addObject(const GraphicsObjectPtr& object, AddObjectFlags flags)
 {
-    if (object)
+    if (!object)
+        return;
+
+    if (flags & (AddObjectDisableSelectionMode | AddObjectLazySelectionMode))
+        d->m_aisContext->Display(object, object->DisplayMode(), -1, false);
+    else
         d->m_aisContext->Display(object, false);
+
+    if (flags & AddObjectLazySelectionMode) {
+        d->m_mapPendingSelectionModes.insert({ object, { 0 } });
+        d->m_setLazySelectionObject.insert(object);
+    }
+
+    this->invalidatePickingBuffer();
 }
 
 void GraphicsScene::eraseObject(const GraphicsObjectPtr& object)
 {
     GraphicsUtils::AisContext_eraseObject(d->m_aisContext, object);
     d->m_setClipPlaneSensitive.erase(object.get());
+    d->m_mapPendingVisible.erase(object);
+    d->m_mapPendingTrsf.erase(object);
+    d->m_mapPendingSelectionModes.erase(object);
+    d->m_setLazySelectionObject.erase(object);
+    auto itSubShapeSelection = d->m_mapSubShapeSelectionObject.find(object);
+    if (itSubShapeSelection != d->m_mapSubShapeSelectionObject.end()) {
+        d->m_listSubShapeSelectionObject.erase(itSubShapeSelection->second);
+        d->m_mapSubShapeSelectionObject.erase(itSubShapeSelection);
+    }
+
+    if (d->m_setPendingRedisplay.erase(object) != 0) {
+        auto& vec = d->m_vecPendingRedisplay;
+        vec.erase(std::remove(vec.begin(), vec.end(), object), vec.end());
+    }
+
+    this->invalidatePickingBuffer();
 }
 
 void GraphicsScene::redraw()
 {
-    if (!d->m_isRedrawBlocked)
-        d->m_aisContext->UpdateCurrentViewer();
+    if (d->m_isRedrawBlocked || this->hasPendingChanges()) {
+        // Replayed by flushPendingChanges(), after pending changes are applied
+        d->m_isRedrawRequested = true;
+        this->scheduleFlush();
+    }
+    else {
+        this->redrawViews();
+    }
 }
 
 bool GraphicsScene::isRedrawBlocked() const
@@ -124,21 +217,182 @@ bool GraphicsScene::isRedrawBlocked() const
 void GraphicsScene::blockRedraw(bool on)
 {
     d->m_isRedrawBlocked = on;
+    if (!on && (this->hasPendingChanges() || d->m_isRedrawRequested))
+        this->scheduleFlush();
+}
+
+bool GraphicsScene::hasPendingChanges() const
+{
+    return !d->m_vecPendingRedisplay.empty()
+            || !d->m_mapPendingVisible.empty()
+            || !d->m_mapPendingTrsf.empty();
+}
+
+void GraphicsScene::flushPendingChanges()
+{
+    d->m_isFlushScheduled = false;
+    if (d->m_isRedrawBlocked)
+        return; // Flush is scheduled again once redraw gets unblocked
+
+    for (const auto& [object, trsf] : d->m_mapPendingTrsf)
+        d->m_aisContext->SetLocation(object, trsf);
+
+    for (const auto& [object, isVisible] : d->m_mapPendingVisible)
+        GraphicsUtils::AisContext_setObjectVisible(d->m_aisContext, object, isVisible);
+
+    for (const GraphicsObjectPtr& object : d->m_vecPendingRedisplay)
+        object->Redisplay(true); // All modes
+
+    const bool isRedrawRequired = d->m_isRedrawRequested || this->hasPendingChanges();
+    if (this->hasPendingChanges())
+        this->invalidatePickingBuffer();
+
+    d->m_mapPendingTrsf.clear();
+    d->m_mapPendingVisible.clear();
+    d->m_vecPendingRedisplay.clear();
+    d->m_setPendingRedisplay.clear();
+    d->m_isRedrawRequested = false;
+    if (isRedrawRequired)
+        this->redrawViews();
+}
+
+void GraphicsScene::setRedrawRequestHandler(const std::function<void()>& fn)
+{
+    d->m_fnRedrawRequestHandler = fn;
+}
+
+void GraphicsScene::redrawViews()
+{
+    if (d->m_fnRedrawRequestHandler)
+        d->m_fnRedrawRequestHandler();
+    else
+        d->m_aisContext->UpdateCurrentViewer();
+}
+
+void GraphicsScene::requestObjectRedisplay(const GraphicsObjectPtr& object)
+{
+    if (object.IsNull())
+        return;
+
+    if (d->m_setPendingRedisplay.insert(object).second)
+        d->m_vecPendingRedisplay.push_back(object);
+
+    this->scheduleFlush();
 }
 
 void GraphicsScene::recomputeObjectPresentation(const GraphicsObjectPtr& object)
 {
     d->m_aisContext->Redisplay(object, false);
+    this->invalidatePickingBuffer();
+}
+
+void GraphicsScene::releaseObjectPresentation(const GraphicsObjectPtr& object, int displayMode)
+{
+    if (object.IsNull())
+        return;
+
+    d->m_aisContext->MainPrsMgr()->Clear(object, displayMode);
+    this->invalidatePickingBuffer();
+}
+
+void GraphicsScene::releaseObjectResources(const GraphicsObjectPtr& object)
+{
+    if (object.IsNull())
+        return;
+
+    std::vector<int> vecDisplayMode;
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 4, 0)
+    for (const Handle_PrsMgr_Presentation& prs : object->Presentations())
+        vecDisplayMode.push_back(prs->Mode());
+#else
+    for (const PrsMgr_ModedPresentation& prs : object->Presentations())
+        vecDisplayMode.push_back(prs.Mode());
+#endif
+    for (int displayMode : vecDisplayMode)
+        d->m_aisContext->MainPrsMgr()->Clear(object, displayMode);
+
+    // Sensitive entities are released, full update forces their computation on next activation
+    auto fnReleaseSelection = [=](const Handle_SelectMgr_Selection& selection) {
+        selection->Clear();
+        d->m_aisContext->SelectionManager()->ClearSelectionStructures(object, selection->Mode());
+        selection->UpdateStatus(SelectMgr_TOU_Full);
+    };
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 4, 0)
+    for (const Handle_SelectMgr_Selection& selection : object->Selections())
+        fnReleaseSelection(selection);
+#else
+    for (object->Init(); object->More(); object->Next())
+        fnReleaseSelection(object->CurrentSelection());
+#endif
+
+    this->invalidatePickingBuffer();
 }
 
 void GraphicsScene::activateObjectSelection(const GraphicsObjectPtr& object, int mode)
 {
-    d->m_aisContext->Activate(object, mode);
+    auto itPending = d->m_mapPendingSelectionModes.find(object);
+    if (itPending != d->m_mapPendingSelectionModes.end()) {
+        std::vector<int>& vecMode = itPending->second;
+        if (std::find(vecMode.cbegin(), vecMode.cend(), mode) == vecMode.cend())
+            vecMode.push_back(mode);
+    }
+    else if (mode != 0
+             && d->m_setLazySelectionObject.find(object) != d->m_setLazySelectionObject.cend()
+             && !d->m_aisContext->IsSelected(object))
+    {
+        // Building sensitive entities of all sub-shapes is costly, wait for the object to be hit
+        d->m_mapPendingSelectionModes.insert({ object, { mode } });
+    }
+    else {
+        d->m_aisContext->Activate(object, mode);
+        if (mode != 0 && d->m_setLazySelectionObject.find(object) != d->m_setLazySelectionObject.cend())
+            this->touchSubShapeSelection(object);
+    }
 }
 
 void GraphicsScene::deactivateObjectSelection(const Mayo::GraphicsObjectPtr &object, int mode)
 {
-    d->m_aisContext->Deactivate(object, mode);
+    auto itPending = d->m_mapPendingSelectionModes.find(object);
+    if (itPending != d->m_mapPendingSelectionModes.end()) {
+        std::vector<int>& vecMode = itPending->second;
+        vecMode.erase(std::remove(vecMode.begin(), vecMode.end(), mode), vecMode.end());
+    }
+    else {
+        d->m_aisContext->Deactivate(object, mode);
+    }
+}
+
+bool GraphicsScene::isObjectSelectionPending(const GraphicsObjectPtr& object) const
+{
+    return d->m_mapPendingSelectionModes.find(object) != d->m_mapPendingSelectionModes.cend();
+}
+
+void GraphicsScene::activatePendingObjectSelection(const GraphicsObjectPtr& object)
+{
+    auto itPending = d->m_mapPendingSelectionModes.find(object);
+    if (itPending == d->m_mapPendingSelectionModes.end())
+        return;
+
+    const std::vector<int> vecMode = std::move(itPending->second);
+    d->m_mapPendingSelectionModes.erase(itPending);
+    for (int mode : vecMode)
+        d->m_aisContext->Activate(object, mode);
+
+    if (std::any_of(vecMode.cbegin(), vecMode.cend(), [](int mode) { return mode != 0; }))
+        this->touchSubShapeSelection(object);
+}
+
+int GraphicsScene::subShapeSelectionCacheCapacity() const
+{
+    return d->m_subShapeSelectionCacheCapacity;
+}
+
+void GraphicsScene::setSubShapeSelectionCacheCapacity(int capacity)
+{
+    d->m_subShapeSelectionCacheCapacity = std::max(0, capacity);
+    const auto cacheCapacity = size_t(d->m_subShapeSelectionCacheCapacity);
+    while (cacheCapacity > 0 && d->m_listSubShapeSelectionObject.size() > cacheCapacity)
+        this->evictSubShapeSelection(d->m_listSubShapeSelectionObject.back());
 }
 
 void GraphicsScene::addSelectionFilter(const Handle_SelectMgr_Filter& filter)
@@ -159,6 +413,7 @@ void GraphicsScene::clearSelectionFilters()
 void GraphicsScene::setObjectDisplayMode(const GraphicsObjectPtr& object, int displayMode)
 {
     d->m_aisContext->SetDisplayMode(object, displayMode, false);
+    this->invalidatePickingBuffer();
 }
 
 bool GraphicsScene::isObjectClipPlaneSensitive(const GraphicsObjectPtr& object) const
@@ -182,22 +437,49 @@ void GraphicsScene::setObjectClipPlaneSensitive(const GraphicsObjectPtr& object,
 
 bool GraphicsScene::isObjectVisible(const GraphicsObjectPtr& object) const
 {
+    auto itPending = d->m_mapPendingVisible.find(object);
+    if (itPending != d->m_mapPendingVisible.cend())
+        return itPending->second;
+
     return d->m_aisContext->IsDisplayed(object);
 }
 
 void GraphicsScene::setObjectVisible(const GraphicsObjectPtr& object, bool on)
 {
-    GraphicsUtils::AisContext_setObjectVisible(d->m_aisContext, object, on);
+    if (d->m_isRedrawBlocked) {
+        d->m_mapPendingVisible.insert_or_assign(object, on);
+    }
+    else {
+        d->m_mapPendingVisible.erase(object);
+        GraphicsUtils::AisContext_setObjectVisible(d->m_aisContext, object, on);
+        this->invalidatePickingBuffer();
+    }
+}
+
+void GraphicsScene::setObjectVisibleInView(const GraphicsObjectPtr& object, const Handle_V3d_View& view, bool on)
+{
+    d->m_aisContext->SetViewAffinity(object, view, on);
 }
 
 gp_Trsf GraphicsScene::objectTransformation(const GraphicsObjectPtr& object) const
 {
+    auto itPending = d->m_mapPendingTrsf.find(object);
+    if (itPending != d->m_mapPendingTrsf.cend())
+        return itPending->second;
+
     return d->m_aisContext->Location(object);
 }
 
 void GraphicsScene::setObjectTransformation(const GraphicsObjectPtr &object, const gp_Trsf &trsf)
 {
-    d->m_aisContext->SetLocation(object, trsf);
+    if (d->m_isRedrawBlocked) {
+        d->m_mapPendingTrsf.insert_or_assign(object, trsf);
+    }
+    else {
+        d->m_mapPendingTrsf.erase(object);
+        d->m_aisContext->SetLocation(object, trsf);
+        this->invalidatePickingBuffer();
+    }
 }
 
 GraphicsOwnerPtr GraphicsScene::firstSelectedOwner() const
@@ -220,6 +502,231 @@ AIS_InteractiveContext* GraphicsScene::aisContextPtr() const
     return d->m_aisContext.get();
 }
 
+void GraphicsScene::activatePendingSelectionsAt(const QPoint& pos, const Handle_V3d_View& view)
+{
+    if (d->m_mapPendingSelectionModes.empty() || view.IsNull())
+        return;
+
+    double x, y, z, dx, dy, dz;
+    view->ConvertWithProj(pos.x(), pos.y(), x, y, z, dx, dy, dz);
+    const gp_Lin pickRay(gp_Pnt(x, y, z), gp_Dir(dx, dy, dz));
+    const double tolerance = view->Convert(int(this->mainSelector()->PixelTolerance()) + 1);
+
+    auto fnIsHit = [&](const GraphicsObjectPtr& object) {
+        if (!d->m_aisContext->IsDisplayed(object))
+            return false;
+
+        Bnd_Box bndBox = GraphicsUtils::AisObject_boundingBox(object);
+        if (bndBox.IsVoid())
+            return false;
+
+        bndBox.Enlarge(tolerance);
+        return !bndBox.IsOut(pickRay);
+    };
+
+    // Coarse test on bounding boxes, only the objects not activated yet are visited
+    std::vector<GraphicsObjectPtr> vecHitObject;
+    for (const auto& [object, vecMode] : d->m_mapPendingSelectionModes) {
+        if (fnIsHit(object))
+            vecHitObject.push_back(object);
+    }
+
+    // Objects with sub-shape selection already active are kept as recently used
+    std::vector<GraphicsObjectPtr> vecHitCachedObject;
+    for (const GraphicsObjectPtr& object : d->m_listSubShapeSelectionObject) {
+        if (fnIsHit(object))
+            vecHitCachedObject.push_back(object);
+    }
+
+    for (const GraphicsObjectPtr& object : vecHitCachedObject)
+        this->touchSubShapeSelection(object);
+
+    for (const GraphicsObjectPtr& object : vecHitObject)
+        this->activatePendingObjectSelection(object);
+}
+
+bool GraphicsScene::isPickingBufferValid(const Handle_V3d_View& view) const
+{
+    if (d->m_isPickingBufferDirty || view.IsNull() || view != d->m_pickingBufferView)
+        return false;
+
+    if (d->m_pickingDepthMap.IsEmpty() || view->Window().IsNull())
+        return false;
+
+    int width, height;
+    view->Window()->Size(width, height);
+    if (size_t(width) != d->m_pickingDepthMap.Width() || size_t(height) != d->m_pickingDepthMap.Height())
+        return false;
+
+    return !view->Camera()->WorldViewProjState().IsChanged(d->m_pickingCameraState);
+}
+
+void GraphicsScene::invalidatePickingBuffer()
+{
+    d->m_isPickingBufferDirty = true;
+}
+
+void GraphicsScene::updatePickingBuffer()
+{
+    const Handle_V3d_View view = d->m_pickingBufferView;
+    if (!d->m_isPickingBufferOn || view.IsNull() || view->Window().IsNull() || !view->Window()->IsMapped())
+        return;
+
+    if (this->hasPendingChanges() || d->m_isRedrawBlocked) {
+        d->m_pickingBufferTimer->start(); // Scene isn't idle, try later
+        return;
+    }
+
+    int width, height;
+    view->Window()->Size(width, height);
+    Image_PixMap& depthMap = d->m_pickingDepthMap;
+    depthMap.Clear();
+    depthMap.SetTopDown(true);
+    V3d_ImageDumpOptions dumpOptions;
+    dumpOptions.BufferType = Graphic3d_BT_Depth;
+    dumpOptions.Width = width;
+    dumpOptions.Height = height;
+    // Renders one frame offscreen, the on-screen image is left as is
+    if (!view->ToPixMap(depthMap, dumpOptions)) {
+        depthMap.Clear();
+        return;
+    }
+
+    d->m_pickingCamera = new Graphic3d_Camera(view->Camera());
+    d->m_pickingCameraState = view->Camera()->WorldViewProjState();
+
+    // Bounding boxes of the displayed objects, as they are at the time the depths are read
+    d->m_vecPickingObject.clear();
+    d->m_vecPickingObjectBox.clear();
+    this->foreachDisplayedObject([&](const GraphicsObjectPtr& object) {
+        const Bnd_Box bndBox = GraphicsUtils::AisObject_boundingBox(object);
+        if (bndBox.IsVoid())
+            return;
+
+        Bvh::Box box;
+        box.add(bndBox.CornerMin());
+        box.add(bndBox.CornerMax());
+        d->m_vecPickingObject.push_back(object);
+        d->m_vecPickingObjectBox.push_back(box);
+    });
+    d->m_pickingBvh = Bvh::build(d->m_vecPickingObjectBox);
+    d->m_isPickingBufferDirty = false;
+}
+
+bool GraphicsScene::activatePendingSelectionsFromPickingBuffer(const QPoint& pos, const Handle_V3d_View& view)
+{
+    const Image_PixMap& depthMap = d->m_pickingDepthMap;
+    const int width = int(depthMap.Width());
+    const int height = int(depthMap.Height());
+    if (pos.x() < 0 || pos.y() < 0 || pos.x() >= width || pos.y() >= height)
+        return false;
+
+    // Nearest depth within the pixel tolerance, so thin edges and vertices are still detected
+    const int pixelTolerance = int(this->mainSelector()->PixelTolerance());
+    float depth = 1.f;
+    int col = pos.x();
+    int row = pos.y();
+    for (int iRow = std::max(0, pos.y() - pixelTolerance); iRow <= std::min(height - 1, pos.y() + pixelTolerance); ++iRow) {
+        for (int iCol = std::max(0, pos.x() - pixelTolerance); iCol <= std::min(width - 1, pos.x() + pixelTolerance); ++iCol) {
+            const float pixelDepth = depthMap.Value<float>(iRow, iCol);
+            if (pixelDepth < depth) {
+                depth = pixelDepth;
+                row = iRow;
+                col = iCol;
+            }
+        }
+    }
+
+    if (depth >= 1.f)
+        return false; // Background
+
+    // Pixel center and depth to normalized device coordinates, then to world space
+    const gp_Pnt ndcPnt(2. * (col + 0.5) / width - 1.,
+                        1. - 2. * (row + 0.5) / height,
+                        2. * depth - 1.);
+    const gp_Pnt pnt = d->m_pickingCamera->UnProject(ndcPnt);
+    const double tolerance = view->Convert(pixelTolerance + 1);
+    const double sqrTolerance = tolerance * tolerance;
+
+    std::vector<GraphicsObjectPtr> vecHitObject;
+    d->m_pickingBvh.traverse(
+                [=](const Bvh::Box& box) { return box.squareDistance(pnt) <= sqrTolerance; },
+                [&](int iItem) {
+        if (d->m_vecPickingObjectBox.at(iItem).squareDistance(pnt) <= sqrTolerance)
+            vecHitObject.push_back(d->m_vecPickingObject.at(iItem));
+    });
+
+    for (const GraphicsObjectPtr& object : vecHitObject) {
+        if (d->m_mapSubShapeSelectionObject.find(object) != d->m_mapSubShapeSelectionObject.cend())
+            this->touchSubShapeSelection(object);
+        else
+            this->activatePendingObjectSelection(object);
+    }
+
+    return true;
+}
+
+void GraphicsScene::touchSubShapeSelection(const GraphicsObjectPtr& object)
+{
+    auto& listObject = d->m_listSubShapeSelectionObject;
+    auto itObject = d->m_mapSubShapeSelectionObject.find(object);
+    if (itObject != d->m_mapSubShapeSelectionObject.end()) {
+        listObject.splice(listObject.begin(), listObject, itObject->second);
+    }
+    else {
+        listObject.push_front(object);
+        d->m_mapSubShapeSelectionObject.insert({ object, listObject.begin() });
+    }
+
+    const auto cacheCapacity = size_t(d->m_subShapeSelectionCacheCapacity);
+    while (cacheCapacity > 0 && listObject.size() > cacheCapacity)
+        this->evictSubShapeSelection(listObject.back());
+}
+
+void GraphicsScene::evictSubShapeSelection(const GraphicsObjectPtr& object)
+{
+    // Copy, 'object' might reference an item of the LRU list
+    const GraphicsObjectPtr evictedObject = object;
+    auto itObject = d->m_mapSubShapeSelectionObject.find(evictedObject);
+    if (itObject != d->m_mapSubShapeSelectionObject.end()) {
+        d->m_listSubShapeSelectionObject.erase(itObject->second);
+        d->m_mapSubShapeSelectionObject.erase(itObject);
+    }
+
+    TColStd_ListOfInteger listMode;
+    d->m_aisContext->ActivatedModes(evictedObject, listMode);
+    std::vector<int>& vecPendingMode = d->m_mapPendingSelectionModes[evictedObject];
+    for (int mode : listMode) {
+        if (mode == 0)
+            continue;
+
+        d->m_aisContext->Deactivate(evictedObject, mode);
+        if (evictedObject->HasSelection(mode)) {
+            // Sensitive entities are released, full update forces their computation on next
+            // activation
+            const Handle_SelectMgr_Selection& selection = evictedObject->Selection(mode);
+            selection->Clear();
+            d->m_aisContext->SelectionManager()->ClearSelectionStructures(evictedObject, mode);
+            selection->UpdateStatus(SelectMgr_TOU_Full);
+        }
+
+        if (std::find(vecPendingMode.cbegin(), vecPendingMode.cend(), mode) == vecPendingMode.cend())
+            vecPendingMode.push_back(mode);
+    }
+
+    if (vecPendingMode.empty())
+        d->m_mapPendingSelectionModes.erase(evictedObject);
+}
+
+void GraphicsScene::scheduleFlush()
+{
+    if (d->m_isFlushScheduled)
+        return;
+
+    d->m_isFlushScheduled = true;
+    QTimer::singleShot(0, this, &GraphicsScene::flushPendingChanges);
+}
+
 void GraphicsScene::toggleOwnerSelection(const GraphicsOwnerPtr& gfxOwner)
 {
     auto gfxObject = GraphicsObjectPtr::DownCast(
@@ -228,8 +735,101 @@ void GraphicsScene::toggleOwnerSelection(const GraphicsOwnerPtr& gfxOwner)
         d->m_aisContext->AddOrRemoveSelected(gfxOwner, false);
 }
 
+void GraphicsScene::selectOwners(Span<const GraphicsOwnerPtr> owners)
+{
+    this->updateOwnersSelection(owners, SelectionUpdate::Select);
+}
+
+void GraphicsScene::deselectOwners(Span<const GraphicsOwnerPtr> owners)
+{
+    this->updateOwnersSelection(owners, SelectionUpdate::Deselect);
+}
+
+void GraphicsScene::toggleOwnersSelection(Span<const GraphicsOwnerPtr> owners)
+{
+    this->updateOwnersSelection(owners, SelectionUpdate::Toggle);
+}
+
+void GraphicsScene::updateOwnersSelection(Span<const GraphicsOwnerPtr> owners, SelectionUpdate update)
+{
+    if (owners.empty())
+        return;
+
+    // AddOrRemoveSelected() would update the highlight of the object of each owner, instead the
+    // selection set is modified directly and highlighted once afterwards
+    // Current highlight is removed first, deselected owners would keep it otherwise
+    const Handle_InteractiveContext& context = d->m_aisContext;
+    const Handle_AIS_Selection& selection = context->Selection();
+    context->UnhilightSelected(false);
+    bool isSelectionChanged = false;
+    for (const GraphicsOwnerPtr& owner : owners) {
+        auto gfxObject = GraphicsObjectPtr::DownCast(
+                    owner ? owner->Selectable() : Handle_SelectMgr_SelectableObject());
+        if (!GraphicsUtils::AisObject_isVisible(gfxObject))
+            continue;
+
+        const bool isSelected = selection->IsSelected(owner);
+        const bool toSelect =
+                update == SelectionUpdate::Select || (update == SelectionUpdate::Toggle && !isSelected);
+        if (toSelect == isSelected)
+            continue;
+
+        if (toSelect) {
+            selection->AddSelect(owner);
+        }
+        else {
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+            selection->Select(owner, Handle_SelectMgr_Filter(), AIS_SelectionScheme_Remove, false);
+#else
+            selection->Select(owner); // Toggles selected state
+#endif
+        }
+
+        isSelectionChanged = true;
+    }
+
+    context->HilightSelected(false);
+    if (isSelectionChanged)
+        emit this->selectionChanged();
+}
+
+bool GraphicsScene::isPickingBufferOn() const
+{
+    return d->m_isPickingBufferOn;
+}
+
+void GraphicsScene::setPickingBufferOn(bool on)
+{
+    d->m_isPickingBufferOn = on;
+    if (!on) {
+        d->m_pickingBufferTimer->stop();
+        d->m_pickingBufferView.Nullify();
+        d->m_pickingDepthMap.Clear();
+        d->m_pickingCamera.Nullify();
+        d->m_pickingBvh = {};
+        d->m_vecPickingObject.clear();
+        d->m_vecPickingObjectBox.clear();
+        this->invalidatePickingBuffer();
+    }
+}
+
 void GraphicsScene::highlightAt(const QPoint& pos, const Handle_V3d_View& view)
 {
+    if (d->m_isPickingBufferOn && this->isPickingBufferValid(view)) {
+        if (!this->activatePendingSelectionsFromPickingBuffer(pos, view)) {
+            // Nothing under the cursor, no need to traverse the sensitive entities
+            d->m_aisContext->ClearDetected(true);
+            return;
+        }
+    }
+    else {
+        this->activatePendingSelectionsAt(pos, view);
+        if (d->m_isPickingBufferOn && !view.IsNull()) {
+            d->m_pickingBufferView = view;
+            d->m_pickingBufferTimer->start();
+        }
+    }
+
     d->m_aisContext->MoveTo(pos.x(), pos.y(), view, true);
 }
 
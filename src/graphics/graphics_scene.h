@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include "../base/span.h"
 #include "graphics_object_ptr.h"
 #include "graphics_owner_ptr.h"
 
@@ -13,6 +14,7 @@
 #include <V3d_Viewer.hxx>
 #include <V3d_View.hxx>
 #include <QtCore/QObject>
+#include <functional>
 #include <unordered_set>
 class QPoint;
 
@@ -26,6 +28,9 @@ public:
     GraphicsScene(QObject* parent = nullptr);
     ~GraphicsScene();
 
+    // Returns the scene where 'object' is displayed, or null if none
+    static GraphicsScene* fromObject(const GraphicsObjectPtr& object);
+
     opencascade::handle<V3d_View> createV3dView();
 
     const opencascade::handle<V3d_Viewer>& v3dViewer() const;
@@ -33,17 +38,59 @@ public:
     const opencascade::handle<StdSelect_ViewerSelector3d>& mainSelector() const;
     bool hiddenLineDrawingOn() const;
 
-    void addObject(const GraphicsObjectPtr& object);
+    enum AddObjectFlag {
+        AddObjectDefault = 0x0,
+        AddObjectDisableSelectionMode = 0x1, // Selection has to be activated explicitly afterwards
+        AddObjectLazySelectionMode = 0x2 // Selection is activated once needed, see below
+    };
+    using AddObjectFlags = unsigned;
+    void addObject(const GraphicsObjectPtr& object, AddObjectFlags flags = AddObjectDefault);
     void eraseObject(const GraphicsObjectPtr& object);
 
+    // -- Batched changes
+    // While redraw is blocked, redraw() requests and object visibility/transformation changes are
+    // recorded. They are applied along with pending redisplays by flushPendingChanges(), which is
+    // invoked once on next event loop iteration after redraw gets unblocked
     void redraw();
     bool isRedrawBlocked() const;
     void blockRedraw(bool on);
+    bool hasPendingChanges() const;
+    void flushPendingChanges();
 
-    void recomputeObjectPresentation(const GraphicsObjectPtr& object);
+    // Function called instead of redrawing the views right away, typically to coalesce redraws
+    // and pace them to the display refresh rate. Pass an empty function to restore default behavior
+    void setRedrawRequestHandler(const std::function<void()>& fn);
 
+    // Recomputes presentations of 'object' in all display modes, computation is deferred to next
+    // flush so successive requests for the same object are coalesced
+    void requestObjectRedisplay(const GraphicsObjectPtr& object);
+
+    void recomputeObjectPresentation(const GraphicsObjectPtr& object);
+    // Deletes the presentation of 'object' in 'displayMode' along with its graphic resources, it
+    // will be computed again once the object is displayed in that mode
+    // 'object' doesn't have to be in the scene(eg prototype of AIS_ConnectedInteractive objects)
+    void releaseObjectPresentation(const GraphicsObjectPtr& object, int displayMode);
+    // Deletes the presentations of 'object' in all display modes along with its sensitive entities,
+    // typically once the shape of the object was released. They're computed again once needed
+    void releaseObjectResources(const GraphicsObjectPtr& object);
+
+    // -- Lazy selection
+    // Objects added with AddObjectLazySelectionMode get their sensitive entities built only once
+    // their bounding box is hit by the picking ray of highlightAt(), or on explicit request with
+    // activatePendingObjectSelection()
+    // Until then activateObjectSelection()/deactivateObjectSelection() just record the modes
+    // Once activated, sub-shape selection modes(ie other than 0) of such objects are also deferred
+    // unless the object is currently selected, they're then activated on next hit of the object
     void activateObjectSelection(const GraphicsObjectPtr& object, int mode);
     void deactivateObjectSelection(const GraphicsObjectPtr& object, int mode);
+    bool isObjectSelectionPending(const GraphicsObjectPtr& object) const;
+    void activatePendingObjectSelection(const GraphicsObjectPtr& object);
+
+    // Maximum count of lazy objects having sub-shape selection modes active. Beyond, the modes of
+    // the least recently hit object are deactivated and its sensitive entities released, these
+    // modes are pending again. Cache is unlimited if capacity is 0
+    int subShapeSelectionCacheCapacity() const;
+    void setSubShapeSelectionCacheCapacity(int capacity);
 
     void addSelectionFilter(const Handle_SelectMgr_Filter& filter);
     void removeSelectionFilter(const Handle_SelectMgr_Filter& filter);
@@ -56,6 +103,8 @@ public:
 
     bool isObjectVisible(const GraphicsObjectPtr& object) const;
     void setObjectVisible(const GraphicsObjectPtr& object, bool on);
+    // Per-view display of a visible object(view affinity), eg to skip it in a single view
+    void setObjectVisibleInView(const GraphicsObjectPtr& object, const Handle_V3d_View& view, bool on);
 
     gp_Trsf objectTransformation(const GraphicsObjectPtr& object) const;
     void setObjectTransformation(const GraphicsObjectPtr& object, const gp_Trsf& trsf);
@@ -66,6 +115,16 @@ public:
     SelectionMode selectionMode() const;
     void setSelectionMode(SelectionMode mode);
 
+    // -- Depth buffer picking
+    // When enabled, the depth buffer of the view used by highlightAt() is read back offscreen once
+    // the camera and the scene are idle. Hovering then reads the depth of the pixel under the
+    // cursor: background pixels are resolved without any selection traversal, otherwise the 3D
+    // point is looked up in a BVH of the object bounding boxes and only the objects containing
+    // it get their pending selection activated(see "Lazy selection")
+    // Until the buffer is up to date, highlightAt() falls back to the picking ray test
+    bool isPickingBufferOn() const;
+    void setPickingBufferOn(bool on);
+
     const GraphicsOwnerPtr& currentHighlightedOwner() const;
     void highlightAt(const QPoint& pos, const Handle_V3d_View& view);
     void select();
@@ -76,6 +135,13 @@ public:
     void toggleOwnerSelection(const GraphicsOwnerPtr& owner);
     void clearSelection();
 
+    // Bulk selection of owners: the selection set is updated once, then highlight presentations
+    // are recomputed in one batch(once per object) and selectionChanged() is emitted once if the
+    // selection changed. Owners of invisible objects are ignored
+    void selectOwners(Span<const GraphicsOwnerPtr> owners);
+    void deselectOwners(Span<const GraphicsOwnerPtr> owners);
+    void toggleOwnersSelection(Span<const GraphicsOwnerPtr> owners);
+
     template<typename FUNCTION>
     void foreachDisplayedObject(FUNCTION fn) const;
 
@@ -92,12 +158,26 @@ signals:
     void selectionChanged();
 
 private:
+    enum class SelectionUpdate { Select, Deselect, Toggle };
+    void updateOwnersSelection(Span<const GraphicsOwnerPtr> owners, SelectionUpdate update);
+
     AIS_InteractiveContext* aisContextPtr() const;
+    void scheduleFlush();
+    void redrawViews();
+    void activatePendingSelectionsAt(const QPoint& pos, const Handle_V3d_View& view);
+    bool isPickingBufferValid(const Handle_V3d_View& view) const;
+    void invalidatePickingBuffer();
+    void updatePickingBuffer();
+    bool activatePendingSelectionsFromPickingBuffer(const QPoint& pos, const Handle_V3d_View& view);
+    void touchSubShapeSelection(const GraphicsObjectPtr& object);
+    void evictSubShapeSelection(const GraphicsObjectPtr& object);
 
     class Private;
     Private* const d;
 };
 
+// Blocks redraw of a GraphicsScene within a scope, so changes are batched until the end of the
+// outermost blocker
 class GraphicsSceneRedrawBlocker {
 public:
     GraphicsSceneRedrawBlocker(GraphicsScene* scene);
@@ -0,0 +1,77 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "graphics_shape_object.h"
+#include "graphics_async_hlr.h"
+
+#include <AIS_Shape.hxx>
+
+namespace Mayo {
+
+namespace {
+
+// Located shape as presented with computed transformation 'trsf', see AIS_Shape::computeHLR()
+TopoDS_Shape hlrShape(const TopoDS_Shape& shape, const Handle_TopLoc_Datum3D& trsf)
+{
+    if (!trsf.IsNull() && trsf->Form() != gp_Identity)
+        return shape.Located(TopLoc_Location(trsf->Trsf()) * shape.Location());
+
+    return shape;
+}
+
+} // namespace
+
+GraphicsShapeObject::GraphicsShapeObject(const TDF_Label& label)
+    : XCAFPrs_AISObject(label)
+{
+}
+
+GraphicsShapeObject::~GraphicsShapeObject()
+{
+    GraphicsAsyncHlr::globalInstance()->forget(this);
+}
+
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 5, 0)
+void GraphicsShapeObject::computeHLR(
+        const Handle_Graphic3d_Camera& camera,
+        const Handle_TopLoc_Datum3D& trsf,
+        const Handle_Prs3d_Presentation& prs)
+{
+    const TopoDS_Shape shape = hlrShape(this->Shape(), trsf);
+    if (!GraphicsAsyncHlr::globalInstance()->computePresentation(this, shape, camera, prs))
+        XCAFPrs_AISObject::computeHLR(camera, trsf, prs);
+}
+#endif
+
+GraphicsShapeInstanceObject::~GraphicsShapeInstanceObject()
+{
+    GraphicsAsyncHlr::globalInstance()->forget(this);
+}
+
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 5, 0)
+void GraphicsShapeInstanceObject::computeHLR(
+        const Handle_Graphic3d_Camera& camera,
+        const Handle_TopLoc_Datum3D& trsf,
+        const Handle_Prs3d_Presentation& prs)
+{
+    auto aisShape = Handle_AIS_Shape::DownCast(this->ConnectedTo());
+    if (aisShape) {
+        // Without computed transformation, instance has to be located explicitly
+        const bool hasTrsf = !trsf.IsNull() && trsf->Form() != gp_Identity;
+        const TopoDS_Shape& protoShape = aisShape->Shape();
+        const TopoDS_Shape shape =
+                hasTrsf ?
+                    hlrShape(protoShape, trsf) :
+                    protoShape.Located(TopLoc_Location(this->Transformation()) * protoShape.Location());
+        if (GraphicsAsyncHlr::globalInstance()->computePresentation(this, shape, camera, prs))
+            return;
+    }
+
+    AIS_ConnectedInteractive::computeHLR(camera, trsf, prs);
+}
+#endif
+
+} // namespace Mayo
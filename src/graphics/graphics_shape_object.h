@@ -0,0 +1,55 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "../base/tkernel_utils.h"
+
+#include <AIS_ConnectedInteractive.hxx>
+#include <XCAFPrs_AISObject.hxx>
+
+namespace Mayo {
+
+class GraphicsShapeObject;
+class GraphicsShapeInstanceObject;
+DEFINE_STANDARD_HANDLE(GraphicsShapeObject, XCAFPrs_AISObject)
+DEFINE_STANDARD_HANDLE(GraphicsShapeInstanceObject, AIS_ConnectedInteractive)
+
+// Presentation of an XCAF shape whose hidden line removal is computed with GraphicsAsyncHlr
+// Requires OpenCascade >= v7.5.0, HLR is computed synchronously with previous versions
+class GraphicsShapeObject : public XCAFPrs_AISObject {
+public:
+    GraphicsShapeObject(const TDF_Label& label);
+    ~GraphicsShapeObject();
+
+    DEFINE_STANDARD_RTTI_INLINE(GraphicsShapeObject, XCAFPrs_AISObject)
+
+protected:
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 5, 0)
+    void computeHLR(
+            const Handle_Graphic3d_Camera& camera,
+            const Handle_TopLoc_Datum3D& trsf,
+            const Handle_Prs3d_Presentation& prs) override;
+#endif
+};
+
+// Instance of a GraphicsShapeObject, same as GraphicsShapeObject regarding hidden line removal
+class GraphicsShapeInstanceObject : public AIS_ConnectedInteractive {
+public:
+    ~GraphicsShapeInstanceObject();
+
+    DEFINE_STANDARD_RTTI_INLINE(GraphicsShapeInstanceObject, AIS_ConnectedInteractive)
+
+protected:
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 5, 0)
+    void computeHLR(
+            const Handle_Graphic3d_Camera& camera,
+            const Handle_TopLoc_Datum3D& trsf,
+            const Handle_Prs3d_Presentation& prs) override;
+#endif
+};
+
+} // namespace Mayo
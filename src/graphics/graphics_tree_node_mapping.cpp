@@ -10,14 +10,66 @@
 #include "../base/document.h"
 #include "../base/document_tree_node.h"
 
+#include <AIS_ConnectedInteractive.hxx>
 #include <AIS_Shape.hxx>
+#include <Precision.hxx>
 #include <StdSelect_BRepOwner.hxx>
+#include <TopExp.hxx>
 #include <TopoDS_Solid.hxx>
+#include <cmath>
+#include <functional>
+#include <unordered_set>
 
 namespace Mayo {
 
-GraphicsShapeTreeNodeMapping::GraphicsShapeTreeNodeMapping(TopAbs_ShapeEnum shapeType)
-    : m_shapeType(shapeType)
+namespace {
+
+// Shape presented by graphics object 'object', instances connected to a product present the
+// shape of the product
+TopoDS_Shape presentedShape(const Handle_SelectMgr_SelectableObject& object)
+{
+    Handle_AIS_InteractiveObject presentable = Handle_AIS_InteractiveObject::DownCast(object);
+    auto connected = Handle_AIS_ConnectedInteractive::DownCast(presentable);
+    if (!connected.IsNull())
+        presentable = connected->ConnectedTo();
+
+    auto aisShape = Handle_AIS_Shape::DownCast(presentable);
+    return !aisShape.IsNull() ? aisShape->Shape() : TopoDS_Shape();
+}
+
+bool isSameTrsf(const gp_Trsf& lhs, const gp_Trsf& rhs)
+{
+    if (!lhs.TranslationPart().IsEqual(rhs.TranslationPart(), Precision::Confusion()))
+        return false;
+
+    for (int row = 1; row <= 3; ++row) {
+        for (int col = 1; col <= 3; ++col) {
+            if (std::abs(lhs.Value(row, col) - rhs.Value(row, col)) > Precision::Angular())
+                return false;
+        }
+    }
+
+    return true;
+}
+
+// Whether sub-shapes of type 'shapeType' are indexed by SubShapeCache
+bool isIndexedSubShapeType(TopAbs_ShapeEnum shapeType)
+{
+    return shapeType == TopAbs_FACE || shapeType == TopAbs_EDGE || shapeType == TopAbs_VERTEX;
+}
+
+// Prototype presented for tree node 'nodeId', ie the referred shape in case of a component
+TopoDS_Shape nodePrototype(const Tree<TDF_Label>& modelTree, TreeNodeId nodeId)
+{
+    const TDF_Label& label = modelTree.nodeData(nodeId);
+    return XCaf::shape(XCaf::isShapeReference(label) ? XCaf::shapeReferred(label) : label);
+}
+
+} // namespace
+
+GraphicsShapeTreeNodeMapping::GraphicsShapeTreeNodeMapping(TopAbs_ShapeEnum shapeType, const DocumentPtr& doc)
+    : m_shapeType(shapeType),
+      m_doc(doc)
 {
 }
 
@@ -29,23 +81,68 @@ int GraphicsShapeTreeNodeMapping::selectionMode() const
 std::vector<GraphicsOwnerPtr>
 GraphicsShapeTreeNodeMapping::findGraphicsOwners(const DocumentTreeNode& treeNode) const
 {
-    const TopLoc_Location shapeLoc = treeNode.document()->xcaf().shapeAbsoluteLocation(treeNode.id());
-    const TopoDS_Shape shape = XCaf::shape(treeNode.label()).Located(shapeLoc);
-    std::vector<TopoDS_Shape> vecShape;
-    if (BRepUtils::moreComplex(shape.ShapeType(), m_shapeType)) {
-        BRepUtils::forEachSubShape(shape, m_shapeType, [&](const TopoDS_Shape& subShape) {
-            vecShape.push_back(subShape);
+    const DocumentPtr doc = treeNode.document();
+    const Tree<TDF_Label>& modelTree = doc->modelTree();
+    std::vector<GraphicsOwnerPtr> vecGfxOwner;
+    std::unordered_set<const SelectMgr_EntityOwner*> setGfxOwner;
+    auto fnAddOwner = [&](const GraphicsOwnerPtr& gfxOwner) {
+        if (!gfxOwner.IsNull() && setGfxOwner.insert(gfxOwner.get()).second)
+            vecGfxOwner.push_back(gfxOwner);
+    };
+
+    // Objects presenting the prototype of node 'nodeId' at the location of this node
+    auto fnForEachNodeObject = [&](TreeNodeId nodeId, const std::function<void(const ObjectOwners&)>& fn) {
+        const TopoDS_Shape prototype = nodePrototype(modelTree, nodeId);
+        auto itObjects = m_mapPrototypeObjects.find(prototype.TShape().get());
+        if (itObjects == m_mapPrototypeObjects.cend())
+            return;
+
+        const gp_Trsf nodeTrsf =
+                doc->xcaf().shapeAbsoluteLocation(nodeId).Transformation() * prototype.Location().Transformation();
+        for (const ObjectOwners* objectOwners : itObjects->second) {
+            if (isSameTrsf(objectOwners->trsf, nodeTrsf))
+                fn(*objectOwners);
+        }
+    };
+
+    // Objects presenting the node or one of its descendants: all their owners belong to the node
+    traverseTree(treeNode.id(), modelTree, [&](TreeNodeId id) {
+        fnForEachNodeObject(id, [&](const ObjectOwners& objectOwners) {
+            for (const GraphicsOwnerPtr& gfxOwner : objectOwners.vecOwner)
+                fnAddOwner(gfxOwner);
         });
-    }
-    else if (shape.ShapeType() == m_shapeType) {
-        vecShape.push_back(shape);
-    }
+    });
 
-    std::vector<GraphicsOwnerPtr> vecGfxOwner;
-    for (const TopoDS_Shape& shape : vecShape) {
-        auto it = m_mapGfxOwner.find(BRepUtils::hashCode(shape));
-        if (it != m_mapGfxOwner.cend())
-            vecGfxOwner.push_back(it->second);
+    // Objects presenting an ancestor(eg the whole entity): sub-shapes of the node are looked up in
+    // the table of the ancestor prototype, so they are expressed relative to this prototype
+    TopLoc_Location locRelative = XCaf::shapeReferenceLocation(treeNode.label());
+    const TopoDS_Shape nodeShape = XCaf::shape(treeNode.label());
+    for (TreeNodeId ancestorId = modelTree.nodeParent(treeNode.id());
+         ancestorId != 0;
+         ancestorId = modelTree.nodeParent(ancestorId))
+    {
+        const TopoDS_Shape shape = nodeShape.Located(locRelative);
+        fnForEachNodeObject(ancestorId, [&](const ObjectOwners& objectOwners) {
+            auto fnAddSubShapeOwner = [&](const TopoDS_Shape& subShape) {
+                const int index = objectOwners.table->FindIndex(subShape);
+                if (index > 0)
+                    fnAddOwner(objectOwners.vecOwner.at(index - 1));
+            };
+            if (BRepUtils::moreComplex(shape.ShapeType(), m_shapeType) && isIndexedSubShapeType(m_shapeType)) {
+                const std::shared_ptr<const SubShapes> subShapes = doc->subShapeCache().subShapes(shape);
+                const TopTools_IndexedMapOfShape& mapSubShape = subShapes->map(m_shapeType);
+                for (int i = 1; i <= mapSubShape.Extent(); ++i)
+                    fnAddSubShapeOwner(mapSubShape.FindKey(i).Moved(shape.Location()));
+            }
+            else if (BRepUtils::moreComplex(shape.ShapeType(), m_shapeType)) {
+                BRepUtils::forEachSubShape(shape, m_shapeType, fnAddSubShapeOwner);
+            }
+            else if (shape.ShapeType() == m_shapeType) {
+                fnAddSubShapeOwner(shape);
+            }
+        });
+
+        locRelative = XCaf::shapeReferenceLocation(modelTree.nodeData(ancestorId)) * locRelative;
     }
 
     return vecGfxOwner;
@@ -60,8 +157,49 @@ bool GraphicsShapeTreeNodeMapping::mapGraphicsOwner(const GraphicsOwnerPtr& gfxO
     if (brepOwner->Shape().ShapeType() != m_shapeType)
         return false;
 
-    auto result = m_mapGfxOwner.emplace(BRepUtils::hashCode(brepOwner->Shape()), brepOwner);
-    return result.second;
+    const Handle_SelectMgr_SelectableObject object = brepOwner->Selectable();
+    const TopoDS_Shape prototype = presentedShape(object);
+    if (prototype.IsNull())
+        return false;
+
+    auto [itObject, isNewObject] = m_mapObjectOwners.insert({ object.get(), {} });
+    ObjectOwners& objectOwners = itObject->second;
+    if (isNewObject) {
+        objectOwners.table = this->prototypeTable(prototype);
+        objectOwners.trsf = object->Transformation() * prototype.Location().Transformation();
+        objectOwners.vecOwner.resize(objectOwners.table->Extent());
+        m_mapPrototypeObjects[prototype.TShape().get()].push_back(&objectOwners);
+    }
+
+    // Sub-shapes of owners are located relative to the presented shape
+    const TopoDS_Shape& subShape = brepOwner->Shape();
+    const TopLoc_Location subShapeLoc = prototype.Location().Inverted() * subShape.Location();
+    const int index = objectOwners.table->FindIndex(subShape.Located(subShapeLoc));
+    if (index <= 0 || !objectOwners.vecOwner.at(index - 1).IsNull())
+        return false;
+
+    objectOwners.vecOwner.at(index - 1) = brepOwner;
+    return true;
+}
+
+std::shared_ptr<const GraphicsShapeTreeNodeMapping::SubShapeTable>
+GraphicsShapeTreeNodeMapping::prototypeTable(const TopoDS_Shape& prototype)
+{
+    std::shared_ptr<const SubShapeTable>& table = m_mapPrototypeTable[prototype.TShape().get()];
+    if (!table) {
+        if (!m_doc.IsNull() && isIndexedSubShapeType(m_shapeType)) {
+            // Table shares ownership of the sub-shapes indexed by the document
+            const std::shared_ptr<const SubShapes> subShapes = m_doc->subShapeCache().subShapes(prototype);
+            table = std::shared_ptr<const SubShapeTable>(subShapes, &subShapes->map(m_shapeType));
+        }
+        else {
+            auto newTable = std::make_shared<SubShapeTable>();
+            TopExp::MapShapes(prototype.Located(TopLoc_Location()), m_shapeType, *newTable);
+            table = std::move(newTable);
+        }
+    }
+
+    return table;
 }
 
 } // namespace Mayo
@@ -6,10 +6,15 @@
 
 #pragma once
 
+#include "../base/document_ptr.h"
 #include "graphics_owner_ptr.h"
 #include <TopAbs_ShapeEnum.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+#include <TopoDS_Shape.hxx>
+#include <gp_Trsf.hxx>
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 namespace Mayo {
 
@@ -23,17 +28,38 @@ public:
     virtual bool mapGraphicsOwner(const GraphicsOwnerPtr& gfxOwner) = 0;
 };
 
+// Mapping between tree nodes and the owners of sub-shapes of type 'shapeType'
+// Sub-shapes of each presented prototype are indexed once in a table shared by all the graphics
+// objects presenting this prototype(eg instances connected to the same product), owners of an
+// object are then stored by sub-shape index. Lookups are exact(no hash code comparison) and the
+// cost of mapping an owner doesn't depend on the count of instances
 class GraphicsShapeTreeNodeMapping : public GraphicsTreeNodeMapping {
 public:
-    GraphicsShapeTreeNodeMapping(TopAbs_ShapeEnum shapeType);
+    // Sub-shape tables of faces, edges and vertices come from the SubShapeCache of 'doc' if not null
+    GraphicsShapeTreeNodeMapping(TopAbs_ShapeEnum shapeType, const DocumentPtr& doc = {});
 
     int selectionMode() const override;
     std::vector<GraphicsOwnerPtr> findGraphicsOwners(const DocumentTreeNode& treeNode) const override;
     bool mapGraphicsOwner(const GraphicsOwnerPtr& gfxOwner) override;
 
 private:
-    std::unordered_map<int, GraphicsOwnerPtr> m_mapGfxOwner;
+    // Sub-shapes of a prototype, in the coordinate system of the prototype
+    using SubShapeTable = TopTools_IndexedMapOfShape;
+
+    struct ObjectOwners {
+        std::shared_ptr<const SubShapeTable> table;
+        gp_Trsf trsf; // Transformation from prototype coordinates to document coordinates
+        std::vector<GraphicsOwnerPtr> vecOwner; // Indexed as SubShapeTable, minus one
+    };
+
+    std::shared_ptr<const SubShapeTable> prototypeTable(const TopoDS_Shape& prototype);
+
+    std::unordered_map<const TopoDS_TShape*, std::shared_ptr<const SubShapeTable>> m_mapPrototypeTable;
+    std::unordered_map<const SelectMgr_SelectableObject*, ObjectOwners> m_mapObjectOwners;
+    // Graphics objects presenting a prototype, given by its TShape
+    std::unordered_map<const TopoDS_TShape*, std::vector<const ObjectOwners*>> m_mapPrototypeObjects;
     TopAbs_ShapeEnum m_shapeType;
+    DocumentPtr m_doc;
 };
 
 } // namespace Mayo
@@ -34,7 +34,7 @@ GraphicsShapeTreeNodeMappingDriver::createMapping(const DocumentTreeNode& entity
     });
 
     const TopAbs_ShapeEnum shapeType = solidCount > faceCount ? TopAbs_SOLID : TopAbs_FACE;
-    return std::make_unique<GraphicsShapeTreeNodeMapping>(shapeType);
+    return std::make_unique<GraphicsShapeTreeNodeMapping>(shapeType, doc);
 }
 
 } // namespace Mayo
@@ -77,6 +77,22 @@ gp_Pnt GraphicsUtils::V3dView_to3dPosition(const Handle_V3d_View& view, double x
     return ElSLib::Value(pntConvertedOnPlane.X(), pntConvertedOnPlane.Y(), planeView);
 }
 
+bool GraphicsUtils::V3dView_isInFrustum(const Handle_V3d_View& view, const Bnd_Box& bndBox)
+{
+    if (bndBox.IsVoid())
+        return false;
+
+    // Bounding box of the projected corners in normalized device coordinates
+    const Handle_Graphic3d_Camera& camera = view->Camera();
+    Bnd_Box bndBoxNdc;
+    for (const gp_Pnt& pnt : BndBoxCoords::get(bndBox).vertices())
+        bndBoxNdc.Add(camera->Project(pnt));
+
+    Bnd_Box bndBoxView;
+    bndBoxView.Update(-1, -1, -1, 1, 1, 1);
+    return !bndBoxNdc.IsOut(bndBoxView);
+}
+
 void GraphicsUtils::AisContext_eraseObject(
         const Handle_AIS_InteractiveContext& context,
         const Handle_AIS_InteractiveObject& object)
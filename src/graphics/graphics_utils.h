@@ -21,6 +21,9 @@ struct GraphicsUtils {
             const Handle_Graphic3d_ClipPlane& plane);
     static gp_Pnt V3dView_to3dPosition(
             const Handle_V3d_View& view, double x, double y);
+    // Approximate test on the projection of 'bndBox' corners, might return true for boxes near
+    // the frustum boundaries
+    static bool V3dView_isInFrustum(const Handle_V3d_View& view, const Bnd_Box& bndBox);
 
     static void AisContext_eraseObject(
             const Handle_AIS_InteractiveContext& context,
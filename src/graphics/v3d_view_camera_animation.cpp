@@ -59,9 +59,18 @@ void V3dViewCameraAnimation::configure(const std::function<void(Handle_V3d_View)
     m_view->SetImmediateUpdate(wasImmediateUpdateOn);
 }
 
-void V3dViewCameraAnimation::updateCurrentTime(int currentTime)
+void V3dViewCameraAnimation::setViewRedrawRequest(const std::function<void()>& fnRedrawRequest)
+{
+    m_fnRedrawRequest = fnRedrawRequest;
+}
+
+void V3dViewCameraAnimation::updateViewCamera()
 {
-    const double t = m_easingCurve.valueForProgress(currentTime / double(m_duration_ms));
+    if (m_pendingTime < 0)
+        return;
+
+    const double t = m_easingCurve.valueForProgress(m_pendingTime / double(m_duration_ms));
+    m_pendingTime = -1;
     const bool prevImmediateUpdate = m_view->SetImmediateUpdate(false);
     const Graphic3d_CameraLerp cameraLerp(m_cameraStart, m_cameraEnd);
     Handle_Graphic3d_Camera camera = m_view->Camera();
@@ -69,7 +78,29 @@ void V3dViewCameraAnimation::updateCurrentTime(int currentTime)
     m_view->SetCamera(camera);
     m_view->ZFitAll();
     m_view->SetImmediateUpdate(prevImmediateUpdate);
-    m_view->Update();
+}
+
+void V3dViewCameraAnimation::updateCurrentTime(int currentTime)
+{
+    m_pendingTime = currentTime;
+    if (m_fnRedrawRequest) {
+        m_fnRedrawRequest();
+    }
+    else {
+        this->updateViewCamera();
+        m_view->Update();
+    }
+}
+
+void V3dViewCameraAnimation::updateState(QAbstractAnimation::State newState, QAbstractAnimation::State oldState)
+{
+    // End camera must be effective when signal finished() is emitted
+    if (newState == QAbstractAnimation::Stopped && oldState == QAbstractAnimation::Running) {
+        if (m_pendingTime >= 0 && m_fnRedrawRequest) {
+            this->updateViewCamera();
+            m_fnRedrawRequest();
+        }
+    }
 }
 
 } // namespace Mayo
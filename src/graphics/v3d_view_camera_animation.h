@@ -26,8 +26,16 @@ public:
 
     void configure(const std::function<void(Handle_V3d_View)>& fnViewChange);
 
+    // By default each animation step updates the camera and redraws the view right away
+    // When a redraw request function is set, animation steps just record the current time and call
+    // that function. The camera is then updated by updateViewCamera(), to be called right before
+    // the view is redrawn, so the animation advances at the pace of the displayed frames
+    void setViewRedrawRequest(const std::function<void()>& fnRedrawRequest);
+    void updateViewCamera();
+
 protected:
     void updateCurrentTime(int currentTime) override;
+    void updateState(QAbstractAnimation::State newState, QAbstractAnimation::State oldState) override;
 
 private:
     Handle_V3d_View m_view;
@@ -35,6 +43,8 @@ private:
     Handle_Graphic3d_Camera m_cameraEnd;
     QEasingCurve m_easingCurve; // Linear by default
     int m_duration_ms = 1000;
+    std::function<void()> m_fnRedrawRequest;
+    int m_pendingTime = -1; // Current time not yet applied to the camera, -1 if none
 };
 
 } // namespace Mayo
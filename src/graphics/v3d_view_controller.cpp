@@ -25,13 +25,13 @@ V3dViewController::~V3dViewController()
 
 void V3dViewController::zoomIn()
 {
-    m_view->SetScale(m_view->Scale() * 1.1); // +10%
+    this->changeView([=]{ m_view->SetScale(m_view->Scale() * 1.1); }); // +10%
     emit viewScaled();
 }
 
 void V3dViewController::zoomOut()
 {
-    m_view->SetScale(m_view->Scale() / 1.1); // -10%
+    this->changeView([=]{ m_view->SetScale(m_view->Scale() / 1.1); }); // -10%
     emit viewScaled();
 }
 
@@ -107,14 +107,32 @@ void V3dViewController::restoreCamera()
 void V3dViewController::instantZoomAt(const QPoint& pos)
 {
     const int dX = m_instantZoomFactor * 100;
-    m_view->StartZoomAtPoint(pos.x(), pos.y());
-    m_view->ZoomAtPoint(pos.x(), pos.y(), pos.x() + dX, pos.y());
+    this->changeView([&]{
+        m_view->StartZoomAtPoint(pos.x(), pos.y());
+        m_view->ZoomAtPoint(pos.x(), pos.y(), pos.x() + dX, pos.y());
+    });
 }
 
 void V3dViewController::windowFitAll(const QPoint& posMin, const QPoint& posMax)
 {
-    if (std::abs(posMin.x() - posMax.x()) > 1 || std::abs(posMin.y() - posMax.y()) > 1)
-        m_view->WindowFitAll(posMin.x(), posMin.y(), posMax.x(), posMax.y());
+    if (std::abs(posMin.x() - posMax.x()) > 1 || std::abs(posMin.y() - posMax.y()) > 1) {
+        this->changeView([&]{
+            m_view->WindowFitAll(posMin.x(), posMin.y(), posMax.x(), posMax.y());
+        });
+    }
+}
+
+void V3dViewController::changeView(const std::function<void()>& fnViewChange)
+{
+    const bool wasImmediateUpdateOn = m_view->SetImmediateUpdate(false);
+    fnViewChange();
+    m_view->SetImmediateUpdate(wasImmediateUpdateOn);
+    this->redrawView();
+}
+
+void V3dViewController::redrawView()
+{
+    m_view->Update();
 }
 
 V3dViewController::DynamicAction V3dViewController::currentDynamicAction() const
@@ -10,6 +10,7 @@
 #include <V3d_View.hxx>
 #include <QtCore/QObject>
 #include <QtCore/QPoint>
+#include <functional>
 
 namespace Mayo {
 
@@ -68,6 +69,11 @@ protected:
     void backupCamera();
     void restoreCamera();
 
+    // Executes 'fnViewChange' with immediate update of the view disabled, then calls redrawView()
+    void changeView(const std::function<void()>& fnViewChange);
+    // Redraws the view once changed by the controller, right away by default
+    virtual void redrawView();
+
 private:
     Handle_V3d_View m_view;
     DynamicAction m_dynamicAction = DynamicAction::None;
@@ -11,7 +11,13 @@
 #include "../base/document.h"
 #include "gui_document.h"
 
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDir>
+#include <QtCore/QTimer>
+#include <algorithm>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 namespace Mayo {
 
@@ -20,8 +26,15 @@ GuiApplication::GuiApplication(const ApplicationPtr& app)
       m_app(app),
       m_selectionModel(new ApplicationItemSelectionModel(this)),
       m_gfxObjectDriverTable(new GraphicsObjectDriverTable),
-      m_gfxTreeNodeMappingDriverTable(new GraphicsTreeNodeMappingDriverTable)
+      m_gfxTreeNodeMappingDriverTable(new GraphicsTreeNodeMappingDriverTable),
+      m_timerPresentationBudget(new QTimer(this))
 {
+    // Budget is checked once presentation changes settled, eg after a burst of lazy meshes
+    m_timerPresentationBudget->setSingleShot(true);
+    m_timerPresentationBudget->setInterval(500);
+    QObject::connect(
+                m_timerPresentationBudget, &QTimer::timeout,
+                this, &GuiApplication::checkPresentationMemoryBudget);
     QObject::connect(
                 app.get(), &Application::documentAdded,
                 this, &GuiApplication::onDocumentAdded);
@@ -35,6 +48,11 @@ GuiApplication::~GuiApplication()
 {
     for (GuiDocument* guiDoc : m_vecGuiDocument)
         delete guiDoc;
+
+    if (!m_shapePager.isNull()) {
+        m_shapePager.clear();
+        QDir().rmdir(filepathTo<QString>(m_shapePager.dirPath()));
+    }
 }
 
 GuiDocument* GuiApplication::findGuiDocument(const DocumentPtr& doc) const
@@ -62,6 +80,38 @@ GraphicsTreeNodeMappingDriverTable* GuiApplication::graphicsTreeNodeMappingDrive
     return m_gfxTreeNodeMappingDriverTable.get();
 }
 
+void GuiApplication::setPresentationMemoryBudget(uint64_t bytes)
+{
+    m_presentationMemoryBudget = bytes;
+    this->schedulePresentationMemoryBudgetCheck();
+}
+
+uint64_t GuiApplication::presentationMemoryUsage() const
+{
+    uint64_t bytes = 0;
+    for (const GuiDocument* guiDoc : m_vecGuiDocument)
+        bytes += guiDoc->presentationMemoryUsage();
+
+    return bytes;
+}
+
+void GuiApplication::setShapePagingOn(bool on)
+{
+    if (on == m_isShapePagingOn)
+        return;
+
+    m_isShapePagingOn = on;
+    if (on && m_shapePager.isNull()) {
+        const QString dirName = QString("mayo-pages-%1").arg(QCoreApplication::applicationPid());
+        m_shapePager.setDirPath(filepathFrom(QDir::temp().filePath(dirName)));
+    }
+
+    if (on) {
+        for (GuiDocument* guiDoc : m_vecGuiDocument)
+            guiDoc->scheduleShapePaging();
+    }
+}
+
 void GuiApplication::onDocumentAdded(const DocumentPtr& doc)
 {
     m_vecGuiDocument.push_back(new GuiDocument(doc, this));
@@ -98,22 +148,69 @@ void GuiApplication::connectApplicationItemSelectionChanged(bool on)
 void GuiApplication::onApplicationItemSelectionChanged(
         Span<const ApplicationItem> selected, Span<const ApplicationItem> deselected)
 {
-    std::unordered_set<GuiDocument*> setGuiDocDirty;
-    auto fnToggleItemSelected = [&](const ApplicationItem& item) {
+    // Items are grouped by document, so each graphics selection is updated in one batch
+    std::unordered_map<GuiDocument*, std::vector<ApplicationItem>> mapGuiDocItems;
+    auto fnAddItem = [&](const ApplicationItem& item) {
         GuiDocument* guiDoc = this->findGuiDocument(item.document());
-        if (guiDoc) {
-            guiDoc->toggleItemSelected(item);
-            setGuiDocDirty.insert(guiDoc);
-        }
+        if (guiDoc)
+            mapGuiDocItems[guiDoc].push_back(item);
     };
     for (const ApplicationItem& item : selected)
-        fnToggleItemSelected(item);
+        fnAddItem(item);
 
     for (const ApplicationItem& item : deselected)
-        fnToggleItemSelected(item);
+        fnAddItem(item);
 
-    for (GuiDocument* guiDoc : setGuiDocDirty)
+    for (const auto& [guiDoc, vecItem] : mapGuiDocItems) {
+        guiDoc->toggleItemsSelected(vecItem);
         guiDoc->graphicsScene()->redraw();
+    }
+}
+
+void GuiApplication::schedulePresentationMemoryBudgetCheck()
+{
+    m_timerPresentationBudget->start();
+}
+
+void GuiApplication::checkPresentationMemoryBudget()
+{
+    // Residency is refreshed even without budget, so evicted presentations get restored
+    for (GuiDocument* guiDoc : m_vecGuiDocument)
+        guiDoc->updatePresentationResidency();
+
+    if (m_presentationMemoryBudget == 0)
+        return;
+
+    uint64_t usedBytes = this->presentationMemoryUsage();
+    if (usedBytes <= m_presentationMemoryBudget)
+        return;
+
+    // Candidates of all documents are evicted least recently used first
+    struct Candidate {
+        GuiDocument* guiDoc;
+        GuiDocument::EvictablePresentation prs;
+    };
+    std::vector<Candidate> vecCandidate;
+    for (GuiDocument* guiDoc : m_vecGuiDocument) {
+        for (const GuiDocument::EvictablePresentation& prs : guiDoc->evictablePresentations())
+            vecCandidate.push_back({ guiDoc, prs });
+    }
+
+    std::sort(vecCandidate.begin(), vecCandidate.end(), [](const Candidate& lhs, const Candidate& rhs) {
+        return lhs.prs.lastUseTick < rhs.prs.lastUseTick;
+    });
+    std::unordered_set<GuiDocument*> setGuiDocEvicted;
+    for (const Candidate& candidate : vecCandidate) {
+        if (usedBytes <= m_presentationMemoryBudget)
+            break;
+
+        candidate.guiDoc->evictPresentation(candidate.prs.product);
+        usedBytes -= std::min(usedBytes, candidate.prs.bytes);
+        setGuiDocEvicted.insert(candidate.guiDoc);
+    }
+
+    for (GuiDocument* guiDoc : setGuiDocEvicted)
+        guiDoc->graphicsScene()->redraw(); // Placeholders of evicted products are drawn instead
 }
 
 } // namespace Mayo
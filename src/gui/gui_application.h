@@ -8,14 +8,18 @@
 
 #include "../base/application_ptr.h"
 #include "../base/application_item_selection_model.h"
+#include "../base/shape_pager.h"
 #include "../base/span.h"
 #include "../graphics/graphics_object_driver_table.h"
 #include "../graphics/graphics_tree_node_mapping_driver_table.h"
 #include "gui_document.h"
 
 #include <QtCore/QObject>
+#include <cstdint>
 #include <memory>
 
+class QTimer;
+
 namespace Mayo {
 
 class GuiDocument;
@@ -37,6 +41,22 @@ public:
     GraphicsObjectDriverTable* graphicsObjectDriverTable() const;
     GraphicsTreeNodeMappingDriverTable* graphicsTreeNodeMappingDriverTable() const;
 
+    // -- Presentation memory budget
+    // Estimated GPU memory the presentations of all the documents are allowed to use, 0 if unlimited
+    // Beyond, presentations of the products completely hidden or located outside of the views are
+    // released, least recently used first. They are computed again once visible in a view
+    uint64_t presentationMemoryBudget() const { return m_presentationMemoryBudget; }
+    void setPresentationMemoryBudget(uint64_t bytes);
+    uint64_t presentationMemoryUsage() const;
+
+    // -- Shape paging
+    // Shapes(BRep and triangulations) of the entities completely hidden for a while are paged out
+    // to a scratch directory private to the process, see ShapePager. They're restored once shown
+    // again or touched by an exporter. Disabling paging doesn't restore the shapes paged out
+    bool isShapePagingOn() const { return m_isShapePagingOn; }
+    void setShapePagingOn(bool on);
+    const ShapePager& shapePager() const { return m_shapePager; }
+
 signals:
     void guiDocumentAdded(Mayo::GuiDocument* guiDoc);
     void guiDocumentErased(Mayo::GuiDocument* guiDoc);
@@ -51,6 +71,9 @@ private:
     void onApplicationItemSelectionCleared();
     void onApplicationItemSelectionChanged(
             Span<const ApplicationItem> selected, Span<const ApplicationItem> deselected);
+    void schedulePresentationMemoryBudgetCheck();
+    void checkPresentationMemoryBudget();
+    uint64_t nextPresentationUseTick() { return ++m_presentationUseTick; }
 
     ApplicationPtr m_app;
     std::vector<GuiDocument*> m_vecGuiDocument;
@@ -58,6 +81,11 @@ private:
     std::unique_ptr<GraphicsObjectDriverTable> m_gfxObjectDriverTable;
     std::unique_ptr<GraphicsTreeNodeMappingDriverTable> m_gfxTreeNodeMappingDriverTable;
     QMetaObject::Connection m_connApplicationItemSelectionChanged;
+    uint64_t m_presentationMemoryBudget = 0;
+    uint64_t m_presentationUseTick = 0;
+    QTimer* m_timerPresentationBudget = nullptr;
+    ShapePager m_shapePager;
+    bool m_isShapePagingOn = false;
 };
 
 } // namespace Mayo
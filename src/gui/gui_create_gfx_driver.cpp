@@ -14,18 +14,50 @@
 #include <OpenGl_GraphicDriver.hxx>
 #include <QtCore/QtGlobal>
 
+#if defined(Q_OS_WIN)
+#  include <windows.h>
+#  include <WNT_WClass.hxx>
+#  include <WNT_Window.hxx>
+#elif defined(Q_OS_MAC) && !defined(MACOSX_USE_GLX)
+#  include <Cocoa_Window.hxx>
+#else
+#  include <Xw_Window.hxx>
+#endif
+
 namespace Mayo {
 namespace Internal {
 
-Handle_Graphic3d_GraphicDriver createGfxDriver()
+// Returns the graphics driver shared by all the viewers, so OpenGL resources(eg textures, shader
+// programs) are shared between views and created once
+Handle_Graphic3d_GraphicDriver sharedGfxDriver()
 {
-    Handle_Aspect_DisplayConnection dispConnection;
+    static Handle_Graphic3d_GraphicDriver gfxDriver;
+    if (gfxDriver.IsNull()) {
+        Handle_Aspect_DisplayConnection dispConnection;
 #if (!defined(Q_OS_WIN) && (!defined(Q_OS_MAC) || defined(MACOSX_USE_GLX)))
-    dispConnection = new Aspect_DisplayConnection(std::getenv("DISPLAY"));
+        dispConnection = new Aspect_DisplayConnection(std::getenv("DISPLAY"));
 #endif
-    Handle_Graphic3d_GraphicDriver gfxDriver = new OpenGl_GraphicDriver(dispConnection);
+        gfxDriver = new OpenGl_GraphicDriver(dispConnection);
+    }
+
     return gfxDriver;
 }
 
+// Creates a native window that is never shown, suitable for offscreen rendering of a V3d_View
+Handle_Aspect_Window createOffscreenWindow(int width, int height)
+{
+#if defined(Q_OS_WIN)
+    static Handle_WNT_WClass wndClass = new WNT_WClass("Mayo_OffscreenWindow", (Standard_Address)DefWindowProcW, CS_OWNDC);
+    Handle_WNT_Window wnd = new WNT_Window("", wndClass, WS_POPUP, 0, 0, width, height, Quantity_NOC_BLACK);
+#elif defined(Q_OS_MAC) && !defined(MACOSX_USE_GLX)
+    Handle_Cocoa_Window wnd = new Cocoa_Window("", 0, 0, width, height);
+#else
+    auto gfxDriver = Handle_OpenGl_GraphicDriver::DownCast(sharedGfxDriver());
+    Handle_Xw_Window wnd = new Xw_Window(gfxDriver->GetDisplayConnection(), "", 0, 0, width, height);
+#endif
+    wnd->SetVirtual(true);
+    return wnd;
+}
+
 } // namespace Internal
 } // namespace Mayo
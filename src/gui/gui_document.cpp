@@ -12,30 +12,46 @@
 #include "../base/caf_utils.h"
 #include "../base/cpp_utils.h"
 #include "../base/document.h"
+#include "../base/memory_usage.h"
+#include "../base/profiler.h"
+#include "../base/task_manager.h"
 #include "../base/tkernel_utils.h"
 #include "../gui/gui_application.h"
 #include "../gui/qtgui_utils.h"
 #include "../graphics/graphics_object_driver_table.h"
+#include "../graphics/graphics_merged_shapes_object.h"
+#include "../graphics/graphics_point_cloud_object.h"
+#include "../graphics/graphics_shape_object.h"
 #include "../graphics/graphics_utils.h"
 #include "../graphics/v3d_view_camera_animation.h"
 
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QTimer>
 #include <QtCore/QtDebug>
 #if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 4, 0)
 #  include <AIS_ViewCube.hxx>
 #endif
 #include <AIS_ConnectedInteractive.hxx>
+#include <AIS_DataMapIteratorOfDataMapOfShapeDrawer.hxx>
+#include <AIS_DisplayMode.hxx>
+#include <AIS_Shape.hxx>
 #include <AIS_Trihedron.hxx>
 #include <Geom_Axis2Placement.hxx>
 #include <Graphic3d_GraphicDriver.hxx>
+#include <Graphic3d_ZLayerSettings.hxx>
+#include <Prs3d_ShadingAspect.hxx>
 #include <V3d_TypeOfOrientation.hxx>
+#include <gp.hxx>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <map>
+#include <unordered_set>
 
 namespace Mayo {
 
 namespace Internal {
 
-// Defined in gui_create_gfx_driver.cpp
-Handle_Graphic3d_GraphicDriver createGfxDriver();
-
 static Handle_AIS_Trihedron createOriginTrihedron()
 {
     Handle_Geom_Axis2Placement axis = new Geom_Axis2Placement(gp::XOY());
@@ -60,6 +76,36 @@ static Handle_AIS_Trihedron createOriginTrihedron()
     return aisTrihedron;
 }
 
+// Returns the object actually holding the presentation, in case 'object' is an instance
+static GraphicsObjectPtr graphicsProduct(const GraphicsObjectPtr& object)
+{
+    auto gfxInstance = Handle_AIS_ConnectedInteractive::DownCast(object);
+    return gfxInstance ? gfxInstance->ConnectedTo() : object;
+}
+
+// AIS_Shape display mode drawing the bounding box of the shape, cheap to compute
+constexpr int AisShape_BoundingBoxDisplayMode = 2;
+
+static bool hasBoundingBoxPlaceholder(const GraphicsObjectPtr& object)
+{
+    return !Handle_AIS_Shape::DownCast(graphicsProduct(object)).IsNull()
+            && object->AcceptDisplayMode(AisShape_BoundingBoxDisplayMode);
+}
+
+// Static batching: count of grid cells along the greatest dimension of the document bounding box
+constexpr int StaticBatchGridSize = 8;
+// Parts beyond this count of triangles are not merged, their draw call isn't the bottleneck
+constexpr int StaticBatchMaxPartTriangleCount = 2000;
+// Limits the cost of recomputing a batch presentation when a part is split out
+constexpr int StaticBatchMaxTriangleCount = 1 << 18;
+
+// Milliseconds between updates of occlusion culling, each one renders an offscreen depth frame
+constexpr int OcclusionCullingUpdateInterval = 100;
+
+// Milliseconds an entity has to stay hidden before its shapes are paged out, so quickly toggling
+// visibility doesn't write and read back shapes
+constexpr int ShapePagingDelay = 10000;
+
 } // namespace Internal
 
 GuiDocument::GuiDocument(const DocumentPtr& doc, GuiApplication* guiApp)
@@ -69,7 +115,11 @@ GuiDocument::GuiDocument(const DocumentPtr& doc, GuiApplication* guiApp)
       m_gfxScene(this),
       m_v3dView(m_gfxScene.createV3dView()),
       m_aisOriginTrihedron(Internal::createOriginTrihedron()),
-      m_cameraAnimation(new V3dViewCameraAnimation(m_v3dView, this))
+      m_cameraAnimation(new V3dViewCameraAnimation(m_v3dView, this)),
+      m_timerPendingPrs(new QTimer(this)),
+      m_timerStaticBatches(new QTimer(this)),
+      m_timerOcclusionCulling(new QTimer(this)),
+      m_timerShapePaging(new QTimer(this))
 {
     Expects(!doc.IsNull());
 
@@ -98,6 +148,21 @@ GuiDocument::GuiDocument(const DocumentPtr& doc, GuiApplication* guiApp)
 
     m_cameraAnimation->setEasingCurve(QEasingCurve::OutExpo);
 
+    m_timerPendingPrs->setSingleShot(true);
+    m_timerPendingPrs->setInterval(0);
+    QObject::connect(m_timerPendingPrs, &QTimer::timeout, this, &GuiDocument::processPendingPresentations);
+    // Batches are built once changes settled, eg after a burst of lazy meshes completed
+    m_timerStaticBatches->setSingleShot(true);
+    m_timerStaticBatches->setInterval(500);
+    QObject::connect(m_timerStaticBatches, &QTimer::timeout, this, &GuiDocument::updateStaticBatches);
+    // Single shot once camera or scene changed, periodic while a dynamic view action is running
+    m_timerOcclusionCulling->setSingleShot(true);
+    m_timerOcclusionCulling->setInterval(Internal::OcclusionCullingUpdateInterval);
+    QObject::connect(m_timerOcclusionCulling, &QTimer::timeout, this, &GuiDocument::updateOcclusionCulling);
+    m_timerShapePaging->setSingleShot(true);
+    m_timerShapePaging->setInterval(Internal::ShapePagingDelay);
+    QObject::connect(m_timerShapePaging, &QTimer::timeout, this, &GuiDocument::pageOutHiddenEntities);
+
     for (int i = 0; i < doc->entityCount(); ++i)
         this->mapEntity(doc->entityTreeNodeId(i));
 
@@ -105,9 +170,54 @@ GuiDocument::GuiDocument(const DocumentPtr& doc, GuiApplication* guiApp)
     QObject::connect(
                 doc.get(), &Document::entityAboutToBeDestroyed,
                 this, &GuiDocument::onDocumentEntityAboutToBeDestroyed);
+    QObject::connect(
+                doc.get(), &Document::deferredShapesLoaded,
+                this, &GuiDocument::onDocumentDeferredShapesLoaded);
+    QObject::connect(
+                doc.get(), &Document::deferredScalingsApplied,
+                this, &GuiDocument::onDocumentDeferredScalingsApplied);
+    QObject::connect(
+                doc.get(), &Document::shapesUnloaded,
+                this, &GuiDocument::onDocumentShapesUnloaded);
     QObject::connect(
                 &m_gfxScene, &GraphicsScene::selectionChanged,
                 this, &GuiDocument::onGraphicsSelectionChanged);
+    QObject::connect(
+                TaskManager::globalInstance(), &TaskManager::ended,
+                this, &GuiDocument::onLazyMeshTaskEnded);
+    QObject::connect(
+                TaskManager::globalInstance(), &TaskManager::ended,
+                this, &GuiDocument::onMeshRefinementTaskEnded);
+    QObject::connect(
+                m_cameraAnimation, &QAbstractAnimation::finished,
+                this, &GuiDocument::updateViewLevelOfDetail);
+}
+
+Handle_V3d_View GuiDocument::createSecondaryView()
+{
+    Handle_V3d_View view = m_gfxScene.createV3dView();
+    view->ChangeRenderingParams() = m_v3dView->RenderingParams();
+    // Performance counters are reported once, in the main view
+    view->ChangeRenderingParams().CollectedStats = Graphic3d_RenderingParams::PerfCounters_None;
+    view->ChangeRenderingParams().TransparencyMethod = m_transparencyMethod;
+    const Aspect_GradientBackground bkgGradient = m_v3dView->GradientBackground();
+    Quantity_Color bkgGradientStart;
+    Quantity_Color bkgGradientEnd;
+    bkgGradient.Colors(bkgGradientStart, bkgGradientEnd);
+    view->SetBgGradientColors(bkgGradientStart, bkgGradientEnd, bkgGradient.BgGradientFillMethod());
+    view->Camera()->Copy(m_v3dView->Camera());
+    m_vecSecondaryView.push_back(view);
+    return view;
+}
+
+void GuiDocument::destroySecondaryView(const Handle_V3d_View& view)
+{
+    auto itView = std::find(m_vecSecondaryView.begin(), m_vecSecondaryView.end(), view);
+    if (itView == m_vecSecondaryView.end())
+        return;
+
+    m_vecSecondaryView.erase(itView);
+    view->Remove();
 }
 
 void GuiDocument::foreachGraphicsObject(
@@ -116,13 +226,8 @@ void GuiDocument::foreachGraphicsObject(
     if (!fn)
         return;
 
-    const Tree<TDF_Label>& docModelTree = m_document->modelTree();
-    const GraphicsEntity* ptrItem = this->findGraphicsEntity(docModelTree.nodeRoot(nodeId));
-    if (!ptrItem)
-        return;
-
-    traverseTree(nodeId, docModelTree, [&](TreeNodeId id) {
-        GraphicsObjectPtr gfxObject = CppUtils::findValue(id, ptrItem->mapTreeNodeGfxObject);
+    traverseTree(nodeId, m_document->modelTree(), [&](TreeNodeId id) {
+        GraphicsObjectPtr gfxObject = this->findGraphicsObject(id);
         if (gfxObject)
             fn(gfxObject);
     });
@@ -130,37 +235,37 @@ void GuiDocument::foreachGraphicsObject(
 
 TreeNodeId GuiDocument::nodeFromGraphicsObject(const GraphicsObjectPtr& object) const
 {
-    if (!object)
-        return 0;
-
-    for (const GraphicsEntity& gfxEntity: m_vecGraphicsEntity) {
-        auto it = gfxEntity.mapGfxObjectTreeNode.find(object);
-        if (it != gfxEntity.mapGfxObjectTreeNode.cend())
-            return it->second;
-    }
-
-    return 0;
+    return object ? CppUtils::findValue(object, m_mapGfxObjectTreeNode) : 0;
 }
 
 void GuiDocument::toggleItemSelected(const ApplicationItem& appItem)
 {
-    const DocumentPtr doc = appItem.document();
-    if (doc != this->document())
-        return;
+    this->toggleItemsSelected(Span<const ApplicationItem>(&appItem, 1));
+}
 
-    if (appItem.isDocumentTreeNode()) {
-        const DocumentTreeNode& docTreeNode = appItem.documentTreeNode();
-        const TreeNodeId entityNodeId = doc->modelTree().nodeRoot(docTreeNode.id());
-        const GraphicsEntity* gfxEntity = this->findGraphicsEntity(entityNodeId);
-        if (!gfxEntity)
-            return;
+void GuiDocument::toggleItemsSelected(Span<const ApplicationItem> spanAppItem)
+{
+    std::vector<TreeNodeId> vecNodeId;
+    for (const ApplicationItem& appItem : spanAppItem) {
+        if (appItem.document() == this->document() && appItem.isDocumentTreeNode())
+            vecNodeId.push_back(appItem.documentTreeNode().id());
+    }
 
-        traverseTree(docTreeNode.id(), doc->modelTree(), [=](TreeNodeId id) {
-            GraphicsObjectPtr gfxObject = CppUtils::findValue(id, gfxEntity->mapTreeNodeGfxObject);
-            if (gfxObject)
-                m_gfxScene.toggleOwnerSelection(gfxObject->GlobalSelOwner());
+    // Merged parts are selected through their own instance
+    this->splitStaticBatchParts(vecNodeId);
+    std::vector<GraphicsOwnerPtr> vecGfxOwner;
+    for (TreeNodeId nodeId : vecNodeId) {
+        this->foreachGraphicsObject(nodeId, [&](GraphicsObjectPtr gfxObject) {
+            m_gfxScene.activatePendingObjectSelection(gfxObject);
+            vecGfxOwner.push_back(gfxObject->GlobalSelOwner());
         });
     }
+
+    // Graphics selection changes here come from the application selection model, they must not
+    // be reported back to it
+    m_isTogglingItemsSelected = true;
+    auto _ = gsl::finally([=]{ m_isTogglingItemsSelected = false; });
+    m_gfxScene.toggleOwnersSelection(vecGfxOwner);
 }
 
 int GuiDocument::activeDisplayMode(const GraphicsObjectDriverPtr& driver) const
@@ -184,10 +289,17 @@ void GuiDocument::setActiveDisplayMode(const GraphicsObjectDriverPtr& driver, in
         return;
 
     m_mapGfxDriverDisplayMode.insert_or_assign(driver, mode);
+    GraphicsSceneRedrawBlocker redrawBlocker(&m_gfxScene);
+    this->clearStaticBatches();
+    this->scheduleStaticBatchesUpdate();
     for (const TreeNodeId entityNodeId : m_document->modelTree().roots()) {
         this->foreachGraphicsObject(entityNodeId, [&](GraphicsObjectPtr object) {
-            if (GraphicsObjectDriver::get(object) == driver)
+            if (GraphicsObjectDriver::get(object) == driver
+                    && !this->isLazyMeshPending(object)
+                    && !this->isPresentationPending(object))
+            {
                 driver->applyDisplayMode(object, mode);
+            }
         });
     }
 }
@@ -200,13 +312,34 @@ Qt::CheckState GuiDocument::nodeVisibleState(TreeNodeId nodeId) const
 
 void GuiDocument::setNodeVisible(TreeNodeId nodeId, bool on)
 {
-    auto itNode = m_mapTreeNodeCheckState.find(nodeId);
-    if (itNode == m_mapTreeNodeCheckState.end())
-        return; // Error: unknown tree node
+    this->setNodesVisible(Span<const TreeNodeId>(&nodeId, 1), on);
+}
 
+void GuiDocument::setNodesVisible(Span<const TreeNodeId> spanNodeId, bool on)
+{
+    this->scheduleOcclusionCullingUpdate();
     const Qt::CheckState nodeVisibleState = on ? Qt::Checked : Qt::Unchecked;
-    if (itNode->second == nodeVisibleState)
-        return; // Same visible state
+    std::vector<TreeNodeId> vecNodeId;
+    for (TreeNodeId nodeId : spanNodeId) {
+        auto itNode = m_mapTreeNodeCheckState.find(nodeId);
+        if (itNode == m_mapTreeNodeCheckState.end())
+            continue; // Error: unknown tree node
+
+        if (itNode->second != nodeVisibleState) // Skip same visible state
+            vecNodeId.push_back(nodeId);
+    }
+
+    if (vecNodeId.empty())
+        return;
+
+    // Graphics are then updated with signal Document::deferredShapesLoaded()
+    if (on) {
+        for (TreeNodeId nodeId : vecNodeId)
+            m_document->loadDeferredShapes(nodeId);
+    }
+    else {
+        this->scheduleShapePaging();
+    }
 
     // Helper data/function to keep track of all the nodes whose visibility state are altered
     std::unordered_map<TreeNodeId, Qt::CheckState> mapNodeIdVisibleState;
@@ -222,43 +355,78 @@ void GuiDocument::setNodeVisible(TreeNodeId nodeId, bool on)
         }
     };
 
-    // Recursive show/hide of the input node graphics
+    // Recursive show/hide of the input nodes graphics, redraw is done once for all of them
+    GraphicsSceneRedrawBlocker redrawBlocker(&m_gfxScene);
+    this->splitStaticBatchParts(vecNodeId);
     const Tree<TDF_Label>& docModelTree = m_document->modelTree();
-    traverseTree(nodeId, docModelTree , [=](TreeNodeId id) {
-        fnSetNodeVisibleState(id, nodeVisibleState);
-    });
-    this->foreachGraphicsObject(nodeId, [=](GraphicsObjectPtr gfxObject){
-        GraphicsUtils::AisObject_setVisible(gfxObject, on);
-    });
+    for (TreeNodeId nodeId : vecNodeId) {
+        traverseTree(nodeId, docModelTree , [&](TreeNodeId id) {
+            fnSetNodeVisibleState(id, nodeVisibleState);
+        });
+        this->foreachGraphicsObject(nodeId, [=](GraphicsObjectPtr gfxObject){
+            GraphicsUtils::AisObject_setVisible(gfxObject, on);
+        });
+    }
 
-    // Keep selection state of the input node: in case the node graphics are "shown" back again then
+    if (on) {
+        this->requestLazyMeshes();
+        if (!m_mapProductResidency.empty())
+            this->updatePresentationResidency(); // Evicted presentations shown back get restored
+    }
+
+    m_guiApp->schedulePresentationMemoryBudgetCheck();
+
+    // Keep selection state of input nodes: in case the node graphics are "shown" back again then
     // AIS object selection status is lost
-    const ApplicationItem appItem({ m_document, nodeId });
-    bool isAppItemSelected = m_guiApp->selectionModel()->isSelected(appItem);
-    if (!isAppItemSelected) { // Check if a parent is selected
-        TreeNodeId parentId = docModelTree.nodeParent(nodeId);
-        while (parentId != 0 && !isAppItemSelected) {
-            const ApplicationItem parentAppItem({ m_document, parentId });
-            isAppItemSelected = m_guiApp->selectionModel()->isSelected(parentAppItem);
-            parentId = docModelTree.nodeParent(parentId);
+    ApplicationItemSelectionModel* selectionModel = m_guiApp->selectionModel();
+    if (on && !selectionModel->selectedItems().empty()) {
+        for (TreeNodeId nodeId : vecNodeId) {
+            const ApplicationItem appItem({ m_document, nodeId });
+            bool isAppItemSelected = selectionModel->isSelected(appItem);
+            if (!isAppItemSelected) { // Check if a parent is selected
+                TreeNodeId parentId = docModelTree.nodeParent(nodeId);
+                while (parentId != 0 && !isAppItemSelected) {
+                    const ApplicationItem parentAppItem({ m_document, parentId });
+                    isAppItemSelected = selectionModel->isSelected(parentAppItem);
+                    parentId = docModelTree.nodeParent(parentId);
+                }
+            }
+
+            if (isAppItemSelected)
+                this->toggleItemSelected(appItem);
+
+            // Keep selection state of input node children
+            traverseTree(nodeId, docModelTree, [=](TreeNodeId id) {
+                if (id != nodeId) {
+                    const ApplicationItem childAppItem({ m_document, id });
+                    if (selectionModel->isSelected(childAppItem))
+                        this->toggleItemSelected(childAppItem);
+                }
+            });
         }
     }
 
-    if (on && isAppItemSelected)
-        this->toggleItemSelected(appItem);
-
-    // Keep selection state of input node children
-    traverseTree(nodeId, docModelTree, [=](TreeNodeId id) {
-        if (id != nodeId) {
-            const ApplicationItem childAppItem({ m_document, id });
-            if (on && m_guiApp->selectionModel()->isSelected(childAppItem))
-                this->toggleItemSelected(childAppItem);
+    // Parent nodes check state: ancestors shared by input nodes are collected once, then computed
+    // bottom-up so a parent is evaluated after all its altered children
+    std::unordered_map<TreeNodeId, int> mapParentDepth;
+    for (TreeNodeId nodeId : vecNodeId) {
+        for (TreeNodeId parentId = docModelTree.nodeParent(nodeId);
+             parentId != 0 && mapParentDepth.find(parentId) == mapParentDepth.cend();
+             parentId = docModelTree.nodeParent(parentId))
+        {
+            int depth = 0;
+            for (TreeNodeId id = docModelTree.nodeParent(parentId); id != 0; id = docModelTree.nodeParent(id))
+                ++depth;
+
+            mapParentDepth.insert({ parentId, depth });
         }
-    });
+    }
 
-    // Parent nodes check state
-    TreeNodeId parentId = docModelTree.nodeParent(nodeId);
-    while (parentId != 0) {
+    std::vector<std::pair<TreeNodeId, int>> vecParentDepth(mapParentDepth.cbegin(), mapParentDepth.cend());
+    std::sort(vecParentDepth.begin(), vecParentDepth.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.second > rhs.second;
+    });
+    for (const auto& [parentId, depth] : vecParentDepth) {
         int childCount = 0;
         int checkedCount = 0;
         int uncheckedCount = 0;
@@ -277,7 +445,6 @@ void GuiDocument::setNodeVisible(TreeNodeId nodeId, bool on)
             parentVisibleState = Qt::Unchecked;
 
         fnSetNodeVisibleState(parentId, parentVisibleState);
-        parentId = docModelTree.nodeParent(parentId);
     }
 
     // Notify all node visibility changes
@@ -288,17 +455,23 @@ void GuiDocument::setNodeVisible(TreeNodeId nodeId, bool on)
 void GuiDocument::setExplodingFactor(double t)
 {
     m_explodingFactor = t;
+    GraphicsSceneRedrawBlocker redrawBlocker(&m_gfxScene);
+    // Merged parts can't move apart
+    if (t != 0.)
+        this->clearStaticBatches();
+    else
+        this->scheduleStaticBatchesUpdate();
+
     for (const GraphicsEntity& entity : m_vecGraphicsEntity) {
-        const gp_Pnt entityCenter = BndBoxCoords::get(entity.bndBox).center();
         for (const GraphicsEntity::Object& object : entity.vecObject) {
-            const gp_Vec vecDirection(entityCenter, BndBoxCoords::get(object.bndBox).center());
             gp_Trsf trsfMove;
-            trsfMove.SetTranslation(2 * t * vecDirection);
+            trsfMove.SetTranslation(t * object.explodingVector);
             m_gfxScene.setObjectTransformation(object.ptr, trsfMove * object.trsfOriginal);
         }
     }
 
     m_gfxScene.redraw();
+    this->scheduleOcclusionCullingUpdate();
 }
 
 bool GuiDocument::isOriginTrihedronVisible() const
@@ -347,6 +520,514 @@ void GuiDocument::stopViewCameraAnimation()
     m_cameraAnimation->stop();
 }
 
+void GuiDocument::updateViewLevelOfDetail()
+{
+    bool isPresentationChanged = false;
+    for (const GraphicsEntity& gfxEntity : m_vecGraphicsEntity) {
+        for (const GraphicsEntity::Object& object : gfxEntity.vecObject) {
+            auto gfxPointCloud = Handle_GraphicsPointCloudObject::DownCast(object.ptr);
+            if (!gfxPointCloud || !m_gfxScene.isObjectVisible(gfxPointCloud))
+                continue;
+
+            if (gfxPointCloud->updateLevelOfDetail(m_v3dView)) {
+                m_gfxScene.recomputeObjectPresentation(gfxPointCloud);
+                isPresentationChanged = true;
+            }
+        }
+    }
+
+    if (isPresentationChanged)
+        m_gfxScene.redraw();
+
+    // Evicted presentations now visible in the view are restored right away
+    const bool hasEvictedPrs = std::any_of(
+                m_mapProductResidency.cbegin(), m_mapProductResidency.cend(),
+                [](const auto& pair) { return pair.second.isEvicted; });
+    if (hasEvictedPrs)
+        this->updatePresentationResidency();
+
+    m_guiApp->schedulePresentationMemoryBudgetCheck();
+    this->scheduleOcclusionCullingUpdate();
+}
+
+bool GuiDocument::isFrustumCullingOn() const
+{
+    return m_v3dView->RenderingParams().FrustumCullingState != Graphic3d_RenderingParams::FrustumCulling_Off;
+}
+
+void GuiDocument::setFrustumCullingOn(bool on)
+{
+    m_v3dView->ChangeRenderingParams().FrustumCullingState =
+            on ? Graphic3d_RenderingParams::FrustumCulling_On : Graphic3d_RenderingParams::FrustumCulling_Off;
+    m_gfxScene.redraw();
+}
+
+void GuiDocument::setSizeCullingThreshold(double pixels)
+{
+    m_sizeCullingThreshold = std::max(0., pixels);
+    this->applySizeCulling();
+}
+
+void GuiDocument::setDynamicSizeCullingThreshold(double pixels)
+{
+    m_dynamicSizeCullingThreshold = std::max(0., pixels);
+    if (m_isViewDynamicActionRunning)
+        this->applySizeCulling();
+}
+
+void GuiDocument::startViewDynamicAction()
+{
+    m_isViewDynamicActionRunning = true;
+    if (m_isAdaptiveRenderingOn)
+        this->lowerViewQuality();
+
+    if (m_dynamicSizeCullingThreshold > m_sizeCullingThreshold)
+        this->applySizeCulling();
+
+    if (m_isOcclusionCullingOn) {
+        m_timerOcclusionCulling->setSingleShot(false);
+        m_timerOcclusionCulling->start();
+    }
+}
+
+void GuiDocument::stopViewDynamicAction()
+{
+    m_isViewDynamicActionRunning = false;
+    m_timerOcclusionCulling->setSingleShot(true);
+    this->scheduleOcclusionCullingUpdate();
+    this->restoreViewQuality();
+    if (m_dynamicSizeCullingThreshold > m_sizeCullingThreshold)
+        this->applySizeCulling();
+    else
+        m_gfxScene.redraw();
+}
+
+void GuiDocument::setAdaptiveRenderingOn(bool on)
+{
+    m_isAdaptiveRenderingOn = on;
+    if (!on)
+        this->restoreViewQuality();
+}
+
+void GuiDocument::setOcclusionCullingOn(bool on)
+{
+    if (m_isOcclusionCullingOn == on)
+        return;
+
+    m_isOcclusionCullingOn = on;
+    if (on) {
+        this->scheduleOcclusionCullingUpdate();
+    }
+    else {
+        m_timerOcclusionCulling->stop();
+        this->clearOcclusionCulling();
+    }
+}
+
+void GuiDocument::setTransparencyMethod(Graphic3d_RenderTransparentMethod method)
+{
+    m_transparencyMethod = method;
+    for (const Handle_V3d_View& view : m_vecSecondaryView)
+        view->ChangeRenderingParams().TransparencyMethod = method;
+
+    // Full quality method is applied to the main view once the dynamic action is over
+    const bool isLowered = m_viewFullQuality.isLowered && GuiDocument::isCostlyTransparency(method);
+    m_v3dView->ChangeRenderingParams().TransparencyMethod = isLowered ? Graphic3d_RTM_BLEND_OIT : method;
+    m_viewFullQuality.isTransparencyLowered = isLowered;
+    m_gfxScene.redraw();
+}
+
+void GuiDocument::setNodesColorOverride(Span<const TreeNodeId> spanNodeId, const Quantity_Color& color)
+{
+    this->splitStaticBatchParts(spanNodeId);
+    const Tree<TDF_Label>& modelTree = m_document->modelTree();
+    for (TreeNodeId nodeId : spanNodeId) {
+        const GraphicsObjectPtr gfxObject = this->findGraphicsObject(nodeId);
+        if (!gfxObject || this->isLazyMeshPending(gfxObject))
+            continue;
+
+        auto gfxInstance = Handle_AIS_ConnectedInteractive::DownCast(gfxObject);
+        if (gfxInstance) {
+            // Instance is connected to a plain AIS_Shape of the prototype, free of XCAF styles
+            const TreeNodeId leafId = modelTree.nodeIsLeaf(nodeId) ? nodeId : modelTree.nodeChildFirst(nodeId);
+            const TDF_Label labelProduct = modelTree.nodeData(leafId);
+            auto itOverride = m_mapColorOverrideObject.find(gfxObject);
+            if (itOverride == m_mapColorOverrideObject.end())
+                itOverride = m_mapColorOverrideObject.insert({ gfxObject, gfxInstance->ConnectedTo() }).first;
+
+            const GraphicsObjectPtr& gfxProduct = itOverride->second;
+            std::vector<Handle_AIS_Shape>& vecColoredProduct = m_mapLabelColoredProduct[labelProduct];
+            auto itColoredProduct = std::find_if(
+                        vecColoredProduct.begin(), vecColoredProduct.end(), [&](const Handle_AIS_Shape& product) {
+                Quantity_Color productColor;
+                product->Color(productColor);
+                return productColor.IsEqual(color);
+            });
+            if (itColoredProduct == vecColoredProduct.end()) {
+                Handle_AIS_Shape coloredProduct = new AIS_Shape(XCaf::shape(labelProduct));
+                coloredProduct->SetColor(color);
+                coloredProduct->SetDisplayMode(gfxProduct->DisplayMode());
+                coloredProduct->Attributes()->SetFaceBoundaryDraw(gfxProduct->Attributes()->FaceBoundaryDraw());
+                itColoredProduct = vecColoredProduct.insert(vecColoredProduct.end(), coloredProduct);
+            }
+
+            gfxInstance->Connect(*itColoredProduct, gfxInstance->LocalTransformation());
+        }
+        else if (auto xcafObject = Handle_XCAFPrs_AISObject::DownCast(gfxObject)) {
+            // Styles would be dispatched again on first computation, wiping out custom colors
+            if (m_setPendingPrsObject.find(gfxObject) != m_setPendingPrsObject.end())
+                continue;
+
+            // Entity root object, custom aspects coming from XCAF styles are overridden as well
+            std::vector<TopoDS_Shape> vecShape = { xcafObject->Shape() };
+            for (AIS_DataMapIteratorOfDataMapOfShapeDrawer it(xcafObject->CustomAspectsMap()); it.More(); it.Next())
+                vecShape.push_back(it.Key());
+
+            for (const TopoDS_Shape& shape : vecShape)
+                xcafObject->SetCustomColor(shape, color);
+
+            m_mapColorOverrideObject.insert({ gfxObject, GraphicsObjectPtr() });
+        }
+        else {
+            continue;
+        }
+
+        m_gfxScene.recomputeObjectPresentation(gfxObject);
+    }
+
+    m_gfxScene.redraw();
+}
+
+void GuiDocument::clearNodesColorOverride()
+{
+    if (m_mapColorOverrideObject.empty())
+        return;
+
+    for (const auto& [gfxObject, gfxProduct] : m_mapColorOverrideObject) {
+        auto gfxInstance = Handle_AIS_ConnectedInteractive::DownCast(gfxObject);
+        auto xcafObject = Handle_XCAFPrs_AISObject::DownCast(gfxObject);
+        if (gfxInstance)
+            gfxInstance->Connect(gfxProduct, gfxInstance->LocalTransformation());
+        else if (xcafObject)
+            xcafObject->SetLabel(xcafObject->GetLabel()); // Styles are dispatched again
+
+        m_gfxScene.recomputeObjectPresentation(gfxObject);
+    }
+
+    m_mapColorOverrideObject.clear();
+    m_mapLabelColoredProduct.clear();
+    m_gfxScene.redraw();
+    this->scheduleStaticBatchesUpdate();
+}
+
+void GuiDocument::setStaticBatchingOn(bool on)
+{
+    if (m_isStaticBatchingOn == on)
+        return;
+
+    m_isStaticBatchingOn = on;
+    if (on) {
+        this->updateStaticBatches();
+    }
+    else {
+        m_timerStaticBatches->stop();
+        this->clearStaticBatches();
+        m_gfxScene.redraw();
+    }
+}
+
+uint64_t GuiDocument::presentationMemoryUsage() const
+{
+    uint64_t bytes = 0;
+    for (const auto& [product, residency] : m_mapProductResidency) {
+        if (!residency.isEvicted)
+            bytes += residency.bytes;
+    }
+
+    return bytes;
+}
+
+void GuiDocument::updatePresentationResidency()
+{
+    const bool hasBudget = m_guiApp->presentationMemoryBudget() != 0;
+    const bool hasEvictedPrs = std::any_of(
+                m_mapProductResidency.cbegin(), m_mapProductResidency.cend(),
+                [](const auto& pair) { return pair.second.isEvicted; });
+    if (!hasBudget && !hasEvictedPrs) {
+        m_mapProductResidency.clear();
+        return;
+    }
+
+    for (auto& [product, residency] : m_mapProductResidency) {
+        residency.vecObject.clear();
+        residency.isInUse = false;
+    }
+
+    auto fnIsInViews = [=](const Bnd_Box& bndBox) {
+        if (GraphicsUtils::V3dView_isInFrustum(m_v3dView, bndBox))
+            return true;
+
+        return std::any_of(m_vecSecondaryView.cbegin(), m_vecSecondaryView.cend(), [&](const Handle_V3d_View& view) {
+            return GraphicsUtils::V3dView_isInFrustum(view, bndBox);
+        });
+    };
+
+    const Tree<TDF_Label>& modelTree = m_document->modelTree();
+    for (const GraphicsEntity& gfxEntity : m_vecGraphicsEntity) {
+        for (const GraphicsEntity::Object& object : gfxEntity.vecObject) {
+            // Only products having a placeholder can be evicted
+            if (!Internal::hasBoundingBoxPlaceholder(object.ptr) || this->isLazyMeshPending(object.ptr))
+                continue;
+
+            const GraphicsObjectPtr product = Internal::graphicsProduct(object.ptr);
+            const TreeNodeId nodeId = CppUtils::findValue(object.ptr, m_mapGfxObjectTreeNode);
+            auto itResidency = m_mapProductResidency.find(product);
+            if (itResidency == m_mapProductResidency.end()) {
+                if (nodeId == 0 || this->isPresentationPending(object.ptr))
+                    continue; // Presentation not computed yet
+
+                const TDF_Label nodeLabel = modelTree.nodeData(nodeId);
+                const TDF_Label productLabel =
+                        XCaf::isShapeReference(nodeLabel) ? XCaf::shapeReferred(nodeLabel) : nodeLabel;
+                PresentationResidency residency;
+                residency.bytes = MemoryUsage::ofLabel(productLabel).estimatedPresentationBytes();
+                itResidency = m_mapProductResidency.insert({ product, std::move(residency) }).first;
+            }
+
+            PresentationResidency& residency = itResidency->second;
+            residency.vecObject.push_back(object.ptr);
+            if (residency.isInUse)
+                continue;
+
+            // Objects merged in static batches, colored or waiting for their presentation are kept
+            const bool isPinned = m_mapNodeStaticBatchPart.find(nodeId) != m_mapNodeStaticBatchPart.cend()
+                    || m_mapColorOverrideObject.find(object.ptr) != m_mapColorOverrideObject.cend()
+                    || this->isPresentationPending(object.ptr);
+            if (isPinned) {
+                residency.isInUse = true;
+            }
+            else if (this->nodeVisibleState(nodeId) != Qt::Unchecked) {
+                gp_Trsf trsfExploding;
+                trsfExploding.SetTranslation(m_explodingFactor * object.explodingVector);
+                residency.isInUse = fnIsInViews(object.bndBox.Transformed(trsfExploding));
+            }
+        }
+    }
+
+    const uint64_t useTick = m_guiApp->nextPresentationUseTick();
+    bool isRestoring = false;
+    for (auto it = m_mapProductResidency.begin(); it != m_mapProductResidency.end(); ) {
+        PresentationResidency& residency = it->second;
+        if (residency.vecObject.empty() || (!hasBudget && !residency.isEvicted && !residency.isInUse)) {
+            it = m_mapProductResidency.erase(it);
+            continue;
+        }
+
+        if (residency.isInUse) {
+            residency.lastUseTick = useTick;
+            if (residency.isEvicted) {
+                // Presentations are computed again by the deferred presentations queue
+                residency.isEvicted = false;
+                for (const GraphicsObjectPtr& object : residency.vecObject) {
+                    if (m_setPendingPrsObject.insert(object).second)
+                        m_queuePendingPrsObject.push_back(object);
+                }
+
+                isRestoring = true;
+            }
+        }
+
+        ++it;
+    }
+
+    if (isRestoring)
+        m_timerPendingPrs->start();
+}
+
+std::vector<GuiDocument::EvictablePresentation> GuiDocument::evictablePresentations() const
+{
+    std::vector<EvictablePresentation> vecPrs;
+    for (const auto& [product, residency] : m_mapProductResidency) {
+        if (!residency.isInUse && !residency.isEvicted)
+            vecPrs.push_back({ product, residency.bytes, residency.lastUseTick });
+    }
+
+    return vecPrs;
+}
+
+void GuiDocument::evictPresentation(const GraphicsObjectPtr& product)
+{
+    auto itResidency = m_mapProductResidency.find(product);
+    if (itResidency == m_mapProductResidency.end())
+        return;
+
+    PresentationResidency& residency = itResidency->second;
+    if (residency.isInUse || residency.isEvicted)
+        return;
+
+    std::vector<int> vecReleasedMode;
+    for (const GraphicsObjectPtr& object : residency.vecObject) {
+        const int displayMode = object->DisplayMode();
+        if (displayMode == Internal::AisShape_BoundingBoxDisplayMode)
+            continue;
+
+        m_gfxScene.setObjectDisplayMode(object, Internal::AisShape_BoundingBoxDisplayMode);
+        m_gfxScene.releaseObjectPresentation(object, displayMode);
+        if (std::find(vecReleasedMode.cbegin(), vecReleasedMode.cend(), displayMode) == vecReleasedMode.cend())
+            vecReleasedMode.push_back(displayMode);
+    }
+
+    // Prototype of instances holds the actual GPU buffers
+    const auto& vecObject = residency.vecObject;
+    if (std::find(vecObject.cbegin(), vecObject.cend(), product) == vecObject.cend()) {
+        for (int displayMode : vecReleasedMode)
+            m_gfxScene.releaseObjectPresentation(product, displayMode);
+    }
+
+    residency.isEvicted = true;
+}
+
+bool GuiDocument::isCostlyTransparency(Graphic3d_RenderTransparentMethod method)
+{
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 5, 0)
+    return method == Graphic3d_RTM_DEPTH_PEELING_OIT;
+#else
+    Q_UNUSED(method);
+    return false;
+#endif
+}
+
+void GuiDocument::lowerViewQuality()
+{
+    if (m_viewFullQuality.isLowered)
+        return;
+
+    Graphic3d_RenderingParams& params = m_v3dView->ChangeRenderingParams();
+    m_viewFullQuality.msaaSampleCount = params.NbMsaaSamples;
+    params.NbMsaaSamples = 0;
+
+    // Hidden line removal presentations are otherwise recomputed on each camera change
+    m_viewFullQuality.isComputedModeOn = m_v3dView->ComputedMode();
+    if (m_viewFullQuality.isComputedModeOn)
+        m_v3dView->SetComputedMode(false);
+
+    m_viewFullQuality.vecCappedPlane.clear();
+    const Handle_Graphic3d_SequenceOfHClipPlane& seqClipPlane = m_v3dView->ClipPlanes();
+    if (!seqClipPlane.IsNull()) {
+        for (Graphic3d_SequenceOfHClipPlane::Iterator it(*seqClipPlane); it.More(); it.Next()) {
+            const Handle_Graphic3d_ClipPlane& plane = it.Value();
+            if (plane->IsOn() && plane->IsCapping()) {
+                plane->SetCapping(false);
+                m_viewFullQuality.vecCappedPlane.push_back(plane);
+            }
+        }
+    }
+
+    // Depth peeling renders the scene once per layer
+    if (GuiDocument::isCostlyTransparency(params.TransparencyMethod)) {
+        params.TransparencyMethod = Graphic3d_RTM_BLEND_OIT;
+        m_viewFullQuality.isTransparencyLowered = true;
+    }
+
+    m_viewFullQuality.isLowered = true;
+}
+
+void GuiDocument::restoreViewQuality()
+{
+    if (!m_viewFullQuality.isLowered)
+        return;
+
+    m_v3dView->ChangeRenderingParams().NbMsaaSamples = m_viewFullQuality.msaaSampleCount;
+    if (m_viewFullQuality.isComputedModeOn)
+        m_v3dView->SetComputedMode(true);
+
+    for (const Handle_Graphic3d_ClipPlane& plane : m_viewFullQuality.vecCappedPlane)
+        plane->SetCapping(true);
+
+    if (m_viewFullQuality.isTransparencyLowered)
+        m_v3dView->ChangeRenderingParams().TransparencyMethod = m_transparencyMethod;
+
+    m_viewFullQuality = {};
+}
+
+void GuiDocument::scheduleOcclusionCullingUpdate()
+{
+    if (m_isOcclusionCullingOn && !m_timerOcclusionCulling->isActive())
+        m_timerOcclusionCulling->start();
+}
+
+void GuiDocument::updateOcclusionCulling()
+{
+    MAYO_PROFILE_ZONE("GuiDocument::updateOcclusionCulling");
+    if (!m_isOcclusionCullingOn)
+        return;
+
+    if (m_gfxScene.hasPendingChanges() || m_gfxScene.isRedrawBlocked()) {
+        this->scheduleOcclusionCullingUpdate(); // Scene isn't idle, try later
+        return;
+    }
+
+    // Depths are those of the objects drawn in the last frame, occluded objects excluded
+    if (!m_occlusionMap.update(m_v3dView))
+        return;
+
+    bool isCullingChanged = false;
+    for (const GraphicsEntity& gfxEntity : m_vecGraphicsEntity) {
+        for (const GraphicsEntity::Object& object : gfxEntity.vecObject) {
+            if (!m_gfxScene.isObjectVisible(object.ptr))
+                continue;
+
+            gp_Trsf trsfExploding;
+            trsfExploding.SetTranslation(m_explodingFactor * object.explodingVector);
+            const bool isOccluded = m_occlusionMap.isOccluded(object.bndBox.Transformed(trsfExploding));
+            const bool wasOccluded = m_setOccludedObject.find(object.ptr) != m_setOccludedObject.cend();
+            if (isOccluded == wasOccluded)
+                continue;
+
+            if (isOccluded)
+                m_setOccludedObject.insert(object.ptr);
+            else
+                m_setOccludedObject.erase(object.ptr);
+
+            m_gfxScene.setObjectVisibleInView(object.ptr, m_v3dView, !isOccluded);
+            isCullingChanged = true;
+        }
+    }
+
+    m_occlusionMap.clear();
+    if (isCullingChanged)
+        m_gfxScene.redraw();
+}
+
+void GuiDocument::clearOcclusionCulling()
+{
+    if (m_setOccludedObject.empty())
+        return;
+
+    for (const GraphicsObjectPtr& object : m_setOccludedObject)
+        m_gfxScene.setObjectVisibleInView(object, m_v3dView, true);
+
+    m_setOccludedObject.clear();
+    m_gfxScene.redraw();
+}
+
+void GuiDocument::applySizeCulling()
+{
+    double threshold = m_sizeCullingThreshold;
+    if (m_isViewDynamicActionRunning)
+        threshold = std::max(threshold, m_dynamicSizeCullingThreshold);
+
+    // Culling size is a setting of Z layers, only layer of the document objects is affected
+    const Handle_V3d_Viewer& viewer = m_gfxScene.v3dViewer();
+    Graphic3d_ZLayerSettings layerSettings = viewer->ZLayerSettings(Graphic3d_ZLayerId_Default);
+    if (layerSettings.CullingSize() == threshold)
+        return;
+
+    layerSettings.SetCullingSize(threshold);
+    viewer->SetZLayerSettings(Graphic3d_ZLayerId_Default, layerSettings);
+    m_gfxScene.redraw();
+}
+
 static Aspect_TypeOfTriedronPosition toOccCorner(Qt::Corner corner)
 {
     switch (corner) {
@@ -463,11 +1144,13 @@ void GuiDocument::onDocumentEntityAdded(TreeNodeId entityTreeNodeId)
     this->mapEntity(entityTreeNodeId);
     BndUtils::add(&m_gfxBoundingBox, m_vecGraphicsEntity.back().bndBox);
     emit graphicsBoundingBoxChanged(m_gfxBoundingBox);
+    this->scheduleOcclusionCullingUpdate();
 }
 
 void GuiDocument::onDocumentEntityAboutToBeDestroyed(TreeNodeId entityTreeNodeId)
 {
     this->unmapEntity(entityTreeNodeId);
+    this->scheduleOcclusionCullingUpdate(); // Objects behind the entity might be uncovered
     // Recompute bounding box
     m_gfxBoundingBox.SetVoid();
     for (const GraphicsEntity& gfxEntity : m_vecGraphicsEntity)
@@ -476,8 +1159,124 @@ void GuiDocument::onDocumentEntityAboutToBeDestroyed(TreeNodeId entityTreeNodeId
     emit graphicsBoundingBoxChanged(m_gfxBoundingBox);
 }
 
+void GuiDocument::onDocumentDeferredShapesLoaded(TreeNodeId nodeId)
+{
+    const Tree<TDF_Label>& docModelTree = m_document->modelTree();
+    TreeNodeId entityTreeNodeId = nodeId;
+    while (!docModelTree.nodeIsRoot(entityTreeNodeId))
+        entityTreeNodeId = docModelTree.nodeParent(entityTreeNodeId);
+
+    auto itGfxEntity = std::find_if(
+                m_vecGraphicsEntity.begin(),
+                m_vecGraphicsEntity.end(),
+                [=](const GraphicsEntity& item) { return item.treeNodeId == entityTreeNodeId; });
+    if (itGfxEntity == m_vecGraphicsEntity.end())
+        return;
+
+    // Presentations of merged products might change
+    this->clearStaticBatches();
+    this->scheduleStaticBatchesUpdate();
+    std::unordered_set<TreeNodeId> setNodeId;
+    traverseTree(nodeId, docModelTree, [&](TreeNodeId id) { setNodeId.insert(id); });
+
+    // Presentations of the products whose shape was a placeholder have to be computed again
+    const bool isLazyMeshEnabled = GraphicsShapeObjectDriver::isLazyMeshEnabled();
+    std::unordered_set<GraphicsObjectPtr> setGfxProductDone;
+    GraphicsEntity& gfxEntity = *itGfxEntity;
+    for (GraphicsEntity::Object& object : gfxEntity.vecObject) {
+        const TreeNodeId objectNodeId = CppUtils::findValue(object.ptr, m_mapGfxObjectTreeNode);
+        if (setNodeId.find(objectNodeId) == setNodeId.cend())
+            continue;
+
+        const TDF_Label nodeLabel = docModelTree.nodeData(objectNodeId);
+        const TDF_Label productLabel =
+                XCaf::isShapeReference(nodeLabel) ? XCaf::shapeReferred(nodeLabel) : nodeLabel;
+        const GraphicsObjectPtr gfxProduct = Internal::graphicsProduct(object.ptr);
+        const bool isProductDone = !setGfxProductDone.insert(gfxProduct).second;
+        if (this->isLazyMeshPending(object.ptr)) {
+            // Bounding box was computed from placeholder shape
+            LazyMeshProduct& lazyProduct = m_mapLazyMeshProduct.at(gfxProduct);
+            object.bndBox = this->graphicsObjectBoundingBox(object);
+            for (LazyMeshProduct::Object& lazyObject : lazyProduct.vecObject) {
+                if (lazyObject.ptr == object.ptr)
+                    lazyObject.bndBox = object.bndBox;
+            }
+        }
+        else if (isLazyMeshEnabled && !GraphicsShapeObjectDriver::isMeshed(productLabel)) {
+            // Product is displayed back once meshed
+            auto itLazyProduct = m_mapLazyMeshProduct.find(gfxProduct);
+            if (itLazyProduct == m_mapLazyMeshProduct.end()) {
+                LazyMeshProduct lazyProduct;
+                lazyProduct.label = productLabel;
+                itLazyProduct = m_mapLazyMeshProduct.insert({ gfxProduct, std::move(lazyProduct) }).first;
+            }
+
+            m_gfxScene.eraseObject(object.ptr);
+            object.bndBox = this->graphicsObjectBoundingBox(object);
+            itLazyProduct->second.vecObject.push_back({ object.ptr, objectNodeId, object.bndBox });
+        }
+        else {
+            if (!isProductDone)
+                m_gfxScene.recomputeObjectPresentation(gfxProduct);
+
+            object.bndBox = this->graphicsObjectBoundingBox(object);
+        }
+    }
+
+    gfxEntity.bndBox.SetVoid();
+    for (const GraphicsEntity::Object& object : gfxEntity.vecObject)
+        BndUtils::add(&gfxEntity.bndBox, object.bndBox);
+
+    GuiDocument::updateExplodingVectors(&gfxEntity);
+
+    m_gfxBoundingBox.SetVoid();
+    for (const GraphicsEntity& item : m_vecGraphicsEntity)
+        BndUtils::add(&m_gfxBoundingBox, item.bndBox);
+
+    emit graphicsBoundingBoxChanged(m_gfxBoundingBox);
+    m_gfxScene.redraw();
+    this->requestLazyMeshes();
+}
+
+void GuiDocument::onDocumentShapesUnloaded(TreeNodeId entityTreeNodeId)
+{
+    auto itGfxEntity = std::find_if(
+                m_vecGraphicsEntity.cbegin(),
+                m_vecGraphicsEntity.cend(),
+                [=](const GraphicsEntity& item) { return item.treeNodeId == entityTreeNodeId; });
+    if (itGfxEntity == m_vecGraphicsEntity.cend())
+        return;
+
+    const Tree<TDF_Label>& docModelTree = m_document->modelTree();
+    std::unordered_set<GraphicsObjectPtr> setGfxProductDone;
+    for (const GraphicsEntity::Object& object : itGfxEntity->vecObject) {
+        const TreeNodeId objectNodeId = CppUtils::findValue(object.ptr, m_mapGfxObjectTreeNode);
+        const TDF_Label nodeLabel = docModelTree.nodeData(objectNodeId);
+        const TDF_Label productLabel =
+                XCaf::isShapeReference(nodeLabel) ? XCaf::shapeReferred(nodeLabel) : nodeLabel;
+        if (!m_document->isShapeDeferred(productLabel))
+            continue; // Prototype kept resident
+
+        // Instances copy the sensitive entities of their product
+        m_gfxScene.releaseObjectResources(object.ptr);
+        const GraphicsObjectPtr gfxProduct = Internal::graphicsProduct(object.ptr);
+        if (!setGfxProductDone.insert(gfxProduct).second)
+            continue;
+
+        // Shape is read again from the label once the presentation is computed
+        auto aisShape = Handle_AIS_Shape::DownCast(gfxProduct);
+        if (aisShape)
+            aisShape->Set(XCaf::shape(productLabel));
+
+        m_gfxScene.releaseObjectResources(gfxProduct);
+    }
+}
+
 void GuiDocument::onGraphicsSelectionChanged()
 {
+    if (m_isTogglingItemsSelected)
+        return;
+
     m_guiApp->connectApplicationItemSelectionChanged(false);
     auto _ = gsl::finally([=]{ m_guiApp->connectApplicationItemSelectionChanged(true); });
 
@@ -488,23 +1287,51 @@ void GuiDocument::onGraphicsSelectionChanged()
     }
 
     std::vector<ApplicationItem> vecSelected;
+    std::unordered_set<TreeNodeId> setSelectedNodeId;
+    std::vector<GraphicsOwnerPtr> vecBatchOwner;
+    std::vector<TreeNodeId> vecBatchNodeId;
     m_gfxScene.foreachSelectedOwner([&](const GraphicsOwnerPtr& gfxOwner) {
         auto gfxObject = GraphicsObjectPtr::DownCast(
                     gfxOwner ? gfxOwner->Selectable() : Handle_SelectMgr_SelectableObject());
-        const TreeNodeId nodeId = this->nodeFromGraphicsObject(gfxObject);
-        if (nodeId != 0) {
+        auto batchOwner = Handle_GraphicsMergedShapesOwner::DownCast(gfxOwner);
+        const TreeNodeId nodeId =
+                batchOwner ? this->nodeFromStaticBatchOwner(batchOwner) : this->nodeFromGraphicsObject(gfxObject);
+        if (batchOwner && nodeId != 0) {
+            vecBatchOwner.push_back(gfxOwner);
+            vecBatchNodeId.push_back(nodeId);
+        }
+
+        if (nodeId != 0 && setSelectedNodeId.insert(nodeId).second) {
             const ApplicationItem appItem({ m_document, nodeId });
             vecSelected.push_back(std::move(appItem));
         }
     });
 
+    // Parts picked in static batches are split out, their own instance is selected instead
+    if (!vecBatchOwner.empty()) {
+        m_isTogglingItemsSelected = true;
+        auto _ = gsl::finally([=]{ m_isTogglingItemsSelected = false; });
+        m_gfxScene.deselectOwners(vecBatchOwner);
+        this->splitStaticBatchParts(vecBatchNodeId);
+        std::vector<GraphicsOwnerPtr> vecInstanceOwner;
+        for (TreeNodeId nodeId : vecBatchNodeId) {
+            const GraphicsObjectPtr gfxObject = this->findGraphicsObject(nodeId);
+            if (gfxObject) {
+                m_gfxScene.activatePendingObjectSelection(gfxObject);
+                vecInstanceOwner.push_back(gfxObject->GlobalSelOwner());
+            }
+        }
+
+        m_gfxScene.selectOwners(vecInstanceOwner);
+    }
+
     std::vector<ApplicationItem> vecRemoved;
     for (const ApplicationItem& appItem : appSelectionModel->selectedItems()) {
         if (appItem.document() != m_document)
             continue;
 
-        auto it = std::find(vecSelected.cbegin(), vecSelected.cend(), appItem);
-        if (it == vecSelected.cend())
+        const TreeNodeId nodeId = appItem.isDocumentTreeNode() ? appItem.documentTreeNode().id() : 0;
+        if (setSelectedNodeId.find(nodeId) == setSelectedNodeId.cend())
             vecRemoved.push_back(appItem);
     }
 
@@ -515,28 +1342,113 @@ void GuiDocument::onGraphicsSelectionChanged()
         appSelectionModel->remove(vecRemoved);
 }
 
+Bnd_Box GuiDocument::graphicsObjectBoundingBox(const GraphicsEntity::Object& object) const
+{
+    const TreeNodeId nodeId = CppUtils::findValue(object.ptr, m_mapGfxObjectTreeNode);
+    const TDF_Label nodeLabel = nodeId != 0 ? m_document->modelTree().nodeData(nodeId) : TDF_Label();
+    if (!nodeLabel.IsNull() && XCaf::isShape(nodeLabel)) {
+        const TDF_Label productLabel =
+                XCaf::isShapeReference(nodeLabel) ? XCaf::shapeReferred(nodeLabel) : nodeLabel;
+        return m_document->bndBoxCache().labelBox(productLabel).Transformed(object.trsfOriginal);
+    }
+
+    return GraphicsUtils::AisObject_boundingBox(object.ptr);
+}
+
+void GuiDocument::onDocumentDeferredScalingsApplied()
+{
+    // Scaling moved from the graphics objects to the shapes, products are created again from the
+    // scaled shapes. All entities are unmapped first, as products can be shared between entities
+    std::vector<TreeNodeId> vecEntityTreeNodeId;
+    std::vector<TreeNodeId> vecHiddenTreeNodeId;
+    for (const GraphicsEntity& gfxEntity : m_vecGraphicsEntity) {
+        vecEntityTreeNodeId.push_back(gfxEntity.treeNodeId);
+        traverseTree(gfxEntity.treeNodeId, m_document->modelTree(), [&](TreeNodeId id) {
+            if (this->nodeVisibleState(id) == Qt::Unchecked)
+                vecHiddenTreeNodeId.push_back(id);
+        });
+    }
+
+    for (TreeNodeId entityTreeNodeId : vecEntityTreeNodeId)
+        this->unmapEntity(entityTreeNodeId);
+
+    for (TreeNodeId entityTreeNodeId : vecEntityTreeNodeId)
+        this->mapEntity(entityTreeNodeId);
+
+    this->setNodesVisible(vecHiddenTreeNodeId, false);
+    m_gfxBoundingBox.SetVoid();
+    for (const GraphicsEntity& gfxEntity : m_vecGraphicsEntity)
+        BndUtils::add(&m_gfxBoundingBox, gfxEntity.bndBox);
+
+    emit graphicsBoundingBoxChanged(m_gfxBoundingBox);
+}
+
+void GuiDocument::scheduleShapePaging()
+{
+    if (m_guiApp->isShapePagingOn())
+        m_timerShapePaging->start();
+}
+
+void GuiDocument::pageOutHiddenEntities()
+{
+    if (!m_guiApp->isShapePagingOn())
+        return;
+
+    for (const GraphicsEntity& gfxEntity : m_vecGraphicsEntity) {
+        auto itState = m_mapTreeNodeCheckState.find(gfxEntity.treeNodeId);
+        if (itState != m_mapTreeNodeCheckState.cend() && itState->second == Qt::Unchecked)
+            m_guiApp->shapePager().pageOut(m_document, gfxEntity.treeNodeId);
+    }
+}
+
 void GuiDocument::mapEntity(TreeNodeId entityTreeNodeId)
 {
+    MAYO_PROFILE_ZONE("GuiDocument::mapEntity");
     const Tree<TDF_Label>& docModelTree = m_document->modelTree();
     GraphicsEntity gfxEntity;
     gfxEntity.treeNodeId = entityTreeNodeId;
-    std::unordered_map<TDF_Label, GraphicsObjectPtr> mapLabelGfxProduct;
+    std::unordered_set<TDF_Label> setProductLabel;
+    const bool isLazyMeshEnabled = GraphicsShapeObjectDriver::isLazyMeshEnabled();
+    auto fnCreateGfxProduct = [&](const TDF_Label& label) {
+        GraphicsObjectPtr gfxProduct = m_guiApp->graphicsObjectDriverTable()->createObject(label);
+        if (gfxProduct && isLazyMeshEnabled && !GraphicsShapeObjectDriver::isMeshed(label)) {
+            LazyMeshProduct lazyProduct;
+            lazyProduct.label = label;
+            m_mapLazyMeshProduct.insert({ gfxProduct, std::move(lazyProduct) });
+        }
 
+        return gfxProduct;
+    };
+
+    // Deferred scaling of the entity is applied on the graphics objects only
+    gp_Trsf trsfScaling;
+    trsfScaling.SetScale(gp::Origin(), m_document->deferredScaling(docModelTree.nodeData(entityTreeNodeId)));
     traverseTree(entityTreeNodeId, docModelTree, [&](TreeNodeId id) {
         const TDF_Label nodeLabel = docModelTree.nodeData(id);
         if (docModelTree.nodeIsLeaf(id)) {
-            GraphicsObjectPtr gfxProduct = CppUtils::findValue(nodeLabel, mapLabelGfxProduct);
-            if (!gfxProduct) {
-                gfxProduct = m_guiApp->graphicsObjectDriverTable()->createObject(nodeLabel);
-                if (!gfxProduct)
-                    return;
-
-                mapLabelGfxProduct.insert({ nodeLabel, gfxProduct });
-            }
-
             if (!docModelTree.nodeIsRoot(id)) {
-                Handle_AIS_ConnectedInteractive gfxInstance = new AIS_ConnectedInteractive;
-                gfxInstance->Connect(gfxProduct, XCaf::shapeAbsoluteLocation(docModelTree, id));
+                // Instances of the same prototype, possibly belonging to other entities, are
+                // connected to a single product: its presentation(and GPU buffers) is computed once
+                auto itProduct = m_mapLabelGfxProduct.find(nodeLabel);
+                if (itProduct == m_mapLabelGfxProduct.end()) {
+                    GraphicsProduct product;
+                    product.ptr = fnCreateGfxProduct(nodeLabel);
+                    if (!product.ptr)
+                        return;
+
+                    itProduct = m_mapLabelGfxProduct.insert({ nodeLabel, product }).first;
+                }
+
+                if (setProductLabel.insert(nodeLabel).second) {
+                    ++(itProduct->second.entityCount);
+                    gfxEntity.vecProductLabel.push_back(nodeLabel);
+                }
+
+                const GraphicsObjectPtr& gfxProduct = itProduct->second.ptr;
+                Handle_AIS_ConnectedInteractive gfxInstance = new GraphicsShapeInstanceObject;
+                gfxInstance->Connect(
+                            gfxProduct,
+                            trsfScaling * m_document->xcaf().shapeAbsoluteLocation(id).Transformation());
                 gfxInstance->SetDisplayMode(gfxProduct->DisplayMode());
                 gfxInstance->Attributes()->SetFaceBoundaryDraw(gfxProduct->Attributes()->FaceBoundaryDraw());
                 gfxInstance->SetOwner(gfxProduct->GetOwner());
@@ -545,28 +1457,59 @@ void GuiDocument::mapEntity(TreeNodeId entityTreeNodeId)
                     id = docModelTree.nodeParent(id);
             }
             else {
+                const GraphicsObjectPtr gfxProduct = fnCreateGfxProduct(nodeLabel);
+                if (!gfxProduct)
+                    return;
+
+                if (trsfScaling.Form() != gp_Identity)
+                    m_gfxScene.setObjectTransformation(gfxProduct, trsfScaling);
+
                 gfxEntity.vecObject.push_back(gfxProduct);
             }
 
             const GraphicsEntity::Object& lastGfxObject = gfxEntity.vecObject.back();
-            gfxEntity.mapTreeNodeGfxObject.insert({ id, lastGfxObject.ptr });
-            gfxEntity.mapGfxObjectTreeNode.insert({ lastGfxObject.ptr, id });
+            if (id >= m_vecTreeNodeGfxObject.size())
+                m_vecTreeNodeGfxObject.resize(id + 1);
+
+            m_vecTreeNodeGfxObject.at(id) = lastGfxObject.ptr;
+            m_mapGfxObjectTreeNode.insert({ lastGfxObject.ptr, id });
         }
     });
 
     for (const GraphicsEntity::Object& object : gfxEntity.vecObject) {
-        m_gfxScene.addObject(object.ptr);
+        if (this->isLazyMeshPending(object.ptr))
+            continue;
+
+        if (Internal::hasBoundingBoxPlaceholder(object.ptr)) {
+            object.ptr->SetDisplayMode(Internal::AisShape_BoundingBoxDisplayMode);
+            m_gfxScene.addObject(object.ptr, GraphicsScene::AddObjectLazySelectionMode);
+            if (m_setPendingPrsObject.insert(object.ptr).second)
+                m_queuePendingPrsObject.push_back(object.ptr);
+
+            continue;
+        }
+
+        m_gfxScene.addObject(object.ptr, GraphicsScene::AddObjectLazySelectionMode);
         auto driver = GraphicsObjectDriver::get(object.ptr);
         if (driver)
             driver->applyDisplayMode(object.ptr, this->activeDisplayMode(driver));
     }
 
     for (GraphicsEntity::Object& object : gfxEntity.vecObject) {
-        object.bndBox = GraphicsUtils::AisObject_boundingBox(object.ptr);
         object.trsfOriginal = m_gfxScene.objectTransformation(object.ptr);
+        // Boxes of shapes come from the document cache, so there's no need to wait for presentations
+        object.bndBox = this->graphicsObjectBoundingBox(object);
+        auto itLazyProduct = m_mapLazyMeshProduct.find(Internal::graphicsProduct(object.ptr));
+        if (itLazyProduct != m_mapLazyMeshProduct.end()) {
+            LazyMeshProduct& lazyProduct = itLazyProduct->second;
+            const TreeNodeId nodeId = CppUtils::findValue(object.ptr, m_mapGfxObjectTreeNode);
+            lazyProduct.vecObject.push_back({ object.ptr, nodeId, object.bndBox });
+        }
+
         BndUtils::add(&gfxEntity.bndBox, object.bndBox);
     }
 
+    GuiDocument::updateExplodingVectors(&gfxEntity);
     m_gfxScene.redraw();
 
     traverseTree(entityTreeNodeId, docModelTree, [=](TreeNodeId id) {
@@ -575,17 +1518,72 @@ void GuiDocument::mapEntity(TreeNodeId entityTreeNodeId)
 
     GraphicsUtils::V3dView_fitAll(m_v3dView);
     m_vecGraphicsEntity.push_back(std::move(gfxEntity));
+    this->requestLazyMeshes();
+    this->updateViewLevelOfDetail();
+    if (!m_queuePendingPrsObject.empty())
+        m_timerPendingPrs->start();
+
+    this->scheduleStaticBatchesUpdate();
 }
 
 void GuiDocument::unmapEntity(TreeNodeId entityTreeNodeId)
 {
+    MAYO_PROFILE_ZONE("GuiDocument::unmapEntity");
     {   // Delete entity graphics
         const GraphicsEntity* ptrItem = this->findGraphicsEntity(entityTreeNodeId);
         if (!ptrItem)
             return;
 
-        for (const GraphicsEntity::Object& object : ptrItem->vecObject)
+        // Batches might hold parts of the entity
+        this->clearStaticBatches();
+        this->scheduleStaticBatchesUpdate();
+
+        for (const GraphicsEntity::Object& object : ptrItem->vecObject) {
+            auto itLazyProduct = m_mapLazyMeshProduct.find(Internal::graphicsProduct(object.ptr));
+            if (itLazyProduct != m_mapLazyMeshProduct.end()) {
+                // Product might still be instantiated by other entities
+                std::vector<LazyMeshProduct::Object>& vecLazyObject = itLazyProduct->second.vecObject;
+                vecLazyObject.erase(
+                            std::remove_if(vecLazyObject.begin(), vecLazyObject.end(), [&](const LazyMeshProduct::Object& lazyObject) {
+                                return lazyObject.ptr == object.ptr;
+                            }),
+                            vecLazyObject.end());
+                if (vecLazyObject.empty()) {
+                    const TaskId taskId = itLazyProduct->second.taskId;
+                    if (taskId != 0) {
+                        TaskManager::globalInstance()->requestAbort(taskId);
+                        m_mapTaskLazyMeshProduct.erase(taskId);
+                    }
+
+                    m_mapLazyMeshProduct.erase(itLazyProduct);
+                }
+            }
+
+            auto itObjectNode = m_mapGfxObjectTreeNode.find(object.ptr);
+            if (itObjectNode != m_mapGfxObjectTreeNode.end()) {
+                m_vecTreeNodeGfxObject.at(itObjectNode->second).Nullify();
+                m_mapGfxObjectTreeNode.erase(itObjectNode);
+            }
+
+            m_setPendingPrsObject.erase(object.ptr); // Queue item is skipped when processed
+            m_mapColorOverrideObject.erase(object.ptr);
+            m_setOccludedObject.erase(object.ptr);
+            auto itResidency = m_mapProductResidency.find(Internal::graphicsProduct(object.ptr));
+            if (itResidency != m_mapProductResidency.end()) {
+                std::vector<GraphicsObjectPtr>& vecObject = itResidency->second.vecObject;
+                vecObject.erase(std::remove(vecObject.begin(), vecObject.end(), object.ptr), vecObject.end());
+                if (vecObject.empty())
+                    m_mapProductResidency.erase(itResidency);
+            }
+
             m_gfxScene.eraseObject(object.ptr);
+        }
+
+        for (const TDF_Label& productLabel : ptrItem->vecProductLabel) {
+            auto itProduct = m_mapLabelGfxProduct.find(productLabel);
+            if (itProduct != m_mapLabelGfxProduct.end() && --(itProduct->second.entityCount) <= 0)
+                m_mapLabelGfxProduct.erase(itProduct);
+        }
 
         const int indexItem = ptrItem - &m_vecGraphicsEntity.front();
         m_vecGraphicsEntity.erase(m_vecGraphicsEntity.begin() + indexItem);
@@ -597,6 +1595,374 @@ void GuiDocument::unmapEntity(TreeNodeId entityTreeNodeId)
     });
 }
 
+bool GuiDocument::isLazyMeshPending(const GraphicsObjectPtr& object) const
+{
+    if (m_mapLazyMeshProduct.empty())
+        return false;
+
+    return m_mapLazyMeshProduct.find(Internal::graphicsProduct(object)) != m_mapLazyMeshProduct.cend();
+}
+
+void GuiDocument::requestLazyMeshes()
+{
+    for (auto& [gfxProduct, lazyProduct] : m_mapLazyMeshProduct) {
+        if (lazyProduct.taskId != 0)
+            continue; // Already requested
+
+        // Products completely hidden are skipped, meshing is requested once they are made visible
+        // Products located inside the view frustum are meshed first
+        bool isVisible = false;
+        bool isInFrustum = false;
+        for (const LazyMeshProduct::Object& object : lazyProduct.vecObject) {
+            if (this->nodeVisibleState(object.treeNodeId) != Qt::Unchecked) {
+                isVisible = true;
+                isInFrustum = GraphicsUtils::V3dView_isInFrustum(m_v3dView, object.bndBox);
+                if (isInFrustum)
+                    break;
+            }
+        }
+
+        if (isVisible) {
+            const int priority = isInFrustum ? TaskPriority_Interactive : TaskPriority_Normal;
+            lazyProduct.taskId = GraphicsShapeObjectDriver::requestMesh(lazyProduct.label, priority);
+            if (lazyProduct.taskId != 0)
+                m_mapTaskLazyMeshProduct.insert({ lazyProduct.taskId, gfxProduct });
+        }
+    }
+}
+
+void GuiDocument::onLazyMeshTaskEnded(TaskId taskId)
+{
+    auto itTask = m_mapTaskLazyMeshProduct.find(taskId);
+    if (itTask == m_mapTaskLazyMeshProduct.end())
+        return;
+
+    auto itLazyProduct = m_mapLazyMeshProduct.find(itTask->second);
+    m_mapTaskLazyMeshProduct.erase(itTask);
+    if (itLazyProduct == m_mapLazyMeshProduct.end())
+        return;
+
+    // Task might have been aborted, then wait for the next request
+    if (!GraphicsShapeObjectDriver::isMeshed(itLazyProduct->second.label)) {
+        itLazyProduct->second.taskId = 0;
+        return;
+    }
+
+    const LazyMeshProduct lazyProduct = std::move(itLazyProduct->second);
+    m_mapLazyMeshProduct.erase(itLazyProduct);
+    for (const LazyMeshProduct::Object& object : lazyProduct.vecObject) {
+        m_gfxScene.addObject(object.ptr, GraphicsScene::AddObjectLazySelectionMode);
+        auto driver = GraphicsObjectDriver::get(object.ptr);
+        if (driver)
+            driver->applyDisplayMode(object.ptr, this->activeDisplayMode(driver));
+
+        if (this->nodeVisibleState(object.treeNodeId) == Qt::Unchecked)
+            m_gfxScene.setObjectVisible(object.ptr, false);
+    }
+
+    m_gfxScene.redraw();
+    this->scheduleStaticBatchesUpdate();
+    m_guiApp->schedulePresentationMemoryBudgetCheck();
+    if (GraphicsShapeObjectDriver::isMeshRefinementEnabled())
+        this->requestMeshRefinement(lazyProduct);
+}
+
+void GuiDocument::requestMeshRefinement(const LazyMeshProduct& lazyProduct)
+{
+    const TaskId taskId = GraphicsShapeObjectDriver::requestMeshRefinement(lazyProduct.label);
+    if (taskId != 0) {
+        LazyMeshProduct refineProduct = lazyProduct;
+        refineProduct.taskId = taskId;
+        m_mapTaskRefineMeshProduct.insert({ taskId, std::move(refineProduct) });
+    }
+}
+
+void GuiDocument::onMeshRefinementTaskEnded(TaskId taskId)
+{
+    auto itTask = m_mapTaskRefineMeshProduct.find(taskId);
+    if (itTask == m_mapTaskRefineMeshProduct.end())
+        return;
+
+    const LazyMeshProduct refineProduct = std::move(itTask->second);
+    m_mapTaskRefineMeshProduct.erase(itTask);
+    if (!GraphicsShapeObjectDriver::commitMeshRefinement(taskId))
+        return; // Aborted, coarse tessellation is kept
+
+    // Objects unmapped in the meantime are skipped, as well as the ones waiting for their
+    // presentation(computed later from the refined triangulations)
+    bool isPresentationChanged = false;
+    for (const LazyMeshProduct::Object& object : refineProduct.vecObject) {
+        if (this->nodeFromGraphicsObject(object.ptr) == 0 || this->isPresentationPending(object.ptr))
+            continue;
+
+        m_gfxScene.recomputeObjectPresentation(object.ptr);
+        isPresentationChanged = true;
+    }
+
+    if (isPresentationChanged) {
+        m_gfxScene.redraw();
+        this->scheduleStaticBatchesUpdate();
+        m_guiApp->schedulePresentationMemoryBudgetCheck();
+    }
+}
+
+bool GuiDocument::isPresentationPending(const GraphicsObjectPtr& object) const
+{
+    return m_setPendingPrsObject.find(object) != m_setPendingPrsObject.cend();
+}
+
+void GuiDocument::completePendingPresentations()
+{
+    {
+        GraphicsSceneRedrawBlocker blocker(&m_gfxScene);
+        while (!m_queuePendingPrsObject.empty())
+            this->processPendingPresentations();
+    }
+
+    m_timerPendingPrs->stop();
+    m_gfxScene.flushPendingChanges();
+}
+
+void GuiDocument::processPendingPresentations()
+{
+    constexpr int frameBudgetMsecs = 16;
+    QElapsedTimer chrono;
+    chrono.start();
+    int processedCount = 0;
+    while (!m_queuePendingPrsObject.empty()) {
+        if (processedCount > 0 && chrono.elapsed() >= frameBudgetMsecs)
+            break;
+
+        const GraphicsObjectPtr object = m_queuePendingPrsObject.front();
+        m_queuePendingPrsObject.pop_front();
+        if (m_setPendingPrsObject.erase(object) == 0)
+            continue; // Object was unmapped in the meantime
+
+        auto driver = GraphicsObjectDriver::get(object);
+        if (driver)
+            driver->applyDisplayMode(object, this->activeDisplayMode(driver));
+
+        ++processedCount;
+    }
+
+    if (processedCount > 0)
+        m_gfxScene.redraw();
+
+    if (!m_queuePendingPrsObject.empty()) {
+        m_timerPendingPrs->start();
+    }
+    else if (processedCount > 0) {
+        this->scheduleStaticBatchesUpdate();
+        m_guiApp->schedulePresentationMemoryBudgetCheck();
+    }
+}
+
+void GuiDocument::scheduleStaticBatchesUpdate()
+{
+    if (m_isStaticBatchingOn)
+        m_timerStaticBatches->start();
+}
+
+void GuiDocument::updateStaticBatches()
+{
+    MAYO_PROFILE_ZONE("GuiDocument::updateStaticBatches");
+    GraphicsSceneRedrawBlocker redrawBlocker(&m_gfxScene);
+    this->clearStaticBatches();
+    if (!m_isStaticBatchingOn || m_explodingFactor != 0. || m_gfxBoundingBox.IsVoid())
+        return;
+
+    std::unordered_set<GraphicsObjectPtr> setSelectedObject;
+    m_gfxScene.foreachSelectedOwner([&](const GraphicsOwnerPtr& gfxOwner) {
+        auto gfxObject = GraphicsObjectPtr::DownCast(
+                    gfxOwner ? gfxOwner->Selectable() : Handle_SelectMgr_SelectableObject());
+        if (gfxObject)
+            setSelectedObject.insert(gfxObject);
+    });
+
+    // Distinct shading aspects of the parts
+    struct ShadingAspect {
+        Quantity_Color color;
+        Graphic3d_MaterialAspect material;
+        double transparency;
+    };
+    std::vector<ShadingAspect> vecShadingAspect;
+    auto fnShadingAspectIndex = [&](const Handle_Prs3d_ShadingAspect& aspect) {
+        const ShadingAspect item = { aspect->Color(), aspect->Material(), aspect->Transparency() };
+        auto itAspect = std::find_if(vecShadingAspect.cbegin(), vecShadingAspect.cend(), [&](const ShadingAspect& other) {
+            return other.color.IsEqual(item.color)
+                    && other.material.IsEqual(item.material)
+                    && other.transparency == item.transparency;
+        });
+        if (itAspect != vecShadingAspect.cend())
+            return int(itAspect - vecShadingAspect.cbegin());
+
+        vecShadingAspect.push_back(item);
+        return int(vecShadingAspect.size()) - 1;
+    };
+
+    // Candidate parts grouped by grid cell and shading aspect
+    struct Candidate {
+        TreeNodeId treeNodeId;
+        GraphicsObjectPtr ptr;
+        TopoDS_Shape shape; // Located
+        int triangleCount;
+    };
+    const BndBoxCoords bbc = BndBoxCoords::get(m_gfxBoundingBox);
+    const double sizeMax = std::max({ bbc.xmax - bbc.xmin, bbc.ymax - bbc.ymin, bbc.zmax - bbc.zmin });
+    const double cellSize = sizeMax > 0. ? sizeMax / Internal::StaticBatchGridSize : 1.;
+    std::map<std::array<int, 5>, std::vector<Candidate>> mapKeyCandidates;
+    std::unordered_map<GraphicsObjectPtr, int> mapProductTriangleCount;
+    for (const GraphicsEntity& gfxEntity : m_vecGraphicsEntity) {
+        for (const GraphicsEntity::Object& object : gfxEntity.vecObject) {
+            auto gfxInstance = Handle_GraphicsShapeInstanceObject::DownCast(object.ptr);
+            auto gfxProduct =
+                    gfxInstance ? Handle_XCAFPrs_AISObject::DownCast(gfxInstance->ConnectedTo()) : Handle_XCAFPrs_AISObject();
+            if (!gfxProduct
+                    || object.ptr->DisplayMode() != AIS_Shaded
+                    || !gfxProduct->CustomAspectsMap().IsEmpty() // Faces of distinct colors
+                    || this->isLazyMeshPending(object.ptr)
+                    || this->isPresentationPending(object.ptr)
+                    || m_mapColorOverrideObject.find(object.ptr) != m_mapColorOverrideObject.cend()
+                    || setSelectedObject.find(object.ptr) != setSelectedObject.cend()
+                    || object.trsfOriginal.ScaleFactor() != 1. // Deferred scaling, can't locate a shape
+                    || !GraphicsUtils::AisObject_isVisible(object.ptr))
+            {
+                continue;
+            }
+
+            auto itTriangleCount = mapProductTriangleCount.find(gfxProduct);
+            if (itTriangleCount == mapProductTriangleCount.end()) {
+                const int triangleCount = GraphicsMergedShapesObject::shapeTriangleCount(gfxProduct->Shape());
+                itTriangleCount = mapProductTriangleCount.insert({ gfxProduct, triangleCount }).first;
+            }
+
+            const int triangleCount = itTriangleCount->second;
+            if (triangleCount == 0 || triangleCount > Internal::StaticBatchMaxPartTriangleCount)
+                continue;
+
+            const gp_Pnt center = BndBoxCoords::get(object.bndBox).center();
+            const std::array<int, 5> key = {
+                int(std::floor((center.X() - bbc.xmin) / cellSize)),
+                int(std::floor((center.Y() - bbc.ymin) / cellSize)),
+                int(std::floor((center.Z() - bbc.zmin) / cellSize)),
+                fnShadingAspectIndex(gfxProduct->Attributes()->ShadingAspect()),
+                object.ptr->Attributes()->FaceBoundaryDraw() ? 1 : 0
+            };
+            Candidate candidate;
+            candidate.treeNodeId = CppUtils::findValue(object.ptr, m_mapGfxObjectTreeNode);
+            candidate.ptr = object.ptr;
+            candidate.shape = gfxProduct->Shape().Moved(TopLoc_Location(object.trsfOriginal));
+            candidate.triangleCount = triangleCount;
+            if (candidate.treeNodeId != 0)
+                mapKeyCandidates[key].push_back(std::move(candidate));
+        }
+    }
+
+    // Lone parts are left as they are, merging them would save nothing
+    for (const auto& [key, vecCandidate] : mapKeyCandidates) {
+        if (vecCandidate.size() < 2)
+            continue;
+
+        const ShadingAspect& aspect = vecShadingAspect.at(key.at(3));
+        StaticBatch* batch = nullptr;
+        int batchTriangleCount = 0;
+        for (const Candidate& candidate : vecCandidate) {
+            if (!batch || batchTriangleCount + candidate.triangleCount > Internal::StaticBatchMaxTriangleCount) {
+                m_vecStaticBatch.push_back({});
+                batch = &m_vecStaticBatch.back();
+                batch->ptr = new GraphicsMergedShapesObject;
+                batch->ptr->setShadingAspect(aspect.color, aspect.material, aspect.transparency);
+                batch->ptr->Attributes()->SetFaceBoundaryDraw(key.at(4) != 0);
+                batchTriangleCount = 0;
+            }
+
+            const int partIndex = batch->ptr->addPart(candidate.shape);
+            batch->vecPartTreeNodeId.push_back(candidate.treeNodeId);
+            batchTriangleCount += candidate.triangleCount;
+            const int batchIndex = int(m_vecStaticBatch.size()) - 1;
+            m_mapNodeStaticBatchPart.insert({ candidate.treeNodeId, { batchIndex, partIndex } });
+            GraphicsUtils::AisObject_setVisible(candidate.ptr, false);
+        }
+    }
+
+    for (const StaticBatch& batch : m_vecStaticBatch)
+        m_gfxScene.addObject(batch.ptr, GraphicsScene::AddObjectLazySelectionMode);
+
+    m_gfxScene.redraw();
+}
+
+void GuiDocument::clearStaticBatches()
+{
+    for (const StaticBatch& batch : m_vecStaticBatch) {
+        if (batch.ptr)
+            m_gfxScene.eraseObject(batch.ptr);
+    }
+
+    for (const auto& [nodeId, batchPart] : m_mapNodeStaticBatchPart)
+        GraphicsUtils::AisObject_setVisible(this->findGraphicsObject(nodeId), true);
+
+    m_vecStaticBatch.clear();
+    m_mapNodeStaticBatchPart.clear();
+}
+
+void GuiDocument::splitStaticBatchParts(Span<const TreeNodeId> spanNodeId)
+{
+    if (m_mapNodeStaticBatchPart.empty())
+        return;
+
+    std::unordered_set<int> setBatchIndex;
+    const Tree<TDF_Label>& docModelTree = m_document->modelTree();
+    for (TreeNodeId nodeId : spanNodeId) {
+        traverseTree(nodeId, docModelTree, [&](TreeNodeId id) {
+            auto itBatchPart = m_mapNodeStaticBatchPart.find(id);
+            if (itBatchPart == m_mapNodeStaticBatchPart.end())
+                return;
+
+            const StaticBatchPart batchPart = itBatchPart->second;
+            m_mapNodeStaticBatchPart.erase(itBatchPart);
+            m_vecStaticBatch.at(batchPart.batchIndex).ptr->setPartExcluded(batchPart.partIndex, true);
+            GraphicsUtils::AisObject_setVisible(this->findGraphicsObject(id), true);
+            setBatchIndex.insert(batchPart.batchIndex);
+        });
+    }
+
+    for (int batchIndex : setBatchIndex) {
+        Handle_GraphicsMergedShapesObject& gfxBatch = m_vecStaticBatch.at(batchIndex).ptr;
+        if (gfxBatch->includedPartCount() == 0) {
+            m_gfxScene.eraseObject(gfxBatch);
+            gfxBatch.Nullify();
+        }
+        else {
+            m_gfxScene.recomputeObjectPresentation(gfxBatch);
+        }
+    }
+}
+
+TreeNodeId GuiDocument::nodeFromStaticBatchOwner(const Handle_GraphicsMergedShapesOwner& owner) const
+{
+    for (const StaticBatch& batch : m_vecStaticBatch) {
+        if (batch.ptr && batch.ptr.get() == owner->Selectable().get()) {
+            const int partIndex = owner->partIndex();
+            const bool isPartMerged = partIndex < batch.ptr->partCount() && !batch.ptr->isPartExcluded(partIndex);
+            return isPartMerged ? batch.vecPartTreeNodeId.at(partIndex) : 0;
+        }
+    }
+
+    return 0;
+}
+
+void GuiDocument::updateExplodingVectors(GraphicsEntity* gfxEntity)
+{
+    const gp_Pnt entityCenter = BndBoxCoords::get(gfxEntity->bndBox).center();
+    for (GraphicsEntity::Object& object : gfxEntity->vecObject)
+        object.explodingVector = 2 * gp_Vec(entityCenter, BndBoxCoords::get(object.bndBox).center());
+}
+
+GraphicsObjectPtr GuiDocument::findGraphicsObject(TreeNodeId nodeId) const
+{
+    return nodeId < m_vecTreeNodeGfxObject.size() ? m_vecTreeNodeGfxObject.at(nodeId) : GraphicsObjectPtr();
+}
+
 const GuiDocument::GraphicsEntity* GuiDocument::findGraphicsEntity(TreeNodeId entityTreeNodeId) const
 {
     auto itFound = std::find_if(
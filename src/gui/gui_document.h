@@ -7,18 +7,28 @@
 #pragma once
 
 #include "../base/document.h"
+#include "../base/span.h"
 #include "../base/tkernel_utils.h"
+#include "../graphics/graphics_merged_shapes_object.h"
 #include "../graphics/graphics_object_driver.h"
+#include "../graphics/graphics_occlusion_map.h"
 #include "../graphics/graphics_scene.h"
 
 #include <QtCore/QObject>
+#include <AIS_Shape.hxx>
 #include <Bnd_Box.hxx>
+#include <Graphic3d_ClipPlane.hxx>
+#include <Graphic3d_RenderTransparentMethod.hxx>
 #include <V3d_View.hxx>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
+class QTimer;
+
 namespace Mayo {
 
 class ApplicationItem;
@@ -36,6 +46,14 @@ public:
     GuiApplication* guiApplication() const { return m_guiApp; }
 
     const Handle_V3d_View& v3dView() const { return m_v3dView; }
+
+    // -- Secondary views
+    // Additional views of the graphics scene, presentations and GPU resources are shared with
+    // v3dView(). Each view has its own camera and clip planes, camera is initialized from v3dView()
+    Handle_V3d_View createSecondaryView();
+    void destroySecondaryView(const Handle_V3d_View& view);
+    Span<const Handle_V3d_View> secondaryViews() const { return m_vecSecondaryView; }
+
     GraphicsScene* graphicsScene() { return &m_gfxScene; }
     const Bnd_Box& graphicsBoundingBox() const { return m_gfxBoundingBox; }
 
@@ -48,6 +66,8 @@ public:
 
     // Toggles selected status of an application item(doesn't affect Application's selection model)
     void toggleItemSelected(const ApplicationItem& appItem);
+    // Same as toggleItemSelected() for many items, graphics selection is updated in one batch
+    void toggleItemsSelected(Span<const ApplicationItem> spanAppItem);
 
     // Executes action associated to a 3D sensistive item
     bool processAction(const GraphicsOwnerPtr& graphicsOwner);
@@ -59,6 +79,9 @@ public:
     // -- Visible state of document's tree nodes
     Qt::CheckState nodeVisibleState(TreeNodeId nodeId) const;
     void setNodeVisible(TreeNodeId nodeId, bool on);
+    // Same as setNodeVisible() for many nodes, parent check states are then computed in one pass
+    // and signal nodesVisibilityChanged() is emitted once
+    void setNodesVisible(Span<const TreeNodeId> spanNodeId, bool on);
 
     // -- Exploding
     double explodingFactor() const { return m_explodingFactor; }
@@ -74,6 +97,77 @@ public:
     void runViewCameraAnimation(const std::function<void(Handle_V3d_View)>& fnViewChange);
     void stopViewCameraAnimation();
 
+    // -- Deferred presentations
+    // Computes right away the presentations still pending, eg before an offscreen rendering
+    void completePendingPresentations();
+
+    // -- Level of detail
+    // Updates the graphics objects whose presentation depends on view camera(ex: point clouds)
+    // Should be called once camera of the view changed
+    void updateViewLevelOfDetail();
+
+    // -- Culling
+    // Frustum culling skips the objects located outside of the view volume
+    bool isFrustumCullingOn() const;
+    void setFrustumCullingOn(bool on);
+    // Size culling skips the objects whose projected size is less than a threshold(in pixels)
+    // Culling is disabled if threshold is 0
+    double sizeCullingThreshold() const { return m_sizeCullingThreshold; }
+    void setSizeCullingThreshold(double pixels);
+    // Size culling threshold applied only while a dynamic view action is running(ex: rotation),
+    // so navigation stays fluid on big models. Full detail is back once the action is over
+    double dynamicSizeCullingThreshold() const { return m_dynamicSizeCullingThreshold; }
+    void setDynamicSizeCullingThreshold(double pixels);
+    void startViewDynamicAction();
+    void stopViewDynamicAction();
+
+    // -- Adaptive rendering
+    // While a dynamic view action is running, rendering quality is lowered: no MSAA, no hidden
+    // line removal and no capping of clip planes. Full quality is restored once action is over
+    bool isAdaptiveRenderingOn() const { return m_isAdaptiveRenderingOn; }
+    void setAdaptiveRenderingOn(bool on);
+
+    // -- Occlusion culling
+    // Objects entirely hidden behind others(eg interior parts of engines and cabinets) are not drawn
+    // in the main view. Temporal coherence: depth buffer of the objects drawn in the last frame is
+    // read back(see GraphicsOcclusionMap), then bounding boxes of all the visible objects are tested
+    // against it. Occluded objects are skipped by the view, the others are drawn again
+    // Culling is updated once the camera or the scene changed, and periodically while a dynamic view
+    // action is running, so objects uncovered by the action might show up with a short delay
+    bool isOcclusionCullingOn() const { return m_isOcclusionCullingOn; }
+    void setOcclusionCullingOn(bool on);
+
+    // -- Transparency
+    // Weighted blended order-independent transparency(Graphic3d_RTM_BLEND_OIT) avoids the depth
+    // sorting of transparent objects, so it scales to many translucent parts. Depth peeling(OCC >=
+    // v7.5.0) is more accurate but costlier, it's replaced by blended OIT with adaptive rendering
+    // Applies to all the views of the document
+    Graphic3d_RenderTransparentMethod transparencyMethod() const { return m_transparencyMethod; }
+    void setTransparencyMethod(Graphic3d_RenderTransparentMethod method);
+
+    // -- Color overrides
+    // Displays the instances of tree nodes with a uniform color whatever their XCAF colors, eg to
+    // show the results of a comparison. Instances of the same prototype overridden with the same
+    // color share a single presentation
+    void setNodesColorOverride(Span<const TreeNodeId> spanNodeId, const Quantity_Color& color);
+    void clearNodesColorOverride();
+
+    // -- Static batching
+    // Visible instances of small meshed parts sharing the same color and material are merged by
+    // cell of a regular grid over the document, each cell being a single GraphicsMergedShapesObject
+    // drawn with one draw call. Instances merged are hidden, picking a merged part selects its node
+    // A part is split back out(its own instance is displayed again) once selected, shown/hidden,
+    // colored or exploded. Batches are built again after changes of the model or display mode
+    // Only applies to shaded display mode
+    bool isStaticBatchingOn() const { return m_isStaticBatchingOn; }
+    void setStaticBatchingOn(bool on);
+
+    // -- Presentation memory
+    // Estimated GPU memory held by the presentations of the document products currently computed
+    // Presentations might be released to fit GuiApplication::presentationMemoryBudget(), usage is
+    // tracked only while such budget is set
+    uint64_t presentationMemoryUsage() const;
+
     // -- View trihedron
     enum class ViewTrihedronMode {
         None,
@@ -98,36 +192,136 @@ signals:
 
     // -- Implementation
 private:
+    friend class GuiApplication;
     void onDocumentEntityAdded(TreeNodeId entityTreeNodeId);
     void onDocumentEntityAboutToBeDestroyed(TreeNodeId entityTreeNodeId);
+    void onDocumentDeferredShapesLoaded(TreeNodeId nodeId);
+    void onDocumentDeferredScalingsApplied();
+    void onDocumentShapesUnloaded(TreeNodeId entityTreeNodeId);
     void onGraphicsSelectionChanged();
 
     void mapEntity(TreeNodeId entityTreeNodeId);
     void unmapEntity(TreeNodeId entityTreeNodeId);
 
+    // Lazy tessellation: graphics products whose BRep shape is not meshed yet are displayed only
+    // once the background mesh task is completed
+    struct LazyMeshProduct;
+    bool isLazyMeshPending(const GraphicsObjectPtr& object) const;
+    void requestLazyMeshes();
+    void onLazyMeshTaskEnded(TaskId taskId);
+    // Progressive display: once displayed with the coarse tessellation of lazy meshing, products
+    // are refined in background and their presentations recomputed with the final triangulations
+    void requestMeshRefinement(const LazyMeshProduct& lazyProduct);
+    void onMeshRefinementTaskEnded(TaskId taskId);
+
+    // Deferred presentations: shape objects are first displayed with a bounding box placeholder,
+    // actual presentations are then computed by batches fitting in a frame time budget, so the
+    // event loop keeps running between batches
+    bool isPresentationPending(const GraphicsObjectPtr& object) const;
+    void processPendingPresentations();
+
+    // Static batching
+    void scheduleStaticBatchesUpdate();
+    void updateStaticBatches();
+    void clearStaticBatches();
+    void splitStaticBatchParts(Span<const TreeNodeId> spanNodeId);
+    TreeNodeId nodeFromStaticBatchOwner(const Handle_GraphicsMergedShapesOwner& owner) const;
+
+    // Presentation memory budget: a product(object holding a shared presentation) is evicted by
+    // switching its objects to the bounding box placeholder and releasing its presentations. It's
+    // restored through the deferred presentations queue once one of its objects is visible in a
+    // view. Triangulations are kept by the shapes, so restoring doesn't mesh again
+    struct EvictablePresentation {
+        GraphicsObjectPtr product;
+        uint64_t bytes = 0;
+        uint64_t lastUseTick = 0;
+    };
+    void updatePresentationResidency();
+    std::vector<EvictablePresentation> evictablePresentations() const;
+    void evictPresentation(const GraphicsObjectPtr& product);
+
+    // Shape paging: shapes of the entities completely hidden for a while are paged out, see
+    // GuiApplication::isShapePagingOn(). Products of the prototypes released drop their presentations
+    // and sensitive entities, bounding boxes of the entity are kept as is
+    // Shapes are restored with Document::loadDeferredShapes() once the entity is shown again
+    void scheduleShapePaging();
+    void pageOutHiddenEntities();
+
     struct GraphicsEntity {
         struct Object {
             Object(const GraphicsObjectPtr& p) : ptr(p) {}
             GraphicsObjectPtr ptr;
             gp_Trsf trsfOriginal;
             Bnd_Box bndBox;
+            gp_Vec explodingVector; // Translation of the object when exploding factor is 1
         };
 
         TreeNodeId treeNodeId;
         std::vector<Object> vecObject;
-        std::unordered_map<TreeNodeId, GraphicsObjectPtr> mapTreeNodeGfxObject;
-        std::unordered_map<GraphicsObjectPtr, TreeNodeId> mapGfxObjectTreeNode;
+        std::vector<TDF_Label> vecProductLabel; // Labels of the shared products instantiated
         Bnd_Box bndBox;
     };
 
+    struct LazyMeshProduct {
+        struct Object {
+            GraphicsObjectPtr ptr;
+            TreeNodeId treeNodeId;
+            Bnd_Box bndBox;
+        };
+
+        TDF_Label label;
+        TaskId taskId = 0;
+        std::vector<Object> vecObject; // Product itself and/or its instances
+    };
+
+    // Graphics object holding the presentation of a prototype shape, which is shared by all the
+    // instances of that prototype across the document entities(see AIS_ConnectedInteractive)
+    struct GraphicsProduct {
+        GraphicsObjectPtr ptr;
+        int entityCount = 0; // Count of entities having instances of the product
+    };
+
+    struct StaticBatch {
+        Handle_GraphicsMergedShapesObject ptr; // Null once all the parts are split out
+        std::vector<TreeNodeId> vecPartTreeNodeId; // Instance node of each part
+    };
+
+    struct StaticBatchPart {
+        int batchIndex;
+        int partIndex;
+    };
+
+    struct PresentationResidency {
+        std::vector<GraphicsObjectPtr> vecObject; // Product itself and/or its instances
+        uint64_t bytes = 0;
+        uint64_t lastUseTick = 0;
+        bool isInUse = false; // Some object is visible in a view, or can't be evicted
+        bool isEvicted = false;
+    };
+
+    // Bounding box of a mapped graphics object, taken from Document::bndBoxCache() for XCAF shapes
+    Bnd_Box graphicsObjectBoundingBox(const GraphicsEntity::Object& object) const;
+
+    // Computes exploding vectors of the objects, to be called once the bounding boxes changed
+    static void updateExplodingVectors(GraphicsEntity* gfxEntity);
+
     const GraphicsEntity* findGraphicsEntity(TreeNodeId entityTreeNodeId) const;
+    GraphicsObjectPtr findGraphicsObject(TreeNodeId nodeId) const;
 
     void v3dViewTrihedronDisplay(Qt::Corner corner);
+    void applySizeCulling();
+    void scheduleOcclusionCullingUpdate();
+    void updateOcclusionCulling();
+    void clearOcclusionCulling();
+    static bool isCostlyTransparency(Graphic3d_RenderTransparentMethod method);
+    void lowerViewQuality();
+    void restoreViewQuality();
 
     GuiApplication* m_guiApp = nullptr;
     DocumentPtr m_document;
     GraphicsScene m_gfxScene;
     Handle_V3d_View m_v3dView;
+    std::vector<Handle_V3d_View> m_vecSecondaryView;
     Handle_AIS_InteractiveObject m_aisOriginTrihedron;
 
     V3dViewCameraAnimation* m_cameraAnimation;
@@ -137,11 +331,52 @@ private:
 
     std::vector<GraphicsEntity> m_vecGraphicsEntity;
     Bnd_Box m_gfxBoundingBox;
+    // Index of the graphics objects for all entities: tree node ids are dense, so objects are
+    // directly stored at [nodeId] and reverse mapping is a single lookup whatever the entity count
+    std::vector<GraphicsObjectPtr> m_vecTreeNodeGfxObject;
+    std::unordered_map<GraphicsObjectPtr, TreeNodeId> m_mapGfxObjectTreeNode;
 
     std::unordered_map<GraphicsObjectDriverPtr, int> m_mapGfxDriverDisplayMode;
     std::unordered_map<TreeNodeId, Qt::CheckState> m_mapTreeNodeCheckState;
+    std::unordered_map<TDF_Label, GraphicsProduct> m_mapLabelGfxProduct;
+    std::unordered_map<GraphicsObjectPtr, LazyMeshProduct> m_mapLazyMeshProduct;
+    std::unordered_map<TaskId, GraphicsObjectPtr> m_mapTaskLazyMeshProduct;
+    std::unordered_map<TaskId, LazyMeshProduct> m_mapTaskRefineMeshProduct;
+    // Objects whose color is overridden, mapped to the product they were connected to(null if the
+    // object is not an instance)
+    std::unordered_map<GraphicsObjectPtr, GraphicsObjectPtr> m_mapColorOverrideObject;
+    std::unordered_map<TDF_Label, std::vector<Handle_AIS_Shape>> m_mapLabelColoredProduct;
+    std::deque<GraphicsObjectPtr> m_queuePendingPrsObject;
+    std::unordered_set<GraphicsObjectPtr> m_setPendingPrsObject;
+    QTimer* m_timerPendingPrs = nullptr;
+    std::vector<StaticBatch> m_vecStaticBatch;
+    std::unordered_map<TreeNodeId, StaticBatchPart> m_mapNodeStaticBatchPart; // Parts merged
+    QTimer* m_timerStaticBatches = nullptr;
+    std::unordered_map<GraphicsObjectPtr, PresentationResidency> m_mapProductResidency;
+    GraphicsOcclusionMap m_occlusionMap;
+    std::unordered_set<GraphicsObjectPtr> m_setOccludedObject; // Objects skipped by the main view
+    QTimer* m_timerOcclusionCulling = nullptr;
+    QTimer* m_timerShapePaging = nullptr;
 
     double m_explodingFactor = 0.;
+    double m_sizeCullingThreshold = 0.;
+    double m_dynamicSizeCullingThreshold = 0.;
+    bool m_isViewDynamicActionRunning = false;
+    bool m_isTogglingItemsSelected = false; // Graphics selection follows the application one
+    bool m_isAdaptiveRenderingOn = false;
+    bool m_isStaticBatchingOn = false;
+    bool m_isOcclusionCullingOn = false;
+    Graphic3d_RenderTransparentMethod m_transparencyMethod = Graphic3d_RTM_BLEND_UNORDERED;
+
+    // View rendering state saved when a dynamic action starts, in case of adaptive rendering
+    struct ViewQuality {
+        bool isLowered = false;
+        int msaaSampleCount = 0;
+        bool isComputedModeOn = false;
+        bool isTransparencyLowered = false;
+        std::vector<Handle_Graphic3d_ClipPlane> vecCappedPlane;
+    };
+    ViewQuality m_viewFullQuality;
 };
 
 } // namespace Mayo
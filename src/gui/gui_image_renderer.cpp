@@ -0,0 +1,86 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "gui_image_renderer.h"
+
+#include "../graphics/graphics_utils.h"
+#include "gui_document.h"
+#include "qtgui_utils.h"
+
+#include <gsl/util>
+#include <Aspect_GradientBackground.hxx>
+#include <Image_PixMap.hxx>
+
+namespace Mayo {
+
+namespace Internal {
+
+// Defined in gui_create_gfx_driver.cpp
+Handle_Aspect_Window createOffscreenWindow(int width, int height);
+
+} // namespace Internal
+
+QImage GuiImageRenderer::render(GuiDocument* guiDoc, V3d_TypeOfOrientation projection) const
+{
+    if (!guiDoc || m_params.size.isEmpty())
+        return {};
+
+    GraphicsScene* gfxScene = guiDoc->graphicsScene();
+    const GuiDocument::ViewTrihedronMode onEntryTrihedronMode = guiDoc->viewTrihedronMode();
+    const bool onEntryOriginTrihedronVisible = guiDoc->isOriginTrihedronVisible();
+    Handle_V3d_View view = gfxScene->createV3dView();
+    auto _ = gsl::finally([=]{
+        view->Remove();
+        guiDoc->setViewTrihedronMode(onEntryTrihedronMode);
+        if (guiDoc->isOriginTrihedronVisible() != onEntryOriginTrihedronVisible)
+            guiDoc->toggleOriginTrihedronVisibility();
+    });
+
+    guiDoc->completePendingPresentations();
+    gfxScene->clearSelection();
+    if (!m_params.decorationsOn) {
+        guiDoc->setViewTrihedronMode(GuiDocument::ViewTrihedronMode::None);
+        if (guiDoc->isOriginTrihedronVisible())
+            guiDoc->toggleOriginTrihedronVisibility();
+    }
+
+    view->ChangeRenderingParams() = guiDoc->v3dView()->RenderingParams();
+    view->ChangeRenderingParams().IsAntialiasingEnabled = m_params.antialiasingOn;
+    view->ChangeRenderingParams().NbMsaaSamples = m_params.antialiasingOn ? 4 : 0;
+    if (m_params.backgroundColor.isValid()) {
+        view->SetBackgroundColor(QtGuiUtils::toPreferredColorSpace(m_params.backgroundColor));
+    }
+    else {
+        const Aspect_GradientBackground bkgGradient = guiDoc->v3dView()->GradientBackground();
+        Quantity_Color bkgColor1, bkgColor2;
+        bkgGradient.Colors(bkgColor1, bkgColor2);
+        view->SetBgGradientColors(bkgColor1, bkgColor2, bkgGradient.BgGradientFillMethod());
+    }
+
+    const int width = m_params.size.width();
+    const int height = m_params.size.height();
+    view->SetWindow(Internal::createOffscreenWindow(width, height));
+    view->SetProj(projection);
+    GraphicsUtils::V3dView_fitAll(view);
+
+    Image_PixMap pixmap;
+    pixmap.SetTopDown(true);
+    V3d_ImageDumpOptions dumpOptions;
+    dumpOptions.BufferType = Graphic3d_BT_RGB;
+    dumpOptions.Width = width;
+    dumpOptions.Height = height;
+    if (!view->ToPixMap(pixmap, dumpOptions))
+        return {};
+
+    const QImage img(pixmap.Data(),
+                     int(pixmap.Width()),
+                     int(pixmap.Height()),
+                     int(pixmap.SizeRowBytes()),
+                     QImage::Format_RGB888);
+    return img.copy(); // Deep copy as 'pixmap' data is released on return
+}
+
+} // namespace Mayo
@@ -0,0 +1,46 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include <QtCore/QSize>
+#include <QtGui/QColor>
+#include <QtGui/QImage>
+#include <V3d_TypeOfOrientation.hxx>
+
+namespace Mayo {
+
+class GuiDocument;
+
+// Renders the graphics of a GuiDocument into an image, without any widget nor visible window
+// Views are created on the fly in a virtual native window, they belong to the graphics driver shared
+// by all documents so OpenGL resources are reused from one rendering to another
+// Rendering must happen in the GUI thread, but resulting images can then be processed(eg saved to
+// files) concurrently
+class GuiImageRenderer {
+public:
+    struct Parameters {
+        QSize size = { 512, 512 };
+        QColor backgroundColor; // Background gradient of the document view is used if invalid
+        bool antialiasingOn = true;
+        bool decorationsOn = false; // Trihedrons, ...
+    };
+
+    GuiImageRenderer() = default;
+    GuiImageRenderer(const Parameters& params) : m_params(params) {}
+
+    const Parameters& parameters() const { return m_params; }
+    void setParameters(const Parameters& params) { m_params = params; }
+
+    // Renders graphics of 'guiDoc' viewed with 'projection' and camera fitted to the whole scene
+    // Returns a null image on failure
+    QImage render(GuiDocument* guiDoc, V3d_TypeOfOrientation projection) const;
+
+private:
+    Parameters m_params;
+};
+
+} // namespace Mayo
@@ -0,0 +1,110 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "gui_render_benchmark.h"
+
+#include "../base/document.h"
+#include "../graphics/graphics_object_driver.h"
+#include "../graphics/graphics_utils.h"
+#include "../graphics/v3d_view_camera_animation.h"
+#include "gui_document.h"
+
+#include <QtCore/QElapsedTimer>
+#include <gsl/util>
+#include <algorithm>
+
+namespace Mayo {
+
+namespace Internal {
+
+// Defined in gui_create_gfx_driver.cpp
+Handle_Aspect_Window createOffscreenWindow(int width, int height);
+
+} // namespace Internal
+
+namespace {
+
+double elapsedMsecs(const QElapsedTimer& chrono)
+{
+    return chrono.nsecsElapsed() / 1e6;
+}
+
+} // namespace
+
+GuiRenderBenchmark::Result GuiRenderBenchmark::run(GuiDocument* guiDoc) const
+{
+    Result result;
+    if (!guiDoc || m_params.size.isEmpty())
+        return result;
+
+    QElapsedTimer chrono;
+    chrono.start();
+    guiDoc->completePendingPresentations();
+    result.presentationMsecs = elapsedMsecs(chrono);
+
+    const DocumentPtr& doc = guiDoc->document();
+    for (int i = 0; i < doc->entityCount(); ++i) {
+        guiDoc->foreachGraphicsObject(doc->entityTreeNodeId(i), [&](GraphicsObjectPtr gfxObject) {
+            const GraphicsObjectDriverPtr driver = GraphicsObjectDriver::get(gfxObject);
+            if (dynamic_cast<const GraphicsShapeObjectDriver*>(driver.get()))
+                ++result.shapeObjectCount;
+            else if (dynamic_cast<const GraphicsMeshObjectDriver*>(driver.get()))
+                ++result.meshObjectCount;
+            else
+                ++result.otherObjectCount;
+        });
+    }
+
+    GraphicsScene* gfxScene = guiDoc->graphicsScene();
+    Handle_V3d_View view = gfxScene->createV3dView();
+    auto _ = gsl::finally([=]{ view->Remove(); });
+    view->ChangeRenderingParams() = guiDoc->v3dView()->RenderingParams();
+    const int width = m_params.size.width();
+    const int height = m_params.size.height();
+    view->SetWindow(Internal::createOffscreenWindow(width, height));
+    view->SetProj(V3d_XposYnegZpos);
+    GraphicsUtils::V3dView_fitAll(view);
+
+    // First frame also includes upload of GPU buffers
+    chrono.restart();
+    view->Redraw();
+    result.firstFrameMsecs = elapsedMsecs(chrono);
+
+    // Full turn around the vertical axis of the view, split into quarter turns as camera
+    // interpolation can't handle a single 360 degrees rotation
+    const int orbitFrameCount = std::max(4, m_params.orbitFrameCount);
+    const int quarterFrameCount = orbitFrameCount / 4;
+    V3dViewCameraAnimation cameraAnimation(view);
+    cameraAnimation.setDuration(quarterFrameCount);
+    chrono.restart();
+    for (int iQuarter = 0; iQuarter < 4; ++iQuarter) {
+        cameraAnimation.configure([](Handle_V3d_View view) { view->Rotate(0, M_PI / 2., 0); });
+        for (int iFrame = 1; iFrame <= quarterFrameCount; ++iFrame) {
+            cameraAnimation.setCurrentTime(iFrame); // Redraws the view
+            ++result.frameCount;
+        }
+    }
+
+    result.averageFrameMsecs = result.frameCount > 0 ? elapsedMsecs(chrono) / result.frameCount : 0.;
+
+    // Picking at the points of a regular grid, cells are centered
+    const int pickGridSize = std::max(1, m_params.pickGridSize);
+    chrono.restart();
+    for (int i = 0; i < pickGridSize; ++i) {
+        for (int j = 0; j < pickGridSize; ++j) {
+            const QPoint pos(((2 * i + 1) * width) / (2 * pickGridSize),
+                             ((2 * j + 1) * height) / (2 * pickGridSize));
+            gfxScene->highlightAt(pos, view);
+            ++result.pickCount;
+        }
+    }
+
+    result.averagePickMsecs = elapsedMsecs(chrono) / result.pickCount;
+    gfxScene->clearSelection();
+    return result;
+}
+
+} // namespace Mayo
@@ -0,0 +1,52 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include <QtCore/QSize>
+
+namespace Mayo {
+
+class GuiDocument;
+
+// Measures rendering performance of the graphics of a GuiDocument, in a view created on the fly in
+// a virtual native window(same as GuiImageRenderer)
+// Timings are CPU side: frame times include scene traversal and OpenGL command submission, but GPU
+// work might still be pending when a frame is considered finished
+// Must be called in the GUI thread
+class GuiRenderBenchmark {
+public:
+    struct Parameters {
+        QSize size = { 1280, 720 };
+        int orbitFrameCount = 120; // Frames rendered during the camera orbit(full turn)
+        int pickGridSize = 10; // Picking is done at the points of a NxN grid covering the view
+    };
+
+    struct Result {
+        double presentationMsecs = 0; // Time to compute pending presentations
+        double firstFrameMsecs = 0;
+        double averageFrameMsecs = 0; // During camera orbit
+        double averagePickMsecs = 0; // GraphicsScene::highlightAt()
+        int frameCount = 0;
+        int pickCount = 0;
+        int shapeObjectCount = 0; // Graphics objects created by GraphicsShapeObjectDriver
+        int meshObjectCount = 0; // Graphics objects created by GraphicsMeshObjectDriver
+        int otherObjectCount = 0;
+    };
+
+    GuiRenderBenchmark() = default;
+    GuiRenderBenchmark(const Parameters& params) : m_params(params) {}
+
+    const Parameters& parameters() const { return m_params; }
+    void setParameters(const Parameters& params) { m_params = params; }
+
+    Result run(GuiDocument* guiDoc) const;
+
+private:
+    Parameters m_params;
+};
+
+} // namespace Mayo
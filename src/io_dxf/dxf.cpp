@@ -9,8 +9,11 @@
 #define _USE_MATH_DEFINES
 #include <cmath>
 
+#include <charconv>
 #include <iomanip>
+#include <limits>
 #include <filesystem>
+#include <fast_float/fast_float.h>
 
 #include "dxf.h"
 
@@ -23,6 +26,77 @@ void safe_strcpy(char (&dst)[N1], const char (&src)[N2]) {
     strncpy(dst, src, std::min(N1, N2));
 }
 
+// Binary DXF files start with "AutoCAD Binary DXF<CR><LF><SUB><NUL>"
+const char binary_dxf_sentinel[] = "AutoCAD Binary DXF\r\n\x1a"; // sizeof() includes <NUL>
+
+enum class BinaryGroupType { String, BinaryChunk, Bool, Int16, Int32, Int64, Double };
+
+// See "Group Code Value Types" in DXF reference
+BinaryGroupType binary_group_type(int code)
+{
+    if (10 <= code && code <= 59) return BinaryGroupType::Double;
+    if (60 <= code && code <= 79) return BinaryGroupType::Int16;
+    if (90 <= code && code <= 99) return BinaryGroupType::Int32;
+    if (110 <= code && code <= 149) return BinaryGroupType::Double;
+    if (160 <= code && code <= 169) return BinaryGroupType::Int64;
+    if (170 <= code && code <= 179) return BinaryGroupType::Int16;
+    if (210 <= code && code <= 239) return BinaryGroupType::Double;
+    if (270 <= code && code <= 289) return BinaryGroupType::Int16;
+    if (290 <= code && code <= 299) return BinaryGroupType::Bool;
+    if (310 <= code && code <= 319) return BinaryGroupType::BinaryChunk;
+    if (370 <= code && code <= 389) return BinaryGroupType::Int16;
+    if (400 <= code && code <= 409) return BinaryGroupType::Int16;
+    if (420 <= code && code <= 429) return BinaryGroupType::Int32;
+    if (440 <= code && code <= 459) return BinaryGroupType::Int32;
+    if (460 <= code && code <= 469) return BinaryGroupType::Double;
+    if (code == 1004) return BinaryGroupType::BinaryChunk;
+    if (1010 <= code && code <= 1059) return BinaryGroupType::Double;
+    if (1060 <= code && code <= 1070) return BinaryGroupType::Int16;
+    if (code == 1071) return BinaryGroupType::Int32;
+
+    return BinaryGroupType::String;
+}
+
+// Decodes little-endian value, whatever the host byte order
+template<typename T>
+T binary_value(const char* ptr)
+{
+    using Bits = std::conditional_t<sizeof(T) == 8, uint64_t, std::conditional_t<sizeof(T) == 4, uint32_t, uint16_t>>;
+    static_assert(sizeof(T) == sizeof(Bits));
+    Bits bits = 0;
+    for (size_t i = 0; i < sizeof(T); ++i)
+        bits |= Bits(uint8_t(ptr[i])) << (8 * i);
+
+    T value;
+    memcpy(&value, &bits, sizeof(T));
+    return value;
+}
+
+// Minimal R12 boiler plate contents, used when the plate files aren't found in the data directory
+// Layer table written by CDxfWrite refers to line type "CONTINUOUS", so it has to be defined
+const char* builtin_plate_file(const std::string& fileName)
+{
+    if (fileName == "header12.rub") {
+        return "  0\nSECTION\n  2\nHEADER\n"
+               "  9\n$ACADVER\n  1\nAC1009\n"
+               "  9\n$HANDLING\n 70\n     1\n"
+               "  9\n$HANDSEED\n  5\nFFFFFFF\n"
+               "  0\nENDSEC\n";
+    }
+
+    if (fileName == "tables112.rub") {
+        return "  0\nSECTION\n  2\nTABLES\n"
+               "  0\nTABLE\n  2\nLTYPE\n 70\n     1\n"
+               "  0\nLTYPE\n  2\nCONTINUOUS\n 70\n     0\n  3\nSolid line\n 72\n    65\n 73\n     0\n 40\n0.0\n"
+               "  0\nENDTAB\n";
+    }
+
+    if (fileName == "entities12.rub")
+        return "  0\nSECTION\n  2\nENTITIES\n";
+
+    return ""; // "tables212.rub" and "blocks112.rub" have no content
+}
+
 } // namespace
 
 Base::Vector3d toVector3d(const double* a)
@@ -52,17 +126,26 @@ m_layerName("none")
     // start the file
     m_fail = false;
     m_version = 12;
-    m_ofs = new std::ofstream(filepath, ios::out);
+    // MAYO: output is buffered by large chunks, buffer has to be installed before opening
+    m_ofs_buffer.resize(1024 * 1024);
+    m_ofs = new std::ofstream;
+    m_ofs->rdbuf()->pubsetbuf(m_ofs_buffer.data(), m_ofs_buffer.size());
+    m_ofs->open(filepath, ios::out);
     m_ssBlock     = new std::ostringstream();
     m_ssBlkRecord = new std::ostringstream();
     m_ssEntity    = new std::ostringstream();
     m_ssLayer     = new std::ostringstream();
 
+    // MAYO: coordinates are written with full precision(default is 6 significant digits)
+    for (std::ostream* os : std::initializer_list<std::ostream*>{ m_ofs, m_ssBlock, m_ssBlkRecord, m_ssEntity, m_ssLayer }) {
+        os->imbue(std::locale::classic());
+        os->precision(std::numeric_limits<double>::digits10);
+    }
+
     if(!(*m_ofs)){
         m_fail = true;
         return;
     }
-    m_ofs->imbue(std::locale("C"));
 }
 
 CDxfWrite::~CDxfWrite()
@@ -93,8 +176,11 @@ void CDxfWrite::endRun(void)
     writeEntitiesSection();
     writeObjectsSection();
 
-    (*m_ofs) << "  0"         << endl;
+    (*m_ofs) << "  0"         << '\n';
     (*m_ofs) << "EOF";
+    m_ofs->flush();
+    if (!(*m_ofs))
+        m_fail = true;
 }
 
 //***************************
@@ -113,8 +199,8 @@ void CDxfWrite::writeHeaderSection(void)
 #endif
 
     //header & version
-    (*m_ofs) << "999"      << endl;
-    (*m_ofs) << ss.str()   << endl;
+    (*m_ofs) << "999"      << '\n';
+    (*m_ofs) << ss.str()   << '\n';
 
     //static header content
     ss.str("");
@@ -162,11 +248,11 @@ void CDxfWrite::writeTablesSection(void)
 
     if (m_version > 12) {
         (*m_ofs) << (*m_ssBlkRecord).str();
-        (*m_ofs) << "  0"      << endl;
-        (*m_ofs) << "ENDTAB"   << endl;
+        (*m_ofs) << "  0"      << '\n';
+        (*m_ofs) << "ENDTAB"   << '\n';
     }
-    (*m_ofs) << "  0"      << endl;
-    (*m_ofs) << "ENDSEC"   << endl;
+    (*m_ofs) << "  0"      << '\n';
+    (*m_ofs) << "ENDSEC"   << '\n';
 }
 
 //***************************
@@ -175,66 +261,66 @@ void CDxfWrite::writeTablesSection(void)
 void CDxfWrite::makeLayerTable(void)
 {
     std::string tablehash = getLayerHandle();
-    (*m_ssLayer) << "  0"      << endl;
-    (*m_ssLayer) << "TABLE"    << endl;
-    (*m_ssLayer) << "  2"      << endl;
-    (*m_ssLayer) << "LAYER"    << endl;
-    (*m_ssLayer) << "  5"      << endl;
-    (*m_ssLayer) << tablehash  << endl;
+    (*m_ssLayer) << "  0"      << '\n';
+    (*m_ssLayer) << "TABLE"    << '\n';
+    (*m_ssLayer) << "  2"      << '\n';
+    (*m_ssLayer) << "LAYER"    << '\n';
+    (*m_ssLayer) << "  5"      << '\n';
+    (*m_ssLayer) << tablehash  << '\n';
     if (m_version > 12) {
-        (*m_ssLayer) << "330"      << endl;
-        (*m_ssLayer) << 0          << endl;
-        (*m_ssLayer) << "100"      << endl;
-        (*m_ssLayer) << "AcDbSymbolTable"   << endl;
-    }
-    (*m_ssLayer) << " 70"      << endl;
-    (*m_ssLayer) << m_layerList.size() + 1 << endl;
-
-    (*m_ssLayer) << "  0"      << endl;
-    (*m_ssLayer) << "LAYER"    << endl;
-    (*m_ssLayer) << "  5"      << endl;
-    (*m_ssLayer) << getLayerHandle()  << endl;
+        (*m_ssLayer) << "330"      << '\n';
+        (*m_ssLayer) << 0          << '\n';
+        (*m_ssLayer) << "100"      << '\n';
+        (*m_ssLayer) << "AcDbSymbolTable"   << '\n';
+    }
+    (*m_ssLayer) << " 70"      << '\n';
+    (*m_ssLayer) << m_layerList.size() + 1 << '\n';
+
+    (*m_ssLayer) << "  0"      << '\n';
+    (*m_ssLayer) << "LAYER"    << '\n';
+    (*m_ssLayer) << "  5"      << '\n';
+    (*m_ssLayer) << getLayerHandle()  << '\n';
     if (m_version > 12) {
-        (*m_ssLayer) << "330"      << endl;
-        (*m_ssLayer) << tablehash  << endl;
-        (*m_ssLayer) << "100"      << endl;
-        (*m_ssLayer) << "AcDbSymbolTableRecord"      << endl;
-        (*m_ssLayer) << "100"      << endl;
-        (*m_ssLayer) << "AcDbLayerTableRecord"      << endl;
-    }
-    (*m_ssLayer) << "  2"      << endl;
-    (*m_ssLayer) << "0"        << endl;
-    (*m_ssLayer) << " 70"      << endl;
-    (*m_ssLayer) << "   0"     << endl;
-    (*m_ssLayer) << " 62"      << endl;
-    (*m_ssLayer) << "   7"     << endl;
-    (*m_ssLayer) << "  6"      << endl;
-    (*m_ssLayer) << "CONTINUOUS" << endl;
+        (*m_ssLayer) << "330"      << '\n';
+        (*m_ssLayer) << tablehash  << '\n';
+        (*m_ssLayer) << "100"      << '\n';
+        (*m_ssLayer) << "AcDbSymbolTableRecord"      << '\n';
+        (*m_ssLayer) << "100"      << '\n';
+        (*m_ssLayer) << "AcDbLayerTableRecord"      << '\n';
+    }
+    (*m_ssLayer) << "  2"      << '\n';
+    (*m_ssLayer) << "0"        << '\n';
+    (*m_ssLayer) << " 70"      << '\n';
+    (*m_ssLayer) << "   0"     << '\n';
+    (*m_ssLayer) << " 62"      << '\n';
+    (*m_ssLayer) << "   7"     << '\n';
+    (*m_ssLayer) << "  6"      << '\n';
+    (*m_ssLayer) << "CONTINUOUS" << '\n';
 
     for (auto& l: m_layerList) {
-        (*m_ssLayer) << "  0"      << endl;
-        (*m_ssLayer) << "LAYER"      << endl;
-        (*m_ssLayer) << "  5"      << endl;
-        (*m_ssLayer) << getLayerHandle() << endl;
+        (*m_ssLayer) << "  0"      << '\n';
+        (*m_ssLayer) << "LAYER"      << '\n';
+        (*m_ssLayer) << "  5"      << '\n';
+        (*m_ssLayer) << getLayerHandle() << '\n';
         if (m_version > 12) {
-            (*m_ssLayer) << "330"      << endl;
-            (*m_ssLayer) << tablehash  << endl;
-            (*m_ssLayer) << "100"      << endl;
-            (*m_ssLayer) << "AcDbSymbolTableRecord"      << endl;
-            (*m_ssLayer) << "100"      << endl;
-            (*m_ssLayer) << "AcDbLayerTableRecord"      << endl;
+            (*m_ssLayer) << "330"      << '\n';
+            (*m_ssLayer) << tablehash  << '\n';
+            (*m_ssLayer) << "100"      << '\n';
+            (*m_ssLayer) << "AcDbSymbolTableRecord"      << '\n';
+            (*m_ssLayer) << "100"      << '\n';
+            (*m_ssLayer) << "AcDbLayerTableRecord"      << '\n';
         }
-        (*m_ssLayer) << "  2"      << endl;
-        (*m_ssLayer) << l << endl;
-        (*m_ssLayer) << " 70"      << endl;
-        (*m_ssLayer) << "    0"      << endl;
-        (*m_ssLayer) << " 62"      << endl;
-        (*m_ssLayer) << "    7"      << endl;
-        (*m_ssLayer) << "  6"      << endl;
-        (*m_ssLayer) << "CONTINUOUS"      << endl;
+        (*m_ssLayer) << "  2"      << '\n';
+        (*m_ssLayer) << l << '\n';
+        (*m_ssLayer) << " 70"      << '\n';
+        (*m_ssLayer) << "    0"      << '\n';
+        (*m_ssLayer) << " 62"      << '\n';
+        (*m_ssLayer) << "    7"      << '\n';
+        (*m_ssLayer) << "  6"      << '\n';
+        (*m_ssLayer) << "CONTINUOUS"      << '\n';
     }
-    (*m_ssLayer) << "  0"      << endl;
-    (*m_ssLayer) << "ENDTAB"   << endl;
+    (*m_ssLayer) << "  0"      << '\n';
+    (*m_ssLayer) << "ENDTAB"   << '\n';
 }
 
 //***************************
@@ -247,50 +333,50 @@ void CDxfWrite::makeBlockRecordTableHead(void)
     }
         std::string tablehash = getBlkRecordHandle();
         m_saveBlockRecordTableHandle = tablehash;
-        (*m_ssBlkRecord) << "  0"      << endl;
-        (*m_ssBlkRecord) << "TABLE"      << endl;
-        (*m_ssBlkRecord) << "  2"      << endl;
-        (*m_ssBlkRecord) << "BLOCK_RECORD"      << endl;
-        (*m_ssBlkRecord) << "  5"      << endl;
-        (*m_ssBlkRecord) << tablehash  << endl;
-        (*m_ssBlkRecord) << "330"      << endl;
-        (*m_ssBlkRecord) << "0"        << endl;
-        (*m_ssBlkRecord) << "100"      << endl;
-        (*m_ssBlkRecord) << "AcDbSymbolTable"      << endl;
-        (*m_ssBlkRecord) << "  70"      << endl;
-        (*m_ssBlkRecord) << (m_blockList.size() + 5)   << endl;
+        (*m_ssBlkRecord) << "  0"      << '\n';
+        (*m_ssBlkRecord) << "TABLE"      << '\n';
+        (*m_ssBlkRecord) << "  2"      << '\n';
+        (*m_ssBlkRecord) << "BLOCK_RECORD"      << '\n';
+        (*m_ssBlkRecord) << "  5"      << '\n';
+        (*m_ssBlkRecord) << tablehash  << '\n';
+        (*m_ssBlkRecord) << "330"      << '\n';
+        (*m_ssBlkRecord) << "0"        << '\n';
+        (*m_ssBlkRecord) << "100"      << '\n';
+        (*m_ssBlkRecord) << "AcDbSymbolTable"      << '\n';
+        (*m_ssBlkRecord) << "  70"      << '\n';
+        (*m_ssBlkRecord) << (m_blockList.size() + 5)   << '\n';
         
         m_saveModelSpaceHandle = getBlkRecordHandle();
-        (*m_ssBlkRecord) << "  0"      << endl;
-        (*m_ssBlkRecord) << "BLOCK_RECORD"      << endl;
-        (*m_ssBlkRecord) << "  5"      << endl;
-        (*m_ssBlkRecord) << m_saveModelSpaceHandle  << endl;
-        (*m_ssBlkRecord) << "330"      << endl;
-        (*m_ssBlkRecord) << tablehash  << endl;
-        (*m_ssBlkRecord) << "100"      << endl;
-        (*m_ssBlkRecord) << "AcDbSymbolTableRecord"      << endl;
-        (*m_ssBlkRecord) << "100"      << endl;
-        (*m_ssBlkRecord) << "AcDbBlockTableRecord"      << endl;
-        (*m_ssBlkRecord) << "  2"      << endl;
-        (*m_ssBlkRecord) << "*MODEL_SPACE"   << endl;
-//        (*m_ssBlkRecord) << "  1"      << endl;
-//        (*m_ssBlkRecord) << " "        << endl;
+        (*m_ssBlkRecord) << "  0"      << '\n';
+        (*m_ssBlkRecord) << "BLOCK_RECORD"      << '\n';
+        (*m_ssBlkRecord) << "  5"      << '\n';
+        (*m_ssBlkRecord) << m_saveModelSpaceHandle  << '\n';
+        (*m_ssBlkRecord) << "330"      << '\n';
+        (*m_ssBlkRecord) << tablehash  << '\n';
+        (*m_ssBlkRecord) << "100"      << '\n';
+        (*m_ssBlkRecord) << "AcDbSymbolTableRecord"      << '\n';
+        (*m_ssBlkRecord) << "100"      << '\n';
+        (*m_ssBlkRecord) << "AcDbBlockTableRecord"      << '\n';
+        (*m_ssBlkRecord) << "  2"      << '\n';
+        (*m_ssBlkRecord) << "*MODEL_SPACE"   << '\n';
+//        (*m_ssBlkRecord) << "  1"      << '\n';
+//        (*m_ssBlkRecord) << " "        << '\n';
 
         m_savePaperSpaceHandle = getBlkRecordHandle();
-        (*m_ssBlkRecord) << "  0"      << endl;
-        (*m_ssBlkRecord) << "BLOCK_RECORD"  << endl;
-        (*m_ssBlkRecord) << "  5"      << endl;
-        (*m_ssBlkRecord) << m_savePaperSpaceHandle  << endl;
-        (*m_ssBlkRecord) << "330"      << endl;
-        (*m_ssBlkRecord) << tablehash  << endl;
-        (*m_ssBlkRecord) << "100"      << endl;
-        (*m_ssBlkRecord) << "AcDbSymbolTableRecord"      << endl;
-        (*m_ssBlkRecord) << "100"      << endl;
-        (*m_ssBlkRecord) << "AcDbBlockTableRecord"      << endl;
-        (*m_ssBlkRecord) << "  2"      << endl;
-        (*m_ssBlkRecord) << "*PAPER_SPACE"   << endl;
-//        (*m_ssBlkRecord) << "  1"      << endl;
-//        (*m_ssBlkRecord) << " "        << endl;
+        (*m_ssBlkRecord) << "  0"      << '\n';
+        (*m_ssBlkRecord) << "BLOCK_RECORD"  << '\n';
+        (*m_ssBlkRecord) << "  5"      << '\n';
+        (*m_ssBlkRecord) << m_savePaperSpaceHandle  << '\n';
+        (*m_ssBlkRecord) << "330"      << '\n';
+        (*m_ssBlkRecord) << tablehash  << '\n';
+        (*m_ssBlkRecord) << "100"      << '\n';
+        (*m_ssBlkRecord) << "AcDbSymbolTableRecord"      << '\n';
+        (*m_ssBlkRecord) << "100"      << '\n';
+        (*m_ssBlkRecord) << "AcDbBlockTableRecord"      << '\n';
+        (*m_ssBlkRecord) << "  2"      << '\n';
+        (*m_ssBlkRecord) << "*PAPER_SPACE"   << '\n';
+//        (*m_ssBlkRecord) << "  1"      << '\n';
+//        (*m_ssBlkRecord) << " "        << '\n';
 }
  
 //***************************
@@ -304,20 +390,20 @@ void CDxfWrite::makeBlockRecordTableBody(void)
     
     int iBlkRecord = 0;
     for (auto& b: m_blockList) {
-        (*m_ssBlkRecord) << "  0"      << endl;
-        (*m_ssBlkRecord) << "BLOCK_RECORD"      << endl;
-        (*m_ssBlkRecord) << "  5"      << endl;
-        (*m_ssBlkRecord) << m_blkRecordList.at(iBlkRecord)      << endl;
-        (*m_ssBlkRecord) << "330"      << endl;
-        (*m_ssBlkRecord) << m_saveBlockRecordTableHandle  << endl;
-        (*m_ssBlkRecord) << "100"      << endl;
-        (*m_ssBlkRecord) << "AcDbSymbolTableRecord"      << endl;
-        (*m_ssBlkRecord) << "100"      << endl;
-        (*m_ssBlkRecord) << "AcDbBlockTableRecord"      << endl;
-        (*m_ssBlkRecord) << "  2"      << endl;
-        (*m_ssBlkRecord) << b          << endl;
-//        (*m_ssBlkRecord) << " 70"      << endl;
-//        (*m_ssBlkRecord) << "    0"      << endl;
+        (*m_ssBlkRecord) << "  0"      << '\n';
+        (*m_ssBlkRecord) << "BLOCK_RECORD"      << '\n';
+        (*m_ssBlkRecord) << "  5"      << '\n';
+        (*m_ssBlkRecord) << m_blkRecordList.at(iBlkRecord)      << '\n';
+        (*m_ssBlkRecord) << "330"      << '\n';
+        (*m_ssBlkRecord) << m_saveBlockRecordTableHandle  << '\n';
+        (*m_ssBlkRecord) << "100"      << '\n';
+        (*m_ssBlkRecord) << "AcDbSymbolTableRecord"      << '\n';
+        (*m_ssBlkRecord) << "100"      << '\n';
+        (*m_ssBlkRecord) << "AcDbBlockTableRecord"      << '\n';
+        (*m_ssBlkRecord) << "  2"      << '\n';
+        (*m_ssBlkRecord) << b          << '\n';
+//        (*m_ssBlkRecord) << " 70"      << '\n';
+//        (*m_ssBlkRecord) << "    0"      << '\n';
         iBlkRecord++;
     }
 }
@@ -327,108 +413,108 @@ void CDxfWrite::makeBlockRecordTableBody(void)
 //added by Wandererfan 2018 (wandererfan@gmail.com) for FreeCAD project
 void CDxfWrite::makeBlockSectionHead(void)
 {
-    (*m_ssBlock) << "  0"          << endl;
-    (*m_ssBlock) << "SECTION"      << endl;
-    (*m_ssBlock) << "  2"          << endl;
-    (*m_ssBlock) << "BLOCKS"       << endl;
-    (*m_ssBlock) << "  0"          << endl;
-    (*m_ssBlock) << "BLOCK"        << endl;
-    (*m_ssBlock) << "  5"          << endl;
+    (*m_ssBlock) << "  0"          << '\n';
+    (*m_ssBlock) << "SECTION"      << '\n';
+    (*m_ssBlock) << "  2"          << '\n';
+    (*m_ssBlock) << "BLOCKS"       << '\n';
+    (*m_ssBlock) << "  0"          << '\n';
+    (*m_ssBlock) << "BLOCK"        << '\n';
+    (*m_ssBlock) << "  5"          << '\n';
     m_currentBlock = getBlockHandle();
-    (*m_ssBlock) << m_currentBlock << endl;
+    (*m_ssBlock) << m_currentBlock << '\n';
     if (m_version > 12) {
-        (*m_ssBlock) << "330"      << endl;
-        (*m_ssBlock) << m_saveModelSpaceHandle << endl;
-        (*m_ssBlock) << "100"      << endl;
-        (*m_ssBlock) << "AcDbEntity"      << endl;
+        (*m_ssBlock) << "330"      << '\n';
+        (*m_ssBlock) << m_saveModelSpaceHandle << '\n';
+        (*m_ssBlock) << "100"      << '\n';
+        (*m_ssBlock) << "AcDbEntity"      << '\n';
     }
-    (*m_ssBlock) << "  8"          << endl;
-    (*m_ssBlock) << "0"            << endl;
+    (*m_ssBlock) << "  8"          << '\n';
+    (*m_ssBlock) << "0"            << '\n';
     if (m_version > 12) {
-        (*m_ssBlock) << "100"      << endl;
-        (*m_ssBlock) << "AcDbBlockBegin"  << endl;
-    }
-    (*m_ssBlock) << "  2"          << endl;
-    (*m_ssBlock) << "*MODEL_SPACE" << endl;
-    (*m_ssBlock) << " 70"          << endl;
-    (*m_ssBlock) << "   0"         << endl;
-    (*m_ssBlock) << " 10"          << endl;
-    (*m_ssBlock) << 0.0            << endl;
-    (*m_ssBlock) << " 20"          << endl; 
-    (*m_ssBlock) << 0.0            << endl;
-    (*m_ssBlock) << " 30"          << endl;
-    (*m_ssBlock) << 0.0            << endl;
-    (*m_ssBlock) << "  3"          << endl;
-    (*m_ssBlock) << "*MODEL_SPACE" << endl;
-    (*m_ssBlock) << "  1"          << endl;
-    (*m_ssBlock) << " "            << endl;
-    (*m_ssBlock) << "  0"          << endl;
-    (*m_ssBlock) << "ENDBLK"       << endl;
-    (*m_ssBlock) << "  5"          << endl;
-    (*m_ssBlock) << getBlockHandle()   << endl;
+        (*m_ssBlock) << "100"      << '\n';
+        (*m_ssBlock) << "AcDbBlockBegin"  << '\n';
+    }
+    (*m_ssBlock) << "  2"          << '\n';
+    (*m_ssBlock) << "*MODEL_SPACE" << '\n';
+    (*m_ssBlock) << " 70"          << '\n';
+    (*m_ssBlock) << "   0"         << '\n';
+    (*m_ssBlock) << " 10"          << '\n';
+    (*m_ssBlock) << 0.0            << '\n';
+    (*m_ssBlock) << " 20"          << '\n'; 
+    (*m_ssBlock) << 0.0            << '\n';
+    (*m_ssBlock) << " 30"          << '\n';
+    (*m_ssBlock) << 0.0            << '\n';
+    (*m_ssBlock) << "  3"          << '\n';
+    (*m_ssBlock) << "*MODEL_SPACE" << '\n';
+    (*m_ssBlock) << "  1"          << '\n';
+    (*m_ssBlock) << " "            << '\n';
+    (*m_ssBlock) << "  0"          << '\n';
+    (*m_ssBlock) << "ENDBLK"       << '\n';
+    (*m_ssBlock) << "  5"          << '\n';
+    (*m_ssBlock) << getBlockHandle()   << '\n';
     if (m_version > 12) {
-        (*m_ssBlock) << "330"      << endl;
-        (*m_ssBlock) << m_saveModelSpaceHandle << endl;
-        (*m_ssBlock) << "100"      << endl;
-        (*m_ssBlock) << "AcDbEntity"  << endl;
+        (*m_ssBlock) << "330"      << '\n';
+        (*m_ssBlock) << m_saveModelSpaceHandle << '\n';
+        (*m_ssBlock) << "100"      << '\n';
+        (*m_ssBlock) << "AcDbEntity"  << '\n';
     }
-    (*m_ssBlock) << "  8"          << endl;
-    (*m_ssBlock) << "0"            << endl;
+    (*m_ssBlock) << "  8"          << '\n';
+    (*m_ssBlock) << "0"            << '\n';
     if (m_version > 12) {
-        (*m_ssBlock) << "100"      << endl;
-        (*m_ssBlock) << "AcDbBlockEnd"      << endl;
+        (*m_ssBlock) << "100"      << '\n';
+        (*m_ssBlock) << "AcDbBlockEnd"      << '\n';
     }
 
-    (*m_ssBlock) << "  0"          << endl;
-    (*m_ssBlock) << "BLOCK"        << endl;
-    (*m_ssBlock) << "  5"          << endl;
+    (*m_ssBlock) << "  0"          << '\n';
+    (*m_ssBlock) << "BLOCK"        << '\n';
+    (*m_ssBlock) << "  5"          << '\n';
     m_currentBlock = getBlockHandle();
-    (*m_ssBlock) << m_currentBlock << endl;
+    (*m_ssBlock) << m_currentBlock << '\n';
     if (m_version > 12) {
-        (*m_ssBlock) << "330"      << endl;
-        (*m_ssBlock) << m_savePaperSpaceHandle << endl;
-        (*m_ssBlock) << "100"      << endl;
-        (*m_ssBlock) << "AcDbEntity"      << endl;
-        (*m_ssBlock) << " 67"          << endl;
-        (*m_ssBlock) << "1"            << endl;
-    }
-    (*m_ssBlock) << "  8"          << endl;
-    (*m_ssBlock) << "0"            << endl;
+        (*m_ssBlock) << "330"      << '\n';
+        (*m_ssBlock) << m_savePaperSpaceHandle << '\n';
+        (*m_ssBlock) << "100"      << '\n';
+        (*m_ssBlock) << "AcDbEntity"      << '\n';
+        (*m_ssBlock) << " 67"          << '\n';
+        (*m_ssBlock) << "1"            << '\n';
+    }
+    (*m_ssBlock) << "  8"          << '\n';
+    (*m_ssBlock) << "0"            << '\n';
     if (m_version > 12) {
-        (*m_ssBlock) << "100"      << endl;
-        (*m_ssBlock) << "AcDbBlockBegin"  << endl;
-    }
-    (*m_ssBlock) << "  2"          << endl;
-    (*m_ssBlock) << "*PAPER_SPACE" << endl;
-    (*m_ssBlock) << " 70"          << endl;
-    (*m_ssBlock) << "   0"         << endl;
-    (*m_ssBlock) << " 10"          << endl;
-    (*m_ssBlock) << 0.0            << endl;
-    (*m_ssBlock) << " 20"          << endl; 
-    (*m_ssBlock) << 0.0            << endl;
-    (*m_ssBlock) << " 30"          << endl;
-    (*m_ssBlock) << 0.0            << endl;
-    (*m_ssBlock) << "  3"          << endl;
-    (*m_ssBlock) << "*PAPER_SPACE" << endl;
-    (*m_ssBlock) << "  1"          << endl;
-    (*m_ssBlock) << " "            << endl;
-    (*m_ssBlock) << "  0"          << endl;
-    (*m_ssBlock) << "ENDBLK"       << endl;
-    (*m_ssBlock) << "  5"          << endl;
-    (*m_ssBlock) << getBlockHandle()   << endl;
+        (*m_ssBlock) << "100"      << '\n';
+        (*m_ssBlock) << "AcDbBlockBegin"  << '\n';
+    }
+    (*m_ssBlock) << "  2"          << '\n';
+    (*m_ssBlock) << "*PAPER_SPACE" << '\n';
+    (*m_ssBlock) << " 70"          << '\n';
+    (*m_ssBlock) << "   0"         << '\n';
+    (*m_ssBlock) << " 10"          << '\n';
+    (*m_ssBlock) << 0.0            << '\n';
+    (*m_ssBlock) << " 20"          << '\n'; 
+    (*m_ssBlock) << 0.0            << '\n';
+    (*m_ssBlock) << " 30"          << '\n';
+    (*m_ssBlock) << 0.0            << '\n';
+    (*m_ssBlock) << "  3"          << '\n';
+    (*m_ssBlock) << "*PAPER_SPACE" << '\n';
+    (*m_ssBlock) << "  1"          << '\n';
+    (*m_ssBlock) << " "            << '\n';
+    (*m_ssBlock) << "  0"          << '\n';
+    (*m_ssBlock) << "ENDBLK"       << '\n';
+    (*m_ssBlock) << "  5"          << '\n';
+    (*m_ssBlock) << getBlockHandle()   << '\n';
     if (m_version > 12) {
-        (*m_ssBlock) << "330"      << endl;
-        (*m_ssBlock) << m_savePaperSpaceHandle << endl;
-        (*m_ssBlock) << "100"      << endl;
-        (*m_ssBlock) << "AcDbEntity"      << endl;
-        (*m_ssBlock) << " 67"      << endl;      //paper_space flag
-        (*m_ssBlock) << "    1"    << endl;
-    }
-    (*m_ssBlock) << "  8"          << endl;
-    (*m_ssBlock) << "0"            << endl;
+        (*m_ssBlock) << "330"      << '\n';
+        (*m_ssBlock) << m_savePaperSpaceHandle << '\n';
+        (*m_ssBlock) << "100"      << '\n';
+        (*m_ssBlock) << "AcDbEntity"      << '\n';
+        (*m_ssBlock) << " 67"      << '\n';      //paper_space flag
+        (*m_ssBlock) << "    1"    << '\n';
+    }
+    (*m_ssBlock) << "  8"          << '\n';
+    (*m_ssBlock) << "0"            << '\n';
     if (m_version > 12) {
-        (*m_ssBlock) << "100"      << endl;
-        (*m_ssBlock) << "AcDbBlockEnd" << endl;
+        (*m_ssBlock) << "100"      << '\n';
+        (*m_ssBlock) << "AcDbBlockEnd" << '\n';
     }
 }
 
@@ -438,6 +524,7 @@ std::string CDxfWrite::getPlateFile(std::string fileSpec)
     const std::filesystem::path fpath(fileSpec);
     if (!std::filesystem::exists(fpath)) { // TODO Check read permissions
         //Base::Console().Message("dxf unable to open %s!\n",fileSpec.c_str());
+        outString << builtin_plate_file(fpath.filename().string());
     } else {
         string line;
         ifstream inFile (fpath);
@@ -523,34 +610,34 @@ void CDxfWrite::putLine(const Base::Vector3d s, const Base::Vector3d e,
                           std::ostringstream* outStream, const std::string handle,
                           const std::string ownerHandle)
 {
-    (*outStream) << "  0"       << endl;
-    (*outStream) << "LINE"      << endl;
-    (*outStream) << "  5"       << endl;
-    (*outStream) << handle      << endl;
+    (*outStream) << "  0"       << '\n';
+    (*outStream) << "LINE"      << '\n';
+    (*outStream) << "  5"       << '\n';
+    (*outStream) << handle      << '\n';
     if (m_version > 12) {
-        (*outStream) << "330"      << endl;
-        (*outStream) << ownerHandle  << endl;
-        (*outStream) << "100"      << endl;
-        (*outStream) << "AcDbEntity"      << endl;
+        (*outStream) << "330"      << '\n';
+        (*outStream) << ownerHandle  << '\n';
+        (*outStream) << "100"      << '\n';
+        (*outStream) << "AcDbEntity"      << '\n';
     }
-    (*outStream) << "  8"       << endl;    // Group code for layer name
-    (*outStream) << getLayerName()  << endl;    // Layer number
+    (*outStream) << "  8"       << '\n';    // Group code for layer name
+    (*outStream) << getLayerName()  << '\n';    // Layer number
     if (m_version > 12) {
-        (*outStream) << "100"      << endl;
-        (*outStream) << "AcDbLine" << endl;
+        (*outStream) << "100"      << '\n';
+        (*outStream) << "AcDbLine" << '\n';
     }
-    (*outStream) << " 10"       << endl;    // Start point of line
-    (*outStream) << s.x         << endl;    // X in WCS coordinates
-    (*outStream) << " 20"       << endl;
-    (*outStream) << s.y         << endl;    // Y in WCS coordinates
-    (*outStream) << " 30"       << endl;
-    (*outStream) << s.z         << endl;    // Z in WCS coordinates
-    (*outStream) << " 11"       << endl;    // End point of line
-    (*outStream) << e.x         << endl;    // X in WCS coordinates
-    (*outStream) << " 21"       << endl;
-    (*outStream) << e.y         << endl;    // Y in WCS coordinates
-    (*outStream) << " 31"       << endl;
-    (*outStream) << e.z         << endl;    // Z in WCS coordinates
+    (*outStream) << " 10"       << '\n';    // Start point of line
+    (*outStream) << s.x         << '\n';    // X in WCS coordinates
+    (*outStream) << " 20"       << '\n';
+    (*outStream) << s.y         << '\n';    // Y in WCS coordinates
+    (*outStream) << " 30"       << '\n';
+    (*outStream) << s.z         << '\n';    // Z in WCS coordinates
+    (*outStream) << " 11"       << '\n';    // End point of line
+    (*outStream) << e.x         << '\n';    // X in WCS coordinates
+    (*outStream) << " 21"       << '\n';
+    (*outStream) << e.y         << '\n';    // Y in WCS coordinates
+    (*outStream) << " 31"       << '\n';
+    (*outStream) << e.z         << '\n';    // Z in WCS coordinates
 }
 
 
@@ -559,57 +646,57 @@ void CDxfWrite::putLine(const Base::Vector3d s, const Base::Vector3d e,
 //added by Wandererfan 2018 (wandererfan@gmail.com) for FreeCAD project
 void CDxfWrite::writeLWPolyLine(const LWPolyDataOut &pd)
 {
-    (*m_ssEntity) << "  0"               << endl;
-    (*m_ssEntity) << "LWPOLYLINE"     << endl;
-    (*m_ssEntity) << "  5"      << endl;
-    (*m_ssEntity) << getEntityHandle() << endl;
+    (*m_ssEntity) << "  0"               << '\n';
+    (*m_ssEntity) << "LWPOLYLINE"     << '\n';
+    (*m_ssEntity) << "  5"      << '\n';
+    (*m_ssEntity) << getEntityHandle() << '\n';
     if (m_version > 12) {
-        (*m_ssEntity) << "330"      << endl;
-        (*m_ssEntity) << m_saveModelSpaceHandle  << endl;
-        (*m_ssEntity) << "100"      << endl;
-        (*m_ssEntity) << "AcDbEntity"      << endl;
+        (*m_ssEntity) << "330"      << '\n';
+        (*m_ssEntity) << m_saveModelSpaceHandle  << '\n';
+        (*m_ssEntity) << "100"      << '\n';
+        (*m_ssEntity) << "AcDbEntity"      << '\n';
     }
     if (m_version > 12) {
-        (*m_ssEntity) << "100"            << endl;    //100 groups are not part of R12
-        (*m_ssEntity) << "AcDbPolyline"   << endl;
-    }
-    (*m_ssEntity) << "  8"            << endl;    // Group code for layer name
-    (*m_ssEntity) << getLayerName()   << endl;    // Layer name
-    (*m_ssEntity) << " 90"            << endl;
-    (*m_ssEntity) << pd.nVert         << endl;    // number of vertices
-    (*m_ssEntity) << " 70"            << endl;
-    (*m_ssEntity) << pd.Flag          << endl;
-    (*m_ssEntity) << " 43"            << endl;
-    (*m_ssEntity) << "0"              << endl;    //Constant width opt
-//    (*m_ssEntity) << pd.Width         << endl;    //Constant width opt
-//    (*m_ssEntity) << " 38"            << endl;
-//    (*m_ssEntity) << pd.Elev          << endl;    // Elevation
-//    (*m_ssEntity) << " 39"            << endl;
-//    (*m_ssEntity) << pd.Thick         << endl;    // Thickness
+        (*m_ssEntity) << "100"            << '\n';    //100 groups are not part of R12
+        (*m_ssEntity) << "AcDbPolyline"   << '\n';
+    }
+    (*m_ssEntity) << "  8"            << '\n';    // Group code for layer name
+    (*m_ssEntity) << getLayerName()   << '\n';    // Layer name
+    (*m_ssEntity) << " 90"            << '\n';
+    (*m_ssEntity) << pd.nVert         << '\n';    // number of vertices
+    (*m_ssEntity) << " 70"            << '\n';
+    (*m_ssEntity) << pd.Flag          << '\n';
+    (*m_ssEntity) << " 43"            << '\n';
+    (*m_ssEntity) << "0"              << '\n';    //Constant width opt
+//    (*m_ssEntity) << pd.Width         << '\n';    //Constant width opt
+//    (*m_ssEntity) << " 38"            << '\n';
+//    (*m_ssEntity) << pd.Elev          << '\n';    // Elevation
+//    (*m_ssEntity) << " 39"            << '\n';
+//    (*m_ssEntity) << pd.Thick         << '\n';    // Thickness
     for (auto& p: pd.Verts) {
-        (*m_ssEntity) << " 10"        << endl;    // Vertices
-        (*m_ssEntity) << p.x          << endl;
-        (*m_ssEntity) << " 20"        << endl;
-        (*m_ssEntity) << p.y          << endl;
+        (*m_ssEntity) << " 10"        << '\n';    // Vertices
+        (*m_ssEntity) << p.x          << '\n';
+        (*m_ssEntity) << " 20"        << '\n';
+        (*m_ssEntity) << p.y          << '\n';
     } 
     for (auto& s: pd.StartWidth) {
-        (*m_ssEntity) << " 40"        << endl;
-        (*m_ssEntity) << s            << endl;    // Start Width
+        (*m_ssEntity) << " 40"        << '\n';
+        (*m_ssEntity) << s            << '\n';    // Start Width
     }
     for (auto& e: pd.EndWidth) {
-        (*m_ssEntity) << " 41"        << endl;
-        (*m_ssEntity) << e            << endl;    // End Width
+        (*m_ssEntity) << " 41"        << '\n';
+        (*m_ssEntity) << e            << '\n';    // End Width
     }
     for (auto& b: pd.Bulge) {                // Bulge
-        (*m_ssEntity) << " 42"        << endl;
-        (*m_ssEntity) << b            << endl;
+        (*m_ssEntity) << " 42"        << '\n';
+        (*m_ssEntity) << b            << '\n';
     }
-//    (*m_ssEntity) << "210"            << endl;    //Extrusion dir
-//    (*m_ssEntity) << pd.Extr.x        << endl;
-//    (*m_ssEntity) << "220"            << endl;
-//    (*m_ssEntity) << pd.Extr.y        << endl;
-//    (*m_ssEntity) << "230"            << endl;
-//    (*m_ssEntity) << pd.Extr.z        << endl;
+//    (*m_ssEntity) << "210"            << '\n';    //Extrusion dir
+//    (*m_ssEntity) << pd.Extr.x        << '\n';
+//    (*m_ssEntity) << "220"            << '\n';
+//    (*m_ssEntity) << pd.Extr.y        << '\n';
+//    (*m_ssEntity) << "230"            << '\n';
+//    (*m_ssEntity) << pd.Extr.z        << '\n';
 }
 
 //***************************
@@ -617,78 +704,78 @@ void CDxfWrite::writeLWPolyLine(const LWPolyDataOut &pd)
 //added by Wandererfan 2018 (wandererfan@gmail.com) for FreeCAD project
 void CDxfWrite::writePolyline(const LWPolyDataOut &pd)
 {
-    (*m_ssEntity) << "  0"            << endl;
-    (*m_ssEntity) << "POLYLINE"       << endl;
-    (*m_ssEntity) << "  5"      << endl;
-    (*m_ssEntity) << getEntityHandle() << endl;
+    (*m_ssEntity) << "  0"            << '\n';
+    (*m_ssEntity) << "POLYLINE"       << '\n';
+    (*m_ssEntity) << "  5"      << '\n';
+    (*m_ssEntity) << getEntityHandle() << '\n';
     if (m_version > 12) {
-        (*m_ssEntity) << "330"      << endl;
-        (*m_ssEntity) << m_saveModelSpaceHandle  << endl;
-        (*m_ssEntity) << "100"      << endl;
-        (*m_ssEntity) << "AcDbEntity"      << endl;
+        (*m_ssEntity) << "330"      << '\n';
+        (*m_ssEntity) << m_saveModelSpaceHandle  << '\n';
+        (*m_ssEntity) << "100"      << '\n';
+        (*m_ssEntity) << "AcDbEntity"      << '\n';
     }
-    (*m_ssEntity) << "  8"            << endl;
-    (*m_ssEntity) << getLayerName()       << endl;    // Layer name
+    (*m_ssEntity) << "  8"            << '\n';
+    (*m_ssEntity) << getLayerName()       << '\n';    // Layer name
     if (m_version > 12) {
-        (*m_ssEntity) << "100"            << endl;    //100 groups are not part of R12
-        (*m_ssEntity) << "AcDbPolyline"   << endl;
-    }
-    (*m_ssEntity) << " 66"            << endl;
-    (*m_ssEntity) << "     1"         << endl;    // vertices follow
-    (*m_ssEntity) << " 10"            << endl;
-    (*m_ssEntity) << "0.0"            << endl;
-    (*m_ssEntity) << " 20"            << endl;
-    (*m_ssEntity) << "0.0"            << endl;
-    (*m_ssEntity) << " 30"            << endl;
-    (*m_ssEntity) << "0.0"            << endl;
-    (*m_ssEntity) << " 70"            << endl;
-    (*m_ssEntity) << "0"              << endl;
+        (*m_ssEntity) << "100"            << '\n';    //100 groups are not part of R12
+        (*m_ssEntity) << "AcDbPolyline"   << '\n';
+    }
+    (*m_ssEntity) << " 66"            << '\n';
+    (*m_ssEntity) << "     1"         << '\n';    // vertices follow
+    (*m_ssEntity) << " 10"            << '\n';
+    (*m_ssEntity) << "0.0"            << '\n';
+    (*m_ssEntity) << " 20"            << '\n';
+    (*m_ssEntity) << "0.0"            << '\n';
+    (*m_ssEntity) << " 30"            << '\n';
+    (*m_ssEntity) << "0.0"            << '\n';
+    (*m_ssEntity) << " 70"            << '\n';
+    (*m_ssEntity) << "0"              << '\n';
     for (auto& p: pd.Verts) {
-        (*m_ssEntity) << "  0"        << endl;
-        (*m_ssEntity) << "VERTEX"     << endl;
-        (*m_ssEntity) << "  5"      << endl;
-        (*m_ssEntity) << getEntityHandle() << endl;
-        (*m_ssEntity) << "  8"        << endl;
-        (*m_ssEntity) << getLayerName()   << endl;
-        (*m_ssEntity) << " 10"        << endl;
-        (*m_ssEntity) << p.x          << endl;
-        (*m_ssEntity) << " 20"        << endl;
-        (*m_ssEntity) << p.y          << endl;
-        (*m_ssEntity) << " 30"        << endl;
-        (*m_ssEntity) << "0.0"        << endl;
+        (*m_ssEntity) << "  0"        << '\n';
+        (*m_ssEntity) << "VERTEX"     << '\n';
+        (*m_ssEntity) << "  5"      << '\n';
+        (*m_ssEntity) << getEntityHandle() << '\n';
+        (*m_ssEntity) << "  8"        << '\n';
+        (*m_ssEntity) << getLayerName()   << '\n';
+        (*m_ssEntity) << " 10"        << '\n';
+        (*m_ssEntity) << p.x          << '\n';
+        (*m_ssEntity) << " 20"        << '\n';
+        (*m_ssEntity) << p.y          << '\n';
+        (*m_ssEntity) << " 30"        << '\n';
+        (*m_ssEntity) << "0.0"        << '\n';
     } 
-    (*m_ssEntity) << "  0"            << endl;
-    (*m_ssEntity) << "SEQEND"         << endl;
-    (*m_ssEntity) << "  5"            << endl;
-    (*m_ssEntity) << getEntityHandle()      << endl;
-    (*m_ssEntity) << "  8"            << endl;
-    (*m_ssEntity) << getLayerName()       << endl;
+    (*m_ssEntity) << "  0"            << '\n';
+    (*m_ssEntity) << "SEQEND"         << '\n';
+    (*m_ssEntity) << "  5"            << '\n';
+    (*m_ssEntity) << getEntityHandle()      << '\n';
+    (*m_ssEntity) << "  8"            << '\n';
+    (*m_ssEntity) << getLayerName()       << '\n';
 }
 
 void CDxfWrite::writePoint(const double* s)
 {
-    (*m_ssEntity) << "  0"            << endl;
-    (*m_ssEntity) << "POINT"          << endl;
-    (*m_ssEntity) << "  5"      << endl;
-    (*m_ssEntity) << getEntityHandle() << endl;
+    (*m_ssEntity) << "  0"            << '\n';
+    (*m_ssEntity) << "POINT"          << '\n';
+    (*m_ssEntity) << "  5"      << '\n';
+    (*m_ssEntity) << getEntityHandle() << '\n';
     if (m_version > 12) {
-        (*m_ssEntity) << "330"      << endl;
-        (*m_ssEntity) << m_saveModelSpaceHandle  << endl;
-        (*m_ssEntity) << "100"      << endl;
-        (*m_ssEntity) << "AcDbEntity"      << endl;
+        (*m_ssEntity) << "330"      << '\n';
+        (*m_ssEntity) << m_saveModelSpaceHandle  << '\n';
+        (*m_ssEntity) << "100"      << '\n';
+        (*m_ssEntity) << "AcDbEntity"      << '\n';
     }
-    (*m_ssEntity) << "  8"            << endl;    // Group code for layer name
-    (*m_ssEntity) << getLayerName()       << endl;    // Layer name
+    (*m_ssEntity) << "  8"            << '\n';    // Group code for layer name
+    (*m_ssEntity) << getLayerName()       << '\n';    // Layer name
     if (m_version > 12) {
-        (*m_ssEntity) << "100"       << endl;
-        (*m_ssEntity) << "AcDbPoint" << endl;
+        (*m_ssEntity) << "100"       << '\n';
+        (*m_ssEntity) << "AcDbPoint" << '\n';
     }
-    (*m_ssEntity) << " 10"            << endl;
-    (*m_ssEntity) << s[0]             << endl;    // X in WCS coordinates
-    (*m_ssEntity) << " 20"            << endl;
-    (*m_ssEntity) << s[1]             << endl;    // Y in WCS coordinates
-    (*m_ssEntity) << " 30"            << endl;
-    (*m_ssEntity) << s[2]             << endl;    // Z in WCS coordinates
+    (*m_ssEntity) << " 10"            << '\n';
+    (*m_ssEntity) << s[0]             << '\n';    // X in WCS coordinates
+    (*m_ssEntity) << " 20"            << '\n';
+    (*m_ssEntity) << s[1]             << '\n';    // Y in WCS coordinates
+    (*m_ssEntity) << " 30"            << '\n';
+    (*m_ssEntity) << s[2]             << '\n';    // Z in WCS coordinates
 }
 
 void CDxfWrite::writeArc(const double* s, const double* e, const double* c, bool dir)
@@ -706,69 +793,69 @@ void CDxfWrite::writeArc(const double* s, const double* e, const double* c, bool
         start_angle = end_angle;
         end_angle = temp;
     }
-    (*m_ssEntity) << "  0"       << endl;
-    (*m_ssEntity) << "ARC"       << endl;
-    (*m_ssEntity) << "  5"      << endl;
-    (*m_ssEntity) << getEntityHandle() << endl;
+    (*m_ssEntity) << "  0"       << '\n';
+    (*m_ssEntity) << "ARC"       << '\n';
+    (*m_ssEntity) << "  5"      << '\n';
+    (*m_ssEntity) << getEntityHandle() << '\n';
     if (m_version > 12) {
-        (*m_ssEntity) << "330"      << endl;
-        (*m_ssEntity) << m_saveModelSpaceHandle  << endl;
-        (*m_ssEntity) << "100"      << endl;
-        (*m_ssEntity) << "AcDbEntity"      << endl;
-    }
-    (*m_ssEntity) << "  8"       << endl;    // Group code for layer name
-    (*m_ssEntity) << getLayerName()  << endl;    // Layer number
-//    (*m_ssEntity) << " 62"          << endl;
-//    (*m_ssEntity) << "     0"       << endl;
+        (*m_ssEntity) << "330"      << '\n';
+        (*m_ssEntity) << m_saveModelSpaceHandle  << '\n';
+        (*m_ssEntity) << "100"      << '\n';
+        (*m_ssEntity) << "AcDbEntity"      << '\n';
+    }
+    (*m_ssEntity) << "  8"       << '\n';    // Group code for layer name
+    (*m_ssEntity) << getLayerName()  << '\n';    // Layer number
+//    (*m_ssEntity) << " 62"          << '\n';
+//    (*m_ssEntity) << "     0"       << '\n';
      if (m_version > 12) {
-        (*m_ssEntity) << "100"          << endl;
-        (*m_ssEntity) << "AcDbCircle"   << endl;
-    }
-    (*m_ssEntity) << " 10"       << endl;    // Centre X
-    (*m_ssEntity) << c[0]        << endl;    // X in WCS coordinates
-    (*m_ssEntity) << " 20"       << endl;
-    (*m_ssEntity) << c[1]        << endl;    // Y in WCS coordinates
-    (*m_ssEntity) << " 30"       << endl;
-    (*m_ssEntity) << c[2]        << endl;    // Z in WCS coordinates
-    (*m_ssEntity) << " 40"       << endl;    //
-    (*m_ssEntity) << radius      << endl;    // Radius
+        (*m_ssEntity) << "100"          << '\n';
+        (*m_ssEntity) << "AcDbCircle"   << '\n';
+    }
+    (*m_ssEntity) << " 10"       << '\n';    // Centre X
+    (*m_ssEntity) << c[0]        << '\n';    // X in WCS coordinates
+    (*m_ssEntity) << " 20"       << '\n';
+    (*m_ssEntity) << c[1]        << '\n';    // Y in WCS coordinates
+    (*m_ssEntity) << " 30"       << '\n';
+    (*m_ssEntity) << c[2]        << '\n';    // Z in WCS coordinates
+    (*m_ssEntity) << " 40"       << '\n';    //
+    (*m_ssEntity) << radius      << '\n';    // Radius
 
     if (m_version > 12) {
-        (*m_ssEntity) << "100"      << endl;
-        (*m_ssEntity) << "AcDbArc" << endl;
+        (*m_ssEntity) << "100"      << '\n';
+        (*m_ssEntity) << "AcDbArc" << '\n';
     }
-    (*m_ssEntity) << " 50"       << endl;
-    (*m_ssEntity) << start_angle << endl;    // Start angle
-    (*m_ssEntity) << " 51"       << endl;
-    (*m_ssEntity) << end_angle   << endl;    // End angle
+    (*m_ssEntity) << " 50"       << '\n';
+    (*m_ssEntity) << start_angle << '\n';    // Start angle
+    (*m_ssEntity) << " 51"       << '\n';
+    (*m_ssEntity) << end_angle   << '\n';    // End angle
 }
 
 void CDxfWrite::writeCircle(const double* c, double radius)
 {
-    (*m_ssEntity) << "  0"       << endl;
-    (*m_ssEntity) << "CIRCLE"    << endl;
-    (*m_ssEntity) << "  5"      << endl;
-    (*m_ssEntity) << getEntityHandle() << endl;
+    (*m_ssEntity) << "  0"       << '\n';
+    (*m_ssEntity) << "CIRCLE"    << '\n';
+    (*m_ssEntity) << "  5"      << '\n';
+    (*m_ssEntity) << getEntityHandle() << '\n';
     if (m_version > 12) {
-        (*m_ssEntity) << "330"      << endl;
-        (*m_ssEntity) << m_saveModelSpaceHandle  << endl;
-        (*m_ssEntity) << "100"      << endl;
-        (*m_ssEntity) << "AcDbEntity"      << endl;
+        (*m_ssEntity) << "330"      << '\n';
+        (*m_ssEntity) << m_saveModelSpaceHandle  << '\n';
+        (*m_ssEntity) << "100"      << '\n';
+        (*m_ssEntity) << "AcDbEntity"      << '\n';
     }
-    (*m_ssEntity) << "  8"       << endl;    // Group code for layer name
-    (*m_ssEntity) << getLayerName()  << endl;    // Layer number
+    (*m_ssEntity) << "  8"       << '\n';    // Group code for layer name
+    (*m_ssEntity) << getLayerName()  << '\n';    // Layer number
      if (m_version > 12) {
-        (*m_ssEntity) << "100"          << endl;
-        (*m_ssEntity) << "AcDbCircle"   << endl;
+        (*m_ssEntity) << "100"          << '\n';
+        (*m_ssEntity) << "AcDbCircle"   << '\n';
     }
-    (*m_ssEntity) << " 10"       << endl;    // Centre X
-    (*m_ssEntity) << c[0]        << endl;    // X in WCS coordinates
-    (*m_ssEntity) << " 20"       << endl;
-    (*m_ssEntity) << c[1]        << endl;    // Y in WCS coordinates
-//    (*m_ssEntity) << " 30"       << endl;
-//    (*m_ssEntity) << c[2]        << endl;    // Z in WCS coordinates
-    (*m_ssEntity) << " 40"       << endl;    //
-    (*m_ssEntity) << radius      << endl;    // Radius
+    (*m_ssEntity) << " 10"       << '\n';    // Centre X
+    (*m_ssEntity) << c[0]        << '\n';    // X in WCS coordinates
+    (*m_ssEntity) << " 20"       << '\n';
+    (*m_ssEntity) << c[1]        << '\n';    // Y in WCS coordinates
+//    (*m_ssEntity) << " 30"       << '\n';
+//    (*m_ssEntity) << c[2]        << '\n';    // Z in WCS coordinates
+    (*m_ssEntity) << " 40"       << '\n';    //
+    (*m_ssEntity) << radius      << '\n';    // Radius
 }
 
 void CDxfWrite::writeEllipse(const double* c, double major_radius, double minor_radius, 
@@ -787,46 +874,46 @@ void CDxfWrite::writeEllipse(const double* c, double major_radius, double minor_
         start_angle = end_angle;
         end_angle = temp;
     }
-    (*m_ssEntity) << "  0"       << endl;
-    (*m_ssEntity) << "ELLIPSE"   << endl;
-    (*m_ssEntity) << "  5"      << endl;
-    (*m_ssEntity) << getEntityHandle() << endl;
+    (*m_ssEntity) << "  0"       << '\n';
+    (*m_ssEntity) << "ELLIPSE"   << '\n';
+    (*m_ssEntity) << "  5"      << '\n';
+    (*m_ssEntity) << getEntityHandle() << '\n';
     if (m_version > 12) {
-        (*m_ssEntity) << "330"      << endl;
-        (*m_ssEntity) << m_saveModelSpaceHandle  << endl;
-        (*m_ssEntity) << "100"      << endl;
-        (*m_ssEntity) << "AcDbEntity"      << endl;
+        (*m_ssEntity) << "330"      << '\n';
+        (*m_ssEntity) << m_saveModelSpaceHandle  << '\n';
+        (*m_ssEntity) << "100"      << '\n';
+        (*m_ssEntity) << "AcDbEntity"      << '\n';
     }
-    (*m_ssEntity) << "  8"       << endl;    // Group code for layer name
-    (*m_ssEntity) << getLayerName()  << endl;    // Layer number
+    (*m_ssEntity) << "  8"       << '\n';    // Group code for layer name
+    (*m_ssEntity) << getLayerName()  << '\n';    // Layer number
      if (m_version > 12) {
-        (*m_ssEntity) << "100"          << endl;
-        (*m_ssEntity) << "AcDbEllipse"   << endl;
-    }
-    (*m_ssEntity) << " 10"       << endl;    // Centre X
-    (*m_ssEntity) << c[0]        << endl;    // X in WCS coordinates
-    (*m_ssEntity) << " 20"       << endl;
-    (*m_ssEntity) << c[1]        << endl;    // Y in WCS coordinates
-    (*m_ssEntity) << " 30"       << endl;
-    (*m_ssEntity) << c[2]        << endl;    // Z in WCS coordinates
-    (*m_ssEntity) << " 11"       << endl;    //
-    (*m_ssEntity) << m[0]        << endl;    // Major X
-    (*m_ssEntity) << " 21"       << endl;
-    (*m_ssEntity) << m[1]        << endl;    // Major Y
-    (*m_ssEntity) << " 31"       << endl;
-    (*m_ssEntity) << m[2]        << endl;    // Major Z
-    (*m_ssEntity) << " 40"       << endl;    //
-    (*m_ssEntity) << ratio       << endl;    // Ratio
-//    (*m_ssEntity) << "210"       << endl;    //extrusion dir??
-//    (*m_ssEntity) << "0"         << endl;
-//    (*m_ssEntity) << "220"       << endl;
-//    (*m_ssEntity) << "0"         << endl;
-//    (*m_ssEntity) << "230"       << endl;
-//    (*m_ssEntity) << "1"         << endl;
-    (*m_ssEntity) << " 41"       << endl;
-    (*m_ssEntity) << start_angle << endl;    // Start angle (radians [0..2pi])
-    (*m_ssEntity) << " 42"       << endl;
-    (*m_ssEntity) << end_angle   << endl;    // End angle
+        (*m_ssEntity) << "100"          << '\n';
+        (*m_ssEntity) << "AcDbEllipse"   << '\n';
+    }
+    (*m_ssEntity) << " 10"       << '\n';    // Centre X
+    (*m_ssEntity) << c[0]        << '\n';    // X in WCS coordinates
+    (*m_ssEntity) << " 20"       << '\n';
+    (*m_ssEntity) << c[1]        << '\n';    // Y in WCS coordinates
+    (*m_ssEntity) << " 30"       << '\n';
+    (*m_ssEntity) << c[2]        << '\n';    // Z in WCS coordinates
+    (*m_ssEntity) << " 11"       << '\n';    //
+    (*m_ssEntity) << m[0]        << '\n';    // Major X
+    (*m_ssEntity) << " 21"       << '\n';
+    (*m_ssEntity) << m[1]        << '\n';    // Major Y
+    (*m_ssEntity) << " 31"       << '\n';
+    (*m_ssEntity) << m[2]        << '\n';    // Major Z
+    (*m_ssEntity) << " 40"       << '\n';    //
+    (*m_ssEntity) << ratio       << '\n';    // Ratio
+//    (*m_ssEntity) << "210"       << '\n';    //extrusion dir??
+//    (*m_ssEntity) << "0"         << '\n';
+//    (*m_ssEntity) << "220"       << '\n';
+//    (*m_ssEntity) << "0"         << '\n';
+//    (*m_ssEntity) << "230"       << '\n';
+//    (*m_ssEntity) << "1"         << '\n';
+    (*m_ssEntity) << " 41"       << '\n';
+    (*m_ssEntity) << start_angle << '\n';    // Start angle (radians [0..2pi])
+    (*m_ssEntity) << " 42"       << '\n';
+    (*m_ssEntity) << end_angle   << '\n';    // End angle
 }
 
 //***************************
@@ -834,78 +921,78 @@ void CDxfWrite::writeEllipse(const double* c, double major_radius, double minor_
 //added by Wandererfan 2018 (wandererfan@gmail.com) for FreeCAD project
 void CDxfWrite::writeSpline(const SplineDataOut &sd)
 {
-    (*m_ssEntity) << "  0"          << endl;
-    (*m_ssEntity) << "SPLINE"       << endl;
-    (*m_ssEntity) << "  5"      << endl;
-    (*m_ssEntity) << getEntityHandle() << endl;
+    (*m_ssEntity) << "  0"          << '\n';
+    (*m_ssEntity) << "SPLINE"       << '\n';
+    (*m_ssEntity) << "  5"      << '\n';
+    (*m_ssEntity) << getEntityHandle() << '\n';
     if (m_version > 12) {
-        (*m_ssEntity) << "330"      << endl;
-        (*m_ssEntity) << m_saveModelSpaceHandle  << endl;
-        (*m_ssEntity) << "100"      << endl;
-        (*m_ssEntity) << "AcDbEntity"      << endl;
+        (*m_ssEntity) << "330"      << '\n';
+        (*m_ssEntity) << m_saveModelSpaceHandle  << '\n';
+        (*m_ssEntity) << "100"      << '\n';
+        (*m_ssEntity) << "AcDbEntity"      << '\n';
     }
-    (*m_ssEntity) << "  8"          << endl;    // Group code for layer name
-    (*m_ssEntity) << getLayerName()     << endl;    // Layer name
+    (*m_ssEntity) << "  8"          << '\n';    // Group code for layer name
+    (*m_ssEntity) << getLayerName()     << '\n';    // Layer name
     if (m_version > 12) {
-        (*m_ssEntity) << "100"          << endl;
-        (*m_ssEntity) << "AcDbSpline"   << endl;
-    }
-    (*m_ssEntity) << "210"          << endl;
-    (*m_ssEntity) << "0"            << endl;
-    (*m_ssEntity) << "220"          << endl;
-    (*m_ssEntity) << "0"            << endl;
-    (*m_ssEntity) << "230"          << endl;
-    (*m_ssEntity) << "1"            << endl;
-
-    (*m_ssEntity) << " 70"          << endl;
-    (*m_ssEntity) << sd.flag        << endl;      //flags
-    (*m_ssEntity) << " 71"          << endl; 
-    (*m_ssEntity) << sd.degree      << endl;
-    (*m_ssEntity) << " 72"          << endl;
-    (*m_ssEntity) << sd.knots       << endl;
-    (*m_ssEntity) << " 73"          << endl;
-    (*m_ssEntity) << sd.control_points   << endl;
-    (*m_ssEntity) << " 74"          << endl; 
-    (*m_ssEntity) << 0              << endl;
-
-//    (*m_ssEntity) << " 12"          << endl;
-//    (*m_ssEntity) << sd.starttan.x  << endl;
-//    (*m_ssEntity) << " 22"          << endl;
-//    (*m_ssEntity) << sd.starttan.y  << endl;
-//    (*m_ssEntity) << " 32"          << endl;
-//    (*m_ssEntity) << sd.starttan.z  << endl;
-//    (*m_ssEntity) << " 13"          << endl;
-//    (*m_ssEntity) << sd.endtan.x    << endl;
-//    (*m_ssEntity) << " 23"          << endl;
-//    (*m_ssEntity) << sd.endtan.y    << endl;
-//    (*m_ssEntity) << " 33"          << endl;
-//    (*m_ssEntity) << sd.endtan.z    << endl;
+        (*m_ssEntity) << "100"          << '\n';
+        (*m_ssEntity) << "AcDbSpline"   << '\n';
+    }
+    (*m_ssEntity) << "210"          << '\n';
+    (*m_ssEntity) << "0"            << '\n';
+    (*m_ssEntity) << "220"          << '\n';
+    (*m_ssEntity) << "0"            << '\n';
+    (*m_ssEntity) << "230"          << '\n';
+    (*m_ssEntity) << "1"            << '\n';
+
+    (*m_ssEntity) << " 70"          << '\n';
+    (*m_ssEntity) << sd.flag        << '\n';      //flags
+    (*m_ssEntity) << " 71"          << '\n'; 
+    (*m_ssEntity) << sd.degree      << '\n';
+    (*m_ssEntity) << " 72"          << '\n';
+    (*m_ssEntity) << sd.knots       << '\n';
+    (*m_ssEntity) << " 73"          << '\n';
+    (*m_ssEntity) << sd.control_points   << '\n';
+    (*m_ssEntity) << " 74"          << '\n'; 
+    (*m_ssEntity) << 0              << '\n';
+
+//    (*m_ssEntity) << " 12"          << '\n';
+//    (*m_ssEntity) << sd.starttan.x  << '\n';
+//    (*m_ssEntity) << " 22"          << '\n';
+//    (*m_ssEntity) << sd.starttan.y  << '\n';
+//    (*m_ssEntity) << " 32"          << '\n';
+//    (*m_ssEntity) << sd.starttan.z  << '\n';
+//    (*m_ssEntity) << " 13"          << '\n';
+//    (*m_ssEntity) << sd.endtan.x    << '\n';
+//    (*m_ssEntity) << " 23"          << '\n';
+//    (*m_ssEntity) << sd.endtan.y    << '\n';
+//    (*m_ssEntity) << " 33"          << '\n';
+//    (*m_ssEntity) << sd.endtan.z    << '\n';
 
     for (auto& k: sd.knot) {
-        (*m_ssEntity) << " 40"      << endl;  
-        (*m_ssEntity) << k          << endl;  
+        (*m_ssEntity) << " 40"      << '\n';  
+        (*m_ssEntity) << k          << '\n';  
     }
 
     for (auto& w : sd.weight) {
-        (*m_ssEntity) << " 41"      << endl;  
-        (*m_ssEntity) << w          << endl;  
+        (*m_ssEntity) << " 41"      << '\n';  
+        (*m_ssEntity) << w          << '\n';  
     }
 
     for (auto& c: sd.control) {
-        (*m_ssEntity) << " 10"      << endl;
-        (*m_ssEntity) << c.x        << endl;    // X in WCS coordinates
-        (*m_ssEntity) << " 20"      << endl;
-        (*m_ssEntity) << c.y        << endl;    // Y in WCS coordinates
-        (*m_ssEntity) << " 30"      << endl;
-        (*m_ssEntity) << c.z        << endl;    // Z in WCS coordinates
+        (*m_ssEntity) << " 10"      << '\n';
+        (*m_ssEntity) << c.x        << '\n';    // X in WCS coordinates
+        (*m_ssEntity) << " 20"      << '\n';
+        (*m_ssEntity) << c.y        << '\n';    // Y in WCS coordinates
+        (*m_ssEntity) << " 30"      << '\n';
+        (*m_ssEntity) << c.z        << '\n';    // Z in WCS coordinates
     }
     for (auto& f: sd.fit) {
-        (*m_ssEntity) << " 11"      << endl;
-        (*m_ssEntity) << f.x        << endl;    // X in WCS coordinates
-        (*m_ssEntity) << " 21"      << endl;
-        (*m_ssEntity) << f.y        << endl;    // Y in WCS coordinates
-        (*m_ssEntity) << " 31"      << endl;
-        (*m_ssEntity) << f.z        << endl;    // Z in WCS coordinates
+        (*m_ssEntity) << " 11"      << '\n';
+        (*m_ssEntity) << f.x        << '\n';    // X in WCS coordinates
+        (*m_ssEntity) << " 21"      << '\n';
+        (*m_ssEntity) << f.y        << '\n';    // Y in WCS coordinates
+        (*m_ssEntity) << " 31"      << '\n';
+        (*m_ssEntity) << f.z        << '\n';    // Z in WCS coordinates
     }
 }
 
@@ -914,30 +1001,30 @@ void CDxfWrite::writeSpline(const SplineDataOut &sd)
 //added by Wandererfan 2018 (wandererfan@gmail.com) for FreeCAD project
 void CDxfWrite::writeVertex(double x, double y, double z)
 {
-    (*m_ssEntity) << "  0"          << endl;
-    (*m_ssEntity) << "VERTEX"       << endl;
-    (*m_ssEntity) << "  5"      << endl;
-    (*m_ssEntity) << getEntityHandle() << endl;
+    (*m_ssEntity) << "  0"          << '\n';
+    (*m_ssEntity) << "VERTEX"       << '\n';
+    (*m_ssEntity) << "  5"      << '\n';
+    (*m_ssEntity) << getEntityHandle() << '\n';
     if (m_version > 12) {
-        (*m_ssEntity) << "330"      << endl;
-        (*m_ssEntity) << m_saveModelSpaceHandle  << endl;
-        (*m_ssEntity) << "100"      << endl;
-        (*m_ssEntity) << "AcDbEntity"      << endl;
+        (*m_ssEntity) << "330"      << '\n';
+        (*m_ssEntity) << m_saveModelSpaceHandle  << '\n';
+        (*m_ssEntity) << "100"      << '\n';
+        (*m_ssEntity) << "AcDbEntity"      << '\n';
     }
-    (*m_ssEntity) << "  8"          << endl;
-    (*m_ssEntity) << getLayerName()     << endl;
+    (*m_ssEntity) << "  8"          << '\n';
+    (*m_ssEntity) << getLayerName()     << '\n';
     if (m_version > 12) {
-        (*m_ssEntity) << "100"          << endl;
-        (*m_ssEntity) << "AcDbVertex"   << endl;
+        (*m_ssEntity) << "100"          << '\n';
+        (*m_ssEntity) << "AcDbVertex"   << '\n';
     }
-    (*m_ssEntity) << " 10"          << endl;
-    (*m_ssEntity) << x              << endl;
-    (*m_ssEntity) << " 20"          << endl; 
-    (*m_ssEntity) << y              << endl;
-    (*m_ssEntity) << " 30"          << endl;
-    (*m_ssEntity) << z              << endl;
-    (*m_ssEntity) << " 70"          << endl;
-    (*m_ssEntity) << 0              << endl;
+    (*m_ssEntity) << " 10"          << '\n';
+    (*m_ssEntity) << x              << '\n';
+    (*m_ssEntity) << " 20"          << '\n'; 
+    (*m_ssEntity) << y              << '\n';
+    (*m_ssEntity) << " 30"          << '\n';
+    (*m_ssEntity) << z              << '\n';
+    (*m_ssEntity) << " 70"          << '\n';
+    (*m_ssEntity) << 0              << '\n';
 }
 
 void CDxfWrite::writeText(const char* text, const double* location1, const double* location2,
@@ -958,64 +1045,64 @@ void CDxfWrite::putText(const char* text, const Base::Vector3d location1, const
 {
     (void) location2;
 
-    (*outStream) << "  0"          << endl;
-    (*outStream) << "TEXT"         << endl;
-    (*outStream) << "  5"      << endl;
-    (*outStream) << handle << endl;
+    (*outStream) << "  0"          << '\n';
+    (*outStream) << "TEXT"         << '\n';
+    (*outStream) << "  5"      << '\n';
+    (*outStream) << handle << '\n';
     if (m_version > 12) {
-        (*outStream) << "330"      << endl;
-        (*outStream) << ownerHandle  << endl;
-        (*outStream) << "100"      << endl;
-        (*outStream) << "AcDbEntity"      << endl;
+        (*outStream) << "330"      << '\n';
+        (*outStream) << ownerHandle  << '\n';
+        (*outStream) << "100"      << '\n';
+        (*outStream) << "AcDbEntity"      << '\n';
     }
-    (*outStream) << "  8"          << endl;
-    (*outStream) << getLayerName()     << endl;
+    (*outStream) << "  8"          << '\n';
+    (*outStream) << getLayerName()     << '\n';
     if (m_version > 12) {
-        (*outStream) << "100"          << endl;
-        (*outStream) << "AcDbText"     << endl;
-    }
-//    (*outStream) << " 39"          << endl;
-//    (*outStream) << 0              << endl;     //thickness
-    (*outStream) << " 10"          << endl;     //first alignment point
-    (*outStream) << location1.x    << endl;
-    (*outStream) << " 20"          << endl; 
-    (*outStream) << location1.y    << endl;
-    (*outStream) << " 30"          << endl;
-    (*outStream) << location1.z    << endl;
-    (*outStream) << " 40"          << endl;
-    (*outStream) << height         << endl;
-    (*outStream) << "  1"          << endl;
-    (*outStream) << text           << endl;
-//    (*outStream) << " 50"          << endl;
-//    (*outStream) << 0              << endl;    //rotation
-//    (*outStream) << " 41"          << endl;
-//    (*outStream) << 1              << endl;
-//    (*outStream) << " 51"          << endl;
-//    (*outStream) << 0              << endl;
-
-    (*outStream) << "  7"          << endl;
-    (*outStream) << "STANDARD"     << endl;    //style
-//    (*outStream) << " 71"          << endl;  //default
-//    (*outStream) << "0"            << endl;
-    (*outStream) << " 72"          << endl;
-    (*outStream) << horizJust      << endl;
-////    (*outStream) << " 73"          << endl;
-////    (*outStream) << "0"            << endl;
-    (*outStream) << " 11"          << endl;    //second alignment point
-    (*outStream) << location2.x    << endl;
-    (*outStream) << " 21"          << endl; 
-    (*outStream) << location2.y    << endl;
-    (*outStream) << " 31"          << endl;
-    (*outStream) << location2.z    << endl;
-//    (*outStream) << "210"          << endl;
-//    (*outStream) << "0"            << endl;
-//    (*outStream) << "220"          << endl;
-//    (*outStream) << "0"            << endl;
-//    (*outStream) << "230"          << endl;
-//    (*outStream) << "1"            << endl;
+        (*outStream) << "100"          << '\n';
+        (*outStream) << "AcDbText"     << '\n';
+    }
+//    (*outStream) << " 39"          << '\n';
+//    (*outStream) << 0              << '\n';     //thickness
+    (*outStream) << " 10"          << '\n';     //first alignment point
+    (*outStream) << location1.x    << '\n';
+    (*outStream) << " 20"          << '\n'; 
+    (*outStream) << location1.y    << '\n';
+    (*outStream) << " 30"          << '\n';
+    (*outStream) << location1.z    << '\n';
+    (*outStream) << " 40"          << '\n';
+    (*outStream) << height         << '\n';
+    (*outStream) << "  1"          << '\n';
+    (*outStream) << text           << '\n';
+//    (*outStream) << " 50"          << '\n';
+//    (*outStream) << 0              << '\n';    //rotation
+//    (*outStream) << " 41"          << '\n';
+//    (*outStream) << 1              << '\n';
+//    (*outStream) << " 51"          << '\n';
+//    (*outStream) << 0              << '\n';
+
+    (*outStream) << "  7"          << '\n';
+    (*outStream) << "STANDARD"     << '\n';    //style
+//    (*outStream) << " 71"          << '\n';  //default
+//    (*outStream) << "0"            << '\n';
+    (*outStream) << " 72"          << '\n';
+    (*outStream) << horizJust      << '\n';
+////    (*outStream) << " 73"          << '\n';
+////    (*outStream) << "0"            << '\n';
+    (*outStream) << " 11"          << '\n';    //second alignment point
+    (*outStream) << location2.x    << '\n';
+    (*outStream) << " 21"          << '\n'; 
+    (*outStream) << location2.y    << '\n';
+    (*outStream) << " 31"          << '\n';
+    (*outStream) << location2.z    << '\n';
+//    (*outStream) << "210"          << '\n';
+//    (*outStream) << "0"            << '\n';
+//    (*outStream) << "220"          << '\n';
+//    (*outStream) << "0"            << '\n';
+//    (*outStream) << "230"          << '\n';
+//    (*outStream) << "1"            << '\n';
     if (m_version > 12) {
-        (*outStream) << "100"          << endl;
-        (*outStream) << "AcDbText"     << endl;
+        (*outStream) << "100"          << '\n';
+        (*outStream) << "AcDbText"     << '\n';
     }
     
 }
@@ -1024,48 +1111,48 @@ void CDxfWrite::putArrow(Base::Vector3d arrowPos, Base::Vector3d barb1Pos, Base:
                          std::ostringstream* outStream, const std::string handle,
                          const std::string ownerHandle)
 {
-    (*outStream) << "  0"          << endl;
-    (*outStream) << "SOLID"        << endl;
-    (*outStream) << "  5"          << endl;
-    (*outStream) << handle         << endl;
+    (*outStream) << "  0"          << '\n';
+    (*outStream) << "SOLID"        << '\n';
+    (*outStream) << "  5"          << '\n';
+    (*outStream) << handle         << '\n';
     if (m_version > 12) {
-        (*outStream) << "330"      << endl;
-        (*outStream) << ownerHandle << endl;
-        (*outStream) << "100"      << endl;
-        (*outStream) << "AcDbEntity"      << endl;
-    }
-    (*outStream) << "  8"          << endl;
-    (*outStream) << "0"            << endl;
-    (*outStream) << " 62"          << endl;
-    (*outStream) << "     0"       << endl;
+        (*outStream) << "330"      << '\n';
+        (*outStream) << ownerHandle << '\n';
+        (*outStream) << "100"      << '\n';
+        (*outStream) << "AcDbEntity"      << '\n';
+    }
+    (*outStream) << "  8"          << '\n';
+    (*outStream) << "0"            << '\n';
+    (*outStream) << " 62"          << '\n';
+    (*outStream) << "     0"       << '\n';
     if (m_version > 12) {
-        (*outStream) << "100"      << endl;
-        (*outStream) << "AcDbTrace" << endl;
-    }
-    (*outStream) << " 10"          << endl;
-    (*outStream) << barb1Pos.x     << endl;
-    (*outStream) << " 20"          << endl;
-    (*outStream) << barb1Pos.y     << endl;
-    (*outStream) << " 30"          << endl;
-    (*outStream) << barb1Pos.z     << endl;
-    (*outStream) << " 11"          << endl;
-    (*outStream) << barb2Pos.x     << endl;
-    (*outStream) << " 21"          << endl;
-    (*outStream) << barb2Pos.y     << endl;
-    (*outStream) << " 31"          << endl;
-    (*outStream) << barb2Pos.z     << endl;
-    (*outStream) << " 12"          << endl;
-    (*outStream) << arrowPos.x     << endl;
-    (*outStream) << " 22"          << endl;
-    (*outStream) << arrowPos.y     << endl;
-    (*outStream) << " 32"          << endl;
-    (*outStream) << arrowPos.z     << endl;
-    (*outStream) << " 13"          << endl;
-    (*outStream) << arrowPos.x     << endl;
-    (*outStream) << " 23"          << endl;
-    (*outStream) << arrowPos.y     << endl;
-    (*outStream) << " 33"          << endl;
-    (*outStream) << arrowPos.z     << endl;
+        (*outStream) << "100"      << '\n';
+        (*outStream) << "AcDbTrace" << '\n';
+    }
+    (*outStream) << " 10"          << '\n';
+    (*outStream) << barb1Pos.x     << '\n';
+    (*outStream) << " 20"          << '\n';
+    (*outStream) << barb1Pos.y     << '\n';
+    (*outStream) << " 30"          << '\n';
+    (*outStream) << barb1Pos.z     << '\n';
+    (*outStream) << " 11"          << '\n';
+    (*outStream) << barb2Pos.x     << '\n';
+    (*outStream) << " 21"          << '\n';
+    (*outStream) << barb2Pos.y     << '\n';
+    (*outStream) << " 31"          << '\n';
+    (*outStream) << barb2Pos.z     << '\n';
+    (*outStream) << " 12"          << '\n';
+    (*outStream) << arrowPos.x     << '\n';
+    (*outStream) << " 22"          << '\n';
+    (*outStream) << arrowPos.y     << '\n';
+    (*outStream) << " 32"          << '\n';
+    (*outStream) << arrowPos.z     << '\n';
+    (*outStream) << " 13"          << '\n';
+    (*outStream) << arrowPos.x     << '\n';
+    (*outStream) << " 23"          << '\n';
+    (*outStream) << arrowPos.y     << '\n';
+    (*outStream) << " 33"          << '\n';
+    (*outStream) << arrowPos.z     << '\n';
 }
 
 //***************************
@@ -1078,77 +1165,77 @@ void CDxfWrite::writeLinearDim(const double* textMidPoint, const double* lineDef
                          const double* extLine1, const double* extLine2,
                          const char* dimText, int type)
 {
-    (*m_ssEntity) << "  0"          << endl;
-    (*m_ssEntity) << "DIMENSION"    << endl;
-    (*m_ssEntity) << "  5"      << endl;
-    (*m_ssEntity) << getEntityHandle() << endl;
+    (*m_ssEntity) << "  0"          << '\n';
+    (*m_ssEntity) << "DIMENSION"    << '\n';
+    (*m_ssEntity) << "  5"      << '\n';
+    (*m_ssEntity) << getEntityHandle() << '\n';
     if (m_version > 12) {
-        (*m_ssEntity) << "330"      << endl;
-        (*m_ssEntity) << m_saveModelSpaceHandle  << endl;
-        (*m_ssEntity) << "100"      << endl;
-        (*m_ssEntity) << "AcDbEntity"      << endl;
+        (*m_ssEntity) << "330"      << '\n';
+        (*m_ssEntity) << m_saveModelSpaceHandle  << '\n';
+        (*m_ssEntity) << "100"      << '\n';
+        (*m_ssEntity) << "AcDbEntity"      << '\n';
     }
-    (*m_ssEntity) << "  8"          << endl;
-    (*m_ssEntity) << getLayerName()     << endl;
+    (*m_ssEntity) << "  8"          << '\n';
+    (*m_ssEntity) << getLayerName()     << '\n';
     if (m_version > 12) {
-        (*m_ssEntity) << "100"          << endl;
-        (*m_ssEntity) << "AcDbDimension"     << endl;
-    }
-    (*m_ssEntity) << "  2"          << endl;
-    (*m_ssEntity) << "*" << getLayerName()     << endl;     // blockName
-    (*m_ssEntity) << " 10"          << endl;     //dimension line definition point
-    (*m_ssEntity) << lineDefPoint[0]    << endl;
-    (*m_ssEntity) << " 20"          << endl; 
-    (*m_ssEntity) << lineDefPoint[1]    << endl;
-    (*m_ssEntity) << " 30"          << endl;
-    (*m_ssEntity) << lineDefPoint[2]    << endl;
-    (*m_ssEntity) << " 11"          << endl;     //text mid point
-    (*m_ssEntity) << textMidPoint[0]    << endl;
-    (*m_ssEntity) << " 21"          << endl; 
-    (*m_ssEntity) << textMidPoint[1]    << endl;
-    (*m_ssEntity) << " 31"          << endl;
-    (*m_ssEntity) << textMidPoint[2]    << endl;
+        (*m_ssEntity) << "100"          << '\n';
+        (*m_ssEntity) << "AcDbDimension"     << '\n';
+    }
+    (*m_ssEntity) << "  2"          << '\n';
+    (*m_ssEntity) << "*" << getLayerName()     << '\n';     // blockName
+    (*m_ssEntity) << " 10"          << '\n';     //dimension line definition point
+    (*m_ssEntity) << lineDefPoint[0]    << '\n';
+    (*m_ssEntity) << " 20"          << '\n'; 
+    (*m_ssEntity) << lineDefPoint[1]    << '\n';
+    (*m_ssEntity) << " 30"          << '\n';
+    (*m_ssEntity) << lineDefPoint[2]    << '\n';
+    (*m_ssEntity) << " 11"          << '\n';     //text mid point
+    (*m_ssEntity) << textMidPoint[0]    << '\n';
+    (*m_ssEntity) << " 21"          << '\n'; 
+    (*m_ssEntity) << textMidPoint[1]    << '\n';
+    (*m_ssEntity) << " 31"          << '\n';
+    (*m_ssEntity) << textMidPoint[2]    << '\n';
     if (type == ALIGNED) {
-        (*m_ssEntity) << " 70"          << endl;
-        (*m_ssEntity) << 1              << endl;    // dimType1 = Aligned
+        (*m_ssEntity) << " 70"          << '\n';
+        (*m_ssEntity) << 1              << '\n';    // dimType1 = Aligned
     }
     if ( (type == HORIZONTAL) ||
          (type == VERTICAL) ) {
-        (*m_ssEntity) << " 70"          << endl;
-        (*m_ssEntity) << 32             << endl;  // dimType0 = Aligned + 32 (bit for unique block)?
-    }
-//    (*m_ssEntity) << " 71"          << endl;    // not R12
-//    (*m_ssEntity) << 1              << endl;    // attachPoint ??1 = topleft
-    (*m_ssEntity) << "  1"          << endl;
-    (*m_ssEntity) << dimText        << endl;    
-    (*m_ssEntity) << "  3"          << endl;
-    (*m_ssEntity) << "STANDARD"     << endl;    //style
+        (*m_ssEntity) << " 70"          << '\n';
+        (*m_ssEntity) << 32             << '\n';  // dimType0 = Aligned + 32 (bit for unique block)?
+    }
+//    (*m_ssEntity) << " 71"          << '\n';    // not R12
+//    (*m_ssEntity) << 1              << '\n';    // attachPoint ??1 = topleft
+    (*m_ssEntity) << "  1"          << '\n';
+    (*m_ssEntity) << dimText        << '\n';    
+    (*m_ssEntity) << "  3"          << '\n';
+    (*m_ssEntity) << "STANDARD"     << '\n';    //style
 //linear dims
     if (m_version > 12) {
-        (*m_ssEntity) << "100"          << endl;
-        (*m_ssEntity) << "AcDbAlignedDimension"     << endl;
-    }
-    (*m_ssEntity) << " 13"          << endl;
-    (*m_ssEntity) << extLine1[0]    << endl;
-    (*m_ssEntity) << " 23"          << endl; 
-    (*m_ssEntity) << extLine1[1]    << endl;
-    (*m_ssEntity) << " 33"          << endl;
-    (*m_ssEntity) << extLine1[2]    << endl;
-    (*m_ssEntity) << " 14"          << endl;
-    (*m_ssEntity) << extLine2[0]    << endl;
-    (*m_ssEntity) << " 24"          << endl; 
-    (*m_ssEntity) << extLine2[1]    << endl;
-    (*m_ssEntity) << " 34"          << endl;
-    (*m_ssEntity) << extLine2[2]    << endl;
+        (*m_ssEntity) << "100"          << '\n';
+        (*m_ssEntity) << "AcDbAlignedDimension"     << '\n';
+    }
+    (*m_ssEntity) << " 13"          << '\n';
+    (*m_ssEntity) << extLine1[0]    << '\n';
+    (*m_ssEntity) << " 23"          << '\n'; 
+    (*m_ssEntity) << extLine1[1]    << '\n';
+    (*m_ssEntity) << " 33"          << '\n';
+    (*m_ssEntity) << extLine1[2]    << '\n';
+    (*m_ssEntity) << " 14"          << '\n';
+    (*m_ssEntity) << extLine2[0]    << '\n';
+    (*m_ssEntity) << " 24"          << '\n'; 
+    (*m_ssEntity) << extLine2[1]    << '\n';
+    (*m_ssEntity) << " 34"          << '\n';
+    (*m_ssEntity) << extLine2[2]    << '\n';
     if (m_version > 12) {
         if (type == VERTICAL) {
-            (*m_ssEntity) << " 50"          << endl;
-            (*m_ssEntity) << "90"     << endl;
+            (*m_ssEntity) << " 50"          << '\n';
+            (*m_ssEntity) << "90"     << '\n';
         }
         if ( (type == HORIZONTAL) ||
              (type == VERTICAL) ) {
-            (*m_ssEntity) << "100"          << endl;
-            (*m_ssEntity) << "AcDbRotatedDimension"     << endl;
+            (*m_ssEntity) << "100"          << '\n';
+            (*m_ssEntity) << "AcDbRotatedDimension"     << '\n';
         }
     }
 
@@ -1167,80 +1254,80 @@ void CDxfWrite::writeAngularDim(const double* textMidPoint, const double* lineDe
                          const double* startExt2, const double* endExt2,
                          const char* dimText)
 {
-    (*m_ssEntity) << "  0"          << endl;
-    (*m_ssEntity) << "DIMENSION"    << endl;
-    (*m_ssEntity) << "  5"      << endl;
-    (*m_ssEntity) << getEntityHandle() << endl;
+    (*m_ssEntity) << "  0"          << '\n';
+    (*m_ssEntity) << "DIMENSION"    << '\n';
+    (*m_ssEntity) << "  5"      << '\n';
+    (*m_ssEntity) << getEntityHandle() << '\n';
     if (m_version > 12) {
-        (*m_ssEntity) << "330"      << endl;
-        (*m_ssEntity) << m_saveModelSpaceHandle  << endl;
-        (*m_ssEntity) << "100"      << endl;
-        (*m_ssEntity) << "AcDbEntity"      << endl;
+        (*m_ssEntity) << "330"      << '\n';
+        (*m_ssEntity) << m_saveModelSpaceHandle  << '\n';
+        (*m_ssEntity) << "100"      << '\n';
+        (*m_ssEntity) << "AcDbEntity"      << '\n';
     }
-    (*m_ssEntity) << "  8"          << endl;
-    (*m_ssEntity) << getLayerName()     << endl;
+    (*m_ssEntity) << "  8"          << '\n';
+    (*m_ssEntity) << getLayerName()     << '\n';
     if (m_version > 12) {
-        (*m_ssEntity) << "100"          << endl;
-        (*m_ssEntity) << "AcDbDimension"     << endl;
-    }
-    (*m_ssEntity) << "  2"          << endl;
-    (*m_ssEntity) << "*" << getLayerName()     << endl;     // blockName
-
-    (*m_ssEntity) << " 10"          << endl;
-    (*m_ssEntity) << endExt2[0]     << endl;
-    (*m_ssEntity) << " 20"          << endl; 
-    (*m_ssEntity) << endExt2[1]     << endl;
-    (*m_ssEntity) << " 30"          << endl;
-    (*m_ssEntity) << endExt2[2]     << endl;
-
-    (*m_ssEntity) << " 11"          << endl;
-    (*m_ssEntity) << textMidPoint[0]  << endl;
-    (*m_ssEntity) << " 21"          << endl; 
-    (*m_ssEntity) << textMidPoint[1]  << endl;
-    (*m_ssEntity) << " 31"          << endl;
-    (*m_ssEntity) << textMidPoint[2]  << endl;
-
-    (*m_ssEntity) << " 70"          << endl;
-    (*m_ssEntity) << 2             << endl;    // dimType 2 = Angular  5 = Angular 3 point
+        (*m_ssEntity) << "100"          << '\n';
+        (*m_ssEntity) << "AcDbDimension"     << '\n';
+    }
+    (*m_ssEntity) << "  2"          << '\n';
+    (*m_ssEntity) << "*" << getLayerName()     << '\n';     // blockName
+
+    (*m_ssEntity) << " 10"          << '\n';
+    (*m_ssEntity) << endExt2[0]     << '\n';
+    (*m_ssEntity) << " 20"          << '\n'; 
+    (*m_ssEntity) << endExt2[1]     << '\n';
+    (*m_ssEntity) << " 30"          << '\n';
+    (*m_ssEntity) << endExt2[2]     << '\n';
+
+    (*m_ssEntity) << " 11"          << '\n';
+    (*m_ssEntity) << textMidPoint[0]  << '\n';
+    (*m_ssEntity) << " 21"          << '\n'; 
+    (*m_ssEntity) << textMidPoint[1]  << '\n';
+    (*m_ssEntity) << " 31"          << '\n';
+    (*m_ssEntity) << textMidPoint[2]  << '\n';
+
+    (*m_ssEntity) << " 70"          << '\n';
+    (*m_ssEntity) << 2             << '\n';    // dimType 2 = Angular  5 = Angular 3 point
                                            // +32 for block?? (not R12)
-//    (*m_ssEntity) << " 71"          << endl;    // not R12?  not required?
-//    (*m_ssEntity) << 5              << endl;    // attachPoint 5 = middle
-    (*m_ssEntity) << "  1"          << endl;
-    (*m_ssEntity) << dimText        << endl;    
-    (*m_ssEntity) << "  3"          << endl;
-    (*m_ssEntity) << "STANDARD"     << endl;    //style
+//    (*m_ssEntity) << " 71"          << '\n';    // not R12?  not required?
+//    (*m_ssEntity) << 5              << '\n';    // attachPoint 5 = middle
+    (*m_ssEntity) << "  1"          << '\n';
+    (*m_ssEntity) << dimText        << '\n';    
+    (*m_ssEntity) << "  3"          << '\n';
+    (*m_ssEntity) << "STANDARD"     << '\n';    //style
 //angular dims
     if (m_version > 12) {
-        (*m_ssEntity) << "100"          << endl;
-        (*m_ssEntity) << "AcDb2LineAngularDimension"     << endl;
-    }
-    (*m_ssEntity) << " 13"           << endl;
-    (*m_ssEntity) << startExt1[0]    << endl;
-    (*m_ssEntity) << " 23"           << endl; 
-    (*m_ssEntity) << startExt1[1]    << endl;
-    (*m_ssEntity) << " 33"           << endl;
-    (*m_ssEntity) << startExt1[2]    << endl;
-
-    (*m_ssEntity) << " 14"           << endl;
-    (*m_ssEntity) << endExt1[0]      << endl;
-    (*m_ssEntity) << " 24"           << endl; 
-    (*m_ssEntity) << endExt1[1]      << endl;
-    (*m_ssEntity) << " 34"           << endl;
-    (*m_ssEntity) << endExt1[2]      << endl;
-
-    (*m_ssEntity) << " 15"           << endl;
-    (*m_ssEntity) << startExt2[0]    << endl;
-    (*m_ssEntity) << " 25"           << endl; 
-    (*m_ssEntity) << startExt2[1]    << endl;
-    (*m_ssEntity) << " 35"           << endl;
-    (*m_ssEntity) << startExt2[2]    << endl;
-
-    (*m_ssEntity) << " 16"           << endl;
-    (*m_ssEntity) << lineDefPoint[0] << endl;
-    (*m_ssEntity) << " 26"           << endl; 
-    (*m_ssEntity) << lineDefPoint[1] << endl;
-    (*m_ssEntity) << " 36"           << endl;
-    (*m_ssEntity) << lineDefPoint[2] << endl;
+        (*m_ssEntity) << "100"          << '\n';
+        (*m_ssEntity) << "AcDb2LineAngularDimension"     << '\n';
+    }
+    (*m_ssEntity) << " 13"           << '\n';
+    (*m_ssEntity) << startExt1[0]    << '\n';
+    (*m_ssEntity) << " 23"           << '\n'; 
+    (*m_ssEntity) << startExt1[1]    << '\n';
+    (*m_ssEntity) << " 33"           << '\n';
+    (*m_ssEntity) << startExt1[2]    << '\n';
+
+    (*m_ssEntity) << " 14"           << '\n';
+    (*m_ssEntity) << endExt1[0]      << '\n';
+    (*m_ssEntity) << " 24"           << '\n'; 
+    (*m_ssEntity) << endExt1[1]      << '\n';
+    (*m_ssEntity) << " 34"           << '\n';
+    (*m_ssEntity) << endExt1[2]      << '\n';
+
+    (*m_ssEntity) << " 15"           << '\n';
+    (*m_ssEntity) << startExt2[0]    << '\n';
+    (*m_ssEntity) << " 25"           << '\n'; 
+    (*m_ssEntity) << startExt2[1]    << '\n';
+    (*m_ssEntity) << " 35"           << '\n';
+    (*m_ssEntity) << startExt2[2]    << '\n';
+
+    (*m_ssEntity) << " 16"           << '\n';
+    (*m_ssEntity) << lineDefPoint[0] << '\n';
+    (*m_ssEntity) << " 26"           << '\n'; 
+    (*m_ssEntity) << lineDefPoint[1] << '\n';
+    (*m_ssEntity) << " 36"           << '\n';
+    (*m_ssEntity) << lineDefPoint[2] << '\n';
     writeDimBlockPreamble();
     writeAngularDimBlock(textMidPoint, lineDefPoint,
                          startExt1, endExt1,
@@ -1256,57 +1343,57 @@ void CDxfWrite::writeRadialDim(const double* centerPoint, const double* textMidP
                          const double* arcPoint,
                          const char* dimText)
 {
-    (*m_ssEntity) << "  0"          << endl;
-    (*m_ssEntity) << "DIMENSION"    << endl;
-    (*m_ssEntity) << "  5"      << endl;
-    (*m_ssEntity) << getEntityHandle() << endl;
+    (*m_ssEntity) << "  0"          << '\n';
+    (*m_ssEntity) << "DIMENSION"    << '\n';
+    (*m_ssEntity) << "  5"      << '\n';
+    (*m_ssEntity) << getEntityHandle() << '\n';
     if (m_version > 12) {
-        (*m_ssEntity) << "330"      << endl;
-        (*m_ssEntity) << m_saveModelSpaceHandle  << endl;
-        (*m_ssEntity) << "100"      << endl;
-        (*m_ssEntity) << "AcDbEntity"      << endl;
+        (*m_ssEntity) << "330"      << '\n';
+        (*m_ssEntity) << m_saveModelSpaceHandle  << '\n';
+        (*m_ssEntity) << "100"      << '\n';
+        (*m_ssEntity) << "AcDbEntity"      << '\n';
     }
-    (*m_ssEntity) << "  8"          << endl;
-    (*m_ssEntity) << getLayerName()     << endl;
+    (*m_ssEntity) << "  8"          << '\n';
+    (*m_ssEntity) << getLayerName()     << '\n';
     if (m_version > 12) {
-        (*m_ssEntity) << "100"          << endl;
-        (*m_ssEntity) << "AcDbDimension"     << endl;
-    }
-    (*m_ssEntity) << "  2"          << endl;
-    (*m_ssEntity) << "*" << getLayerName()     << endl;     // blockName
-    (*m_ssEntity) << " 10"          << endl;     // arc center point
-    (*m_ssEntity) << centerPoint[0] << endl;
-    (*m_ssEntity) << " 20"          << endl; 
-    (*m_ssEntity) << centerPoint[1] << endl;
-    (*m_ssEntity) << " 30"          << endl;
-    (*m_ssEntity) << centerPoint[2] << endl;
-    (*m_ssEntity) << " 11"          << endl;     //text mid point
-    (*m_ssEntity) << textMidPoint[0]   << endl;
-    (*m_ssEntity) << " 21"          << endl; 
-    (*m_ssEntity) << textMidPoint[1]   << endl;
-    (*m_ssEntity) << " 31"          << endl;
-    (*m_ssEntity) << textMidPoint[2]   << endl;
-    (*m_ssEntity) << " 70"          << endl;
-    (*m_ssEntity) << 4              << endl;    // dimType 4 = Radius
-//    (*m_ssEntity) << " 71"          << endl;    // not R12
-//    (*m_ssEntity) << 1              << endl;    // attachPoint 5 = middle center
-    (*m_ssEntity) << "  1"          << endl;
-    (*m_ssEntity) << dimText        << endl;    
-    (*m_ssEntity) << "  3"          << endl;
-    (*m_ssEntity) << "STANDARD"     << endl;    //style
+        (*m_ssEntity) << "100"          << '\n';
+        (*m_ssEntity) << "AcDbDimension"     << '\n';
+    }
+    (*m_ssEntity) << "  2"          << '\n';
+    (*m_ssEntity) << "*" << getLayerName()     << '\n';     // blockName
+    (*m_ssEntity) << " 10"          << '\n';     // arc center point
+    (*m_ssEntity) << centerPoint[0] << '\n';
+    (*m_ssEntity) << " 20"          << '\n'; 
+    (*m_ssEntity) << centerPoint[1] << '\n';
+    (*m_ssEntity) << " 30"          << '\n';
+    (*m_ssEntity) << centerPoint[2] << '\n';
+    (*m_ssEntity) << " 11"          << '\n';     //text mid point
+    (*m_ssEntity) << textMidPoint[0]   << '\n';
+    (*m_ssEntity) << " 21"          << '\n'; 
+    (*m_ssEntity) << textMidPoint[1]   << '\n';
+    (*m_ssEntity) << " 31"          << '\n';
+    (*m_ssEntity) << textMidPoint[2]   << '\n';
+    (*m_ssEntity) << " 70"          << '\n';
+    (*m_ssEntity) << 4              << '\n';    // dimType 4 = Radius
+//    (*m_ssEntity) << " 71"          << '\n';    // not R12
+//    (*m_ssEntity) << 1              << '\n';    // attachPoint 5 = middle center
+    (*m_ssEntity) << "  1"          << '\n';
+    (*m_ssEntity) << dimText        << '\n';    
+    (*m_ssEntity) << "  3"          << '\n';
+    (*m_ssEntity) << "STANDARD"     << '\n';    //style
 //radial dims
     if (m_version > 12) {
-        (*m_ssEntity) << "100"          << endl;
-        (*m_ssEntity) << "AcDbRadialDimension"     << endl;
-    }
-    (*m_ssEntity) << " 15"          << endl;
-    (*m_ssEntity) << arcPoint[0]    << endl;
-    (*m_ssEntity) << " 25"          << endl; 
-    (*m_ssEntity) << arcPoint[1]    << endl;
-    (*m_ssEntity) << " 35"          << endl;
-    (*m_ssEntity) << arcPoint[2]    << endl;
-    (*m_ssEntity) << " 40"          << endl;   // leader length????
-    (*m_ssEntity) << 0              << endl;
+        (*m_ssEntity) << "100"          << '\n';
+        (*m_ssEntity) << "AcDbRadialDimension"     << '\n';
+    }
+    (*m_ssEntity) << " 15"          << '\n';
+    (*m_ssEntity) << arcPoint[0]    << '\n';
+    (*m_ssEntity) << " 25"          << '\n'; 
+    (*m_ssEntity) << arcPoint[1]    << '\n';
+    (*m_ssEntity) << " 35"          << '\n';
+    (*m_ssEntity) << arcPoint[2]    << '\n';
+    (*m_ssEntity) << " 40"          << '\n';   // leader length????
+    (*m_ssEntity) << 0              << '\n';
 
     writeDimBlockPreamble();
     writeRadialDimBlock(centerPoint, textMidPoint, arcPoint, dimText);
@@ -1320,57 +1407,57 @@ void CDxfWrite::writeDiametricDim(const double* textMidPoint,
                          const double* arcPoint1, const double* arcPoint2,
                          const char* dimText)
 {
-    (*m_ssEntity) << "  0"          << endl;
-    (*m_ssEntity) << "DIMENSION"    << endl;
-    (*m_ssEntity) << "  5"      << endl;
-    (*m_ssEntity) << getEntityHandle() << endl;
+    (*m_ssEntity) << "  0"          << '\n';
+    (*m_ssEntity) << "DIMENSION"    << '\n';
+    (*m_ssEntity) << "  5"      << '\n';
+    (*m_ssEntity) << getEntityHandle() << '\n';
     if (m_version > 12) {
-        (*m_ssEntity) << "330"      << endl;
-        (*m_ssEntity) << m_saveModelSpaceHandle  << endl;
-        (*m_ssEntity) << "100"      << endl;
-        (*m_ssEntity) << "AcDbEntity"      << endl;
+        (*m_ssEntity) << "330"      << '\n';
+        (*m_ssEntity) << m_saveModelSpaceHandle  << '\n';
+        (*m_ssEntity) << "100"      << '\n';
+        (*m_ssEntity) << "AcDbEntity"      << '\n';
     }
-    (*m_ssEntity) << "  8"          << endl;
-    (*m_ssEntity) << getLayerName()     << endl;
+    (*m_ssEntity) << "  8"          << '\n';
+    (*m_ssEntity) << getLayerName()     << '\n';
     if (m_version > 12) {
-        (*m_ssEntity) << "100"          << endl;
-        (*m_ssEntity) << "AcDbDimension"     << endl;
-    }
-    (*m_ssEntity) << "  2"          << endl;
-    (*m_ssEntity) << "*" << getLayerName()     << endl;     // blockName
-    (*m_ssEntity) << " 10"          << endl;
-    (*m_ssEntity) << arcPoint1[0]   << endl;
-    (*m_ssEntity) << " 20"          << endl; 
-    (*m_ssEntity) << arcPoint1[1]   << endl;
-    (*m_ssEntity) << " 30"          << endl;
-    (*m_ssEntity) << arcPoint1[2]   << endl;
-    (*m_ssEntity) << " 11"          << endl;     //text mid point
-    (*m_ssEntity) << textMidPoint[0]   << endl;
-    (*m_ssEntity) << " 21"          << endl; 
-    (*m_ssEntity) << textMidPoint[1]   << endl;
-    (*m_ssEntity) << " 31"          << endl;
-    (*m_ssEntity) << textMidPoint[2]   << endl;
-    (*m_ssEntity) << " 70"          << endl;
-    (*m_ssEntity) << 3              << endl;    // dimType 3 = Diameter
-//    (*m_ssEntity) << " 71"          << endl;    // not R12
-//    (*m_ssEntity) << 5              << endl;    // attachPoint 5 = middle center
-    (*m_ssEntity) << "  1"          << endl;
-    (*m_ssEntity) << dimText        << endl;    
-    (*m_ssEntity) << "  3"          << endl;
-    (*m_ssEntity) << "STANDARD"     << endl;    //style
+        (*m_ssEntity) << "100"          << '\n';
+        (*m_ssEntity) << "AcDbDimension"     << '\n';
+    }
+    (*m_ssEntity) << "  2"          << '\n';
+    (*m_ssEntity) << "*" << getLayerName()     << '\n';     // blockName
+    (*m_ssEntity) << " 10"          << '\n';
+    (*m_ssEntity) << arcPoint1[0]   << '\n';
+    (*m_ssEntity) << " 20"          << '\n'; 
+    (*m_ssEntity) << arcPoint1[1]   << '\n';
+    (*m_ssEntity) << " 30"          << '\n';
+    (*m_ssEntity) << arcPoint1[2]   << '\n';
+    (*m_ssEntity) << " 11"          << '\n';     //text mid point
+    (*m_ssEntity) << textMidPoint[0]   << '\n';
+    (*m_ssEntity) << " 21"          << '\n'; 
+    (*m_ssEntity) << textMidPoint[1]   << '\n';
+    (*m_ssEntity) << " 31"          << '\n';
+    (*m_ssEntity) << textMidPoint[2]   << '\n';
+    (*m_ssEntity) << " 70"          << '\n';
+    (*m_ssEntity) << 3              << '\n';    // dimType 3 = Diameter
+//    (*m_ssEntity) << " 71"          << '\n';    // not R12
+//    (*m_ssEntity) << 5              << '\n';    // attachPoint 5 = middle center
+    (*m_ssEntity) << "  1"          << '\n';
+    (*m_ssEntity) << dimText        << '\n';    
+    (*m_ssEntity) << "  3"          << '\n';
+    (*m_ssEntity) << "STANDARD"     << '\n';    //style
 //diametric dims
     if (m_version > 12) {
-        (*m_ssEntity) << "100"          << endl;
-        (*m_ssEntity) << "AcDbDiametricDimension"     << endl;
-    }
-    (*m_ssEntity) << " 15"          << endl;
-    (*m_ssEntity) << arcPoint2[0]   << endl;
-    (*m_ssEntity) << " 25"          << endl; 
-    (*m_ssEntity) << arcPoint2[1]   << endl;
-    (*m_ssEntity) << " 35"          << endl;
-    (*m_ssEntity) << arcPoint2[2]   << endl;
-    (*m_ssEntity) << " 40"          << endl;   // leader length????
-    (*m_ssEntity) << 0              << endl;
+        (*m_ssEntity) << "100"          << '\n';
+        (*m_ssEntity) << "AcDbDiametricDimension"     << '\n';
+    }
+    (*m_ssEntity) << " 15"          << '\n';
+    (*m_ssEntity) << arcPoint2[0]   << '\n';
+    (*m_ssEntity) << " 25"          << '\n'; 
+    (*m_ssEntity) << arcPoint2[1]   << '\n';
+    (*m_ssEntity) << " 35"          << '\n';
+    (*m_ssEntity) << arcPoint2[2]   << '\n';
+    (*m_ssEntity) << " 40"          << '\n';   // leader length????
+    (*m_ssEntity) << 0              << '\n';
 
     writeDimBlockPreamble();
     writeDiametricDimBlock(textMidPoint, arcPoint1, arcPoint2, dimText);
@@ -1390,36 +1477,36 @@ void CDxfWrite::writeDimBlockPreamble(void)
     }
 
     m_currentBlock = getBlockHandle();
-    (*m_ssBlock) << "  0"          << endl;
-    (*m_ssBlock) << "BLOCK"        << endl;
-    (*m_ssBlock) << "  5"      << endl;
-    (*m_ssBlock) << m_currentBlock << endl;
+    (*m_ssBlock) << "  0"          << '\n';
+    (*m_ssBlock) << "BLOCK"        << '\n';
+    (*m_ssBlock) << "  5"      << '\n';
+    (*m_ssBlock) << m_currentBlock << '\n';
     if (m_version > 12) {
-        (*m_ssBlock) << "330"      << endl;
-        (*m_ssBlock) << m_saveBlkRecordHandle << endl;
-        (*m_ssBlock) << "100"      << endl;
-        (*m_ssBlock) << "AcDbEntity"      << endl;
+        (*m_ssBlock) << "330"      << '\n';
+        (*m_ssBlock) << m_saveBlkRecordHandle << '\n';
+        (*m_ssBlock) << "100"      << '\n';
+        (*m_ssBlock) << "AcDbEntity"      << '\n';
     }
-    (*m_ssBlock) << "  8"          << endl;
-    (*m_ssBlock) << getLayerName() << endl;
+    (*m_ssBlock) << "  8"          << '\n';
+    (*m_ssBlock) << getLayerName() << '\n';
     if (m_version > 12) {
-        (*m_ssBlock) << "100"          << endl;
-        (*m_ssBlock) << "AcDbBlockBegin"  << endl;
-    }
-    (*m_ssBlock) << "  2"          << endl;
-    (*m_ssBlock) << "*" << getLayerName()     << endl;     // blockName
-    (*m_ssBlock) << " 70"          << endl;
-    (*m_ssBlock) << "   1"         << endl;
-    (*m_ssBlock) << " 10"          << endl;
-    (*m_ssBlock) << 0.0            << endl;
-    (*m_ssBlock) << " 20"          << endl; 
-    (*m_ssBlock) << 0.0            << endl;
-    (*m_ssBlock) << " 30"          << endl;
-    (*m_ssBlock) << 0.0            << endl;
-    (*m_ssBlock) << "  3"          << endl;
-    (*m_ssBlock) << "*" << getLayerName()     << endl;     // blockName
-    (*m_ssBlock) << "  1"          << endl;
-    (*m_ssBlock) << " "            << endl;
+        (*m_ssBlock) << "100"          << '\n';
+        (*m_ssBlock) << "AcDbBlockBegin"  << '\n';
+    }
+    (*m_ssBlock) << "  2"          << '\n';
+    (*m_ssBlock) << "*" << getLayerName()     << '\n';     // blockName
+    (*m_ssBlock) << " 70"          << '\n';
+    (*m_ssBlock) << "   1"         << '\n';
+    (*m_ssBlock) << " 10"          << '\n';
+    (*m_ssBlock) << 0.0            << '\n';
+    (*m_ssBlock) << " 20"          << '\n'; 
+    (*m_ssBlock) << 0.0            << '\n';
+    (*m_ssBlock) << " 30"          << '\n';
+    (*m_ssBlock) << 0.0            << '\n';
+    (*m_ssBlock) << "  3"          << '\n';
+    (*m_ssBlock) << "*" << getLayerName()     << '\n';     // blockName
+    (*m_ssBlock) << "  1"          << '\n';
+    (*m_ssBlock) << " "            << '\n';
 }
 
 //***************************
@@ -1427,23 +1514,23 @@ void CDxfWrite::writeDimBlockPreamble(void)
 //added by Wandererfan 2018 (wandererfan@gmail.com) for FreeCAD project
 void CDxfWrite::writeBlockTrailer(void)
 {
-    (*m_ssBlock) << "  0"    << endl;
-    (*m_ssBlock) << "ENDBLK" << endl;
-    (*m_ssBlock) << "  5"      << endl;
-    (*m_ssBlock) << getBlockHandle() << endl;
+    (*m_ssBlock) << "  0"    << '\n';
+    (*m_ssBlock) << "ENDBLK" << '\n';
+    (*m_ssBlock) << "  5"      << '\n';
+    (*m_ssBlock) << getBlockHandle() << '\n';
     if (m_version > 12) {
-        (*m_ssBlock) << "330"    << endl;
-        (*m_ssBlock) << m_saveBlkRecordHandle    << endl;
-        (*m_ssBlock) << "100"    << endl;
-        (*m_ssBlock) << "AcDbEntity"    << endl;
-    }
-//    (*m_ssBlock) << " 67"    << endl;
-//    (*m_ssBlock) << "1"    << endl;
-    (*m_ssBlock) << "  8"    << endl;
-    (*m_ssBlock) << getLayerName() << endl;
+        (*m_ssBlock) << "330"    << '\n';
+        (*m_ssBlock) << m_saveBlkRecordHandle    << '\n';
+        (*m_ssBlock) << "100"    << '\n';
+        (*m_ssBlock) << "AcDbEntity"    << '\n';
+    }
+//    (*m_ssBlock) << " 67"    << '\n';
+//    (*m_ssBlock) << "1"    << '\n';
+    (*m_ssBlock) << "  8"    << '\n';
+    (*m_ssBlock) << getLayerName() << '\n';
     if (m_version > 12) {
-        (*m_ssBlock) << "100"    << endl;
-        (*m_ssBlock) << "AcDbBlockEnd"    << endl;
+        (*m_ssBlock) << "100"    << '\n';
+        (*m_ssBlock) << "AcDbBlockEnd"    << '\n';
     }
 }
 
@@ -1565,40 +1652,40 @@ void CDxfWrite::writeAngularDimBlock(const double* textMidPoint, const double* l
     Base::Vector3d linePt(lineDefPoint[0],lineDefPoint[1],lineDefPoint[2]);
     double radius = (e2S - linePt).Length();
 
-    (*m_ssBlock) << "  0"          << endl;
-    (*m_ssBlock) << "ARC"          << endl;       //dimline arc
-    (*m_ssBlock) << "  5"          << endl;
-    (*m_ssBlock) << getBlockHandle() << endl;
+    (*m_ssBlock) << "  0"          << '\n';
+    (*m_ssBlock) << "ARC"          << '\n';       //dimline arc
+    (*m_ssBlock) << "  5"          << '\n';
+    (*m_ssBlock) << getBlockHandle() << '\n';
     if (m_version > 12) {
-        (*m_ssBlock) << "330"      << endl;
-        (*m_ssBlock) << m_saveBlkRecordHandle << endl;
-        (*m_ssBlock) << "100"      << endl;
-        (*m_ssBlock) << "AcDbEntity"      << endl;
-    }
-    (*m_ssBlock) << "  8"          << endl;
-    (*m_ssBlock) << "0"            << endl;
-//    (*m_ssBlock) << " 62"          << endl;
-//    (*m_ssBlock) << "     0"       << endl;
+        (*m_ssBlock) << "330"      << '\n';
+        (*m_ssBlock) << m_saveBlkRecordHandle << '\n';
+        (*m_ssBlock) << "100"      << '\n';
+        (*m_ssBlock) << "AcDbEntity"      << '\n';
+    }
+    (*m_ssBlock) << "  8"          << '\n';
+    (*m_ssBlock) << "0"            << '\n';
+//    (*m_ssBlock) << " 62"          << '\n';
+//    (*m_ssBlock) << "     0"       << '\n';
     if (m_version > 12) {
-        (*m_ssBlock) << "100"      << endl;
-        (*m_ssBlock) << "AcDbCircle" << endl;
-    }
-    (*m_ssBlock) << " 10"          << endl;
-    (*m_ssBlock) << startExt2[0]   << endl;      //arc center
-    (*m_ssBlock) << " 20"          << endl;
-    (*m_ssBlock) << startExt2[1]   << endl;
-    (*m_ssBlock) << " 30"          << endl;
-    (*m_ssBlock) << startExt2[2]   << endl;
-    (*m_ssBlock) << " 40"          << endl;
-    (*m_ssBlock) << radius         << endl;      //radius
+        (*m_ssBlock) << "100"      << '\n';
+        (*m_ssBlock) << "AcDbCircle" << '\n';
+    }
+    (*m_ssBlock) << " 10"          << '\n';
+    (*m_ssBlock) << startExt2[0]   << '\n';      //arc center
+    (*m_ssBlock) << " 20"          << '\n';
+    (*m_ssBlock) << startExt2[1]   << '\n';
+    (*m_ssBlock) << " 30"          << '\n';
+    (*m_ssBlock) << startExt2[2]   << '\n';
+    (*m_ssBlock) << " 40"          << '\n';
+    (*m_ssBlock) << radius         << '\n';      //radius
     if (m_version > 12) {
-        (*m_ssBlock) << "100"      << endl;
-        (*m_ssBlock) << "AcDbArc" << endl;
+        (*m_ssBlock) << "100"      << '\n';
+        (*m_ssBlock) << "AcDbArc" << '\n';
     }
-    (*m_ssBlock) << " 50"          << endl;
-    (*m_ssBlock) << startAngle     << endl;            //start angle
-    (*m_ssBlock) << " 51"          << endl;
-    (*m_ssBlock) << endAngle       << endl;            //end angle
+    (*m_ssBlock) << " 50"          << '\n';
+    (*m_ssBlock) << startAngle     << '\n';            //start angle
+    (*m_ssBlock) << " 51"          << '\n';
+    (*m_ssBlock) << endAngle       << '\n';            //end angle
 
     putText(dimText,toVector3d(textMidPoint), toVector3d(textMidPoint),3.5,1,
             m_ssBlock,getBlockHandle(),m_saveBlkRecordHandle);
@@ -1710,8 +1797,8 @@ void CDxfWrite::writeBlocksSection(void)
     //write blocks content
     (*m_ofs) << (*m_ssBlock).str();
 
-    (*m_ofs) << "  0"      << endl;
-    (*m_ofs) << "ENDSEC"   << endl;
+    (*m_ofs) << "  0"      << '\n';
+    (*m_ofs) << "ENDSEC"   << '\n';
 }
 
 //***************************
@@ -1728,8 +1815,8 @@ void CDxfWrite::writeEntitiesSection(void)
     (*m_ofs) << (*m_ssEntity).str();
     
 
-    (*m_ofs) << "  0"      << endl;
-    (*m_ofs) << "ENDSEC"   << endl;
+    (*m_ofs) << "  0"      << '\n';
+    (*m_ofs) << "ENDSEC"   << '\n';
 }
 
 //***************************
@@ -1747,6 +1834,19 @@ void CDxfWrite::writeObjectsSection(void)
 }
 
 CDxfRead::CDxfRead(const char* filepath)
+    : CDxfRead(nullptr, 0)
+{
+    ifstream ifs(filepath, ios::binary);
+    if(!ifs){
+        m_fail = true;
+        return;
+    }
+
+    m_data_owned.assign(istreambuf_iterator<char>(ifs), istreambuf_iterator<char>());
+    SetInput(m_data_owned.data(), m_data_owned.size());
+}
+
+CDxfRead::CDxfRead(const char* data, size_t size)
 {
     // start the file
     memset( m_str, '\0', sizeof(m_str) );
@@ -1760,18 +1860,25 @@ CDxfRead::CDxfRead(const char* filepath)
     memset( m_block_name, '\0', sizeof(m_block_name) );
     m_ignore_errors = true;
 
-    m_ifs = new ifstream(filepath);
-    if(!(*m_ifs)){
-        m_fail = true;
-        return;
-    }
-    m_ifs->imbue(std::locale("C"));
-
+    SetInput(data, size);
 }
 
 CDxfRead::~CDxfRead()
 {
-    delete m_ifs;
+}
+
+void CDxfRead::SetInput(const char* data, size_t size)
+{
+    m_data_pos = data;
+    m_data_end = data + size;
+    m_binary = size >= sizeof(binary_dxf_sentinel)
+            && memcmp(data, binary_dxf_sentinel, sizeof(binary_dxf_sentinel)) == 0;
+    if (m_binary) {
+        m_data_pos += sizeof(binary_dxf_sentinel);
+        // First group is (0, "SECTION"), its code is either a single byte(R12) or a 16-bit word
+        m_binary_code16 = !(m_data_end - m_data_pos >= 2 && m_data_pos[0] == 0 && m_data_pos[1] == 'S');
+        m_binary_next_is_code = true;
+    }
 }
 
 double CDxfRead::mm( double value ) const
@@ -1815,19 +1922,17 @@ bool CDxfRead::ReadLine()
     double e[3] = {0, 0, 0};
     bool hidden = false;
 
-    while(!((*m_ifs).eof()))
+    while(!eof())
     {
         get_line();
         int n;
 
-        if(sscanf(m_str, "%d", &n) != 1)
+        if(!ParseValue(n))
         {
             this->ReportError_readInteger("DXF::ReadLine()");
             return false;
         }
 
-        std::istringstream ss;
-        ss.imbue(std::locale("C"));
         switch(n){
             case 0:
                 // next item found, so finish with line
@@ -1849,37 +1954,43 @@ bool CDxfRead::ReadLine()
             case 10:
                 // start x
                 get_line();
-                ss.str(m_str); ss >> s[0]; s[0] = mm(s[0]); if(ss.fail()) return false;
+                if(!ParseValue(s[0])) return false;
+                s[0] = mm(s[0]);
                 break;
             case 20:
                 // start y
                 get_line();
-                ss.str(m_str); ss >> s[1]; s[1] = mm(s[1]); if(ss.fail()) return false;
+                if(!ParseValue(s[1])) return false;
+                s[1] = mm(s[1]);
                 break;
             case 30:
                 // start z
                 get_line();
-                ss.str(m_str); ss >> s[2]; s[2] = mm(s[2]); if(ss.fail()) return false;
+                if(!ParseValue(s[2])) return false;
+                s[2] = mm(s[2]);
                 break;
             case 11:
                 // end x
                 get_line();
-                ss.str(m_str); ss >> e[0]; e[0] = mm(e[0]); if(ss.fail()) return false;
+                if(!ParseValue(e[0])) return false;
+                e[0] = mm(e[0]);
                 break;
             case 21:
                 // end y
                 get_line();
-                ss.str(m_str); ss >> e[1]; e[1] = mm(e[1]); if(ss.fail()) return false;
+                if(!ParseValue(e[1])) return false;
+                e[1] = mm(e[1]);
                 break;
             case 31:
                 // end z
                 get_line();
-                ss.str(m_str); ss >> e[2]; e[2] = mm(e[2]); if(ss.fail()) return false;
+                if(!ParseValue(e[2])) return false;
+                e[2] = mm(e[2]);
                 break;
                 case 62:
                 // color index
                 get_line();
-                ss.str(m_str); ss >> m_aci; if(ss.fail()) return false;
+                if(!ParseValue(m_aci)) return false;
                 break;
 
             case 100:
@@ -1913,19 +2024,17 @@ bool CDxfRead::ReadPoint()
 {
     double s[3] = {0, 0, 0};
 
-    while(!((*m_ifs).eof()))
+    while(!eof())
     {
         get_line();
         int n;
 
-        if(sscanf(m_str, "%d", &n) != 1)
+        if(!ParseValue(n))
         {
             this->ReportError_readInteger("DXF::ReadPoint()");
             return false;
         }
 
-        std::istringstream ss;
-        ss.imbue(std::locale("C"));
         switch(n){
             case 0:
                 // next item found, so finish with line
@@ -1941,23 +2050,26 @@ bool CDxfRead::ReadPoint()
             case 10:
                 // start x
                 get_line();
-                ss.str(m_str); ss >> s[0]; s[0] = mm(s[0]); if(ss.fail()) return false;
+                if(!ParseValue(s[0])) return false;
+                s[0] = mm(s[0]);
                 break;
             case 20:
                 // start y
                 get_line();
-                ss.str(m_str); ss >> s[1]; s[1] = mm(s[1]); if(ss.fail()) return false;
+                if(!ParseValue(s[1])) return false;
+                s[1] = mm(s[1]);
                 break;
             case 30:
                 // start z
                 get_line();
-                ss.str(m_str); ss >> s[2]; s[2] = mm(s[2]); if(ss.fail()) return false;
+                if(!ParseValue(s[2])) return false;
+                s[2] = mm(s[2]);
                 break;
 
                 case 62:
                 // color index
                 get_line();
-                ss.str(m_str); ss >> m_aci; if(ss.fail()) return false;
+                if(!ParseValue(m_aci)) return false;
                 break;
 
             case 100:
@@ -1997,18 +2109,16 @@ bool CDxfRead::ReadArc()
     double z_extrusion_dir = 1.0;
     bool hidden = false;
     
-    while(!((*m_ifs).eof()))
+    while(!eof())
     {
         get_line();
         int n;
-        if(sscanf(m_str, "%d", &n) != 1)
+        if(!ParseValue(n))
         {
             this->ReportError_readInteger("DXF::ReadArc()");
             return false;
         }
 
-        std::istringstream ss;
-        ss.imbue(std::locale("C"));
         switch(n){
             case 0:
                 // next item found, so finish with arc
@@ -2030,37 +2140,41 @@ bool CDxfRead::ReadArc()
             case 10:
                 // centre x
                 get_line();
-                ss.str(m_str); ss >> c[0]; c[0] = mm(c[0]); if(ss.fail()) return false;
+                if(!ParseValue(c[0])) return false;
+                c[0] = mm(c[0]);
                 break;
             case 20:
                 // centre y
                 get_line();
-                ss.str(m_str); ss >> c[1]; c[1] = mm(c[1]); if(ss.fail()) return false;
+                if(!ParseValue(c[1])) return false;
+                c[1] = mm(c[1]);
                 break;
             case 30:
                 // centre z
                 get_line();
-                ss.str(m_str); ss >> c[2]; c[2] = mm(c[2]); if(ss.fail()) return false;
+                if(!ParseValue(c[2])) return false;
+                c[2] = mm(c[2]);
                 break;
             case 40:
                 // radius
                 get_line();
-                ss.str(m_str); ss >> radius; radius = mm(radius); if(ss.fail()) return false;
+                if(!ParseValue(radius)) return false;
+                radius = mm(radius);
                 break;
             case 50:
                 // start angle
                 get_line();
-                ss.str(m_str); ss >> start_angle; if(ss.fail()) return false;
+                if(!ParseValue(start_angle)) return false;
                 break;
             case 51:
                 // end angle
                 get_line();
-                ss.str(m_str); ss >> end_angle; if(ss.fail()) return false;
+                if(!ParseValue(end_angle)) return false;
                 break;
                 case 62:
                 // color index
                 get_line();
-                ss.str(m_str); ss >> m_aci; if(ss.fail()) return false;
+                if(!ParseValue(m_aci)) return false;
                 break;
 
 
@@ -2075,7 +2189,7 @@ bool CDxfRead::ReadArc()
             case 230:
                 //Z extrusion direction for arc 
                 get_line();
-                ss.str(m_str); ss >> z_extrusion_dir; if(ss.fail()) return false;                                
+                if(!ParseValue(z_extrusion_dir)) return false;                                
                 break;
 
             default:
@@ -2103,17 +2217,15 @@ bool CDxfRead::ReadSpline()
 
     double temp_double;
 
-    while(!((*m_ifs).eof()))
+    while(!eof())
     {
         get_line();
         int n;
-        if(sscanf(m_str, "%d", &n) != 1)
+        if(!ParseValue(n))
         {
             this->ReportError_readInteger("DXF::ReadSpline()");
             return false;
         }
-        std::istringstream ss;
-        ss.imbue(std::locale("C"));
         switch(n){
             case 0:
                 // next item found, so finish with Spline
@@ -2127,130 +2239,144 @@ bool CDxfRead::ReadSpline()
                 case 62:
                 // color index
                 get_line();
-                ss.str(m_str); ss >> m_aci; if(ss.fail()) return false;
+                if(!ParseValue(m_aci)) return false;
                 break;
             case 210:
                 // normal x
                 get_line();
-                ss.str(m_str); ss >> sd.norm[0]; if(ss.fail()) return false;
+                if(!ParseValue(sd.norm[0])) return false;
                 break;
             case 220:
                 // normal y
                 get_line();
-                ss.str(m_str); ss >> sd.norm[1]; if(ss.fail()) return false;
+                if(!ParseValue(sd.norm[1])) return false;
                 break;
             case 230:
                 // normal z
                 get_line();
-                ss.str(m_str); ss >> sd.norm[2]; if(ss.fail()) return false;
+                if(!ParseValue(sd.norm[2])) return false;
                 break;
             case 70:
                 // flag
                 get_line();
-                ss.str(m_str); ss >> sd.flag; if(ss.fail()) return false;
+                if(!ParseValue(sd.flag)) return false;
                 break;
             case 71:
                 // degree
                 get_line();
-                ss.str(m_str); ss >> sd.degree; if(ss.fail()) return false;
+                if(!ParseValue(sd.degree)) return false;
                 break;
             case 72:
                 // knots
                 get_line();
-                ss.str(m_str); ss >> sd.knots; if(ss.fail()) return false;
+                if(!ParseValue(sd.knots)) return false;
                 break;
             case 73:
                 // control points
                 get_line();
-                ss.str(m_str); ss >> sd.control_points; if(ss.fail()) return false;
+                if(!ParseValue(sd.control_points)) return false;
                 break;
             case 74:
                 // fit points
                 get_line();
-                ss.str(m_str); ss >> sd.fit_points; if(ss.fail()) return false;
+                if(!ParseValue(sd.fit_points)) return false;
                 break;
             case 12:
                 // starttan x
                 get_line();
-                ss.str(m_str); ss >> temp_double; temp_double = mm(temp_double); if(ss.fail()) return false;
+                if(!ParseValue(temp_double)) return false;
+                temp_double = mm(temp_double);
                 sd.starttanx.push_back(temp_double);
                 break;
             case 22:
                 // starttan y
                 get_line();
-                ss.str(m_str); ss >> temp_double; temp_double = mm(temp_double); if(ss.fail()) return false;
+                if(!ParseValue(temp_double)) return false;
+                temp_double = mm(temp_double);
                 sd.starttany.push_back(temp_double);
                 break;
             case 32:
                 // starttan z
                 get_line();
-                ss.str(m_str); ss >> temp_double; temp_double = mm(temp_double); if(ss.fail()) return false;
+                if(!ParseValue(temp_double)) return false;
+                temp_double = mm(temp_double);
                 sd.starttanz.push_back(temp_double);
                 break;
             case 13:
                 // endtan x
                 get_line();
-                ss.str(m_str); ss >> temp_double; temp_double = mm(temp_double); if(ss.fail()) return false;
+                if(!ParseValue(temp_double)) return false;
+                temp_double = mm(temp_double);
                 sd.endtanx.push_back(temp_double);
                 break;
             case 23:
                 // endtan y
                 get_line();
-                ss.str(m_str); ss >> temp_double; temp_double = mm(temp_double); if(ss.fail()) return false;
+                if(!ParseValue(temp_double)) return false;
+                temp_double = mm(temp_double);
                 sd.endtany.push_back(temp_double);
                 break;
             case 33:
                 // endtan z
                 get_line();
-                ss.str(m_str); ss >> temp_double; temp_double = mm(temp_double); if(ss.fail()) return false;
+                if(!ParseValue(temp_double)) return false;
+                temp_double = mm(temp_double);
                 sd.endtanz.push_back(temp_double);
                 break;
             case 40:
                 // knot
                 get_line();
-                ss.str(m_str); ss >> temp_double; temp_double = mm(temp_double); if(ss.fail()) return false;
+                if(!ParseValue(temp_double)) return false;
+                temp_double = mm(temp_double);
                 sd.knot.push_back(temp_double);
                 break;
             case 41:
                 // weight
                 get_line();
-                ss.str(m_str); ss >> temp_double; temp_double = mm(temp_double); if(ss.fail()) return false;
+                if(!ParseValue(temp_double)) return false;
+                temp_double = mm(temp_double);
                 sd.weight.push_back(temp_double);
                 break;
             case 10:
                 // control x
                 get_line();
-                ss.str(m_str); ss >> temp_double; temp_double = mm(temp_double); if(ss.fail()) return false;
+                if(!ParseValue(temp_double)) return false;
+                temp_double = mm(temp_double);
                 sd.controlx.push_back(temp_double);
                 break;
             case 20:
                 // control y
                 get_line();
-                ss.str(m_str); ss >> temp_double; temp_double = mm(temp_double); if(ss.fail()) return false;
+                if(!ParseValue(temp_double)) return false;
+                temp_double = mm(temp_double);
                 sd.controly.push_back(temp_double);
                 break;
             case 30:
                 // control z
                 get_line();
-                ss.str(m_str); ss >> temp_double; temp_double = mm(temp_double); if(ss.fail()) return false;
+                if(!ParseValue(temp_double)) return false;
+                temp_double = mm(temp_double);
                 sd.controlz.push_back(temp_double);
                 break;
             case 11:
                 // fit x
                 get_line();
-                ss.str(m_str); ss >> temp_double; temp_double = mm(temp_double); if(ss.fail()) return false;
+                if(!ParseValue(temp_double)) return false;
+                temp_double = mm(temp_double);
                 sd.fitx.push_back(temp_double);
                 break;
             case 21:
                 // fit y
                 get_line();
-                ss.str(m_str); ss >> temp_double; temp_double = mm(temp_double); if(ss.fail()) return false;
+                if(!ParseValue(temp_double)) return false;
+                temp_double = mm(temp_double);
                 sd.fity.push_back(temp_double);
                 break;
             case 31:
                 // fit z
                 get_line();
-                ss.str(m_str); ss >> temp_double; temp_double = mm(temp_double); if(ss.fail()) return false;
+                if(!ParseValue(temp_double)) return false;
+                temp_double = mm(temp_double);
                 sd.fitz.push_back(temp_double);
                 break;
             case 42:
@@ -2277,17 +2403,15 @@ bool CDxfRead::ReadCircle()
     double c[3] = {0,0,0}; // centre
     bool hidden = false;
 
-    while(!((*m_ifs).eof()))
+    while(!eof())
     {
         get_line();
         int n;
-        if(sscanf(m_str, "%d", &n) != 1)
+        if(!ParseValue(n))
         {
             this->ReportError_readInteger("DXF::ReadCircle()");
             return false;
         }
-        std::istringstream ss;
-        ss.imbue(std::locale("C"));
         switch(n){
             case 0:
                 // next item found, so finish with Circle
@@ -2309,27 +2433,31 @@ bool CDxfRead::ReadCircle()
             case 10:
                 // centre x
                 get_line();
-                ss.str(m_str); ss >> c[0]; c[0] = mm(c[0]); if(ss.fail()) return false;
+                if(!ParseValue(c[0])) return false;
+                c[0] = mm(c[0]);
                 break;
             case 20:
                 // centre y
                 get_line();
-                ss.str(m_str); ss >> c[1]; c[1] = mm(c[1]); if(ss.fail()) return false;
+                if(!ParseValue(c[1])) return false;
+                c[1] = mm(c[1]);
                 break;
             case 30:
                 // centre z
                 get_line();
-                ss.str(m_str); ss >> c[2]; c[2] = mm(c[2]); if(ss.fail()) return false;
+                if(!ParseValue(c[2])) return false;
+                c[2] = mm(c[2]);
                 break;
             case 40:
                 // radius
                 get_line();
-                ss.str(m_str); ss >> radius; radius = mm(radius); if(ss.fail()) return false;
+                if(!ParseValue(radius)) return false;
+                radius = mm(radius);
                 break;
                 case 62:
                 // color index
                 get_line();
-                ss.str(m_str); ss >> m_aci; if(ss.fail()) return false;
+                if(!ParseValue(m_aci)) return false;
                 break;
 
             case 100:
@@ -2361,17 +2489,15 @@ bool CDxfRead::ReadText()
 
     memset( c, 0, sizeof(c) );
 
-    while(!((*m_ifs).eof()))
+    while(!eof())
     {
         get_line();
         int n;
-        if(sscanf(m_str, "%d", &n) != 1)
+        if(!ParseValue(n))
         {
             this->ReportError_readInteger("DXF::ReadText()");
             return false;
         }
-        std::istringstream ss;
-        ss.imbue(std::locale("C"));
         switch(n){
             case 0:
                 DerefACI();
@@ -2386,22 +2512,26 @@ bool CDxfRead::ReadText()
             case 10:
                 // centre x
                 get_line();
-                ss.str(m_str); ss >> c[0]; c[0] = mm(c[0]); if(ss.fail()) return false;
+                if(!ParseValue(c[0])) return false;
+                c[0] = mm(c[0]);
                 break;
             case 20:
                 // centre y
                 get_line();
-                ss.str(m_str); ss >> c[1]; c[1] = mm(c[1]); if(ss.fail()) return false;
+                if(!ParseValue(c[1])) return false;
+                c[1] = mm(c[1]);
                 break;
             case 30:
                 // centre z
                 get_line();
-                ss.str(m_str); ss >> c[2]; c[2] = mm(c[2]); if(ss.fail()) return false;
+                if(!ParseValue(c[2])) return false;
+                c[2] = mm(c[2]);
                 break;
             case 40:
                 // text height
                 get_line();
-                ss.str(m_str); ss >> height; height = mm(height); if(ss.fail()) return false;
+                if(!ParseValue(height)) return false;
+                height = mm(height);
                 break;
             case 1:
                 // text
@@ -2412,13 +2542,13 @@ bool CDxfRead::ReadText()
             case 50:
                 // text rotation
                 get_line();
-                ss.str(m_str); ss >> rotation; if(ss.fail()) return false;
+                if(!ParseValue(rotation)) return false;
                 break;
 
             case 62:
                 // color index
                 get_line();
-                ss.str(m_str); ss >> m_aci; if(ss.fail()) return false;
+                if(!ParseValue(m_aci)) return false;
                 break;
 
             case 100:
@@ -2448,17 +2578,15 @@ bool CDxfRead::ReadEllipse()
     double start=0; //start of arc
     double end=0;  // end of arc
 
-    while(!((*m_ifs).eof()))
+    while(!eof())
     {
         get_line();
         int n;
-        if(sscanf(m_str, "%d", &n) != 1)
+        if(!ParseValue(n))
         {
             this->ReportError_readInteger("DXF::ReadEllipse()");
             return false;
         }
-        std::istringstream ss;
-        ss.imbue(std::locale("C"));
         switch(n){
             case 0:
                 // next item found, so finish with Ellipse
@@ -2473,52 +2601,58 @@ bool CDxfRead::ReadEllipse()
             case 10:
                 // centre x
                 get_line();
-                ss.str(m_str); ss >> c[0]; c[0] = mm(c[0]); if(ss.fail()) return false;
+                if(!ParseValue(c[0])) return false;
+                c[0] = mm(c[0]);
                 break;
             case 20:
                 // centre y
                 get_line();
-                ss.str(m_str); ss >> c[1]; c[1] = mm(c[1]); if(ss.fail()) return false;
+                if(!ParseValue(c[1])) return false;
+                c[1] = mm(c[1]);
                 break;
             case 30:
                 // centre z
                 get_line();
-                ss.str(m_str); ss >> c[2]; c[2] = mm(c[2]); if(ss.fail()) return false;
+                if(!ParseValue(c[2])) return false;
+                c[2] = mm(c[2]);
                 break;
             case 11:
                 // major x
                 get_line();
-                ss.str(m_str); ss >> m[0]; m[0] = mm(m[0]); if(ss.fail()) return false;
+                if(!ParseValue(m[0])) return false;
+                m[0] = mm(m[0]);
                 break;
             case 21:
                 // major y
                 get_line();
-                ss.str(m_str); ss >> m[1]; m[1] = mm(m[1]); if(ss.fail()) return false;
+                if(!ParseValue(m[1])) return false;
+                m[1] = mm(m[1]);
                 break;
             case 31:
                 // major z
                 get_line();
-                ss.str(m_str); ss >> m[2]; m[2] = mm(m[2]); if(ss.fail()) return false;
+                if(!ParseValue(m[2])) return false;
+                m[2] = mm(m[2]);
                 break;
             case 40:
                 // ratio
                 get_line();
-                ss.str(m_str); ss >> ratio; if(ss.fail()) return false;
+                if(!ParseValue(ratio)) return false;
                 break;
             case 41:
                 // start
                 get_line();
-                ss.str(m_str); ss >> start; if(ss.fail()) return false;
+                if(!ParseValue(start)) return false;
                 break;
             case 42:
                 // end
                 get_line();
-                ss.str(m_str); ss >> end; if(ss.fail()) return false;
+                if(!ParseValue(end)) return false;
                 break;
                 case 62:
                 // color index
                 get_line();
-                ss.str(m_str); ss >> m_aci; if(ss.fail()) return false;
+                if(!ParseValue(m_aci)) return false;
                 break;
             case 100:
             case 210:
@@ -2603,9 +2737,25 @@ static void PolyLineStart()
     poly_first_found = false;
 }
 
-bool CDxfRead::ReadLwPolyLine()
+void CDxfRead::ReportPolyline(const PolylineData& pd)
 {
+    if (OnReadPolyline(pd))
+        return;
+
     PolyLineStart();
+    for (const PolylineVertex& vertex : pd.vertices)
+        AddPolyLinePoint(this, vertex.x, vertex.y, vertex.z, vertex.bulge != 0., vertex.bulge);
+
+    if (pd.closed && poly_first_found) // repeat the first point
+        AddPolyLinePoint(this, poly_first_x, poly_first_y, poly_first_z, false, 0.0);
+
+    PolyLineStart();
+}
+
+bool CDxfRead::ReadLwPolyLine()
+{
+    PolylineData pd;
+    pd.closed = false;
 
     bool x_found = false;
     bool y_found = false;
@@ -2614,21 +2764,18 @@ bool CDxfRead::ReadLwPolyLine()
     double z = 0.0;
     bool bulge_found = false;
     double bulge = 0.0;
-    bool closed = false;
     int flags;
     bool next_item_found = false;
 
-    while(!((*m_ifs).eof()) && !next_item_found)
+    while(!eof() && !next_item_found)
     {
         get_line();
         int n;
-        if(sscanf(m_str, "%d", &n) != 1)
+        if(!ParseValue(n))
         {
             this->ReportError_readInteger("DXF::ReadLwPolyLine()");
             return false;
         }
-        std::istringstream ss;
-        ss.imbue(std::locale("C"));
         switch(n){
             case 0:
                 // next item found
@@ -2636,7 +2783,7 @@ bool CDxfRead::ReadLwPolyLine()
                     DerefACI();
                     if(x_found && y_found){
                     // add point
-                    AddPolyLinePoint(this, x, y, z, bulge_found, bulge);
+                    pd.vertices.push_back({ x, y, z, bulge_found ? bulge : 0. });
                     bulge_found = false;
                     x_found = false;
                     y_found = false;
@@ -2652,41 +2799,44 @@ bool CDxfRead::ReadLwPolyLine()
                 get_line();
                 if(x_found && y_found){
                     // add point
-                    AddPolyLinePoint(this, x, y, z, bulge_found, bulge);
+                    pd.vertices.push_back({ x, y, z, bulge_found ? bulge : 0. });
                     bulge_found = false;
                     x_found = false;
                     y_found = false;
                 }
-                ss.str(m_str); ss >> x; x = mm(x); if(ss.fail()) return false;
+                if(!ParseValue(x)) return false;
+                x = mm(x);
                 x_found = true;
                 break;
             case 20:
                 // y
                 get_line();
-                ss.str(m_str); ss >> y; y = mm(y); if(ss.fail()) return false;
+                if(!ParseValue(y)) return false;
+                y = mm(y);
                 y_found = true;
                 break;
             case 38: 
                 // elevation
                 get_line();
-                ss.str(m_str); ss >> z; z = mm(z); if(ss.fail()) return false;
+                if(!ParseValue(z)) return false;
+                z = mm(z);
                 break;
             case 42:
                 // bulge
                 get_line();
-                ss.str(m_str); ss >> bulge; if(ss.fail()) return false;
+                if(!ParseValue(bulge)) return false;
                 bulge_found = true;
                 break;
             case 70:
                 // flags
                 get_line();
-                if(sscanf(m_str, "%d", &flags) != 1)return false;
-                closed = ((flags & 1) != 0);
+                if(!ParseValue(flags))return false;
+                pd.closed = ((flags & 1) != 0);
                 break;
                 case 62:
                 // color index
                 get_line();
-                ss.str(m_str); ss >> m_aci; if(ss.fail()) return false;
+                if(!ParseValue(m_aci)) return false;
                 break;
             default:
                 // skip the next line
@@ -2697,12 +2847,7 @@ bool CDxfRead::ReadLwPolyLine()
 
     if(next_item_found)
     {
-        if(closed && poly_first_found)
-        {
-            // repeat the first point
-                DerefACI();
-            AddPolyLinePoint(this, poly_first_x, poly_first_y, poly_first_z, false, 0.0);
-        }
+        ReportPolyline(pd);
         return true;
     }
 
@@ -2725,15 +2870,13 @@ bool CDxfRead::ReadVertex(double *pVertex, bool *bulge_found, double *bulge)
     pVertex[1] = 0.0;
     pVertex[2] = 0.0;
 
-    while(!(*m_ifs).eof()) {
+    while(!eof()) {
         get_line();
         int n;
-        if(sscanf(m_str, "%d", &n) != 1) {
+        if(!ParseValue(n)) {
             this->ReportError_readInteger("DXF::ReadVertex()");
             return false;
         }
-        std::istringstream ss;
-        ss.imbue(std::locale("C"));
         switch(n){
         case 0:
         DerefACI();
@@ -2749,30 +2892,33 @@ bool CDxfRead::ReadVertex(double *pVertex, bool *bulge_found, double *bulge)
         case 10:
             // x
             get_line();
-            ss.str(m_str); ss >> x; pVertex[0] = mm(x); if(ss.fail()) return false;
+            if(!ParseValue(x)) return false;
+            pVertex[0] = mm(x);
             x_found = true;
             break;
         case 20:
             // y
             get_line();
-            ss.str(m_str); ss >> y; pVertex[1] = mm(y); if(ss.fail()) return false;
+            if(!ParseValue(y)) return false;
+            pVertex[1] = mm(y);
             y_found = true;
             break;
         case 30:
             // z
             get_line();
-            ss.str(m_str); ss >> z; pVertex[2] = mm(z); if(ss.fail()) return false;
+            if(!ParseValue(z)) return false;
+            pVertex[2] = mm(z);
             break;
 
         case 42:
             get_line();
             *bulge_found = true;
-            ss.str(m_str); ss >> *bulge; if(ss.fail()) return false;
+            if(!ParseValue(*bulge)) return false;
             break;
     case 62:
         // color index
         get_line();
-        ss.str(m_str); ss >> m_aci; if(ss.fail()) return false;
+        if(!ParseValue(m_aci)) return false;
         break;
 
         default:
@@ -2789,26 +2935,22 @@ bool CDxfRead::ReadVertex(double *pVertex, bool *bulge_found, double *bulge)
 
 bool CDxfRead::ReadPolyLine()
 {
-    PolyLineStart();
+    PolylineData pd;
+    pd.closed = false;
 
-    bool closed = false;
     int flags;
-    bool first_vertex_section_found = false;
-    double first_vertex[3] = {0,0,0};
     bool bulge_found;
     double bulge;
 
-    while(!(*m_ifs).eof())
+    while(!eof())
     {
         get_line();
         int n;
-        if(sscanf(m_str, "%d", &n) != 1)
+        if(!ParseValue(n))
         {
             this->ReportError_readInteger("DXF::ReadPolyLine()");
             return false;
         }
-        std::istringstream ss;
-        ss.imbue(std::locale("C"));
         switch(n){
             case 0:
                 // next item found
@@ -2819,34 +2961,26 @@ bool CDxfRead::ReadPolyLine()
                     double vertex[3] = {0,0,0};
                     if (CDxfRead::ReadVertex(vertex, &bulge_found, &bulge))
                     {
-                        if(!first_vertex_section_found) {
-                            first_vertex_section_found = true;
-                            memcpy(first_vertex, vertex, 3*sizeof(double));
-                        }
-                        AddPolyLinePoint(this, vertex[0], vertex[1], vertex[2], bulge_found, bulge);
+                        pd.vertices.push_back({ vertex[0], vertex[1], vertex[2], bulge_found ? bulge : 0. });
                         break;
                     }
                 }
                 if (! strcmp(m_str,"SEQEND"))
                 {
-                    if(closed && first_vertex_section_found) {
-                        AddPolyLinePoint(this, first_vertex[0], first_vertex[1], first_vertex[2], 0, 0);
-                    }
-                    first_vertex_section_found = false;
-                    PolyLineStart();
+                    ReportPolyline(pd);
                     return(true);
                 }
                 break;
             case 70:
                 // flags
                 get_line();
-                if(sscanf(m_str, "%d", &flags) != 1)return false;
-                closed = ((flags & 1) != 0);
+                if(!ParseValue(flags))return false;
+                pd.closed = ((flags & 1) != 0);
                 break;
                 case 62:
                 // color index
                 get_line();
-                ss.str(m_str); ss >> m_aci; if(ss.fail()) return false;
+                if(!ParseValue(m_aci)) return false;
                 break;
             default:
                 // skip the next line
@@ -2920,17 +3054,15 @@ bool CDxfRead::ReadInsert()
     double rot = 0.0; // rotation
     char name[1024] = {0};
 
-    while(!((*m_ifs).eof()))
+    while(!eof())
     {
         get_line();
         int n;
-        if(sscanf(m_str, "%d", &n) != 1)
+        if(!ParseValue(n))
         {
             this->ReportError_readInteger("DXF::ReadInsert()");
             return false;
         }
-        std::istringstream ss;
-        ss.imbue(std::locale("C"));
         switch(n){
             case 0: 
                 // next item found
@@ -2945,37 +3077,40 @@ bool CDxfRead::ReadInsert()
             case 10:
                 // coord x
                 get_line();
-                ss.str(m_str); ss >> c[0]; c[0] = mm(c[0]); if(ss.fail()) return false;
+                if(!ParseValue(c[0])) return false;
+                c[0] = mm(c[0]);
                 break;
             case 20:
                 // coord y
                 get_line();
-                ss.str(m_str); ss >> c[1]; c[1] = mm(c[1]); if(ss.fail()) return false;
+                if(!ParseValue(c[1])) return false;
+                c[1] = mm(c[1]);
                 break;
             case 30:
                 // coord z
                 get_line();
-                ss.str(m_str); ss >> c[2]; c[2] = mm(c[2]); if(ss.fail()) return false;
+                if(!ParseValue(c[2])) return false;
+                c[2] = mm(c[2]);
                 break;
             case 41:
                 // scale x
                 get_line();
-                ss.str(m_str); ss >> s[0]; if(ss.fail()) return false;
+                if(!ParseValue(s[0])) return false;
                 break;
             case 42:
                 // scale y
                 get_line();
-                ss.str(m_str); ss >> s[1]; if(ss.fail()) return false;
+                if(!ParseValue(s[1])) return false;
                 break;
             case 43:
                 // scale z
                 get_line();
-                ss.str(m_str); ss >> s[2]; if(ss.fail()) return false;
+                if(!ParseValue(s[2])) return false;
                 break;
             case 50:
                 // rotation
                 get_line();
-                ss.str(m_str); ss >> rot; if(ss.fail()) return false;
+                if(!ParseValue(rot)) return false;
                 break;
             case 2:
                 // block name
@@ -2985,7 +3120,7 @@ bool CDxfRead::ReadInsert()
             case 62:
                 // color index
                 get_line();
-                ss.str(m_str); ss >> m_aci; if(ss.fail()) return false;
+                if(!ParseValue(m_aci)) return false;
                 break;
             case 100:
             case 39:
@@ -3012,17 +3147,15 @@ bool CDxfRead::ReadDimension()
     double p[3] = {0,0,0}; // dimpoint
     double rot = -1.0; // rotation
 
-    while(!((*m_ifs).eof()))
+    while(!eof())
     {
         get_line();
         int n;
-        if(sscanf(m_str, "%d", &n) != 1)
+        if(!ParseValue(n))
         {
             this->ReportError_readInteger("DXF::ReadDimension()");
             return false;
         }
-        std::istringstream ss;
-        ss.imbue(std::locale("C"));
         switch(n){
             case 0: 
                 // next item found
@@ -3037,57 +3170,66 @@ bool CDxfRead::ReadDimension()
             case 13:
                 // start x
                 get_line();
-                ss.str(m_str); ss >> s[0]; s[0] = mm(s[0]); if(ss.fail()) return false;
+                if(!ParseValue(s[0])) return false;
+                s[0] = mm(s[0]);
                 break;
             case 23:
                 // start y
                 get_line();
-                ss.str(m_str); ss >> s[1]; s[1] = mm(s[1]); if(ss.fail()) return false;
+                if(!ParseValue(s[1])) return false;
+                s[1] = mm(s[1]);
                 break;
             case 33:
                 // start z
                 get_line();
-                ss.str(m_str); ss >> s[2]; s[2] = mm(s[2]); if(ss.fail()) return false;
+                if(!ParseValue(s[2])) return false;
+                s[2] = mm(s[2]);
                 break;
             case 14:
                 // end x
                 get_line();
-                ss.str(m_str); ss >> e[0]; e[0] = mm(e[0]); if(ss.fail()) return false;
+                if(!ParseValue(e[0])) return false;
+                e[0] = mm(e[0]);
                 break;
             case 24:
                 // end y
                 get_line();
-                ss.str(m_str); ss >> e[1]; e[1] = mm(e[1]); if(ss.fail()) return false;
+                if(!ParseValue(e[1])) return false;
+                e[1] = mm(e[1]);
                 break;
             case 34:
                 // end z
                 get_line();
-                ss.str(m_str); ss >> e[2]; e[2] = mm(e[2]); if(ss.fail()) return false;
+                if(!ParseValue(e[2])) return false;
+                e[2] = mm(e[2]);
                 break;
             case 10:
                 // dimline x
                 get_line();
-                ss.str(m_str); ss >> p[0]; p[0] = mm(p[0]); if(ss.fail()) return false;
+                if(!ParseValue(p[0])) return false;
+                p[0] = mm(p[0]);
                 break;
             case 20:
                 // dimline y
                 get_line();
-                ss.str(m_str); ss >> p[1]; p[1] = mm(p[1]); if(ss.fail()) return false;
+                if(!ParseValue(p[1])) return false;
+                p[1] = mm(p[1]);
                 break;
             case 30:
                 // dimline z
                 get_line();
-                ss.str(m_str); ss >> p[2]; p[2] = mm(p[2]); if(ss.fail()) return false;
+                if(!ParseValue(p[2])) return false;
+                p[2] = mm(p[2]);
                 break;
             case 50:
                 // rotation
                 get_line();
-                ss.str(m_str); ss >> rot; if(ss.fail()) return false;
+                if(!ParseValue(rot)) return false;
                 break;
             case 62:
                 // color index
                 get_line();
-                ss.str(m_str); ss >> m_aci; if(ss.fail()) return false;
+                if(!ParseValue(m_aci)) return false;
                 break;
             case 100:
             case 39:
@@ -3109,17 +3251,15 @@ bool CDxfRead::ReadDimension()
 
 bool CDxfRead::ReadBlockInfo()
 {
-    while(!((*m_ifs).eof()))
+    while(!eof())
     {
         get_line();
         int n;
-        if(sscanf(m_str, "%d", &n) != 1)
+        if(!ParseValue(n))
         {
             this->ReportError_readInteger("DXF::ReadBlockInfo()");
             return false;
         }
-        std::istringstream ss;
-        ss.imbue(std::locale("C"));
         switch(n){
             case 2:
                 // block name
@@ -3143,31 +3283,230 @@ bool CDxfRead::ReadBlockInfo()
 
 void CDxfRead::get_line()
 {
+    m_binary_value_type = eBinaryValueNone;
     if (m_unused_line[0] != '\0')
     {
         safe_strcpy(m_str, m_unused_line);
         memset( m_unused_line, '\0', sizeof(m_unused_line));
+        m_str_len = strlen(m_str);
+        m_gcount = 0;
         return;
     }
 
-    m_ifs->getline(m_str, 1024);
+    if (m_binary) {
+        get_binary_line();
+        return;
+    }
+
+    m_gcount = 0;
+    if (m_data_pos >= m_data_end) {
+        // Same as std::istream::getline() at end of input
+        m_eof = true;
+        m_str[0] = '\0';
+        m_str_len = 0;
+        return;
+    }
+
+    const char* line_begin = m_data_pos;
+    const char* line_end = static_cast<const char*>(memchr(line_begin, '\n', m_data_end - line_begin));
+    if (line_end) {
+        m_data_pos = line_end + 1;
+    }
+    else {
+        line_end = m_data_end;
+        m_data_pos = m_data_end;
+        m_eof = true;
+    }
+
+    m_gcount = m_data_pos - line_begin;
     ++m_lineNum;
 
-    char str[1024];
-    size_t len = strlen(m_str);
-    int j = 0;
-    bool non_white_found = false;
-    for(size_t i = 0; i<len; i++){
-        if(non_white_found || (m_str[i] != ' ' && m_str[i] != '\t')){
-            if(m_str[i] != '\r')
-            {
-                str[j] = m_str[i]; j++;
+    // Trim leading white spaces and trailing carriage returns
+    while (line_begin != line_end && (*line_begin == ' ' || *line_begin == '\t'))
+        ++line_begin;
+
+    while (line_end != line_begin && line_end[-1] == '\r')
+        --line_end;
+
+    const size_t len = std::min<size_t>(line_end - line_begin, sizeof(m_str) - 1);
+    memcpy(m_str, line_begin, len);
+    m_str[len] = '\0';
+    m_str_len = len;
+}
+
+void CDxfRead::StopRead()
+{
+    m_data_pos = m_data_end;
+    m_unused_line[0] = '\0';
+    m_str[0] = '\0';
+    m_str_len = 0;
+    m_eof = true;
+}
+
+void CDxfRead::get_binary_line()
+{
+    const char* pos = m_data_pos;
+    auto fnAvailable = [&](size_t len) { return size_t(m_data_end - pos) >= len; };
+    auto fnEnd = [&]{
+        // End of input, possibly truncated group
+        m_eof = true;
+        m_str[0] = '\0';
+        m_str_len = 0;
+        m_gcount = m_data_end - m_data_pos;
+        m_data_pos = m_data_end;
+    };
+    auto fnSetString = [&](const char* str, size_t len) {
+        len = std::min(len, sizeof(m_str) - 1);
+        memcpy(m_str, str, len);
+        m_str[len] = '\0';
+        m_str_len = len;
+    };
+
+    m_str[0] = '\0';
+    m_str_len = 0;
+    if (m_binary_next_is_code) {
+        int code = 0;
+        if (m_binary_code16 && fnAvailable(2)) {
+            code = binary_value<int16_t>(pos);
+            pos += 2;
+        }
+        else if (!m_binary_code16 && fnAvailable(1)) {
+            code = uint8_t(*pos);
+            pos += 1;
+            if (code == 255) { // Extended group code
+                if (!fnAvailable(2))
+                    return fnEnd();
+
+                code = binary_value<int16_t>(pos);
+                pos += 2;
             }
-            non_white_found = true;
+        }
+        else {
+            return fnEnd();
+        }
+
+        // Code text is still needed, DoRead() matches lines like "0"
+        const std::to_chars_result res = std::to_chars(m_str, m_str + sizeof(m_str) - 1, code);
+        *res.ptr = '\0';
+        m_str_len = res.ptr - m_str;
+        m_binary_code = code;
+        m_binary_int = code;
+        m_binary_value_type = eBinaryValueInteger;
+    }
+    else {
+        switch (binary_group_type(m_binary_code)) {
+        case BinaryGroupType::String: {
+            const char* str_end = static_cast<const char*>(memchr(pos, '\0', m_data_end - pos));
+            if (!str_end)
+                return fnEnd();
+
+            fnSetString(pos, str_end - pos);
+            pos = str_end + 1;
+            break;
+        }
+        case BinaryGroupType::BinaryChunk: {
+            // Length byte followed by data, converted to the hexadecimal form found in ASCII DXF
+            if (!fnAvailable(1) || !fnAvailable(1 + uint8_t(*pos)))
+                return fnEnd();
+
+            const size_t len = uint8_t(*pos);
+            static const char hex_digits[] = "0123456789ABCDEF";
+            for (size_t i = 0; i < len; ++i) {
+                const uint8_t byte = uint8_t(pos[1 + i]);
+                m_str[2 * i] = hex_digits[byte >> 4];
+                m_str[2 * i + 1] = hex_digits[byte & 0xF];
+            }
+
+            m_str[2 * len] = '\0';
+            m_str_len = 2 * len;
+            pos += 1 + len;
+            break;
+        }
+        case BinaryGroupType::Bool:
+            if (!fnAvailable(1))
+                return fnEnd();
+
+            m_binary_int = uint8_t(*pos);
+            m_binary_value_type = eBinaryValueInteger;
+            pos += 1;
+            break;
+        case BinaryGroupType::Int16:
+            if (!fnAvailable(2))
+                return fnEnd();
+
+            m_binary_int = binary_value<int16_t>(pos);
+            m_binary_value_type = eBinaryValueInteger;
+            pos += 2;
+            break;
+        case BinaryGroupType::Int32:
+            if (!fnAvailable(4))
+                return fnEnd();
+
+            m_binary_int = binary_value<int32_t>(pos);
+            m_binary_value_type = eBinaryValueInteger;
+            pos += 4;
+            break;
+        case BinaryGroupType::Int64:
+            if (!fnAvailable(8))
+                return fnEnd();
+
+            m_binary_int = binary_value<int64_t>(pos);
+            m_binary_value_type = eBinaryValueInteger;
+            pos += 8;
+            break;
+        case BinaryGroupType::Double:
+            if (!fnAvailable(8))
+                return fnEnd();
+
+            m_binary_double = binary_value<double>(pos);
+            m_binary_value_type = eBinaryValueDouble;
+            pos += 8;
+            break;
         }
     }
-    str[j] = 0;
-    safe_strcpy(m_str, str);
+
+    m_binary_next_is_code = !m_binary_next_is_code;
+    m_gcount = pos - m_data_pos;
+    m_data_pos = pos;
+    ++m_lineNum;
+}
+
+bool CDxfRead::ParseValue(double& value) const
+{
+    if (m_binary_value_type == eBinaryValueDouble) {
+        value = m_binary_double;
+        return true;
+    }
+    else if (m_binary_value_type == eBinaryValueInteger) {
+        value = double(m_binary_int);
+        return true;
+    }
+
+    const char* first = m_str;
+    const char* last = m_str + m_str_len;
+    if (first != last && *first == '+')
+        ++first;
+
+    return fast_float::from_chars(first, last, value).ec == std::errc();
+}
+
+bool CDxfRead::ParseValue(int& value) const
+{
+    if (m_binary_value_type == eBinaryValueInteger) {
+        value = int(m_binary_int);
+        return true;
+    }
+    else if (m_binary_value_type == eBinaryValueDouble) {
+        value = int(m_binary_double);
+        return true;
+    }
+
+    const char* first = m_str;
+    const char* last = m_str + m_str_len;
+    if (first != last && *first == '+')
+        ++first;
+
+    return std::from_chars(first, last, value).ec == std::errc();
 }
 
 void dxf_strncpy(char* dst, const char* src, size_t size)
@@ -3192,7 +3531,7 @@ bool CDxfRead::ReadUnits()
     get_line(); // Skip to next line.
     get_line(); // Skip to next line.
     int n = 0;
-    if(sscanf(m_str, "%d", &n) == 1)
+    if(ParseValue(n))
     {
         m_eUnits = eDxfUnits_t( n );
         return(true);
@@ -3210,19 +3549,17 @@ bool CDxfRead::ReadLayer()
     std::string layername;
     int aci = -1;
 
-    while(!((*m_ifs).eof()))
+    while(!eof())
     {
         get_line();
         int n;
 
-        if(sscanf(m_str, "%d", &n) != 1)
+        if(!ParseValue(n))
         {
             this->ReportError_readInteger("DXF::ReadLayer()");
             return false;
         }
 
-        std::istringstream ss;
-        ss.imbue(std::locale("C"));
         switch(n){
             case 0: // next item found, so finish with line
                 if (layername.empty())
@@ -3239,7 +3576,7 @@ bool CDxfRead::ReadLayer()
             case 62:
                 // layer color ; if negative, layer is off
                 get_line();
-                if(sscanf(m_str, "%d", &aci) != 1)return false;
+                if(!ParseValue(aci))return false;
                 break;
 
             case 6: // linetype name
@@ -3267,7 +3604,7 @@ void CDxfRead::DoRead(const bool ignore_errors /* = false */ )
 
     get_line();
 
-    while(!((*m_ifs).eof()))
+    while(!eof())
     {
         m_aci = 256;
 
@@ -3280,7 +3617,7 @@ void CDxfRead::DoRead(const bool ignore_errors /* = false */ )
             get_line();
             get_line();
             int n = 1;
-            if(sscanf(m_str, "%d", &n) == 1)
+            if(ParseValue(n))
             {
                 if(n == 0)m_measurement_inch = true;
             }
@@ -3455,7 +3792,7 @@ void CDxfRead::ReportError_readInteger(const char* context)
 
 streamsize CDxfRead::gcount() const
 {
-    return m_ifs ? m_ifs->gcount() : 0;
+    return m_gcount;
 }
 
 std::string CDxfRead::LayerName() const
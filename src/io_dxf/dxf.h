@@ -83,6 +83,21 @@ struct SplineData
     std::list<double> fitz;
 };
 
+//polyline data for reading(LWPOLYLINE and POLYLINE entities)
+struct PolylineVertex
+{
+    double x;
+    double y;
+    double z;
+    double bulge; // Tangent of 1/4 of the arc angle between this vertex and the next one, 0 if straight
+};
+
+struct PolylineData
+{
+    std::vector<PolylineVertex> vertices;
+    bool closed;
+};
+
 //***************************
 //data structures for writing
 //added by Wandererfan 2018 (wandererfan@gmail.com) for FreeCAD project
@@ -127,6 +142,7 @@ struct LWPolyDataOut
 class ImportExport CDxfWrite{
 private:
     std::ofstream* m_ofs;
+    std::vector<char> m_ofs_buffer;
     bool m_fail;
     std::ostringstream* m_ssBlock;
     std::ostringstream* m_ssBlkRecord;
@@ -247,10 +263,26 @@ public:
 // derive a class from this and implement it's virtual functions
 class ImportExport CDxfRead{
 private:
-    std::ifstream* m_ifs;
+    // Input data, lines are tokenized in place without intermediate stream buffering
+    std::string m_data_owned; // File contents, empty when data is provided by the caller
+    const char* m_data_pos = nullptr;
+    const char* m_data_end = nullptr;
+    bool m_eof = false;
+    std::streamsize m_gcount = 0;
+
+    // Binary DXF: groups are decoded as code and value "lines", numeric values are kept typed
+    enum eBinaryValue_t { eBinaryValueNone, eBinaryValueInteger, eBinaryValueDouble };
+    bool m_binary = false;
+    bool m_binary_code16 = true; // Group codes are 16-bit words(R13+), otherwise single bytes(R12)
+    bool m_binary_next_is_code = true;
+    int m_binary_code = 0;
+    eBinaryValue_t m_binary_value_type = eBinaryValueNone;
+    long long m_binary_int = 0;
+    double m_binary_double = 0.;
 
     bool m_fail;
     char m_str[1024];
+    size_t m_str_len = 0; // Length of the current line in m_str
     char m_unused_line[1024];
     eDxfUnits_t m_eUnits;
     bool m_measurement_inch;
@@ -274,6 +306,7 @@ private:
     bool ReadSpline();
     bool ReadLwPolyLine();
     bool ReadPolyLine();
+    void ReportPolyline(const PolylineData& pd);
     bool ReadVertex(double *pVertex, bool *bulge_found, double *bulge);
     void OnReadArc(double start_angle, double end_angle, double radius, const double* c, double z_extrusion_dir, bool hidden);
     void OnReadCircle(const double* c, double radius, bool hidden);
@@ -282,22 +315,37 @@ private:
     bool ReadDimension();
     bool ReadBlockInfo();
 
+    void SetInput(const char* data, size_t size);
+    void get_binary_line();
     void put_line(const char *value);
     void DerefACI();
 
+    // Parses number at the beginning of the current line, as 'istream >> value' would do
+    bool ParseValue(double& value) const;
+    bool ParseValue(int& value) const;
+
     void ReportError_readInteger(const char* context);
 
 protected:
     Aci_t m_aci; // manifest color name or 256 for layer color
     int m_lineNum = 0;
 
-    std::streamsize gcount() const;
+    std::streamsize gcount() const; // Count of bytes consumed by last get_line()
+    bool eof() const { return m_eof; }
+    bool IsBinary() const { return m_binary; }
+    // MAYO: ends reading as if the end of input was reached, DoRead() returns quickly
+    void StopRead();
+    // Layer name of the entity being read, without section/block prefixes(see LayerName())
+    const char* EntityLayerName() const { return m_layer_name; }
+    const char* BlockName() const { return m_block_name; }
+    bool IsBlocksSection() const { return strcmp(m_section_name, "BLOCKS") == 0; }
     virtual void get_line();
     virtual void ReportError(const char* /*msg*/) {}
 
 public:
-    CDxfRead(const char* filepath); // this opens the file
-    virtual ~CDxfRead(); // this closes the file
+    CDxfRead(const char* filepath); // this loads the file in memory
+    CDxfRead(const char* data, size_t size); // 'data' must be valid until DoRead() returns(ex: memory-mapped file)
+    virtual ~CDxfRead();
 
     bool Failed(){return m_fail;}
     void DoRead(const bool ignore_errors = false); // this reads the file and calls the following functions
@@ -313,6 +361,8 @@ public:
     virtual void OnReadCircle(const double* /*s*/, const double* /*c*/, bool /*dir*/, bool /*hidden*/){}
     virtual void OnReadEllipse(const double* /*c*/, double /*major_radius*/, double /*minor_radius*/, double /*rotation*/, double /*start_angle*/, double /*end_angle*/, bool /*dir*/){}
     virtual void OnReadSpline(struct SplineData& /*sd*/){}
+    // MAYO: returns false if the polyline isn't handled, it's then reported segment by segment with OnReadLine()/OnReadArc()
+    virtual bool OnReadPolyline(const PolylineData& /*pd*/){ return false; }
     virtual void OnReadInsert(const double* /*point*/, const double* /*scale*/, const char* /*name*/, double /*rotation*/){}
     virtual void OnReadDimension(const double* /*s*/, const double* /*e*/, const double* /*point*/, double /*rotation*/){}
     virtual void AddGraphics() const { }
@@ -6,14 +6,20 @@
 
 #include "io_dxf.h"
 
+#include "../base/application_item.h"
+#include "../base/caf_utils.h"
 #include "../base/cpp_utils.h"
 #include "../base/document.h"
+#include "../base/io_file_source.h"
 #include "../base/math_utils.h"
 #include "../base/messenger.h"
+#include "../base/profiler.h"
 #include "../base/property_builtins.h"
 #include "../base/property_enumeration.h"
+#include "../base/task_manager.h"
 #include "../base/task_progress.h"
 #include "../base/string_conv.h"
+#include "../base/tkernel_utils.h"
 #include "../base/unit_system.h"
 #include "aci_table.h"
 #include "dxf.h"
@@ -22,19 +28,39 @@
 #include <gp_Elips.hxx>
 #include <gp_Trsf.hxx>
 #include <BRep_Builder.hxx>
+#include <BRep_Tool.hxx>
+#include <BRepAdaptor_Curve.hxx>
 #include <BRepBuilderAPI_MakeEdge.hxx>
 #include <BRepBuilderAPI_MakeVertex.hxx>
+#include <BRepBuilderAPI_MakeWire.hxx>
+#include <Bnd_Box2d.hxx>
+#include <Font_BRepFont.hxx>
 #include <Font_BRepTextBuilder.hxx>
 #include <Font_FontMgr.hxx>
+#include <GCPnts_TangentialDeflection.hxx>
 #include <GeomAPI_Interpolate.hxx>
 #include <Geom_BSplineCurve.hxx>
+#include <HLRAlgo_Projector.hxx>
+#include <HLRBRep_Algo.hxx>
+#include <HLRBRep_HLRToShape.hxx>
+#include <Poly_Polygon3D.hxx>
 #include <Precision.hxx>
 #include <TDataStd_Name.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopLoc_Location.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Compound.hxx>
 #include <TopoDS_Edge.hxx>
 #include <XCAFDoc_ShapeTool.hxx>
 
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <functional>
 #include <sstream>
 #include <string_view>
+#include <thread>
+#include <unordered_set>
 
 namespace Mayo {
 namespace IO {
@@ -61,26 +87,265 @@ const Enumeration& systemFontNames()
     return fontNames;
 }
 
+// DXF layer names are case-insensitive
+std::string upperLayerName(std::string_view name)
+{
+    std::string upperName(name);
+    for (char& c : upperName)
+        c = char(std::toupper(static_cast<unsigned char>(c)));
+
+    return upperName;
+}
+
+// Splits a list of layer names separated with ';', which is a forbidden character in layer names
+std::vector<std::string> splitLayerNames(std::string_view strNames)
+{
+    std::vector<std::string> vecName;
+    while (!strNames.empty()) {
+        const size_t pos = std::min(strNames.find(';'), strNames.size());
+        std::string_view name = strNames.substr(0, pos);
+        while (!name.empty() && std::isspace(static_cast<unsigned char>(name.front())))
+            name.remove_prefix(1);
+
+        while (!name.empty() && std::isspace(static_cast<unsigned char>(name.back())))
+            name.remove_suffix(1);
+
+        if (!name.empty())
+            vecName.emplace_back(name);
+
+        strNames.remove_prefix(std::min(pos + 1, strNames.size()));
+    }
+
+    return vecName;
+}
+
+// Returns the index of 'name' in 'vecName', which is appended if not found
+int internedNameIndex(
+        std::string name, std::vector<std::string>& vecName, std::unordered_map<std::string, int>& mapNameIndex)
+{
+    auto it = mapNameIndex.find(name);
+    if (it == mapNameIndex.end()) {
+        it = mapNameIndex.insert({ name, int(vecName.size()) }).first;
+        vecName.push_back(std::move(name));
+    }
+
+    return it->second;
+}
+
+int concurrentTaskCount(size_t itemCount)
+{
+    // Avoid tasks too small to be worth it
+    constexpr size_t minTaskItemCount = 1024;
+    const int threadCount = std::max(1, int(std::thread::hardware_concurrency()));
+    return int(std::min<size_t>(1 + itemCount / minTaskItemCount, threadCount));
+}
+
+// Entities approximating the edges of a shape, ready to be written with CDxfWrite
+struct DxfEdgeEntities {
+    struct Line {
+        gp_Pnt start;
+        gp_Pnt end;
+    };
+    struct Arc {
+        gp_Pnt center;
+        double radius;
+        gp_Pnt start;
+        gp_Pnt end;
+        bool ccw;
+        bool isCircle;
+    };
+
+    std::vector<Line> vecLine;
+    std::vector<Arc> vecArc;
+    std::vector<std::vector<gp_Pnt>> vecPolyline;
+};
+
+// DXF R12 layer names are restricted to letters, digits and characters '$', '-', '_'
+std::string dxfLayerName(std::string_view name)
+{
+    std::string layerName(name);
+    for (char& c : layerName) {
+        if (!std::isalnum(static_cast<unsigned char>(c)) && c != '$' && c != '-' && c != '_')
+            c = '_';
+    }
+
+    return !layerName.empty() ? layerName : std::string("SHAPE");
+}
+
+// Returns the edges of 'shape' visible for 'projection', expressed in the view plane(Z=0)
+TopoDS_Shape dxfVisibleEdges(const TopoDS_Shape& shape, DxfWriter::Projection projection)
+{
+    if (projection == DxfWriter::Projection::None)
+        return shape;
+
+    // Main direction points towards the viewer, X direction is the horizontal axis of the view
+    gp_Ax2 viewAxes(gp::Origin(), gp::DZ(), gp::DX());
+    if (projection == DxfWriter::Projection::Front)
+        viewAxes = gp_Ax2(gp::Origin(), gp::DY().Reversed(), gp::DX());
+    else if (projection == DxfWriter::Projection::Right)
+        viewAxes = gp_Ax2(gp::Origin(), gp::DX(), gp::DY());
+
+    Handle_HLRBRep_Algo algo = new HLRBRep_Algo;
+    algo->Add(shape);
+    algo->Projector(HLRAlgo_Projector(viewAxes));
+    algo->Update();
+    algo->Hide();
+
+    // Sharp edges, smooth edges and silhouettes
+    HLRBRep_HLRToShape hlrToShape(algo);
+    TopoDS_Compound cmpd;
+    BRep_Builder builder;
+    builder.MakeCompound(cmpd);
+    for (const TopoDS_Shape& edges : { hlrToShape.VCompound(),
+                                       hlrToShape.Rg1LineVCompound(),
+                                       hlrToShape.OutLineVCompound() })
+    {
+        if (!edges.IsNull())
+            builder.Add(cmpd, edges);
+    }
+
+    return cmpd;
+}
+
+DxfEdgeEntities dxfEdgeEntities(const TopoDS_Shape& shape, const DxfWriter::Parameters& params)
+{
+    DxfEdgeEntities entities;
+    for (TopExp_Explorer expl(shape, TopAbs_EDGE); expl.More(); expl.Next()) {
+        const TopoDS_Edge& edge = TopoDS::Edge(expl.Current());
+        if (BRep_Tool::Degenerated(edge) || !BRep_Tool::IsGeometric(edge))
+            continue;
+
+        const BRepAdaptor_Curve curve(edge);
+        const gp_Pnt pntFirst = curve.Value(curve.FirstParameter());
+        const gp_Pnt pntLast = curve.Value(curve.LastParameter());
+        if (curve.GetType() == GeomAbs_Line) {
+            entities.vecLine.push_back({ pntFirst, pntLast });
+            continue;
+        }
+
+        // CIRCLE/ARC entities are expressed in the XY plane
+        if (curve.GetType() == GeomAbs_Circle) {
+            const gp_Circ circ = curve.Circle();
+            const gp_Dir& circDir = circ.Axis().Direction();
+            if (circDir.IsParallel(gp::DZ(), Precision::Angular())
+                    && std::abs(circ.Location().Z()) < Precision::Confusion())
+            {
+                const bool ccw = circDir.Z() > 0;
+                entities.vecArc.push_back({ circ.Location(), circ.Radius(), pntFirst, pntLast, ccw, curve.IsClosed() });
+                continue;
+            }
+        }
+
+        const GCPnts_TangentialDeflection discr(curve, params.angularDeflection, params.chordalDeflection);
+        if (discr.NbPoints() < 2)
+            continue;
+
+        std::vector<gp_Pnt> vecPnt;
+        vecPnt.reserve(discr.NbPoints());
+        for (int i = 1; i <= discr.NbPoints(); ++i)
+            vecPnt.push_back(discr.Value(i));
+
+        entities.vecPolyline.push_back(std::move(vecPnt));
+    }
+
+    return entities;
+}
+
+void dxfWriteEntities(CDxfWrite& writer, const DxfEdgeEntities& entities)
+{
+    for (const DxfEdgeEntities::Line& line : entities.vecLine)
+        writer.writeLine(line.start.XYZ().GetData(), line.end.XYZ().GetData());
+
+    for (const DxfEdgeEntities::Arc& arc : entities.vecArc) {
+        if (arc.isCircle)
+            writer.writeCircle(arc.center.XYZ().GetData(), arc.radius);
+        else
+            writer.writeArc(arc.start.XYZ().GetData(), arc.end.XYZ().GetData(), arc.center.XYZ().GetData(), arc.ccw);
+    }
+
+    // R12 POLYLINE entities written by CDxfWrite are 2D, fallback to LINE entities otherwise
+    for (const std::vector<gp_Pnt>& vecPnt : entities.vecPolyline) {
+        const bool isPlanarXY = std::all_of(vecPnt.cbegin(), vecPnt.cend(), [](const gp_Pnt& pnt) {
+            return std::abs(pnt.Z()) < Precision::Confusion();
+        });
+        if (isPlanarXY) {
+            LWPolyDataOut polyline = {};
+            polyline.nVert = double(vecPnt.size());
+            for (const gp_Pnt& pnt : vecPnt)
+                polyline.Verts.push_back({ pnt.X(), pnt.Y(), 0. });
+
+            writer.writePolyline(polyline);
+        }
+        else {
+            for (size_t i = 1; i < vecPnt.size(); ++i)
+                writer.writeLine(vecPnt.at(i - 1).XYZ().GetData(), vecPnt.at(i).XYZ().GetData());
+        }
+    }
+}
+
 } // namespace
 
 class DxfReader::Internal : public CDxfRead {
 private:
+    // DXF entity parsed into a compact record, its shape is built afterwards by buildShapes()
+    struct Primitive {
+        enum class Type : uint8_t { Line, Point, Arc, Circle, Ellipse, Spline, Polyline, Shape };
+        Type type = Type::Shape;
+        Aci_t aci = 0;
+        int layerIndex = -1; // Index in m_vecLayerName, -1 for entities of block definitions
+        int blockIndex = -1; // Index in m_vecBlockName, -1 for entities outside of block definitions
+        int dataIndex = -1; // Index in m_vecSplineData for Spline, m_vecPolylineData for Polyline, m_vecShape for Shape
+        gp_Pnt p0; // Line, Point, Arc
+        gp_Pnt p1; // Line, Arc
+        gp_Ax2 axes; // Arc, Circle, Ellipse
+        double radius1 = 0; // Arc, Circle, Ellipse(major)
+        double radius2 = 0; // Ellipse(minor)
+    };
+
     Messenger* m_messenger = nullptr;
     DxfReader::Parameters m_params;
-    std::unordered_map<std::string, std::vector<DxfReader::Entity>> m_layers;
+    // Arena for the records parsed and the entity arrays, must be declared before the containers
+    Handle_NCollection_BaseAllocator m_allocator;
+    ArenaVector<Primitive> m_vecPrimitive;
+    ArenaVector<SplineData> m_vecSplineData;
+    ArenaVector<PolylineData> m_vecPolylineData;
+    ArenaVector<TopoDS_Shape> m_vecShape;
+    std::vector<std::string> m_vecLayerName;
+    std::unordered_map<std::string, int> m_mapLayerNameIndex;
+    std::vector<std::string> m_vecBlockName;
+    std::unordered_map<std::string, int> m_mapBlockNameIndex;
+    std::unordered_set<std::string> m_setLayerWhitelist; // Upper case names
+    std::unordered_set<std::string> m_setLayerBlacklist; // Upper case names
+    // Fonts by height, Font_BRepFont caches the shapes of the glyphs it renders. So text shapes are
+    // composed of located references to glyph shapes rendered once per (font, glyph, height)
+    std::unordered_map<double, Handle_Font_BRepFont> m_mapHeightFont;
+    Font_BRepTextBuilder m_brepTextBuilder;
+    std::unordered_map<std::string, ArenaVector<DxfReader::Entity>> m_layers;
+    std::unordered_map<std::string, std::vector<DxfReader::Insert>> m_layerInserts;
+    std::unordered_map<std::string, DxfReader::Block> m_blocks;
     TaskProgress* m_progress = nullptr;
     std::uintmax_t m_fileSize = 0;
     std::uintmax_t m_fileReadSize = 0;
+    std::uintmax_t m_nextProgressReadSize = 0;
+    bool m_abortRequested = false;
 
 protected:
     void get_line() override;
 
 public:
-    Internal(const FilePath& filepath, TaskProgress* progress = nullptr);
+    Internal(std::string_view fileContents);
 
     void setMessenger(Messenger* messenger) { m_messenger = messenger; }
-    void setParameters(const DxfReader::Parameters& params) { m_params = params; }
-    const auto& layers() const { return m_layers; }
+    void setParameters(const DxfReader::Parameters& params);
+    void setProgress(TaskProgress* progress) { m_progress = progress; }
+    bool isAbortRequested() const { return m_abortRequested; }
+    auto& layers() { return m_layers; }
+    auto& layerInserts() { return m_layerInserts; }
+    auto& blocks() { return m_blocks; }
+
+    // Builds concurrently the shapes of the primitives parsed by DoRead(), then groups them by layer
+    // Returns false if abort was requested
+    bool buildShapes(TaskProgress* progress);
 
     // CDxfRead's virtual functions
     void OnReadLine(const double* s, const double* e, bool hidden) override;
@@ -90,16 +355,29 @@ public:
     void OnReadCircle(const double* s, const double* c, bool dir, bool hidden) override;
     void OnReadEllipse(const double* c, double major_radius, double minor_radius, double rotation, double start_angle, double end_angle, bool dir) override;
     void OnReadSpline(struct SplineData& sd) override;
+    bool OnReadPolyline(const PolylineData& pd) override;
     void OnReadInsert(const double* point, const double* scale, const char* name, double rotation) override;
     void OnReadDimension(const double* s, const double* e, const double* point, double rotation) override;
 
     void ReportError(const char* msg) override;
 
-    static Handle_Geom_BSplineCurve createSplineFromPolesAndKnots(struct SplineData& sd);
-    static Handle_Geom_BSplineCurve createInterpolationSpline(struct SplineData& sd);
+    static Handle_Geom_BSplineCurve createSplineFromPolesAndKnots(const SplineData& sd);
+    static Handle_Geom_BSplineCurve createInterpolationSpline(const SplineData& sd);
 
     gp_Pnt toPnt(const double* coords) const;
+
+    // Returns true if the current entity is rejected by the layer or region filters
+    // Entities of block definitions are never rejected, filters apply to the inserts of the blocks
+    bool isEntityFiltered(const Bnd_Box2d& bndBox) const;
+    bool isEntityFiltered(std::initializer_list<gp_Pnt> points, double gap = 0.) const;
+
     void addShape(const TopoDS_Shape& shape);
+    void addPrimitive(Primitive&& primitive);
+    ArenaVector<DxfReader::Entity>& layerEntities(const std::string& layerName);
+    DxfReader::Block& block(const std::string& blockName);
+    TopoDS_Shape buildShape(const Primitive& primitive) const;
+    TopoDS_Shape buildPolylineShape(const PolylineData& pd) const;
+    Handle_Font_BRepFont findFont(double height);
 };
 
 class DxfReader::Properties : public PropertyGroup {
@@ -110,56 +388,163 @@ public:
     {
         this->scaling.setDescription(
                     textIdTr("Scale entities according some factor"));
+        this->deferScaling.setDescription(
+                    textIdTr("Display entities scaled but keep their geometry unscaled until actual "
+                             "coordinates are needed(ex: export, measurement).\n\n"
+                             "Speeds up the import of big drawings"));
         this->importAnnotations.setDescription(
                     textIdTr("Import text/dimension objects"));
         this->groupLayers.setDescription(
                     textIdTr("Group all objects within a layer into a single coumpound shape"));
         this->fontNameForTextObjects.setDescription(
                     textIdTr("Name of the font to be used when creating shape for text objects"));
+        this->mergePolylineSegments.setDescription(
+                    textIdTr("Import each polyline as a single shape instead of one edge per segment.\n\n"
+                             "Polylines with straight segments only are imported as a single polygonal edge"));
+        this->layerWhitelist.setDescription(
+                    textIdTr("Names of the layers to be imported, separated with ';'\n\n"
+                             "All layers are imported if empty. Names are case-insensitive"));
+        this->layerBlacklist.setDescription(
+                    textIdTr("Names of the layers to be skipped, separated with ';'"));
+        this->regionFilter.setDescription(
+                    textIdTr("Skip the entities outside of a XY region.\n\n"
+                             "Region is defined in the coordinates of the imported shapes(ie after scaling)"));
+        for (PropertyDouble* prop : { &this->regionMinX, &this->regionMinY, &this->regionMaxX, &this->regionMaxY })
+            prop->setEnabled(false);
     }
 
     void restoreDefaults() override {
         const DxfReader::Parameters params;
         this->scaling.setValue(params.scaling);
+        this->deferScaling.setValue(params.deferScaling);
         this->importAnnotations.setValue(params.importAnnotations);
         this->groupLayers.setValue(params.groupLayers);
         this->fontNameForTextObjects.setValue(0);
+        this->mergePolylineSegments.setValue(params.mergePolylineSegments);
+        this->layerWhitelist.setValue({});
+        this->layerBlacklist.setValue({});
+        this->regionFilter.setValue(false);
+        for (PropertyDouble* prop : { &this->regionMinX, &this->regionMinY, &this->regionMaxX, &this->regionMaxY })
+            prop->setValue(0.);
+    }
+
+    void onPropertyChanged(Property* prop) override
+    {
+        if (prop == &this->regionFilter) {
+            for (PropertyDouble* propCoord : { &this->regionMinX, &this->regionMinY, &this->regionMaxX, &this->regionMaxY })
+                propCoord->setEnabled(this->regionFilter);
+        }
+
+        PropertyGroup::onPropertyChanged(prop);
     }
 
     PropertyDouble scaling{ this, textId("scaling") };
+    PropertyBool deferScaling{ this, textId("deferScaling") };
     PropertyBool importAnnotations{ this, textId("importAnnotations") };
     PropertyBool groupLayers{ this, textId("groupLayers") };
     PropertyEnumeration fontNameForTextObjects{ this, textId("fontNameForTextObjects"), systemFontNames() };
+    PropertyBool mergePolylineSegments{ this, textId("mergePolylineSegments") };
+    PropertyString layerWhitelist{ this, textId("layerWhitelist") };
+    PropertyString layerBlacklist{ this, textId("layerBlacklist") };
+    PropertyBool regionFilter{ this, textId("regionFilter") };
+    PropertyDouble regionMinX{ this, textId("regionMinX") };
+    PropertyDouble regionMinY{ this, textId("regionMinY") };
+    PropertyDouble regionMaxX{ this, textId("regionMaxX") };
+    PropertyDouble regionMaxY{ this, textId("regionMaxY") };
 };
 
 bool DxfReader::readFile(const FilePath& filepath, TaskProgress* progress)
+{
+    MAYO_PROFILE_ZONE("DxfReader::readFile");
+    // CDxfRead tokenizes lines directly within the memory-mapped file contents
+    const FileSource fileSource(filepath);
+    if (!fileSource.isMapped())
+        return false;
+
+    return this->readContents(fileSource.contents(), progress);
+}
+
+bool DxfReader::readBuffer(Span<const uint8_t> data, const FilePath& /*nameHint*/, TaskProgress* progress)
+{
+    MAYO_PROFILE_ZONE("DxfReader::readBuffer");
+    return this->readContents(
+                std::string_view(reinterpret_cast<const char*>(data.data()), data.size()), progress);
+}
+
+bool DxfReader::readContents(std::string_view contents, TaskProgress* progress)
 {
     m_layers.clear();
-    DxfReader::Internal internalReader(filepath, progress);
-    internalReader.setParameters(m_params);
+    m_layerInserts.clear();
+    m_blocks.clear();
+    DxfReader::Internal internalReader(contents);
+    if (m_params.deferScaling && m_params.scaling > 0 && m_params.scaling != 1.) {
+        // Coordinates are kept unscaled, region filter is then expressed in the same coordinates
+        DxfReader::Parameters internalParams = m_params;
+        internalParams.scaling = 1.;
+        if (!m_params.regionFilter.IsVoid()) {
+            double xmin, ymin, xmax, ymax;
+            m_params.regionFilter.Get(xmin, ymin, xmax, ymax);
+            internalParams.regionFilter.SetVoid();
+            internalParams.regionFilter.Update(
+                        xmin / m_params.scaling, ymin / m_params.scaling,
+                        xmax / m_params.scaling, ymax / m_params.scaling);
+        }
+
+        internalReader.setParameters(internalParams);
+    }
+    else {
+        internalReader.setParameters(m_params);
+    }
+
     internalReader.setMessenger(this->messenger() ? this->messenger() : NullMessenger::instance());
-    internalReader.DoRead();
+    {
+        TaskProgress parseProgress(progress, 50);
+        internalReader.setProgress(&parseProgress);
+        internalReader.DoRead();
+        internalReader.setProgress(nullptr);
+        if (internalReader.isAbortRequested())
+            return false;
+    }
+
+    // Entity shapes are built in a second stage, concurrently
+    TaskProgress buildProgress(progress, 50);
+    if (!internalReader.buildShapes(&buildProgress))
+        return false;
+
     m_layers = std::move(internalReader.layers());
+    m_layerInserts = std::move(internalReader.layerInserts());
+    m_blocks = std::move(internalReader.blocks());
     return !internalReader.Failed();
 }
 
 TDF_LabelSequence DxfReader::transfer(DocumentPtr doc, TaskProgress* progress)
 {
+    MAYO_PROFILE_ZONE("DxfReader::transfer");
     TDF_LabelSequence seqLabel;
     Handle_XCAFDoc_ShapeTool shapeTool = doc->xcaf().shapeTool();
     Handle_XCAFDoc_ColorTool colorTool = doc->xcaf().colorTool();
     Handle_XCAFDoc_LayerTool layerTool = doc->xcaf().layerTool();
     std::unordered_map<std::string, TDF_Label> mapLayerNameLabel;
     std::unordered_map<Aci_t, TDF_Label> mapAciColorLabel;
+    std::unordered_map<std::string, TDF_Label> mapBlockNameLabel;
+    const ArenaVector<Entity> emptyVecEntity;
+    const std::vector<Insert> emptyVecInsert;
+
+    const bool isScalingDeferred = m_params.deferScaling && m_params.scaling > 0 && m_params.scaling != 1.;
+    auto fnAddRootLabel = [&](const TDF_Label& label, const std::string& shapeName, TDF_Label layer) {
+        TDataStd_Name::Set(label, to_OccExtString(shapeName));
+        seqLabel.Append(label);
+        if (isScalingDeferred)
+            doc->setDeferredScaling(label, m_params.scaling);
+
+        if (!layer.IsNull())
+            layerTool->SetLayer(label, layer, true/*onlyInOneLayer*/);
+    };
 
     auto fnAddRootShape = [&](const TopoDS_Shape& shape, const std::string& shapeName, TDF_Label layer) {
         const TDF_Label labelShape = shapeTool->NewShape();
         shapeTool->SetShape(labelShape, shape);
-        TDataStd_Name::Set(labelShape, to_OccExtString(shapeName));
-        seqLabel.Append(labelShape);
-        if (!layer.IsNull())
-            layerTool->SetLayer(labelShape, layer, true/*onlyInOneLayer*/);
-
+        fnAddRootLabel(labelShape, shapeName, layer);
         return labelShape;
     };
 
@@ -179,76 +564,166 @@ TDF_LabelSequence DxfReader::transfer(DocumentPtr doc, TaskProgress* progress)
         return TDF_Label();
     };
 
+    // Creates shape label of a compound grouping entities, null label if there is no shape
+    auto fnAddEntityCompound = [&](const ArenaVector<Entity>& vecEntity) {
+        BRep_Builder builder;
+        TopoDS_Compound comp;
+        builder.MakeCompound(comp);
+        bool isCompEmpty = true;
+        for (const Entity& entity : vecEntity) {
+            if (!entity.shape.IsNull()) {
+                builder.Add(comp, entity.shape);
+                isCompEmpty = false;
+            }
+        }
+
+        if (isCompEmpty)
+            return TDF_Label();
+
+        const TDF_Label compLabel = shapeTool->NewShape();
+        shapeTool->SetShape(compLabel, comp);
+        // Check if all entities have the same color
+        bool uniqueColor = true;
+        const Aci_t aci = vecEntity.front().aci;
+        for (const Entity& entity : vecEntity) {
+            uniqueColor = entity.aci == aci;
+            if (!uniqueColor)
+                break;
+        }
+
+        if (uniqueColor) {
+            colorTool->SetColor(compLabel, fnAddAci(aci), XCAFDoc_ColorGen);
+        }
+        else {
+            for (const Entity& entity : vecEntity) {
+                if (!entity.shape.IsNull()) {
+                    const TDF_Label entityLabel = shapeTool->AddSubShape(compLabel, entity.shape);
+                    colorTool->SetColor(entityLabel, fnAddAci(entity.aci), XCAFDoc_ColorGen);
+                }
+            }
+        }
+
+        return compLabel;
+    };
+
+    // Block definitions are imported once as prototype shapes, an insert is then an assembly
+    // component referring to the block prototype at some location
+    // Shape label is a compound if there are no inserts, otherwise an assembly
+    std::function<TDF_Label(const std::string&)> fnBlockPrototype;
+    auto fnAddShapeLabel = [&](const ArenaVector<Entity>& vecEntity, const std::vector<Insert>& vecInsert) {
+        const TDF_Label compLabel = fnAddEntityCompound(vecEntity);
+        if (vecInsert.empty())
+            return compLabel;
+
+        std::vector<std::pair<TDF_Label, TopLoc_Location>> vecComponent;
+        if (!compLabel.IsNull())
+            vecComponent.push_back({ compLabel, TopLoc_Location() });
+
+        for (const Insert& insert : vecInsert) {
+            const TDF_Label blockLabel = fnBlockPrototype(insert.blockName);
+            if (!blockLabel.IsNull())
+                vecComponent.push_back({ blockLabel, TopLoc_Location(insert.trsf) });
+        }
+
+        if (vecComponent.empty())
+            return TDF_Label();
+
+        const TDF_Label asmLabel = shapeTool->NewShape();
+        for (const auto& [label, loc] : vecComponent)
+            shapeTool->AddComponent(asmLabel, label, loc);
+
+        return asmLabel;
+    };
+
+    fnBlockPrototype = [&](const std::string& blockName) {
+        auto itBlock = mapBlockNameLabel.find(blockName);
+        if (itBlock != mapBlockNameLabel.cend())
+            return itBlock->second;
+
+        // Insert null label first, so recursive block definitions are cut
+        mapBlockNameLabel.insert({ blockName, TDF_Label() });
+        auto itBlockContents = m_blocks.find(blockName);
+        if (itBlockContents == m_blocks.cend())
+            return TDF_Label();
+
+        const Block& block = itBlockContents->second;
+        const TDF_Label blockLabel = fnAddShapeLabel(block.entities, block.inserts);
+        if (!blockLabel.IsNull())
+            TDataStd_Name::Set(blockLabel, to_OccExtString(blockName));
+
+        mapBlockNameLabel[blockName] = blockLabel;
+        return blockLabel;
+    };
+
+    std::vector<std::string> vecLayerName;
+    for (const auto& [layerName, vecEntity] : m_layers)
+        vecLayerName.push_back(layerName);
+
+    for (const auto& [layerName, vecInsert] : m_layerInserts) {
+        if (m_layers.find(layerName) == m_layers.cend())
+            vecLayerName.push_back(layerName);
+    }
+
+    auto fnLayerEntities = [&](const std::string& layerName) -> const ArenaVector<Entity>& {
+        auto it = m_layers.find(layerName);
+        return it != m_layers.cend() ? it->second : emptyVecEntity;
+    };
+    auto fnLayerInserts = [&](const std::string& layerName) -> const std::vector<Insert>& {
+        auto it = m_layerInserts.find(layerName);
+        return it != m_layerInserts.cend() ? it->second : emptyVecInsert;
+    };
+
     int iShape = 0;
     int shapeCount = 0;
-    for (const auto& [layerName, vecEntity] : m_layers) {
-        if (!startsWith(layerName, "BLOCKS")) {
-            shapeCount += vecEntity.size();
-            const TDF_Label layerLabel = layerTool->AddLayer(to_OccExtString(layerName));
-            mapLayerNameLabel.insert({ layerName, layerLabel });
-        }
+    for (const std::string& layerName : vecLayerName) {
+        shapeCount += fnLayerEntities(layerName).size() + fnLayerInserts(layerName).size();
+        const TDF_Label layerLabel = layerTool->AddLayer(to_OccExtString(layerName));
+        mapLayerNameLabel.insert({ layerName, layerLabel });
     }
     auto fnUpdateProgressValue = [&]{
         progress->setValue(MathUtils::mappedValue(iShape, 0, shapeCount, 0, 100));
     };
 
     if (!m_params.groupLayers) {
-        for (const auto& [layerName, vecEntity] : m_layers) {
-            if (startsWith(layerName, "BLOCKS"))
-                continue; // Skip
-
+        for (const std::string& layerName : vecLayerName) {
             const TDF_Label layerLabel = CppUtils::findValue(layerName, mapLayerNameLabel);
-            for (const DxfReader::Entity& entity : vecEntity) {
+            for (const DxfReader::Entity& entity : fnLayerEntities(layerName)) {
                 const std::string shapeName = std::string("Shape_") + std::to_string(++iShape);
                 const TDF_Label shapeLabel = fnAddRootShape(entity.shape, shapeName, layerLabel);
                 colorTool->SetColor(shapeLabel, fnAddAci(entity.aci), XCAFDoc_ColorGen);
                 fnUpdateProgressValue();
             }
+
+            for (const DxfReader::Insert& insert : fnLayerInserts(layerName)) {
+                const std::string shapeName = std::string("Shape_") + std::to_string(++iShape);
+                const TDF_Label insertLabel = fnAddShapeLabel(emptyVecEntity, { insert });
+                if (!insertLabel.IsNull())
+                    fnAddRootLabel(insertLabel, shapeName, layerLabel);
+
+                fnUpdateProgressValue();
+            }
         }
     }
     else {
-        for (const auto& [layerName, vecEntity] : m_layers) {
-            if (startsWith(layerName, "BLOCKS"))
-                continue; // Skip
-
-            BRep_Builder builder;
-            TopoDS_Compound comp;
-            builder.MakeCompound(comp);
-            for (const Entity& entity : vecEntity) {
-                if (!entity.shape.IsNull())
-                    builder.Add(comp, entity.shape);
-            }
-
-            if (!comp.IsNull()) {
+        for (const std::string& layerName : vecLayerName) {
+            const ArenaVector<Entity>& vecEntity = fnLayerEntities(layerName);
+            const std::vector<Insert>& vecInsert = fnLayerInserts(layerName);
+            const TDF_Label layerShapeLabel = fnAddShapeLabel(vecEntity, vecInsert);
+            if (!layerShapeLabel.IsNull()) {
                 const TDF_Label layerLabel = CppUtils::findValue(layerName, mapLayerNameLabel);
-                const TDF_Label compLabel = fnAddRootShape(comp, layerName, layerLabel);
-                // Check if all entities have the same color
-                bool uniqueColor = true;
-                const Aci_t aci = !vecEntity.empty() ? vecEntity.front().aci : -1;
-                for (const Entity& entity : vecEntity) {
-                    uniqueColor = entity.aci == aci;
-                    if (!uniqueColor)
-                        break;
-                }
-
-                if (uniqueColor) {
-                    colorTool->SetColor(compLabel, fnAddAci(aci), XCAFDoc_ColorGen);
-                }
-                else {
-                    for (const Entity& entity : vecEntity) {
-                        if (!entity.shape.IsNull()) {
-                            const TDF_Label entityLabel = shapeTool->AddSubShape(compLabel, entity.shape);
-                            colorTool->SetColor(entityLabel, fnAddAci(entity.aci), XCAFDoc_ColorGen);
-                        }
-                    }
-                }
+                fnAddRootLabel(layerShapeLabel, layerName, layerLabel);
             }
 
-            iShape += vecEntity.size();
+            iShape += vecEntity.size() + vecInsert.size();
             fnUpdateProgressValue();
         }
     }
 
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 4, 0)
+    if (!mapBlockNameLabel.empty())
+        shapeTool->UpdateAssemblies();
+#endif
+
     return seqLabel;
 }
 
@@ -262,12 +737,34 @@ void DxfReader::applyProperties(const PropertyGroup* group)
     auto ptr = dynamic_cast<const Properties*>(group);
     if (ptr) {
         m_params.scaling = ptr->scaling;
+        m_params.deferScaling = ptr->deferScaling;
         m_params.importAnnotations = ptr->importAnnotations;
         m_params.groupLayers = ptr->groupLayers;
         m_params.fontNameForTextObjects = ptr->fontNameForTextObjects.name().toStdString();
+        m_params.mergePolylineSegments = ptr->mergePolylineSegments;
+        m_params.layerWhitelist = splitLayerNames(ptr->layerWhitelist.value());
+        m_params.layerBlacklist = splitLayerNames(ptr->layerBlacklist.value());
+        m_params.regionFilter.SetVoid();
+        if (ptr->regionFilter) {
+            m_params.regionFilter.Update(
+                        std::min(ptr->regionMinX.value(), ptr->regionMaxX.value()),
+                        std::min(ptr->regionMinY.value(), ptr->regionMaxY.value()),
+                        std::max(ptr->regionMinX.value(), ptr->regionMaxX.value()),
+                        std::max(ptr->regionMinY.value(), ptr->regionMaxY.value()));
+        }
     }
 }
 
+ReaderParametersSnapshotPtr DxfReader::createParametersSnapshot() const
+{
+    return ReaderParametersSnapshotOf<Parameters>::create(m_params);
+}
+
+void DxfReader::applyParametersSnapshot(const ReaderParametersSnapshot& snapshot)
+{
+    ReaderParametersSnapshotOf<Parameters>::apply(snapshot, &m_params);
+}
+
 Span<const Format> DxfFactoryReader::formats() const
 {
     static const Format arrayFormat[] = { Format_DXF };
@@ -290,37 +787,385 @@ std::unique_ptr<PropertyGroup> DxfFactoryReader::createProperties(Format format,
     return {};
 }
 
+class DxfWriter::Properties : public PropertyGroup {
+    MAYO_DECLARE_TEXT_ID_FUNCTIONS(Mayo::IO::DxfWriter::Properties)
+public:
+    Properties(PropertyGroup* parentGroup)
+        : PropertyGroup(parentGroup)
+    {
+        this->projection.setDescription(
+                    textIdTr("View projection of the shapes, only the visible edges are written.\n\n"
+                             "With `None` the edges are written as they are, without hidden line removal"));
+        this->projection.mutableEnumeration().changeTrContext(this->textIdContext());
+        this->chordalDeflection.setDescription(
+                    textIdTr("Maximum distance between an edge and its polyline approximation, for "
+                             "edges which are not straight lines or arcs"));
+        this->angularDeflection.setDescription(
+                    textIdTr("Maximum angle between two consecutive segments of a polyline approximation"));
+    }
+
+    void restoreDefaults() override {
+        const DxfWriter::Parameters params;
+        this->projection.setValue(params.projection);
+        this->chordalDeflection.setQuantity(params.chordalDeflection * Quantity_Millimeter);
+        this->angularDeflection.setQuantity(params.angularDeflection * Quantity_Radian);
+    }
+
+    PropertyEnum<DxfWriter::Projection> projection{ this, textId("projection") };
+    PropertyLength chordalDeflection{ this, textId("chordalDeflection") };
+    PropertyAngle angularDeflection{ this, textId("angularDeflection") };
+};
+
+bool DxfWriter::transfer(Span<const ApplicationItem> appItems, TaskProgress* /*progress*/)
+{
+    m_vecLayerShape.clear();
+    auto fnAddLayerShape = [&](const TDF_Label& label) {
+        const TopoDS_Shape shape = XCaf::shape(label);
+        if (!shape.IsNull())
+            this->addShape(to_stdString(CafUtils::labelAttrStdName(label)), shape);
+    };
+
+    for (const ApplicationItem& item : appItems) {
+        if (item.isDocument()) {
+            for (const TDF_Label& label : item.document()->xcaf().topLevelFreeShapes())
+                fnAddLayerShape(label);
+        }
+        else if (item.isDocumentTreeNode()) {
+            fnAddLayerShape(item.documentTreeNode().label());
+        }
+    }
+
+    return true;
+}
+
+void DxfWriter::addShape(const std::string& name, const TopoDS_Shape& shape)
+{
+    // Each shape goes into its own layer, "0" is the default layer always written by CDxfWrite
+    auto fnLayerExists = [&](const std::string& layerName) {
+        return layerName == "0"
+                || std::any_of(m_vecLayerShape.cbegin(), m_vecLayerShape.cend(), [&](const LayerShape& layer) {
+            return layer.layerName == layerName;
+        });
+    };
+
+    const std::string baseLayerName = dxfLayerName(name);
+    std::string layerName = baseLayerName;
+    for (int i = 2; fnLayerExists(layerName); ++i)
+        layerName = baseLayerName + "_" + std::to_string(i);
+
+    m_vecLayerShape.push_back({ layerName, shape });
+}
+
+bool DxfWriter::writeFile(const FilePath& filepath, TaskProgress* progress)
+{
+    // Hidden line removal and discretization of the shapes are independent, so they run concurrently
+    const size_t count = m_vecLayerShape.size();
+    std::vector<DxfEdgeEntities> vecEntities(count);
+    std::atomic<int> failureCount = 0;
+    {
+        const int threadCount = std::max(1, int(std::thread::hardware_concurrency()));
+        const int taskCount = int(std::clamp<size_t>(count, 1, threadCount));
+        TaskProgress entitiesProgress(progress, 80);
+        const bool ok = TaskManager::runConcurrently(taskCount, &entitiesProgress, [&](int iTask, TaskProgress* taskProgress) {
+            const size_t first = (iTask * count) / taskCount;
+            const size_t last = ((iTask + 1) * count) / taskCount;
+            for (size_t i = first; i < last; ++i) {
+                if (TaskProgress::isAbortRequested(taskProgress))
+                    return;
+
+                try {
+                    const TopoDS_Shape edges = dxfVisibleEdges(m_vecLayerShape.at(i).shape, m_params.projection);
+                    vecEntities.at(i) = dxfEdgeEntities(edges, m_params);
+                } catch (const Standard_Failure&) {
+                    ++failureCount;
+                }
+
+                taskProgress->setValue(MathUtils::mappedValue(i + 1, first, last, 0, 100));
+            }
+        });
+        if (!ok)
+            return false;
+    }
+
+    if (failureCount > 0 && this->messenger())
+        this->messenger()->emitWarning(QString("DxfWriter - Failed to compute edges of %1 shape(s)").arg(int(failureCount)));
+
+    CDxfWrite writer(filepath.u8string().c_str());
+    if (writer.Failed())
+        return false;
+
+    TaskProgress writeProgress(progress, 20);
+    writer.init();
+    for (size_t i = 0; i < count; ++i) {
+        writer.setLayerName(m_vecLayerShape.at(i).layerName);
+        dxfWriteEntities(writer, vecEntities.at(i));
+        writeProgress.setValue(MathUtils::mappedValue(i + 1, 0, count, 0, 90));
+    }
+
+    writer.endRun();
+    return !writer.Failed();
+}
+
+std::unique_ptr<PropertyGroup> DxfWriter::createProperties(PropertyGroup* parentGroup)
+{
+    return std::make_unique<Properties>(parentGroup);
+}
+
+void DxfWriter::applyProperties(const PropertyGroup* group)
+{
+    auto ptr = dynamic_cast<const Properties*>(group);
+    if (ptr) {
+        m_params.projection = ptr->projection;
+        m_params.chordalDeflection = UnitSystem::millimeters(ptr->chordalDeflection.quantity());
+        m_params.angularDeflection = UnitSystem::radians(ptr->angularDeflection.quantity());
+    }
+}
+
+Span<const Format> DxfFactoryWriter::formats() const
+{
+    static const Format arrayFormat[] = { Format_DXF };
+    return arrayFormat;
+}
+
+std::unique_ptr<Writer> DxfFactoryWriter::create(Format format) const
+{
+    if (format == Format_DXF)
+        return std::make_unique<DxfWriter>();
+
+    return {};
+}
+
+std::unique_ptr<PropertyGroup> DxfFactoryWriter::createProperties(Format format, PropertyGroup* parentGroup) const
+{
+    if (format == Format_DXF)
+        return DxfWriter::createProperties(parentGroup);
+
+    return {};
+}
+
+void DxfReader::Internal::setParameters(const DxfReader::Parameters& params)
+{
+    m_params = params;
+    m_setLayerWhitelist.clear();
+    m_setLayerBlacklist.clear();
+    for (const std::string& layerName : params.layerWhitelist)
+        m_setLayerWhitelist.insert(upperLayerName(layerName));
+
+    for (const std::string& layerName : params.layerBlacklist)
+        m_setLayerBlacklist.insert(upperLayerName(layerName));
+}
+
 void DxfReader::Internal::get_line()
 {
     CDxfRead::get_line();
     m_fileReadSize += this->gcount();
-    if (m_progress)
+    // Progress and abort request are checked once per chunk of input, not to slow down tokenization
+    if (m_progress && m_fileReadSize >= m_nextProgressReadSize) {
+        constexpr std::uintmax_t progressChunkSize = 256 * 1024;
+        m_nextProgressReadSize = m_fileReadSize + progressChunkSize;
         m_progress->setValue(MathUtils::mappedValue(m_fileReadSize, 0, m_fileSize, 0, 100));
+        if (TaskProgress::isAbortRequested(m_progress)) {
+            m_abortRequested = true;
+            this->StopRead();
+        }
+    }
 }
 
-DxfReader::Internal::Internal(const FilePath& filepath, TaskProgress* progress)
-    : CDxfRead(filepath.u8string().c_str()),
-      m_progress(progress)
+DxfReader::Internal::Internal(std::string_view fileContents)
+    : CDxfRead(fileContents.data(), fileContents.size()),
+      m_allocator(newArena()),
+      m_vecPrimitive(m_allocator),
+      m_vecSplineData(m_allocator),
+      m_vecPolylineData(m_allocator),
+      m_vecShape(m_allocator),
+      m_fileSize(fileContents.size())
 {
-    if (!this->Failed())
-        m_fileSize = std::filesystem::file_size(filepath);
+    // Arena never reuses memory of a grown array, so avoid most of the reallocations
+    // Note: a DXF entity takes at least a few hundreds of bytes in the file
+    m_vecPrimitive.reserve(fileContents.size() / 512);
+}
+
+bool DxfReader::Internal::buildShapes(TaskProgress* progress)
+{
+    MAYO_PROFILE_ZONE("DxfReader::buildShapes");
+    const size_t count = m_vecPrimitive.size();
+    ArenaVector<TopoDS_Shape> vecShape(count, TopoDS_Shape(), m_allocator);
+    std::atomic<int> failureCount = 0;
+    const int taskCount = concurrentTaskCount(count);
+    const bool ok = TaskManager::runConcurrently(taskCount, progress, [&](int iTask, TaskProgress* taskProgress) {
+        const size_t first = (iTask * count) / taskCount;
+        const size_t last = ((iTask + 1) * count) / taskCount;
+        for (size_t i = first; i < last; ++i) {
+            if ((i - first) % 1024 == 0) {
+                taskProgress->setValue(MathUtils::mappedValue(i, first, last, 0, 100));
+                if (TaskProgress::isAbortRequested(taskProgress))
+                    return;
+            }
+
+            try {
+                vecShape.at(i) = this->buildShape(m_vecPrimitive.at(i));
+            } catch (const Standard_Failure&) {
+                ++failureCount;
+            }
+        }
+    });
+    if (!ok)
+        return false;
+
+    if (failureCount > 0)
+        m_messenger->emitWarning(QString("DxfReader - Failed to create %1 shape(s)").arg(int(failureCount)));
+
+    // Group shapes by layer or block, in the order of the file
+    for (size_t i = 0; i < count; ++i) {
+        const Primitive& primitive = m_vecPrimitive.at(i);
+        if (vecShape.at(i).IsNull())
+            continue;
+
+        const DxfReader::Entity entity{ primitive.aci, vecShape.at(i) };
+        if (primitive.blockIndex >= 0)
+            this->block(m_vecBlockName.at(primitive.blockIndex)).entities.push_back(entity);
+        else
+            this->layerEntities(m_vecLayerName.at(primitive.layerIndex)).push_back(entity);
+    }
+
+    m_vecPrimitive.clear();
+    m_vecSplineData.clear();
+    m_vecPolylineData.clear();
+    m_vecShape.clear();
+    return true;
+}
+
+TopoDS_Shape DxfReader::Internal::buildShape(const Primitive& primitive) const
+{
+    switch (primitive.type) {
+    case Primitive::Type::Line:
+        return BRepBuilderAPI_MakeEdge(primitive.p0, primitive.p1).Edge();
+    case Primitive::Type::Point:
+        return BRepBuilderAPI_MakeVertex(primitive.p0).Vertex();
+    case Primitive::Type::Arc:
+        return BRepBuilderAPI_MakeEdge(gp_Circ(primitive.axes, primitive.radius1), primitive.p0, primitive.p1).Edge();
+    case Primitive::Type::Circle:
+        return BRepBuilderAPI_MakeEdge(gp_Circ(primitive.axes, primitive.radius1)).Edge();
+    case Primitive::Type::Ellipse:
+        return BRepBuilderAPI_MakeEdge(gp_Elips(primitive.axes, primitive.radius1, primitive.radius2)).Edge();
+    case Primitive::Type::Spline: {
+        const SplineData& sd = m_vecSplineData.at(primitive.dataIndex);
+        Handle_Geom_BSplineCurve geom;
+        if (sd.control_points > 0)
+            geom = createSplineFromPolesAndKnots(sd);
+        else if (sd.fit_points > 0)
+            geom = createInterpolationSpline(sd);
+
+        if (geom.IsNull())
+            throw Standard_Failure();
+
+        return BRepBuilderAPI_MakeEdge(geom).Edge();
+    }
+    case Primitive::Type::Polyline:
+        return this->buildPolylineShape(m_vecPolylineData.at(primitive.dataIndex));
+    case Primitive::Type::Shape:
+        return m_vecShape.at(primitive.dataIndex);
+    }
+
+    return {};
+}
+
+TopoDS_Shape DxfReader::Internal::buildPolylineShape(const PolylineData& pd) const
+{
+    // Consecutive coincident vertices are merged, bulge of a vertex applies to the segment it starts
+    std::vector<gp_Pnt> vecPnt;
+    std::vector<double> vecBulge;
+    for (const PolylineVertex& vertex : pd.vertices) {
+        const double coords[3] = { vertex.x, vertex.y, vertex.z };
+        const gp_Pnt pnt = this->toPnt(coords);
+        if (!vecPnt.empty() && pnt.IsEqual(vecPnt.back(), Precision::Confusion())) {
+            vecBulge.back() = vertex.bulge;
+            continue;
+        }
+
+        vecPnt.push_back(pnt);
+        vecBulge.push_back(vertex.bulge);
+    }
+
+    if (pd.closed && vecPnt.size() > 1 && !vecPnt.front().IsEqual(vecPnt.back(), Precision::Confusion())) {
+        vecPnt.push_back(vecPnt.front());
+        vecBulge.push_back(0.);
+    }
+
+    if (vecPnt.size() < 2)
+        return {};
+
+    const auto segmentCount = vecPnt.size() - 1;
+    const bool hasArcSegment = std::any_of(vecBulge.cbegin(), vecBulge.cbegin() + segmentCount, [](double bulge) {
+        return bulge != 0.;
+    });
+    if (!hasArcSegment) {
+        // Single edge on a degree 1 BSpline curve, the exact polygon is attached so it's displayed
+        // as is instead of being discretized
+        const int pntCount = int(vecPnt.size());
+        TColgp_Array1OfPnt poles(1, pntCount);
+        TColStd_Array1OfReal knots(1, pntCount);
+        TColStd_Array1OfInteger mults(1, pntCount);
+        for (int i = 1; i <= pntCount; ++i) {
+            poles.ChangeValue(i) = vecPnt.at(i - 1);
+            knots.ChangeValue(i) = i - 1;
+            mults.ChangeValue(i) = 1;
+        }
+
+        mults.ChangeValue(1) = 2;
+        mults.ChangeValue(pntCount) = 2;
+        const Handle_Geom_BSplineCurve curve = new Geom_BSplineCurve(poles, knots, mults, 1);
+        const TopoDS_Edge edge = BRepBuilderAPI_MakeEdge(curve).Edge();
+        BRep_Builder().UpdateEdge(edge, new Poly_Polygon3D(poles, knots));
+        return edge;
+    }
+
+    // Same arc construction as CDxfRead when polylines are reported segment by segment
+    BRepBuilderAPI_MakeWire makeWire;
+    for (size_t i = 0; i < segmentCount; ++i) {
+        const gp_Pnt& p0 = vecPnt.at(i);
+        const gp_Pnt& p1 = vecPnt.at(i + 1);
+        const double bulge = vecBulge.at(i);
+        if (bulge != 0.) {
+            const double cot = 0.5 * ((1. / bulge) - bulge);
+            const gp_Pnt pc(((p0.X() + p1.X()) - ((p1.Y() - p0.Y()) * cot)) / 2.,
+                            ((p0.Y() + p1.Y()) + ((p1.X() - p0.X()) * cot)) / 2.,
+                            (p0.Z() + p1.Z()) / 2.);
+            const gp_Dir up = bulge >= 0 ? gp::DZ() : -gp::DZ();
+            makeWire.Add(BRepBuilderAPI_MakeEdge(gp_Circ(gp_Ax2(pc, up), p0.Distance(pc)), p0, p1).Edge());
+        }
+        else {
+            makeWire.Add(BRepBuilderAPI_MakeEdge(p0, p1).Edge());
+        }
+    }
+
+    return makeWire.Wire();
 }
 
 void DxfReader::Internal::OnReadLine(const double* s, const double* e, bool /*hidden*/)
 {
     const gp_Pnt p0 = this->toPnt(s);
     const gp_Pnt p1 = this->toPnt(e);
-    if (p0.IsEqual(p1, Precision::Confusion()))
+    if (p0.IsEqual(p1, Precision::Confusion()) || this->isEntityFiltered({ p0, p1 }))
         return;
 
-    const TopoDS_Edge edge = BRepBuilderAPI_MakeEdge(p0, p1);
-    this->addShape(edge);
+    Primitive primitive;
+    primitive.type = Primitive::Type::Line;
+    primitive.p0 = p0;
+    primitive.p1 = p1;
+    this->addPrimitive(std::move(primitive));
 }
 
 void DxfReader::Internal::OnReadPoint(const double* s)
 {
-    const TopoDS_Vertex vertex = BRepBuilderAPI_MakeVertex(this->toPnt(s));
-    this->addShape(vertex);
+    const gp_Pnt pnt = this->toPnt(s);
+    if (this->isEntityFiltered({ pnt }))
+        return;
+
+    Primitive primitive;
+    primitive.type = Primitive::Type::Point;
+    primitive.p0 = pnt;
+    this->addPrimitive(std::move(primitive));
 }
 
 void DxfReader::Internal::OnReadText(const double* point, const double height, double rotation, const char* text)
@@ -329,27 +1174,44 @@ void DxfReader::Internal::OnReadText(const double* point, const double height, d
         return;
 
     const gp_Pnt pt = this->toPnt(point);
+    const double fontHeight = 4 * height * m_params.scaling;
+    // Text extent isn't known before its shape is built, region filtering is approximate
+    if (this->isEntityFiltered({ pt }, fontHeight))
+        return;
+
     const std::string layerName = this->LayerName();
     if (!startsWith(layerName, "BLOCKS")) {
-        const std::string& fontName = m_params.fontNameForTextObjects;
-        const double fontHeight = 4 * height * m_params.scaling;
-        Font_BRepFont brepFont;
-        if (brepFont.Init(fontName.c_str(), Font_FA_Regular, fontHeight)) {
+        const Handle_Font_BRepFont brepFont = this->findFont(fontHeight);
+        if (!brepFont.IsNull()) {
             gp_Trsf rotTrsf;
             if (rotation != 0.)
                 rotTrsf.SetRotation(gp_Ax1(pt, gp::DZ()), UnitSystem::radians(rotation * Quantity_Degree));
 
             const gp_Ax3 locText(pt, gp::DZ(), gp::DX().Transformed(rotTrsf));
-            Font_BRepTextBuilder brepTextBuilder;
-            const TopoDS_Shape shapeText = brepTextBuilder.Perform(brepFont, text, locText);
+            const TopoDS_Shape shapeText = m_brepTextBuilder.Perform(*brepFont, text, locText);
             this->addShape(shapeText);
         }
-        else {
-            m_messenger->emitWarning(QString("Font_BRepFont is null for '%1'").arg(to_QString(fontName)));
-        }
     }
 }
 
+Handle_Font_BRepFont DxfReader::Internal::findFont(double height)
+{
+    auto itFont = m_mapHeightFont.find(height);
+    if (itFont != m_mapHeightFont.cend())
+        return itFont->second;
+
+    // Null font is kept too, so failure is reported only once per height
+    const std::string& fontName = m_params.fontNameForTextObjects;
+    Handle_Font_BRepFont brepFont = new Font_BRepFont;
+    if (!brepFont->Init(fontName.c_str(), Font_FA_Regular, height)) {
+        m_messenger->emitWarning(QString("Font_BRepFont is null for '%1'").arg(to_QString(fontName)));
+        brepFont.Nullify();
+    }
+
+    m_mapHeightFont.insert({ height, brepFont });
+    return brepFont;
+}
+
 // Excerpted from FreeCad/src/Mod/Import/App/ImpExpDxf
 void DxfReader::Internal::OnReadArc(const double* s, const double* e, const double* c, bool dir, bool /*hidden*/)
 {
@@ -358,9 +1220,17 @@ void DxfReader::Internal::OnReadArc(const double* s, const double* e, const doub
     const gp_Dir up = dir ? gp::DZ() : -gp::DZ();
     const gp_Pnt pc = this->toPnt(c);
     const gp_Circ circle(gp_Ax2(pc, up), p0.Distance(pc));
+    if (this->isEntityFiltered({ pc }, circle.Radius()))
+        return;
+
     if (circle.Radius() > 0) {
-        const TopoDS_Edge edge = BRepBuilderAPI_MakeEdge(circle, p0, p1);
-        this->addShape(edge);
+        Primitive primitive;
+        primitive.type = Primitive::Type::Arc;
+        primitive.p0 = p0;
+        primitive.p1 = p1;
+        primitive.axes = circle.Position();
+        primitive.radius1 = circle.Radius();
+        this->addPrimitive(std::move(primitive));
     }
     else {
         m_messenger->emitWarning("DxfReader - Ignore degenerate arc of circle");
@@ -374,9 +1244,15 @@ void DxfReader::Internal::OnReadCircle(const double* s, const double* c, bool di
     const gp_Dir up = dir ? gp::DZ() : -gp::DZ();
     const gp_Pnt pc = this->toPnt(c);
     const gp_Circ circle(gp_Ax2(pc, up), p0.Distance(pc));
+    if (this->isEntityFiltered({ pc }, circle.Radius()))
+        return;
+
     if (circle.Radius() > 0) {
-        const TopoDS_Edge edge = BRepBuilderAPI_MakeEdge(circle);
-        this->addShape(edge);
+        Primitive primitive;
+        primitive.type = Primitive::Type::Circle;
+        primitive.axes = circle.Position();
+        primitive.radius1 = circle.Radius();
+        this->addPrimitive(std::move(primitive));
     }
     else {
         m_messenger->emitWarning("DxfReader - Ignore degenerate circle");
@@ -398,9 +1274,16 @@ void DxfReader::Internal::OnReadEllipse(
                 major_radius * m_params.scaling,
                 minor_radius * m_params.scaling);
     ellipse.Rotate(gp_Ax1(pc, up), rotation);
+    if (this->isEntityFiltered({ pc }, ellipse.MajorRadius()))
+        return;
+
     if (ellipse.MinorRadius() > 0) {
-        const TopoDS_Edge edge = BRepBuilderAPI_MakeEdge(ellipse);
-        this->addShape(edge);
+        Primitive primitive;
+        primitive.type = Primitive::Type::Ellipse;
+        primitive.axes = ellipse.Position();
+        primitive.radius1 = ellipse.MajorRadius();
+        primitive.radius2 = ellipse.MinorRadius();
+        this->addPrimitive(std::move(primitive));
     }
     else {
         m_messenger->emitWarning("DxfReader - Ignore degenerate ellipse");
@@ -413,58 +1296,74 @@ void DxfReader::Internal::OnReadSpline(SplineData& sd)
     // https://documentation.help/AutoCAD-DXF/WS1a9193826455f5ff18cb41610ec0a2e719-79e1.htm
     // Flags:
     // 1: Closed, 2: Periodic, 4: Rational, 8: Planar, 16: Linear
+    // Spline curve is created by buildShapes()
+    Bnd_Box2d bndBox;
+    if (!m_params.regionFilter.IsVoid()) {
+        // Spline curve lies within the convex hull of its poles
+        auto fnAddPoints = [&](const std::list<double>& listX, const std::list<double>& listY) {
+            auto itY = listY.cbegin();
+            for (auto itX = listX.cbegin(); itX != listX.cend() && itY != listY.cend(); ++itX, ++itY)
+                bndBox.Add(gp_Pnt2d(*itX * m_params.scaling, *itY * m_params.scaling));
+        };
+        fnAddPoints(sd.controlx, sd.controly);
+        fnAddPoints(sd.fitx, sd.fity);
+    }
 
-    try {
-        Handle_Geom_BSplineCurve geom;
-        if (sd.control_points > 0)
-            geom = createSplineFromPolesAndKnots(sd);
-        else if (sd.fit_points > 0)
-            geom = createInterpolationSpline(sd);
+    if (this->isEntityFiltered(bndBox))
+        return;
 
-        if (geom.IsNull())
-            throw Standard_Failure();
+    Primitive primitive;
+    primitive.type = Primitive::Type::Spline;
+    primitive.dataIndex = int(m_vecSplineData.size());
+    m_vecSplineData.push_back(std::move(sd));
+    this->addPrimitive(std::move(primitive));
+}
 
-        const TopoDS_Edge edge = BRepBuilderAPI_MakeEdge(geom);
-        this->addShape(edge);
-    }
-    catch (const Standard_Failure&) {
-        m_messenger->emitWarning("DxfReader - Failed to create bspline");
+bool DxfReader::Internal::OnReadPolyline(const PolylineData& pd)
+{
+    if (!m_params.mergePolylineSegments)
+        return false;
+
+    Bnd_Box2d bndBox;
+    if (!m_params.regionFilter.IsVoid()) {
+        for (const PolylineVertex& vertex : pd.vertices)
+            bndBox.Add(gp_Pnt2d(vertex.x * m_params.scaling, vertex.y * m_params.scaling));
     }
+
+    if (this->isEntityFiltered(bndBox))
+        return true;
+
+    // Polyline shape is created by buildShapes()
+    Primitive primitive;
+    primitive.type = Primitive::Type::Polyline;
+    primitive.dataIndex = int(m_vecPolylineData.size());
+    m_vecPolylineData.push_back(pd);
+    this->addPrimitive(std::move(primitive));
+    return true;
 }
 
 // Excerpted from FreeCad/src/Mod/Import/App/ImpExpDxf
 void DxfReader::Internal::OnReadInsert(const double* point, const double* scale, const char* name, double rotation)
 {
-    //std::cout << "Inserting block " << name << " rotation " << rotation << " pos " << point[0] << "," << point[1] << "," << point[2] << " scale " << scale[0] << "," << scale[1] << "," << scale[2] << std::endl;
-    const std::string prefix = std::string("BLOCKS ") + name + " ";
-    for (const auto& [k, vecEntity] : m_layers) {
-        if (!startsWith(k, prefix))
-            continue; // Skip
-
-        BRep_Builder builder;
-        TopoDS_Compound comp;
-        builder.MakeCompound(comp);
-        for (const DxfReader::Entity& entity : vecEntity) {
-            if (!entity.shape.IsNull())
-                builder.Add(comp, entity.shape);
-        }
-
-        if (comp.IsNull())
-            continue; // Skip
+    // Block shapes aren't copied, DxfReader::transfer() creates a located reference to the block
+    // Block extent isn't known at this point, region filtering applies to the insertion point
+    if (this->isEntityFiltered({ this->toPnt(point) }))
+        return;
 
-        gp_Trsf trsfScale;
-        trsfScale.SetValues(
-                scale[0], 0,        0,        0,
-                0,        scale[1], 0,        0,
-                0,        0,        scale[2], 0);
-        gp_Trsf trsfRotZ;
-        trsfRotZ.SetRotation(gp::OZ(), rotation);
-        gp_Trsf trsfMove;
-        trsfMove.SetTranslation(this->toPnt(point).XYZ());
-        const gp_Trsf trsf = trsfScale * trsfRotZ * trsfMove;
-        comp.Location(trsf);
-        this->addShape(comp);
-    }
+    gp_Trsf trsfScale;
+    trsfScale.SetValues(
+            scale[0], 0,        0,        0,
+            0,        scale[1], 0,        0,
+            0,        0,        scale[2], 0);
+    gp_Trsf trsfRotZ;
+    trsfRotZ.SetRotation(gp::OZ(), rotation);
+    gp_Trsf trsfMove;
+    trsfMove.SetTranslation(this->toPnt(point).XYZ());
+    const DxfReader::Insert insert{ name, trsfScale * trsfRotZ * trsfMove };
+    if (this->IsBlocksSection())
+        this->block(this->BlockName()).inserts.push_back(insert);
+    else
+        m_layerInserts[this->LayerName()].push_back(insert);
 }
 
 void DxfReader::Internal::OnReadDimension(const double* s, const double* e, const double* point, double rotation)
@@ -483,6 +1382,10 @@ void DxfReader::Internal::OnReadDimension(const double* s, const double* e, cons
 
 void DxfReader::Internal::ReportError(const char* msg)
 {
+    // Entity being read when abort was requested is truncated, this isn't an error
+    if (m_abortRequested)
+        return;
+
     m_messenger->emitError(msg);
 }
 
@@ -500,23 +1403,76 @@ gp_Pnt DxfReader::Internal::toPnt(const double* coords) const
     return gp_Pnt(sp1, sp2, sp3);
 }
 
-void DxfReader::Internal::addShape(const TopoDS_Shape& shape)
+bool DxfReader::Internal::isEntityFiltered(const Bnd_Box2d& bndBox) const
 {
-    const Entity newEntity{ m_aci, shape };
-    const std::string layerName = this->LayerName();
-    auto itFound = m_layers.find(layerName);
-    if (itFound != m_layers.end()) {
-        std::vector<DxfReader::Entity>& vecEntity = itFound->second;
-        vecEntity.push_back(newEntity);
+    if (this->IsBlocksSection())
+        return false;
+
+    if (!m_setLayerWhitelist.empty() || !m_setLayerBlacklist.empty()) {
+        const std::string layerName = upperLayerName(this->EntityLayerName());
+        if (!m_setLayerWhitelist.empty() && m_setLayerWhitelist.find(layerName) == m_setLayerWhitelist.cend())
+            return true;
+
+        if (m_setLayerBlacklist.find(layerName) != m_setLayerBlacklist.cend())
+            return true;
     }
-    else {
-        decltype(m_layers)::value_type pair(std::move(layerName), { newEntity });
-        m_layers.insert(std::move(pair));
+
+    return !m_params.regionFilter.IsVoid() && !bndBox.IsVoid() && bndBox.IsOut(m_params.regionFilter);
+}
+
+bool DxfReader::Internal::isEntityFiltered(std::initializer_list<gp_Pnt> points, double gap) const
+{
+    Bnd_Box2d bndBox;
+    if (!m_params.regionFilter.IsVoid()) {
+        for (const gp_Pnt& pnt : points)
+            bndBox.Add(gp_Pnt2d(pnt.X(), pnt.Y()));
+
+        bndBox.Enlarge(gap);
+    }
+
+    return this->isEntityFiltered(bndBox);
+}
+
+void DxfReader::Internal::addShape(const TopoDS_Shape& shape)
+{
+    Primitive primitive;
+    primitive.type = Primitive::Type::Shape;
+    primitive.dataIndex = int(m_vecShape.size());
+    m_vecShape.push_back(shape);
+    this->addPrimitive(std::move(primitive));
+}
+
+void DxfReader::Internal::addPrimitive(Primitive&& primitive)
+{
+    // Entities of block definitions are grouped by block, to be found directly for inserts
+    if (this->IsBlocksSection())
+        primitive.blockIndex = internedNameIndex(this->BlockName(), m_vecBlockName, m_mapBlockNameIndex);
+    else
+        primitive.layerIndex = internedNameIndex(this->LayerName(), m_vecLayerName, m_mapLayerNameIndex);
+
+    primitive.aci = m_aci;
+    m_vecPrimitive.push_back(std::move(primitive));
+}
+
+ArenaVector<DxfReader::Entity>& DxfReader::Internal::layerEntities(const std::string& layerName)
+{
+    // Vector is constructed with the arena allocator only if layer isn't yet in the map
+    return m_layers.try_emplace(layerName, ArenaAllocator<DxfReader::Entity>(m_allocator)).first->second;
+}
+
+DxfReader::Block& DxfReader::Internal::block(const std::string& blockName)
+{
+    auto it = m_blocks.find(blockName);
+    if (it == m_blocks.end()) {
+        DxfReader::Block block{ ArenaVector<DxfReader::Entity>(m_allocator), {} };
+        it = m_blocks.insert({ blockName, std::move(block) }).first;
     }
+
+    return it->second;
 }
 
 // Excerpted from FreeCad/src/Mod/Import/App/ImpExpDxf
-Handle_Geom_BSplineCurve DxfReader::Internal::createSplineFromPolesAndKnots(struct SplineData& sd)
+Handle_Geom_BSplineCurve DxfReader::Internal::createSplineFromPolesAndKnots(const SplineData& sd)
 {
     const size_t numPoles = sd.control_points;
     if (sd.controlx.size() > numPoles
@@ -574,7 +1530,7 @@ Handle_Geom_BSplineCurve DxfReader::Internal::createSplineFromPolesAndKnots(stru
 }
 
 // Excerpted from FreeCad/src/Mod/Import/App/ImpExpDxf
-Handle_Geom_BSplineCurve DxfReader::Internal::createInterpolationSpline(struct SplineData& sd)
+Handle_Geom_BSplineCurve DxfReader::Internal::createInterpolationSpline(const SplineData& sd)
 {
     const size_t numPoints = sd.fit_points;
     if (sd.fitx.size() > numPoints || sd.fity.size() > numPoints || sd.fitz.size() > numPoints)
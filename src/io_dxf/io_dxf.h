@@ -6,10 +6,15 @@
 
 #pragma once
 
+#include "../base/arena_allocator.h"
 #include "../base/io_reader.h"
+#include "../base/io_writer.h"
+#include <Bnd_Box2d.hxx>
+#include <gp_Trsf.hxx>
 #include <TopoDS_Shape.hxx>
 #include <unordered_map>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace Mayo {
@@ -19,29 +24,60 @@ namespace IO {
 class DxfReader : public Reader {
 public:
     bool readFile(const FilePath& filepath, TaskProgress* progress) override;
+    bool readBuffer(Span<const uint8_t> data, const FilePath& nameHint, TaskProgress* progress) override;
     TDF_LabelSequence transfer(DocumentPtr doc, TaskProgress* progress) override;
 
     struct Parameters {
         double scaling = 1.;
+        // Scaling is recorded as a deferred scaling of the imported entities(see
+        // Document::setDeferredScaling()) instead of being applied on the coordinates
+        bool deferScaling = false;
         bool importAnnotations = true;
         bool groupLayers = true;
         std::string fontNameForTextObjects = "Arial";
+        bool mergePolylineSegments = false; // One shape per polyline instead of one edge per segment
+        // Layer filters, names are case-insensitive. All layers are imported if the whitelist is empty
+        std::vector<std::string> layerWhitelist;
+        std::vector<std::string> layerBlacklist;
+        // Entities whose XY bounding box is outside this region are skipped, no filter if void
+        Bnd_Box2d regionFilter;
     };
     Parameters& parameters() { return m_params; }
     const Parameters& constParameters() const { return m_params; }
 
     static std::unique_ptr<PropertyGroup> createProperties(PropertyGroup* parentGroup);
     void applyProperties(const PropertyGroup* params) override;
+    ReaderParametersSnapshotPtr createParametersSnapshot() const override;
+    void applyParametersSnapshot(const ReaderParametersSnapshot& snapshot) override;
 
 private:
     class Properties;
     class Internal;
 
+    bool readContents(std::string_view contents, TaskProgress* progress);
+
     struct Entity {
         int aci = 0;
         TopoDS_Shape shape;
     };
-    std::unordered_map<std::string, std::vector<Entity>> m_layers;
+    // Reference to a block definition, shapes of the block are shared by all its inserts
+    struct Insert {
+        std::string blockName;
+        gp_Trsf trsf;
+    };
+
+    // Contents of a block definition
+    struct Block {
+        ArenaVector<Entity> entities;
+        std::vector<Insert> inserts;
+    };
+
+    // Entities and inserts outside of block definitions, by layer name
+    // Entity arrays are allocated within the arena of the readFile() call, released at once when
+    // the arrays are cleared by next readFile() or destroyed along with the reader
+    std::unordered_map<std::string, ArenaVector<Entity>> m_layers;
+    std::unordered_map<std::string, std::vector<Insert>> m_layerInserts;
+    std::unordered_map<std::string, Block> m_blocks; // Key is the block name
     Parameters m_params;
 };
 
@@ -52,5 +88,50 @@ public:
     std::unique_ptr<PropertyGroup> createProperties(Format format, PropertyGroup* parentGroup) const override;
 };
 
+// Writer for DXF file format based on FreeCad's CDxfWrite
+// Edges of the shapes are written as 2D entities(lines, arcs, polylines) in DXF R12 format. Shapes
+// are optionally projected on a view plane, keeping only visible edges(hidden line removal)
+class DxfWriter : public Writer {
+public:
+    bool transfer(Span<const ApplicationItem> appItems, TaskProgress* progress) override;
+    bool writeFile(const FilePath& filepath, TaskProgress* progress) override;
+
+    // Adds 'shape' to be written in a layer named after 'name', for shapes not owned by a document
+    void addShape(const std::string& name, const TopoDS_Shape& shape);
+
+    static std::unique_ptr<PropertyGroup> createProperties(PropertyGroup* parentGroup);
+    void applyProperties(const PropertyGroup* params) override;
+
+    // Parameters
+    enum class Projection { None, Top, Front, Right };
+
+    struct Parameters {
+        Projection projection = Projection::Top;
+        double chordalDeflection = 0.1; // Used for the discretization of non linear/circular edges
+        double angularDeflection = 0.35; // Radians
+    };
+    Parameters& parameters() { return m_params; }
+    const Parameters& constParameters() const { return m_params; }
+
+private:
+    class Properties;
+
+    // Shape to be written within its own layer
+    struct LayerShape {
+        std::string layerName;
+        TopoDS_Shape shape;
+    };
+
+    Parameters m_params;
+    std::vector<LayerShape> m_vecLayerShape;
+};
+
+class DxfFactoryWriter : public FactoryWriter {
+public:
+    Span<const Format> formats() const override;
+    std::unique_ptr<Writer> create(Format format) const override;
+    std::unique_ptr<PropertyGroup> createProperties(Format format, PropertyGroup* parentGroup) const override;
+};
+
 } // namespace IO
 } // namespace Mayo
@@ -6,14 +6,36 @@
 
 #include "io_gmio.h"
 
+#include "io_gmio_3mf_reader.h"
+#include "io_gmio_3mf_writer.h"
 #include "io_gmio_amf_writer.h"
 
 namespace Mayo {
 namespace IO {
 
+Span<const Format> GmioFactoryReader::formats() const
+{
+    static const Format array[] = { Format_3MF };
+    return array;
+}
+
+std::unique_ptr<Reader> GmioFactoryReader::create(Format format) const
+{
+    if (format == Format_3MF)
+        return std::make_unique<Gmio3mfReader>();
+
+    return {};
+}
+
+std::unique_ptr<PropertyGroup>
+GmioFactoryReader::createProperties(Format /*format*/, PropertyGroup* /*parentGroup*/) const
+{
+    return {};
+}
+
 Span<const Format> GmioFactoryWriter::formats() const
 {
-    static const Format array[] = { Format_AMF };
+    static const Format array[] = { Format_AMF, Format_3MF };
     return array;
 }
 
@@ -21,6 +43,8 @@ std::unique_ptr<Writer> GmioFactoryWriter::create(Format format) const
 {
     if (format == Format_AMF)
         return std::make_unique<GmioAmfWriter>();
+    else if (format == Format_3MF)
+        return std::make_unique<Gmio3mfWriter>();
 
     return {};
 }
@@ -30,6 +54,8 @@ GmioFactoryWriter::createProperties(Format format, PropertyGroup* parentGroup) c
 {
     if (format == Format_AMF)
         return GmioAmfWriter::createProperties(parentGroup);
+    else if (format == Format_3MF)
+        return Gmio3mfWriter::createProperties(parentGroup);
 
     return {};
 }
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include "../base/io_reader.h"
 #include "../base/io_writer.h"
 #include "../base/property.h"
 #include <memory>
@@ -13,6 +14,22 @@
 namespace Mayo {
 namespace IO {
 
+// Provides factory for gmio-based Reader objects
+class GmioFactoryReader : public FactoryReader {
+public:
+    Span<const Format> formats() const override;
+    std::unique_ptr<Reader> create(Format format) const override;
+    std::unique_ptr<PropertyGroup> createProperties(Format format, PropertyGroup* parentGroup) const override;
+
+    static std::unique_ptr<FactoryReader> create() {
+#ifdef HAVE_GMIO
+        return std::make_unique<GmioFactoryReader>();
+#else
+        return {};
+#endif
+    }
+};
+
 // Provides factory for gmio-based Writer objects
 class GmioFactoryWriter : public FactoryWriter {
 public:
@@ -0,0 +1,350 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "io_gmio_3mf_reader.h"
+#include "io_gmio_zip.h"
+
+#include "../base/caf_utils.h"
+#include "../base/document.h"
+#include "../base/math_utils.h"
+#include "../base/string_conv.h"
+#include "../base/task_progress.h"
+#include "../base/tkernel_utils.h"
+
+#include <BRep_Builder.hxx>
+#include <Standard_Failure.hxx>
+#include <TDataStd_Name.hxx>
+#include <TopoDS_Face.hxx>
+#include <XCAFDoc_ColorTool.hxx>
+#include <XCAFDoc_ShapeTool.hxx>
+#include <QtCore/QFile>
+#include <QtCore/QXmlStreamReader>
+#include <algorithm>
+#include <sstream>
+#include <unordered_map>
+
+namespace Mayo {
+namespace IO {
+
+namespace {
+
+void setNode(Poly_Triangulation* mesh, int index, const gp_Pnt& pnt)
+{
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+    mesh->SetNode(index, pnt);
+#else
+    mesh->ChangeNode(index) = pnt;
+#endif
+}
+
+void setTriangle(Poly_Triangulation* mesh, int index, const Poly_Triangle& triangle)
+{
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+    mesh->SetTriangle(index, triangle);
+#else
+    mesh->ChangeTriangle(index) = triangle;
+#endif
+}
+
+// Parses color text "#RRGGBB" or "#RRGGBBAA", components are in sRGB color space
+bool parseHexColor(const QString& text, Quantity_ColorRGBA* color)
+{
+    if (!text.startsWith(QLatin1Char('#')) || (text.size() != 7 && text.size() != 9))
+        return false;
+
+    bool ok = false;
+    uint value = text.mid(1).toUInt(&ok, 16);
+    if (!ok)
+        return false;
+
+    if (text.size() == 7)
+        value = (value << 8) | 0xFF;
+
+    auto fnComponent = [=](int shift) { return ((value >> shift) & 0xFF) / 255.; };
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 5, 0)
+    const Quantity_Color rgb(fnComponent(24), fnComponent(16), fnComponent(8), Quantity_TOC_sRGB);
+#else
+    const Quantity_Color rgb(fnComponent(24), fnComponent(16), fnComponent(8), Quantity_TOC_RGB);
+#endif
+    *color = Quantity_ColorRGBA(rgb, float(fnComponent(0)));
+    return true;
+}
+
+// Parses 3MF transform text "m00 m01 m02 m10 m11 m12 m20 m21 m22 m30 m31 m32"
+// 3MF matrices apply to row vectors, translation is in the last row
+gp_Trsf parseTransform(const QString& text)
+{
+    gp_Trsf trsf;
+    if (text.isEmpty())
+        return trsf;
+
+    std::istringstream istr(text.toStdString());
+    double m[12] = {};
+    for (double& value : m) {
+        if (!(istr >> value))
+            return trsf;
+    }
+
+    try {
+        trsf.SetValues(m[0], m[3], m[6], m[9],
+                       m[1], m[4], m[7], m[10],
+                       m[2], m[5], m[8], m[11]);
+    } catch (const Standard_Failure&) {
+        // Non-orthogonal or singular matrix, not supported by gp_Trsf
+        return gp_Trsf();
+    }
+
+    return trsf;
+}
+
+} // namespace
+
+// Incremental parser of the model XML part, data can be provided by chunks
+class Gmio3mfReader::ModelParser {
+public:
+    ModelParser(Gmio3mfReader* reader)
+        : m_reader(reader)
+    {}
+
+    // Parses tokens of the XML data added so far to 'xml'
+    // Returns false if an error occured(other than data missing)
+    bool parse(QXmlStreamReader* xml)
+    {
+        while (!xml->atEnd() && m_isValid) {
+            const QXmlStreamReader::TokenType token = xml->readNext();
+            if (token == QXmlStreamReader::StartElement)
+                this->onStartElement(*xml);
+            else if (token == QXmlStreamReader::EndElement)
+                this->onEndElement(*xml);
+        }
+
+        if (xml->hasError() && xml->error() != QXmlStreamReader::PrematureEndOfDocumentError)
+            return false;
+
+        return m_isValid;
+    }
+
+private:
+    void onStartElement(const QXmlStreamReader& xml)
+    {
+        const auto name = xml.name();
+        const QXmlStreamAttributes attrs = xml.attributes();
+        auto fnAttrDouble = [&](const char* attr) {
+            return attrs.value(QLatin1String(attr)).toDouble();
+        };
+        auto fnAttrInt = [&](const char* attr) {
+            bool ok = false;
+            const int value = attrs.value(QLatin1String(attr)).toInt(&ok);
+            return ok ? value : -1;
+        };
+
+        if (name == QLatin1String("vertex")) {
+            m_vecNode.emplace_back(fnAttrDouble("x"), fnAttrDouble("y"), fnAttrDouble("z"));
+        }
+        else if (name == QLatin1String("triangle")) {
+            const int nodeCount = int(m_vecNode.size());
+            const int v1 = fnAttrInt("v1");
+            const int v2 = fnAttrInt("v2");
+            const int v3 = fnAttrInt("v3");
+            auto fnIsValidIndex = [=](int index) { return 0 <= index && index < nodeCount; };
+            if (fnIsValidIndex(v1) && fnIsValidIndex(v2) && fnIsValidIndex(v3))
+                m_vecTriangle.emplace_back(v1 + 1, v2 + 1, v3 + 1);
+            else
+                m_isValid = false;
+        }
+        else if (name == QLatin1String("object")) {
+            Object object;
+            object.id = fnAttrInt("id");
+            object.name = attrs.value(QLatin1String("name")).toString().toStdString();
+            auto itColorGroup = m_mapColorGroup.find(fnAttrInt("pid"));
+            if (itColorGroup != m_mapColorGroup.cend()) {
+                const std::vector<Quantity_ColorRGBA>& vecColor = itColorGroup->second;
+                const int index = std::max(fnAttrInt("pindex"), 0);
+                if (index < int(vecColor.size())) {
+                    object.color = vecColor.at(index);
+                    object.hasColor = true;
+                }
+            }
+
+            m_reader->m_vecObject.push_back(std::move(object));
+        }
+        else if (name == QLatin1String("component")) {
+            if (!m_reader->m_vecObject.empty())
+                m_reader->m_vecObject.back().vecComponent.push_back(this->component(attrs));
+        }
+        else if (name == QLatin1String("item")) {
+            m_reader->m_vecBuildItem.push_back(this->component(attrs));
+        }
+        else if (name == QLatin1String("basematerials") || name == QLatin1String("colorgroup")) {
+            m_colorGroupId = fnAttrInt("id");
+        }
+        else if (name == QLatin1String("base") || name == QLatin1String("color")) {
+            const char* attrColor = name == QLatin1String("base") ? "displaycolor" : "color";
+            Quantity_ColorRGBA color;
+            if (m_colorGroupId >= 0) {
+                parseHexColor(attrs.value(QLatin1String(attrColor)).toString(), &color);
+                m_mapColorGroup[m_colorGroupId].push_back(color);
+            }
+        }
+    }
+
+    void onEndElement(const QXmlStreamReader& xml)
+    {
+        const auto name = xml.name();
+        if (name == QLatin1String("mesh")) {
+            // Poly_Triangulation can't be empty of triangles before OpenCascade 7.6
+            if (!m_reader->m_vecObject.empty() && !m_vecTriangle.empty()) {
+                Handle_Poly_Triangulation mesh = new Poly_Triangulation(
+                            int(m_vecNode.size()), int(m_vecTriangle.size()), false);
+                for (unsigned i = 0; i < m_vecNode.size(); ++i)
+                    setNode(mesh.get(), int(i + 1), m_vecNode.at(i));
+
+                for (unsigned i = 0; i < m_vecTriangle.size(); ++i)
+                    setTriangle(mesh.get(), int(i + 1), m_vecTriangle.at(i));
+
+                m_reader->m_vecObject.back().mesh = mesh;
+            }
+
+            // Release memory early
+            std::vector<gp_Pnt>().swap(m_vecNode);
+            std::vector<Poly_Triangle>().swap(m_vecTriangle);
+        }
+        else if (name == QLatin1String("basematerials") || name == QLatin1String("colorgroup")) {
+            m_colorGroupId = -1;
+        }
+    }
+
+    Component component(const QXmlStreamAttributes& attrs) const
+    {
+        Component comp;
+        bool ok = false;
+        const int objectId = attrs.value(QLatin1String("objectid")).toInt(&ok);
+        comp.objectId = ok ? objectId : -1;
+        comp.trsf = parseTransform(attrs.value(QLatin1String("transform")).toString());
+        return comp;
+    }
+
+    Gmio3mfReader* m_reader = nullptr;
+    std::vector<gp_Pnt> m_vecNode;
+    std::vector<Poly_Triangle> m_vecTriangle;
+    std::unordered_map<int, std::vector<Quantity_ColorRGBA>> m_mapColorGroup;
+    int m_colorGroupId = -1;
+    bool m_isValid = true;
+};
+
+bool Gmio3mfReader::readFile(const FilePath& filepath, TaskProgress* progress)
+{
+    m_vecObject.clear();
+    m_vecBuildItem.clear();
+    m_baseFilename = filepath.stem();
+
+    QFile file(filepathTo<QString>(filepath));
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    const uchar* fileData = file.map(0, file.size());
+    if (!fileData)
+        return false;
+
+    const ZipReader zip(Span<const uint8_t>(fileData, size_t(file.size())));
+    if (!zip.isValid())
+        return false;
+
+    // The model part is the target of the "3dmodel" package relationship
+    std::string modelPartName = "3D/3dmodel.model";
+    const ZipReader::Entry* relsEntry = zip.findEntry("_rels/.rels");
+    if (relsEntry) {
+        QXmlStreamReader xml(QByteArray::fromStdString(zip.entryContents(*relsEntry)));
+        while (!xml.atEnd()) {
+            if (xml.readNext() == QXmlStreamReader::StartElement
+                    && xml.name() == QLatin1String("Relationship"))
+            {
+                const QXmlStreamAttributes attrs = xml.attributes();
+                if (attrs.value(QLatin1String("Type")).endsWith(QLatin1String("/3dmodel")))
+                    modelPartName = attrs.value(QLatin1String("Target")).toString().toStdString();
+            }
+        }
+    }
+
+    const ZipReader::Entry* modelEntry = zip.findEntry(modelPartName);
+    if (!modelEntry)
+        return false;
+
+    QXmlStreamReader xml;
+    ModelParser parser(this);
+    uint64_t inflatedSize = 0;
+    const double modelSize = double(std::max<uint64_t>(modelEntry->uncompressedSize, 1));
+    const bool okRead = zip.readEntry(*modelEntry, [&](std::string_view data) {
+        xml.addData(QByteArray(data.data(), int(data.size())));
+        inflatedSize += data.size();
+        if (progress)
+            progress->setValue(MathUtils::mappedValue(double(inflatedSize), 0, modelSize, 0, 100));
+
+        return parser.parse(&xml) && !TaskProgress::isAbortRequested(progress);
+    });
+
+    return okRead && !xml.hasError();
+}
+
+TDF_LabelSequence Gmio3mfReader::transfer(DocumentPtr doc, TaskProgress* progress)
+{
+    Handle_XCAFDoc_ShapeTool shapeTool = doc->xcaf().shapeTool();
+    Handle_XCAFDoc_ColorTool colorTool = doc->xcaf().colorTool();
+    auto fnAddComponents = [&](const TDF_Label& assemblyLabel,
+                               const std::vector<Component>& vecComponent,
+                               const std::unordered_map<int, TDF_Label>& mapObjectLabel)
+    {
+        for (const Component& component : vecComponent) {
+            auto itObjectLabel = mapObjectLabel.find(component.objectId);
+            if (itObjectLabel != mapObjectLabel.cend())
+                shapeTool->AddComponent(assemblyLabel, itObjectLabel->second, TopLoc_Location(component.trsf));
+        }
+    };
+
+    // 3MF specification requires objects to be defined before being referenced
+    std::unordered_map<int, TDF_Label> mapObjectLabel;
+    BRep_Builder builder;
+    int iObject = 0;
+    for (const Object& object : m_vecObject) {
+        TDF_Label label;
+        if (!object.mesh.IsNull()) {
+            TopoDS_Face face;
+            builder.MakeFace(face, object.mesh);
+            label = shapeTool->AddShape(face, false);
+        }
+        else if (!object.vecComponent.empty()) {
+            label = shapeTool->NewShape();
+            fnAddComponents(label, object.vecComponent, mapObjectLabel);
+        }
+
+        if (!label.IsNull()) {
+            if (!object.name.empty())
+                TDataStd_Name::Set(label, string_conv<TCollection_ExtendedString>(object.name));
+
+            if (object.hasColor)
+                colorTool->SetColor(label, object.color, XCAFDoc_ColorSurf);
+
+            mapObjectLabel.insert({ object.id, label });
+        }
+
+        if (progress)
+            progress->setValue(MathUtils::mappedValue(++iObject, 0, int(m_vecObject.size()), 0, 100));
+    }
+
+    const TDF_Label rootLabel = shapeTool->NewShape();
+    TDataStd_Name::Set(rootLabel, filepathTo<TCollection_ExtendedString>(m_baseFilename));
+    fnAddComponents(rootLabel, m_vecBuildItem, mapObjectLabel);
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 4, 0)
+    shapeTool->UpdateAssemblies();
+#endif
+
+    m_vecObject.clear();
+    m_vecBuildItem.clear();
+    return CafUtils::makeLabelSequence({ rootLabel });
+}
+
+} // namespace IO
+} // namespace Mayo
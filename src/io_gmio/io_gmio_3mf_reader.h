@@ -0,0 +1,53 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "../base/io_reader.h"
+
+#include <Poly_Triangulation.hxx>
+#include <Quantity_ColorRGBA.hxx>
+#include <gp_Trsf.hxx>
+#include <string>
+#include <vector>
+
+namespace Mayo {
+namespace IO {
+
+// Reader for 3MF(3D Manufacturing Format) packages, core specification
+// The model XML part is decompressed and parsed in streaming, so it's never entirely held in memory
+// Mesh objects are mapped to shapes made of a single triangulated face, objects made of components
+// and the build items are mapped to XCAF assemblies
+// Object colors are loaded from "basematerials" and "colorgroup" resources
+class Gmio3mfReader : public Reader {
+public:
+    bool readFile(const FilePath& filepath, TaskProgress* progress) override;
+    TDF_LabelSequence transfer(DocumentPtr doc, TaskProgress* progress) override;
+
+private:
+    struct Component {
+        int objectId = -1;
+        gp_Trsf trsf;
+    };
+
+    struct Object {
+        int id = -1;
+        std::string name;
+        Handle_Poly_Triangulation mesh; // Null if object is made of components
+        std::vector<Component> vecComponent;
+        Quantity_ColorRGBA color;
+        bool hasColor = false;
+    };
+
+    class ModelParser;
+
+    std::vector<Object> m_vecObject;
+    std::vector<Component> m_vecBuildItem;
+    FilePath m_baseFilename;
+};
+
+} // namespace IO
+} // namespace Mayo
@@ -0,0 +1,298 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "io_gmio_3mf_writer.h"
+#include "io_gmio_zip.h"
+
+#include "../base/math_utils.h"
+#include "../base/property_builtins.h"
+#include "../base/task_manager.h"
+#include "../base/task_progress.h"
+#include "../base/text_number.h"
+#include "../base/tkernel_utils.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QString>
+#include <algorithm>
+#include <cstdio>
+#include <set>
+#include <thread>
+
+namespace Mayo {
+namespace IO {
+
+namespace {
+
+// Identifier of the "basematerials" resource, object identifiers follow
+constexpr int BaseMaterialsId = 1;
+
+int objectResourceId(int objectId) {
+    return BaseMaterialsId + 1 + objectId;
+}
+
+std::string hexColorText(const Quantity_Color& color)
+{
+    double r, g, b;
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 5, 0)
+    color.Values(r, g, b, Quantity_TOC_sRGB);
+#else
+    color.Values(r, g, b, Quantity_TOC_RGB);
+#endif
+    auto fnByte = [](double value) { return int(std::clamp(value, 0., 1.) * 255. + 0.5); };
+    char buff[16];
+    std::snprintf(buff, sizeof(buff), "#%02X%02X%02X", fnByte(r), fnByte(g), fnByte(b));
+    return buff;
+}
+
+// 3MF matrices apply to row vectors, translation is in the last row
+std::string transformText(const gp_Trsf& trsf)
+{
+    std::string text;
+    for (int col = 1; col <= 4; ++col) {
+        for (int row = 1; row <= 3; ++row) {
+            if (!text.empty())
+                text += ' ';
+
+            TextNumber::append(&text, trsf.Value(row, col), TextNumber::Format::General, 17);
+        }
+    }
+
+    return text;
+}
+
+const char ContentTypesXml[] =
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        "<Types xmlns=\"http://schemas.openxmlformats.org/package/2006/content-types\">\n"
+        "<Default Extension=\"rels\" ContentType=\"application/vnd.openxmlformats-package.relationships+xml\"/>\n"
+        "<Default Extension=\"model\" ContentType=\"application/vnd.ms-package.3dmanufacturing-3dmodel+xml\"/>\n"
+        "</Types>\n";
+
+const char RelationshipsXml[] =
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        "<Relationships xmlns=\"http://schemas.openxmlformats.org/package/2006/relationships\">\n"
+        "<Relationship Target=\"/3D/3dmodel.model\" Id=\"rel0\""
+        " Type=\"http://schemas.microsoft.com/3dmanufacturing/2013/01/3dmodel\"/>\n"
+        "</Relationships>\n";
+
+} // namespace
+
+class Gmio3mfWriter::Properties : public PropertyGroup {
+    MAYO_DECLARE_TEXT_ID_FUNCTIONS(Mayo::IO::Gmio3mfWriter::Properties)
+public:
+    Properties(PropertyGroup* parentGroup)
+        : PropertyGroup(parentGroup)
+    {
+        this->compressionLevel.setConstraintsEnabled(true);
+        this->compressionLevel.setRange(0, 9);
+        this->compressionLevel.setDescription(
+                    textIdTr("Level of deflate compression, from 0(no compression) to 9(best compression)"));
+        this->parallelCompression.setDescription(
+                    textIdTr("Format and compress the model XML part by chunks processed concurrently"));
+    }
+
+    void restoreDefaults() override {
+        const Gmio3mfWriter::Parameters params;
+        this->compressionLevel.setValue(params.compressionLevel);
+        this->parallelCompression.setValue(params.parallelCompression);
+    }
+
+    PropertyInt compressionLevel{ this, textId("compressionLevel") };
+    PropertyBool parallelCompression{ this, textId("parallelCompression") };
+};
+
+bool Gmio3mfWriter::transfer(Span<const ApplicationItem> spanAppItem, TaskProgress* progress)
+{
+    return m_amfWriter.transfer(spanAppItem, progress);
+}
+
+bool Gmio3mfWriter::writeFile(const FilePath& filepath, TaskProgress* progress)
+{
+    QFile file(filepathTo<QString>(filepath));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    const int level = m_params.compressionLevel;
+    ZipWriter zip(&file);
+    zip.addEntry("[Content_Types].xml", ContentTypesXml, level);
+    zip.addEntry("_rels/.rels", RelationshipsXml, level);
+    zip.beginEntry("3D/3dmodel.model");
+
+    // Model XML is a sequence of text chunks, either static text or a range of mesh elements to be
+    // formatted. Pending chunks are formatted and deflated concurrently by batches, then written in
+    // order so neither the XML text nor the compressed data is entirely held in memory
+    struct TextChunk {
+        const GmioAmfWriter::Mesh* mesh = nullptr; // Null if static text
+        bool isVertexRange = false;
+        int first = 0; // 0-based
+        int last = 0; // Exclusive
+        int nodeOffset = 0; // Index of first mesh node within the object vertices
+        std::string text;
+        ZipDeflateBlock block;
+    };
+
+    constexpr int chunkElementCount = 16 * 1024;
+    const int threadCount = m_params.parallelCompression ? std::max(1, int(std::thread::hardware_concurrency())) : 1;
+    const size_t maxPendingChunkCount = 4 * threadCount;
+    std::vector<TextChunk> vecPendingChunk;
+    size_t totalElementCount = 0;
+    for (const GmioAmfWriter::Mesh& mesh : m_amfWriter.meshes())
+        totalElementCount += mesh.triangulation->NbNodes() + mesh.triangulation->NbTriangles();
+
+    size_t formattedElementCount = 0;
+    bool ok = zip.isOk();
+    auto fnProcessChunk = [=](TextChunk* chunk) {
+        std::string& text = chunk->text;
+        if (chunk->mesh) {
+            const Poly_Triangulation* mesh = chunk->mesh->triangulation.get();
+            const gp_Trsf& trsf = chunk->mesh->location.Transformation();
+            char buff[128];
+            text.reserve((chunk->last - chunk->first) * (chunk->isVertexRange ? 64 : 48));
+            for (int i = chunk->first; i < chunk->last; ++i) {
+                if (chunk->isVertexRange) {
+                    // Decimal separator must not depend on the C locale, so no snprintf()
+                    const gp_Pnt pnt = mesh->Node(i + 1).Transformed(trsf);
+                    text += "<vertex x=\"";
+                    TextNumber::append(&text, pnt.X(), TextNumber::Format::General, 9);
+                    text += "\" y=\"";
+                    TextNumber::append(&text, pnt.Y(), TextNumber::Format::General, 9);
+                    text += "\" z=\"";
+                    TextNumber::append(&text, pnt.Z(), TextNumber::Format::General, 9);
+                    text += "\"/>\n";
+                }
+                else {
+                    int n1, n2, n3;
+                    mesh->Triangle(i + 1).Get(n1, n2, n3);
+                    const int offset = chunk->nodeOffset - 1;
+                    const int len = std::snprintf(
+                                buff, sizeof(buff), "<triangle v1=\"%d\" v2=\"%d\" v3=\"%d\"/>\n",
+                                n1 + offset, n2 + offset, n3 + offset);
+                    text.append(buff, std::clamp(len, 0, int(sizeof(buff)) - 1));
+                }
+            }
+        }
+
+        chunk->block = zipDeflateBlock(text, level);
+        std::string().swap(text); // Release memory early
+    };
+    auto fnWritePendingChunks = [&]{
+        if (m_params.parallelCompression) {
+            TaskManager::runConcurrently(int(vecPendingChunk.size()), nullptr, [&](int i, TaskProgress*) {
+                fnProcessChunk(&vecPendingChunk.at(i));
+            });
+        }
+        else {
+            for (TextChunk& chunk : vecPendingChunk)
+                fnProcessChunk(&chunk);
+        }
+
+        for (const TextChunk& chunk : vecPendingChunk) {
+            ok = ok && zip.writeEntryBlock(chunk.block);
+            formattedElementCount += chunk.last - chunk.first;
+        }
+
+        vecPendingChunk.clear();
+        progress->setValue(MathUtils::mappedValue(formattedElementCount, 0, std::max<size_t>(1, totalElementCount), 0, 100));
+        ok = ok && !TaskProgress::isAbortRequested(progress);
+    };
+    auto fnAppendText = [&](std::string_view str) {
+        if (vecPendingChunk.empty() || vecPendingChunk.back().mesh)
+            vecPendingChunk.emplace_back();
+
+        vecPendingChunk.back().text += str;
+    };
+    auto fnAppendElementRanges = [&](const GmioAmfWriter::Mesh* mesh, bool isVertexRange, int nodeOffset) {
+        const int count = isVertexRange ? mesh->triangulation->NbNodes() : mesh->triangulation->NbTriangles();
+        for (int first = 0; first < count && ok; first += chunkElementCount) {
+            TextChunk chunk;
+            chunk.mesh = mesh;
+            chunk.isVertexRange = isVertexRange;
+            chunk.first = first;
+            chunk.last = std::min(first + chunkElementCount, count);
+            chunk.nodeOffset = nodeOffset;
+            vecPendingChunk.push_back(std::move(chunk));
+            if (vecPendingChunk.size() >= maxPendingChunkCount)
+                fnWritePendingChunks();
+        }
+    };
+
+    fnAppendText("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                 "<model unit=\"millimeter\" xml:lang=\"en-US\""
+                 " xmlns=\"http://schemas.microsoft.com/3dmanufacturing/core/2015/02\">\n"
+                 "<resources>\n");
+    const std::vector<GmioAmfWriter::Material>& vecMaterial = m_amfWriter.materials();
+    if (!vecMaterial.empty()) {
+        fnAppendText("<basematerials id=\"" + std::to_string(BaseMaterialsId) + "\">\n");
+        for (const GmioAmfWriter::Material& material : vecMaterial) {
+            const Quantity_Color color = material.isColor ? material.color : Quantity_Color(Quantity_NOC_WHITE);
+            fnAppendText("<base name=\"material" + std::to_string(material.id) + "\""
+                         " displaycolor=\"" + hexColorText(color) + "\"/>\n");
+        }
+
+        fnAppendText("</basematerials>\n");
+    }
+
+    const std::vector<GmioAmfWriter::Mesh>& vecMesh = m_amfWriter.meshes();
+    for (const GmioAmfWriter::Object& object : m_amfWriter.objects()) {
+        std::string text = "<object id=\"" + std::to_string(objectResourceId(object.id)) + "\" type=\"model\"";
+        if (!object.name.empty())
+            text += " name=\"" + QString::fromStdString(object.name).toHtmlEscaped().toStdString() + "\"";
+
+        if (object.materialId >= 0)
+            text += " pid=\"" + std::to_string(BaseMaterialsId) + "\" pindex=\"" + std::to_string(object.materialId) + "\"";
+
+        fnAppendText(text + ">\n<mesh>\n<vertices>\n");
+        for (int meshId = object.firstMeshId; meshId <= object.lastMeshId; ++meshId)
+            fnAppendElementRanges(&vecMesh.at(meshId), true, 0);
+
+        // Meshes of the object are merged, node indices are offset accordingly
+        fnAppendText("</vertices>\n<triangles>\n");
+        int nodeOffset = 0;
+        for (int meshId = object.firstMeshId; meshId <= object.lastMeshId; ++meshId) {
+            fnAppendElementRanges(&vecMesh.at(meshId), false, nodeOffset);
+            nodeOffset += vecMesh.at(meshId).triangulation->NbNodes();
+        }
+
+        fnAppendText("</triangles>\n</mesh>\n</object>\n");
+        if (!ok)
+            return false;
+    }
+
+    fnAppendText("</resources>\n<build>\n");
+    std::set<int> setInstancedObjectId;
+    for (const GmioAmfWriter::Instance& instance : m_amfWriter.instances()) {
+        fnAppendText("<item objectid=\"" + std::to_string(objectResourceId(instance.objectId)) + "\""
+                     " transform=\"" + transformText(instance.trsf) + "\"/>\n");
+        setInstancedObjectId.insert(instance.objectId);
+    }
+
+    // Objects that aren't instanced(ex: free shapes without parent) are placed as is
+    for (const GmioAmfWriter::Object& object : m_amfWriter.objects()) {
+        if (setInstancedObjectId.find(object.id) == setInstancedObjectId.cend())
+            fnAppendText("<item objectid=\"" + std::to_string(objectResourceId(object.id)) + "\"/>\n");
+    }
+
+    fnAppendText("</build>\n</model>\n");
+    fnWritePendingChunks();
+    ok = ok && zip.endEntry();
+    return ok && zip.finish();
+}
+
+std::unique_ptr<PropertyGroup> Gmio3mfWriter::createProperties(PropertyGroup* parentGroup)
+{
+    return std::make_unique<Properties>(parentGroup);
+}
+
+void Gmio3mfWriter::applyProperties(const PropertyGroup* group)
+{
+    auto ptr = dynamic_cast<const Properties*>(group);
+    if (ptr) {
+        m_params.compressionLevel = ptr->compressionLevel;
+        m_params.parallelCompression = ptr->parallelCompression;
+    }
+}
+
+} // namespace IO
+} // namespace Mayo
@@ -0,0 +1,43 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "../base/io_writer.h"
+#include "io_gmio_amf_writer.h"
+
+namespace Mayo {
+namespace IO {
+
+// Writer for 3MF(3D Manufacturing Format) packages, core specification
+// Objects, colors and instances are gathered the same way as GmioAmfWriter. The meshes of an
+// object are merged into a single 3MF mesh, instances are written as build items
+// The model XML part is streamed by chunks, each chunk being formatted and deflated by a
+// concurrent task
+class Gmio3mfWriter : public Writer {
+public:
+    bool transfer(Span<const ApplicationItem> spanAppItem, TaskProgress* progress) override;
+    bool writeFile(const FilePath& filepath, TaskProgress* progress) override;
+
+    static std::unique_ptr<PropertyGroup> createProperties(PropertyGroup* parentGroup);
+    void applyProperties(const PropertyGroup* group) override;
+
+    // Parameters
+    struct Parameters {
+        int compressionLevel = 6; // zlib level in [0,9]
+        bool parallelCompression = true;
+    };
+    Parameters& parameters() { return m_params; }
+    const Parameters& constParameters() const { return m_params; }
+
+private:
+    class Properties;
+    Parameters m_params;
+    GmioAmfWriter m_amfWriter; // Provides the transfer of application items
+};
+
+} // namespace IO
+} // namespace Mayo
@@ -7,20 +7,25 @@
 #include "io_gmio_amf_writer.h"
 
 #include "../base/application_item.h"
-#include "../base/brep_utils.h"
 #include "../base/caf_utils.h"
 #include "../base/math_utils.h"
 #include "../base/meta_enum.h"
 #include "../base/property_builtins.h"
 #include "../base/property_enumeration.h"
+#include "../base/shape_style_cache.h"
 #include "../base/string_conv.h"
+#include "../base/sub_shape_cache.h"
+#include "../base/task_manager.h"
 #include "../base/task_progress.h"
+#include "../base/text_number.h"
 #include "../base/unit_system.h"
 #include "../base/xcaf.h"
 
+#include <QtCore/QFile>
 #include <BRep_Tool.hxx>
 #include <Poly_Triangulation.hxx>
 #include <TDataXtd_Triangulation.hxx>
+#include <TopTools_DataMapOfShapeInteger.hxx>
 #include <gp_Quaternion.hxx>
 
 #include <gmio_amf/amf_error.h>
@@ -28,6 +33,9 @@
 #include <gmio_core/error.h>
 #include <gmio_stl/stl_error.h>
 
+#include <algorithm>
+#include <set>
+#include <thread>
 #include <unordered_map>
 
 namespace Mayo {
@@ -117,6 +125,24 @@ IO::Result IO::exportStl_gmio(ExportData data)
 }
 #endif // HAVE_GMIO
 
+std::string escapedXmlText(std::string_view str)
+{
+    std::string text;
+    text.reserve(str.size());
+    for (char c : str) {
+        switch (c) {
+        case '&': text += "&amp;"; break;
+        case '<': text += "&lt;"; break;
+        case '>': text += "&gt;"; break;
+        case '"': text += "&quot;"; break;
+        case '\'': text += "&apos;"; break;
+        default: text += c;
+        }
+    }
+
+    return text;
+}
+
 } // namespace
 
 class GmioAmfWriter::Properties : public PropertyGroup {
@@ -149,6 +175,10 @@ public:
         this->useZip64.setDescription(
                     textIdTr("Use the ZIP64 format extensions.\n"
                              "Only applicable if option `%1` is on").arg(this->createZipArchive.label()));
+
+        this->parallelFormatting.setDescription(
+                    textIdTr("Format the vertices and triangles of meshes as text concurrently.\n"
+                             "Only applicable if option `%1` is off").arg(this->createZipArchive.label()));
     }
 
     void restoreDefaults() override {
@@ -158,9 +188,11 @@ public:
         this->createZipArchive.setValue(params.createZipArchive);
         this->zipEntryFilename.setValue(params.zipEntryFilename);
         this->useZip64.setValue(params.useZip64);
+        this->parallelFormatting.setValue(params.parallelFormatting);
 
         this->zipEntryFilename.setEnabled(this->createZipArchive);
         this->useZip64.setEnabled(this->createZipArchive);
+        this->parallelFormatting.setEnabled(!this->createZipArchive);
     }
 
     void onPropertyChanged(Property* prop) override
@@ -168,6 +200,7 @@ public:
         if (prop == &this->createZipArchive) {
             this->zipEntryFilename.setEnabled(this->createZipArchive);
             this->useZip64.setEnabled(this->createZipArchive);
+            this->parallelFormatting.setEnabled(!this->createZipArchive);
         }
 
         PropertyGroup::onPropertyChanged(prop);
@@ -178,6 +211,7 @@ public:
     PropertyBool createZipArchive{ this, textId("createZipArchive") };
     PropertyString zipEntryFilename{ this, textId("zipEntryFilename") };
     PropertyBool useZip64{ this, textId("useZip64") };
+    PropertyBool parallelFormatting{ this, textId("parallelFormatting") };
 };
 
 bool GmioAmfWriter::transfer(Span<const ApplicationItem> spanAppItem, TaskProgress* progress)
@@ -193,21 +227,38 @@ bool GmioAmfWriter::transfer(Span<const ApplicationItem> spanAppItem, TaskProgre
     defaultMaterial.isColor = true;
     m_vecMaterial.push_back(std::move(defaultMaterial));
 
+    // Objects are created once per prototype, repeated occurrences are emitted as constellation
+    // instances. Prototypes are identified by label, and by shape so prototypes shared between
+    // different labels(or documents) aren't duplicated
     std::unordered_map<TDF_Label, int> mapLabelObjectId;
-    auto fnFindObjectId = [&](const TDF_Label& label) {
+    TopTools_DataMapOfShapeInteger mapShapeObjectId;
+    std::set<std::pair<const Document*, TreeNodeId>> setVisitedNode;
+    auto fnFindObjectId = [&](const TDF_Label& label, const TopoDS_Shape& shape) {
         auto it = mapLabelObjectId.find(label);
-        return it != mapLabelObjectId.cend() ? it->second : -1;
+        if (it != mapLabelObjectId.cend())
+            return it->second;
+
+        return !shape.IsNull() && mapShapeObjectId.IsBound(shape) ? mapShapeObjectId.Find(shape) : -1;
     };
     auto fnCreateObject = [&](const Tree<TDF_Label>& modelTree, TreeNodeId id) {
         const TDF_Label nodeLabel = modelTree.nodeData(id);
         if (modelTree.nodeIsLeaf(id)) {
-            int objectId = fnFindObjectId(nodeLabel);
+            // Tree nodes can be reached several times when application items overlap
+            const DocumentPtr doc = Document::findFrom(nodeLabel);
+            if (!setVisitedNode.insert({ doc.get(), id }).second)
+                return;
+
+            const TDF_Label protoLabel = XCaf::isShapeReference(nodeLabel) ? XCaf::shapeReferred(nodeLabel) : nodeLabel;
+            const TopoDS_Shape protoShape = XCaf::shape(protoLabel);
+            int objectId = fnFindObjectId(protoLabel, protoShape);
             if (objectId == -1) {
-                objectId = this->createObject(nodeLabel);
+                objectId = this->createObject(protoLabel);
                 if (objectId == -1)
                     return;
 
-                mapLabelObjectId.insert({ nodeLabel, objectId });
+                mapLabelObjectId.insert({ protoLabel, objectId });
+                if (!protoShape.IsNull())
+                    mapShapeObjectId.Bind(protoShape, objectId);
             }
 
             QStringList absoluteName;
@@ -226,13 +277,26 @@ bool GmioAmfWriter::transfer(Span<const ApplicationItem> spanAppItem, TaskProgre
             if (!absoluteName.isEmpty()) {
                 Instance instance;
                 instance.objectId = objectId;
-                instance.trsf = XCaf::shapeAbsoluteLocation(modelTree, id);
+                instance.trsf = doc->xcaf().shapeAbsoluteLocation(id);
                 instance.name = absoluteName.join('/').toStdString();
                 m_vecInstance.push_back(std::move(instance));
             }
         }
     };
 
+    // Styles of the prototypes are resolved concurrently up front, createObject() just looks them up
+    for (const ApplicationItem& appItem : spanAppItem) {
+        const DocumentPtr doc = appItem.document();
+        if (appItem.isDocument()) {
+            doc->styleCache().computePrototypeStyles(doc->xcaf().topLevelFreeShapes());
+        }
+        else if (appItem.isDocumentTreeNode()) {
+            TDF_LabelSequence seqLabel;
+            seqLabel.Append(appItem.documentTreeNode().label());
+            doc->styleCache().computePrototypeStyles(seqLabel);
+        }
+    }
+
     for (const ApplicationItem& appItem : spanAppItem) {
         const int appItemIndex = &appItem - &spanAppItem.front();
         progress->setValue(MathUtils::mappedValue(appItemIndex, 0, spanAppItem.size() - 1, 0, 100));
@@ -252,6 +316,9 @@ bool GmioAmfWriter::transfer(Span<const ApplicationItem> spanAppItem, TaskProgre
 
 bool GmioAmfWriter::writeFile(const FilePath& filepath, TaskProgress* progress)
 {
+    if (m_params.parallelFormatting && !m_params.createZipArchive)
+        return this->writeFileParallel(filepath, progress);
+
     gmio_amf_document amfDoc = {};
     amfDoc.cookie = this;
     amfDoc.unit = GMIO_AMF_UNIT_MILLIMETER;
@@ -302,39 +369,210 @@ void GmioAmfWriter::applyProperties(const PropertyGroup* group)
         m_params.createZipArchive = ptr->createZipArchive;
         m_params.zipEntryFilename = ptr->zipEntryFilename;
         m_params.useZip64 = ptr->useZip64;
+        m_params.parallelFormatting = ptr->parallelFormatting;
+    }
+}
+
+bool GmioAmfWriter::writeFileParallel(const FilePath& filepath, TaskProgress* progress)
+{
+    QFile file(filepathTo<QString>(filepath));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    TextNumber::Format float64Format = TextNumber::Format::Fixed;
+    if (m_params.float64Format == FloatTextFormat::Scientific)
+        float64Format = TextNumber::Format::Scientific;
+    else if (m_params.float64Format == FloatTextFormat::Shortest)
+        float64Format = TextNumber::Format::General;
+
+    auto fnAppendFloat64 = [=](std::string* str, double value) {
+        TextNumber::append(str, value, float64Format, int(m_params.float64Precision));
+    };
+    auto fnAppendElement = [&](std::string* str, const char* tag, double value) {
+        *str += '<'; *str += tag; *str += '>';
+        fnAppendFloat64(str, value);
+        *str += "</"; *str += tag; *str += '>';
+    };
+
+    // Contents are a sequence of text chunks, either static text or a range of mesh elements to be
+    // formatted. Pending chunks are formatted concurrently by batches then written in order, so the
+    // whole XML text is never held in memory
+    struct TextChunk {
+        const Poly_Triangulation* mesh = nullptr; // Null if static text
+        bool isVertexRange = false;
+        int first = 0; // 0-based
+        int last = 0; // Exclusive
+        std::string text;
+    };
+
+    constexpr int chunkElementCount = 16 * 1024;
+    const int threadCount = std::max(1, int(std::thread::hardware_concurrency()));
+    const size_t maxPendingChunkCount = 4 * threadCount;
+    std::vector<TextChunk> vecPendingChunk;
+    size_t totalElementCount = 0;
+    for (const Mesh& mesh : m_vecMesh)
+        totalElementCount += mesh.triangulation->NbNodes() + mesh.triangulation->NbTriangles();
+
+    size_t formattedElementCount = 0;
+    bool ok = true;
+    auto fnFormatChunk = [&](TextChunk* chunk) {
+        const Poly_Triangulation* mesh = chunk->mesh;
+        std::string& text = chunk->text;
+        text.reserve((chunk->last - chunk->first) * (chunk->isVertexRange ? 128 : 64));
+        for (int i = chunk->first; i < chunk->last; ++i) {
+            if (chunk->isVertexRange) {
+                const gp_Pnt pnt = mesh->Node(i + 1);
+                text += "<vertex><coordinates>";
+                fnAppendElement(&text, "x", pnt.X());
+                fnAppendElement(&text, "y", pnt.Y());
+                fnAppendElement(&text, "z", pnt.Z());
+                text += "</coordinates></vertex>\n";
+            }
+            else {
+                int n1, n2, n3;
+                mesh->Triangle(i + 1).Get(n1, n2, n3);
+                text += "<triangle><v1>" + std::to_string(n1 - 1) + "</v1>";
+                text += "<v2>" + std::to_string(n2 - 1) + "</v2>";
+                text += "<v3>" + std::to_string(n3 - 1) + "</v3></triangle>\n";
+            }
+        }
+    };
+    auto fnWritePendingChunks = [&]{
+        std::vector<int> vecFormatIndex;
+        for (const TextChunk& chunk : vecPendingChunk) {
+            if (chunk.mesh)
+                vecFormatIndex.push_back(&chunk - &vecPendingChunk.front());
+        }
+
+        TaskManager::runConcurrently(int(vecFormatIndex.size()), nullptr, [&](int i, TaskProgress*) {
+            fnFormatChunk(&vecPendingChunk.at(vecFormatIndex.at(i)));
+        });
+        for (const TextChunk& chunk : vecPendingChunk) {
+            ok = ok && file.write(chunk.text.data(), chunk.text.size()) == qint64(chunk.text.size());
+            formattedElementCount += chunk.last - chunk.first;
+        }
+
+        vecPendingChunk.clear();
+        progress->setValue(MathUtils::mappedValue(formattedElementCount, 0, std::max<size_t>(1, totalElementCount), 0, 100));
+        ok = ok && !TaskProgress::isAbortRequested(progress);
+    };
+    auto fnAppendText = [&](std::string_view str) {
+        if (vecPendingChunk.empty() || vecPendingChunk.back().mesh)
+            vecPendingChunk.emplace_back();
+
+        vecPendingChunk.back().text += str;
+    };
+    auto fnAppendElementRanges = [&](const Poly_Triangulation* mesh, bool isVertexRange, int count) {
+        for (int first = 0; first < count && ok; first += chunkElementCount) {
+            TextChunk chunk;
+            chunk.mesh = mesh;
+            chunk.isVertexRange = isVertexRange;
+            chunk.first = first;
+            chunk.last = std::min(first + chunkElementCount, count);
+            vecPendingChunk.push_back(std::move(chunk));
+            if (vecPendingChunk.size() >= maxPendingChunkCount)
+                fnWritePendingChunks();
+        }
+    };
+
+    fnAppendText("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<amf unit=\"millimeter\" version=\"1.2\">\n");
+    for (const Object& object : m_vecObject) {
+        fnAppendText("<object id=\"" + std::to_string(object.id) + "\">\n");
+        fnAppendText("<metadata type=\"name\">" + escapedXmlText(object.name) + "</metadata>\n");
+        for (int meshId = object.firstMeshId; meshId <= object.lastMeshId; ++meshId) {
+            const Poly_Triangulation* mesh = m_vecMesh.at(meshId).triangulation.get();
+            const int materialId = volumeMaterialId(object, m_vecMesh.at(meshId));
+            fnAppendText("<mesh>\n<vertices>\n");
+            fnAppendElementRanges(mesh, true, mesh->NbNodes());
+            fnAppendText("</vertices>\n<volume");
+            if (materialId >= 0)
+                fnAppendText(" materialid=\"" + std::to_string(materialId) + "\"");
+
+            fnAppendText(">\n");
+            fnAppendElementRanges(mesh, false, mesh->NbTriangles());
+            fnAppendText("</volume>\n</mesh>\n");
+        }
+
+        fnAppendText("</object>\n");
+        if (!ok)
+            return false;
+    }
+
+    for (const Material& material : m_vecMaterial) {
+        std::string text = "<material id=\"" + std::to_string(material.id) + "\">";
+        if (material.isColor) {
+            text += "<color>";
+            fnAppendElement(&text, "r", material.color.Red());
+            fnAppendElement(&text, "g", material.color.Green());
+            fnAppendElement(&text, "b", material.color.Blue());
+            text += "</color>";
+        }
+
+        fnAppendText(text + "</material>\n");
+    }
+
+    if (!m_vecInstance.empty()) {
+        fnAppendText("<constellation id=\"0\">\n");
+        for (uint32_t i = 0; i < m_vecInstance.size(); ++i) {
+            gmio_amf_instance instance;
+            GmioAmfWriter::amf_getConstellationInstance(this, 0, i, &instance);
+            std::string text = "<instance objectid=\"" + std::to_string(instance.objectid) + "\">";
+            fnAppendElement(&text, "deltax", instance.delta.x);
+            fnAppendElement(&text, "deltay", instance.delta.y);
+            fnAppendElement(&text, "deltaz", instance.delta.z);
+            fnAppendElement(&text, "rx", instance.rot.x);
+            fnAppendElement(&text, "ry", instance.rot.y);
+            fnAppendElement(&text, "rz", instance.rot.z);
+            fnAppendText(text + "</instance>\n");
+        }
+
+        fnAppendText("</constellation>\n");
     }
+
+    fnAppendText("</amf>\n");
+    fnWritePendingChunks();
+    return ok;
 }
 
 int GmioAmfWriter::createObject(const TDF_Label& labelShape)
 {
+    DocumentPtr doc = Document::findFrom(labelShape);
+    const TopoDS_Shape shape = XCaf::shape(labelShape);
+    std::shared_ptr<const PrototypeStyle> style;
+    if (doc && !shape.IsNull())
+        style = doc->styleCache().prototypeStyle(labelShape);
+
     // Object meshes
     const int meshCount = int(m_vecMesh.size());
 
-    auto fnAddMesh = [&](const Handle_Poly_Triangulation& polyTri, const TopLoc_Location& loc) {
+    auto fnAddMesh = [&](const Handle_Poly_Triangulation& polyTri, const TopLoc_Location& loc, int materialId) {
         if (!polyTri.IsNull()) {
             Mesh mesh;
             mesh.id = int(m_vecMesh.size());
             mesh.triangulation = polyTri;
             mesh.location = loc;
-            // TODO mesh.materialId = ?
+            mesh.materialId = materialId;
             m_vecMesh.push_back(std::move(mesh));
         }
     };
 
     // -- Shape ?
-    const TopoDS_Shape shape = XCaf::shape(labelShape);
     if (!shape.IsNull()) {
-        BRepUtils::forEachSubFace(shape, [=](const TopoDS_Face& face){
+        // Faces having their own color(XCAF sub-shape labels) get their own material
+        int iFace = 0;
+        doc->subShapeCache().forEachSubFace(shape, [&](const TopoDS_Face& face, bool) {
+            ++iFace;
             TopLoc_Location loc;
             const Handle_Poly_Triangulation& polyTri = BRep_Tool::Triangulation(face, loc);
-            fnAddMesh(polyTri, loc);
+            const Quantity_Color* faceColor = style->faceColor(iFace);
+            fnAddMesh(polyTri, loc, faceColor ? this->findOrAddMaterial(*faceColor) : -1);
         });
     }
 
     // -- Triangulation ?
     auto attrPolyTri = CafUtils::findAttribute<TDataXtd_Triangulation>(labelShape);
     if (!attrPolyTri.IsNull()) {
-        fnAddMesh(attrPolyTri->Get(), TopLoc_Location());
+        fnAddMesh(attrPolyTri->Get(), TopLoc_Location(), -1);
     }
 
     if (m_vecMesh.size() == meshCount)
@@ -342,25 +580,10 @@ int GmioAmfWriter::createObject(const TDF_Label& labelShape)
 
     // Object material
     int materialId = -1;
-    DocumentPtr doc = Document::findFrom(labelShape);
-    if (doc && doc->xcaf().hasShapeColor(labelShape)) {
-        const Quantity_Color color = doc->xcaf().shapeColor(labelShape);
-        auto itColor = std::find_if(
-                    m_vecMaterial.cbegin(), m_vecMaterial.cend(), [=](const Material& mat) {
-            return mat.color == color;
-        });
-        if (itColor != m_vecMaterial.cend()) {
-            materialId = itColor - m_vecMaterial.cbegin();
-        }
-        else {
-            materialId = m_vecMaterial.size();
-            Material material;
-            material.id = materialId;
-            material.color = color;
-            material.isColor = true;
-            m_vecMaterial.push_back(std::move(material));
-        }
-    }
+    if (style && style->hasColor)
+        materialId = this->findOrAddMaterial(style->color);
+    else if (doc && doc->xcaf().hasShapeColor(labelShape))
+        materialId = this->findOrAddMaterial(doc->xcaf().shapeColor(labelShape));
 
     // Add object
     Object object;
@@ -373,6 +596,23 @@ int GmioAmfWriter::createObject(const TDF_Label& labelShape)
     return m_vecObject.back().id;
 }
 
+int GmioAmfWriter::findOrAddMaterial(const Quantity_Color& color)
+{
+    auto itColor = std::find_if(
+                m_vecMaterial.cbegin(), m_vecMaterial.cend(), [=](const Material& mat) {
+        return mat.color == color;
+    });
+    if (itColor != m_vecMaterial.cend())
+        return itColor - m_vecMaterial.cbegin();
+
+    Material material;
+    material.id = m_vecMaterial.size();
+    material.color = color;
+    material.isColor = true;
+    m_vecMaterial.push_back(std::move(material));
+    return m_vecMaterial.back().id;
+}
+
 const GmioAmfWriter* GmioAmfWriter::from(const void* cookie) {
     return static_cast<const GmioAmfWriter*>(cookie);
 }
@@ -456,7 +696,7 @@ void GmioAmfWriter::amf_getObjectMeshElement(
         *amfVolume = {};
         amfVolume->type = GMIO_AMF_VOLUME_TYPE_OBJECT;
         amfVolume->triangle_count = mesh.triangulation->NbTriangles();
-        amfVolume->materialid = object.materialId;
+        amfVolume->materialid = volumeMaterialId(object, mesh);
     }
 }
 
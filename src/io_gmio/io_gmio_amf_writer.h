@@ -45,12 +45,54 @@ public:
         bool createZipArchive = false;
         bool useZip64 = true;
         std::string zipEntryFilename; // UTF8
+        // XML text of mesh elements is formatted by concurrent tasks, not applicable with ZIP archive
+        bool parallelFormatting = true;
     };
     Parameters& parameters() { return m_params; }
     const Parameters& constParameters() const { return m_params; }
 
+    // Data gathered by transfer(), also used by other mesh-based writers(ex: Gmio3mfWriter)
+
+    struct Instance {
+        int objectId = -1;
+        gp_Trsf trsf;
+        std::string name;
+    };
+
+    struct Material {
+        int id = -1;
+        Quantity_Color color;
+        bool isColor = false;
+    };
+
+    struct Object {
+        int id = -1;
+        int firstMeshId = 0;
+        int lastMeshId = -1;
+        int materialId = -1;
+        std::string name;
+    };
+
+    struct Mesh {
+        int id = -1;
+        Handle_Poly_Triangulation triangulation;
+        TopLoc_Location location;
+        int materialId = -1;
+    };
+
+    const std::vector<Material>& materials() const { return m_vecMaterial; }
+    const std::vector<Mesh>& meshes() const { return m_vecMesh; }
+    const std::vector<Object>& objects() const { return m_vecObject; }
+    const std::vector<Instance>& instances() const { return m_vecInstance; }
+
 private:
     int createObject(const TDF_Label& labelShape);
+    int findOrAddMaterial(const Quantity_Color& color);
+    // Material of a face mesh takes precedence over the material of its object
+    static int volumeMaterialId(const Object& object, const Mesh& mesh) {
+        return mesh.materialId >= 0 ? mesh.materialId : object.materialId;
+    }
+    bool writeFileParallel(const FilePath& filepath, TaskProgress* progress);
 
     static const GmioAmfWriter* from(const void* cookie);
 
@@ -90,33 +132,6 @@ private:
             uint32_t instanceIndex,
             struct gmio_amf_instance* ptrInstance);
 
-    struct Instance {
-        int objectId = -1;
-        gp_Trsf trsf;
-        std::string name;
-    };
-
-    struct Material {
-        int id = -1;
-        Quantity_Color color;
-        bool isColor = false;
-    };
-
-    struct Object {
-        int id = -1;
-        int firstMeshId = 0;
-        int lastMeshId = -1;
-        int materialId = -1;
-        std::string name;
-    };
-
-    struct Mesh {
-        int id = -1;
-        Handle_Poly_Triangulation triangulation;
-        TopLoc_Location location;
-        int materialId = -1;
-    };
-
     class Properties;
     Parameters m_params;
     std::vector<Material> m_vecMaterial;
@@ -0,0 +1,422 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "io_gmio_zip.h"
+
+#include <QtCore/QDateTime>
+#include <QtCore/QFile>
+#include <zlib.h>
+#include <algorithm>
+#include <cctype>
+#include <limits>
+
+namespace Mayo {
+namespace IO {
+
+namespace {
+
+constexpr uint32_t LocalHeaderSignature = 0x04034b50;
+constexpr uint32_t DataDescriptorSignature = 0x08074b50;
+constexpr uint32_t CentralHeaderSignature = 0x02014b50;
+constexpr uint32_t Zip64EndOfCentralDirSignature = 0x06064b50;
+constexpr uint32_t Zip64EndOfCentralDirLocatorSignature = 0x07064b50;
+constexpr uint32_t EndOfCentralDirSignature = 0x06054b50;
+
+constexpr uint16_t Zip64ExtraFieldId = 0x0001;
+constexpr uint16_t ZipVersion = 45; // ZIP64 extensions
+constexpr uint16_t ZipFlags = 0x0008 | 0x0800; // Data descriptor, UTF8 filename
+constexpr uint16_t MethodStored = 0;
+constexpr uint16_t MethodDeflated = 8;
+constexpr uint32_t Max32 = 0xFFFFFFFF;
+constexpr uint16_t Max16 = 0xFFFF;
+
+void appendLE(std::vector<uint8_t>* bytes, uint64_t value, int size)
+{
+    for (int i = 0; i < size; ++i)
+        bytes->push_back(uint8_t(value >> (8 * i)));
+}
+
+void appendText(std::vector<uint8_t>* bytes, std::string_view str)
+{
+    bytes->insert(bytes->end(), str.cbegin(), str.cend());
+}
+
+uint64_t readLE(const uint8_t* bytes, int size)
+{
+    uint64_t value = 0;
+    for (int i = 0; i < size; ++i)
+        value |= uint64_t(bytes[i]) << (8 * i);
+
+    return value;
+}
+
+bool isSameFilename(std::string_view lhs, std::string_view rhs)
+{
+    auto fnTrim = [](std::string_view str) {
+        return !str.empty() && str.front() == '/' ? str.substr(1) : str;
+    };
+    lhs = fnTrim(lhs);
+    rhs = fnTrim(rhs);
+    return lhs.size() == rhs.size()
+            && std::equal(lhs.cbegin(), lhs.cend(), rhs.cbegin(), [](char a, char b) {
+                return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+            });
+}
+
+} // namespace
+
+ZipDeflateBlock zipDeflateBlock(std::string_view data, int level)
+{
+    ZipDeflateBlock block;
+    block.uncompressedSize = data.size();
+    block.crc = crc32(crc32(0L, Z_NULL, 0), reinterpret_cast<const Bytef*>(data.data()), uInt(data.size()));
+
+    z_stream stream = {};
+    // Negative window bits: raw deflate data, without zlib header
+    if (deflateInit2(&stream, std::clamp(level, 0, 9), Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        return block;
+
+    // Sync flush(instead of finish) ends data on a byte boundary without setting the "final" bit
+    block.compressed.resize(deflateBound(&stream, uLong(data.size())) + 16);
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = uInt(data.size());
+    int res = Z_OK;
+    do {
+        if (stream.total_out == block.compressed.size())
+            block.compressed.resize(2 * block.compressed.size());
+
+        stream.next_out = block.compressed.data() + stream.total_out;
+        stream.avail_out = uInt(block.compressed.size() - stream.total_out);
+        res = deflate(&stream, Z_SYNC_FLUSH);
+    } while (res == Z_OK && stream.avail_out == 0);
+
+    block.compressed.resize(stream.total_out);
+    block.isValid = res == Z_OK && stream.avail_in == 0;
+    deflateEnd(&stream);
+    return block;
+}
+
+ZipWriter::ZipWriter(QFile* file)
+    : m_file(file)
+{
+    const QDateTime now = QDateTime::currentDateTime();
+    const QTime time = now.time();
+    const QDate date = now.date();
+    m_dosTime = uint16_t((time.hour() << 11) | (time.minute() << 5) | (time.second() / 2));
+    m_dosDate = uint16_t((std::max(date.year() - 1980, 0) << 9) | (date.month() << 5) | date.day());
+}
+
+bool ZipWriter::beginEntry(std::string_view filename)
+{
+    if (m_isEntryOpen)
+        return false;
+
+    Entry entry;
+    entry.filename = filename;
+    entry.localHeaderOffset = uint64_t(m_file->pos());
+    std::vector<uint8_t> header;
+    appendLE(&header, LocalHeaderSignature, 4);
+    appendLE(&header, ZipVersion, 2);
+    appendLE(&header, ZipFlags, 2);
+    appendLE(&header, MethodDeflated, 2);
+    appendLE(&header, m_dosTime, 2);
+    appendLE(&header, m_dosDate, 2);
+    appendLE(&header, 0, 4); // CRC-32, in data descriptor
+    appendLE(&header, Max32, 4); // Compressed size, in data descriptor
+    appendLE(&header, Max32, 4); // Uncompressed size, in data descriptor
+    appendLE(&header, filename.size(), 2);
+    appendLE(&header, 4 + 16, 2); // Extra field length
+    appendText(&header, filename);
+    // ZIP64 extra field, so data descriptor holds 64bit sizes
+    appendLE(&header, Zip64ExtraFieldId, 2);
+    appendLE(&header, 16, 2);
+    appendLE(&header, 0, 8);
+    appendLE(&header, 0, 8);
+
+    m_vecEntry.push_back(std::move(entry));
+    m_isEntryOpen = true;
+    return this->write(header);
+}
+
+bool ZipWriter::writeEntryBlock(const ZipDeflateBlock& block)
+{
+    if (!m_isEntryOpen || !block.isValid)
+        return m_isOk = false;
+
+    Entry& entry = m_vecEntry.back();
+    entry.crc = uint32_t(crc32_combine(entry.crc, block.crc, z_off_t(block.uncompressedSize)));
+    entry.compressedSize += block.compressed.size();
+    entry.uncompressedSize += block.uncompressedSize;
+    return this->write(block.compressed);
+}
+
+bool ZipWriter::endEntry()
+{
+    if (!m_isEntryOpen)
+        return false;
+
+    // Final empty block(fixed Huffman codes), closes the deflate stream
+    const std::vector<uint8_t> finalBlock = { 0x03, 0x00 };
+    this->write(finalBlock);
+
+    Entry& entry = m_vecEntry.back();
+    entry.compressedSize += finalBlock.size();
+    std::vector<uint8_t> descriptor;
+    appendLE(&descriptor, DataDescriptorSignature, 4);
+    appendLE(&descriptor, entry.crc, 4);
+    appendLE(&descriptor, entry.compressedSize, 8);
+    appendLE(&descriptor, entry.uncompressedSize, 8);
+    m_isEntryOpen = false;
+    return this->write(descriptor);
+}
+
+bool ZipWriter::addEntry(std::string_view filename, std::string_view contents, int level)
+{
+    return this->beginEntry(filename)
+            && this->writeEntryBlock(zipDeflateBlock(contents, level))
+            && this->endEntry();
+}
+
+bool ZipWriter::finish()
+{
+    if (m_isEntryOpen)
+        this->endEntry();
+
+    const uint64_t centralDirOffset = uint64_t(m_file->pos());
+    std::vector<uint8_t> bytes;
+    for (const Entry& entry : m_vecEntry) {
+        appendLE(&bytes, CentralHeaderSignature, 4);
+        appendLE(&bytes, ZipVersion, 2); // Version made by
+        appendLE(&bytes, ZipVersion, 2); // Version needed to extract
+        appendLE(&bytes, ZipFlags, 2);
+        appendLE(&bytes, MethodDeflated, 2);
+        appendLE(&bytes, m_dosTime, 2);
+        appendLE(&bytes, m_dosDate, 2);
+        appendLE(&bytes, entry.crc, 4);
+        appendLE(&bytes, Max32, 4); // Compressed size, in ZIP64 extra field
+        appendLE(&bytes, Max32, 4); // Uncompressed size, in ZIP64 extra field
+        appendLE(&bytes, entry.filename.size(), 2);
+        appendLE(&bytes, 4 + 24, 2); // Extra field length
+        appendLE(&bytes, 0, 2); // Comment length
+        appendLE(&bytes, 0, 2); // Disk number start
+        appendLE(&bytes, 0, 2); // Internal attributes
+        appendLE(&bytes, 0, 4); // External attributes
+        appendLE(&bytes, Max32, 4); // Local header offset, in ZIP64 extra field
+        appendText(&bytes, entry.filename);
+        appendLE(&bytes, Zip64ExtraFieldId, 2);
+        appendLE(&bytes, 24, 2);
+        appendLE(&bytes, entry.uncompressedSize, 8);
+        appendLE(&bytes, entry.compressedSize, 8);
+        appendLE(&bytes, entry.localHeaderOffset, 8);
+    }
+
+    const uint64_t centralDirSize = bytes.size();
+    const uint64_t zip64EndOffset = centralDirOffset + centralDirSize;
+    appendLE(&bytes, Zip64EndOfCentralDirSignature, 4);
+    appendLE(&bytes, 44, 8); // Size of remaining record
+    appendLE(&bytes, ZipVersion, 2);
+    appendLE(&bytes, ZipVersion, 2);
+    appendLE(&bytes, 0, 4); // Number of this disk
+    appendLE(&bytes, 0, 4); // Disk of central directory start
+    appendLE(&bytes, m_vecEntry.size(), 8);
+    appendLE(&bytes, m_vecEntry.size(), 8);
+    appendLE(&bytes, centralDirSize, 8);
+    appendLE(&bytes, centralDirOffset, 8);
+
+    appendLE(&bytes, Zip64EndOfCentralDirLocatorSignature, 4);
+    appendLE(&bytes, 0, 4); // Disk of ZIP64 end of central directory
+    appendLE(&bytes, zip64EndOffset, 8);
+    appendLE(&bytes, 1, 4); // Total number of disks
+
+    appendLE(&bytes, EndOfCentralDirSignature, 4);
+    appendLE(&bytes, 0, 2);
+    appendLE(&bytes, 0, 2);
+    appendLE(&bytes, std::min<uint64_t>(m_vecEntry.size(), Max16), 2);
+    appendLE(&bytes, std::min<uint64_t>(m_vecEntry.size(), Max16), 2);
+    appendLE(&bytes, std::min<uint64_t>(centralDirSize, Max32), 4);
+    appendLE(&bytes, std::min<uint64_t>(centralDirOffset, Max32), 4);
+    appendLE(&bytes, 0, 2); // Comment length
+    return this->write(bytes);
+}
+
+bool ZipWriter::write(const std::vector<uint8_t>& bytes)
+{
+    const auto data = reinterpret_cast<const char*>(bytes.data());
+    m_isOk = m_isOk && m_file->write(data, bytes.size()) == qint64(bytes.size());
+    return m_isOk;
+}
+
+ZipReader::ZipReader(Span<const uint8_t> data)
+    : m_data(data)
+{
+    constexpr size_t endRecordSize = 22;
+    if (data.size() < endRecordSize)
+        return;
+
+    // Find "end of central directory" record, which ends with a comment of variable length
+    const uint8_t* bytes = data.data();
+    size_t posEnd = data.size() - endRecordSize;
+    const size_t posEndMin = posEnd > Max16 ? posEnd - Max16 : 0;
+    while (readLE(bytes + posEnd, 4) != EndOfCentralDirSignature) {
+        if (posEnd == posEndMin)
+            return;
+
+        --posEnd;
+    }
+
+    uint64_t entryCount = readLE(bytes + posEnd + 10, 2);
+    uint64_t centralDirSize = readLE(bytes + posEnd + 12, 4);
+    uint64_t centralDirOffset = readLE(bytes + posEnd + 16, 4);
+    constexpr size_t locatorSize = 20;
+    constexpr size_t zip64EndRecordSize = 56;
+    if (posEnd >= locatorSize && readLE(bytes + posEnd - locatorSize, 4) == Zip64EndOfCentralDirLocatorSignature) {
+        const uint64_t posZip64End = readLE(bytes + posEnd - locatorSize + 8, 8);
+        if (data.size() < zip64EndRecordSize
+                || posZip64End > data.size() - zip64EndRecordSize
+                || readLE(bytes + posZip64End, 4) != Zip64EndOfCentralDirSignature)
+        {
+            return;
+        }
+
+        entryCount = readLE(bytes + posZip64End + 32, 8);
+        centralDirSize = readLE(bytes + posZip64End + 40, 8);
+        centralDirOffset = readLE(bytes + posZip64End + 48, 8);
+    }
+
+    if (centralDirOffset > data.size() || centralDirSize > data.size() - centralDirOffset)
+        return;
+
+    constexpr size_t centralHeaderSize = 46;
+    const uint8_t* ptr = bytes + centralDirOffset;
+    const uint8_t* ptrEnd = ptr + centralDirSize;
+    for (uint64_t i = 0; i < entryCount; ++i) {
+        if (size_t(ptrEnd - ptr) < centralHeaderSize || readLE(ptr, 4) != CentralHeaderSignature)
+            return;
+
+        const size_t filenameSize = readLE(ptr + 28, 2);
+        const size_t extraSize = readLE(ptr + 30, 2);
+        const size_t commentSize = readLE(ptr + 32, 2);
+        if (size_t(ptrEnd - ptr) < centralHeaderSize + filenameSize + extraSize + commentSize)
+            return;
+
+        Entry entry;
+        entry.method = uint16_t(readLE(ptr + 10, 2));
+        entry.compressedSize = readLE(ptr + 20, 4);
+        entry.uncompressedSize = readLE(ptr + 24, 4);
+        entry.localHeaderOffset = readLE(ptr + 42, 4);
+        entry.filename.assign(reinterpret_cast<const char*>(ptr + centralHeaderSize), filenameSize);
+
+        // ZIP64 extra field holds the values saturated in the header, in this order
+        const uint8_t* extra = ptr + centralHeaderSize + filenameSize;
+        const uint8_t* extraEnd = extra + extraSize;
+        while (extraEnd - extra >= 4) {
+            const uint16_t fieldId = uint16_t(readLE(extra, 2));
+            const size_t fieldSize = std::min<size_t>(readLE(extra + 2, 2), extraEnd - extra - 4);
+            if (fieldId == Zip64ExtraFieldId) {
+                const uint8_t* field = extra + 4;
+                const uint8_t* fieldEnd = field + fieldSize;
+                for (uint64_t* value : { &entry.uncompressedSize, &entry.compressedSize, &entry.localHeaderOffset }) {
+                    if (*value == Max32 && fieldEnd - field >= 8) {
+                        *value = readLE(field, 8);
+                        field += 8;
+                    }
+                }
+            }
+
+            extra += 4 + fieldSize;
+        }
+
+        m_vecEntry.push_back(std::move(entry));
+        ptr += centralHeaderSize + filenameSize + extraSize + commentSize;
+    }
+
+    m_isValid = true;
+}
+
+const ZipReader::Entry* ZipReader::findEntry(std::string_view filename) const
+{
+    auto it = std::find_if(m_vecEntry.cbegin(), m_vecEntry.cend(), [=](const Entry& entry) {
+        return isSameFilename(entry.filename, filename);
+    });
+    return it != m_vecEntry.cend() ? &(*it) : nullptr;
+}
+
+bool ZipReader::readEntry(const Entry& entry, const std::function<bool(std::string_view)>& fnData) const
+{
+    constexpr size_t localHeaderSize = 30;
+    const uint64_t posHeader = entry.localHeaderOffset;
+    if (posHeader > m_data.size() || m_data.size() - posHeader < localHeaderSize)
+        return false;
+
+    const uint8_t* header = m_data.data() + posHeader;
+    if (readLE(header, 4) != LocalHeaderSignature)
+        return false;
+
+    const uint64_t posData = posHeader + localHeaderSize + readLE(header + 26, 2) + readLE(header + 28, 2);
+    if (posData > m_data.size() || entry.compressedSize > m_data.size() - posData)
+        return false;
+
+    const uint8_t* data = m_data.data() + posData;
+    if (entry.method == MethodStored) {
+        constexpr size_t blockSize = 1024 * 1024;
+        for (uint64_t pos = 0; pos < entry.compressedSize; pos += blockSize) {
+            const size_t size = size_t(std::min<uint64_t>(blockSize, entry.compressedSize - pos));
+            if (!fnData(std::string_view(reinterpret_cast<const char*>(data + pos), size)))
+                return false;
+        }
+
+        return true;
+    }
+
+    if (entry.method != MethodDeflated)
+        return false;
+
+    z_stream stream = {};
+    if (inflateInit2(&stream, -MAX_WBITS) != Z_OK)
+        return false;
+
+    std::vector<char> buffer(4 * 1024 * 1024);
+    uint64_t posInput = 0;
+    int res = Z_OK;
+    bool ok = true;
+    while (ok && res == Z_OK) {
+        if (stream.avail_in == 0) {
+            // Input is fed by parts, as avail_in is 32bit
+            const uint64_t size = std::min<uint64_t>(entry.compressedSize - posInput, std::numeric_limits<uInt>::max());
+            stream.next_in = const_cast<Bytef*>(data + posInput);
+            stream.avail_in = uInt(size);
+            posInput += size;
+        }
+
+        stream.next_out = reinterpret_cast<Bytef*>(buffer.data());
+        stream.avail_out = uInt(buffer.size());
+        res = inflate(&stream, Z_NO_FLUSH);
+        const size_t outputSize = buffer.size() - stream.avail_out;
+        if (res != Z_OK && res != Z_STREAM_END)
+            ok = false;
+        else if (outputSize > 0)
+            ok = fnData(std::string_view(buffer.data(), outputSize));
+
+        if (res == Z_OK && outputSize == 0 && stream.avail_in == 0 && posInput == entry.compressedSize)
+            ok = false; // Truncated data
+    }
+
+    inflateEnd(&stream);
+    return ok && res == Z_STREAM_END;
+}
+
+std::string ZipReader::entryContents(const Entry& entry) const
+{
+    std::string contents;
+    this->readEntry(entry, [&](std::string_view data) {
+        contents += data;
+        return true;
+    });
+    return contents;
+}
+
+} // namespace IO
+} // namespace Mayo
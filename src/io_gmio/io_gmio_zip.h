@@ -0,0 +1,109 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "../base/span.h"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class QFile;
+
+namespace Mayo {
+namespace IO {
+
+// Deflated data that can be concatenated with other blocks within a ZIP entry
+// Blocks are compressed independently(without shared dictionary), so they can be produced by
+// concurrent tasks
+struct ZipDeflateBlock {
+    std::vector<uint8_t> compressed;
+    uint32_t crc = 0; // CRC-32 of uncompressed data
+    uint64_t uncompressedSize = 0;
+    bool isValid = false;
+};
+
+// Returns 'data' deflated with compression 'level'(in [0,9]), as a non-final block
+ZipDeflateBlock zipDeflateBlock(std::string_view data, int level);
+
+// Minimal streaming writer of ZIP archives, entries are deflated and written with ZIP64 extensions
+// Sizes and CRC of an entry are known only once all its blocks are written, so they are stored in
+// a data descriptor following entry data
+// Uses zlib provided along with gmio
+class ZipWriter {
+public:
+    ZipWriter(QFile* file);
+
+    bool beginEntry(std::string_view filename);
+    bool writeEntryBlock(const ZipDeflateBlock& block);
+    bool endEntry();
+
+    // Convenience function to write an entry holding 'contents'
+    bool addEntry(std::string_view filename, std::string_view contents, int level);
+
+    // Writes the central directory, no more entries can be added after
+    bool finish();
+
+    bool isOk() const { return m_isOk; }
+
+private:
+    struct Entry {
+        std::string filename;
+        uint64_t localHeaderOffset = 0;
+        uint32_t crc = 0;
+        uint64_t compressedSize = 0;
+        uint64_t uncompressedSize = 0;
+    };
+
+    bool write(const std::vector<uint8_t>& bytes);
+
+    QFile* m_file = nullptr;
+    std::vector<Entry> m_vecEntry;
+    uint16_t m_dosTime = 0;
+    uint16_t m_dosDate = 0;
+    bool m_isEntryOpen = false;
+    bool m_isOk = true;
+};
+
+// Reader of ZIP archives whose contents are in memory(typically memory-mapped)
+// Supports stored and deflated entries, and ZIP64 extensions
+class ZipReader {
+public:
+    struct Entry {
+        std::string filename;
+        uint16_t method = 0;
+        uint64_t compressedSize = 0;
+        uint64_t uncompressedSize = 0;
+        uint64_t localHeaderOffset = 0;
+    };
+
+    ZipReader(Span<const uint8_t> data);
+
+    bool isValid() const { return m_isValid; }
+    Span<const Entry> entries() const { return m_vecEntry; }
+
+    // Filenames are compared case-insensitively, leading '/' is ignored
+    const Entry* findEntry(std::string_view filename) const;
+
+    // Decompresses data of 'entry' by blocks, fnData(block) is called for each block and returns
+    // false to stop decompression
+    // Returns true if all data could be decompressed and wasn't stopped
+    bool readEntry(const Entry& entry, const std::function<bool(std::string_view)>& fnData) const;
+
+    // Returns all the uncompressed data of 'entry', should be called only for small entries
+    std::string entryContents(const Entry& entry) const;
+
+private:
+    Span<const uint8_t> m_data;
+    std::vector<Entry> m_vecEntry;
+    bool m_isValid = false;
+};
+
+} // namespace IO
+} // namespace Mayo
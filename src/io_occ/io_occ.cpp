@@ -10,6 +10,8 @@
 #include "../base/tkernel_utils.h"
 #include "io_occ_brep.h"
 #include "io_occ_iges.h"
+#include "io_occ_obj_writer.h"
+#include "io_occ_ply.h"
 #include "io_occ_step.h"
 #include "io_occ_stl.h"
 #include "io_occ_vrml.h"
@@ -34,7 +36,7 @@ namespace { using PtrPropertyGroup = std::unique_ptr<PropertyGroup>; }
 Span<const Format> OccFactoryReader::formats() const
 {
     static const Format arrayFormat[] = {
-        Format_STEP, Format_IGES, Format_OCCBREP, Format_STL
+        Format_STEP, Format_IGES, Format_OCCBREP, Format_STL, Format_PLY
     #if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 4, 0)
         , Format_GLTF, Format_OBJ
     #endif
@@ -52,6 +54,8 @@ std::unique_ptr<Reader> OccFactoryReader::create(Format format) const
         return std::make_unique<OccBRepReader>();
     if (format == Format_STL)
         return std::make_unique<OccStlReader>();
+    if (format == Format_PLY)
+        return std::make_unique<OccPlyReader>();
 
 #if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 4, 0)
     if (format == Format_GLTF)
@@ -69,6 +73,8 @@ PtrPropertyGroup OccFactoryReader::createProperties(Format format, PropertyGroup
         return OccStepReader::createProperties(parentGroup);
     if (format == Format_IGES)
         return OccIgesReader::createProperties(parentGroup);
+    if (format == Format_STL)
+        return OccStlReader::createProperties(parentGroup);
 
 #if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 4, 0)
     if (format == Format_GLTF)
@@ -83,7 +89,7 @@ PtrPropertyGroup OccFactoryReader::createProperties(Format format, PropertyGroup
 Span<const Format> OccFactoryWriter::formats() const
 {
     static const Format arrayFormat[] = {
-        Format_STEP, Format_IGES, Format_OCCBREP, Format_STL, Format_VRML
+        Format_STEP, Format_IGES, Format_OCCBREP, Format_STL, Format_VRML, Format_PLY, Format_OBJ
     #if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 5, 0)
         , Format_GLTF
     #endif
@@ -103,6 +109,10 @@ std::unique_ptr<Writer> OccFactoryWriter::create(Format format) const
         return std::make_unique<OccStlWriter>();
     if (format == Format_VRML)
         return std::make_unique<OccVrmlWriter>();
+    if (format == Format_PLY)
+        return std::make_unique<OccPlyWriter>();
+    if (format == Format_OBJ)
+        return std::make_unique<OccObjWriter>();
 
 #if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 5, 0)
     if (format == Format_GLTF)
@@ -118,10 +128,16 @@ PtrPropertyGroup OccFactoryWriter::createProperties(Format format, PropertyGroup
         return OccStepWriter::createProperties(parentGroup);
     if (format == Format_IGES)
         return OccIgesWriter::createProperties(parentGroup);
+    if (format == Format_OCCBREP)
+        return OccBRepWriter::createProperties(parentGroup);
     if (format == Format_STL)
         return OccStlWriter::createProperties(parentGroup);
     if (format == Format_VRML)
         return OccVrmlWriter::createProperties(parentGroup);
+    if (format == Format_PLY)
+        return OccPlyWriter::createProperties(parentGroup);
+    if (format == Format_OBJ)
+        return OccObjWriter::createProperties(parentGroup);
 
 #if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 5, 0)
     if (format == Format_GLTF)
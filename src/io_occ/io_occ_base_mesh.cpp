@@ -6,13 +6,20 @@
 
 #include "io_occ_base_mesh.h"
 
+#include "../base/caf_utils.h"
 #include "../base/document.h"
 #include "../base/occ_progress_indicator.h"
+#include "../base/profiler.h"
 #include "../base/task_progress.h"
 #include "../base/string_conv.h"
 #include "../base/tkernel_utils.h"
 
+#include <Poly_Array1OfTriangle.hxx>
 #include <RWMesh_CafReader.hxx>
+#include <TColgp_Array1OfPnt.hxx>
+#include <TDataStd_Name.hxx>
+#include <TDataXtd_Triangulation.hxx>
+#include <utility>
 
 namespace Mayo {
 namespace IO {
@@ -21,10 +28,15 @@ OccBaseMeshReaderProperties::OccBaseMeshReaderProperties(PropertyGroup* parentGr
     : PropertyGroup(parentGroup),
       rootPrefix(this, textId("rootPrefix")),
       systemCoordinatesConverter(this, textId("systemCoordinatesConverter")),
-      systemLengthUnit(this, textId("systemLengthUnit"))
+      systemLengthUnit(this, textId("systemLengthUnit")),
+      meshEntities(this, textId("meshEntities"))
 {
     this->rootPrefix.setDescription(tr("Prefix for generating root labels name"));
     this->systemLengthUnit.setDescription(tr("System length units to convert into while reading files"));
+    this->meshEntities.setDescription(
+                tr("Import file as a single mesh instead of a shape having a face per mesh "
+                   "primitive. Lighter in memory and faster to display, but assembly structure, "
+                   "names and colors are lost"));
 }
 
 void OccBaseMeshReaderProperties::restoreDefaults()
@@ -33,6 +45,7 @@ void OccBaseMeshReaderProperties::restoreDefaults()
     this->rootPrefix.setValue(defaults.rootPrefix);
     this->systemCoordinatesConverter.setValue(defaults.systemCoordinatesConverter);
     this->systemLengthUnit.setValue(defaults.systemLengthUnit);
+    this->meshEntities.setValue(defaults.meshEntities);
 }
 
 double OccBaseMeshReaderProperties::lengthUnitFactor(LengthUnit lenUnit)
@@ -68,13 +81,26 @@ OccBaseMeshReaderProperties::LengthUnit OccBaseMeshReaderProperties::lengthUnit(
 
 bool OccBaseMeshReader::readFile(const FilePath& filepath, TaskProgress* /*progress*/)
 {
+    MAYO_PROFILE_ZONE("OccBaseMeshReader::readFile");
     m_filepath = filepath;
     return true;
 }
 
 TDF_LabelSequence OccBaseMeshReader::transfer(DocumentPtr doc, TaskProgress* progress)
 {
+    MAYO_PROFILE_ZONE("OccBaseMeshReader::transfer");
     this->applyParameters();
+    if (this->constParameters().meshEntities) {
+        // No target document: RWMesh_CafReader then only builds the root shapes, faces are
+        // released along with the reader
+        m_reader.SetDocument(Handle_TDocStd_Document());
+        Handle_Message_ProgressIndicator indicator = new OccProgressIndicator(progress);
+        m_reader.Perform(m_filepath.u8string().c_str(), TKernelUtils::start(indicator));
+        const auto parts = StlNative::meshParts(m_reader.SingleShape());
+        const TDF_Label entityLabel = OccBaseMeshReader::addMeshEntity(doc, parts, m_filepath);
+        return !entityLabel.IsNull() ? CafUtils::makeLabelSequence({ entityLabel }) : TDF_LabelSequence();
+    }
+
     m_reader.SetDocument(doc);
     const TDF_LabelSequence seqMark = doc->xcaf().topLevelFreeShapes();
     Handle_Message_ProgressIndicator indicator = new OccProgressIndicator(progress);
@@ -89,6 +115,7 @@ void OccBaseMeshReader::applyProperties(const PropertyGroup* params)
         this->parameters().systemCoordinatesConverter = ptr->systemCoordinatesConverter;
         this->parameters().systemLengthUnit = ptr->systemLengthUnit;
         this->parameters().rootPrefix = ptr->rootPrefix;
+        this->parameters().meshEntities = ptr->meshEntities;
     }
 }
 
@@ -104,5 +131,71 @@ void OccBaseMeshReader::applyParameters()
     m_reader.SetSystemCoordinateSystem(this->constParameters().systemCoordinatesConverter);
 }
 
+TDF_Label OccBaseMeshReader::addMeshEntity(
+        DocumentPtr doc, Span<const StlNative::MeshPart> parts, const FilePath& filepath)
+{
+    int nodeCount = 0;
+    int triangleCount = 0;
+    bool hasNormals = true;
+    for (const StlNative::MeshPart& part : parts) {
+        nodeCount += part.triangulation->NbNodes();
+        triangleCount += part.triangulation->NbTriangles();
+        hasNormals = hasNormals && part.triangulation->HasNormals();
+    }
+
+    if (triangleCount == 0)
+        return {};
+
+    TColgp_Array1OfPnt nodes(1, nodeCount);
+    Poly_Array1OfTriangle triangles(1, triangleCount);
+    int nodeOffset = 0;
+    int triangleOffset = 0;
+    for (const StlNative::MeshPart& part : parts) {
+        const Handle_Poly_Triangulation& mesh = part.triangulation;
+        for (int i = 1; i <= mesh->NbNodes(); ++i)
+            nodes.SetValue(nodeOffset + i, mesh->Node(i).Transformed(part.trsf));
+
+        for (int i = 1; i <= mesh->NbTriangles(); ++i) {
+            int n1, n2, n3;
+            mesh->Triangle(i).Get(n1, n2, n3);
+            if (part.isReversed)
+                std::swap(n2, n3);
+
+            triangles.SetValue(triangleOffset + i, Poly_Triangle(n1 + nodeOffset, n2 + nodeOffset, n3 + nodeOffset));
+        }
+
+        nodeOffset += mesh->NbNodes();
+        triangleOffset += mesh->NbTriangles();
+    }
+
+    Handle_Poly_Triangulation meshEntity = new Poly_Triangulation(nodes, triangles);
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+    // Normals are kept only if all parts provide them, otherwise they're computed for display
+    if (hasNormals) {
+        meshEntity->AddNormals();
+        nodeOffset = 0;
+        for (const StlNative::MeshPart& part : parts) {
+            const Handle_Poly_Triangulation& mesh = part.triangulation;
+            for (int i = 1; i <= mesh->NbNodes(); ++i) {
+                gp_Dir normal = mesh->Normal(i).Transformed(part.trsf);
+                if (part.isReversed)
+                    normal.Reverse();
+
+                meshEntity->SetNormal(nodeOffset + i, normal);
+            }
+
+            nodeOffset += mesh->NbNodes();
+        }
+    }
+#else
+    (void)hasNormals;
+#endif
+
+    const TDF_Label entityLabel = doc->newEntityLabel();
+    TDataXtd_Triangulation::Set(entityLabel, meshEntity);
+    TDataStd_Name::Set(entityLabel, filepathTo<TCollection_ExtendedString>(filepath.stem()));
+    return entityLabel;
+}
+
 } // namespace IO
 } // namespace Mayo
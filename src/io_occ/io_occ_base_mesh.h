@@ -7,6 +7,7 @@
 #pragma once
 
 #include "io_occ_common.h"
+#include "io_occ_stl_native.h"
 #include "../base/io_reader.h"
 #include "../base/property_builtins.h"
 #include "../base/property_enumeration.h"
@@ -32,6 +33,9 @@ public:
         std::string rootPrefix;
         LengthUnit systemLengthUnit = LengthUnit::Undefined;
         RWMesh_CoordinateSystem systemCoordinatesConverter = RWMesh_CoordinateSystem_Undefined;
+        // Create a single mesh entity(TDataXtd_Triangulation) instead of an XCAF shape having a
+        // face per mesh primitive. Assembly structure, names and colors are lost
+        bool meshEntities = false;
     };
     virtual Parameters& parameters() = 0;
     virtual const Parameters& constParameters() const = 0;
@@ -40,6 +44,10 @@ protected:
     OccBaseMeshReader(RWMesh_CafReader& reader);
     virtual void applyParameters();
 
+    // Adds to 'doc' an entity label holding the triangulations of 'parts' merged into a single
+    // one, placements being applied. Returns null label if 'parts' has no triangle
+    static TDF_Label addMeshEntity(DocumentPtr doc, Span<const StlNative::MeshPart> parts, const FilePath& filepath);
+
 private:
     FilePath m_filepath;
     RWMesh_CafReader& m_reader;
@@ -61,6 +69,7 @@ public:
     PropertyString rootPrefix;
     PropertyEnum<RWMesh_CoordinateSystem> systemCoordinatesConverter;
     PropertyEnum<LengthUnit> systemLengthUnit;
+    PropertyBool meshEntities;
 };
 
 } // namespace IO
@@ -10,22 +10,89 @@
 #include "../base/caf_utils.h"
 #include "../base/document.h"
 #include "../base/occ_progress_indicator.h"
+#include "../base/property_builtins.h"
+#include "../base/property_enumeration.h"
 #include "../base/task_progress.h"
 #include "../base/tkernel_utils.h"
 
+#include <BinTools.hxx>
 #include <BRep_Builder.hxx>
 #include <BRepTools.hxx>
 #include <TDataStd_Name.hxx>
+#include <algorithm>
+#include <fstream>
+#include <string_view>
 
 namespace Mayo {
 namespace IO {
 
+class OccBRepWriter::Properties : public PropertyGroup {
+    MAYO_DECLARE_TEXT_ID_FUNCTIONS(Mayo::IO::OccBRepWriter::Properties)
+public:
+    Properties(PropertyGroup* parentGroup)
+        : PropertyGroup(parentGroup)
+    {
+        this->targetFormat.mutableEnumeration().changeTrContext(this->textIdContext());
+        this->targetFormat.setDescription(
+                    textIdTr("Binary format is faster to read and write, and files are smaller"));
+        this->writeTriangulations.setDescription(
+                    textIdTr("Write the triangulations(meshes) of the faces along with the shapes"));
+        this->writeNormals.setDescription(textIdTr("Write the normals of the triangulations, if any"));
+#if OCC_VERSION_HEX < OCC_VERSION_CHECK(7, 6, 0)
+        this->writeTriangulations.setEnabled(false);
+        this->writeNormals.setEnabled(false);
+#endif
+    }
+
+    void restoreDefaults() override {
+        const OccBRepWriter::Parameters params;
+        this->targetFormat.setValue(params.format);
+        this->writeTriangulations.setValue(params.writeTriangulations);
+        this->writeNormals.setValue(params.writeNormals);
+    }
+
+    PropertyEnum<OccBRepWriter::Format> targetFormat{ this, textId("targetFormat") };
+    PropertyBool writeTriangulations{ this, textId("writeTriangulations") };
+    PropertyBool writeNormals{ this, textId("writeNormals") };
+};
+
+namespace {
+
+// Whether 'contents'(start of a file) is the header of a binary BRep file(BinTools)
+bool isBinaryOccBRep(std::string_view contents)
+{
+    // BinTools_ShapeSet header is "Open CASCADE Topology V<n> (c)"
+    constexpr std::string_view binaryToken = "Open CASCADE Topology V";
+    auto itChar = std::find_if_not(contents.cbegin(), contents.cend(), [](char c) {
+        return c == ' ' || (c >= '\t' && c <= '\r');
+    });
+    const std::string_view str = contents.substr(itChar - contents.cbegin());
+    return str.substr(0, binaryToken.size()) == binaryToken;
+}
+
+} // namespace
+
 bool OccBRepReader::readFile(const FilePath& filepath, TaskProgress* progress)
 {
     m_shape.Nullify();
     m_baseFilename = filepath.stem();
-    BRep_Builder brepBuilder;
+
+    char header[64] = {};
+    std::ifstream ifs(filepath, std::ios::in | std::ios::binary);
+    ifs.read(header, sizeof(header));
+    const bool isBinary = isBinaryOccBRep(std::string_view(header, size_t(ifs.gcount())));
+    ifs.close();
+
     Handle_Message_ProgressIndicator indicator = new OccProgressIndicator(progress);
+    if (isBinary) {
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 5, 0)
+        return BinTools::Read(m_shape, filepath.u8string().c_str(), TKernelUtils::start(indicator));
+#else
+        return BinTools::Read(m_shape, filepath.u8string().c_str());
+#endif
+    }
+
+    BRep_Builder brepBuilder;
     return BRepTools::Read(
                 m_shape,
                 filepath.u8string().c_str(),
@@ -81,7 +148,49 @@ bool OccBRepWriter::transfer(Span<const ApplicationItem> appItems, TaskProgress*
 bool OccBRepWriter::writeFile(const FilePath& filepath, TaskProgress* progress)
 {
     Handle_Message_ProgressIndicator indicator = new OccProgressIndicator(progress);
-    return BRepTools::Write(m_shape, filepath.u8string().c_str(), TKernelUtils::start(indicator));
+    const std::string strFilepath = filepath.u8string();
+    if (m_params.format == Format::Binary) {
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+        return BinTools::Write(
+                    m_shape,
+                    strFilepath.c_str(),
+                    m_params.writeTriangulations,
+                    m_params.writeNormals,
+                    BinTools_FormatVersion_CURRENT,
+                    TKernelUtils::start(indicator));
+#elif OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 5, 0)
+        return BinTools::Write(m_shape, strFilepath.c_str(), TKernelUtils::start(indicator));
+#else
+        return BinTools::Write(m_shape, strFilepath.c_str());
+#endif
+    }
+
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+    return BRepTools::Write(
+                m_shape,
+                strFilepath.c_str(),
+                m_params.writeTriangulations,
+                m_params.writeNormals,
+                TopTools_FormatVersion_CURRENT,
+                TKernelUtils::start(indicator));
+#else
+    return BRepTools::Write(m_shape, strFilepath.c_str(), TKernelUtils::start(indicator));
+#endif
+}
+
+std::unique_ptr<PropertyGroup> OccBRepWriter::createProperties(PropertyGroup* parentGroup)
+{
+    return std::make_unique<Properties>(parentGroup);
+}
+
+void OccBRepWriter::applyProperties(const PropertyGroup* params)
+{
+    auto ptr = dynamic_cast<const Properties*>(params);
+    if (ptr) {
+        m_params.format = ptr->targetFormat;
+        m_params.writeTriangulations = ptr->writeTriangulations;
+        m_params.writeNormals = ptr->writeNormals;
+    }
 }
 
 } // namespace IO
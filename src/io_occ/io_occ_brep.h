@@ -14,6 +14,7 @@ namespace Mayo {
 namespace IO {
 
 // Reader for OpenCascade BRep file format
+// ASCII(BRepTools) and binary(BinTools) contents are both supported, detected from file header
 class OccBRepReader : public Reader {
 public:
     bool readFile(const FilePath& filepath, TaskProgress* progress) override;
@@ -30,7 +31,23 @@ public:
     bool transfer(Span<const ApplicationItem> appItems, TaskProgress* progress) override;
     bool writeFile(const FilePath& filepath, TaskProgress* progress) override;
 
+    static std::unique_ptr<PropertyGroup> createProperties(PropertyGroup* parentGroup);
+    void applyProperties(const PropertyGroup* params) override;
+
+    // Parameters
+
+    enum class Format { Ascii, Binary };
+    struct Parameters {
+        Format format = Format::Ascii;
+        bool writeTriangulations = true; // Requires OpenCascade >= v7.6.0 to be disabled
+        bool writeNormals = false; // Requires OpenCascade >= v7.6.0
+    };
+    Parameters& parameters() { return m_params; }
+    const Parameters& constParameters() const { return m_params; }
+
 private:
+    class Properties;
+    Parameters m_params;
     TopoDS_Shape m_shape;
 };
 
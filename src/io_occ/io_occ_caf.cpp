@@ -8,15 +8,41 @@
 #include "../base/global.h"
 #include "../base/document.h"
 #include "../base/occ_progress_indicator.h"
+#include "../base/task_manager.h"
 #include "../base/task_progress.h"
 #include "../base/tkernel_utils.h"
 
 #include <Transfer_TransientProcess.hxx>
-#include <IGESCAFControl_Reader.hxx>
+#include <BRepBndLib.hxx>
+#include <BRepToIGESBRep_Entity.hxx>
+#include <BRepToIGES_BREntity.hxx>
+#include <Bnd_Box.hxx>
+#include <IGESBasic_Group.hxx>
 #include <IGESCAFControl_Writer.hxx>
+#include <IGESCAFControl_Reader.hxx>
+#include <IGESData_HArray1OfIGESEntity.hxx>
+#include <IGESData_IGESModel.hxx>
+#include <Interface_Protocol.hxx>
+#include <Interface_Static.hxx>
+#include <ShapeAnalysis_ShapeTolerance.hxx>
+#include <Standard_Failure.hxx>
+#include <TopoDS_Iterator.hxx>
+#include <XSAlgo.hxx>
+#include <XSAlgo_AlgoContainer.hxx>
 #include <STEPCAFControl_Reader.hxx>
 #include <STEPCAFControl_Writer.hxx>
+#include <TDocStd_Document.hxx>
+#include <XCAFDoc_DocumentTool.hxx>
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+#  include <XCAFDoc_Editor.hxx>
+#endif
+#include <XCAFDoc_ShapeTool.hxx>
 #include <gsl/util>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace Mayo {
 namespace IO {
@@ -72,6 +98,213 @@ bool cafGenericWriteTransfer(CAF_WRITER& writer, Span<const ApplicationItem> app
     return true;
 }
 
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+// Contiguous range of roots(1-based indices) to be translated into a scratch document
+struct RootBatch {
+    int firstRoot = 0;
+    int lastRoot = 0;
+    Handle_TDocStd_Document scratchDoc;
+};
+
+int rootBatchCount(int rootCount)
+{
+    const int threadCount = std::max(1, int(std::thread::hardware_concurrency()));
+    return std::min(rootCount, threadCount);
+}
+
+bool canTransferRootsInParallel(int rootCount)
+{
+    return rootBatchCount(rootCount) >= 2;
+}
+
+// Splits the roots into batches translated concurrently with 'fnTransferBatch', then merges the
+// scratch documents into 'doc'
+// Each batch gets a contiguous range of roots, so merged entities keep the order of the file
+// Note: entities shared between batches are translated once per batch
+template<typename FN>
+TDF_LabelSequence cafTransferRootBatchesInParallel(
+        int rootCount, DocumentPtr doc, TaskProgress* progress, FN fnTransferBatch)
+{
+    const int batchCount = rootBatchCount(rootCount);
+    std::vector<RootBatch> vecBatch(batchCount);
+    for (RootBatch& batch : vecBatch) {
+        const int index = &batch - &vecBatch.front();
+        batch.firstRoot = 1 + (index * rootCount) / batchCount;
+        batch.lastRoot = ((index + 1) * rootCount) / batchCount;
+        batch.scratchDoc = new TDocStd_Document("BinXCAF");
+        XCAFDoc_DocumentTool::Set(batch.scratchDoc->Main(), false);
+    }
+
+    TaskManager childTaskManager;
+    QObject::connect(&childTaskManager, &TaskManager::progressChanged, [&](TaskId, int) {
+        if (progress)
+            progress->setValue(childTaskManager.globalProgress());
+    });
+
+    std::vector<TaskId> vecTaskId;
+    for (RootBatch& batch : vecBatch) {
+        const TaskId taskId = childTaskManager.newTask([&](TaskProgress* batchProgress) {
+            fnTransferBatch(batch, batchProgress);
+        });
+        vecTaskId.push_back(taskId);
+    }
+
+    for (const TaskId taskId : vecTaskId)
+        childTaskManager.run(taskId, TaskAutoDestroy::Off);
+
+    // Timeout is only used to check periodically for abort request
+    bool isAbortPropagated = false;
+    while (!childTaskManager.waitForAll(vecTaskId, 100)) {
+        if (!isAbortPropagated && TaskProgress::isAbortRequested(progress)) {
+            for (const TaskId taskId : vecTaskId)
+                childTaskManager.requestAbort(taskId);
+
+            isAbortPropagated = true;
+        }
+    }
+
+    if (TaskProgress::isAbortRequested(progress))
+        return {};
+
+    // Merge in calling thread, attributes(names, colors, layers, ...) are cloned along with shapes
+    const TDF_LabelSequence seqMark = doc->xcaf().topLevelFreeShapes();
+    const TDF_Label labelShapeTool = doc->xcaf().shapeTool()->Label();
+    for (const RootBatch& batch : vecBatch) {
+        TDF_LabelSequence seqBatchFreeShape;
+        XCAFDoc_DocumentTool::ShapeTool(batch.scratchDoc->Main())->GetFreeShapes(seqBatchFreeShape);
+        XCAFDoc_Editor::Extract(seqBatchFreeShape, labelShapeTool);
+    }
+
+    return doc->xcaf().diffTopLevelFreeShapes(seqMark);
+}
+
+#endif
+
+// Gives access to the protected functions of IGESCAFControl_Writer writing the XCAF attributes of
+// shapes already translated
+class IgesAttributesWriter : public IGESCAFControl_Writer {
+public:
+    static void write(IGESCAFControl_Writer& writer, const TDF_LabelSequence& labels) {
+        using FnWrite = Standard_Boolean (IGESCAFControl_Writer::*)(const TDF_LabelSequence&);
+        const FnWrite fnWriteAttributes = &IgesAttributesWriter::WriteAttributes;
+        const FnWrite fnWriteLayers = &IgesAttributesWriter::WriteLayers;
+        const FnWrite fnWriteNames = &IgesAttributesWriter::WriteNames;
+        if (writer.GetColorMode())
+            (writer.*fnWriteAttributes)(labels);
+
+        if (writer.GetLayerMode())
+            (writer.*fnWriteLayers)(labels);
+
+        if (writer.GetNameMode())
+            (writer.*fnWriteNames)(labels);
+    }
+};
+
+// Shape translated into an IGES entity by a concurrent task, with its own transfer process
+struct IgesTranslationUnit {
+    TopoDS_Shape shape;
+    TopoDS_Shape processedShape;
+    Handle_IGESData_IGESEntity entity;
+    Handle_Transfer_FinderProcess finderProcess;
+};
+
+// Shape of a label, translated as a single unit or split into its sub-shapes when it's a compound
+struct IgesTranslationRoot {
+    TopoDS_Shape shape;
+    int firstUnit = 0;
+    int unitCount = 0;
+};
+
+// Same steps as IGESControl_Writer::AddShape(): shape processing("write.iges.sequence"), then
+// translation with BRepToIGES_BREntity or BRepToIGESBRep_Entity
+void translateIgesUnit(IgesTranslationUnit* unit, const Handle_IGESData_IGESModel& model, bool brepMode)
+{
+    try {
+        Handle_Standard_Transient info;
+        const double tol = Interface_Static::RVal("write.precision.val");
+        const double maxTol = Interface_Static::RVal("read.maxprecision.val");
+        unit->processedShape = XSAlgo::AlgoContainer()->ProcessShape(
+                    unit->shape, tol, maxTol, "write.iges.resource.name", "write.iges.sequence", info);
+        unit->finderProcess = new Transfer_FinderProcess;
+        if (brepMode) {
+            BRepToIGESBRep_Entity converter;
+            converter.SetTransferProcess(unit->finderProcess);
+            converter.SetModel(model);
+            unit->entity = converter.TransferShape(unit->processedShape);
+        }
+        else {
+            BRepToIGES_BREntity converter;
+            converter.SetTransferProcess(unit->finderProcess);
+            converter.SetModel(model);
+            unit->entity = converter.TransferShape(unit->processedShape);
+        }
+
+        if (unit->processedShape != unit->shape)
+            XSAlgo::AlgoContainer()->MergeTransferInfo(unit->finderProcess, info);
+    } catch (const Standard_Failure&) {
+        unit->entity.Nullify();
+    }
+}
+
+// Updates the resolution and max coordinate of the global section of 'model' once 'shapes' were
+// added, as IGESControl_Writer::AddShape() does
+void updateIgesGlobalSection(
+        const Handle_IGESData_IGESModel& model,
+        const std::vector<TopoDS_Shape>& shapes,
+        int oldEntityCount)
+{
+    const int newEntityCount = model->NbEntities();
+    const double oldTol = model->GlobalSection().Resolution();
+    double newTol = 0;
+    const int tolMode = Interface_Static::IVal("write.precision.mode");
+    if (tolMode == 2) {
+        newTol = Interface_Static::RVal("write.precision.val");
+    }
+    else {
+        ShapeAnalysis_ShapeTolerance vertexTol;
+        ShapeAnalysis_ShapeTolerance edgeTol;
+        vertexTol.InitTolerance();
+        edgeTol.InitTolerance();
+        for (const TopoDS_Shape& shape : shapes) {
+            vertexTol.AddTolerance(shape, TopAbs_VERTEX);
+            edgeTol.AddTolerance(shape, TopAbs_EDGE);
+        }
+
+        const double tolVertex = vertexTol.GlobalTolerance(tolMode);
+        const double tolEdge = edgeTol.GlobalTolerance(tolMode);
+        if (tolMode == 0) {
+            const double tol = (tolVertex + tolEdge) / 2.;
+            newTol = (oldTol * oldEntityCount + tol * (newEntityCount - oldEntityCount)) / std::max(1, newEntityCount);
+        }
+        else if (tolMode < 0) {
+            newTol = std::min(tolVertex, tolEdge);
+            if (oldEntityCount > 0)
+                newTol = std::min(oldTol, newTol);
+        }
+        else {
+            newTol = std::max(tolVertex, tolEdge);
+            if (oldEntityCount > 0)
+                newTol = std::max(oldTol, newTol);
+        }
+    }
+
+    IGESData_GlobalSection gs = model->GlobalSection();
+    gs.SetResolution(newTol / gs.UnitValue());
+    Bnd_Box box;
+    for (const TopoDS_Shape& shape : shapes)
+        BRepBndLib::Add(shape, box);
+
+    if (!box.IsVoid()) {
+        double xMin, yMin, zMin, xMax, yMax, zMax;
+        box.Get(xMin, yMin, zMin, xMax, yMax, zMax);
+        const double unit = gs.UnitValue();
+        gs.MaxMaxCoords(gp_XYZ(xMax / unit, yMax / unit, zMax / unit));
+        gs.MaxMaxCoords(gp_XYZ(-xMin / unit, -yMin / unit, -zMin / unit));
+    }
+
+    model->SetGlobalSection(gs);
+}
+
 } // namespace
 
 namespace Private {
@@ -106,6 +339,81 @@ TDF_LabelSequence cafTransfer(STEPCAFControl_Reader& reader, DocumentPtr doc, Ta
     return cafGenericReadTransfer(reader, doc, progress);
 }
 
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+TDF_LabelSequence cafTransferRootsInParallel(
+        STEPCAFControl_Reader& reader, DocumentPtr doc, TaskProgress* progress)
+{
+    const Handle_Interface_InterfaceModel model = reader.Reader().WS()->Model();
+    const int rootCount = reader.ChangeReader().NbRootsForTransfer();
+    if (!canTransferRootsInParallel(rootCount))
+        return cafTransfer(reader, doc, progress);
+
+    auto fnTransferBatch = [&](RootBatch& batch, TaskProgress* batchProgress) {
+        // Separate work session(and transfer process) sharing the already parsed STEP model
+        Handle_XSControl_WorkSession batchWs = new XSControl_WorkSession;
+        batchWs->SelectNorm("STEP");
+        batchWs->SetModel(model);
+        STEPCAFControl_Reader batchReader(batchWs, false/*!scratch*/);
+        batchReader.SetColorMode(reader.GetColorMode());
+        batchReader.SetNameMode(reader.GetNameMode());
+        batchReader.SetLayerMode(reader.GetLayerMode());
+        batchReader.SetPropsMode(reader.GetPropsMode());
+        batchReader.SetGDTMode(reader.GetGDTMode());
+        batchReader.SetMatMode(reader.GetMatMode());
+        batchReader.SetViewMode(reader.GetViewMode());
+        batchReader.ChangeReader().NbRootsForTransfer();
+        const int batchRootCount = batch.lastRoot - batch.firstRoot + 1;
+        for (int iRoot = batch.firstRoot; iRoot <= batch.lastRoot; ++iRoot) {
+            if (TaskProgress::isAbortRequested(batchProgress))
+                return;
+
+            batchReader.TransferOneRoot(iRoot, batch.scratchDoc);
+            batchProgress->setValue((100 * (iRoot - batch.firstRoot + 1)) / batchRootCount);
+        }
+    };
+
+    return cafTransferRootBatchesInParallel(rootCount, doc, progress, fnTransferBatch);
+}
+
+TDF_LabelSequence cafTransferRootsInParallel(
+        IGESCAFControl_Reader& reader, DocumentPtr doc, TaskProgress* progress)
+{
+    const Handle_Interface_InterfaceModel model = reader.WS()->Model();
+    const Handle_Interface_Protocol protocol = reader.WS()->Protocol();
+    const int rootCount = reader.NbRootsForTransfer();
+    if (!canTransferRootsInParallel(rootCount))
+        return cafTransfer(reader, doc, progress);
+
+    std::mutex mutexModel;
+    auto fnTransferBatch = [&](RootBatch& batch, TaskProgress* batchProgress) {
+        // IGESCAFControl_Reader::Transfer() translates all the roots of its model(then colors, names
+        // and layers of the translated entities), whatever the roots selected in XSControl_Reader
+        // So each batch gets a model holding only its roots along with the entities they refer to.
+        // Entities are shared with the source model, not copied
+        Handle_Interface_InterfaceModel batchModel = model->NewEmptyModel();
+        {
+            std::lock_guard<std::mutex> lock(mutexModel);
+            batchModel->GetFromAnother(model); // IGES start and global sections(ie units)
+            for (int iRoot = batch.firstRoot; iRoot <= batch.lastRoot; ++iRoot)
+                batchModel->AddWithRefs(reader.RootForTransfer(iRoot), protocol);
+        }
+
+        // Separate work session(and transfer process) for the batch model
+        Handle_XSControl_WorkSession batchWs = new XSControl_WorkSession;
+        batchWs->SelectNorm("IGES");
+        batchWs->SetModel(batchModel);
+        IGESCAFControl_Reader batchReader(batchWs, false/*!scratch*/);
+        batchReader.SetColorMode(reader.GetColorMode());
+        batchReader.SetNameMode(reader.GetNameMode());
+        batchReader.SetLayerMode(reader.GetLayerMode());
+        Handle_Message_ProgressIndicator indicator = new OccProgressIndicator(batchProgress);
+        batchReader.Transfer(batch.scratchDoc, indicator->Start());
+    };
+
+    return cafTransferRootBatchesInParallel(rootCount, doc, progress, fnTransferBatch);
+}
+#endif
+
 Handle_Transfer_FinderProcess cafFinderProcess(const IGESCAFControl_Writer& writer) {
     return writer.TransferProcess();
 }
@@ -122,6 +430,117 @@ bool cafTransfer(STEPCAFControl_Writer& writer, Span<const ApplicationItem> appI
     return cafGenericWriteTransfer(writer, appItems, progress);
 }
 
+bool cafTransferShapesInParallel(
+        IGESCAFControl_Writer& writer, bool brepMode, Span<const ApplicationItem> appItems, TaskProgress* progress)
+{
+    // Labels and translation roots of each item
+    std::vector<TDF_LabelSequence> vecItemLabels;
+    std::vector<IgesTranslationRoot> vecRoot;
+    std::vector<IgesTranslationUnit> vecUnit;
+    for (const ApplicationItem& item : appItems) {
+        TDF_LabelSequence seqLabel;
+        if (item.isDocument())
+            seqLabel = item.document()->xcaf().topLevelFreeShapes();
+        else if (item.isDocumentTreeNode())
+            seqLabel.Append(item.documentTreeNode().label());
+
+        for (const TDF_Label& label : seqLabel) {
+            IgesTranslationRoot root;
+            root.shape = XCaf::shape(label);
+            root.firstUnit = int(vecUnit.size());
+            if (root.shape.ShapeType() == TopAbs_COMPOUND && root.shape.NbChildren() > 1) {
+                for (TopoDS_Iterator it(root.shape); it.More(); it.Next())
+                    vecUnit.push_back({ it.Value(), {}, {}, {} });
+            }
+            else if (!root.shape.IsNull()) {
+                vecUnit.push_back({ root.shape, {}, {}, {} });
+            }
+
+            root.unitCount = int(vecUnit.size()) - root.firstUnit;
+            vecRoot.push_back(std::move(root));
+        }
+
+        vecItemLabels.push_back(std::move(seqLabel));
+    }
+
+    if (vecUnit.empty())
+        return false;
+
+    // Units are picked by the concurrent tasks in order, the biggest shapes usually come first
+    XSAlgo::AlgoContainer()->PrepareForTransfer();
+    const Handle_IGESData_IGESModel& model = writer.Model();
+    const int unitCount = int(vecUnit.size());
+    const int taskCount = std::max(1, std::min(unitCount, int(std::thread::hardware_concurrency())));
+    std::atomic<int> nextUnit{0};
+    std::atomic<int> translatedUnitCount{0};
+    TaskProgress translationProgress(progress, 90);
+    const bool ok = TaskManager::runConcurrently(taskCount, nullptr, [&](int iTask, TaskProgress*) {
+        for (int i = nextUnit++; i < unitCount; i = nextUnit++) {
+            if (TaskProgress::isAbortRequested(&translationProgress))
+                return;
+
+            translateIgesUnit(&vecUnit.at(i), model, brepMode);
+            const int count = ++translatedUnitCount;
+            if (iTask == 0) // Progress is reported by a single task
+                translationProgress.setValue((100 * count) / unitCount);
+        }
+    });
+    if (!ok || TaskProgress::isAbortRequested(progress))
+        return false;
+
+    // Entities are added to the model in the order of the labels, then translation results are
+    // made available to the XCAF attributes writing
+    const Handle_Transfer_FinderProcess writerFinderProcess = writer.TransferProcess();
+    BRepToIGES_BREntity resultBinder;
+    resultBinder.SetTransferProcess(writerFinderProcess);
+    auto itRoot = vecRoot.cbegin();
+    for (const TDF_LabelSequence& seqLabel : vecItemLabels) {
+        for (int iLabel = 1; iLabel <= seqLabel.Size(); ++iLabel, ++itRoot) {
+            const IgesTranslationRoot& root = *itRoot;
+            std::vector<Handle_IGESData_IGESEntity> vecEntity;
+            std::vector<TopoDS_Shape> vecProcessedShape;
+            for (int i = root.firstUnit; i < root.firstUnit + root.unitCount; ++i) {
+                const IgesTranslationUnit& unit = vecUnit.at(i);
+                if (unit.entity.IsNull())
+                    continue;
+
+                vecEntity.push_back(unit.entity);
+                vecProcessedShape.push_back(unit.processedShape);
+                for (int iMapped = 1; iMapped <= unit.finderProcess->NbMapped(); ++iMapped) {
+                    const Handle_Transfer_Finder& mapped = unit.finderProcess->Mapped(iMapped);
+                    if (!writerFinderProcess->IsBound(mapped))
+                        writerFinderProcess->Bind(mapped, unit.finderProcess->MapItem(iMapped));
+                }
+            }
+
+            if (vecEntity.empty())
+                continue;
+
+            // Sub-shapes of a compound are grouped, as BRepToIGES_BREntity::TransferCompound() does
+            Handle_IGESData_IGESEntity rootEntity = vecEntity.front();
+            if (root.unitCount > 1) {
+                Handle_IGESData_HArray1OfIGESEntity arrayEntity = new IGESData_HArray1OfIGESEntity(1, int(vecEntity.size()));
+                for (const Handle_IGESData_IGESEntity& entity : vecEntity)
+                    arrayEntity->SetValue(int(&entity - &vecEntity.front()) + 1, entity);
+
+                Handle_IGESBasic_Group group = new IGESBasic_Group;
+                group->Init(arrayEntity);
+                rootEntity = group;
+                resultBinder.AddResult(root.shape, group);
+            }
+
+            const int oldEntityCount = model->NbEntities();
+            writer.AddEntity(rootEntity);
+            updateIgesGlobalSection(model, vecProcessedShape, oldEntityCount);
+        }
+
+        IgesAttributesWriter::write(writer, seqLabel);
+    }
+
+    writer.ComputeModel();
+    return true;
+}
+
 } // namespace Private
 } // namespace IO
 } // namespace Mayo
@@ -14,6 +14,7 @@
 #include "../base/document_ptr.h"
 #include "../base/filepath.h"
 #include "../base/span.h"
+#include "../base/tkernel_utils.h"
 
 #include <Transfer_FinderProcess.hxx>
 #include <XSControl_WorkSession.hxx>
@@ -33,6 +34,13 @@ class TaskProgress;
 namespace IO {
 namespace Private {
 
+// Global lock guarding the process-wide state of OpenCascade DataExchange: Interface_Static
+// variables(changed temporarily with OccStaticVariablesRollback) and non-reentrant file parsers
+// Readers/writers must hold this lock while changing static variables and until the operation
+// depending on them is completed. The lock has to be taken even with no change of static variables,
+// so another thread can't alter them in the meantime
+// Note that with OpenCascade >= v7.7 the STEP reader has its own parameters and doesn't need the
+// lock for readFile()
 std::mutex& cafGlobalMutex();
 
 #define MayoIO_CafGlobalScopedLock(name) \
@@ -50,10 +58,28 @@ bool cafReadFile(STEPCAFControl_Reader& reader, const FilePath& filepath, TaskPr
 
 TDF_LabelSequence cafTransfer(IGESCAFControl_Reader& reader, DocumentPtr doc, TaskProgress* progress);
 TDF_LabelSequence cafTransfer(STEPCAFControl_Reader& reader, DocumentPtr doc, TaskProgress* progress);
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+// Splits the roots of 'reader' into batches translated concurrently into scratch documents, the
+// results are then merged into 'doc' preserving names, colors, layers and materials
+// 'reader' must have read a file, and the statics variables and CAF modes are used as is
+TDF_LabelSequence cafTransferRootsInParallel(
+        IGESCAFControl_Reader& reader, DocumentPtr doc, TaskProgress* progress);
+TDF_LabelSequence cafTransferRootsInParallel(
+        STEPCAFControl_Reader& reader, DocumentPtr doc, TaskProgress* progress);
+#endif
 
 bool cafTransfer(IGESCAFControl_Writer& writer, Span<const ApplicationItem> appItems, TaskProgress* progress);
 bool cafTransfer(STEPCAFControl_Writer& writer, Span<const ApplicationItem> appItems, TaskProgress* progress);
 
+// Translates the shapes of 'appItems' into IGES entities with concurrent tasks, compounds being
+// split into their sub-shapes. Entities are then added to the model of 'writer' in the order of the
+// items, along with names, colors and layers. Numbering of the entities(directory entries) is done
+// later on by IGESControl_Writer::Write()
+// 'brepMode' selects the BRep entities(type 186), otherwise faces are translated into trimmed
+// surfaces(type 144). Static variables(eg "write.iges.plane.mode") are used as is
+bool cafTransferShapesInParallel(
+        IGESCAFControl_Writer& writer, bool brepMode, Span<const ApplicationItem> appItems, TaskProgress* progress);
+
 } // namespace Private
 } // namespace IO
 } // namespace Mayo
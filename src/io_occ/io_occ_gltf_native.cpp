@@ -0,0 +1,678 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "io_occ_gltf_native.h"
+#include "../base/mesh_utils.h"
+#include "../base/profiler.h"
+#include "../base/task_manager.h"
+#include "../base/task_progress.h"
+#include "../base/text_number.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QtEndian>
+#include <BRep_Tool.hxx>
+#include <GeomLProp_SLProps.hxx>
+#include <Graphic3d_Vec3.hxx>
+#include <Precision.hxx>
+#include <algorithm>
+#include <cfloat>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <thread>
+
+namespace Mayo {
+namespace IO {
+namespace GltfNative {
+
+namespace {
+
+constexpr quint32 GlbMagic = 0x46546C67; // "glTF"
+constexpr quint32 GlbChunkTypeJson = 0x4E4F534A; // "JSON"
+constexpr quint32 GlbChunkTypeBin = 0x004E4942; // "BIN\0"
+constexpr size_t GlbHeaderSize = 12;
+constexpr size_t GlbChunkHeaderSize = 8;
+
+// Buffer views shared by all the primitives, in order of appearance in the binary chunk
+enum BufferView { View_Position, View_Normal, View_TexCoord, View_Index, View_Count };
+
+// Location of the data of a primitive within the buffer views, and bounds of its positions
+struct PrimitiveLayout {
+    int meshIndex = -1;
+    const Primitive* primitive = nullptr;
+    size_t nodeCount = 0;
+    size_t triangleCount = 0;
+    bool hasTexCoords = false;
+    bool hasIndex16 = false;
+    size_t viewOffset[View_Count] = {};
+    float posMin[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+    float posMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+};
+
+// Unit of work of the concurrent tasks: nodes and triangles of a mesh part
+struct PartJob {
+    int layoutIndex = -1;
+    const MeshPart* part = nullptr;
+    size_t firstNode = 0; // Count of nodes of the previous parts in the primitive
+    size_t firstTriangle = 0;
+};
+
+struct Bounds {
+    float min[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+    float max[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+};
+
+int concurrentTaskCount(size_t itemCount)
+{
+    const int threadCount = std::max(1, int(std::thread::hardware_concurrency()));
+    return int(std::max<size_t>(1, std::min<size_t>(itemCount, threadCount)));
+}
+
+// Size of 'size' rounded up to the next multiple of 4, as required for chunks and buffer views
+size_t align4(size_t size)
+{
+    return (size + 3) & ~size_t(3);
+}
+
+void writeFloat32(uint8_t* bytes, float value)
+{
+    quint32 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    qToLittleEndian<quint32>(bits, bytes);
+}
+
+// Position of node 'i'(1-based) as written in the buffer
+Graphic3d_Vec3 partNodePosition(const MeshPart& part, int i, const RWMesh_CoordinateSystemConverter& converter)
+{
+    gp_XYZ coords = part.triangulation->Node(i).Transformed(part.trsf).XYZ();
+    converter.TransformPosition(coords);
+    return Graphic3d_Vec3(float(coords.X()), float(coords.Y()), float(coords.Z()));
+}
+
+// Provides the node normals of a mesh part, in order of preference: normals stored in the
+// triangulation, normals of the face surface at UV nodes, normals computed from the triangles
+class PartNormals {
+public:
+    PartNormals(const MeshPart& part)
+        : m_part(part)
+    {
+        const Poly_Triangulation& mesh = *part.triangulation;
+        if (!mesh.HasNormals() && mesh.HasUVNodes() && !part.face.IsNull()) {
+            TopLoc_Location locSurface;
+            const Handle_Geom_Surface& surface = BRep_Tool::Surface(part.face, locSurface);
+            if (!surface.IsNull()) {
+                m_surfaceProps.emplace(surface, 1, Precision::Confusion());
+                // Surface location is relative to the face location, which is part of 'part.trsf'
+                m_surfaceTrsf = (part.face.Location().Inverted() * locSurface).Transformation();
+            }
+        }
+    }
+
+    // Returns the normal at node 'i'(1-based) as written in the buffer
+    Graphic3d_Vec3 normal(int i, const RWMesh_CoordinateSystemConverter& converter)
+    {
+        gp_Vec vec = this->rawNormal(i);
+        if (m_part.isReversed)
+            vec.Reverse();
+
+        vec.Transform(m_part.trsf);
+        const double magnitude = vec.Magnitude();
+        if (magnitude > gp::Resolution())
+            vec.Divide(magnitude);
+
+        Graphic3d_Vec3 normal(float(vec.X()), float(vec.Y()), float(vec.Z()));
+        converter.TransformNormal(normal);
+        return normal;
+    }
+
+private:
+    gp_Vec rawNormal(int i)
+    {
+        const Poly_Triangulation& mesh = *m_part.triangulation;
+        if (mesh.HasNormals()) {
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+            gp_Vec3f vec;
+            mesh.Normal(i, vec);
+            return gp_Vec(vec.x(), vec.y(), vec.z());
+#else
+            const TShort_Array1OfShortReal& normals = mesh.Normals();
+            return gp_Vec(normals(3 * i - 2), normals(3 * i - 1), normals(3 * i));
+#endif
+        }
+
+        if (m_surfaceProps) {
+            const gp_Pnt2d uv = mesh.UVNode(i);
+            m_surfaceProps->SetParameters(uv.X(), uv.Y());
+            if (m_surfaceProps->IsNormalDefined())
+                return gp_Vec(m_surfaceProps->Normal()).Transformed(m_surfaceTrsf);
+        }
+
+        // Surface normal may be undefined at singular points(eg apex of a cone)
+        if (!m_computedNormals)
+            m_computedNormals = MeshUtils::cachedTriangulationNormals(m_part.triangulation);
+
+        const MeshUtils::NormalArray& nodeNormals = m_computedNormals->nodes;
+        return gp_Vec(nodeNormals.x[i - 1], nodeNormals.y[i - 1], nodeNormals.z[i - 1]);
+    }
+
+    const MeshPart& m_part;
+    std::optional<GeomLProp_SLProps> m_surfaceProps;
+    gp_Trsf m_surfaceTrsf;
+    std::shared_ptr<const MeshUtils::TriangulationNormals> m_computedNormals;
+};
+
+// Executes fnJob() for each job with concurrent tasks, each one processing a contiguous range of
+// jobs having about the same count of nodes and triangles
+bool runJobs(
+        const std::vector<PartJob>& vecJob,
+        bool parallel,
+        TaskProgress* progress,
+        const std::function<void(int)>& fnJob)
+{
+    std::vector<size_t> vecJobWeightStart;
+    vecJobWeightStart.reserve(vecJob.size());
+    size_t totalWeight = 0;
+    for (const PartJob& job : vecJob) {
+        vecJobWeightStart.push_back(totalWeight);
+        totalWeight += job.part->triangulation->NbNodes() + job.part->triangulation->NbTriangles();
+    }
+
+    const int taskCount = parallel ? concurrentTaskCount(vecJob.size()) : 1;
+    return TaskManager::runConcurrently(taskCount, progress, [&](int iTask, TaskProgress* taskProgress) {
+        const size_t weightFirst = (iTask * totalWeight) / taskCount;
+        const size_t weightLast = ((iTask + 1) * totalWeight) / taskCount;
+        const auto itBegin = vecJobWeightStart.cbegin();
+        const auto itFirst = std::lower_bound(itBegin, vecJobWeightStart.cend(), weightFirst);
+        const auto itLast = std::lower_bound(itFirst, vecJobWeightStart.cend(), weightLast);
+        for (auto it = itFirst; it != itLast; ++it) {
+            if (TaskProgress::isAbortRequested(taskProgress))
+                return;
+
+            fnJob(int(it - itBegin));
+            taskProgress->setValue(int((100 * (it - itFirst + 1)) / (itLast - itFirst)));
+        }
+    });
+}
+
+Bounds partBounds(const MeshPart& part, const RWMesh_CoordinateSystemConverter& converter)
+{
+    Bounds bounds;
+    for (int i = 1; i <= part.triangulation->NbNodes(); ++i) {
+        const Graphic3d_Vec3 pos = partNodePosition(part, i, converter);
+        for (int c = 0; c < 3; ++c) {
+            bounds.min[c] = std::min(bounds.min[c], pos[c]);
+            bounds.max[c] = std::max(bounds.max[c], pos[c]);
+        }
+    }
+
+    return bounds;
+}
+
+// Writes the vertex attributes and indices of a mesh part into the binary chunk 'bin'
+void writePartData(
+        const PartJob& job,
+        const PrimitiveLayout& layout,
+        const size_t (&viewStart)[View_Count],
+        const Options& options,
+        uint8_t* bin)
+{
+    const MeshPart& part = *job.part;
+    const Poly_Triangulation& mesh = *part.triangulation;
+    auto fnAttributeData = [&](BufferView view, size_t elementSize) {
+        return bin + viewStart[view] + layout.viewOffset[view] + job.firstNode * elementSize;
+    };
+
+    uint8_t* positions = fnAttributeData(View_Position, 12);
+    uint8_t* normals = fnAttributeData(View_Normal, 12);
+    PartNormals partNormals(part);
+    for (int i = 1; i <= mesh.NbNodes(); ++i) {
+        const Graphic3d_Vec3 pos = partNodePosition(part, i, options.converter);
+        const Graphic3d_Vec3 normal = partNormals.normal(i, options.converter);
+        for (int c = 0; c < 3; ++c) {
+            writeFloat32(positions + 4 * c, pos[c]);
+            writeFloat32(normals + 4 * c, normal[c]);
+        }
+
+        positions += 12;
+        normals += 12;
+    }
+
+    if (layout.hasTexCoords) {
+        // glTF texture coordinates have their origin at top-left corner
+        uint8_t* texCoords = fnAttributeData(View_TexCoord, 8);
+        for (int i = 1; i <= mesh.NbNodes(); ++i) {
+            const gp_Pnt2d uv = mesh.HasUVNodes() ? mesh.UVNode(i) : gp_Pnt2d(0, 1);
+            writeFloat32(texCoords, float(uv.X()));
+            writeFloat32(texCoords + 4, float(1. - uv.Y()));
+            texCoords += 8;
+        }
+    }
+
+    // Indices are 0-based and relative to the first node of the primitive
+    const size_t indexSize = layout.hasIndex16 ? 2 : 4;
+    uint8_t* indices = bin + viewStart[View_Index] + layout.viewOffset[View_Index] + job.firstTriangle * 3 * indexSize;
+    for (int i = 1; i <= mesh.NbTriangles(); ++i) {
+        int n[3];
+        mesh.Triangle(i).Get(n[0], n[1], n[2]);
+        if (part.isReversed)
+            std::swap(n[1], n[2]);
+
+        for (int j = 0; j < 3; ++j) {
+            const size_t index = job.firstNode + n[j] - 1;
+            if (layout.hasIndex16)
+                qToLittleEndian<quint16>(quint16(index), indices);
+            else
+                qToLittleEndian<quint32>(quint32(index), indices);
+
+            indices += indexSize;
+        }
+    }
+}
+
+class JsonWriter {
+public:
+    const std::string& str() const { return m_str; }
+
+    JsonWriter& raw(std::string_view str) {
+        m_str.append(str);
+        return *this;
+    }
+
+    JsonWriter& key(std::string_view key) {
+        this->separator();
+        this->string(key);
+        m_str.push_back(':');
+        m_isFirstItem = true; // The value is not preceded by a separator
+        return *this;
+    }
+
+    JsonWriter& beginObject() { return this->begin('{'); }
+    JsonWriter& endObject() { return this->end('}'); }
+    JsonWriter& beginArray() { return this->begin('['); }
+    JsonWriter& endArray() { return this->end(']'); }
+
+    JsonWriter& value(std::string_view str) {
+        this->separator();
+        this->string(str);
+        return *this;
+    }
+
+    JsonWriter& value(size_t value) {
+        this->separator();
+        m_str.append(std::to_string(value));
+        return *this;
+    }
+
+    JsonWriter& value(int value) {
+        this->separator();
+        m_str.append(std::to_string(value));
+        return *this;
+    }
+
+    // Shortest representation of 'value' that reads back to the same double
+    JsonWriter& value(double value) {
+        this->separator();
+        TextNumber::append(&m_str, value);
+        return *this;
+    }
+
+    template<typename T> JsonWriter& property(std::string_view key, const T& value) {
+        return this->key(key).value(value);
+    }
+
+private:
+    void separator() {
+        if (!m_isFirstItem)
+            m_str.push_back(',');
+
+        m_isFirstItem = false;
+    }
+
+    JsonWriter& begin(char c) {
+        this->separator();
+        m_str.push_back(c);
+        m_isFirstItem = true;
+        return *this;
+    }
+
+    JsonWriter& end(char c) {
+        m_str.push_back(c);
+        m_isFirstItem = false;
+        return *this;
+    }
+
+    void string(std::string_view str) {
+        m_str.push_back('"');
+        for (char c : str) {
+            if (c == '"' || c == '\\') {
+                m_str.push_back('\\');
+                m_str.push_back(c);
+            }
+            else if (static_cast<unsigned char>(c) < 0x20) {
+                char buff[8];
+                std::snprintf(buff, sizeof(buff), "\\u%04x", c);
+                m_str.append(buff);
+            }
+            else {
+                m_str.push_back(c);
+            }
+        }
+
+        m_str.push_back('"');
+    }
+
+    std::string m_str;
+    bool m_isFirstItem = true;
+};
+
+std::string formatJson(
+        const Scene& scene,
+        const Options& options,
+        const std::vector<PrimitiveLayout>& vecLayout,
+        const size_t (&viewStart)[View_Count],
+        const size_t (&viewLength)[View_Count],
+        size_t binLength)
+{
+    // Indices of the glTF objects, empty views and meshes are not written
+    int viewIndex[View_Count] = {};
+    int viewCount = 0;
+    for (int view = 0; view < View_Count; ++view)
+        viewIndex[view] = viewLength[view] > 0 ? viewCount++ : -1;
+
+    std::vector<int> vecGltfMeshIndex(scene.meshes.size(), -1);
+    int gltfMeshCount = 0;
+    for (const PrimitiveLayout& layout : vecLayout) {
+        if (vecGltfMeshIndex.at(layout.meshIndex) < 0)
+            vecGltfMeshIndex.at(layout.meshIndex) = gltfMeshCount++;
+    }
+
+    JsonWriter json;
+    json.beginObject();
+    json.key("asset").beginObject().property("version", "2.0").property("generator", "Mayo").endObject();
+    json.property("scene", 0);
+    json.key("scenes").beginArray().beginObject();
+    json.key("nodes").beginArray();
+    for (int iNode : scene.rootNodes)
+        json.value(iNode);
+
+    json.endArray().endObject().endArray();
+
+    json.key("nodes").beginArray();
+    for (const Node& node : scene.nodes) {
+        json.beginObject();
+        if (!node.name.empty())
+            json.property("name", node.name);
+
+        gp_Trsf trsf = node.trsf;
+        options.converter.TransformTransformation(trsf);
+        if (trsf.Form() != gp_Identity) {
+            // Column-major order
+            json.key("matrix").beginArray();
+            for (int col = 1; col <= 4; ++col) {
+                for (int row = 1; row <= 3; ++row)
+                    json.value(trsf.Value(row, col));
+
+                json.value(col == 4 ? 1. : 0.);
+            }
+
+            json.endArray();
+        }
+
+        if (node.meshIndex >= 0 && vecGltfMeshIndex.at(node.meshIndex) >= 0)
+            json.property("mesh", vecGltfMeshIndex.at(node.meshIndex));
+
+        if (!node.children.empty()) {
+            json.key("children").beginArray();
+            for (int iChild : node.children)
+                json.value(iChild);
+
+            json.endArray();
+        }
+
+        json.endObject();
+    }
+
+    json.endArray();
+
+    // Accessors of a primitive: positions, normals, optional texture coordinates then indices
+    int accessorCount = 0;
+    json.key("meshes").beginArray();
+    for (auto itLayout = vecLayout.cbegin(); itLayout != vecLayout.cend(); ) {
+        const int meshIndex = itLayout->meshIndex;
+        json.beginObject();
+        if (!scene.meshes.at(meshIndex).name.empty())
+            json.property("name", scene.meshes.at(meshIndex).name);
+
+        json.key("primitives").beginArray();
+        for (; itLayout != vecLayout.cend() && itLayout->meshIndex == meshIndex; ++itLayout) {
+            json.beginObject();
+            json.key("attributes").beginObject();
+            json.property("POSITION", accessorCount++);
+            json.property("NORMAL", accessorCount++);
+            if (itLayout->hasTexCoords)
+                json.property("TEXCOORD_0", accessorCount++);
+
+            json.endObject();
+            json.property("indices", accessorCount++);
+            json.property("mode", 4); // TRIANGLES
+            if (itLayout->primitive->materialIndex >= 0)
+                json.property("material", itLayout->primitive->materialIndex);
+
+            json.endObject();
+        }
+
+        json.endArray().endObject();
+    }
+
+    json.endArray();
+
+    if (!scene.materials.empty()) {
+        json.key("materials").beginArray();
+        for (const Material& material : scene.materials) {
+            json.beginObject();
+            if (!material.name.empty())
+                json.property("name", material.name);
+
+            json.key("pbrMetallicRoughness").beginObject();
+            json.key("baseColorFactor").beginArray();
+            json.value(material.color.Red()).value(material.color.Green()).value(material.color.Blue()).value(1.);
+            json.endArray();
+            json.property("metallicFactor", 0.).property("roughnessFactor", 1.);
+            json.endObject().endObject();
+        }
+
+        json.endArray();
+    }
+
+    json.key("accessors").beginArray();
+    for (const PrimitiveLayout& layout : vecLayout) {
+        auto fnBeginAccessor = [&](BufferView view, int componentType, size_t count, std::string_view type) {
+            json.beginObject();
+            json.property("bufferView", viewIndex[view]);
+            json.property("byteOffset", layout.viewOffset[view]);
+            json.property("componentType", componentType);
+            json.property("count", count);
+            json.property("type", type);
+        };
+        constexpr int ComponentType_Float = 5126;
+        fnBeginAccessor(View_Position, ComponentType_Float, layout.nodeCount, "VEC3");
+        json.key("min").beginArray().value(double(layout.posMin[0])).value(double(layout.posMin[1])).value(double(layout.posMin[2])).endArray();
+        json.key("max").beginArray().value(double(layout.posMax[0])).value(double(layout.posMax[1])).value(double(layout.posMax[2])).endArray();
+        json.endObject();
+        fnBeginAccessor(View_Normal, ComponentType_Float, layout.nodeCount, "VEC3");
+        json.endObject();
+        if (layout.hasTexCoords) {
+            fnBeginAccessor(View_TexCoord, ComponentType_Float, layout.nodeCount, "VEC2");
+            json.endObject();
+        }
+
+        const int indexComponentType = layout.hasIndex16 ? 5123 : 5125; // UNSIGNED_SHORT/UNSIGNED_INT
+        fnBeginAccessor(View_Index, indexComponentType, 3 * layout.triangleCount, "SCALAR");
+        json.endObject();
+    }
+
+    json.endArray();
+
+    json.key("bufferViews").beginArray();
+    for (int view = 0; view < View_Count; ++view) {
+        if (viewIndex[view] < 0)
+            continue;
+
+        json.beginObject();
+        json.property("buffer", 0);
+        json.property("byteOffset", viewStart[view]);
+        json.property("byteLength", viewLength[view]);
+        if (view != View_Index)
+            json.property("byteStride", view == View_TexCoord ? 8 : 12);
+
+        json.property("target", view != View_Index ? 34962 : 34963); // ARRAY_BUFFER/ELEMENT_ARRAY_BUFFER
+        json.endObject();
+    }
+
+    json.endArray();
+    json.key("buffers").beginArray().beginObject().property("byteLength", binLength).endObject().endArray();
+    json.endObject();
+    return json.str();
+}
+
+void writeChunkHeader(uint8_t* bytes, size_t length, quint32 type)
+{
+    qToLittleEndian<quint32>(quint32(length), bytes);
+    qToLittleEndian<quint32>(type, bytes + 4);
+}
+
+} // namespace
+
+bool writeBinary(const Scene& scene, const Options& options, const FilePath& filepath, TaskProgress* progress)
+{
+    MAYO_PROFILE_ZONE("GltfNative::writeBinary");
+    // Layout of the primitives, parts without triangles are skipped
+    std::vector<PrimitiveLayout> vecLayout;
+    std::vector<PartJob> vecJob;
+    for (const Mesh& mesh : scene.meshes) {
+        for (const Primitive& primitive : mesh.primitives) {
+            PrimitiveLayout layout;
+            layout.meshIndex = int(&mesh - &scene.meshes.front());
+            layout.primitive = &primitive;
+            const size_t jobStart = vecJob.size();
+            for (const MeshPart& part : primitive.parts) {
+                if (part.triangulation.IsNull() || part.triangulation->NbTriangles() <= 0)
+                    continue;
+
+                vecJob.push_back({ int(vecLayout.size()), &part, layout.nodeCount, layout.triangleCount });
+                layout.nodeCount += part.triangulation->NbNodes();
+                layout.triangleCount += part.triangulation->NbTriangles();
+                layout.hasTexCoords = layout.hasTexCoords || (options.exportUV && part.triangulation->HasUVNodes());
+            }
+
+            if (layout.triangleCount > 0) {
+                layout.hasIndex16 = layout.nodeCount < UINT16_MAX;
+                vecLayout.push_back(layout);
+            }
+            else {
+                vecJob.resize(jobStart);
+            }
+        }
+    }
+
+    if (vecLayout.empty())
+        return false;
+
+    size_t viewLength[View_Count] = {};
+    for (PrimitiveLayout& layout : vecLayout) {
+        layout.viewOffset[View_Position] = viewLength[View_Position];
+        layout.viewOffset[View_Normal] = viewLength[View_Normal];
+        layout.viewOffset[View_TexCoord] = viewLength[View_TexCoord];
+        layout.viewOffset[View_Index] = viewLength[View_Index];
+        viewLength[View_Position] += 12 * layout.nodeCount;
+        viewLength[View_Normal] += 12 * layout.nodeCount;
+        viewLength[View_TexCoord] += layout.hasTexCoords ? 8 * layout.nodeCount : 0;
+        viewLength[View_Index] += align4(3 * layout.triangleCount * (layout.hasIndex16 ? 2 : 4));
+    }
+
+    size_t viewStart[View_Count] = {};
+    size_t binLength = 0;
+    for (int view = 0; view < View_Count; ++view) {
+        viewStart[view] = binLength;
+        binLength += viewLength[view];
+    }
+
+    // Bounds of the positions, required by the JSON accessors
+    TaskProgress boundsProgress(progress, 20);
+    std::vector<Bounds> vecJobBounds(vecJob.size());
+    bool ok = runJobs(vecJob, options.parallel, &boundsProgress, [&](int iJob) {
+        vecJobBounds.at(iJob) = partBounds(*vecJob.at(iJob).part, options.converter);
+    });
+    if (!ok)
+        return false;
+
+    for (const PartJob& job : vecJob) {
+        const Bounds& bounds = vecJobBounds.at(&job - &vecJob.front());
+        PrimitiveLayout& layout = vecLayout.at(job.layoutIndex);
+        for (int c = 0; c < 3; ++c) {
+            layout.posMin[c] = std::min(layout.posMin[c], bounds.min[c]);
+            layout.posMax[c] = std::max(layout.posMax[c], bounds.max[c]);
+        }
+    }
+
+    // JSON chunk is padded with spaces, binary chunk is already 4-bytes aligned
+    std::string json = formatJson(scene, options, vecLayout, viewStart, viewLength, binLength);
+    json.resize(align4(json.size()), ' ');
+    const size_t binChunkOffset = GlbHeaderSize + GlbChunkHeaderSize + json.size();
+    const size_t fileSize = binChunkOffset + GlbChunkHeaderSize + binLength;
+    if (fileSize > UINT32_MAX)
+        return false;
+
+    auto fnWriteHeaders = [&](uint8_t* bytes) {
+        qToLittleEndian<quint32>(GlbMagic, bytes);
+        qToLittleEndian<quint32>(2, bytes + 4);
+        qToLittleEndian<quint32>(quint32(fileSize), bytes + 8);
+        writeChunkHeader(bytes + GlbHeaderSize, json.size(), GlbChunkTypeJson);
+        std::memcpy(bytes + GlbHeaderSize + GlbChunkHeaderSize, json.data(), json.size());
+        writeChunkHeader(bytes + binChunkOffset, binLength, GlbChunkTypeBin);
+    };
+
+    QFile file(filepathTo<QString>(filepath));
+    if (!file.open(QIODevice::ReadWrite | QIODevice::Truncate))
+        return false;
+
+    uchar* fileData = nullptr;
+    if (file.resize(fileSize))
+        fileData = file.map(0, fileSize);
+
+    std::vector<uint8_t> vecBin; // Binary chunk built in memory if file can't be mapped
+    if (!fileData)
+        vecBin.resize(binLength);
+
+    uint8_t* bin = fileData ? fileData + binChunkOffset + GlbChunkHeaderSize : vecBin.data();
+    TaskProgress fillProgress(progress, 80);
+    ok = runJobs(vecJob, options.parallel, &fillProgress, [&](int iJob) {
+        const PartJob& job = vecJob.at(iJob);
+        writePartData(job, vecLayout.at(job.layoutIndex), viewStart, options, bin);
+    });
+
+    if (fileData) {
+        fnWriteHeaders(fileData);
+        return file.unmap(fileData) && ok;
+    }
+
+    if (!ok)
+        return false;
+
+    file.resize(0);
+    std::vector<uint8_t> headers(binChunkOffset + GlbChunkHeaderSize);
+    fnWriteHeaders(headers.data());
+    return file.write(reinterpret_cast<const char*>(headers.data()), headers.size()) == qint64(headers.size())
+            && file.write(reinterpret_cast<const char*>(vecBin.data()), vecBin.size()) == qint64(vecBin.size());
+}
+
+} // namespace GltfNative
+} // namespace IO
+} // namespace Mayo
@@ -0,0 +1,87 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "../base/filepath.h"
+#include <Poly_Triangulation.hxx>
+#include <Quantity_Color.hxx>
+#include <RWMesh_CoordinateSystemConverter.hxx>
+#include <TopoDS_Face.hxx>
+#include <gp_Trsf.hxx>
+#include <string>
+#include <vector>
+
+namespace Mayo {
+
+class TaskProgress;
+
+namespace IO {
+
+// Mayo-native encoding of binary glTF(GLB) files
+// Layout of the binary buffer is computed up front: vertex positions, normals, UVs and indices of
+// all the primitives go in four buffer views, so the offset of every face within the buffer is
+// known before any data is written. The JSON chunk is written first(accessors need the bounds of
+// the positions), then the binary chunk is filled by concurrent tasks directly into the
+// memory-mapped file
+namespace GltfNative {
+
+// Triangulation of a face, with its location within the mesh
+struct MeshPart {
+    Handle_Poly_Triangulation triangulation;
+    gp_Trsf trsf;
+    bool isReversed = false; // Triangles orientation has to be flipped
+    // Optional, node normals are evaluated on its surface when triangulation doesn't store normals
+    TopoDS_Face face;
+};
+
+// Parts are merged into a single glTF primitive
+struct Primitive {
+    std::vector<MeshPart> parts;
+    int materialIndex = -1; // -1 if no material
+};
+
+struct Mesh {
+    std::string name;
+    std::vector<Primitive> primitives;
+};
+
+struct Node {
+    std::string name;
+    gp_Trsf trsf; // Relative to the parent node
+    int meshIndex = -1; // -1 if no mesh
+    std::vector<int> children;
+};
+
+struct Material {
+    std::string name;
+    Quantity_Color color;
+};
+
+struct Scene {
+    std::vector<Mesh> meshes;
+    std::vector<Node> nodes;
+    std::vector<int> rootNodes;
+    std::vector<Material> materials;
+};
+
+struct Options {
+    // Applied on node transformations, vertex positions and normals
+    RWMesh_CoordinateSystemConverter converter;
+    // UV coordinates are written for the primitives having at least one part with UV nodes
+    bool exportUV = false;
+    // Binary chunk is filled by concurrent tasks, each one writing a range of mesh parts
+    bool parallel = true;
+};
+
+// Binary chunk is filled in memory if the output file can't be mapped
+// Returns false in case of abort request or write error
+bool writeBinary(const Scene& scene, const Options& options, const FilePath& filepath, TaskProgress* progress);
+
+} // namespace GltfNative
+
+} // namespace IO
+} // namespace Mayo
@@ -7,18 +7,69 @@
 #include "io_occ_gltf_writer.h"
 
 #include "../base/application_item.h"
+#include "../base/brep_utils.h"
+#include "../base/document.h"
+#include "../base/label_attributes_cache.h"
+#include "../base/mesh_utils.h"
 #include "../base/occ_progress_indicator.h"
 #include "../base/property_builtins.h"
 #include "../base/property_enumeration.h"
 #include "../base/enumeration_fromenum.h"
+#include "../base/string_conv.h"
 #include "../base/text_id.h"
+#include "../base/tkernel_utils.h"
 #include "io_occ_common.h"
+#include "io_occ_gltf_native.h"
 
+#include <BRep_Tool.hxx>
 #include <RWGltf_CafWriter.hxx>
+#include <TopoDS_Face.hxx>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <unordered_map>
+#if OCC_VERSION_HEX < OCC_VERSION_CHECK(7, 6, 0)
+#  include <TShort_HArray1OfShortReal.hxx>
+#endif
 
 namespace Mayo {
 namespace IO {
 
+namespace {
+
+// RWGltf_CafWriter exports the normals stored in triangulations, otherwise normals are computed
+// from the surface of the faces. Faces without surface(eg shapes created from mesh files) would be
+// exported without normals, so they get the node normals of MeshUtils::cachedTriangulationNormals()
+void addMissingNodeNormals(const TopoDS_Shape& shape)
+{
+    BRepUtils::forEachSubFace(shape, [](const TopoDS_Face& face) {
+        TopLoc_Location loc;
+        const Handle_Poly_Triangulation& mesh = BRep_Tool::Triangulation(face, loc);
+        if (mesh.IsNull() || mesh->HasNormals() || !BRep_Tool::Surface(face, loc).IsNull())
+            return;
+
+        const auto normals = MeshUtils::cachedTriangulationNormals(mesh);
+        const MeshUtils::NormalArray& nodeNormals = normals->nodes;
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+        mesh->AddNormals();
+        for (int i = 0; i < nodeNormals.count(); ++i)
+            mesh->SetNormal(i + 1, gp_Vec3f(nodeNormals.x[i], nodeNormals.y[i], nodeNormals.z[i]));
+#else
+        Handle_TShort_HArray1OfShortReal arrayNormal = new TShort_HArray1OfShortReal(1, 3 * nodeNormals.count());
+        for (int i = 0; i < nodeNormals.count(); ++i) {
+            arrayNormal->SetValue(3 * i + 1, nodeNormals.x[i]);
+            arrayNormal->SetValue(3 * i + 2, nodeNormals.y[i]);
+            arrayNormal->SetValue(3 * i + 3, nodeNormals.z[i]);
+        }
+
+        mesh->SetNormals(arrayNormal);
+#endif
+    });
+}
+
+} // namespace
+
 class OccGltfWriter::Properties : public PropertyGroup {
     MAYO_DECLARE_TEXT_ID_FUNCTIONS(Mayo::IO::OccGltfWriter::Properties)
 public:
@@ -31,6 +82,12 @@ public:
                     textIdTr("Preferred transformation format for writing into glTF file"));
         this->forceExportUV.setDescription(
                     textIdTr("Export UV coordinates even if there is no mapped texture"));
+        this->mergeFaces.setDescription(
+                    textIdTr("Merge the faces of a part into a single mesh primitive.\n\n"
+                             "Repeated parts then reference one glTF mesh, written once in the binary buffer"));
+#if OCC_VERSION_HEX < OCC_VERSION_CHECK(7, 6, 0)
+        this->mergeFaces.setEnabled(false);
+#endif
 
         this->transformationFormat.mutableEnumeration().chopPrefix("RWGltf_WriterTrsfFormat_");
         this->transformationFormat.setDescriptions({
@@ -40,6 +97,36 @@ public:
                     { RWGltf_WriterTrsfFormat_TRS, textIdTr("Transformation decomposed into Translation "
                       "vector, Rotation quaternion and Scale factor(T * R * S)") }
         });
+
+        this->dracoCompression.setDescription(
+                    textIdTr("Compress mesh data with Draco(`KHR_draco_mesh_compression` extension)\n\n"
+                             "Requires OpenCascade >= v7.7.0 built with Draco"));
+        this->dracoCompressionLevel.setConstraintsEnabled(true);
+        this->dracoCompressionLevel.setRange(0, 10);
+        this->dracoCompressionLevel.setDescription(
+                    textIdTr("Draco compression level, higher is smaller but slower to encode and decode"));
+        for (PropertyInt* prop : { &this->dracoQuantizePositionBits,
+                                   &this->dracoQuantizeNormalBits,
+                                   &this->dracoQuantizeTexCoordBits })
+        {
+            prop->setConstraintsEnabled(true);
+            prop->setRange(1, 30);
+        }
+
+        this->dracoQuantizePositionBits.setDescription(
+                    textIdTr("Quantization bits of vertex positions for Draco compression"));
+        this->dracoQuantizeNormalBits.setDescription(
+                    textIdTr("Quantization bits of vertex normals for Draco compression"));
+        this->dracoQuantizeTexCoordBits.setDescription(
+                    textIdTr("Quantization bits of texture coordinates for Draco compression"));
+        this->parallelCompression.setDescription(
+                    textIdTr("Compress mesh primitives concurrently"));
+        this->parallelBinaryWrite.setDescription(
+                    textIdTr("Fill the binary buffer concurrently, directly into the memory-mapped "
+                             "output file\n\nNot applicable with Draco compression"));
+#if OCC_VERSION_HEX < OCC_VERSION_CHECK(7, 7, 0)
+        this->dracoCompression.setEnabled(false);
+#endif
     }
 
     void restoreDefaults() override {
@@ -48,12 +135,47 @@ public:
         this->transformationFormat.setValue(defaults.transformationFormat);
         this->format.setValue(defaults.format);
         this->forceExportUV.setValue(defaults.forceExportUV);
+        this->mergeFaces.setValue(defaults.mergeFaces);
+        this->dracoCompression.setValue(defaults.dracoCompression);
+        this->dracoCompressionLevel.setValue(defaults.dracoCompressionLevel);
+        this->dracoQuantizePositionBits.setValue(defaults.dracoQuantizePositionBits);
+        this->dracoQuantizeNormalBits.setValue(defaults.dracoQuantizeNormalBits);
+        this->dracoQuantizeTexCoordBits.setValue(defaults.dracoQuantizeTexCoordBits);
+        this->parallelCompression.setValue(defaults.parallelCompression);
+        this->parallelBinaryWrite.setValue(defaults.parallelBinaryWrite);
+        this->updatePropertiesEnabled();
+    }
+
+    void onPropertyChanged(Property* prop) override
+    {
+        if (prop == &this->dracoCompression || prop == &this->format)
+            this->updatePropertiesEnabled();
+
+        PropertyGroup::onPropertyChanged(prop);
+    }
+
+    void updatePropertiesEnabled()
+    {
+        this->dracoCompressionLevel.setEnabled(this->dracoCompression);
+        this->dracoQuantizePositionBits.setEnabled(this->dracoCompression);
+        this->dracoQuantizeNormalBits.setEnabled(this->dracoCompression);
+        this->dracoQuantizeTexCoordBits.setEnabled(this->dracoCompression);
+        this->parallelCompression.setEnabled(this->dracoCompression);
+        this->parallelBinaryWrite.setEnabled(this->format == Format::Binary && !this->dracoCompression);
     }
 
     PropertyEnum<RWMesh_CoordinateSystem> coordinatesConverter{ this, textId("coordinatesConverter") };
     PropertyEnum<RWGltf_WriterTrsfFormat> transformationFormat{ this, textId("transformationFormat") };
     PropertyEnum<Format> format{ this, textId("format") };
     PropertyBool forceExportUV{ this, textId("forceExportUV") };
+    PropertyBool mergeFaces{ this, textId("mergeFaces") };
+    PropertyBool dracoCompression{ this, textId("dracoCompression") };
+    PropertyInt dracoCompressionLevel{ this, textId("dracoCompressionLevel") };
+    PropertyInt dracoQuantizePositionBits{ this, textId("dracoQuantizePositionBits") };
+    PropertyInt dracoQuantizeNormalBits{ this, textId("dracoQuantizeNormalBits") };
+    PropertyInt dracoQuantizeTexCoordBits{ this, textId("dracoQuantizeTexCoordBits") };
+    PropertyBool parallelCompression{ this, textId("parallelCompression") };
+    PropertyBool parallelBinaryWrite{ this, textId("parallelBinaryWrite") };
 };
 
 bool OccGltfWriter::transfer(Span<const ApplicationItem> spanAppItem, TaskProgress*)
@@ -84,9 +206,33 @@ bool OccGltfWriter::writeFile(const FilePath& filepath, TaskProgress* progress)
     if (!m_document)
         return false;
 
+    if (m_params.format == Format::Binary && m_params.parallelBinaryWrite && !m_params.dracoCompression)
+        return this->writeBinaryNative(filepath, progress);
+
     Handle_Message_ProgressIndicator occProgress = new OccProgressIndicator(progress);
     const bool isBinary = m_params.format == Format::Binary;
     RWGltf_CafWriter writer(filepath.u8string().c_str(), isBinary);
+    writer.ChangeCoordinateSystemConverter().SetOutputCoordinateSystem(m_params.coordinatesConverter);
+    writer.SetTransformationFormat(m_params.transformationFormat);
+    writer.SetForcedUVExport(m_params.forceExportUV);
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+    writer.SetMergeFaces(m_params.mergeFaces);
+#endif
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 7, 0)
+    RWGltf_DracoParameters dracoParams;
+    dracoParams.DracoCompression = m_params.dracoCompression;
+    dracoParams.CompressionLevel = m_params.dracoCompressionLevel;
+    dracoParams.QuantizePositionBits = m_params.dracoQuantizePositionBits;
+    dracoParams.QuantizeNormalBits = m_params.dracoQuantizeNormalBits;
+    dracoParams.QuantizeTexcoordBits = m_params.dracoQuantizeTexCoordBits;
+    writer.SetCompressionParameters(dracoParams);
+    writer.SetParallel(m_params.parallelCompression);
+#endif
+    const TDF_LabelSequence seqLabel =
+            !m_seqRootLabel.IsEmpty() ? m_seqRootLabel : m_document->xcaf().topLevelFreeShapes();
+    for (const TDF_Label& label : seqLabel)
+        addMissingNodeNormals(XCaf::shape(label));
+
     const TColStd_IndexedDataMapOfStringString fileInfo;
     if (m_seqRootLabel.IsEmpty())
         return writer.Perform(m_document, fileInfo, occProgress->Start());
@@ -94,6 +240,109 @@ bool OccGltfWriter::writeFile(const FilePath& filepath, TaskProgress* progress)
         return writer.Perform(m_document, m_seqRootLabel, nullptr, fileInfo, occProgress->Start());
 }
 
+bool OccGltfWriter::writeBinaryNative(const FilePath& filepath, TaskProgress* progress)
+{
+    GltfNative::Scene scene;
+    auto fnMaterial = [&](const Quantity_Color& color) {
+        auto itMaterial = std::find_if(scene.materials.cbegin(), scene.materials.cend(), [&](const GltfNative::Material& material) {
+            return material.color.IsEqual(color);
+        });
+        if (itMaterial != scene.materials.cend())
+            return int(itMaterial - scene.materials.cbegin());
+
+        scene.materials.push_back({ "material_" + std::to_string(scene.materials.size()), color });
+        return int(scene.materials.size() - 1);
+    };
+
+    // A glTF mesh is created for each part and material inherited from the assembly tree, so all
+    // instances of a part having the same color refer to the same mesh(written once)
+    // Faces having their own color(XCAF sub-shape labels) get their own material, see ShapeStyleCache
+    const TDF_LabelSequence seqLabel =
+            !m_seqRootLabel.IsEmpty() ? m_seqRootLabel : m_document->xcaf().topLevelFreeShapes();
+    LabelAttributesCache& attrsCache = m_document->labelAttributesCache();
+    ShapeStyleCache& styleCache = m_document->styleCache();
+    styleCache.computePrototypeStyles(seqLabel);
+    std::unordered_map<TDF_Label, std::map<int, int>> mapPartMaterialMesh;
+    auto fnMesh = [&](const TDF_Label& labelPart, const LabelAttributes& attrsPart, int materialIndex) {
+        std::map<int, int>& mapMaterialMesh = mapPartMaterialMesh[labelPart];
+        auto [it, isNew] = mapMaterialMesh.try_emplace(materialIndex, int(scene.meshes.size()));
+        if (!isNew)
+            return it->second;
+
+        const auto style = styleCache.prototypeStyle(labelPart);
+        GltfNative::Mesh mesh;
+        mesh.name = string_conv<std::string>(attrsPart.name);
+        int iFace = 0;
+        m_document->subShapeCache().forEachSubFace(attrsPart.shape, [&](const TopoDS_Face& face, bool) {
+            ++iFace;
+            TopLoc_Location loc;
+            const Handle_Poly_Triangulation& triangulation = BRep_Tool::Triangulation(face, loc);
+            if (triangulation.IsNull() || triangulation->NbTriangles() <= 0)
+                return;
+
+            const Quantity_Color* faceColor = style->faceColor(iFace);
+            const int faceMaterialIndex = faceColor ? fnMaterial(*faceColor) : materialIndex;
+            auto itPrimitive = mesh.primitives.end();
+            if (m_params.mergeFaces) {
+                itPrimitive = std::find_if(mesh.primitives.begin(), mesh.primitives.end(), [=](const GltfNative::Primitive& primitive) {
+                    return primitive.materialIndex == faceMaterialIndex;
+                });
+            }
+
+            if (itPrimitive == mesh.primitives.end()) {
+                mesh.primitives.emplace_back();
+                mesh.primitives.back().materialIndex = faceMaterialIndex;
+                itPrimitive = std::prev(mesh.primitives.end());
+            }
+
+            itPrimitive->parts.push_back({
+                triangulation, loc.Transformation(), face.Orientation() == TopAbs_REVERSED, face
+            });
+        });
+
+        scene.meshes.push_back(std::move(mesh));
+        return it->second;
+    };
+
+    std::function<int(const TDF_Label&, int)> fnAddNode;
+    fnAddNode = [&](const TDF_Label& label, int materialIndex) {
+        const auto attrs = attrsCache.attributes(label);
+        GltfNative::Node node;
+        node.name = string_conv<std::string>(attrs->name);
+        auto attrsShape = attrs;
+        if (attrs->isReference) {
+            node.trsf = attrs->referenceLocation.Transformation();
+            attrsShape = attrsCache.attributes(attrs->labelReferred);
+        }
+
+        const Quantity_Color* color = ShapeStyleCache::nodeColor(*attrs, *attrsShape, nullptr);
+        if (color)
+            materialIndex = fnMaterial(*color);
+
+        const TDF_Label labelShape = attrs->isReference ? attrs->labelReferred : label;
+        if (attrsShape->isAssembly) {
+            for (const TDF_Label& labelChild : XCaf::shapeComponents(labelShape))
+                node.children.push_back(fnAddNode(labelChild, materialIndex));
+        }
+        else if (!attrsShape->shape.IsNull()) {
+            node.meshIndex = fnMesh(labelShape, *attrsShape, materialIndex);
+        }
+
+        scene.nodes.push_back(std::move(node));
+        return int(scene.nodes.size() - 1);
+    };
+
+    for (const TDF_Label& label : seqLabel)
+        scene.rootNodes.push_back(fnAddNode(label, -1));
+
+    // Same conversion as RWGltf_CafWriter
+    GltfNative::Options options;
+    options.converter.SetOutputLengthUnit(1.);
+    options.converter.SetOutputCoordinateSystem(m_params.coordinatesConverter);
+    options.exportUV = m_params.forceExportUV;
+    return GltfNative::writeBinary(scene, options, filepath, progress);
+}
+
 std::unique_ptr<PropertyGroup> OccGltfWriter::createProperties(PropertyGroup* parentGroup)
 {
     return std::make_unique<Properties>(parentGroup);
@@ -105,8 +354,16 @@ void OccGltfWriter::applyProperties(const PropertyGroup* params)
     if (ptr) {
         m_params.coordinatesConverter = ptr->coordinatesConverter;
         m_params.forceExportUV = ptr->forceExportUV;
+        m_params.mergeFaces = ptr->mergeFaces;
         m_params.format = ptr->format;
         m_params.transformationFormat = ptr->transformationFormat;
+        m_params.dracoCompression = ptr->dracoCompression;
+        m_params.dracoCompressionLevel = ptr->dracoCompressionLevel;
+        m_params.dracoQuantizePositionBits = ptr->dracoQuantizePositionBits;
+        m_params.dracoQuantizeNormalBits = ptr->dracoQuantizeNormalBits;
+        m_params.dracoQuantizeTexCoordBits = ptr->dracoQuantizeTexCoordBits;
+        m_params.parallelCompression = ptr->parallelCompression;
+        m_params.parallelBinaryWrite = ptr->parallelBinaryWrite;
     }
 }
 
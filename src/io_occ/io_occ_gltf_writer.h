@@ -17,6 +17,8 @@ namespace Mayo {
 namespace IO {
 
 // OpenCascade-based writer for glTF format
+// Binary glTF(GLB) files are written by default with GltfNative, whose binary buffer is filled
+// concurrently. RWGltf_CafWriter is used for JSON format and Draco compression
 // Requires OpenCascade >= v7.5.0
 class OccGltfWriter : public Writer {
 public:
@@ -35,11 +37,25 @@ public:
         RWGltf_WriterTrsfFormat transformationFormat = RWGltf_WriterTrsfFormat_Compact;
         Format format = Format::Binary;
         bool forceExportUV = false;
+        // Merge the faces of a part into a single glTF primitive, requires OpenCascade >= v7.6.0
+        bool mergeFaces = false;
+        // Draco compression of mesh data(KHR_draco_mesh_compression), requires OpenCascade >= v7.7.0
+        bool dracoCompression = false;
+        int dracoCompressionLevel = 7;
+        int dracoQuantizePositionBits = 14;
+        int dracoQuantizeNormalBits = 10;
+        int dracoQuantizeTexCoordBits = 12;
+        bool parallelCompression = true;
+        // Binary format only: buffer is filled concurrently with Mayo-native writer, directly into
+        // the memory-mapped file. Not applicable with Draco compression
+        bool parallelBinaryWrite = true;
     };
     Parameters& parameters() { return m_params; }
     const Parameters& constParameters() const { return m_params; }
 
 private:
+    bool writeBinaryNative(const FilePath& filepath, TaskProgress* progress);
+
     class Properties;
     Parameters m_params;
     DocumentPtr m_document;
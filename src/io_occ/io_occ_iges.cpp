@@ -6,14 +6,18 @@
 
 #include "io_occ_iges.h"
 #include "io_occ_caf.h"
+#include "../base/io_progress_stream.h"
 #include "../base/occ_static_variables_rollback.h"
 #include "../base/property_builtins.h"
 #include "../base/property_enumeration.h"
 #include "../base/task_progress.h"
+#include "../base/tkernel_utils.h"
 #include "../base/enumeration_fromenum.h"
 
 #include <IGESControl_Controller.hxx>
 #include <Interface_Static.hxx>
+#include <fstream>
+#include <ostream>
 
 namespace Mayo {
 namespace IO {
@@ -53,6 +57,16 @@ public:
 
         this->readFaultyEntities.setDescription(textIdTr("Read failed entities"));
 
+        this->parallelRootTransfer.setDescription(
+                    textIdTr("Translate the root entities of the IGES file in independent batches "
+                             "running concurrently, then merge the results into the document.\n"
+                             "This mainly benefits files having many independent entities(ie trimmed "
+                             "surfaces). Requires OpenCascade >= v7.6.0"));
+
+        this->healShapes.setDescription(
+                    textIdTr("Fix the imported shapes(gaps in wires of faces, shells orientation, ...) "
+                             "before they are meshed. Parts are healed concurrently"));
+
         this->bsplineContinuity.setDescriptions({
                     { BSplineContinuity::NoChange, textIdTr("Curves are taken as they are in the IGES "
                       "file. C0 entities of Open CASCADE may be produced")
@@ -81,12 +95,16 @@ public:
         this->surfaceCurveMode.setValue(params.surfaceCurveMode);
         this->readFaultyEntities.setValue(params.readFaultyEntities);
         this->readOnlyVisibleEntities.setValue(params.readOnlyVisibleEntities);
+        this->parallelRootTransfer.setValue(params.parallelRootTransfer);
+        this->healShapes.setValue(params.healShapes);
     }
 
     PropertyEnum<BSplineContinuity> bsplineContinuity{ this, textId("bsplineContinuity") };
     PropertyEnum<SurfaceCurveMode> surfaceCurveMode{ this, textId("surfaceCurveMode") };
     PropertyBool readFaultyEntities{ this, textId("readFaultyEntities") };
     PropertyBool readOnlyVisibleEntities{ this, textId("readOnlyVisibleEntities") };
+    PropertyBool parallelRootTransfer{ this, textId("parallelRootTransfer") };
+    PropertyBool healShapes{ this, textId("healShapes") };
 };
 
 OccIgesReader::OccIgesReader()
@@ -117,6 +135,11 @@ TDF_LabelSequence OccIgesReader::transfer(DocumentPtr doc, TaskProgress* progres
     MayoIO_CafGlobalScopedLock(cafLock);
     OccStaticVariablesRollback rollback;
     this->changeStaticVariables(&rollback);
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+    if (m_params.parallelRootTransfer)
+        return Private::cafTransferRootsInParallel(*m_reader, doc, progress);
+#endif
+
     return Private::cafTransfer(*m_reader, doc, progress);
 }
 
@@ -133,9 +156,21 @@ void OccIgesReader::applyProperties(const PropertyGroup* group)
         m_params.surfaceCurveMode = ptr->surfaceCurveMode;
         m_params.readFaultyEntities = ptr->readFaultyEntities;
         m_params.readOnlyVisibleEntities = ptr->readOnlyVisibleEntities;
+        m_params.parallelRootTransfer = ptr->parallelRootTransfer;
+        m_params.healShapes = ptr->healShapes;
     }
 }
 
+ReaderParametersSnapshotPtr OccIgesReader::createParametersSnapshot() const
+{
+    return ReaderParametersSnapshotOf<Parameters>::create(m_params);
+}
+
+void OccIgesReader::applyParametersSnapshot(const ReaderParametersSnapshot& snapshot)
+{
+    ReaderParametersSnapshotOf<Parameters>::apply(snapshot, &m_params);
+}
+
 void OccIgesReader::changeStaticVariables(OccStaticVariablesRollback* rollback) const
 {
     rollback->change("read.iges.bspline.continuity", int(m_params.bsplineContinuity));
@@ -161,6 +196,11 @@ public:
                       "(Face) entities, the IGES file will contain BRep entities")
                     }
         });
+        this->parallelTranslation.setDescription(
+                    textIdTr("Translate the shapes into IGES entities concurrently, compounds being "
+                             "split into their sub-shapes. Entities are then numbered and written "
+                             "sequentially.\n"
+                             "This mainly benefits big surface models"));
     }
 
     void restoreDefaults() override {
@@ -168,11 +208,13 @@ public:
         this->brepMode.setValue(params.brepMode);
         this->planeMode.setValue(params.planeMode);
         this->lengthUnit.setValue(params.lengthUnit);
+        this->parallelTranslation.setValue(params.parallelTranslation);
     }
 
     PropertyEnum<BRepMode> brepMode{ this, textId("brepMode") };
     PropertyEnum<PlaneMode> planeMode{ this, textId("planeMode") };
     PropertyEnum<OccCommon::LengthUnit> lengthUnit{ this, textId("lengthUnit") };
+    PropertyBool parallelTranslation{ this, textId("parallelTranslation") };
 };
 
 OccIgesWriter::OccIgesWriter()
@@ -195,17 +237,31 @@ bool OccIgesWriter::transfer(Span<const ApplicationItem> appItems, TaskProgress*
     MayoIO_CafGlobalScopedLock(cafLock);
     OccStaticVariablesRollback rollback;
     this->changeStaticVariables(&rollback);
+    if (m_params.parallelTranslation)
+        return Private::cafTransferShapesInParallel(*m_writer, m_params.brepMode == BRepMode::BRep, appItems, progress);
+
     return Private::cafTransfer(*m_writer, appItems, progress);
 }
 
-bool OccIgesWriter::writeFile(const FilePath& filepath, TaskProgress* /*progress*/)
+bool OccIgesWriter::writeFile(const FilePath& filepath, TaskProgress* progress)
 {
     MayoIO_CafGlobalScopedLock(cafLock);
     OccStaticVariablesRollback rollback;
     this->changeStaticVariables(&rollback);
     m_writer->ComputeModel();
-    const bool ok = m_writer->Write(filepath.u8string().c_str());
-    return ok;
+    if (TaskProgress::isAbortRequested(progress))
+        return false;
+
+    // IGESControl_Writer::Write() has no progress indicator, output stream fails on abort request
+    std::filebuf fileBuffer;
+    if (!fileBuffer.open(filepath, std::ios::out | std::ios::binary | std::ios::trunc))
+        return false;
+
+    AbortableOutputStreamBuffer streamBuffer(&fileBuffer, progress);
+    std::ostream ostr(&streamBuffer);
+    const bool ok = m_writer->Write(ostr);
+    ostr.flush();
+    return ok && ostr.good() && !streamBuffer.isAborted();
 }
 
 std::unique_ptr<PropertyGroup> OccIgesWriter::createProperties(PropertyGroup* parentGroup)
@@ -220,6 +276,7 @@ void OccIgesWriter::applyProperties(const PropertyGroup* group)
         m_params.brepMode = ptr->brepMode;
         m_params.planeMode = ptr->planeMode;
         m_params.lengthUnit = ptr->lengthUnit;
+        m_params.parallelTranslation = ptr->parallelTranslation;
     }
 }
 
@@ -47,12 +47,16 @@ public:
         SurfaceCurveMode surfaceCurveMode = SurfaceCurveMode::Default;
         bool readFaultyEntities = false;
         bool readOnlyVisibleEntities = false;
+        bool parallelRootTransfer = false; // Requires OpenCascade >= v7.6.0
+        bool healShapes = false; // Post-import stage, see AppModule::healImportedShapes()
     };
     Parameters& parameters() { return m_params; }
     const Parameters& constParameters() const { return m_params; }
 
     static std::unique_ptr<PropertyGroup> createProperties(PropertyGroup* parentGroup);
     void applyProperties(const PropertyGroup* group) override;
+    ReaderParametersSnapshotPtr createParametersSnapshot() const override;
+    void applyParametersSnapshot(const ReaderParametersSnapshot& snapshot) override;
 
 private:
     void changeStaticVariables(OccStaticVariablesRollback* rollback) const;
@@ -87,6 +91,9 @@ public:
         BRepMode brepMode = BRepMode::Faces;
         PlaneMode planeMode = PlaneMode::Plane;
         LengthUnit lengthUnit = LengthUnit::Millimeter;
+        // Translate shapes(and sub-shapes of compounds) into IGES entities concurrently, see
+        // Private::cafTransferShapesInParallel()
+        bool parallelTranslation = false;
         // TODO Support "write.iges.offset.mode"
         // Summary: Writing offset-based surfaces of revolution to IGES
         // New parameter "write.iges.offset.mode" added in class
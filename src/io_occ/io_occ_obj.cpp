@@ -5,7 +5,20 @@
 ****************************************************************************/
 
 #include "io_occ_obj.h"
+#include "../base/caf_utils.h"
+#include "../base/document.h"
+#include "../base/io_file_source.h"
 #include "../base/property_builtins.h"
+#include "../base/string_conv.h"
+#include "../base/task_progress.h"
+
+#include <QtCore/QFile>
+#include <BRep_Builder.hxx>
+#include <TDataStd_Name.hxx>
+#include <TopoDS_Compound.hxx>
+#include <TopoDS_Face.hxx>
+#include <XCAFDoc_ColorTool.hxx>
+#include <XCAFDoc_ShapeTool.hxx>
 
 namespace Mayo {
 namespace IO {
@@ -18,14 +31,20 @@ public:
     {
         this->singlePrecisionVertexCoords.setDescription(
                     textId("Single precision flag for reading vertex data(coordinates)").tr());
+        this->parallelParsing.setDescription(
+                    textIdTr("Parse file contents concurrently with Mayo-native reader\n\n"
+                             "Faster on big files, but textures are ignored"));
     }
 
     void restoreDefaults() override {
         OccBaseMeshReaderProperties::restoreDefaults();
-        this->singlePrecisionVertexCoords.setValue(false);
+        const OccObjReader::Parameters defaults;
+        this->singlePrecisionVertexCoords.setValue(defaults.singlePrecisionVertexCoords);
+        this->parallelParsing.setValue(defaults.parallelParsing);
     }
 
     PropertyBool singlePrecisionVertexCoords{ this, textId("singlePrecisionVertexCoords") };
+    PropertyBool parallelParsing{ this, textId("parallelParsing") };
 };
 
 OccObjReader::OccObjReader()
@@ -33,6 +52,135 @@ OccObjReader::OccObjReader()
 {
 }
 
+bool OccObjReader::readFile(const FilePath& filepath, TaskProgress* progress)
+{
+    m_filepath = filepath;
+    m_nativeResult = {};
+    if (!m_params.parallelParsing)
+        return OccBaseMeshReader::readFile(filepath, progress);
+
+    QFile file(filepathTo<QString>(filepath));
+    const uchar* fileData = file.open(QIODevice::ReadOnly) ? file.map(0, file.size()) : nullptr;
+    if (fileData) {
+        const Span<const uint8_t> data(fileData, size_t(file.size()));
+        if (this->readContents(data, progress))
+            return true;
+
+        if (TaskProgress::isAbortRequested(progress))
+            return false;
+    }
+
+    // Fallback on OpenCascade
+    m_nativeResult = {};
+    return OccBaseMeshReader::readFile(filepath, progress);
+}
+
+bool OccObjReader::readFileSource(const FileSource& source, TaskProgress* progress)
+{
+    // Remote contents are gathered from a stream then passed to readBuffer()
+    if (source.isRemote())
+        return Reader::readFileSource(source, progress);
+
+    if (!source.isCompressed())
+        return this->readFile(source.filepath(), progress);
+
+    // OpenCascade can only read files from disk, so the native parser is used whatever the
+    // "parallel parsing" parameter
+    // It needs contiguous contents, the whole file is then decompressed in memory
+    m_filepath = source.filepath();
+    m_nativeResult = {};
+    std::vector<uint8_t> contents;
+    if (!decompressFile(source.filepath(), source.compression(), &contents))
+        return false;
+
+    return this->readContents(contents, progress);
+}
+
+bool OccObjReader::readBuffer(Span<const uint8_t> data, const FilePath& nameHint, TaskProgress* progress)
+{
+    // Native parser is used whatever the "parallel parsing" parameter, OpenCascade is reached
+    // through a temporary file only if it fails. MTL files are looked up next to 'nameHint'
+    m_filepath = nameHint;
+    m_nativeResult = {};
+    if (this->readContents(data, progress))
+        return true;
+
+    if (TaskProgress::isAbortRequested(progress))
+        return false;
+
+    m_nativeResult = {};
+    return Reader::readBuffer(data, nameHint, progress);
+}
+
+bool OccObjReader::readContents(Span<const uint8_t> data, TaskProgress* progress)
+{
+    this->applyParameters();
+    RWMesh_CoordinateSystemConverter converter;
+    converter.SetInputLengthUnit(m_reader.FileLengthUnit());
+    converter.SetInputCoordinateSystem(m_reader.FileCoordinateSystem());
+    converter.SetOutputLengthUnit(m_reader.SystemLengthUnit());
+    converter.SetOutputCoordinateSystem(m_reader.SystemCoordinateSystem());
+    return ObjNative::read(data, converter, &m_nativeResult, progress);
+}
+
+TDF_LabelSequence OccObjReader::transfer(DocumentPtr doc, TaskProgress* progress)
+{
+    if (m_nativeResult.vecMesh.empty())
+        return OccBaseMeshReader::transfer(doc, progress);
+
+    if (m_params.meshEntities) {
+        std::vector<StlNative::MeshPart> parts;
+        for (const ObjNative::Mesh& mesh : m_nativeResult.vecMesh)
+            parts.push_back({ mesh.triangulation, gp_Trsf(), false });
+
+        const TDF_Label entityLabel = OccBaseMeshReader::addMeshEntity(doc, parts, m_filepath);
+        m_nativeResult = {};
+        return !entityLabel.IsNull() ? CafUtils::makeLabelSequence({ entityLabel }) : TDF_LabelSequence();
+    }
+
+    std::unordered_map<std::string, ObjNative::Material> mapMaterial;
+    for (const std::string& library : m_nativeResult.vecMaterialLibrary) {
+        const FilePath mtlFilepath = m_filepath.parent_path() / std::filesystem::u8path(library);
+        mapMaterial.merge(ObjNative::readMaterials(mtlFilepath));
+    }
+
+    // One face per group/material, all gathered in a compound
+    BRep_Builder builder;
+    TopoDS_Compound compound;
+    builder.MakeCompound(compound);
+    std::vector<TopoDS_Face> vecFace;
+    for (const ObjNative::Mesh& mesh : m_nativeResult.vecMesh) {
+        TopoDS_Face face;
+        builder.MakeFace(face, mesh.triangulation);
+        builder.Add(compound, face);
+        vecFace.push_back(face);
+    }
+
+    Handle_XCAFDoc_ShapeTool shapeTool = doc->xcaf().shapeTool();
+    Handle_XCAFDoc_ColorTool colorTool = doc->xcaf().colorTool();
+    const TDF_Label rootLabel = shapeTool->AddShape(compound, false);
+    TDataStd_Name::Set(rootLabel, filepathTo<TCollection_ExtendedString>(m_filepath.stem()));
+    for (size_t i = 0; i < vecFace.size(); ++i) {
+        const ObjNative::Mesh& mesh = m_nativeResult.vecMesh.at(i);
+        const TDF_Label faceLabel = shapeTool->AddSubShape(rootLabel, vecFace.at(i));
+        if (faceLabel.IsNull())
+            continue;
+
+        if (!mesh.groupName.empty())
+            TDataStd_Name::Set(faceLabel, string_conv<TCollection_ExtendedString>(mesh.groupName));
+
+        auto itMaterial = mapMaterial.find(mesh.materialName);
+        if (itMaterial != mapMaterial.cend() && itMaterial->second.hasDiffuseColor) {
+            const ObjNative::Material& material = itMaterial->second;
+            const Quantity_ColorRGBA color(material.diffuseColor, 1.f - material.transparency);
+            colorTool->SetColor(faceLabel, color, XCAFDoc_ColorSurf);
+        }
+    }
+
+    m_nativeResult = {};
+    return CafUtils::makeLabelSequence({ rootLabel });
+}
+
 std::unique_ptr<PropertyGroup> OccObjReader::createProperties(PropertyGroup* parentGroup)
 {
     return std::make_unique<Properties>(parentGroup);
@@ -44,6 +192,7 @@ void OccObjReader::applyProperties(const PropertyGroup* params)
     auto ptr = dynamic_cast<const Properties*>(params);
     if (ptr) {
         m_params.singlePrecisionVertexCoords = ptr->singlePrecisionVertexCoords;
+        m_params.parallelParsing = ptr->parallelParsing;
     }
 }
 
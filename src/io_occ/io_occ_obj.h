@@ -7,6 +7,7 @@
 #pragma once
 
 #include "io_occ_base_mesh.h"
+#include "io_occ_obj_native.h"
 #include <RWObj_CafReader.hxx>
 
 namespace Mayo {
@@ -18,6 +19,11 @@ class OccObjReader : public OccBaseMeshReader {
 public:
     OccObjReader();
 
+    bool readFile(const FilePath& filepath, TaskProgress* progress) override;
+    bool readFileSource(const FileSource& source, TaskProgress* progress) override;
+    bool readBuffer(Span<const uint8_t> data, const FilePath& nameHint, TaskProgress* progress) override;
+    TDF_LabelSequence transfer(DocumentPtr doc, TaskProgress* progress) override;
+
     static std::unique_ptr<PropertyGroup> createProperties(PropertyGroup* parentGroup);
     void applyProperties(const PropertyGroup* params) override;
 
@@ -25,6 +31,7 @@ public:
 
     struct Parameters : public OccBaseMeshReader::Parameters {
         bool singlePrecisionVertexCoords = false;
+        bool parallelParsing = false;
     };
     OccObjReader::Parameters& parameters() override { return m_params; }
     const OccObjReader::Parameters& constParameters() const override { return m_params; }
@@ -33,9 +40,14 @@ protected:
     void applyParameters() override;
 
 private:
+    // Reads contents with the native parser into 'm_nativeResult'
+    bool readContents(Span<const uint8_t> data, TaskProgress* progress);
+
     class Properties;
     Parameters m_params;
     RWObj_CafReader m_reader;
+    FilePath m_filepath;
+    ObjNative::Result m_nativeResult;
 };
 
 } // namespace IO
@@ -0,0 +1,576 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "io_occ_obj_native.h"
+#include "../base/task_manager.h"
+#include "../base/task_progress.h"
+#include "../base/tkernel_utils.h"
+
+#include <QtCore/QFile>
+#include <fast_float/fast_float.h>
+#if OCC_VERSION_HEX < OCC_VERSION_CHECK(7, 6, 0)
+#  include <TShort_HArray1OfShortReal.hxx>
+#endif
+#include <algorithm>
+#include <charconv>
+#include <climits>
+#include <cstring>
+#include <map>
+#include <string_view>
+#include <thread>
+
+namespace Mayo {
+namespace IO {
+namespace ObjNative {
+
+namespace {
+
+// Indices of the vertex attributes
+enum Attribute { Attribute_Position = 0, Attribute_TexCoord = 1, Attribute_Normal = 2 };
+constexpr int AttributeCount = 3;
+constexpr int AttributeComponentCount[AttributeCount] = { 3, 2, 3 };
+
+// Face vertex as found in "f" records, indices are 1-based and 0 means absent
+// Negative(relative) indices are stored as chunk-local 0-based indices, flagged in 'relativeMask'
+struct FaceVertex {
+    int index[AttributeCount];
+    uint8_t relativeMask;
+};
+
+// Change of current group or material, effective from face vertex 'faceVertexPos'
+struct StateChange {
+    size_t faceVertexPos;
+    bool isGroup; // Otherwise material
+    std::string name;
+};
+
+struct Chunk {
+    const char* begin = nullptr;
+    const char* end = nullptr;
+    std::vector<float> vecAttributeValue[AttributeCount];
+    std::vector<FaceVertex> vecFaceVertex; // Faces are triangulated, 3 vertices per triangle
+    std::vector<StateChange> vecStateChange;
+    std::vector<std::string> vecMaterialLibrary;
+    size_t attributeOffset[AttributeCount] = {}; // Count of attributes in previous chunks
+
+    size_t attributeCount(int attr) const {
+        return this->vecAttributeValue[attr].size() / AttributeComponentCount[attr];
+    }
+};
+
+// Contiguous range of face vertices of a chunk belonging to a mesh
+struct Segment {
+    int iChunk;
+    size_t faceVertexBegin;
+    size_t faceVertexEnd;
+};
+
+struct MeshData {
+    std::string groupName;
+    std::string materialName;
+    std::vector<Segment> vecSegment;
+};
+
+bool isLineSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+const char* skipLineSpaces(const char* ptr, const char* lineEnd)
+{
+    while (ptr < lineEnd && isLineSpace(*ptr))
+        ++ptr;
+
+    return ptr;
+}
+
+// Returns true if line starts with 'keyword' followed by a space or end of line, 'ptrAfter' is
+// then the position following the keyword
+bool matchKeyword(const char* ptr, const char* lineEnd, std::string_view keyword, const char** ptrAfter)
+{
+    const size_t keywordEnd = keyword.size();
+    if (size_t(lineEnd - ptr) < keywordEnd || std::memcmp(ptr, keyword.data(), keywordEnd) != 0)
+        return false;
+
+    if (ptr + keywordEnd < lineEnd && !isLineSpace(ptr[keywordEnd]))
+        return false;
+
+    *ptrAfter = ptr + keywordEnd;
+    return true;
+}
+
+std::string trimmedText(const char* ptr, const char* lineEnd)
+{
+    ptr = skipLineSpaces(ptr, lineEnd);
+    while (lineEnd > ptr && isLineSpace(lineEnd[-1]))
+        --lineEnd;
+
+    return std::string(ptr, lineEnd - ptr);
+}
+
+// Parses 'count' float values, missing or invalid values are set to zero
+void parseFloats(const char* ptr, const char* lineEnd, float* values, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        ptr = skipLineSpaces(ptr, lineEnd);
+        if (ptr < lineEnd && *ptr == '+') // Not accepted by from_chars()
+            ++ptr;
+
+        const fast_float::from_chars_result res = fast_float::from_chars(ptr, lineEnd, values[i]);
+        if (res.ec != std::errc()) {
+            std::fill(values + i, values + count, 0.f);
+            return;
+        }
+
+        ptr = res.ptr;
+    }
+}
+
+// Parses "f" record, polygons are triangulated as fans
+void parseFace(const char* ptr, const char* lineEnd, Chunk* chunk)
+{
+    FaceVertex firstVertex = {};
+    FaceVertex prevVertex = {};
+    int vertexCount = 0;
+    while (true) {
+        ptr = skipLineSpaces(ptr, lineEnd);
+        if (ptr >= lineEnd)
+            break;
+
+        // Syntax is one of: v  v/vt  v//vn  v/vt/vn
+        FaceVertex vertex = {};
+        for (int attr = 0; attr < AttributeCount; ++attr) {
+            if (attr > 0) {
+                if (ptr >= lineEnd || *ptr != '/')
+                    break;
+
+                ++ptr;
+                if (ptr < lineEnd && *ptr == '/')
+                    continue; // Empty field
+            }
+
+            int value = 0;
+            const std::from_chars_result res = std::from_chars(ptr, lineEnd, value);
+            if (res.ec != std::errc())
+                break;
+
+            ptr = res.ptr;
+            if (value < 0) {
+                vertex.index[attr] = int(chunk->attributeCount(attr)) + value;
+                vertex.relativeMask |= 1 << attr;
+            }
+            else {
+                vertex.index[attr] = value;
+            }
+        }
+
+        while (ptr < lineEnd && !isLineSpace(*ptr))
+            ++ptr;
+
+        if (vertexCount == 0)
+            firstVertex = vertex;
+
+        if (vertexCount >= 2) {
+            chunk->vecFaceVertex.push_back(firstVertex);
+            chunk->vecFaceVertex.push_back(prevVertex);
+            chunk->vecFaceVertex.push_back(vertex);
+        }
+
+        prevVertex = vertex;
+        ++vertexCount;
+    }
+}
+
+void parseChunkRecords(Chunk* chunk, TaskProgress* progress)
+{
+    const char* ptr = chunk->begin;
+    const size_t chunkSize = std::max<ptrdiff_t>(1, chunk->end - chunk->begin);
+    size_t lineCount = 0;
+    while (ptr < chunk->end) {
+        auto lineEnd = static_cast<const char*>(std::memchr(ptr, '\n', chunk->end - ptr));
+        if (!lineEnd)
+            lineEnd = chunk->end;
+
+        const char* token = skipLineSpaces(ptr, lineEnd);
+        const char* ptrAfter = nullptr;
+        if (matchKeyword(token, lineEnd, "v", &ptrAfter)) {
+            float* values = &(*chunk->vecAttributeValue[Attribute_Position].insert(
+                                  chunk->vecAttributeValue[Attribute_Position].end(), 3, 0.f));
+            parseFloats(ptrAfter, lineEnd, values, 3);
+        }
+        else if (matchKeyword(token, lineEnd, "vt", &ptrAfter)) {
+            float* values = &(*chunk->vecAttributeValue[Attribute_TexCoord].insert(
+                                  chunk->vecAttributeValue[Attribute_TexCoord].end(), 2, 0.f));
+            parseFloats(ptrAfter, lineEnd, values, 2);
+        }
+        else if (matchKeyword(token, lineEnd, "vn", &ptrAfter)) {
+            float* values = &(*chunk->vecAttributeValue[Attribute_Normal].insert(
+                                  chunk->vecAttributeValue[Attribute_Normal].end(), 3, 0.f));
+            parseFloats(ptrAfter, lineEnd, values, 3);
+        }
+        else if (matchKeyword(token, lineEnd, "f", &ptrAfter)) {
+            parseFace(ptrAfter, lineEnd, chunk);
+        }
+        else if (matchKeyword(token, lineEnd, "g", &ptrAfter) || matchKeyword(token, lineEnd, "o", &ptrAfter)) {
+            const std::string name = trimmedText(ptrAfter, lineEnd);
+            chunk->vecStateChange.push_back({ chunk->vecFaceVertex.size(), true, name });
+        }
+        else if (matchKeyword(token, lineEnd, "usemtl", &ptrAfter)) {
+            const std::string name = trimmedText(ptrAfter, lineEnd);
+            chunk->vecStateChange.push_back({ chunk->vecFaceVertex.size(), false, name });
+        }
+        else if (matchKeyword(token, lineEnd, "mtllib", &ptrAfter)) {
+            chunk->vecMaterialLibrary.push_back(trimmedText(ptrAfter, lineEnd));
+        }
+
+        ptr = lineEnd + 1;
+        if (++lineCount % (1 << 16) == 0) {
+            progress->setValue(int((100 * size_t(ptr - chunk->begin)) / chunkSize));
+            if (TaskProgress::isAbortRequested(progress))
+                return;
+        }
+    }
+}
+
+void setNode(Poly_Triangulation* mesh, int index, const gp_XYZ& coords)
+{
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+    mesh->SetNode(index, coords);
+#else
+    mesh->ChangeNode(index) = coords;
+#endif
+}
+
+void setUVNode(Poly_Triangulation* mesh, int index, const gp_Pnt2d& uv)
+{
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+    mesh->SetUVNode(index, uv);
+#else
+    mesh->ChangeUVNode(index) = uv;
+#endif
+}
+
+void setTriangle(Poly_Triangulation* mesh, int index, const Poly_Triangle& triangle)
+{
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+    mesh->SetTriangle(index, triangle);
+#else
+    mesh->ChangeTriangle(index) = triangle;
+#endif
+}
+
+// Key of a triangulation node: global 0-based attribute indices, -1 if attribute is not used
+struct NodeKey {
+    int index[AttributeCount];
+    bool operator==(const NodeKey& other) const {
+        return std::memcmp(this->index, other.index, sizeof(this->index)) == 0;
+    }
+};
+
+struct NodeKeyHasher {
+    size_t operator()(const NodeKey& key) const {
+        return (size_t(key.index[0]) * 73856093u) ^ (size_t(key.index[1]) * 19349663u) ^ (size_t(key.index[2]) * 83492791u);
+    }
+};
+
+class MeshBuilder {
+public:
+    MeshBuilder(const std::vector<Chunk>& vecChunk, const RWMesh_CoordinateSystemConverter& converter)
+        : m_vecChunk(vecChunk), m_converter(converter)
+    {
+        for (int attr = 0; attr < AttributeCount; ++attr) {
+            std::vector<size_t>& vecOffset = m_vecChunkAttributeOffset[attr];
+            for (const Chunk& chunk : vecChunk)
+                vecOffset.push_back(chunk.attributeOffset[attr]);
+
+            m_attributeTotalCount[attr] = vecChunk.back().attributeOffset[attr] + vecChunk.back().attributeCount(attr);
+        }
+    }
+
+    Handle_Poly_Triangulation build(const MeshData& meshData, TaskProgress* progress) const
+    {
+        // Texture coordinates and normals are used only if defined for all the face vertices
+        bool useAttribute[AttributeCount] = { true, true, true };
+        for (const Segment& segment : meshData.vecSegment) {
+            const Chunk& chunk = m_vecChunk.at(segment.iChunk);
+            for (size_t i = segment.faceVertexBegin; i < segment.faceVertexEnd; ++i) {
+                for (int attr = Attribute_TexCoord; attr < AttributeCount; ++attr)
+                    useAttribute[attr] = useAttribute[attr] && this->globalIndex(chunk, chunk.vecFaceVertex[i], attr) >= 0;
+            }
+        }
+
+        const bool usePositionOnly = !useAttribute[Attribute_TexCoord] && !useAttribute[Attribute_Normal];
+        std::vector<int> vecPositionNode; // Used if only positions, maps global positions to nodes
+        std::unordered_map<NodeKey, int, NodeKeyHasher> mapNode;
+        if (usePositionOnly)
+            vecPositionNode.resize(m_attributeTotalCount[Attribute_Position], 0);
+
+        std::vector<NodeKey> vecNodeKey;
+        std::vector<int> vecTriangleNode;
+        auto fnNode = [&](const NodeKey& key) {
+            int& node = usePositionOnly ? vecPositionNode[key.index[Attribute_Position]] : mapNode[key];
+            if (node == 0) {
+                vecNodeKey.push_back(key);
+                node = int(vecNodeKey.size()); // 1-based
+            }
+
+            return node;
+        };
+
+        for (const Segment& segment : meshData.vecSegment) {
+            const Chunk& chunk = m_vecChunk.at(segment.iChunk);
+            for (size_t i = segment.faceVertexBegin; i + 2 < segment.faceVertexEnd; i += 3) {
+                NodeKey keys[3];
+                bool isValid = true;
+                for (int j = 0; j < 3; ++j) {
+                    for (int attr = 0; attr < AttributeCount; ++attr) {
+                        keys[j].index[attr] =
+                                useAttribute[attr] ? this->globalIndex(chunk, chunk.vecFaceVertex[i + j], attr) : -1;
+                    }
+
+                    isValid = isValid && keys[j].index[Attribute_Position] >= 0;
+                }
+
+                if (isValid) {
+                    for (const NodeKey& key : keys)
+                        vecTriangleNode.push_back(fnNode(key));
+                }
+            }
+
+            if (TaskProgress::isAbortRequested(progress))
+                return {};
+        }
+
+        progress->setValue(50);
+        const int nodeCount = int(vecNodeKey.size());
+        const int triangleCount = int(vecTriangleNode.size() / 3);
+        if (triangleCount == 0)
+            return {};
+
+        Handle_Poly_Triangulation mesh = new Poly_Triangulation(nodeCount, triangleCount, useAttribute[Attribute_TexCoord]);
+        const bool useConverter = !m_converter.IsEmpty();
+        for (int i = 0; i < nodeCount; ++i) {
+            const NodeKey& key = vecNodeKey.at(i);
+            const float* position = this->attributeValues(Attribute_Position, key.index[Attribute_Position]);
+            gp_XYZ coords(position[0], position[1], position[2]);
+            if (useConverter)
+                m_converter.TransformPosition(coords);
+
+            setNode(mesh.get(), i + 1, coords);
+            if (useAttribute[Attribute_TexCoord]) {
+                const float* uv = this->attributeValues(Attribute_TexCoord, key.index[Attribute_TexCoord]);
+                setUVNode(mesh.get(), i + 1, gp_Pnt2d(uv[0], uv[1]));
+            }
+        }
+
+        if (useAttribute[Attribute_Normal]) {
+            auto fnNormal = [&](int i) {
+                const float* values = this->attributeValues(Attribute_Normal, vecNodeKey.at(i).index[Attribute_Normal]);
+                Graphic3d_Vec3 normal(values[0], values[1], values[2]);
+                if (useConverter)
+                    m_converter.TransformNormal(normal);
+
+                return normal;
+            };
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+            mesh->AddNormals();
+            for (int i = 0; i < nodeCount; ++i)
+                mesh->SetNormal(i + 1, fnNormal(i));
+#else
+            Handle_TShort_HArray1OfShortReal normals = new TShort_HArray1OfShortReal(1, 3 * nodeCount);
+            for (int i = 0; i < nodeCount; ++i) {
+                const Graphic3d_Vec3 normal = fnNormal(i);
+                normals->SetValue(3 * i + 1, normal.x());
+                normals->SetValue(3 * i + 2, normal.y());
+                normals->SetValue(3 * i + 3, normal.z());
+            }
+
+            mesh->SetNormals(normals);
+#endif
+        }
+
+        for (int i = 0; i < triangleCount; ++i) {
+            const int* nodes = &vecTriangleNode[3 * i];
+            setTriangle(mesh.get(), i + 1, Poly_Triangle(nodes[0], nodes[1], nodes[2]));
+        }
+
+        return mesh;
+    }
+
+private:
+    // Returns the global 0-based index of attribute 'attr' of face vertex, -1 if absent or invalid
+    int globalIndex(const Chunk& chunk, const FaceVertex& vertex, int attr) const
+    {
+        int64_t index = vertex.index[attr];
+        if (vertex.relativeMask & (1 << attr))
+            index += chunk.attributeOffset[attr];
+        else if (index > 0)
+            index -= 1;
+        else
+            return -1;
+
+        return index >= 0 && size_t(index) < m_attributeTotalCount[attr] ? int(index) : -1;
+    }
+
+    const float* attributeValues(int attr, int globalIndex) const
+    {
+        const std::vector<size_t>& vecOffset = m_vecChunkAttributeOffset[attr];
+        auto itChunk = std::upper_bound(vecOffset.cbegin(), vecOffset.cend(), size_t(globalIndex));
+        // Chunks without any such attribute share their offset with the next ones
+        const int iChunk = int(itChunk - vecOffset.cbegin()) - 1;
+        const Chunk& chunk = m_vecChunk.at(iChunk);
+        const size_t localIndex = size_t(globalIndex) - chunk.attributeOffset[attr];
+        return chunk.vecAttributeValue[attr].data() + localIndex * AttributeComponentCount[attr];
+    }
+
+    const std::vector<Chunk>& m_vecChunk;
+    const RWMesh_CoordinateSystemConverter& m_converter;
+    std::vector<size_t> m_vecChunkAttributeOffset[AttributeCount];
+    size_t m_attributeTotalCount[AttributeCount] = {};
+};
+
+} // namespace
+
+bool read(
+        Span<const uint8_t> data,
+        const RWMesh_CoordinateSystemConverter& converter,
+        Result* result,
+        TaskProgress* progress)
+{
+    const char* dataBegin = reinterpret_cast<const char*>(data.data());
+    const char* dataEnd = dataBegin + data.size();
+    constexpr size_t minChunkSize = 1 << 20;
+    const int threadCount = std::max(1, int(std::thread::hardware_concurrency()));
+    const int chunkCount = int(std::min<size_t>(threadCount, 1 + data.size() / minChunkSize));
+
+    // Line-aligned chunks
+    std::vector<Chunk> vecChunk(chunkCount);
+    const char* chunkBegin = dataBegin;
+    for (Chunk& chunk : vecChunk) {
+        const int iChunk = &chunk - &vecChunk.front();
+        const char* chunkEnd = dataEnd;
+        if (iChunk + 1 < chunkCount) {
+            chunkEnd = std::max(chunkBegin, dataBegin + ((iChunk + 1) * data.size()) / chunkCount);
+            auto lineEnd = static_cast<const char*>(std::memchr(chunkEnd, '\n', dataEnd - chunkEnd));
+            chunkEnd = lineEnd ? lineEnd + 1 : dataEnd;
+        }
+
+        chunk.begin = chunkBegin;
+        chunk.end = chunkEnd;
+        chunkBegin = chunkEnd;
+    }
+
+    {
+        TaskProgress parseProgress(progress, 60);
+        const bool ok = TaskManager::runConcurrently(chunkCount, &parseProgress, [&](int iChunk, TaskProgress* taskProgress) {
+            parseChunkRecords(&vecChunk.at(iChunk), taskProgress);
+        });
+        if (!ok)
+            return false;
+    }
+
+    // Resolve attribute offsets, then group contiguous face ranges by group/material
+    for (int iChunk = 1; iChunk < chunkCount; ++iChunk) {
+        const Chunk& prevChunk = vecChunk.at(iChunk - 1);
+        for (int attr = 0; attr < AttributeCount; ++attr)
+            vecChunk.at(iChunk).attributeOffset[attr] = prevChunk.attributeOffset[attr] + prevChunk.attributeCount(attr);
+    }
+
+    for (int attr = 0; attr < AttributeCount; ++attr) {
+        const Chunk& lastChunk = vecChunk.back();
+        if (lastChunk.attributeOffset[attr] + lastChunk.attributeCount(attr) > size_t(INT_MAX))
+            return false;
+    }
+
+    std::vector<MeshData> vecMeshData;
+    std::map<std::pair<std::string, std::string>, int> mapMeshId;
+    std::string currentGroup;
+    std::string currentMaterial;
+    auto fnAddSegment = [&](int iChunk, size_t begin, size_t end) {
+        if (begin >= end)
+            return;
+
+        auto [itMeshId, isNew] = mapMeshId.insert({ { currentGroup, currentMaterial }, int(vecMeshData.size()) });
+        if (isNew)
+            vecMeshData.push_back({ currentGroup, currentMaterial, {} });
+
+        vecMeshData.at(itMeshId->second).vecSegment.push_back({ iChunk, begin, end });
+    };
+
+    for (const Chunk& chunk : vecChunk) {
+        const int iChunk = &chunk - &vecChunk.front();
+        size_t faceVertexPos = 0;
+        for (const StateChange& change : chunk.vecStateChange) {
+            fnAddSegment(iChunk, faceVertexPos, change.faceVertexPos);
+            faceVertexPos = change.faceVertexPos;
+            (change.isGroup ? currentGroup : currentMaterial) = change.name;
+        }
+
+        fnAddSegment(iChunk, faceVertexPos, chunk.vecFaceVertex.size());
+        for (const std::string& library : chunk.vecMaterialLibrary)
+            result->vecMaterialLibrary.push_back(library);
+    }
+
+    // Build triangulations concurrently
+    const MeshBuilder builder(vecChunk, converter);
+    std::vector<Mesh> vecMesh(vecMeshData.size());
+    {
+        TaskProgress buildProgress(progress, 40);
+        const bool ok = TaskManager::runConcurrently(int(vecMeshData.size()), &buildProgress, [&](int iMesh, TaskProgress* taskProgress) {
+            const MeshData& meshData = vecMeshData.at(iMesh);
+            Mesh& mesh = vecMesh.at(iMesh);
+            mesh.groupName = meshData.groupName;
+            mesh.materialName = meshData.materialName;
+            mesh.triangulation = builder.build(meshData, taskProgress);
+        });
+        if (!ok)
+            return false;
+    }
+
+    for (Mesh& mesh : vecMesh) {
+        if (!mesh.triangulation.IsNull())
+            result->vecMesh.push_back(std::move(mesh));
+    }
+
+    return !result->vecMesh.empty();
+}
+
+std::unordered_map<std::string, Material> readMaterials(const FilePath& filepath)
+{
+    std::unordered_map<std::string, Material> mapMaterial;
+    QFile file(filepathTo<QString>(filepath));
+    if (!file.open(QIODevice::ReadOnly))
+        return mapMaterial;
+
+    Material* currentMaterial = nullptr;
+    const QByteArray contents = file.readAll();
+    for (const QByteArray& line : contents.split('\n')) {
+        const QList<QByteArray> tokens = line.simplified().split(' ');
+        const QByteArray& keyword = tokens.front();
+        if (keyword == "newmtl" && tokens.size() >= 2) {
+            const QByteArray name = line.simplified().mid(keyword.size() + 1);
+            currentMaterial = &mapMaterial[name.toStdString()];
+        }
+        else if (currentMaterial && keyword == "Kd" && tokens.size() >= 4) {
+            currentMaterial->diffuseColor.SetValues(
+                        tokens.at(1).toDouble(), tokens.at(2).toDouble(), tokens.at(3).toDouble(),
+                        Quantity_TOC_RGB);
+            currentMaterial->hasDiffuseColor = true;
+        }
+        else if (currentMaterial && keyword == "d" && tokens.size() >= 2) {
+            currentMaterial->transparency = 1.f - tokens.at(1).toFloat();
+        }
+        else if (currentMaterial && keyword == "Tr" && tokens.size() >= 2) {
+            currentMaterial->transparency = tokens.at(1).toFloat();
+        }
+    }
+
+    return mapMaterial;
+}
+
+} // namespace ObjNative
+} // namespace IO
+} // namespace Mayo
@@ -0,0 +1,62 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "../base/filepath.h"
+#include "../base/span.h"
+#include <Poly_Triangulation.hxx>
+#include <Quantity_Color.hxx>
+#include <RWMesh_CoordinateSystemConverter.hxx>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Mayo {
+
+class TaskProgress;
+
+namespace IO {
+
+// Mayo-native parsing of Wavefront OBJ contents
+// Contents(expected to be memory-mapped) are split into line-aligned chunks whose records are
+// parsed concurrently, then face indices are resolved in a second pass producing one
+// Poly_Triangulation per group/material
+namespace ObjNative {
+
+struct Mesh {
+    std::string groupName;
+    std::string materialName;
+    Handle_Poly_Triangulation triangulation;
+};
+
+struct Material {
+    Quantity_Color diffuseColor;
+    bool hasDiffuseColor = false;
+    float transparency = 0.f;
+};
+
+struct Result {
+    std::vector<Mesh> vecMesh;
+    std::vector<std::string> vecMaterialLibrary; // File names found in "mtllib" records
+};
+
+// Coordinates(and normals) are transformed with 'converter' unless it's empty
+// Returns false in case of abort request or if no mesh could be built
+bool read(
+        Span<const uint8_t> data,
+        const RWMesh_CoordinateSystemConverter& converter,
+        Result* result,
+        TaskProgress* progress);
+
+// Reads the "newmtl" definitions of a MTL file, only diffuse color and transparency are supported
+std::unordered_map<std::string, Material> readMaterials(const FilePath& filepath);
+
+} // namespace ObjNative
+
+} // namespace IO
+} // namespace Mayo
@@ -0,0 +1,426 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "io_occ_obj_writer.h"
+
+#include "../base/application_item.h"
+#include "../base/caf_utils.h"
+#include "../base/document.h"
+#include "../base/profiler.h"
+#include "../base/property_builtins.h"
+#include "../base/string_conv.h"
+#include "../base/task_manager.h"
+#include "../base/task_progress.h"
+#include "../base/text_number.h"
+
+#include <BRepTools.hxx>
+#include <QtCore/QFile>
+#include <TDataXtd_Triangulation.hxx>
+#include <algorithm>
+#include <charconv>
+#include <climits>
+#include <functional>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+
+namespace Mayo {
+namespace IO {
+
+namespace {
+
+// Shortest representation of 'value' as a float that reads back to the same float(9 significant
+// digits if floating-point std::to_chars() isn't available)
+void appendFloat(std::string* str, double value)
+{
+#if __cpp_lib_to_chars
+    char buff[64];
+    const std::to_chars_result res = std::to_chars(std::begin(buff), std::end(buff), float(value));
+    str->append(buff, res.ptr - buff);
+#else
+    TextNumber::append(str, value, TextNumber::Format::General, 9);
+#endif
+}
+
+void appendInt(std::string* str, int value)
+{
+    char buff[16];
+    const std::to_chars_result res = std::to_chars(std::begin(buff), std::end(buff), value);
+    str->append(buff, res.ptr - buff);
+}
+
+std::string materialName(int materialIndex)
+{
+    return "material_" + std::to_string(materialIndex);
+}
+
+// Name suitable for "o" records, which stop at end of line
+std::string objName(const TDF_Label& label)
+{
+    std::string name = string_conv<std::string>(CafUtils::labelAttrStdName(label));
+    std::replace_if(name.begin(), name.end(), [](char c) { return c == '\n' || c == '\r'; }, ' ');
+    return name;
+}
+
+// Vertex and face records of a group, with vertices transformed by 'trsf'
+struct ObjBlock {
+    int prototypeIndex = -1;
+    const std::vector<StlNative::MeshPart>* parts = nullptr; // Available once the block is reached
+    std::string name;
+    gp_Trsf trsf;
+    int materialIndex = -1;
+    int64_t nodeOffset = 0; // Count of vertices written before the block
+};
+
+void formatBlock(const ObjBlock& block, std::string* str)
+{
+    size_t nodeCount = 0;
+    size_t triangleCount = 0;
+    for (const StlNative::MeshPart& part : *block.parts) {
+        nodeCount += part.triangulation->NbNodes();
+        triangleCount += part.triangulation->NbTriangles();
+    }
+
+    str->clear();
+    str->reserve(64 + block.name.size() + nodeCount * 32 + triangleCount * 24);
+    str->append("o ").append(block.name).append("\n");
+    if (block.materialIndex >= 0)
+        str->append("usemtl ").append(materialName(block.materialIndex)).append("\n");
+
+    for (const StlNative::MeshPart& part : *block.parts) {
+        const gp_Trsf trsf = block.trsf * part.trsf;
+        const Poly_Triangulation& mesh = *part.triangulation;
+        for (int i = 1; i <= mesh.NbNodes(); ++i) {
+            const gp_Pnt pnt = mesh.Node(i).Transformed(trsf);
+            str->append("v ");
+            appendFloat(str, pnt.X());
+            str->push_back(' ');
+            appendFloat(str, pnt.Y());
+            str->push_back(' ');
+            appendFloat(str, pnt.Z());
+            str->push_back('\n');
+        }
+    }
+
+    // OBJ indices are 1-based and refer to all the vertices written so far in the file
+    int nodeOffset = int(block.nodeOffset);
+    for (const StlNative::MeshPart& part : *block.parts) {
+        const Poly_Triangulation& mesh = *part.triangulation;
+        for (int i = 1; i <= mesh.NbTriangles(); ++i) {
+            int n1, n2, n3;
+            mesh.Triangle(i).Get(n1, n2, n3);
+            if (part.isReversed)
+                std::swap(n2, n3);
+
+            str->append("f ");
+            appendInt(str, n1 + nodeOffset);
+            str->push_back(' ');
+            appendInt(str, n2 + nodeOffset);
+            str->push_back(' ');
+            appendInt(str, n3 + nodeOffset);
+            str->push_back('\n');
+        }
+
+        nodeOffset += mesh.NbNodes();
+    }
+}
+
+} // namespace
+
+class OccObjWriter::Properties : public PropertyGroup {
+    MAYO_DECLARE_TEXT_ID_FUNCTIONS(Mayo::IO::OccObjWriter::Properties)
+public:
+    Properties(PropertyGroup* parentGroup)
+        : PropertyGroup(parentGroup)
+    {
+        this->writePrototypesOnce.setDescription(
+                    textIdTr("Parts having many instances are written once as a group in their own "
+                             "coordinates, locations of the instances are lost"));
+    }
+
+    void restoreDefaults() override {
+        const OccObjWriter::Parameters params;
+        this->writePrototypesOnce.setValue(params.writePrototypesOnce);
+    }
+
+    PropertyBool writePrototypesOnce{ this, textId("writePrototypesOnce") };
+};
+
+bool OccObjWriter::transfer(Span<const ApplicationItem> appItems, TaskProgress* /*progress*/)
+{
+    m_vecPrototype.clear();
+    m_vecInstance.clear();
+    m_vecColor.clear();
+
+    std::unordered_map<TDF_Label, int> mapLabelPrototype;
+    auto fnShapePrototype = [&](const TDF_Label& label) {
+        auto [it, isNew] = mapLabelPrototype.try_emplace(label, int(m_vecPrototype.size()));
+        if (isNew) {
+            Prototype prototype;
+            prototype.name = objName(label);
+            prototype.shape = XCaf::shape(label);
+            m_vecPrototype.push_back(std::move(prototype));
+        }
+
+        return it->second;
+    };
+
+    // Color of a reference takes precedence over the color of the referred shape, and color of an
+    // assembly is inherited by its components unless they define their own
+    // Label attributes come from the document snapshots, shared prototypes are queried only once
+    std::function<void(LabelAttributesCache&, const TDF_Label&, const TopLoc_Location&, const Quantity_Color*, const std::string&)> fnWalk;
+    fnWalk = [&](LabelAttributesCache& attrsCache,
+                 const TDF_Label& label,
+                 const TopLoc_Location& loc,
+                 const Quantity_Color* color,
+                 const std::string& instanceName)
+    {
+        const auto attrs = attrsCache.attributes(label);
+        Quantity_Color labelColor;
+        if (attrs->hasColor) {
+            labelColor = attrs->color;
+            color = &labelColor;
+        }
+
+        if (attrs->isReference) {
+            const TDF_Label labelReferred = attrs->labelReferred;
+            const TopLoc_Location locReferred = loc * attrs->referenceLocation;
+            if (attrsCache.attributes(labelReferred)->isAssembly) {
+                for (const TDF_Label& labelChild : XCaf::shapeComponents(labelReferred))
+                    fnWalk(attrsCache, labelChild, locReferred, color, {});
+            }
+            else if (color != &labelColor) {
+                fnWalk(attrsCache, labelReferred, locReferred, color, objName(label));
+            }
+            else {
+                const int iPrototype = fnShapePrototype(labelReferred);
+                this->addInstance(iPrototype, objName(label), locReferred.Transformation(), color);
+            }
+        }
+        else if (attrs->isAssembly) {
+            for (const TDF_Label& labelChild : XCaf::shapeComponents(label))
+                fnWalk(attrsCache, labelChild, loc, color, {});
+        }
+        else if (!attrs->shape.IsNull()) {
+            const int iPrototype = fnShapePrototype(label);
+            const std::string& name = !instanceName.empty() ? instanceName : m_vecPrototype.at(iPrototype).name;
+            this->addInstance(iPrototype, name, loc.Transformation(), color);
+        }
+    };
+
+    for (const ApplicationItem& item : appItems) {
+        const XCaf& xcaf = item.document()->xcaf();
+        LabelAttributesCache& attrsCache = item.document()->labelAttributesCache();
+        if (item.isDocument()) {
+            for (const TDF_Label& label : xcaf.topLevelFreeShapes())
+                fnWalk(attrsCache, label, TopLoc_Location(), nullptr, {});
+        }
+        else if (item.isDocumentTreeNode()) {
+            const TDF_Label label = item.documentTreeNode().label();
+            if (XCaf::isShape(label)) {
+                fnWalk(attrsCache, label, TopLoc_Location(), nullptr, {});
+            }
+            else {
+                auto attrPolyTri = CafUtils::findAttribute<TDataXtd_Triangulation>(label);
+                if (!attrPolyTri.IsNull() && !attrPolyTri->Get().IsNull()) {
+                    const int iPrototype = int(m_vecPrototype.size());
+                    Prototype prototype;
+                    prototype.name = objName(label);
+                    prototype.parts = { { attrPolyTri->Get(), gp_Trsf(), false } };
+                    prototype.hasParts = true;
+                    m_vecPrototype.push_back(std::move(prototype));
+                    this->addInstance(iPrototype, m_vecPrototype.back().name, gp_Trsf(), nullptr);
+                }
+            }
+        }
+    }
+
+    return !m_vecInstance.empty();
+}
+
+bool OccObjWriter::writeFile(const FilePath& filepath, TaskProgress* progress)
+{
+    MAYO_PROFILE_ZONE("OccObjWriter::writeFile");
+    std::vector<ObjBlock> vecBlock;
+    if (m_params.writePrototypesOnce) {
+        // Material of a prototype is the one of its first instance
+        std::vector<bool> vecPrototypeWritten(m_vecPrototype.size(), false);
+        for (const Instance& instance : m_vecInstance) {
+            if (!vecPrototypeWritten.at(instance.prototypeIndex)) {
+                const Prototype& prototype = m_vecPrototype.at(instance.prototypeIndex);
+                vecBlock.push_back({ instance.prototypeIndex, nullptr, prototype.name, gp_Trsf(), instance.materialIndex });
+                vecPrototypeWritten.at(instance.prototypeIndex) = true;
+            }
+        }
+    }
+    else {
+        for (const Instance& instance : m_vecInstance)
+            vecBlock.push_back({ instance.prototypeIndex, nullptr, instance.name, instance.trsf, instance.materialIndex });
+    }
+
+    if (vecBlock.empty())
+        return false;
+
+    // Index of the last block referring to each prototype, meshes computed by the writer can be
+    // released once it's written
+    std::vector<int> vecPrototypeLastBlock(m_vecPrototype.size(), -1);
+    for (ObjBlock& block : vecBlock) {
+        const int iBlock = int(&block - &vecBlock.front());
+        vecPrototypeLastBlock.at(block.prototypeIndex) = iBlock;
+        if (block.name.empty())
+            block.name = "part_" + std::to_string(iBlock + 1);
+    }
+
+    // Materials
+    const bool hasMaterials = std::any_of(vecBlock.cbegin(), vecBlock.cend(), [](const ObjBlock& block) {
+        return block.materialIndex >= 0;
+    });
+    const FilePath filepathMtl = FilePath(filepath).replace_extension(".mtl");
+    if (hasMaterials) {
+        QFile fileMtl(filepathTo<QString>(filepathMtl));
+        if (!fileMtl.open(QIODevice::WriteOnly | QIODevice::Truncate))
+            return false;
+
+        std::string strMtl = "# Wavefront MTL file written by Mayo\n";
+        for (const Quantity_Color& color : m_vecColor) {
+            strMtl.append("\nnewmtl ").append(materialName(&color - &m_vecColor.front())).append("\n");
+            strMtl.append("Kd ");
+            appendFloat(&strMtl, color.Red());
+            strMtl.push_back(' ');
+            appendFloat(&strMtl, color.Green());
+            strMtl.push_back(' ');
+            appendFloat(&strMtl, color.Blue());
+            strMtl.push_back('\n');
+        }
+
+        if (fileMtl.write(strMtl.data(), strMtl.size()) != qint64(strMtl.size()))
+            return false;
+    }
+
+    QFile file(filepathTo<QString>(filepath));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    auto fnWrite = [&](std::string_view str) {
+        return file.write(str.data(), str.size()) == qint64(str.size());
+    };
+    std::string strHeader = "# Wavefront OBJ file written by Mayo\n";
+    if (hasMaterials)
+        strHeader.append("mtllib ").append(filepathMtl.filename().u8string()).append("\n");
+
+    if (!fnWrite(strHeader))
+        return false;
+
+    // Prototypes of a window are meshed concurrently(if needed), then its blocks are formatted
+    // concurrently, written in order and released
+    auto fnPreparePrototype = [&](Prototype* prototype) {
+        // Faces not meshed are skipped
+        prototype->parts = StlNative::meshParts(prototype->shape);
+        if (prototype->parts.empty() && this->shapeMesher()) {
+            this->shapeMesher()(prototype->shape, nullptr);
+            prototype->parts = StlNative::meshParts(prototype->shape);
+            prototype->isMeshedByWriter = !prototype->parts.empty();
+        }
+
+        prototype->hasParts = true;
+    };
+
+    const int blockCount = int(vecBlock.size());
+    const int windowSize = 2 * std::max(1, int(std::thread::hardware_concurrency()));
+    std::vector<std::string> vecBlockText(std::min(windowSize, blockCount));
+    std::vector<Prototype*> vecWindowPrototype;
+    int64_t nodeCount = 0;
+    for (int iWindowStart = 0; iWindowStart < blockCount; iWindowStart += windowSize) {
+        const int windowBlockCount = std::min(windowSize, blockCount - iWindowStart);
+        vecWindowPrototype.clear();
+        for (int i = 0; i < windowBlockCount; ++i) {
+            Prototype* prototype = &m_vecPrototype.at(vecBlock.at(iWindowStart + i).prototypeIndex);
+            auto itFound = std::find(vecWindowPrototype.cbegin(), vecWindowPrototype.cend(), prototype);
+            if (!prototype->hasParts && itFound == vecWindowPrototype.cend())
+                vecWindowPrototype.push_back(prototype);
+        }
+
+        TaskManager::runConcurrently(int(vecWindowPrototype.size()), nullptr, [&](int i, TaskProgress*) {
+            fnPreparePrototype(vecWindowPrototype.at(i));
+        });
+
+        // OBJ indices are 32-bit in most readers
+        for (int i = 0; i < windowBlockCount; ++i) {
+            ObjBlock& block = vecBlock.at(iWindowStart + i);
+            block.parts = &m_vecPrototype.at(block.prototypeIndex).parts;
+            block.nodeOffset = nodeCount;
+            for (const StlNative::MeshPart& part : *block.parts)
+                nodeCount += part.triangulation->NbNodes();
+        }
+
+        if (nodeCount > INT_MAX)
+            return false;
+
+        TaskManager::runConcurrently(windowBlockCount, nullptr, [&](int i, TaskProgress*) {
+            const ObjBlock& block = vecBlock.at(iWindowStart + i);
+            if (!block.parts->empty())
+                formatBlock(block, &vecBlockText.at(i));
+        });
+
+        for (int i = 0; i < windowBlockCount; ++i) {
+            if (!fnWrite(vecBlockText.at(i)))
+                return false;
+
+            std::string().swap(vecBlockText.at(i));
+            const ObjBlock& block = vecBlock.at(iWindowStart + i);
+            Prototype& prototype = m_vecPrototype.at(block.prototypeIndex);
+            if (vecPrototypeLastBlock.at(block.prototypeIndex) == iWindowStart + i
+                    && prototype.isMeshedByWriter
+                    && this->releaseMeshes())
+            {
+                prototype.parts.clear();
+                BRepTools::Clean(prototype.shape);
+            }
+        }
+
+        if (TaskProgress::isAbortRequested(progress))
+            return false;
+
+        if (progress)
+            progress->setValue((100 * (iWindowStart + windowBlockCount)) / blockCount);
+    }
+
+    return nodeCount > 0;
+}
+
+std::unique_ptr<PropertyGroup> OccObjWriter::createProperties(PropertyGroup* parentGroup)
+{
+    return std::make_unique<Properties>(parentGroup);
+}
+
+void OccObjWriter::applyProperties(const PropertyGroup* params)
+{
+    auto ptr = dynamic_cast<const Properties*>(params);
+    if (ptr)
+        m_params.writePrototypesOnce = ptr->writePrototypesOnce;
+}
+
+void OccObjWriter::addInstance(
+        int prototypeIndex, const std::string& name, const gp_Trsf& trsf, const Quantity_Color* color)
+{
+    Instance instance;
+    instance.prototypeIndex = prototypeIndex;
+    instance.name = name;
+    instance.trsf = trsf;
+    if (color) {
+        auto itColor = std::find_if(m_vecColor.cbegin(), m_vecColor.cend(), [=](const Quantity_Color& other) {
+            return other.IsEqual(*color);
+        });
+        instance.materialIndex = int(itColor - m_vecColor.cbegin());
+        if (itColor == m_vecColor.cend())
+            m_vecColor.push_back(*color);
+    }
+
+    m_vecInstance.push_back(std::move(instance));
+}
+
+} // namespace IO
+} // namespace Mayo
@@ -0,0 +1,74 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "../base/io_writer.h"
+#include "io_occ_stl_native.h"
+
+#include <Quantity_Color.hxx>
+#include <TopoDS_Shape.hxx>
+#include <gp_Trsf.hxx>
+#include <string>
+#include <vector>
+
+namespace Mayo {
+namespace IO {
+
+// Writer for Wavefront OBJ format, shape colors are written in a companion MTL file
+// XCAF assemblies are walked so each instance of a part is written as an "o" group with its
+// location applied. Vertex/face blocks of the groups are formatted concurrently then written to
+// file in order
+// Parts not meshed yet are meshed window by window with the shape mesher(if any), so export can
+// proceed while meshing and meshes can be released once written
+class OccObjWriter : public Writer {
+public:
+    bool transfer(Span<const ApplicationItem> appItems, TaskProgress* progress) override;
+    bool writeFile(const FilePath& filepath, TaskProgress* progress) override;
+
+    bool supportsShapeMesher() const override { return true; }
+
+    static std::unique_ptr<PropertyGroup> createProperties(PropertyGroup* parentGroup);
+    void applyProperties(const PropertyGroup* params) override;
+
+    // Parameters
+
+    struct Parameters {
+        // Parts having many instances are written once in their own coordinates(locations of
+        // the instances are lost), otherwise each instance is written with its location applied
+        bool writePrototypesOnce = false;
+    };
+    Parameters& parameters() { return m_params; }
+    const Parameters& constParameters() const { return m_params; }
+
+private:
+    // Triangulations of a part(or of a mesh entity), in part coordinates
+    struct Prototype {
+        std::string name;
+        std::vector<StlNative::MeshPart> parts;
+        TopoDS_Shape shape; // Null for mesh entities
+        bool hasParts = false; // True once 'parts' is computed
+        bool isMeshedByWriter = false; // True if triangulations were computed with the shape mesher
+    };
+
+    struct Instance {
+        int prototypeIndex = -1;
+        std::string name;
+        gp_Trsf trsf;
+        int materialIndex = -1; // Index in m_vecColor, -1 if no color
+    };
+
+    void addInstance(int prototypeIndex, const std::string& name, const gp_Trsf& trsf, const Quantity_Color* color);
+
+    class Properties;
+    Parameters m_params;
+    std::vector<Prototype> m_vecPrototype;
+    std::vector<Instance> m_vecInstance;
+    std::vector<Quantity_Color> m_vecColor;
+};
+
+} // namespace IO
+} // namespace Mayo
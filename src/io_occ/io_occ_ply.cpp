@@ -0,0 +1,865 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "io_occ_ply.h"
+
+#include "../base/application_item.h"
+#include "../base/caf_utils.h"
+#include "../base/document.h"
+#include "../base/point_cloud.h"
+#include "../base/property_enumeration.h"
+#include "../base/task_manager.h"
+#include "../base/task_progress.h"
+#include "../base/text_number.h"
+#include "../base/tkernel_utils.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QtEndian>
+#include <TDataStd_Name.hxx>
+#include <TDataXtd_Triangulation.hxx>
+#include <fast_float/fast_float.h>
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace Mayo {
+namespace IO {
+
+namespace {
+
+enum class Encoding { Ascii, BinaryLittleEndian, BinaryBigEndian };
+
+enum class ScalarType { None, Int8, UInt8, Int16, UInt16, Int32, UInt32, Float32, Float64 };
+
+struct PlyProperty {
+    std::string name;
+    ScalarType type = ScalarType::None; // Type of the items in case of list
+    ScalarType listCountType = ScalarType::None;
+
+    bool isList() const { return this->listCountType != ScalarType::None; }
+};
+
+struct PlyElement {
+    std::string name;
+    int64_t count = 0;
+    std::vector<PlyProperty> properties;
+
+    int findProperty(std::string_view name) const;
+    size_t binaryRecordSize() const; // Zero if some property is a list
+};
+
+struct PlyHeader {
+    Encoding encoding = Encoding::Ascii;
+    std::vector<PlyElement> elements;
+    size_t dataOffset = 0; // Position of the first byte following "end_header" line
+
+    const PlyElement* findElement(std::string_view name) const;
+};
+
+ScalarType scalarTypeFromName(std::string_view name)
+{
+    if (name == "char" || name == "int8")
+        return ScalarType::Int8;
+    if (name == "uchar" || name == "uint8")
+        return ScalarType::UInt8;
+    if (name == "short" || name == "int16")
+        return ScalarType::Int16;
+    if (name == "ushort" || name == "uint16")
+        return ScalarType::UInt16;
+    if (name == "int" || name == "int32")
+        return ScalarType::Int32;
+    if (name == "uint" || name == "uint32")
+        return ScalarType::UInt32;
+    if (name == "float" || name == "float32")
+        return ScalarType::Float32;
+    if (name == "double" || name == "float64")
+        return ScalarType::Float64;
+
+    return ScalarType::None;
+}
+
+size_t scalarSize(ScalarType type)
+{
+    switch (type) {
+    case ScalarType::None: return 0;
+    case ScalarType::Int8:
+    case ScalarType::UInt8: return 1;
+    case ScalarType::Int16:
+    case ScalarType::UInt16: return 2;
+    case ScalarType::Int32:
+    case ScalarType::UInt32:
+    case ScalarType::Float32: return 4;
+    case ScalarType::Float64: return 8;
+    }
+
+    return 0;
+}
+
+int PlyElement::findProperty(std::string_view name) const
+{
+    auto it = std::find_if(this->properties.cbegin(), this->properties.cend(), [=](const PlyProperty& prop) {
+        return prop.name == name;
+    });
+    return it != this->properties.cend() ? int(it - this->properties.cbegin()) : -1;
+}
+
+size_t PlyElement::binaryRecordSize() const
+{
+    size_t size = 0;
+    for (const PlyProperty& prop : this->properties) {
+        if (prop.isList())
+            return 0;
+
+        size += scalarSize(prop.type);
+    }
+
+    return size;
+}
+
+const PlyElement* PlyHeader::findElement(std::string_view name) const
+{
+    auto it = std::find_if(this->elements.cbegin(), this->elements.cend(), [=](const PlyElement& element) {
+        return element.name == name;
+    });
+    return it != this->elements.cend() ? &(*it) : nullptr;
+}
+
+bool parsePlyHeader(Span<const uint8_t> data, PlyHeader* header)
+{
+    const std::string_view contents(reinterpret_cast<const char*>(data.data()), data.size());
+    constexpr std::string_view endHeaderToken = "\nend_header";
+    const size_t posEndHeader = contents.find(endHeaderToken);
+    if (contents.substr(0, 3) != "ply" || posEndHeader == std::string_view::npos)
+        return false;
+
+    const size_t posEndHeaderLine = contents.find('\n', posEndHeader + endHeaderToken.size());
+    if (posEndHeaderLine == std::string_view::npos)
+        return false;
+
+    header->dataOffset = posEndHeaderLine + 1;
+    bool hasFormat = false;
+    std::istringstream stream(std::string(contents.substr(0, posEndHeader)));
+    std::string line;
+    while (std::getline(stream, line)) {
+        std::istringstream lineStream(line);
+        std::string keyword;
+        lineStream >> keyword;
+        if (keyword == "format") {
+            std::string strEncoding;
+            lineStream >> strEncoding;
+            if (strEncoding == "ascii")
+                header->encoding = Encoding::Ascii;
+            else if (strEncoding == "binary_little_endian")
+                header->encoding = Encoding::BinaryLittleEndian;
+            else if (strEncoding == "binary_big_endian")
+                header->encoding = Encoding::BinaryBigEndian;
+            else
+                return false;
+
+            hasFormat = true;
+        }
+        else if (keyword == "element") {
+            PlyElement element;
+            lineStream >> element.name >> element.count;
+            if (lineStream.fail() || element.count < 0)
+                return false;
+
+            header->elements.push_back(std::move(element));
+        }
+        else if (keyword == "property") {
+            if (header->elements.empty())
+                return false;
+
+            PlyProperty prop;
+            std::string strType;
+            lineStream >> strType;
+            if (strType == "list") {
+                std::string strCountType;
+                std::string strItemType;
+                lineStream >> strCountType >> strItemType;
+                prop.listCountType = scalarTypeFromName(strCountType);
+                prop.type = scalarTypeFromName(strItemType);
+                if (prop.listCountType == ScalarType::None)
+                    return false;
+            }
+            else {
+                prop.type = scalarTypeFromName(strType);
+            }
+
+            lineStream >> prop.name;
+            if (prop.type == ScalarType::None || lineStream.fail())
+                return false;
+
+            header->elements.back().properties.push_back(std::move(prop));
+        }
+
+        // Other keywords("comment", "obj_info", ...) are ignored
+    }
+
+    return hasFormat;
+}
+
+double binaryScalar(const uint8_t* bytes, ScalarType type, bool isBigEndian)
+{
+    auto fnLoad = [=](auto zero) {
+        using T = decltype(zero);
+        return isBigEndian ? qFromBigEndian<T>(bytes) : qFromLittleEndian<T>(bytes);
+    };
+
+    switch (type) {
+    case ScalarType::None: return 0.;
+    case ScalarType::Int8: return int8_t(bytes[0]);
+    case ScalarType::UInt8: return bytes[0];
+    case ScalarType::Int16: return fnLoad(qint16());
+    case ScalarType::UInt16: return fnLoad(quint16());
+    case ScalarType::Int32: return fnLoad(qint32());
+    case ScalarType::UInt32: return fnLoad(quint32());
+    case ScalarType::Float32: {
+        const quint32 bits = fnLoad(quint32());
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+    case ScalarType::Float64: {
+        const quint64 bits = fnLoad(quint64());
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+    }
+
+    return 0.;
+}
+
+bool isAsciiSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+// Sequential reading of property values, ASCII contents being a stream of whitespace-separated values
+class PlyValueReader {
+public:
+    PlyValueReader(Encoding encoding, const uint8_t* begin, const uint8_t* end)
+        : m_encoding(encoding), m_ptr(begin), m_end(end)
+    {}
+
+    bool read(ScalarType type, double* value) {
+        if (m_encoding == Encoding::Ascii)
+            return this->readAscii(value);
+
+        const size_t size = scalarSize(type);
+        if (size_t(m_end - m_ptr) < size)
+            return false;
+
+        *value = binaryScalar(m_ptr, type, m_encoding == Encoding::BinaryBigEndian);
+        m_ptr += size;
+        return true;
+    }
+
+    const uint8_t* position() const { return m_ptr; }
+
+private:
+    bool readAscii(double* value) {
+        auto ptr = reinterpret_cast<const char*>(m_ptr);
+        auto end = reinterpret_cast<const char*>(m_end);
+        while (ptr < end && isAsciiSpace(*ptr))
+            ++ptr;
+
+        if (ptr < end && *ptr == '+') // Not accepted by from_chars()
+            ++ptr;
+
+        const fast_float::from_chars_result res = fast_float::from_chars(ptr, end, *value);
+        if (res.ec != std::errc())
+            return false;
+
+        m_ptr = reinterpret_cast<const uint8_t*>(res.ptr);
+        return true;
+    }
+
+    Encoding m_encoding;
+    const uint8_t* m_ptr;
+    const uint8_t* m_end;
+};
+
+void setNode(Poly_Triangulation* mesh, int index, const gp_Pnt& pnt)
+{
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+    mesh->SetNode(index, pnt);
+#else
+    mesh->ChangeNode(index) = pnt;
+#endif
+}
+
+void setTriangle(Poly_Triangulation* mesh, int index, const Poly_Triangle& triangle)
+{
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+    mesh->SetTriangle(index, triangle);
+#else
+    mesh->ChangeTriangle(index) = triangle;
+#endif
+}
+
+int concurrentTaskCount(int64_t itemCount)
+{
+    const int threadCount = std::max(1, int(std::thread::hardware_concurrency()));
+    return int(std::max<int64_t>(1, std::min<int64_t>(itemCount, threadCount)));
+}
+
+// Reads sequentially the records of 'element' starting at 'ptr' and calls fn(scalars, listItems)
+// for each one. Scalar property values are stored at property index in 'scalars', 'listItems' holds
+// the items of list property at 'iListProperty', other lists are skipped
+// Returns the position following the last record, or nullptr in case of error or abort
+template<typename FN>
+const uint8_t* readPlyRecords(
+        const PlyHeader& header,
+        const PlyElement& element,
+        int iListProperty,
+        const uint8_t* ptr,
+        const uint8_t* end,
+        TaskProgress* progress,
+        const FN& fn)
+{
+    PlyValueReader reader(header.encoding, ptr, end);
+    std::vector<double> scalars(element.properties.size(), 0.);
+    std::vector<double> listItems;
+    const size_t count = size_t(element.count);
+    for (size_t i = 0; i < count; ++i) {
+        if (!TaskProgress::checkLoopProgress(progress, i, 0, count))
+            return nullptr;
+
+        for (size_t iProp = 0; iProp < element.properties.size(); ++iProp) {
+            const PlyProperty& prop = element.properties.at(iProp);
+            if (!prop.isList()) {
+                if (!reader.read(prop.type, &scalars.at(iProp)))
+                    return nullptr;
+
+                continue;
+            }
+
+            double value = 0.;
+            if (!reader.read(prop.listCountType, &value) || value < 0)
+                return nullptr;
+
+            const bool isListStored = int(iProp) == iListProperty;
+            if (isListStored)
+                listItems.clear();
+
+            for (int64_t j = 0; j < int64_t(value); ++j) {
+                double item = 0.;
+                if (!reader.read(prop.type, &item))
+                    return nullptr;
+
+                if (isListStored)
+                    listItems.push_back(item);
+            }
+        }
+
+        if (!fn(scalars, listItems))
+            return nullptr;
+    }
+
+    return reader.position();
+}
+
+// Decodes concurrently binary face records with the assumption that all faces are triangles, so
+// records have a fixed size. Checking the vertex count of each record is then enough to validate
+// the assumption: by induction record 'i' starts at 'i * recordSize'
+// Returns the position following the last record, or nullptr if assumption doesn't hold, some
+// vertex index is invalid or abort was requested
+const uint8_t* readPlyBinaryTriangleRecords(
+        const PlyHeader& header,
+        const PlyElement& element,
+        int iListProperty,
+        const uint8_t* records,
+        size_t recordsMaxSize,
+        int nodeCount,
+        std::vector<Poly_Triangle>* ptrVecTriangle,
+        TaskProgress* progress)
+{
+    size_t listOffset = 0;
+    size_t recordSize = 0;
+    for (size_t iProp = 0; iProp < element.properties.size(); ++iProp) {
+        const PlyProperty& prop = element.properties.at(iProp);
+        if (int(iProp) == iListProperty) {
+            listOffset = recordSize;
+            recordSize += scalarSize(prop.listCountType) + 3 * scalarSize(prop.type);
+        }
+        else if (prop.isList()) {
+            return nullptr;
+        }
+        else {
+            recordSize += scalarSize(prop.type);
+        }
+    }
+
+    const size_t count = size_t(element.count);
+    if (recordsMaxSize / recordSize < count)
+        return nullptr;
+
+    const PlyProperty& listProp = element.properties.at(iListProperty);
+    const size_t countSize = scalarSize(listProp.listCountType);
+    const size_t itemSize = scalarSize(listProp.type);
+    const bool isBigEndian = header.encoding == Encoding::BinaryBigEndian;
+    std::vector<Poly_Triangle>& vecTriangle = *ptrVecTriangle;
+    vecTriangle.resize(count);
+    std::atomic<bool> isValid = true;
+    const int taskCount = concurrentTaskCount(element.count);
+    const bool ok = TaskManager::runConcurrently(taskCount, progress, [&](int iTask, TaskProgress* taskProgress) {
+        const size_t first = (iTask * count) / taskCount;
+        const size_t last = ((iTask + 1) * count) / taskCount;
+        for (size_t i = first; i < last && isValid; ++i) {
+            if (!TaskProgress::checkLoopProgress(taskProgress, i, first, last))
+                return;
+
+            const uint8_t* list = records + i * recordSize + listOffset;
+            if (binaryScalar(list, listProp.listCountType, isBigEndian) != 3) {
+                isValid = false;
+                return;
+            }
+
+            int nodes[3];
+            for (int j = 0; j < 3; ++j) {
+                const double index = binaryScalar(list + countSize + j * itemSize, listProp.type, isBigEndian);
+                if (index < 0 || index >= nodeCount) {
+                    isValid = false;
+                    return;
+                }
+
+                nodes[j] = int(index) + 1; // Poly_Triangulation indices are 1-based
+            }
+
+            vecTriangle[i] = Poly_Triangle(nodes[0], nodes[1], nodes[2]);
+        }
+    });
+
+    return ok && isValid ? records + count * recordSize : nullptr;
+}
+
+// Decodes concurrently binary vertex records having a fixed size
+bool readPlyBinaryVertexRecords(
+        const PlyHeader& header,
+        const PlyElement& element,
+        const uint8_t* records,
+        Poly_Triangulation* mesh,
+        TaskProgress* progress)
+{
+    const int iPropCoords[] = { element.findProperty("x"), element.findProperty("y"), element.findProperty("z") };
+    size_t offsetCoords[3] = {};
+    ScalarType typeCoords[3] = {};
+    for (int i = 0; i < 3; ++i) {
+        for (int iProp = 0; iProp < iPropCoords[i]; ++iProp)
+            offsetCoords[i] += scalarSize(element.properties.at(iProp).type);
+
+        typeCoords[i] = element.properties.at(iPropCoords[i]).type;
+    }
+
+    const size_t recordSize = element.binaryRecordSize();
+    const size_t count = size_t(element.count);
+    const bool isBigEndian = header.encoding == Encoding::BinaryBigEndian;
+    const int taskCount = concurrentTaskCount(element.count);
+    return TaskManager::runConcurrently(taskCount, progress, [&](int iTask, TaskProgress* taskProgress) {
+        const size_t first = (iTask * count) / taskCount;
+        const size_t last = ((iTask + 1) * count) / taskCount;
+        for (size_t i = first; i < last; ++i) {
+            if (!TaskProgress::checkLoopProgress(taskProgress, i, first, last))
+                return;
+
+            const uint8_t* record = records + i * recordSize;
+            const gp_Pnt pnt(
+                        binaryScalar(record + offsetCoords[0], typeCoords[0], isBigEndian),
+                        binaryScalar(record + offsetCoords[1], typeCoords[1], isBigEndian),
+                        binaryScalar(record + offsetCoords[2], typeCoords[2], isBigEndian));
+            setNode(mesh, int(i + 1), pnt);
+        }
+    });
+}
+
+// Appends the triangles of polygon 'indices'(0-based) as a fan
+// Returns false if some index is out of range
+bool addPlyFaceTriangles(const std::vector<double>& indices, int nodeCount, std::vector<Poly_Triangle>* ptrVecTriangle)
+{
+    for (double index : indices) {
+        if (index < 0 || index >= nodeCount)
+            return false;
+    }
+
+    for (size_t i = 2; i < indices.size(); ++i)
+        ptrVecTriangle->emplace_back(int(indices[0]) + 1, int(indices[i - 1]) + 1, int(indices[i]) + 1);
+
+    return true;
+}
+
+Handle_Poly_Triangulation readPly(Span<const uint8_t> data, TaskProgress* progress)
+{
+    PlyHeader header;
+    if (!parsePlyHeader(data, &header))
+        return {};
+
+    const PlyElement* vertexElement = header.findElement("vertex");
+    if (!vertexElement || vertexElement->count == 0 || vertexElement->count > INT_MAX)
+        return {};
+
+    const int ix = vertexElement->findProperty("x");
+    const int iy = vertexElement->findProperty("y");
+    const int iz = vertexElement->findProperty("z");
+    if (ix < 0 || iy < 0 || iz < 0)
+        return {};
+
+    const int nodeCount = int(vertexElement->count);
+    const bool isBinary = header.encoding != Encoding::Ascii;
+    const uint8_t* ptr = data.data() + std::min(header.dataOffset, data.size());
+    const uint8_t* end = data.data() + data.size();
+    const uint8_t* vertexRecords = nullptr; // Fixed-size binary records, decoded once mesh is allocated
+    std::vector<gp_Pnt> vecNode; // Vertices read sequentially
+    std::vector<Poly_Triangle> vecTriangle;
+    TaskProgress elementsProgress(progress, 60);
+    for (const PlyElement& element : header.elements) {
+        TaskProgress elementProgress(&elementsProgress, 100. / header.elements.size());
+        const size_t recordSize = isBinary ? element.binaryRecordSize() : 0;
+        if (&element == vertexElement && recordSize > 0) {
+            if (size_t(end - ptr) / recordSize < size_t(element.count))
+                return {};
+
+            vertexRecords = ptr;
+            ptr += recordSize * size_t(element.count);
+        }
+        else if (&element == vertexElement) {
+            vecNode.reserve(nodeCount);
+            ptr = readPlyRecords(header, element, -1, ptr, end, &elementProgress, [&](const std::vector<double>& values, const auto&) {
+                vecNode.emplace_back(values.at(ix), values.at(iy), values.at(iz));
+                return true;
+            });
+        }
+        else if (element.name == "face") {
+            int iListProperty = element.findProperty("vertex_indices");
+            if (iListProperty < 0)
+                iListProperty = element.findProperty("vertex_index");
+
+            if (iListProperty < 0 || !element.properties.at(iListProperty).isList())
+                return {};
+
+            const uint8_t* ptrFacesEnd =
+                    isBinary ?
+                        readPlyBinaryTriangleRecords(
+                            header, element, iListProperty, ptr, end - ptr, nodeCount, &vecTriangle, &elementProgress) :
+                        nullptr;
+            if (TaskProgress::isAbortRequested(&elementProgress))
+                return {};
+
+            if (ptrFacesEnd) {
+                ptr = ptrFacesEnd;
+            }
+            else {
+                // Some faces aren't triangles, fallback on sequential reading
+                vecTriangle.clear();
+                vecTriangle.reserve(size_t(element.count));
+                ptr = readPlyRecords(header, element, iListProperty, ptr, end, &elementProgress, [&](const auto&, const std::vector<double>& indices) {
+                    return addPlyFaceTriangles(indices, nodeCount, &vecTriangle);
+                });
+            }
+        }
+        else if (recordSize > 0) {
+            if (size_t(end - ptr) / recordSize < size_t(element.count))
+                return {};
+
+            ptr += recordSize * size_t(element.count);
+        }
+        else {
+            ptr = readPlyRecords(header, element, -1, ptr, end, &elementProgress, [](const auto&, const auto&) {
+                return true;
+            });
+        }
+
+        if (!ptr)
+            return {};
+    }
+
+    if (!vertexRecords && vecNode.size() != size_t(nodeCount))
+        return {};
+
+    if (vecTriangle.size() > size_t(INT_MAX))
+        return {};
+
+#if OCC_VERSION_HEX < OCC_VERSION_CHECK(7, 6, 0)
+    // Poly_Triangulation can't be created with an empty array of triangles
+    if (vecTriangle.empty())
+        return {};
+#endif
+
+    Handle_Poly_Triangulation mesh = new Poly_Triangulation(nodeCount, int(vecTriangle.size()), false);
+    {
+        TaskProgress nodeProgress(progress, 30);
+        if (vertexRecords) {
+            if (!readPlyBinaryVertexRecords(header, *vertexElement, vertexRecords, mesh.get(), &nodeProgress))
+                return {};
+        }
+        else {
+            for (int i = 0; i < nodeCount; ++i)
+                setNode(mesh.get(), i + 1, vecNode.at(i));
+
+            std::vector<gp_Pnt>().swap(vecNode); // Release memory early
+        }
+    }
+
+    {
+        TaskProgress triangleProgress(progress, 10);
+        for (size_t i = 0; i < vecTriangle.size(); ++i) {
+            if (!TaskProgress::checkLoopProgress(&triangleProgress, i, 0, vecTriangle.size()))
+                return {};
+
+            setTriangle(mesh.get(), int(i + 1), vecTriangle.at(i));
+        }
+    }
+
+    return mesh;
+}
+
+} // namespace
+
+class OccPlyWriter::Properties : public PropertyGroup {
+    MAYO_DECLARE_TEXT_ID_FUNCTIONS(Mayo::IO::OccPlyWriter::Properties)
+public:
+    Properties(PropertyGroup* parentGroup)
+        : PropertyGroup(parentGroup)
+    {
+        this->targetFormat.mutableEnumeration().changeTrContext(this->textIdContext());
+    }
+
+    void restoreDefaults() override {
+        const OccPlyWriter::Parameters params;
+        this->targetFormat.setValue(params.format);
+    }
+
+    PropertyEnum<OccPlyWriter::Format> targetFormat{ this, textId("targetFormat") };
+};
+
+bool OccPlyReader::readFile(const FilePath& filepath, TaskProgress* progress)
+{
+    m_baseFilename = filepath.stem();
+    m_mesh.Nullify();
+    QFile file(filepathTo<QString>(filepath));
+    const uchar* fileData = file.open(QIODevice::ReadOnly) ? file.map(0, file.size()) : nullptr;
+    if (!fileData)
+        return false;
+
+    m_mesh = readPly(Span<const uint8_t>(fileData, size_t(file.size())), progress);
+    return !m_mesh.IsNull();
+}
+
+TDF_LabelSequence OccPlyReader::transfer(DocumentPtr doc, TaskProgress* progress)
+{
+    if (m_mesh.IsNull())
+        return {};
+
+    PointCloudPtr pointCloud;
+    if (m_mesh->NbTriangles() == 0) {
+        std::vector<PointCloud::Point> vecPoint;
+        vecPoint.reserve(size_t(m_mesh->NbNodes()));
+        for (int i = 1; i <= m_mesh->NbNodes(); ++i) {
+            const gp_Pnt pnt = m_mesh->Node(i);
+            vecPoint.emplace_back(float(pnt.X()), float(pnt.Y()), float(pnt.Z()));
+        }
+
+        m_mesh.Nullify(); // Release memory early
+        pointCloud = PointCloud::build(std::move(vecPoint), {}, progress);
+        if (pointCloud.IsNull())
+            return {};
+    }
+
+    const TDF_Label entityLabel = doc->newEntityLabel();
+    if (pointCloud)
+        PointCloudAttribute::Set(entityLabel, pointCloud);
+    else
+        TDataXtd_Triangulation::Set(entityLabel, m_mesh);
+
+    TDataStd_Name::Set(entityLabel, filepathTo<TCollection_ExtendedString>(m_baseFilename));
+    return CafUtils::makeLabelSequence({ entityLabel });
+}
+
+bool OccPlyWriter::transfer(Span<const ApplicationItem> appItems, TaskProgress* /*progress*/)
+{
+    m_vecPart.clear();
+    auto fnAddShapeParts = [&](const TopoDS_Shape& shape) {
+        for (StlNative::MeshPart& part : StlNative::meshParts(shape)) // Faces not meshed are skipped
+            m_vecPart.push_back(std::move(part));
+    };
+
+    for (const ApplicationItem& item : appItems) {
+        if (item.isDocument()) {
+            for (const TDF_Label& label : item.document()->xcaf().topLevelFreeShapes())
+                fnAddShapeParts(XCaf::shape(label));
+        }
+        else if (item.isDocumentTreeNode()) {
+            const TDF_Label label = item.documentTreeNode().label();
+            if (XCaf::isShape(label)) {
+                fnAddShapeParts(XCaf::shape(label));
+            }
+            else {
+                auto attrPolyTri = CafUtils::findAttribute<TDataXtd_Triangulation>(label);
+                if (!attrPolyTri.IsNull() && !attrPolyTri->Get().IsNull())
+                    m_vecPart.push_back({ attrPolyTri->Get(), gp_Trsf(), false });
+            }
+        }
+    }
+
+    return !m_vecPart.empty();
+}
+
+bool OccPlyWriter::writeFile(const FilePath& filepath, TaskProgress* progress)
+{
+    size_t nodeCount = 0;
+    size_t triangleCount = 0;
+    for (const StlNative::MeshPart& part : m_vecPart) {
+        nodeCount += part.triangulation->NbNodes();
+        triangleCount += part.triangulation->NbTriangles();
+    }
+
+    if (nodeCount == 0 || nodeCount > size_t(INT_MAX))
+        return false;
+
+    QFile file(filepathTo<QString>(filepath));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    // Buffered writing, data is flushed into file by blocks
+    constexpr size_t bufferCapacity = 4 * 1024 * 1024;
+    std::vector<char> buffer;
+    buffer.reserve(bufferCapacity);
+    bool ok = true;
+    auto fnFlush = [&]{
+        ok = ok && file.write(buffer.data(), buffer.size()) == qint64(buffer.size());
+        buffer.clear();
+        return ok;
+    };
+    auto fnAppend = [&](const void* bytes, size_t size) {
+        if (buffer.size() + size > bufferCapacity)
+            fnFlush();
+
+        const auto chars = static_cast<const char*>(bytes);
+        buffer.insert(buffer.end(), chars, chars + size);
+    };
+    auto fnAppendText = [&](std::string_view str) { fnAppend(str.data(), str.size()); };
+
+    const bool isBinary = m_params.format == Format::BinaryLittleEndian;
+    fnAppendText("ply\n");
+    fnAppendText(isBinary ? "format binary_little_endian 1.0\n" : "format ascii 1.0\n");
+    fnAppendText("element vertex " + std::to_string(nodeCount) + "\n");
+    fnAppendText("property float x\nproperty float y\nproperty float z\n");
+    if (triangleCount > 0) {
+        fnAppendText("element face " + std::to_string(triangleCount) + "\n");
+        fnAppendText("property list uchar int vertex_indices\n");
+    }
+
+    fnAppendText("end_header\n");
+
+    auto fnAppendFloat = [&](double value) {
+        const float fValue = float(value);
+        quint32 bits;
+        std::memcpy(&bits, &fValue, sizeof(bits));
+        bits = qToLittleEndian(bits);
+        fnAppend(&bits, sizeof(bits));
+    };
+    auto fnAppendInt = [&](int value) {
+        const qint32 leValue = qToLittleEndian(qint32(value));
+        fnAppend(&leValue, sizeof(leValue));
+    };
+
+    const size_t itemCount = nodeCount + triangleCount;
+    size_t itemsWritten = 0;
+    auto fnPartProgress = [&](size_t partItemCount) {
+        itemsWritten += partItemCount;
+        if (progress)
+            progress->setValue(int((100 * itemsWritten) / itemCount));
+        return !TaskProgress::isAbortRequested(progress);
+    };
+
+    char line[128];
+    std::string lineText;
+
+    // Vertices
+    for (const StlNative::MeshPart& part : m_vecPart) {
+        const Handle_Poly_Triangulation& mesh = part.triangulation;
+        for (int i = 1; i <= mesh->NbNodes(); ++i) {
+            const gp_Pnt pnt = mesh->Node(i).Transformed(part.trsf);
+            if (isBinary) {
+                fnAppendFloat(pnt.X());
+                fnAppendFloat(pnt.Y());
+                fnAppendFloat(pnt.Z());
+            }
+            else {
+                // Decimal separator must not depend on the C locale, so no snprintf()
+                lineText.clear();
+                for (double value : { pnt.X(), pnt.Y(), pnt.Z() }) {
+                    if (!lineText.empty())
+                        lineText += ' ';
+
+                    TextNumber::append(&lineText, value, TextNumber::Format::General, 9);
+                }
+
+                lineText += '\n';
+                fnAppendText(lineText);
+            }
+        }
+
+        if (!fnPartProgress(mesh->NbNodes()))
+            return false;
+    }
+
+    // Faces, node indices are offset so they refer to the merged "vertex" element
+    int nodeOffset = 0;
+    for (const StlNative::MeshPart& part : m_vecPart) {
+        const Handle_Poly_Triangulation& mesh = part.triangulation;
+        for (int i = 1; i <= mesh->NbTriangles(); ++i) {
+            int n1, n2, n3;
+            mesh->Triangle(i).Get(n1, n2, n3);
+            if (part.isReversed)
+                std::swap(n2, n3);
+
+            n1 += nodeOffset - 1;
+            n2 += nodeOffset - 1;
+            n3 += nodeOffset - 1;
+            if (isBinary) {
+                const uint8_t vertexCount = 3;
+                fnAppend(&vertexCount, sizeof(vertexCount));
+                fnAppendInt(n1);
+                fnAppendInt(n2);
+                fnAppendInt(n3);
+            }
+            else {
+                const int len = std::snprintf(line, sizeof(line), "3 %d %d %d\n", n1, n2, n3);
+                fnAppend(line, std::min<size_t>(len, sizeof(line) - 1));
+            }
+        }
+
+        nodeOffset += mesh->NbNodes();
+        if (!fnPartProgress(mesh->NbTriangles()))
+            return false;
+    }
+
+    return fnFlush();
+}
+
+std::unique_ptr<PropertyGroup> OccPlyWriter::createProperties(PropertyGroup* parentGroup)
+{
+    return std::make_unique<Properties>(parentGroup);
+}
+
+void OccPlyWriter::applyProperties(const PropertyGroup* params)
+{
+    auto ptr = dynamic_cast<const Properties*>(params);
+    if (ptr)
+        m_params.format = ptr->targetFormat;
+}
+
+} // namespace IO
+} // namespace Mayo
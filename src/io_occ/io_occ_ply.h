@@ -0,0 +1,58 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "../base/io_reader.h"
+#include "../base/io_writer.h"
+#include "io_occ_stl_native.h"
+#include <Poly_Triangulation.hxx>
+#include <vector>
+
+namespace Mayo {
+namespace IO {
+
+// Reader for PLY(Polygon File Format) files
+// Files are memory-mapped, binary vertex records having a fixed size are decoded concurrently.
+// Faces are triangulated as fans, only coordinates and vertex indices are loaded
+// Files without faces are loaded as point cloud entities(see PointCloudAttribute)
+class OccPlyReader : public Reader {
+public:
+    bool readFile(const FilePath& filepath, TaskProgress* progress) override;
+    TDF_LabelSequence transfer(DocumentPtr doc, TaskProgress* progress) override;
+
+private:
+    Handle_Poly_Triangulation m_mesh;
+    FilePath m_baseFilename;
+};
+
+// Writer for PLY(Polygon File Format) files
+// Triangulations are merged into single "vertex" and "face" elements, locations being applied
+class OccPlyWriter : public Writer {
+public:
+    bool transfer(Span<const ApplicationItem> appItems, TaskProgress* progress) override;
+    bool writeFile(const FilePath& filepath, TaskProgress* progress) override;
+
+    static std::unique_ptr<PropertyGroup> createProperties(PropertyGroup* parentGroup);
+    void applyProperties(const PropertyGroup* params) override;
+
+    // Parameters
+    enum class Format { Ascii, BinaryLittleEndian };
+
+    struct Parameters {
+        Format format = Format::BinaryLittleEndian;
+    };
+    Parameters& parameters() { return m_params; }
+    const Parameters& constParameters() const { return m_params; }
+
+private:
+    class Properties;
+    Parameters m_params;
+    std::vector<StlNative::MeshPart> m_vecPart;
+};
+
+} // namespace IO
+} // namespace Mayo
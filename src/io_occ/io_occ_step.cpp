@@ -8,16 +8,37 @@
 #include "io_occ_caf.h"
 #include "../base/occ_static_variables_rollback.h"
 #include "../base/property_builtins.h"
+#include "../base/document.h"
+#include "../base/io_file_source.h"
+#include "../base/io_progress_stream.h"
+#include "../base/io_remote_file.h"
+#include "../base/occ_progress_indicator.h"
+#include "../base/profiler.h"
 #include "../base/property_enumeration.h"
 #include "../base/string_conv.h"
+#include "../base/task_manager.h"
 #include "../base/task_progress.h"
 #include "../base/tkernel_utils.h"
 #include "../base/enumeration_fromenum.h"
+#include "../base/xcaf.h"
 
 #include <APIHeaderSection_MakeHeader.hxx>
 #include <Interface_Static.hxx>
 #include <Interface_Version.hxx>
 #include <STEPCAFControl_Controller.hxx>
+#include <STEPControl_Reader.hxx>
+#include <StepData_Protocol.hxx>
+#include <StepData_StepModel.hxx>
+#include <StepData_StepWriter.hxx>
+#include <StepData_WriterLib.hxx>
+#include <XSControl_TransferReader.hxx>
+#include <XSControl_WorkSession.hxx>
+#include <filesystem>
+#include <fstream>
+#include <istream>
+#include <memory>
+#include <streambuf>
+#include <thread>
 
 namespace Mayo {
 namespace IO {
@@ -42,6 +63,18 @@ public:
                              "case if a STEP file contains more than one representation (i.e. multiple "
                              "`PRODUCT_DEFINITION_SHAPE` entities) for a single product"));
 
+        this->readTessellated.setDescription(
+                    textIdTr("Specifies whether tessellated geometry(AP242 `TESSELLATED_SHAPE_REPRESENTATION`) "
+                             "is read as triangulations. Faces translated this way have no surface and "
+                             "aren't meshed again. Requires OpenCascade >= v7.6.0"));
+        this->readTessellated.setDescriptions({
+                    { TessellatedGeometry::Off, textIdTr("Tessellated geometry is ignored") },
+                    { TessellatedGeometry::On, textIdTr("Tessellated geometry is read along with "
+                      "the BRep representations") },
+                    { TessellatedGeometry::OnNoBRep, textIdTr("Tessellated geometry is read only "
+                      "for products having no BRep representation") }
+        });
+
         this->readShapeAspect.setDescription(
                     textIdTr("Defines whether shapes associated with the `PRODUCT_DEFINITION_SHAPE` entity "
                              "of the product via `SHAPE_ASPECT` should be translated.\n"
@@ -56,6 +89,29 @@ public:
                     textIdTr("Indicates whether to read sub-shape names from 'Name' attributes of "
                              "STEP Representation Items"));
 
+        this->parallelRootTransfer.setDescription(
+                    textIdTr("Translate the root entities of the STEP file in independent batches "
+                             "running concurrently, then merge the results into the document.\n"
+                             "This mainly benefits files having many top-level products. "
+                             "Requires OpenCascade >= v7.6.0"));
+
+        this->readStructureOnly.setDescription(
+                    textIdTr("Translate only the product structure and names, without shape "
+                             "geometry nor attributes like colors and layers.\n"
+                             "This is much faster than a complete read, suitable for indexing files. "
+                             "If activated then option `%1` is ignored").arg(this->assemblyLevel.label()));
+
+        this->deferShapeLoading.setDescription(
+                    textIdTr("Translate only the product structure and names, the shape of a part is "
+                             "then loaded on demand(when shown, expanded in the model tree or exported).\n"
+                             "This allows to quickly open a big assembly and inspect some parts only. "
+                             "Colors and layers are not read. "
+                             "If activated then option `%1` is ignored").arg(this->assemblyLevel.label()));
+
+        this->healShapes.setDescription(
+                    textIdTr("Fix the imported shapes(gaps in wires of faces, shells orientation, ...) "
+                             "before they are meshed. Parts are healed concurrently"));
+
         this->productContext.setDescriptions({
                     { ProductContext::Design, textIdTr("Translate only products that have "
                       "`PRODUCT_DEFINITION_CONTEXT` with field `life_cycle_stage` set to `design`")
@@ -101,17 +157,55 @@ public:
         this->productContext.setValue(params.productContext);
         this->assemblyLevel.setValue(params.assemblyLevel);
         this->preferredShapeRepresentation.setValue(params.preferredShapeRepresentation);
+        this->readTessellated.setValue(params.readTessellated);
         this->readShapeAspect.setValue(params.readShapeAspect);
         this->readSubShapesNames.setValue(params.readSubShapesNames);
         this->encoding.setValue(params.encoding);
+        this->parallelRootTransfer.setValue(params.parallelRootTransfer);
+        this->readStructureOnly.setValue(params.readStructureOnly);
+        this->deferShapeLoading.setValue(params.deferShapeLoading);
+        this->healShapes.setValue(params.healShapes);
+        this->assemblyLevel.setEnabled(!this->readStructureOnly && !this->deferShapeLoading);
+    }
+
+    void onPropertyChanged(Property* prop) override
+    {
+        if (prop == &this->readStructureOnly || prop == &this->deferShapeLoading)
+            this->assemblyLevel.setEnabled(!this->readStructureOnly && !this->deferShapeLoading);
+
+        PropertyGroup::onPropertyChanged(prop);
     }
 
     PropertyEnum<ProductContext> productContext{ this, textId("productContext") };
     PropertyEnum<AssemblyLevel> assemblyLevel{ this, textId("assemblyLevel") };
     PropertyEnum<ShapeRepresentation> preferredShapeRepresentation{ this, textId("preferredShapeRepresentation") };
+    PropertyEnum<TessellatedGeometry> readTessellated{ this, textId("readTessellated") };
     PropertyBool readShapeAspect{ this, textId("readShapeAspect") };
     PropertyBool readSubShapesNames{ this, textId("readSubShapesNames") };
     PropertyEnum<Encoding> encoding{ this, textId("encoding") };
+    PropertyBool parallelRootTransfer{ this, textId("parallelRootTransfer") };
+    PropertyBool readStructureOnly{ this, textId("readStructureOnly") };
+    PropertyBool deferShapeLoading{ this, textId("deferShapeLoading") };
+    PropertyBool healShapes{ this, textId("healShapes") };
+};
+
+namespace {
+
+// Read-only stream buffer over contents held in memory, no copy
+class MemoryStreamBuffer : public std::streambuf {
+public:
+    MemoryStreamBuffer(Span<const uint8_t> data) {
+        char* begin = reinterpret_cast<char*>(const_cast<uint8_t*>(data.data()));
+        this->setg(begin, begin, begin + data.size());
+    }
+};
+
+} // namespace
+
+// Keeps alive the parsed STEP model, shared by all the deferred shapes of a read
+struct OccStepReader::DeferredShapeSource {
+    Handle_Interface_InterfaceModel model;
+    OccStepReader::Parameters params;
 };
 
 OccStepReader::OccStepReader()
@@ -135,18 +229,115 @@ OccStepReader::~OccStepReader()
 
 bool OccStepReader::readFile(const FilePath& filepath, TaskProgress* progress)
 {
+    MAYO_PROFILE_ZONE("OccStepReader::readFile");
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+    // STEPCAFControl_Reader::ReadFile() has no progress indicator, the file is parsed as a stream
+    // instead so progress is reported and abort requests are honored
+    std::filebuf fileBuffer;
+    if (!fileBuffer.open(filepath, std::ios::in | std::ios::binary))
+        return false;
+
+    std::error_code errorCode;
+    const uintmax_t fileSize = std::filesystem::file_size(filepath, errorCode);
+    return this->readStreamBuffer(&fileBuffer, !errorCode ? fileSize : 0, filepath, progress);
+#else
     MayoIO_CafGlobalScopedLock(cafLock);
     OccStaticVariablesRollback rollback;
-    this->changeStaticVariables(&rollback);
+    OccStepReader::changeStaticVariables(m_params, &rollback);
     return Private::cafReadFile(*m_reader, filepath, progress);
+#endif
+}
+
+bool OccStepReader::readFileSource(const FileSource& source, TaskProgress* progress)
+{
+    if (source.isRemote() && !source.isCompressed()) {
+        // Download runs in a separate thread while the STEP parser consumes the stream
+        RemoteStreamBuffer streamBuffer(source.url());
+        return this->readStreamBuffer(&streamBuffer, source.size(), source.nameHint(), progress)
+                && !streamBuffer.hasError();
+    }
+
+    if (!source.isCompressed())
+        return this->readFile(source.filepath(), progress);
+
+    // Decompression runs in a separate thread while the STEP parser consumes the stream
+    DecompressStreamBuffer streamBuffer(source.filepath(), source.compression());
+    return this->readStreamBuffer(&streamBuffer, source.contentsSize(), source.filepath(), progress)
+            && !streamBuffer.hasError();
+}
+
+bool OccStepReader::readBuffer(Span<const uint8_t> data, const FilePath& nameHint, TaskProgress* progress)
+{
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+    MemoryStreamBuffer streamBuffer(data);
+    return this->readStreamBuffer(&streamBuffer, data.size(), nameHint, progress);
+#else
+    return Reader::readBuffer(data, nameHint, progress);
+#endif
+}
+
+bool OccStepReader::readStream(std::istream& istr, const FilePath& nameHint, TaskProgress* progress)
+{
+    return this->readStreamBuffer(istr.rdbuf(), 0, nameHint, progress);
+}
+
+bool OccStepReader::readStreamBuffer(
+        std::streambuf* buffer, uint64_t contentsSize, const FilePath& nameHint, TaskProgress* progress)
+{
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+    MAYO_PROFILE_ZONE("OccStepReader::readStream");
+    ProgressInputStreamBuffer progressBuffer(buffer, contentsSize, progress);
+    std::istream istr(&progressBuffer);
+    const std::string name = nameHint.u8string();
+#  if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 7, 0)
+    // Parameters are scoped to the reader(stored in the STEP model), not a single process-wide
+    // state is altered so concurrent reads of STEP files don't need the global lock
+    const IFSelect_ReturnStatus error =
+            m_reader->ReadStream(name.c_str(), OccStepReader::confParameters(m_params), istr);
+#  else
+    MayoIO_CafGlobalScopedLock(cafLock);
+    OccStaticVariablesRollback rollback;
+    OccStepReader::changeStaticVariables(m_params, &rollback);
+    const IFSelect_ReturnStatus error = m_reader->ReadStream(name.c_str(), istr);
+#  endif
+    return error == IFSelect_RetDone && !progressBuffer.isAborted();
+#else
+    // Reading from streams requires OpenCascade >= 7.6, fallback on temporary file
+    MAYO_UNUSED(contentsSize);
+    std::istream istr(buffer);
+    return Reader::readStream(istr, nameHint, progress);
+#endif
 }
 
 TDF_LabelSequence OccStepReader::transfer(DocumentPtr doc, TaskProgress* progress)
 {
+    MAYO_PROFILE_ZONE("OccStepReader::transfer");
     MayoIO_CafGlobalScopedLock(cafLock);
+    // Attributes are meaningless without shapes, skip them in "structure only" mode
+    const bool readStructureOnly = m_params.readStructureOnly || m_params.deferShapeLoading;
+    const bool readAttributes = !readStructureOnly;
+    m_reader->SetColorMode(readAttributes);
+    m_reader->SetLayerMode(readAttributes);
+    m_reader->SetPropsMode(readAttributes);
+    m_reader->SetGDTMode(readAttributes);
+    m_reader->SetMatMode(readAttributes);
+    m_reader->SetViewMode(readAttributes);
+#if OCC_VERSION_HEX < OCC_VERSION_CHECK(7, 7, 0)
+    // Translation parameters are then read from Interface_Static
     OccStaticVariablesRollback rollback;
-    this->changeStaticVariables(&rollback);
-    return Private::cafTransfer(*m_reader, doc, progress);
+    OccStepReader::changeStaticVariables(m_params, &rollback);
+#endif
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+    // Deferred shapes need the transfer process of the main reader, so no parallel transfer then
+    if (m_params.parallelRootTransfer && !m_params.deferShapeLoading)
+        return Private::cafTransferRootsInParallel(*m_reader, doc, progress);
+#endif
+
+    const TDF_LabelSequence seqEntity = Private::cafTransfer(*m_reader, doc, progress);
+    if (m_params.deferShapeLoading)
+        this->registerDeferredShapes(doc, seqEntity);
+
+    return seqEntity;
 }
 
 std::unique_ptr<PropertyGroup> OccStepReader::createProperties(PropertyGroup* parentGroup)
@@ -161,13 +352,92 @@ void OccStepReader::applyProperties(const PropertyGroup* group)
         m_params.productContext = ptr->productContext;
         m_params.assemblyLevel = ptr->assemblyLevel;
         m_params.preferredShapeRepresentation = ptr->preferredShapeRepresentation;
+        m_params.readTessellated = ptr->readTessellated;
         m_params.readShapeAspect = ptr->readShapeAspect;
         m_params.readSubShapesNames = ptr->readSubShapesNames;
         m_params.encoding = ptr->encoding;
+        m_params.parallelRootTransfer = ptr->parallelRootTransfer;
+        m_params.readStructureOnly = ptr->readStructureOnly;
+        m_params.deferShapeLoading = ptr->deferShapeLoading;
+        m_params.healShapes = ptr->healShapes;
+    }
+}
+
+ReaderParametersSnapshotPtr OccStepReader::createParametersSnapshot() const
+{
+    return ReaderParametersSnapshotOf<Parameters>::create(m_params);
+}
+
+void OccStepReader::applyParametersSnapshot(const ReaderParametersSnapshot& snapshot)
+{
+    ReaderParametersSnapshotOf<Parameters>::apply(snapshot, &m_params);
+}
+
+void OccStepReader::registerDeferredShapes(DocumentPtr doc, const TDF_LabelSequence& seqEntity) const
+{
+    // Parts are empty compounds at this stage, each one is bound to its source STEP entity(product)
+    // in the transfer process of the reader
+    const Handle_XSControl_WorkSession ws = Private::cafWorkSession(*m_reader);
+    const Handle_XSControl_TransferReader transferReader = ws->TransferReader();
+    auto source = std::make_shared<DeferredShapeSource>();
+    source->model = ws->Model();
+    source->params = m_params;
+    source->params.readStructureOnly = false;
+    source->params.deferShapeLoading = false;
+    source->params.assemblyLevel = AssemblyLevel::Shape;
+    for (const TDF_Label& entityLabel : seqEntity) {
+        for (const TDF_Label& protoLabel : XCaf::shapePrototypes(entityLabel)) {
+            if (doc->isShapeDeferred(protoLabel))
+                continue;
+
+            const Handle_Standard_Transient entity = transferReader->EntityFromShapeResult(XCaf::shape(protoLabel), 1);
+            if (entity.IsNull())
+                continue;
+
+            doc->setDeferredShape(protoLabel, [=](TaskProgress* progress) {
+                return OccStepReader::transferDeferredShape(*source, entity, progress);
+            });
+        }
     }
 }
 
-void OccStepReader::changeStaticVariables(OccStaticVariablesRollback* rollback) const
+TopoDS_Shape OccStepReader::transferDeferredShape(
+        const DeferredShapeSource& source, const Handle_Standard_Transient& entity, TaskProgress* progress)
+{
+    MayoIO_CafGlobalScopedLock(cafLock);
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 7, 0)
+    // Model parameters were set by the structure-only read, switch them to shape translation
+    Handle_StepData_StepModel::DownCast(source.model)->InternalParameters =
+            OccStepReader::confParameters(source.params);
+#else
+    OccStaticVariablesRollback rollback;
+    OccStepReader::changeStaticVariables(source.params, &rollback);
+#endif
+    // Separate work session(and transfer process) sharing the already parsed STEP model
+    Handle_XSControl_WorkSession ws = new XSControl_WorkSession;
+    ws->SelectNorm("STEP");
+    ws->SetModel(source.model);
+    STEPControl_Reader reader(ws, false/*!scratch*/);
+    Handle_Message_ProgressIndicator indicator = new OccProgressIndicator(progress);
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 5, 0)
+    reader.TransferEntity(entity, indicator->Start());
+#else
+    ws->MapReader()->SetProgress(indicator);
+    reader.TransferEntity(entity);
+    ws->MapReader()->SetProgress(nullptr);
+#endif
+    return reader.NbShapes() > 0 ? reader.OneShape() : TopoDS_Shape();
+}
+
+OccStepReader::AssemblyLevel OccStepReader::effectiveAssemblyLevel(const Parameters& params)
+{
+    if (params.readStructureOnly || params.deferShapeLoading)
+        return AssemblyLevel::Structure;
+
+    return params.assemblyLevel;
+}
+
+void OccStepReader::changeStaticVariables(const Parameters& params, OccStaticVariablesRollback* rollback)
 {
     auto fnOccEncoding = [](Encoding code) {
         switch (code) {
@@ -209,13 +479,62 @@ void OccStepReader::changeStaticVariables(OccStaticVariablesRollback* rollback)
         "read.stepcaf.codepage";
 #endif
 
-    rollback->change("read.step.product.context", int(m_params.productContext));
-    rollback->change("read.step.assembly.level", int(m_params.assemblyLevel));
-    rollback->change("read.step.shape.repr", int(m_params.preferredShapeRepresentation));
-    rollback->change("read.step.shape.aspect", int(m_params.readShapeAspect ? 1 : 0));
-    rollback->change("read.stepcaf.subshapes.name", int(m_params.readSubShapesNames ? 1 : 0));
-    rollback->change(strKeyReadStepCodePage, fnOccEncoding(m_params.encoding));
+    rollback->change("read.step.product.context", int(params.productContext));
+    rollback->change("read.step.assembly.level", int(OccStepReader::effectiveAssemblyLevel(params)));
+    rollback->change("read.step.shape.repr", int(params.preferredShapeRepresentation));
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+    rollback->change("read.step.tessellated", int(params.readTessellated));
+#endif
+    rollback->change("read.step.shape.aspect", int(params.readShapeAspect ? 1 : 0));
+    rollback->change("read.stepcaf.subshapes.name", int(params.readSubShapesNames ? 1 : 0));
+    rollback->change(strKeyReadStepCodePage, fnOccEncoding(params.encoding));
+}
+
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 7, 0)
+StepData_ConfParameters OccStepReader::confParameters(const Parameters& params)
+{
+    auto fnOccEncoding = [](Encoding code) {
+        switch (code) {
+        case Encoding::Shift_JIS: return Resource_FormatType_SJIS;
+        case Encoding::EUC: return Resource_FormatType_EUC;
+        case Encoding::ANSI: return Resource_FormatType_ANSI;
+        case Encoding::GB: return Resource_FormatType_GB;
+        case Encoding::UTF8: return Resource_FormatType_UTF8;
+        case Encoding::CP_1250: return Resource_FormatType_CP1250;
+        case Encoding::CP_1251: return Resource_FormatType_CP1251;
+        case Encoding::CP_1252: return Resource_FormatType_CP1252;
+        case Encoding::CP_1253: return Resource_FormatType_CP1253;
+        case Encoding::CP_1254: return Resource_FormatType_CP1254;
+        case Encoding::CP_1255: return Resource_FormatType_CP1255;
+        case Encoding::CP_1256: return Resource_FormatType_CP1256;
+        case Encoding::CP_1257: return Resource_FormatType_CP1257;
+        case Encoding::CP_1258: return Resource_FormatType_CP1258;
+        case Encoding::ISO_8859_1: return Resource_FormatType_iso8859_1;
+        case Encoding::ISO_8859_2: return Resource_FormatType_iso8859_2;
+        case Encoding::ISO_8859_3: return Resource_FormatType_iso8859_3;
+        case Encoding::ISO_8859_4: return Resource_FormatType_iso8859_4;
+        case Encoding::ISO_8859_5: return Resource_FormatType_iso8859_5;
+        case Encoding::ISO_8859_6: return Resource_FormatType_iso8859_6;
+        case Encoding::ISO_8859_7: return Resource_FormatType_iso8859_7;
+        case Encoding::ISO_8859_8: return Resource_FormatType_iso8859_8;
+        case Encoding::ISO_8859_9: return Resource_FormatType_iso8859_9;
+        }
+        Q_UNREACHABLE();
+    };
+
+    // Mayo enumerations share their integer values with the OpenCascade ones
+    using ConfParams = StepData_ConfParameters;
+    ConfParams confParams;
+    confParams.ReadProductContext = static_cast<ConfParams::ReadMode_ProductContext>(params.productContext);
+    confParams.ReadAssemblyLevel = static_cast<ConfParams::ReadMode_AssemblyLevel>(OccStepReader::effectiveAssemblyLevel(params));
+    confParams.ReadShapeRepr = static_cast<ConfParams::ReadMode_ShapeRepr>(params.preferredShapeRepresentation);
+    confParams.ReadTessellated = static_cast<ConfParams::RWMode_Tessellated>(params.readTessellated);
+    confParams.ReadShapeAspect = params.readShapeAspect;
+    confParams.ReadSubshapeNames = params.readSubShapesNames;
+    confParams.ReadCodePage = fnOccEncoding(params.encoding);
+    return confParams;
 }
+#endif
 
 class OccStepWriter::Properties : public PropertyGroup {
     MAYO_DECLARE_TEXT_ID_FUNCTIONS(Mayo::IO::OccStepWriter::Properties)
@@ -252,6 +571,10 @@ public:
                     textIdTr("Indicates whether to write sub-shape names to 'Name' attributes of "
                              "STEP Representation Items"));
 
+        this->parallelWrite.setDescription(
+                    textIdTr("Format STEP entities concurrently and write them to file by chunks.\n"
+                             "It reduces memory usage and write time of big models"));
+
         this->headerAuthor.setDescription(textIdTr("Author attribute in STEP header"));
         this->headerOrganization.setDescription(textIdTr("Organization(of author) attribute in STEP header"));
         this->headerOriginatingSystem.setDescription(textIdTr("Originating system attribute in STEP header"));
@@ -266,6 +589,7 @@ public:
         this->freeVertexMode.setValue(params.freeVertexMode);
         this->writePCurves.setValue(params.writeParametricCurves);
         this->writeSubShapesNames.setValue(params.writeSubShapesNames);
+        this->parallelWrite.setValue(params.parallelWrite);
 
         this->headerAuthor.setValue({});
         this->headerOrganization.setValue({});
@@ -279,12 +603,84 @@ public:
     PropertyEnum<FreeVertexMode> freeVertexMode{ this, textId("freeVertexMode") };
     PropertyBool writePCurves{ this, textId("writeParametericCurves") };
     PropertyBool writeSubShapesNames{ this, textId("writeSubShapesNames") };
+    PropertyBool parallelWrite{ this, textId("parallelWrite") };
     PropertyString headerAuthor{ this, textId("headerAuthor") };
     PropertyString headerOrganization{ this, textId("headerOrganization") };
     PropertyString headerOriginatingSystem{ this, textId("headerOriginatingSystem") };
     PropertyString headerDescription{ this, textId("headerDescription") };
 };
 
+namespace {
+
+// Writes the model of 'writer' to file, equivalent to STEPControl_Writer::Write() but the DATA
+// section is formatted by chunks of entities: the chunks of a window are formatted concurrently
+// then appended to the file and released, so text of the whole file is never held in memory
+// Abort requests are checked after each window. If 'isParallel' is false then windows are made of
+// a single chunk formatted in the calling thread
+// NOTE entities are only read while formatting, the model isn't modified
+bool writeStepModelByChunks(
+        STEPControl_Writer& writer, const FilePath& filepath, bool isParallel, TaskProgress* progress)
+{
+    MAYO_PROFILE_ZONE("OccStepWriter::writeStepModelByChunks");
+    const Handle_StepData_StepModel model = writer.Model();
+    const Handle_StepData_Protocol protocol = Handle_StepData_Protocol::DownCast(writer.WS()->Protocol());
+    if (model.IsNull() || protocol.IsNull())
+        return false;
+
+    std::ofstream fstr(filepath, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!fstr.is_open())
+        return false;
+
+    {
+        // Header only mode of SendModel() doesn't emit the start token of the exchange structure
+        StepData_StepWriter headerWriter(model);
+        headerWriter.SendModel(protocol, true/*headerOnly*/);
+        fstr << "ISO-10303-21;\n";
+        headerWriter.Print(fstr);
+    }
+
+    fstr << "DATA;\n";
+    const StepData_WriterLib writerLib(protocol); // Read-only once constructed
+    constexpr int chunkSize = 20000;
+    const int entityCount = model->NbEntities();
+    const int chunkCount = (entityCount + chunkSize - 1) / chunkSize;
+    const int windowSize = isParallel ? std::max(1, int(std::thread::hardware_concurrency())) : 1;
+    std::vector<std::unique_ptr<StepData_StepWriter>> vecChunkWriter(windowSize);
+    for (int iWindowStart = 0; iWindowStart < chunkCount; iWindowStart += windowSize) {
+        const int windowChunkCount = std::min(windowSize, chunkCount - iWindowStart);
+        auto fnFormatChunk = [&](int iChunk, TaskProgress*) {
+            const int firstEntity = (iWindowStart + iChunk) * chunkSize + 1;
+            const int lastEntity = std::min(entityCount, firstEntity + chunkSize - 1);
+            auto chunkWriter = std::make_unique<StepData_StepWriter>(model);
+            for (int iEntity = firstEntity; iEntity <= lastEntity; ++iEntity)
+                chunkWriter->SendEntity(iEntity, writerLib);
+
+            vecChunkWriter.at(iChunk) = std::move(chunkWriter);
+        };
+        if (windowChunkCount > 1)
+            TaskManager::runConcurrently(windowChunkCount, nullptr, fnFormatChunk);
+        else
+            fnFormatChunk(0, nullptr);
+
+        for (int iChunk = 0; iChunk < windowChunkCount; ++iChunk) {
+            vecChunkWriter.at(iChunk)->Print(fstr);
+            vecChunkWriter.at(iChunk).reset();
+        }
+
+        if (!fstr.good() || TaskProgress::isAbortRequested(progress))
+            return false;
+
+        if (progress)
+            progress->setValue((100 * (iWindowStart + windowChunkCount)) / chunkCount);
+    }
+
+    fstr << "ENDSEC;\n" << "END-ISO-10303-21;\n";
+    fstr.flush();
+    return fstr.good();
+}
+
+} // namespace
+
 OccStepWriter::OccStepWriter()
 {
     MayoIO_CafGlobalScopedLock(cafLock);
@@ -305,14 +701,16 @@ OccStepWriter::~OccStepWriter()
 
 bool OccStepWriter::transfer(Span<const ApplicationItem> appItems, TaskProgress* progress)
 {
+    MAYO_PROFILE_ZONE("OccStepWriter::transfer");
     MayoIO_CafGlobalScopedLock(cafLock);
     OccStaticVariablesRollback rollback;
     this->changeStaticVariables(&rollback);
     return Private::cafTransfer(*m_writer, appItems, progress);
 }
 
-bool OccStepWriter::writeFile(const FilePath& filepath, TaskProgress* /*progress*/)
+bool OccStepWriter::writeFile(const FilePath& filepath, TaskProgress* progress)
 {
+    MAYO_PROFILE_ZONE("OccStepWriter::writeFile");
     MayoIO_CafGlobalScopedLock(cafLock);
     OccStaticVariablesRollback rollback;
     this->changeStaticVariables(&rollback);
@@ -327,8 +725,9 @@ bool OccStepWriter::writeFile(const FilePath& filepath, TaskProgress* /*progress
     makeHeader.SetDescriptionValue(
                 1, string_conv<Handle(TCollection_HAsciiString)>(m_params.headerDescription));
 
-    const IFSelect_ReturnStatus err = m_writer->Write(filepath.u8string().c_str());
-    return err == IFSelect_RetDone;
+    // STEPControl_Writer::Write() has no progress indicator, the model is also written by chunks
+    // when not in parallel mode so abort requests are checked
+    return writeStepModelByChunks(m_writer->ChangeWriter(), filepath, m_params.parallelWrite, progress);
 }
 
 std::unique_ptr<PropertyGroup> OccStepWriter::createProperties(PropertyGroup* parentGroup)
@@ -346,6 +745,7 @@ void OccStepWriter::applyProperties(const PropertyGroup* group)
         m_params.freeVertexMode = ptr->freeVertexMode;
         m_params.writeParametricCurves = ptr->writePCurves;
         m_params.writeSubShapesNames = ptr->writeSubShapesNames;
+        m_params.parallelWrite = ptr->parallelWrite;
         m_params.headerAuthor = ptr->headerAuthor;
         m_params.headerOrganization = ptr->headerOrganization;
         m_params.headerOriginatingSystem = ptr->headerOriginatingSystem;
@@ -13,7 +13,12 @@
 #include <NCollection_Vector.hxx>
 #include <STEPCAFControl_Reader.hxx>
 #include <STEPCAFControl_Writer.hxx>
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 7, 0)
+#  include <StepData_ConfParameters.hxx>
+#endif
 
+#include <cstdint>
+#include <streambuf>
 #include <type_traits>
 
 namespace Mayo {
@@ -28,6 +33,9 @@ public:
     ~OccStepReader();
 
     bool readFile(const FilePath& filepath, TaskProgress* progress) override;
+    bool readFileSource(const FileSource& source, TaskProgress* progress) override;
+    bool readBuffer(Span<const uint8_t> data, const FilePath& nameHint, TaskProgress* progress) override;
+    bool readStream(std::istream& istr, const FilePath& nameHint, TaskProgress* progress) override;
     TDF_LabelSequence transfer(DocumentPtr doc, TaskProgress* progress) override;
 
     // Parameters
@@ -50,6 +58,12 @@ public:
         All = 1
     };
 
+    // Reading of tessellated geometry(eg `TESSELLATED_SHAPE_REPRESENTATION` of AP242 files) as
+    // triangulations of faces without surface, which then don't need BRep meshing
+    enum class TessellatedGeometry {
+        Off = 0, On = 1, OnNoBRep = 2
+    };
+
     // Maps to OpenCascade's Resource_FormatType
     enum class Encoding {
         Shift_JIS, // Shift Japanese Industrial Standards
@@ -85,8 +99,13 @@ public:
         ProductContext productContext = ProductContext::Both;
         AssemblyLevel assemblyLevel = AssemblyLevel::All;
         ShapeRepresentation preferredShapeRepresentation = ShapeRepresentation::All;
+        TessellatedGeometry readTessellated = TessellatedGeometry::On; // Requires OpenCascade >= v7.6.0
         bool readShapeAspect = true;
         bool readSubShapesNames = false;
+        bool parallelRootTransfer = false; // Requires OpenCascade >= v7.6.0
+        bool readStructureOnly = false; // Overrides 'assemblyLevel'
+        bool deferShapeLoading = false; // Implies structure-only translation, overrides 'assemblyLevel'
+        bool healShapes = false; // Post-import stage, see AppModule::healImportedShapes()
         Encoding encoding = Encoding::UTF8;
     };
     Parameters& parameters() { return m_params; }
@@ -94,9 +113,24 @@ public:
 
     static std::unique_ptr<PropertyGroup> createProperties(PropertyGroup* parentGroup);
     void applyProperties(const PropertyGroup* params) override;
+    ReaderParametersSnapshotPtr createParametersSnapshot() const override;
+    void applyParametersSnapshot(const ReaderParametersSnapshot& snapshot) override;
 
 private:
-    void changeStaticVariables(OccStaticVariablesRollback* rollback) const;
+    struct DeferredShapeSource;
+    static void changeStaticVariables(const Parameters& params, OccStaticVariablesRollback* rollback);
+    static AssemblyLevel effectiveAssemblyLevel(const Parameters& params);
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 7, 0)
+    static StepData_ConfParameters confParameters(const Parameters& params);
+#endif
+    // Parses the contents of 'buffer', progress is reported if 'contentsSize' isn't zero
+    bool readStreamBuffer(
+            std::streambuf* buffer, uint64_t contentsSize, const FilePath& nameHint, TaskProgress* progress);
+    void registerDeferredShapes(DocumentPtr doc, const TDF_LabelSequence& seqEntity) const;
+    static TopoDS_Shape transferDeferredShape(
+            const DeferredShapeSource& source,
+            const Handle_Standard_Transient& entity,
+            TaskProgress* progress);
 
     class Properties;
     STEPCAFControl_Reader* m_reader = nullptr;
@@ -139,6 +173,9 @@ public:
         FreeVertexMode freeVertexMode = FreeVertexMode::Compound;
         bool writeParametricCurves = true;
         bool writeSubShapesNames = false;
+        // Entity records are formatted concurrently and written to file by chunks, instead of
+        // formatting the whole file in memory before writing
+        bool parallelWrite = false;
         std::string headerAuthor;            // utf8
         std::string headerOrganization;      // utf8
         std::string headerOriginatingSystem; // utf8
@@ -5,51 +5,53 @@
 ****************************************************************************/
 
 #include "io_occ_stl.h"
+#include "io_occ_stl_native.h"
 
 #include "../base/application_item.h"
-#include "../base/brep_utils.h"
 #include "../base/document.h"
 #include "../base/caf_utils.h"
+#include "../base/io_file_source.h"
+#include "../base/io_remote_file.h"
 #include "../base/occ_progress_indicator.h"
+#include "../base/profiler.h"
+#include "../base/property_builtins.h"
 #include "../base/property_enumeration.h"
+#include "../base/string_conv.h"
 #include "../base/task_progress.h"
 #include "../base/tkernel_utils.h"
 
+#include <QtCore/QFile>
 #include <QtCore/QtDebug>
-#include <BRep_Builder.hxx>
 #include <BRepTools.hxx>
+#include <BRep_Tool.hxx>
 #include <RWStl.hxx>
-#include <StlAPI_Writer.hxx>
 #include <TDataStd_Name.hxx>
 #include <TDataXtd_Triangulation.hxx>
-#include <TopoDS_Compound.hxx>
+#include <algorithm>
+#include <istream>
+#include <iterator>
 
 namespace Mayo {
 namespace IO {
 
-namespace {
-
-static TopoDS_Shape asShape(const DocumentPtr& doc)
-{
-    TopoDS_Shape shape;
-    const TDF_LabelSequence seqFreeShape = doc->xcaf().topLevelFreeShapes();
-    if (seqFreeShape.Size() > 1) {
-        TopoDS_Compound cmpd;
-        BRep_Builder builder;
-        builder.MakeCompound(cmpd);
-        for (const TDF_Label& label : seqFreeShape)
-            builder.Add(cmpd, XCaf::shape(label));
-
-        shape = cmpd;
-    }
-    else if (seqFreeShape.Size() == 1) {
-        shape = XCaf::shape(seqFreeShape.First());
+class OccStlReader::Properties : public PropertyGroup {
+    MAYO_DECLARE_TEXT_ID_FUNCTIONS(Mayo::IO::OccStlReader::Properties)
+public:
+    Properties(PropertyGroup* parentGroup)
+        : PropertyGroup(parentGroup)
+    {
+        this->weldVertices.setDescription(
+                    textIdTr("Merge the vertices having the same coordinates, so triangles share "
+                             "their nodes. This reduces memory usage, applies only to binary STL files"));
     }
 
-    return shape;
-}
+    void restoreDefaults() override {
+        const OccStlReader::Parameters params;
+        this->weldVertices.setValue(params.weldVertices);
+    }
 
-} // namespace
+    PropertyBool weldVertices{ this, textId("weldVertices") };
+};
 
 class OccStlWriter::Properties : public PropertyGroup {
     MAYO_DECLARE_TEXT_ID_FUNCTIONS(Mayo::IO::OccStlWriter::Properties)
@@ -58,25 +60,130 @@ public:
         : PropertyGroup(parentGroup)
     {
         this->targetFormat.mutableEnumeration().changeTrContext(this->textIdContext());
+        this->parallelBinaryWrite.setDescription(
+                    textIdTr("Encode binary facets concurrently, directly into the memory-mapped "
+                             "output file"));
+        this->asciiSolidPerItem.setDescription(
+                    textIdTr("Write a separate solid for each exported item, named after the item"));
+        this->asciiSolidPerItem.setEnabled(false);
     }
 
     void restoreDefaults() override {
-        this->targetFormat.setValue(Format::Binary);
+        const OccStlWriter::Parameters params;
+        this->targetFormat.setValue(params.format);
+        this->parallelBinaryWrite.setValue(params.parallelBinaryWrite);
+        this->asciiSolidPerItem.setValue(params.asciiSolidPerItem);
+    }
+
+    void onPropertyChanged(Property* prop) override
+    {
+        if (prop == &this->targetFormat) {
+            this->parallelBinaryWrite.setEnabled(this->targetFormat == Format::Binary);
+            this->asciiSolidPerItem.setEnabled(this->targetFormat == Format::Ascii);
+        }
+
+        PropertyGroup::onPropertyChanged(prop);
     }
 
     PropertyEnum<OccStlWriter::Format> targetFormat{ this, textId("targetFormat") };
+    PropertyBool parallelBinaryWrite{ this, textId("parallelBinaryWrite") };
+    PropertyBool asciiSolidPerItem{ this, textId("asciiSolidPerItem") };
 };
 
 bool OccStlReader::readFile(const FilePath& filepath, TaskProgress* progress)
 {
-    Handle_Message_ProgressIndicator indicator = new OccProgressIndicator(progress);
+    MAYO_PROFILE_ZONE("OccStlReader::readFile");
     m_baseFilename = filepath.stem();
+    m_mesh.Nullify();
+    QFile file(filepathTo<QString>(filepath));
+    const uchar* fileData = file.open(QIODevice::ReadOnly) ? file.map(0, file.size()) : nullptr;
+    if (fileData) {
+        const Span<const uint8_t> data(fileData, size_t(file.size()));
+        if (this->readContents(data, progress) || TaskProgress::isAbortRequested(progress))
+            return !m_mesh.IsNull();
+    }
+
+    // Fallback on OpenCascade for unusual ASCII contents(ex: uppercase keywords)
+    Handle_Message_ProgressIndicator indicator = new OccProgressIndicator(progress);
     m_mesh = RWStl::ReadFile(filepath.u8string().c_str(), TKernelUtils::start(indicator));
     return !m_mesh.IsNull();
 }
 
+bool OccStlReader::readFileSource(const FileSource& source, TaskProgress* progress)
+{
+    if (source.isRemote() && !source.isCompressed()) {
+        RemoteStreamBuffer streamBuffer(source.url());
+        std::istream istr(&streamBuffer);
+        return this->readStreamContents(istr, source.size(), source.nameHint(), progress)
+                && !streamBuffer.hasError();
+    }
+
+    if (!source.isCompressed())
+        return this->readFile(source.filepath(), progress);
+
+    // Native parsers need contiguous contents, so the whole file is decompressed in memory
+    // No fallback on OpenCascade then, it can only read files from disk
+    MAYO_PROFILE_ZONE("OccStlReader::readFileSource");
+    m_baseFilename = source.filepath().stem().stem(); // Eg "part" for "part.stl.gz"
+    m_mesh.Nullify();
+    std::vector<uint8_t> contents;
+    if (!decompressFile(source.filepath(), source.compression(), &contents))
+        return false;
+
+    this->readContents(contents, progress);
+    return !m_mesh.IsNull();
+}
+
+bool OccStlReader::readBuffer(Span<const uint8_t> data, const FilePath& nameHint, TaskProgress* progress)
+{
+    MAYO_PROFILE_ZONE("OccStlReader::readBuffer");
+    m_baseFilename = nameHint.stem();
+    m_mesh.Nullify();
+    if (this->readContents(data, progress) || TaskProgress::isAbortRequested(progress))
+        return !m_mesh.IsNull();
+
+    // Fallback on OpenCascade(through temporary file) for unusual ASCII contents
+    return Reader::readBuffer(data, nameHint, progress);
+}
+
+bool OccStlReader::readStreamContents(
+        std::istream& istr, uint64_t contentsSize, const FilePath& nameHint, TaskProgress* progress)
+{
+    MAYO_PROFILE_ZONE("OccStlReader::readStreamContents");
+    m_baseFilename = nameHint.stem();
+    m_mesh.Nullify();
+    // Binary facets are decoded as they arrive, contents size is needed to identify binary STL
+    std::vector<uint8_t> contents;
+    if (!m_params.weldVertices && contentsSize > 0) {
+        m_mesh = StlNative::readBinaryStream(istr, contentsSize, &contents, progress);
+        if (!m_mesh.IsNull() || istr.fail() || TaskProgress::isAbortRequested(progress))
+            return !m_mesh.IsNull();
+    }
+
+    // Native parsers need the whole contents otherwise
+    contents.insert(contents.end(), std::istreambuf_iterator<char>(istr), std::istreambuf_iterator<char>());
+    if (istr.bad())
+        return false;
+
+    return this->readBuffer(contents, nameHint, progress);
+}
+
+bool OccStlReader::readContents(Span<const uint8_t> data, TaskProgress* progress)
+{
+    if (StlNative::isBinary(data)) {
+        StlNative::Options options;
+        options.weldVertices = m_params.weldVertices;
+        m_mesh = StlNative::readBinary(data, options, progress);
+        return true;
+    }
+
+    m_mesh = StlNative::readAscii(data, progress);
+    return !m_mesh.IsNull();
+}
+
 TDF_LabelSequence OccStlReader::transfer(DocumentPtr doc, TaskProgress* /*progress*/)
 {
+    MAYO_PROFILE_ZONE("OccStlReader::transfer");
     if (m_mesh.IsNull())
         return {};
 
@@ -86,68 +193,99 @@ TDF_LabelSequence OccStlReader::transfer(DocumentPtr doc, TaskProgress* /*progre
     return CafUtils::makeLabelSequence({ entityLabel });
 }
 
+std::unique_ptr<PropertyGroup> OccStlReader::createProperties(PropertyGroup* parentGroup)
+{
+    return std::make_unique<Properties>(parentGroup);
+}
+
+void OccStlReader::applyProperties(const PropertyGroup* params)
+{
+    auto ptr = dynamic_cast<const Properties*>(params);
+    if (ptr)
+        m_params.weldVertices = ptr->weldVertices;
+}
+
 bool OccStlWriter::transfer(Span<const ApplicationItem> appItems, TaskProgress* /*progress*/)
 {
-//    if (appItems.size() > 1)
-//        return Result::error(tr("OpenCascade RWStl does not support multi-solids"));
-
-    m_shape = {};
-    m_mesh = {};
-    if (!appItems.empty()) {
-        const ApplicationItem& item = appItems.front();
-        if (item.isDocument()) {
-            m_shape = asShape(item.document());
+    m_vecItem.clear();
+    auto fnAddNode = [&](const DocumentPtr& doc, TreeNodeId nodeId) {
+        const TDF_Label label = doc->modelTree().nodeData(nodeId);
+        Item item;
+        item.name = to_stdString(CafUtils::labelAttrStdName(label));
+        std::replace_if(item.name.begin(), item.name.end(), [](char c) { return c == '\n' || c == '\r'; }, ' ');
+        if (XCaf::isShape(label)) {
+            // Shape of a label is located relative to its parent node
+            const TreeNodeId parentId = doc->modelTree().nodeParent(nodeId);
+            item.doc = doc;
+            item.shapeLabel = label;
+            item.shapeLocation = parentId != 0 ? doc->xcaf().shapeAbsoluteLocation(parentId) : TopLoc_Location();
+        }
+        else {
+            auto attrPolyTri = CafUtils::findAttribute<TDataXtd_Triangulation>(label);
+            if (!attrPolyTri.IsNull())
+                item.mesh = attrPolyTri->Get();
         }
-        else if (item.isDocumentTreeNode()) {
-            const TDF_Label label = item.documentTreeNode().label();
-            if (XCaf::isShape(label)) {
-                m_shape = XCaf::shape(label);
-            }
-            else {
-                auto attrPolyTri = CafUtils::findAttribute<TDataXtd_Triangulation>(label);
-                if (!attrPolyTri.IsNull())
-                    m_mesh = attrPolyTri->Get();
-            }
+
+        if (!item.shapeLabel.IsNull() || !item.mesh.IsNull())
+            m_vecItem.push_back(std::move(item));
+    };
+
+    for (const ApplicationItem& appItem : appItems) {
+        if (appItem.isDocument()) {
+            const DocumentPtr doc = appItem.document();
+            for (int i = 0; i < doc->entityCount(); ++i)
+                fnAddNode(doc, doc->entityTreeNodeId(i));
+        }
+        else if (appItem.isDocumentTreeNode()) {
+            fnAddNode(appItem.document(), appItem.documentTreeNode().id());
         }
     }
 
-    return !m_shape.IsNull() || !m_mesh.IsNull();
+    return !m_vecItem.empty();
 }
 
 bool OccStlWriter::writeFile(const FilePath& filepath, TaskProgress* progress)
 {
-    if (!m_shape.IsNull()) {
-        bool facesMeshed = true;
-        BRepUtils::forEachSubFace(m_shape, [&](const TopoDS_Face& face) {
-            TopLoc_Location loc;
-            Handle_Poly_Triangulation mesh = BRep_Tool::Triangulation(face, loc);
-            if (mesh.IsNull())
-                facesMeshed = false;
-        });
-        if (!facesMeshed) {
-#if OCC_VERSION_HEX <= OCC_VERSION_CHECK(7, 3, 0)
-            //qCritical() << "Not all BRep faces are meshed";
-            return false; // Continuing would crash
-#else
-            //qWarning() << "Not all BRep faces are meshed";
-#endif
+    MAYO_PROFILE_ZONE("OccStlWriter::writeFile");
+    if (m_vecItem.empty())
+        return false;
+
+    std::vector<StlNative::MeshPart> parts;
+    std::vector<std::string> vecSolidName;
+    for (const Item& item : m_vecItem) {
+        const int solid = int(vecSolidName.size());
+        if (!item.shapeLabel.IsNull()) {
+            // Faces not meshed are skipped, assemblies are walked down to prototypes whose faces
+            // are indexed once
+            item.doc->subShapeCache().forEachLabelFace(
+                        item.shapeLabel, item.shapeLocation, [&](const TopoDS_Face& face, bool isTriangulated) {
+                if (!isTriangulated)
+                    return;
+
+                TopLoc_Location loc;
+                const Handle_Poly_Triangulation& mesh = BRep_Tool::Triangulation(face, loc);
+                if (!mesh.IsNull())
+                    parts.push_back({ mesh, loc.Transformation(), face.Orientation() == TopAbs_REVERSED, solid });
+            });
+        }
+        else {
+            StlNative::MeshPart part{ item.mesh, gp_Trsf(), false };
+            part.solid = solid;
+            parts.push_back(std::move(part));
         }
 
-        StlAPI_Writer writer;
-        writer.ASCIIMode() = m_params.format == Format::Ascii;
-        return writer.Write(m_shape, filepath.u8string().c_str());
-    }
-    else if (!m_mesh.IsNull()) {
-        Handle_Message_ProgressIndicator indicator = new OccProgressIndicator(progress);
-        const std::string filepathUtf8 = filepath.u8string();
-        const OSD_Path osdFilepath(filepathUtf8.c_str());
-        if (m_params.format == Format::Ascii)
-            return RWStl::WriteAscii(m_mesh, osdFilepath, TKernelUtils::start(indicator));
-        else
-            return RWStl::WriteBinary(m_mesh, osdFilepath, TKernelUtils::start(indicator));
+        vecSolidName.push_back(item.name);
     }
 
-    return false;
+    if (m_params.format == Format::Ascii) {
+        if (!m_params.asciiSolidPerItem)
+            vecSolidName.clear();
+
+        return StlNative::writeAscii(parts, filepath, progress, vecSolidName);
+    }
+    else {
+        return StlNative::writeBinary(parts, filepath, progress, m_params.parallelBinaryWrite);
+    }
 }
 
 std::unique_ptr<PropertyGroup> OccStlWriter::createProperties(PropertyGroup* parentGroup)
@@ -158,8 +296,11 @@ std::unique_ptr<PropertyGroup> OccStlWriter::createProperties(PropertyGroup* par
 void OccStlWriter::applyProperties(const PropertyGroup* params)
 {
     auto ptr = dynamic_cast<const Properties*>(params);
-    if (ptr)
+    if (ptr) {
         m_params.format = ptr->targetFormat;
+        m_params.parallelBinaryWrite = ptr->parallelBinaryWrite;
+        m_params.asciiSolidPerItem = ptr->asciiSolidPerItem;
+    }
 }
 
 } // namespace IO
@@ -6,26 +6,54 @@
 
 #pragma once
 
+#include "../base/document_ptr.h"
 #include "../base/io_reader.h"
 #include "../base/io_writer.h"
 #include <Poly_Triangulation.hxx>
-#include <TopoDS_Shape.hxx>
+#include <TDF_Label.hxx>
+#include <TopLoc_Location.hxx>
+#include <string>
+#include <vector>
 
 namespace Mayo {
 namespace IO {
 
-// Opencascade-based reader for STL file format
+// Reader for STL file format
+// Files are memory-mapped and decoded natively with multithreading, OpenCascade RWStl is used as a
+// fallback for ASCII contents that couldn't be parsed
 class OccStlReader : public Reader {
 public:
     bool readFile(const FilePath& filepath, TaskProgress* progress) override;
+    bool readFileSource(const FileSource& source, TaskProgress* progress) override;
+    bool readBuffer(Span<const uint8_t> data, const FilePath& nameHint, TaskProgress* progress) override;
     TDF_LabelSequence transfer(DocumentPtr doc, TaskProgress* progress) override;
 
+    static std::unique_ptr<PropertyGroup> createProperties(PropertyGroup* parentGroup);
+    void applyProperties(const PropertyGroup* params) override;
+
+    // Parameters
+    struct Parameters {
+        bool weldVertices = false; // Binary files only
+    };
+    Parameters& parameters() { return m_params; }
+    const Parameters& constParameters() const { return m_params; }
+
 private:
+    // Reads contents with the native parser, returns false if ASCII contents are not recognized
+    bool readContents(Span<const uint8_t> data, TaskProgress* progress);
+    // Reads contents from a stream, 'contentsSize' being zero if unknown
+    bool readStreamContents(std::istream& istr, uint64_t contentsSize, const FilePath& nameHint, TaskProgress* progress);
+
+    class Properties;
+    Parameters m_params;
     Handle_Poly_Triangulation m_mesh;
     FilePath m_baseFilename;
 };
 
-// Opencascade-based writer for STL file format
+// Writer for STL file format
+// Any number of items(documents, shapes at any level of an assembly, mesh entities) can be written
+// Face triangulations are streamed into the file with their absolute locations applied on the fly,
+// no intermediate compound or mesh is built
 class OccStlWriter : public Writer {
 public:
     bool transfer(Span<const ApplicationItem> appItems, TaskProgress* progress) override;
@@ -39,6 +67,8 @@ public:
 
     struct Parameters {
         Format format = Format::Binary;
+        bool parallelBinaryWrite = true; // Binary format only
+        bool asciiSolidPerItem = false; // ASCII format only, one named "solid" block per item
     };
     Parameters& parameters() { return m_params; }
     const Parameters& constParameters() const { return m_params; }
@@ -46,8 +76,18 @@ public:
 private:
     class Properties;
     Parameters m_params;
-    TopoDS_Shape m_shape;
-    Handle_Poly_Triangulation m_mesh;
+
+    // Shape(with its absolute location) or mesh entity to be written
+    struct Item {
+        std::string name;
+        // Shape label, located relative to the parent node. Faces are queried from the
+        // SubShapeCache of the document
+        DocumentPtr doc;
+        TDF_Label shapeLabel;
+        TopLoc_Location shapeLocation;
+        Handle_Poly_Triangulation mesh;
+    };
+    std::vector<Item> m_vecItem;
 };
 
 } // namespace IO
@@ -0,0 +1,829 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "io_occ_stl_native.h"
+#include "../base/brep_utils.h"
+#include "../base/mesh_utils.h"
+#include "../base/task_manager.h"
+#include "../base/task_progress.h"
+#include "../base/text_number.h"
+#include "../base/tkernel_utils.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QtEndian>
+#include <BRep_Tool.hxx>
+#include <TopoDS_Face.hxx>
+#include <fast_float/fast_float.h>
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstring>
+#include <functional>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace Mayo {
+namespace IO {
+namespace StlNative {
+
+namespace {
+
+constexpr size_t BinaryHeaderSize = 80 + 4; // Free text, then facet count(uint32)
+constexpr size_t BinaryFacetSize = 50; // Normal and vertices(12 float32), then attribute(uint16)
+
+// Raw coordinates of a facet vertex, read as little-endian bit patterns
+struct VertexKey {
+    quint32 bits[3];
+
+    static VertexKey read(const uint8_t* bytes) {
+        return {{
+            qFromLittleEndian<quint32>(bytes),
+            qFromLittleEndian<quint32>(bytes + 4),
+            qFromLittleEndian<quint32>(bytes + 8)
+        }};
+    }
+
+    size_t hash() const {
+        // Spatial hash from "Optimized Spatial Hashing for Collision Detection of Deformable Objects"
+        return (size_t(bits[0]) * 73856093u) ^ (size_t(bits[1]) * 19349663u) ^ (size_t(bits[2]) * 83492791u);
+    }
+
+    gp_Pnt toPoint() const {
+        float coords[3];
+        std::memcpy(coords, bits, sizeof(coords));
+        return { coords[0], coords[1], coords[2] };
+    }
+
+    bool operator==(const VertexKey& other) const {
+        return std::memcmp(bits, other.bits, sizeof(bits)) == 0;
+    }
+};
+
+struct VertexKeyHasher {
+    size_t operator()(const VertexKey& key) const { return key.hash(); }
+};
+
+// Pointer to the coordinates of vertex 'iVertex'(in [0,2]) of facet 'iFacet'
+const uint8_t* binaryFacetVertex(const uint8_t* facets, size_t iFacet, int iVertex)
+{
+    return facets + iFacet * BinaryFacetSize + 12 * (1 + iVertex);
+}
+
+void setNode(Poly_Triangulation* mesh, int index, const gp_Pnt& pnt)
+{
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+    mesh->SetNode(index, pnt);
+#else
+    mesh->ChangeNode(index) = pnt;
+#endif
+}
+
+void setTriangle(Poly_Triangulation* mesh, int index, const Poly_Triangle& triangle)
+{
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+    mesh->SetTriangle(index, triangle);
+#else
+    mesh->ChangeTriangle(index) = triangle;
+#endif
+}
+
+int concurrentTaskCount(int itemCount)
+{
+    const int threadCount = std::max(1, int(std::thread::hardware_concurrency()));
+    return std::max(1, std::min(itemCount, threadCount));
+}
+
+bool isAsciiSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+// Executes fn(ptr) for each "vertex" keyword found in [begin, end[, 'ptr' pointing just after the
+// keyword. Candidates are located with memchr(), which is vectorized by the C runtime
+// Function 'fn' returns false to stop iteration
+template<typename FN>
+void forEachAsciiVertexKeyword(const char* begin, const char* end, const FN& fn)
+{
+    constexpr std::string_view keyword = "vertex";
+    const char* ptr = begin;
+    while (ptr < end) {
+        ptr = static_cast<const char*>(std::memchr(ptr, 'v', end - ptr));
+        if (!ptr || size_t(end - ptr) <= keyword.size())
+            return;
+
+        const bool isKeyword =
+                std::memcmp(ptr, keyword.data(), keyword.size()) == 0
+                && (ptr == begin || isAsciiSpace(ptr[-1]))
+                && isAsciiSpace(ptr[keyword.size()]);
+        ptr += isKeyword ? keyword.size() : 1;
+        if (isKeyword && !fn(ptr))
+            return;
+    }
+}
+
+// Parses a float value after optional whitespaces, returns nullptr on error
+const char* parseAsciiFloat(const char* ptr, const char* end, float* value)
+{
+    while (ptr < end && isAsciiSpace(*ptr))
+        ++ptr;
+
+    if (ptr < end && *ptr == '+') // Not accepted by from_chars()
+        ++ptr;
+
+    const fast_float::from_chars_result res = fast_float::from_chars(ptr, end, *value);
+    return res.ec == std::errc() ? res.ptr : nullptr;
+}
+
+// Returns the position just after the first "endfacet" keyword found in [begin, end[, or 'end'
+const char* findAsciiFacetEnd(const char* begin, const char* end)
+{
+    constexpr std::string_view keyword = "endfacet";
+    const std::boyer_moore_horspool_searcher searcher(keyword.begin(), keyword.end());
+    const char* ptr = std::search(begin, end, searcher);
+    return ptr != end ? ptr + keyword.size() : end;
+}
+
+// Buffered writing into a file, buffer is flushed when full
+class FileSink {
+public:
+    FileSink(QFile* file, size_t capacity = 4 * 1024 * 1024)
+        : m_file(file)
+    {
+        m_buffer.reserve(capacity);
+    }
+
+    // Returns pointer to 'size' bytes to be filled, buffer is flushed if not enough room
+    uint8_t* append(size_t size) {
+        if (m_buffer.size() + size > m_buffer.capacity())
+            this->flush();
+
+        const size_t pos = m_buffer.size();
+        m_buffer.resize(pos + size);
+        return m_buffer.data() + pos;
+    }
+
+    void append(std::string_view str) {
+        std::memcpy(this->append(str.size()), str.data(), str.size());
+    }
+
+    bool flush() {
+        if (!m_buffer.empty()) {
+            const auto bytes = reinterpret_cast<const char*>(m_buffer.data());
+            m_isOk = m_isOk && m_file->write(bytes, m_buffer.size()) == qint64(m_buffer.size());
+            m_buffer.clear();
+        }
+
+        return m_isOk;
+    }
+
+    bool isOk() const { return m_isOk; }
+
+private:
+    QFile* m_file = nullptr;
+    std::vector<uint8_t> m_buffer;
+    bool m_isOk = true;
+};
+
+struct Facet {
+    gp_XYZ normal;
+    gp_XYZ vertex[3];
+};
+
+bool hasTransformation(const MeshPart& part)
+{
+    return part.trsf.Form() != gp_Identity;
+}
+
+// Node indices of triangle 'iTriangle'(1-based) of 'part', orientation of the part being applied
+void meshPartTriangleNodes(const MeshPart& part, int iTriangle, int nodes[3])
+{
+    part.triangulation->Triangle(iTriangle).Get(nodes[0], nodes[1], nodes[2]);
+    if (part.isReversed)
+        std::swap(nodes[1], nodes[2]);
+}
+
+// Normal of the facet comes from 'triNormals', the normals of the triangles of 'part'
+gp_XYZ meshPartFacetNormal(const MeshPart& part, const MeshUtils::NormalArray& triNormals, int iTriangle)
+{
+    const int iNormal = iTriangle - 1;
+    gp_XYZ normal(triNormals.x[iNormal], triNormals.y[iNormal], triNormals.z[iNormal]);
+    // Matrix of gp_Trsf is a rotation(the scale factor holds mirroring), so the transformed
+    // normal is still unit
+    if (hasTransformation(part))
+        normal.Multiply(part.trsf.HVectorialPart());
+
+    if (part.isReversed)
+        normal.Reverse();
+
+    return normal;
+}
+
+Facet meshPartFacet(const MeshPart& part, const MeshUtils::NormalArray& triNormals, int iTriangle)
+{
+    int nodes[3];
+    meshPartTriangleNodes(part, iTriangle, nodes);
+    const bool hasTrsf = hasTransformation(part);
+    Facet facet;
+    for (int i = 0; i < 3; ++i) {
+        facet.vertex[i] = part.triangulation->Node(nodes[i]).XYZ();
+        if (hasTrsf)
+            part.trsf.Transforms(facet.vertex[i]);
+    }
+
+    facet.normal = meshPartFacetNormal(part, triNormals, iTriangle);
+    return facet;
+}
+
+void writeFloat32(uint8_t* bytes, double value)
+{
+    const float valueF = float(value);
+    quint32 bits;
+    std::memcpy(&bits, &valueF, sizeof(bits));
+    qToLittleEndian<quint32>(bits, bytes);
+}
+
+void writeXYZ(uint8_t* bytes, const gp_XYZ& coords)
+{
+    writeFloat32(bytes, coords.X());
+    writeFloat32(bytes + 4, coords.Y());
+    writeFloat32(bytes + 8, coords.Z());
+}
+
+// Writes binary STL record of triangle 'iTriangle'(1-based) into 'bytes'(BinaryFacetSize long)
+void writeBinaryFacet(
+        const MeshPart& part, const MeshUtils::NormalArray& triNormals, int iTriangle, uint8_t* bytes)
+{
+    const Facet facet = meshPartFacet(part, triNormals, iTriangle);
+    writeXYZ(bytes, facet.normal);
+    for (int i = 0; i < 3; ++i)
+        writeXYZ(bytes + 12 * (1 + i), facet.vertex[i]);
+
+    bytes[48] = bytes[49] = 0; // Attribute byte count
+}
+
+// Variant of writeBinaryFacet() where vertex coordinates are taken from 'nodeCoords', the nodes of
+// the part already transformed(xyz float32 triplets)
+void writeBinaryFacet(
+        const MeshPart& part,
+        const MeshUtils::NormalArray& triNormals,
+        int iTriangle,
+        const float* nodeCoords,
+        uint8_t* bytes)
+{
+    int nodes[3];
+    meshPartTriangleNodes(part, iTriangle, nodes);
+    writeXYZ(bytes, meshPartFacetNormal(part, triNormals, iTriangle));
+    for (int i = 0; i < 3; ++i) {
+        const float* coords = nodeCoords + 3 * (nodes[i] - 1);
+        uint8_t* vertexBytes = bytes + 12 * (1 + i);
+        for (int j = 0; j < 3; ++j)
+            writeFloat32(vertexBytes + 4 * j, coords[j]);
+    }
+
+    bytes[48] = bytes[49] = 0; // Attribute byte count
+}
+
+// Transforms all the nodes of 'part' into 'nodeCoords'(xyz float32 triplets)
+void transformMeshPartNodes(const MeshPart& part, std::vector<float>* nodeCoords)
+{
+    const Poly_Triangulation* mesh = part.triangulation.get();
+    nodeCoords->resize(3 * size_t(mesh->NbNodes()));
+    float* coords = nodeCoords->data();
+    for (int i = 1; i <= mesh->NbNodes(); ++i) {
+        gp_XYZ node = mesh->Node(i).XYZ();
+        part.trsf.Transforms(node);
+        *coords++ = float(node.X());
+        *coords++ = float(node.Y());
+        *coords++ = float(node.Z());
+    }
+}
+
+size_t meshPartsTriangleCount(Span<const MeshPart> parts)
+{
+    size_t count = 0;
+    for (const MeshPart& part : parts)
+        count += part.triangulation->NbTriangles();
+
+    return count;
+}
+
+// Returns the normals of the triangulations of 'parts', see MeshUtils::cachedTriangulationNormals()
+std::vector<std::shared_ptr<const MeshUtils::TriangulationNormals>> meshPartsNormals(Span<const MeshPart> parts)
+{
+    std::vector<std::shared_ptr<const MeshUtils::TriangulationNormals>> vecNormals(parts.size());
+    const int partCount = int(parts.size());
+    const int taskCount = concurrentTaskCount(partCount);
+    auto fnTask = [&](int iTask) {
+        for (int i = (iTask * partCount) / taskCount; i < ((iTask + 1) * partCount) / taskCount; ++i)
+            vecNormals.at(i) = MeshUtils::cachedTriangulationNormals(parts[i].triangulation);
+    };
+    if (taskCount > 1)
+        TaskManager::runConcurrently(taskCount, nullptr, [&](int iTask, TaskProgress*) { fnTask(iTask); });
+    else
+        fnTask(0);
+
+    return vecNormals;
+}
+
+// Parts to be written as binary STL facets, with data shared by the encoding tasks
+struct BinaryFacetSource {
+    Span<const MeshPart> parts;
+    std::vector<size_t> vecPartOffset; // Index of the first facet of each part
+    std::vector<std::shared_ptr<const MeshUtils::TriangulationNormals>> vecPartNormals;
+    size_t facetCount = 0;
+
+    BinaryFacetSource(Span<const MeshPart> meshParts)
+        : parts(meshParts),
+          vecPartNormals(meshPartsNormals(meshParts))
+    {
+        for (const MeshPart& part : parts) {
+            this->vecPartOffset.push_back(this->facetCount);
+            this->facetCount += part.triangulation->NbTriangles();
+        }
+    }
+};
+
+// Encodes the binary STL records of facets [first, last[ into 'bytes', returns false on abort request
+// Nodes of a transformed part are transformed once into a contiguous buffer when the range covers
+// enough of its triangles, instead of three times per triangle(a node is shared by six triangles on
+// average)
+bool encodeBinaryFacets(
+        const BinaryFacetSource& src, size_t first, size_t last, uint8_t* bytes, TaskProgress* progress)
+{
+    if (first >= last)
+        return true;
+
+    std::vector<float> vecNodeCoords;
+    auto itPart = std::upper_bound(src.vecPartOffset.cbegin(), src.vecPartOffset.cend(), first);
+    size_t iPart = (itPart - src.vecPartOffset.cbegin()) - 1;
+    size_t i = first;
+    while (i < last) {
+        while (i - src.vecPartOffset.at(iPart) >= size_t(src.parts[iPart].triangulation->NbTriangles()))
+            ++iPart;
+
+        const MeshPart& part = src.parts[iPart];
+        const MeshUtils::NormalArray& triNormals = src.vecPartNormals.at(iPart)->triangles;
+        const size_t partOffset = src.vecPartOffset.at(iPart);
+        const size_t partLast = std::min(partOffset + part.triangulation->NbTriangles(), last);
+        const bool useNodeBuffer =
+                hasTransformation(part)
+                && 3 * (partLast - i) >= size_t(part.triangulation->NbNodes());
+        if (useNodeBuffer)
+            transformMeshPartNodes(part, &vecNodeCoords);
+
+        for (; i < partLast; ++i) {
+            const int iTriangle = int(i - partOffset) + 1;
+            uint8_t* facetBytes = bytes + (i - first) * BinaryFacetSize;
+            if (useNodeBuffer)
+                writeBinaryFacet(part, triNormals, iTriangle, vecNodeCoords.data(), facetBytes);
+            else
+                writeBinaryFacet(part, triNormals, iTriangle, facetBytes);
+
+            if (!TaskProgress::checkLoopProgress(progress, i, first, last))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+// Calls fn(part, triNormals, iTriangle) for all triangles of 'parts', returns false on abort request
+template<typename FN>
+bool forEachMeshPartTriangle(Span<const MeshPart> parts, TaskProgress* progress, FN fn)
+{
+    const size_t triangleCount = meshPartsTriangleCount(parts);
+    const auto vecPartNormals = meshPartsNormals(parts);
+    size_t iGlobalTriangle = 0;
+    for (size_t iPart = 0; iPart < parts.size(); ++iPart) {
+        const MeshPart& part = parts[iPart];
+        const MeshUtils::NormalArray& triNormals = vecPartNormals.at(iPart)->triangles;
+        for (int i = 1; i <= part.triangulation->NbTriangles(); ++i) {
+            fn(part, triNormals, i);
+            if (!TaskProgress::checkLoopProgress(progress, ++iGlobalTriangle, 0, triangleCount))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+} // namespace
+
+bool isBinary(Span<const uint8_t> data)
+{
+    const size_t dataSize = data.size();
+    if (dataSize < BinaryHeaderSize)
+        return false;
+
+    const size_t facetCount = qFromLittleEndian<quint32>(data.data() + 80);
+    const size_t expectedSize = BinaryHeaderSize + facetCount * BinaryFacetSize;
+    if (dataSize == expectedSize)
+        return true;
+
+    // Some writers append data after the facets, ASCII STL always starts with "solid"
+    return dataSize > expectedSize && std::memcmp(data.data(), "solid", 5) != 0;
+}
+
+Handle_Poly_Triangulation readBinaryStream(
+        std::istream& istr, uint64_t contentsSize, std::vector<uint8_t>* contentsBegin, TaskProgress* progress)
+{
+    const size_t headerOffset = contentsBegin->size();
+    contentsBegin->resize(headerOffset + BinaryHeaderSize);
+    istr.read(reinterpret_cast<char*>(contentsBegin->data() + headerOffset), BinaryHeaderSize);
+    contentsBegin->resize(headerOffset + size_t(istr.gcount()));
+    if (contentsBegin->size() - headerOffset < BinaryHeaderSize)
+        return {};
+
+    const uint8_t* header = contentsBegin->data() + headerOffset;
+    const size_t facetCount = qFromLittleEndian<quint32>(header + 80);
+    const size_t vertexCount = 3 * facetCount;
+    if (facetCount == 0 || vertexCount > size_t(INT_MAX))
+        return {};
+
+    // Trailing data(see isBinary()) is not supported, the layout has to match exactly
+    if (contentsSize != BinaryHeaderSize + facetCount * BinaryFacetSize)
+        return {};
+
+    constexpr size_t blockFacetCount = 4096;
+    std::vector<uint8_t> block(blockFacetCount * BinaryFacetSize);
+    Handle_Poly_Triangulation mesh = new Poly_Triangulation(int(vertexCount), int(facetCount), false);
+    for (size_t first = 0; first < facetCount; first += blockFacetCount) {
+        const size_t count = std::min(blockFacetCount, facetCount - first);
+        istr.read(reinterpret_cast<char*>(block.data()), std::streamsize(count * BinaryFacetSize));
+        if (size_t(istr.gcount()) != count * BinaryFacetSize)
+            return {};
+
+        for (size_t i = 0; i < count; ++i) {
+            const int n1 = int(3 * (first + i) + 1);
+            for (int j = 0; j < 3; ++j)
+                setNode(mesh.get(), n1 + j, VertexKey::read(binaryFacetVertex(block.data(), i, j)).toPoint());
+
+            setTriangle(mesh.get(), int(first + i + 1), Poly_Triangle(n1, n1 + 1, n1 + 2));
+        }
+
+        if (!TaskProgress::checkLoopProgress(progress, first + count, 0, facetCount))
+            return {};
+    }
+
+    // Header is not needed by the caller anymore
+    contentsBegin->resize(headerOffset);
+    return mesh;
+}
+
+Handle_Poly_Triangulation readBinary(Span<const uint8_t> data, const Options& options, TaskProgress* progress)
+{
+    if (!isBinary(data))
+        return {};
+
+    const size_t facetCount = qFromLittleEndian<quint32>(data.data() + 80);
+    const size_t vertexCount = 3 * facetCount;
+    if (facetCount == 0 || vertexCount > size_t(INT_MAX))
+        return {};
+
+    const uint8_t* facets = data.data() + BinaryHeaderSize;
+    const int taskCount = concurrentTaskCount(int(facetCount));
+    auto fnTaskFacetRange = [=](int iTask) {
+        return std::make_pair((iTask * facetCount) / taskCount, ((iTask + 1) * facetCount) / taskCount);
+    };
+
+    if (!options.weldVertices) {
+        // Each facet is independent: nodes 3i+1, 3i+2, 3i+3 belong to triangle i+1
+        Handle_Poly_Triangulation mesh = new Poly_Triangulation(int(vertexCount), int(facetCount), false);
+        const bool ok = TaskManager::runConcurrently(taskCount, progress, [&](int iTask, TaskProgress* taskProgress) {
+            const auto [first, last] = fnTaskFacetRange(iTask);
+            for (size_t i = first; i < last; ++i) {
+                if (!TaskProgress::checkLoopProgress(taskProgress, i, first, last))
+                    return;
+
+                const int n1 = int(3 * i + 1);
+                for (int j = 0; j < 3; ++j)
+                    setNode(mesh.get(), n1 + j, VertexKey::read(binaryFacetVertex(facets, i, j)).toPoint());
+
+                setTriangle(mesh.get(), int(i + 1), Poly_Triangle(n1, n1 + 1, n1 + 2));
+            }
+        });
+        return ok ? mesh : Handle_Poly_Triangulation();
+    }
+
+    // Welding: vertices are partitioned into shards by hash value, each task handles one shard so
+    // there is no shared map. Node indices are first local to shards then made global
+    std::vector<int> vecVertexNode(vertexCount);
+    std::vector<std::vector<VertexKey>> vecShardNodes(taskCount);
+    auto fnVertexKey = [=](size_t iVertex) {
+        return VertexKey::read(binaryFacetVertex(facets, iVertex / 3, int(iVertex % 3)));
+    };
+
+    {
+        TaskProgress weldProgress(progress, 50);
+        const bool ok = TaskManager::runConcurrently(taskCount, &weldProgress, [&](int iShard, TaskProgress* taskProgress) {
+            std::unordered_map<VertexKey, int, VertexKeyHasher> mapNode;
+            std::vector<VertexKey>& vecNode = vecShardNodes.at(iShard);
+            for (size_t i = 0; i < vertexCount; ++i) {
+                if (!TaskProgress::checkLoopProgress(taskProgress, i, 0, vertexCount))
+                    return;
+
+                const VertexKey key = fnVertexKey(i);
+                if (int(key.hash() % taskCount) != iShard)
+                    continue;
+
+                const auto [it, isNew] = mapNode.try_emplace(key, int(vecNode.size()));
+                if (isNew)
+                    vecNode.push_back(key);
+
+                vecVertexNode[i] = it->second;
+            }
+        });
+        if (!ok)
+            return {};
+    }
+
+    std::vector<int> vecShardOffset(taskCount + 1, 0);
+    for (int iShard = 0; iShard < taskCount; ++iShard)
+        vecShardOffset.at(iShard + 1) = vecShardOffset.at(iShard) + int(vecShardNodes.at(iShard).size());
+
+    Handle_Poly_Triangulation mesh = new Poly_Triangulation(vecShardOffset.back(), int(facetCount), false);
+    {
+        TaskProgress nodeProgress(progress, 25);
+        const bool ok = TaskManager::runConcurrently(taskCount, &nodeProgress, [&](int iShard, TaskProgress* taskProgress) {
+            const int nodeOffset = vecShardOffset.at(iShard) + 1; // Poly_Triangulation indices are 1-based
+            std::vector<VertexKey>& vecNode = vecShardNodes.at(iShard);
+            for (size_t i = 0; i < vecNode.size(); ++i)
+                setNode(mesh.get(), nodeOffset + int(i), vecNode.at(i).toPoint());
+
+            std::vector<VertexKey>().swap(vecNode); // Release memory early
+            for (size_t i = 0; i < vertexCount; ++i) {
+                if (!TaskProgress::checkLoopProgress(taskProgress, i, 0, vertexCount))
+                    return;
+
+                if (int(fnVertexKey(i).hash() % taskCount) == iShard)
+                    vecVertexNode[i] += nodeOffset;
+            }
+        });
+        if (!ok)
+            return {};
+    }
+
+    {
+        TaskProgress triangleProgress(progress, 25);
+        const bool ok = TaskManager::runConcurrently(taskCount, &triangleProgress, [&](int iTask, TaskProgress* taskProgress) {
+            const auto [first, last] = fnTaskFacetRange(iTask);
+            for (size_t i = first; i < last; ++i) {
+                if (!TaskProgress::checkLoopProgress(taskProgress, i, first, last))
+                    return;
+
+                const int* nodes = &vecVertexNode[3 * i];
+                setTriangle(mesh.get(), int(i + 1), Poly_Triangle(nodes[0], nodes[1], nodes[2]));
+            }
+        });
+        if (!ok)
+            return {};
+    }
+
+    return mesh;
+}
+
+Handle_Poly_Triangulation readAscii(Span<const uint8_t> data, TaskProgress* progress)
+{
+    const char* dataBegin = reinterpret_cast<const char*>(data.data());
+    const char* dataEnd = dataBegin + data.size();
+    constexpr size_t minChunkSize = 1 << 20;
+    const int chunkCount = concurrentTaskCount(int(std::min<size_t>(INT_MAX, 1 + data.size() / minChunkSize)));
+
+    // Chunks contain complete facets, so vertex count of each chunk is a multiple of 3
+    struct Chunk {
+        const char* begin = nullptr;
+        const char* end = nullptr;
+        size_t vertexCount = 0;
+        size_t vertexOffset = 0;
+    };
+    std::vector<Chunk> vecChunk(chunkCount);
+    const char* chunkBegin = dataBegin;
+    for (Chunk& chunk : vecChunk) {
+        const int iChunk = &chunk - &vecChunk.front();
+        const char* chunkNominalEnd = dataBegin + ((iChunk + 1) * data.size()) / chunkCount;
+        chunk.begin = chunkBegin;
+        chunk.end = iChunk + 1 < chunkCount ? findAsciiFacetEnd(std::max(chunkBegin, chunkNominalEnd), dataEnd) : dataEnd;
+        chunkBegin = chunk.end;
+    }
+
+    {   // Count vertices to allocate the triangulation upfront
+        TaskProgress countProgress(progress, 20);
+        const bool ok = TaskManager::runConcurrently(chunkCount, &countProgress, [&](int iChunk, TaskProgress*) {
+            Chunk& chunk = vecChunk.at(iChunk);
+            forEachAsciiVertexKeyword(chunk.begin, chunk.end, [&](const char*) {
+                ++chunk.vertexCount;
+                return true;
+            });
+        });
+        if (!ok)
+            return {};
+    }
+
+    size_t vertexCount = 0;
+    for (Chunk& chunk : vecChunk) {
+        if (chunk.vertexCount % 3 != 0)
+            return {};
+
+        chunk.vertexOffset = vertexCount;
+        vertexCount += chunk.vertexCount;
+    }
+
+    if (vertexCount == 0 || vertexCount > size_t(INT_MAX))
+        return {};
+
+    Handle_Poly_Triangulation mesh = new Poly_Triangulation(int(vertexCount), int(vertexCount / 3), false);
+    std::atomic<bool> isMalformed = false;
+    TaskProgress parseProgress(progress, 80);
+    const bool ok = TaskManager::runConcurrently(chunkCount, &parseProgress, [&](int iChunk, TaskProgress* taskProgress) {
+        const Chunk& chunk = vecChunk.at(iChunk);
+        const size_t chunkSize = std::max<ptrdiff_t>(1, chunk.end - chunk.begin);
+        int nodeIndex = int(chunk.vertexOffset) + 1;
+        forEachAsciiVertexKeyword(chunk.begin, chunk.end, [&](const char* ptr) {
+            float coords[3];
+            for (float& coord : coords) {
+                ptr = parseAsciiFloat(ptr, chunk.end, &coord);
+                if (!ptr) {
+                    isMalformed = true;
+                    return false;
+                }
+            }
+
+            setNode(mesh.get(), nodeIndex, gp_Pnt(coords[0], coords[1], coords[2]));
+            if (nodeIndex % 3 == 0) // Chunk vertex offsets are multiple of 3
+                setTriangle(mesh.get(), nodeIndex / 3, Poly_Triangle(nodeIndex - 2, nodeIndex - 1, nodeIndex));
+
+            if (nodeIndex % (1 << 16) == 0) {
+                taskProgress->setValue(int((100 * size_t(ptr - chunk.begin)) / chunkSize));
+                if (TaskProgress::isAbortRequested(taskProgress))
+                    return false;
+            }
+
+            ++nodeIndex;
+            return !isMalformed;
+        });
+    });
+
+    if (!ok || isMalformed)
+        return {};
+
+    return mesh;
+}
+
+std::vector<MeshPart> meshParts(const TopoDS_Shape& shape, const gp_Trsf& trsf, int solid)
+{
+    std::vector<MeshPart> parts;
+    BRepUtils::forEachSubFace(shape, [&](const TopoDS_Face& face) {
+        TopLoc_Location loc;
+        const Handle_Poly_Triangulation& mesh = BRep_Tool::Triangulation(face, loc);
+        if (!mesh.IsNull() && mesh->NbTriangles() > 0)
+            parts.push_back({ mesh, trsf * loc.Transformation(), face.Orientation() == TopAbs_REVERSED, solid });
+    });
+
+    return parts;
+}
+
+bool writeBinary(Span<const MeshPart> parts, const FilePath& filepath, TaskProgress* progress, bool parallel)
+{
+    const BinaryFacetSource src(parts);
+    const size_t facetCount = src.facetCount;
+    if (facetCount > UINT32_MAX)
+        return false;
+
+    QFile file(filepathTo<QString>(filepath));
+    if (!file.open(QIODevice::ReadWrite | QIODevice::Truncate))
+        return false;
+
+    auto fnWriteHeader = [=](uint8_t* header) {
+        std::memset(header, 0, BinaryHeaderSize);
+        const std::string_view headerText = "Binary STL file written by Mayo";
+        std::memcpy(header, headerText.data(), headerText.size());
+        qToLittleEndian<quint32>(quint32(facetCount), header + 80);
+    };
+
+    const qint64 fileSize = BinaryHeaderSize + facetCount * BinaryFacetSize;
+    uchar* fileData = nullptr;
+    if (parallel && file.resize(fileSize))
+        fileData = file.map(0, fileSize);
+
+    const int taskCount = parallel ? concurrentTaskCount(int(std::min<size_t>(facetCount, INT_MAX))) : 1;
+    if (fileData) {
+        fnWriteHeader(fileData);
+        uint8_t* facets = fileData + BinaryHeaderSize;
+        const bool ok = TaskManager::runConcurrently(taskCount, progress, [&](int iTask, TaskProgress* taskProgress) {
+            const size_t first = (iTask * facetCount) / taskCount;
+            const size_t last = ((iTask + 1) * facetCount) / taskCount;
+            encodeBinaryFacets(src, first, last, facets + first * BinaryFacetSize, taskProgress);
+        });
+
+        return file.unmap(fileData) && ok;
+    }
+
+    // Facets are encoded block by block into a contiguous buffer, concurrently if 'parallel' is on,
+    // then each block is written at once. Memory usage is bounded by the block size
+    constexpr size_t blockMaxFacetCount = (32 * 1024 * 1024) / BinaryFacetSize;
+    file.resize(0);
+    std::vector<uint8_t> block(BinaryHeaderSize);
+    fnWriteHeader(block.data());
+    if (file.write(reinterpret_cast<const char*>(block.data()), BinaryHeaderSize) != qint64(BinaryHeaderSize))
+        return false;
+
+    block.resize(std::min(facetCount, blockMaxFacetCount) * BinaryFacetSize);
+    for (size_t blockFirst = 0; blockFirst < facetCount; blockFirst += blockMaxFacetCount) {
+        const size_t blockLast = std::min(blockFirst + blockMaxFacetCount, facetCount);
+        const size_t blockFacetCount = blockLast - blockFirst;
+        auto fnEncode = [&](int iTask) {
+            const size_t first = blockFirst + (iTask * blockFacetCount) / taskCount;
+            const size_t last = blockFirst + ((iTask + 1) * blockFacetCount) / taskCount;
+            encodeBinaryFacets(src, first, last, block.data() + (first - blockFirst) * BinaryFacetSize, nullptr);
+        };
+        if (taskCount > 1)
+            TaskManager::runConcurrently(taskCount, nullptr, [&](int iTask, TaskProgress*) { fnEncode(iTask); });
+        else
+            fnEncode(0);
+
+        const qint64 blockSize = blockFacetCount * BinaryFacetSize;
+        if (file.write(reinterpret_cast<const char*>(block.data()), blockSize) != blockSize)
+            return false;
+
+        if (progress) {
+            progress->setValue(int((100 * blockLast) / facetCount));
+            if (progress->isAbortRequested())
+                return false;
+        }
+    }
+
+    return true;
+}
+
+bool writeAscii(
+        Span<const MeshPart> parts,
+        const FilePath& filepath,
+        TaskProgress* progress,
+        Span<const std::string> solidNames)
+{
+    QFile file(filepathTo<QString>(filepath));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    FileSink sink(&file);
+    std::string line;
+    auto fnAppendXYZ = [&](const char* keyword, const gp_XYZ& coords) {
+        line = keyword;
+        for (double value : { coords.X(), coords.Y(), coords.Z() }) {
+            line += ' ';
+            TextNumber::append(&line, value, TextNumber::Format::Scientific, 9);
+        }
+
+        line += '\n';
+        sink.append(line);
+    };
+
+    // Solids are opened/closed as parts go, empty solids(items without triangles) are written too
+    int iSolid = 0;
+    auto fnAppendSolidKeyword = [&](std::string_view keyword) {
+        sink.append(keyword);
+        if (iSolid < int(solidNames.size())) {
+            sink.append(" ");
+            sink.append(solidNames[iSolid]);
+        }
+
+        sink.append("\n");
+    };
+    auto fnAdvanceToSolid = [&](int solid) {
+        while (iSolid < solid && iSolid + 1 < int(solidNames.size())) {
+            fnAppendSolidKeyword("endsolid");
+            ++iSolid;
+            fnAppendSolidKeyword("solid");
+        }
+    };
+
+    fnAppendSolidKeyword("solid");
+    const bool ok = forEachMeshPartTriangle(parts, progress, [&](
+            const MeshPart& part, const MeshUtils::NormalArray& triNormals, int iTriangle)
+    {
+        if (iTriangle == 1)
+            fnAdvanceToSolid(part.solid);
+
+        const Facet facet = meshPartFacet(part, triNormals, iTriangle);
+        fnAppendXYZ(" facet normal", facet.normal);
+        sink.append("  outer loop\n");
+        for (const gp_XYZ& vertex : facet.vertex)
+            fnAppendXYZ("   vertex", vertex);
+
+        sink.append("  endloop\n endfacet\n");
+    });
+    if (ok)
+        fnAdvanceToSolid(int(solidNames.size()) - 1);
+
+    fnAppendSolidKeyword("endsolid");
+    return ok && sink.flush();
+}
+
+} // namespace StlNative
+} // namespace IO
+} // namespace Mayo
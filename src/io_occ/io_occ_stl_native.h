@@ -0,0 +1,86 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "../base/filepath.h"
+#include "../base/span.h"
+#include <Poly_Triangulation.hxx>
+#include <TopoDS_Shape.hxx>
+#include <gp_Trsf.hxx>
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace Mayo {
+
+class TaskProgress;
+
+namespace IO {
+
+// Mayo-native decoding/encoding of STL contents
+// Decoding builds a Poly_Triangulation directly, contents are expected to be memory-mapped and
+// decoding is split into concurrent tasks
+// Encoding streams the facets of triangulations through a buffered sink, transformations being
+// applied on the fly so no aggregated copy of the mesh data is created
+namespace StlNative {
+
+struct Options {
+    // Merge the vertices having the same coordinates, this typically divides memory usage by 3
+    bool weldVertices = false;
+};
+
+// Returns true if 'data' is a binary STL, checked against the facet count found in the header
+bool isBinary(Span<const uint8_t> data);
+
+// Returns null triangulation in case of malformed contents or abort request
+Handle_Poly_Triangulation readBinary(Span<const uint8_t> data, const Options& options, TaskProgress* progress);
+
+// Decodes binary STL contents while they are read from 'istr'(ex: a download stream), facets are
+// decoded block by block so decoding overlaps with the production of the stream
+// 'contentsSize' is the expected size of the whole contents, used to check the header is the one of
+// a binary STL before any facet is read. Bytes consumed from 'istr' are appended to '*contentsBegin'
+// if the contents turn out to be not a binary STL, so the caller can go on with readAscii()
+// Note: option 'weldVertices' is not supported
+// Returns null triangulation if contents are not a binary STL, on read error or abort request
+Handle_Poly_Triangulation readBinaryStream(
+        std::istream& istr, uint64_t contentsSize, std::vector<uint8_t>* contentsBegin, TaskProgress* progress);
+
+// Contents are split at "endfacet" keywords into chunks parsed concurrently
+// Note: option 'weldVertices' is not supported
+// Returns null triangulation in case of malformed contents or abort request
+Handle_Poly_Triangulation readAscii(Span<const uint8_t> data, TaskProgress* progress);
+
+// Triangulation to be written, with its placement
+struct MeshPart {
+    Handle_Poly_Triangulation triangulation;
+    gp_Trsf trsf;
+    bool isReversed = false; // Triangles orientation has to be flipped
+    int solid = 0; // Index of the ASCII solid the part belongs to, see writeAscii()
+};
+
+// Returns the non-empty triangulations of the faces of 'shape', 'trsf' being applied on top of
+// their locations. Faces not meshed are ignored
+std::vector<MeshPart> meshParts(const TopoDS_Shape& shape, const gp_Trsf& trsf = {}, int solid = 0);
+
+// Option 'parallel': the output file is memory-mapped and filled by concurrent tasks, each one
+// writing a range of facets whose offset is known up front(binary records have fixed size)
+// Otherwise(or if the file can't be mapped) facets are encoded into a bounded memory block which is
+// written at once when full, block encoding being concurrent if 'parallel' is on
+bool writeBinary(Span<const MeshPart> parts, const FilePath& filepath, TaskProgress* progress, bool parallel = false);
+// If 'solidNames' is not empty then a "solid" block is written for each of the names, parts being
+// expected in increasing order of MeshPart::solid
+bool writeAscii(
+        Span<const MeshPart> parts,
+        const FilePath& filepath,
+        TaskProgress* progress,
+        Span<const std::string> solidNames = {});
+
+} // namespace StlNative
+
+} // namespace IO
+} // namespace Mayo
@@ -12,16 +12,137 @@
 #include "../base/math_utils.h"
 #include "../base/property_builtins.h"
 #include "../base/property_enumeration.h"
+#include "../base/task_manager.h"
 #include "../base/task_progress.h"
+#include "../base/text_number.h"
 #include "../base/tkernel_utils.h"
 
+#include <QtCore/QFile>
+#include <BRep_Tool.hxx>
 #include <OSD_OpenFile.hxx>
+#include <Poly_PolygonOnTriangulation.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopoDS.hxx>
+#include <TopTools_MapOfShape.hxx>
 #include <VrmlData_ShapeConvert.hxx>
+#include <gp_Quaternion.hxx>
+#include <algorithm>
 #include <fstream>
+#include <thread>
+#include <unordered_map>
 
 namespace Mayo {
 namespace IO {
 
+namespace {
+
+void appendVrmlValues(std::string* str, std::initializer_list<double> values)
+{
+    for (double value : values) {
+        str->push_back(' ');
+        TextNumber::append(str, value, TextNumber::Format::General, 9);
+    }
+}
+
+std::string vrmlPrototypeName(int prototypeId)
+{
+    return "Proto_" + std::to_string(prototypeId);
+}
+
+// Returns the VRML Group node(DEF'ed) of all the triangulations of 'shape'
+// Faces are merged into a single IndexedFaceSet, edges into a single IndexedLineSet
+std::string vrmlPrototypeText(
+        const TopoDS_Shape& shape, const Quantity_Color* color, int prototypeId, bool shaded, bool wireframe)
+{
+    std::string facePoints;
+    std::string faceIndices;
+    std::string edgePoints;
+    std::string edgeIndices;
+    int faceNodeOffset = 0;
+    int edgeNodeOffset = 0;
+    TopTools_MapOfShape mapEdge;
+    for (TopExp_Explorer expFace(shape, TopAbs_FACE); expFace.More(); expFace.Next()) {
+        const TopoDS_Face& face = TopoDS::Face(expFace.Current());
+        TopLoc_Location loc;
+        const Handle_Poly_Triangulation& mesh = BRep_Tool::Triangulation(face, loc);
+        if (mesh.IsNull())
+            continue;
+
+        const gp_Trsf& trsf = loc.Transformation();
+        if (shaded) {
+            for (int i = 1; i <= mesh->NbNodes(); ++i) {
+                const gp_Pnt pnt = mesh->Node(i).Transformed(trsf);
+                appendVrmlValues(&facePoints, { pnt.X(), pnt.Y(), pnt.Z() });
+                facePoints += ",\n";
+            }
+
+            const bool isReversed = face.Orientation() == TopAbs_REVERSED;
+            for (int i = 1; i <= mesh->NbTriangles(); ++i) {
+                int n1, n2, n3;
+                mesh->Triangle(i).Get(n1, n2, n3);
+                if (isReversed)
+                    std::swap(n2, n3);
+
+                faceIndices += std::to_string(faceNodeOffset + n1 - 1) + ' ';
+                faceIndices += std::to_string(faceNodeOffset + n2 - 1) + ' ';
+                faceIndices += std::to_string(faceNodeOffset + n3 - 1) + " -1,\n";
+            }
+
+            faceNodeOffset += mesh->NbNodes();
+        }
+
+        if (wireframe) {
+            for (TopExp_Explorer expEdge(face, TopAbs_EDGE); expEdge.More(); expEdge.Next()) {
+                const TopoDS_Edge& edge = TopoDS::Edge(expEdge.Current());
+                if (!mapEdge.Add(edge))
+                    continue;
+
+                Handle_Poly_PolygonOnTriangulation polygon = BRep_Tool::PolygonOnTriangulation(edge, mesh, loc);
+                if (polygon.IsNull())
+                    continue;
+
+                const TColStd_Array1OfInteger& nodes = polygon->Nodes();
+                for (int i = nodes.Lower(); i <= nodes.Upper(); ++i) {
+                    const gp_Pnt pnt = mesh->Node(nodes.Value(i)).Transformed(trsf);
+                    appendVrmlValues(&edgePoints, { pnt.X(), pnt.Y(), pnt.Z() });
+                    edgePoints += ",\n";
+                    edgeIndices += std::to_string(edgeNodeOffset++) + ' ';
+                }
+
+                edgeIndices += "-1,\n";
+            }
+        }
+    }
+
+    std::string text = "DEF " + vrmlPrototypeName(prototypeId) + " Group {\nchildren [\n";
+    if (!faceIndices.empty()) {
+        text += "Shape {\nappearance Appearance { material Material {";
+        if (color) {
+            text += " diffuseColor";
+            appendVrmlValues(&text, { color->Red(), color->Green(), color->Blue() });
+        }
+
+        text += " } }\ngeometry IndexedFaceSet {\nsolid FALSE\ncoord Coordinate { point [\n";
+        text += facePoints;
+        text += "] }\ncoordIndex [\n";
+        text += faceIndices;
+        text += "]\n}\n}\n";
+    }
+
+    if (!edgeIndices.empty()) {
+        text += "Shape {\ngeometry IndexedLineSet {\ncoord Coordinate { point [\n";
+        text += edgePoints;
+        text += "] }\ncoordIndex [\n";
+        text += edgeIndices;
+        text += "]\n}\n}\n";
+    }
+
+    text += "]\n}\n";
+    return text;
+}
+
+} // namespace
+
 class OccVrmlWriter::Properties : public PropertyGroup {
     MAYO_DECLARE_TEXT_ID_FUNCTIONS(Mayo::IO::OccVrmlWriter::Properties)
 public:
@@ -29,21 +150,75 @@ public:
         : PropertyGroup(parentGroup)
     {
         this->shapeRepresentation.mutableEnumeration().chopPrefix("VrmlAPI_");
+        this->nativeStreaming.setDescription(
+                    textIdTr("Stream shapes into the file with Mayo-native writer: part prototypes are "
+                             "formatted concurrently and written once(DEF/USE).\n"
+                             "Otherwise the whole VRML scene is built in memory with OpenCascade"));
     }
 
     void restoreDefaults() override {
         const OccVrmlWriter::Parameters params;
         this->shapeRepresentation.setValue(params.shapeRepresentation);
+        this->nativeStreaming.setValue(params.nativeStreaming);
     }
 
 //    PropertyBool m_meshDeflectionFromShapeRelativeSize;
 //    PropertyDouble m_meshDeflection;
 //    PropertyDouble scale;
     PropertyEnum<VrmlAPI_RepresentationOfShape> shapeRepresentation{ this, textId("shapeRepresentation") };
+    PropertyBool nativeStreaming{ this, textId("nativeStreaming") };
 };
 
 bool OccVrmlWriter::transfer(Span<const ApplicationItem> spanAppItem, TaskProgress* progress)
 {
+    m_scene.reset();
+    m_vecPrototype.clear();
+    m_vecOccurrence.clear();
+    if (m_params.nativeStreaming) {
+        std::unordered_map<TDF_Label, int> mapLabelPrototypeId;
+        auto fnAddOccurrence = [&](const DocumentPtr& doc, TreeNodeId id) {
+            const Tree<TDF_Label>& modelTree = doc->modelTree();
+            const TDF_Label label = modelTree.nodeData(id);
+            if (!modelTree.nodeIsLeaf(id) || !XCaf::isShape(label))
+                return;
+
+            auto [itProto, isNew] = mapLabelPrototypeId.insert({ label, int(m_vecPrototype.size()) });
+            if (isNew) {
+                Prototype proto;
+                const auto attrs = doc->labelAttributesCache().attributes(label);
+                proto.shape = attrs->shape;
+                proto.hasColor = attrs->hasColor;
+                if (proto.hasColor)
+                    proto.color = attrs->color;
+
+                m_vecPrototype.push_back(std::move(proto));
+            }
+
+            Occurrence occurrence;
+            occurrence.prototypeId = itProto->second;
+            occurrence.trsf = doc->xcaf().shapeAbsoluteLocation(id).Transformation();
+            m_vecOccurrence.push_back(std::move(occurrence));
+        };
+
+        for (const ApplicationItem& appItem : spanAppItem) {
+            const DocumentPtr doc = appItem.document();
+            const Tree<TDF_Label>& modelTree = doc->modelTree();
+            if (appItem.isDocument()) {
+                traverseTree(modelTree, [&](TreeNodeId id) { fnAddOccurrence(doc, id); });
+            }
+            else if (appItem.isDocumentTreeNode()) {
+                traverseTree(appItem.documentTreeNode().id(), modelTree, [&](TreeNodeId id) {
+                    fnAddOccurrence(doc, id);
+                });
+            }
+
+            const int index = &appItem - &spanAppItem.front();
+            progress->setValue(MathUtils::mappedValue(index, 0, spanAppItem.size() - 1, 0, 100));
+        }
+
+        return true;
+    }
+
     m_scene.reset(new VrmlData_Scene);
     VrmlData_ShapeConvert converter(*m_scene);
     for (const ApplicationItem& appItem : spanAppItem) {
@@ -64,15 +239,18 @@ bool OccVrmlWriter::transfer(Span<const ApplicationItem> spanAppItem, TaskProgre
         progress->setValue(MathUtils::mappedValue(index, 0, spanAppItem.size() - 1, 0, 100));
     }
 
-    const auto rep = m_shapeRepresentation;
+    const auto rep = m_params.shapeRepresentation;
     converter.Convert(
                 rep == VrmlAPI_ShadedRepresentation || rep == VrmlAPI_BothRepresentation,
                 rep == VrmlAPI_WireFrameRepresentation || rep == VrmlAPI_BothRepresentation);
     return true;
 }
 
-bool OccVrmlWriter::writeFile(const FilePath& filepath, TaskProgress*)
+bool OccVrmlWriter::writeFile(const FilePath& filepath, TaskProgress* progress)
 {
+    if (m_params.nativeStreaming)
+        return this->writeFileNative(filepath, progress);
+
     if (!m_scene)
         return false;
 
@@ -87,6 +265,90 @@ bool OccVrmlWriter::writeFile(const FilePath& filepath, TaskProgress*)
     return false;
 }
 
+bool OccVrmlWriter::writeFileNative(const FilePath& filepath, TaskProgress* progress)
+{
+    QFile file(filepathTo<QString>(filepath));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    const auto rep = m_params.shapeRepresentation;
+    const bool shaded = rep == VrmlAPI_ShadedRepresentation || rep == VrmlAPI_BothRepresentation;
+    const bool wireframe = rep == VrmlAPI_WireFrameRepresentation || rep == VrmlAPI_BothRepresentation;
+    bool ok = true;
+    auto fnWrite = [&](const std::string& str) {
+        ok = ok && file.write(str.data(), str.size()) == qint64(str.size());
+    };
+
+    fnWrite("#VRML V2.0 utf8\n");
+
+    // Occurrences are processed by windows containing a bounded count of new prototypes, these are
+    // formatted concurrently and then written in order. Prototype is DEF'ed at its first occurrence
+    const int threadCount = std::max(1, int(std::thread::hardware_concurrency()));
+    const size_t maxWindowPrototypeCount = 2 * threadCount;
+    std::vector<std::string> vecPrototypeText(m_vecPrototype.size());
+    std::vector<bool> vecPrototypeScheduled(m_vecPrototype.size(), false);
+    std::vector<bool> vecPrototypeWritten(m_vecPrototype.size(), false);
+    size_t iOccurrence = 0;
+    while (iOccurrence < m_vecOccurrence.size() && ok) {
+        std::vector<int> vecWindowPrototypeId;
+        size_t iOccurrenceEnd = iOccurrence;
+        while (iOccurrenceEnd < m_vecOccurrence.size()) {
+            const int protoId = m_vecOccurrence.at(iOccurrenceEnd).prototypeId;
+            if (!vecPrototypeScheduled.at(protoId)) {
+                if (vecWindowPrototypeId.size() >= maxWindowPrototypeCount)
+                    break;
+
+                vecPrototypeScheduled.at(protoId) = true;
+                vecWindowPrototypeId.push_back(protoId);
+            }
+
+            ++iOccurrenceEnd;
+        }
+
+        TaskManager::runConcurrently(int(vecWindowPrototypeId.size()), nullptr, [&](int i, TaskProgress*) {
+            const int protoId = vecWindowPrototypeId.at(i);
+            const Prototype& proto = m_vecPrototype.at(protoId);
+            const Quantity_Color* color = proto.hasColor ? &proto.color : nullptr;
+            vecPrototypeText.at(protoId) = vrmlPrototypeText(proto.shape, color, protoId, shaded, wireframe);
+        });
+
+        for (size_t i = iOccurrence; i < iOccurrenceEnd; ++i) {
+            const Occurrence& occurrence = m_vecOccurrence.at(i);
+            std::string text = "Transform {\ntranslation";
+            const gp_XYZ translation = occurrence.trsf.TranslationPart();
+            appendVrmlValues(&text, { translation.X(), translation.Y(), translation.Z() });
+            gp_Vec rotationAxis(0, 0, 1);
+            double rotationAngle = 0;
+            occurrence.trsf.GetRotation().GetVectorAndAngle(rotationAxis, rotationAngle);
+            text += "\nrotation";
+            appendVrmlValues(&text, { rotationAxis.X(), rotationAxis.Y(), rotationAxis.Z(), rotationAngle });
+            text += "\nscale";
+            const double scale = occurrence.trsf.ScaleFactor();
+            appendVrmlValues(&text, { scale, scale, scale });
+            text += "\nchildren [\n";
+            const int protoId = occurrence.prototypeId;
+            if (!vecPrototypeWritten.at(protoId)) {
+                fnWrite(text);
+                fnWrite(vecPrototypeText.at(protoId));
+                vecPrototypeText.at(protoId) = {}; // Release memory
+                vecPrototypeWritten.at(protoId) = true;
+                text = "]\n}\n";
+            }
+            else {
+                text += "USE " + vrmlPrototypeName(protoId) + "\n]\n}\n";
+            }
+
+            fnWrite(text);
+        }
+
+        iOccurrence = iOccurrenceEnd;
+        progress->setValue(MathUtils::mappedValue(iOccurrence, 0, m_vecOccurrence.size(), 0, 100));
+        ok = ok && !TaskProgress::isAbortRequested(progress);
+    }
+
+    return ok;
+}
+
 std::unique_ptr<PropertyGroup> OccVrmlWriter::createProperties(PropertyGroup* parentGroup)
 {
     return std::make_unique<Properties>(parentGroup);
@@ -97,6 +359,7 @@ void OccVrmlWriter::applyProperties(const PropertyGroup* params)
     auto ptr = dynamic_cast<const Properties*>(params);
     if (ptr) {
         m_params.shapeRepresentation = static_cast<VrmlAPI_RepresentationOfShape>(ptr->shapeRepresentation);
+        m_params.nativeStreaming = ptr->nativeStreaming;
     }
 }
 
@@ -7,14 +7,21 @@
 #pragma once
 
 #include "../base/io_writer.h"
+#include <Quantity_Color.hxx>
+#include <TopoDS_Shape.hxx>
 #include <VrmlAPI_RepresentationOfShape.hxx>
 #include <VrmlData_Scene.hxx>
+#include <gp_Trsf.hxx>
 #include <memory>
+#include <vector>
 
 namespace Mayo {
 namespace IO {
 
-// Opencascade-based writer for VRML(v2.0 UTF8) file format
+// Writer for VRML(v2.0 UTF8) file format
+// By default shapes are written natively: each part prototype is DEF'ed once then USE'd by the
+// other occurrences, prototypes being formatted concurrently and streamed to the file in order
+// Otherwise OpenCascade VrmlData_Scene is built in memory and then serialized
 class OccVrmlWriter : public Writer {
 public:
     bool transfer(Span<const ApplicationItem> appItems, TaskProgress* progress) override;
@@ -27,15 +34,30 @@ public:
 
     struct Parameters {
         VrmlAPI_RepresentationOfShape shapeRepresentation = VrmlAPI_BothRepresentation;
+        bool nativeStreaming = true;
     };
     Parameters& parameters() { return m_params; }
     const Parameters& constParameters() const { return m_params; }
 
 private:
+    bool writeFileNative(const FilePath& filepath, TaskProgress* progress);
+
+    struct Prototype {
+        TopoDS_Shape shape;
+        Quantity_Color color;
+        bool hasColor = false;
+    };
+
+    struct Occurrence {
+        int prototypeId = -1;
+        gp_Trsf trsf;
+    };
+
     class Properties;
     Parameters m_params;
     std::unique_ptr<VrmlData_Scene> m_scene;
-    VrmlAPI_RepresentationOfShape m_shapeRepresentation = VrmlAPI_BothRepresentation;
+    std::vector<Prototype> m_vecPrototype;
+    std::vector<Occurrence> m_vecOccurrence;
 };
 
 } // namespace IO
@@ -0,0 +1,208 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "io_converter.h"
+
+#include "../base/application.h"
+#include "../base/application_item.h"
+#include "../base/bnd_box_cache.h"
+#include "../base/brep_utils.h"
+#include "../base/document.h"
+#include "../base/io_parameters_provider.h"
+#include "../base/io_reader.h"
+#include "../base/messenger.h"
+#include "../base/task_progress.h"
+#include "../io_dxf/io_dxf.h"
+#include "../io_gmio/io_gmio.h"
+#include "../io_occ/io_occ.h"
+
+#include <QtCore/QStringList>
+#include <gsl/util>
+#include <mutex>
+
+namespace Mayo {
+namespace IO {
+
+namespace {
+
+ShapeMesher createShapeMesher(const Converter::Options& options)
+{
+    OccBRepMeshParameters params;
+    params.Deflection = options.meshLinearDeflection;
+    params.Angle = options.meshAngularDeflection;
+    params.Relative = options.meshRelative;
+    params.InParallel = true;
+    return [=](const TopoDS_Shape& shape, TaskProgress* progress) {
+        BRepUtils::computeMesh(shape, params, progress);
+    };
+}
+
+} // namespace
+
+Converter::Converter()
+{
+    // Factories are stateless, actual readers/writers are created on first use of a format
+    m_system.addFactoryReader(std::make_unique<OccFactoryReader>());
+    m_system.addFactoryReader(std::make_unique<DxfFactoryReader>());
+    m_system.addFactoryReader(GmioFactoryReader::create());
+    m_system.addFactoryWriter(std::make_unique<OccFactoryWriter>());
+    m_system.addFactoryWriter(std::make_unique<DxfFactoryWriter>());
+    m_system.addFactoryWriter(GmioFactoryWriter::create());
+    addPredefinedFormatProbes(&m_system);
+}
+
+Converter::Result Converter::importFiles(
+        const DocumentPtr& doc, Span<const FilePath> filepaths, const Options& options)
+{
+    return this->execTask([&](Messenger* messenger, TaskProgress* progress) {
+        return m_system.importInDocument()
+                .targetDocument(doc)
+                .withFilepaths(filepaths)
+                .withParametersProvider(options.parametersProvider)
+                .withGeometryDeduplicated(options.deduplicateGeometry)
+                .withModelTreeBuiltConcurrently(options.concurrentModelTreeBuild)
+                .withMessenger(messenger)
+                .withTaskProgress(progress)
+                .execute();
+    }, options);
+}
+
+Converter::Result Converter::importBuffer(
+        const DocumentPtr& doc,
+        Span<const uint8_t> data,
+        const FilePath& nameHint,
+        Format format,
+        const Options& options)
+{
+    return this->execTask([&](Messenger* messenger, TaskProgress* progress) {
+        const Format fileFormat = format != Format_Unknown ? format : m_system.probeFormat(nameHint);
+        std::unique_ptr<Reader> reader = m_system.createReader(fileFormat);
+        if (!reader) {
+            messenger->emitError(tr("No supporting reader"));
+            return false;
+        }
+
+        reader->setMessenger(messenger);
+        if (options.parametersProvider)
+            options.parametersProvider->applyReaderParameters(fileFormat, reader.get());
+
+        {
+            TaskProgress readProgress(progress, 40, tr("Reading contents"));
+            if (!reader->readBuffer(data, nameHint, &readProgress)) {
+                messenger->emitError(tr("Read problem"));
+                return false;
+            }
+        }
+
+        TaskProgress transferProgress(progress, 60, tr("Transferring contents"));
+        if (TaskProgress::isAbortRequested(&transferProgress))
+            return false;
+
+        const TDF_LabelSequence seqEntity = reader->transfer(doc, &transferProgress);
+        if (seqEntity.IsEmpty()) {
+            messenger->emitError(tr("Transfer problem"));
+            return false;
+        }
+
+        doc->bndBoxCache().computePrototypeBoxes(seqEntity);
+        for (const TDF_Label& labelEntity : seqEntity)
+            doc->addEntityTreeNode(labelEntity);
+
+        return true;
+    }, options);
+}
+
+Converter::Result Converter::exportDocument(
+        const DocumentPtr& doc, const FilePath& filepath, Format format, const Options& options)
+{
+    return this->execTask([&](Messenger* messenger, TaskProgress* progress) {
+        const Format targetFormat = format != Format_Unknown ? format : m_system.probeFormat(filepath);
+        const ApplicationItem appItem(doc);
+        const PropertyGroup* params =
+                options.parametersProvider ? options.parametersProvider->findWriterParameters(targetFormat) : nullptr;
+        auto operation = m_system.exportApplicationItems();
+        operation.targetFile(filepath)
+                .targetFormat(targetFormat)
+                .withItems(Span<const ApplicationItem>(&appItem, 1))
+                .withParameters(params)
+                .withMessenger(messenger)
+                .withTaskProgress(progress);
+        // Shapes not meshed yet are meshed on the fly by writers supporting it
+        if (formatProvidesMesh(targetFormat))
+            operation.withShapeMesher(createShapeMesher(options));
+
+        return operation.execute();
+    }, options);
+}
+
+Converter::Result Converter::convertFiles(
+        Span<const FilePath> filepathsIn, const FilePath& filepathOut, const Options& options)
+{
+    auto app = Application::instance();
+    const DocumentPtr doc = app->newDocument();
+    auto _ = gsl::finally([&]{ app->closeDocument(doc); });
+
+    // Progress of import and export are reported as halves of the whole conversion
+    Options importOptions = options;
+    Options exportOptions = options;
+    if (options.progress) {
+        importOptions.progress = [=](int pct) { return options.progress(pct / 2); };
+        exportOptions.progress = [=](int pct) { return options.progress(50 + pct / 2); };
+    }
+
+    const Result importResult = this->importFiles(doc, filepathsIn, importOptions);
+    if (!importResult.ok)
+        return importResult;
+
+    return this->exportDocument(doc, filepathOut, Format_Unknown, exportOptions);
+}
+
+void Converter::requestAbort()
+{
+    m_isAbortRequested = true;
+}
+
+Converter::Result Converter::execTask(const TaskFunction& fn, const Options& options)
+{
+    std::mutex mutexError;
+    QStringList listError;
+    MessengerByCallback messenger([&](Messenger::MessageType msgType, const QString& text) {
+        if (msgType != Messenger::MessageType::Error)
+            return;
+
+        std::lock_guard<std::mutex> lock(mutexError);
+        if (!listError.contains(text))
+            listError.push_back(text);
+    });
+
+    Result result;
+    m_isAbortRequested = false;
+    const TaskId taskId = m_taskMgr.newTask([&](TaskProgress* progress) {
+        result.ok = fn(&messenger, progress);
+        result.aborted = progress->isAbortRequested();
+    });
+
+    // Abort requests are checked on progress notifications, emitted from the thread changing the
+    // progress value
+    const QMetaObject::Connection connection = QObject::connect(
+                &m_taskMgr, &TaskManager::progressChanged, &m_taskMgr, [&](TaskId id, int pct) {
+        if (id != taskId)
+            return;
+
+        const bool okContinue = !m_isAbortRequested && (!options.progress || options.progress(pct));
+        if (!okContinue)
+            m_taskMgr.requestAbort(taskId);
+    }, Qt::DirectConnection);
+    m_taskMgr.exec(taskId);
+    QObject::disconnect(connection);
+
+    result.ok = result.ok && !result.aborted;
+    result.errorMessage = listError.join('\n');
+    return result;
+}
+
+} // namespace IO
+} // namespace Mayo
@@ -0,0 +1,99 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "../base/document_ptr.h"
+#include "../base/filepath.h"
+#include "../base/io_format.h"
+#include "../base/io_system.h"
+#include "../base/span.h"
+#include "../base/task_manager.h"
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QString>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+namespace Mayo {
+namespace IO {
+
+class ParametersProvider;
+
+// Entry point for applications embedding the I/O layer of Mayo in-process(see mayo_io.pro)
+// Owns an IO::System where OpenCascade, DXF and gmio(if available) readers/writers are registered
+// along with the predefined format probes
+// Operations are synchronous: they run in the calling thread, readers/writers dispatching parts of
+// their work to TaskManager threads. Distinct Converter objects can be used from distinct threads
+class Converter {
+    Q_DECLARE_TR_FUNCTIONS(Mayo::IO::Converter)
+public:
+    // Called with progress of the operation in [0,100], returns false to abort the operation
+    // Might be called from TaskManager threads
+    using ProgressCallback = std::function<bool(int)>;
+
+    struct Options {
+        ProgressCallback progress;
+        // Parameters of the readers/writers, defaults of readers/writers are used if null
+        const ParametersProvider* parametersProvider = nullptr;
+        // BRep shapes exported to mesh formats(eg STL, OBJ, glTF) are meshed with these parameters
+        double meshLinearDeflection = 0.001; // Relative to the size of the shape if 'meshRelative'
+        double meshAngularDeflection = 0.5; // Radians
+        bool meshRelative = true;
+        // Identical prototypes of the imported files are merged into shared references
+        bool deduplicateGeometry = false;
+        // Assembly trees of the imported entities are explored concurrently
+        bool concurrentModelTreeBuild = false;
+    };
+
+    struct Result {
+        bool ok = false;
+        bool aborted = false;
+        QString errorMessage; // Errors reported by the readers/writers, one per line
+    };
+
+    Converter();
+
+    System* system() { return &m_system; }
+    const System* system() const { return &m_system; }
+
+    // Imports files into 'doc', formats are probed from the file contents
+    Result importFiles(const DocumentPtr& doc, Span<const FilePath> filepaths, const Options& options = {});
+
+    // Imports contents held in memory into 'doc', format is probed from the suffix of 'nameHint' if
+    // unknown(see Reader::readBuffer())
+    Result importBuffer(
+            const DocumentPtr& doc,
+            Span<const uint8_t> data,
+            const FilePath& nameHint,
+            Format format = Format_Unknown,
+            const Options& options = {});
+
+    // Exports the whole contents of 'doc', format is probed from the suffix of 'filepath' if unknown
+    Result exportDocument(
+            const DocumentPtr& doc,
+            const FilePath& filepath,
+            Format format = Format_Unknown,
+            const Options& options = {});
+
+    // Imports 'filepathsIn' into a temporary document then exports it to 'filepathOut'
+    Result convertFiles(Span<const FilePath> filepathsIn, const FilePath& filepathOut, const Options& options = {});
+
+    // Requests abort of the operation in progress(if any), can be called from any thread
+    void requestAbort();
+
+private:
+    using TaskFunction = std::function<bool(Messenger*, TaskProgress*)>;
+    Result execTask(const TaskFunction& fn, const Options& options);
+
+    System m_system;
+    TaskManager m_taskMgr;
+    std::atomic<bool> m_isAbortRequested = false;
+};
+
+} // namespace IO
+} // namespace Mayo
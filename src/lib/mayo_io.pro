@@ -0,0 +1,119 @@
+#****************************************************************************
+#* Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+#* All rights reserved.
+#* See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+#****************************************************************************
+
+# Headless library of the Mayo I/O pipeline(base, readers/writers, TaskManager), no dependency on
+# QtGui/QtWidgets nor on OpenCascade visualization
+# Depends on QtCore and on QtNetwork, the latter for reading remote files(see io_remote_file.h)
+# Embedding API is IO::Converter(see io_converter.h), link also OpenCascade libraries listed below
+# -- Static library by default, "qmake CONFIG+=mayo_io_shared" builds a shared library(symbols
+#    are not explicitly exported, so not for MSVC)
+
+TEMPLATE = lib
+TARGET = mayo_io
+include(../../version.pri)
+
+QT = core network
+CONFIG += c++17
+mayo_io_shared {
+    message(mayo_io shared library)
+    CONFIG += shared
+} else {
+    CONFIG += staticlib
+}
+
+*msvc* {
+    QMAKE_CXXFLAGS += /we4150 # Deletion of pointer to incomplete type 'XXXX'; no destructor called
+    QMAKE_CXXFLAGS += /std:c++17
+}
+*g++*|*clang* {
+    QMAKE_CXXFLAGS += -std=c++17
+}
+*clang* {
+    # Silent Clang warnings about instantiation of variable 'Mayo::GenericProperty<T>::TypeName'
+    QMAKE_CXXFLAGS += -Wno-undefined-var-template
+}
+
+*win* {
+    LIBS += -lPsapi # For GetProcessMemoryInfo()
+}
+
+INCLUDEPATH += \
+    ../3rdparty
+
+HEADERS += \
+    $$files(../base/*.h) \
+    $$files(../io_occ/*.h) \
+    $$files(../io_dxf/*.h) \
+    io_converter.h \
+
+SOURCES += \
+    $$files(../base/*.cpp) \
+    $$files(../io_occ/*.cpp) \
+    $$files(../io_dxf/*.cpp) \
+    io_converter.cpp \
+
+# OpenCascade
+include(../../opencascade.pri)
+message(OpenCascade version $$OCC_VERSION_STR)
+LIBS += -lTKernel -lTKMath -lTKBRep -lTKGeomBase -lTKGeomAlgo -lTKG2d -lTKG3d -lTKTopAlgo -lTKPrim
+LIBS += -lTKBO -lTKBool -lTKHLR -lTKMesh -lTKShHealing -lTKXSBase
+LIBS += -lTKLCAF -lTKXCAF -lTKCAF -lTKVCAF
+LIBS += -lTKCDF -lTKBin -lTKBinL -lTKBinXCAF -lTKXml -lTKXmlL -lTKXmlXCAF
+# -- IGES support
+LIBS += -lTKIGES -lTKXDEIGES
+# -- STEP support
+LIBS += -lTKSTEP -lTKSTEP209 -lTKSTEPAttr -lTKSTEPBase -lTKXDESTEP
+# -- STL support
+LIBS += -lTKSTL
+# -- OBJ/glTF support
+minOpenCascadeVersion(7, 4, 0) {
+    LIBS += -lTKRWMesh
+} else {
+    SOURCES -= \
+        ../io_occ/io_occ_base_mesh.cpp \
+        ../io_occ/io_occ_gltf_reader.cpp \
+        ../io_occ/io_occ_obj.cpp
+}
+
+!minOpenCascadeVersion(7, 5, 0) {
+    SOURCES -= ../io_occ/io_occ_gltf_writer.cpp
+}
+# -- VRML support
+LIBS += -lTKVRML
+# -- DXF support(text objects use Font_BRepFont)
+LIBS += -lTKService
+
+# gmio
+!isEmpty(GMIO_ROOT) {
+    message(gmio ON)
+    HEADERS += $$files(../io_gmio/*.h)
+    SOURCES += $$files(../io_gmio/*.cpp)
+    INCLUDEPATH += $$GMIO_ROOT/include
+    LIBS += -L$$GMIO_ROOT/lib -lgmio_static -lzlibstatic
+    SOURCES += $$GMIO_ROOT/src/gmio_support/stream_qt.cpp
+    DEFINES += HAVE_GMIO
+}
+
+# Options shared with mayo.pro
+mayo_profiler {
+    DEFINES += MAYO_WITH_PROFILER
+}
+mayo_zlib|!isEmpty(ZLIB_ROOT) {
+    !isEmpty(ZLIB_ROOT) {
+        INCLUDEPATH += $$ZLIB_ROOT/include
+        LIBS += -L$$ZLIB_ROOT/lib
+    }
+    LIBS += -lz
+    DEFINES += HAVE_ZLIB
+}
+mayo_zstd|!isEmpty(ZSTD_ROOT) {
+    !isEmpty(ZSTD_ROOT) {
+        INCLUDEPATH += $$ZSTD_ROOT/include
+        LIBS += -L$$ZSTD_ROOT/lib
+    }
+    LIBS += -lzstd
+    DEFINES += HAVE_ZSTD
+}
@@ -0,0 +1,645 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "bench.h"
+#include "../src/base/application.h"
+#include "../src/base/application_item.h"
+#include "../src/base/document.h"
+#include "../src/base/filepath.h"
+#include "../src/base/io_reader.h"
+#include "../src/base/io_system.h"
+#include "../src/base/memory_usage.h"
+#include "../src/base/task_manager.h"
+#include "../src/base/task_progress.h"
+#include "../src/io_dxf/io_dxf.h"
+#include "../src/io_occ/io_occ.h"
+
+#include <BRepPrimAPI_MakeBox.hxx>
+#include <gp_Trsf.hxx>
+#include <TopLoc_Location.hxx>
+#include <QtCore/QtDebug>
+#include <QtCore/QDataStream>
+#include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QTextStream>
+#include <gsl/util>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#if defined(Q_OS_WIN)
+#  define NOMINMAX // Keeps std::min()/std::max() usable
+#  include <windows.h>
+#elif defined(Q_OS_UNIX)
+#  include <sys/resource.h>
+#endif
+
+Q_DECLARE_METATYPE(Mayo::IO::Format)
+
+namespace Mayo {
+
+namespace {
+
+// Count of cells along each side of a square grid made of (at least) 'triangleCount' triangles
+int gridCellCount(int triangleCount)
+{
+    return std::max(1, int(std::ceil(std::sqrt(triangleCount / 2.))));
+}
+
+// Binary STL of a square grid
+bool writeStlGrid(const QString& filepath, int triangleCount)
+{
+    QFile file(filepath);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    const int cellCount = gridCellCount(triangleCount);
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    stream.writeRawData(QByteArray(80, '\0').constData(), 80);
+    stream << quint32(2 * cellCount * cellCount);
+    auto fnWriteTriangle = [&](float x0, float y0, float x1, float y1, float x2, float y2) {
+        stream << 0.f << 0.f << 1.f;
+        stream << x0 << y0 << 0.f << x1 << y1 << 0.f << x2 << y2 << 0.f;
+        stream << quint16(0);
+    };
+    for (int i = 0; i < cellCount; ++i) {
+        for (int j = 0; j < cellCount; ++j) {
+            fnWriteTriangle(i, j, i + 1, j, i + 1, j + 1);
+            fnWriteTriangle(i, j, i + 1, j + 1, i, j + 1);
+        }
+    }
+
+    return stream.status() == QDataStream::Ok;
+}
+
+// Wavefront OBJ of a square grid, with shared vertices
+bool writeObjGrid(const QString& filepath, int triangleCount)
+{
+    QFile file(filepath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+        return false;
+
+    const int cellCount = gridCellCount(triangleCount);
+    QTextStream stream(&file);
+    for (int i = 0; i <= cellCount; ++i) {
+        for (int j = 0; j <= cellCount; ++j)
+            stream << "v " << i << ' ' << j << " 0\n";
+    }
+
+    // OBJ vertex indices are 1-based
+    auto fnVertexIndex = [=](int i, int j) { return i * (cellCount + 1) + j + 1; };
+    for (int i = 0; i < cellCount; ++i) {
+        for (int j = 0; j < cellCount; ++j) {
+            stream << "f " << fnVertexIndex(i, j) << ' ' << fnVertexIndex(i + 1, j)
+                   << ' ' << fnVertexIndex(i + 1, j + 1) << '\n';
+            stream << "f " << fnVertexIndex(i, j) << ' ' << fnVertexIndex(i + 1, j + 1)
+                   << ' ' << fnVertexIndex(i, j + 1) << '\n';
+        }
+    }
+
+    stream.flush();
+    return stream.status() == QTextStream::Ok;
+}
+
+// ASCII DXF with an ENTITIES section made of LINE entities
+bool writeDxfLines(const QString& filepath, int entityCount)
+{
+    QFile file(filepath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+        return false;
+
+    QTextStream stream(&file);
+    stream << "0\nSECTION\n2\nENTITIES\n";
+    for (int i = 0; i < entityCount; ++i) {
+        stream << "0\nLINE\n8\n0\n"
+               << "10\n" << i << "\n20\n0\n30\n0\n"
+               << "11\n" << i << "\n21\n10\n31\n0\n";
+    }
+
+    stream << "0\nENDSEC\n0\nEOF\n";
+    stream.flush();
+    return stream.status() == QTextStream::Ok;
+}
+
+// STEP assembly of 'instanceCount' instances of a single box prototype
+bool writeStepAssembly(const QString& filepath, int instanceCount)
+{
+    auto app = Application::instance();
+    DocumentPtr doc = app->newDocument();
+    auto _ = gsl::finally([=]{ app->closeDocument(doc); });
+    Handle_XCAFDoc_ShapeTool shapeTool = doc->xcaf().shapeTool();
+    const TDF_Label labelPrototype = shapeTool->AddShape(BRepPrimAPI_MakeBox(10, 10, 10), false);
+    const TDF_Label labelAssembly = shapeTool->NewShape();
+    for (int i = 0; i < instanceCount; ++i) {
+        gp_Trsf trsf;
+        trsf.SetTranslation(gp_Vec(20 * (i % 100), 20 * (i / 100), 0));
+        shapeTool->AddComponent(labelAssembly, labelPrototype, TopLoc_Location(trsf));
+    }
+
+    shapeTool->UpdateAssemblies();
+    const std::vector<ApplicationItem> appItems = { ApplicationItem(doc) };
+    return Application::instance()->ioSystem()->exportApplicationItems()
+            .targetFile(filepathFrom(filepath))
+            .targetFormat(IO::Format_STEP)
+            .withItems(appItems)
+            .execute();
+}
+
+// CPU time(user and system) consumed by all threads of the process in microseconds, -1 if not available
+int64_t processCpuTimeUsec()
+{
+#if defined(Q_OS_WIN)
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    if (!GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime))
+        return -1;
+
+    // FILETIME unit is 100 nanoseconds
+    auto fnUsec = [](const FILETIME& ft) { return ((int64_t(ft.dwHighDateTime) << 32) | ft.dwLowDateTime) / 10; };
+    return fnUsec(kernelTime) + fnUsec(userTime);
+#elif defined(Q_OS_UNIX)
+    rusage usage = {};
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return -1;
+
+    auto fnUsec = [](const timeval& tv) { return int64_t(tv.tv_sec) * 1000000 + tv.tv_usec; };
+    return fnUsec(usage.ru_utime) + fnUsec(usage.ru_stime);
+#else
+    return -1;
+#endif
+}
+
+// Resources used by the process while running an operation with a given count of workers
+struct ScalingSample {
+    int workerCount = 0;
+    int64_t wallMsecs = 0;
+    double cpuUsage = -1; // CPU time divided by wall time, ie average count of busy cores
+    int64_t peakResidentBytes = -1;
+};
+
+// Runs 'fn' and measures its resources. Resident memory is polled by a separate thread, so the
+// peak is specific to 'fn'(unlike the peak RSS kept by the OS for the process lifetime)
+ScalingSample measureScaling(int workerCount, const std::function<void()>& fn)
+{
+    ProcessMemory::trim();
+    std::atomic<bool> isDone = false;
+    std::atomic<int64_t> peakResidentBytes = ProcessMemory::residentBytes();
+    auto fnSampleResident = [&]{
+        const int64_t residentBytes = ProcessMemory::residentBytes();
+        if (residentBytes > peakResidentBytes)
+            peakResidentBytes = residentBytes;
+    };
+    std::thread threadSampler([&]{
+        while (!isDone) {
+            fnSampleResident();
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    });
+
+    const int64_t cpuTimeStart = processCpuTimeUsec();
+    QElapsedTimer timer;
+    timer.start();
+    fn();
+    const int64_t wallUsec = timer.nsecsElapsed() / 1000;
+    const int64_t cpuTimeEnd = processCpuTimeUsec();
+    isDone = true;
+    threadSampler.join();
+    fnSampleResident();
+
+    ScalingSample sample;
+    sample.workerCount = workerCount;
+    sample.wallMsecs = wallUsec / 1000;
+    if (cpuTimeStart >= 0 && cpuTimeEnd >= 0 && wallUsec > 0)
+        sample.cpuUsage = double(cpuTimeEnd - cpuTimeStart) / wallUsec;
+
+    sample.peakResidentBytes = peakResidentBytes;
+    return sample;
+}
+
+// Worker counts 1, 2, 4, ... up to hardware concurrency(included even if not a power of 2)
+std::vector<int> scalingWorkerCounts()
+{
+    const int maxWorkerCount = std::max(1, int(std::thread::hardware_concurrency()));
+    std::vector<int> vecCount;
+    for (int count = 1; count < maxWorkerCount; count *= 2)
+        vecCount.push_back(count);
+
+    vecCount.push_back(maxWorkerCount);
+    return vecCount;
+}
+
+// Count of files processed by scaling benchmarks, so all workers are busy whatever their count
+int scalingFileCount()
+{
+    return std::max(8, 2 * int(std::thread::hardware_concurrency()));
+}
+
+// Prints 'sample' and returns an error message if it's slower than the samples with fewer workers
+// Small slowdowns are tolerated, timings being noisy
+QString checkScaling(const ScalingSample& sample, const std::vector<ScalingSample>& vecPrevSample)
+{
+    qInfo().noquote() << QString("%1 worker(s): %2 ms, CPU usage %3, peak RSS %4 MB")
+                         .arg(sample.workerCount, 3)
+                         .arg(sample.wallMsecs, 6)
+                         .arg(sample.cpuUsage, 5, 'f', 2)
+                         .arg(sample.peakResidentBytes / (1024 * 1024));
+    constexpr double tolerance = 1.15;
+    for (const ScalingSample& prevSample : vecPrevSample) {
+        if (sample.wallMsecs > tolerance * prevSample.wallMsecs && sample.wallMsecs - prevSample.wallMsecs > 10) {
+            return QString("%1 workers slower than %2 workers(%3 ms > %4 ms)")
+                    .arg(sample.workerCount).arg(prevSample.workerCount)
+                    .arg(sample.wallMsecs).arg(prevSample.wallMsecs);
+        }
+    }
+
+    return {};
+}
+
+} // namespace
+
+void Bench::IO_readFile_bench()
+{
+    QFETCH(IO::Format, format);
+    QFETCH(QString, filepath);
+
+    auto ioSystem = Application::instance()->ioSystem();
+    QBENCHMARK {
+        std::unique_ptr<IO::Reader> reader = ioSystem->createReader(format);
+        QVERIFY(reader);
+        TaskProgress progress;
+        QVERIFY(reader->readFile(filepathFrom(filepath), &progress));
+    }
+}
+
+void Bench::IO_readFile_bench_data()
+{
+    this->createInputs_data();
+}
+
+void Bench::IO_transfer_bench()
+{
+    QFETCH(IO::Format, format);
+    QFETCH(QString, filepath);
+
+    auto app = Application::instance();
+    DocumentPtr doc = app->newDocument();
+    auto _ = gsl::finally([=]{ app->closeDocument(doc); });
+    std::unique_ptr<IO::Reader> reader = app->ioSystem()->createReader(format);
+    QVERIFY(reader);
+    TaskProgress progress;
+    QVERIFY(reader->readFile(filepathFrom(filepath), &progress));
+    // Transfer consumes the data read by the reader, so it can't be repeated
+    QBENCHMARK_ONCE {
+        const TDF_LabelSequence seqLabel = reader->transfer(doc, &progress);
+        QVERIFY(!seqLabel.IsEmpty());
+    }
+}
+
+void Bench::IO_transfer_bench_data()
+{
+    this->createInputs_data();
+}
+
+void Bench::IO_import_bench()
+{
+    QFETCH(IO::Format, format);
+    QFETCH(QString, filepath);
+
+    auto app = Application::instance();
+    DocumentPtr doc = app->newDocument();
+    auto _ = gsl::finally([=]{ app->closeDocument(doc); });
+    QBENCHMARK {
+        const bool okImport = app->ioSystem()->importInDocument()
+                .targetDocument(doc)
+                .withFilepath(filepathFrom(filepath))
+                .execute();
+        QVERIFY(okImport);
+    }
+
+    QCOMPARE(app->ioSystem()->probeFormat(filepathFrom(filepath)), format);
+}
+
+void Bench::IO_import_bench_data()
+{
+    this->createInputs_data();
+}
+
+void Bench::IO_export_bench()
+{
+    QFETCH(IO::Format, format);
+    QFETCH(QString, filepath);
+
+    auto app = Application::instance();
+    if (!app->ioSystem()->findFactoryWriter(format))
+        QSKIP("No writer available for the format");
+
+    DocumentPtr doc = app->newDocument();
+    auto _ = gsl::finally([=]{ app->closeDocument(doc); });
+    const bool okImport = app->ioSystem()->importInDocument()
+            .targetDocument(doc)
+            .withFilepath(filepathFrom(filepath))
+            .execute();
+    QVERIFY(okImport);
+
+    const FilePath filepathOut = filepathFrom(this->inputFilePath("out_" + QFileInfo(filepath).fileName()));
+    const std::vector<ApplicationItem> appItems = { ApplicationItem(doc) };
+    QBENCHMARK {
+        const bool okExport = app->ioSystem()->exportApplicationItems()
+                .targetFile(filepathOut)
+                .targetFormat(format)
+                .withItems(appItems)
+                .execute();
+        QVERIFY(okExport);
+    }
+}
+
+void Bench::IO_export_bench_data()
+{
+    this->createInputs_data();
+}
+
+void Bench::IO_importScaling_bench()
+{
+    QFETCH(IO::Format, format);
+    QFETCH(QString, filepath);
+
+    // Distinct copies of the input, as for a folder of files
+    const QString dirPath = this->inputFilePath("scaling_import");
+    QDir(dirPath).removeRecursively();
+    QVERIFY(QDir().mkpath(dirPath));
+    auto _ = gsl::finally([=]{ QDir(dirPath).removeRecursively(); });
+    std::vector<FilePath> vecFilepath;
+    for (int i = 0; i < scalingFileCount(); ++i) {
+        const QString filepathCopy = QDir(dirPath).filePath(QString("%1_%2").arg(i).arg(QFileInfo(filepath).fileName()));
+        QVERIFY(QFile::copy(filepath, filepathCopy));
+        vecFilepath.push_back(filepathFrom(filepathCopy));
+    }
+
+    auto app = Application::instance();
+    auto ioSystem = app->ioSystem();
+    const int prevMaxConcurrency = ioSystem->maxConcurrency();
+    auto _2 = gsl::finally([=]{ ioSystem->setMaxConcurrency(prevMaxConcurrency); });
+    auto fnImport = [&]{
+        DocumentPtr doc = app->newDocument();
+        auto _ = gsl::finally([=]{ app->closeDocument(doc); });
+        const bool okImport = ioSystem->importInDocument()
+                .targetDocument(doc)
+                .withFilepaths(vecFilepath)
+                .withFormat(format)
+                .execute();
+        QVERIFY(okImport);
+    };
+
+    // Warm-up, so the first worker count doesn't pay for cold file and allocator caches
+    fnImport();
+    std::vector<ScalingSample> vecSample;
+    QStringList listRegression;
+    for (int workerCount : scalingWorkerCounts()) {
+        ioSystem->setMaxConcurrency(workerCount);
+        const ScalingSample sample = measureScaling(workerCount, fnImport);
+        const QString regression = checkScaling(sample, vecSample);
+        if (!regression.isEmpty())
+            listRegression.push_back(regression);
+
+        vecSample.push_back(sample);
+    }
+
+    QTest::setBenchmarkResult(vecSample.back().wallMsecs, QTest::WalltimeMilliseconds);
+    QVERIFY2(listRegression.isEmpty(), qUtf8Printable(listRegression.join("\n")));
+}
+
+void Bench::IO_importScaling_bench_data()
+{
+    this->createScalingInputs_data();
+}
+
+void Bench::IO_exportScaling_bench()
+{
+    QFETCH(IO::Format, format);
+    QFETCH(QString, filepath);
+
+    auto app = Application::instance();
+    auto ioSystem = app->ioSystem();
+    if (!ioSystem->findFactoryWriter(format))
+        QSKIP("No writer available for the format");
+
+    DocumentPtr doc = app->newDocument();
+    auto _ = gsl::finally([=]{ app->closeDocument(doc); });
+    const bool okImport = ioSystem->importInDocument()
+            .targetDocument(doc)
+            .withFilepath(filepathFrom(filepath))
+            .execute();
+    QVERIFY(okImport);
+
+    const QString dirPath = this->inputFilePath("scaling_export");
+    QDir(dirPath).removeRecursively();
+    QVERIFY(QDir().mkpath(dirPath));
+    auto _2 = gsl::finally([=]{ QDir(dirPath).removeRecursively(); });
+    std::vector<FilePath> vecFilepathOut;
+    for (int i = 0; i < scalingFileCount(); ++i)
+        vecFilepathOut.push_back(filepathFrom(QDir(dirPath).filePath(QString("%1_%2").arg(i).arg(QFileInfo(filepath).fileName()))));
+
+    const int prevMaxConcurrency = ioSystem->maxConcurrency();
+    auto _3 = gsl::finally([=]{ ioSystem->setMaxConcurrency(prevMaxConcurrency); });
+    const std::vector<ApplicationItem> appItems = { ApplicationItem(doc) };
+    auto fnExport = [&]{
+        auto operation = ioSystem->exportApplicationItems();
+        operation.targetFile(vecFilepathOut.front()).targetFormat(format).withItems(appItems);
+        for (size_t i = 1; i < vecFilepathOut.size(); ++i)
+            operation.addTarget(vecFilepathOut.at(i), format);
+
+        QVERIFY(operation.execute());
+    };
+
+    // Warm-up, shapes are also meshed here once and for all if writer needs meshes
+    fnExport();
+    std::vector<ScalingSample> vecSample;
+    QStringList listRegression;
+    for (int workerCount : scalingWorkerCounts()) {
+        ioSystem->setMaxConcurrency(workerCount);
+        const ScalingSample sample = measureScaling(workerCount, fnExport);
+        const QString regression = checkScaling(sample, vecSample);
+        if (!regression.isEmpty())
+            listRegression.push_back(regression);
+
+        vecSample.push_back(sample);
+    }
+
+    QTest::setBenchmarkResult(vecSample.back().wallMsecs, QTest::WalltimeMilliseconds);
+    QVERIFY2(listRegression.isEmpty(), qUtf8Printable(listRegression.join("\n")));
+}
+
+void Bench::IO_exportScaling_bench_data()
+{
+    this->createScalingInputs_data();
+}
+
+void Bench::LibTask_spawnLatency_bench()
+{
+    // Time from task submission to end of its execution, for an empty task
+    TaskManager taskMgr;
+    QBENCHMARK {
+        const TaskId taskId = taskMgr.newTask([](TaskProgress*) {});
+        taskMgr.run(taskId, TaskAutoDestroy::Off);
+        taskMgr.waitForDone(taskId);
+    }
+}
+
+void Bench::LibTask_throughput_bench()
+{
+    QFETCH(int, taskCount);
+
+    std::atomic<int> doneCount = 0;
+    QBENCHMARK {
+        TaskManager taskMgr;
+        std::vector<TaskId> vecTaskId;
+        vecTaskId.reserve(taskCount);
+        for (int i = 0; i < taskCount; ++i)
+            vecTaskId.push_back(taskMgr.newTask([&](TaskProgress*) { ++doneCount; }));
+
+        for (const TaskId taskId : vecTaskId)
+            taskMgr.run(taskId, TaskAutoDestroy::Off);
+
+        QVERIFY(taskMgr.waitForAll(vecTaskId));
+    }
+
+    QVERIFY(doneCount.load() >= taskCount);
+}
+
+void Bench::LibTask_throughput_bench_data()
+{
+    QTest::addColumn<int>("taskCount");
+    QTest::newRow("1k tasks") << 1000;
+    QTest::newRow("10k tasks") << 10000;
+}
+
+void Bench::LibTask_progressHierarchy_bench()
+{
+    QFETCH(int, depth);
+
+    // Progress updated at the deepest level of a chain of nested TaskProgress objects, each update
+    // is propagated up to the root progress
+    std::function<void(TaskProgress*, int)> fnProgress;
+    fnProgress = [&](TaskProgress* progress, int level) {
+        if (level < depth) {
+            TaskProgress subProgress(progress, 100);
+            fnProgress(&subProgress, level + 1);
+        }
+        else {
+            for (int i = 0; i <= 100; ++i)
+                progress->setValue(i);
+        }
+    };
+
+    TaskManager taskMgr;
+    const TaskId taskId = taskMgr.newTask([&](TaskProgress* progress) {
+        QBENCHMARK {
+            fnProgress(progress, 0);
+        }
+    });
+    taskMgr.exec(taskId, TaskAutoDestroy::Off);
+}
+
+void Bench::LibTask_progressHierarchy_bench_data()
+{
+    QTest::addColumn<int>("depth");
+    QTest::newRow("depth 1") << 1;
+    QTest::newRow("depth 4") << 4;
+    QTest::newRow("depth 16") << 16;
+}
+
+void Bench::LibTask_globalProgress_bench()
+{
+    QFETCH(int, taskCount);
+
+    TaskManager taskMgr;
+    std::vector<TaskId> vecTaskId;
+    for (int i = 0; i < taskCount; ++i)
+        vecTaskId.push_back(taskMgr.newTask([](TaskProgress* progress) { progress->setValue(50); }));
+
+    for (const TaskId taskId : vecTaskId)
+        taskMgr.exec(taskId, TaskAutoDestroy::Off);
+
+    int globalPct = 0;
+    QBENCHMARK {
+        globalPct = taskMgr.globalProgress();
+    }
+
+    QCOMPARE(globalPct, 100);
+}
+
+void Bench::LibTask_globalProgress_bench_data()
+{
+    QTest::addColumn<int>("taskCount");
+    QTest::newRow("100 tasks") << 100;
+    QTest::newRow("10k tasks") << 10000;
+}
+
+void Bench::initTestCase()
+{
+    IO::System* ioSystem = Application::instance()->ioSystem();
+    ioSystem->addFactoryReader(std::make_unique<IO::OccFactoryReader>());
+    ioSystem->addFactoryReader(std::make_unique<IO::DxfFactoryReader>());
+    ioSystem->addFactoryWriter(std::make_unique<IO::OccFactoryWriter>());
+    ioSystem->addFactoryWriter(std::make_unique<IO::DxfFactoryWriter>());
+    IO::addPredefinedFormatProbes(ioSystem);
+
+    QVERIFY(m_inputDir.isValid());
+    for (int count : { 1000, 10000, 100000 }) {
+        QVERIFY(writeStlGrid(this->inputFilePath(QString("grid_%1.stl").arg(count)), count));
+        QVERIFY(writeObjGrid(this->inputFilePath(QString("grid_%1.obj").arg(count)), count));
+        QVERIFY(writeDxfLines(this->inputFilePath(QString("lines_%1.dxf").arg(count)), count));
+    }
+
+    for (int count : { 10, 100, 1000 })
+        QVERIFY(writeStepAssembly(this->inputFilePath(QString("assembly_%1.step").arg(count)), count));
+}
+
+void Bench::createInputs_data()
+{
+    QTest::addColumn<IO::Format>("format");
+    QTest::addColumn<QString>("filepath");
+
+    for (int count : { 1000, 10000, 100000 }) {
+        QTest::newRow(qUtf8Printable(QString("STL %1 triangles").arg(count)))
+                << IO::Format_STL << this->inputFilePath(QString("grid_%1.stl").arg(count));
+        QTest::newRow(qUtf8Printable(QString("OBJ %1 triangles").arg(count)))
+                << IO::Format_OBJ << this->inputFilePath(QString("grid_%1.obj").arg(count));
+        QTest::newRow(qUtf8Printable(QString("DXF %1 entities").arg(count)))
+                << IO::Format_DXF << this->inputFilePath(QString("lines_%1.dxf").arg(count));
+    }
+
+    for (int count : { 10, 100, 1000 }) {
+        QTest::newRow(qUtf8Printable(QString("STEP %1 instances").arg(count)))
+                << IO::Format_STEP << this->inputFilePath(QString("assembly_%1.step").arg(count));
+    }
+}
+
+void Bench::createScalingInputs_data()
+{
+    QTest::addColumn<IO::Format>("format");
+    QTest::addColumn<QString>("filepath");
+
+    // Middle-sized inputs, so reads are long enough to be measured while the whole run stays short
+    QTest::newRow("STL 10000 triangles") << IO::Format_STL << this->inputFilePath("grid_10000.stl");
+    QTest::newRow("OBJ 10000 triangles") << IO::Format_OBJ << this->inputFilePath("grid_10000.obj");
+    QTest::newRow("DXF 10000 entities") << IO::Format_DXF << this->inputFilePath("lines_10000.dxf");
+    QTest::newRow("STEP 100 instances") << IO::Format_STEP << this->inputFilePath("assembly_100.step");
+}
+
+QString Bench::inputFilePath(const QString& name) const
+{
+    return m_inputDir.filePath(name);
+}
+
+} // namespace Mayo
@@ -0,0 +1,57 @@
+/****************************************************************************
+** Copyright (c) 2021, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include <QtCore/QObject>
+#include <QtCore/QTemporaryDir>
+#include <QtTest/QtTest>
+
+namespace Mayo {
+
+// Benchmarks of IO readers/writers through IO::System, over synthetic inputs of scalable size
+// generated at startup(STL/OBJ of N triangles, STEP assembly of N instances, DXF of N entities)
+// Scaling benchmarks import/export many files with 1, 2, 4, ... hardware concurrency workers, they
+// report wall time, CPU usage and peak memory of each worker count and fail if adding workers makes
+// the operation slower
+// Also micro-benchmarks of TaskManager/TaskProgress overhead
+// Run with "mayo_tests --bench", results can be kept over time with QtTest output options
+// eg "mayo_tests --bench -o bench.xml,xml" then compared between releases
+class Bench : public QObject {
+    Q_OBJECT
+private slots:
+    void IO_readFile_bench();
+    void IO_readFile_bench_data();
+    void IO_transfer_bench();
+    void IO_transfer_bench_data();
+    void IO_import_bench();
+    void IO_import_bench_data();
+    void IO_export_bench();
+    void IO_export_bench_data();
+    void IO_importScaling_bench();
+    void IO_importScaling_bench_data();
+    void IO_exportScaling_bench();
+    void IO_exportScaling_bench_data();
+
+    void LibTask_spawnLatency_bench();
+    void LibTask_throughput_bench();
+    void LibTask_throughput_bench_data();
+    void LibTask_progressHierarchy_bench();
+    void LibTask_progressHierarchy_bench_data();
+    void LibTask_globalProgress_bench();
+    void LibTask_globalProgress_bench_data();
+
+    void initTestCase();
+
+private:
+    void createInputs_data();
+    void createScalingInputs_data();
+    QString inputFilePath(const QString& name) const;
+
+    QTemporaryDir m_inputDir;
+};
+
+} // namespace Mayo
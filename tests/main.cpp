@@ -4,16 +4,34 @@
 ** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
 ****************************************************************************/
 
+#include "bench.h"
 #include "test.h"
 
+#include <cstring>
 #include <memory>
 #include <vector>
 
 int main(int argc, char** argv)
 {
+    // Option --bench runs benchmarks instead of tests, other arguments are forwarded to QtTest
+    bool isBenchRequested = false;
+    std::vector<char*> vecArg;
+    for (int i = 0; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--bench") == 0)
+            isBenchRequested = true;
+        else
+            vecArg.push_back(argv[i]);
+    }
+
+    argc = int(vecArg.size());
+    argv = vecArg.data();
     int retcode = 0;
     std::vector<std::unique_ptr<QObject>> vecTest;
-    vecTest.emplace_back(new Mayo::Test);
+    if (isBenchRequested)
+        vecTest.emplace_back(new Mayo::Bench);
+    else
+        vecTest.emplace_back(new Mayo::Test);
+
     for (const std::unique_ptr<QObject>& test : vecTest)
         retcode += QTest::qExec(test.get(), argc, argv);
 
@@ -3,7 +3,7 @@ TEMPLATE = app
 
 CONFIG += c++17 no_batch
 
-QT += testlib
+QT += testlib network
 
 *msvc*:QMAKE_CXXFLAGS += /std:c++17
 *g++*:QMAKE_CXXFLAGS += -std=c++17
@@ -12,16 +12,20 @@ INCLUDEPATH += \
     ../src/3rdparty
 
 HEADERS += \
+    bench.h \
     test.h \
     $$files(../src/base/*.h) \
+    $$files(../src/io_dxf/*.h) \
     $$files(../src/io_occ/*.h) \
     ../src/gui/qtgui_utils.h \
 
 SOURCES += \
+    bench.cpp \
     test.cpp \
     main.cpp \
     \
     $$files(../src/base/*.cpp) \
+    $$files(../src/io_dxf/*.cpp) \
     $$files(../src/io_occ/*.cpp) \
     ../src/app/qstring_utils.cpp \
     ../src/gui/qtgui_utils.cpp \
@@ -58,3 +62,5 @@ minOpenCascadeVersion(7, 4, 0) {
 }
 # -- VRML support
 LIBS += -lTKVRML
+# -- DXF support
+LIBS += -lTKG2d -lTKGeomAlgo -lTKHLR -lTKService
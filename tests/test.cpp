@@ -9,18 +9,43 @@
 
 #include "test.h"
 #include "../src/base/application.h"
+#include "../src/base/bnd_box_cache.h"
+#include "../src/base/bnd_utils.h"
+#include "../src/base/brep_mass_properties.h"
 #include "../src/base/brep_utils.h"
+#include "../src/base/bvh.h"
 #include "../src/base/caf_utils.h"
+#include "../src/base/cpu_topology.h"
+#include "../src/base/document_diff.h"
+#include "../src/base/document_search_index.h"
+#include "../src/base/document_snapshot.h"
 #include "../src/base/filepath.h"
 #include "../src/base/geom_utils.h"
+#include "../src/base/io_compressed_stream.h"
+#include "../src/base/io_progress_stream.h"
+#include "../src/base/io_remote_file.h"
 #include "../src/base/io_system.h"
+#include "../src/base/label_attributes_cache.h"
 #include "../src/base/occ_static_variables_rollback.h"
 #include "../src/base/libtree.h"
+#include "../src/base/libtree_concurrent.h"
+#include "../src/base/mesh_decimation.h"
+#include "../src/base/mesh_reorder.h"
+#include "../src/base/mesh_repair.h"
+#include "../src/base/mesh_section.h"
 #include "../src/base/mesh_utils.h"
+#include "../src/base/messenger.h"
+#include "../src/base/model_cache.h"
 #include "../src/base/meta_enum.h"
+#include "../src/base/point_cloud.h"
 #include "../src/base/property_builtins.h"
 #include "../src/base/property_enumeration.h"
 #include "../src/base/property_value_conversion.h"
+#include "../src/base/qtcore_hfuncs.h"
+#include "../src/base/shape_deduplication.h"
+#include "../src/base/shape_healing.h"
+#include "../src/base/shape_pager.h"
+#include "../src/base/shape_style_cache.h"
 #include "../src/base/string_conv.h"
 #include "../src/base/task_manager.h"
 #include "../src/base/tkernel_utils.h"
@@ -28,26 +53,55 @@
 #include "../src/base/unit_system.h"
 #include "../src/app/qstring_utils.h"
 #include "../src/io_occ/io_occ.h"
+#include "../src/io_occ/io_occ_gltf_native.h"
+#include "../src/io_occ/io_occ_iges.h"
+#include "../src/io_occ/io_occ_stl_native.h"
 #include "../src/gui/qtgui_utils.h"
 
+#include <BRepBndLib.hxx>
+#include <BRep_Builder.hxx>
 #include <BRep_Tool.hxx>
 #include <BRepAdaptor_Curve.hxx>
 #include <BRepMesh_IncrementalMesh.hxx>
 #include <GCPnts_TangentialDeflection.hxx>
 #include <Interface_ParamType.hxx>
 #include <Interface_Static.hxx>
+#include <Poly_Array1OfTriangle.hxx>
+#include <Precision.hxx>
+#include <TColgp_Array1OfPnt.hxx>
+#include <TDataStd_Name.hxx>
+#include <TDataXtd_Triangulation.hxx>
 #include <TopAbs_ShapeEnum.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Iterator.hxx>
+#include <gp.hxx>
 #include <QtCore/QtDebug>
+#include <QtCore/QDir>
 #include <QtCore/QFile>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QPointer>
+#include <QtCore/QtEndian>
 #include <QtCore/QVariant>
 #include <QtTest/QSignalSpy>
 #include <gsl/util>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cmath>
 #include <cstring>
 #include <iostream>
+#include <limits>
 #include <memory>
+#include <mutex>
+#include <random>
+#include <set>
 #include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -109,6 +163,13 @@ void Test::Application_test()
         QCOMPARE(doc->entityCount(), 1);
         QVERIFY(XCaf::isShape(doc->entityLabel(0)));
         QCOMPARE(CafUtils::labelAttrStdName(doc->entityLabel(0)), to_OccExtString("Cube"));
+        {   // Bounding box is filled by import
+            const Bnd_Box cachedBox = doc->bndBoxCache().labelBox(doc->entityLabel(0));
+            const Bnd_Box shapeBox = BndBoxCache::shapeBox(XCaf::shape(doc->entityLabel(0)));
+            QVERIFY(!cachedBox.IsVoid());
+            QVERIFY(BndBoxCoords::get(cachedBox).minVertex().IsEqual(BndBoxCoords::get(shapeBox).minVertex(), Precision::Confusion()));
+            QVERIFY(BndBoxCoords::get(cachedBox).maxVertex().IsEqual(BndBoxCoords::get(shapeBox).maxVertex(), Precision::Confusion()));
+        }
 
         QSignalSpy sigSpy_docEntityAboutToBeDestroyed(doc.get(), &Document::entityAboutToBeDestroyed);
         doc->destroyEntity(doc->entityTreeNodeId(0));
@@ -116,6 +177,36 @@ void Test::Application_test()
         QCOMPARE(doc->entityCount(), 0);
     }
 
+    {   // Close document asynchronously, contents are released by a task once the last reference
+        // is dropped
+        DocumentPtr doc = app->newDocument();
+        QVERIFY(fnImportInDocument(doc, "inputs/cube.step"));
+        QSignalSpy sigSpy_taskEnded(TaskManager::globalInstance(), &TaskManager::ended);
+        QSignalSpy sigSpy_documentAboutToClose(app.get(), &Application::documentAboutToClose);
+        std::atomic<bool> isReleased = false;
+        const TaskId taskId = app->closeDocumentAsync(doc, [&]{ isReleased = true; });
+        QVERIFY(taskId != 0);
+        QCOMPARE(sigSpy_documentAboutToClose.count(), 1);
+        QCOMPARE(app->documentCount(), 0);
+        auto fnTaskEnded = [&]{
+            return std::any_of(sigSpy_taskEnded.cbegin(), sigSpy_taskEnded.cend(), [=](const QList<QVariant>& args) {
+                return args.at(0).value<TaskId>() == taskId;
+            });
+        };
+        DocumentPtr docOtherRef = doc;
+        doc.Nullify();
+        QTest::qWait(50);
+        QVERIFY(!isReleased.load());
+        QVERIFY(!fnTaskEnded());
+
+        // QObject part is deleted in the thread of the document(deferred delete event)
+        QPointer<Document> qptrDoc = docOtherRef.get();
+        docOtherRef.Nullify();
+        QTRY_VERIFY(fnTaskEnded());
+        QVERIFY(isReleased.load());
+        QTRY_VERIFY(qptrDoc.isNull());
+    }
+
     {   // Add mesh entity
         // Add XCAF entity
         // Try to remove mesh and XCAF entities
@@ -127,6 +218,29 @@ void Test::Application_test()
         okImport = fnImportInDocument(doc, "inputs/cube.stlb");
         QVERIFY(okImport);
         QCOMPARE(doc->entityCount(), 1);
+        {   // Spatial index of the mesh entity
+            const Bvh::Box box = doc->bvh().box();
+            QVERIFY(!box.isVoid());
+            const gp_Pnt center(
+                        0.5 * (box.minCorner[0] + box.maxCorner[0]),
+                        0.5 * (box.minCorner[1] + box.maxCorner[1]),
+                        0.5 * (box.minCorner[2] + box.maxCorner[2]));
+            const gp_Pnt pntAbove(center.X(), center.Y(), box.maxCorner[2] + 5.);
+            const DocumentBvh::Hit hitNearest = doc->bvh().nearestPoint(pntAbove);
+            QVERIFY(hitNearest.isValid());
+            QCOMPARE(hitNearest.instance->entityLabel, doc->entityLabel(0));
+            QVERIFY(std::abs(hitNearest.distance - 5.) < 1e-6);
+            QVERIFY(!doc->bvh().nearestPoint(pntAbove, 4.).isValid());
+
+            const DocumentBvh::Hit hitRay = doc->bvh().raycast(gp_Lin(pntAbove, -gp::DZ()));
+            QVERIFY(hitRay.isValid());
+            QVERIFY(hitRay.point.IsEqual(gp_Pnt(center.X(), center.Y(), box.maxCorner[2]), 1e-6));
+            QVERIFY(!doc->bvh().raycast(gp_Lin(pntAbove, gp::DZ())).isValid());
+
+            const gp_Pln planeCenter(center, gp::DZ());
+            QCOMPARE(int(doc->bvh().instancesCrossing(planeCenter).size()), 1);
+            QVERIFY(doc->bvh().instancesCrossing(gp_Pln(pntAbove, gp::DZ())).empty());
+        }
 
         okImport = fnImportInDocument(doc, "inputs/cube.step");
         QVERIFY(okImport);
@@ -145,6 +259,20 @@ void Test::TextId_test()
 {
     QVERIFY(TextId(MAYO_TEXT_ID("Mayo::Test", "foobar")).key == "foobar");
     QVERIFY(TextId(MAYO_TEXT_ID("Mayo::Test", "foobar")).trContext == "Mayo::Test");
+
+    // Cached translations must not be mixed up when the bytes of a TextId object are reused
+    {
+        TextId::invalidateTrCache();
+        char strContext[] = "Mayo::Test";
+        char strKey[] = "foo";
+        const TextId textId1{ QByteArray::fromRawData(strContext, 10), QByteArray::fromRawData(strKey, 3) };
+        QCOMPARE(textId1.tr(), QString("foo"));
+        QCOMPARE(textId1.tr(), QString("foo"));
+        strKey[0] = 'b';
+        const TextId textId2{ QByteArray::fromRawData(strContext, 10), QByteArray::fromRawData(strKey, 3) };
+        QCOMPARE(textId2.tr(), QString("boo"));
+        TextId::invalidateTrCache();
+    }
 }
 
 void Test::FilePath_test()
@@ -275,6 +403,35 @@ void Test::IO_test_data()
     QTest::newRow("cube.stla") << "inputs/cube.stla" << IO::Format_STL;
     QTest::newRow("cube.stlb") << "inputs/cube.stlb" << IO::Format_STL;
     QTest::newRow("cube.obj") << "inputs/cube.obj" << IO::Format_OBJ;
+    QTest::newRow("cube.ply") << "inputs/cube.ply" << IO::Format_PLY;
+    QTest::newRow("square.dxfb") << "inputs/square.dxfb" << IO::Format_DXF;
+}
+
+void Test::IO_probeFormatObj_test()
+{
+    QFETCH(QByteArray, contents);
+    QFETCH(IO::Format, expectedFormat);
+
+    IO::System::FormatProbeInput input = {};
+    input.contentsBegin = contents;
+    input.hintFullSize = contents.size();
+    QCOMPARE(IO::probeFormat_OBJ(input), expectedFormat);
+}
+
+void Test::IO_probeFormatObj_test_data()
+{
+    QTest::addColumn<QByteArray>("contents");
+    QTest::addColumn<IO::Format>("expectedFormat");
+
+    QTest::newRow("vertex") << QByteArray("v 1.0 2.0 3.0\n") << IO::Format_OBJ;
+    QTest::newRow("negative_vertex") << QByteArray("  v\t-1 0 0\r\n") << IO::Format_OBJ;
+    QTest::newRow("texcoord") << QByteArray("vt .5 .5\n") << IO::Format_OBJ;
+    QTest::newRow("header") << QByteArray("# comment\n\nmtllib a.mtl\no Part\ng group\nvn 0 0 1\n") << IO::Format_OBJ;
+    QTest::newRow("no_vertex") << QByteArray("# comment\nmtllib a.mtl\n") << IO::Format_Unknown;
+    QTest::newRow("vertex_no_coords") << QByteArray("v\n0 0 0\n") << IO::Format_Unknown;
+    QTest::newRow("vertex_not_number") << QByteArray("v x y z\n") << IO::Format_Unknown;
+    QTest::newRow("ply") << QByteArray("ply\nformat ascii 1.0\n") << IO::Format_Unknown;
+    QTest::newRow("dxf") << QByteArray("  0\nSECTION\n") << IO::Format_Unknown;
 }
 
 void Test::IO_OccStaticVariablesRollback_test()
@@ -337,6 +494,553 @@ void Test::IO_OccStaticVariablesRollback_test_data()
     QTest::newRow("var_str2") << "mayo.test.variable_str2" << QVariant("foo") << QVariant("blah");
 }
 
+void Test::IO_StlNative_test()
+{
+    QFile file("inputs/cube.stlb");
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QByteArray fileContents = file.readAll();
+    const Span<const uint8_t> data(reinterpret_cast<const uint8_t*>(fileContents.constData()), fileContents.size());
+    QVERIFY(IO::StlNative::isBinary(data));
+    QVERIFY(!IO::StlNative::isBinary(data.first(100)));
+
+    IO::StlNative::Options options;
+    options.weldVertices = false;
+    const Handle_Poly_Triangulation mesh = IO::StlNative::readBinary(data, options, nullptr);
+    QVERIFY(!mesh.IsNull());
+    QCOMPARE(mesh->NbTriangles(), 12);
+    QCOMPARE(mesh->NbNodes(), 36);
+
+    {   // Progressive decoding from a stream
+        std::istringstream istr(fileContents.toStdString());
+        std::vector<uint8_t> contentsBegin;
+        const Handle_Poly_Triangulation meshStream =
+                IO::StlNative::readBinaryStream(istr, fileContents.size(), &contentsBegin, nullptr);
+        QVERIFY(!meshStream.IsNull());
+        QVERIFY(contentsBegin.empty());
+        QCOMPARE(meshStream->NbTriangles(), 12);
+        for (int i = 1; i <= mesh->NbNodes(); ++i)
+            QVERIFY(meshStream->Node(i).IsEqual(mesh->Node(i), Precision::Confusion()));
+
+        // Size mismatch, header is given back to the caller
+        std::istringstream istrOther(fileContents.toStdString());
+        QVERIFY(IO::StlNative::readBinaryStream(istrOther, fileContents.size() + 1, &contentsBegin, nullptr).IsNull());
+        QCOMPARE(contentsBegin.size(), size_t(84));
+    }
+
+    options.weldVertices = true;
+    const Handle_Poly_Triangulation meshWelded = IO::StlNative::readBinary(data, options, nullptr);
+    QVERIFY(!meshWelded.IsNull());
+    QCOMPARE(meshWelded->NbTriangles(), 12);
+    QCOMPARE(meshWelded->NbNodes(), 8);
+    for (int i = 1; i <= meshWelded->NbTriangles(); ++i) {
+        int n1, n2, n3;
+        meshWelded->Triangle(i).Get(n1, n2, n3);
+        const gp_Pnt& pnt1 = meshWelded->Node(n1);
+        const gp_Pnt& pnt1Expected = mesh->Node(3 * i - 2);
+        QVERIFY(pnt1.IsEqual(pnt1Expected, Precision::Confusion()));
+    }
+
+    QFile fileAscii("inputs/cube.stla");
+    QVERIFY(fileAscii.open(QIODevice::ReadOnly));
+    const QByteArray fileAsciiContents = fileAscii.readAll();
+    const Span<const uint8_t> dataAscii(
+                reinterpret_cast<const uint8_t*>(fileAsciiContents.constData()), fileAsciiContents.size());
+    QVERIFY(!IO::StlNative::isBinary(dataAscii));
+    const Handle_Poly_Triangulation meshAscii = IO::StlNative::readAscii(dataAscii, nullptr);
+    QVERIFY(!meshAscii.IsNull());
+    QCOMPARE(meshAscii->NbTriangles(), 12);
+    QCOMPARE(meshAscii->NbNodes(), 36);
+
+    // Two solids in ASCII, the second one translated
+    gp_Trsf trsf;
+    trsf.SetTranslation(gp_Vec(100, 0, 0));
+    IO::StlNative::MeshPart parts[] = { { mesh, gp_Trsf(), false, 0 }, { mesh, trsf, false, 1 } };
+    const std::string solidNames[] = { "first", "second" };
+    const FilePath filepathSolids = std::filesystem::temp_directory_path() / "mayo_solids.stla";
+    auto _ = gsl::finally([=]{ std::filesystem::remove(filepathSolids); });
+    QVERIFY(IO::StlNative::writeAscii(parts, filepathSolids, nullptr, solidNames));
+    QFile fileSolids(filepathTo<QString>(filepathSolids));
+    QVERIFY(fileSolids.open(QIODevice::ReadOnly));
+    const QByteArray fileSolidsContents = fileSolids.readAll();
+    QVERIFY(fileSolidsContents.startsWith("solid first\n"));
+    QVERIFY(fileSolidsContents.contains("endsolid first\nsolid second\n"));
+    QVERIFY(fileSolidsContents.endsWith("endsolid second\n"));
+    QCOMPARE(fileSolidsContents.count("endfacet"), 24);
+
+    // Binary encoding into mapped file and into memory blocks give the same contents
+    QByteArray binaryContents[2];
+    for (bool parallel : { true, false }) {
+        const FilePath filepathBinary = std::filesystem::temp_directory_path() / "mayo_parts.stlb";
+        auto _ = gsl::finally([=]{ std::filesystem::remove(filepathBinary); });
+        QVERIFY(IO::StlNative::writeBinary(parts, filepathBinary, nullptr, parallel));
+        QFile fileBinary(filepathTo<QString>(filepathBinary));
+        QVERIFY(fileBinary.open(QIODevice::ReadOnly));
+        binaryContents[parallel ? 0 : 1] = fileBinary.readAll();
+    }
+
+    QCOMPARE(binaryContents[0].size(), 84 + 24 * 50);
+    QCOMPARE(binaryContents[0], binaryContents[1]);
+    const Span<const uint8_t> dataBinary(
+                reinterpret_cast<const uint8_t*>(binaryContents[0].constData()), binaryContents[0].size());
+    const Handle_Poly_Triangulation meshBinary = IO::StlNative::readBinary(dataBinary, options, nullptr);
+    QVERIFY(!meshBinary.IsNull());
+    QCOMPARE(meshBinary->NbTriangles(), 24);
+    double maxX = -std::numeric_limits<double>::max();
+    for (int i = 1; i <= meshBinary->NbNodes(); ++i)
+        maxX = std::max(maxX, meshBinary->Node(i).X());
+
+    QVERIFY(maxX > 100);
+}
+
+void Test::IO_RemoteFile_test()
+{
+    QVERIFY(IO::RemoteFile::isUrl("https://bucket.s3.amazonaws.com/part.stl"));
+    QVERIFY(IO::RemoteFile::isUrl("HTTP://localhost:8080/part.stl"));
+    QVERIFY(!IO::RemoteFile::isUrl("/home/user/part.stl"));
+    QVERIFY(!IO::RemoteFile::isUrl("ftp://host/part.stl"));
+    QVERIFY(!IO::RemoteFile::isUrl("https"));
+
+    // Signature of presigned URL is dropped from name hint
+    const FilePath fp = filepathFrom(QString("https://bucket.s3.amazonaws.com/dir/part%20A.stp?X-Amz-Signature=abc"));
+    QVERIFY(IO::RemoteFile::isUrl(fp));
+    const FilePath nameHint = IO::RemoteFile::nameHint(IO::RemoteFile::toUrl(fp));
+    QCOMPARE(filepathTo<QString>(nameHint.filename()), QString("part A.stp"));
+    QCOMPARE(filepathTo<QString>(nameHint.extension()), QString(".stp"));
+}
+
+void Test::IO_GltfNative_test()
+{
+    QFile fileStl("inputs/cube.stlb");
+    QVERIFY(fileStl.open(QIODevice::ReadOnly));
+    const QByteArray fileStlContents = fileStl.readAll();
+    const Span<const uint8_t> dataStl(reinterpret_cast<const uint8_t*>(fileStlContents.constData()), fileStlContents.size());
+    const Handle_Poly_Triangulation mesh = IO::StlNative::readBinary(dataStl, {}, nullptr);
+    QVERIFY(!mesh.IsNull());
+
+    // One mesh referred by two nodes, the second one translated
+    IO::GltfNative::Scene scene;
+    scene.meshes.resize(1);
+    scene.meshes.front().name = "cube";
+    scene.meshes.front().primitives.resize(1);
+    scene.meshes.front().primitives.front().parts.push_back({ mesh, gp_Trsf(), false, TopoDS_Face() });
+    scene.nodes.resize(2);
+    scene.nodes.at(0).meshIndex = 0;
+    scene.nodes.at(1).meshIndex = 0;
+    scene.nodes.at(1).trsf.SetTranslation(gp_Vec(100, 0, 0));
+    scene.rootNodes = { 0, 1 };
+
+    const FilePath filepathGlb = std::filesystem::temp_directory_path() / "mayo_cube.glb";
+    auto _ = gsl::finally([=]{ std::filesystem::remove(filepathGlb); });
+    QVERIFY(IO::GltfNative::writeBinary(scene, {}, filepathGlb, nullptr));
+    QFile fileGlb(filepathTo<QString>(filepathGlb));
+    QVERIFY(fileGlb.open(QIODevice::ReadOnly));
+    const QByteArray glb = fileGlb.readAll();
+    const auto glbData = reinterpret_cast<const uchar*>(glb.constData());
+    QVERIFY(glb.startsWith("glTF"));
+    QCOMPARE(qFromLittleEndian<quint32>(glbData + 4), 2u);
+    QCOMPARE(qFromLittleEndian<quint32>(glbData + 8), quint32(glb.size()));
+
+    const quint32 jsonLength = qFromLittleEndian<quint32>(glbData + 12);
+    QCOMPARE(jsonLength % 4, 0u);
+    QCOMPARE(glb.mid(16, 4), QByteArray("JSON"));
+    const QJsonObject json = QJsonDocument::fromJson(glb.mid(20, jsonLength)).object();
+    QCOMPARE(json.value("nodes").toArray().size(), 2);
+    QCOMPARE(json.value("meshes").toArray().size(), 1);
+    const QJsonArray jsonAccessors = json.value("accessors").toArray();
+    QCOMPARE(jsonAccessors.size(), 3); // Positions, normals and indices
+    QCOMPARE(jsonAccessors.at(0).toObject().value("count").toInt(), 36);
+    QCOMPARE(jsonAccessors.at(2).toObject().value("count").toInt(), 36);
+    QCOMPARE(jsonAccessors.at(2).toObject().value("componentType").toInt(), 5123);
+
+    // Binary chunk: positions and normals(36 * 12 bytes each), then 16-bit indices
+    const int binChunkOffset = 20 + int(jsonLength);
+    QCOMPARE(qFromLittleEndian<quint32>(glbData + binChunkOffset), 936u);
+    QCOMPARE(glb.mid(binChunkOffset + 4, 4), QByteArray("BIN\0", 4));
+    const uchar* bin = glbData + binChunkOffset + 8;
+    for (int i = 0; i < mesh->NbNodes(); ++i) {
+        float coords[3];
+        std::memcpy(coords, bin + 12 * i, sizeof(coords));
+        QVERIFY(mesh->Node(i + 1).IsEqual(gp_Pnt(coords[0], coords[1], coords[2]), Precision::Confusion()));
+    }
+
+    for (int i = 0; i < 3 * mesh->NbTriangles(); ++i) {
+        int n[3];
+        mesh->Triangle(i / 3 + 1).Get(n[0], n[1], n[2]);
+        QCOMPARE(int(qFromLittleEndian<quint16>(bin + 864 + 2 * i)), n[i % 3] - 1);
+    }
+}
+
+void Test::IO_fileMetadata_test()
+{
+    IO::System system;
+    IO::addPredefinedFormatProbes(&system);
+
+    const FilePath filepath = std::filesystem::temp_directory_path() / "mayo_file_metadata.step";
+    QFile::remove(filepathTo<QString>(filepath));
+    QVERIFY(QFile::copy("inputs/cube.step", filepathTo<QString>(filepath)));
+
+    // Schema is read from header, entity count is estimated from the last entities
+    const IO::FileMetadata metadata = system.fileMetadata(filepath);
+    QCOMPARE(metadata.format, IO::Format_STEP);
+    QVERIFY(metadata.isScanned);
+    QCOMPARE(metadata.schema, std::string("AUTOMOTIVE_DESIGN"));
+    QCOMPARE(metadata.entityCount, int64_t(361));
+    QCOMPARE(system.fileMetadataCache().size(), size_t(1));
+
+    // Cached entry is used as long as file is unchanged
+    IO::FileMetadata metadataCached;
+    QVERIFY(system.fileMetadataCache().find(filepath, IO::FileStamp::get(filepath), &metadataCached));
+    QCOMPARE(metadataCached.entityCount, int64_t(361));
+    QCOMPARE(system.probeFormat(filepath), IO::Format_STEP);
+
+    // Entry is outdated once file is modified
+    {
+        QFile file(filepathTo<QString>(filepath));
+        QVERIFY(file.open(QIODevice::Append));
+        file.write("\n");
+    }
+
+    QVERIFY(!system.fileMetadataCache().find(filepath, IO::FileStamp::get(filepath), nullptr));
+    QCOMPARE(system.probeFormat(filepath), IO::Format_STEP);
+    QVERIFY(system.fileMetadataCache().find(filepath, IO::FileStamp::get(filepath), &metadataCached));
+    QVERIFY(!metadataCached.isScanned);
+    QCOMPARE(system.fileMetadata(filepath).entityCount, int64_t(361));
+
+    // Not a regular file, nothing cached
+    const FilePath dirPath = std::filesystem::temp_directory_path();
+    QCOMPARE(system.fileMetadata(dirPath).format, IO::Format_Unknown);
+    QVERIFY(!system.fileMetadataCache().find(dirPath, IO::FileStamp::get(dirPath), nullptr));
+    QFile::remove(filepathTo<QString>(filepath));
+}
+
+void Test::IO_estimate_test()
+{
+    IO::System system;
+    IO::addPredefinedFormatProbes(&system);
+
+    // Binary STL, triangle count is read from header
+    const IO::System::FileEstimate estimateStlb = system.estimate("inputs/cube.stlb");
+    QCOMPARE(estimateStlb.format, IO::Format_STL);
+    QCOMPARE(estimateStlb.contentsSize, uint64_t(684));
+    QCOMPARE(estimateStlb.triangleCount, int64_t(12));
+    QVERIFY(estimateStlb.providesMesh);
+    QVERIFY(!estimateStlb.providesBRep);
+    QVERIFY(estimateStlb.memory > 0);
+    QVERIFY(estimateStlb.work > 0);
+
+    // ASCII STL, facets are counted
+    QCOMPARE(system.estimate("inputs/cube.stla").triangleCount, int64_t(12));
+
+    // STEP, entity count is estimated from the end of the data section
+    const IO::System::FileEstimate estimateStep = system.estimate("inputs/cube.step");
+    QCOMPARE(estimateStep.format, IO::Format_STEP);
+    QCOMPARE(estimateStep.entityCount, int64_t(361));
+    QVERIFY(estimateStep.providesBRep);
+    QVERIFY(estimateStep.work > estimateStlb.work);
+
+    // ASCII DXF, entities of section ENTITIES are counted. Value "0" of group 8(layer) is not an entity
+    const FilePath filepathDxf = std::filesystem::temp_directory_path() / "mayo_estimate.dxf";
+    {
+        QFile file(filepathTo<QString>(filepathDxf));
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        file.write("  0\nSECTION\n  2\nENTITIES\n"
+                   "  0\nLINE\n  8\n0\n 10\n0.0\n 20\n0.0\n 11\n1.0\n 21\n0.0\n"
+                   "  0\nLINE\n  8\n0\n 10\n1.0\n 20\n0.0\n 11\n1.0\n 21\n1.0\n"
+                   "  0\nENDSEC\n  0\nEOF\n");
+    }
+
+    const IO::System::FileEstimate estimateDxf = system.estimate(filepathDxf);
+    QCOMPARE(estimateDxf.format, IO::Format_DXF);
+    QCOMPARE(estimateDxf.entityCount, int64_t(2));
+    QVERIFY(estimateDxf.work > 0);
+    QFile::remove(filepathTo<QString>(filepathDxf));
+
+    // Unknown file
+    const IO::System::FileEstimate estimateNone = system.estimate("inputs/file_not_existing.step");
+    QCOMPARE(estimateNone.entityCount, int64_t(-1));
+    QCOMPARE(estimateNone.memory, uint64_t(0));
+}
+
+void Test::IO_probeCompression_test()
+{
+    using namespace std::literals;
+    QCOMPARE(IO::probeCompression("\x1F\x8B\x08\x00"sv), IO::Compression::Gzip);
+    QCOMPARE(IO::probeCompression("\x28\xB5\x2F\xFD\x00"sv), IO::Compression::Zstd);
+    QCOMPARE(IO::probeCompression("\x28\xB5\x2F"sv), IO::Compression::None);
+    QCOMPARE(IO::probeCompression("ISO-10303-21;"sv), IO::Compression::None);
+    QCOMPARE(IO::probeCompression(""sv), IO::Compression::None);
+    QVERIFY(IO::isCompressionSupported(IO::Compression::None));
+    QCOMPARE(IO::compressionFileSuffix(IO::Compression::Gzip), "gz"sv);
+    QCOMPARE(IO::compressionFileSuffix(IO::Compression::Zstd), "zst"sv);
+
+    // Gzip ISIZE trailer is little-endian
+    const std::string_view gzipEnd = "\x00\x00\x00\x00\x10\x27\x00\x00"sv;
+    QCOMPARE(IO::decompressedSizeHint({}, gzipEnd, IO::Compression::Gzip), uint64_t(10000));
+    QCOMPARE(IO::decompressedSizeHint({}, gzipEnd, IO::Compression::None), uint64_t(0));
+}
+
+void Test::IO_readBuffer_test()
+{
+    QFile file("inputs/cube.stlb");
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QByteArray fileContents = file.readAll();
+    const Span<const uint8_t> data(reinterpret_cast<const uint8_t*>(fileContents.constData()), fileContents.size());
+    const std::unique_ptr<IO::Reader> reader = IO::OccFactoryReader().create(IO::Format_STL);
+    QVERIFY(reader);
+
+    auto app = Application::instance();
+    QVERIFY(reader->readBuffer(data, "cube.stlb", nullptr));
+    DocumentPtr doc = app->newDocument();
+    QCOMPARE(reader->transfer(doc, nullptr).Size(), 1);
+    app->closeDocument(doc);
+
+    // Default implementation of readStream() collects contents then calls readBuffer()
+    std::istringstream istr(std::string(fileContents.constData(), fileContents.size()));
+    QVERIFY(reader->readStream(istr, "cube.stlb", nullptr));
+    doc = app->newDocument();
+    QCOMPARE(reader->transfer(doc, nullptr).Size(), 1);
+    app->closeDocument(doc);
+}
+
+void Test::IO_reloadDocument_test()
+{
+    auto app = Application::instance();
+    auto fnImportInDocument = [=](const DocumentPtr& doc, const FilePath& fp, bool reload) {
+        return app->ioSystem()->importInDocument()
+                .targetDocument(doc)
+                .withFilepath(fp)
+                .withEntitiesReloaded(reload)
+                .execute();
+    };
+
+    DocumentPtr doc = app->newDocument();
+    auto _ = gsl::finally([=]{ app->closeDocument(doc); });
+    QVERIFY(fnImportInDocument(doc, "inputs/cube.step", false));
+    QCOMPARE(doc->entityCount(), 1);
+    const TDF_Label labelEntity = doc->entityLabel(0);
+
+    // Geometry is unchanged, existing entity is kept
+    QSignalSpy sigSpy_docEntityAdded(doc.get(), &Document::entityAdded);
+    QSignalSpy sigSpy_docEntityAboutToBeDestroyed(doc.get(), &Document::entityAboutToBeDestroyed);
+    QVERIFY(fnImportInDocument(doc, "inputs/cube.step", true));
+    QCOMPARE(doc->entityCount(), 1);
+    QCOMPARE(doc->entityLabel(0), labelEntity);
+    QCOMPARE(sigSpy_docEntityAdded.count(), 0);
+    QCOMPARE(sigSpy_docEntityAboutToBeDestroyed.count(), 0);
+
+    // No matching entity, existing entity is replaced
+    QVERIFY(fnImportInDocument(doc, "inputs/cube.stlb", true));
+    QCOMPARE(doc->entityCount(), 1);
+    QVERIFY(doc->entityLabel(0) != labelEntity);
+    QCOMPARE(sigSpy_docEntityAdded.count(), 1);
+    QCOMPARE(sigSpy_docEntityAboutToBeDestroyed.count(), 1);
+}
+
+void Test::IO_igesParallelRootTransfer_test()
+{
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+    const int threadCount = int(std::thread::hardware_concurrency());
+    if (threadCount < 2)
+        QSKIP("Parallel transfer of roots requires at least two hardware threads");
+
+    // IGES file with more root entities than there are batches
+    auto app = Application::instance();
+    const FilePath filepath = std::filesystem::temp_directory_path() / "mayo_parallel_roots.iges";
+    auto _ = gsl::finally([=]{ std::filesystem::remove(filepath); });
+    const int boxCount = 2 * threadCount + 1;
+    {
+        DocumentPtr doc = app->newDocument();
+        auto _doc = gsl::finally([=]{ app->closeDocument(doc); });
+        for (int i = 0; i < boxCount; ++i) {
+            gp_Trsf trsf;
+            trsf.SetTranslation(gp_Vec(20. * i, 0, 0));
+            const TopoDS_Shape box = BRepPrimAPI_MakeBox(10, 10, 10 + i).Shape().Moved(trsf);
+            doc->xcaf().shapeTool()->AddShape(box, false);
+        }
+
+        IO::OccIgesWriter writer;
+        const ApplicationItem appItems[] = { ApplicationItem(doc) };
+        QVERIFY(writer.transfer(appItems, nullptr));
+        QVERIFY(writer.writeFile(filepath, nullptr));
+    }
+
+    // Parallel transfer gives the same entities as sequential transfer, each root being translated once
+    struct TransferResult {
+        int entityCount = 0;
+        int faceCount = 0;
+    };
+    auto fnTransfer = [&](bool parallel) {
+        TransferResult result;
+        DocumentPtr doc = app->newDocument();
+        auto _doc = gsl::finally([=]{ app->closeDocument(doc); });
+        IO::OccIgesReader reader;
+        reader.parameters().parallelRootTransfer = parallel;
+        if (!reader.readFile(filepath, nullptr))
+            return result;
+
+        const TDF_LabelSequence seqEntity = reader.transfer(doc, nullptr);
+        result.entityCount = seqEntity.Size();
+        for (const TDF_Label& labelEntity : seqEntity) {
+            for (TopExp_Explorer expl(XCaf::shape(labelEntity), TopAbs_FACE); expl.More(); expl.Next())
+                ++result.faceCount;
+        }
+
+        return result;
+    };
+
+    const TransferResult resultSequential = fnTransfer(false);
+    const TransferResult resultParallel = fnTransfer(true);
+    QVERIFY(resultSequential.entityCount > 0);
+    QCOMPARE(resultSequential.faceCount, 6 * boxCount);
+    QCOMPARE(resultParallel.entityCount, resultSequential.entityCount);
+    QCOMPARE(resultParallel.faceCount, resultSequential.faceCount);
+#else
+    QSKIP("Parallel transfer of roots requires OpenCascade >= v7.6.0");
+#endif
+}
+
+void Test::IO_importMemoryBudget_test()
+{
+    QVERIFY(IO::System::estimatedReadMemory(IO::Format_STEP, 1000) > IO::System::estimatedReadMemory(IO::Format_STL, 1000));
+    QCOMPARE(IO::System::estimatedReadMemory(IO::Format_STEP, 0), uint64_t(0));
+
+    // Budget exceeded by each file: files are read one after the other, but all imported
+    auto app = Application::instance();
+    const uint64_t budgetOnEntry = app->ioSystem()->importMemoryBudget();
+    auto _ = gsl::finally([=]{ app->ioSystem()->setImportMemoryBudget(budgetOnEntry); });
+    app->ioSystem()->setImportMemoryBudget(1);
+    const FilePath filepaths[] = { "inputs/cube.step", "inputs/cube.iges", "inputs/cube.stlb", "inputs/cube.brep" };
+    DocumentPtr doc = app->newDocument();
+    auto _doc = gsl::finally([=]{ app->closeDocument(doc); });
+    const bool okImport = app->ioSystem()->importInDocument()
+            .targetDocument(doc)
+            .withFilepaths(filepaths)
+            .execute();
+    QVERIFY(okImport);
+    QVERIFY(doc->entityCount() >= int(std::size(filepaths)));
+}
+
+void Test::IO_importThrowingReader_test()
+{
+    // Reader throwing an exception during read(STEP) or transfer(IGES)
+    class ThrowingReader : public IO::Reader {
+    public:
+        ThrowingReader(bool throwOnRead) : m_throwOnRead(throwOnRead) {}
+        bool readFile(const FilePath&, TaskProgress*) override {
+            if (m_throwOnRead)
+                throw std::runtime_error("read failure");
+
+            return true;
+        }
+        TDF_LabelSequence transfer(DocumentPtr, TaskProgress*) override {
+            throw std::runtime_error("transfer failure");
+        }
+
+    private:
+        bool m_throwOnRead = false;
+    };
+    class ThrowingFactoryReader : public IO::FactoryReader {
+    public:
+        Span<const IO::Format> formats() const override {
+            static const IO::Format array[] = { IO::Format_STEP, IO::Format_IGES };
+            return array;
+        }
+        std::unique_ptr<IO::Reader> create(IO::Format format) const override {
+            return std::make_unique<ThrowingReader>(format == IO::Format_STEP);
+        }
+        std::unique_ptr<PropertyGroup> createProperties(IO::Format, PropertyGroup*) const override {
+            return {};
+        }
+    };
+
+    IO::System system;
+    system.addFactoryReader(std::make_unique<ThrowingFactoryReader>());
+    system.addFactoryReader(std::make_unique<IO::OccFactoryReader>());
+    IO::addPredefinedFormatProbes(&system);
+
+    // Failing files are reported as errors, import isn't blocked and other files are imported
+    auto app = Application::instance();
+    DocumentPtr doc = app->newDocument();
+    auto _ = gsl::finally([=]{ app->closeDocument(doc); });
+    const FilePath filepaths[] = { "inputs/cube.step", "inputs/cube.iges", "inputs/cube.stlb" };
+    const bool okImport = system.importInDocument()
+            .targetDocument(doc)
+            .withFilepaths(filepaths)
+            .execute();
+    QVERIFY(!okImport);
+    QCOMPARE(doc->entityCount(), 1);
+
+    // Single file case
+    QVERIFY(!system.importInDocument().targetDocument(doc).withFilepath("inputs/cube.step").execute());
+    QCOMPARE(doc->entityCount(), 1);
+}
+
+void Test::IO_exportThrowingWriter_test()
+{
+    // STEP/IGES writers are executed one after the other, STEP writer throws an exception
+    struct WriterStats {
+        std::atomic<int> activeCount = 0;
+        std::atomic<int> maxActiveCount = 0;
+    };
+    class SerializedWriter : public IO::Writer {
+    public:
+        SerializedWriter(IO::Format format, WriterStats* stats) : m_format(format), m_stats(stats) {}
+        bool transfer(Span<const ApplicationItem>, TaskProgress*) override { return true; }
+        bool writeFile(const FilePath&, TaskProgress*) override {
+            const int activeCount = ++(m_stats->activeCount);
+            m_stats->maxActiveCount = std::max(m_stats->maxActiveCount.load(), activeCount);
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            --(m_stats->activeCount);
+            if (m_format == IO::Format_STEP)
+                throw std::runtime_error("write failure");
+
+            return true;
+        }
+
+    private:
+        IO::Format m_format = IO::Format_Unknown;
+        WriterStats* m_stats = nullptr;
+    };
+    class SerializedFactoryWriter : public IO::FactoryWriter {
+    public:
+        SerializedFactoryWriter(WriterStats* stats) : m_stats(stats) {}
+        Span<const IO::Format> formats() const override {
+            static const IO::Format array[] = { IO::Format_STEP, IO::Format_IGES };
+            return array;
+        }
+        std::unique_ptr<IO::Writer> create(IO::Format format) const override {
+            return std::make_unique<SerializedWriter>(format, m_stats);
+        }
+        std::unique_ptr<PropertyGroup> createProperties(IO::Format, PropertyGroup*) const override {
+            return {};
+        }
+
+    private:
+        WriterStats* m_stats = nullptr;
+    };
+
+    WriterStats stats;
+    IO::System system;
+    system.setMaxConcurrency(4);
+    system.addFactoryWriter(std::make_unique<SerializedFactoryWriter>(&stats));
+    int finishedCount = 0;
+    int successCount = 0;
+    const bool okExport = system.exportApplicationItems()
+            .targetFile("mayo_export_0.step")
+            .targetFormat(IO::Format_STEP)
+            .addTarget("mayo_export_1.iges", IO::Format_IGES)
+            .addTarget("mayo_export_2.iges", IO::Format_IGES)
+            .withTargetFinished([&](const IO::System::ExportTarget&, bool success) {
+                ++finishedCount;
+                successCount += success ? 1 : 0;
+            })
+            .execute();
+    QVERIFY(!okExport);
+    QCOMPARE(finishedCount, 3);
+    QCOMPARE(successCount, 2);
+    QCOMPARE(stats.maxActiveCount.load(), 1);
+}
+
 void Test::BRepUtils_test()
 {
     QVERIFY(BRepUtils::moreComplex(TopAbs_COMPOUND, TopAbs_SOLID));
@@ -353,6 +1057,135 @@ void Test::BRepUtils_test()
         QVERIFY(BRepUtils::hashCode(shapeBase) >= 0);
         QCOMPARE(BRepUtils::hashCode(shapeBase), BRepUtils::hashCode(shapeCopy));
     }
+
+    {
+        const TopoDS_Shape shapeBox = BRepPrimAPI_MakeBox(25, 25, 25);
+        auto fnFaceCount = [](const TopoDS_Shape& shape) {
+            int count = 0;
+            BRepUtils::forEachSubFace(shape, [&](const TopoDS_Face&) { ++count; });
+            return count;
+        };
+
+        const std::string strShape = BRepUtils::shapeToString(shapeBox);
+        QCOMPARE(fnFaceCount(BRepUtils::shapeFromString(strShape)), 6);
+
+        const std::string binShape = BRepUtils::shapeToBinary(shapeBox);
+        QVERIFY(binShape.size() < strShape.size());
+        QCOMPARE(fnFaceCount(BRepUtils::shapeFromBinary(binShape)), 6);
+
+        const std::string zbinShape = BRepUtils::shapeToBinary(shapeBox, true/*compress*/);
+        QVERIFY(zbinShape.size() < binShape.size());
+        QCOMPARE(fnFaceCount(BRepUtils::shapeFromBinary(zbinShape)), 6);
+
+        QVERIFY(BRepUtils::shapeFromBinary({}).IsNull());
+    }
+}
+
+void Test::BRepMassProperties_test()
+{
+    QCOMPARE(BRepMassProperties::compute(TopoDS_Shape()).faceCount, 0);
+
+    // Compound of two boxes 10x20x30, the second one translated along X
+    TopoDS_Compound compound;
+    BRep_Builder builder;
+    builder.MakeCompound(compound);
+    builder.Add(compound, BRepPrimAPI_MakeBox(10, 20, 30).Shape());
+    builder.Add(compound, BRepPrimAPI_MakeBox(gp_Pnt(100, 0, 0), 10, 20, 30).Shape());
+
+    auto fnCheck = [](const BRepMassProperties& props) {
+        QCOMPARE(props.faceCount, 12);
+        QVERIFY(std::abs(props.area - 2 * 2 * (10 * 20 + 20 * 30 + 10 * 30)) < 1e-6);
+        QVERIFY(std::abs(props.volume - 2 * 10 * 20 * 30) < 1e-6);
+        QVERIFY(props.centroid.IsEqual(gp_Pnt(55, 10, 15), 1e-6));
+    };
+    fnCheck(BRepMassProperties::compute(compound, BRepMassProperties::Mode::Exact));
+    // Without triangulation, faces are computed the exact way
+    fnCheck(BRepMassProperties::compute(compound, BRepMassProperties::Mode::Triangulation));
+    // Triangulation of planar faces is exact
+    BRepMesh_IncrementalMesh mesher(compound, 0.1);
+    fnCheck(BRepMassProperties::compute(compound, BRepMassProperties::Mode::Triangulation));
+}
+
+void Test::Bvh_test()
+{
+    // Unit boxes on a grid, enough of them so subtrees are built concurrently
+    constexpr int gridSize = 50;
+    std::vector<Bvh::Box> vecBox;
+    for (int i = 0; i < gridSize; ++i) {
+        for (int j = 0; j < gridSize; ++j) {
+            for (int k = 0; k < gridSize; ++k) {
+                Bvh::Box box;
+                box.add(gp_Pnt(i, j, k));
+                box.add(gp_Pnt(i + 0.5, j + 0.5, k + 0.5));
+                vecBox.push_back(box);
+            }
+        }
+    }
+
+    const Bvh bvh = Bvh::build(vecBox);
+    QCOMPARE(bvh.itemCount(), int(vecBox.size()));
+    QCOMPARE(bvh.box().minCorner[0], 0.);
+    QCOMPARE(bvh.box().maxCorner[2], gridSize - 0.5);
+
+    // Each item is referenced by a single leaf node, which contains its box
+    std::vector<int> vecItemRefCount(vecBox.size(), 0);
+    for (const Bvh::Node& node : bvh.nodes()) {
+        QVERIFY(node.isLeaf() || node.first + 1 < int(bvh.nodes().size()));
+        for (int i = node.first; node.isLeaf() && i < node.first + node.count; ++i) {
+            const int iItem = bvh.items().at(i);
+            ++vecItemRefCount.at(iItem);
+            for (int axis = 0; axis < 3; ++axis) {
+                QVERIFY(node.box.minCorner[axis] <= vecBox.at(iItem).minCorner[axis]);
+                QVERIFY(vecBox.at(iItem).maxCorner[axis] <= node.box.maxCorner[axis]);
+            }
+        }
+    }
+
+    QVERIFY(std::all_of(vecItemRefCount.cbegin(), vecItemRefCount.cend(), [](int count) { return count == 1; }));
+
+    // Box query gives the same items as brute force
+    Bvh::Box boxQuery;
+    boxQuery.add(gp_Pnt(10.2, 20.2, 30.2));
+    boxQuery.add(gp_Pnt(14.7, 22.7, 30.7));
+    auto fnIntersects = [](const Bvh::Box& lhs, const Bvh::Box& rhs) {
+        for (int i = 0; i < 3; ++i) {
+            if (lhs.maxCorner[i] < rhs.minCorner[i] || rhs.maxCorner[i] < lhs.minCorner[i])
+                return false;
+        }
+
+        return true;
+    };
+    std::vector<int> vecFound;
+    bvh.traverse(
+                [&](const Bvh::Box& box) { return fnIntersects(box, boxQuery); },
+                [&](int iItem) { if (fnIntersects(vecBox.at(iItem), boxQuery)) vecFound.push_back(iItem); });
+    std::vector<int> vecExpected;
+    for (int i = 0; i < int(vecBox.size()); ++i) {
+        if (fnIntersects(vecBox.at(i), boxQuery))
+            vecExpected.push_back(i);
+    }
+
+    std::sort(vecFound.begin(), vecFound.end());
+    QCOMPARE(vecFound, vecExpected);
+    QCOMPARE(int(vecExpected.size()), 5 * 3 * 1);
+
+    // Nearest box to a point outside of the grid
+    const gp_Pnt pnt(-3, 10.25, 10.25);
+    int iNearest = -1;
+    double bestSqDist = std::numeric_limits<double>::max();
+    bvh.traverseNearest(
+                [&](const Bvh::Box& box) { return box.squareDistance(pnt); },
+                [&](int iItem) {
+        const double sqDist = vecBox.at(iItem).squareDistance(pnt);
+        if (sqDist < bestSqDist) {
+            bestSqDist = sqDist;
+            iNearest = iItem;
+        }
+
+        return bestSqDist;
+    });
+    QCOMPARE(iNearest, 10 * gridSize + 10);
+    QCOMPARE(bestSqDist, 9.);
 }
 
 void Test::CafUtils_test()
@@ -360,6 +1193,644 @@ void Test::CafUtils_test()
     // TODO Add CafUtils::labelTag() test for multi-threaded safety
 }
 
+void Test::LabelAttributesCache_test()
+{
+    auto app = Application::instance();
+    DocumentPtr doc = app->newDocument();
+    auto _ = gsl::finally([=]{ app->closeDocument(doc); });
+    const TDF_Label label = doc->xcaf().shapeTool()->AddShape(BRepPrimAPI_MakeBox(10, 20, 30), false);
+    TDataStd_Name::Set(label, "box");
+    doc->xcaf().colorTool()->SetColor(label, Quantity_Color(Quantity_NOC_RED), XCAFDoc_ColorGen);
+
+    LabelAttributesCache& cache = doc->labelAttributesCache();
+    const auto attrs = cache.attributes(label);
+    QVERIFY(attrs);
+    QCOMPARE(attrs->name, TCollection_ExtendedString("box"));
+    QVERIFY(!attrs->shape.IsNull());
+    QVERIFY(!attrs->isAssembly);
+    QVERIFY(!attrs->isReference);
+    QVERIFY(attrs->hasColor);
+    QVERIFY(attrs->color.IsEqual(Quantity_Color(Quantity_NOC_RED)));
+    QCOMPARE(cache.attributes(label), attrs);
+
+    // Snapshot is kept until forget() is called
+    TDataStd_Name::Set(label, "cube");
+    QCOMPARE(cache.attributes(label)->name, TCollection_ExtendedString("box"));
+    cache.forget(label);
+    QCOMPARE(cache.attributes(label)->name, TCollection_ExtendedString("cube"));
+}
+
+void Test::SubShapeCache_test()
+{
+    auto app = Application::instance();
+    DocumentPtr doc = app->newDocument();
+    auto _ = gsl::finally([=]{ app->closeDocument(doc); });
+    const TopoDS_Shape box = BRepPrimAPI_MakeBox(10, 20, 30).Shape();
+    Handle_XCAFDoc_ShapeTool shapeTool = doc->xcaf().shapeTool();
+    const TDF_Label labelAsm = shapeTool->NewShape();
+    const TDF_Label labelProto = shapeTool->AddShape(box, false);
+    gp_Trsf trsf;
+    trsf.SetTranslation(gp_Vec(100, 0, 0));
+    shapeTool->AddComponent(labelAsm, labelProto, TopLoc_Location());
+    shapeTool->AddComponent(labelAsm, labelProto, TopLoc_Location(trsf));
+    shapeTool->UpdateAssemblies();
+
+    SubShapeCache& cache = doc->subShapeCache();
+    cache.computePrototypeSubShapes(CafUtils::makeLabelSequence({ labelAsm }));
+    const auto subShapes = cache.subShapes(box);
+    QCOMPARE(subShapes->mapFace.Extent(), 6);
+    QCOMPARE(subShapes->mapEdge.Extent(), 12);
+    QCOMPARE(subShapes->mapVertex.Extent(), 8);
+    QCOMPARE(subShapes->triangulatedFaceCount, 0);
+    // Entry is shared whatever the location of the shape
+    QCOMPARE(cache.subShapes(box.Moved(trsf)), subShapes);
+
+    // Faces of the instances are located, prototype is explored once
+    int faceCount = 0;
+    double maxX = -std::numeric_limits<double>::max();
+    cache.forEachLabelFace(labelAsm, TopLoc_Location(), [&](const TopoDS_Face& face, bool isTriangulated) {
+        QVERIFY(!isTriangulated);
+        ++faceCount;
+        maxX = std::max(maxX, BndBoxCache::shapeBox(face).CornerMax().X());
+    });
+    QCOMPARE(faceCount, 12);
+    QVERIFY(std::abs(maxX - 110) < Precision::Confusion());
+
+    // Triangulation flags are a snapshot, kept until forget() is called
+    BRepMesh_IncrementalMesh mesher(box, 0.1);
+    QCOMPARE(cache.subShapes(box)->triangulatedFaceCount, 0);
+    cache.forget(labelAsm);
+    QCOMPARE(cache.subShapes(box)->triangulatedFaceCount, 6);
+}
+
+void Test::ShapeStyleCache_test()
+{
+    auto app = Application::instance();
+    DocumentPtr doc = app->newDocument();
+    auto _ = gsl::finally([=]{ app->closeDocument(doc); });
+    Handle_XCAFDoc_ShapeTool shapeTool = doc->xcaf().shapeTool();
+    Handle_XCAFDoc_ColorTool colorTool = doc->xcaf().colorTool();
+    const TDF_Label labelProto = shapeTool->AddShape(BRepPrimAPI_MakeBox(10, 20, 30).Shape(), false);
+    const TopoDS_Shape face = TopExp_Explorer(XCaf::shape(labelProto), TopAbs_FACE).Current();
+    const TDF_Label labelFace = shapeTool->AddSubShape(labelProto, face);
+    QVERIFY(!labelFace.IsNull());
+    colorTool->SetColor(labelProto, Quantity_Color(Quantity_NOC_BLUE1), XCAFDoc_ColorGen);
+    colorTool->SetColor(labelFace, Quantity_Color(Quantity_NOC_RED), XCAFDoc_ColorSurf);
+
+    ShapeStyleCache& cache = doc->styleCache();
+    cache.computePrototypeStyles(CafUtils::makeLabelSequence({ labelProto }));
+    const auto style = cache.prototypeStyle(labelProto);
+    QVERIFY(style->hasColor);
+    QVERIFY(style->color == Quantity_Color(Quantity_NOC_BLUE1));
+    QCOMPARE(style->subShapes->mapFace.Extent(), 6);
+    int coloredFaceCount = 0;
+    for (int iFace = 1; iFace <= style->subShapes->mapFace.Extent(); ++iFace) {
+        const Quantity_Color* faceColor = style->faceColor(iFace);
+        if (faceColor) {
+            ++coloredFaceCount;
+            QVERIFY(*faceColor == Quantity_Color(Quantity_NOC_RED));
+            QVERIFY(style->subShapes->mapFace.FindKey(iFace).IsSame(face));
+        }
+    }
+
+    QCOMPARE(coloredFaceCount, 1);
+    QCOMPARE(cache.prototypeStyle(labelProto), style);
+
+    // Color of a reference takes precedence over the color of the referred shape, then inherited
+    LabelAttributes attrsNode;
+    LabelAttributes attrsShape;
+    const Quantity_Color inheritedColor(Quantity_NOC_GREEN);
+    QVERIFY(!ShapeStyleCache::nodeColor(attrsNode, attrsShape, nullptr));
+    QCOMPARE(ShapeStyleCache::nodeColor(attrsNode, attrsShape, &inheritedColor), &inheritedColor);
+    attrsShape.hasColor = true;
+    QCOMPARE(ShapeStyleCache::nodeColor(attrsNode, attrsShape, &inheritedColor), &attrsShape.color);
+    attrsNode.hasColor = true;
+    QCOMPARE(ShapeStyleCache::nodeColor(attrsNode, attrsShape, &inheritedColor), &attrsNode.color);
+}
+
+void Test::ShapeDeduplication_test()
+{
+    // Hash doesn't depend on the location of the shape nor on the TShape objects
+    const TopoDS_Shape box = BRepPrimAPI_MakeBox(10, 20, 30).Shape();
+    const TopoDS_Shape boxOther = BRepPrimAPI_MakeBox(10, 20, 30).Shape();
+    const QByteArray boxHash = ShapeDeduplication::geometryHash(box);
+    QCOMPARE(ShapeDeduplication::geometryHash(boxOther), boxHash);
+    QCOMPARE(ShapeDeduplication::geometryHash(box.Located(gp_Trsf())), boxHash);
+    gp_Trsf trsf;
+    trsf.SetTranslation(gp_Vec(5, 0, 0));
+    QCOMPARE(ShapeDeduplication::geometryHash(box.Moved(trsf)), boxHash);
+    QVERIFY(ShapeDeduplication::geometryHash(BRepPrimAPI_MakeBox(10, 20, 31).Shape()) != boxHash);
+
+    // Two assemblies referring to distinct but identical prototypes
+    auto app = Application::instance();
+    DocumentPtr doc = app->newDocument();
+    auto _ = gsl::finally([=]{ app->closeDocument(doc); });
+    Handle_XCAFDoc_ShapeTool shapeTool = doc->xcaf().shapeTool();
+    const TDF_Label labelAsm1 = shapeTool->NewShape();
+    const TDF_Label labelAsm2 = shapeTool->NewShape();
+    const TDF_Label labelProto1 = shapeTool->AddShape(box, false);
+    const TDF_Label labelProto2 = shapeTool->AddShape(boxOther, false);
+    const TDF_Label labelComp1 = shapeTool->AddComponent(labelAsm1, labelProto1, TopLoc_Location());
+    const TDF_Label labelComp2 = shapeTool->AddComponent(labelAsm2, labelProto2, TopLoc_Location(trsf));
+    shapeTool->UpdateAssemblies();
+
+    TDF_LabelSequence seqAsm;
+    seqAsm.Append(labelAsm1);
+    seqAsm.Append(labelAsm2);
+    const ShapeDeduplication::Report report = ShapeDeduplication::deduplicate(seqAsm, {});
+    QCOMPARE(report.prototypeCount, 2);
+    QCOMPARE(report.mergedPrototypeCount, 1);
+    QCOMPARE(report.redirectedReferenceCount, 1);
+    QCOMPARE(XCaf::shapeReferred(labelComp1), labelProto1);
+    QCOMPARE(XCaf::shapeReferred(labelComp2), labelProto1);
+    QVERIFY(XCaf::shapeReferenceLocation(labelComp2).IsEqual(TopLoc_Location(trsf)));
+    QVERIFY(!XCaf::isShape(labelProto2));
+}
+
+void Test::DocumentConcurrentModelTree_test()
+{
+    auto app = Application::instance();
+    DocumentPtr doc = app->newDocument();
+    auto _ = gsl::finally([=]{ app->closeDocument(doc); });
+    Handle_XCAFDoc_ShapeTool shapeTool = doc->xcaf().shapeTool();
+    const TDF_Label labelProto = shapeTool->AddShape(BRepPrimAPI_MakeBox(10, 20, 30).Shape(), false);
+    TDF_LabelSequence seqLabelAsm;
+    for (int i = 0; i < 200; ++i) {
+        const TDF_Label labelAsm = shapeTool->NewShape();
+        gp_Trsf trsf;
+        trsf.SetTranslation(gp_Vec(i * 20, 0, 0));
+        shapeTool->AddComponent(labelAsm, labelProto, TopLoc_Location());
+        shapeTool->AddComponent(labelAsm, labelProto, TopLoc_Location(trsf));
+        seqLabelAsm.Append(labelAsm);
+    }
+
+    shapeTool->UpdateAssemblies();
+    doc->addEntityTreeNode(seqLabelAsm.First());
+    doc->addEntityTreeNodes(seqLabelAsm, true);
+    QCOMPARE(doc->entityCount(), seqLabelAsm.Size());
+
+    // Entities are added in order, with the same tree nodes as the sequential build
+    const Tree<TDF_Label>& modelTree = doc->modelTree();
+    for (int i = 0; i < doc->entityCount(); ++i) {
+        const TreeNodeId entityId = doc->entityTreeNodeId(i);
+        QVERIFY(modelTree.nodeData(entityId) == seqLabelAsm.Value(i + 1));
+        const auto vecItem = XCaf::collectAssemblyTree(seqLabelAsm.Value(i + 1));
+        std::vector<TreeNodeId> vecNodeId;
+        traverseTree(entityId, modelTree, [&](TreeNodeId id) { vecNodeId.push_back(id); });
+        QCOMPARE(vecNodeId.size(), vecItem.size());
+        QCOMPARE(int(vecItem.size()), 5); // Assembly, 2 references, 2 referred prototypes
+        for (size_t j = 0; j < vecItem.size(); ++j) {
+            QVERIFY(modelTree.nodeData(vecNodeId.at(j)) == vecItem.at(j).label);
+            const TreeNodeId parentId = vecItem.at(j).parentIndex >= 0 ? vecNodeId.at(vecItem.at(j).parentIndex) : 0;
+            QCOMPARE(modelTree.nodeParent(vecNodeId.at(j)), parentId);
+        }
+    }
+}
+
+void Test::DocumentDeferredScaling_test()
+{
+    auto app = Application::instance();
+    DocumentPtr doc = app->newDocument();
+    auto _ = gsl::finally([=]{ app->closeDocument(doc); });
+    Handle_XCAFDoc_ShapeTool shapeTool = doc->xcaf().shapeTool();
+    const TDF_Label labelProto = shapeTool->AddShape(BRepPrimAPI_MakeBox(10, 20, 30).Shape(), false);
+    const TopoDS_Shape face = TopExp_Explorer(XCaf::shape(labelProto), TopAbs_FACE).Current();
+    const TDF_Label labelFace = shapeTool->AddSubShape(labelProto, face);
+    QVERIFY(!labelFace.IsNull());
+    const TDF_Label labelAsm = shapeTool->NewShape();
+    gp_Trsf trsf;
+    trsf.SetTranslation(gp_Vec(5, 0, 0));
+    const TDF_Label labelComp = shapeTool->AddComponent(labelAsm, labelProto, TopLoc_Location(trsf));
+    shapeTool->UpdateAssemblies();
+    doc->addEntityTreeNode(labelAsm);
+
+    QCOMPARE(doc->deferredScaling(labelAsm), 1.);
+    doc->setDeferredScaling(labelAsm, 2.);
+    QVERIFY(doc->hasDeferredScalings());
+    QCOMPARE(doc->deferredScaling(labelAsm), 2.);
+
+    QSignalSpy spyApplied(doc.get(), &Document::deferredScalingsApplied);
+    doc->applyDeferredScalings();
+    QCOMPARE(spyApplied.count(), 1);
+    QVERIFY(!doc->hasDeferredScalings());
+    QCOMPARE(doc->deferredScaling(labelAsm), 1.);
+
+    // Prototype is scaled about the origin, translation of the component is scaled as well
+    Bnd_Box bndBox;
+    BRepBndLib::AddOptimal(XCaf::shape(labelAsm), bndBox, false, false);
+    const BndBoxCoords bbc = BndBoxCoords::get(bndBox);
+    QCOMPARE(bbc.xmin, 10.);
+    QCOMPARE(bbc.xmax, 30.);
+    QCOMPARE(bbc.ymax, 40.);
+    QCOMPARE(bbc.zmax, 60.);
+    QVERIFY(XCaf::shapeReferenceLocation(labelComp).Transformation().TranslationPart().IsEqual(gp_XYZ(10, 0, 0), Precision::Confusion()));
+
+    // Sub-shape label refers to the scaled face
+    QCOMPARE(XCaf::shapeSubs(labelProto).Length(), 1);
+    QVERIFY(shapeTool->IsSubShape(labelProto, XCaf::shape(labelFace)));
+
+    // Nothing more to apply
+    doc->applyDeferredScalings();
+    QCOMPARE(spyApplied.count(), 1);
+}
+
+void Test::DocumentDiff_test()
+{
+    // Assembly "Asm" made of the components named in 'listComponent', each one referring to its own box
+    struct Component { const char* name; double boxSizeZ; gp_Vec translation; };
+    auto app = Application::instance();
+    auto fnCreateDocument = [=](std::initializer_list<Component> listComponent) {
+        DocumentPtr doc = app->newDocument();
+        Handle_XCAFDoc_ShapeTool shapeTool = doc->xcaf().shapeTool();
+        const TDF_Label labelAsm = shapeTool->NewShape();
+        TDataStd_Name::Set(labelAsm, "Asm");
+        for (const Component& comp : listComponent) {
+            const TDF_Label labelProto = shapeTool->AddShape(BRepPrimAPI_MakeBox(10, 10, comp.boxSizeZ).Shape(), false);
+            TDataStd_Name::Set(labelProto, "Box");
+            gp_Trsf trsf;
+            trsf.SetTranslation(comp.translation);
+            const TDF_Label labelComp = shapeTool->AddComponent(labelAsm, labelProto, TopLoc_Location(trsf));
+            TDataStd_Name::Set(labelComp, comp.name);
+        }
+
+        shapeTool->UpdateAssemblies();
+        doc->addEntityTreeNode(labelAsm);
+        return doc;
+    };
+
+    const DocumentPtr docReference = fnCreateDocument({
+        { "A", 10, {} }, { "B", 10, {} }, { "C", 10, {} }, { "E", 10, {} }
+    });
+    const DocumentPtr docCompared = fnCreateDocument({
+        { "A", 10, {} }, { "B", 10, { 0, 0, 5 } }, { "C", 12, {} }, { "D", 10, {} }
+    });
+    auto _ = gsl::finally([=]{
+        app->closeDocument(docReference);
+        app->closeDocument(docCompared);
+    });
+
+    std::unordered_map<QString, DocumentDiff::Item> mapPathItem;
+    DocumentDiff::Options options;
+    options.batchSize = 2;
+    const DocumentDiff::Report report = DocumentDiff::compare(
+                docReference, docCompared, [&](Span<const DocumentDiff::Item> spanItem) {
+        for (const DocumentDiff::Item& item : spanItem)
+            mapPathItem.insert({ item.path, item });
+    }, options);
+    QVERIFY(report.hasDifferences());
+    QCOMPARE(report.unchangedCount, 1);
+    QCOMPARE(report.movedCount, 1);
+    QCOMPARE(report.modifiedCount, 1);
+    QCOMPARE(report.addedCount, 1);
+    QCOMPARE(report.removedCount, 1);
+    QCOMPARE(int(mapPathItem.size()), 5);
+    QCOMPARE(mapPathItem.at("Asm/A/Box").status, DocumentDiff::Status::Unchanged);
+    QCOMPARE(mapPathItem.at("Asm/B/Box").status, DocumentDiff::Status::Moved);
+    QVERIFY(std::abs(mapPathItem.at("Asm/B/Box").bndBoxDelta - 5) < 1e-3);
+    QCOMPARE(mapPathItem.at("Asm/C/Box").status, DocumentDiff::Status::Modified);
+    QVERIFY(std::abs(mapPathItem.at("Asm/C/Box").volumeDelta - 200) < 1e-3);
+    QCOMPARE(mapPathItem.at("Asm/D/Box").status, DocumentDiff::Status::Added);
+    QCOMPARE(mapPathItem.at("Asm/D/Box").nodeIdReference, TreeNodeId(0));
+    QCOMPARE(mapPathItem.at("Asm/E/Box").status, DocumentDiff::Status::Removed);
+    QCOMPARE(mapPathItem.at("Asm/E/Box").nodeIdCompared, TreeNodeId(0));
+}
+
+void Test::DocumentSearchIndex_test()
+{
+    {
+        const std::vector<QString> vecWord = DocumentSearchIndex::words("Screw_M6x20 (ISO-4762)");
+        const std::vector<QString> vecWordExpected = { "screw", "m6x20", "iso", "4762" };
+        QCOMPARE(vecWord, vecWordExpected);
+    }
+
+    // Assembly "Frame" made of two instances of product "Screw M6" and one of product "Plate"
+    auto app = Application::instance();
+    DocumentPtr doc = app->newDocument();
+    auto _ = gsl::finally([=]{ app->closeDocument(doc); });
+    Handle_XCAFDoc_ShapeTool shapeTool = doc->xcaf().shapeTool();
+    const TDF_Label labelAsm = shapeTool->NewShape();
+    TDataStd_Name::Set(labelAsm, "Frame");
+    const TDF_Label labelScrew = shapeTool->AddShape(BRepPrimAPI_MakeBox(1, 1, 5).Shape(), false);
+    TDataStd_Name::Set(labelScrew, "Screw M6");
+    const TDF_Label labelPlate = shapeTool->AddShape(BRepPrimAPI_MakeBox(10, 10, 1).Shape(), false);
+    TDataStd_Name::Set(labelPlate, "Plate");
+    TDataStd_Name::Set(shapeTool->AddComponent(labelAsm, labelScrew, TopLoc_Location()), "Screw left");
+    TDataStd_Name::Set(shapeTool->AddComponent(labelAsm, labelScrew, TopLoc_Location()), "Screw right");
+    TDataStd_Name::Set(shapeTool->AddComponent(labelAsm, labelPlate, TopLoc_Location()), "Base");
+    shapeTool->UpdateAssemblies();
+    doc->addEntityTreeNode(labelAsm);
+
+    // Product names match the component nodes
+    const Tree<TDF_Label>& modelTree = doc->modelTree();
+    auto fnFindLabels = [&](const QString& query) {
+        std::vector<TDF_Label> vecLabel;
+        for (TreeNodeId nodeId : doc->searchIndex().find(query))
+            vecLabel.push_back(modelTree.nodeData(nodeId));
+
+        return vecLabel;
+    };
+    QCOMPARE(int(fnFindLabels("scr").size()), 2);
+    QCOMPARE(int(fnFindLabels("m6").size()), 2);
+    QCOMPARE(int(fnFindLabels("screw RIG").size()), 1);
+    QCOMPARE(int(fnFindLabels("plate").size()), 1);
+    QVERIFY(XCaf::isShapeReference(fnFindLabels("plate").front()));
+    QCOMPARE(int(fnFindLabels("frame").size()), 1);
+    QCOMPARE(fnFindLabels("frame").front(), labelAsm);
+    QVERIFY(fnFindLabels("bolt").empty());
+    QVERIFY(fnFindLabels(" -- ").empty());
+
+    // Renamed labels are indexed again
+    TDataStd_Name::Set(labelPlate, "Bracket");
+    doc->labelAttributesCache().forget(labelPlate);
+    doc->searchIndex().invalidateLabel(labelPlate);
+    QVERIFY(fnFindLabels("plate").empty());
+    QCOMPARE(int(fnFindLabels("brack").size()), 1);
+
+    // Destroyed entities are no longer found
+    doc->destroyEntity(doc->entityTreeNodeId(0));
+    QVERIFY(fnFindLabels("screw").empty());
+}
+
+void Test::DocumentSnapshot_test()
+{
+    auto app = Application::instance();
+    DocumentPtr doc = app->newDocument();
+    auto _ = gsl::finally([=]{ app->closeDocument(doc); });
+    const int docCount = app->documentCount();
+
+    // Mesh entity
+    TColgp_Array1OfPnt nodes(1, 3);
+    nodes.SetValue(1, gp_Pnt(0, 0, 0));
+    nodes.SetValue(2, gp_Pnt(1, 0, 0));
+    nodes.SetValue(3, gp_Pnt(0, 1, 0));
+    Poly_Array1OfTriangle triangles(1, 1);
+    triangles.SetValue(1, Poly_Triangle(1, 2, 3));
+    const Handle_Poly_Triangulation mesh = new Poly_Triangulation(nodes, triangles);
+    const TDF_Label labelMesh = doc->newEntityLabel();
+    TDataXtd_Triangulation::Set(labelMesh, mesh);
+    TDataStd_Name::Set(labelMesh, "Mesh");
+    doc->addEntityTreeNode(labelMesh);
+
+    // Assembly "Frame" with a component "Base"
+    Handle_XCAFDoc_ShapeTool shapeTool = doc->xcaf().shapeTool();
+    const TDF_Label labelAsm = shapeTool->NewShape();
+    TDataStd_Name::Set(labelAsm, "Frame");
+    const TDF_Label labelPlate = shapeTool->AddShape(BRepPrimAPI_MakeBox(10, 10, 1).Shape(), false);
+    TDataStd_Name::Set(shapeTool->AddComponent(labelAsm, labelPlate, TopLoc_Location()), "Base");
+    shapeTool->UpdateAssemblies();
+    doc->addEntityTreeNode(labelAsm);
+
+    const TreeNodeId asmNodeId = doc->findEntityTreeNodeId(labelAsm);
+    const ApplicationItem items[] = {
+        ApplicationItem(DocumentTreeNode(doc, doc->findEntityTreeNodeId(labelMesh))),
+        ApplicationItem(DocumentTreeNode(doc, doc->modelTree().nodeChildFirst(asmNodeId)))
+    };
+    const DocumentSnapshotPtr snapshot = DocumentSnapshot::create(items);
+    QCOMPARE(app->documentCount(), docCount); // Snapshot documents aren't registered
+    QCOMPARE(int(snapshot->applicationItems().size()), 2);
+
+    // Source document is modified, snapshot isn't affected
+    while (doc->entityCount() > 0)
+        doc->destroyEntity(doc->entityTreeNodeId(0));
+
+    const ApplicationItem& itemMesh = snapshot->applicationItems()[0];
+    QVERIFY(itemMesh.isDocumentTreeNode());
+    QVERIFY(itemMesh.document() != doc);
+    auto attrTriangulation = CafUtils::findAttribute<TDataXtd_Triangulation>(itemMesh.documentTreeNode().label());
+    QVERIFY(!attrTriangulation.IsNull());
+    QVERIFY(attrTriangulation->Get() == mesh); // Shared, not copied
+    QCOMPARE(CafUtils::labelAttrStdName(itemMesh.documentTreeNode().label()), TCollection_ExtendedString("Mesh"));
+
+    const ApplicationItem& itemComponent = snapshot->applicationItems()[1];
+    if (snapshot->isIsolated()) {
+        QVERIFY(itemComponent.document() != doc);
+        const TDF_Label labelComponent = itemComponent.documentTreeNode().label();
+        QVERIFY(XCaf::isShapeReference(labelComponent));
+        QCOMPARE(CafUtils::labelAttrStdName(labelComponent), TCollection_ExtendedString("Base"));
+        QVERIFY(!XCaf::shape(labelComponent).IsNull());
+    }
+}
+
+void Test::MeshDecimation_test()
+{
+    // Regular grid of N*N nodes over square [0, N-1]^2, optionally with a bump along Z
+    constexpr int N = 60;
+    auto fnMakeGrid = [](bool withBump) {
+        const double pi = std::acos(-1.);
+        TColgp_Array1OfPnt nodes(1, N * N);
+        Poly_Array1OfTriangle triangles(1, 2 * (N - 1) * (N - 1));
+        for (int i = 0; i < N; ++i) {
+            for (int j = 0; j < N; ++j) {
+                const double z = withBump ? 5 * std::sin(i * pi / (N - 1)) * std::sin(j * pi / (N - 1)) : 0.;
+                nodes.SetValue(i * N + j + 1, gp_Pnt(i, j, z));
+            }
+        }
+
+        int iTriangle = 0;
+        for (int i = 0; i < N - 1; ++i) {
+            for (int j = 0; j < N - 1; ++j) {
+                const int n00 = i * N + j + 1;
+                const int n10 = n00 + N;
+                triangles.SetValue(++iTriangle, Poly_Triangle(n00, n10, n10 + 1));
+                triangles.SetValue(++iTriangle, Poly_Triangle(n00, n10 + 1, n00 + 1));
+            }
+        }
+
+        return Handle_Poly_Triangulation(new Poly_Triangulation(nodes, triangles));
+    };
+
+    const Handle_Poly_Triangulation meshFlat = fnMakeGrid(false);
+    const int inputCount = meshFlat->NbTriangles();
+    MeshDecimation::Options options;
+    options.targetRatio = 0.1;
+    MeshDecimation::Report report;
+    const Handle_Poly_Triangulation meshFlatDecimated = MeshDecimation::decimate(meshFlat, options, &report);
+    QVERIFY(!meshFlatDecimated.IsNull());
+    QCOMPARE(report.inputTriangleCount, inputCount);
+    QCOMPARE(report.outputTriangleCount, meshFlatDecimated->NbTriangles());
+    QVERIFY(meshFlatDecimated->NbTriangles() <= std::ceil(0.1 * inputCount));
+    // Planar and border kept: area must be preserved
+    QVERIFY(std::abs(MeshUtils::triangulationArea(meshFlatDecimated) - (N - 1) * (N - 1)) < 1e-6);
+
+    // Already under target count
+    options.targetTriangleCount = inputCount;
+    QVERIFY(MeshDecimation::decimate(meshFlat, options) == meshFlat);
+
+    // Error bound limits the decimation of curved areas
+    const Handle_Poly_Triangulation meshBump = fnMakeGrid(true);
+    options.targetTriangleCount = 100;
+    const int freeCount = MeshDecimation::decimate(meshBump, options)->NbTriangles();
+    options.maxError = 1e-3;
+    const int boundedCount = MeshDecimation::decimate(meshBump, options)->NbTriangles();
+    QVERIFY(boundedCount > freeCount);
+}
+
+void Test::MeshReorder_test()
+{
+    // Planar grid 40x40 of unit squares, triangles are shuffled
+    const int gridSize = 40;
+    auto fnNodeIndex = [=](int i, int j) { return j * (gridSize + 1) + i + 1; };
+    auto fnMakeGrid = [=]{
+        TColgp_Array1OfPnt nodes(1, (gridSize + 1) * (gridSize + 1));
+        for (int j = 0; j <= gridSize; ++j) {
+            for (int i = 0; i <= gridSize; ++i)
+                nodes.SetValue(fnNodeIndex(i, j), gp_Pnt(i, j, 0));
+        }
+
+        std::vector<Poly_Triangle> vecTriangle;
+        for (int j = 0; j < gridSize; ++j) {
+            for (int i = 0; i < gridSize; ++i) {
+                vecTriangle.emplace_back(fnNodeIndex(i, j), fnNodeIndex(i + 1, j), fnNodeIndex(i + 1, j + 1));
+                vecTriangle.emplace_back(fnNodeIndex(i, j), fnNodeIndex(i + 1, j + 1), fnNodeIndex(i, j + 1));
+            }
+        }
+
+        std::shuffle(vecTriangle.begin(), vecTriangle.end(), std::mt19937(42));
+        Poly_Array1OfTriangle triangles(1, int(vecTriangle.size()));
+        for (int i = 0; i < int(vecTriangle.size()); ++i)
+            triangles.SetValue(i + 1, vecTriangle.at(i));
+
+        return Handle_Poly_Triangulation(new Poly_Triangulation(nodes, triangles));
+    };
+    auto fnNodeSum = [](const Handle_Poly_Triangulation& mesh) {
+        gp_XYZ sum;
+        for (int i = 1; i <= mesh->NbNodes(); ++i)
+            sum += mesh->Node(i).XYZ();
+
+        return sum;
+    };
+
+    {
+        const Handle_Poly_Triangulation mesh = fnMakeGrid();
+        const double acmrBefore = MeshReorder::averageCacheMissRatio(mesh);
+        const gp_XYZ nodeSumBefore = fnNodeSum(mesh);
+        MeshReorder::reorder(mesh, {});
+        QCOMPARE(mesh->NbNodes(), (gridSize + 1) * (gridSize + 1));
+        QCOMPARE(mesh->NbTriangles(), 2 * gridSize * gridSize);
+        QVERIFY(fnNodeSum(mesh).IsEqual(nodeSumBefore, 1e-6));
+        QVERIFY(std::abs(MeshUtils::triangulationArea(mesh) - gridSize * gridSize) < 1e-6);
+        // All triangles still oriented towards +Z
+        for (int i = 1; i <= mesh->NbTriangles(); ++i) {
+            int n1, n2, n3;
+            mesh->Triangle(i).Get(n1, n2, n3);
+            const gp_Vec vec12(mesh->Node(n1), mesh->Node(n2));
+            const gp_Vec vec13(mesh->Node(n1), mesh->Node(n3));
+            QVERIFY(vec12.Crossed(vec13).Z() > 0);
+        }
+
+        const double acmrAfter = MeshReorder::averageCacheMissRatio(mesh);
+        qInfo() << "ACMR before:" << acmrBefore << "after:" << acmrAfter;
+        QVERIFY(acmrAfter < acmrBefore);
+        QVERIFY(acmrAfter < 1.);
+    }
+
+    {
+        // Node indices are kept
+        const Handle_Poly_Triangulation mesh = fnMakeGrid();
+        MeshReorder::Options options;
+        options.renumberNodes = false;
+        MeshReorder::reorder(mesh, options);
+        for (int j = 0; j <= gridSize; ++j) {
+            for (int i = 0; i <= gridSize; ++i)
+                QVERIFY(mesh->Node(fnNodeIndex(i, j)).IsEqual(gp_Pnt(i, j, 0), Precision::Confusion()));
+        }
+
+        QVERIFY(std::abs(MeshUtils::triangulationArea(mesh) - gridSize * gridSize) < 1e-6);
+    }
+}
+
+void Test::MeshRepair_test()
+{
+    // Triangle soup of a cube 10x10x10: each triangle has its own nodes
+    // Corner i is at (x, y, z) = 10 * (bit0, bit1, bit2) of i, triangles are oriented outwards
+    const int cubeTriangles[12][3] = {
+        { 0, 2, 3 }, { 0, 3, 1 }, { 4, 5, 7 }, { 4, 7, 6 }, { 0, 1, 5 }, { 0, 5, 4 },
+        { 2, 6, 7 }, { 2, 7, 3 }, { 0, 4, 6 }, { 0, 6, 2 }, { 1, 3, 7 }, { 1, 7, 5 }
+    };
+    auto fnCorner = [](int i) { return gp_Pnt(10 * (i & 1), 10 * ((i >> 1) & 1), 10 * ((i >> 2) & 1)); };
+    auto fnMakeSoup = [=](bool reversed) {
+        // One more triangle which is degenerate(two identical nodes)
+        TColgp_Array1OfPnt nodes(1, 3 * 13);
+        Poly_Array1OfTriangle triangles(1, 13);
+        for (int i = 0; i < 12; ++i) {
+            const bool isFlipped = reversed || i == 4; // Triangle #4 badly oriented
+            for (int j = 0; j < 3; ++j)
+                nodes.SetValue(3 * i + j + 1, fnCorner(cubeTriangles[i][j]));
+
+            const int n1 = 3 * i + 1;
+            triangles.SetValue(i + 1, isFlipped ? Poly_Triangle(n1, n1 + 2, n1 + 1) : Poly_Triangle(n1, n1 + 1, n1 + 2));
+        }
+
+        nodes.SetValue(37, fnCorner(0));
+        nodes.SetValue(38, fnCorner(0));
+        nodes.SetValue(39, fnCorner(7));
+        triangles.SetValue(13, Poly_Triangle(37, 38, 39));
+        return Handle_Poly_Triangulation(new Poly_Triangulation(nodes, triangles));
+    };
+
+    {
+        const Handle_Poly_Triangulation mesh = fnMakeSoup(false);
+        MeshRepair::Report report;
+        const Handle_Poly_Triangulation meshRepaired = MeshRepair::repair(mesh, {}, &report);
+        QVERIFY(!meshRepaired.IsNull());
+        QVERIFY(meshRepaired != mesh);
+        QCOMPARE(meshRepaired->NbNodes(), 8);
+        QCOMPARE(meshRepaired->NbTriangles(), 12);
+        QCOMPARE(report.removedNodeCount, 39 - 8);
+        QCOMPARE(report.removedTriangleCount, 1);
+        QCOMPARE(report.flippedTriangleCount, 1);
+        QVERIFY(report.savedBytes() > 0);
+        QVERIFY(std::abs(MeshUtils::triangulationVolume(meshRepaired) - 1000.) < 1e-6);
+        QVERIFY(std::abs(MeshUtils::triangulationArea(meshRepaired) - 600.) < 1e-6);
+
+        // Already repaired, input is returned as is
+        QVERIFY(MeshRepair::repair(meshRepaired, {}, &report) == meshRepaired);
+        QVERIFY(!report.isModified());
+    }
+
+    {
+        // Closed mesh oriented inwards
+        const Handle_Poly_Triangulation meshRepaired = MeshRepair::repair(fnMakeSoup(true), {});
+        QCOMPARE(meshRepaired->NbTriangles(), 12);
+        QVERIFY(std::abs(MeshUtils::triangulationVolume(meshRepaired) - 1000.) < 1e-6);
+    }
+
+    {
+        // Welding only
+        MeshRepair::Options options;
+        options.removeDegenerateTriangles = false;
+        options.unifyOrientation = false;
+        MeshRepair::Report report;
+        const Handle_Poly_Triangulation meshRepaired = MeshRepair::repair(fnMakeSoup(false), options, &report);
+        QCOMPARE(meshRepaired->NbNodes(), 8);
+        QCOMPARE(meshRepaired->NbTriangles(), 13);
+        QCOMPARE(report.flippedTriangleCount, 0);
+    }
+}
+
+void Test::ShapeHealing_test()
+{
+    {
+        ShapeHealing::Report report;
+        QVERIFY(ShapeHealing::heal(TopoDS_Shape(), {}, &report).IsNull());
+        QVERIFY(!report.isModified());
+    }
+
+    {
+        // Valid shape, topology is kept
+        const TopoDS_Shape shapeBox = BRepPrimAPI_MakeBox(10, 20, 30);
+        ShapeHealing::Report report;
+        const TopoDS_Shape shapeHealed = ShapeHealing::heal(shapeBox, {}, &report);
+        QVERIFY(!shapeHealed.IsNull());
+        int solidCount = 0;
+        int faceCount = 0;
+        BRepUtils::forEachSubShape(shapeHealed, TopAbs_SOLID, [&](const TopoDS_Shape&) { ++solidCount; });
+        BRepUtils::forEachSubFace(shapeHealed, [&](const TopoDS_Face&) { ++faceCount; });
+        QCOMPARE(solidCount, 1);
+        QCOMPARE(faceCount, 6);
+    }
+}
+
 void Test::MeshUtils_orientation_test()
 {
     struct BasicPolyline2d : public Mayo::MeshUtils::AdaptorPolyline2d {
@@ -373,6 +1844,8 @@ void Test::MeshUtils_orientation_test()
     BasicPolyline2d polyline2d;
     polyline2d.vecPoint = std::move(vecPoint);
     QCOMPARE(Mayo::MeshUtils::orientation(polyline2d), orientation);
+    const Span<const gp_Pnt2d> spanPoint(polyline2d.vecPoint.data(), polyline2d.vecPoint.size());
+    QCOMPARE(Mayo::MeshUtils::orientation(spanPoint), orientation);
 }
 
 void Test::MeshUtils_orientation_test_data()
@@ -451,6 +1924,220 @@ void Test::MetaEnum_test()
     QCOMPARE(MetaEnum::nameWithoutPrefix(TopAbs_VERTEX, ""), "TopAbs_VERTEX");
 }
 
+void Test::PointCloud_test()
+{
+    // Points on a regular grid, coordinates in [0,99]
+    std::vector<PointCloud::Point> vecPoint;
+    for (int i = 0; i < 100; ++i) {
+        for (int j = 0; j < 100; ++j) {
+            for (int k = 0; k < 10; ++k)
+                vecPoint.emplace_back(float(i), float(j), float(k * 11));
+        }
+    }
+
+    PointCloud::BuildParameters params;
+    params.maxLeafPointCount = 1000;
+    const PointCloudPtr pointCloud = PointCloud::build(std::move(vecPoint), params);
+    QVERIFY(!pointCloud.IsNull());
+    QCOMPARE(pointCloud->pointCount(), uint64_t(100 * 100 * 10));
+    QCOMPARE(pointCloud->rootNode().pointCount, pointCloud->pointCount());
+    QVERIFY(pointCloud->nodes().size() > 1);
+
+    // Children partition parent points, and points lie inside their node
+    for (const PointCloud::Node& node : pointCloud->nodes()) {
+        for (const PointCloud::Point& pnt : pointCloud->nodePoints(node)) {
+            for (int axis = 0; axis < 3; ++axis) {
+                QVERIFY(node.minCorner[axis] <= pnt[axis]);
+                QVERIFY(pnt[axis] <= node.maxCorner[axis]);
+            }
+        }
+
+        if (node.isLeaf()) {
+            QVERIFY(node.pointCount <= params.maxLeafPointCount);
+            continue;
+        }
+
+        uint64_t nextChildFirstPoint = node.firstPoint;
+        for (int32_t iChild : node.children) {
+            if (iChild >= 0) {
+                const PointCloud::Node& child = pointCloud->nodes()[iChild];
+                QCOMPARE(child.depth, node.depth + 1);
+                QCOMPARE(child.firstPoint, nextChildFirstPoint);
+                nextChildFirstPoint += child.pointCount;
+            }
+        }
+
+        QCOMPARE(nextChildFirstPoint, node.firstPoint + node.pointCount);
+    }
+}
+
+void Test::MeshSection_test()
+{
+    // Closed cube [0,10]^3 made of 12 triangles
+    TColgp_Array1OfPnt nodes(1, 8);
+    for (int i = 0; i < 8; ++i)
+        nodes.SetValue(i + 1, gp_Pnt((i & 1) * 10., ((i >> 1) & 1) * 10., ((i >> 2) & 1) * 10.));
+
+    const int quads[6][4] = {
+        { 1, 3, 4, 2 }, { 5, 6, 8, 7 }, { 1, 2, 6, 5 }, { 3, 7, 8, 4 }, { 1, 5, 7, 3 }, { 2, 4, 8, 6 }
+    };
+    Poly_Array1OfTriangle triangles(1, 12);
+    for (int i = 0; i < 6; ++i) {
+        triangles.SetValue(2 * i + 1, Poly_Triangle(quads[i][0], quads[i][1], quads[i][2]));
+        triangles.SetValue(2 * i + 2, Poly_Triangle(quads[i][0], quads[i][2], quads[i][3]));
+    }
+
+    DocumentBvh::Mesh mesh;
+    mesh.triangulation = new Poly_Triangulation(nodes, triangles);
+    std::vector<Bvh::Box> vecTriangleBox(12);
+    for (int i = 0; i < 12; ++i) {
+        int n1, n2, n3;
+        triangles.Value(i + 1).Get(n1, n2, n3);
+        vecTriangleBox.at(i).add(nodes.Value(n1));
+        vecTriangleBox.at(i).add(nodes.Value(n2));
+        vecTriangleBox.at(i).add(nodes.Value(n3));
+    }
+
+    mesh.bvh = Bvh::build(vecTriangleBox);
+
+    // Mid plane gives a single closed square
+    {
+        const auto vecPolyline = MeshSection::compute(mesh, gp_Pln(gp_Pnt(0, 0, 5), gp::DZ()));
+        QCOMPARE(vecPolyline.size(), size_t(1));
+        const MeshSection::Polyline& polyline = vecPolyline.front();
+        QVERIFY(polyline.isClosed);
+        QVERIFY(std::all_of(polyline.points.cbegin(), polyline.points.cend(), [](const gp_Pnt& pnt) {
+            return std::abs(pnt.Z() - 5.) < Precision::Confusion();
+        }));
+        QVERIFY(std::abs(MeshSection::length(polyline) - 40.) < Precision::Confusion());
+
+        int wireCount = 0;
+        for (TopExp_Explorer expl(MeshSection::toShape(vecPolyline), TopAbs_WIRE); expl.More(); expl.Next())
+            ++wireCount;
+
+        QCOMPARE(wireCount, 1);
+    }
+
+    // Oblique plane through cube nodes, nodes on the plane must not break the section
+    {
+        const auto vecPolyline = MeshSection::compute(mesh, gp_Pln(gp_Pnt(10, 0, 0), gp_Dir(1, 1, 0)));
+        QCOMPARE(vecPolyline.size(), size_t(1));
+        QVERIFY(vecPolyline.front().isClosed);
+    }
+
+    // Plane missing the cube
+    QVERIFY(MeshSection::compute(mesh, gp_Pln(gp_Pnt(0, 0, 20), gp::DZ())).empty());
+}
+
+void Test::ModelCache_test()
+{
+    const FilePath dirPath = std::filesystem::temp_directory_path() / "mayo_model_cache";
+    ModelCache cache(dirPath);
+    cache.clear();
+
+    // Key depends on file contents and parameters, not on file location
+    const FilePath filepath1 = std::filesystem::temp_directory_path() / "mayo_model_cache_1.txt";
+    const FilePath filepath2 = std::filesystem::temp_directory_path() / "mayo_model_cache_2.txt";
+    for (const FilePath& fp : { filepath1, filepath2 }) {
+        QFile file(filepathTo<QString>(fp));
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("solid model");
+    }
+
+    const QByteArray key = ModelCache::key(filepath1, "params");
+    QVERIFY(!key.isEmpty());
+    QCOMPARE(ModelCache::key(filepath2, "params"), key);
+    QVERIFY(ModelCache::key(filepath1, "other_params") != key);
+    QVERIFY(ModelCache::key(dirPath / "no_file.txt", "params").isEmpty());
+    QVERIFY(!cache.contains(key));
+
+    auto app = Application::instance();
+    DocumentPtr doc = app->newDocument();
+    auto _ = gsl::finally([=]{ app->closeDocument(doc); });
+    const TDF_Label labelBox = doc->xcaf().shapeTool()->NewShape();
+    doc->xcaf().shapeTool()->SetShape(labelBox, BRepPrimAPI_MakeBox(10, 20, 30).Shape());
+    TDataStd_Name::Set(labelBox, "Box");
+    doc->addEntityTreeNode(labelBox);
+
+    QVERIFY(cache.save(app, doc, key));
+    QVERIFY(cache.contains(key));
+    // Entry already exists(ex: written by another process), kept as is
+    QVERIFY(cache.save(app, doc, key));
+    // No temporary file left
+    QCOMPARE(QDir(filepathTo<QString>(dirPath)).entryList(QDir::Files).size(), 1);
+
+    DocumentPtr docCached = cache.open(app, key);
+    QVERIFY(!docCached.IsNull());
+    QCOMPARE(docCached->entityCount(), 1);
+    const TDF_Label labelCachedBox = docCached->entityLabel(0);
+    QCOMPARE(CafUtils::labelAttrStdName(labelCachedBox), TCollection_ExtendedString("Box"));
+    Bnd_Box bndBox;
+    BRepBndLib::Add(XCaf::shape(labelCachedBox), bndBox);
+    QCOMPARE(BndBoxCoords::get(bndBox).zmax, 30.);
+    app->closeDocument(docCached);
+
+    QVERIFY(cache.open(app, ModelCache::key(filepath1, "other_params")).IsNull());
+    cache.clear();
+    QVERIFY(!cache.contains(key));
+}
+
+void Test::ShapePager_test()
+{
+    const FilePath dirPath = std::filesystem::temp_directory_path() / "mayo_shape_pager";
+    ShapePager pager(dirPath);
+    pager.clear();
+
+    auto app = Application::instance();
+    DocumentPtr doc = app->newDocument();
+    auto _ = gsl::finally([=]{ app->closeDocument(doc); });
+    Handle_XCAFDoc_ShapeTool shapeTool = doc->xcaf().shapeTool();
+    const TopoDS_Shape shapeBox = BRepPrimAPI_MakeBox(10, 20, 30).Shape();
+    BRepMesh_IncrementalMesh(shapeBox, 0.1);
+    const TDF_Label labelProto = shapeTool->AddShape(shapeBox, false);
+    const TopoDS_Shape face = TopExp_Explorer(shapeBox, TopAbs_FACE).Current();
+    const TDF_Label labelFace = shapeTool->AddSubShape(labelProto, face);
+    const TDF_Label labelAsm = shapeTool->NewShape();
+    gp_Trsf trsf;
+    trsf.SetTranslation(gp_Vec(5, 0, 0));
+    shapeTool->AddComponent(labelAsm, labelProto, TopLoc_Location(trsf));
+    shapeTool->UpdateAssemblies();
+    doc->addEntityTreeNode(labelAsm);
+    const TreeNodeId entityTreeNodeId = doc->entityTreeNodeId(0);
+
+    // Prototype and sub-shape are replaced by placeholders
+    QSignalSpy spyUnloaded(doc.get(), &Document::shapesUnloaded);
+    QCOMPARE(pager.pageOut(doc, entityTreeNodeId), 1);
+    QCOMPARE(spyUnloaded.count(), 1);
+    QVERIFY(doc->isShapeDeferred(labelProto));
+    QVERIFY(!TopoDS_Iterator(XCaf::shape(labelProto)).More());
+    QVERIFY(!TopoDS_Iterator(XCaf::shape(labelFace)).More());
+    QCOMPARE(QDir(filepathTo<QString>(dirPath)).entryList(QDir::Files).size(), 1);
+    // Already paged out
+    QCOMPARE(pager.pageOut(doc, entityTreeNodeId), 0);
+
+    // Restored along with the triangulations and the sub-shape label, page file is consumed
+    doc->loadDeferredShapes(entityTreeNodeId);
+    QVERIFY(!doc->isShapeDeferred(labelProto));
+    QCOMPARE(QDir(filepathTo<QString>(dirPath)).entryList(QDir::Files).size(), 0);
+    Bnd_Box bndBox;
+    BRepBndLib::AddOptimal(XCaf::shape(labelAsm), bndBox, false, false);
+    QCOMPARE(BndBoxCoords::get(bndBox).xmax, 15.);
+    QCOMPARE(BndBoxCoords::get(bndBox).zmax, 30.);
+    QCOMPARE(XCaf::shapeSubs(labelProto).Length(), 1);
+    QVERIFY(shapeTool->IsSubShape(labelProto, XCaf::shape(labelFace)));
+    TopLoc_Location locFace;
+    QVERIFY(!BRep_Tool::Triangulation(TopoDS::Face(XCaf::shape(labelFace)), locFace).IsNull());
+
+    // Prototype instantiated by another entity stays resident
+    const TDF_Label labelAsm2 = shapeTool->NewShape();
+    shapeTool->AddComponent(labelAsm2, labelProto, TopLoc_Location());
+    shapeTool->UpdateAssemblies();
+    doc->addEntityTreeNode(labelAsm2);
+    QCOMPARE(pager.pageOut(doc, entityTreeNodeId), 0);
+    QVERIFY(!doc->isShapeDeferred(labelProto));
+    pager.clear();
+}
+
 void Test::MeshUtils_test()
 {
     // Create box
@@ -508,6 +2195,13 @@ void Test::MeshUtils_test()
              double(boxDx * boxDy * boxDz));
     QCOMPARE(MeshUtils::triangulationArea(polyTriBox),
              double(2 * boxDx * boxDy + 2 * boxDy * boxDz + 2 * boxDx * boxDz));
+
+    const MeshUtils::MassProperties massProps = MeshUtils::triangulationMassProperties(polyTriBox);
+    const double boxVolume = boxDx * boxDy * boxDz;
+    QVERIFY(massProps.centroid.IsEqual(gp_Pnt(boxDx / 2., boxDy / 2., boxDz / 2.), Precision::Confusion()));
+    QCOMPARE(massProps.inertia.Value(1, 1), boxVolume * (boxDy * boxDy + boxDz * boxDz) / 12.);
+    QCOMPARE(massProps.inertia.Value(2, 2), boxVolume * (boxDz * boxDz + boxDx * boxDx) / 12.);
+    QCOMPARE(massProps.inertia.Value(3, 3), boxVolume * (boxDx * boxDx + boxDy * boxDy) / 12.);
 }
 
 void Test::MeshUtils_test_data()
@@ -522,6 +2216,78 @@ void Test::MeshUtils_test_data()
     QTest::newRow("case4") << 40. << 50. << 70.;
 }
 
+void Test::MeshUtils_normals_test()
+{
+    // Corner of a tetrahedron, plus a degenerate triangle and an unused node
+    TColgp_Array1OfPnt nodes(1, 5);
+    nodes.SetValue(1, gp_Pnt(0, 0, 0));
+    nodes.SetValue(2, gp_Pnt(1, 0, 0));
+    nodes.SetValue(3, gp_Pnt(0, 1, 0));
+    nodes.SetValue(4, gp_Pnt(0, 0, 2));
+    nodes.SetValue(5, gp_Pnt(5, 5, 5));
+    Poly_Array1OfTriangle triangles(1, 3);
+    triangles.SetValue(1, Poly_Triangle(1, 2, 3)); // Area 0.5, normal +Z
+    triangles.SetValue(2, Poly_Triangle(1, 4, 2)); // Area 1, normal +Y
+    triangles.SetValue(3, Poly_Triangle(1, 2, 2));
+    const Handle_Poly_Triangulation mesh = new Poly_Triangulation(nodes, triangles);
+
+    const MeshUtils::TriangulationNormals normals = MeshUtils::triangulationNormals(mesh);
+    QCOMPARE(normals.triangles.count(), 3);
+    QCOMPARE(normals.nodes.count(), 5);
+    auto fnNormal = [](const MeshUtils::NormalArray& array, int i) {
+        return gp_Vec(array.x.at(i), array.y.at(i), array.z.at(i));
+    };
+    constexpr double tol = 1e-6;
+    QVERIFY(fnNormal(normals.triangles, 0).IsEqual(gp_Vec(0, 0, 1), tol, tol));
+    QVERIFY(fnNormal(normals.triangles, 1).IsEqual(gp_Vec(0, 1, 0), tol, tol));
+    QVERIFY(fnNormal(normals.triangles, 2).Magnitude() == 0.);
+
+    // Node 1 is shared by both triangles, the biggest one weighs twice as much
+    QVERIFY(fnNormal(normals.nodes, 0).IsEqual(gp_Vec(0, 2, 1).Normalized(), tol, tol));
+    QVERIFY(fnNormal(normals.nodes, 2).IsEqual(gp_Vec(0, 0, 1), tol, tol));
+    QVERIFY(fnNormal(normals.nodes, 3).IsEqual(gp_Vec(0, 1, 0), tol, tol));
+    QVERIFY(fnNormal(normals.nodes, 4).Magnitude() == 0.);
+
+    // Normals are computed once per triangulation
+    const auto cachedNormals = MeshUtils::cachedTriangulationNormals(mesh);
+    QVERIFY(cachedNormals);
+    QCOMPARE(MeshUtils::cachedTriangulationNormals(mesh).get(), cachedNormals.get());
+    QVERIFY(fnNormal(cachedNormals->nodes, 0).IsEqual(fnNormal(normals.nodes, 0), tol, tol));
+}
+
+void Test::MeshUtils_edges_test()
+{
+    // Two triangles sharing edge(2, 3), the second one is tilted
+    TColgp_Array1OfPnt nodes(1, 4);
+    nodes.SetValue(1, gp_Pnt(0, 0, 0));
+    nodes.SetValue(2, gp_Pnt(1, 0, 0));
+    nodes.SetValue(3, gp_Pnt(0, 1, 0));
+    nodes.SetValue(4, gp_Pnt(1, 1, 1));
+    Poly_Array1OfTriangle triangles(1, 2);
+    triangles.SetValue(1, Poly_Triangle(1, 2, 3));
+    triangles.SetValue(2, Poly_Triangle(3, 2, 4));
+    const Handle_Poly_Triangulation mesh = new Poly_Triangulation(nodes, triangles);
+
+    // Shared edges appear once, node indices are sorted
+    const MeshUtils::TriangulationEdges edges = MeshUtils::triangulationEdges(mesh);
+    QCOMPARE(edges.nodes, std::vector<int>({ 1, 2,  1, 3,  2, 3,  2, 4,  3, 4 }));
+    QCOMPARE(edges.count(), 5);
+
+    // Dihedral angle between the two triangles is 54.7 degrees
+    const double angle30deg = UnitSystem::radians(30 * Quantity_Degree);
+    const double angle60deg = UnitSystem::radians(60 * Quantity_Degree);
+    const MeshUtils::TriangulationEdges sharpEdges = MeshUtils::triangulationEdges(mesh, angle30deg);
+    QCOMPARE(sharpEdges.count(), 5);
+    const MeshUtils::TriangulationEdges freeEdges = MeshUtils::triangulationEdges(mesh, angle60deg);
+    QCOMPARE(freeEdges.nodes, std::vector<int>({ 1, 2,  1, 3,  2, 4,  3, 4 }));
+
+    // Edges are computed once per triangulation and feature angle
+    const auto cachedEdges = MeshUtils::cachedTriangulationEdges(mesh);
+    QVERIFY(cachedEdges);
+    QCOMPARE(MeshUtils::cachedTriangulationEdges(mesh).get(), cachedEdges.get());
+    QVERIFY(MeshUtils::cachedTriangulationEdges(mesh, angle60deg).get() != cachedEdges.get());
+}
+
 void Test::Quantity_test()
 {
     const QuantityArea area = (10 * Quantity_Millimeter) * (5 * Quantity_Centimeter);
@@ -609,6 +2375,20 @@ void Test::StringConv_test()
     QCOMPARE(to_QString(string_conv<Handle(TCollection_HAsciiString)>(text)), text);
     QCOMPARE(to_QString(to_stdString(text)), text);
     QCOMPARE(to_QString(to_OccExtString(text)), text);
+
+    // Conversions into existing buffers
+    const TCollection_ExtendedString extText = to_OccExtString(text);
+    QString qtBuffer = "some preceding content, longer than 'text'";
+    string_conv(extText, &qtBuffer);
+    QCOMPARE(qtBuffer, text);
+    std::string stdBuffer;
+    string_conv(extText, &stdBuffer);
+    QCOMPARE(stdBuffer, to_stdString(text));
+    string_conv(TCollection_AsciiString("ascii"), &stdBuffer);
+    QCOMPARE(stdBuffer, std::string("ascii"));
+    // Converter without assign() function
+    string_conv(text, &stdBuffer);
+    QCOMPARE(stdBuffer, to_stdString(text));
 }
 
 void Test::TKernelUtils_colorToHex_test()
@@ -695,6 +2475,58 @@ void Test::UnitSystem_test_data()
             << UnitSystem::TranslateResult{ 180., "°", radDeg };
 }
 
+void Test::UnitSystem_bulkTranslate_test()
+{
+    const UnitSystem::Conversion convInch = UnitSystem::conversion(UnitSystem::ImperialUK, Unit::Length);
+    QCOMPARE(convInch.strUnit, "in");
+    QCOMPARE(convInch.factor, 25.4);
+    std::vector<double> vecValue = { 0., 25.4, 50.8, -254. };
+    UnitSystem::translate(convInch, vecValue);
+    QCOMPARE(vecValue.at(0), 0.);
+    QCOMPARE(vecValue.at(1), 1.);
+    QCOMPARE(vecValue.at(2), 2.);
+    QCOMPARE(vecValue.at(3), -10.);
+
+    const UnitSystem::Conversion convSquareInch = UnitSystem::conversion(UnitSystem::ImperialUK, Unit::Area);
+    QCOMPARE(convSquareInch.factor, 645.16);
+    const double areas[] = { 645.16, 1290.32 };
+    std::vector<double> vecArea(std::size(areas));
+    UnitSystem::translate(convSquareInch, areas, vecArea);
+    for (size_t i = 0; i < vecArea.size(); ++i)
+        QCOMPARE(vecArea.at(i), UnitSystem::translate(UnitSystem::ImperialUK, areas[i], Unit::Area).value);
+
+    const UnitSystem::Conversion convMillimeter = UnitSystem::conversion(UnitSystem::SI, Unit::Length);
+    QCOMPARE(convMillimeter.strUnit, "mm");
+    std::vector<double> vecMm = { 1.5, 2.5 };
+    UnitSystem::translate(convMillimeter, vecMm);
+    QCOMPARE(vecMm, std::vector<double>({ 1.5, 2.5 }));
+}
+
+void Test::MessageBatchQueue_test()
+{
+    using MessageType = Messenger::MessageType;
+    MessageBatchQueue queue(2);
+    QVERIFY(queue.push(MessageType::Warning, "warning_1"));
+    QVERIFY(!queue.push(MessageType::Warning, "warning_1"));
+    QVERIFY(!queue.push(MessageType::Warning, "warning_2"));
+    QVERIFY(!queue.push(MessageType::Warning, "warning_3"));
+    QVERIFY(!queue.push(MessageType::Warning, "warning_4"));
+    QVERIFY(!queue.push(MessageType::Error, "error_1"));
+
+    const MessageBatchQueue::Batch batch = queue.takeBatch();
+    QCOMPARE(int(batch.items.size()), 3);
+    QCOMPARE(batch.items.at(0).message.text, QString("warning_1"));
+    QCOMPARE(batch.items.at(0).repeatCount, 2);
+    QCOMPARE(batch.items.at(1).message.text, QString("warning_2"));
+    QCOMPARE(batch.items.at(2).message.type, MessageType::Error);
+    QCOMPARE(batch.discardedCount[int(MessageType::Warning)], 2);
+    QCOMPARE(batch.discardedCount[int(MessageType::Error)], 0);
+
+    // New batch after takeBatch()
+    QVERIFY(queue.takeBatch().isEmpty());
+    QVERIFY(queue.push(MessageType::Warning, "warning_1"));
+}
+
 void Test::LibTask_test()
 {
     struct ProgressRecord {
@@ -742,6 +2574,375 @@ void Test::LibTask_test()
     QCOMPARE(vecProgressRec.back().value, 100);
 }
 
+void Test::LibTask_completion_test()
+{
+    TaskManager taskMgr;
+    taskMgr.setMaxConcurrency(2);
+    QCOMPARE(taskMgr.maxConcurrency(), 2);
+
+    std::atomic<int> continuationCount = 0;
+    std::vector<TaskId> vecTaskId;
+    for (int i = 0; i < 5; ++i) {
+        const TaskId taskId = taskMgr.newTask([=](TaskProgress*) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10 * i));
+        });
+        taskMgr.whenDone(taskId, [&]{ ++continuationCount; });
+        vecTaskId.push_back(taskId);
+    }
+
+    for (const TaskId taskId : vecTaskId)
+        taskMgr.run(taskId, TaskAutoDestroy::Off);
+
+    std::vector<TaskId> vecPendingTaskId = vecTaskId;
+    while (!vecPendingTaskId.empty()) {
+        const int index = taskMgr.waitForAny(vecPendingTaskId, 5000);
+        QVERIFY(index >= 0);
+        QCOMPARE(taskMgr.progress(vecPendingTaskId.at(index)), 100);
+        vecPendingTaskId.erase(vecPendingTaskId.begin() + index);
+    }
+
+    QVERIFY(taskMgr.waitForAll(vecTaskId, 5000));
+    for (const TaskId taskId : vecTaskId)
+        taskMgr.waitForDone(taskId);
+
+    QCOMPARE(continuationCount.load(), 5);
+    QCOMPARE(taskMgr.pendingTaskCount(), 0);
+
+    // Continuation registered on an already finished task is called immediately
+    bool continuationCalled = false;
+    taskMgr.whenDone(vecTaskId.front(), [&]{ continuationCalled = true; });
+    QVERIFY(continuationCalled);
+}
+
+void Test::LibTask_concurrentAccess_test()
+{
+    // Tasks created and destroyed by one thread while another one waits for other tasks
+    TaskManager taskMgr;
+    const TaskId waitedTaskId = taskMgr.newTask([](TaskProgress*) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    });
+    taskMgr.run(waitedTaskId, TaskAutoDestroy::Off);
+    std::thread threadCreate([&]{
+        for (int i = 0; i < 1000; ++i) {
+            const TaskId taskId = taskMgr.newTask([](TaskProgress*) {});
+            taskMgr.run(taskId); // Also destroys the finished tasks
+        }
+    });
+
+    const TaskId ids[] = { waitedTaskId };
+    while (!taskMgr.waitForAll(ids, 1))
+        taskMgr.foreachTask([&](TaskId id) { taskMgr.progress(id); });
+
+    threadCreate.join();
+    QCOMPARE(taskMgr.waitForAny(ids), 0);
+}
+
+void Test::LibTask_runConcurrently_test()
+{
+    // Nested calls from the tasks of another task manager, all sub-tasks are executed by a bounded
+    // count of threads(callers and shared worker pool)
+    TaskManager taskMgr;
+    taskMgr.setMaxConcurrency(4);
+    std::atomic<int> executedCount = 0;
+    std::atomic<int> completedCount = 0;
+    std::mutex mutexThreadId;
+    std::set<std::thread::id> setThreadId;
+    std::vector<TaskId> vecTaskId;
+    for (int i = 0; i < 4; ++i) {
+        vecTaskId.push_back(taskMgr.newTask([&](TaskProgress* progress) {
+            const bool ok = TaskManager::runConcurrently(50, progress, [&](int, TaskProgress* subProgress) {
+                TaskManager::runConcurrently(10, subProgress, [&](int, TaskProgress*) {
+                    ++executedCount;
+                    std::lock_guard<std::mutex> lock(mutexThreadId);
+                    setThreadId.insert(std::this_thread::get_id());
+                });
+            });
+            if (ok && progress->value() == 100)
+                ++completedCount;
+        }));
+    }
+
+    for (const TaskId taskId : vecTaskId)
+        taskMgr.run(taskId, TaskAutoDestroy::Off);
+
+    QVERIFY(taskMgr.waitForAll(vecTaskId, 30000));
+    QCOMPARE(executedCount.load(), 4 * 50 * 10);
+    QCOMPARE(completedCount.load(), 4);
+    const int maxThreadCount = 4 + std::max(1, int(std::thread::hardware_concurrency()));
+    QVERIFY(int(setThreadId.size()) <= maxThreadCount);
+}
+
+void Test::LibTask_dependency_test()
+{
+    TaskManager taskMgr;
+    taskMgr.setMaxConcurrency(2);
+
+    // Task started only once all its dependencies are finished
+    std::atomic<int> finishedCount = 0;
+    std::atomic<int> finishedCountAtJoin = -1;
+    std::vector<TaskId> vecTaskId;
+    for (int i = 0; i < 3; ++i) {
+        vecTaskId.push_back(taskMgr.newTask([=, &finishedCount](TaskProgress*) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10 * (i + 1)));
+            ++finishedCount;
+        }));
+    }
+
+    const TaskId joinTaskId = taskMgr.newTaskAfter(vecTaskId, [&](TaskProgress*) {
+        finishedCountAtJoin = finishedCount.load();
+    });
+    taskMgr.run(joinTaskId, TaskAutoDestroy::Off);
+    QCOMPARE(taskMgr.pendingTaskCount(), 1);
+    for (const TaskId taskId : vecTaskId)
+        taskMgr.run(taskId, TaskAutoDestroy::Off);
+
+    QVERIFY(taskMgr.waitForDone(joinTaskId, 5000));
+    QCOMPARE(finishedCountAtJoin.load(), 3);
+
+    // Abort of a dependency is seen by the dependent task
+    std::atomic<bool> isDependencyStarted = false;
+    const TaskId abortedTaskId = taskMgr.newTask([&](TaskProgress* progress) {
+        isDependencyStarted = true;
+        while (!progress->isAbortRequested())
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    });
+    std::atomic<bool> isDependentAborted = false;
+    const TaskId dependentTaskId = taskMgr.newTask([&](TaskProgress* progress) {
+        isDependentAborted = progress->isAbortRequested();
+    });
+    taskMgr.addDependency(dependentTaskId, abortedTaskId);
+    taskMgr.run(dependentTaskId, TaskAutoDestroy::Off);
+    taskMgr.run(abortedTaskId, TaskAutoDestroy::Off);
+    QTRY_VERIFY(isDependencyStarted.load());
+    taskMgr.requestAbort(abortedTaskId);
+    QVERIFY(taskMgr.waitForDone(dependentTaskId, 5000));
+    QVERIFY(isDependentAborted.load());
+
+    // Interactive task doesn't wait for the completion of running tasks
+    taskMgr.setMaxConcurrency(1);
+    std::atomic<bool> isBackgroundReleased = false;
+    const TaskId backgroundTaskId = taskMgr.newTask([&](TaskProgress*) {
+        while (!isBackgroundReleased)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }, TaskPriority_Background);
+    const TaskId interactiveTaskId = taskMgr.newTask([](TaskProgress*) {}, TaskPriority_Interactive);
+    taskMgr.run(backgroundTaskId, TaskAutoDestroy::Off);
+    QTRY_COMPARE(taskMgr.pendingTaskCount(), 0);
+    taskMgr.run(interactiveTaskId, TaskAutoDestroy::Off);
+    const bool isInteractiveDone = taskMgr.waitForDone(interactiveTaskId, 5000);
+    isBackgroundReleased = true;
+    QVERIFY(isInteractiveDone);
+    QVERIFY(taskMgr.waitForDone(backgroundTaskId, 5000));
+}
+
+void Test::LibTask_exception_test()
+{
+    // Task throwing an exception is still finished: waiting functions return, continuations and
+    // dependent tasks are executed
+    TaskManager taskMgr;
+    const TaskId throwingTaskId = taskMgr.newTask([](TaskProgress*) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        throw std::runtime_error("task failure");
+    });
+    std::atomic<bool> isContinuationCalled = false;
+    taskMgr.whenDone(throwingTaskId, [&]{ isContinuationCalled = true; });
+    std::atomic<bool> isDependentExecuted = false;
+    const TaskId dependentTaskId = taskMgr.newTask([&](TaskProgress*) { isDependentExecuted = true; });
+    taskMgr.addDependency(dependentTaskId, throwingTaskId);
+    QSignalSpy sigSpy_ended(&taskMgr, &TaskManager::ended);
+    taskMgr.run(dependentTaskId, TaskAutoDestroy::Off);
+    taskMgr.run(throwingTaskId, TaskAutoDestroy::Off);
+
+    const TaskId ids[] = { throwingTaskId };
+    QVERIFY(taskMgr.waitForAll(ids, 5000));
+    QCOMPARE(taskMgr.waitForAny(ids, 5000), 0);
+    QVERIFY(taskMgr.waitForDone(throwingTaskId, 5000));
+    QVERIFY(isContinuationCalled.load());
+    QVERIFY(taskMgr.waitForDone(dependentTaskId, 5000));
+    QVERIFY(isDependentExecuted.load());
+    QTRY_COMPARE(sigSpy_ended.count(), 2);
+}
+
+void Test::LibTask_abortStress_test()
+{
+    // Abort requests racing with the start and the end of task execution
+    TaskManager taskMgr;
+    std::atomic<int> abortedCount = 0;
+    std::vector<TaskId> vecTaskId;
+    for (int i = 0; i < 200; ++i) {
+        const TaskId taskId = taskMgr.newTask([&](TaskProgress* progress) {
+            for (int pct = 0; pct <= 100; ++pct) {
+                if (progress->isAbortRequested()) {
+                    ++abortedCount;
+                    return;
+                }
+
+                progress->setValue(pct);
+            }
+        });
+        vecTaskId.push_back(taskId);
+    }
+
+    for (const TaskId taskId : vecTaskId) {
+        taskMgr.run(taskId, TaskAutoDestroy::Off);
+        taskMgr.requestAbort(taskId);
+    }
+
+    QVERIFY(taskMgr.waitForAll(vecTaskId, 10000));
+    int abortedProgressCount = 0;
+    for (const TaskId taskId : vecTaskId) {
+        QVERIFY(taskMgr.waitForDone(taskId, 0));
+        if (taskMgr.progress(taskId) < 100)
+            ++abortedProgressCount;
+    }
+
+    QCOMPARE(abortedProgressCount, abortedCount.load());
+    QCOMPARE(taskMgr.pendingTaskCount(), 0);
+}
+
+void Test::LibTask_abortPropagation_test()
+{
+    // Abort requested on the task is seen by nested progress objects and by the stream buffers
+    // feeding OpenCascade parsers
+    TaskManager taskMgr;
+    const std::string contents(4 * 1024 * 1024, 'x');
+    std::atomic<bool> isFirstChunkRead = false;
+    bool isChildAborted = false;
+    bool isStreamAborted = false;
+    size_t readSize = 0;
+    const TaskId taskId = taskMgr.newTask([&](TaskProgress* progress) {
+        TaskProgress childProgress(progress, 50);
+        TaskProgress subChildProgress(&childProgress, 50);
+        std::stringbuf sourceBuffer(contents, std::ios::in);
+        IO::ProgressInputStreamBuffer streamBuffer(&sourceBuffer, contents.size(), &subChildProgress);
+        std::istream istr(&streamBuffer);
+        char c;
+        while (istr.get(c)) {
+            ++readSize;
+            if (readSize == 1)
+                isFirstChunkRead = true;
+
+            // Wait for the abort request after the first chunk
+            while (readSize == 1 && !subChildProgress.isAbortRequested())
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        isChildAborted = childProgress.isAbortRequested();
+        isStreamAborted = streamBuffer.isAborted();
+    });
+    taskMgr.run(taskId, TaskAutoDestroy::Off);
+    QTRY_VERIFY(isFirstChunkRead.load());
+    taskMgr.requestAbort(taskId);
+    QVERIFY(taskMgr.waitForDone(taskId, 5000));
+    QVERIFY(isChildAborted);
+    QVERIFY(isStreamAborted);
+    QVERIFY(readSize < contents.size());
+}
+
+void Test::LibTask_stats_test()
+{
+    // Throughput and ETA extrapolated from samples
+    {
+        TaskStatsHistory history(10000);
+        QCOMPARE(history.remainingMs(), int64_t(-1));
+        history.addSample({ 10, 1000, 1000, 1000, 0 });
+        history.addSample({ 30, 3000, 500, 5000, 4 });
+        QCOMPARE(history.bytesPerSecond(), 2000.);
+        QCOMPARE(history.entitiesPerSecond(), 2.);
+        QCOMPARE(history.remainingMs(), int64_t(7000));
+        // Samples out of the window are discarded, last two samples are always kept
+        history.addSample({ 50, 13000, 100, 6000, 4 });
+        history.addSample({ 60, 14000, 1100, 6600, 4 });
+        QCOMPARE(history.bytesPerSecond(), 600.);
+        QCOMPARE(history.remainingMs(), int64_t(4000));
+    }
+
+    // Counters of child progress objects are accumulated into the root progress
+    TaskManager taskMgr;
+    std::atomic<bool> isStatsSampled = false;
+    const TaskId taskId = taskMgr.newTask([&](TaskProgress* progress) {
+        TaskProgress childProgress(progress, 50, "Step");
+        childProgress.addProcessedBytes(1000);
+        childProgress.addProcessedEntities(2);
+        progress->addProcessedBytes(24);
+        while (!isStatsSampled)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    });
+    QCOMPARE(taskMgr.stats(taskId).elapsedMs, int64_t(0)); // Not started
+    taskMgr.run(taskId, TaskAutoDestroy::Off);
+    QTRY_VERIFY_WITH_TIMEOUT(taskMgr.stats(taskId).processedBytes == 1024, 5000);
+    const TaskStats stats = taskMgr.stats(taskId);
+    QCOMPARE(stats.processedEntities, uint64_t(2));
+    QVERIFY(stats.stepElapsedMs <= stats.elapsedMs);
+    isStatsSampled = true;
+    QVERIFY(taskMgr.waitForDone(taskId, 5000));
+}
+
+void Test::LibTask_workerPlacement_test()
+{
+    const int nodeCount = CpuTopology::numaNodeCount();
+    QVERIFY(nodeCount >= 1);
+    const TaskManager::WorkerPlacement placements[] = {
+        TaskManager::WorkerPlacement::None,
+        TaskManager::WorkerPlacement::Cpu,
+        TaskManager::WorkerPlacement::NumaNode
+    };
+    for (const TaskManager::WorkerPlacement placement : placements) {
+        TaskManager taskMgr;
+        taskMgr.setWorkerPlacement(placement);
+        QCOMPARE(taskMgr.workerPlacement(), placement);
+        std::vector<TaskId> vecTaskId;
+        std::vector<int> vecTaskNode(4 * nodeCount, -1);
+        for (int i = 0; i < int(vecTaskNode.size()); ++i) {
+            const TaskId taskId = taskMgr.newTask([=, &vecTaskNode](TaskProgress*) {
+                vecTaskNode.at(i) = CpuTopology::currentThreadNumaNode();
+            });
+            taskMgr.setNumaNode(taskId, i % nodeCount);
+            QCOMPARE(taskMgr.numaNode(taskId), i % nodeCount);
+            vecTaskId.push_back(taskId);
+        }
+
+        for (const TaskId taskId : vecTaskId)
+            taskMgr.run(taskId, TaskAutoDestroy::Off);
+
+        QVERIFY(taskMgr.waitForAll(vecTaskId, 5000));
+        // Tasks are executed on the requested node, only meaningful on a NUMA machine
+        if (placement == TaskManager::WorkerPlacement::NumaNode && nodeCount > 1) {
+            for (int i = 0; i < int(vecTaskNode.size()); ++i)
+                QCOMPARE(vecTaskNode.at(i), i % nodeCount);
+        }
+    }
+}
+
+void Test::LibTask_waitStress_test()
+{
+    // Continuations registered and waits started while tasks are finishing
+    TaskManager taskMgr;
+    taskMgr.setMaxConcurrency(4);
+    constexpr int taskCount = 500;
+    std::atomic<int> continuationCount = 0;
+    std::vector<TaskId> vecTaskId;
+    for (int i = 0; i < taskCount; ++i)
+        vecTaskId.push_back(taskMgr.newTask([](TaskProgress* progress) { progress->setValue(50); }));
+
+    for (const TaskId taskId : vecTaskId) {
+        taskMgr.run(taskId, TaskAutoDestroy::Off);
+        taskMgr.whenDone(taskId, [&]{ ++continuationCount; });
+    }
+
+    std::vector<TaskId> vecPendingTaskId = vecTaskId;
+    while (!vecPendingTaskId.empty()) {
+        const int index = taskMgr.waitForAny(vecPendingTaskId, 10000);
+        QVERIFY(index >= 0);
+        vecPendingTaskId.erase(vecPendingTaskId.begin() + index);
+    }
+
+    QVERIFY(taskMgr.waitForAll(vecTaskId, 10000));
+    QCOMPARE(continuationCount.load(), taskCount);
+    for (const TaskId taskId : vecTaskId)
+        QCOMPARE(taskMgr.progress(taskId), 100);
+}
+
 void Test::LibTree_test()
 {
     const TreeNodeId nullptrId = 0;
@@ -793,6 +2994,64 @@ void Test::LibTree_test()
         std::sort(vecTreeNodeIdVisited.begin(), vecTreeNodeIdVisited.end());
         QCOMPARE(vecTreeNodeIdVisited, vecTreeNodeId);
     }
+
+    {
+        // Pre-order built tree, trailing removed subtrees are reclaimed
+        Tree<std::string> treePreOrder;
+        const TreeNodeId m0 = treePreOrder.appendChild(nullptrId, "0");
+        const TreeNodeId m0_1 = treePreOrder.appendChild(m0, "0-1");
+        treePreOrder.appendChild(m0_1, "0-1-1");
+        treePreOrder.appendChild(m0, "0-2");
+        const TreeNodeId m1 = treePreOrder.appendChild(nullptrId, "1");
+        treePreOrder.appendChild(m1, "1-1");
+        auto fnPreOrderString = [&]{
+            std::string str;
+            traverseTree_preOrder(treePreOrder, [&](TreeNodeId id) { str += " " + treePreOrder.nodeData(id); });
+            return str;
+        };
+        QCOMPARE(fnPreOrderString(), " 0 0-1 0-1-1 0-2 1 1-1");
+
+        treePreOrder.removeRoot(m1);
+        QCOMPARE(fnPreOrderString(), " 0 0-1 0-1-1 0-2");
+        const TreeNodeId m2 = treePreOrder.appendChild(nullptrId, "2");
+        QCOMPARE(m2, m1);
+        QCOMPARE(fnPreOrderString(), " 0 0-1 0-1-1 0-2 2");
+
+        treePreOrder.removeRoot(m0);
+        QCOMPARE(fnPreOrderString(), " 2");
+        QVERIFY(treePreOrder.nodeData(m0_1).empty());
+    }
+
+    {
+        // Concurrent algorithms, tree is large enough to be split into several chunks
+        Tree<int> treeInt;
+        int64_t expectedSum = 0;
+        for (int i = 0; i < 10; ++i) {
+            const TreeNodeId rootId = treeInt.appendChild(nullptrId, i);
+            expectedSum += i;
+            for (int j = 0; j < 500; ++j) {
+                treeInt.appendChild(rootId, j);
+                expectedSum += j;
+            }
+        }
+
+        std::atomic<int64_t> visitSum = 0;
+        traverseTree_concurrent(treeInt, [&](TreeNodeId id) { visitSum += treeInt.nodeData(id); });
+        QCOMPARE(visitSum.load(), expectedSum);
+
+        const int64_t reduceSum = reduceTree_concurrent(
+                    treeInt, int64_t(0),
+                    [&](TreeNodeId id) { return int64_t(treeInt.nodeData(id)); },
+                    [](int64_t lhs, int64_t rhs) { return lhs + rhs; });
+        QCOMPARE(reduceSum, expectedSum);
+
+        const TreeNodeId firstRootId = treeInt.roots().front();
+        const int subtreeCount = reduceTree_concurrent(
+                    firstRootId, treeInt, 0,
+                    [](TreeNodeId) { return 1; },
+                    [](int lhs, int rhs) { return lhs + rhs; });
+        QCOMPARE(subtreeCount, 501);
+    }
 }
 
 void Test::QtGuiUtils_test()
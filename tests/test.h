@@ -27,22 +27,61 @@ private slots:
 
     void IO_test();
     void IO_test_data();
+    void IO_probeFormatObj_test();
+    void IO_probeFormatObj_test_data();
     void IO_OccStaticVariablesRollback_test();
     void IO_OccStaticVariablesRollback_test_data();
+    void IO_StlNative_test();
+    void IO_RemoteFile_test();
+    void IO_GltfNative_test();
+    void IO_probeCompression_test();
+    void IO_fileMetadata_test();
+    void IO_estimate_test();
+    void IO_readBuffer_test();
+    void IO_reloadDocument_test();
+    void IO_igesParallelRootTransfer_test();
+    void IO_importMemoryBudget_test();
+    void IO_importThrowingReader_test();
+    void IO_exportThrowingWriter_test();
 
     void BRepUtils_test();
+    void BRepMassProperties_test();
+
+    void Bvh_test();
 
     void CafUtils_test();
+    void LabelAttributesCache_test();
+    void SubShapeCache_test();
+    void ShapeStyleCache_test();
+
+    void ShapeDeduplication_test();
+    void DocumentConcurrentModelTree_test();
+    void DocumentDeferredScaling_test();
+    void DocumentDiff_test();
+    void DocumentSearchIndex_test();
+    void DocumentSnapshot_test();
+    void MeshDecimation_test();
+    void MeshReorder_test();
+    void MeshRepair_test();
+    void MeshSection_test();
+    void ModelCache_test();
+    void ShapePager_test();
 
     void MeshUtils_test();
     void MeshUtils_test_data();
+    void MeshUtils_normals_test();
+    void MeshUtils_edges_test();
     void MeshUtils_orientation_test();
     void MeshUtils_orientation_test_data();
 
     void MetaEnum_test();
 
+    void PointCloud_test();
+
     void Quantity_test();
 
+    void ShapeHealing_test();
+
     void QStringUtils_append_test();
     void QStringUtils_append_test_data();
     void QStringUtils_text_test();
@@ -57,8 +96,21 @@ private slots:
 
     void UnitSystem_test();
     void UnitSystem_test_data();
+    void UnitSystem_bulkTranslate_test();
+
+    void MessageBatchQueue_test();
 
     void LibTask_test();
+    void LibTask_completion_test();
+    void LibTask_concurrentAccess_test();
+    void LibTask_runConcurrently_test();
+    void LibTask_dependency_test();
+    void LibTask_exception_test();
+    void LibTask_abortStress_test();
+    void LibTask_abortPropagation_test();
+    void LibTask_stats_test();
+    void LibTask_workerPlacement_test();
+    void LibTask_waitStress_test();
     void LibTree_test();
 
     void QtGuiUtils_test();